@@ -0,0 +1,50 @@
+// Subexpressions repeated across the fields of a $project, or the _id and accumulators of a
+// $group, are evaluated once per document. Each document must still get its own values, and a
+// shared subexpression must only be evaluated where it would have been without sharing.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_aggregation_common_subexpressions;
+    coll.drop();
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i, x: i, y: i % 4, sub: {x: 100 + i}}));
+    }
+
+    var ratio = {$divide: ['$x', '$y']};
+    var res = coll.aggregate([
+        {$project: {
+            // $divide fails for y == 0, so the shared ratio must not be evaluated for it.
+            a: {$cond: [{$eq: ['$y', 0]}, null, ratio]},
+            b: {$cond: [{$eq: ['$y', 0]}, null, {$multiply: [ratio, 2]}]},
+            c: {$let: {vars: {CURRENT: '$sub'}, in: {$add: ['$x', 1]}}},
+            d: {$add: ['$x', 1]}
+        }},
+        {$sort: {_id: 1}}
+    ]).toArray();
+
+    assert.eq(20, res.length);
+    res.forEach(function(doc) {
+        var i = doc._id;
+        if (i % 4 === 0) {
+            assert.eq(null, doc.a, tojson(doc));
+            assert.eq(null, doc.b, tojson(doc));
+        }
+        else {
+            assert.eq(i / (i % 4), doc.a, tojson(doc));
+            assert.eq(2 * i / (i % 4), doc.b, tojson(doc));
+        }
+        assert.eq(101 + i, doc.c, tojson(doc));
+        assert.eq(i + 1, doc.d, tojson(doc));
+    });
+
+    var bucket = {$mod: ['$x', 5]};
+    res = coll.aggregate([
+        {$group: {_id: bucket, total: {$sum: bucket}, maxTwice: {$max: {$multiply: [bucket, 2]}}}},
+        {$sort: {_id: 1}}
+    ]).toArray();
+    assert.eq(5, res.length);
+    res.forEach(function(group) {
+        assert.eq(4 * group._id, group.total, tojson(group));
+        assert.eq(2 * group._id, group.maxTwice, tojson(group));
+    });
+}());
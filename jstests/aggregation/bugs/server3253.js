@@ -86,6 +86,15 @@ test(input,
      [{$project: {c: {$concat: ["hello there ", "_id"]}}}],
      [{_id:1, c:"hello there _id"}, {_id:2, c:"hello there _id"}, {_id:3, c:"hello there _id"}]);
 
+// indexes are built after the results are loaded, so results violating a unique index fail the
+// $out as a whole and leave the previous output in place
+output.ensureIndex({d: 1}, {unique: true, sparse: true});
+var previousOutput = output.find().sort({_id: 1}).toArray();
+assertErrorCode(input, [{$project: {d: {$literal: 1}}}, {$out: output.getName()}], 16995);
+assert.eq(output.find().sort({_id: 1}).toArray(), previousOutput);
+assert.eq([], listCollections(/tmp\.agg_out/));
+output.dropIndex({d: 1});
+
 // test with capped collection
 cappedOutput.drop();
 db.createCollection(cappedOutput.getName(), {capped: true, size: 2});
@@ -61,6 +61,21 @@ assert.eq(cursor.itcount(), bigArray.length * t.count());
 var cursor = aggCursor([{$unwind:'$bigArray'}], 5, 5); // many small batches
 assert.eq(cursor.itcount(), bigArray.length * t.count());
 
+// a large first batch is cut by size, and the result that didn't fit starts the next batch
+var res = t.runCommand(buildAggCmd([{$unwind:'$bigArray'}], 1000000));
+assert.gt(res.cursor.firstBatch.length, 0);
+assert.lt(res.cursor.firstBatch.length, bigArray.length * t.count());
+assert.lte(Object.bsonsize(res.cursor), 4 * 1024 * 1024 + 4 * 1024);
+var seen = {};
+var n = 0;
+makeCursor(res).forEach(function(doc) {
+    var key = doc._id + ',' + doc.bigArray;
+    assert(!seen[key], key);
+    seen[key] = true;
+    n++;
+});
+assert.eq(bigArray.length * t.count(), n);
+
 // empty result set results in cursor.id == 0 unless batchSize is 0;
 var res = t.runCommand(buildAggCmd([{$match: {noSuchField: {$exists:true}}}]));
 assert.eq(res.cursor.firstBatch, []);
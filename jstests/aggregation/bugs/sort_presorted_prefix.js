@@ -0,0 +1,68 @@
+// A $sort whose leading fields an index provides only sorts the documents sharing those fields,
+// and with a $limit stops reading once the remaining results are final.  The results must match
+// those of a full blocking sort.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_aggregation_sort_presorted_prefix;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({category: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        var doc = {_id: i, ts: (i * 37) % 101};
+        if (i % 50 === 0) {
+            // Missing and null categories sort together in the index.
+            if (i % 100 === 0) {
+                doc.category = null;
+            }
+        }
+        else {
+            doc.category = i % 9;
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    function presortedPrefix(pipeline) {
+        var explain = coll.aggregate(pipeline, {explain: true});
+        assert.commandWorked(explain);
+        var prefix = 0;
+        explain.stages.forEach(function(stage) {
+            if (stage.$sort && stage.$sort.presortedPrefix) {
+                prefix = stage.$sort.presortedPrefix;
+            }
+        });
+        return prefix;
+    }
+
+    function check(sort, limit) {
+        var pipeline = [{$sort: sort}];
+        // Sorting on a computed field keeps the index from providing any of the order.
+        var blocking = [{$project: {category: 1, ts: 1}}, {$sort: sort}];
+        if (limit) {
+            pipeline.push({$limit: limit});
+            blocking.push({$limit: limit});
+        }
+        assert.eq(1, presortedPrefix(pipeline), tojson(pipeline));
+        assert.eq(0, presortedPrefix(blocking), tojson(blocking));
+        var res = coll.aggregate(pipeline).toArray();
+        assert.eq(coll.aggregate(blocking).toArray(), res);
+        return res;
+    }
+
+    var res = check({category: 1, ts: -1, _id: 1}, 30);
+    assert.eq(30, res.length);
+    assert.eq(null, res[0].category);
+    assert.eq(0, res[res.length - 1].category);
+
+    res = check({category: -1, ts: 1, _id: 1}, 250);
+    assert.eq(250, res.length);
+
+    res = check({category: 1, ts: 1, _id: -1});
+    assert.eq(1000, res.length);
+
+    // A limit past the end of the input returns everything.
+    res = check({category: 1, ts: 1, _id: 1}, 5000);
+    assert.eq(1000, res.length);
+}());
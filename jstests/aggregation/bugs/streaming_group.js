@@ -0,0 +1,75 @@
+// A $group on the field an index-provided $sort leads with returns each group as soon as the next
+// one starts.  The results must match those of the regular hash-based $group.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_aggregation_streaming_group;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({ts: 1, x: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        var doc = {_id: i, x: i % 7};
+        if (i % 100 === 0) {
+            // Missing and null keys sort together in the index, and fall into the same group.
+            if (i % 200 === 0) {
+                doc.ts = null;
+            }
+        }
+        else {
+            doc.ts = Math.floor(i / 10);
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    function isStreaming(pipeline) {
+        var explain = coll.aggregate(pipeline, {explain: true});
+        assert.commandWorked(explain);
+        return explain.stages.some(function(stage) {
+            return stage.$group && stage.$group.$streaming;
+        });
+    }
+
+    function sortById(docs) {
+        return docs.sort(function(a, b) {
+            return bsonWoCompare({_: a._id}, {_: b._id});
+        });
+    }
+
+    function checkGroup(sort, group) {
+        var streamed = [{$sort: sort}, {$group: group}];
+        assert(isStreaming(streamed), tojson(streamed));
+        var hashed = [{$sort: sort}, {$project: {ts: 1, x: 1}}, {$group: group}];
+        assert(!isStreaming(hashed), tojson(hashed));
+
+        var res = coll.aggregate(streamed).toArray();
+        assert.eq(sortById(coll.aggregate(hashed).toArray()), sortById(res));
+        return res;
+    }
+
+    var res = checkGroup({ts: 1}, {_id: '$ts', n: {$sum: 1}, maxX: {$max: '$x'}});
+    assert.eq(101, res.length, tojson(res));
+    assert.eq({_id: null, n: 10, maxX: 6}, res[0]);
+
+    res = checkGroup({ts: -1, x: -1}, {_id: {t: '$ts'}, xs: {$addToSet: '$x'}});
+    assert.eq(101, res.length, tojson(res));
+    assert.eq({t: null}, res[res.length - 1]._id);
+
+    // A $limit in between keeps the order.
+    res = coll.aggregate([{$sort: {ts: 1}}, {$limit: 25}, {$group: {_id: '$ts', n: {$sum: 1}}}])
+              .toArray();
+    assert.eq([{_id: null, n: 10}, {_id: 0, n: 9}, {_id: 1, n: 6}], res);
+
+    // Groups which the sort order doesn't keep together are hashed.
+    assert(!isStreaming([{$sort: {ts: 1}}, {$group: {_id: '$x'}}]));
+    assert(!isStreaming([{$sort: {ts: 1}}, {$group: {_id: {$add: ['$ts', 1]}}}]));
+
+    // Arrays sort by their elements, so a multikey index doesn't keep equal keys together.
+    assert.writeOK(coll.insert({_id: 'array', ts: [1, 50], x: 0}));
+    assert.writeOK(coll.insert({_id: 'array2', ts: [1, 50], x: 1}));
+    assert(!isStreaming([{$sort: {ts: 1}}, {$group: {_id: '$ts'}}]));
+    assert.eq(2, coll.aggregate([{$sort: {ts: 1}},
+                                 {$group: {_id: '$ts', n: {$sum: 1}}},
+                                 {$match: {_id: [1, 50]}}]).toArray()[0].n);
+}());
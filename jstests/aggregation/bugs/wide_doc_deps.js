@@ -0,0 +1,32 @@
+// Pipelines that only need a few fields of wide documents stop reading each document once the
+// needed fields have been found.  Fields anywhere in the document must still be found.
+(function() {
+    'use strict';
+
+    var coll = db.jstests_aggregation_wide_doc_deps;
+    coll.drop();
+
+    var numFields = 500;
+    for (var i = 0; i < 20; i++) {
+        var doc = {_id: i};
+        for (var j = 0; j < numFields; j++) {
+            doc['f' + j] = j;
+        }
+        doc.sub = {x: i, y: 'skip me', z: [{x: 1, w: 2}, {x: 2}]};
+        doc.last = i * 2;
+        assert.writeOK(coll.insert(doc));
+    }
+
+    var res = coll.aggregate([{$match: {f3: 3}},
+                              {$project: {_id: 0, f0: 1, f250: 1, last: 1, 'sub.x': 1,
+                                          'sub.z.x': 1}},
+                              {$sort: {last: 1}}]).toArray();
+    assert.eq(20, res.length);
+    for (var i = 0; i < res.length; i++) {
+        assert.eq({f0: 0, f250: 250, sub: {x: i, z: [{x: 1}, {x: 2}]}, last: i * 2}, res[i]);
+    }
+
+    res = coll.aggregate([{$group: {_id: null, total: {$sum: '$last'}, n: {$sum: '$f499'}}}])
+              .toArray();
+    assert.eq([{_id: null, total: 380, n: 20 * 499}], res);
+}());
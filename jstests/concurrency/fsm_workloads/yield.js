@@ -141,6 +141,9 @@ var $config = (function() {
             assertAlways.commandWorked(
                 db.adminCommand({ setParameter: 1, internalQueryExecYieldPeriodMS: 1 })
             );
+            assertAlways.commandWorked(
+                db.adminCommand({ setParameter: 1, internalQueryExecUncontendedYieldPeriodMS: 0 })
+            );
         });
         // Set up some data to query.
         var N = this.nDocs;
@@ -171,6 +174,10 @@ var $config = (function() {
             assertAlways.commandWorked(
                 db.adminCommand({ setParameter: 1, internalQueryExecYieldPeriodMS: 10 })
             );
+            assertAlways.commandWorked(
+                db.adminCommand({ setParameter: 1,
+                                  internalQueryExecUncontendedYieldPeriodMS: 1000 })
+            );
         });
     }
 
@@ -0,0 +1,24 @@
+// Tests the options that are handled for every command rather than by the command itself.
+(function() {
+    'use strict';
+
+    // mongos parses these options itself.
+    if (db.isMaster().msg === 'isdbgrid') {
+        return;
+    }
+
+    var res = assert.commandWorked(db.runCommand({ping: 1, help: 1}));
+    assert(res.help, tojson(res));
+    res = assert.commandWorked(db.runCommand({ping: 1, help: false}));
+    assert(!res.help, tojson(res));
+
+    assert.commandWorked(db.runCommand({ping: 1, maxTimeMS: 1000}));
+    assert.commandFailed(db.runCommand({ping: 1, maxTimeMS: 'x'}));
+    assert.commandFailed(db.runCommand({ping: 1, $maxTimeMS: 1000}));
+
+    // The same options on commands wrapped as queries.
+    assert.commandWorked(db.runCommand({$query: {ping: 1}, $readPreference: {mode: 'primary'}}));
+    assert.commandWorked(db.runCommand({query: {ping: 1, maxTimeMS: 1000}}));
+    assert.commandFailed(db.runCommand({$query: {ping: 1}, $maxTimeMS: 1000}));
+    assert.commandFailed(db.runCommand({$query: {ping: 1, maxTimeMS: -1}}));
+}());
@@ -0,0 +1,41 @@
+// compact {freeSpaceOnly: true} merges adjacent free space in place on mmapv1, without moving
+// documents or rebuilding indexes, and reports the free lists in collStats.
+(function() {
+    'use strict';
+
+    var engine = db.serverStatus().storageEngine;
+    if (!engine || engine.name != 'mmapv1') {
+        jsTestLog('Skipping test because storageEngine is not mmapv1');
+        return;
+    }
+
+    var coll = db.compact_free_space_only;
+    coll.drop();
+    assert.commandWorked(db.createCollection(coll.getName(), {usePowerOf2Sizes: false}));
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+
+    var pad = new Array(200).join('x');
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, x: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    // Free runs of neighbouring documents.
+    assert.writeOK(coll.remove({_id: {$mod: [4, 1]}}));
+    assert.writeOK(coll.remove({_id: {$mod: [4, 2]}}));
+
+    var before = coll.stats().freeList;
+    assert(before, tojson(coll.stats()));
+
+    var res = coll.runCommand('compact', {freeSpaceOnly: true});
+    assert.commandWorked(res);
+    assert.gt(res.freeRecordsMerged, 0, tojson(res));
+
+    var after = coll.stats().freeList;
+    assert.lt(after.records, before.records, tojson(after));
+    assert.gte(after.largestRecord, before.largestRecord, tojson(after));
+
+    assert.eq(500, coll.find().itcount());
+    assert.eq(500, coll.find({x: {$gte: 0}}).hint({x: 1}).itcount());
+    assert.commandWorked(coll.validate(true));
+}());
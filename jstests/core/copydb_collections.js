@@ -0,0 +1,45 @@
+// copydb clones several collections at once and builds their secondary indexes along with the _id
+// index, unless one of them is unique.  Every collection must arrive whole, with all its indexes.
+(function() {
+    'use strict';
+
+    var db1 = db.getSisterDB("copydb-collections-db1");
+    var db2 = db.getSisterDB("copydb-collections-db2");
+    assert.commandWorked(db1.dropDatabase());
+    assert.commandWorked(db2.dropDatabase());
+
+    var numColls = 8;
+    for (var c = 0; c < numColls; c++) {
+        var coll = db1['coll' + c];
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 300 * (c + 1); i++) {
+            bulk.insert({_id: i, a: i % 17, b: 'b' + i, arr: [i, -i]});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(coll.ensureIndex({a: 1}));
+        assert.commandWorked(coll.ensureIndex({arr: 1, b: -1}));
+        if (c % 2) {
+            assert.commandWorked(coll.ensureIndex({b: 1}, {unique: true}));
+        }
+    }
+
+    assert.commandWorked(db1.copyDatabase(db1.getName(), db2.getName()));
+
+    function indexKeys(coll) {
+        return coll.getIndexes().map(function(index) {
+            return tojson(index.key) + (index.unique ? ' unique' : '');
+        }).sort();
+    }
+
+    for (var c = 0; c < numColls; c++) {
+        var from = db1['coll' + c];
+        var to = db2['coll' + c];
+        assert.eq(from.count(), to.count(), to.getFullName());
+        assert.eq(indexKeys(from), indexKeys(to), to.getFullName());
+        assert.eq(from.find({a: 3}).itcount(), to.find({a: 3}).hint({a: 1}).itcount());
+        assert.eq(1, to.find({arr: -5}).hint({arr: 1, b: -1}).itcount());
+    }
+
+    assert.commandWorked(db1.dropDatabase());
+    assert.commandWorked(db2.dropDatabase());
+}());
@@ -0,0 +1,54 @@
+// Counts over one index range with approximate: true may be estimated, but never past what the
+// collection holds, and small ranges are always counted exactly.
+(function() {
+    'use strict';
+
+    var coll = db.count_approximate;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    var N = 30000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        bulk.insert({a: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function count(query, approximate) {
+        return assert.commandWorked(db.runCommand({count: coll.getName(),
+                                                   query: query,
+                                                   approximate: approximate}));
+    }
+
+    var res = count({a: {$gte: 100, $lt: 150}}, true);
+    assert.eq(50, res.n, tojson(res));
+    assert(!res.approximate, tojson(res));
+
+    res = count({a: {$gte: 5000}}, true);
+    if (res.approximate) {
+        assert.gt(res.n, 10000, tojson(res));
+        assert.lte(res.n, N, tojson(res));
+    }
+    else {
+        assert.eq(N - 5000, res.n, tojson(res));
+    }
+
+    // Exact unless asked otherwise.
+    res = count({a: {$gte: 5000}}, false);
+    assert.eq(N - 5000, res.n, tojson(res));
+    assert(!res.approximate, tojson(res));
+    assert.eq(N - 5000, coll.count({a: {$gte: 5000}}));
+
+    // Skip and limit still apply to an estimate.
+    res = assert.commandWorked(db.runCommand({count: coll.getName(), query: {a: {$gte: 5000}},
+                                              approximate: true, skip: 10, limit: 100}));
+    assert.eq(100, res.n, tojson(res));
+
+    // A multikey index can't be estimated from the collection size.
+    assert.writeOK(coll.insert({a: [1, 2]}));
+    res = count({a: {$gte: 5000}}, true);
+    assert.eq(N - 5000, res.n, tojson(res));
+    assert(!res.approximate, tojson(res));
+
+    assert.commandFailed(db.runCommand({count: coll.getName(), approximate: 'yes'}));
+}());
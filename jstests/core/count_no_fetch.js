@@ -0,0 +1,38 @@
+// Counts whose index scans match the query exactly don't fetch documents, even when they can't
+// use a single COUNT_SCAN.
+(function() {
+    'use strict';
+
+    var coll = db.count_no_fetch;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({a: i % 10, b: i % 7, c: [i % 3, i % 5]});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: 1, b: 1}));
+    assert.commandWorked(coll.ensureIndex({c: 1}));
+
+    function checkCount(query) {
+        var expected = coll.find(query).itcount();
+        assert.eq(expected, coll.count(query), tojson(query));
+
+        var explain = coll.explain('executionStats').count(query);
+        assert.eq(0, explain.executionStats.totalDocsExamined, tojson(explain));
+    }
+
+    checkCount({a: {$in: [1, 3, 5]}});
+    checkCount({a: {$in: [1, 3, 5]}, b: {$gt: 2}});
+    checkCount({a: {$gt: 2}, b: 4});
+    // Multikey entries are only counted once per document.
+    checkCount({c: {$in: [0, 1, 2]}});
+    checkCount({c: {$gte: 1}});
+
+    // Predicates the index can't answer still need the documents.
+    [{a: {$in: [1, 3]}, c: 2},
+     {c: {$gte: 1, $lte: 3}},
+     {$or: [{a: 1}, {b: 2, a: {$lt: 5}}]}].forEach(function(query) {
+        assert.eq(coll.find(query).itcount(), coll.count(query), tojson(query));
+    });
+}());
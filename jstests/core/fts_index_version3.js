@@ -0,0 +1,73 @@
+// Test "textIndexVersion:3" indexes, which store term positions so that phrases and negated
+// terms can be matched without fetching documents.
+
+var coll = db.fts_index_version3;
+
+coll.drop();
+assert.commandWorked(coll.ensureIndex({a: "text"}, {textIndexVersion: 3}));
+assert.eq(3, coll.getIndexes().filter(function(index) {
+    return index.name == "a_text";
+})[0].textIndexVersion);
+
+assert.writeOK(coll.insert({_id: 0, a: "the password reset link expired"}));
+assert.writeOK(coll.insert({_id: 1, a: "reset your password"}));
+assert.writeOK(coll.insert({_id: 2, a: ["please reset", "password"]}));
+assert.writeOK(coll.insert({_id: 3, a: "Passwords were reset twice"}));
+assert.writeOK(coll.insert({_id: 4, a: "password-reset emails"}));
+assert.writeOK(coll.insert({_id: 5, a: "the reset of the password reset page"}));
+
+function ids(search) {
+    return coll.find({$text: {$search: search}}, {_id: 1}).sort({_id: 1}).toArray().map(
+        function(doc) { return doc._id; });
+}
+
+function docsExamined(search) {
+    var stage = coll.find({$text: {$search: search}}).explain(true).executionStats.executionStages;
+    if ("SINGLE_SHARD" === stage.stage) {
+        stage = stage.shards[0].executionStages;
+    }
+    assert.eq(stage.stage, "TEXT");
+    return stage.docsExamined;
+}
+
+// Phrase terms are matched after stemming, in order and at the right distance from each other.
+// Delimiters and stop words take up a position each.
+assert.eq([0, 5], ids("\"password reset\""));
+assert.eq([3], ids("\"passwords were reset\""));
+assert.eq([3, 4], ids("\"password-reset\""));
+assert.eq([1], ids("\"reset your password\""));
+
+// Only the matching documents need to be fetched.
+assert.eq(2, docsExamined("\"password reset\""));
+
+// Negations.
+assert.eq([1, 2, 3, 4], ids("reset -\"password reset\""));
+assert.eq([0, 1, 5], ids("password -emails -please -twice"));
+assert.eq(3, docsExamined("password -emails -please -twice"));
+
+// Phrases of stop words are matched as substrings.
+assert.eq([5], ids("password \"of the\""));
+
+// Case-sensitive queries fetch and check every document.
+assert.eq([], coll.find({$text: {$search: "\"passwords were reset\"",
+                                 $caseSensitive: true}}).toArray());
+assert.eq([3], coll.find({$text: {$search: "\"Passwords were reset\"", $caseSensitive: true}},
+                         {_id: 1}).toArray().map(function(doc) { return doc._id; }));
+
+// Documents with more occurrences of a term than fit in an index key are still matched.
+var longText = new Array(500).join("reset ") + "password reset";
+assert.writeOK(coll.insert({_id: 6, a: longText}));
+assert.writeOK(coll.insert({_id: 7, a: new Array(500).join("reset ") + "password"}));
+assert.eq([0, 5, 6], ids("\"password reset\""));
+assert.eq([1, 2, 3, 4, 7], ids("-\"password reset\" password"));
+
+// Version 2 indexes keep matching phrases as substrings.
+assert.eq([], ids("\"passwords were re\""));
+coll.drop();
+assert.commandWorked(coll.ensureIndex({a: "text"}));
+assert.writeOK(coll.insert({_id: 3, a: "Passwords were reset twice"}));
+assert.eq([3], ids("\"passwords were re\""));
+
+// Unsupported versions are rejected.
+coll.drop();
+assert.commandFailed(coll.ensureIndex({a: "text"}, {textIndexVersion: 4}));
@@ -0,0 +1,85 @@
+// A $text query sorted by text score with a limit only reads as many index keys as it needs to
+// find the best scoring documents.  The results must be the same as sorting all matches.
+(function() {
+    'use strict';
+
+    var coll = db.fts_score_sort_limit;
+    coll.drop();
+
+    var words = ['apple', 'banana', 'cherry', 'grape', 'lemon', 'mango', 'peach', 'plum'];
+    for (var i = 0; i < 2000; i++) {
+        var text = [];
+        for (var j = 0; j < words.length; j++) {
+            // Vary how often each word appears, so that the scores spread out.
+            var count = (i * (j + 3)) % (j + 5);
+            for (var n = 0; n < count; n++) {
+                text.push(words[j]);
+            }
+        }
+        text.push('filler' + (i % 50));
+        assert.writeOK(coll.insert({_id: i, a: text.join(' '), b: i % 3}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 'text'}));
+
+    function textStage(explain) {
+        var stage = explain.executionStats.executionStages;
+        if ('SINGLE_SHARD' === stage.stage) {
+            stage = stage.shards[0].executionStages;
+        }
+        while (stage.stage !== 'TEXT') {
+            assert(stage.inputStage, tojson(explain));
+            stage = stage.inputStage;
+        }
+        return stage;
+    }
+
+    function scores(query, limit) {
+        var cursor = coll.find(query, {score: {$meta: 'textScore'}})
+                         .sort({score: {$meta: 'textScore'}});
+        if (limit) {
+            cursor = cursor.limit(limit);
+        }
+        return cursor.toArray().map(function(doc) { return doc.score; });
+    }
+
+    function check(query, limit) {
+        var expected = scores(query).slice(0, limit);
+        assert.eq(expected, scores(query, limit), tojson(query));
+    }
+
+    var queries = [
+        {$text: {$search: 'apple'}},
+        {$text: {$search: 'apple banana'}},
+        {$text: {$search: 'cherry lemon plum peach'}},
+        {$text: {$search: 'mango filler7'}},
+        {$text: {$search: 'banana grape'}, b: 1},
+        {$text: {$search: 'nothing'}},
+    ];
+    [1, 5, 20, 3000].forEach(function(limit) {
+        queries.forEach(function(query) {
+            check(query, limit);
+        });
+    });
+
+    // Reading stops well before all the keys of the terms have been read.
+    var query = {$text: {$search: 'cherry lemon plum peach'}};
+    var all = textStage(coll.find(query).explain('executionStats'));
+    var limited = textStage(coll.find(query, {score: {$meta: 'textScore'}})
+                                .sort({score: {$meta: 'textScore'}})
+                                .limit(20)
+                                .explain('executionStats'));
+    assert.lt(limited.keysExamined, all.keysExamined, tojson(limited));
+
+    // Negations and phrases are still applied to the limited results.
+    check({$text: {$search: 'apple banana -cherry'}}, 10);
+    check({$text: {$search: 'apple "banana banana"'}}, 10);
+
+    // Skipped results count towards the number of documents needed.
+    var skipped = coll.find(query, {score: {$meta: 'textScore'}})
+                      .sort({score: {$meta: 'textScore'}})
+                      .skip(10)
+                      .limit(10)
+                      .toArray()
+                      .map(function(doc) { return doc.score; });
+    assert.eq(scores(query).slice(10, 20), skipped);
+}());
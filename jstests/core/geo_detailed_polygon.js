@@ -0,0 +1,58 @@
+// Points tested against a polygon with many vertices, which is indexed by its edges once enough
+// points have been tested, must match the same way as against the polygon itself.
+(function() {
+    'use strict';
+
+    var coll = db.geo_detailed_polygon;
+    coll.drop();
+
+    // A star with 7 arms around (-70, 40), with radii between 0.7 and 1.3 degrees.
+    function star(lng, lat, numVertices) {
+        var ring = [];
+        for (var i = 0; i < numVertices; i++) {
+            var angle = 2 * Math.PI * i / numVertices;
+            var r = 1 + 0.3 * Math.sin(7 * angle);
+            ring.push([lng + r * Math.cos(angle), lat + r * Math.sin(angle)]);
+        }
+        ring.push(ring[0]);
+        return ring;
+    }
+
+    // Points well inside the star (radius 0.5) or well outside it (radius 1.5).
+    var numInside = 0;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 3000; i++) {
+        var angle = 2 * Math.PI * i / 3000;
+        var r = (i % 3 === 0) ? 0.5 : 1.5;
+        numInside += (r < 1);
+        bulk.insert({_id: i,
+                     loc: {type: "Point",
+                           coordinates: [-70 + r * Math.cos(angle), 40 + r * Math.sin(angle)]}});
+    }
+    assert.writeOK(bulk.execute());
+
+    var polygon = {type: "Polygon", coordinates: [star(-70, 40, 2000)]};
+    var multiPolygon = {type: "MultiPolygon",
+                        coordinates: [[star(-70, 40, 2000)], [star(-60, 40, 1500)]]};
+    var bigPolygon = {type: "Polygon",
+                      coordinates: [star(-70, 40, 2000)],
+                      crs: {type: "name",
+                            properties: {name: "urn:x-mongodb:crs:strictwinding:EPSG:4326"}}};
+
+    function check() {
+        // Twice, the second time with the index kept by the first query.
+        for (var i = 0; i < 2; i++) {
+            assert.eq(numInside, coll.find({loc: {$geoWithin: {$geometry: polygon}}}).itcount());
+            assert.eq(numInside,
+                      coll.find({loc: {$geoIntersects: {$geometry: polygon}}}).itcount());
+            assert.eq(numInside,
+                      coll.find({loc: {$geoWithin: {$geometry: multiPolygon}}}).itcount());
+            assert.eq(numInside,
+                      coll.find({loc: {$geoWithin: {$geometry: bigPolygon}}}).itcount());
+        }
+    }
+
+    check();
+    assert.commandWorked(coll.ensureIndex({loc: "2dsphere"}));
+    check();
+}());
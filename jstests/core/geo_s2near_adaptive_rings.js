@@ -0,0 +1,66 @@
+// $near over a 2dsphere index sizes its search annuli from the density of documents it has found
+// so far, and remembers that density for later queries near the same place.  Results must come
+// back in distance order regardless of how the annuli end up being sized.
+(function() {
+    'use strict';
+
+    var t = db.geo_s2near_adaptive_rings;
+    t.drop();
+
+    // A dense cluster near the origin, and a few documents scattered far away from it.
+    var docs = [];
+    for (var i = 0; i < 1000; i++) {
+        docs.push({_id: i, geo: {type: 'Point', coordinates: [(i % 40) * 0.0001,
+                                                              Math.floor(i / 40) * 0.0001]},
+                   even: i % 2 == 0});
+    }
+    for (var j = 0; j < 30; j++) {
+        docs.push({_id: 1000 + j, geo: {type: 'Point', coordinates: [-170 + j * 11, -60 + j * 4]},
+                   even: j % 2 == 0});
+    }
+    docs.forEach(function(doc) {
+        assert.writeOK(t.insert(doc));
+    });
+    assert.commandWorked(t.ensureIndex({geo: '2dsphere'}));
+
+    function checkSorted(query, expectedCount) {
+        var results = t.find(query, {_id: 1, geo: 1}).toArray();
+        assert.eq(expectedCount, results.length);
+
+        var center = query.geo.$near.$geometry.coordinates;
+        var lastDistance = -1;
+        results.forEach(function(doc) {
+            var distance = Geo.sphereDistance(center, doc.geo.coordinates);
+            assert.gte(distance + 1e-12, lastDistance, tojson(doc));
+            lastDistance = distance;
+        });
+    }
+
+    // Run each query twice, so that the second run starts from the cached density.
+    for (var run = 0; run < 2; run++) {
+        // From inside the dense cluster outward to the sparse documents.
+        checkSorted({geo: {$near: {$geometry: {type: 'Point', coordinates: [0, 0]}}}}, 1030);
+
+        // From a sparse area, where most annuli are empty.
+        checkSorted({geo: {$near: {$geometry: {type: 'Point', coordinates: [100, -30]}}}}, 1030);
+
+        // With a filter, which changes the density of matching documents.
+        checkSorted({geo: {$near: {$geometry: {type: 'Point', coordinates: [0, 0]}}}, even: true},
+                    515);
+
+        // Bounded searches near the cluster.
+        assert.eq(t.find({geo: {$near: {$geometry: {type: 'Point', coordinates: [0, 0]},
+                                        $maxDistance: 50}}}).itcount(),
+                  t.find({geo: {$geoWithin: {$centerSphere: [[0, 0],
+                                                             50 / 6378100]}}}).itcount());
+        checkSorted({geo: {$near: {$geometry: {type: 'Point', coordinates: [0, 0]},
+                                   $minDistance: 100000}}}, 30);
+    }
+
+    // A limited query only needs the first annulus or two, and still gets the closest documents.
+    var nearest = t.find({geo: {$near: {$geometry: {type: 'Point', coordinates: [0, 0]}}}})
+                      .limit(3).toArray();
+    assert.eq([0, 1, 40], nearest.map(function(doc) { return doc._id; }).sort(function(a, b) {
+        return a - b;
+    }));
+}());
@@ -0,0 +1,43 @@
+// Hashed indexes can use the faster hashVersion 1 and a non-default seed, and equality lookups
+// hash the query value the same way the index does.
+(function() {
+    'use strict';
+
+    var t = db.hashindex_version;
+    t.drop();
+
+    // Unknown versions are rejected.
+    assert.commandFailed(t.ensureIndex({a: "hashed"}, {hashVersion: 2}));
+    assert.eq(1, t.getIndexes().length);
+
+    var specs = [{hashVersion: 1, name: "v1"},
+                 {hashVersion: 1, seed: 7, name: "v1_seed"},
+                 {seed: 7, name: "v0_seed"}];
+    specs.forEach(function(spec) {
+        assert.commandWorked(t.ensureIndex({a: "hashed"}, spec));
+    });
+
+    for (var i = 0; i < 50; i++) {
+        assert.writeOK(t.insert({a: i}));
+        assert.writeOK(t.insert({a: "s" + i}));
+    }
+    assert.writeOK(t.insert({b: 1}));
+
+    specs.forEach(function(spec) {
+        assert.eq(1, t.find({a: 3}).hint(spec.name).itcount(), tojson(spec));
+        assert.eq(1, t.find({a: NumberLong(3)}).hint(spec.name).itcount(), tojson(spec));
+        assert.eq(1, t.find({a: "s7"}).hint(spec.name).itcount(), tojson(spec));
+        assert.eq(3, t.find({a: {$in: [1, 2, "s3"]}}).hint(spec.name).itcount(), tojson(spec));
+        assert.eq(1, t.find({a: null}).hint(spec.name).itcount(), tojson(spec));
+        assert.eq(0, t.find({a: 1000}).hint(spec.name).itcount(), tojson(spec));
+    });
+
+    // The two versions hash differently.
+    var v0 = db.runCommand({_hashBSONElement: 42});
+    var v1 = db.runCommand({_hashBSONElement: 42, hashVersion: 1});
+    assert.commandWorked(v0);
+    assert.commandWorked(v1);
+    assert.eq(NumberLong("-944302157085130861"), v0.out);
+    assert.neq(tojson(v0.out), tojson(v1.out));
+    assert.commandFailed(db.runCommand({_hashBSONElement: 42, hashVersion: 2}));
+}());
@@ -0,0 +1,96 @@
+// The keys of a document for all of a collection's indexes are generated together. Checks that
+// every index, of any kind and over shared paths, gets the same keys as it would on its own.
+(function() {
+    'use strict';
+
+    var coll = db.index_keys_many_indexes;
+    coll.drop();
+
+    var indexes = [
+        {a: 1},
+        {'a.b': 1},
+        {'a.b': 1, c: -1},
+        {'a.c': 1, 'a.b': 1},
+        {c: 1, a: 1},
+        {'d.0': 1},
+        {'d.0.e': 1},
+        {c: 'hashed'},
+        {'e.f': 'hashed'},
+        {e: 1},
+        {f: 1},
+        {loc: '2dsphere'}
+    ];
+    indexes.forEach(function(key) {
+        assert.commandWorked(coll.ensureIndex(key));
+    });
+    assert.commandWorked(coll.ensureIndex({g: 1}, {sparse: true}));
+    assert.commandWorked(coll.ensureIndex({h: 1}, {partialFilterExpression: {c: {$gt: 5}}}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 200; i++) {
+        var doc = {_id: i, c: i % 10};
+        if (i % 2) {
+            doc.a = {b: i % 7, c: 'x' + (i % 3)};
+        }
+        else if (i % 3) {
+            doc.a = [{b: 1}, {b: i % 5, c: 'y'}];
+        }
+        if (i % 4 === 0) {
+            doc.d = [{e: i % 6}, 2];
+        }
+        if (i % 5 === 0) {
+            doc.g = i;
+            doc.h = i;
+        }
+        doc.e = {f: i};
+        doc.f = null;
+        doc.loc = {type: 'Point', coordinates: [i % 90, i % 45]};
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    // Updates and removes take the same path.
+    assert.writeOK(coll.update({c: 3}, {$set: {'a.b': 100}}, {multi: true}));
+    assert.writeOK(coll.remove({c: 4}));
+
+    function check(query, hint) {
+        var expected = coll.find(query).hint({$natural: 1}).sort({_id: 1}).toArray();
+        var actual = coll.find(query).hint(hint).sort({_id: 1}).toArray();
+        assert.eq(expected, actual, tojson(query) + ' ' + tojson(hint));
+    }
+
+    check({a: {b: 3, c: 'x0'}}, {a: 1});
+    check({'a.b': 1}, {'a.b': 1});
+    check({'a.b': 100}, {'a.b': 1, c: -1});
+    check({'a.b': {$gt: 2}, c: {$lt: 5}}, {'a.b': 1, c: -1});
+    check({'a.c': 'y', 'a.b': 2}, {'a.c': 1, 'a.b': 1});
+    check({c: 2, a: {$exists: false}}, {c: 1, a: 1});
+    check({'d.0': {e: 0}}, {'d.0': 1});
+    check({'d.0.e': 2}, {'d.0.e': 1});
+    check({c: 7}, {c: 'hashed'});
+    check({'e.f': 10}, {'e.f': 'hashed'});
+    check({e: {f: 10}}, {e: 1});
+    check({f: null}, {f: 1});
+    check({g: {$gte: 100}}, {g: 1});
+    check({h: {$gte: 0}, c: {$gt: 5}}, {h: 1});
+    check({loc: {$geoWithin: {$centerSphere: [[10, 10], 0.1]}}}, {loc: '2dsphere'});
+
+    // The sparse and partial indexes only hold the documents they should.
+    assert.eq(coll.find({g: {$exists: true}}).count(), coll.find().hint({g: 1}).itcount());
+    assert.eq(coll.find({c: {$gt: 5}, h: {$exists: true}}).count(),
+              coll.find({h: {$gte: 0}, c: {$gt: 5}}).hint({h: 1}).itcount());
+
+    // A document an index can't take isn't inserted at all.
+    assert.writeError(coll.insert({_id: 'parallel', a: [{b: [1, 2]}], c: [1, 2]}));
+    assert.eq(null, coll.findOne({_id: 'parallel'}));
+    assert.writeError(coll.insert({_id: 'array', c: [1, 2]}));
+    assert.eq(null, coll.findOne({_id: 'array'}));
+
+    // Indexes added and dropped later are kept up to date too.
+    assert.commandWorked(coll.dropIndex({'a.b': 1}));
+    assert.commandWorked(coll.ensureIndex({'a.b': 1, e: 1}));
+    assert.writeOK(coll.insert({_id: 'late', a: {b: 1000}, e: 5}));
+    check({'a.b': 1000}, {'a.b': 1, e: 1});
+    check({'a.b': 1000}, {'a.b': 1, c: -1});
+    assert.eq(1, coll.find({e: 5}).hint({e: 1}).itcount());
+}());
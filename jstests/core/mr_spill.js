@@ -0,0 +1,43 @@
+// Map/reduce results which don't fit in memory are spilled, sorted by key, before the final
+// reduce.  Every key must still be reduced into exactly one result.
+(function() {
+    'use strict';
+
+    var coll = db.mr_spill;
+    coll.drop();
+    var out = db.mr_spill_out;
+    out.drop();
+
+    var numKeys = 3000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 4 * numKeys; i++) {
+        // Mix key types, so that grouping relies on the key ordering rather than on equality.
+        var key = (i % numKeys) % 2 ? 'k' + (i % numKeys) : i % numKeys;
+        bulk.insert({key: key, n: 1});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pad = new Array(200).join('x');
+    var map = function() {
+        emit(this.key, {count: this.n, pad: pad});
+    };
+    var reduce = function(key, values) {
+        var result = {count: 0, pad: values[0].pad};
+        values.forEach(function(value) {
+            result.count += value.count;
+        });
+        return result;
+    };
+
+    var res = coll.mapReduce(map, reduce, {out: out.getName(), scope: {pad: pad}});
+    assert.commandWorked(res);
+    assert.eq(4 * numKeys, res.counts.input, tojson(res));
+    assert.eq(numKeys, res.counts.output, tojson(res));
+
+    assert.eq(numKeys, out.count());
+    assert.eq(0, out.find({'value.count': {$ne: 4}}).itcount());
+    assert.eq(1, out.find({_id: 'k1'}).itcount());
+    assert.eq(1, out.find({_id: 0}).itcount());
+
+    out.drop();
+}());
@@ -0,0 +1,62 @@
+// Updates which don't change the size of a document are applied in place, and findAndModify
+// returns the new version of documents updated that way.
+(function() {
+    'use strict';
+
+    var coll = db.update_in_place;
+    coll.drop();
+
+    var pad = new Array(8 * 1024).join('x');
+    assert.writeOK(coll.insert({_id: 0, n: NumberInt(1), c: NumberLong(10), d: new Date(0),
+                                s: 'abc', pad: pad}));
+
+    function updateStage(explain) {
+        var stage = explain.executionStats.executionStages;
+        if ('SINGLE_SHARD' === stage.stage) {
+            stage = stage.shards[0].executionStages;
+        }
+        assert.eq('UPDATE', stage.stage, tojson(explain));
+        return stage;
+    }
+
+    var engine = db.serverStatus().storageEngine;
+    var supportsInPlace = engine && (engine.name == 'mmapv1' || engine.name == 'wiredTiger');
+
+    var updates = [
+        {$inc: {n: NumberInt(1)}},
+        {$inc: {c: NumberLong(5)}},
+        {$set: {s: 'xyz'}},
+        {$currentDate: {d: true}},
+    ];
+    updates.forEach(function(update) {
+        var explain = coll.explain('executionStats').update({_id: 0}, update);
+        if (supportsInPlace) {
+            assert(updateStage(explain).fastmod, tojson(explain));
+        }
+    });
+
+    // Size-changing updates aren't done in place.
+    var explain = coll.explain('executionStats').update({_id: 0}, {$set: {s: 'longer string'}});
+    assert(!updateStage(explain).fastmod, tojson(explain));
+
+    // The new version of the document is returned.
+    var res = coll.findAndModify({query: {_id: 0}, update: {$inc: {n: NumberInt(1)}}, new: true});
+    assert.eq(2, res.n);
+    res = coll.findAndModify({query: {_id: 0}, update: {$inc: {c: NumberLong(5)}}, new: true,
+                              fields: {c: 1}});
+    assert.eq({_id: 0, c: NumberLong(15)}, res);
+    res = coll.findAndModify({query: {_id: 0}, update: {$set: {s: 'xyz'}}});
+    assert.eq('abc', res.s);
+    res = coll.findAndModify({query: {_id: 0}, update: {$currentDate: {d: true}}, new: true});
+    assert.gt(res.d, new Date(0));
+
+    // And so is every write.
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.update({_id: 0}, {$inc: {n: NumberInt(1)}}));
+    }
+    var doc = coll.findOne();
+    assert.eq(22, doc.n);
+    assert.eq(NumberLong(15), doc.c);
+    assert.eq('xyz', doc.s);
+    assert.eq(pad, doc.pad);
+}());
@@ -0,0 +1,62 @@
+// Journal recovery prepares sections and applies writes to different data files on several
+// threads.  The sections must still be applied in order, and processing must still stop at the
+// first corrupt section.
+
+var testname = "dur_recover_parallel";
+var path = MongoRunner.dataPath + testname;
+var numDbs = 4;
+var numDocs = 2000;
+
+function startMongod(params) {
+    return MongoRunner.runMongod({restart: true,
+                                  cleanData: false,
+                                  dbpath: path,
+                                  journal: "",
+                                  smallfiles: "",
+                                  setParameter: params});
+}
+
+jsTest.log("Writing to several databases");
+var conn = MongoRunner.runMongod({dbpath: path, journal: "", smallfiles: "", syncdelay: 0});
+var pad = new Array(500).join("x");
+for (var i = 0; i < numDocs; i++) {
+    for (var d = 0; d < numDbs; d++) {
+        var coll = conn.getDB(testname + d).foo;
+        // Overwrite the same documents repeatedly, so that the order the writes are applied in
+        // matters.
+        assert.writeOK(coll.update({_id: i % 100}, {$set: {n: i, pad: pad}}, {upsert: true}));
+    }
+}
+assert.writeOK(conn.getDB(testname + 0).foo.insert({_id: "last"}, {writeConcern: {j: true}}));
+MongoRunner.stopMongod(conn.port, /*signal*/9);
+
+// Make sure the whole journal is replayed, including recreating a data file.
+removeFile(path + "/lsn");
+removeFile(path + "/" + testname + "1.0");
+
+jsTest.log("Recovering on several threads");
+conn = startMongod("journalRecoveryThreads=8");
+for (var d = 0; d < numDbs; d++) {
+    var coll = conn.getDB(testname + d).foo;
+    assert.eq(100, coll.find({_id: {$lt: 100}}).itcount(), "db " + d);
+    for (var id = 0; id < 100; id++) {
+        assert.eq(numDocs - 100 + id, coll.findOne({_id: id}).n, "db " + d + " _id " + id);
+    }
+}
+assert.eq(1, conn.getDB(testname + 0).foo.find({_id: "last"}).itcount());
+MongoRunner.stopMongod(conn);
+
+// The checksum journals, see checksum.js.
+[["dur_checksum_good.journal", 2],
+ ["dur_checksum_bad_last.journal", 1],
+ ["dur_checksum_bad_first.journal", 0]].forEach(function(test) {
+    jsTest.log("Recovering " + test[0] + " on several threads");
+    resetDbpath(path);
+    mkdir(path + "/journal");
+    copyFile("jstests/libs/" + test[0], path + "/journal/j._0");
+    conn = startMongod("journalRecoveryThreads=4");
+    assert.eq(test[1], conn.getDB("test").foo.count(), test[0]);
+    MongoRunner.stopMongod(conn);
+});
+
+jsTest.log("SUCCESS recover_parallel.js");
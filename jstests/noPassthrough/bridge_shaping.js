@@ -0,0 +1,71 @@
+// mongobridge holds back requests and replies by the configured delay, jitter and bandwidth
+// limit, and the configureBridge command changes these while the bridge runs.
+(function() {
+    'use strict';
+
+    var ports = allocatePorts(2);
+    var mongod = MongoRunner.runMongod({port: ports[0]});
+    assert.neq(null, mongod, "mongod failed to start");
+
+    var bridgePid = startMongoProgramNoConnect("mongobridge",
+                                               "--port", ports[1],
+                                               "--dest", "localhost:" + ports[0],
+                                               "--delay", 100);
+    var conn;
+    assert.soon(function() {
+        try {
+            conn = new Mongo("localhost:" + ports[1]);
+            return true;
+        }
+        catch (e) {
+            return false;
+        }
+    }, "could not connect to mongobridge");
+    var db = conn.getDB("admin");
+
+    function pingMillis() {
+        var start = new Date();
+        assert.commandWorked(db.runCommand({ping: 1}));
+        return new Date() - start;
+    }
+
+    function configure(shaping) {
+        return db.runCommand(Object.extend({configureBridge: 1}, shaping));
+    }
+
+    // The command line sets up the initial shaping, and it is reported back.
+    var res = assert.commandWorked(configure({}));
+    assert.eq({delay: 100, jitter: 0, bytesPerSec: 0}, res.requests, tojson(res));
+    assert.eq({delay: 0, jitter: 0, bytesPerSec: 0}, res.replies, tojson(res));
+    assert.gte(pingMillis(), 100);
+
+    // Each direction is delayed separately, and fields left out are kept.
+    res = assert.commandWorked(configure({replies: {delay: 200}}));
+    assert.eq(100, res.requests.delay, tojson(res));
+    assert.gte(pingMillis(), 300);
+
+    res = assert.commandWorked(configure({requests: {delay: 0}, replies: {delay: 0, jitter: 50}}));
+    assert.eq({delay: 0, jitter: 50, bytesPerSec: 0}, res.replies, tojson(res));
+    assert.lt(pingMillis(), 1000);
+
+    // Replies are held back for as long as they take to send at the bandwidth limit.
+    assert.commandWorked(configure({replies: {jitter: 0}}));
+    var coll = conn.getDB("test").bridge_shaping;
+    var pad = new Array(100 * 1024).join("x");
+    assert.writeOK(coll.insert({pad: pad}));
+    assert.commandWorked(configure({replies: {bytesPerSec: 200 * 1024}}));
+    var start = new Date();
+    assert.eq(pad, coll.findOne().pad);
+    assert.gte(new Date() - start, 400);
+
+    // Bad settings are rejected and change nothing.
+    assert.commandFailed(configure({requests: {delay: -1}}));
+    assert.commandFailed(configure({requests: {delay: "a"}}));
+    assert.commandFailed(configure({requests: {latency: 5}}));
+    assert.commandFailed(configure({sideways: {delay: 5}}));
+    res = assert.commandWorked(configure({}));
+    assert.eq({delay: 0, jitter: 0, bytesPerSec: 200 * 1024}, res.replies, tojson(res));
+
+    stopMongoProgramByPid(bridgePid);
+    MongoRunner.stopMongod(mongod);
+}());
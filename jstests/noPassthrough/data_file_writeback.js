@@ -0,0 +1,35 @@
+// With dataFileWritebackMBPerSecond set, mmapv1 writes the data files back a little at a time in
+// between the syncdelay flushes, and reports how far it got in serverStatus.backgroundFlushing.
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({smallfiles: "",
+                                       setParameter: "dataFileWritebackMBPerSecond=1000"});
+    var testDB = mongo.getDB('test');
+    var serverStatus = assert.commandWorked(testDB.serverStatus());
+    if (serverStatus.storageEngine.name != 'mmapv1') {
+        MongoRunner.stopMongod(mongo);
+        return;
+    }
+
+    for (var i = 0; i < 1000; i++) {
+        assert.writeOK(testDB.data.insert({_id: i, s: new Array(1000).join('x')}));
+    }
+
+    assert.soon(function() {
+        var writeback = testDB.serverStatus().backgroundFlushing.writeback;
+        return writeback && writeback.passes > 0 && writeback.MB > 0;
+    }, 'no writeback pass completed: ' + tojson(testDB.serverStatus().backgroundFlushing));
+
+    var writeback = testDB.serverStatus().backgroundFlushing.writeback;
+    assert.eq(1000, writeback.MBPerSecond, tojson(writeback));
+    assert.gte(writeback.last_pass_ms, 0, tojson(writeback));
+
+    // It stops when the rate is set back to 0, and the syncdelay flushes go on.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, dataFileWritebackMBPerSecond: 0}));
+    var mb = testDB.serverStatus().backgroundFlushing.writeback.MB;
+    sleep(500);
+    assert.eq(mb, testDB.serverStatus().backgroundFlushing.writeback.MB);
+
+    MongoRunner.stopMongod(mongo);
+}());
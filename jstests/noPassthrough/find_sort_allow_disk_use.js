@@ -0,0 +1,45 @@
+// Checks that a blocking sort in find spills to disk when allowDiskUse is given, instead of
+// failing once it exceeds its memory limit.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({setParameter: "internalQueryExecMaxBlockingSortBytes=65536"});
+    var coll = mongo.getDB('test').find_sort_allow_disk_use;
+
+    var padding = new Array(100).join('x');
+    for (var i = 0; i < 2000; i++) {
+        assert.writeOK(coll.insert({a: (i * 7) % 2000, padding: padding}));
+    }
+
+    // Without allowDiskUse, the sort runs out of memory.
+    assert.throws(function() {
+        coll.find().sort({a: 1}).itcount();
+    });
+
+    function checkSorted(cursor, expectedCount) {
+        var count = 0;
+        var last = -1;
+        cursor.forEach(function(doc) {
+            assert.gt(doc.a, last, tojson(doc));
+            assert.eq(padding, doc.padding);
+            last = doc.a;
+            count++;
+        });
+        assert.eq(expectedCount, count);
+    }
+
+    checkSorted(coll.find().sort({a: 1}).allowDiskUse(), 2000);
+
+    // A limit keeps only the top results, but they may still not fit in memory.
+    checkSorted(coll.find().sort({a: 1}).limit(1500).allowDiskUse(), 1500);
+
+    var explain = coll.find().sort({a: 1}).allowDiskUse().explain('executionStats');
+    var stage = explain.executionStats.executionStages;
+    while (stage.stage != 'SORT') {
+        stage = stage.inputStage;
+    }
+    assert(stage.usedDisk, tojson(explain));
+
+    MongoRunner.stopMongod(mongo);
+}());
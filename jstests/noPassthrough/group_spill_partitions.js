@@ -0,0 +1,46 @@
+// Checks that $group produces the same results whether it spills to disk by hash partition or by
+// sorting the whole table (internalDocumentSourceGroupSpillPartitions=0).
+
+(function() {
+    'use strict';
+
+    var bigStr = Array(1024*1024 + 1).toString(); // 1MB of ','
+
+    function runGroup(spillPartitions) {
+        var mongo = MongoRunner.runMongod({
+            setParameter: "internalDocumentSourceGroupSpillPartitions=" + spillPartitions
+        });
+        var coll = mongo.getDB('test').group_spill_partitions;
+
+        // More than the 100MB $group memory limit, spread across groups that each get several
+        // documents so that partial groups have to be merged after spilling.
+        for (var i = 0; i < 120; i++) {
+            assert.writeOK(coll.insert({_id: i, bigStr: i + bigStr}));
+        }
+
+        var pipeline = [{$group: {_id: {$mod: ['$_id', 24]},
+                                  count: {$sum: 1},
+                                  total: {$sum: '$_id'},
+                                  ids: {$push: '$_id'},
+                                  big: {$max: '$bigStr'}}},
+                        {$project: {count: 1, total: 1, ids: 1, bigPrefix: {$substr: ['$big', 0, 4]}}},
+                        {$sort: {_id: 1}}];
+
+        var res = coll.runCommand('aggregate', {pipeline: pipeline});
+        assert.commandFailedWithCode(res, 16945);
+
+        var results = coll.aggregate(pipeline, {allowDiskUse: true}).toArray();
+        MongoRunner.stopMongod(mongo);
+        return results;
+    }
+
+    var partitioned = runGroup(4);
+    assert.eq(24, partitioned.length, tojson(partitioned));
+    partitioned.forEach(function(group) {
+        assert.eq(5, group.count, tojson(group));
+        assert.eq(5 * group._id + 24 * 10, group.total, tojson(group));
+        assert.eq(5, group.ids.length, tojson(group));
+    });
+
+    assert.eq(runGroup(0), partitioned);
+}());
@@ -0,0 +1,44 @@
+// Tests that point reads by _id are served from the _id lookup cache once it is enabled, and that
+// writes are never hidden by it.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({setParameter: "idHackCacheSizeBytes=1048576"});
+    assert.neq(null, conn, "mongod failed to start");
+    var coll = conn.getDB("test").idhack_cache;
+
+    function cacheStats() {
+        return conn.getDB("admin").serverStatus().metrics.query.idHackCache;
+    }
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i}));
+    }
+
+    // The first read of a document misses, the next ones hit.
+    var before = cacheStats();
+    assert.eq({_id: 1, a: 1}, coll.findOne({_id: 1}));
+    assert.eq({_id: 1, a: 1}, coll.findOne({_id: 1}));
+    assert.eq({_id: 1, a: 1}, coll.findOne({_id: 1}));
+    var stats = cacheStats();
+    assert.gte(stats.misses, before.misses + 1, tojson(stats));
+    assert.gte(stats.hits, before.hits + 2, tojson(stats));
+    assert.gt(stats.bytes, 0, tojson(stats));
+
+    // Updates, in place or not, and removes are seen right away.
+    assert.writeOK(coll.update({_id: 1}, {$inc: {a: 1}}));
+    assert.eq({_id: 1, a: 2}, coll.findOne({_id: 1}));
+    assert.writeOK(coll.update({_id: 1}, {$set: {b: new Array(1000).join("x")}}));
+    assert.eq(2, coll.findOne({_id: 1}).a);
+    assert.eq(999, coll.findOne({_id: 1}).b.length);
+    assert.writeOK(coll.remove({_id: 1}));
+    assert.eq(null, coll.findOne({_id: 1}));
+    assert.writeOK(coll.insert({_id: 1, a: 10}));
+    assert.eq({_id: 1, a: 10}, coll.findOne({_id: 1}));
+    assert.gt(cacheStats().invalidations, stats.invalidations, tojson(cacheStats()));
+
+    // Projections are applied to cached documents.
+    assert.eq({a: 10}, coll.findOne({_id: 1}, {_id: 0, a: 1}));
+
+    MongoRunner.stopMongod(conn);
+}());
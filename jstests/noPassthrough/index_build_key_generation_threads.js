@@ -0,0 +1,62 @@
+// Checks that foreground index builds give the same results whether keys are generated on the
+// building thread or on separate key generation threads.
+
+(function() {
+    'use strict';
+
+    function runTest(numThreads) {
+        var mongo = MongoRunner.runMongod(
+            {setParameter: "maxIndexBuildKeyGenerationThreads=" + numThreads});
+        var coll = mongo.getDB('test').key_generation_threads;
+
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 5000; i++) {
+            bulk.insert({_id: i, a: i % 100, b: [i, -i], c: {d: 'x' + i}, e: (i % 2 == 0)});
+        }
+        assert.writeOK(bulk.execute());
+
+        assert.commandWorked(coll.runCommand('createIndexes', {
+            indexes: [
+                {key: {a: 1}, name: 'a_1'},
+                {key: {b: 1}, name: 'b_1'},
+                {key: {'c.d': 1}, name: 'c.d_1', unique: true},
+                {key: {a: 1, 'c.d': -1}, name: 'a_1_c.d_-1'},
+                {key: {a: 1}, name: 'a_1_partial', filter: {e: true}}
+            ]
+        }));
+
+        var res = coll.validate(true);
+        assert(res.valid, tojson(res));
+        var keys = res.keysPerIndex;
+        var prefix = coll.getFullName() + '.$';
+        assert.eq(5000, keys[prefix + 'a_1'], tojson(res));
+        assert.eq(9999, keys[prefix + 'b_1'], tojson(res));  // 0 and -0 are the same key.
+        assert.eq(5000, keys[prefix + 'c.d_1'], tojson(res));
+        assert.eq(5000, keys[prefix + 'a_1_c.d_-1'], tojson(res));
+        assert.eq(2500, keys[prefix + 'a_1_partial'], tojson(res));
+
+        assert.eq(50, coll.find({a: 7}).hint('a_1').itcount());
+        assert.eq(1, coll.find({b: -42}).hint('b_1').itcount());
+        assert.eq(1, coll.find({'c.d': 'x1234'}).hint('c.d_1').itcount());
+        assert.eq(50, coll.find({a: 8}).hint('a_1_c.d_-1').itcount());
+
+        // Errors from key generation and duplicate keys fail the whole build.
+        assert.writeOK(coll.insert({_id: 'parallel', f: [1, 2], g: [3, 4]}));
+        assert.commandFailedWithCode(
+            coll.runCommand('createIndexes', {indexes: [{key: {f: 1, g: 1}, name: 'f_1_g_1'},
+                                                        {key: {a: 1, b: 1}, name: 'a_1_b_1'}]}),
+            10088);
+        assert.writeOK(coll.insert([{_id: 'dup1', h: 1}, {_id: 'dup2', h: 1}]));
+        assert.commandFailedWithCode(
+            coll.runCommand('createIndexes', {indexes: [{key: {a: -1}, name: 'a_-1'},
+                                                        {key: {h: 1}, name: 'h_1', unique: true}]}),
+            11000);
+        assert.eq(6, coll.getIndexes().length);
+
+        MongoRunner.stopMongod(mongo);
+    }
+
+    runTest(0);
+    runTest(1);
+    runTest(4);
+}());
@@ -0,0 +1,52 @@
+// Checks the latency histograms reported by db.serverStatus({latencyHistograms: 1}) and by
+// {top: 1, latencyHistograms: true}.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({});
+    var testDB = mongo.getDB('test');
+    var coll = testDB.latency;
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({i: i}));
+    }
+    assert.eq(20, coll.find().itcount());
+    assert.eq(20, coll.count());
+
+    function checkHistogram(histogram, minCount) {
+        assert(histogram, 'missing histogram');
+        assert.gte(histogram.count, minCount, tojson(histogram));
+        assert.lte(histogram.p50Micros, histogram.p99Micros, tojson(histogram));
+        assert.lte(histogram.p99Micros, histogram.p999Micros, tojson(histogram));
+
+        var bucketTotal = 0;
+        histogram.buckets.forEach(function(bucket) {
+            bucketTotal += bucket.count;
+        });
+        assert.eq(histogram.count, bucketTotal, tojson(histogram));
+    }
+
+    var serverStatus = assert.commandWorked(testDB.serverStatus());
+    assert(!serverStatus.hasOwnProperty('latencyHistograms'),
+           'latencyHistograms should not be reported by default');
+
+    var histograms = assert.commandWorked(testDB.serverStatus({latencyHistograms: 1}))
+                         .latencyHistograms;
+    checkHistogram(histograms.ops.insert, 20);
+    checkHistogram(histograms.ops.query, 1);
+    checkHistogram(histograms.ops.command, 1);
+    checkHistogram(histograms.commands.count, 1);
+    assert(!histograms.commands.hasOwnProperty('eval'), tojson(histograms.commands));
+
+    var top = assert.commandWorked(mongo.getDB('admin').runCommand({top: 1}));
+    assert(!top.hasOwnProperty('latencyHistograms'), tojson(top));
+
+    top = assert.commandWorked(mongo.getDB('admin').runCommand({top: 1, latencyHistograms: true}));
+    var collHistograms = top.latencyHistograms[coll.getFullName()];
+    assert(collHistograms, tojson(top.latencyHistograms));
+    checkHistogram(collHistograms.insert, 20);
+    checkHistogram(collHistograms.queries, 1);
+
+    MongoRunner.stopMongod(mongo);
+}());
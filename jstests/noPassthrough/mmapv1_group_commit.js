@@ -0,0 +1,47 @@
+// Checks that j:true writes are group committed and that the flush thread reports its group
+// commit statistics in db.serverStatus().dur.groupCommit.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({storageEngine: 'mmapv1',
+                                       journal: '',
+                                       setParameter: 'journalGroupCommitWindowMicros=1000'});
+    var testDB = mongo.getDB('test');
+
+    var dur = assert.commandWorked(testDB.serverStatus()).dur;
+    if (!dur) {
+        // Not running mmapv1 with journaling.
+        MongoRunner.stopMongod(mongo);
+        return;
+    }
+
+    // A j:true acknowledgement must not have to wait for the full commit interval.
+    var start = new Date();
+    for (var i = 0; i < 50; i++) {
+        assert.writeOK(testDB.gc.insert({i: i}, {writeConcern: {j: true}}));
+    }
+    var elapsed = new Date() - start;
+    assert.lt(elapsed, 50 * 100, 'j:true inserts took ' + elapsed + 'ms');
+
+    // Concurrent waiters share commits.
+    var awaitShell = startParallelShell(
+        'for (var i = 0; i < 100; i++) {' +
+        '    assert.writeOK(db.gc.insert({p: i}, {writeConcern: {j: true}}));' +
+        '}', mongo.port);
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(testDB.gc.insert({q: i}, {writeConcern: {j: true}}));
+    }
+    awaitShell();
+    assert.eq(250, testDB.gc.count());
+
+    var groupCommit = assert.commandWorked(testDB.serverStatus()).dur.groupCommit;
+    assert(groupCommit, 'missing groupCommit statistics');
+    assert.gt(groupCommit.waitersPerCommit.count, 0, tojson(groupCommit));
+    assert.gte(groupCommit.waitersPerCommit.total, 250, tojson(groupCommit));
+    assert.gt(groupCommit.bytesPerCommit.count, 0, tojson(groupCommit));
+    assert.gt(groupCommit.journalWriteLatency.count, 0, tojson(groupCommit));
+    assert.lte(groupCommit.windowMicros, 1000, tojson(groupCommit));
+
+    MongoRunner.stopMongod(mongo);
+}());
@@ -0,0 +1,48 @@
+// Checks that members of a replica set negotiate wire protocol compression with each other when
+// it is enabled, and that they report how much they compressed in db.serverStatus().network.
+
+(function() {
+    'use strict';
+
+    var rst = new ReplSetTest({
+        name: 'network_compression',
+        nodes: 2,
+        nodeOptions: {setParameter: 'networkMessageCompressors=snappy'}
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var coll = primary.getDB('test').compression;
+
+    // Large, repetitive documents so that the oplog batches are worth compressing.
+    var padding = new Array(1024).join('x');
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, padding: padding}));
+    }
+    rst.awaitReplication();
+
+    rst.nodes.forEach(function(node) {
+        var network = assert.commandWorked(node.adminCommand({serverStatus: 1})).network;
+        assert(network.compression && network.compression.snappy, tojson(network));
+    });
+
+    // The secondary fetched the oplog compressed, so it decompressed at least what it inserted.
+    var secondary = rst.getSecondary();
+    var snappy = assert.commandWorked(secondary.adminCommand({serverStatus: 1}))
+                     .network.compression.snappy;
+    assert.gt(snappy.decompressor.bytesOut, 100 * padding.length, tojson(snappy));
+    assert.lt(snappy.decompressor.bytesIn, snappy.decompressor.bytesOut, tojson(snappy));
+
+    // The shell didn't ask for compression, so isMaster doesn't offer it.
+    var res = assert.commandWorked(primary.adminCommand({isMaster: 1}));
+    assert(!res.hasOwnProperty('compression'), tojson(res));
+
+    res = assert.commandWorked(primary.adminCommand({isMaster: 1, compression: ['bogus']}));
+    assert(!res.hasOwnProperty('compression'), tojson(res));
+
+    rst.stopSet();
+
+    // Unknown compressors are rejected.
+    assert.isnull(MongoRunner.runMongod({setParameter: 'networkMessageCompressors=bogus'}));
+}());
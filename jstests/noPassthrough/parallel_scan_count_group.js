@@ -0,0 +1,59 @@
+// Checks that count and $group give the same answers when a collection scan is split across
+// several threads (internalQueryParallelScanThreads) as when it runs on one.
+
+(function() {
+    'use strict';
+
+    // Only mmapv1 record stores split into several partitions, one per extent.
+    var mongo = MongoRunner.runMongod({storageEngine: 'mmapv1'});
+    if (!mongo) {
+        return;
+    }
+    var testDB = mongo.getDB('test');
+    var coll = testDB.parallel_scan_count_group;
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 20000; i++) {
+        bulk.insert({a: i % 7, b: i, s: new Array(i % 100).join('x')});
+    }
+    assert.writeOK(bulk.execute());
+
+    var pipelines = [
+        [{$group: {_id: '$a', n: {$sum: 1}, avg: {$avg: '$b'}, max: {$max: '$b'}}},
+         {$sort: {_id: 1}}],
+        [{$match: {b: {$gte: 5000}}},
+         {$group: {_id: null, n: {$sum: 1}, first: {$min: '$b'}, set: {$addToSet: '$a'}}}],
+    ];
+
+    function runAll() {
+        return {
+            countAll: coll.find({b: {$exists: true}}).count(),
+            countSome: coll.find({a: 3}).count(),
+            countSkipLimit: coll.find({a: {$lt: 4}}).skip(10).limit(100).count(true),
+            groups: pipelines.map(function(pipeline) {
+                var results = coll.aggregate(pipeline).toArray();
+                results.forEach(function(doc) {
+                    if (doc.set) {
+                        doc.set.sort();
+                    }
+                });
+                return results;
+            }),
+        };
+    }
+
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, internalQueryParallelScanThreads: 0}));
+    var serial = runAll();
+
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, internalQueryParallelScanThreads: 4}));
+    var parallel = runAll();
+
+    assert.eq(20000, serial.countAll);
+    assert.eq(100, serial.countSkipLimit);
+    assert.eq(serial, parallel);
+
+    // $where cannot be evaluated by several threads, so it falls back to a single one.
+    assert.eq(serial.countSome, coll.find({$where: 'this.a == 3'}).count());
+
+    MongoRunner.stopMongod(mongo);
+}());
@@ -0,0 +1,46 @@
+// Checks that with internalQueryCacheBackgroundReplan a degraded cached plan is replanned by the
+// background replanner, and that db.serverStatus({planCache: 1}) reports per-collection stats.
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({setParameter: "internalQueryCacheBackgroundReplan=true"});
+    var testDB = mongo.getDB('test');
+    var coll = testDB.plan_cache_background_replan;
+
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+
+    // The {b: 1} index is selective for b: 1, but every document in the second batch has b: 2.
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({a: 1, b: i + 10});
+        bulk.insert({a: i + 10, b: 2});
+    }
+    bulk.insert({a: 1, b: 1});
+    assert.writeOK(bulk.execute());
+
+    // Caches the {b: 1} plan after a short trial.
+    assert.eq(1, coll.find({a: 1, b: 1}).itcount());
+
+    // The cached plan now has to scan 1000 index keys, far more than it was cached with. The query
+    // still returns the right answer while the entry is replanned in the background.
+    assert.eq(1, coll.find({a: 10, b: 2}).itcount());
+
+    assert.soon(function() {
+        var status = assert.commandWorked(testDB.serverStatus({planCache: 1}));
+        var stats = status.planCache[coll.getFullName()];
+        return stats && stats.backgroundReplans >= 1;
+    }, 'background replan was not reported');
+
+    var status = assert.commandWorked(testDB.serverStatus({planCache: 1}));
+    var stats = status.planCache[coll.getFullName()];
+    assert.gte(stats.hits, 1, tojson(stats));
+    assert.gte(stats.misses, 1, tojson(stats));
+    assert.eq(0, stats.replans, tojson(stats));
+
+    // The section is only reported on request.
+    assert(!testDB.serverStatus().hasOwnProperty('planCache'));
+
+    MongoRunner.stopMongod(mongo);
+}());
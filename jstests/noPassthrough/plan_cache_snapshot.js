@@ -0,0 +1,71 @@
+// With planCacheSnapshotIntervalSecs set, the plan cache entries of every collection are saved to
+// admin.system.plancache, and restored when the server restarts so long as the indexes their plans
+// use still exist.
+(function() {
+    "use strict";
+
+    var runner = MongoRunner.runMongod({setParameter: {planCacheSnapshotIntervalSecs: 1}});
+    var testDB = runner.getDB("test");
+    var coll = testDB.plan_cache_snapshot;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 200; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i % 20, c: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    assert.commandWorked(coll.ensureIndex({c: 1}));
+
+    // Each of these has several candidate plans, and is cached.
+    assert.eq(1, coll.find({a: 1, b: 1, c: {$lt: 100}}).itcount());
+    assert.eq(10, coll.find({a: 2, b: {$gt: 0}}).sort({c: 1}).itcount());
+
+    function queryShapes(db) {
+        var res = assert.commandWorked(db.runCommand({planCacheListQueryShapes: coll.getName()}));
+        return res.shapes.map(function(shape) {
+            return tojson(shape);
+        }).sort();
+    }
+    var shapes = queryShapes(testDB);
+    assert.eq(2, shapes.length, tojson(shapes));
+
+    var snapshots = runner.getDB("admin").system.plancache;
+    assert.soon(function() {
+        var doc = snapshots.findOne({_id: coll.getFullName()});
+        return doc && doc.entries.length == 2;
+    }, "plan cache not saved");
+
+    MongoRunner.stopMongod(runner);
+    runner = MongoRunner.runMongod({restart: true, cleanData: false, dbpath: runner.dbpath,
+                                    setParameter: {planCacheSnapshotIntervalSecs: 1}});
+    testDB = runner.getDB("test");
+    assert.soon(function() {
+        return queryShapes(testDB).length == 2;
+    }, "plan cache not restored");
+    assert.eq(shapes, queryShapes(testDB));
+
+    var res = assert.commandWorked(testDB.runCommand({planCacheListPlans: coll.getName(),
+                                                      query: {a: 1, b: 1, c: {$lt: 100}}}));
+    assert.gt(res.plans.length, 0, tojson(res));
+    assert.eq(1, testDB[coll.getName()].find({a: 1, b: 1, c: {$lt: 100}}).itcount());
+
+    // Entries whose plans use a dropped index are not restored.
+    assert.commandWorked(testDB[coll.getName()].dropIndex({a: 1}));
+    assert.commandWorked(testDB[coll.getName()].dropIndex({b: 1}));
+    assert.commandWorked(testDB[coll.getName()].dropIndex({c: 1}));
+    MongoRunner.stopMongod(runner);
+    runner = MongoRunner.runMongod({restart: true, cleanData: false, dbpath: runner.dbpath,
+                                    setParameter: {planCacheSnapshotIntervalSecs: 1}});
+    testDB = runner.getDB("test");
+    assert.soon(function() {
+        var log = assert.commandWorked(runner.adminCommand({getLog: "global"})).log;
+        return log.some(function(line) {
+            return /restored 0 of 2 plan cache entries/.test(line);
+        });
+    }, "plan cache snapshot not read");
+    assert.eq(0, queryShapes(testDB).length);
+
+    MongoRunner.stopMongod(runner);
+}());
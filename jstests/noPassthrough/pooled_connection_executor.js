@@ -0,0 +1,44 @@
+// Checks that mongod can service connections with the pooled connection executor and that it
+// reports its state in db.serverStatus().
+
+(function() {
+    'use strict';
+
+    var mongo = MongoRunner.runMongod({setParameter: "connectionExecutor=pooled"});
+    var testDB = mongo.getDB('test');
+
+    var serverStatus = assert.commandWorked(testDB.serverStatus());
+    assert(serverStatus.connectionExecutor,
+           'db.serverStatus() result must contain connectionExecutor document: ' +
+           tojson(serverStatus));
+
+    if (serverStatus.connectionExecutor.mode != 'pooled') {
+        // Not supported on this platform or with this configuration.
+        MongoRunner.stopMongod(mongo);
+        return;
+    }
+
+    // Use several connections so that operations are spread across the workers.
+    var conns = [];
+    for (var i = 0; i < 10; i++) {
+        conns.push(new Mongo(mongo.host));
+    }
+    conns.forEach(function(conn, i) {
+        var coll = conn.getDB('test').pooled;
+        for (var j = 0; j < 20; j++) {
+            assert.writeOK(coll.insert({conn: i, j: j}));
+        }
+    });
+    assert.eq(200, testDB.pooled.find().itcount());
+
+    serverStatus = assert.commandWorked(testDB.serverStatus());
+    var stats = serverStatus.connectionExecutor;
+    assert.gte(stats.workers, 1, tojson(stats));
+    assert.gte(stats.totalDispatched, 200, tojson(stats));
+    assert(stats.hasOwnProperty('queueDepth'), tojson(stats));
+
+    MongoRunner.stopMongod(mongo);
+
+    // Unknown executors are rejected.
+    assert.isnull(MongoRunner.runMongod({setParameter: "connectionExecutor=bogus"}));
+}());
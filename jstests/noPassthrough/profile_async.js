@@ -0,0 +1,40 @@
+// Tests that with profilerWriteAsync, profile entries are still written to system.profile, by a
+// background thread, and that entries which don't fit in the queue are counted as dropped.
+(function() {
+    "use strict";
+
+    var runner = MongoRunner.runMongod({setParameter: {profilerWriteAsync: true}});
+    var testDB = runner.getDB("test");
+    var coll = testDB.profile_async;
+    coll.drop();
+    testDB.system.profile.drop();
+
+    function profilerMetrics() {
+        return testDB.serverStatus().metrics.profiler;
+    }
+    var before = profilerMetrics();
+
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    for (var i = 0; i < 50; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+        assert.eq(1, coll.find({_id: i}).itcount());
+    }
+    assert.commandWorked(testDB.setProfilingLevel(0));
+
+    assert.soon(function() {
+        return testDB.system.profile.find({ns: coll.getFullName(), op: "query"}).itcount() == 50;
+    }, "profile entries weren't written: " + tojson(profilerMetrics()));
+
+    var after = profilerMetrics();
+    assert.gte(after.queued - before.queued, 100, tojson(after));
+    assert.eq(after.dropped, before.dropped, tojson(after));
+
+    // With no room in the queue, entries are dropped instead of written.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, profilerQueueMaxEntries: 0}));
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    assert.eq(1, coll.find({_id: 0}).itcount());
+    assert.commandWorked(testDB.setProfilingLevel(0));
+    assert.gt(profilerMetrics().dropped, after.dropped, tojson(profilerMetrics()));
+
+    MongoRunner.stopMongod(runner);
+}());
@@ -0,0 +1,58 @@
+/**
+ * This test is only for the WiredTiger storageEngine, whose indexes can be sampled.
+ * splitVector estimates the split points of large chunks from random index entries instead of
+ * walking the index. The chunks it picks must still be close to the requested size.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to start");
+    var db = conn.getDB("test");
+    var coll = db.splitvector_sampling;
+
+    var numDocs = 200 * 1000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; i++) {
+        bulk.insert({x: i, pad: "abcdefghijklmnopqrstuvwxyz"});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({x: 1}));
+
+    // Split keys are placed every chunkSize / 2 bytes.
+    var chunkSize = coll.stats().size / 5;
+    function splitVector() {
+        return assert.commandWorked(db.runCommand({splitVector: coll.getFullName(),
+                                                   keyPattern: {x: 1},
+                                                   maxChunkSizeBytes: chunkSize}));
+    }
+
+    var res = splitVector();
+    assert(res.sampled, tojson(res));
+    var keys = res.splitKeys;
+    assert.gte(keys.length, 7, tojson(res));
+    assert.lte(keys.length, 11, tojson(res));
+
+    // Each chunk holds about a tenth of the documents.
+    var bounds = [-1].concat(keys.map(function(key) { return key.x; }));
+    for (var i = 1; i < bounds.length; i++) {
+        var count = bounds[i] - bounds[i - 1];
+        assert.gt(count, numDocs / 10 * 0.6, tojson(keys));
+        assert.lt(count, numDocs / 10 * 1.4, tojson(keys));
+    }
+
+    // Turning sampling off walks the index.
+    assert.commandWorked(db.adminCommand({setParameter: 1, splitVectorSamplesPerChunk: 0}));
+    res = splitVector();
+    assert(!res.sampled, tojson(res));
+    assert.eq(9, res.splitKeys.length, tojson(res));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,53 @@
+// Tests that the TTL monitor removes expired documents in batches of ttlMonitorBatchSize, from
+// several collections at once with ttlMonitorThreads, and reports per-index progress in
+// db.serverStatus({ttlIndexes: 1}).
+(function() {
+    "use strict";
+
+    var runner = MongoRunner.runMongod({setParameter: {ttlMonitorSleepSecs: 1,
+                                                       ttlMonitorThreads: 2,
+                                                       ttlMonitorBatchSize: 10}});
+    var testDB = runner.getDB("test");
+
+    var past = new Date(new Date().getTime() - 60 * 60 * 1000);
+    var future = new Date(new Date().getTime() + 60 * 60 * 1000);
+    var colls = [testDB.ttl_batched_a, testDB.ttl_batched_b];
+    colls.forEach(function(coll) {
+        coll.drop();
+        for (var i = 0; i < 95; i++) {
+            assert.writeOK(coll.insert({x: new Date(past.getTime() + i * 1000)}));
+        }
+        assert.writeOK(coll.insert({x: future}));
+        assert.commandWorked(coll.ensureIndex({x: 1}, {expireAfterSeconds: 0}));
+    });
+
+    assert.soon(function() {
+                    return colls.every(function(coll) { return coll.count() == 1; });
+                },
+                "TTL monitor didn't remove the expired documents before timing out.");
+    colls.forEach(function(coll) {
+        assert.eq(1, coll.find({x: future}).itcount());
+    });
+
+    // Later passes find nothing left to delete, in a single batch.
+    var stats = assert.commandWorked(testDB.serverStatus({ttlIndexes: 1})).ttlIndexes;
+    colls.forEach(function(coll) {
+        var indexStats = stats[coll.getFullName() + ".$x_1"];
+        assert(indexStats, tojson(stats));
+        assert(indexStats.caughtUp, tojson(indexStats));
+        assert.gte(indexStats.batchesLastPass, 1, tojson(indexStats));
+    });
+    assert.gte(testDB.serverStatus().metrics.ttl.deletedDocuments, 190);
+
+    // A rate limit slows deletion down, and can be changed at runtime.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1,
+                                              ttlMonitorMaxDeletesPerSecond: 20}));
+    var coll = colls[0];
+    for (var i = 0; i < 40; i++) {
+        assert.writeOK(coll.insert({x: past}));
+    }
+    assert.soon(function() { return coll.count() == 1; },
+                "TTL monitor didn't remove the expired documents with a rate limit.");
+
+    MongoRunner.stopMongod(runner);
+})();
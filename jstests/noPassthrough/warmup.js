@@ -0,0 +1,54 @@
+// Tests that the warmup command reads a collection's documents and indexes in the background,
+// reporting progress in currentOp and at most warmupMaxMBPerSecond, and that a warmup is started
+// at startup for the collections in warmupNamespaces.
+(function() {
+    "use strict";
+
+    var runner = MongoRunner.runMongod({setParameter: {warmupThreads: 2,
+                                                       warmupMaxMBPerSecond: 1}});
+    var testDB = runner.getDB("test");
+    var coll = testDB.warmup;
+    coll.drop();
+
+    var pad = new Array(1024).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; i++) {
+        bulk.insert({_id: i, a: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: -1}));
+
+    assert.commandFailed(testDB.runCommand({warmup: coll.getName()}));
+    assert.commandFailed(testDB.runCommand({warmup: coll.getName(), index: [1]}));
+
+    // About 5MB of documents, read at 1MB per second, take a few seconds.
+    assert.commandWorked(testDB.runCommand({warmup: coll.getName(), data: true, index: true}));
+    var res = testDB.runCommand({warmup: coll.getName(), index: ["a_-1"]});
+    assert.commandFailedWithCode(res, 117 /* ConflictingOperationInProgress */);
+
+    assert.soon(function() {
+        return testDB.currentOp({msg: /^Warmup: test.warmup/}).inprog.length > 0;
+    }, "warmup not shown in currentOp");
+
+    // Lift the limit so that the warmup finishes.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, warmupMaxMBPerSecond: 0}));
+    assert.soon(function() {
+        return testDB.currentOp({msg: /^Warmup:/}).inprog.length == 0 &&
+               testDB.runCommand({warmup: coll.getName(), index: ["a_-1"]}).ok;
+    }, "warmup didn't finish");
+
+    MongoRunner.stopMongod(runner);
+
+    // A bad warmupNamespaces keeps the server from starting.
+    assert.eq(null, MongoRunner.runMongod({setParameter: {warmupNamespaces: "test."}}));
+
+    runner = MongoRunner.runMongod({restart: true, cleanData: false, dbpath: runner.dbpath,
+                                    setParameter: {warmupNamespaces: "test.warmup.$a_-1"}});
+    assert.soon(function() {
+        var log = assert.commandWorked(runner.adminCommand({getLog: "global"})).log;
+        return log.some(function(line) {
+            return /warmed index a_-1 of test.warmup/.test(line);
+        });
+    }, "warmup at startup didn't run");
+    MongoRunner.stopMongod(runner);
+}());
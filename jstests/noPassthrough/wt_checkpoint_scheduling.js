@@ -0,0 +1,60 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * With wiredTigerCheckpointScheduling, mongod takes the checkpoints itself. It takes one once
+ * syncPeriodSecs is up, or earlier once enough of the cache is dirty, and reports them in
+ * serverStatus.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    function checkpointStats(conn) {
+        return conn.getDB("admin").serverStatus({wiredTiger: {}}).wiredTiger.checkpointScheduler;
+    }
+
+    // Not reported unless mongod takes the checkpoints.
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to start");
+    assert.eq(undefined, checkpointStats(conn));
+    MongoRunner.stopMongod(conn);
+
+    conn = MongoRunner.runMongod({storageEngine: "wiredTiger",
+                                  syncdelay: 2,
+                                  setParameter: {wiredTigerCheckpointScheduling: true,
+                                                 wiredTigerCheckpointMinIntervalMillis: 100,
+                                                 wiredTigerCheckpointDirtyTriggerPercent: 0.01}});
+    assert.neq(null, conn, "mongod failed to start");
+
+    // Taken every syncPeriodSecs while idle.
+    assert.soon(function() {
+        return checkpointStats(conn).checkpointsForInterval >= 2;
+    }, "no checkpoints taken for the interval: " + tojson(checkpointStats(conn)));
+
+    // Taken early for dirty data.
+    var coll = conn.getDB("test").wt_checkpoint_scheduling;
+    var pad = new Array(1024).join("x");
+    assert.soon(function() {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 1000; i++) {
+            bulk.insert({pad: pad});
+        }
+        assert.writeOK(bulk.execute());
+        return checkpointStats(conn).checkpointsForDirtyCache > 0;
+    }, "no checkpoints taken for dirty data: " + tojson(checkpointStats(conn)));
+
+    var stats = checkpointStats(conn);
+    assert.gt(stats.totalBytesWritten, 0, tojson(stats));
+    assert.gte(stats.totalDurationMillis, stats.maxDurationMillis, tojson(stats));
+    assert.eq(stats.checkpoints,
+              stats.checkpointsForInterval + stats.checkpointsForDirtyCache +
+                  stats.checkpointsForTargetTime,
+              tojson(stats));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,64 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * With wiredTigerCursorPinMillis set, a cursor's snapshot is kept open between getMore batches, so
+ * the next batch resumes without repositioning. Results must be the same either way.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger",
+                                      setParameter: "wiredTigerCursorPinMillis=60000"});
+    assert.neq(null, conn, "mongod failed to start");
+    var db = conn.getDB("test");
+    var coll = db.wt_cursor_snapshot_pin;
+    for (var i = 0; i < 1000; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i % 10}));
+    }
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    function keptSnapshots() {
+        // Passing the section a config object skips its cached snapshot.
+        return db.serverStatus({wiredTiger: {}}).wiredTiger.cursorSnapshots.keptBetweenBatches;
+    }
+
+    function checkScan(query, expected) {
+        var before = keptSnapshots();
+        var results = coll.find(query).batchSize(10).toArray();
+        assert.eq(expected, results.length, tojson(query));
+        assert.gt(keptSnapshots(), before, "no snapshot kept for " + tojson(query));
+    }
+    checkScan({}, 1000);
+    checkScan({a: {$gte: 5}}, 500);
+
+    // Writes between batches don't break the scan.
+    var cursor = coll.find().batchSize(10);
+    var seen = 0;
+    while (cursor.hasNext()) {
+        var doc = cursor.next();
+        seen++;
+        if (seen % 100 == 0) {
+            assert.writeOK(coll.remove({_id: doc._id + 1}));
+        }
+    }
+    assert.lte(seen, 1000);
+    assert.gte(seen, 990);
+
+    var explain = coll.find({a: 1}).explain("executionStats");
+    assert(explain.executionStats.executionStages.hasOwnProperty("restoreStateMicros"),
+           tojson(explain));
+
+    // Turning it off goes back to ending the snapshot after every batch.
+    assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerCursorPinMillis: 0}));
+    var before = keptSnapshots();
+    assert.eq(coll.count(), coll.find().batchSize(10).itcount());
+    assert.eq(before, keptSnapshots());
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,77 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * With wiredTigerFairTicketScheduling set, operations that find no free read ticket queue per
+ * database, and serverStatus reports how long each database's operations waited.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger",
+                                      setParameter: "wiredTigerFairTicketScheduling=true"});
+    assert.neq(null, conn, "mongod failed to start");
+    var admin = conn.getDB("admin");
+
+    function concurrentTransactions() {
+        return assert.commandWorked(admin.serverStatus()).wiredTiger.concurrentTransactions;
+    }
+    assert.eq(true, concurrentTransactions().fairScheduling);
+
+    // Weights must be positive numbers, given per database.
+    assert.commandFailed(admin.runCommand({setParameter: 1, wiredTigerTicketWeights: 4}));
+    assert.commandFailed(admin.runCommand({setParameter: 1, wiredTigerTicketWeights: {a: 0}}));
+    assert.commandFailed(admin.runCommand({setParameter: 1, wiredTigerTicketWeights: {a: 'x'}}));
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           wiredTigerTicketWeights: {premium: 4}}));
+    var res = assert.commandWorked(admin.runCommand({getParameter: 1,
+                                                     wiredTigerTicketWeights: 1}));
+    assert.eq({premium: 4}, res.wiredTigerTicketWeights, tojson(res));
+
+    ['premium', 'analytics'].forEach(function(dbName) {
+        assert.writeOK(conn.getDB(dbName).coll.insert({_id: 1}));
+    });
+
+    // Few tickets, each held for a while, so that the readers queue.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           wiredTigerConcurrentReadTransactions: 5}));
+    var reader = function(dbName) {
+        return 'var coll = db.getSiblingDB("' + dbName + '").coll;' +
+               'for (var i = 0; i < 5; i++) {' +
+               '    assert.eq(1, coll.find({$where: "sleep(100); return true;"}).itcount());' +
+               '}';
+    };
+    var shells = [];
+    for (var i = 0; i < 6; i++) {
+        shells.push(startParallelShell(reader(i % 2 ? 'premium' : 'analytics'), conn.port));
+    }
+    shells.forEach(function(awaitShell) {
+        awaitShell();
+    });
+
+    var read = concurrentTransactions().read;
+    var waits = 0;
+    ['premium', 'analytics'].forEach(function(dbName) {
+        var queue = read.queues[dbName];
+        if (!queue) {
+            return;
+        }
+        assert.eq(0, queue.queued, tojson(read));
+        assert.gte(queue.totalWaitMicros, queue.maxWaitMicros, tojson(read));
+        waits += queue.waits;
+    });
+    assert.gt(waits, 0, tojson(read));
+
+    // It can be turned off while running.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           wiredTigerFairTicketScheduling: false}));
+    assert.eq(1, conn.getDB('premium').coll.find().itcount());
+    assert.eq(false, concurrentTransactions().fairScheduling);
+
+    MongoRunner.stopMongod(conn);
+}());
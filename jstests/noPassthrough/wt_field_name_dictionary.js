@@ -0,0 +1,106 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * A collection created with fieldNameDictionary stores its documents with tokens in place of
+ * their field names, and gives back the same documents it was given.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to start");
+    var db = conn.getDB("test");
+
+    var dictionary = {storageEngine: {wiredTiger: {fieldNameDictionary: true}}};
+    assert.commandFailed(db.createCollection("capped", Object.extend({capped: true, size: 4096},
+                                                                      dictionary)));
+    assert.commandFailed(db.createCollection("bad",
+                                             {storageEngine: {wiredTiger: {fieldNameDictionary:
+                                                                           'yes'}}}));
+
+    assert.commandWorked(db.createCollection("wt_field_name_dictionary", dictionary));
+    var coll = db.wt_field_name_dictionary;
+    assert.commandWorked(coll.ensureIndex({'shippingAddress.postalCode': 1}));
+
+    function makeDoc(i) {
+        return {
+            _id: i,
+            customerIdentifier: i % 7,
+            shippingAddress: {streetName: 'street ' + i, postalCode: i % 100},
+            lineItems: [{productIdentifier: i, requestedQuantity: 2},
+                        {productIdentifier: i + 1, requestedQuantity: 3}],
+            emptyName: {'': 1},
+            values: [null, true, 1.5, NumberLong(5), new Date(i), /re/i, BinData(0, 'AAEC'),
+                     ObjectId(), MinKey, MaxKey, Timestamp(1, i), []]
+        };
+    }
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert(makeDoc(i));
+    }
+    assert.writeOK(bulk.execute());
+
+    function checkDocs() {
+        var docs = coll.find().sort({_id: 1}).toArray();
+        assert.eq(500, docs.length);
+        docs.forEach(function(doc) {
+            var expected = makeDoc(doc._id);
+            // ObjectIds are generated fresh each time.
+            expected.values[7] = doc.values[7];
+            assert.eq(0, bsonWoCompare(expected, doc), tojson(doc));
+            assert.eq(Object.keySet(expected), Object.keySet(doc));
+        });
+    }
+    checkDocs();
+
+    // Indexes and queries see the full documents too.
+    assert.eq(5, coll.find({'shippingAddress.postalCode': 42}).itcount());
+    assert.eq(71, coll.find({customerIdentifier: 3}).itcount());
+
+    // Updates can't be applied in place, but still work.
+    assert.writeOK(coll.update({_id: 1}, {$set: {customerIdentifier: 8}}));
+    assert.writeOK(coll.update({_id: 2}, {$inc: {'lineItems.0.requestedQuantity': 1}}));
+    assert.writeOK(coll.update({_id: 3}, {$set: {brandNewField: 'x'}}));
+    assert.eq(8, coll.findOne({_id: 1}).customerIdentifier);
+    assert.eq(3, coll.findOne({_id: 2}).lineItems[0].requestedQuantity);
+    assert.eq('x', coll.findOne({_id: 3}).brandNewField);
+    assert.writeOK(coll.update({_id: 1}, {$set: {customerIdentifier: 1}}));
+    assert.writeOK(coll.update({_id: 2}, {$inc: {'lineItems.0.requestedQuantity': -1}}));
+    assert.writeOK(coll.update({_id: 3}, {$unset: {brandNewField: 1}}));
+    checkDocs();
+
+    // Sizes are still counted in BSON bytes.
+    var stats = coll.stats();
+    assert.eq(Object.bsonsize(coll.findOne({_id: 0})), Object.bsonsize(makeDoc(0)));
+    assert.gt(stats.wiredTiger.fieldNameDictionary.names, 10, tojson(stats));
+    assert.gt(stats.size, 0, tojson(stats));
+
+    assert.commandWorked(coll.validate(true));
+
+    // The dictionary survives a restart.
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod({restart: true, cleanData: false, dbpath: conn.dbpath,
+                                  storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to restart");
+    db = conn.getDB("test");
+    coll = db.wt_field_name_dictionary;
+    checkDocs();
+    assert.writeOK(coll.insert({_id: 'after restart', anotherNewField: 1}));
+    assert.eq(1, coll.findOne({_id: 'after restart'}).anotherNewField);
+
+    // A collection of the same name created after a drop starts from nothing.
+    assert(coll.drop());
+    assert.commandWorked(db.createCollection("wt_field_name_dictionary", dictionary));
+    assert.writeOK(coll.insert({_id: 1, onlyField: 1}));
+    assert.eq({_id: 1, onlyField: 1}, coll.findOne());
+    assert.eq(2, coll.stats().wiredTiger.fieldNameDictionary.names);
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,89 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * A collection created with keyedById stores each document at a RecordId made from its numeric
+ * _id, so finding a document by _id reads it straight from the table.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var conn = MongoRunner.runMongod({storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to start");
+    var db = conn.getDB("test");
+
+    var keyed = {storageEngine: {wiredTiger: {keyedById: true}}};
+    assert.commandFailed(db.createCollection("capped", Object.extend({capped: true, size: 4096},
+                                                                      keyed)));
+    assert.commandFailed(db.createCollection("bad", {storageEngine: {wiredTiger: {keyedById: 1}}}));
+
+    assert.commandWorked(db.createCollection("wt_keyed_by_id", keyed));
+    var coll = db.wt_keyed_by_id;
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = -50; i < 50; i++) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(coll.insert({_id: NumberLong("1000000000000"), x: 'long'}));
+    assert.writeOK(coll.insert({_id: 100.0, x: 'double'}));
+
+    // Only numeric _ids that are whole numbers can be keys.
+    assert.writeError(coll.insert({_id: 'a'}));
+    assert.writeError(coll.insert({_id: 1.5}));
+    assert.writeError(coll.insert({x: 'no _id given'}));
+
+    // Duplicates are found by the table itself, and also by the _id index.
+    assert.writeError(coll.insert({_id: 7}));
+    assert.writeError(coll.insert({_id: NumberLong(7)}));
+    assert.eq(102, coll.count());
+
+    assert.eq({_id: 7, x: 7}, coll.findOne({_id: 7}));
+    assert.eq({_id: -50, x: -50}, coll.findOne({_id: NumberLong(-50)}));
+    assert.eq('long', coll.findOne({_id: 1000000000000}).x);
+    assert.eq(null, coll.findOne({_id: 51}));
+    assert.eq(null, coll.findOne({_id: 'a'}));
+
+    // Lookups by _id don't need the index.
+    var stats = coll.find({_id: 12}).explain("executionStats").executionStats;
+    assert.eq(1, stats.nReturned, tojson(stats));
+    assert.eq(0, stats.totalKeysExamined, tojson(stats));
+    assert.eq(1, stats.totalDocsExamined, tojson(stats));
+
+    // A collection scan returns documents in _id order.
+    var ids = coll.find({_id: {$lt: 50}}).hint({$natural: 1}).toArray().map(function(doc) {
+        return doc._id;
+    });
+    assert.eq(ids.slice().sort(function(a, b) { return a - b; }), ids);
+
+    // Updates keep the document where it is, and the _id can't be changed.
+    assert.writeOK(coll.update({_id: 3}, {$set: {pad: new Array(4096).join('x')}}));
+    assert.eq(4095, coll.findOne({_id: 3}).pad.length);
+    assert.writeOK(coll.update({_id: 4}, {x: 'replaced'}));
+    assert.eq({_id: 4, x: 'replaced'}, coll.findOne({_id: 4}));
+    assert.writeError(coll.update({_id: 5}, {$set: {_id: 6}}));
+
+    // A removed _id can be used again.
+    assert.writeOK(coll.remove({_id: 8}));
+    assert.eq(null, coll.findOne({_id: 8}));
+    assert.writeOK(coll.insert({_id: 8, x: 'again'}));
+    assert.eq('again', coll.findOne({_id: 8}).x);
+
+    // The layout survives a restart.
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod({restart: true, cleanData: false, dbpath: conn.dbpath,
+                                  storageEngine: "wiredTiger"});
+    assert.neq(null, conn, "mongod failed to restart");
+    coll = conn.getDB("test").wt_keyed_by_id;
+    assert.eq('again', coll.findOne({_id: 8}).x);
+    assert.writeError(coll.insert({_id: 'a'}));
+    stats = coll.find({_id: 9}).explain("executionStats").executionStats;
+    assert.eq(0, stats.totalKeysExamined, tojson(stats));
+
+    MongoRunner.stopMongod(conn);
+}());
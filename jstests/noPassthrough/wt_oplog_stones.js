@@ -0,0 +1,57 @@
+/**
+ * This test is only for the WiredTiger storageEngine.
+ * The oplog is divided into stones, which a background thread truncates once the oplog has grown
+ * past its cap, instead of inserts deleting the oldest entries themselves.
+ */
+(function() {
+    'use strict';
+
+    if (typeof(TestData) != "object" ||
+        !TestData.storageEngine ||
+        TestData.storageEngine != "wiredTiger") {
+        jsTestLog("Skipping test because storageEngine is not wiredTiger");
+        return;
+    }
+
+    var replTest = new ReplSetTest({name: "wt_oplog_stones", nodes: 1, oplogSize: 2});
+    replTest.startSet({storageEngine: "wiredTiger"});
+    replTest.initiate();
+
+    var primary = replTest.getMaster();
+    var oplog = primary.getDB("local").oplog.rs;
+    var maxSize = oplog.stats().maxSize;
+
+    function stoneStats() {
+        // Passing the section a config object skips its cached snapshot.
+        var stats = primary.getDB("admin").serverStatus({wiredTiger: {}}).wiredTiger.oplogStones;
+        assert(stats, "no oplogStones section in serverStatus");
+        return stats;
+    }
+    var before = stoneStats();
+
+    // Write several times the size of the oplog.
+    var pad = new Array(1024).join("x");
+    var coll = primary.getDB("test").wt_oplog_stones;
+    for (var i = 0; i < 10; i++) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var j = 0; j < 1000; j++) {
+            bulk.insert({_id: i * 1000 + j, pad: pad});
+        }
+        assert.writeOK(bulk.execute());
+    }
+
+    assert.soon(function() {
+        var stats = stoneStats();
+        return stats.truncations > before.truncations && oplog.stats().size <= 2 * maxSize;
+    }, "oplog was not truncated; stones: " + tojson(stoneStats()));
+
+    var stats = stoneStats();
+    assert.gt(stats.stones, 0, tojson(stats));
+    assert.gte(stats.totalTruncateMicros, stats.lastTruncateMicros, tojson(stats));
+
+    // The newest entries are kept, and the oldest are gone.
+    assert.eq(1, oplog.find({ns: coll.getFullName(), "o._id": 9999}).itcount());
+    assert.eq(0, oplog.find({ns: coll.getFullName(), "o._id": 0}).itcount());
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,65 @@
+// Tests benchRun weighted op mixes, rate limited load, latency percentiles and diaglog replay.
+(function() {
+    'use strict';
+
+    var t = db.benchrun_workload;
+    t.drop();
+    assert.writeOK(t.insert({_id: 0, a: 0, b: 0, c: 0}));
+
+    function run(args) {
+        args.host = db.getMongo().host;
+        return benchRun(args);
+    }
+
+    // Operations are picked in proportion to their weights, and never with a weight of 0.
+    var res = run({ops: [{op: "update", ns: t.getFullName(), query: {_id: 0},
+                          update: {$inc: {a: 1}}, weight: 3},
+                         {op: "update", ns: t.getFullName(), query: {_id: 0},
+                          update: {$inc: {b: 1}}},
+                         {op: "update", ns: t.getFullName(), query: {_id: 0},
+                          update: {$inc: {c: 1}}, weight: 0},
+                         {op: "findOne", ns: t.getFullName(), query: {_id: 0}, weight: 1}],
+                   parallel: 2,
+                   seconds: 2});
+    var doc = t.findOne();
+    assert.gt(doc.b, 0, tojson(doc));
+    assert.eq(0, doc.c, tojson(doc));
+    assert.gt(doc.a / doc.b, 2, tojson(doc));
+    assert.lt(doc.a / doc.b, 4, tojson(doc));
+
+    var percentiles = res.updateLatencyPercentilesMicros;
+    assert(percentiles, tojson(res));
+    assert.lte(percentiles.p50, percentiles.p99, tojson(res));
+    assert.lte(percentiles.p99, percentiles.p999, tojson(res));
+    assert(res.findOneLatencyPercentilesMicros, tojson(res));
+
+    // A target rate caps the number of operations.
+    assert.writeOK(t.update({_id: 0}, {$set: {a: 0}}));
+    run({ops: [{op: "update", ns: t.getFullName(), query: {_id: 0}, update: {$inc: {a: 1}}}],
+         parallel: 2,
+         seconds: 2,
+         opsPerSecond: 100});
+    doc = t.findOne();
+    assert.gt(doc.a, 50, tojson(doc));
+    assert.lte(doc.a, 300, tojson(doc));
+
+    // Requests captured in a diaglog are replayed.
+    var dbPath = db.adminCommand("getCmdLineOpts").parsed.storage.dbPath;
+    assert.commandWorked(db.adminCommand({diagLogging: 3}));
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(t.update({_id: 0}, {$inc: {replayed: 1}}));
+    }
+    assert.commandWorked(db.adminCommand({diagLogging: 0}));
+
+    var diagLogs = listFiles(dbPath).filter(function(file) {
+        return /\/diaglog\.[0-9a-f]+$/.test(file.name);
+    }).map(function(file) {
+        return file.name;
+    }).sort();
+    assert.gt(diagLogs.length, 0, "no diaglog in " + dbPath);
+
+    assert.writeOK(t.update({_id: 0}, {$set: {replayed: 0}}));
+    run({replayDiagLog: diagLogs[diagLogs.length - 1], parallel: 1, seconds: 1});
+    doc = t.findOne();
+    assert.gt(doc.replayed, 0, tojson(doc));
+}());
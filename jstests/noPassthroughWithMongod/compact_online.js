@@ -0,0 +1,43 @@
+// Tests online compaction, which only holds intent locks and keeps the collection usable.
+(function() {
+    'use strict';
+
+    var coll = db.compact_online;
+    coll.drop();
+    var pad = new Array(200).join('x');
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i % 10, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+    assert.writeOK(coll.remove({_id: {$mod: [2, 0]}}));
+
+    // Online mode can't be combined with options which only apply to a blocking compact.
+    assert.commandFailed(coll.runCommand('compact', {online: true, freeSpaceOnly: true}));
+    assert.commandFailed(coll.runCommand('compact', {online: true, paddingFactor: 1.5}));
+    assert.commandFailed(coll.runCommand('compact', {online: true, batchSize: 0}));
+
+    var res = coll.runCommand('compact', {online: true, batchSize: 16, force: true});
+    if (res.code === ErrorCodes.CommandNotSupported) {
+        jsTestLog("Skipping test because the storage engine doesn't support compact");
+        return;
+    }
+    assert.commandWorked(res);
+    assert(res.hasOwnProperty('reclaimedBytes'), tojson(res));
+    assert(res.hasOwnProperty('recordsMoved'), tojson(res));
+    if (res.recordsMoved > 0) {
+        // Every remaining document was moved exactly once.
+        assert.eq(500, res.recordsMoved, tojson(res));
+    }
+
+    // The documents and their index entries are all still there.
+    assert.eq(500, coll.find().itcount());
+    assert.eq(100, coll.find({a: 1}).hint({a: 1}).itcount());
+    assert.eq({_id: 1, a: 1, pad: pad}, coll.findOne({_id: 1}));
+    assert.eq(null, coll.findOne({_id: 2}));
+    var validate = coll.validate(true);
+    assert(validate.valid, tojson(validate));
+
+    coll.drop();
+}());
@@ -0,0 +1,39 @@
+// With currentOpSnapshotMillis set, currentOp reports from a snapshot of all operations, which is
+// reused by every request until it is older than that.
+(function() {
+    'use strict';
+
+    var admin = db.getSiblingDB('admin');
+
+    var res = assert.commandWorked(admin.currentOp());
+    assert(!res.hasOwnProperty('snapshotTime'), tojson(res));
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, currentOpSnapshotMillis: 60 * 1000}));
+    try {
+        var first = assert.commandWorked(admin.currentOp(true));
+        assert(first.hasOwnProperty('snapshotTime'), tojson(first));
+        assert.gt(first.inprog.length, 0, tojson(first));
+
+        // Later requests are answered from the same snapshot, filters and all.
+        var second = assert.commandWorked(admin.currentOp());
+        assert.eq(first.snapshotTime, second.snapshotTime);
+        second.inprog.forEach(function(op) {
+            assert(op.active, tojson(op));
+        });
+
+        var filtered = assert.commandWorked(admin.currentOp({op: 'command'}));
+        assert.eq(first.snapshotTime, filtered.snapshotTime);
+        filtered.inprog.forEach(function(op) {
+            assert.eq('command', op.op, tojson(op));
+        });
+
+        // An old enough snapshot is replaced.
+        assert.commandWorked(admin.runCommand({setParameter: 1, currentOpSnapshotMillis: 1}));
+        sleep(10);
+        var third = assert.commandWorked(admin.currentOp());
+        assert.gt(third.snapshotTime, first.snapshotTime);
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1, currentOpSnapshotMillis: 0}));
+    }
+}());
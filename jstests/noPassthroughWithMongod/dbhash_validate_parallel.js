@@ -0,0 +1,52 @@
+// Tests that dbHash hashes collections on several threads, and that validate runs in the background
+// on several threads, with the same results as when run serially.
+(function() {
+    'use strict';
+
+    var testDB = db.getSiblingDB('dbhash_validate_parallel');
+    testDB.dropDatabase();
+    for (var i = 0; i < 5; i++) {
+        var coll = testDB['coll' + i];
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var j = 0; j < 200 * (i + 1); j++) {
+            bulk.insert({_id: j, a: j % 7, b: 'x' + j});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(coll.ensureIndex({a: 1}));
+        assert.commandWorked(coll.ensureIndex({b: 1, a: -1}));
+    }
+
+    var serial = assert.commandWorked(testDB.runCommand({dbHash: 1}));
+    var parallel = assert.commandWorked(testDB.runCommand({dbHash: 1, parallel: 4}));
+    assert.eq(4, parallel.parallel, tojson(parallel));
+    assert.eq(serial.md5, parallel.md5, tojson(parallel));
+    assert.eq(serial.collections, parallel.collections, tojson(parallel));
+
+    var throttled = assert.commandWorked(testDB.runCommand({dbHash: 1,
+                                                            parallel: 2,
+                                                            maxMBPerSecond: 100,
+                                                            collections: ['coll1', 'coll3']}));
+    assert.eq(serial.collections.coll1, throttled.collections.coll1, tojson(throttled));
+    assert.eq(serial.collections.coll3, throttled.collections.coll3, tojson(throttled));
+    assert(!throttled.collections.hasOwnProperty('coll0'), tojson(throttled));
+
+    var coll = testDB.coll4;
+    var foreground = assert.commandWorked(coll.validate());
+    [1, 3].forEach(function(threads) {
+        var res = assert.commandWorked(testDB.runCommand({validate: coll.getName(),
+                                                          background: true,
+                                                          parallel: threads}));
+        assert(res.valid, tojson(res));
+        assert(res.background, tojson(res));
+        assert.eq(threads, res.parallel, tojson(res));
+        assert.eq(foreground.nIndexes, res.nIndexes, tojson(res));
+        assert.eq(foreground.keysPerIndex, res.keysPerIndex, tojson(res));
+    });
+
+    // Full validation needs an exclusive lock.
+    assert.commandFailed(testDB.runCommand({validate: coll.getName(), background: true,
+                                            full: true}));
+    assert.commandFailed(testDB.runCommand({validate: 'missing', background: true}));
+
+    testDB.dropDatabase();
+}());
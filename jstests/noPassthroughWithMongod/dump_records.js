@@ -0,0 +1,68 @@
+// Tests that dumpRecords returns every record of a collection exactly once across its batches,
+// with and without compression.
+(function() {
+    'use strict';
+
+    var coll = db.dump_records;
+    coll.drop();
+
+    var totalBytes = 0;
+    for (var i = 0; i < 500; i++) {
+        var doc = {_id: i, pad: new Array(200).join('y')};
+        totalBytes += Object.bsonsize(doc);
+        assert.writeOK(coll.insert(doc));
+    }
+
+    function dumpAll(compress) {
+        var res = assert.commandWorked(db.runCommand({dumpRecords: coll.getName(),
+                                                      batchBytes: 10000,
+                                                      compress: compress}));
+        var numRecords = 0;
+        var bytes = 0;
+        var batches = 0;
+        while (true) {
+            batches++;
+            numRecords += res.numRecords;
+            if (res.compressed) {
+                assert(compress, tojson(res));
+                assert.lt(res.records.length(), res.uncompressedBytes);
+                bytes += res.uncompressedBytes;
+            }
+            else {
+                bytes += res.records.length();
+            }
+            if (res.cursorId == 0) {
+                break;
+            }
+            res = assert.commandWorked(db.runCommand({dumpRecords: coll.getName(),
+                                                      cursorId: res.cursorId,
+                                                      batchBytes: 10000,
+                                                      compress: compress}));
+        }
+        assert.eq(500, numRecords);
+        assert.eq(totalBytes, bytes);
+        assert.gt(batches, 10);
+    }
+
+    dumpAll(false);
+    dumpAll(true);
+
+    // Bad arguments.
+    assert.commandFailed(db.runCommand({dumpRecords: coll.getName(), batchBytes: 0}));
+    assert.commandFailed(db.runCommand({dumpRecords: coll.getName(), batchBytes: 'a'}));
+    assert.commandFailed(db.runCommand({dumpRecords: coll.getName(), cursorId: 1}));
+    assert.commandFailed(db.runCommand({dumpRecords: coll.getName(),
+                                        cursorId: NumberLong(12345)}));
+    assert.commandFailed(db.runCommand({dumpRecords: 'dump_records_missing'}));
+
+    // A cursor on one collection can't be used for another.
+    db.dump_records_other.drop();
+    assert.writeOK(db.dump_records_other.insert({_id: 1}));
+    var res = assert.commandWorked(db.runCommand({dumpRecords: coll.getName(), batchBytes: 100}));
+    assert.neq(0, res.cursorId);
+    assert.commandFailed(db.runCommand({dumpRecords: 'dump_records_other',
+                                        cursorId: res.cursorId}));
+
+    coll.drop();
+    db.dump_records_other.drop();
+}());
@@ -0,0 +1,48 @@
+// An exhaust find command streams all of its batches as replies to the one request, each a getMore
+// command reply, like a legacy exhaust query does with OP_REPLY batches.
+(function() {
+    'use strict';
+
+    var coll = db.exhaust_find_command;
+    coll.drop();
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 105; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function readExhaustCommand(cmd) {
+        var cursor = db.getMongo().find(db.getName() + ".$cmd", cmd, null, -1, 0, 0,
+                                        DBQuery.Option.exhaust);
+        var replies = [];
+        while (cursor.hasNext()) {
+            replies.push(cursor.next());
+        }
+        return replies;
+    }
+
+    var replies = readExhaustCommand({find: coll.getName(), batchSize: 10});
+    assert.eq(11, replies.length, tojson(replies));
+    var count = 0;
+    replies.forEach(function(reply, i) {
+        assert.commandWorked(reply);
+        var batch = i === 0 ? reply.cursor.firstBatch : reply.cursor.nextBatch;
+        assert.lte(batch.length, 10, tojson(reply));
+        count += batch.length;
+    });
+    assert.eq(105, count);
+    assert.eq(0, replies[replies.length - 1].cursor.id);
+
+    // A failed command ends the stream with its error.
+    replies = readExhaustCommand({find: coll.getName(), filter: {$bad: 1}});
+    assert.eq(1, replies.length, tojson(replies));
+    assert.commandFailed(replies[0]);
+
+    // Other commands ignore the option.
+    replies = readExhaustCommand({ping: 1});
+    assert.eq(1, replies.length, tojson(replies));
+    assert.commandWorked(replies[0]);
+
+    // Legacy exhaust queries still work.
+    assert.eq(105, coll.find().batchSize(10).addOption(DBQuery.Option.exhaust).itcount());
+}());
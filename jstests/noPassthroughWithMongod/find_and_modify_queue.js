@@ -0,0 +1,71 @@
+// Concurrent findAndModify commands popping documents off a queue in priority order. A
+// findAndModify whose first choice is taken by another one goes on to the next document, so none
+// of them may report an empty queue while ready documents are left, and no document is popped
+// twice.
+(function() {
+    'use strict';
+
+    var coll = db.find_and_modify_queue;
+    var popped = db.find_and_modify_queue_popped;
+    var numDocs = 500;
+    var numPoppers = 4;
+
+    function fill(withIndex) {
+        coll.drop();
+        popped.drop();
+        if (withIndex) {
+            assert.commandWorked(coll.ensureIndex({pri: -1}));
+        }
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < numDocs; i++) {
+            bulk.insert({_id: i, status: 'ready', pri: i % 10});
+        }
+        assert.writeOK(bulk.execute());
+    }
+
+    function pop(remove) {
+        var coll = db.find_and_modify_queue;
+        var popped = db.find_and_modify_queue_popped;
+        while (true) {
+            var doc = remove
+                ? coll.findAndModify({query: {status: 'ready'}, sort: {pri: -1}, remove: true})
+                : coll.findAndModify({query: {status: 'ready'},
+                                      sort: {pri: -1},
+                                      update: {$set: {status: 'taken'}}});
+            if (!doc) {
+                // Documents only ever leave the queue, so one found now was already there.
+                assert.eq(0, coll.count({status: 'ready'}));
+                return;
+            }
+            assert.writeOK(popped.insert({_id: doc._id}));
+        }
+    }
+
+    function runPoppers(remove, withIndex) {
+        fill(withIndex);
+        var joins = [];
+        for (var i = 0; i < numPoppers; i++) {
+            joins.push(startParallelShell('(' + pop.toString() + ')(' + remove + ');'));
+        }
+        joins.forEach(function(join) {
+            assert.eq(0, join());
+        });
+        assert.eq(numDocs, popped.count());
+        assert.eq(0, coll.count({status: 'ready'}));
+    }
+
+    // A blocking sort, then a sort provided by an index.
+    runPoppers(false, false);
+    runPoppers(true, false);
+    runPoppers(false, true);
+    runPoppers(true, true);
+
+    // The queue order is kept.
+    fill(true);
+    assert.eq(9, coll.findAndModify({query: {status: 'ready'}, sort: {pri: -1}, remove: true}).pri);
+    var doc = coll.findAndModify({query: {status: 'ready', pri: {$lt: 5}},
+                                  sort: {pri: -1},
+                                  update: {$set: {status: 'taken'}},
+                                  new: true});
+    assert.eq({status: 'taken', pri: 4}, {status: doc.status, pri: doc.pri});
+}());
@@ -0,0 +1,78 @@
+// A 2d query's index bounds come from a covering whose precision follows the size of the queried
+// region, with cells next to each other in the index scanned as one interval. The results must be
+// the same as without the index, and fewer documents should be fetched than with a fixed covering.
+(function() {
+    'use strict';
+
+    var coll = db.geo_2d_covering;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({loc: '2d'}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var x = -20; x <= 20; x += 0.25) {
+        for (var y = -20; y <= 20; y += 0.25) {
+            bulk.insert({loc: [x, y]});
+        }
+    }
+    assert.writeOK(bulk.execute());
+
+    function findIxscan(stage) {
+        if (stage.stage === 'IXSCAN') {
+            return stage;
+        }
+        var children = stage.inputStage ? [stage.inputStage] : (stage.inputStages || []);
+        for (var i = 0; i < children.length; i++) {
+            var found = findIxscan(children[i]);
+            if (found) {
+                return found;
+            }
+        }
+        return null;
+    }
+
+    function setLevels(levels) {
+        assert.commandWorked(db.adminCommand({setParameter: 1,
+                                              internalGeoQuery2DCoveringLevels: levels}));
+    }
+
+    var queries = [
+        {loc: {$geoWithin: {$box: [[0, 0], [1, 1]]}}},
+        {loc: {$geoWithin: {$box: [[-3.1, 2.2], [7.7, 2.9]]}}},
+        {loc: {$geoWithin: {$box: [[-15, -15], [15, 15]]}}},
+        {loc: {$geoWithin: {$center: [[5, -5], 3]}}},
+        {loc: {$geoWithin: {$polygon: [[0, 0], [10, 0], [0, 10]]}}}
+    ];
+
+    function checkQuery(query) {
+        var expected = coll.find(query).hint({$natural: 1}).count();
+        assert.eq(expected, coll.find(query).hint({loc: '2d'}).itcount(), tojson(query));
+
+        var explain = coll.find(query).hint({loc: '2d'}).explain('executionStats');
+        var ixscan = findIxscan(explain.executionStats.executionStages);
+        assert.neq(null, ixscan, tojson(explain));
+        assert(ixscan.geoCovering && ixscan.geoCovering.loc, tojson(ixscan));
+        var covering = ixscan.geoCovering.loc;
+        assert.lte(covering.intervals, covering.cells, tojson(covering));
+        assert.eq(covering.intervals, ixscan.indexBounds.loc.length, tojson(ixscan));
+        return explain.executionStats.totalDocsExamined;
+    }
+
+    var oldLevels = assert.commandWorked(
+        db.adminCommand({getParameter: 1, internalGeoQuery2DCoveringLevels: 1}));
+    oldLevels = oldLevels.internalGeoQuery2DCoveringLevels;
+
+    var adaptive = 0;
+    var fixed = 0;
+    try {
+        queries.forEach(function(query) {
+            setLevels(4);
+            adaptive += checkQuery(query);
+            setLevels(0);
+            fixed += checkQuery(query);
+        });
+    }
+    finally {
+        setLevels(oldLevels);
+    }
+    assert.lt(adaptive, fixed);
+}());
@@ -0,0 +1,33 @@
+// Tests the mutexContention command and the mutexContentionSampleRate parameter.
+(function() {
+    'use strict';
+
+    var admin = db.getSiblingDB('admin');
+    var res = assert.commandWorked(admin.runCommand({mutexContention: 1, reset: true}));
+    assert.eq(0, res.sampleRate, tojson(res));
+
+    assert.commandFailed(admin.runCommand({setParameter: 1, mutexContentionSampleRate: -1}));
+    assert.commandWorked(admin.runCommand({setParameter: 1, mutexContentionSampleRate: 1}));
+    try {
+        var coll = db.mutex_contention;
+        coll.drop();
+        startParallelShell('for (var i = 0; i < 200; i++) { db.mutex_contention.insert({}); }');
+        for (var i = 0; i < 200; i++) {
+            assert.writeOK(coll.insert({}));
+            coll.find().limit(1).itcount();
+        }
+        res = assert.commandWorked(admin.runCommand({mutexContention: 1}));
+        assert.eq(1, res.sampleRate, tojson(res));
+        res.mutexes.forEach(function(mutex) {
+            assert.gt(mutex.waits, 0, tojson(mutex));
+            assert.lte(mutex.maxWaitMicros, mutex.totalWaitMicros, tojson(mutex));
+        });
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1, mutexContentionSampleRate: 0}));
+    }
+
+    assert.commandWorked(admin.runCommand({mutexContention: 1, reset: true}));
+    res = assert.commandWorked(admin.runCommand({mutexContention: 1}));
+    assert.eq([], res.mutexes, tojson(res));
+}());
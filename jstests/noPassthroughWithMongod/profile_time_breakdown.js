@@ -0,0 +1,29 @@
+// Tests that the profiler reports where an operation spent its time besides waiting for locks.
+(function() {
+    'use strict';
+
+    var testDB = db.getSiblingDB('profile_time_breakdown');
+    testDB.dropDatabase();
+    var coll = testDB.data;
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, a: i % 10});
+    }
+    assert.writeOK(bulk.execute());
+
+    testDB.setProfilingLevel(2);
+    assert.eq(1000, coll.find({a: 3}).itcount());
+    assert.writeOK(coll.insert({_id: 'wc'}, {writeConcern: {w: 1, j: true}}));
+    testDB.setProfilingLevel(0);
+
+    var entry = testDB.system.profile.find({op: 'query', ns: coll.getFullName()}).next();
+    assert.gt(entry.storageTimeMicros, 0, tojson(entry));
+    assert.lte(entry.storageTimeMicros, entry.millis * 1000 + 1000, tojson(entry));
+
+    // Fields which are zero are left out.
+    entry = testDB.system.profile.find({op: 'insert', ns: coll.getFullName()}).next();
+    assert(!entry.hasOwnProperty('storageTimeMicros'), tojson(entry));
+    assert(!entry.hasOwnProperty('yieldMicros'), tojson(entry));
+    testDB.dropDatabase();
+}());
@@ -0,0 +1,98 @@
+// Tests that aggregations over a collection with a projection cache return the same results as
+// without it, and that writes invalidate the cached rows.
+(function() {
+    'use strict';
+
+    var coll = db.projection_cache;
+    coll.drop();
+
+    for (var i = 0; i < 200; i++) {
+        assert.writeOK(coll.insert({_id: i,
+                                    a: i % 7,
+                                    b: {c: i % 3, d: [i, i + 1]},
+                                    pad: new Array(100).join('x'),
+                                    other: i}));
+    }
+
+    function cacheStats() {
+        return assert.commandWorked(db.runCommand({projectionCache: coll.getName()}));
+    }
+
+    var pipelines = [
+        [{$group: {_id: '$a', n: {$sum: 1}, total: {$sum: '$b.c'}}}, {$sort: {_id: 1}}],
+        [{$match: {a: {$gte: 3}, 'b.c': 1}}, {$project: {_id: 0, a: 1, c: '$b.c'}},
+         {$sort: {a: 1, c: 1}}],
+        [{$match: {$or: [{a: 1}, {'b.d': {$elemMatch: {$gt: 150}}}]}},
+         {$group: {_id: null, n: {$sum: 1}}}],
+        [{$group: {_id: null, n: {$sum: 1}}}],
+    ];
+
+    function runAll() {
+        return pipelines.map(function(pipeline) {
+            return coll.aggregate(pipeline).toArray();
+        });
+    }
+
+    var expected = runAll();
+
+    // Only top-level field names can be cached, and capped collections are rejected.
+    assert.commandFailed(db.runCommand({projectionCache: coll.getName(), fields: ['b.c']}));
+    assert.commandFailed(db.runCommand({projectionCache: coll.getName(), fields: ['$a']}));
+    assert.commandFailed(db.runCommand({projectionCache: 'projection_cache_missing',
+                                        fields: ['a']}));
+    db.projection_cache_capped.drop();
+    assert.commandWorked(db.createCollection('projection_cache_capped',
+                                             {capped: true, size: 4096}));
+    assert.commandFailed(db.runCommand({projectionCache: 'projection_cache_capped',
+                                        fields: ['a']}));
+
+    var res = assert.commandWorked(db.runCommand({projectionCache: coll.getName(),
+                                                  fields: ['_id', 'a', 'b']}));
+    assert.eq(['_id', 'a', 'b'], res.fields);
+    assert(!res.current, tojson(res));
+
+    assert.eq(expected, runAll());
+    res = cacheStats();
+    assert(res.current, tojson(res));
+    assert.eq(200, res.numRows, tojson(res));
+
+    // Pipelines reading fields which are not cached still work, and leave the cache alone.
+    assert.eq([{_id: null, s: 19900}],
+              coll.aggregate([{$group: {_id: null, s: {$sum: '$other'}}}]).toArray());
+    assert.eq([{_id: null, n: 1}],
+              coll.aggregate([{$match: {$where: 'this.a == 1 && this.other == 1'}},
+                              {$group: {_id: null, n: {$sum: 1}}}]).toArray());
+    assert(cacheStats().current);
+
+    // Each kind of write makes the rows stale; the next aggregation sees the change.
+    assert.writeOK(coll.insert({_id: 200, a: 1, b: {c: 1, d: [200]}}));
+    assert(!cacheStats().current);
+    expected[3] = [{_id: null, n: 201}];
+    assert.eq(expected[3], coll.aggregate(pipelines[3]).toArray());
+    assert(cacheStats().current);
+
+    assert.writeOK(coll.update({_id: 0}, {$set: {a: 100}}));
+    assert(!cacheStats().current);
+    assert.eq([{_id: 100, n: 1, total: 0}],
+              coll.aggregate([{$match: {a: 100}},
+                              {$group: {_id: '$a', n: {$sum: 1}, total: {$sum: '$b.c'}}}])
+                  .toArray());
+
+    assert.writeOK(coll.remove({a: 100}));
+    assert.eq([], coll.aggregate([{$match: {a: 100}}]).toArray());
+    assert.eq([{_id: null, n: 200}], coll.aggregate(pipelines[3]).toArray());
+
+    // Dropping the collection forgets the declaration.
+    coll.drop();
+    assert.eq([], cacheStats().fields);
+
+    // Removing the cache is done with an empty list of fields.
+    assert.writeOK(coll.insert({_id: 1, a: 1}));
+    assert.commandWorked(db.runCommand({projectionCache: coll.getName(), fields: ['a']}));
+    assert.eq(['a'], cacheStats().fields);
+    assert.commandWorked(db.runCommand({projectionCache: coll.getName(), fields: []}));
+    assert.eq([], cacheStats().fields);
+
+    coll.drop();
+    db.projection_cache_capped.drop();
+}());
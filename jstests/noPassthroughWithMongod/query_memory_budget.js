@@ -0,0 +1,54 @@
+// Tests the memory budgets of query subsystems, and the reporting of tracked memory in explain
+// and serverStatus.
+(function() {
+    'use strict';
+
+    var coll = db.query_memory_budget;
+    coll.drop();
+    var pad = new Array(1024).join('x');
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i, a: i % 100, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    var admin = db.getSiblingDB('admin');
+    var status = assert.commandWorked(admin.runCommand({serverStatus: 1}));
+    assert(status.queryMemory, tojson(status));
+    assert(status.queryMemory.subsystems.sort, tojson(status.queryMemory));
+
+    var explain = coll.find().sort({a: 1}).explain('executionStats');
+    assert.gt(explain.executionStats.peakTrackedMemoryBytes, 100 * 1024, tojson(explain));
+
+    // Going over the sort budget fails the sort, and frees what it charged.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           internalQuerySortMemoryBudgetBytes: 100 * 1024}));
+    try {
+        assert.throws(function() {
+            coll.find().sort({a: 1}).itcount();
+        });
+        assert.eq(1000, coll.find().sort({_id: 1}).itcount());
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1,
+                                               internalQuerySortMemoryBudgetBytes: 0}));
+    }
+
+    status = assert.commandWorked(admin.runCommand({serverStatus: 1}));
+    assert.eq(0, status.queryMemory.subsystems.sort.currentBytes, tojson(status.queryMemory));
+
+    // The operation budget covers $group, which spills when it may.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           internalQueryOperationMemoryBudgetBytes: 64 * 1024}));
+    try {
+        var pipeline = [{$group: {_id: '$_id', pad: {$first: '$pad'}}}];
+        assert.throws(function() {
+            coll.aggregate(pipeline).itcount();
+        });
+        assert.eq(1000, coll.aggregate(pipeline, {allowDiskUse: true}).itcount());
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1,
+                                               internalQueryOperationMemoryBudgetBytes: 0}));
+    }
+}());
@@ -0,0 +1,53 @@
+// Tests per-stage times in explain, and the sampling of query plans into the querySamples buffer.
+(function() {
+    'use strict';
+
+    var coll = db.query_samples;
+    coll.drop();
+    for (var i = 0; i < 100; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i % 10}));
+    }
+
+    function findStage(stage, name) {
+        while (stage.stage !== name) {
+            assert(stage.inputStage, "no " + name + " stage");
+            stage = stage.inputStage;
+        }
+        return stage;
+    }
+
+    // Every stage reports its time, and stages reading from storage report the time spent there.
+    var explain = coll.find({a: 1}).explain('executionStats');
+    var scan = findStage(explain.executionStats.executionStages, 'COLLSCAN');
+    assert(scan.hasOwnProperty('executionTimeMicros'), tojson(scan));
+    assert(scan.hasOwnProperty('storageTimeMicros'), tojson(scan));
+    assert.lte(scan.storageTimeMicros, scan.executionTimeMicros + 1, tojson(scan));
+
+    var admin = db.getSiblingDB('admin');
+    assert.commandWorked(admin.runCommand({querySamples: 1, clear: true}));
+
+    // Nothing is sampled by default.
+    assert.eq(10, coll.find({a: 2}).itcount());
+    var res = assert.commandWorked(admin.runCommand({querySamples: 1}));
+    assert.eq(0, res.samples.length, tojson(res));
+
+    assert.commandWorked(admin.runCommand({setParameter: 1, querySampleRate: 1}));
+    try {
+        assert.eq(10, coll.find({a: 3}).itcount());
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1, querySampleRate: 0}));
+    }
+
+    res = assert.commandWorked(admin.runCommand({querySamples: 1, clear: true}));
+    var samples = res.samples.filter(function(sample) {
+        return sample.ns === coll.getFullName() && friendlyEqual(sample.query, {a: 3});
+    });
+    assert.eq(1, samples.length, tojson(res));
+    assert.eq(10, samples[0].executionStages.nReturned, tojson(samples[0]));
+    scan = findStage(samples[0].executionStages, 'COLLSCAN');
+    assert(scan.hasOwnProperty('storageTimeMicros'), tojson(scan));
+
+    res = assert.commandWorked(admin.runCommand({querySamples: 1}));
+    assert.eq(0, res.samples.length, tojson(res));
+}());
@@ -0,0 +1,94 @@
+// The queryShapeStats command reports the executions of the queries run against a collection,
+// added up for each query shape, and can reset them.
+(function() {
+    'use strict';
+
+    var coll = db.query_shape_stats;
+    coll.drop();
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 100; i++) {
+        bulk.insert({_id: i, a: i % 10, b: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    function getShapes(reset) {
+        var cmd = {queryShapeStats: coll.getName()};
+        if (reset !== undefined) {
+            cmd.reset = reset;
+        }
+        var res = assert.commandWorked(db.runCommand(cmd));
+        assert.eq(0, res.evictions, tojson(res));
+        return res.shapes;
+    }
+
+    function findShape(shapes, query) {
+        for (var i = 0; i < shapes.length; i++) {
+            if (friendlyEqual(query, shapes[i].query)) {
+                return shapes[i];
+            }
+        }
+        return null;
+    }
+
+    assert.eq([], getShapes());
+
+    // Queries that differ only in their values share a shape.
+    for (i = 0; i < 10; i++) {
+        assert.eq(10, coll.find({a: i}).itcount());
+    }
+    for (i = 0; i < 5; i++) {
+        assert.eq(4, coll.find({b: {$gt: 95}}).sort({b: -1}).itcount());
+    }
+    // A query that takes several batches is counted once.
+    assert.eq(100, coll.find().batchSize(10).itcount());
+
+    var shapes = getShapes();
+    assert.eq(3, shapes.length, tojson(shapes));
+
+    var byA = findShape(shapes, {a: 0});
+    assert.neq(null, byA, tojson(shapes));
+    assert.eq({}, byA.sort, tojson(byA));
+    assert.eq(10, byA.executions, tojson(byA));
+    assert.eq(100, byA.nReturned, tojson(byA));
+    assert.eq(100, byA.keysExamined, tojson(byA));
+    assert.eq(100, byA.docsExamined, tojson(byA));
+    assert.eq(0, byA.planChanges, tojson(byA));
+    assert(/IXSCAN/.test(byA.planSummary), tojson(byA));
+    assert.gte(byA.totalMicros, byA.maxMicros, tojson(byA));
+
+    var byB = findShape(shapes, {b: {$gt: 95}});
+    assert.neq(null, byB, tojson(shapes));
+    assert.eq({b: -1}, byB.sort, tojson(byB));
+    assert.eq(5, byB.executions, tojson(byB));
+    assert.eq(20, byB.nReturned, tojson(byB));
+    assert.eq(0, byB.keysExamined, tojson(byB));
+    assert.eq(500, byB.docsExamined, tojson(byB));
+    assert(/COLLSCAN/.test(byB.planSummary), tojson(byB));
+
+    var all = findShape(shapes, {});
+    assert.neq(null, all, tojson(shapes));
+    assert.eq(1, all.executions, tojson(all));
+    assert.eq(100, all.nReturned, tojson(all));
+
+    // The shapes that took the most time come first.
+    for (i = 1; i < shapes.length; i++) {
+        assert.gte(shapes[i - 1].totalMicros, shapes[i].totalMicros, tojson(shapes));
+    }
+
+    // A new index changes the plan of the second shape.
+    assert.commandWorked(coll.ensureIndex({b: 1}));
+    assert.eq(4, coll.find({b: {$gt: 95}}).sort({b: -1}).itcount());
+    byB = findShape(getShapes(), {b: {$gt: 95}});
+    assert.eq(6, byB.executions, tojson(byB));
+    assert.eq(1, byB.planChanges, tojson(byB));
+    assert(/IXSCAN/.test(byB.planSummary), tojson(byB));
+
+    // The statistics are returned one last time when they are reset.
+    assert.commandFailed(db.runCommand({queryShapeStats: coll.getName(), reset: 1}));
+    assert.eq(3, getShapes(true).length);
+    assert.eq([], getShapes());
+
+    assert.commandFailed(db.runCommand({queryShapeStats: 'query_shape_stats_missing'}));
+}());
@@ -0,0 +1,55 @@
+// Expensive serverStatus sections are served from a snapshot for up to
+// serverStatusExpensiveSectionMaxAgeMillis, and sectionTiming reports each section's cost and the
+// age of its snapshot.
+(function() {
+    'use strict';
+
+    var admin = db.getSiblingDB('admin');
+
+    function timing(options) {
+        var cmd = {serverStatus: 1, sectionTiming: 1};
+        Object.extend(cmd, options || {});
+        var res = assert.commandWorked(admin.runCommand(cmd));
+        assert(res.sectionTiming, tojson(res));
+        return res.sectionTiming;
+    }
+
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           serverStatusExpensiveSectionMaxAgeMillis: 60000}));
+    try {
+        timing();
+        var t = timing();
+        assert(t.locks.hasOwnProperty('micros'), tojson(t));
+        assert.gte(t.locks.snapshotAgeMillis, 0, tojson(t));
+        assert(t.locks.hasOwnProperty('snapshotTime'), tojson(t));
+
+        // Cheap sections are always generated.
+        assert(t.connections.hasOwnProperty('micros'), tojson(t));
+        assert(!t.connections.hasOwnProperty('snapshotAgeMillis'), tojson(t));
+
+        // Configuring a section asks for a fresh one.
+        t = timing({locks: {}});
+        assert(!t.locks.hasOwnProperty('snapshotAgeMillis'), tojson(t));
+
+        // Without sectionTiming there is no report.
+        var res = assert.commandWorked(admin.runCommand({serverStatus: 1}));
+        assert(!res.hasOwnProperty('sectionTiming'), tojson(res));
+        assert(res.locks, tojson(res));
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1,
+                                               serverStatusExpensiveSectionMaxAgeMillis: 1000}));
+    }
+
+    // A maximum age of 0 turns the snapshots off.
+    assert.commandWorked(admin.runCommand({setParameter: 1,
+                                           serverStatusExpensiveSectionMaxAgeMillis: 0}));
+    try {
+        t = timing();
+        assert(!t.locks.hasOwnProperty('snapshotAgeMillis'), tojson(t));
+    }
+    finally {
+        assert.commandWorked(admin.runCommand({setParameter: 1,
+                                               serverStatusExpensiveSectionMaxAgeMillis: 1000}));
+    }
+}());
@@ -0,0 +1,36 @@
+// A getMore on a tailable, awaitData cursor waits for an insert into the capped collection, and
+// returns the new document as soon as it is committed. With nothing inserted it gives up after a
+// few seconds.
+(function() {
+    'use strict';
+
+    var coll = db.tailable_await_data;
+    coll.drop();
+    assert.commandWorked(db.createCollection(coll.getName(), {capped: true, size: 4096}));
+    assert.writeOK(coll.insert({_id: 0}));
+
+    var cursor = coll.find().addOption(DBQuery.Option.tailable)
+                            .addOption(DBQuery.Option.awaitData);
+    assert.eq(0, cursor.next()._id);
+
+    var start = new Date();
+    assert(!cursor.hasNext());
+    assert.gte(new Date() - start, 1000);
+
+    var join = startParallelShell('sleep(500); assert.writeOK(db.tailable_await_data.insert({_id: 1}));');
+    assert.soon(function() {
+        return cursor.hasNext();
+    });
+    assert.eq(1, cursor.next()._id);
+    join();
+
+    // A write to another capped collection doesn't return anything.
+    var other = db.tailable_await_data_other;
+    other.drop();
+    assert.commandWorked(db.createCollection(other.getName(), {capped: true, size: 4096}));
+    assert.writeOK(other.insert({_id: 0}));
+    assert(!cursor.hasNext());
+
+    coll.drop();
+    other.drop();
+}());
@@ -0,0 +1,62 @@
+// Tests that an update only generates new keys for the indexes over the fields it changes, and
+// that every index is still correct afterwards.
+(function() {
+    'use strict';
+
+    var coll = db.update_skips_indexes;
+    coll.drop();
+    var fields = ['a', 'b', 'c', 'd', 'e', 'f'];
+    fields.forEach(function(field) {
+        var key = {};
+        key[field] = 1;
+        assert.commandWorked(coll.ensureIndex(key));
+    });
+    assert.commandWorked(coll.ensureIndex({'g.h': 1, a: 1}));
+    assert.commandWorked(coll.ensureIndex({tags: 1}));
+
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({_id: i, a: i, b: i, c: i, d: i, e: i, f: i, g: {h: i},
+                                    tags: ['x' + i, 'y'], pad: ''}));
+    }
+
+    function skipped() {
+        return db.serverStatus().metrics.record.indexUpdatesSkipped;
+    }
+
+    // Only the indexes on 'a' change, so the six others are skipped.
+    var before = skipped();
+    assert.writeOK(coll.update({_id: 1}, {$inc: {a: 100}, $set: {pad: 'x'}}));
+    assert.eq(6, skipped() - before);
+    assert.eq(1, coll.find({a: 101}).hint({a: 1}).itcount());
+    assert.eq(0, coll.find({a: 1}).hint({a: 1}).itcount());
+    assert.eq(1, coll.find({'g.h': 1, a: 101}).hint({'g.h': 1, a: 1}).itcount());
+    assert.eq(1, coll.find({b: 1}).hint({b: 1}).itcount());
+
+    // A nested and an array field.
+    before = skipped();
+    assert.writeOK(coll.update({_id: 2}, {$set: {'g.h': 200}, $push: {tags: 'z'}}));
+    assert.eq(6, skipped() - before);
+    assert.eq(1, coll.find({'g.h': 200}).hint({'g.h': 1, a: 1}).itcount());
+    assert.eq(1, coll.find({tags: 'z'}).hint({tags: 1}).itcount());
+    assert.eq(10, coll.find({tags: 'y'}).hint({tags: 1}).itcount());
+
+    // A replacement may change any field, so nothing is skipped.
+    before = skipped();
+    assert.writeOK(coll.update({_id: 3}, {a: 3, b: 300}));
+    assert.eq(0, skipped() - before);
+    assert.eq(1, coll.find({b: 300}).hint({b: 1}).itcount());
+    assert.eq(0, coll.find({c: 3}).hint({c: 1}).itcount());
+
+    // Updates that make the document grow and move it still reindex it everywhere.
+    assert.writeOK(coll.update({_id: 4}, {$set: {pad: new Array(10000).join('x'), f: 400}}));
+    fields.forEach(function(field) {
+        var key = {};
+        key[field] = 1;
+        var query = {_id: 4};
+        query[field] = field === 'f' ? 400 : 4;
+        assert.eq(1, coll.find(query).hint(key).itcount(), tojson(key));
+    });
+
+    var res = coll.validate(true);
+    assert(res.valid, tojson(res));
+}());
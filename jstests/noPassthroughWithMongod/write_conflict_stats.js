@@ -0,0 +1,49 @@
+// serverStatus reports the write conflicts retried on each namespace, and a sample of the records
+// which conflicted the most.
+(function() {
+    'use strict';
+
+    var coll = db.write_conflict_stats;
+    coll.drop();
+    assert.writeOK(coll.insert({_id: 0, n: 0}));
+
+    var stats = db.serverStatus().writeConflicts;
+    assert(stats, tojson(db.serverStatus()));
+    assert.eq('object', typeof stats.namespaces, tojson(stats));
+    assert(Array.isArray(stats.sampledRecords), tojson(stats));
+
+    // Only document-level locking storage engines have write conflicts.
+    if (db.serverStatus().storageEngine.name !== 'wiredTiger') {
+        return;
+    }
+
+    var numShells = 4;
+    var numUpdates = 2000;
+    var joins = [];
+    for (var i = 0; i < numShells; i++) {
+        joins.push(startParallelShell(
+            'for (var i = 0; i < ' + numUpdates + '; i++) {' +
+            '    assert.writeOK(db.write_conflict_stats.update({_id: 0}, {$inc: {n: 1}}));' +
+            '}'));
+    }
+    joins.forEach(function(join) {
+        join();
+    });
+    assert.eq(numShells * numUpdates, coll.findOne().n);
+
+    stats = db.serverStatus().writeConflicts;
+    var conflicts = stats.namespaces[coll.getFullName()];
+    if (conflicts) {
+        assert.gt(conflicts, 0, tojson(stats));
+    }
+    stats.sampledRecords.forEach(function(record) {
+        assert(record.hasOwnProperty('ns'), tojson(stats));
+        assert(record.hasOwnProperty('recordId'), tojson(stats));
+        assert.gt(record.conflicts, 0, tojson(stats));
+    });
+    for (var j = 1; j < stats.sampledRecords.length; j++) {
+        assert.gte(stats.sampledRecords[j - 1].conflicts, stats.sampledRecords[j].conflicts,
+                   tojson(stats));
+    }
+    assert.lte(stats.sampledRecords.length, 10, tojson(stats));
+}());
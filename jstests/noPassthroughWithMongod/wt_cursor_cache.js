@@ -0,0 +1,61 @@
+// WiredTiger sessions reuse the cursors of earlier operations, up to wiredTigerCursorCacheSize of
+// them, and serverStatus reports how many were reused, opened and closed to stay within it.
+(function() {
+    'use strict';
+
+    if (db.serverStatus().storageEngine.name !== 'wiredTiger') {
+        return;
+    }
+
+    var numColls = 20;
+    for (var i = 0; i < numColls; i++) {
+        var coll = db.getCollection('wt_cursor_cache' + i);
+        coll.drop();
+        assert.writeOK(coll.insert({_id: 0, a: 0}));
+        assert.commandWorked(coll.ensureIndex({a: 1}));
+    }
+
+    function cursorStats() {
+        // Passing the section a config object skips its cached snapshot.
+        return db.serverStatus({wiredTiger: {}}).wiredTiger.sessionCache;
+    }
+
+    function readAll() {
+        for (var i = 0; i < numColls; i++) {
+            var coll = db.getCollection('wt_cursor_cache' + i);
+            assert.eq(1, coll.find({_id: 0}).itcount());
+            assert.eq(1, coll.find({a: 0}).hint({a: 1}).itcount());
+        }
+    }
+
+    var before = cursorStats();
+    assert(before.hasOwnProperty('cursorHits'), tojson(before));
+    readAll();
+    readAll();
+    var after = cursorStats();
+    assert.gt(after.cursorHits, before.cursorHits, tojson(after));
+
+    // With the cache disabled every cursor is closed once it's released.
+    assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerCursorCacheSize: 0}));
+    try {
+        before = cursorStats();
+        readAll();
+        after = cursorStats();
+        assert.gte(after.cursorOpens - before.cursorOpens, 2 * numColls, tojson(after));
+    }
+    finally {
+        assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerCursorCacheSize: 100}));
+    }
+
+    // A cache smaller than the number of tables in use evicts cursors.
+    assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerCursorCacheSize: 2}));
+    try {
+        before = cursorStats();
+        readAll();
+        after = cursorStats();
+        assert.gt(after.cursorEvictions, before.cursorEvictions, tojson(after));
+    }
+    finally {
+        assert.commandWorked(db.adminCommand({setParameter: 1, wiredTigerCursorCacheSize: 100}));
+    }
+}());
@@ -0,0 +1,62 @@
+// Secondaries apply runs of consecutive inserts on a collection as bulk inserts, and fall back to
+// one insert at a time when a run can't be applied whole.  Either way the secondary must end up
+// with the primary's documents.
+(function() {
+    'use strict';
+
+    var rt = new ReplSetTest({name: "apply_insert_batches", nodes: 2, oplogSize: 40});
+    rt.startSet();
+    rt.initiate();
+    rt.awaitSecondaryNodes();
+
+    var primary = rt.getPrimary();
+    var secondary = rt.getSecondary();
+    var testDB = primary.getDB("test");
+    secondary.setSlaveOk();
+
+    assert.commandWorked(testDB.createCollection("capped", {capped: true, size: 64 * 1024}));
+    assert.commandWorked(testDB.unique.ensureIndex({u: 1}, {unique: true}));
+
+    function insertMany(coll, n, makeDoc) {
+        var bulk = coll.initializeOrderedBulkOp();
+        for (var i = 0; i < n; i++) {
+            bulk.insert(makeDoc(i));
+        }
+        assert.writeOK(bulk.execute());
+    }
+
+    function check() {
+        rt.awaitReplication();
+        ["plain", "capped", "unique", "mixed"].forEach(function(name) {
+            var onPrimary = testDB[name].find().sort({$natural: 1}).toArray();
+            var onSecondary = secondary.getDB("test")[name].find().sort({$natural: 1}).toArray();
+            assert.eq(onPrimary.length, onSecondary.length, name);
+            assert.eq(onPrimary, onSecondary, name);
+        });
+    }
+
+    insertMany(testDB.plain, 2000, function(i) { return {_id: i, x: 'x' + i}; });
+    insertMany(testDB.capped, 2000, function(i) { return {_id: i, pad: new Array(100).join('p')}; });
+    insertMany(testDB.unique, 500, function(i) { return {_id: i, u: i}; });
+    // Inserts interleaved with updates, removes and inserts on another collection.
+    var bulk = testDB.mixed.initializeOrderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({_id: i, n: 0});
+        if (i % 7 === 0) {
+            bulk.find({_id: i}).updateOne({$inc: {n: 1}});
+        }
+        if (i % 11 === 0) {
+            bulk.find({_id: i - 1}).removeOne();
+        }
+    }
+    assert.writeOK(bulk.execute());
+    check();
+
+    // With batching turned off.
+    assert.commandWorked(secondary.adminCommand({setParameter: 1, replWriterInsertBatchSize: 1}));
+    insertMany(testDB.plain, 500, function(i) { return {_id: 'off' + i}; });
+    assert.commandWorked(secondary.adminCommand({setParameter: 1, replWriterInsertBatchSize: 64}));
+    check();
+
+    rt.stopSet();
+}());
@@ -0,0 +1,51 @@
+// With replIndexBuildsInBackground set, a secondary builds the indexes the primary built in the
+// foreground as background builds, and keeps applying the oplog while they run.
+(function() {
+    'use strict';
+
+    var rt = new ReplSetTest({name: "index_builds_in_background", nodes: 2});
+    rt.startSet();
+    rt.initiate();
+    rt.awaitSecondaryNodes();
+
+    var primary = rt.getPrimary();
+    var secondary = rt.getSecondary();
+    var testDB = primary.getDB("test");
+    secondary.setSlaveOk();
+    assert.commandWorked(
+        secondary.adminCommand({setParameter: 1, replIndexBuildsInBackground: true}));
+
+    var bulk = testDB.coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 10000; i++) {
+        bulk.insert({_id: i, a: i % 100, b: i});
+    }
+    assert.writeOK(bulk.execute());
+    rt.awaitReplication();
+
+    assert.commandWorked(testDB.coll.ensureIndex({a: 1}));
+    assert.commandWorked(testDB.coll.ensureIndex({b: 1}, {unique: true}));
+    for (var i = 10000; i < 10100; i++) {
+        assert.writeOK(testDB.coll.insert({_id: i, a: i % 100, b: i}));
+    }
+    rt.awaitReplication();
+
+    function indexSpec(key) {
+        var specs = secondary.getDB("test").coll.getIndexes().filter(function(spec) {
+            return friendlyEqual(spec.key, key);
+        });
+        return specs.length ? specs[0] : null;
+    }
+
+    assert.soon(function() {
+        return indexSpec({a: 1}) && indexSpec({b: 1});
+    }, "indexes not built on the secondary");
+    assert(indexSpec({a: 1}).background, tojson(indexSpec({a: 1})));
+    assert(indexSpec({b: 1}).unique, tojson(indexSpec({b: 1})));
+
+    // The indexes include the documents written while they were being built.
+    var secondaryColl = secondary.getDB("test").coll;
+    assert.eq(101, secondaryColl.find({a: 7}).hint({a: 1}).itcount());
+    assert.eq(1, secondaryColl.find({b: 10050}).hint({b: 1}).itcount());
+
+    rt.stopSet();
+}());
@@ -0,0 +1,52 @@
+// Secondaries fetch the oplog either with a getMore per batch or streamed by the sync source
+// (replOplogFetchExhaust), and the size of the buffer of fetched entries can be changed at runtime.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'oplog_fetch_exhaust', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getPrimary();
+    var secondary = replTest.getSecondary();
+    var coll = primary.getDB('test').oplog_fetch_exhaust;
+
+    function writeAndCheck(n) {
+        var bulk = coll.initializeUnorderedBulkOp();
+        for (var i = 0; i < 1000; i++) {
+            bulk.insert({batch: n, i: i, pad: new Array(1000).join('x')});
+        }
+        assert.writeOK(bulk.execute({w: 2, wtimeout: 60000}));
+        secondary.setSlaveOk();
+        assert.eq(1000, secondary.getDB('test').oplog_fetch_exhaust.count({batch: n}));
+    }
+
+    function setSecondaryParameter(params) {
+        params.setParameter = 1;
+        assert.commandWorked(secondary.adminCommand(params));
+    }
+
+    // Streaming is the default.
+    writeAndCheck(0);
+
+    // A new query is only started when the sync source is chosen again, so restart syncing.
+    setSecondaryParameter({replOplogFetchExhaust: false});
+    assert.commandWorked(secondary.adminCommand({replSetSyncFrom: primary.host}));
+    writeAndCheck(1);
+
+    setSecondaryParameter({replOplogFetchExhaust: true});
+    assert.commandWorked(secondary.adminCommand({replSetSyncFrom: primary.host}));
+    writeAndCheck(2);
+
+    // The buffer must be able to hold the largest oplog entry.
+    assert.commandFailed(secondary.adminCommand({setParameter: 1,
+                                                 replBufferMaxSizeBytes: 1024 * 1024}));
+    setSecondaryParameter({replBufferMaxSizeBytes: 32 * 1024 * 1024});
+    writeAndCheck(3);
+    assert.soon(function() {
+        var buffer = secondary.adminCommand({serverStatus: 1}).metrics.repl.buffer;
+        return buffer.maxSizeBytes == 32 * 1024 * 1024;
+    });
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,85 @@
+// A replacement-style update that changes a few fields of a large document is logged as the $set
+// and $unset operators for those fields. Secondaries must end up with exactly the same documents.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'oplog_replacement_diff', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getPrimary();
+    var coll = primary.getDB('test').oplog_replacement_diff;
+    var oplog = primary.getDB('local').oplog.rs;
+
+    function lastEntry() {
+        return oplog.find({ns: coll.getFullName()}).sort({$natural: -1}).limit(1).next();
+    }
+
+    var pad = new Array(2048).join('x');
+    var doc = {_id: 1, a: 1, b: {c: pad, d: 2, e: [1, 2]}, f: 'f', g: pad};
+    assert.writeOK(coll.insert(doc));
+
+    // Changed, removed and added fields, including nested ones.
+    doc = {_id: 1, a: 2, b: {c: pad, e: [1, 3], h: 'h'}, g: pad, i: 'i'};
+    assert.writeOK(coll.update({_id: 1}, doc));
+    var entry = lastEntry();
+    assert.eq('u', entry.op, tojson(entry));
+    assert.eq({$set: {a: 2, 'b.e': [1, 3], 'b.h': 'h', i: 'i'}, $unset: {'b.d': true, f: true}},
+              entry.o,
+              tojson(entry));
+    assert.eq({_id: 1}, entry.o2, tojson(entry));
+
+    // Reordered fields can't be reproduced with $set and $unset.
+    doc = {_id: 1, g: pad, a: 3, b: {c: pad, e: [1, 3], h: 'h'}, i: 'i'};
+    assert.writeOK(coll.update({_id: 1}, doc));
+    entry = lastEntry();
+    assert.eq(doc, entry.o, tojson(entry));
+
+    // Nor is it worth it when most of the document changes.
+    doc = {_id: 1, g: 'y' + pad, a: 3, b: {c: 'z' + pad}};
+    assert.writeOK(coll.update({_id: 1}, doc));
+    entry = lastEntry();
+    assert.eq(doc, entry.o, tojson(entry));
+
+    // And it can be turned off.
+    assert.commandWorked(primary.adminCommand({setParameter: 1,
+                                               internalQueryExecReplacementDiffPercent: 0}));
+    doc.a = 4;
+    assert.writeOK(coll.update({_id: 1}, doc));
+    entry = lastEntry();
+    assert.eq(doc, entry.o, tojson(entry));
+    assert.commandWorked(primary.adminCommand({setParameter: 1,
+                                               internalQueryExecReplacementDiffPercent: 50}));
+
+    // Saves of many documents, each changing one field.
+    for (var i = 2; i < 50; i++) {
+        assert.writeOK(coll.insert({_id: i, n: i, pad: pad, sub: {m: i, pad: pad}}));
+    }
+    for (i = 2; i < 50; i++) {
+        var d = coll.findOne({_id: i});
+        if (i % 3 === 0) {
+            d.n = 'n' + i;
+        }
+        else if (i % 3 === 1) {
+            d.sub.m = -i;
+        }
+        else {
+            delete d.n;
+            d.added = i;
+        }
+        assert.writeOK(coll.save(d));
+    }
+
+    replTest.awaitReplication();
+    var secondaryColl = replTest.getSecondary().getDB('test').oplog_replacement_diff;
+    var onPrimary = coll.find().sort({_id: 1}).toArray();
+    var onSecondary = secondaryColl.find().sort({_id: 1}).toArray();
+    assert.eq(onPrimary.length, onSecondary.length);
+    for (i = 0; i < onPrimary.length; i++) {
+        // Compare BSON, so that field order and types count.
+        assert.eq(0, bsonWoCompare(onPrimary[i], onSecondary[i]), tojson(onSecondary[i]));
+        assert.eq(Object.keySet(onPrimary[i]), Object.keySet(onSecondary[i]));
+    }
+
+    replTest.stopSet();
+}());
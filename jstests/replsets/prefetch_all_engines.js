@@ -0,0 +1,51 @@
+// Secondaries read the documents and index keys each batch of oplog entries touches before
+// applying it, on every storage engine, unless replIndexPrefetch is "none".
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'prefetch_all_engines', nodes: 2});
+    replTest.startSet();
+    replTest.initiate();
+
+    var primary = replTest.getPrimary();
+    var secondary = replTest.getSecondary();
+    var coll = primary.getDB('test').prefetch_all_engines;
+    assert.commandWorked(coll.ensureIndex({a: 1}));
+
+    function preload() {
+        return secondary.adminCommand({serverStatus: 1}).metrics.repl.preload;
+    }
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.insert({_id: i, a: i});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    var before = preload();
+    bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; i++) {
+        bulk.find({_id: i}).updateOne({$set: {a: -i}});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+    var after = preload();
+    assert.gt(after.docs.num, before.docs.num, tojson(after));
+    assert.gt(after.indexes.num, before.indexes.num, tojson(after));
+
+    // Deletes prefetch the document too.
+    before = after;
+    assert.writeOK(coll.remove({_id: {$lt: 100}}, {writeConcern: {w: 2}}));
+    after = preload();
+    assert.gt(after.docs.num, before.docs.num, tojson(after));
+
+    assert.commandWorked(secondary.adminCommand({setParameter: 1, replIndexPrefetch: 'none'}));
+    before = preload();
+    assert.writeOK(coll.update({}, {$inc: {a: 1}}, {multi: true, writeConcern: {w: 2}}));
+    after = preload();
+    assert.eq(before.indexes.num, after.indexes.num, tojson(after));
+
+    secondary.setSlaveOk();
+    assert.eq(400, secondary.getDB('test').prefetch_all_engines.count({a: {$lte: 1}}));
+
+    replTest.stopSet();
+}());
@@ -0,0 +1,69 @@
+// Rollback refetches the documents to roll back in batches per collection.  Roll back updates,
+// deletes and inserts of many documents in several collections, and check that the rolled back
+// member ends up with the same data as the primary.
+(function() {
+    'use strict';
+
+    var replTest = new ReplSetTest({name: 'rollback_bulk_refetch', nodes: 3});
+    var nodes = replTest.nodeList();
+
+    var conns = replTest.startSet();
+    replTest.initiate({"_id": "rollback_bulk_refetch",
+                       "members": [
+                           {"_id": 0, "host": nodes[0], priority: 3},
+                           {"_id": 1, "host": nodes[1]},
+                           {"_id": 2, "host": nodes[2], arbiterOnly: true}]
+                      });
+
+    replTest.waitForState(replTest.nodes[0], replTest.PRIMARY, 60 * 1000);
+    var a_conn = conns[0];
+    var b_conn = conns[1];
+    a_conn.setSlaveOk();
+    b_conn.setSlaveOk();
+    var A = a_conn.getDB("test");
+    var B = b_conn.getDB("test");
+    var AID = replTest.getNodeId(a_conn);
+    var BID = replTest.getNodeId(b_conn);
+    assert.eq(a_conn.host, replTest.getMaster().host);
+
+    var numDocs = 2500;
+    ['updated', 'deleted', 'inserted'].forEach(function(name) {
+        var bulk = A[name].initializeUnorderedBulkOp();
+        for (var i = 0; i < numDocs; i++) {
+            // Mix _id types, which must still be matched with the documents refetched.
+            bulk.insert({_id: i % 3 ? i : 'id' + i, x: 0});
+        }
+        assert.writeOK(bulk.execute({w: 2, wtimeout: 60000}));
+    });
+
+    // Write on B only, so that these writes are rolled back.
+    replTest.stop(AID);
+    assert.eq(b_conn.host, replTest.getMaster().host);
+    assert.writeOK(B.updated.update({}, {$set: {x: 1}}, {multi: true}));
+    assert.writeOK(B.deleted.remove({_id: {$type: 2}}));
+    var bulk = B.inserted.initializeUnorderedBulkOp();
+    for (var i = numDocs; i < 2 * numDocs; i++) {
+        bulk.insert({_id: i, x: 1});
+    }
+    assert.writeOK(bulk.execute());
+
+    replTest.stop(BID);
+    replTest.restart(AID);
+    assert.eq(a_conn.host, replTest.getMaster().host);
+    assert.writeOK(A.updated.update({_id: 1}, {$set: {x: 2}},
+                                    {writeConcern: {w: 1, wtimeout: 60000}}));
+    replTest.restart(BID);
+
+    replTest.awaitReplication();
+    replTest.awaitSecondaryNodes();
+
+    ['updated', 'deleted', 'inserted'].forEach(function(name) {
+        var expected = A[name].find().sort({_id: 1}).toArray();
+        assert.eq(numDocs, expected.length, name);
+        assert.eq(expected, B[name].find().sort({_id: 1}).toArray(), name);
+    });
+    assert.eq(0, B.updated.find({x: 1}).itcount());
+    assert.eq(2, B.updated.findOne({_id: 1}).x);
+
+    replTest.stopSet(15);
+}());
@@ -77,6 +77,16 @@ assert.eq(testDB.serverStatus().metrics.getLastError.wtime.num, startNum + 1);
 assert.writeError(testDB.a.insert({ x: 1 }, { writeConcern: { w: 3, wtimeout: 50 }}));
 assert.eq(testDB.serverStatus().metrics.getLastError.wtime.num, startNum + 2);
 
+// Satisfied write concerns are also recorded in latency histograms, w:majority separately.
+var latency = testDB.serverStatus().metrics.getLastError.wtimeLatency;
+var startMajority = latency.majority.count;
+var startOther = latency.other.count;
+assert.gt(startOther, 0, tojson(latency));
+assert.writeOK(testDB.a.insert({ x: 1 }, { writeConcern: { w: "majority", wtimeout: 5000 }}));
+latency = testDB.serverStatus().metrics.getLastError.wtimeLatency;
+assert.eq(latency.majority.count, startMajority + 1, tojson(latency));
+assert.eq(latency.other.count, startOther, tojson(latency));
+
 printjson(primary.getDB("test").serverStatus().metrics);
 
 rt.stopSet();
@@ -0,0 +1,42 @@
+// With replUpdatePositionCoalesceMillis set, secondaries send position updates upstream at most
+// once per window, folding the progress made meanwhile into one replSetUpdatePosition command.
+(function() {
+    'use strict';
+
+    var rt = new ReplSetTest({name: "update_position_coalesce", nodes: 2, oplogSize: 10});
+    rt.startSet();
+    rt.initiate();
+    rt.awaitSecondaryNodes();
+
+    var primary = rt.getPrimary();
+    var secondary = rt.getSecondary();
+    var coll = primary.getDB("test").update_position_coalesce;
+
+    function updatePositionStats() {
+        var stats = secondary.getDB("admin").serverStatus().metrics.repl.network.updatePosition;
+        assert(stats, "no updatePosition metrics");
+        return stats;
+    }
+
+    assert.commandWorked(secondary.adminCommand({setParameter: 1,
+                                                 replUpdatePositionCoalesceMillis: 200}));
+    var before = updatePositionStats();
+
+    for (var i = 0; i < 20; i++) {
+        assert.writeOK(coll.insert({_id: i}));
+    }
+    // Writes are still acknowledged, although later.
+    assert.writeOK(coll.insert({_id: "last"}, {writeConcern: {w: 2, wtimeout: 60 * 1000}}));
+
+    var after = updatePositionStats();
+    printjson(after);
+    assert.gt(after.sent, before.sent, tojson(after));
+    assert.gt(after.coalesced, before.coalesced, tojson(after));
+    assert.gt(after.waitMillis, before.waitMillis, tojson(after));
+
+    assert.commandWorked(secondary.adminCommand({setParameter: 1,
+                                                 replUpdatePositionCoalesceMillis: 0}));
+    assert.writeOK(coll.insert({_id: "final"}, {writeConcern: {w: 2, wtimeout: 60 * 1000}}));
+
+    rt.stopSet();
+}());
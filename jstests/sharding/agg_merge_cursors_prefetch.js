@@ -0,0 +1,52 @@
+// The merging half of a sharded aggregation asks every shard for its next batch ahead of time, and
+// returns results from whichever shard has some on hand. Checks that each result still comes back
+// exactly once.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'agg_merge_cursors_prefetch', shards: 3, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var db = mongos.getDB('test');
+    var coll = db.data;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+
+    var N = 6000;
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var others = st.config.shards.find({_id: {$ne: primary}}).toArray();
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 1000}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 4000}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 2000}, to: others[0]._id, _waitForDelete: true}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 5000}, to: others[1]._id, _waitForDelete: true}));
+
+    // Big enough documents that each shard returns its results over several batches.
+    var pad = new Array(2000).join('x');
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        bulk.insert({_id: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    // A $project keeps the shards from sending everything in one reply.
+    var pipeline = [{$match: {_id: {$gte: 0}}}, {$project: {pad: 1}}];
+
+    var seen = {};
+    var n = 0;
+    coll.aggregate(pipeline, {cursor: {batchSize: 10}}).forEach(function(doc) {
+        assert(!seen[doc._id], 'returned twice: ' + doc._id);
+        seen[doc._id] = true;
+        n++;
+    });
+    assert.eq(N, n);
+
+    // Also when the merging runs on the primary shard, for $out.
+    coll.aggregate(pipeline.concat([{$out: 'copied'}]));
+    assert.eq(N, db.copied.count());
+
+    st.stop();
+}());
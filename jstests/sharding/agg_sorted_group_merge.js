@@ -0,0 +1,72 @@
+// Shards return their partial $group results sorted by _id, and mongos merges those streams and
+// combines them one group at a time. Checks that every group is complete, including for keys of
+// mixed types and groups found on every shard, and that a requested order is kept.
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'agg_sorted_group_merge', shards: 3, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var db = mongos.getDB('test');
+    var coll = db.data;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+
+    var N = 3000;
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var others = st.config.shards.find({_id: {$ne: primary}}).toArray();
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 1000}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 2000}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 1500}, to: others[0]._id, _waitForDelete: true}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 2500}, to: others[1]._id, _waitForDelete: true}));
+
+    var numKeys = 500;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        // Every key is found on every shard; odd keys are strings, and some documents have none.
+        var k = i % numKeys;
+        var doc = {_id: i, v: i};
+        if (k === 0) {
+            if (i % 1000 === 0) {
+                doc.k = null;
+            }
+        }
+        else {
+            doc.k = k % 2 ? 'k' + k : k;
+        }
+        bulk.insert(doc);
+    }
+    assert.writeOK(bulk.execute());
+
+    function checkGroups(res) {
+        assert.eq(numKeys, res.length, tojson(res));
+        res.forEach(function(group) {
+            assert.eq(N / numKeys, group.n, tojson(group));
+        });
+    }
+
+    var res = coll.aggregate([{$group: {_id: '$k', n: {$sum: 1}, v: {$max: '$v'}}}]).toArray();
+    checkGroups(res);
+
+    res = coll.aggregate([{$group: {_id: '$k', n: {$sum: 1}}}, {$sort: {_id: 1}}]).toArray();
+    checkGroups(res);
+    for (var j = 1; j < res.length; j++) {
+        assert.lt(bsonWoCompare({_: res[j - 1]._id}, {_: res[j]._id}), 0, tojson(res));
+    }
+    assert.eq(null, res[0]._id);
+
+    res = coll.aggregate([{$group: {_id: '$k', n: {$sum: 1}}}, {$sort: {_id: -1}}]).toArray();
+    checkGroups(res);
+    assert.eq(null, res[res.length - 1]._id);
+
+    // Also when the merging runs on the primary shard, for $out.
+    coll.aggregate([{$group: {_id: '$k', n: {$sum: 1}}}, {$out: 'grouped'}]);
+    checkGroups(db.grouped.find().toArray());
+
+    st.stop();
+}());
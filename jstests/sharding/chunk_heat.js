@@ -0,0 +1,73 @@
+// Shards track how often each of their chunks is read and written, and report it to the balancer
+// through _getChunkHeat.
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'chunk_heat', shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB('admin');
+    var coll = mongos.getDB('test').data;
+
+    assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+    assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {x: 0}}));
+
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var shard = st.shard0.shardName == primary ? st.shard0 : st.shard1;
+
+    // Sample every op so that the counts are exact.
+    assert.commandWorked(shard.getDB('admin').runCommand({setParameter: 1, chunkHeatSampleRate: 1}));
+
+    for (var i = 1; i <= 100; i++) {
+        assert.writeOK(coll.insert({x: -i}));
+    }
+    for (var i = 0; i < 10; i++) {
+        assert.writeOK(coll.insert({x: i}));
+    }
+    for (var i = 1; i <= 20; i++) {
+        assert.writeOK(coll.update({x: -i}, {$set: {y: 1}}));
+    }
+    // Writes without the shard key aren't attributed to any chunk.
+    assert.writeOK(coll.update({y: 1}, {$set: {z: 1}}, {multi: true}));
+    assert.eq(100, coll.find({x: {$lt: 0}}).itcount());
+
+    function heatOf(min) {
+        var res = shard.getDB('admin').runCommand({_getChunkHeat: coll.getFullName()});
+        assert.commandWorked(res);
+        assert.eq(1, res.sampleRate, tojson(res));
+        var chunk = null;
+        res.chunks.forEach(function(c) {
+            if (bsonWoCompare(c.min, min) == 0) {
+                chunk = c;
+            }
+        });
+        assert(chunk, 'no heat for chunk at ' + tojson(min) + ': ' + tojson(res));
+        return chunk;
+    }
+
+    var cold = heatOf({x: 0});
+    assert.eq({x: MaxKey}, cold.max);
+    assert.gte(cold.writes, 10, tojson(cold));
+    assert.lt(cold.writes, 15, tojson(cold));
+
+    var hot = heatOf({x: MinKey});
+    assert.eq({x: 0}, hot.max);
+    assert.gte(hot.writes, 110, tojson(hot));
+    assert.lt(hot.writes, 125, tojson(hot));
+    assert.gte(hot.reads, 100, tojson(hot));
+
+    // Unsharded collections have no heat.
+    var res = shard.getDB('admin').runCommand({_getChunkHeat: 'test.unsharded'});
+    assert.commandWorked(res);
+    assert.eq([], res.chunks);
+
+    assert.commandFailed(shard.getDB('admin').runCommand({_getChunkHeat: ''}));
+
+    // The balancer can be told to use it.
+    assert.commandWorked(admin.runCommand({setParameter: 1, balancerUseChunkHeat: true}));
+
+    st.stop();
+}());
@@ -0,0 +1,78 @@
+// Checks that mongos accounts for the shard batches its cursors read ahead in cursorInfo, and that
+// the read-ahead limits are honored without changing query results.
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'cursor_read_ahead_limits', shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB('admin');
+    var coll = mongos.getDB('test').data;
+
+    assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+    assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+    assert.commandWorked(admin.runCommand({split: coll.getFullName(), middle: {_id: 1000}}));
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var other = st.config.shards.findOne({_id: {$ne: primary}})._id;
+    assert.commandWorked(admin.runCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 1500}, to: other, _waitForDelete: true}));
+
+    var N = 2000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        bulk.insert({_id: i, x: (i * 7919) % N});
+    }
+    assert.writeOK(bulk.execute());
+
+    function readAheadBytes() {
+        return assert.commandWorked(admin.runCommand({cursorInfo: 1})).readAheadBytes;
+    }
+
+    assert.eq(0, readAheadBytes());
+
+    // With the defaults, a cursor left open between batches has the shards' next batches pending.
+    var cursor = coll.find().sort({x: 1}).batchSize(10);
+    for (var j = 0; j < 10; j++) {
+        cursor.next();
+    }
+    assert.gt(readAheadBytes(), 0);
+    assert.eq(N - 10, cursor.itcount());
+    assert.eq(0, readAheadBytes());
+
+    // Closing a cursor part way through releases its share.
+    cursor = coll.find().sort({x: -1}).batchSize(10);
+    cursor.next();
+    cursor.close();
+    assert.soon(function() { return readAheadBytes() == 0; });
+
+    // Cursors over the limits, or with read-ahead turned off, only fetch on demand.
+    [{cursorReadAheadMaxBytesPerCursor: 0},
+     {cursorReadAheadMaxBytesTotal: 0},
+     {cursorReadAhead: false}].forEach(function(param) {
+        var defaults = assert.commandWorked(admin.runCommand(
+            {getParameter: 1, cursorReadAhead: 1, cursorReadAheadMaxBytesPerCursor: 1,
+             cursorReadAheadMaxBytesTotal: 1}));
+        assert.commandWorked(admin.runCommand(Object.extend({setParameter: 1}, param)));
+
+        var cursor = coll.find().sort({x: 1}).batchSize(10);
+        var last = -1;
+        var count = 0;
+        while (cursor.hasNext()) {
+            var doc = cursor.next();
+            assert.gt(doc.x, last, tojson(param));
+            last = doc.x;
+            count++;
+            if (count > 10 && count % 10 == 5) {
+                assert.eq(0, readAheadBytes(), tojson(param));
+            }
+        }
+        assert.eq(N, count, tojson(param));
+
+        delete defaults.ok;
+        assert.commandWorked(admin.runCommand(Object.extend({setParameter: 1}, defaults)));
+    });
+
+    st.stop();
+}());
@@ -0,0 +1,55 @@
+// The recipient of a chunk clones it over several connections at once and applies cloned and
+// transferred documents in batches. All the documents must arrive, whatever the settings.
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'migrate_clone_concurrency', shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var admin = mongos.getDB('admin');
+    var coll = mongos.getDB('test').data;
+
+    assert.commandWorked(admin.runCommand({enableSharding: 'test'}));
+    assert.commandWorked(admin.runCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var other = st.config.shards.findOne({_id: {$ne: primary}})._id;
+
+    // Big enough that each _migrateClone batch holds only part of the chunk.
+    var N = 20000;
+    var pad = new Array(1024).join('x');
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        bulk.insert({_id: i, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    function setOnShards(params) {
+        [st.shard0, st.shard1].forEach(function(shard) {
+            var cmd = Object.extend({setParameter: 1}, params);
+            assert.commandWorked(shard.getDB('admin').runCommand(cmd));
+        });
+    }
+
+    function moveAndCheck(to) {
+        assert.commandWorked(admin.runCommand(
+            {moveChunk: coll.getFullName(), find: {_id: 0}, to: to, _waitForDelete: true}));
+        assert.eq(N, coll.find().itcount());
+        assert.eq(N, coll.find({pad: pad}).itcount());
+        // All of it is on one shard.
+        var counts = [st.shard0, st.shard1].map(function(shard) {
+            return shard.getCollection(coll.getFullName()).count();
+        });
+        assert.eq(N, Math.max(counts[0], counts[1]), tojson(counts));
+        assert.eq(0, Math.min(counts[0], counts[1]), tojson(counts));
+    }
+
+    setOnShards({migrateCloneConcurrency: 4, migrateDocsPerWriteLock: 7});
+    moveAndCheck(other);
+
+    setOnShards({migrateCloneConcurrency: 1, migrateDocsPerWriteLock: 1000});
+    moveAndCheck(primary);
+
+    st.stop();
+}());
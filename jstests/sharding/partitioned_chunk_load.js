@@ -0,0 +1,59 @@
+// Routing tables of collections with many chunks are loaded by reading several ranges of chunk
+// versions in parallel, on mongos and on the shards. The loaded tables must match the chunks.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'partitioned_chunk_load', shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var coll = mongos.getDB('test').data;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+
+    var numChunks = 60;
+    for (var i = 1; i < numChunks; i++) {
+        assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {x: i * 10}}));
+    }
+    for (i = 0; i < numChunks * 10; i++) {
+        assert.writeOK(coll.insert({x: i}));
+    }
+
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var other = st.config.shards.findOne({_id: {$ne: primary}})._id;
+
+    // Read every load of at least 10 chunks in 3 ranges.
+    [mongos, st.shard0, st.shard1].forEach(function(conn) {
+        assert.commandWorked(conn.adminCommand({setParameter: 1, internalChunkReadPartitions: 3}));
+        assert.commandWorked(conn.adminCommand(
+            {setParameter: 1, internalChunkReadPartitionThreshold: 10}));
+    });
+
+    // Moving a chunk reloads the metadata on both shards.
+    for (i = 0; i < numChunks; i += 2) {
+        assert.commandWorked(mongos.adminCommand(
+            {moveChunk: coll.getFullName(), find: {x: i * 10}, to: other, _waitForDelete: true}));
+    }
+
+    assert.commandWorked(mongos.adminCommand({flushRouterConfig: 1}));
+    assert.eq(numChunks * 10, coll.find().itcount());
+    assert.eq(10, coll.find({x: {$gte: 200, $lt: 210}}).itcount());
+
+    var version = mongos.adminCommand({getShardVersion: coll.getFullName()});
+    assert.commandWorked(version);
+    var lastChunk = st.config.chunks.find({ns: coll.getFullName()}).sort({lastmod: -1}).next();
+    assert.eq(lastChunk.lastmod, version.version, tojson(version));
+
+    // Each shard's version is the highest version of its own chunks.
+    [st.shard0, st.shard1].forEach(function(conn) {
+        var res = conn.adminCommand({getShardVersion: coll.getFullName()});
+        assert.commandWorked(res);
+        var name = st.config.shards.findOne({host: conn.host})._id;
+        var shardLastChunk =
+            st.config.chunks.find({ns: coll.getFullName(), shard: name}).sort({lastmod: -1}).next();
+        assert.eq(shardLastChunk.lastmod, res.global, tojson(res));
+    });
+
+    st.stop();
+}());
@@ -2,22 +2,53 @@
 // Tests mongos-only query behavior
 //
 
-var st = new ShardingTest({shards : 1,
+var st = new ShardingTest({shards : 2,
                            mongos : 1,
                            verbose : 0});
+st.stopBalancer();
 
 var mongos = st.s0;
 var coll = mongos.getCollection("foo.bar");
 
 //
 //
-// Ensure we can't use exhaust option through mongos
+// Ensure the exhaust option works through mongos, both for a collection on one shard and for one
+// sharded across both, and that every batch arrives
+function checkExhaust(coll, n) {
+    var query = coll.find({}).batchSize(7).addOption(DBQuery.Option.exhaust);
+    var ids = {};
+    var count = 0;
+    while (query.hasNext()) {
+        var doc = query.next();
+        assert(!ids[doc._id], tojson(doc));
+        ids[doc._id] = true;
+        count++;
+    }
+    assert.eq(n, count);
+}
+
 coll.remove({});
-assert.writeOK(coll.insert({a : 'b'}));
+for (var i = 0; i < 100; i++) {
+    assert.writeOK(coll.insert({_id : i, a : 'b'}));
+}
 var query = coll.find({});
 assert.neq(null, query.next());
-query = coll.find({}).addOption(DBQuery.Option.exhaust);
-assert.throws(function(){ query.next(); });
+checkExhaust(coll, 100);
+
+var shardedColl = mongos.getCollection("foo.sharded");
+assert.commandWorked(mongos.adminCommand({enableSharding : "foo"}));
+var primary = st.config.databases.findOne({_id : "foo"}).primary;
+var other = st.config.shards.findOne({_id : {$ne : primary}})._id;
+assert.commandWorked(mongos.adminCommand({shardCollection : shardedColl.getFullName(),
+                                          key : {_id : 1}}));
+assert.commandWorked(mongos.adminCommand({split : shardedColl.getFullName(), middle : {_id : 50}}));
+assert.commandWorked(mongos.adminCommand({moveChunk : shardedColl.getFullName(),
+                                          find : {_id : 50},
+                                          to : other}));
+for (var i = 0; i < 100; i++) {
+    assert.writeOK(shardedColl.insert({_id : i, a : 'b'}));
+}
+checkExhaust(shardedColl, 100);
 
 //
 //
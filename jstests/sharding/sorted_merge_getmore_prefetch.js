@@ -0,0 +1,60 @@
+// Sorted queries through mongos request each shard's next batch before the current one has been
+// merged. Checks that results stay complete and in order across many small batches, and that
+// cursors closed with a getMore still outstanding leave their connections usable.
+
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'sorted_merge_getmore_prefetch', shards: 3, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var db = mongos.getDB('test');
+    var coll = db.data;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {_id: 1}}));
+
+    var N = 3000;
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var others = st.config.shards.find({_id: {$ne: primary}}).toArray();
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 1000}}));
+    assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {_id: 2000}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 1500}, to: others[0]._id, _waitForDelete: true}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: coll.getFullName(), find: {_id: 2500}, to: others[1]._id, _waitForDelete: true}));
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < N; i++) {
+        // 'x' interleaves the documents of all three shards in the sort order below.
+        bulk.insert({_id: i, x: (i * 7919) % N});
+    }
+    assert.writeOK(bulk.execute());
+
+    [1, 5, 50, 0].forEach(function(batchSize) {
+        var cursor = coll.find().sort({x: 1}).batchSize(batchSize);
+        var last = -1;
+        var count = 0;
+        while (cursor.hasNext()) {
+            var doc = cursor.next();
+            assert.gt(doc.x, last, 'out of order with batchSize ' + batchSize);
+            last = doc.x;
+            count++;
+        }
+        assert.eq(N, count, 'wrong count with batchSize ' + batchSize);
+    });
+
+    // Abandon cursors part way through their batches, then make sure mongos still works.
+    for (var j = 0; j < 20; j++) {
+        var partial = coll.find().sort({x: -1}).batchSize(10);
+        for (var k = 0; k < 25; k++) {
+            partial.next();
+        }
+        partial.close();
+    }
+    assert.eq(N, coll.find().sort({x: 1}).batchSize(7).itcount());
+    assert.eq(N, coll.count());
+
+    st.stop();
+}());
@@ -0,0 +1,60 @@
+// Unordered insert batches are targeted at once, in shard key order. Every document must still
+// reach the shard owning its chunk, and documents without a shard key must fail on their own.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({name: 'unordered_insert_targeting', shards: 2, mongos: 1});
+    st.stopBalancer();
+
+    var mongos = st.s0;
+    var coll = mongos.getDB('test').data;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: 'test'}));
+    assert.commandWorked(mongos.adminCommand({shardCollection: coll.getFullName(), key: {x: 1}}));
+
+    var primary = st.config.databases.findOne({_id: 'test'}).primary;
+    var other = st.config.shards.findOne({_id: {$ne: primary}})._id;
+    for (var i = 1; i < 20; i++) {
+        assert.commandWorked(mongos.adminCommand({split: coll.getFullName(), middle: {x: i * 50}}));
+        if (i % 2) {
+            assert.commandWorked(mongos.adminCommand(
+                {moveChunk: coll.getFullName(), find: {x: i * 50}, to: other,
+                 _waitForDelete: true}));
+        }
+    }
+
+    // Shuffled keys, including some outside of the split points and some without a shard key.
+    var docs = [];
+    for (i = -100; i < 1100; i++) {
+        docs.push({_id: i, x: i});
+    }
+    for (i = docs.length - 1; i > 0; i--) {
+        var j = Math.floor(Math.random() * (i + 1));
+        var tmp = docs[i];
+        docs[i] = docs[j];
+        docs[j] = tmp;
+    }
+    docs.splice(100, 0, {_id: 'noKey1'});
+    docs.splice(700, 0, {_id: 'noKey2'});
+
+    var res = mongos.getDB('test').runCommand(
+        {insert: coll.getName(), documents: docs, ordered: false});
+    assert.eq(1200, res.n, tojson(res));
+    assert.eq(2, res.writeErrors.length, tojson(res));
+    assert.eq(100, res.writeErrors[0].index, tojson(res));
+    assert.eq(700, res.writeErrors[1].index, tojson(res));
+    assert.eq(1200, coll.find().itcount());
+
+    // Every document is on the shard of its chunk.
+    var shardConns = {};
+    st.config.shards.find().forEach(function(shard) {
+        shardConns[shard._id] = new Mongo(shard.host).getCollection(coll.getFullName());
+    });
+    st.config.chunks.find({ns: coll.getFullName()}).forEach(function(chunk) {
+        var query = {x: {$gte: chunk.min.x, $lt: chunk.max.x}};
+        var expected = coll.find(query).itcount();
+        assert.eq(expected, shardConns[chunk.shard].find(query).itcount(), tojson(chunk));
+    });
+
+    st.stop();
+}());
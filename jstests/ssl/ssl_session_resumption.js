@@ -0,0 +1,24 @@
+// Test that reconnecting clients resume their TLS session instead of doing a full handshake.
+var md = MongoRunner.runMongod({sslMode: "requireSSL",
+                                sslPEMKeyFile: "jstests/libs/server.pem",
+                                sslCAFile: "jstests/libs/ca.pem",
+                                sslAllowConnectionsWithoutCertificates: ""});
+
+function sessionStats() {
+    var stats = md.getDB("admin").serverStatus().security.SSLSessions;
+    assert(stats, "no SSLSessions in serverStatus");
+    return stats;
+}
+
+var before = sessionStats();
+for (var i = 0; i < 5; i++) {
+    var conn = new Mongo("localhost:" + md.port);
+    assert.commandWorked(conn.getDB("admin").runCommand({ping: 1}));
+}
+var after = sessionStats();
+printjson(after);
+
+// This shell resumes the session of its first connection on the following ones.
+assert.gte(after.serverResumedSessions - before.serverResumedSessions, 4, tojson(after));
+
+MongoRunner.stopMongod(md.port);
@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_extractor.h"
+
+#include <cstring>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    BSONFieldExtractor::BSONFieldExtractor(const std::vector<std::string>& paths) {
+        _nodes.push_back(Node("", 0));
+
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const std::string& path = paths[i];
+            _pathLengths.push_back(path.size());
+
+            size_t nodeIdx = 0;
+            size_t start = 0;
+            while (true) {
+                size_t dot = path.find('.', start);
+                const size_t end = (dot == std::string::npos) ? path.size() : dot;
+                const std::string name = path.substr(start, end - start);
+                const size_t endOffset = (dot == std::string::npos) ? end : end + 1;
+
+                size_t childIdx = 0;
+                const std::vector<size_t>& children = _nodes[nodeIdx].children;
+                for (size_t j = 0; j < children.size(); ++j) {
+                    if (_nodes[children[j]].name == name) {
+                        childIdx = children[j];
+                        break;
+                    }
+                }
+                if (childIdx == 0) {
+                    childIdx = _nodes.size();
+                    _nodes.push_back(Node(name, endOffset));
+                    _nodes[nodeIdx].children.push_back(childIdx);
+                }
+
+                _nodes[childIdx].allPaths.push_back(i);
+                nodeIdx = childIdx;
+
+                if (dot == std::string::npos) {
+                    _nodes[nodeIdx].completedPaths.push_back(i);
+                    break;
+                }
+                start = dot + 1;
+            }
+        }
+    }
+
+    void BSONFieldExtractor::extract(const BSONObj& obj,
+                                     std::vector<BSONElement>* elements,
+                                     std::vector<size_t>* remainingOffsets) const {
+        elements->assign(numPaths(), BSONElement());
+        if (remainingOffsets) {
+            *remainingOffsets = _pathLengths;
+        }
+        _extractChildren(obj, _nodes[0], elements, remainingOffsets);
+    }
+
+    void BSONFieldExtractor::_extractChildren(const BSONObj& obj,
+                                              const Node& parent,
+                                              std::vector<BSONElement>* elements,
+                                              std::vector<size_t>* remainingOffsets) const {
+        const size_t numChildren = parent.children.size();
+
+        // Key patterns and shard keys rarely have more than a handful of fields, so the matches
+        // for one level fit on the stack.
+        const size_t kMaxInlineChildren = 16;
+        BSONElement inlineFound[kMaxInlineChildren];
+        std::vector<BSONElement> heapFound;
+        BSONElement* found = inlineFound;
+        if (numChildren > kMaxInlineChildren) {
+            heapFound.resize(numChildren);
+            found = &heapFound[0];
+        }
+
+        // Single pass over this level. Like getField(), only the first element with a given name
+        // counts.
+        size_t numUnmatched = numChildren;
+        BSONObjIterator it(obj);
+        while (numUnmatched > 0 && it.more()) {
+            BSONElement e = it.next();
+            const char* fieldName = e.fieldName();
+            for (size_t j = 0; j < numChildren; ++j) {
+                if (found[j].eoo() &&
+                    std::strcmp(_nodes[parent.children[j]].name.c_str(), fieldName) == 0) {
+                    found[j] = e;
+                    --numUnmatched;
+                    break;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < numChildren; ++j) {
+            const BSONElement& e = found[j];
+            if (e.eoo()) {
+                // Missing: every path through this node is left as EOO.
+                continue;
+            }
+
+            const Node& child = _nodes[parent.children[j]];
+            for (size_t k = 0; k < child.completedPaths.size(); ++k) {
+                (*elements)[child.completedPaths[k]] = e;
+            }
+
+            if (child.children.empty()) {
+                continue;
+            }
+
+            if (e.type() == Array) {
+                // Stop at the array and let the caller handle the rest of the path.
+                for (size_t k = 0; k < child.allPaths.size(); ++k) {
+                    const size_t pathIdx = child.allPaths[k];
+                    if ((*elements)[pathIdx].eoo()) {
+                        (*elements)[pathIdx] = e;
+                        if (remainingOffsets) {
+                            (*remainingOffsets)[pathIdx] = child.endOffset;
+                        }
+                    }
+                }
+            }
+            else if (e.type() == Object) {
+                _extractChildren(e.embeddedObject(), child, elements, remainingOffsets);
+            }
+        }
+    }
+
+}  // namespace mongo
@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+    /**
+     * Looks up a fixed set of (possibly dotted) field paths in many documents, visiting each
+     * element of each traversed object at most once.
+     *
+     * Calling getFieldDottedOrArray() once per path rescans the top level of the document, and
+     * every shared prefix, for each path. A BSONFieldExtractor instead builds a tree of path
+     * components when it is constructed, so it should be built once (e.g. per index or per
+     * shard key pattern) and reused for every document.
+     *
+     * For each path, extract() produces the same element as getFieldDottedOrArray(): the first
+     * element with a matching name at each level, stopping at the first array along the path
+     * and returning EOO if a component is missing or names a field of a non-object.
+     */
+    class BSONFieldExtractor {
+    public:
+        explicit BSONFieldExtractor(const std::vector<std::string>& paths);
+
+        size_t numPaths() const { return _pathLengths.size(); }
+
+        /**
+         * Fills '*elements' with one element per path, in the order the paths were given to the
+         * constructor.
+         *
+         * If 'remainingOffsets' is not NULL, it is filled with the offset into each path of the
+         * part that was not traversed, i.e. the offset getFieldDottedOrArray() leaves its 'name'
+         * argument at. This is the length of the path unless the element returned is an array
+         * found before the last component.
+         */
+        void extract(const BSONObj& obj,
+                     std::vector<BSONElement>* elements,
+                     std::vector<size_t>* remainingOffsets = NULL) const;
+
+    private:
+        struct Node {
+            Node(const std::string& n, size_t end) : name(n), endOffset(end) {}
+
+            // Component of the path(s) leading to this node.
+            std::string name;
+
+            // Offset into the paths just past this component and the '.' following it.
+            size_t endOffset;
+
+            // Indexes into '_nodes' of the components that may follow this one.
+            std::vector<size_t> children;
+
+            // Paths that end with this component.
+            std::vector<size_t> completedPaths;
+
+            // All paths that go through this component, including 'completedPaths'.
+            std::vector<size_t> allPaths;
+        };
+
+        void _extractChildren(const BSONObj& obj,
+                              const Node& parent,
+                              std::vector<BSONElement>* elements,
+                              std::vector<size_t>* remainingOffsets) const;
+
+        // _nodes[0] is the root, which matches no field name and has the top level components
+        // as its children.
+        std::vector<Node> _nodes;
+
+        std::vector<size_t> _pathLengths;
+    };
+
+}  // namespace mongo
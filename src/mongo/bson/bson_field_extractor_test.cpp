@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_extractor.h"
+
+#include <cstring>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::string;
+    using std::vector;
+
+    namespace str = mongoutils::str;
+
+    vector<string> makePaths(const char* a, const char* b = NULL, const char* c = NULL) {
+        vector<string> paths;
+        paths.push_back(a);
+        if (b)
+            paths.push_back(b);
+        if (c)
+            paths.push_back(c);
+        return paths;
+    }
+
+    // Checks every path against what getFieldDottedOrArray() returns for it.
+    void assertMatchesGetFieldDottedOrArray(const vector<string>& paths, const BSONObj& obj) {
+        BSONFieldExtractor extractor(paths);
+        ASSERT_EQUALS(paths.size(), extractor.numPaths());
+
+        vector<BSONElement> elements;
+        vector<size_t> remainingOffsets;
+        extractor.extract(obj, &elements, &remainingOffsets);
+        ASSERT_EQUALS(paths.size(), elements.size());
+        ASSERT_EQUALS(paths.size(), remainingOffsets.size());
+
+        for (size_t i = 0; i < paths.size(); ++i) {
+            const char* name = paths[i].c_str();
+            BSONElement expected = obj.getFieldDottedOrArray(name);
+            ASSERT_EQUALS(expected.eoo(), elements[i].eoo());
+            ASSERT_EQUALS(expected.rawdata(), elements[i].rawdata());
+            if (!expected.eoo()) {
+                ASSERT_EQUALS(static_cast<size_t>(name - paths[i].c_str()), remainingOffsets[i]);
+            }
+        }
+    }
+
+    TEST(BSONFieldExtractor, TopLevelFields) {
+        BSONObj obj = fromjson("{a: 1, b: 'x', c: {d: 2}}");
+        assertMatchesGetFieldDottedOrArray(makePaths("c", "a", "b"), obj);
+        assertMatchesGetFieldDottedOrArray(makePaths("z"), obj);
+    }
+
+    TEST(BSONFieldExtractor, DottedFieldsSharingPrefix) {
+        BSONObj obj = fromjson("{a: {b: 1, c: {d: 2}}, e: 3}");
+        assertMatchesGetFieldDottedOrArray(makePaths("a.b", "a.c.d", "e"), obj);
+        assertMatchesGetFieldDottedOrArray(makePaths("a", "a.c", "a.c.d"), obj);
+        assertMatchesGetFieldDottedOrArray(makePaths("a.x", "a.c.x", "e.f"), obj);
+    }
+
+    TEST(BSONFieldExtractor, DuplicatePaths) {
+        BSONObj obj = fromjson("{a: {b: 1}}");
+        assertMatchesGetFieldDottedOrArray(makePaths("a.b", "a.b"), obj);
+    }
+
+    TEST(BSONFieldExtractor, FirstOccurrenceOfRepeatedFieldName) {
+        BSONObj obj = BSON("a" << BSON("b" << 1) << "a" << BSON("b" << 2));
+        assertMatchesGetFieldDottedOrArray(makePaths("a.b"), obj);
+
+        BSONFieldExtractor extractor(makePaths("a.b"));
+        vector<BSONElement> elements;
+        extractor.extract(obj, &elements);
+        ASSERT_EQUALS(1, elements[0].numberInt());
+    }
+
+    TEST(BSONFieldExtractor, StopsAtArray) {
+        BSONObj obj = fromjson("{a: [{b: 1}, {b: 2}], c: {d: [1, 2]}}");
+        assertMatchesGetFieldDottedOrArray(makePaths("a.b", "c.d", "c.d.0"), obj);
+
+        BSONFieldExtractor extractor(makePaths("a.b", "c.d.0"));
+        vector<BSONElement> elements;
+        vector<size_t> remainingOffsets;
+        extractor.extract(obj, &elements, &remainingOffsets);
+        ASSERT_EQUALS(Array, elements[0].type());
+        ASSERT_EQUALS(0, strcmp("b", "a.b" + remainingOffsets[0]));
+        ASSERT_EQUALS(Array, elements[1].type());
+        ASSERT_EQUALS(0, strcmp("0", "c.d.0" + remainingOffsets[1]));
+    }
+
+    TEST(BSONFieldExtractor, NonObjectIntermediate) {
+        BSONObj obj = fromjson("{a: 1, b: 'str'}");
+        assertMatchesGetFieldDottedOrArray(makePaths("a.b", "b.c"), obj);
+    }
+
+    TEST(BSONFieldExtractor, EmptyObject) {
+        assertMatchesGetFieldDottedOrArray(makePaths("a", "b.c"), BSONObj());
+    }
+
+    TEST(BSONFieldExtractor, ManyFields) {
+        vector<string> paths;
+        BSONObjBuilder bob;
+        for (int i = 0; i < 40; ++i) {
+            paths.push_back(str::stream() << "f" << i << ".x");
+            const string fieldName = str::stream() << "f" << (39 - i);
+            bob.append(fieldName, BSON("x" << i));
+        }
+        assertMatchesGetFieldDottedOrArray(paths, bob.obj());
+    }
+
+}  // namespace
@@ -28,8 +28,8 @@
  */
 
 #include <cstring>
-#include <deque>
 #include <limits>
+#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
@@ -173,11 +173,87 @@ namespace mongo {
             int _startPosition;
         };
 
+        /**
+         * Stack of the objects being validated.  Almost all documents are shallow, so the first
+         * frames live inline and validating them doesn't allocate.
+         */
+        class ValidationFrameStack {
+        public:
+            ValidationFrameStack() : _size(0) {}
+
+            // Returns the new top frame, which stays valid until the next push().
+            ValidationObjectFrame* push() {
+                ++_size;
+                if (_size <= kInlineFrames)
+                    return &_inline[_size - 1];
+                _overflow.push_back(ValidationObjectFrame());
+                return &_overflow.back();
+            }
+
+            void pop() {
+                if (_size > kInlineFrames)
+                    _overflow.pop_back();
+                --_size;
+            }
+
+            ValidationObjectFrame* back() {
+                return _size <= kInlineFrames ? &_inline[_size - 1] : &_overflow.back();
+            }
+
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+        private:
+            static const size_t kInlineFrames = 32;
+
+            ValidationObjectFrame _inline[kInlineFrames];
+            std::vector<ValidationObjectFrame> _overflow;
+            size_t _size;
+        };
+
+        /**
+         * Size of the value of each BSON type whose value has a fixed size, indexed by the type
+         * byte; kVariableSize for all other types, valid or not.
+         */
+        class FixedValueSizes {
+        public:
+            static const signed char kVariableSize = -1;
+
+            FixedValueSizes() {
+                memset(_sizes, kVariableSize, sizeof(_sizes));
+                set(MinKey, 0);
+                set(MaxKey, 0);
+                set(jstNULL, 0);
+                set(Undefined, 0);
+                set(jstOID, OID::kOIDSize);
+                set(NumberInt, sizeof(int32_t));
+                set(Bool, sizeof(int8_t));
+                set(NumberDouble, sizeof(int64_t));
+                set(NumberLong, sizeof(int64_t));
+                set(bsonTimestamp, sizeof(int64_t));
+                set(Date, sizeof(int64_t));
+            }
+
+            int get(signed char type) const {
+                return _sizes[static_cast<unsigned char>(type)];
+            }
+
+        private:
+            void set(BSONType type, int size) {
+                _sizes[static_cast<unsigned char>(type)] = size;
+            }
+
+            signed char _sizes[256];
+        };
+
+        const FixedValueSizes fixedValueSizes;
+
         /**
          * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
          */
         Status validateElementInfo(Buffer* buffer,
                                    ValidationState::State* nextState,
+                                   StringData* name,
                                    BSONElement idElem) {
             Status status = Status::OK();
 
@@ -190,42 +266,21 @@ namespace mongo {
                 return Status::OK();
             }
 
-            StringData name;
-            status = buffer->readCString( &name );
+            status = buffer->readCString( name );
             if ( !status.isOK() )
                 return status;
 
-            switch ( type ) {
-            case MinKey:
-            case MaxKey:
-            case jstNULL:
-            case Undefined:
-                return Status::OK();
-
-            case jstOID:
-                if ( !buffer->skip( OID::kOIDSize ) )
-                    return makeError("invalid bson", idElem);
-                return Status::OK();
-
-            case NumberInt:
-                if ( !buffer->skip( sizeof(int32_t) ) )
-                    return makeError("invalid bson", idElem);
-                return Status::OK();
-
-            case Bool:
-                if ( !buffer->skip( sizeof(int8_t) ) )
-                    return makeError("invalid bson", idElem);
+            // Most elements have a fixed size value, which only needs a bounds check.
+            const int fixedSize = fixedValueSizes.get(type);
+            if ( fixedSize == 0 )
                 return Status::OK();
-
-
-            case NumberDouble:
-            case NumberLong:
-            case bsonTimestamp:
-            case Date:
-                if ( !buffer->skip( sizeof(int64_t) ) )
+            if ( fixedSize > 0 ) {
+                if ( !buffer->skip( fixedSize ) )
                     return makeError("invalid bson", idElem);
                 return Status::OK();
+            }
 
+            switch ( type ) {
             case DBRef:
                 status = buffer->readUTF8String( NULL );
                 if ( !status.isOK() )
@@ -275,7 +330,7 @@ namespace mongo {
         }
 
         Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
+            ValidationFrameStack frames;
             ValidationObjectFrame* curr = NULL;
             ValidationState::State state = ValidationState::BeginObj;
 
@@ -285,8 +340,7 @@ namespace mongo {
             while (state != ValidationState::Done) {
                 switch (state) {
                 case ValidationState::BeginObj:
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
+                    curr = frames.push();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(false);
                     if (!buffer->readNumber<int>(&curr->expectedSize)) {
@@ -305,14 +359,15 @@ namespace mongo {
 
                     const uint64_t elemStartPos = buffer->position();
                     ValidationState::State nextState = state;
-                    Status status = validateElementInfo(buffer, &nextState, idElem);
+                    StringData name;
+                    Status status = validateElementInfo(buffer, &nextState, &name, idElem);
                     if (!status.isOK())
                         return status;
 
-                    // we've already validated that fieldname is safe to access as long as we aren't
-                    // at the end of the object, since EOO doesn't have a fieldname.
+                    // name is only set if we aren't at the end of the object, since EOO doesn't
+                    // have a fieldname.
                     if (nextState != ValidationState::EndObj && idElem.eoo() && atTopLevel) {
-                        if (strcmp(buffer->getBasePtr() + elemStartPos + 1/*type*/, "_id") == 0) {
+                        if (name == "_id") {
                             idElemStartPos = elemStartPos;
                         }
                     }
@@ -325,12 +380,12 @@ namespace mongo {
                     if ( actualLength != curr->expectedSize ) {
                         return makeError("bson length doesn't match what we found", idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty()) {
                         state = ValidationState::Done;
                     }
                     else {
-                        curr = &frames.back();
+                        curr = frames.back();
                         if (curr->isCodeWithScope())
                             state = ValidationState::EndCodeWScope;
                         else
@@ -339,8 +394,7 @@ namespace mongo {
                     break;
                 }
                 case ValidationState::BeginCodeWScope: {
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
+                    curr = frames.push();
                     curr->setStartPosition(buffer->position());
                     curr->setIsCodeWithScope(true);
                     if ( !buffer->readNumber<int>( &curr->expectedSize ) )
@@ -357,10 +411,10 @@ namespace mongo {
                         return makeError("bson length for CodeWScope doesn't match what we found",
                                          idElem);
                     }
-                    frames.pop_back();
+                    frames.pop();
                     if (frames.empty())
                         return makeError("unnested CodeWScope", idElem);
-                    curr = &frames.back();
+                    curr = frames.back();
                     state = ValidationState::WithinObj;
                     break;
                 }
@@ -308,4 +308,21 @@ namespace {
         ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize()));
     }
 
+    TEST(BSONValidateFast, DeeplyNested) {
+        // Deeper than the frames which are kept inline.
+        BSONObj x = BSON("x" << 1);
+        for (int i = 0; i < 100; i++) {
+            if (i % 3 == 0)
+                x = BSON("a" << 1 << "b" << x << "c" << "str");
+            else if (i % 3 == 1)
+                x = BSON("arr" << BSON_ARRAY(x << 2));
+            else
+                x = BSON("code" << BSONCodeWScope("f()", x) << "d" << 1.5);
+        }
+        ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+        for (int len = x.objsize() - 1; len > 0; len -= 97) {
+            ASSERT_NOT_OK(validateBSON(x.objdata(), len));
+        }
+    }
+
 }
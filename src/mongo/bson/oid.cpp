@@ -36,6 +36,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/config.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/hex.h"
@@ -51,6 +52,35 @@ namespace {
     const std::size_t kIncrementOffset = kInstanceUniqueOffset +
                                          OID::kInstanceUniqueSize;
     OID::InstanceUnique _instanceUnique;
+
+#if defined(MONGO_CONFIG_HAVE___THREAD)
+#define MONGO_OID_THREAD_LOCAL __thread
+#elif defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+#define MONGO_OID_THREAD_LOCAL __declspec(thread)
+#endif
+
+#ifdef MONGO_OID_THREAD_LOCAL
+    // Each thread reserves increments from the shared counter in blocks, so that generating an
+    // OID does not write to a cache line shared by every thread.  The OIDs a thread generates
+    // still have consecutive increments, though those of different threads now interleave.
+    const uint32_t kIncrementBlockSize = 256;
+
+    MONGO_OID_THREAD_LOCAL uint32_t threadNextIncrement = 0;
+    MONGO_OID_THREAD_LOCAL uint32_t threadIncrementsLeft = 0;
+
+    uint32_t nextIncrement() {
+        if (threadIncrementsLeft == 0) {
+            threadNextIncrement = counter->fetchAndAdd(kIncrementBlockSize);
+            threadIncrementsLeft = kIncrementBlockSize;
+        }
+        threadIncrementsLeft--;
+        return threadNextIncrement++;
+    }
+#else
+    uint32_t nextIncrement() {
+        return counter->fetchAndAdd(1);
+    }
+#endif
 }  // namespace
 
     MONGO_INITIALIZER_GENERAL(OIDGeneration, MONGO_NO_PREREQUISITES, ("default"))
@@ -62,7 +92,7 @@ namespace {
     }
 
     OID::Increment OID::Increment::next() {
-        uint64_t nextCtr = counter->fetchAndAdd(1);
+        uint64_t nextCtr = nextIncrement();
         OID::Increment incr;
 
         incr.bytes[0] = uint8_t(nextCtr >> 16);
@@ -27,6 +27,11 @@
 
 #include "mongo/bson/oid.h"
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <set>
+#include <vector>
+
 #include "mongo/platform/endian.h"
 #include "mongo/unittest/unittest.h"
 
@@ -57,6 +62,30 @@ namespace {
         ASSERT_TRUE(o1 < o2);
     }
 
+    void genOIDs(std::vector<OID>* oids) {
+        for (size_t i = 0; i < oids->size(); ++i) {
+            (*oids)[i] = OID::gen();
+        }
+    }
+
+    TEST(Unique, ManyThreads) {
+        const size_t kThreads = 8;
+        const size_t kOIDsPerThread = 10000;
+        std::vector<std::vector<OID> > oids(kThreads, std::vector<OID>(kOIDsPerThread));
+
+        boost::thread_group threads;
+        for (size_t i = 0; i < kThreads; ++i) {
+            threads.create_thread(boost::bind(&genOIDs, &oids[i]));
+        }
+        threads.join_all();
+
+        std::set<OID> all;
+        for (size_t i = 0; i < kThreads; ++i) {
+            all.insert(oids[i].begin(), oids[i].end());
+        }
+        ASSERT_EQUALS(kThreads * kOIDsPerThread, all.size());
+    }
+
     TEST(IsSet, Simple) {
         OID o;
         ASSERT_FALSE(o.isSet());
@@ -0,0 +1,177 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/buffer_pool.h"
+
+#include <algorithm>
+#include <boost/thread/tss.hpp>
+#include <cstdlib>
+
+#include "mongo/config.h"
+#include "mongo/util/allocator.h"
+
+namespace mongo {
+namespace {
+
+    // Size classes are the powers of two from kMinPooledSize to kMaxPooledSize.
+    const int kMinShift = 9;
+    const int kMaxShift = 20;
+    const int kNumClasses = kMaxShift - kMinShift + 1;
+    const int kBuffersPerClass = 2;
+
+    // Bounds the memory each thread keeps back from the allocator.  There is deliberately no
+    // process-wide bound, which would need a counter shared by all threads.
+    const size_t kMaxPooledBytesPerThread = 1024 * 1024;
+
+    struct ThreadBuffers {
+        ThreadBuffers() : pooledBytes(0), recentSize(BufferPool::kMinPooledSize) {
+            for (int i = 0; i < kNumClasses; ++i) {
+                count[i] = 0;
+            }
+        }
+
+        ~ThreadBuffers() {
+            for (int i = 0; i < kNumClasses; ++i) {
+                for (int j = 0; j < count[i]; ++j) {
+                    free(buffers[i][j]);
+                }
+            }
+        }
+
+        void* buffers[kNumClasses][kBuffersPerClass];
+        int count[kNumClasses];
+        size_t pooledBytes;
+        size_t recentSize;
+    };
+
+#if defined(MONGO_CONFIG_HAVE___THREAD)
+    __thread ThreadBuffers* fastThreadBuffers = NULL;
+#elif defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+    __declspec(thread) ThreadBuffers* fastThreadBuffers = NULL;
+#endif
+
+    void destroyThreadBuffers(ThreadBuffers* buffers) {
+#if defined(MONGO_CONFIG_HAVE___THREAD) || defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+        fastThreadBuffers = NULL;
+#endif
+        delete buffers;
+    }
+
+    // Deliberately leaked, since buffers are released by the destructors of other statics.
+    // Constructed on first use, since they are also allocated by their constructors.
+    boost::thread_specific_ptr<ThreadBuffers>& threadBuffersOwner() {
+        static boost::thread_specific_ptr<ThreadBuffers>* owner =
+            new boost::thread_specific_ptr<ThreadBuffers>(&destroyThreadBuffers);
+        return *owner;
+    }
+
+    ThreadBuffers* getThreadBuffers() {
+#if defined(MONGO_CONFIG_HAVE___THREAD) || defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+        if (fastThreadBuffers) {
+            return fastThreadBuffers;
+        }
+#endif
+        boost::thread_specific_ptr<ThreadBuffers>& owner = threadBuffersOwner();
+        ThreadBuffers* buffers = owner.get();
+        if (!buffers) {
+            buffers = new ThreadBuffers();
+            owner.reset(buffers);
+        }
+#if defined(MONGO_CONFIG_HAVE___THREAD) || defined(MONGO_CONFIG_HAVE___DECLSPEC_THREAD)
+        fastThreadBuffers = buffers;
+#endif
+        return buffers;
+    }
+
+    // The smallest class whose buffers hold 'size' bytes.
+    int classForAllocation(size_t size) {
+        int shift = kMinShift;
+        while ((size_t(1) << shift) < size) {
+            ++shift;
+        }
+        return shift - kMinShift;
+    }
+
+    // The largest class whose buffers fit in 'size' bytes.
+    int classForRelease(size_t size) {
+        int shift = kMinShift;
+        while (shift < kMaxShift && (size_t(1) << (shift + 1)) <= size) {
+            ++shift;
+        }
+        return shift - kMinShift;
+    }
+
+}  // namespace
+
+    void* BufferPool::allocate(size_t size) {
+        if (size <= kMaxPooledSize) {
+            ThreadBuffers* buffers = getThreadBuffers();
+            const int sizeClass = classForAllocation(std::max(size, kMinPooledSize));
+            if (buffers->count[sizeClass] > 0) {
+                const size_t classSize = kMinPooledSize << sizeClass;
+                buffers->pooledBytes -= classSize;
+                return buffers->buffers[sizeClass][--buffers->count[sizeClass]];
+            }
+        }
+        return mongoMalloc(size);
+    }
+
+    void BufferPool::release(void* buf, size_t size) {
+        if (!buf) {
+            return;
+        }
+
+        if (size < kMinPooledSize || size >= 2 * kMaxPooledSize) {
+            free(buf);
+            return;
+        }
+
+        ThreadBuffers* buffers = getThreadBuffers();
+        buffers->recentSize = (buffers->recentSize * 7 + size) / 8;
+
+        const int sizeClass = classForRelease(size);
+        const size_t classSize = kMinPooledSize << sizeClass;
+        if (buffers->count[sizeClass] == kBuffersPerClass ||
+            buffers->pooledBytes + classSize > kMaxPooledBytesPerThread) {
+            free(buf);
+            return;
+        }
+
+        buffers->pooledBytes += classSize;
+        buffers->buffers[sizeClass][buffers->count[sizeClass]++] = buf;
+    }
+
+    int BufferPool::suggestedSize() {
+        const size_t recentSize = getThreadBuffers()->recentSize;
+        return static_cast<int>(kMinPooledSize << classForAllocation(
+            std::min(std::max(recentSize, kMinPooledSize), kMaxPooledSize)));
+    }
+
+}  // namespace mongo
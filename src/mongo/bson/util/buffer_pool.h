@@ -0,0 +1,67 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace mongo {
+
+    /**
+     * A per-thread cache of heap buffers, which BufBuilders and Messages draw from and release
+     * their buffers to, so that a thread building one reply after another reuses the same few
+     * buffers rather than going to the allocator for each.
+     *
+     * Buffers are grouped by power of two sizes, and only buffers of up to kMaxPooledSize are
+     * kept.  Every buffer handed out is an ordinary heap block, so code which takes ownership of
+     * one, as with BufBuilder::decouple(), may still free() it.
+     */
+    class BufferPool {
+    public:
+        static const size_t kMinPooledSize = 512;
+        static const size_t kMaxPooledSize = 1024 * 1024;
+
+        /**
+         * Returns a buffer of at least 'size' bytes.  Never returns NULL.
+         */
+        static void* allocate(size_t size);
+
+        /**
+         * Takes back a buffer from allocate(), mongoMalloc() or malloc().  'size' must not be
+         * more than the buffer's usable size.
+         */
+        static void release(void* buf, size_t size);
+
+        /**
+         * A starting size for a builder of a message, based on the sizes of the buffers this
+         * thread released recently.  Starting there saves growing the builder a step at a time.
+         */
+        static int suggestedSize();
+    };
+
+}  // namespace mongo
@@ -0,0 +1,140 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/util/buffer_pool.h"
+
+#include <boost/thread/thread.hpp>
+#include <cstring>
+
+#include "mongo/bson/util/builder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    // Each test runs on a new thread, so that it starts with an empty pool.
+    void runOnNewThread(void (*test)()) {
+        boost::thread thread(test);
+        thread.join();
+    }
+
+    void reusesReleasedBuffer() {
+        void* buf = BufferPool::allocate(4096);
+        std::memset(buf, 'x', 4096);
+        BufferPool::release(buf, 4096);
+        ASSERT_EQUALS(buf, BufferPool::allocate(3000));
+        BufferPool::release(buf, 4096);
+    }
+
+    TEST(BufferPool, ReusesReleasedBuffer) {
+        runOnNewThread(&reusesReleasedBuffer);
+    }
+
+    void smallerBufferDoesNotSatisfyLargerRequest() {
+        void* small = BufferPool::allocate(1024);
+        BufferPool::release(small, 1024);
+        void* large = BufferPool::allocate(1025);
+        ASSERT_NOT_EQUALS(small, large);
+        std::memset(large, 'x', 1025);
+        free(large);
+        ASSERT_EQUALS(small, BufferPool::allocate(1024));
+        free(small);
+    }
+
+    TEST(BufferPool, SmallerBufferDoesNotSatisfyLargerRequest) {
+        runOnNewThread(&smallerBufferDoesNotSatisfyLargerRequest);
+    }
+
+    void keepsBoundedNumberOfBuffers() {
+        void* bufs[4];
+        for (int i = 0; i < 4; ++i) {
+            bufs[i] = BufferPool::allocate(8192);
+        }
+        for (int i = 0; i < 4; ++i) {
+            BufferPool::release(bufs[i], 8192);
+        }
+
+        // Only the first two buffers released are kept, and they are handed out last in first
+        // out.
+        void* first = BufferPool::allocate(8192);
+        void* second = BufferPool::allocate(8192);
+        void* third = BufferPool::allocate(8192);
+        ASSERT_EQUALS(bufs[1], first);
+        ASSERT_EQUALS(bufs[0], second);
+        free(first);
+        free(second);
+        free(third);
+    }
+
+    TEST(BufferPool, KeepsBoundedNumberOfBuffers) {
+        runOnNewThread(&keepsBoundedNumberOfBuffers);
+    }
+
+    void doesNotKeepHugeBuffers() {
+        const size_t size = 4 * BufferPool::kMaxPooledSize;
+        void* huge = BufferPool::allocate(size);
+        std::memset(huge, 'x', size);
+        BufferPool::release(huge, size);
+        void* other = BufferPool::allocate(size);
+        std::memset(other, 'x', size);
+        free(other);
+    }
+
+    TEST(BufferPool, DoesNotKeepHugeBuffers) {
+        runOnNewThread(&doesNotKeepHugeBuffers);
+    }
+
+    void suggestedSizeFollowsReleasedSizes() {
+        ASSERT_EQUALS(static_cast<int>(BufferPool::kMinPooledSize), BufferPool::suggestedSize());
+        for (int i = 0; i < 50; ++i) {
+            BufBuilder b;
+            b.skip(100 * 1000);
+        }
+        ASSERT_GREATER_THAN_OR_EQUALS(BufferPool::suggestedSize(), 100 * 1000);
+        ASSERT_LESS_THAN_OR_EQUALS(BufferPool::suggestedSize(),
+                                   static_cast<int>(BufferPool::kMaxPooledSize));
+    }
+
+    TEST(BufferPool, SuggestedSizeFollowsReleasedSizes) {
+        runOnNewThread(&suggestedSizeFollowsReleasedSizes);
+    }
+
+    void releaseFromOtherThread(void* buf) {
+        BufferPool::release(buf, 2048);
+    }
+
+    TEST(BufferPool, BuffersMayMoveBetweenThreads) {
+        void* buf = BufferPool::allocate(2048);
+        boost::thread other(&releaseFromOtherThread, buf);
+        other.join();
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -41,6 +41,7 @@
 #include "mongo/base/data_view.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/inline_decls.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/assert_util.h"
 
@@ -78,9 +79,9 @@ namespace mongo {
 
     class TrivialAllocator { 
     public:
-        void* Malloc(size_t sz) { return mongoMalloc(sz); }
+        void* Malloc(size_t sz) { return BufferPool::allocate(sz); }
         void* Realloc(void *p, size_t sz) { return mongoRealloc(p, sz); }
-        void Free(void *p) { free(p); }
+        void Free(void *p, size_t sz) { BufferPool::release(p, sz); }
     };
 
     class StackAllocator {
@@ -101,9 +102,9 @@ namespace mongo {
             }
             return mongoRealloc(p, sz);
         }
-        void Free(void *p) { 
+        void Free(void *p, size_t sz) { 
             if( p != buf )
-                free(p); 
+                BufferPool::release(p, sz);
         }
     private:
         char buf[SZ];
@@ -132,7 +133,7 @@ namespace mongo {
 
         void kill() {
             if ( data ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = 0;
             }
         }
@@ -145,7 +146,7 @@ namespace mongo {
             l = 0;
             reservedBytes = 0;
             if ( maxSize && size > maxSize ) {
-                al.Free(data);
+                al.Free(data, size);
                 data = (char*)al.Malloc(maxSize);
                 if ( data == 0 )
                     msgasserted( 15913 , "out of memory BufBuilder::reset" );
@@ -182,19 +182,50 @@ namespace mongo {
     DBConnectionPool::DBConnectionPool()
         : _name( "dbconnectionpool" ) , 
           _maxPoolSize(PoolForHost::kPoolSizeUnlimited) ,
+          _maxInUse(PoolForHost::kPoolSizeUnlimited) ,
+          _inUseWaitTimeoutMillis(0) ,
+          _inUseWaits(0) ,
+          _inUseWaitTimeouts(0) ,
           _hooks( new list<DBConnectionHook*>() ) {
     }
 
     DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
         uassert(17382, "Can't use connection pool during shutdown",
                 !inShutdown());
-        boost::lock_guard<boost::mutex> L(_mutex);
+        boost::unique_lock<boost::mutex> lk(_mutex);
         PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
         p.setMaxPoolSize(_maxPoolSize);
         p.initializeHostName(ident);
+
+        if (_maxInUse >= 0 && p.numInUse() >= _maxInUse) {
+            _inUseWaits++;
+            const boost::system_time deadline = boost::get_system_time() +
+                boost::posix_time::milliseconds(_inUseWaitTimeoutMillis);
+            while (p.numInUse() >= _maxInUse) {
+                if (!_inUseReleased.timed_wait(lk, deadline) && p.numInUse() >= _maxInUse) {
+                    _inUseWaitTimeouts++;
+                    uasserted(28704, str::stream() << _name << ": timed out after "
+                                                   << _inUseWaitTimeoutMillis << "ms waiting for"
+                                                   << " one of the " << p.numInUse()
+                                                   << " connections in use to " << ident);
+                }
+            }
+        }
+
+        // Whether it comes from the pool or the caller creates it, the connection counts towards
+        // the host's in-use limit until it is released or discarded
+        p.checkedOutOne();
         return p.get( this , socketTimeout );
     }
 
+    void DBConnectionPool::_returnSlot( const string& ident , double socketTimeout ) {
+        {
+            boost::lock_guard<boost::mutex> L(_mutex);
+            _pools[PoolKey(ident,socketTimeout)].returnedOne();
+        }
+        _inUseReleased.notify_all();
+    }
+
     DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
         {
             boost::lock_guard<boost::mutex> L(_mutex);
@@ -210,6 +241,7 @@ namespace mongo {
         }
         catch ( std::exception & ) {
             delete conn;
+            _returnSlot( host , socketTimeout );
             throw;
         }
 
@@ -224,6 +256,7 @@ namespace mongo {
             }
             catch ( std::exception& ) {
                 delete c;
+                _returnSlot( url.toString() , socketTimeout );
                 throw;
             }
             return c;
@@ -231,7 +264,10 @@ namespace mongo {
 
         string errmsg;
         c = url.connect( errmsg, socketTimeout );
-        uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
+        if ( ! c ) {
+            _returnSlot( url.toString() , socketTimeout );
+            uasserted( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg );
+        }
 
         return _finishCreate( url.toString() , socketTimeout , c );
     }
@@ -244,6 +280,7 @@ namespace mongo {
             }
             catch ( std::exception& ) {
                 delete c;
+                _returnSlot( host , socketTimeout );
                 throw;
             }
             return c;
@@ -251,11 +288,16 @@ namespace mongo {
 
         string errmsg;
         ConnectionString cs = ConnectionString::parse( host , errmsg );
-        uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
+        if ( ! cs.isValid() ) {
+            _returnSlot( host , socketTimeout );
+            uasserted( 13071 , (string)"invalid hostname [" + host + "]" + errmsg );
+        }
 
         c = cs.connect( errmsg, socketTimeout );
-        if ( ! c )
+        if ( ! c ) {
+            _returnSlot( host , socketTimeout );
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
+        }
         return _finishCreate( host , socketTimeout , c );
     }
 
@@ -272,8 +314,20 @@ namespace mongo {
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
         onRelease(c);
 
-        boost::lock_guard<boost::mutex> L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        {
+            boost::lock_guard<boost::mutex> L(_mutex);
+            PoolForHost& p = _pools[PoolKey(host,c->getSoTimeout())];
+            p.returnedOne();
+            p.done(this,c);
+        }
+        _inUseReleased.notify_all();
+    }
+
+    void DBConnectionPool::discard(const string& host, DBClientBase* c) {
+        const double socketTimeout = c->getSoTimeout();
+        onDestroy(c);
+        delete c;
+        _returnSlot(host, socketTimeout);
     }
 
 
@@ -343,7 +397,10 @@ namespace mongo {
     void DBConnectionPool::appendInfo( BSONObjBuilder& b ) {
 
         int avail = 0;
+        int inUse = 0;
         long long created = 0;
+        long long inUseWaits = 0;
+        long long inUseWaitTimeouts = 0;
 
 
         map<ConnectionString::ConnectionType,long long> createdByType;
@@ -359,10 +416,12 @@ namespace mongo {
 
                 BSONObjBuilder temp( bb.subobjStart( s ) );
                 temp.append( "available" , i->second.numAvailable() );
+                temp.append( "inUse" , i->second.numInUse() );
                 temp.appendNumber( "created" , i->second.numCreated() );
                 temp.done();
 
                 avail += i->second.numAvailable();
+                inUse += i->second.numInUse();
                 created += i->second.numCreated();
 
                 long long& x = createdByType[i->second.type()];
@@ -370,6 +429,12 @@ namespace mongo {
             }
         }
         bb.done();
+
+        {
+            boost::lock_guard<boost::mutex> lk( _mutex );
+            inUseWaits = _inUseWaits;
+            inUseWaitTimeouts = _inUseWaitTimeouts;
+        }
         
         // Always report all replica sets being tracked
         set<string> replicaSets = ReplicaSetMonitor::getAllTrackedSets();
@@ -398,7 +463,10 @@ namespace mongo {
         }
 
         b.append( "totalAvailable" , avail );
+        b.append( "totalInUse" , inUse );
         b.appendNumber( "totalCreated" , created );
+        b.appendNumber( "totalInUseWaits" , inUseWaits );
+        b.appendNumber( "totalInUseWaitTimeouts" , inUseWaitTimeouts );
     }
 
     bool DBConnectionPool::serverNameCompare::operator()( const string& a , const string& b ) const{
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -56,15 +57,18 @@ namespace mongo {
             _created(0),
             _minValidCreationTimeMicroSec(0),
             _type(ConnectionString::INVALID),
-            _maxPoolSize(kPoolSizeUnlimited) {
+            _maxPoolSize(kPoolSizeUnlimited),
+            _checkedOut(0) {
         }
 
         PoolForHost(const PoolForHost& other) :
             _created(other._created),
             _minValidCreationTimeMicroSec(other._minValidCreationTimeMicroSec),
             _type(other._type),
-            _maxPoolSize(other._maxPoolSize) {
+            _maxPoolSize(other._maxPoolSize),
+            _checkedOut(other._checkedOut) {
             verify(_created == 0);
+            verify(_checkedOut == 0);
             verify(other._pool.size() == 0);
         }
 
@@ -82,6 +86,20 @@ namespace mongo {
 
         int numAvailable() const { return (int)_pool.size(); }
 
+        /**
+         * Returns the number of connections handed out, or reserved for creation, which have not
+         * been returned or discarded yet.
+         */
+        int numInUse() const { return _checkedOut; }
+
+        void checkedOutOne() { _checkedOut++; }
+        void returnedOne() {
+            // Connections bound to a ScopedDbConnection from outside the pool are returned
+            // without ever having been checked out
+            if (_checkedOut > 0)
+                _checkedOut--;
+        }
+
         void createdOne( DBClientBase * base );
         long long numCreated() const { return _created; }
 
@@ -138,6 +156,9 @@ namespace mongo {
 
         // The maximum number of connections we'll save in the pool
         int _maxPoolSize;
+
+        // The number of connections currently handed out for this host
+        int _checkedOut;
     };
 
     class DBConnectionHook {
@@ -189,6 +210,25 @@ namespace mongo {
          */
         void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
 
+        /**
+         * Returns the maximum number of connections per-host which may be handed out at once.
+         */
+        int getMaxInUse() { return _maxInUse; }
+
+        /**
+         * Sets the maximum number of connections per-host which may be handed out at once.  Once a
+         * host has reached it, get() waits up to the in-use wait timeout for another connection
+         * to that host to be released or discarded before failing.
+         *
+         * PoolForHost::kPoolSizeUnlimited means no limit.
+         */
+        void setMaxInUse( int maxInUse ) { _maxInUse = maxInUse; }
+
+        /**
+         * Sets how long get() may wait for a host which is at its in-use limit.
+         */
+        void setInUseWaitTimeoutMillis( int millis ) { _inUseWaitTimeoutMillis = millis; }
+
         void onCreate( DBClientBase * conn );
         void onHandedOut( DBClientBase * conn );
         void onDestroy( DBClientBase * conn );
@@ -201,6 +241,13 @@ namespace mongo {
 
         void release(const std::string& host, DBClientBase *c);
 
+        /**
+         * Deletes a connection handed out by get() instead of returning it to the pool, freeing
+         * its slot towards the host's in-use limit.  Use this rather than deleting the connection
+         * directly.
+         */
+        void discard(const std::string& host, DBClientBase* c);
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -238,6 +285,9 @@ namespace mongo {
 
         DBClientBase* _finishCreate( const std::string& ident , double socketTimeout, DBClientBase* conn );
 
+        // Frees the in-use slot _get reserved for a connection which couldn't be handed out
+        void _returnSlot( const std::string& ident , double socketTimeout );
+
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
             std::string ident;
@@ -258,6 +308,18 @@ namespace mongo {
         // 0 effectively disables the pool
         int _maxPoolSize;
 
+        // The maximum number of connections handed out per-host at once, and how long get() waits
+        // for one to be released once a host has reached it
+        int _maxInUse;
+        int _inUseWaitTimeoutMillis;
+
+        // Signalled whenever an in-use connection is released or discarded
+        boost::condition_variable _inUseReleased;
+
+        // Number of get() calls which had to wait for, or timed out waiting for, a connection
+        long long _inUseWaits;
+        long long _inUseWaitTimeouts;
+
         PoolMap _pools;
 
         // pointers owned by me, right now they leak on shutdown
@@ -345,7 +407,8 @@ namespace mongo {
             a bad state.  Destructor will do this too, but it is verbose.
         */
         void kill() {
-            delete _conn;
+            if ( _conn )
+                pool.discard(_host, _conn);
             _conn = 0;
         }
 
@@ -48,6 +48,7 @@
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/password_digest.h"
@@ -917,10 +918,39 @@ namespace mongo {
         int sslModeVal = sslGlobalParams.sslMode.load();
         if (sslModeVal == SSLParams::SSLMode_preferSSL ||
             sslModeVal == SSLParams::SSLMode_requireSSL) {
-            return p->secure( sslManager(), _server.host() );
+            if (!p->secure(sslManager(), _server.host())) {
+                return false;
+            }
         }
 #endif
 
+        return _negotiateCompression(errmsg);
+    }
+
+    bool DBClientConnection::_negotiateCompression(string& errmsg) {
+        BSONObjBuilder cmd;
+        cmd.append("isMaster", 1);
+        appendMessageCompressionRequest(&cmd);
+        if (cmd.asTempObj().nFields() == 1) {
+            // Compression is disabled on this side.
+            return true;
+        }
+
+        BSONObj info;
+        try {
+            // Servers that can't compress, or won't, just leave "compression" out of the reply.
+            if (!runCommand("admin", cmd.obj(), info)) {
+                return true;
+            }
+        }
+        catch (const DBException& e) {
+            errmsg = str::stream() << "couldn't negotiate compression with " << toString()
+                                   << ": " << e.toString();
+            _failed = true;
+            return false;
+        }
+
+        applyMessageCompressionReply(info, p.get());
         return true;
     }
 
@@ -42,6 +42,7 @@
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -164,6 +165,31 @@ namespace {
                 mongo::ReadPreference_SecondaryPreferred : mongo::ReadPreference_PrimaryOnly;
         return new ReadPreferenceSetting(pref, TagSet());
     }
+
+    /**
+     * Reports an operation on a member of a replica set to its monitor, along with its round trip
+     * time if it completed.
+     */
+    class OperationReport {
+        MONGO_DISALLOW_COPYING(OperationReport);
+    public:
+        OperationReport(const ReplicaSetMonitorPtr& monitor, const HostAndPort& host)
+            : _monitor(monitor), _host(host), _completed(false) {
+            _monitor->startedOperation(_host);
+        }
+
+        ~OperationReport() {
+            _monitor->finishedOperation(_host, _completed ? _timer.micros() : -1);
+        }
+
+        void completed() { _completed = true; }
+
+    private:
+        const ReplicaSetMonitorPtr _monitor;
+        const HostAndPort _host;
+        const Timer _timer;
+        bool _completed;
+    };
 } // namespace
 
     // --------------------------------
@@ -182,6 +208,11 @@ namespace {
         if (_lastSlaveOkConn.get() == _master.get()) {
             _lastSlaveOkConn.release();
         }
+
+        for (IdleConns::iterator it = _idleSecondaryConns.begin();
+             it != _idleSecondaryConns.end(); ++it) {
+            delete it->second;
+        }
     }
 
     ReplicaSetMonitorPtr DBClientReplicaSet::_getMonitor() const {
@@ -246,10 +277,20 @@ namespace {
         }
 
         if ( _lastSlaveOkConn.get() && !_lastSlaveOkConn->isStillConnected() ) {
-            resetSlaveOkConn();
+            resetSlaveOkConn(false);
             // Don't notify monitor of bg failure, since it's not clear how long ago it happened
         }
 
+        for (IdleConns::iterator it = _idleSecondaryConns.begin();
+             it != _idleSecondaryConns.end();) {
+            if (it->second->isStillConnected()) {
+                ++it;
+                continue;
+            }
+            pool.release(it->first.toString(), it->second);
+            _idleSecondaryConns.erase(it++);
+        }
+
         return true;
     }
 
@@ -352,19 +393,17 @@ namespace {
         return _master.get();
     }
 
-    bool DBClientReplicaSet::checkLastHost(const ReadPreferenceSetting* readPref) {
+    bool DBClientReplicaSet::checkLastHost(const HostAndPort& host) {
         // Can't use a cached host if we don't have one.
         if (!_lastSlaveOkConn.get() || _lastSlaveOkHost.empty()) {
             return false;
         }
 
-        // Don't pin if the readPrefs differ.
-        if (!_lastReadPref || !_lastReadPref->equals(*readPref)) {
+        if (_lastSlaveOkHost != host) {
             return false;
         }
 
-        // Make sure we don't think the host is down.
-        if (_lastSlaveOkConn->isFailed() || !_getMonitor()->isHostUp(_lastSlaveOkHost)) {
+        if (_lastSlaveOkConn->isFailed()) {
             invalidateLastSlaveOkCache();
             return false;
         }
@@ -458,6 +497,7 @@ namespace {
                 if ( conn != _master.get() ) {
                     resetMaster();
                 }
+                releaseIdleSecondaryConns();
 
                 return;
             }
@@ -492,6 +532,9 @@ namespace {
         DBClientConnection* priConn = checkMaster();
 
         priConn->logout(dbname, info);
+
+        // The idle connections are logged in to dbname as well.
+        releaseIdleSecondaryConns();
         _auths.erase(dbname);
 
         /* Also logout the cached secondary connection. Note that this is only
@@ -558,9 +601,11 @@ namespace {
                         break;
                     }
 
+                    OperationReport report(_getMonitor(), _lastSlaveOkHost);
                     auto_ptr<DBClientCursor> cursor = conn->query(ns, query,
                             nToReturn, nToSkip, fieldsToReturn, queryOptions,
                             batchSize);
+                    report.completed();
 
                     return checkSlaveQueryResult(cursor);
                 }
@@ -618,7 +663,11 @@ namespace {
                         break;
                     }
 
-                    return conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    OperationReport report(_getMonitor(), _lastSlaveOkHost);
+                    BSONObj result = conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    report.completed();
+
+                    return result;
                 }
                 catch ( const DBException &dbExcep ) {
                     StringBuilder errMsgBuilder;
@@ -692,19 +741,11 @@ namespace {
         // Failover to next slave
         _getMonitor()->failedHost( _lastSlaveOkHost );
 
-        resetSlaveOkConn();
+        resetSlaveOkConn(false);
     }
 
     DBClientConnection* DBClientReplicaSet::selectNodeUsingTags(
             shared_ptr<ReadPreferenceSetting> readPref) {
-        if (checkLastHost(readPref.get())) {
-
-            LOG( 3 ) << "dbclient_rs selecting compatible last used node " << _lastSlaveOkHost
-                                << endl;
-
-            return _lastSlaveOkConn.get();
-        }
-
         ReplicaSetMonitorPtr monitor = _getMonitor();
         HostAndPort selectedNode = monitor->getHostOrRefresh(*readPref);
 
@@ -715,6 +756,14 @@ namespace {
             return NULL;
         }
 
+        if (checkLastHost(selectedNode)) {
+
+            LOG( 3 ) << "dbclient_rs selecting last used node " << _lastSlaveOkHost << endl;
+
+            _lastReadPref = readPref;
+            return _lastSlaveOkConn.get();
+        }
+
         // We are now about to get a new connection from the pool, so cleanup
         // the current one and release it back to the pool.
         resetSlaveOkConn();
@@ -736,6 +785,17 @@ namespace {
             return _master.get();
         }
 
+        DBClientConnection* idleConn = takeIdleSecondaryConn(selectedNode);
+        if (idleConn) {
+
+            LOG( 3 ) << "dbclient_rs selecting node " << _lastSlaveOkHost
+                     << " using an idle connection" << endl;
+
+            // Already set up and authenticated when it was first used.
+            _lastSlaveOkConn.reset(idleConn);
+            return _lastSlaveOkConn.get();
+        }
+
         // Needs to perform a dynamic_cast because we need to set the replSet
         // callback. We should eventually not need this after we remove the
         // callback.
@@ -978,7 +1038,13 @@ namespace {
                             *actualServer = conn->getServerAddress();
                         }
 
-                        return conn->call(toSend, response, assertOk);
+                        OperationReport report(_getMonitor(), _lastSlaveOkHost);
+                        const bool ok = conn->call(toSend, response, assertOk);
+                        if (ok) {
+                            report.completed();
+                        }
+
+                        return ok;
                     }
                     catch ( const DBException& dbExcep ) {
                         LOG(1) << "can't call replica set node " << _lastSlaveOkHost << ": "
@@ -1028,7 +1094,7 @@ namespace {
          * as failed. For example, asserts 13079, 13080, 16386
          */
         _getMonitor()->failedHost(_lastSlaveOkHost);
-        resetSlaveOkConn();
+        resetSlaveOkConn(false);
     }
 
     void DBClientReplicaSet::reset() {
@@ -1051,26 +1117,60 @@ namespace {
         _masterHost = HostAndPort();
     }
 
-    void DBClientReplicaSet::resetSlaveOkConn() {
+    void DBClientReplicaSet::resetSlaveOkConn(bool keepIdle) {
         if (_lastSlaveOkConn.get() == _master.get()) {
             _lastSlaveOkConn.release();
         }
         else if (_lastSlaveOkConn.get() != NULL) {
-            if (_authPooledSecondaryConn) {
-                logoutAll(_lastSlaveOkConn.get());
+            if (keepIdle &&
+                    !_lastSlaveOkConn->isFailed() &&
+                    _idleSecondaryConns.find(_lastSlaveOkHost) == _idleSecondaryConns.end()) {
+                _idleSecondaryConns[_lastSlaveOkHost] = _lastSlaveOkConn.release();
             }
             else {
-                // Mongos pooled connections are all authenticated with the same credentials;
-                // so no need to logout.
-            }
+                if (_authPooledSecondaryConn) {
+                    logoutAll(_lastSlaveOkConn.get());
+                }
+                else {
+                    // Mongos pooled connections are all authenticated with the same
+                    // credentials; so no need to logout.
+                }
 
-            // If the connection was bad, the pool will clean it up.
-            pool.release(_lastSlaveOkHost.toString(), _lastSlaveOkConn.release());
+                // If the connection was bad, the pool will clean it up.
+                pool.release(_lastSlaveOkHost.toString(), _lastSlaveOkConn.release());
+            }
         }
 
         _lastSlaveOkHost = HostAndPort();
     }
 
+    DBClientConnection* DBClientReplicaSet::takeIdleSecondaryConn(const HostAndPort& host) {
+        IdleConns::iterator it = _idleSecondaryConns.find(host);
+        if (it == _idleSecondaryConns.end()) {
+            return NULL;
+        }
+
+        DBClientConnection* conn = it->second;
+        _idleSecondaryConns.erase(it);
+        if (conn->isFailed()) {
+            // The pool cleans it up.
+            pool.release(host.toString(), conn);
+            return NULL;
+        }
+        return conn;
+    }
+
+    void DBClientReplicaSet::releaseIdleSecondaryConns() {
+        for (IdleConns::iterator it = _idleSecondaryConns.begin();
+             it != _idleSecondaryConns.end(); ++it) {
+            if (_authPooledSecondaryConn) {
+                logoutAll(it->second);
+            }
+            pool.release(it->first.toString(), it->second);
+        }
+        _idleSecondaryConns.clear();
+    }
+
     // trying to optimize for the common dont-care-about-tags case.
     static const BSONArray tagsMatchesAll = BSON_ARRAY(BSONObj());
     TagSet::TagSet() : _tags(tagsMatchesAll) {}
@@ -226,10 +226,10 @@ namespace mongo {
         DBClientConnection* selectNodeUsingTags(boost::shared_ptr<ReadPreferenceSetting> readPref);
 
         /**
-         * @return true if the last host used in the last slaveOk query is still in the
-         * set and can be used for the given read preference.
+         * @return true if the connection used in the last slaveOk query is to host and is still
+         * good to use.
          */
-        bool checkLastHost(const ReadPreferenceSetting* readPref);
+        bool checkLastHost(const HostAndPort& host);
 
         /**
          * Destroys all cached information about the last slaveOk operation.
@@ -250,9 +250,20 @@ namespace mongo {
         void resetMaster();
 
         /**
-         * Clears the slaveOk connection and returns it to the pool if not the same as _master.
+         * Clears the slaveOk connection.  Unless it is the same as _master, it is kept in
+         * _idleSecondaryConns if keepIdle is true and it is still good, or returned to the pool.
          */
-        void resetSlaveOkConn();
+        void resetSlaveOkConn(bool keepIdle = true);
+
+        /**
+         * Removes and returns the idle connection to host, or returns NULL if there is none.
+         */
+        DBClientConnection* takeIdleSecondaryConn(const HostAndPort& host);
+
+        /**
+         * Returns all idle secondary connections to the pool.
+         */
+        void releaseIdleSecondaryConns();
 
         /**
          * Maximum number of retries to make for auto-retry logic when performing a slave ok
@@ -280,6 +291,13 @@ namespace mongo {
         std::auto_ptr<DBClientConnection> _lastSlaveOkConn;
         boost::shared_ptr<ReadPreferenceSetting> _lastReadPref;
 
+        // Connections to secondaries used by earlier slaveOk operations, at most one per host.
+        // A node is selected for every slaveOk operation, so that reads spread over the set and
+        // move away from a node as soon as it slows down; these save getting a connection from
+        // the pool, and authenticating it, whenever the selection changes. Owned.
+        typedef std::map<HostAndPort, DBClientConnection*> IdleConns;
+        IdleConns _idleSecondaryConns;
+
         double _so_timeout;
 
         // we need to store so that when we connect to a new node on failure
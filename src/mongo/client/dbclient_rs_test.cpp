@@ -53,6 +53,7 @@ namespace {
     using std::map;
     using std::make_pair;
     using std::pair;
+    using std::set;
     using std::string;
     using std::vector;
 
@@ -659,6 +660,33 @@ namespace {
         }
     }
 
+    TEST_F(TaggedFiveMemberRS, ConnShouldSelectNodeForEveryOperation) {
+        MockReplicaSet* replSet = getReplSet();
+        vector<HostAndPort> seedList;
+        seedList.push_back(HostAndPort(replSet->getPrimary()));
+
+        DBClientReplicaSet replConn(replSet->getSetName(), seedList);
+
+        // Need up-to-date view to ensure there are multiple valid choices.
+        ReplicaSetMonitor::get(replSet->getSetName())->startOrContinueRefresh().refreshAll();
+
+        set<string> dests;
+        for (size_t i = 0; i < 2 * replSet->getSecondaries().size(); i++) {
+            Query query;
+            query.readPref(mongo::ReadPreference_SecondaryOnly, BSONArray());
+
+            // Note: IdentityNS contains the name of the server.
+            auto_ptr<DBClientCursor> cursor = replConn.query(IdentityNS, query);
+            BSONObj doc = cursor->next();
+            const string dest = doc[HostField.name()].str();
+            ASSERT_NOT_EQUALS(dest, replSet->getPrimary());
+            dests.insert(dest);
+        }
+
+        // Reads with the same settings spread over all the secondaries.
+        ASSERT_EQUALS(replSet->getSecondaries().size(), dests.size());
+    }
+
     // Note: slaveConn is dangerous and should be deprecated! Also see SERVER-7801.
     TEST_F(TaggedFiveMemberRS, SlaveConnReturnsSecConn) {
         MockReplicaSet* replSet = getReplSet();
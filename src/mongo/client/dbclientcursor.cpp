@@ -33,6 +33,8 @@
 
 #include "mongo/client/dbclientcursor.h"
 
+#include <boost/scoped_ptr.hpp>
+
 #include "mongo/client/connpool.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
@@ -43,6 +45,7 @@
 
 namespace mongo {
 
+    using boost::scoped_ptr;
     using std::auto_ptr;
     using std::endl;
     using std::string;
@@ -153,21 +156,32 @@ namespace mongo {
         return ok;
     }
 
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+
+        toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        if ( opts & QueryOption_Exhaust ) {
+            // The server sends the batches without being asked.
+            exhaustReceiveMore();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
         }
-        BufBuilder b;
-        b.appendNum(opts);
-        b.appendStr(ns);
-        b.appendNum(nextBatchSize());
-        b.appendNum(cursorId);
 
         Message toSend;
-        toSend.setData(dbGetMore, b.buf(), b.len());
+        _assembleGetMore( toSend );
         auto_ptr<Message> response(new Message());
 
         if ( _client ) {
@@ -187,6 +201,55 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::requestMoreLazy() {
+        // A limited cursor adjusts nToReturn when requesting more, which more() relies on while
+        // the current batch is consumed, so it can't run ahead.
+        if ( _pendingMoreConn || _client || _scopedHost.empty() || ! cursorId || haveLimit ||
+             ( opts & ( QueryOption_CursorTailable | QueryOption_Exhaust ) ) ) {
+            return;
+        }
+
+        Message toSend;
+        _assembleGetMore( toSend );
+
+        try {
+            auto_ptr<ScopedDbConnection> conn(new ScopedDbConnection(_scopedHost));
+            conn->get()->say( toSend );
+            _pendingMoreConn = conn.release();
+        }
+        catch ( const DBException& e ) {
+            // Not fatal, the getMore is retried synchronously (and any error reported) by more().
+            LOG(1) << "could not request more results from " << _scopedHost << " ahead of time"
+                   << causedBy( e );
+        }
+    }
+
+    void DBClientCursor::requestMoreLazyFinish() {
+        verify( _pendingMoreConn && cursorId && batch.pos == batch.nReturned );
+
+        // If anything below fails, the connection is closed rather than returned to the pool.
+        scoped_ptr<ScopedDbConnection> conn(_pendingMoreConn);
+        _pendingMoreConn = NULL;
+
+        auto_ptr<Message> response(new Message());
+        if ( ! conn->get()->recv( *response ) ) {
+            uasserted(28703, str::stream() << "recv failed while requesting more results from "
+                                           << _scopedHost);
+        }
+
+        _client = conn->get();
+        this->batch.m = response;
+        try {
+            dataReceived();
+        }
+        catch (...) {
+            _client = 0;
+            throw;
+        }
+        _client = 0;
+        conn->done();
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -261,7 +324,10 @@ namespace mongo {
         if ( cursorId == 0 )
             return false;
 
-        requestMore();
+        if ( _pendingMoreConn )
+            requestMoreLazyFinish();
+        else
+            requestMore();
         return batch.pos < batch.nReturned;
     }
 
@@ -363,6 +429,15 @@ namespace mongo {
     DBClientCursor::~DBClientCursor() {
         DESTRUCTOR_GUARD (
 
+        if ( _pendingMoreConn ) {
+            // Read and drop the reply so the connection can go back to the pool.
+            scoped_ptr<ScopedDbConnection> conn(_pendingMoreConn);
+            _pendingMoreConn = NULL;
+            Message discarded;
+            if ( conn->get()->recv( discarded ) )
+                conn->done();
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
@@ -40,6 +40,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here
         @see DBClientMockCursor
@@ -149,7 +150,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _pendingMoreConn( NULL ) {
             _finishConsInit();
         }
 
@@ -165,7 +167,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _pendingMoreConn(NULL) {
             _finishConsInit();
         }
 
@@ -204,6 +207,22 @@ namespace mongo {
         void initLazy( bool isRetry = false );
         bool initLazyFinish( bool& retry );
 
+        /**
+         * Sends the getMore for the next batch without waiting for the reply, so that the server
+         * produces it while the current batch is still being consumed. The reply is read by the
+         * call to more() that exhausts the current batch.
+         *
+         * Only applies to cursors that are attached (see attach()), still open on the server and
+         * neither tailable, exhaust nor limited; otherwise this does nothing, as it does if a
+         * getMore is already outstanding.
+         */
+        void requestMoreLazy();
+
+        /**
+         * Returns true if a getMore sent by requestMoreLazy() has not been read yet.
+         */
+        bool hasPendingMore() const { return _pendingMoreConn != NULL; }
+
         class Batch : boost::noncopyable {
             friend class DBClientCursor;
             std::auto_ptr<Message> m;
@@ -240,10 +259,15 @@ namespace mongo {
         std::string _lazyHost;
         bool wasError;
 
+        // Holds the connection a getMore sent by requestMoreLazy() is outstanding on, if any.
+        ScopedDbConnection* _pendingMoreConn;
+
         void dataReceived() { bool retry; std::string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, std::string& lazyHost );
         void requestMore();
+        void requestMoreLazyFinish();
         void exhaustReceiveMore(); // for exhaust
+        void _assembleGetMore( Message& toSend );
 
         // Don't call from a virtual function
         void _assertIfNull() const { uassert(13348, "connection died", this); }
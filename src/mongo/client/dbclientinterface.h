@@ -1239,6 +1239,9 @@ namespace mongo {
         double _so_timeout;
         bool _connect( std::string& errmsg );
 
+        // Runs the isMaster that negotiates message compression, if any compressor is enabled.
+        bool _negotiateCompression(std::string& errmsg);
+
         static AtomicInt32 _numConnections;
         static bool _lazyKillCursor; // lazy means we piggy back kill cursors on next op
 
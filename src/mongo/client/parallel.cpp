@@ -295,6 +295,7 @@ namespace mongo {
         _numServers = _servers.size();
         _lastFrom = 0;
         _cursors = 0;
+        _readAhead = true;
 
         if( ! _qSpec.isEmpty() ){
             _needToSkip = _qSpec.ntoskip();
@@ -1476,6 +1477,16 @@ namespace mongo {
         }
     }
 
+    long long ParallelSortClusteredCursor::getReadAheadBytes() {
+        long long bytes = 0;
+        for ( int i=0; i<_numServers; i++ ) {
+            DBClientCursor* cursor = _cursors ? _cursors[i].get() : NULL;
+            if (cursor && cursor->hasPendingMore())
+                bytes += cursor->getMessage()->size();
+        }
+        return bytes;
+    }
+
     bool ParallelSortClusteredCursor::more() {
 
         if ( _needToSkip > 0 ) {
@@ -1540,6 +1551,11 @@ namespace mongo {
         uassert(10019, "no more elements", bestFrom >= 0);
         _cursors[bestFrom].get()->next();
 
+        // Have the shard produce its next batch while the rest of this one is merged, rather than
+        // waiting for a round trip to it when the batch runs out.
+        if (_readAhead)
+            _cursors[bestFrom].get()->requestMoreLazy();
+
         // Make sure the result data won't go away after the next call to more()
         if (!_cursors[bestFrom].get()->moreInCurrentBatch()) {
             best = best.getOwned();
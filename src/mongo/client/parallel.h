@@ -170,6 +170,19 @@ namespace mongo {
          */
         void setBatchSize(int newBatchSize);
 
+        /**
+         * Controls whether next() asks a shard for its next batch as soon as it starts consuming
+         * the current one (see DBClientCursor::requestMoreLazy()). On by default. Turning it off
+         * leaves getMores which are already outstanding alone.
+         */
+        void setReadAhead(bool readAhead) { _readAhead = readAhead; }
+
+        /**
+         * Estimates the size of the replies to getMores requested ahead of time and not read yet,
+         * taking each shard's next batch to be as large as the one it last returned.
+         */
+        long long getReadAheadBytes();
+
         /**
          * Returns whether the collection was sharded when the cursors were established.
          */
@@ -215,6 +228,7 @@ namespace mongo {
 
         bool _didInit;
         bool _done;
+        bool _readAhead;
 
         QuerySpec _qSpec;
         CommandInfo _cInfo;
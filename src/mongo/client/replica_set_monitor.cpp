@@ -41,6 +41,7 @@
 #include "mongo/client/connpool.h"
 #include "mongo/client/replica_set_monitor_internal.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/concurrency/mutex.h" // for StaticObserver
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
@@ -75,8 +76,6 @@ namespace {
     typedef SetState::Node Node;
     typedef SetState::Nodes Nodes;
 
-    const double socketTimeoutSecs = 5;
-
     /*  Replica Set Monitor shared state:
      *      If a program (such as one built with the C++ driver) exits (by either calling exit()
      *      or by returning from main()), static objects will be destroyed in the reverse order
@@ -145,6 +144,15 @@ namespace {
             _stopRequestedCV.notify_one();
         }
 
+        /**
+         * Asks for the named set to be refreshed now instead of at the next periodic check.
+         */
+        void requestRefresh(const std::string& setName) {
+            boost::lock_guard<boost::mutex> sl( _monitorMutex );
+            if (_pendingSets.insert(setName).second)
+                _stopRequestedCV.notify_one();
+        }
+
     protected:
         void run() {
             log() << "starting"; // includes thread name in output
@@ -153,22 +161,41 @@ namespace {
             // are fixed - see 392b933598668768bf12b1e41ad444aa3548d970.
             // Should not be needed after SERVER-7533 gets implemented and tests start
             // using it.
+            boost::system_time nextCheckAll =
+                boost::get_system_time() + boost::posix_time::seconds(10);
             if (!inShutdown() && !StaticObserver::_destroyingStatics) {
                 boost::unique_lock<boost::mutex> sl( _monitorMutex );
-                _stopRequestedCV.timed_wait(sl, boost::posix_time::seconds(10));
+                while (!_stopRequested && _stopRequestedCV.timed_wait(sl, nextCheckAll)) {
+                }
             }
 
             while ( !inShutdown() &&
                     !StaticObserver::_destroyingStatics ) {
+                set<string> pendingSets;
+                bool checkAll = false;
                 {
-                    boost::lock_guard<boost::mutex> sl( _monitorMutex );
+                    boost::unique_lock<boost::mutex> sl( _monitorMutex );
+                    // Sleep until the next periodic check of all sets, or until a set is asked
+                    // to be refreshed early.
+                    while (!_stopRequested && _pendingSets.empty() &&
+                           _stopRequestedCV.timed_wait(sl, nextCheckAll)) {
+                    }
+
                     if (_stopRequested) {
                         break;
                     }
+
+                    checkAll = boost::get_system_time() >= nextCheckAll;
+                    pendingSets.swap(_pendingSets);
                 }
 
                 try {
-                    checkAllSets();
+                    if (checkAll) {
+                        checkAllSets();
+                    }
+                    else {
+                        checkSets(pendingSets);
+                    }
                 }
                 catch ( std::exception& e ) {
                     error() << "check failed: " << e.what();
@@ -177,30 +204,66 @@ namespace {
                     error() << "unknown error";
                 }
 
-                boost::unique_lock<boost::mutex> sl( _monitorMutex );
-                if (_stopRequested) {
-                    break;
+                if (checkAll) {
+                    nextCheckAll = boost::get_system_time() + boost::posix_time::seconds(10);
                 }
-
-                _stopRequestedCV.timed_wait(sl, boost::posix_time::seconds(10));
             }
         }
 
         void checkAllSets() {
             // make a copy so we can quickly unlock setsLock
-            StringMap<ReplicaSetMonitorPtr> setsCopy;
+            std::vector<ReplicaSetMonitorPtr> monitors;
             {
                 boost::lock_guard<boost::mutex> lk( setsLock );
-                setsCopy = sets;
+                for (StringMap<ReplicaSetMonitorPtr>::const_iterator it = sets.begin();
+                        it != sets.end(); ++it) {
+                    monitors.push_back(it->second);
+                }
             }
 
-            for (StringMap<ReplicaSetMonitorPtr>::const_iterator it = setsCopy.begin();
-                    it != setsCopy.end(); ++it) {
-                LOG(1) << "checking replica set: " << it->first;
-                ReplicaSetMonitorPtr m = it->second;
+            refreshSets(monitors);
+        }
 
-                m->startOrContinueRefresh().refreshAll();
+        void checkSets(const set<string>& setNames) {
+            std::vector<ReplicaSetMonitorPtr> monitors;
+            {
+                boost::lock_guard<boost::mutex> lk( setsLock );
+                for (set<string>::const_iterator it = setNames.begin();
+                        it != setNames.end(); ++it) {
+                    StringMap<ReplicaSetMonitorPtr>::const_iterator setIt = sets.find(*it);
+                    if (setIt != sets.end())
+                        monitors.push_back(setIt->second);
+                }
+            }
+
+            refreshSets(monitors);
+        }
+
+        static void refreshSet(ReplicaSetMonitorPtr m) {
+            LOG(1) << "checking replica set: " << m->getName();
+            m->startOrContinueRefresh().refreshAll();
+        }
 
+        void refreshSets(const std::vector<ReplicaSetMonitorPtr>& monitors) {
+            // Each set is refreshed by a single thread, contacting its hosts one at a time, but
+            // different sets are refreshed at once so that slow hosts only delay their own set.
+            const size_t numThreads = std::min(monitors.size(),
+                    static_cast<size_t>(std::max(1, ReplicaSetMonitor::refreshThreads)));
+            if (numThreads <= 1) {
+                for (size_t i = 0; i < monitors.size(); i++) {
+                    refreshSet(monitors[i]);
+                }
+            }
+            else {
+                ThreadPool workers(numThreads, "ReplicaSetMonitorRefresh");
+                for (size_t i = 0; i < monitors.size(); i++) {
+                    workers.schedule(&refreshSet, monitors[i]);
+                }
+                workers.join();
+            }
+
+            for (size_t i = 0; i < monitors.size(); i++) {
+                const ReplicaSetMonitorPtr& m = monitors[i];
                 const int numFails = m->getConsecutiveFailedScans();
                 if (numFails >= ReplicaSetMonitor::maxConsecutiveFailedChecks) {
                     log() << "Replica set " << m->getName() << " was down for " << numFails
@@ -212,12 +275,15 @@ namespace {
             }
         }
 
-        // protects _started, _stopRequested
+        // protects _started, _stopRequested, _pendingSets
         mongo::mutex _monitorMutex;
         bool _started;
 
+        // notified when _stopRequested is set or a set is added to _pendingSets
         boost::condition _stopRequestedCV;
         bool _stopRequested;
+
+        set<string> _pendingSets; // names of sets to refresh without waiting for the next check
     } replicaSetMonitorWatcher;
 
     StaticObserver staticObserver;
@@ -232,6 +298,12 @@ namespace {
         return lhs->latencyMicros < rhs->latencyMicros;
     }
 
+    bool compareLoads(const Node* lhs, const Node* rhs) {
+        if (lhs->pendingOperations != rhs->pendingOperations)
+            return lhs->pendingOperations < rhs->pendingOperations;
+        return compareLatencies(lhs, rhs);
+    }
+
     bool hostsEqual(const Node& lhs, const HostAndPort& rhs) { return lhs.host == rhs; }
 
     // Allows comparing two Nodes, or a HostAndPort and a Node.
@@ -267,6 +339,10 @@ namespace {
     // At 1 check every 10 seconds, 30 checks takes 5 minutes
     int ReplicaSetMonitor::maxConsecutiveFailedChecks = 30;
 
+    int ReplicaSetMonitor::refreshThreads = 8;
+
+    int ReplicaSetMonitor::isMasterTimeoutMillis = 5000;
+
     // Defaults to random selection as required by the spec
     bool ReplicaSetMonitor::useDeterministicHostSelection = false;
 
@@ -321,11 +397,41 @@ namespace {
     }
 
     void ReplicaSetMonitor::failedHost(const HostAndPort& host) {
+        bool wasUp = false;
+        {
+            boost::lock_guard<boost::mutex> lk(_state->mutex);
+            Node* node = _state->findNode(host);
+            if (node) {
+                wasUp = node->isUp;
+                node->markFailed();
+            }
+            DEV _state->checkInvariants();
+        }
+
+        // Only a host going down is news; hosts already known to be down are left to the periodic
+        // checks so that clients retrying against them don't keep the set rescanning.
+        if (wasUp)
+            replicaSetMonitorWatcher.requestRefresh(getName());
+    }
+
+    void ReplicaSetMonitor::startedOperation(const HostAndPort& host) {
         boost::lock_guard<boost::mutex> lk(_state->mutex);
         Node* node = _state->findNode(host);
         if (node)
-            node->markFailed();
-        DEV _state->checkInvariants();
+            node->pendingOperations++;
+    }
+
+    void ReplicaSetMonitor::finishedOperation(const HostAndPort& host, int64_t latencyMicros) {
+        boost::lock_guard<boost::mutex> lk(_state->mutex);
+        Node* node = _state->findNode(host);
+        if (!node)
+            return;
+
+        // The node may have been dropped and added again while the operation ran.
+        if (node->pendingOperations > 0)
+            node->pendingOperations--;
+        if (latencyMicros >= 0)
+            node->updateLatency(latencyMicros);
     }
 
     bool ReplicaSetMonitor::isPrimary(const HostAndPort& host) const {
@@ -467,6 +573,13 @@ namespace {
             hosts.append(builder.obj());
         }
         hosts.done();
+
+        BSONObjBuilder scans(bsonObjBuilder.subobjStart("scans"));
+        scans.appendNumber("count", static_cast<long long>(_state->numScans));
+        scans.appendNumber("lastMicros", static_cast<long long>(_state->lastScanMicros));
+        scans.appendNumber("maxMicros", static_cast<long long>(_state->maxScanMicros));
+        scans.appendNumber("totalMicros", static_cast<long long>(_state->totalScanMicros));
+        scans.done();
     }
 
     void ReplicaSetMonitor::cleanup() {
@@ -539,6 +652,7 @@ namespace {
                       << " more failed checks";
             }
 
+            _set->recordScan(_scan->timer.micros());
             _set->currentScan.reset(); // Makes sure all other Refreshers in this round return DONE
             return NextStep(NextStep::DONE);
         }
@@ -773,7 +887,8 @@ namespace {
                 DEV _set->checkInvariants();
                 lk.unlock(); // relocked after attempting to call isMaster
                 try {
-                    ScopedDbConnection conn(ConnectionString(ns.host), socketTimeoutSecs);
+                    ScopedDbConnection conn(ConnectionString(ns.host),
+                                            isMasterTimeoutMillis / 1000.0);
                     bool ignoredOutParam = false;
                     Timer timer;
                     conn->isMaster(ignoredOutParam, &reply);
@@ -876,13 +991,17 @@ namespace {
             tags = reply.tags.getOwned();
 
         if (reply.latencyMicros >= 0) { // TODO upper bound?
-            if (latencyMicros == unknownLatency) {
-                latencyMicros = reply.latencyMicros;
-            }
-            else {
-                // update latency with smoothed moving average (1/4th the delta)
-                latencyMicros += (reply.latencyMicros - latencyMicros) / 4;
-            }
+            updateLatency(reply.latencyMicros);
+        }
+    }
+
+    void Node::updateLatency(int64_t sampleMicros) {
+        if (latencyMicros == unknownLatency) {
+            latencyMicros = sampleMicros;
+        }
+        else {
+            // update latency with smoothed moving average (1/4th the delta)
+            latencyMicros += (sampleMicros - latencyMicros) / 4;
         }
     }
 
@@ -895,6 +1014,10 @@ namespace {
         , latencyThresholdMicros(serverGlobalParams.defaultLocalThresholdMillis * 1000)
         , rand(int64_t(time(0)))
         , roundRobin(0)
+        , numScans(0)
+        , lastScanMicros(0)
+        , maxScanMicros(0)
+        , totalScanMicros(0)
     {
         uassert(13642, "Replica set seed list can't be empty", !seedNodes.empty());
 
@@ -983,8 +1106,12 @@ namespace {
                     return matchingNodes[roundRobin++ % matchingNodes.size()]->host;
                 }
                 else {
-                    // normal case
-                    return matchingNodes[rand.nextInt32(matchingNodes.size())]->host;
+                    // normal case: of two random candidates, take the one with fewer operations
+                    // in progress, or else the lower latency, so that a node slowed down by load
+                    // gets less of it while the rest still share it
+                    const Node* first = matchingNodes[rand.nextInt32(matchingNodes.size())];
+                    const Node* second = matchingNodes[rand.nextInt32(matchingNodes.size())];
+                    return compareLoads(second, first) ? second->host : first->host;
                 };
             }
 
@@ -1042,6 +1169,13 @@ namespace {
         return ss.str();
     }
 
+    void SetState::recordScan(int64_t scanMicros) {
+        numScans++;
+        lastScanMicros = scanMicros;
+        maxScanMicros = std::max(maxScanMicros, scanMicros);
+        totalScanMicros += scanMicros;
+    }
+
     void SetState::checkInvariants() const {
         bool foundMaster = false;
         for (size_t i = 0; i < nodes.size(); i++) {
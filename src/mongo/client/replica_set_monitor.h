@@ -93,9 +93,27 @@ namespace mongo {
          *
          * Call this when you get a connection error. If you get an error while trying to refresh
          * our view of a host, call Refresher::hostFailed() instead.
+         *
+         * If the host was thought to be up, this also asks the ReplicaSetMonitorWatcher to rescan
+         * the set right away rather than at its next periodic check.
          */
         void failedHost(const HostAndPort& host);
 
+        /**
+         * Notifies this Monitor that a client sent an operation to host, which counts against the
+         * host when choosing between nodes that are equally close.  Every call must be followed
+         * by a call to finishedOperation() for the same host.
+         */
+        void startedOperation(const HostAndPort& host);
+
+        /**
+         * Notifies this Monitor that an operation sent to host is over.  If latencyMicros is not
+         * negative, it is the round trip time of the operation, which is folded into the latency
+         * of the host like the ping times of the periodic scans, so that a host which slows down
+         * is noticed between scans.
+         */
+        void finishedOperation(const HostAndPort& host, int64_t latencyMicros);
+
         /**
          * Returns true if this node is the master based ONLY on local data. Be careful, return may
          * be stale.
@@ -184,6 +202,18 @@ namespace mongo {
          */
         static int maxConsecutiveFailedChecks;
 
+        /**
+         * The ReplicaSetMonitorWatcher refreshes up to this many sets at once, so that sets with
+         * slow or unreachable hosts don't hold up noticing changes in the others.
+         */
+        static int refreshThreads;
+
+        /**
+         * How long a refresh waits on the isMaster reply of any one host before counting that host
+         * as down.
+         */
+        static int isMasterTimeoutMillis;
+
         //
         // internal types (defined in replica_set_monitor_internal.h)
         //
@@ -294,6 +324,21 @@ namespace mongo {
          */
         void failedHost(const HostAndPort& host);
 
+        /**
+         * Notifies this Monitor that a client sent an operation to host, which counts against the
+         * host when choosing between nodes that are equally close.  Every call must be followed
+         * by a call to finishedOperation() for the same host.
+         */
+        void startedOperation(const HostAndPort& host);
+
+        /**
+         * Notifies this Monitor that an operation sent to host is over.  If latencyMicros is not
+         * negative, it is the round trip time of the operation, which is folded into the latency
+         * of the host like the ping times of the periodic scans, so that a host which slows down
+         * is noticed between scans.
+         */
+        void finishedOperation(const HostAndPort& host, int64_t latencyMicros);
+
         /**
          * True if this Refresher started a new full scan rather than joining an existing one.
          */
@@ -46,6 +46,7 @@
 #include "mongo/platform/cstdint.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/net/hostandport.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
     struct ReplicaSetMonitor::IsMasterReply {
@@ -85,7 +86,8 @@ namespace mongo {
         struct Node {
             explicit Node(const HostAndPort& host)
                     : host(host)
-                    , latencyMicros(unknownLatency) {
+                    , latencyMicros(unknownLatency)
+                    , pendingOperations(0) {
                 markFailed();
             }
 
@@ -116,6 +118,12 @@ namespace mongo {
              */
             void update(const IsMasterReply& reply);
 
+            /**
+             * Folds a round trip time into latencyMicros, which is a moving average of both the
+             * pings of the monitor and the operations reported by clients.
+             */
+            void updateLatency(int64_t sampleMicros);
+
             // Intentionally chosen to compare worse than all known latencies.
             static const int64_t unknownLatency; // = numeric_limits<int64_t>::max()
 
@@ -123,6 +131,7 @@ namespace mongo {
             bool isUp;
             bool isMaster; // implies isUp
             int64_t latencyMicros; // unknownLatency if unknown
+            int pendingOperations; // started by clients but not finished yet
             BSONObj tags; // owned
         };
         typedef std::vector<Node> Nodes;
@@ -159,6 +168,11 @@ namespace mongo {
          */
         void checkInvariants() const;
 
+        /**
+         * Records how long a scan of the set took, from its start until it found what it could.
+         */
+        void recordScan(int64_t scanMicros);
+
         static ConfigChangeHook configChangeHook;
 
         boost::mutex mutex; // must hold this to access any other member or method (except name).
@@ -181,6 +195,12 @@ namespace mongo {
         int64_t latencyThresholdMicros;
         mutable PseudoRandom rand; // only used for host selection to balance load
         mutable int roundRobin; // used when useDeterministicHostSelection is true
+
+        // Stats about completed scans, reported by ReplicaSetMonitor::appendInfo.
+        int64_t numScans;
+        int64_t lastScanMicros;
+        int64_t maxScanMicros;
+        int64_t totalScanMicros;
     };
 
     struct ReplicaSetMonitor::ScanState {
@@ -206,5 +226,7 @@ namespace mongo {
         // All responses go here until we find a master.
         typedef std::vector<IsMasterReply> UnconfirmedReplies;
         UnconfirmedReplies unconfirmedReplies;
+
+        Timer timer; // started when the scan is
     };
 }
@@ -289,6 +289,37 @@ TEST(ReplicaSetMonitorTests, CheckAllSeedsSerial) {
     }
 }
 
+TEST(ReplicaSetMonitorTests, ScanStats) {
+    SetStatePtr state = boost::make_shared<SetState>("name", basicSeedsSet);
+    ASSERT_EQUALS(state->numScans, 0);
+
+    for (int scan = 1; scan <= 2; scan++) {
+        Refresher refresher(state);
+        for (NextStep ns = refresher.getNextStep(); ns.step == NextStep::CONTACT_HOST;
+                ns = refresher.getNextStep()) {
+            bool primary = ns.host.host() == "a";
+            refresher.receivedIsMaster(ns.host, -1, BSON(
+                    "setName" << "name"
+                 << "ismaster" << primary
+                 << "secondary" << !primary
+                 << "hosts" << BSON_ARRAY("a" << "b" << "c")
+                 << "ok" << true
+                 ));
+        }
+
+        ASSERT(!state->currentScan);
+        ASSERT_EQUALS(state->numScans, scan);
+        ASSERT_GREATER_THAN_OR_EQUALS(state->maxScanMicros, state->lastScanMicros);
+        ASSERT_GREATER_THAN_OR_EQUALS(state->totalScanMicros, state->maxScanMicros);
+    }
+
+    BSONObjBuilder bob;
+    ReplicaSetMonitor(state).appendInfo(bob);
+    BSONObj scans = bob.obj()["scans"].Obj();
+    ASSERT_EQUALS(scans["count"].numberLong(), 2);
+    ASSERT_EQUALS(scans["totalMicros"].numberLong(), state->totalScanMicros);
+}
+
 TEST(ReplicaSetMonitorTests, CheckAllSeedsParallel) {
     SetStatePtr state = boost::make_shared<SetState>("name", basicSeedsSet);
     Refresher refresher(state);
@@ -784,3 +815,52 @@ TEST(ReplicaSetMonitorTests, OutOfBandFailedHost) {
         }
     }
 }
+
+// Round trips reported by clients move the latency of a node between scans, so that reads
+// leave it as soon as it slows down.
+TEST(ReplicaSetMonitorTests, OperationLatencies) {
+    SetStatePtr state = boost::make_shared<SetState>("name", basicSeedsSet);
+    ReplicaSetMonitorPtr rsm = boost::make_shared<ReplicaSetMonitor>(state);
+    Refresher refresher = rsm->startOrContinueRefresh();
+
+    for (size_t i = 0; i != basicSeeds.size(); ++i) {
+        NextStep ns = refresher.getNextStep();
+    }
+
+    for (size_t i = 0; i != basicSeeds.size(); ++i) {
+        bool primary = (i == 0);
+        refresher.receivedIsMaster(basicSeeds[i], 1000, BSON(
+                "setName" << "name"
+             << "ismaster" << primary
+             << "secondary" << !primary
+             << "hosts" << BSON_ARRAY("a" << "b" << "c")
+             << "ok" << true
+             ));
+    }
+
+    const HostAndPort b("b");
+    Node* node = state->findNode(b);
+    ASSERT(node);
+    ASSERT_EQUALS(1000, node->latencyMicros);
+
+    rsm->startedOperation(b);
+    ASSERT_EQUALS(1, node->pendingOperations);
+    rsm->finishedOperation(b, -1);
+    ASSERT_EQUALS(0, node->pendingOperations);
+    ASSERT_EQUALS(1000, node->latencyMicros);
+
+    rsm->startedOperation(b);
+    rsm->finishedOperation(b, 1000 + 4 * 100 * 1000);
+    ASSERT_EQUALS(0, node->pendingOperations);
+    ASSERT_EQUALS(1000 + 100 * 1000, node->latencyMicros);
+
+    // b is now well outside the latency window of c.
+    const ReadPreferenceSetting secondary(ReadPreference_SecondaryOnly, TagSet());
+    for (int i = 0; i < 10; i++) {
+        ASSERT_EQUALS(HostAndPort("c"), state->getMatchingHost(secondary));
+    }
+
+    // Hosts that aren't in the set are ignored.
+    rsm->startedOperation(HostAndPort("d"));
+    rsm->finishedOperation(HostAndPort("d"), 1000);
+}
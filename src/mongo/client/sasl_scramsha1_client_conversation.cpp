@@ -32,6 +32,9 @@
 
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
 
 #include "mongo/base/parse_number.h"
 #include "mongo/client/sasl_client_session.h"
@@ -46,6 +49,69 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::string;
 
+namespace {
+
+    /**
+     * SaltedPasswords computed by the client conversations of this process, by user, salt and
+     * iteration count.  These only change with the user's password, so reconnecting to servers
+     * which know the user doesn't recompute the iterated hash, leaving a few HMACs per login.
+     */
+    class SaltedPasswordCache {
+    public:
+        ~SaltedPasswordCache() {
+            _clear_inlock();
+        }
+
+        /**
+         * Copies the SaltedPassword computed from "hashedPassword" with "key" to
+         * "saltedPassword", and returns true, if there is one.
+         */
+        bool get(const std::string& key,
+                 StringData hashedPassword,
+                 unsigned char saltedPassword[scram::hashSize]) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            CacheMap::const_iterator it = _cache.find(key);
+            if (it == _cache.end() || hashedPassword != it->second.hashedPassword) {
+                return false;
+            }
+            memcpy(saltedPassword, it->second.saltedPassword, scram::hashSize);
+            return true;
+        }
+
+        void put(const std::string& key,
+                 StringData hashedPassword,
+                 const unsigned char saltedPassword[scram::hashSize]) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_cache.size() >= kMaxEntries && !_cache.count(key)) {
+                _clear_inlock();
+            }
+            Entry& entry = _cache[key];
+            entry.hashedPassword = hashedPassword.toString();
+            memcpy(entry.saltedPassword, saltedPassword, scram::hashSize);
+        }
+
+    private:
+        static const size_t kMaxEntries = 100;
+
+        struct Entry {
+            std::string hashedPassword;
+            unsigned char saltedPassword[scram::hashSize];
+        };
+        typedef std::map<std::string, Entry> CacheMap;
+
+        void _clear_inlock() {
+            for (CacheMap::iterator it = _cache.begin(); it != _cache.end(); ++it) {
+                memset(it->second.saltedPassword, 0, scram::hashSize);
+            }
+            _cache.clear();
+        }
+
+        boost::mutex _mutex;
+        CacheMap _cache;
+    } saltedPasswordCache;
+
+} // namespace
+
     SaslSCRAMSHA1ClientConversation::SaslSCRAMSHA1ClientConversation(
                                                     SaslClientSession* saslClientSession) :
         SaslClientConversation(saslClientSession),
@@ -181,12 +247,20 @@ namespace mongo {
             return StatusWith<bool>(ex.toStatus());
         }
 
-        scram::generateSaltedPassword(
-                            _saslClientSession->getParameter(SaslClientSession::parameterPassword),
-                            reinterpret_cast<const unsigned char*>(decodedSalt.c_str()),
-                            decodedSalt.size(),
-                            iterationCount,
-                            _saltedPassword);
+        const StringData hashedPassword =
+            _saslClientSession->getParameter(SaslClientSession::parameterPassword);
+        const std::string cacheKey = mongoutils::str::stream() <<
+            _saslClientSession->getParameter(SaslClientSession::parameterUser) << '\0' <<
+            decodedSalt << '\0' << iterationCount;
+        if (!saltedPasswordCache.get(cacheKey, hashedPassword, _saltedPassword)) {
+            scram::generateSaltedPassword(
+                                hashedPassword,
+                                reinterpret_cast<const unsigned char*>(decodedSalt.c_str()),
+                                decodedSalt.size(),
+                                iterationCount,
+                                _saltedPassword);
+            saltedPasswordCache.put(cacheKey, hashedPassword, _saltedPassword);
+        }
 
         std::string clientProof = scram::generateClientProof(_saltedPassword, _authMessage);
 
@@ -550,13 +550,30 @@ namespace {
 
     bool AuthorizationSession::_isAuthorizedForPrivilege(const Privilege& privilege) {
         const ResourcePattern& target(privilege.getResourcePattern());
+        const bool allowLocalhost = _externalState->shouldAllowLocalhost();
+
+        // Unless the localhost exception adds default privileges, an action which none of the
+        // authenticated users hold on any resource can't be granted, and there is no need to
+        // build the resource search list or look the resources up.
+        if (!allowLocalhost) {
+            ActionSet grantableActions;
+            for (UserSet::iterator it = _authenticatedUsers.begin();
+                    it != _authenticatedUsers.end(); ++it) {
+                grantableActions.addAllActionsFromSet((*it)->getAllActions());
+            }
+            if (!grantableActions.isSupersetOf(privilege.getActions()))
+                return false;
+        }
 
         ResourcePattern resourceSearchList[resourceSearchListCapacity];
         const int resourceSearchListLength = buildResourceSearchList(target, resourceSearchList);
 
         ActionSet unmetRequirements = privilege.getActions();
 
-        PrivilegeVector defaultPrivileges = getDefaultPrivileges();
+        PrivilegeVector defaultPrivileges;
+        if (allowLocalhost) {
+            defaultPrivileges = getDefaultPrivileges();
+        }
         for (PrivilegeVector::iterator it = defaultPrivileges.begin();
                 it != defaultPrivileges.end(); ++it) {
 
@@ -35,6 +35,9 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
 
 #include "mongo/crypto/crypto.h"
 #include "mongo/crypto/mechanism_scram.h"
@@ -52,6 +55,57 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::string;
 
+namespace {
+
+    // Use a default value of 5000 for the scramIterationCount when in mixed mode,
+    // overriding the default value (10000) used for SCRAM mode or the user-given value.
+    const int mixedModeScramIterationCount = 5000;
+
+    /**
+     * SCRAM credentials generated for users which only have MONGODB-CR credentials, so that
+     * the iterated hash is computed once per user and password rather than on every login.
+     * Keeping the same salt also lets clients reuse the SaltedPassword they computed.
+     */
+    class MixedModeCredentialsCache {
+    public:
+        User::SCRAMCredentials get(const UserName& userName, const std::string& password) {
+            const std::string key = userName.getFullName();
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                CacheMap::const_iterator it = _cache.find(key);
+                if (it != _cache.end() && it->second.first == password) {
+                    return it->second.second;
+                }
+            }
+
+            BSONObj scramCreds = scram::generateCredentials(password,
+                                                            mixedModeScramIterationCount);
+            User::SCRAMCredentials creds;
+            creds.iterationCount = scramCreds[scram::iterationCountFieldName].Int();
+            creds.salt = scramCreds[scram::saltFieldName].String();
+            creds.storedKey = scramCreds[scram::storedKeyFieldName].String();
+            creds.serverKey = scramCreds[scram::serverKeyFieldName].String();
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_cache.size() >= kMaxUsers && !_cache.count(key)) {
+                _cache.clear();
+            }
+            _cache[key] = std::make_pair(password, creds);
+            return creds;
+        }
+
+    private:
+        static const size_t kMaxUsers = 1000;
+
+        // From user name to the password hash the credentials were generated from, and them.
+        typedef std::map<std::string, std::pair<std::string, User::SCRAMCredentials> > CacheMap;
+
+        boost::mutex _mutex;
+        CacheMap _cache;
+    } mixedModeCredentialsCache;
+
+} // namespace
+
     SaslSCRAMSHA1ServerConversation::SaslSCRAMSHA1ServerConversation(
                                                     SaslAuthenticationSession* saslAuthSession) :
         SaslServerConversation(saslAuthSession),
@@ -189,15 +243,7 @@ namespace mongo {
 
         // Generate SCRAM credentials on the fly for mixed MONGODB-CR/SCRAM mode.
         if (_creds.scram.salt.empty() && !_creds.password.empty()) {
-            // Use a default value of 5000 for the scramIterationCount when in mixed mode,
-            // overriding the default value (10000) used for SCRAM mode or the user-given value.
-            const int mixedModeScramIterationCount = 5000;
-            BSONObj scramCreds = scram::generateCredentials(_creds.password,
-                                                            mixedModeScramIterationCount);
-            _creds.scram.iterationCount = scramCreds[scram::iterationCountFieldName].Int();
-            _creds.scram.salt = scramCreds[scram::saltFieldName].String();
-            _creds.scram.storedKey = scramCreds[scram::storedKeyFieldName].String();
-            _creds.scram.serverKey = scramCreds[scram::serverKeyFieldName].String();
+            _creds.scram = mixedModeCredentialsCache.get(userName, _creds.password);
         }
 
         // Generate server-first-message
@@ -89,6 +89,7 @@ namespace mongo {
     User* User::clone() const {
         std::auto_ptr<User> result(new User(_name));
         result->_privileges = _privileges;
+        result->_allActions = _allActions;
         result->_roles = _roles;
         result->_credentials = _credentials;
         return result.release();
@@ -114,9 +115,11 @@ namespace mongo {
 
     void User::setPrivileges(const PrivilegeVector& privileges) {
         _privileges.clear();
+        _allActions.removeAllActions();
         for (size_t i = 0; i < privileges.size(); ++i) {
             const Privilege& privilege = privileges[i];
             _privileges[privilege.getResourcePattern()] = privilege;
+            _allActions.addAllActionsFromSet(privilege.getActions());
         }
     }
 
@@ -139,6 +142,7 @@ namespace mongo {
             dassert(it->first == privilegeToAdd.getResourcePattern());
             it->second.addActions(privilegeToAdd.getActions());
         }
+        _allActions.addAllActionsFromSet(privilegeToAdd.getActions());
     }
 
     void User::addPrivileges(const PrivilegeVector& privileges) {
@@ -121,6 +121,13 @@ namespace mongo {
          */
         const ActionSet getActionsForResource(const ResourcePattern& resource) const;
 
+        /**
+         * Gets the union of the actions this user is allowed to perform on any resource.  An action
+         * missing from this set is not granted on any resource, which lets authorization checks
+         * reject such requests without searching the privilege map.
+         */
+        const ActionSet& getAllActions() const { return _allActions; }
+
         /**
          * Returns true if this copy of information about this user is still valid. If this returns
          * false, this object should no longer be used and should be returned to the
@@ -214,6 +221,9 @@ namespace mongo {
         // Maps resource name to privilege on that resource
         ResourcePrivilegeMap _privileges;
 
+        // Union of the actions of all privileges in _privileges
+        ActionSet _allActions;
+
         // Roles the user has privileges from
         unordered_set<RoleName> _roles;
 
@@ -34,6 +34,7 @@
 
 #include "mongo/db/catalog/collection.h"
 
+#include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
 
 #include "mongo/base/counter.h"
@@ -81,10 +82,77 @@ namespace mongo {
         }
 
         ss << " validateDocuments: " << validateDocuments;
+        ss << " freeSpaceOnly: " << freeSpaceOnly;
+        ss << " online: " << online;
+        if ( online )
+            ss << " batchSize: " << batchSize;
 
         return ss.str();
     }
 
+namespace {
+
+    /**
+     * Drops a written document from the _id lookup cache again once its write commits or rolls
+     * back, so that no reader can cache the version it saw before the write became visible.
+     */
+    class InvalidateIdLookupChange : public RecoveryUnit::Change {
+    public:
+        InvalidateIdLookupChange(const boost::shared_ptr<IdLookupCache>& cache,
+                                 const BSONObj& id)
+            : _cache(cache),
+              _id(id.getOwned()) { }
+
+        virtual void commit() { _cache->invalidate(_id); }
+        virtual void rollback() { _cache->invalidate(_id); }
+
+    private:
+        const boost::shared_ptr<IdLookupCache> _cache;
+        const BSONObj _id;
+    };
+
+    /**
+     * Signals the capped insert notifier once a write commits, and only then, as tailable cursors
+     * can't see the new documents before.
+     */
+    class NotifyCappedWaitersChange : public RecoveryUnit::Change {
+    public:
+        explicit NotifyCappedWaitersChange(const boost::shared_ptr<CappedInsertNotifier>& notifier)
+            : _notifier(notifier) { }
+
+        virtual void commit() { _notifier->notifyAll(); }
+        virtual void rollback() { }
+
+    private:
+        const boost::shared_ptr<CappedInsertNotifier> _notifier;
+    };
+
+}  // namespace
+
+    CappedInsertNotifier::CappedInsertNotifier()
+        : _version(0) { }
+
+    uint64_t CappedInsertNotifier::getVersion() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _version;
+    }
+
+    void CappedInsertNotifier::waitForInsert(uint64_t referenceVersion,
+                                             Milliseconds timeout) const {
+        const boost::system_time deadline = boost::get_system_time() + timeout;
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (_version == referenceVersion) {
+            if (!_notifier.timed_wait(lk, deadline))
+                return;
+        }
+    }
+
+    void CappedInsertNotifier::notifyAll() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        ++_version;
+        _notifier.notify_all();
+    }
+
     // ----
 
     Collection::Collection( OperationContext* txn,
@@ -98,6 +166,8 @@ namespace mongo {
           _dbce( dbce ),
           _infoCache( this ),
           _indexCatalog( this ),
+          _cappedNotifier( recordStore->isCapped() ? boost::make_shared<CappedInsertNotifier>()
+                                                   : boost::shared_ptr<CappedInsertNotifier>() ),
           _cursorManager( fullNS ) {
         _magic = 1357924;
         _indexCatalog.init(txn);
@@ -185,6 +255,8 @@ namespace mongo {
         if ( !loc.isOK() )
             return loc;
 
+        _notifyCappedWaitersOnCommit(txn);
+
         // we cannot call into the OpObserver here because the document being written is not present
         // fortunately, this is currently only used for adding entries to the oplog.
 
@@ -217,6 +289,55 @@ namespace mongo {
         return res;
     }
 
+    Status Collection::insertDocuments(OperationContext* txn,
+                                       const std::vector<BSONObj>& docs,
+                                       bool enforceQuota,
+                                       bool fromMigrate) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+
+        const SnapshotId sid = txn->recoveryUnit()->getSnapshotId();
+
+        if ( _indexCatalog.findIdIndex( txn ) ) {
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                if ( docs[i]["_id"].eoo() ) {
+                    return Status( ErrorCodes::InternalError,
+                                   str::stream() << "Collection::insertDocuments got "
+                                   "document without _id for ns:" << _ns.ns() );
+                }
+            }
+        }
+
+        std::vector<RecordId> locs;
+        Status status = _recordStore->insertRecords( txn,
+                                                     docs,
+                                                     &locs,
+                                                     _enforceQuota( enforceQuota ) );
+        if ( !status.isOK() )
+            return status;
+
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            invariant( RecordId::min() < locs[i] );
+            invariant( locs[i] < RecordId::max() );
+        }
+
+        _infoCache.notifyOfWriteOp();
+
+        status = _indexCatalog.indexRecords( txn, docs, locs );
+        if ( !status.isOK() )
+            return status;
+
+        _notifyCappedWaitersOnCommit(txn);
+
+        invariant( sid == txn->recoveryUnit()->getSnapshotId() );
+
+        OpObserver* opObserver = getGlobalServiceContext()->getOpObserver();
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            opObserver->onInsert( txn, ns(), docs[i], fromMigrate );
+        }
+
+        return Status::OK();
+    }
+
     StatusWith<RecordId> Collection::insertDocument(OperationContext* txn,
                                                     const BSONObj& doc,
                                                     MultiIndexBlock* indexBlock,
@@ -235,6 +356,8 @@ namespace mongo {
         if ( !status.isOK() )
             return StatusWith<RecordId>( status );
 
+        _notifyCappedWaitersOnCommit(txn);
+
         getGlobalServiceContext()->getOpObserver()->onInsert(txn, ns(), doc);
 
         return loc;
@@ -271,6 +394,8 @@ namespace mongo {
         if (!s.isOK())
             return StatusWith<RecordId>(s);
 
+        _notifyCappedWaitersOnCommit(txn);
+
         return loc;
     }
 
@@ -314,6 +439,8 @@ namespace mongo {
 
         _indexCatalog.unindexRecord(txn, doc.value(), loc, noWarn);
 
+        _invalidateIdLookup(txn, doc.value());
+
         _recordStore->deleteRecord(txn, loc);
 
         _infoCache.notifyOfWriteOp();
@@ -323,17 +450,72 @@ namespace mongo {
         }
     }
 
+    void Collection::_invalidateIdLookup(OperationContext* txn, const BSONObj& doc) {
+        if (!IdLookupCache::isEnabled() || isCapped()) {
+            return;
+        }
+
+        BSONElement id = doc["_id"];
+        if (id.eoo()) {
+            return;
+        }
+
+        const boost::shared_ptr<IdLookupCache>& cache = _infoCache.getIdLookupCache();
+        BSONObj key = id.wrap();
+        cache->invalidate(key);
+        txn->recoveryUnit()->registerChange(new InvalidateIdLookupChange(cache, key));
+    }
+
+    void Collection::_notifyCappedWaitersOnCommit(OperationContext* txn) {
+        if (!_cappedNotifier) {
+            return;
+        }
+
+        txn->recoveryUnit()->registerChange(new NotifyCappedWaitersChange(_cappedNotifier));
+    }
+
     Counter64 moveCounter;
     ServerStatusMetricField<Counter64> moveCounterDisplay( "record.moves", &moveCounter );
 
-    StatusWith<RecordId> Collection::updateDocument( OperationContext* txn,
-                                                     const RecordId& oldLocation,
-                                                     const Snapshotted<BSONObj>& oldDoc,
-                                                     const BSONObj& newDoc,
-                                                     bool enforceQuota,
-                                                     bool indexesAffected,
-                                                     OpDebug* debug,
-                                                     oplogUpdateEntryArgs& args) {
+    Counter64 indexUpdatesSkippedCounter;
+    ServerStatusMetricField<Counter64> indexUpdatesSkippedDisplay( "record.indexUpdatesSkipped",
+                                                                   &indexUpdatesSkippedCounter );
+
+namespace {
+
+    /**
+     * Returns true unless none of 'modifiedIndexedPaths' can change the keys of 'descriptor'.
+     */
+    bool indexAffectedBy( OperationContext* txn,
+                          const CollectionInfoCache* infoCache,
+                          const IndexDescriptor* descriptor,
+                          const std::vector<std::string>* modifiedIndexedPaths ) {
+        if ( !modifiedIndexedPaths )
+            return true;
+
+        const UpdateIndexData* indexedPaths = infoCache->indexKeysFor( txn, descriptor );
+        if ( !indexedPaths )
+            return true;
+
+        for ( size_t i = 0; i < modifiedIndexedPaths->size(); i++ ) {
+            if ( indexedPaths->mightBeIndexed( (*modifiedIndexedPaths)[i] ) )
+                return true;
+        }
+        return false;
+    }
+
+}  // namespace
+
+    StatusWith<RecordId> Collection::updateDocument(
+            OperationContext* txn,
+            const RecordId& oldLocation,
+            const Snapshotted<BSONObj>& oldDoc,
+            const BSONObj& newDoc,
+            bool enforceQuota,
+            bool indexesAffected,
+            const std::vector<std::string>* modifiedIndexedPaths,
+            OpDebug* debug,
+            oplogUpdateEntryArgs& args) {
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
         invariant(oldDoc.snapshotId() == txn->recoveryUnit()->getSnapshotId());
 
@@ -353,6 +535,12 @@ namespace mongo {
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, true );
             while ( ii.more() ) {
                 IndexDescriptor* descriptor = ii.next();
+                if ( !indexAffectedBy( txn, &_infoCache, descriptor, modifiedIndexedPaths ) ) {
+                    // None of this index's fields changed, so neither do its keys.
+                    indexUpdatesSkippedCounter.increment();
+                    continue;
+                }
+
                 IndexCatalogEntry* entry = ii.catalogEntry(descriptor);
                 IndexAccessMethod* iam = ii.accessMethod( descriptor );
 
@@ -376,6 +564,8 @@ namespace mongo {
             }
         }
 
+        _invalidateIdLookup(txn, oldDoc.value());
+
         // This can call back into Collection::recordStoreGoingToMove.  If that happens, the old
         // object is removed from all indexes.
         StatusWith<RecordId> newLocation = _recordStore->updateRecord( txn,
@@ -423,11 +613,15 @@ namespace mongo {
             IndexCatalog::IndexIterator ii = _indexCatalog.getIndexIterator( txn, true );
             while ( ii.more() ) {
                 IndexDescriptor* descriptor = ii.next();
+                std::map<IndexDescriptor*, UpdateTicket*>::const_iterator ticket =
+                    updateTickets.map().find(descriptor);
+                if ( ticket == updateTickets.map().end() )
+                    continue;
+
                 IndexAccessMethod* iam = ii.accessMethod(descriptor);
 
                 int64_t updatedKeys;
-                Status ret = iam->update(
-                    txn, *updateTickets.mutableMap()[descriptor], &updatedKeys);
+                Status ret = iam->update(txn, *ticket->second, &updatedKeys);
                 if ( !ret.isOK() )
                     return StatusWith<RecordId>( ret );
                 if ( debug )
@@ -473,6 +667,8 @@ namespace mongo {
         // Broadcast the mutation so that query results stay correct.
         _cursorManager.invalidateDocument(txn, loc, INVALIDATION_MUTATION);
 
+        _invalidateIdLookup(txn, oldRec.value().toBson());
+
         Status status = 
             _recordStore->updateWithDamages(txn, loc, oldRec.value(), damageSource, damages);
 
@@ -503,6 +699,11 @@ namespace mongo {
         return _recordStore->isCapped();
     }
 
+    boost::shared_ptr<CappedInsertNotifier> Collection::getCappedInsertNotifier() const {
+        invariant(isCapped());
+        return _cappedNotifier;
+    }
+
     uint64_t Collection::numRecords( OperationContext* txn ) const {
         return _recordStore->numRecords( txn );
     }
@@ -610,8 +811,7 @@ namespace mongo {
                                  ValidateResults* results, BSONObjBuilder* output ){
         dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
 
-        MyValidateAdaptor adaptor;
-        Status status = _recordStore->validate( txn, full, scanData, &adaptor, results, output );
+        Status status = validateRecords( txn, full, scanData, results, output );
         if ( !status.isOK() )
             return status;
 
@@ -626,27 +826,15 @@ namespace mongo {
                 IndexCatalog::IndexIterator i = _indexCatalog.getIndexIterator(txn, false);
                 while( i.more() ) {
                     const IndexDescriptor* descriptor = i.next();
-                    log(LogComponent::kIndex) << "validating index " << descriptor->indexNamespace() << endl;
-                    IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
-                    invariant( iam );
-
                     boost::scoped_ptr<BSONObjBuilder> bob(
                         indexDetails.get() ? new BSONObjBuilder(
                             indexDetails->subobjStart(descriptor->indexNamespace())) :
                         NULL);
 
                     int64_t keys;
-                    iam->validate(txn, full, &keys, bob.get());
+                    validateIndex(txn, descriptor, full, results, &keys, bob.get());
                     indexes.appendNumber(descriptor->indexNamespace(),
                                          static_cast<long long>(keys));
-
-                    if (bob) {
-                        BSONObj obj = bob->done();
-                        BSONElement valid = obj["valid"];
-                        if (valid.ok() && !valid.trueValue()) {
-                            results->valid = false;
-                        }
-                    }
                     idxn++;
                 }
 
@@ -668,6 +856,38 @@ namespace mongo {
         return Status::OK();
     }
 
+    Status Collection::validateRecords( OperationContext* txn,
+                                        bool full, bool scanData,
+                                        ValidateResults* results, BSONObjBuilder* output ) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
+
+        MyValidateAdaptor adaptor;
+        return _recordStore->validate( txn, full, scanData, &adaptor, results, output );
+    }
+
+    void Collection::validateIndex( OperationContext* txn,
+                                    const IndexDescriptor* descriptor,
+                                    bool full,
+                                    ValidateResults* results,
+                                    int64_t* numKeys,
+                                    BSONObjBuilder* details ) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IS));
+
+        log(LogComponent::kIndex) << "validating index " << descriptor->indexNamespace() << endl;
+        IndexAccessMethod* iam = _indexCatalog.getIndex( descriptor );
+        invariant( iam );
+
+        iam->validate(txn, full, numKeys, details);
+
+        if (details) {
+            BSONObj obj = details->done();
+            BSONElement valid = obj["valid"];
+            if (valid.ok() && !valid.trueValue()) {
+                results->valid = false;
+            }
+        }
+    }
+
     Status Collection::touch( OperationContext* txn,
                               bool touchData, bool touchIndexes,
                               BSONObjBuilder* output ) const {
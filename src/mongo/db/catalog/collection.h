@@ -30,8 +30,12 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <string>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
 #include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/db/catalog/collection_info_cache.h"
@@ -45,6 +49,7 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/snapshot.h"
 #include "mongo/platform/cstdint.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -70,6 +75,9 @@ namespace mongo {
             validateDocuments = true;
             paddingFactor = 1;
             paddingBytes = 0;
+            freeSpaceOnly = false;
+            online = false;
+            batchSize = 100;
         }
 
         // padding
@@ -89,15 +97,65 @@ namespace mongo {
         // other
         bool validateDocuments;
 
+        // Only merge adjacent free space instead of moving documents, which leaves the indexes
+        // alone.  Record stores which compact in place ignore it.
+        bool freeSpaceOnly;
+
+        // Only lock the collection in intent mode.  Record stores which don't compact in place
+        // have their records moved batchSize at a time by the compact command instead, which
+        // yields in between.
+        bool online;
+        int batchSize;
+
         std::string toString() const;
     };
 
     struct CompactStats {
         CompactStats() {
             corruptDocuments = 0;
+            freeRecordsMerged = 0;
+            recordsMoved = 0;
+            bytesMoved = 0;
         }
 
         long long corruptDocuments;
+
+        // Number of free space records merged into neighbouring ones by a freeSpaceOnly compact.
+        long long freeRecordsMerged;
+
+        // Records moved, and their size, by an online compact.
+        long long recordsMoved;
+        long long bytesMoved;
+    };
+
+    /**
+     * Lets tailable cursors on a capped collection wait for new documents instead of polling for
+     * them. Every committed insert into the collection bumps the version and wakes the waiters.
+     */
+    class CappedInsertNotifier {
+        MONGO_DISALLOW_COPYING(CappedInsertNotifier);
+    public:
+        CappedInsertNotifier();
+
+        /**
+         * Returns the version for use as an additional wake condition in waitForInsert().
+         */
+        uint64_t getVersion() const;
+
+        /**
+         * Waits until the version is no longer 'referenceVersion', or until 'timeout' has passed.
+         */
+        void waitForInsert(uint64_t referenceVersion, Milliseconds timeout) const;
+
+        /**
+         * Bumps the version and wakes up every waiter.
+         */
+        void notifyAll();
+
+    private:
+        mutable boost::mutex _mutex;
+        mutable boost::condition_variable _notifier;
+        uint64_t _version;
     };
 
     /**
@@ -178,6 +236,19 @@ namespace mongo {
                                             const DocWriter* doc,
                                             bool enforceQuota );
 
+        /**
+         * Inserts all of 'docs' within the caller's unit of work, as if by calling
+         * insertDocument() for each, but hands them to the record store and to each index as
+         * one batch.
+         *
+         * On failure nothing tells which document failed, and any documents inserted before the
+         * failure are not undone; the caller must abort its unit of work.
+         */
+        Status insertDocuments( OperationContext* txn,
+                                const std::vector<BSONObj>& docs,
+                                bool enforceQuota,
+                                bool fromMigrate = false );
+
         StatusWith<RecordId> insertDocument( OperationContext* txn,
                                             const BSONObj& doc,
                                             MultiIndexBlock* indexBlock,
@@ -199,6 +270,7 @@ namespace mongo {
          * updates the document @ oldLocation with newDoc
          * if the document fits in the old space, it is put there
          * if not, it is moved
+         * if 'modifiedIndexedPaths' isn't NULL, only the indexes over those paths get new keys
          * @return the post update location of the doc (may or may not be the same as oldLocation)
          */
         StatusWith<RecordId> updateDocument(OperationContext* txn,
@@ -207,6 +279,7 @@ namespace mongo {
                                             const BSONObj& newDoc,
                                             bool enforceQuota,
                                             bool indexesAffected,
+                                            const std::vector<std::string>* modifiedIndexedPaths,
                                             OpDebug* debug,
                                             oplogUpdateEntryArgs& args);
         /**
@@ -223,6 +296,17 @@ namespace mongo {
 
         StatusWith<CompactStats> compact(OperationContext* txn, const CompactOptions* options);
 
+        /**
+         * Moves the record at 'loc' into newly allocated space, and points the indexes at its new
+         * location, for an online compact.  Doesn't write to the oplog, as the document doesn't
+         * change.  Must be called within a WriteUnitOfWork, with the collection locked in at
+         * least MODE_IX.
+         */
+        Status relocateRecord(OperationContext* txn,
+                              const RecordId& loc,
+                              const CompactOptions* options,
+                              CompactStats* stats);
+
         /**
          * removes all documents as fast as possible
          * indexes before and after will be the same
@@ -241,6 +325,26 @@ namespace mongo {
                          bool full, bool scanData,
                          ValidateResults* results, BSONObjBuilder* output );
 
+        /**
+         * The parts of validate(), so that they can be run separately: validates the records
+         * only, appending their stats to 'output'.
+         */
+        Status validateRecords( OperationContext* txn,
+                                bool full, bool scanData,
+                                ValidateResults* results, BSONObjBuilder* output );
+
+        /**
+         * Validates the index 'descriptor', setting 'numKeys' to its number of keys.  If
+         * 'details' isn't NULL, appends the details of the (full) validation to it and calls
+         * done() on it.
+         */
+        void validateIndex( OperationContext* txn,
+                            const IndexDescriptor* descriptor,
+                            bool full,
+                            ValidateResults* results,
+                            int64_t* numKeys,
+                            BSONObjBuilder* details );
+
         /**
          * forces data into cache
          */
@@ -265,6 +369,12 @@ namespace mongo {
 
         bool isCapped() const;
 
+        /**
+         * Returns the notifier signalled by each insert into this capped collection. It stays
+         * valid for the holder after the collection goes away, but is then never signalled again.
+         */
+        boost::shared_ptr<CappedInsertNotifier> getCappedInsertNotifier() const;
+
         uint64_t numRecords( OperationContext* txn ) const;
 
         uint64_t dataSize( OperationContext* txn ) const;
@@ -305,6 +415,18 @@ namespace mongo {
 
         bool _enforceQuota( bool userEnforeQuota ) const;
 
+        /**
+         * Drops the document 'doc', which is about to be written, from the _id lookup cache, now
+         * and again when the write commits or rolls back.
+         */
+        void _invalidateIdLookup(OperationContext* txn, const BSONObj& doc);
+
+        /**
+         * Has the capped insert notifier signalled once the current write commits, if this
+         * collection is capped.
+         */
+        void _notifyCappedWaitersOnCommit(OperationContext* txn);
+
         int _magic;
 
         NamespaceString _ns;
@@ -314,6 +436,9 @@ namespace mongo {
         CollectionInfoCache _infoCache;
         IndexCatalog _indexCatalog;
 
+        // Only set for capped collections.
+        const boost::shared_ptr<CappedInsertNotifier> _cappedNotifier;
+
         // this is mutable because read only users of the Collection class
         // use it keep state.  This seems valid as const correctness of Collection
         // should be about the data.
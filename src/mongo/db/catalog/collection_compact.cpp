@@ -103,7 +103,9 @@ namespace mongo {
 
     StatusWith<CompactStats> Collection::compact( OperationContext* txn,
                                                   const CompactOptions* compactOptions ) {
-        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_X));
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(),
+                                                            compactOptions->online ? MODE_IX
+                                                                                   : MODE_X));
 
         if ( !_recordStore->compactSupported() )
             return StatusWith<CompactStats>( ErrorCodes::CommandNotSupported,
@@ -111,7 +113,12 @@ namespace mongo {
                                              "cannot compact collection with record store: " <<
                                              _recordStore->name() );
 
-        if (_recordStore->compactsInPlace()) {
+        if ( compactOptions->online && !_recordStore->compactsInPlace() )
+            return StatusWith<CompactStats>( ErrorCodes::BadValue,
+                                             "online compact of a record store which doesn't "
+                                             "compact in place moves records one by one" );
+
+        if (_recordStore->compactsInPlace() || compactOptions->freeSpaceOnly) {
             // Since we are compacting in-place, we don't need to touch the indexes.
             // TODO SERVER-16856 compact indexes
             CompactStats stats;
@@ -195,4 +202,49 @@ namespace mongo {
         return StatusWith<CompactStats>( stats );
     }
 
+    Status Collection::relocateRecord( OperationContext* txn,
+                                       const RecordId& loc,
+                                       const CompactOptions* compactOptions,
+                                       CompactStats* stats ) {
+        dassert(txn->lockState()->isCollectionLockedForMode(ns().toString(), MODE_IX));
+        invariant(txn->lockState()->inAWriteUnitOfWork());
+
+        Snapshotted<BSONObj> snapshotted;
+        if ( !findDoc( txn, loc, &snapshotted ) ) {
+            // Deleted since it was found.
+            return Status::OK();
+        }
+
+        // The record is about to be freed.
+        const BSONObj doc = snapshotted.value().getOwned();
+        if ( compactOptions->validateDocuments && !doc.valid() ) {
+            // Left where it is, as there is no telling where the document really ends.
+            stats->corruptDocuments++;
+            return Status::OK();
+        }
+
+        // The copy is written first, so that it doesn't take the space of the original.
+        StatusWith<RecordId> newLoc = _recordStore->insertRecord( txn,
+                                                                  doc.objdata(),
+                                                                  doc.objsize(),
+                                                                  false );
+        if ( !newLoc.isOK() )
+            return newLoc.getStatus();
+
+        _cursorManager.invalidateDocument( txn, loc, INVALIDATION_DELETION );
+        _indexCatalog.unindexRecord( txn, doc, loc, true );
+        _invalidateIdLookup( txn, doc );
+        _recordStore->deleteRecord( txn, loc );
+
+        Status status = _indexCatalog.indexRecord( txn, doc, newLoc.getValue() );
+        if ( !status.isOK() )
+            return status;
+
+        _infoCache.notifyOfWriteOp();
+
+        stats->recordsMoved++;
+        stats->bytesMoved += doc.objsize();
+        return Status::OK();
+    }
+
 }  // namespace mongo
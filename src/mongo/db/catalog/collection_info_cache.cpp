@@ -34,27 +34,51 @@
 
 #include "mongo/db/catalog/collection_info_cache.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/planner_ixselect.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
 
+    namespace {
+
+        // Statistics are sampled again once the number of writes since they were sampled
+        // reaches this fraction of the collection's size.
+        const double kIndexStatisticsRefreshFraction = 0.1;
+
+        // But not more often than every this many writes.
+        const unsigned long long kIndexStatisticsMinRefreshWrites = 1000;
+
+    }  // namespace
+
     CollectionInfoCache::CollectionInfoCache( Collection* collection )
         : _collection( collection ),
           _keysComputed( false ),
           _planCache(new PlanCache(collection->ns().ns())),
-          _querySettings(new QuerySettings()) { }
+          _querySettings(new QuerySettings()),
+          _idLookupCache(new IdLookupCache()),
+          _queryShapeStats(new QueryShapeStats()) { }
 
     void CollectionInfoCache::reset( OperationContext* txn ) {
         LOG(1) << _collection->ns().ns() << ": clearing plan cache - collection info cache reset";
         clearQueryCache();
+        _idLookupCache->clear();
+        {
+            boost::lock_guard<boost::mutex> lk(_indexStatsMutex);
+            _indexStats.clear();
+        }
         _keysComputed = false;
         computeIndexKeys( txn );
         // query settings is not affected by info cache reset.
@@ -68,64 +92,89 @@ namespace mongo {
         return _indexedPaths;
     }
 
-    void CollectionInfoCache::computeIndexKeys( OperationContext* txn ) {
-        // This function modified objects attached to the Collection so we need a write lock
-        invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
-        _indexedPaths.clear();
+namespace {
 
-        IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
-        while (i.more()) {
-            IndexDescriptor* descriptor = i.next();
+    /**
+     * Adds the paths whose update could change the keys of 'descriptor' to 'indexedPaths'.
+     */
+    void addIndexedPaths(const IndexDescriptor* descriptor,
+                         const IndexCatalogEntry* entry,
+                         UpdateIndexData* indexedPaths) {
+        if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
+            BSONObj key = descriptor->keyPattern();
+            BSONObjIterator j(key);
+            while (j.more()) {
+                BSONElement e = j.next();
+                indexedPaths->addPath(e.fieldName());
+            }
+        }
+        else {
+            fts::FTSSpec ftsSpec(descriptor->infoObj());
 
-            if (descriptor->getAccessMethodName() != IndexNames::TEXT) {
-                BSONObj key = descriptor->keyPattern();
-                BSONObjIterator j(key);
-                while (j.more()) {
-                    BSONElement e = j.next();
-                    _indexedPaths.addPath(e.fieldName());
-                }
+            if (ftsSpec.wildcard()) {
+                indexedPaths->allPathsIndexed();
             }
             else {
-                fts::FTSSpec ftsSpec(descriptor->infoObj());
-
-                if (ftsSpec.wildcard()) {
-                    _indexedPaths.allPathsIndexed();
+                for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraBefore(i));
                 }
-                else {
-                    for (size_t i = 0; i < ftsSpec.numExtraBefore(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraBefore(i));
-                    }
-                    for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
-                         it != ftsSpec.weights().end();
-                         ++it) {
-                        _indexedPaths.addPath(it->first);
-                    }
-                    for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
-                        _indexedPaths.addPath(ftsSpec.extraAfter(i));
-                    }
-                    // Any update to a path containing "language" as a component could change the
-                    // language of a subdocument.  Add the override field as a path component.
-                    _indexedPaths.addPathComponent(ftsSpec.languageOverrideField());
+                for (fts::Weights::const_iterator it = ftsSpec.weights().begin();
+                     it != ftsSpec.weights().end();
+                     ++it) {
+                    indexedPaths->addPath(it->first);
+                }
+                for (size_t i = 0; i < ftsSpec.numExtraAfter(); ++i) {
+                    indexedPaths->addPath(ftsSpec.extraAfter(i));
                 }
+                // Any update to a path containing "language" as a component could change the
+                // language of a subdocument.  Add the override field as a path component.
+                indexedPaths->addPathComponent(ftsSpec.languageOverrideField());
             }
+        }
 
-            // handle filtered indexes
-            const IndexCatalogEntry* entry = i.catalogEntry(descriptor);
-            const MatchExpression* filter = entry->getFilterExpression();
-            if (filter) {
-                unordered_set<std::string> paths;
-                QueryPlannerIXSelect::getFields(filter, "", &paths);
-                for (auto it = paths.begin(); it != paths.end(); ++it) {
-                    _indexedPaths.addPath(*it);
-                }
+        // handle filtered indexes
+        const MatchExpression* filter = entry->getFilterExpression();
+        if (filter) {
+            unordered_set<std::string> paths;
+            QueryPlannerIXSelect::getFields(filter, "", &paths);
+            for (auto it = paths.begin(); it != paths.end(); ++it) {
+                indexedPaths->addPath(*it);
             }
         }
+    }
+
+}  // namespace
+
+    const UpdateIndexData* CollectionInfoCache::indexKeysFor(
+            OperationContext* txn, const IndexDescriptor* desc) const {
+        dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+        invariant(_keysComputed);
+        std::map<std::string, UpdateIndexData>::const_iterator it =
+            _indexedPathsByIndex.find(desc->indexName());
+        return it == _indexedPathsByIndex.end() ? NULL : &it->second;
+    }
+
+    void CollectionInfoCache::computeIndexKeys( OperationContext* txn ) {
+        // This function modified objects attached to the Collection so we need a write lock
+        invariant(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_X));
+        _indexedPaths.clear();
+        _indexedPathsByIndex.clear();
+
+        IndexCatalog::IndexIterator i = _collection->getIndexCatalog()->getIndexIterator(txn, true);
+        while (i.more()) {
+            IndexDescriptor* descriptor = i.next();
+            const IndexCatalogEntry* entry = i.catalogEntry(descriptor);
+
+            addIndexedPaths(descriptor, entry, &_indexedPaths);
+            addIndexedPaths(descriptor, entry, &_indexedPathsByIndex[descriptor->indexName()]);
+        }
 
         _keysComputed = true;
 
     }
 
     void CollectionInfoCache::notifyOfWriteOp() {
+        _writeOps.fetchAndAdd(1);
         if (NULL != _planCache.get()) {
             _planCache->notifyOfWriteOp();
         }
@@ -145,4 +194,63 @@ namespace mongo {
         return _querySettings.get();
     }
 
+    boost::shared_ptr<const IndexStatistics> CollectionInfoCache::getIndexStatistics(
+            OperationContext* txn, const IndexDescriptor* desc) const {
+        dassert(txn->lockState()->isCollectionLockedForMode(_collection->ns().ns(), MODE_IS));
+
+        const unsigned long long writeOps = _writeOps.load();
+        {
+            boost::lock_guard<boost::mutex> lk(_indexStatsMutex);
+            std::map<std::string, IndexStatisticsEntry>::const_iterator it =
+                _indexStats.find(desc->indexName());
+            if (_indexStats.end() != it) {
+                const IndexStatisticsEntry& entry = it->second;
+                const unsigned long long refreshWrites = std::max(
+                    kIndexStatisticsMinRefreshWrites,
+                    static_cast<unsigned long long>(kIndexStatisticsRefreshFraction
+                                                    * entry.numRecords));
+                if (writeOps - entry.writeOps < refreshWrites) {
+                    return entry.stats;
+                }
+            }
+        }
+
+        // Sample without holding the mutex. Concurrent samplers of the same index each store
+        // their result, and the last one stays.
+        IndexStatisticsEntry entry;
+        entry.writeOps = writeOps;
+        entry.numRecords = _collection->numRecords(txn);
+
+        // Sparse, partial and multikey indexes don't have one entry per document, and other
+        // access methods' keys aren't ordered like the values they index.
+        if (IndexNames::BTREE == desc->getAccessMethodName()
+            && !desc->isSparse()
+            && !desc->isPartial()
+            && !desc->isMultikey(txn)) {
+            const IndexAccessMethod* iam = _collection->getIndexCatalog()->getIndex(desc);
+            std::unique_ptr<SortedDataInterface::RandomCursor> cursor =
+                iam->newRandomCursor(txn);
+            if (cursor) {
+                std::vector<BSONObj> samples;
+                for (int i = 0; i < internalQueryIndexStatisticsSampleSize; ++i) {
+                    boost::optional<IndexKeyEntry> next = cursor->next();
+                    if (!next) {
+                        break;
+                    }
+                    samples.push_back(next->key.getOwned());
+                }
+                entry.stats.reset(new IndexStatistics(desc->keyPattern(), samples,
+                                                      entry.numRecords));
+
+                LOG(2) << _collection->ns().ns() << ": sampled " << samples.size()
+                       << " entries of index " << desc->indexName() << ", estimated "
+                       << entry.stats->numDistinctKeys() << " distinct keys";
+            }
+        }
+
+        boost::lock_guard<boost::mutex> lk(_indexStatsMutex);
+        _indexStats[desc->indexName()] = entry;
+        return entry.stats;
+    }
+
 }
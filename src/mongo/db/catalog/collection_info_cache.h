@@ -31,14 +31,22 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
 
+#include "mongo/db/catalog/id_lookup_cache.h"
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
 
 namespace mongo {
 
     class Collection;
+    class IndexDescriptor;
 
     /**
      * this is for storing things that you want to cache about a single collection
@@ -68,6 +76,36 @@ namespace mongo {
          */
         QuerySettings* getQuerySettings() const;
 
+        /**
+         * Get the sampled statistics of the index 'desc', sampling it first if it has none yet
+         * or enough writes went by since it was last sampled. Returns an empty pointer if the
+         * index doesn't have exactly one entry per document, or its storage engine can't sample
+         * it.
+         *
+         * Requires at least a shared lock on the collection.
+         */
+        boost::shared_ptr<const IndexStatistics> getIndexStatistics(
+                OperationContext* txn, const IndexDescriptor* desc) const;
+
+        /**
+         * Get the cache of documents found by _id for this collection. Only use it if
+         * IdLookupCache::isEnabled(). The cache is thread safe, and writers to the collection
+         * must keep it up to date, so it can be used through a const collection.
+         *
+         * Writes hold on to the cache past the lifetime of the collection.
+         */
+        const boost::shared_ptr<IdLookupCache>& getIdLookupCache() const {
+            return _idLookupCache;
+        }
+
+        /**
+         * Get the execution statistics of the queries run against this collection, by query
+         * shape. Thread safe. Plan executors hold on to it past the lifetime of the collection.
+         */
+        const boost::shared_ptr<QueryShapeStats>& getQueryShapeStats() const {
+            return _queryShapeStats;
+        }
+
         // -------------------
 
         /* get set of index keys for this namespace.  handy to quickly check if a given
@@ -75,6 +113,13 @@ namespace mongo {
         */
         const UpdateIndexData& indexKeys( OperationContext* txn ) const;
 
+        /**
+         * Get the paths whose update could change the keys of the index 'desc' alone, or NULL
+         * if it isn't known.
+         */
+        const UpdateIndexData* indexKeysFor( OperationContext* txn,
+                                             const IndexDescriptor* desc ) const;
+
         // ---------------------
 
         /**
@@ -94,6 +139,8 @@ namespace mongo {
         // ---  index keys cache
         bool _keysComputed;
         UpdateIndexData _indexedPaths;
+        // The same, by index name.
+        std::map<std::string, UpdateIndexData> _indexedPathsByIndex;
 
         // A cache for query plans.
         boost::scoped_ptr<PlanCache> _planCache;
@@ -102,6 +149,30 @@ namespace mongo {
         // Includes index filters.
         boost::scoped_ptr<QuerySettings> _querySettings;
 
+        // Documents recently found by _id.
+        boost::shared_ptr<IdLookupCache> _idLookupCache;
+
+        // Not cleared by reset(), since the queries ran no matter what indexes there are now.
+        boost::shared_ptr<QueryShapeStats> _queryShapeStats;
+
+        struct IndexStatisticsEntry {
+            IndexStatisticsEntry() : writeOps(0), numRecords(0) { }
+
+            // Empty if the index can't be sampled.
+            boost::shared_ptr<const IndexStatistics> stats;
+
+            // The values of _writeOps and of the number of records when it was sampled.
+            unsigned long long writeOps;
+            long long numRecords;
+        };
+
+        // Sampled statistics, by index name.
+        mutable boost::mutex _indexStatsMutex;
+        mutable std::map<std::string, IndexStatisticsEntry> _indexStats;
+
+        // Counts the writes to the collection, to tell when statistics are stale.
+        AtomicUInt64 _writeOps;
+
         /**
          * Must be called under exclusive DB lock.
          */
@@ -316,11 +316,20 @@ namespace mongo {
     // --------------------------
 
 
+    // static
+    const unsigned CursorManager::kNumPartitions;
+
+    CursorManager::Partition::Partition() : mutex( "CursorManagerPartition" ) { }
+
+    CursorManager::Partition::~Partition() { }
+
     CursorManager::CursorManager( StringData ns )
         : _nss( ns ),
           _mutex( "CursorManager" ) {
         _collectionCacheRuntimeId = globalCursorIdCache->created( _nss.ns() );
-        _random.reset( new PseudoRandom( globalCursorIdCache->nextSeed() ) );
+        for ( unsigned i = 0; i < kNumPartitions; i++ ) {
+            _partitions[i].random.reset( new PseudoRandom( globalCursorIdCache->nextSeed() ) );
+        }
     }
 
     CursorManager::~CursorManager() {
@@ -342,58 +351,67 @@ namespace mongo {
         }
         _nonCachedExecutors.clear();
 
-        if ( collectionGoingAway ) {
-            // we're going to wipe out the world
-            for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-                ClientCursor* cc = i->second;
+        for ( unsigned p = 0; p < kNumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock partitionLock( partition.mutex );
+            CursorMap& cursors = partition.cursors;
 
-                cc->kill();
+            if ( collectionGoingAway ) {
+                // we're going to wipe out the world
+                for ( CursorMap::const_iterator i = cursors.begin(); i != cursors.end(); ++i ) {
+                    ClientCursor* cc = i->second;
 
-                invariant( cc->getExecutor() == NULL || cc->getExecutor()->collection() == NULL );
+                    cc->kill();
 
-                // If the CC is pinned, somebody is actively using it and we do not delete it.
-                // Instead we notify the holder that we killed it.  The holder will then delete the
-                // CC.
-                //
-                // If the CC is not pinned, there is nobody actively holding it.  We can safely
-                // delete it.
-                if (!cc->isPinned()) {
-                    delete cc;
+                    invariant( cc->getExecutor() == NULL ||
+                               cc->getExecutor()->collection() == NULL );
+
+                    // If the CC is pinned, somebody is actively using it and we do not delete
+                    // it.  Instead we notify the holder that we killed it.  The holder will then
+                    // delete the CC.
+                    //
+                    // If the CC is not pinned, there is nobody actively holding it.  We can
+                    // safely delete it.
+                    if (!cc->isPinned()) {
+                        delete cc;
+                    }
                 }
+                cursors.clear();
             }
-        }
-        else {
-            CursorMap newMap;
+            else {
+                CursorMap newMap;
+
+                // collection will still be around, just all PlanExecutors are invalid
+                for ( CursorMap::const_iterator i = cursors.begin(); i != cursors.end(); ++i ) {
+                    ClientCursor* cc = i->second;
+
+                    // Note that a valid ClientCursor state is "no cursor no executor."  This is
+                    // because the set of active cursor IDs in ClientCursor is used as
+                    // representation of query state.  See sharding_block.h.  TODO(greg,hk): Move
+                    // this out.
+                    if (NULL == cc->getExecutor() ) {
+                        newMap.insert( *i );
+                        continue;
+                    }
+
+                    if (cc->isPinned() || cc->isAggCursor()) {
+                        // Pinned cursors need to stay alive, so we leave them around.
+                        // Aggregation cursors also can stay alive (since they don't have their
+                        // lifetime bound to the underlying collection).  However, if they have an
+                        // associated executor, we need to kill it, because it's now invalid.
+                        if ( cc->getExecutor() )
+                            cc->getExecutor()->kill();
+                        newMap.insert( *i );
+                    }
+                    else {
+                        cc->kill();
+                        delete cc;
+                    }
 
-            // collection will still be around, just all PlanExecutors are invalid
-            for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-                ClientCursor* cc = i->second;
-
-                // Note that a valid ClientCursor state is "no cursor no executor."  This is because
-                // the set of active cursor IDs in ClientCursor is used as representation of query
-                // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-                if (NULL == cc->getExecutor() ) {
-                    newMap.insert( *i );
-                    continue;
-                }
-
-                if (cc->isPinned() || cc->isAggCursor()) {
-                    // Pinned cursors need to stay alive, so we leave them around.  Aggregation
-                    // cursors also can stay alive (since they don't have their lifetime bound to
-                    // the underlying collection).  However, if they have an associated executor, we
-                    // need to kill it, because it's now invalid.
-                    if ( cc->getExecutor() )
-                        cc->getExecutor()->kill();
-                    newMap.insert( *i );
-                }
-                else {
-                    cc->kill();
-                    delete cc;
                 }
 
+                cursors.swap( newMap );
             }
-
-            _cursors = newMap;
         }
     }
 
@@ -416,34 +434,53 @@ namespace mongo {
             exec->invalidate(txn, dl, type);
         }
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            PlanExecutor* exec = i->second->getExecutor();
-            if ( exec ) {
-                exec->invalidate(txn, dl, type);
+        for ( unsigned p = 0; p < kNumPartitions; p++ ) {
+            const Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock partitionLock( partition.mutex );
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                PlanExecutor* exec = i->second->getExecutor();
+                if ( exec ) {
+                    exec->invalidate(txn, dl, type);
+                }
             }
         }
     }
 
     std::size_t CursorManager::timeoutCursors( int millisSinceLastCall ) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        std::size_t numTimedOut = 0;
 
+        // Only one partition is locked at a time, so that cursors in the other partitions can
+        // still be used while this one is scanned.
         vector<ClientCursor*> toDelete;
+        for ( unsigned p = 0; p < kNumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
+
+            toDelete.clear();
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                ClientCursor* cc = i->second;
+                if ( cc->shouldTimeout( millisSinceLastCall ) )
+                    toDelete.push_back( cc );
+                else if ( !cc->isPinned() )
+                    cc->releaseIdleSnapshot();
+            }
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            ClientCursor* cc = i->second;
-            if ( cc->shouldTimeout( millisSinceLastCall ) )
-                toDelete.push_back( cc );
-        }
+            for ( vector<ClientCursor*>::const_iterator i = toDelete.begin();
+                    i != toDelete.end(); ++i ) {
+                ClientCursor* cc = *i;
+                _deregisterCursor_inlock( partition, cc );
+                cc->kill();
+                delete cc;
+            }
 
-        for ( vector<ClientCursor*>::const_iterator i = toDelete.begin();
-                i != toDelete.end(); ++i ) {
-            ClientCursor* cc = *i;
-            _deregisterCursor_inlock( cc );
-            cc->kill();
-            delete cc;
+            numTimedOut += toDelete.size();
         }
 
-        return toDelete.size();
+        return numTimedOut;
     }
 
     void CursorManager::registerExecutor( PlanExecutor* exec ) {
@@ -457,10 +494,15 @@ namespace mongo {
         _nonCachedExecutors.erase(exec);
     }
 
+    CursorManager::Partition& CursorManager::_partitionFor( CursorId id ) {
+        return _partitions[static_cast<unsigned>( id ) & ( kNumPartitions - 1 )];
+    }
+
     ClientCursor* CursorManager::find( CursorId id, bool pin ) {
-        SimpleMutex::scoped_lock lk( _mutex );
-        CursorMap::const_iterator it = _cursors.find( id );
-        if ( it == _cursors.end() )
+        Partition& partition = _partitionFor( id );
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        CursorMap::const_iterator it = partition.cursors.find( id );
+        if ( it == partition.cursors.end() )
             return NULL;
 
         ClientCursor* cursor = it->second;
@@ -475,7 +517,7 @@ namespace mongo {
     }
 
     void CursorManager::unpin( ClientCursor* cursor ) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        SimpleMutex::scoped_lock lk( _partitionFor( cursor->cursorid() ).mutex );
 
         invariant( cursor->isPinned() );
         cursor->unsetPinned();
@@ -486,24 +528,37 @@ namespace mongo {
     }
 
     void CursorManager::getCursorIds( std::set<CursorId>* openCursors ) const {
-        SimpleMutex::scoped_lock lk( _mutex );
+        for ( unsigned p = 0; p < kNumPartitions; p++ ) {
+            const Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
 
-        for ( CursorMap::const_iterator i = _cursors.begin(); i != _cursors.end(); ++i ) {
-            ClientCursor* cc = i->second;
-            openCursors->insert( cc->cursorid() );
+            for ( CursorMap::const_iterator i = partition.cursors.begin();
+                  i != partition.cursors.end();
+                  ++i ) {
+                ClientCursor* cc = i->second;
+                openCursors->insert( cc->cursorid() );
+            }
         }
     }
 
     size_t CursorManager::numCursors() const {
-        SimpleMutex::scoped_lock lk( _mutex );
-        return _cursors.size();
+        size_t num = 0;
+        for ( unsigned p = 0; p < kNumPartitions; p++ ) {
+            const Partition& partition = _partitions[p];
+            SimpleMutex::scoped_lock lk( partition.mutex );
+            num += partition.cursors.size();
+        }
+        return num;
     }
 
-    CursorId CursorManager::_allocateCursorId_inlock() {
+    CursorId CursorManager::_allocateCursorId_inlock( unsigned partitionIndex ) {
+        Partition& partition = _partitions[partitionIndex];
         for ( int i = 0; i < 10000; i++ ) {
-            unsigned mypart = static_cast<unsigned>( _random->nextInt32() );
+            // The low bits of the id pick its partition.
+            unsigned mypart = static_cast<unsigned>( partition.random->nextInt32() );
+            mypart = ( mypart & ~( kNumPartitions - 1 ) ) | partitionIndex;
             CursorId id = cursorIdFromParts( _collectionCacheRuntimeId, mypart );
-            if ( _cursors.count( id ) == 0 )
+            if ( partition.cursors.count( id ) == 0 )
                 return id;
         }
         fassertFailed( 17360 );
@@ -511,22 +566,26 @@ namespace mongo {
 
     CursorId CursorManager::registerCursor( ClientCursor* cc ) {
         invariant( cc );
-        SimpleMutex::scoped_lock lk( _mutex );
-        CursorId id = _allocateCursorId_inlock();
-        _cursors[id] = cc;
+        const unsigned partitionIndex = _nextPartition.fetchAndAdd( 1 ) & ( kNumPartitions - 1 );
+        Partition& partition = _partitions[partitionIndex];
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        CursorId id = _allocateCursorId_inlock( partitionIndex );
+        partition.cursors[id] = cc;
         return id;
     }
 
     void CursorManager::deregisterCursor( ClientCursor* cc ) {
-        SimpleMutex::scoped_lock lk( _mutex );
-        _deregisterCursor_inlock( cc );
+        Partition& partition = _partitionFor( cc->cursorid() );
+        SimpleMutex::scoped_lock lk( partition.mutex );
+        _deregisterCursor_inlock( partition, cc );
     }
 
     bool CursorManager::eraseCursor(OperationContext* txn, CursorId id, bool checkAuth) {
-        SimpleMutex::scoped_lock lk( _mutex );
+        Partition& partition = _partitionFor( id );
+        SimpleMutex::scoped_lock lk( partition.mutex );
 
-        CursorMap::iterator it = _cursors.find( id );
-        if ( it == _cursors.end() ) {
+        CursorMap::iterator it = partition.cursors.find( id );
+        if ( it == partition.cursors.end() ) {
             if ( checkAuth )
                 audit::logKillCursorsAuthzCheck( txn->getClient(),
                                                  _nss,
@@ -548,15 +607,15 @@ namespace mongo {
                  !cursor->isPinned() );
 
         cursor->kill();
-        _deregisterCursor_inlock( cursor );
+        _deregisterCursor_inlock( partition, cursor );
         delete cursor;
         return true;
     }
 
-    void CursorManager::_deregisterCursor_inlock( ClientCursor* cc ) {
+    void CursorManager::_deregisterCursor_inlock( Partition& partition, ClientCursor* cc ) {
         invariant( cc );
         CursorId id = cc->cursorid();
-        _cursors.erase( id );
+        partition.cursors.erase( id );
     }
 
 }
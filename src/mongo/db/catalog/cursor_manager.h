@@ -36,6 +36,7 @@
 #include "mongo/db/invalidation_type.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -45,6 +46,14 @@ namespace mongo {
     class PseudoRandom;
     class PlanExecutor;
 
+    /**
+     * Keeps track of the cursors and executors open on one collection, or of the cursors which
+     * aren't bound to a collection for the global cursor manager.
+     *
+     * The cursors are split into partitions by cursor id, each with its own lock, so that
+     * creating, pinning and killing cursors on a busy collection don't all wait on each other,
+     * and so that timing cursors out only ever holds up one partition at a time.
+     */
     class CursorManager {
     public:
         CursorManager( StringData ns );
@@ -72,7 +81,7 @@ namespace mongo {
                                  InvalidationType type );
 
         /*
-         * timesout cursors that have been idle for too long
+         * timesout cursors that have been idle for too long, one partition at a time
          * note: must have a readlock on the collection
          * @return number timed out
          */
@@ -136,20 +145,43 @@ namespace mongo {
         static std::size_t timeoutCursorsGlobal(OperationContext* txn, int millisSinceLastCall);
 
     private:
-        CursorId _allocateCursorId_inlock();
-        void _deregisterCursor_inlock( ClientCursor* cc );
+        // Must be a power of 2.
+        static const unsigned kNumPartitions = 16;
+
+        typedef std::map<CursorId,ClientCursor*> CursorMap;
+
+        struct Partition {
+            Partition();
+            ~Partition();
+
+            // Protects all of the below.
+            mutable SimpleMutex mutex;
+
+            // Draws the ids of the cursors registered in this partition.
+            boost::scoped_ptr<PseudoRandom> random;
+
+            CursorMap cursors;
+        };
+
+        Partition& _partitionFor( CursorId id );
+
+        CursorId _allocateCursorId_inlock( unsigned partitionIndex );
+        void _deregisterCursor_inlock( Partition& partition, ClientCursor* cc );
 
         NamespaceString _nss;
         unsigned _collectionCacheRuntimeId;
-        boost::scoped_ptr<PseudoRandom> _random;
 
+        // Protects _nonCachedExecutors.  If taken along with a partition's mutex, this must be
+        // taken first.
         mutable SimpleMutex _mutex;
 
         typedef unordered_set<PlanExecutor*> ExecSet;
         ExecSet _nonCachedExecutors;
 
-        typedef std::map<CursorId,ClientCursor*> CursorMap;
-        CursorMap _cursors;
+        Partition _partitions[kNumPartitions];
+
+        // Spreads newly registered cursors across the partitions.
+        AtomicUInt32 _nextPartition;
     };
 
 }
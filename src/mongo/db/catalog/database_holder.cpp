@@ -79,15 +79,27 @@ namespace {
     }
 
 
+    DatabaseHolder::DatabaseHolder()
+        : _m("dbholder"),
+          _dbs(new DBs()) { }
+
+    DatabaseHolder::~DatabaseHolder() {
+        delete _dbs.load();
+        for (size_t i = 0; i < _retired.size(); i++) {
+            delete _retired[i];
+        }
+    }
+
     Database* DatabaseHolder::get(OperationContext* txn,
                                   StringData ns) const {
 
         const StringData db = _todb(ns);
         invariant(txn->lockState()->isDbLockedForMode(db, MODE_IS));
 
-        SimpleMutex::scoped_lock lk(_m);
-        DBs::const_iterator it = _dbs.find(db);
-        if (it != _dbs.end()) {
+        // The map can't be freed while we read it, as that takes the global lock in X-mode.
+        const DBs* dbs = _dbs.load();
+        DBs::const_iterator it = dbs->find(db);
+        if (it != dbs->end()) {
             return it->second;
         }
 
@@ -143,7 +155,9 @@ namespace {
         db = new Database(txn, dbname, entry);
 
         SimpleMutex::scoped_lock lk(_m);
-        _dbs[dbname] = db;
+        DBs* dbs = new DBs(*_dbs.load());
+        (*dbs)[dbname] = db;
+        _publish(dbs);
 
         return db;
     }
@@ -157,14 +171,19 @@ namespace {
 
         SimpleMutex::scoped_lock lk(_m);
 
-        DBs::const_iterator it = _dbs.find(dbName);
-        if (it == _dbs.end()) {
+        DBs::const_iterator it = _dbs.load()->find(dbName);
+        if (it == _dbs.load()->end()) {
             return;
         }
 
-        it->second->close( txn );
-        delete it->second;
-        _dbs.erase(it);
+        Database* db = it->second;
+        db->close( txn );
+        delete db;
+
+        DBs* dbs = new DBs(*_dbs.load());
+        dbs->erase(dbName);
+        _publish(dbs);
+        _reclaim();
 
         getGlobalServiceContext()->getGlobalStorageEngine()->closeDatabase(txn, dbName.toString());
     }
@@ -175,7 +194,7 @@ namespace {
         SimpleMutex::scoped_lock lk(_m);
 
         set< string > dbs;
-        for ( DBs::const_iterator i = _dbs.begin(); i != _dbs.end(); ++i ) {
+        for ( DBs::const_iterator i = _dbs.load()->begin(); i != _dbs.load()->end(); ++i ) {
             dbs.insert( i->first );
         }
 
@@ -194,17 +213,21 @@ namespace {
                 continue;
             }
 
-            Database* db = _dbs[name];
+            DBs* remaining = new DBs(*_dbs.load());
+            Database* db = (*remaining)[name];
             db->close( txn );
             delete db;
 
-            _dbs.erase( name );
+            remaining->erase( name );
+            _publish( remaining );
 
             getGlobalServiceContext()->getGlobalStorageEngine()->closeDatabase( txn, name );
 
             bb.append( name );
         }
 
+        _reclaim();
+
         bb.done();
         if( nNotClosed ) {
             result.append("nNotClosed", nNotClosed);
@@ -212,4 +235,24 @@ namespace {
 
         return true;
     }
+
+    void DatabaseHolder::getAllShortNames( std::set<std::string>& all ) const {
+        SimpleMutex::scoped_lock lk(_m);
+        const DBs* dbs = _dbs.load();
+        for( DBs::const_iterator j=dbs->begin(); j!=dbs->end(); ++j ) {
+            all.insert( j->first );
+        }
+    }
+
+    void DatabaseHolder::_publish(DBs* dbs) {
+        _retired.push_back(_dbs.load());
+        _dbs.store(dbs);
+    }
+
+    void DatabaseHolder::_reclaim() {
+        for (size_t i = 0; i < _retired.size(); i++) {
+            delete _retired[i];
+        }
+        _retired.clear();
+    }
 }
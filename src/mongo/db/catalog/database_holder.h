@@ -29,9 +29,11 @@
 #pragma once
 
 #include <set>
+#include <vector>
 
 #include "mongo/base/string_data.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -44,7 +46,8 @@ namespace mongo {
      */
     class DatabaseHolder {
     public:
-        DatabaseHolder() : _m("dbholder") { }
+        DatabaseHolder();
+        ~DatabaseHolder();
 
         /**
          * Retrieves an already opened database or returns NULL. Must be called with the database
@@ -79,18 +82,32 @@ namespace mongo {
          * is not guaranteed that the returned set of names will be still valid unless a global
          * lock is held, which would prevent database from disappearing or being created.
          */
-        void getAllShortNames( std::set<std::string>& all ) const {
-            SimpleMutex::scoped_lock lk(_m);
-            for( DBs::const_iterator j=_dbs.begin(); j!=_dbs.end(); ++j ) {
-                all.insert( j->first );
-            }
-        }
+        void getAllShortNames( std::set<std::string>& all ) const;
 
     private:
         typedef StringMap<Database*> DBs;
 
+        /**
+         * Makes 'dbs' the current map. The map it replaces is kept until _reclaim(), as get() may
+         * still be reading it. Must be called with _m held.
+         */
+        void _publish(DBs* dbs);
+
+        /**
+         * Frees the maps replaced by _publish(). Must be called with _m held and the global lock
+         * in X-mode, which keeps every other thread out of get().
+         */
+        void _reclaim();
+
+        // Serializes the changes to _dbs.
         mutable SimpleMutex _m;
-        DBs _dbs;
+
+        // The opened databases. get() reads this without taking _m, so a map is never changed
+        // once published: each change publishes a modified copy instead.
+        AtomicWord<DBs*> _dbs;
+
+        // The maps replaced since the last _reclaim().
+        std::vector<DBs*> _retired;
     };
 
     DatabaseHolder& dbHolder();
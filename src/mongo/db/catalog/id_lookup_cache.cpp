@@ -0,0 +1,155 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/id_lookup_cache.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    // The most memory, in bytes, the documents cached for each collection may take up.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(idHackCacheSizeBytes, int, 0);
+
+namespace {
+
+    // Documents larger than this fraction of the cache aren't cached.
+    const int kMaxDocFraction = 16;
+
+    // What an entry costs besides its key and document.
+    const size_t kEntryOverheadBytes = sizeof(void*) * 8 + sizeof(RecordId);
+
+    Counter64 hitsCounter;
+    Counter64 missesCounter;
+    Counter64 invalidationsCounter;
+    Counter64 evictionsCounter;
+    Counter64 bytesCounter;
+
+    ServerStatusMetricField<Counter64> hitsDisplay("query.idHackCache.hits", &hitsCounter);
+    ServerStatusMetricField<Counter64> missesDisplay("query.idHackCache.misses", &missesCounter);
+    ServerStatusMetricField<Counter64> invalidationsDisplay("query.idHackCache.invalidations",
+                                                            &invalidationsCounter);
+    ServerStatusMetricField<Counter64> evictionsDisplay("query.idHackCache.evictions",
+                                                        &evictionsCounter);
+    ServerStatusMetricField<Counter64> bytesDisplay("query.idHackCache.bytes", &bytesCounter);
+
+    size_t entryBytes(const BSONObj& key, const BSONObj& doc) {
+        return key.objsize() + doc.objsize() + kEntryOverheadBytes;
+    }
+
+}  // namespace
+
+    // static
+    bool IdLookupCache::isEnabled() {
+        return idHackCacheSizeBytes > 0;
+    }
+
+    IdLookupCache::IdLookupCache() : _generation(0), _bytes(0) { }
+
+    unsigned long long IdLookupCache::getGeneration() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _generation;
+    }
+
+    bool IdLookupCache::find(const BSONObj& key, RecordId* locOut, BSONObj* docOut) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        EntryMap::iterator it = _byKey.find(key);
+        if (it == _byKey.end()) {
+            missesCounter.increment();
+            return false;
+        }
+
+        _entries.splice(_entries.begin(), _entries, it->second);
+        *locOut = it->second->loc;
+        *docOut = it->second->doc;
+        hitsCounter.increment();
+        return true;
+    }
+
+    void IdLookupCache::add(const BSONObj& key,
+                            unsigned long long generation,
+                            const RecordId& loc,
+                            const BSONObj& doc) {
+        const size_t maxBytes = idHackCacheSizeBytes;
+        if (doc.objsize() > static_cast<int>(maxBytes / kMaxDocFraction)) {
+            return;
+        }
+
+        Entry entry;
+        entry.key = key.getOwned();
+        entry.loc = loc;
+        entry.doc = doc.getOwned();
+        const size_t bytes = entryBytes(entry.key, entry.doc);
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (generation != _generation || _byKey.count(entry.key)) {
+            return;
+        }
+
+        while (!_entries.empty() && _bytes + bytes > maxBytes) {
+            _remove(_byKey.find(_entries.back().key));
+            evictionsCounter.increment();
+        }
+
+        _entries.push_front(entry);
+        _byKey.insert(std::make_pair(entry.key, _entries.begin()));
+        _bytes += bytes;
+        bytesCounter.increment(bytes);
+    }
+
+    void IdLookupCache::invalidate(const BSONObj& key) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        ++_generation;
+        EntryMap::iterator it = _byKey.find(key);
+        if (it != _byKey.end()) {
+            _remove(it);
+            invalidationsCounter.increment();
+        }
+    }
+
+    void IdLookupCache::clear() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        ++_generation;
+        _byKey.clear();
+        _entries.clear();
+        bytesCounter.decrement(_bytes);
+        _bytes = 0;
+    }
+
+    void IdLookupCache::_remove(EntryMap::iterator it) {
+        const size_t bytes = entryBytes(it->second->key, it->second->doc);
+        _bytes -= bytes;
+        bytesCounter.decrement(bytes);
+        _entries.erase(it->second);
+        _byKey.erase(it);
+    }
+
+}  // namespace mongo
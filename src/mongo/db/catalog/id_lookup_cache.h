@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <list>
+#include <map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+
+namespace mongo {
+
+    /**
+     * A read-through cache of the documents of one collection most recently found by the IDHACK
+     * stage, so that hot point reads don't have to go through the _id index and the record
+     * store.  Its size is set by the idHackCacheSizeBytes startup parameter, and it is off (0)
+     * by default.
+     *
+     * Entries are keyed by {_id: <value>}. A cached document is always the latest committed
+     * version of the document:
+     * - Writers call invalidate() for each document they update or delete, both when
+     *   writing it and when the write commits or rolls back.
+     * - Readers only add() documents they read from a snapshot opened after they called
+     *   getGeneration(). The add is dropped if anything was invalidated since.
+     *
+     * Thread safe.
+     */
+    class IdLookupCache {
+        MONGO_DISALLOW_COPYING(IdLookupCache);
+    public:
+        /**
+         * Returns true if the server was started with a cache size.
+         */
+        static bool isEnabled();
+
+        IdLookupCache();
+
+        /**
+         * Returns the number of invalidations so far, to pass to add().
+         */
+        unsigned long long getGeneration() const;
+
+        /**
+         * Looks up the document with _id 'key', and marks it recently used. Returns false if
+         * it isn't cached.
+         */
+        bool find(const BSONObj& key, RecordId* locOut, BSONObj* docOut);
+
+        /**
+         * Caches 'doc', stored at 'loc', under 'key', evicting the least recently used
+         * documents to make room. Does nothing if anything was invalidated since getGeneration()
+         * returned 'generation', or if 'doc' is too large to be worth caching.
+         */
+        void add(const BSONObj& key,
+                 unsigned long long generation,
+                 const RecordId& loc,
+                 const BSONObj& doc);
+
+        /**
+         * Drops the document with _id 'key', and fails any add() under way.
+         */
+        void invalidate(const BSONObj& key);
+
+        /**
+         * Drops every document.
+         */
+        void clear();
+
+    private:
+        struct Entry {
+            BSONObj key;
+            RecordId loc;
+            BSONObj doc;
+        };
+
+        // Most recently used first.
+        typedef std::list<Entry> EntryList;
+        typedef std::map<BSONObj, EntryList::iterator, BSONObjCmp> EntryMap;
+
+        // Must be called with _mutex held.
+        void _remove(EntryMap::iterator it);
+
+        // Protects all of the below.
+        mutable boost::mutex _mutex;
+
+        unsigned long long _generation;
+        EntryList _entries;
+        EntryMap _byKey;
+        size_t _bytes;
+    };
+
+}  // namespace mongo
@@ -50,6 +50,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/multi_index_key_generator.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
@@ -83,7 +84,8 @@ namespace mongo {
     IndexCatalog::IndexCatalog( Collection* collection )
         : _magic(INDEX_CATALOG_UNINIT),
           _collection( collection ),
-          _maxNumIndexesAllowed(_collection->getCatalogEntry()->getMaxAllowedIndexes()) {
+          _maxNumIndexesAllowed(_collection->getCatalogEntry()->getMaxAllowedIndexes()),
+          _keyGeneratorVersion(0) {
     }
 
     IndexCatalog::~IndexCatalog() {
@@ -1134,26 +1136,63 @@ namespace {
 
     }
 
+    boost::shared_ptr<const MultiIndexKeyGenerator> IndexCatalog::_getKeyGenerator() const {
+        // '_entries' only change under an exclusive lock, so they can't change while the writers
+        // which share the key generator run.
+        boost::lock_guard<boost::mutex> lk(_keyGeneratorMutex);
+        if (!_keyGenerator || _keyGeneratorVersion != _entries.version()) {
+            std::vector<const IndexAccessMethod*> indexes;
+            for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+                  i != _entries.end();
+                  ++i ) {
+                indexes.push_back((*i)->accessMethod());
+            }
+            _keyGenerator.reset(new MultiIndexKeyGenerator(indexes));
+            _keyGeneratorVersion = _entries.version();
+        }
+        return _keyGenerator;
+    }
+
     Status IndexCatalog::_indexRecord(OperationContext* txn,
-                                      IndexCatalogEntry* index,
+                                      const MultiIndexKeyGenerator& keyGenerator,
                                       const BSONObj& obj,
                                       const RecordId &loc ) {
-        const MatchExpression* filter = index->getFilterExpression();
-        if ( filter && !filter->matchesBSON( obj ) ) {
-            return Status::OK();
+        invariant(keyGenerator.numIndexes() == _entries.size());
+
+        std::vector<bool> wanted;
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+            const MatchExpression* filter = (*i)->getFilterExpression();
+            wanted.push_back(!filter || filter->matchesBSON(obj));
         }
 
-        InsertDeleteOptions options;
-        options.logIfError = false;
-        options.dupsAllowed = isDupsAllowed( index->descriptor() );
+        std::vector<BSONObjSet> keys;
+        keyGenerator.getKeys(obj, wanted, &keys);
+
+        for ( size_t i = 0; i < keys.size(); ++i ) {
+            if ( !wanted[i] )
+                continue;
+
+            IndexCatalogEntry* index = _entries.begin()[i];
 
-        int64_t inserted;
-        return index->accessMethod()->insert(txn, obj, loc, options, &inserted);
+            InsertDeleteOptions options;
+            options.logIfError = false;
+            options.dupsAllowed = isDupsAllowed( index->descriptor() );
+
+            int64_t inserted;
+            Status s = index->accessMethod()->insertKeys(txn, keys[i], loc, options, &inserted);
+            if ( !s.isOK() )
+                return s;
+        }
+
+        return Status::OK();
     }
 
     Status IndexCatalog::_unindexRecord(OperationContext* txn,
                                         IndexCatalogEntry* index,
                                         const BSONObj& obj,
+                                        const BSONObjSet& keys,
                                         const RecordId &loc,
                                         bool logIfError) {
         InsertDeleteOptions options;
@@ -1166,7 +1205,7 @@ namespace {
         options.dupsAllowed = options.dupsAllowed || !index->isReady(txn);
 
         int64_t removed;
-        Status status = index->accessMethod()->remove(txn, obj, loc, options, &removed);
+        Status status = index->accessMethod()->removeKeys(txn, keys, loc, options, &removed);
 
         if ( !status.isOK() ) {
             log() << "Couldn't unindex record " << obj.toString()
@@ -1181,11 +1220,17 @@ namespace {
     Status IndexCatalog::indexRecord(OperationContext* txn,
                                    const BSONObj& obj,
                                    const RecordId &loc ) {
+        return _indexRecord(txn, *_getKeyGenerator(), obj, loc);
+    }
 
-        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
-              i != _entries.end();
-              ++i ) {
-            Status s = _indexRecord(txn, *i, obj, loc);
+    Status IndexCatalog::indexRecords(OperationContext* txn,
+                                      const std::vector<BSONObj>& objs,
+                                      const std::vector<RecordId>& locs) {
+        invariant( objs.size() == locs.size() );
+
+        const boost::shared_ptr<const MultiIndexKeyGenerator> keyGenerator = _getKeyGenerator();
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            Status s = _indexRecord(txn, *keyGenerator, objs[i], locs[i]);
             if (!s.isOK())
                 return s;
         }
@@ -1197,16 +1242,18 @@ namespace {
                                      const BSONObj& obj,
                                      const RecordId& loc,
                                      bool noWarn) {
+        const boost::shared_ptr<const MultiIndexKeyGenerator> keyGenerator = _getKeyGenerator();
+        invariant(keyGenerator->numIndexes() == _entries.size());
 
-        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
-              i != _entries.end();
-              ++i ) {
+        std::vector<BSONObjSet> keys;
+        keyGenerator->getKeys(obj, std::vector<bool>(_entries.size(), true), &keys);
 
-            IndexCatalogEntry* entry = *i;
+        for ( size_t i = 0; i < keys.size(); ++i ) {
+            IndexCatalogEntry* entry = _entries.begin()[i];
 
             // If it's a background index, we DO NOT want to log anything.
             bool logIfError = entry->isReady(txn) ? !noWarn : false;
-            _unindexRecord(txn, entry, obj, loc, logIfError);
+            _unindexRecord(txn, entry, obj, keys[i], loc, logIfError);
         }
     }
 
@@ -32,6 +32,9 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -42,6 +45,7 @@ namespace mongo {
 
     class Client;
     class Collection;
+    class MultiIndexKeyGenerator;
 
     class IndexDescriptor;
     class IndexAccessMethod;
@@ -295,6 +299,14 @@ namespace mongo {
         // this throws for now
         Status indexRecord(OperationContext* txn, const BSONObj& obj, const RecordId &loc);
 
+        /**
+         * Same as calling indexRecord() for each of 'objs' and the matching entry of 'locs', but
+         * adds all of the documents' keys to one index before moving on to the next.
+         */
+        Status indexRecords(OperationContext* txn,
+                            const std::vector<BSONObj>& objs,
+                            const std::vector<RecordId>& locs);
+
         void unindexRecord(OperationContext* txn,
                            const BSONObj& obj,
                            const RecordId& loc,
@@ -329,14 +341,20 @@ namespace mongo {
 
         void _checkMagic() const;
 
+        /**
+         * Returns the key generator for the current '_entries', building it if they changed.
+         */
+        boost::shared_ptr<const MultiIndexKeyGenerator> _getKeyGenerator() const;
+
         Status _indexRecord(OperationContext* txn,
-                            IndexCatalogEntry* index,
+                            const MultiIndexKeyGenerator& keyGenerator,
                             const BSONObj& obj,
                             const RecordId &loc );
 
         Status _unindexRecord(OperationContext* txn,
                               IndexCatalogEntry* index,
                               const BSONObj& obj,
+                              const BSONObjSet& keys,
                               const RecordId &loc,
                               bool logIfError);
 
@@ -375,6 +393,12 @@ namespace mongo {
 
         IndexCatalogEntryContainer _entries;
 
+        // Generates the keys of a document for every index in '_entries' in one pass. Rebuilt by
+        // the first write after '_entries' changes, and shared by concurrent writers.
+        mutable boost::mutex _keyGeneratorMutex;
+        mutable boost::shared_ptr<const MultiIndexKeyGenerator> _keyGenerator;
+        mutable unsigned long long _keyGeneratorVersion;  // the _entries.version() it is for
+
         // These are the index specs of indexes that were "leftover".
         // "Leftover" means they were unfinished when a mongod shut down.
         // Certain operations are prohibited until someone fixes.
@@ -286,6 +286,7 @@ namespace mongo {
             if ( e->descriptor() != desc )
                 continue;
             _entries.mutableVector().erase( i );
+            ++_version;
             return e;
         }
         return NULL;
@@ -125,6 +125,7 @@ namespace mongo {
 
     class IndexCatalogEntryContainer {
     public:
+        IndexCatalogEntryContainer() : _version(0) { }
 
         typedef std::vector<IndexCatalogEntry*>::const_iterator const_iterator;
         typedef std::vector<IndexCatalogEntry*>::const_iterator iterator;
@@ -144,6 +145,11 @@ namespace mongo {
 
 
         unsigned size() const { return _entries.size(); }
+
+        /**
+         * Changes whenever an entry is added or removed.
+         */
+        unsigned long long version() const { return _version; }
         // -----------------
 
         /**
@@ -158,10 +164,14 @@ namespace mongo {
         }
 
         // pass ownership to EntryContainer
-        void add( IndexCatalogEntry* entry ) { _entries.mutableVector().push_back( entry ); }
+        void add( IndexCatalogEntry* entry ) {
+            _entries.mutableVector().push_back( entry );
+            ++_version;
+        }
 
     private:
         OwnedPointerVector<IndexCatalogEntry> _entries;
+        unsigned long long _version;
     };
 
 }
@@ -36,6 +36,11 @@
 
 #include <boost/make_shared.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
 
 #include "mongo/base/error_codes.h"
 #include "mongo/client/dbclientinterface.h"
@@ -48,6 +53,9 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
@@ -58,6 +66,202 @@ namespace mongo {
     using std::string;
     using std::endl;
 
+    // Maximum number of threads generating keys for a single foreground index build. Zero
+    // generates keys on the thread running the build.
+    MONGO_EXPORT_SERVER_PARAMETER(maxIndexBuildKeyGenerationThreads, int, 4);
+
+    /**
+     * Generates the keys of a foreground index build on a small set of threads, so that the
+     * collection scan on the building thread overlaps with key generation and sorting, and the
+     * indexes of a multi-index build are processed in parallel.
+     *
+     * Each index is assigned to exactly one worker, since BulkBuilders are not thread safe. The
+     * building thread collects owned copies of the documents into batches and hands every batch
+     * to all workers. A worker generates keys for its indexes and adds them to their external
+     * sorters, which sort and spill to disk independently of each other.
+     *
+     * The first error is kept and returned by later calls to insert() and by finish(). Once
+     * there is an error, workers discard their remaining batches.
+     */
+    class MultiIndexBlock::KeyGenerationPool {
+        MONGO_DISALLOW_COPYING(KeyGenerationPool);
+    public:
+        KeyGenerationPool(std::vector<IndexToBuild>* indexes, size_t numThreads)
+            : _currentBatch(new Batch()),
+              _currentBatchBytes(0),
+              _status(Status::OK()),
+              _done(false) {
+            invariant(numThreads > 0);
+            for (size_t i = 0; i < numThreads; i++) {
+                _workers.push_back(boost::make_shared<Worker>());
+            }
+            for (size_t i = 0; i < indexes->size(); i++) {
+                invariant((*indexes)[i].bulk);
+                _workers[i % numThreads]->indexes.push_back(&(*indexes)[i]);
+            }
+            for (size_t i = 0; i < numThreads; i++) {
+                _workers[i]->thread = boost::thread(
+                        stdx::bind(&KeyGenerationPool::_workerThread, this, _workers[i].get()));
+            }
+        }
+
+        ~KeyGenerationPool() {
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                if (_status.isOK()) {
+                    _status = Status(ErrorCodes::Interrupted, "index build aborted");
+                }
+            }
+            _join();
+        }
+
+        Status insert(const BSONObj& doc, const RecordId& loc) {
+            _currentBatch->push_back(std::make_pair(doc.getOwned(), loc));
+            _currentBatchBytes += doc.objsize();
+            if (_currentBatch->size() >= kMaxBatchDocs || _currentBatchBytes >= kMaxBatchBytes) {
+                return _flush();
+            }
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _status;
+        }
+
+        /**
+         * Waits for keys to be generated for every document passed to insert() and stops the
+         * workers. After this returns the BulkBuilders may be committed.
+         */
+        Status finish() {
+            _flush();
+            return _join();
+        }
+
+    private:
+        typedef std::vector<std::pair<BSONObj, RecordId> > Batch;
+
+        struct Worker {
+            std::vector<IndexToBuild*> indexes;
+            std::deque<boost::shared_ptr<const Batch> > queue;
+            boost::thread thread;
+        };
+
+        static const size_t kMaxBatchDocs = 1000;
+        static const int kMaxBatchBytes = 4 * 1024 * 1024;
+
+        // Bounds the memory used by documents waiting for the slowest worker.
+        static const size_t kMaxQueuedBatches = 4;
+
+        Status _flush() {
+            boost::shared_ptr<const Batch> batch(_currentBatch.release());
+            _currentBatch.reset(new Batch());
+            _currentBatchBytes = 0;
+
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            if (!batch->empty()) {
+                while (_status.isOK() && _anyQueueFull_inlock()) {
+                    _queueSpaceAvailable.wait(lk);
+                }
+                if (_status.isOK()) {
+                    for (size_t i = 0; i < _workers.size(); i++) {
+                        _workers[i]->queue.push_back(batch);
+                    }
+                    _workAvailable.notify_all();
+                }
+            }
+            return _status;
+        }
+
+        Status _join() {
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _done = true;
+                _workAvailable.notify_all();
+            }
+            for (size_t i = 0; i < _workers.size(); i++) {
+                if (_workers[i]->thread.joinable()) {
+                    _workers[i]->thread.join();
+                }
+            }
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _status;
+        }
+
+        bool _anyQueueFull_inlock() const {
+            for (size_t i = 0; i < _workers.size(); i++) {
+                if (_workers[i]->queue.size() >= kMaxQueuedBatches)
+                    return true;
+            }
+            return false;
+        }
+
+        void _workerThread(Worker* worker) {
+            setThreadName("indexKeyGenerator");
+
+            while (true) {
+                boost::shared_ptr<const Batch> batch;
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (worker->queue.empty() && !_done) {
+                        _workAvailable.wait(lk);
+                    }
+                    if (worker->queue.empty()) {
+                        return;
+                    }
+                    batch = worker->queue.front();
+                    worker->queue.pop_front();
+                    _queueSpaceAvailable.notify_all();
+                    if (!_status.isOK()) {
+                        continue;
+                    }
+                }
+
+                Status status = _generateKeys(*batch, worker->indexes);
+                if (!status.isOK()) {
+                    boost::lock_guard<boost::mutex> lk(_mutex);
+                    if (_status.isOK()) {
+                        _status = status;
+                    }
+                    _queueSpaceAvailable.notify_all();
+                }
+            }
+        }
+
+        static Status _generateKeys(const Batch& batch, const std::vector<IndexToBuild*>& indexes) {
+            try {
+                for (size_t i = 0; i < batch.size(); i++) {
+                    const BSONObj& doc = batch[i].first;
+                    for (size_t j = 0; j < indexes.size(); j++) {
+                        IndexToBuild* index = indexes[j];
+                        if (index->filterExpression && !index->filterExpression->matchesBSON(doc)) {
+                            continue;
+                        }
+
+                        int64_t unused;
+                        Status status =
+                            index->bulk->insert(NULL, doc, batch[i].second, index->options, &unused);
+                        if (!status.isOK())
+                            return status;
+                    }
+                }
+            }
+            catch (...) {
+                return exceptionToStatus();
+            }
+            return Status::OK();
+        }
+
+        // Only used by the building thread.
+        std::unique_ptr<Batch> _currentBatch;
+        int _currentBatchBytes;
+
+        std::vector<boost::shared_ptr<Worker> > _workers;
+
+        // Protects the members below and the workers' queues.
+        boost::mutex _mutex;
+        boost::condition_variable _workAvailable;
+        boost::condition_variable _queueSpaceAvailable;
+        Status _status;
+        bool _done;
+    };
+
     /**
      * On rollback sets MultiIndexBlock::_needToCleanup to true.
      */
@@ -98,6 +302,9 @@ namespace mongo {
     }
 
     MultiIndexBlock::~MultiIndexBlock() {
+        // Stop using the BulkBuilders before the indexes go away.
+        _keyGenerationPool.reset();
+
         if (!_needToCleanup || _indexes.empty())
             return;
         while (true) {
@@ -219,6 +426,14 @@ namespace mongo {
             _backgroundOperation.reset(new BackgroundOperation(ns));
 
         wunit.commit();
+
+        const int maxThreads = maxIndexBuildKeyGenerationThreads;
+        if (!_buildInBackground && maxThreads > 0 && !_indexes.empty()) {
+            const size_t numThreads = std::min(_indexes.size(), static_cast<size_t>(maxThreads));
+            LOG(1) << "\t generating index keys on " << numThreads << " thread(s)";
+            _keyGenerationPool.reset(new KeyGenerationPool(&_indexes, numThreads));
+        }
+
         return Status::OK();
     }
 
@@ -336,6 +551,10 @@ namespace mongo {
     }
 
     Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
+        if (_keyGenerationPool) {
+            return _keyGenerationPool->insert(doc, loc);
+        }
+
         for ( size_t i = 0; i < _indexes.size(); i++ ) {
 
             if ( _indexes[i].filterExpression &&
@@ -359,6 +578,13 @@ namespace mongo {
     }
 
     Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
+        if (_keyGenerationPool) {
+            Status status = _keyGenerationPool->finish();
+            _keyGenerationPool.reset();
+            if (!status.isOK())
+                return status;
+        }
+
         for ( size_t i = 0; i < _indexes.size(); i++ ) {
             if ( _indexes[i].bulk == NULL )
                 continue;
@@ -378,6 +604,7 @@ namespace mongo {
     }
 
     void MultiIndexBlock::abortWithoutCleanup() {
+        _keyGenerationPool.reset();
         _indexes.clear();
         _needToCleanup = false;
     }
@@ -147,6 +147,10 @@ namespace mongo {
          *
          * Do not call if you called insertAllDocumentsInCollection();
          *
+         * For foreground builds, keys may be generated on other threads after this returns, so
+         * an error caused by 'wholeDocument' may instead be returned by a later call to insert()
+         * or by doneInserting().
+         *
          * Should be called inside of a WriteUnitOfWork.
          */
         Status insert(const BSONObj& wholeDocument, const RecordId& loc);
@@ -197,6 +201,7 @@ namespace mongo {
     private:
         class SetNeedToCleanupOnRollback;
         class CleanupIndexesVectorOnRollback;
+        class KeyGenerationPool;
 
         struct IndexToBuild {
 #if defined(_MSC_VER) && _MSC_VER < 1900 // MVSC++ <= 2013 can't generate default move operations
@@ -230,6 +235,9 @@ namespace mongo {
 
         std::vector<IndexToBuild> _indexes;
 
+        // Set for foreground builds when key generation runs on separate threads; see init().
+        std::unique_ptr<KeyGenerationPool> _keyGenerationPool;
+
         std::unique_ptr<BackgroundOperation> _backgroundOperation;
 
         // Pointers not owned here and must outlive 'this'
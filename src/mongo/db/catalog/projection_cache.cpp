@@ -0,0 +1,303 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/projection_cache.h"
+
+#include <algorithm>
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using boost::scoped_ptr;
+    using boost::shared_ptr;
+    using std::string;
+    using std::vector;
+
+    MONGO_EXPORT_SERVER_PARAMETER(projectionCacheMaxBytesPerCollection, int, 256 * 1024 * 1024);
+
+namespace {
+
+    const size_t kBlockSize = 1024 * 1024;
+
+    // Rows are checked for interruption every this many documents while they are built.
+    const size_t kInterruptCheckInterval = 1024;
+
+    ProjectionCache globalProjectionCache;
+
+    bool containsField(const vector<string>& fields, StringData name) {
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (name == fields[i]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace
+
+    ProjectionCache* getGlobalProjectionCache() {
+        return &globalProjectionCache;
+    }
+
+    class ProjectionCache::BumpGenerationOnCommit : public RecoveryUnit::Change {
+    public:
+        BumpGenerationOnCommit(ProjectionCache* cache, const string& ns)
+            : _cache(cache),
+              _ns(ns) { }
+
+        // A build whose snapshot started between the write and its commit may have missed the
+        // write, so its rows must not be used either.
+        virtual void commit() { _cache->_bumpGeneration(_ns); }
+        virtual void rollback() { _cache->_bumpGeneration(_ns); }
+
+    private:
+        ProjectionCache* const _cache;
+        const string _ns;
+    };
+
+    ProjectionCache::Rows::Iterator::Iterator(const Rows& rows)
+        : _rows(rows),
+          _block(0),
+          _offset(0) { }
+
+    bool ProjectionCache::Rows::Iterator::more() {
+        while (_block < _rows._blocks.size() && _offset >= _rows._blocks[_block].size()) {
+            ++_block;
+            _offset = 0;
+        }
+        return _block < _rows._blocks.size();
+    }
+
+    BSONObj ProjectionCache::Rows::Iterator::next() {
+        invariant(more());
+        BSONObj row(&_rows._blocks[_block][_offset]);
+        _offset += row.objsize();
+        return row;
+    }
+
+    void ProjectionCache::Rows::append(const BSONObj& row) {
+        const size_t size = row.objsize();
+        if (_blocks.empty() || _blocks.back().size() + size > _blocks.back().capacity()) {
+            _blocks.push_back(vector<char>());
+            _blocks.back().reserve(std::max(kBlockSize, size));
+        }
+        vector<char>& block = _blocks.back();
+        block.insert(block.end(), row.objdata(), row.objdata() + size);
+        ++_numRows;
+        _dataSize += size;
+    }
+
+    Status ProjectionCache::setFields(Collection* collection, const vector<string>& fields) {
+        const string& ns = collection->ns().ns();
+        if (!fields.empty() && collection->isCapped()) {
+            return Status(ErrorCodes::InvalidOptions,
+                          str::stream() << "cannot cache projections of capped collection " << ns);
+        }
+        for (size_t i = 0; i < fields.size(); ++i) {
+            if (fields[i].empty() ||
+                fields[i][0] == '$' ||
+                fields[i].find('.') != string::npos) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "projection cache fields must be top-level field "
+                                            << "names, not '" << fields[i] << "'");
+            }
+        }
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (fields.empty()) {
+            _entries.erase(ns);
+        }
+        else {
+            Entry& entry = _entries[ns];
+            entry = Entry();
+            entry.fields = fields;
+            entry.generation = ++_lastGeneration;
+        }
+        _numEntries.store(_entries.size());
+        return Status::OK();
+    }
+
+    shared_ptr<const ProjectionCache::Rows> ProjectionCache::getRows(
+            OperationContext* txn,
+            const Collection* collection,
+            const vector<string>& fields) {
+        const string& ns = collection->ns().ns();
+        vector<string> declared;
+        unsigned long long generation;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            EntryMap::const_iterator it = _entries.find(ns);
+            if (it == _entries.end()) {
+                return shared_ptr<const Rows>();
+            }
+            const Entry& entry = it->second;
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (!containsField(entry.fields, fields[i])) {
+                    return shared_ptr<const Rows>();
+                }
+            }
+            if (entry.rows && entry.rowsGeneration == entry.generation) {
+                return entry.rows;
+            }
+            if (entry.failed && entry.failedGeneration == entry.generation) {
+                return shared_ptr<const Rows>();
+            }
+            declared = entry.fields;
+            generation = entry.generation;
+        }
+
+        // Build without holding _mutex, so that writers are only held up by the collection lock.
+        shared_ptr<Rows> rows(new Rows());
+        bool tooLarge = false;
+        scoped_ptr<RecordIterator> iter(collection->getIterator(txn));
+        while (!iter->isEOF()) {
+            const RecordId loc = iter->getNext();
+            const BSONObj doc = iter->dataFor(loc).toBson();
+
+            BSONObjBuilder row;
+            BSONForEach(elem, doc) {
+                if (containsField(declared, elem.fieldNameStringData())) {
+                    row.append(elem);
+                }
+            }
+            rows->append(row.done());
+
+            if (rows->dataSize() > static_cast<size_t>(projectionCacheMaxBytesPerCollection)) {
+                tooLarge = true;
+                break;
+            }
+            if (rows->numRows() % kInterruptCheckInterval == 0) {
+                txn->checkForInterrupt();
+            }
+        }
+
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            EntryMap::iterator it = _entries.find(ns);
+            if (it != _entries.end() && it->second.generation == generation) {
+                Entry& entry = it->second;
+                if (tooLarge) {
+                    entry.rows.reset();
+                    entry.failed = true;
+                    entry.failedGeneration = generation;
+                }
+                else {
+                    entry.rows = rows;
+                    entry.rowsGeneration = generation;
+                }
+            }
+        }
+
+        // Even if a write raced with the build and the rows were not kept, they reflect what
+        // the caller's own scan would have seen under its lock.
+        if (tooLarge) {
+            return shared_ptr<const Rows>();
+        }
+        return rows;
+    }
+
+    void ProjectionCache::noteWrite(OperationContext* txn, StringData ns) {
+        if (_numEntries.loadRelaxed() == 0) {
+            return;
+        }
+
+        const string nsString = ns.toString();
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_entries.find(nsString) == _entries.end()) {
+                return;
+            }
+        }
+        _bumpGeneration(nsString);
+        txn->recoveryUnit()->registerChange(new BumpGenerationOnCommit(this, nsString));
+    }
+
+    void ProjectionCache::_bumpGeneration(const string& ns) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        EntryMap::iterator it = _entries.find(ns);
+        if (it == _entries.end()) {
+            return;
+        }
+        it->second.generation = ++_lastGeneration;
+        it->second.rows.reset();
+    }
+
+    void ProjectionCache::dropCollection(StringData ns) {
+        if (_numEntries.loadRelaxed() == 0) {
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _entries.erase(ns.toString());
+        _numEntries.store(_entries.size());
+    }
+
+    void ProjectionCache::dropDatabase(StringData dbName) {
+        if (_numEntries.loadRelaxed() == 0) {
+            return;
+        }
+
+        const string prefix = dbName.toString() + '.';
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        EntryMap::iterator it = _entries.lower_bound(prefix);
+        while (it != _entries.end() && str::startsWith(it->first, prefix)) {
+            _entries.erase(it++);
+        }
+        _numEntries.store(_entries.size());
+    }
+
+    void ProjectionCache::appendStats(StringData ns, BSONObjBuilder* builder) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        EntryMap::const_iterator it = _entries.find(ns.toString());
+        if (it == _entries.end()) {
+            builder->append("fields", vector<string>());
+            return;
+        }
+
+        const Entry& entry = it->second;
+        builder->append("fields", entry.fields);
+        const bool current = entry.rows && entry.rowsGeneration == entry.generation;
+        builder->appendBool("current", current);
+        builder->appendBool("tooLarge",
+                            entry.failed && entry.failedGeneration == entry.generation);
+        if (current) {
+            builder->appendNumber("numRows", static_cast<long long>(entry.rows->numRows()));
+            builder->appendNumber("dataSize", static_cast<long long>(entry.rows->dataSize()));
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class Collection;
+    class OperationContext;
+
+    /**
+     * Keeps, for collections that ask for it, an in-memory copy of just a few declared top-level
+     * "hot" fields of every document. Aggregations which only depend on those fields scan the
+     * densely packed copies instead of the full documents (see PipelineD).
+     *
+     * The copies of a collection are built lazily by the first query that can use them and are
+     * thrown away by every write to the collection, which OpObserver reports through noteWrite().
+     * This suits read-mostly collections that are queried much more often than they change.
+     *
+     * Declarations live only in memory and are lost on restart. Capped collections are not
+     * supported since documents age out of them without going through the OpObserver.
+     */
+    class ProjectionCache {
+        MONGO_DISALLOW_COPYING(ProjectionCache);
+    public:
+        /**
+         * The cached projections of all documents of one collection, each a BSONObj holding only
+         * the declared fields, in the order the documents were stored in. Immutable once built.
+         */
+        class Rows {
+            MONGO_DISALLOW_COPYING(Rows);
+        public:
+            class Iterator {
+            public:
+                explicit Iterator(const Rows& rows);
+
+                bool more();
+
+                /**
+                 * The returned BSONObj points into "rows", which must outlive it.
+                 */
+                BSONObj next();
+
+            private:
+                const Rows& _rows;
+                size_t _block;
+                size_t _offset;
+            };
+
+            Rows() : _numRows(0), _dataSize(0) { }
+
+            size_t numRows() const { return _numRows; }
+            size_t dataSize() const { return _dataSize; }
+
+        private:
+            friend class ProjectionCache;
+
+            void append(const BSONObj& row);
+
+            // Rows are packed back to back into blocks of about kBlockSize bytes.
+            std::vector<std::vector<char> > _blocks;
+            size_t _numRows;
+            size_t _dataSize;
+        };
+
+        ProjectionCache() : _lastGeneration(0) { }
+
+        /**
+         * Declares the top-level fields to cache for "collection", replacing any earlier
+         * declaration. An empty list removes the cache.
+         *
+         * The caller must hold the collection exclusively, so that no write which predates the
+         * declaration can still commit after it.
+         */
+        Status setFields(Collection* collection, const std::vector<std::string>& fields);
+
+        /**
+         * Returns the cached rows of "collection" if all of "fields" were declared for it,
+         * building them first if a write made them stale. Returns NULL if the collection has no
+         * cache, does not declare one of the fields, or is too large to cache.
+         *
+         * The caller must hold at least a shared lock on the collection and must not yield while
+         * this runs, so that a build sees a consistent collection.
+         */
+        boost::shared_ptr<const Rows> getRows(OperationContext* txn,
+                                              const Collection* collection,
+                                              const std::vector<std::string>& fields);
+
+        /**
+         * Invalidates the cached rows of "ns" because of a write in "txn". Cheap when no
+         * collection has a cache.
+         */
+        void noteWrite(OperationContext* txn, StringData ns);
+
+        /**
+         * Forgets the declaration for "ns", which is being dropped or renamed.
+         */
+        void dropCollection(StringData ns);
+
+        /**
+         * Forgets the declarations for all collections of "dbName".
+         */
+        void dropDatabase(StringData dbName);
+
+        /**
+         * Appends the declared fields and the state of the cached rows of "ns" to "builder".
+         */
+        void appendStats(StringData ns, BSONObjBuilder* builder) const;
+
+    private:
+        class BumpGenerationOnCommit;
+
+        struct Entry {
+            Entry() : generation(0), rowsGeneration(0), failedGeneration(0), failed(false) { }
+
+            std::vector<std::string> fields;
+
+            // Renewed from _lastGeneration by every write. The rows are only current while
+            // rowsGeneration matches, and are not rebuilt at failedGeneration once they turned
+            // out to be too large.
+            unsigned long long generation;
+            boost::shared_ptr<const Rows> rows;
+            unsigned long long rowsGeneration;
+            unsigned long long failedGeneration;
+            bool failed;
+        };
+
+        typedef std::map<std::string, Entry> EntryMap;
+
+        void _bumpGeneration(const std::string& ns);
+
+        mutable boost::mutex _mutex;
+        EntryMap _entries;
+
+        // Generations are unique across entries, so a build that started before the entry was
+        // redeclared can never publish its rows into the new one.
+        unsigned long long _lastGeneration;
+
+        // Mirrors _entries.size() so that writes need not take _mutex when nothing is cached.
+        AtomicUInt32 _numEntries;
+    };
+
+    ProjectionCache* getGlobalProjectionCache();
+
+} // namespace mongo
@@ -76,6 +76,17 @@ namespace mongo {
          */
         static void initThreadIfNotAlready();
 
+        /**
+         * Unbinds the Client from the current thread and returns it, leaving the thread without
+         * a Client. Used to move a connection's Client between threads; see setCurrent().
+         */
+        static ServiceContext::UniqueClient releaseCurrent();
+
+        /**
+         * Binds "client" to the current thread, which must not already have a Client.
+         */
+        static void setCurrent(ServiceContext::UniqueClient client);
+
         std::string clientAddress(bool includePort = false) const;
         const std::string& desc() const { return _desc; }
 
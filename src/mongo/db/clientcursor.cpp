@@ -220,6 +220,13 @@ namespace mongo {
         return _ownedRU.release();
     }
 
+    void ClientCursor::releaseIdleSnapshot() {
+        invariant(!_isPinned);
+        if (_ownedRU.get()) {
+            _ownedRU->releaseIdleSnapshot();
+        }
+    }
+
     //
     // Pin methods
     //
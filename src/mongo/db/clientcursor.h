@@ -195,6 +195,12 @@ namespace mongo {
          */
         RecoveryUnit* releaseOwnedRecoveryUnit();
 
+        /**
+         * Lets the owned recovery unit, if any, release a snapshot it kept open between batches.
+         * Must not be called while the cursor is pinned.
+         */
+        void releaseIdleSnapshot();
+
     private:
         friend class CursorManager;
         friend class ClientCursorPin;
@@ -41,11 +41,13 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_create.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/copydb.h"
 #include "mongo/db/commands/rename_collection.h"
@@ -56,12 +58,15 @@
 #include "mongo/db/index_builder.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/op_observer.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/isself.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -77,6 +82,13 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(skipCorruptDocumentsWhenCloning, bool, false);
 
+    // The number of collections a database clone copies at once, each over its own connection.
+    // 1 or less clones them one after another.
+    MONGO_EXPORT_SERVER_PARAMETER(clonerParallelCollections, int, 4);
+
+    // The most documents a clone inserts in one unit of work.
+    const size_t kMaxInsertBatchDocs = 128;
+
     BSONElement getErrField(const BSONObj& o);
 
     /* for index info object:
@@ -114,13 +126,17 @@ namespace mongo {
         return res;
     }
 
-    Cloner::Cloner() { }
+    Cloner::Cloner()
+        : _mayOpenConnections(false),
+          _authenticateConnections(false) {
+    }
 
     struct Cloner::Fun {
         Fun(OperationContext* txn, const string& dbName)
             :lastLog(0),
              txn(txn),
-             _dbName(dbName)
+             _dbName(dbName),
+             _interruptTxn(NULL)
         {}
 
         void operator()( DBClientCursorBatchIterator &i ) {
@@ -156,8 +172,12 @@ namespace mongo {
                 } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createCollection", to_collection.ns());
             }
 
+            vector<BSONObj> docs;
+            docs.reserve(kMaxInsertBatchDocs);
             while( i.moreInCurrentBatch() ) {
                 if ( numSeen % 128 == 127 ) {
+                    insertDocuments(collection, &docs);
+
                     time_t now = time(0);
                     if( now - lastLog >= 60 ) {
                         // report progress
@@ -168,6 +188,9 @@ namespace mongo {
 
                     if (_mayBeInterrupted) {
                         txn->checkForInterrupt();
+                        if (_interruptTxn) {
+                            uassertStatusOK(_interruptTxn->checkForInterruptNoAssert());
+                        }
                     }
 
                     if (_mayYield) {
@@ -219,10 +242,41 @@ namespace mongo {
                 }
 
                 ++numSeen;
+                docs.push_back(tmp);
+                if (docs.size() >= kMaxInsertBatchDocs) {
+                    insertDocuments(collection, &docs);
+                }
+                RARELY if ( time( 0 ) - saveLast > 60 ) {
+                    log() << numSeen << " objects cloned so far from collection " << from_collection;
+                    saveLast = time( 0 );
+                }
+            }
+            insertDocuments(collection, &docs);
+        }
+
+        /**
+         * Inserts docs, which are then cleared, in a single unit of work.  If that fails the
+         * documents are inserted one at a time, to report which of them failed.
+         */
+        void insertDocuments(Collection* collection, vector<BSONObj>* docs) {
+            if (docs->empty()) {
+                return;
+            }
+
+            bool inserted = false;
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                WriteUnitOfWork wunit(txn);
+                if (collection->insertDocuments(txn, *docs, true).isOK()) {
+                    wunit.commit();
+                    inserted = true;
+                }
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to_collection.ns());
+
+            for (size_t i = 0; !inserted && i < docs->size(); i++) {
                 MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
                     WriteUnitOfWork wunit(txn);
 
-                    BSONObj doc = tmp;
+                    const BSONObj& doc = (*docs)[i];
                     StatusWith<RecordId> loc = collection->insertDocument( txn, doc, true );
                     if ( !loc.isOK() ) {
                         error() << "error: exception cloning object in " << from_collection
@@ -231,11 +285,8 @@ namespace mongo {
                     uassertStatusOK( loc.getStatus() );
                     wunit.commit();
                 } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "cloner insert", to_collection.ns());
-                RARELY if ( time( 0 ) - saveLast > 60 ) {
-                    log() << numSeen << " objects cloned so far from collection " << from_collection;
-                    saveLast = time( 0 );
-                }
             }
+            docs->clear();
         }
 
         time_t lastLog;
@@ -248,11 +299,13 @@ namespace mongo {
         time_t saveLast;
         bool _mayYield;
         bool _mayBeInterrupted;
+        OperationContext* _interruptTxn;
     };
 
     /* copy the specified collection
     */
     void Cloner::copy(OperationContext* txn,
+                      DBClientBase* conn,
                       const string& toDBName,
                       const NamespaceString& from_collection,
                       const NamespaceString& to_collection,
@@ -260,8 +313,9 @@ namespace mongo {
                       bool slaveOk,
                       bool mayYield,
                       bool mayBeInterrupted,
-                      Query query) {
-        LOG(2) << "\t\tcloning collection " << from_collection << " to " << to_collection << " on " << _conn->getServerAddress() << " with filter " << query.toString() << endl;
+                      Query query,
+                      OperationContext* interruptTxn) {
+        LOG(2) << "\t\tcloning collection " << from_collection << " to " << to_collection << " on " << conn->getServerAddress() << " with filter " << query.toString() << endl;
 
         Fun f(txn, toDBName);
         f.numSeen = 0;
@@ -270,11 +324,12 @@ namespace mongo {
         f.saveLast = time( 0 );
         f._mayYield = mayYield;
         f._mayBeInterrupted = mayBeInterrupted;
+        f._interruptTxn = interruptTxn;
 
         int options = QueryOption_NoCursorTimeout | ( slaveOk ? QueryOption_SlaveOk : 0 );
         {
             Lock::TempRelease tempRelease(txn->lockState());
-            _conn->query(stdx::function<void(DBClientCursorBatchIterator &)>(f), from_collection,
+            conn->query(stdx::function<void(DBClientCursorBatchIterator &)>(f), from_collection,
                          query, 0, options);
         }
 
@@ -287,6 +342,7 @@ namespace mongo {
     }
 
     void Cloner::copyIndexes(OperationContext* txn,
+                             DBClientBase* conn,
                              const string& toDBName,
                              const NamespaceString& from_collection,
                              const NamespaceString& to_collection,
@@ -296,14 +352,14 @@ namespace mongo {
                              bool mayBeInterrupted) {
 
         LOG(2) << "\t\t copyIndexes " << from_collection << " to " << to_collection
-               << " on " << _conn->getServerAddress();
+               << " on " << conn->getServerAddress();
 
         vector<BSONObj> indexesToBuild;
 
         {
             Lock::TempRelease tempRelease(txn->lockState());
-            list<BSONObj> sourceIndexes = _conn->getIndexSpecs( from_collection,
-                                                                slaveOk ? QueryOption_SlaveOk : 0 );
+            list<BSONObj> sourceIndexes = conn->getIndexSpecs( from_collection,
+                                                               slaveOk ? QueryOption_SlaveOk : 0 );
             for (list<BSONObj>::const_iterator it = sourceIndexes.begin();
                     it != sourceIndexes.end(); ++it) {
                 indexesToBuild.push_back(fixindex(to_collection.db().toString(), *it));
@@ -405,7 +461,7 @@ namespace mongo {
         }
 
         // main data
-        copy(txn, dbname,
+        copy(txn, _conn.get(), dbname,
              nss, nss,
              false, true, mayYield, mayBeInterrupted,
              Query(query).snapshot());
@@ -416,7 +472,7 @@ namespace mongo {
         }
 
         // indexes
-        copyIndexes(txn, dbname,
+        copyIndexes(txn, _conn.get(), dbname,
                     NamespaceString(ns), NamespaceString(ns),
                     false, true, mayYield,
                     mayBeInterrupted);
@@ -424,6 +480,238 @@ namespace mongo {
         return true;
     }
 
+    struct Cloner::CollectionCloneTask {
+        CollectionCloneTask()
+            : parentTxn(NULL),
+              cs(NULL),
+              masterSameProcess(false),
+              toDBName(NULL),
+              opts(NULL),
+              ok(false),
+              builtAllIndexes(false),
+              exceptionCode(0) {
+        }
+
+        OperationContext* parentTxn;
+        const ConnectionString* cs;
+        bool masterSameProcess;
+        const string* toDBName;
+        const CloneOptions* opts;
+        BSONObj collection;
+
+        // Set by the worker.  If it caught an exception, exceptionCode is that of the exception
+        // and errmsg its reason.
+        bool ok;
+        bool builtAllIndexes;
+        string errmsg;
+        int exceptionCode;
+    };
+
+    void Cloner::cloneOnWorker(CollectionCloneTask* task) {
+        if (!ClientBasic::getCurrent()) {
+            Client::initThreadIfNotAlready();
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+        }
+
+        OperationContextImpl txn;
+        txn.setReplicatedWrites(task->parentTxn->writesAreReplicated());
+
+        try {
+            scoped_ptr<DBClientBase> conn;
+            if (task->masterSameProcess) {
+                conn.reset(new DBDirectClient(&txn));
+            }
+            else {
+                conn.reset(task->cs->connect(task->errmsg));
+                if (!conn) {
+                    return;
+                }
+                if (_authenticateConnections && !authenticateInternalUser(conn.get())) {
+                    task->errmsg = str::stream() << "failed to authenticate to "
+                                                 << conn->getServerAddress();
+                    return;
+                }
+            }
+
+            ScopedTransaction transaction(&txn, MODE_IX);
+            Lock::DBLock dbWrite(txn.lockState(), *task->toDBName, MODE_X);
+            task->ok = cloneOneCollection(&txn,
+                                          conn.get(),
+                                          *task->toDBName,
+                                          task->collection,
+                                          task->masterSameProcess,
+                                          *task->opts,
+                                          task->parentTxn,
+                                          &task->builtAllIndexes,
+                                          &task->errmsg);
+        }
+        catch (const DBException& e) {
+            task->exceptionCode = e.getCode() ? e.getCode() : ErrorCodes::UnknownError;
+            task->errmsg = e.what();
+        }
+        catch (const std::exception& e) {
+            task->exceptionCode = ErrorCodes::UnknownError;
+            task->errmsg = e.what();
+        }
+    }
+
+    bool Cloner::cloneOneCollection(OperationContext* txn,
+                                    DBClientBase* conn,
+                                    const string& toDBName,
+                                    const BSONObj& collection,
+                                    bool masterSameProcess,
+                                    const CloneOptions& opts,
+                                    OperationContext* interruptTxn,
+                                    bool* builtAllIndexes,
+                                    string* errmsg) {
+        *builtAllIndexes = false;
+
+        LOG(2) << "  really will clone: " << collection << endl;
+        const char* collectionName = collection["name"].valuestr();
+        BSONObj options = collection.getObjectField("options");
+
+        const NamespaceString from_name(opts.fromDB, collectionName);
+        const NamespaceString to_name(toDBName, collectionName);
+
+        Database* db = dbHolder().openDb(txn, toDBName);
+
+        {
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                WriteUnitOfWork wunit(txn);
+
+                // we defer building id index for performance - building it in batch is much
+                // faster
+                Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
+                if ( !createStatus.isOK() ) {
+                    *errmsg = str::stream() << "failed to create collection \""
+                                            << to_name.ns() << "\": "
+                                            << createStatus.reason();
+                    return false;
+                }
+                wunit.commit();
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createUser", to_name.ns());
+        }
+
+        LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
+        Query q;
+        if( opts.snapshot )
+            q.snapshot();
+
+        copy(txn,
+             conn,
+             toDBName,
+             from_name,
+             to_name,
+             masterSameProcess,
+             opts.slaveOk,
+             opts.mayYield,
+             opts.mayBeInterrupted,
+             q,
+             interruptTxn);
+
+        // The secondary indexes are built along with the _id index, in one pass over the
+        // collection, unless one of them is unique: duplicates are only dropped for _id.
+        vector<BSONObj> secondaryIndexes;
+        bool buildSecondaryIndexes = false;
+        if (opts.syncIndexes) {
+            Lock::TempRelease tempRelease(txn->lockState());
+            list<BSONObj> sourceIndexes =
+                conn->getIndexSpecs(from_name, opts.slaveOk ? QueryOption_SlaveOk : 0);
+
+            buildSecondaryIndexes = true;
+            for (list<BSONObj>::const_iterator it = sourceIndexes.begin();
+                    it != sourceIndexes.end(); ++it) {
+                if (IndexDescriptor::isIdIndexPattern((*it)["key"].Obj())) {
+                    continue;
+                }
+                if ((*it)["unique"].trueValue()) {
+                    buildSecondaryIndexes = false;
+                    break;
+                }
+                secondaryIndexes.push_back(fixindex(toDBName, *it));
+            }
+        }
+
+        if (opts.mayBeInterrupted && interruptTxn) {
+            uassertStatusOK(interruptTxn->checkForInterruptNoAssert());
+        }
+
+        uassert(ErrorCodes::NotMaster,
+                str::stream() << "Not primary while building indexes of " << to_name.ns()
+                              << " (Cloner)",
+                !txn->writesAreReplicated() ||
+                repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(toDBName));
+
+        // Copy releases the lock, so we need to re-load the database. This should
+        // probably throw if the database has changed in between, but for now preserve
+        // the existing behaviour.
+        db = dbHolder().get(txn, toDBName);
+        uassert(18645,
+                str::stream() << "database " << toDBName << " dropped during clone",
+                db);
+
+        Collection* c = db->getCollection( to_name );
+        if ( c && !c->getIndexCatalog()->haveIdIndex( txn ) ) {
+            vector<BSONObj> indexesToBuild;
+            indexesToBuild.push_back(c->getIndexCatalog()->getDefaultIdIndexSpec());
+            if (buildSecondaryIndexes) {
+                indexesToBuild.insert(indexesToBuild.end(),
+                                      secondaryIndexes.begin(),
+                                      secondaryIndexes.end());
+            }
+
+            // We need to drop objects with duplicate _ids because we didn't do a true
+            // snapshot and this is before applying oplog operations that occur during the
+            // initial sync.
+            set<RecordId> dups;
+
+            MultiIndexBlock indexer(txn, c);
+            if (opts.mayBeInterrupted)
+                indexer.allowInterruption();
+
+            indexer.removeExistingIndexes(&indexesToBuild);
+            uassertStatusOK(indexer.init(indexesToBuild));
+            uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
+
+            // This must be done before we commit the indexer. See the comment about
+            // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
+            for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
+                WriteUnitOfWork wunit(txn);
+                BSONObj id;
+
+                c->deleteDocument(txn,
+                                  *it,
+                                  true,
+                                  true,
+                                  txn->writesAreReplicated() ? &id : nullptr);
+                wunit.commit();
+            }
+
+            if (!dups.empty()) {
+                log() << "index build dropped: " << dups.size() << " dups";
+            }
+
+            WriteUnitOfWork wunit(txn);
+            indexer.commit();
+            if (txn->writesAreReplicated()) {
+                const string targetSystemIndexesCollectionName =
+                    c->ns().getSystemIndexesCollection();
+                for (vector<BSONObj>::const_iterator it = indexesToBuild.begin();
+                        it != indexesToBuild.end(); ++it) {
+                    getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+                            txn,
+                            targetSystemIndexesCollectionName.c_str(),
+                            *it);
+                }
+            }
+            wunit.commit();
+
+            *builtAllIndexes = buildSecondaryIndexes;
+        }
+
+        return true;
+    }
+
     bool Cloner::go(OperationContext* txn,
                     const std::string& toDBName,
                     const string& masterHost,
@@ -483,9 +771,12 @@ namespace mongo {
                 }
 
                 _conn = con;
+                _mayOpenConnections = true;
+                _authenticateConnections = getGlobalAuthorizationManager()->isAuthEnabled();
             }
             else {
                 _conn.reset(new DBDirectClient(txn));
+                _mayOpenConnections = true;
             }
         }
 
@@ -561,99 +852,73 @@ namespace mongo {
                 !txn->writesAreReplicated() ||
                 repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(toDBName));
 
+        set<string> indexedColls;
         if ( opts.syncData ) {
-            for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
-                BSONObj collection = *i;
-                LOG(2) << "  really will clone: " << collection << endl;
-                const char* collectionName = collection["name"].valuestr();
-                BSONObj options = collection.getObjectField("options");
-
-                const NamespaceString from_name(opts.fromDB, collectionName);
-                const NamespaceString to_name(toDBName, collectionName);
-
-                Database* db = dbHolder().openDb(txn, toDBName);
-
-                {
-                    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
-                        WriteUnitOfWork wunit(txn);
-
-                        // we defer building id index for performance - building it in batch is much
-                        // faster
-                        Status createStatus = userCreateNS(txn, db, to_name.ns(), options, false);
-                        if ( !createStatus.isOK() ) {
-                            errmsg = str::stream() << "failed to create collection \""
-                                                   << to_name.ns() << "\": "
-                                                   << createStatus.reason();
-                            return false;
-                        }
-                        wunit.commit();
-                    } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "createUser", to_name.ns());
+            vector<CollectionCloneTask> tasks;
+            const size_t numWorkers =
+                std::min(toClone.size(),
+                         static_cast<size_t>(std::max(0, static_cast<int>(
+                                                          clonerParallelCollections))));
+            if (numWorkers > 1 && _mayOpenConnections) {
+                for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
+                    CollectionCloneTask task;
+                    task.parentTxn = txn;
+                    task.cs = &cs;
+                    task.masterSameProcess = masterSameProcess;
+                    task.toDBName = &toDBName;
+                    task.opts = &opts;
+                    task.collection = *i;
+                    tasks.push_back(task);
                 }
 
-                LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-                Query q;
-                if( opts.snapshot )
-                    q.snapshot();
-
-                copy(txn,
-                     toDBName,
-                     from_name,
-                     to_name,
-                     masterSameProcess,
-                     opts.slaveOk,
-                     opts.mayYield,
-                     opts.mayBeInterrupted,
-                     q);
-
-                // Copy releases the lock, so we need to re-load the database. This should
-                // probably throw if the database has changed in between, but for now preserve
-                // the existing behaviour.
-                db = dbHolder().get(txn, toDBName);
-                uassert(18645,
-                        str::stream() << "database " << toDBName << " dropped during clone",
-                        db);
-
-                Collection* c = db->getCollection( to_name );
-                if ( c && !c->getIndexCatalog()->haveIdIndex( txn ) ) {
-                    // We need to drop objects with duplicate _ids because we didn't do a true
-                    // snapshot and this is before applying oplog operations that occur during the
-                    // initial sync.
-                    set<RecordId> dups;
-
-                    MultiIndexBlock indexer(txn, c);
-                    if (opts.mayBeInterrupted)
-                        indexer.allowInterruption();
-
-                    uassertStatusOK(indexer.init(c->getIndexCatalog()->getDefaultIdIndexSpec()));
-                    uassertStatusOK(indexer.insertAllDocumentsInCollection(&dups));
-
-                    // This must be done before we commit the indexer. See the comment about
-                    // dupsAllowed in IndexCatalog::_unindexRecord and SERVER-17487.
-                    for (set<RecordId>::const_iterator it = dups.begin(); it != dups.end(); ++it) {
-                        WriteUnitOfWork wunit(txn);
-                        BSONObj id;
-
-                        c->deleteDocument(txn,
-                                          *it,
-                                          true,
-                                          true,
-                                          txn->writesAreReplicated() ? &id : nullptr);
-                        wunit.commit();
+                // The workers take the locks of their own, so let go of ours meanwhile.
+                Lock::TempRelease tempRelease(txn->lockState());
+                if (txn->lockState()->isLocked()) {
+                    // Our locks are held recursively, as in a DBDirectClient call, and can't be
+                    // released; clone one collection after another instead.
+                    tasks.clear();
+                }
+                else {
+                    LOG(1) << "\t cloning " << tasks.size() << " collections of " << opts.fromDB
+                           << " on " << numWorkers << " threads";
+                    ThreadPool workers(numWorkers, "clonerWorker");
+                    for (size_t i = 0; i < tasks.size(); i++) {
+                        workers.schedule(&Cloner::cloneOnWorker, this, &tasks[i]);
                     }
+                    workers.join();
+                }
+            }
 
-                    if (!dups.empty()) {
-                        log() << "index build dropped: " << dups.size() << " dups";
-                    }
+            size_t taskIndex = 0;
+            for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
+                const NamespaceString to_name(toDBName, (*i)["name"].valuestr());
 
-                    WriteUnitOfWork wunit(txn);
-                    indexer.commit();
-                    if (txn->writesAreReplicated()) {
-                        getGlobalServiceContext()->getOpObserver()->onCreateIndex(
-                                txn,
-                                c->ns().getSystemIndexesCollection().c_str(),
-                                c->getIndexCatalog()->getDefaultIdIndexSpec());
+                bool builtAllIndexes = false;
+                if (!tasks.empty()) {
+                    const CollectionCloneTask& task = tasks[taskIndex++];
+                    if (task.exceptionCode) {
+                        uasserted(task.exceptionCode, task.errmsg);
                     }
-                    wunit.commit();
+                    if (!task.ok) {
+                        errmsg = task.errmsg;
+                        return false;
+                    }
+                    builtAllIndexes = task.builtAllIndexes;
+                }
+                else if (!cloneOneCollection(txn,
+                                             _conn.get(),
+                                             toDBName,
+                                             *i,
+                                             masterSameProcess,
+                                             opts,
+                                             NULL,
+                                             &builtAllIndexes,
+                                             &errmsg)) {
+                    return false;
+                }
+
+                if (builtAllIndexes) {
+                    indexedColls.insert(to_name.ns());
                 }
             }
         }
@@ -662,14 +927,18 @@ namespace mongo {
         if ( opts.syncIndexes ) {
             for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
                 BSONObj collection = *i;
-                log() << "copying indexes for: " << collection;
-
                 const char* collectionName = collection["name"].valuestr();
 
                 NamespaceString from_name( opts.fromDB, collectionName );
                 NamespaceString to_name( toDBName, collectionName );
 
+                if (indexedColls.count(to_name.ns())) {
+                    continue;
+                }
+                log() << "copying indexes for: " << collection;
+
                 copyIndexes(txn,
+                            _conn.get(),
                             toDBName,
                             from_name,
                             to_name,
@@ -46,8 +46,15 @@ namespace mongo {
     public:
         Cloner();
 
-        void setConnection(DBClientBase* c) {
+        /**
+         * Clones through c, which the Cloner takes ownership of.  Pass mayReconnect if connecting
+         * to the source takes nothing more than ConnectionString::connect, so that go() may open
+         * further connections like it to clone several collections at once.
+         */
+        void setConnection(DBClientBase* c, bool mayReconnect = false) {
             _conn.reset(c);
+            _mayOpenConnections = mayReconnect;
+            _authenticateConnections = false;
         }
 
         /** copy the entire database */
@@ -68,7 +75,30 @@ namespace mongo {
                             bool copyIndexes = true);
 
     private:
+        struct CollectionCloneTask;
+
+        /**
+         * Creates the collection described by the listCollections entry 'collection', copies its
+         * documents through conn and builds its _id index.  When opts.syncIndexes is set and none
+         * of the source's secondary indexes is unique, those are built in the same pass, and
+         * *builtAllIndexes is set.  Interruption of interruptTxn, if not NULL, stops the clone as
+         * well as that of txn.
+         */
+        bool cloneOneCollection(OperationContext* txn,
+                                DBClientBase* conn,
+                                const std::string& toDBName,
+                                const BSONObj& collection,
+                                bool masterSameProcess,
+                                const CloneOptions& opts,
+                                OperationContext* interruptTxn,
+                                bool* builtAllIndexes,
+                                std::string* errmsg);
+
+        /** Runs cloneOneCollection for task on a thread of its own, over a connection of its own. */
+        void cloneOnWorker(CollectionCloneTask* task);
+
         void copy(OperationContext* txn,
+                  DBClientBase* conn,
                   const std::string& toDBName,
                   const NamespaceString& from_ns,
                   const NamespaceString& to_ns,
@@ -76,9 +106,11 @@ namespace mongo {
                   bool slaveOk,
                   bool mayYield,
                   bool mayBeInterrupted,
-                  Query q);
+                  Query q,
+                  OperationContext* interruptTxn = NULL);
 
         void copyIndexes(OperationContext* txn,
+                         DBClientBase* conn,
                          const std::string& toDBName,
                          const NamespaceString& from_ns,
                          const NamespaceString& to_ns,
@@ -89,6 +121,12 @@ namespace mongo {
 
         struct Fun;
         std::auto_ptr<DBClientBase> _conn;
+
+        // Whether go() may open more connections to the source, to clone collections in parallel.
+        bool _mayOpenConnections;
+
+        // Whether the connections go() opens are authenticated as the internal user.
+        bool _authenticateConnections;
     };
 
     /**
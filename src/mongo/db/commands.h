@@ -40,6 +40,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/util/string_map.h"
 
 namespace mongo {
@@ -237,8 +238,13 @@ namespace mutablebson {
         ServerStatusMetricField<Counter64> _commandsExecutedMetric;
         ServerStatusMetricField<Counter64> _commandsFailedMetric;
 
+        // Latencies of this command's executions, successful or not
+        PartitionedLatencyHistogram _commandLatency;
+
     public:
 
+        const PartitionedLatencyHistogram& getLatencyHistogram() const { return _commandLatency; }
+
         static const CommandMap* commandsByBestName() { return _commandsByBestName; }
         static const CommandMap* webCommands() { return _webCommands; }
 
@@ -44,8 +44,10 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/index_builder.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/util/log.h"
 
@@ -71,9 +73,12 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation locks the database and is slow. you can cancel with killOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>], [freeSpaceOnly:<bool>] }\n"
                 "  force - allows to run on a replica set primary\n"
-                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
+                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n"
+                "  freeSpaceOnly - only merge adjacent free space (mmapv1), without moving documents or rebuilding indexes\n"
+                "  online - only lock the collection in intent mode; mmapv1 moves documents a batch at a time, yielding in between\n"
+                "  batchSize - number of documents moved at a time by an online compact\n";
         }
         CompactCmd() : Command("compact") { }
 
@@ -95,8 +100,12 @@ namespace mongo {
                          BSONObjBuilder& result) {
             const std::string nsToCompact = parseNsCollectionRequired(db, cmdObj);
 
+            // Merging free space doesn't move documents, so it is quick enough to run anywhere.
+            const bool freeSpaceOnly = cmdObj["freeSpaceOnly"].trueValue();
+
             repl::ReplicationCoordinator* replCoord = repl::getGlobalReplicationCoordinator();
-            if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue()) {
+            if (replCoord->getMemberState().primary() && !cmdObj["force"].trueValue() &&
+                    !freeSpaceOnly) {
                 errmsg = "will not run compact on an active replica set primary as this is a slow blocking operation. use force:true to force";
                 return false;
             }
@@ -115,6 +124,7 @@ namespace mongo {
             }
 
             CompactOptions compactOptions;
+            compactOptions.freeSpaceOnly = freeSpaceOnly;
 
             if ( cmdObj["preservePadding"].trueValue() ) {
                 compactOptions.paddingMode = CompactOptions::PRESERVE;
@@ -147,6 +157,23 @@ namespace mongo {
             if ( cmdObj.hasElement("validate") )
                 compactOptions.validateDocuments = cmdObj["validate"].trueValue();
 
+            compactOptions.online = cmdObj["online"].trueValue();
+            if ( compactOptions.online ) {
+                if ( freeSpaceOnly || compactOptions.paddingMode != CompactOptions::NONE ) {
+                    errmsg = "cannot mix online with freeSpaceOnly or padding options";
+                    return false;
+                }
+                if ( cmdObj.hasElement("batchSize") ) {
+                    compactOptions.batchSize = cmdObj["batchSize"].numberInt();
+                    if ( compactOptions.batchSize < 1 ||
+                         compactOptions.batchSize > 100 * 1000 ) {
+                        errmsg = "invalid batch size";
+                        return false;
+                    }
+                }
+                return runOnline( txn, ns, compactOptions, errmsg, result );
+            }
+
 
             ScopedTransaction transaction(txn, MODE_IX);
             AutoGetDb autoDb(txn, db, MODE_X);
@@ -178,12 +205,157 @@ namespace mongo {
             if ( status.getValue().corruptDocuments > 0 )
                 result.append("invalidObjects", status.getValue().corruptDocuments );
 
+            if ( freeSpaceOnly )
+                result.appendNumber("freeRecordsMerged", status.getValue().freeRecordsMerged );
+
             log() << "compact " << ns << " end";
 
             IndexBuilder::restoreIndexes(txn, indexesInProg);
 
             return true;
         }
+
+    private:
+        /**
+         * Compacts 'ns' while only holding intent locks, so that the rest of the database, and
+         * on record stores with document level locking the collection too, stay writable.
+         * Record stores which don't compact in place have their documents moved into new space
+         * a batch at a time, each batch in its own WriteUnitOfWork, and the lock is yielded
+         * in between.
+         */
+        bool runOnline(OperationContext* txn,
+                       const NamespaceString& ns,
+                       const CompactOptions& compactOptions,
+                       string& errmsg,
+                       BSONObjBuilder& result) {
+            ScopedTransaction transaction(txn, MODE_IX);
+            AutoGetDb autoDb(txn, ns.db(), MODE_IX);
+            Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IX);
+            Database* const collDB = autoDb.getDb();
+            Collection* collection = collDB ? collDB->getCollection(ns) : NULL;
+            if ( !collection ) {
+                errmsg = "namespace does not exist";
+                return false;
+            }
+
+            if ( collection->isCapped() ) {
+                errmsg = "cannot compact a capped collection";
+                return false;
+            }
+
+            RecordStore* recordStore = collection->getRecordStore();
+            if ( !recordStore->compactSupported() ) {
+                errmsg = str::stream() << "cannot compact collection with record store: "
+                                       << recordStore->name();
+                return false;
+            }
+
+            // Index builds and drops of the collection must wait until we are done.
+            BackgroundOperation::assertNoBgOpInProgForNs(ns.ns());
+            if ( collection->getIndexCatalog()->numIndexesInProgress(txn) ) {
+                errmsg = "cannot compact when indexes in progress";
+                return false;
+            }
+            BackgroundOperation backgroundOp(ns.ns());
+
+            log() << "compact " << ns << " begin online, options: " << compactOptions.toString();
+
+            const long long storageSizeBefore = recordStore->storageSize(txn);
+            CompactStats stats;
+            if ( recordStore->compactsInPlace() ) {
+                StatusWith<CompactStats> status = collection->compact(txn, &compactOptions);
+                if ( !status.isOK() )
+                    return appendCommandStatus(result, status.getStatus());
+                stats = status.getValue();
+            }
+            else {
+                Status status = moveRecords(txn, collection, compactOptions, &stats);
+                if ( !status.isOK() )
+                    return appendCommandStatus(result, status);
+                collection = collDB->getCollection(ns);
+                recordStore = collection->getRecordStore();
+            }
+            const long long storageSizeAfter = recordStore->storageSize(txn);
+
+            if ( stats.corruptDocuments > 0 )
+                result.append("invalidObjects", stats.corruptDocuments);
+            result.appendNumber("recordsMoved", stats.recordsMoved);
+            result.appendNumber("bytesMoved", stats.bytesMoved);
+            result.appendNumber("reclaimedBytes",
+                                std::max(0LL, storageSizeBefore - storageSizeAfter));
+
+            log() << "compact " << ns << " end online: moved " << stats.recordsMoved
+                  << " records, storage size " << storageSizeBefore << " -> " << storageSizeAfter;
+            return true;
+        }
+
+        /**
+         * Moves every record of 'collection' there was when it started, in batches of
+         * compactOptions.batchSize.  The scan yields its locks as usual between the batches.
+         */
+        Status moveRecords(OperationContext* txn,
+                           Collection* collection,
+                           const CompactOptions& compactOptions,
+                           CompactStats* stats) {
+            const string ns = collection->ns().ns();
+
+            // Moved records may be found again further along, so stop after as many as there
+            // were to begin with.
+            const long long numRecords = collection->numRecords(txn);
+            ProgressMeterHolder progress(*txn->setMessage("compact",
+                                                          "Compact: " + ns + " records moved",
+                                                          numRecords,
+                                                          10));
+
+            std::auto_ptr<PlanExecutor> exec(
+                InternalPlanner::collectionScan(txn, ns, collection));
+            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+            long long numScanned = 0;
+            std::vector<RecordId> batch;
+            PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+            while ( PlanExecutor::ADVANCED == state && numScanned < numRecords ) {
+                batch.clear();
+                RecordId loc;
+                while ( static_cast<int>(batch.size()) < compactOptions.batchSize &&
+                        numScanned < numRecords &&
+                        PlanExecutor::ADVANCED == (state = exec->getNext(NULL, &loc)) ) {
+                    batch.push_back(loc);
+                    numScanned++;
+                }
+
+                if ( PlanExecutor::DEAD == state || PlanExecutor::FAILURE == state ) {
+                    return Status(ErrorCodes::OperationFailed,
+                                  str::stream() << "collection scan stopped during online "
+                                                << "compact of " << ns);
+                }
+
+                // The collection can't go away while the background operation is registered.
+                invariant(exec->collection() == collection);
+
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                    CompactStats batchStats;
+                    WriteUnitOfWork wunit(txn);
+                    for ( size_t i = 0; i < batch.size(); i++ ) {
+                        Status status =
+                            collection->relocateRecord(txn, batch[i], &compactOptions,
+                                                       &batchStats);
+                        if ( !status.isOK() )
+                            return status;
+                    }
+                    wunit.commit();
+
+                    stats->recordsMoved += batchStats.recordsMoved;
+                    stats->bytesMoved += batchStats.bytesMoved;
+                    stats->corruptDocuments += batchStats.corruptDocuments;
+                } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "compact", ns);
+
+                progress.hit(batch.size());
+                txn->checkForInterrupt();
+            }
+
+            return Status::OK();
+        }
     };
     static CompactCmd compactCmd;
 
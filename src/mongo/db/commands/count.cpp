@@ -158,6 +158,9 @@ namespace mongo {
                 static_cast<const CountStats*>(countStage->getSpecificStats());
 
             result.appendNumber("n", countStats->nCounted);
+            if (countStats->approximate) {
+                result.appendBool("approximate", true);
+            }
             return true;
         }
 
@@ -196,6 +199,14 @@ namespace mongo {
                 limit = -limit;
             }
 
+            bool approximate = false;
+            if (cmdObj["approximate"].isBoolean()) {
+                approximate = cmdObj["approximate"].boolean();
+            }
+            else if (cmdObj["approximate"].ok()) {
+                return Status(ErrorCodes::BadValue, "approximate value is not a boolean");
+            }
+
             // We don't validate that "query" is a nested object due to SERVER-15456.
             BSONObj query = cmdObj.getObjectField("query");
 
@@ -220,6 +231,7 @@ namespace mongo {
             request->hint = hintObj;
             request->limit = limit;
             request->skip = skip;
+            request->approximate = approximate;
 
             // By default, count requests are regular count not explain of count.
             request->explain = false;
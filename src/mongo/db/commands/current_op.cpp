@@ -30,7 +30,11 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <string>
+#include <vector>
 
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -43,11 +47,127 @@
 #include "mongo/db/matcher/matcher.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/fill_locker_info.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+    // When positive, currentOp reports from a snapshot of every operation taken at most this many
+    // milliseconds earlier, instead of locking every client for each request. One request takes
+    // a new snapshot once the last one is too old, while the others keep using the last one.
+    MONGO_EXPORT_SERVER_PARAMETER(currentOpSnapshotMillis, int, 0);
+
+namespace {
+
+    struct OpSnapshot {
+        BSONObj info;
+        bool active;
+    };
+
+    struct CurrentOpSnapshot {
+        std::vector<OpSnapshot> ops;
+        Date_t takenAt;
+    };
+
+    // Protects latestSnapshot, which is only replaced, never modified.
+    boost::mutex snapshotMutex;
+    boost::shared_ptr<const CurrentOpSnapshot> latestSnapshot;
+
+    // Held by the request taking a new snapshot.
+    boost::mutex snapshotRefreshMutex;
+
+    /**
+     * Reports the state of 'client' and of its operation, if any. Sets '*active' to whether it
+     * is running an operation. The client must be locked.
+     */
+    BSONObj reportClientState(Client* client, bool* active) {
+        const OperationContext* opCtx = client->getOperationContext();
+        *active = opCtx && opCtx->getCurOp() && opCtx->getCurOp()->active();
+
+        BSONObjBuilder infoBuilder;
+
+        // The client information
+        client->reportState(infoBuilder);
+
+        // Operation context specific information
+        if (opCtx) {
+            // CurOp
+            if (opCtx->getCurOp()) {
+                opCtx->getCurOp()->reportState(&infoBuilder);
+            }
+
+            // LockState
+            Locker::LockerInfo lockerInfo;
+            client->getOperationContext()->lockState()->getLockerInfo(&lockerInfo);
+            fillLockerInfo(lockerInfo, infoBuilder);
+        }
+        else {
+            // If no operation context, mark the operation as inactive
+            infoBuilder.append("active", false);
+        }
+
+        return infoBuilder.obj();
+    }
+
+    boost::shared_ptr<const CurrentOpSnapshot> takeSnapshot(ServiceContext* serviceContext) {
+        boost::shared_ptr<CurrentOpSnapshot> snapshot(new CurrentOpSnapshot());
+        for (ServiceContext::LockedClientsCursor cursor(serviceContext);
+             Client* client = cursor.next();) {
+
+            invariant(client);
+
+            boost::unique_lock<Client> uniqueLock(*client);
+            OpSnapshot op;
+            op.info = reportClientState(client, &op.active);
+            snapshot->ops.push_back(op);
+        }
+        snapshot->takenAt = jsTime();
+        return snapshot;
+    }
+
+    /**
+     * Returns a snapshot taken at most 'maxAgeMillis' earlier, unless another request is taking
+     * a new one, in which case the last one is returned instead of waiting.
+     */
+    boost::shared_ptr<const CurrentOpSnapshot> getSnapshot(ServiceContext* serviceContext,
+                                                           int maxAgeMillis) {
+        boost::shared_ptr<const CurrentOpSnapshot> snapshot;
+        {
+            boost::lock_guard<boost::mutex> lk(snapshotMutex);
+            snapshot = latestSnapshot;
+        }
+        if (snapshot && jsTime().millis < snapshot->takenAt.millis + maxAgeMillis) {
+            return snapshot;
+        }
+
+        boost::unique_lock<boost::mutex> refreshLock(snapshotRefreshMutex, boost::try_to_lock);
+        if (!refreshLock.owns_lock()) {
+            if (snapshot) {
+                return snapshot;
+            }
+            // There's nothing to report yet, so wait for the first snapshot.
+            refreshLock.lock();
+        }
+
+        {
+            // Another request may have taken one while we waited.
+            boost::lock_guard<boost::mutex> lk(snapshotMutex);
+            if (latestSnapshot != snapshot) {
+                return latestSnapshot;
+            }
+        }
+
+        snapshot = takeSnapshot(serviceContext);
+
+        boost::lock_guard<boost::mutex> lk(snapshotMutex);
+        latestSnapshot = snapshot;
+        return snapshot;
+    }
+
+} // namespace
+
     class CurrentOpCommand : public Command {
     public:
 
@@ -99,56 +219,50 @@ namespace mongo {
             const WhereCallbackReal whereCallback(txn, db);
             const Matcher matcher(filter, whereCallback);
 
-            BSONArrayBuilder inprogBuilder(result.subarrayStart("inprog"));
-
-            for (ServiceContext::LockedClientsCursor cursor(txn->getClient()->getServiceContext());
-                 Client* client = cursor.next();) {
+            ServiceContext* serviceContext = txn->getClient()->getServiceContext();
+            const int snapshotMillis = currentOpSnapshotMillis;
 
-                invariant(client);
-
-                boost::unique_lock<Client> uniqueLock(*client);
-                const OperationContext* opCtx = client->getOperationContext();
+            BSONArrayBuilder inprogBuilder(result.subarrayStart("inprog"));
 
-                if (!includeAll) {
-                    // Skip over inactive connections.
-                    if (!opCtx || !opCtx->getCurOp() || !opCtx->getCurOp()->active()) {
-                        continue;
+            if (snapshotMillis > 0) {
+                // Filtered without holding any lock, and without copying the operations left out.
+                boost::shared_ptr<const CurrentOpSnapshot> snapshot =
+                    getSnapshot(serviceContext, snapshotMillis);
+                for (size_t i = 0; i < snapshot->ops.size(); ++i) {
+                    const OpSnapshot& op = snapshot->ops[i];
+                    if (includeAll || (op.active && matcher.matches(op.info))) {
+                        inprogBuilder.append(op.info);
                     }
                 }
+                inprogBuilder.done();
+                result.append("snapshotTime", snapshot->takenAt);
+            }
+            else {
+                for (ServiceContext::LockedClientsCursor cursor(serviceContext);
+                     Client* client = cursor.next();) {
 
-                BSONObjBuilder infoBuilder;
+                    invariant(client);
 
-                // The client information
-                client->reportState(infoBuilder);
+                    boost::unique_lock<Client> uniqueLock(*client);
+                    const OperationContext* opCtx = client->getOperationContext();
 
-                // Operation context specific information
-                if (opCtx) {
-                    // CurOp
-                    if (opCtx->getCurOp()) {
-                        opCtx->getCurOp()->reportState(&infoBuilder);
+                    if (!includeAll) {
+                        // Skip over inactive connections.
+                        if (!opCtx || !opCtx->getCurOp() || !opCtx->getCurOp()->active()) {
+                            continue;
+                        }
                     }
 
-                    // LockState
-                    Locker::LockerInfo lockerInfo;
-                    client->getOperationContext()->lockState()->getLockerInfo(&lockerInfo);
-                    fillLockerInfo(lockerInfo, infoBuilder);
-                }
-                else {
-                    // If no operation context, mark the operation as inactive
-                    infoBuilder.append("active", false);
-                }
-
-                infoBuilder.done();
-
-                const BSONObj info = infoBuilder.obj();
+                    bool active;
+                    const BSONObj info = reportClientState(client, &active);
 
-                if (includeAll || matcher.matches(info)) {
-                    inprogBuilder.append(info);
+                    if (includeAll || matcher.matches(info)) {
+                        inprogBuilder.append(info);
+                    }
                 }
+                inprogBuilder.done();
             }
 
-            inprogBuilder.done();
-
             if (lockedForWriting()) {
                 result.append("fsyncLock", true);
                 result.append("info",
@@ -34,15 +34,20 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_catalog_entry.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/md5.hpp"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -57,6 +62,74 @@ namespace mongo {
 
     DBHashCmd dbhashCmd;
 
+    // The most threads a dbHash command may hash collections on.
+    MONGO_EXPORT_SERVER_PARAMETER(dbHashMaxParallelism, int, 16);
+
+namespace {
+
+    // How many documents are hashed between checks for pacing.
+    const int kDocsPerPacingCheck = 128;
+
+}  // namespace
+
+    /**
+     * Paces the reads of all threads of one dbHash command to a number of megabytes per second.
+     */
+    class DBHashCmd::RateLimiter {
+    public:
+        explicit RateLimiter(int maxMBPerSecond)
+            : _maxMBPerSecond(maxMBPerSecond),
+              _nextMicros(0) { }
+
+        /**
+         * Accounts for 'numBytes' read and sleeps for as long as it takes to stay within the rate.
+         */
+        void pace(long long numBytes) {
+            if (_maxMBPerSecond <= 0 || numBytes <= 0)
+                return;
+
+            unsigned long long startMicros;
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                const unsigned long long now = curTimeMicros64();
+                startMicros = std::max(now, _nextMicros);
+                _nextMicros = startMicros + numBytes * 1000 * 1000 /
+                                            (_maxMBPerSecond * 1024LL * 1024);
+            }
+
+            const unsigned long long now = curTimeMicros64();
+            if (startMicros > now) {
+                sleepmicros(startMicros - now);
+            }
+        }
+
+    private:
+        const int _maxMBPerSecond;
+
+        boost::mutex _mutex;
+
+        // When the reads accounted for so far are allowed to have happened.
+        unsigned long long _nextMicros;
+    };
+
+    /**
+     * The hash of one collection, as it is filled in by a worker.
+     */
+    struct DBHashCmd::CollectionHash {
+        CollectionHash(const std::string& fullName, const std::string& shortName)
+            : fullName(fullName),
+              shortName(shortName),
+              fromCache(false) { }
+
+        std::string fullName;
+        std::string shortName;
+        std::string hash;
+        bool fromCache;
+
+        // Set instead of 'hash' if hashing failed.
+        std::string error;
+    };
+
 
     void logOpForDbHash(OperationContext* txn, const char* ns) {
         dbhashCmd.wipeCacheForCollection(txn, ns);
@@ -78,7 +151,8 @@ namespace mongo {
     std::string DBHashCmd::hashCollection(OperationContext* opCtx,
                                           Database* db,
                                           const std::string& fullCollectionName,
-                                          bool* fromCache) {
+                                          bool* fromCache,
+                                          RateLimiter* limiter) {
         boost::unique_lock<boost::mutex> cachedHashedLock(_cachedHashedMutex, boost::defer_lock);
 
         if ( isCachable( fullCollectionName ) ) {
@@ -122,12 +196,19 @@ namespace mongo {
         md5_init(&st);
 
         long long n = 0;
+        long long unpacedBytes = 0;
         PlanExecutor::ExecState state;
         BSONObj c;
         verify(NULL != exec.get());
         while (PlanExecutor::ADVANCED == (state = exec->getNext(&c, NULL))) {
             md5_append( &st , (const md5_byte_t*)c.objdata() , c.objsize() );
             n++;
+
+            unpacedBytes += c.objsize();
+            if (limiter && n % kDocsPerPacingCheck == 0) {
+                limiter->pace(unpacedBytes);
+                unpacedBytes = 0;
+            }
         }
         if (PlanExecutor::IS_EOF != state) {
             warning() << "error while hashing, db dropped? ns=" << fullCollectionName << endl;
@@ -143,6 +224,33 @@ namespace mongo {
         return hash;
     }
 
+    void DBHashCmd::hashCollectionOnWorker(const std::string& dbname,
+                                           CollectionHash* collectionHash,
+                                           RateLimiter* limiter) {
+        Client::initThreadIfNotAlready();
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+        OperationContextImpl txn;
+        try {
+            // Only this collection is locked in S-mode, so that its hash is of a single
+            // snapshot.
+            ScopedTransaction scopedXact(&txn, MODE_IS);
+            AutoGetDb autoDb(&txn, dbname, MODE_IS);
+            Lock::CollectionLock collLock(txn.lockState(), collectionHash->fullName, MODE_S);
+            Database* db = autoDb.getDb();
+            if (db) {
+                collectionHash->hash = hashCollection(&txn,
+                                                      db,
+                                                      collectionHash->fullName,
+                                                      &collectionHash->fromCache,
+                                                      limiter);
+            }
+        }
+        catch (const DBException& ex) {
+            collectionHash->error = ex.toString();
+        }
+    }
+
     bool DBHashCmd::run(OperationContext* txn,
                         const string& dbname,
                         BSONObj& cmdObj,
@@ -164,17 +272,74 @@ namespace mongo {
             }
         }
 
+        // With more than one thread, each collection is hashed from its own snapshot, instead of
+        // all of them from a snapshot of the whole database.
+        int parallel = 1;
+        if ( cmdObj["parallel"].isNumber() ) {
+            parallel = std::max(1, std::min(cmdObj["parallel"].numberInt(),
+                                            static_cast<int>(dbHashMaxParallelism)));
+        }
+
+        boost::scoped_ptr<RateLimiter> limiter;
+        if ( cmdObj["maxMBPerSecond"].isNumber() && cmdObj["maxMBPerSecond"].numberInt() > 0 ) {
+            limiter.reset(new RateLimiter(cmdObj["maxMBPerSecond"].numberInt()));
+        }
+
         list<string> colls;
+        vector<CollectionHash> hashes;
         const string ns = parseNs(dbname, cmdObj);
+        {
+            // We lock the entire database in S-mode in order to ensure that the contents will not
+            // change for the snapshot.
+            ScopedTransaction scopedXact(txn, MODE_IS);
+            AutoGetDb autoDb(txn, ns, MODE_S);
+            Database* db = autoDb.getDb();
+            if (db) {
+                db->getDatabaseCatalogEntry()->getCollectionNamespaces(&colls);
+                colls.sort();
+            }
+
+            for ( list<string>::iterator i=colls.begin(); i != colls.end(); i++ ) {
+                string fullCollectionName = *i;
+                if ( fullCollectionName.size() -1 <= dbname.size() ) {
+                    errmsg  = str::stream() << "weird fullCollectionName ["
+                                            << fullCollectionName << "]";
+                    return false;
+                }
+                string shortCollectionName = fullCollectionName.substr( dbname.size() + 1 );
+
+                if ( shortCollectionName.find( "system." ) == 0 )
+                    continue;
 
-        // We lock the entire database in S-mode in order to ensure that the contents will not
-        // change for the snapshot.
-        ScopedTransaction scopedXact(txn, MODE_IS);
-        AutoGetDb autoDb(txn, ns, MODE_S);
-        Database* db = autoDb.getDb();
-        if (db) {
-            db->getDatabaseCatalogEntry()->getCollectionNamespaces(&colls);
-            colls.sort();
+                if ( desiredCollections.size() > 0 &&
+                     desiredCollections.count( shortCollectionName ) == 0 )
+                    continue;
+
+                hashes.push_back( CollectionHash( fullCollectionName, shortCollectionName ) );
+            }
+
+            if ( parallel == 1 ) {
+                for ( size_t i = 0; i < hashes.size(); i++ ) {
+                    hashes[i].hash = hashCollection( txn,
+                                                     db,
+                                                     hashes[i].fullName,
+                                                     &hashes[i].fromCache,
+                                                     limiter.get() );
+                }
+            }
+        }
+
+        if ( parallel > 1 && !hashes.empty() ) {
+            ThreadPool workers( std::min( parallel, static_cast<int>( hashes.size() ) ),
+                                "DBHashWorker" );
+            for ( size_t i = 0; i < hashes.size(); i++ ) {
+                workers.schedule( &DBHashCmd::hashCollectionOnWorker,
+                                  this,
+                                  dbname,
+                                  &hashes[i],
+                                  limiter.get() );
+            }
+            workers.join();
         }
 
         result.appendNumber( "numCollections" , (long long)colls.size() );
@@ -186,29 +351,20 @@ namespace mongo {
         vector<string> cached;
 
         BSONObjBuilder bb( result.subobjStart( "collections" ) );
-        for ( list<string>::iterator i=colls.begin(); i != colls.end(); i++ ) {
-            string fullCollectionName = *i;
-            if ( fullCollectionName.size() -1 <= dbname.size() ) {
-                errmsg  = str::stream() << "weird fullCollectionName [" << fullCollectionName << "]";
+        for ( size_t i = 0; i < hashes.size(); i++ ) {
+            const CollectionHash& collectionHash = hashes[i];
+            if ( !collectionHash.error.empty() ) {
+                errmsg = str::stream() << "error hashing " << collectionHash.fullName << ": "
+                                       << collectionHash.error;
                 return false;
             }
-            string shortCollectionName = fullCollectionName.substr( dbname.size() + 1 );
-
-            if ( shortCollectionName.find( "system." ) == 0 )
-                continue;
-
-            if ( desiredCollections.size() > 0 &&
-                 desiredCollections.count( shortCollectionName ) == 0 )
-                continue;
-
-            bool fromCache = false;
-            string hash = hashCollection( txn, db, fullCollectionName, &fromCache );
 
-            bb.append( shortCollectionName, hash );
+            const string& hash = collectionHash.hash;
+            bb.append( collectionHash.shortName, hash );
 
             md5_append( &globalState , (const md5_byte_t*)hash.c_str() , hash.size() );
-            if ( fromCache )
-                cached.push_back( fullCollectionName );
+            if ( collectionHash.fromCache )
+                cached.push_back( collectionHash.fullName );
         }
         bb.done();
 
@@ -220,6 +376,7 @@ namespace mongo {
         result.appendNumber( "timeMillis", timer.millis() );
 
         result.append( "fromCache", cached );
+        result.append( "parallel", parallel );
 
         return 1;
     }
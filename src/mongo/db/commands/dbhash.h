@@ -62,9 +62,28 @@ namespace mongo {
          */
         class DBHashLogOpHandler;
 
+        class RateLimiter;
+        struct CollectionHash;
+
         bool isCachable( StringData ns ) const;
 
-        std::string hashCollection( OperationContext* opCtx, Database* db, const std::string& fullCollectionName, bool* fromCache );
+        /**
+         * Hashes the documents of 'fullCollectionName' in _id order.  If 'limiter' isn't NULL,
+         * paces the reads with it.
+         */
+        std::string hashCollection( OperationContext* opCtx,
+                                    Database* db,
+                                    const std::string& fullCollectionName,
+                                    bool* fromCache,
+                                    RateLimiter* limiter );
+
+        /**
+         * Hashes the collection of 'collectionHash' on a worker thread, under its own collection
+         * lock.
+         */
+        void hashCollectionOnWorker( const std::string& dbname,
+                                     CollectionHash* collectionHash,
+                                     RateLimiter* limiter );
 
         std::map<std::string,std::string> _cachedHashed;
         mutex _cachedHashedMutex;
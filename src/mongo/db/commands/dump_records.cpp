@@ -0,0 +1,249 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/cursor_manager.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/multi_iterator.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/find.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+
+namespace {
+
+    const int kDefaultBatchBytes = 4 * 1024 * 1024;
+
+    // The records of a batch travel in one BinData field, so the reply stays a valid BSONObj.
+    const int kMaxBatchBytes = BSONObjMaxUserSize;
+
+    /**
+     * Registers a cursor over the records of 'collection' in storage order, starting at 'start'
+     * if it is set. The caller must hold the collection lock.
+     */
+    ClientCursor* makeDumpCursor(OperationContext* txn,
+                                 Collection* collection,
+                                 const NamespaceString& nss,
+                                 const RecordId& start) {
+        std::auto_ptr<WorkingSet> ws(new WorkingSet());
+        std::auto_ptr<MultiIteratorStage> stage(new MultiIteratorStage(txn, ws.get(),
+                                                                       collection));
+        stage->addIterator(collection->getIterator(txn, start));
+
+        // Each batch runs under a single collection lock and storage snapshot; the iterator is
+        // only saved and restored between batches.
+        PlanExecutor* rawExec;
+        Status execStatus = PlanExecutor::make(txn,
+                                               ws.release(),
+                                               stage.release(),
+                                               collection,
+                                               PlanExecutor::YIELD_MANUAL,
+                                               &rawExec);
+        invariant(execStatus.isOK());
+        std::auto_ptr<PlanExecutor> exec(rawExec);
+        exec->saveState();
+
+        // ClientCursors' constructor inserts them into a global map that manages their
+        // lifetimes. That is why the next line isn't leaky.
+        return new ClientCursor(collection->getCursorManager(), exec.release(), nss.ns());
+    }
+
+} // namespace
+
+    /**
+     * Streams the raw records of a collection, in storage order, for backup tools. Records are
+     * returned as BSON documents concatenated into one BinData field per batch, optionally
+     * snappy-compressed, instead of going through the query and projection machinery.
+     */
+    class DumpRecordsCmd : public Command {
+    public:
+        DumpRecordsCmd() : Command("dumpRecords") { }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool slaveOk() const { return true; }
+        virtual void help(stringstream& help) const {
+            help << "returns the records of a collection in storage order, in large batches\n"
+                    "{ dumpRecords : <collection_name>, [cursorId : <id>],\n"
+                    "  [batchBytes : <bytes>], [compress : <bool>] }\n"
+                    " without cursorId a new dump is started; pass the returned cursorId\n"
+                    " to get the next batch, until it is 0";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::find);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            const NamespaceString nss(parseNsCollectionRequired(dbname, cmdObj));
+            if (!nss.isValid()) {
+                errmsg = "bad namespace name";
+                return false;
+            }
+
+            int batchBytes = kDefaultBatchBytes;
+            const BSONElement batchBytesElem = cmdObj["batchBytes"];
+            if (!batchBytesElem.eoo()) {
+                if (!batchBytesElem.isNumber() ||
+                    batchBytesElem.numberLong() <= 0 ||
+                    batchBytesElem.numberLong() > kMaxBatchBytes) {
+                    return appendCommandStatus(result, Status(ErrorCodes::BadValue, str::stream()
+                        << "batchBytes must be a number between 1 and " << kMaxBatchBytes));
+                }
+                batchBytes = batchBytesElem.numberInt();
+            }
+
+            const bool compressRecords = cmdObj["compress"].trueValue();
+
+            const BSONElement cursorIdElem = cmdObj["cursorId"];
+            if (!cursorIdElem.eoo() && cursorIdElem.type() != NumberLong) {
+                return appendCommandStatus(result, Status(ErrorCodes::TypeMismatch,
+                                                          "cursorId must be a NumberLong"));
+            }
+
+            // The pin must be released while the collection is still locked.
+            AutoGetCollectionForRead ctx(txn, nss.ns());
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return appendCommandStatus(result, Status(ErrorCodes::NamespaceNotFound,
+                                                          "ns does not exist: " + nss.ns()));
+            }
+
+            const CursorId cursorId = cursorIdElem.eoo()
+                ? makeDumpCursor(txn, collection, nss, RecordId())->cursorid()
+                : cursorIdElem.numberLong();
+
+            ClientCursorPin ccPin(collection->getCursorManager(), cursorId);
+            ClientCursor* cursor = ccPin.c();
+            if (!cursor) {
+                return appendCommandStatus(result, Status(ErrorCodes::CursorNotFound, str::stream()
+                    << "Cursor not found, cursor id: " << cursorId));
+            }
+            if (cursor->ns() != nss.ns()) {
+                return appendCommandStatus(result, Status(ErrorCodes::Unauthorized, str::stream()
+                    << "Requested dumpRecords on namespace '" << nss.ns()
+                    << "', but cursor belongs to a different namespace"));
+            }
+
+            // Unless dismissed, the cursor goes away with this batch.
+            ScopeGuard cursorFreer = MakeGuard(&ClientCursorPin::deleteUnderlying, ccPin);
+
+            if (!cursor->hasRecoveryUnit()) {
+                cursor->setOwnedRecoveryUnit(
+                    getGlobalServiceContext()->getGlobalStorageEngine()->newRecoveryUnit());
+            }
+            ScopedRecoveryUnitSwapper ruSwapper(cursor, txn);
+            cursor->setIdleTime(0);
+
+            PlanExecutor* exec = cursor->getExecutor();
+            exec->restoreState(txn);
+
+            BufBuilder records(std::min(batchBytes, kDefaultBatchBytes) + 64 * 1024);
+            int numRecords = 0;
+            CursorId nextCursorId = 0;
+            BSONObj obj;
+            RecordId loc;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, &loc))) {
+                if (numRecords > 0 && records.len() + obj.objsize() > kMaxBatchBytes) {
+                    // The executor can't take the record back, so the dump continues from it on
+                    // a new cursor, which replaces this one.
+                    nextCursorId = makeDumpCursor(txn, collection, nss, loc)->cursorid();
+                    break;
+                }
+
+                records.appendBuf(obj.objdata(), obj.objsize());
+                numRecords++;
+
+                if (records.len() >= batchBytes) {
+                    break;
+                }
+            }
+
+            if (PlanExecutor::FAILURE == state) {
+                return appendCommandStatus(result, Status(ErrorCodes::OperationFailed,
+                    str::stream() << "dumpRecords executor error: "
+                                  << WorkingSetCommon::toStatusString(obj)));
+            }
+
+            if (PlanExecutor::ADVANCED == state && !nextCursorId) {
+                exec->saveState();
+                cursor->incPos(numRecords);
+                cursorFreer.Dismiss();
+                nextCursorId = cursorId;
+            }
+
+            result.append("cursorId", static_cast<long long>(nextCursorId));
+            result.append("ns", nss.ns());
+            result.append("numRecords", numRecords);
+
+            // Data which doesn't compress is sent as is, which also keeps the reply in bounds.
+            std::string compressed;
+            if (compressRecords) {
+                compress(records.buf(), records.len(), &compressed);
+            }
+            if (compressRecords && static_cast<int>(compressed.size()) < records.len()) {
+                result.append("compressed", true);
+                result.append("uncompressedBytes", records.len());
+                result.appendBinData("records", compressed.size(), BinDataGeneral,
+                                     compressed.data());
+            }
+            else {
+                result.append("compressed", false);
+                result.appendBinData("records", records.len(), BinDataGeneral, records.buf());
+            }
+            return true;
+        }
+
+    } dumpRecordsCmd;
+
+} // namespace mongo
@@ -46,8 +46,10 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/s/d_chunk_heat.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/util/log.h"
@@ -293,6 +295,12 @@ namespace mongo {
             invariant(!execHolder);
             PlanExecutor* exec = cursor->getExecutor();
 
+            // Results are copied into the batch before the next one is asked for, both here and in
+            // the getMore command.
+            if (internalQueryFindPinnedRecords) {
+                exec->returnPinnedRecords();
+            }
+
             // 5) Stream query results, adding them to a BSONArray as we go.
             //
             // TODO: Handle result sets larger than 16MB.
@@ -303,6 +311,7 @@ namespace mongo {
             while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
                 // Add result to output buffer.
                 firstBatch.append(obj);
+                chunkHeatTracker.noteRead(nss.ns(), obj);
                 numResults++;
 
                 if (enoughForFirstBatch(pq, numResults, firstBatch.len())) {
@@ -333,7 +342,7 @@ namespace mongo {
                 if (!(pq.isTailable() && state == PlanExecutor::IS_EOF)) {
                     // We stash away the RecoveryUnit in the ClientCursor. It's used for
                     // subsequent getMore requests. The calling OpCtx gets a fresh RecoveryUnit.
-                    txn->recoveryUnit()->commitAndRestart();
+                    txn->recoveryUnit()->endCursorBatch();
                     cursor->setOwnedRecoveryUnit(txn->releaseRecoveryUnit());
                     StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
                     txn->setRecoveryUnit(engine->newRecoveryUnit());
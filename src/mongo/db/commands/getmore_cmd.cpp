@@ -46,6 +46,7 @@
 #include "mongo/db/query/find.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/s/d_chunk_heat.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -213,6 +214,7 @@ namespace mongo {
             while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
                 // Add result to output buffer.
                 nextBatch.append(obj);
+                chunkHeatTracker.noteRead(request.nss.ns(), obj);
                 numResults++;
 
                 if (enoughForGetMore(request.batchSize, numResults, nextBatch.len())) {
@@ -65,6 +65,7 @@ namespace mongo {
 
         /* CmdObj has the form {"hash" : <thingToHash>}
          * or {"hash" : <thingToHash>, "seed" : <number> }
+         * and may also have a "hashVersion" : <number> field, defaulting to 0.
          * Result has the form
          * {"key" : <thingTohash>, "seed" : <int>, "out": NumberLong(<hash>)}
          *
@@ -91,7 +92,17 @@ namespace mongo {
             }
             result.append( "seed" , seed );
 
-            result.append( "out" , BSONElementHasher::hash64( cmdObj.firstElement() , seed ) );
+            int hashVersion = BSONElementHasher::HASH_VERSION_MD5;
+            if (cmdObj.hasField("hashVersion")){
+                hashVersion = cmdObj["hashVersion"].numberInt();
+                if (!BSONElementHasher::isValidHashVersion(hashVersion)) {
+                    errmsg += "unknown hashVersion";
+                    return false;
+                }
+            }
+
+            result.append( "out" ,
+                           BSONElementHasher::hash64( cmdObj.firstElement() , seed , hashVersion ) );
             return true;
         }
     };
@@ -45,6 +45,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/matcher/matcher.h"
@@ -82,6 +83,24 @@ namespace mongo {
 
         AtomicUInt32 Config::JOB_NUMBER;
 
+    namespace {
+
+        /**
+         * Orders spilled tuples by key, the same way TupleKeyCmp orders the in memory map.
+         */
+        class SpillComparator {
+        public:
+            int operator()( const BSONObj& l , const BSONObj& r ) const {
+                return l.firstElement().woCompare( r.firstElement() );
+            }
+
+            int operator()( const SpillSorter::Data& l , const SpillSorter::Data& r ) const {
+                return (*this)( l.first , r.first );
+            }
+        };
+
+    } // namespace
+
         JSFunction::JSFunction( const std::string& type , const BSONElement& e ) {
             _type = type;
             _code = e._asCode();
@@ -295,7 +314,6 @@ namespace mongo {
                         << cmdObj.firstElement().String()
                         << "_"
                         << JOB_NUMBER.fetchAndAdd(1);
-                incLong = tempNamespace + "_inc";
             }
 
             {
@@ -344,26 +362,6 @@ namespace mongo {
             _db.dropCollection(_config.tempNamespace);
             // Always forget about temporary namespaces, so we don't cache lots of them
             ShardConnection::forgetNS( _config.tempNamespace );
-            if (_useIncremental) {
-                // We don't want to log the deletion of incLong as it isn't replicated. While
-                // harmless, this would lead to a scary looking warning on the secondaries.
-                bool shouldReplicateWrites = _txn->writesAreReplicated();
-                _txn->setReplicatedWrites(false);
-                ON_BLOCK_EXIT(&OperationContext::setReplicatedWrites, _txn, shouldReplicateWrites);
-
-                ScopedTransaction scopedXact(_txn, MODE_IX);
-                Lock::DBLock lk(_txn->lockState(),
-                                nsToDatabaseSubstring(_config.incLong),
-                                MODE_X);
-                if (Database* db = dbHolder().get(_txn, _config.incLong)) {
-                    WriteUnitOfWork wunit(_txn);
-                    db->dropCollection(_txn, _config.incLong);
-                    wunit.commit();
-                }
-
-                ShardConnection::forgetNS( _config.incLong );
-            }
-
         }
 
         /**
@@ -374,34 +372,6 @@ namespace mongo {
                 return;
 
             dropTempCollections();
-            if (_useIncremental) {
-                // Create the inc collection and make sure we have index on "0" key.
-                // Intentionally not replicating the inc collection to secondaries.
-                bool shouldReplicateWrites = _txn->writesAreReplicated();
-                _txn->setReplicatedWrites(false);
-                ON_BLOCK_EXIT(&OperationContext::setReplicatedWrites, _txn, shouldReplicateWrites);
-
-                OldClientWriteContext incCtx(_txn, _config.incLong);
-                WriteUnitOfWork wuow(_txn);
-                Collection* incColl = incCtx.getCollection();
-                invariant(!incColl);
-
-                CollectionOptions options;
-                options.setNoIdIndex();
-                options.temp = true;
-                incColl = incCtx.db()->createCollection(_txn, _config.incLong, options);
-                invariant(incColl);
-
-                BSONObj indexSpec = BSON( "key" << BSON( "0" << 1 ) << "ns" << _config.incLong
-                                          << "name" << "_temp_0" );
-                Status status = incColl->getIndexCatalog()->createIndexOnEmptyCollection(_txn,
-                                                                                         indexSpec);
-                if ( !status.isOK() ) {
-                    uasserted( 17305 , str::stream() << "createIndex failed for mr incLong ns: " <<
-                            _config.incLong << " err: " << status.code() );
-                }
-                wuow.commit();
-            }
 
             vector<BSONObj> indexesToInsert;
 
@@ -699,26 +669,28 @@ namespace mongo {
         }
 
         /**
-         * Insert doc into the inc collection. This should not be replicated.
+         * Spill tuple to the sorter, whose sorted output the final reduce reads.
          */
         void State::_insertToInc( BSONObj& o ) {
             verify( _onDisk );
 
-            OldClientWriteContext ctx(_txn,  _config.incLong );
-            WriteUnitOfWork wuow(_txn);
-            Collection* coll = getCollectionOrUassert(ctx.db(), _config.incLong);
-            bool shouldReplicateWrites = _txn->writesAreReplicated();
-            _txn->setReplicatedWrites(false);
-            ON_BLOCK_EXIT(&OperationContext::setReplicatedWrites, _txn, shouldReplicateWrites);
-            uassertStatusOK(coll->insertDocument(_txn, o, true, false).getStatus());
-            wuow.commit();
+            if ( ! _spilled ) {
+                SortOptions opts;
+                opts.maxMemoryUsageBytes = _config.maxInMemSize;
+                opts.extSortAllowed = true;
+                opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+                _spilled.reset( SpillSorter::make( opts , SpillComparator() ) );
+            }
+
+            _spilled->add( o , BSONObj() );
+            _numSpilled++;
         }
 
         State::State(OperationContext* txn, const Config& c) :
                 _config(c),
                 _db(txn),
-                _useIncremental(true),
                 _txn(txn),
+                _numSpilled(0),
                 _size(0),
                 _dupCount(0),
                 _numEmits(0) {
@@ -982,74 +954,30 @@ namespace mongo {
                 return;
             }
 
-            // use index on "0" to pull sorted data
+            // the spilled tuples come back sorted by key
             verify( _temp->size() == 0 );
-            BSONObj sortKey = BSON( "0" << 1 );
-
-            {
-                OldClientWriteContext incCtx(_txn, _config.incLong );
-                WriteUnitOfWork wuow(_txn);
-                Collection* incColl = getCollectionOrUassert(incCtx.db(), _config.incLong );
-
-                bool foundIndex = false;
-                IndexCatalog::IndexIterator ii =
-                    incColl->getIndexCatalog()->getIndexIterator( _txn, true );
-                // Iterate over incColl's indexes.
-                while ( ii.more() ) {
-                    IndexDescriptor* currIndex = ii.next();
-                    BSONObj x = currIndex->infoObj();
-                    if ( sortKey.woCompare( x["key"].embeddedObject() ) == 0 ) {
-                        foundIndex = true;
-                        break;
-                    }
-                }
-
-                verify( foundIndex );
-                wuow.commit();
-            }
-
-            scoped_ptr<AutoGetCollectionForRead> ctx(new AutoGetCollectionForRead(_txn, _config.incLong));
-
-            BSONObj prev;
-            BSONList all;
 
             verify(pm == op->setMessage("m/r: (3/3) final reduce to collection",
                                         "M/R: (3/3) Final Reduce Progress",
-                                        _db.count(_config.incLong, BSONObj(), QueryOption_SlaveOk)));
-
-            const NamespaceString nss(_config.incLong);
-            const WhereCallbackReal whereCallback(_txn, nss.db());
+                                        _numSpilled));
 
-            CanonicalQuery* cqRaw;
-            verify(CanonicalQuery::canonicalize(_config.incLong,
-                                                BSONObj(),
-                                                sortKey,
-                                                BSONObj(),
-                                                &cqRaw,
-                                                whereCallback).isOK());
-            std::auto_ptr<CanonicalQuery> cq(cqRaw);
-
-            Collection* coll = getCollectionOrUassert(ctx->getDb(), _config.incLong);
-            invariant(coll);
+            if ( ! _spilled ) {
+                pm.finished();
+                return;
+            }
 
-            PlanExecutor* rawExec;
-            verify(getExecutor(_txn,
-                               coll,
-                               cq.release(),
-                               PlanExecutor::YIELD_AUTO,
-                               &rawExec,
-                               QueryPlannerParams::NO_TABLE_SCAN).isOK());
+            scoped_ptr<SpillSorter::Iterator> it( _spilled->done() );
+            _spilled.reset();
 
-            scoped_ptr<PlanExecutor> exec(rawExec);
+            const SpillComparator cmp;
+            BSONList all;
 
             // iterate over all sorted objects
-            BSONObj o;
-            PlanExecutor::ExecState state;
-            while (PlanExecutor::ADVANCED == (state = exec->getNext(&o, NULL))) {
-                o = o.getOwned(); // we will be accessing outside of the lock
+            while ( it->more() ) {
+                BSONObj o = it->next().first.getOwned();
                 pm.hit();
 
-                if ( o.woSortOrder( prev , sortKey ) == 0 ) {
+                if ( ! all.empty() && cmp( all.front() , o ) == 0 ) {
                     // object is same as previous, add to array
                     all.push_back( o );
                     if ( pm->hits() % 100 == 0 ) {
@@ -1058,30 +986,17 @@ namespace mongo {
                     continue;
                 }
 
-                exec->saveState();
-
-                ctx.reset();
-
                 // reduce a finalize array
                 finalReduce( all );
 
-                ctx.reset(new AutoGetCollectionForRead(_txn, _config.incLong));
-
                 all.clear();
-                prev = o;
                 all.push_back( o );
 
-                if (!exec->restoreState(_txn)) {
-                    break;
-                }
-
                 _txn->checkForInterrupt();
             }
 
-            ctx.reset();
             // reduce and finalize last array
             finalReduce( all );
-            ctx.reset(new AutoGetCollectionForRead(_txn, _config.incLong));
 
             pm.finished();
         }
@@ -1583,10 +1498,6 @@ namespace mongo {
                 State state(txn, config);
                 state.init();
 
-                // no need for incremental collection because records are already sorted
-                state._useIncremental = false;
-                config.incLong = config.tempNamespace;
-
                 BSONObj shardCounts = cmdObj["shardCounts"].embeddedObjectUserCheck();
                 BSONObj counts = cmdObj["counts"].embeddedObjectUserCheck();
 
@@ -1725,3 +1636,5 @@ namespace mongo {
 
 }
 
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing SpillSorter outside of this file.
@@ -39,6 +39,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/scripting/engine.h"
 
@@ -170,6 +171,11 @@ namespace mongo {
 
         typedef std::map< BSONObj,BSONList,TupleKeyCmp > InMemory; // from key to list of tuples
 
+        /**
+         * Holds the tuples spilled from memory, sorted by key, until the final reduce
+         */
+        typedef Sorter< BSONObj,BSONObj > SpillSorter;
+
         /**
          * holds map/reduce config information
          */
@@ -201,7 +207,6 @@ namespace mongo {
             BSONObj scopeSetup;
 
             // output tables
-            std::string incLong;
             std::string tempNamespace;
 
             enum OutputType {
@@ -276,7 +281,8 @@ namespace mongo {
             void reduceInMemory();
 
             /**
-             * transfers in memory storage to temp collection
+             * transfers in memory storage to the spill sorter, which writes it to disk in sorted
+             * runs once it grows past the in memory limit
              */
             void dumpToInc();
             void insertToInc( BSONObj& o );
@@ -339,7 +345,6 @@ namespace mongo {
 
             const Config& _config;
             DBDirectClient _db;
-            bool _useIncremental;   // use an incremental collection
 
         protected:
 
@@ -356,6 +361,8 @@ namespace mongo {
             bool _onDisk; // if the end result of this map reduce is disk or not
 
             boost::scoped_ptr<InMemory> _temp;
+            boost::scoped_ptr<SpillSorter> _spilled; // tuples spilled by dumpToInc()
+            long long _numSpilled;
             long _size; // bytes in _temp
             long _dupCount; // number of duplicate key entries
 
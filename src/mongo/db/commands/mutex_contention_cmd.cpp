@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/base/parse_number.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/mutex_stats.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+    using std::vector;
+
+namespace {
+
+    /**
+     * One in every mutexContentionSampleRate waits for a SimpleMutex or a SpinLock is timed, or
+     * none for 0, the default.
+     */
+    class MutexContentionSampleRate : public ServerParameter {
+    public:
+        MutexContentionSampleRate()
+            : ServerParameter(ServerParameterSet::getGlobal(), "mutexContentionSampleRate") { }
+
+        virtual void append(OperationContext* txn, BSONObjBuilder& b, const string& name) {
+            b << name << MutexContention::getSampleRate();
+        }
+
+        virtual Status set(const BSONElement& newValueElement) {
+            int newValue;
+            if (!newValueElement.coerce(&newValue)) {
+                return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                              "Invalid value for mutexContentionSampleRate: " << newValueElement);
+            }
+            return _set(newValue);
+        }
+
+        virtual Status setFromString(const string& str) {
+            int newValue;
+            Status status = parseNumberFromString(str, &newValue);
+            if (!status.isOK()) {
+                return status;
+            }
+            return _set(newValue);
+        }
+
+    private:
+        Status _set(int newValue) {
+            if (newValue < 0) {
+                return Status(ErrorCodes::BadValue, mongoutils::str::stream() <<
+                              "mutexContentionSampleRate must be >= 0: " << newValue);
+            }
+            MutexContention::setSampleRate(newValue);
+            return Status::OK();
+        }
+    } mutexContentionSampleRate;
+
+    bool moreWaitTime(const MutexContention::Stats& lhs, const MutexContention::Stats& rhs) {
+        return lhs.totalWaitMicros > rhs.totalWaitMicros;
+    }
+
+}  // namespace
+
+    /**
+     * Returns the sampled contention of the named mutexes, the most waited for first.
+     */
+    class MutexContentionCmd : public Command {
+    public:
+        MutexContentionCmd() : Command("mutexContention") { }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual void help(stringstream& help) const {
+            help << "sampled wait counts and times, and holder call sites, of the named mutexes\n"
+                    "set the fraction of waits sampled with the mutexContentionSampleRate "
+                    "parameter\n"
+                    "{ mutexContention : 1, [reset : true] }  reset also discards the statistics";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            vector<MutexContention::Stats> stats = MutexContention::getStats();
+            if (cmdObj["reset"].trueValue()) {
+                MutexContention::reset();
+            }
+            std::stable_sort(stats.begin(), stats.end(), moreWaitTime);
+
+            result.append("sampleRate", MutexContention::getSampleRate());
+            BSONArrayBuilder mutexes(result.subarrayStart("mutexes"));
+            for (size_t i = 0; i < stats.size(); i++) {
+                BSONObjBuilder mutex(mutexes.subobjStart());
+                mutex.append("name", stats[i].name);
+                mutex.append("waits", stats[i].waits);
+                mutex.append("totalWaitMicros", stats[i].totalWaitMicros);
+                mutex.append("maxWaitMicros", stats[i].maxWaitMicros);
+
+                BSONArrayBuilder holders(mutex.subarrayStart("holders"));
+                for (size_t j = 0; j < stats[i].holders.size(); j++) {
+                    holders.append(BSON("site" << stats[i].holders[j].first
+                                        << "waits" << stats[i].holders[j].second));
+                }
+                holders.doneFast();
+                mutex.append("otherHolderWaits", stats[i].otherHolderWaits);
+                mutex.doneFast();
+            }
+            mutexes.doneFast();
+            return true;
+        }
+
+    } mutexContentionCmd;
+
+} // namespace mongo
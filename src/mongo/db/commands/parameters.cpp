@@ -593,6 +593,20 @@ namespace mongo {
                                                     false, // allowedToChangeAtStartup
                                                     true); // allowedToChangeAtRuntime
 
+        ExportedServerParameter<int> ReplMonitorRefreshThreadsSetting(
+                                                    ServerParameterSet::getGlobal(),
+                                                    "replMonitorRefreshThreads",
+                                                    &ReplicaSetMonitor::refreshThreads,
+                                                    true, // allowedToChangeAtStartup
+                                                    true); // allowedToChangeAtRuntime
+
+        ExportedServerParameter<int> ReplMonitorIsMasterTimeoutSetting(
+                                                    ServerParameterSet::getGlobal(),
+                                                    "replMonitorIsMasterTimeoutMillis",
+                                                    &ReplicaSetMonitor::isMasterTimeoutMillis,
+                                                    true, // allowedToChangeAtStartup
+                                                    true); // allowedToChangeAtRuntime
+
         ExportedServerParameter<bool> TraceExceptionsSetting(ServerParameterSet::getGlobal(),
                                                              "traceExceptions",
                                                              &DBException::traceExceptions,
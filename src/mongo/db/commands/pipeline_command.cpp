@@ -87,28 +87,16 @@ namespace mongo {
         uassertStatusOK(Command::parseCommandCursorOptions(cmdObj, defaultBatchSize, &batchSize));
 
         // can't use result BSONObjBuilder directly since it won't handle exceptions correctly.
-        BSONArrayBuilder resultsArray;
+        // The results are written into the batch straight from the pipeline's Documents.
+        // The initial getNext() on a PipelineProxyStage may be very expensive so none is done
+        // when batchSize is 0 since that indicates a desire for a fast return.
+        BSONObjBuilder resultsArray;
         const int byteLimit = MaxBytesToReturnToClientAtOnce;
-        BSONObj next;
-        for (int objCount = 0; objCount < batchSize; objCount++) {
-            // The initial getNext() on a PipelineProxyStage may be very expensive so we don't
-            // do it when batchSize is 0 since that indicates a desire for a fast return.
-            if (exec->getNext(&next, NULL) != PlanExecutor::ADVANCED) {
-                // make it an obvious error to use cursor or executor after this point
-                cursor = NULL;
-                exec = NULL;
-                break;
-            }
-
-            if (resultsArray.len() + next.objsize() > byteLimit) {
-                // Get the pipeline proxy stage wrapped by this PlanExecutor.
-                PipelineProxyStage* proxy = static_cast<PipelineProxyStage*>(exec->getRootStage());
-                // too big. next will be the first doc in the second batch
-                proxy->pushBack(next);
-                break;
-            }
-
-            resultsArray.append(next);
+        PipelineProxyStage* proxy = static_cast<PipelineProxyStage*>(exec->getRootStage());
+        if (!proxy->appendBatch(&resultsArray, batchSize, byteLimit)) {
+            // make it an obvious error to use cursor or executor after this point
+            cursor = NULL;
+            exec = NULL;
         }
 
         // NOTE: exec->isEOF() can have side effects such as writing by $out. However, it should
@@ -149,7 +137,7 @@ namespace mongo {
         }
 
         const long long cursorId = cursor ? cursor->cursorid() : 0LL;
-        appendCursorResponseObject(cursorId, ns, resultsArray.arr(), &result);
+        appendCursorResponseObject(cursorId, ns, BSONArray(resultsArray.obj()), &result);
 
         return static_cast<bool>(cursor);
     }
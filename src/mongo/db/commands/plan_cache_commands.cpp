@@ -41,6 +41,7 @@
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/plan_cache_commands.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/explain.h"
@@ -444,4 +445,22 @@ namespace mongo {
         return Status::OK();
     }
 
+    /**
+     * Reports plan cache hits, misses and replans per collection. Not included by default since
+     * it has one entry per collection; request it with db.serverStatus({planCache: 1}).
+     */
+    class PlanCacheServerStatusSection : public ServerStatusSection {
+    public:
+        PlanCacheServerStatusSection() : ServerStatusSection("planCache") { }
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder b;
+            PlanCache::appendAllStats(&b);
+            return b.obj();
+        }
+
+    } planCacheServerStatusSection;
+
 } // namespace mongo
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/projection_cache.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+    using std::vector;
+
+    /**
+     * Declares the fields a collection keeps in the ProjectionCache of this node, and reports
+     * on its cached rows.
+     */
+    class ProjectionCacheCmd : public Command {
+    public:
+        ProjectionCacheCmd() : Command("projectionCache") { }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool slaveOk() const { return true; }
+        virtual void help(stringstream& help) const {
+            help << "keeps an in-memory copy of some top-level fields of every document for\n"
+                    "aggregations that only read those fields; not persisted\n"
+                    "{ projectionCache : <collection_name>, [fields : [<field>, ...]] }\n"
+                    " an empty fields array removes the cache; without fields only reports";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(cmdObj.hasField("fields") ? ActionType::collMod
+                                                        : ActionType::collStats);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            const NamespaceString nss(parseNsCollectionRequired(dbname, cmdObj));
+            if (!nss.isNormal()) {
+                errmsg = "bad namespace name";
+                return false;
+            }
+
+            const BSONElement fieldsElem = cmdObj["fields"];
+            if (!fieldsElem.eoo()) {
+                if (fieldsElem.type() != Array) {
+                    errmsg = "fields must be an array of field names";
+                    return false;
+                }
+                vector<string> fields;
+                BSONForEach(elem, fieldsElem.Obj()) {
+                    if (elem.type() != String) {
+                        errmsg = "fields must be an array of field names";
+                        return false;
+                    }
+                    fields.push_back(elem.String());
+                }
+
+                // Taking the database exclusively waits for all writes in progress, which could
+                // otherwise commit without invalidating rows built after this declaration.
+                ScopedTransaction transaction(txn, MODE_IX);
+                AutoGetDb autoDb(txn, nss.db(), MODE_X);
+                Database* const db = autoDb.getDb();
+                Collection* const collection = db ? db->getCollection(nss) : NULL;
+                if (!collection) {
+                    return appendCommandStatus(result, Status(ErrorCodes::NamespaceNotFound,
+                                                              "collection not found"));
+                }
+
+                Status status = getGlobalProjectionCache()->setFields(collection, fields);
+                if (!status.isOK()) {
+                    return appendCommandStatus(result, status);
+                }
+            }
+
+            getGlobalProjectionCache()->appendStats(nss.ns(), &result);
+            return true;
+        }
+
+    } projectionCacheCmd;
+
+} // namespace mongo
@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_shape_stats.h"
+
+namespace mongo {
+
+    using boost::shared_ptr;
+    using std::string;
+    using std::stringstream;
+
+    /**
+     * Returns the execution statistics kept for each query shape run against a collection.
+     */
+    class QueryShapeStatsCmd : public Command {
+    public:
+        QueryShapeStatsCmd() : Command("queryShapeStats") { }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool slaveOk() const { return true; }
+        virtual void help(stringstream& help) const {
+            help << "executions, time spent and documents examined for each query shape run "
+                    "against a collection, the shapes that took the most time first\n"
+                    "{ queryShapeStats : 'collection', [reset : true] }  "
+                    "reset also discards the statistics";
+        }
+        virtual Status checkAuthForCommand(ClientBasic* client,
+                                           const std::string& dbname,
+                                           const BSONObj& cmdObj) {
+            ActionSet actions;
+            actions.addAction(ActionType::planCacheRead);
+            if (cmdObj["reset"].trueValue()) {
+                actions.addAction(ActionType::planCacheWrite);
+            }
+
+            AuthorizationSession* authzSession = AuthorizationSession::get(client);
+            if (authzSession->isAuthorizedForActionsOnResource(
+                    parseResourcePattern(dbname, cmdObj), actions)) {
+                return Status::OK();
+            }
+            return Status(ErrorCodes::Unauthorized, "unauthorized");
+        }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            const string ns = parseNs(dbname, cmdObj);
+
+            BSONElement reset = cmdObj["reset"];
+            if (!reset.eoo() && !reset.isBoolean()) {
+                return appendCommandStatus(result,
+                                           Status(ErrorCodes::TypeMismatch,
+                                                  "reset must be a boolean"));
+            }
+
+            AutoGetCollectionForRead ctx(txn, ns);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return appendCommandStatus(result,
+                                           Status(ErrorCodes::NamespaceNotFound,
+                                                  "no such collection"));
+            }
+
+            const shared_ptr<QueryShapeStats>& shapeStats =
+                collection->infoCache()->getQueryShapeStats();
+
+            BSONArrayBuilder shapes(result.subarrayStart("shapes"));
+            shapeStats->append(&shapes);
+            shapes.doneFast();
+            result.appendNumber("evictions", shapeStats->evictions());
+            result.appendBool("enabled", QueryShapeStats::isEnabled());
+
+            if (reset.trueValue()) {
+                shapeStats->clear();
+            }
+            return true;
+        }
+
+    } queryShapeStatsCmd;
+
+} // namespace mongo
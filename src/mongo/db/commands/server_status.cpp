@@ -32,6 +32,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -43,13 +46,16 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_internal.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
+#include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 
 namespace mongo {
@@ -59,6 +65,10 @@ namespace mongo {
     using std::string;
     using std::stringstream;
 
+    // How old the result of an expensive section may get before serverStatus generates it again.
+    // 0 generates every section on every call.
+    MONGO_EXPORT_SERVER_PARAMETER(serverStatusExpensiveSectionMaxAgeMillis, int, 1000);
+
     class CmdServerStatus : public Command {
     public:
 
@@ -107,7 +117,12 @@ namespace mongo {
             result.appendDate( "localTime" , jsTime() );
 
             timeBuilder.appendNumber( "after basic" , Listener::getElapsedTimeMillis() - start );
-            
+
+            // With sectionTiming: 1, reports how long each section took and the age of those
+            // which came from a snapshot.
+            const bool reportSectionTiming = cmdObj["sectionTiming"].trueValue();
+            BSONObjBuilder sectionTiming;
+
             // --- all sections
             
             for ( SectionMap::const_iterator i = _sections->begin(); i != _sections->end(); ++i ) {
@@ -128,7 +143,20 @@ namespace mongo {
                 if ( ! include )
                     continue;
                 
-                BSONObj data = section->generateSection(txn, e);
+                Timer sectionTimer;
+                long long snapshotAgeMillis = -1;
+                BSONObj data = _getSection(txn, section, e, &snapshotAgeMillis);
+
+                if (reportSectionTiming) {
+                    BSONObjBuilder b(sectionTiming.subobjStart(section->getSectionName()));
+                    b.append("micros", sectionTimer.micros());
+                    if (snapshotAgeMillis >= 0) {
+                        b.append("snapshotAgeMillis", snapshotAgeMillis);
+                        b.appendDate("snapshotTime", jsTime() - snapshotAgeMillis);
+                    }
+                    b.done();
+                }
+
                 if ( data.isEmpty() )
                     continue;
 
@@ -159,6 +187,10 @@ namespace mongo {
                 }
             }
 
+            if (reportSectionTiming) {
+                result.append("sectionTiming", sectionTiming.obj());
+            }
+
             timeBuilder.appendNumber( "at end" , Listener::getElapsedTimeMillis() - start );
             if ( Listener::getElapsedTimeMillis() - start > 1000 ) {
                 BSONObj t = timeBuilder.obj();
@@ -173,20 +205,69 @@ namespace mongo {
             verify( ! _runCalled );
             if ( _sections == 0 ) {
                 _sections = new SectionMap();
+                _snapshots = new SnapshotMap();
             }
             (*_sections)[section->getSectionName()] = section;
+            (*_snapshots)[section->getSectionName()] = new SectionSnapshot();
         }
 
     private:
+        /**
+         * The last result of an expensive section, shared by the serverStatus calls which come
+         * before it gets too old.
+         */
+        struct SectionSnapshot {
+            SectionSnapshot() : generatedAtMillis(-1) { }
+
+            // Held while the section is generated, so that concurrent calls wait for that result
+            // instead of generating it too.
+            boost::mutex mutex;
+            BSONObj data;
+            long long generatedAtMillis;
+        };
+
+        /**
+         * Returns the section, from its snapshot if it is expensive and this request doesn't
+         * configure it. In that case 'snapshotAgeMillis' is set to how old the result is.
+         */
+        BSONObj _getSection(OperationContext* txn,
+                            ServerStatusSection* section,
+                            const BSONElement& configElement,
+                            long long* snapshotAgeMillis) {
+            const int maxAgeMillis = serverStatusExpensiveSectionMaxAgeMillis;
+            if (!section->isExpensive() || maxAgeMillis <= 0 || configElement.type() == Object) {
+                return section->generateSection(txn, configElement);
+            }
+
+            SectionSnapshot* snapshot = (*_snapshots)[section->getSectionName()];
+            boost::lock_guard<boost::mutex> lk(snapshot->mutex);
+
+            long long now = Listener::getElapsedTimeMillis();
+            if (snapshot->generatedAtMillis < 0 ||
+                    now - snapshot->generatedAtMillis >= maxAgeMillis) {
+                snapshot->data = section->generateSection(txn, configElement).getOwned();
+                now = Listener::getElapsedTimeMillis();
+                snapshot->generatedAtMillis = now;
+            }
+
+            *snapshotAgeMillis = now - snapshot->generatedAtMillis;
+            return snapshot->data;
+        }
+
         const unsigned long long _started;
         bool _runCalled;
 
         typedef map< string , ServerStatusSection* > SectionMap;
         static SectionMap* _sections;
+
+        // Only ever added to, before the first run(), so it can be read without locking.
+        typedef map< string , SectionSnapshot* > SnapshotMap;
+        static SnapshotMap* _snapshots;
     } cmdServerStatus;
 
 
     CmdServerStatus::SectionMap* CmdServerStatus::_sections = 0;
+    CmdServerStatus::SnapshotMap* CmdServerStatus::_snapshots = 0;
 
     ServerStatusSection::ServerStatusSection( const string& sectionName )
         : _sectionName( sectionName ) {
@@ -276,6 +357,10 @@ namespace mongo {
 
                 BSONObjBuilder b;
                 networkCounter.append( b );
+                {
+                    BSONObjBuilder compression(b.subobjStart("compression"));
+                    MessageCompressorRegistry::get().appendStats(&compression);
+                }
                 return b.obj();
             }
                 
@@ -289,12 +374,16 @@ namespace mongo {
 
             BSONObj generateSection(OperationContext* txn,
                                     const BSONElement& configElement) const {
-                BSONObj result;
+                BSONObjBuilder result;
                 if (getSSLManager()) {
-                    result = getSSLManager()->getSSLConfiguration().getServerStatusBSON();
+                    result.appendElements(
+                        getSSLManager()->getSSLConfiguration().getServerStatusBSON());
+                    BSONObjBuilder sessions(result.subobjStart("SSLSessions"));
+                    getSSLManager()->appendSessionStats(&sessions);
+                    sessions.done();
                 }
 
-                return result;
+                return result.obj();
             }
         } security;
 #endif
@@ -69,6 +69,14 @@ namespace mongo {
          */
         virtual void addRequiredPrivileges(std::vector<Privilege>* out) {};
 
+        /**
+         * if this returns true, the section is costly enough to generate that serverStatus
+         * regenerates it at most once every serverStatusExpensiveSectionMaxAgeMillis, and
+         * returns the last result in between. Requests passing an object as the configElement
+         * always get a freshly generated section.
+         */
+        virtual bool isExpensive() const { return false; }
+
         /**
          * actually generate the result
          * @param configElement the element from the actual command related to this section
@@ -33,10 +33,13 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/top.h"
-#include "mongo/db/commands.h"
 
 namespace {
 
@@ -50,7 +53,9 @@ namespace {
         virtual bool adminOnly() const { return true; }
         virtual bool isWriteCommandForConfigServer() const { return false; }
         virtual void help(std::stringstream& help) const {
-            help << "usage by collection, in micros ";
+            help << "usage by collection, in micros\n"
+                 << "{ top : 1, latencyHistograms : true } also reports latency histograms by "
+                 << "collection and operation type";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
                                            const BSONObj& cmdObj,
@@ -71,11 +76,52 @@ namespace {
                 Top::get(txn->getClient()->getServiceContext()).append(b);
                 b.done();
             }
+            if (cmdObj["latencyHistograms"].trueValue()) {
+                BSONObjBuilder b(result.subobjStart("latencyHistograms"));
+                Top::get(txn->getClient()->getServiceContext()).appendLatencyHistograms(b);
+                b.done();
+            }
             return true;
         }
 
     };
 
+    /**
+     * Reports the latency histograms of each operation type and of each command that has run.
+     * Not included by default because of its size.
+     */
+    class LatencyHistogramsServerStatusSection : public ServerStatusSection {
+    public:
+        LatencyHistogramsServerStatusSection() : ServerStatusSection("latencyHistograms") {}
+
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder b;
+
+            BSONObjBuilder ops(b.subobjStart("ops"));
+            OpDebug::appendLatencyHistograms(&ops);
+            ops.done();
+
+            BSONObjBuilder commands(b.subobjStart("commands"));
+            const Command::CommandMap* commandMap = Command::commandsByBestName();
+            for (Command::CommandMap::const_iterator it = commandMap->begin();
+                 it != commandMap->end();
+                 ++it) {
+                const PartitionedLatencyHistogram& histogram = it->second->getLatencyHistogram();
+                if (histogram.getCount() == 0) {
+                    continue;
+                }
+                commands.append(it->first, histogram.getReport());
+            }
+            commands.done();
+
+            return b.obj();
+        }
+
+    } latencyHistogramsServerStatusSection;
+
     //
     // Command instance.
     // Registers command with the command system and make command
@@ -32,11 +32,16 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -44,6 +49,93 @@ namespace mongo {
     using std::endl;
     using std::string;
     using std::stringstream;
+    using std::vector;
+
+    // The most threads a background validate may validate the parts of a collection on.
+    MONGO_EXPORT_SERVER_PARAMETER(validateMaxParallelism, int, 16);
+
+namespace {
+
+    /**
+     * The records, or one index, of a collection, and what validating them found.
+     */
+    struct ValidatePart {
+        ValidatePart() : found(false), numKeys(0) { }
+
+        // Empty for the records.
+        string indexName;
+
+        // False if the collection or index went away before it could be validated.
+        bool found;
+
+        ValidateResults results;
+
+        // The stats of the records.
+        BSONObj output;
+
+        // The namespace and number of keys of the index.
+        string indexNamespace;
+        long long numKeys;
+    };
+
+    /**
+     * Validates 'part' of 'ns' under an intent lock, which lets writes to the collection go on.
+     */
+    void validatePart(OperationContext* txn,
+                      const string& ns,
+                      bool scanData,
+                      ValidatePart* part) {
+        try {
+            AutoGetCollectionForRead ctx(txn, ns);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return;
+            }
+
+            if (part->indexName.empty()) {
+                BSONObjBuilder output;
+                Status status =
+                    collection->validateRecords(txn, false, scanData, &part->results, &output);
+                if (!status.isOK()) {
+                    part->results.errors.push_back(status.toString());
+                    part->results.valid = false;
+                }
+                part->output = output.obj();
+                part->found = true;
+                return;
+            }
+
+            const IndexDescriptor* descriptor =
+                collection->getIndexCatalog()->findIndexByName(txn, part->indexName);
+            if (!descriptor) {
+                return;
+            }
+
+            int64_t numKeys;
+            collection->validateIndex(txn, descriptor, false, &part->results, &numKeys, NULL);
+            part->indexNamespace = descriptor->indexNamespace();
+            part->numKeys = numKeys;
+            part->found = true;
+        }
+        catch (const DBException& ex) {
+            part->results.errors.push_back(str::stream() << "exception during validate of "
+                                           << (part->indexName.empty() ? "records"
+                                                                       : part->indexName)
+                                           << ": " << ex.toString());
+            part->results.valid = false;
+            part->found = true;
+        }
+    }
+
+    void validatePartOnWorker(const string& ns, bool scanData, ValidatePart* part) {
+        Client::initThreadIfNotAlready();
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+        OperationContextImpl txn;
+        validatePart(&txn, ns, scanData, part);
+    }
+
+}  // namespace
 
     class ValidateCmd : public Command {
     public:
@@ -64,7 +156,8 @@ namespace mongo {
             actions.addAction(ActionType::validate);
             out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
         }
-        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool> } */
+        //{ validate: "collectionnamewithoutthedbpart" [, scandata: <bool>] [, full: <bool>]
+        //  [, background: <bool> [, parallel: <number of threads>]] }
 
         bool run(OperationContext* txn,
                  const string& dbname,
@@ -83,8 +176,19 @@ namespace mongo {
                 return false;
             }
 
+            const bool background = cmdObj["background"].trueValue();
+            if ( background && full ) {
+                errmsg = "Can't run full validate in the background";
+                return false;
+            }
+
             if (!serverGlobalParams.quiet) {
-                LOG(0) << "CMD: validate " << ns << endl;
+                LOG(0) << "CMD: validate " << ns << (background ? " in the background" : "")
+                       << endl;
+            }
+
+            if ( background ) {
+                return runInBackground( txn, ns, scanData, cmdObj, errmsg, result );
             }
 
             AutoGetDb ctx(txn, ns_string.db(), MODE_IX);
@@ -116,6 +220,99 @@ namespace mongo {
             return true;
         }
 
+    private:
+        /**
+         * Validates the records and each index of 'ns' one after the other, or in parallel,
+         * locking the collection only in intent mode and for one of them at a time.  Writes
+         * in between, and to the records while an index is validated, aren't accounted for.
+         */
+        bool runInBackground(OperationContext* txn,
+                             const string& ns,
+                             bool scanData,
+                             const BSONObj& cmdObj,
+                             string& errmsg,
+                             BSONObjBuilder& result) {
+            vector<ValidatePart> parts(1);
+            {
+                AutoGetCollectionForRead ctx(txn, ns);
+                Collection* collection = ctx.getCollection();
+                if ( !collection ) {
+                    errmsg = "ns not found";
+                    return false;
+                }
+
+                IndexCatalog::IndexIterator it =
+                    collection->getIndexCatalog()->getIndexIterator(txn, false);
+                while ( it.more() ) {
+                    parts.push_back(ValidatePart());
+                    parts.back().indexName = it.next()->indexName();
+                }
+            }
+
+            int parallel = 1;
+            if ( cmdObj["parallel"].isNumber() ) {
+                parallel = std::max(1, std::min(cmdObj["parallel"].numberInt(),
+                                                static_cast<int>(validateMaxParallelism)));
+            }
+            parallel = std::min(parallel, static_cast<int>(parts.size()));
+
+            if ( parallel == 1 ) {
+                for ( size_t i = 0; i < parts.size(); i++ ) {
+                    validatePart(txn, ns, scanData, &parts[i]);
+                }
+            }
+            else {
+                ThreadPool workers(parallel, "ValidateWorker");
+                for ( size_t i = 0; i < parts.size(); i++ ) {
+                    workers.schedule(&validatePartOnWorker, ns, scanData, &parts[i]);
+                }
+                workers.join();
+            }
+
+            if ( !parts[0].found ) {
+                errmsg = "ns not found";
+                return false;
+            }
+
+            result.append( "ns", ns );
+            result.appendElements( parts[0].output );
+
+            ValidateResults results;
+            int nIndexes = 0;
+            BSONObjBuilder keysPerIndex;
+            for ( size_t i = 0; i < parts.size(); i++ ) {
+                const ValidatePart& part = parts[i];
+                if ( !part.found ) {
+                    continue;
+                }
+                if ( !part.indexNamespace.empty() ) {
+                    keysPerIndex.appendNumber( part.indexNamespace, part.numKeys );
+                    nIndexes++;
+                }
+                results.valid = results.valid && part.results.valid;
+                results.errors.insert( results.errors.end(),
+                                       part.results.errors.begin(),
+                                       part.results.errors.end() );
+            }
+            result.append( "nIndexes", nIndexes );
+            result.append( "keysPerIndex", keysPerIndex.obj() );
+
+            result.appendBool( "valid", results.valid );
+            result.append( "errors", results.errors );
+            result.appendBool( "background", true );
+            result.append( "parallel", parallel );
+
+            result.append("warning", "Validated in the background, so concurrent writes may "
+                                     "make counts disagree. Some checks omitted for speed. use "
+                                     "{full:true} option to do more thorough scan.");
+
+            if ( !results.valid ) {
+                result.append("advice", "ns corrupt. See http://dochub.mongodb.org/core/data-recovery");
+            }
+
+            return true;
+        }
+
     } validateCmd;
 
 }
@@ -0,0 +1,112 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/warmup.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+
+    class WarmupCmd : public Command {
+    public:
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual bool adminOnly() const { return false; }
+        virtual bool slaveOk() const { return true; }
+        virtual void help( stringstream& help ) const {
+            help << "warmup collection\n"
+                "Read the documents and indexes of a collection into cache in the background\n"
+                "{ warmup : <collection_name>, [data : true], [index : true | [<index_name>, ...]] }\n"
+                " at least one of data or index must be given; progress is shown in currentOp\n";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::touch);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        WarmupCmd() : Command("warmup") { }
+
+        virtual bool run(OperationContext* txn,
+                         const string& dbname,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result) {
+            const std::string ns = parseNsCollectionRequired(dbname, cmdObj);
+
+            const NamespaceString nss(ns);
+            if ( ! nss.isNormal() ) {
+                errmsg = "bad namespace name";
+                return false;
+            }
+
+            WarmupTarget target;
+            target.ns = ns;
+            target.data = cmdObj["data"].trueValue();
+
+            const BSONElement index = cmdObj["index"];
+            if ( index.type() == Array ) {
+                BSONObjIterator it( index.Obj() );
+                while ( it.more() ) {
+                    const BSONElement name = it.next();
+                    if ( name.type() != String ) {
+                        errmsg = "index names must be strings";
+                        return false;
+                    }
+                    target.indexNames.push_back( name.String() );
+                }
+            }
+            else {
+                target.allIndexes = index.trueValue();
+            }
+
+            if ( ! (target.data || target.allIndexes || !target.indexNames.empty()) ) {
+                errmsg = "must specify at least one of (data:true, index:true or index names)";
+                return false;
+            }
+
+            return appendCommandStatus( result,
+                                        startWarmup( std::vector<WarmupTarget>( 1, target ) ) );
+        }
+
+    };
+    static WarmupCmd warmupCmd;
+}
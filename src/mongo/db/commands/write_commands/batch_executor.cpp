@@ -68,6 +68,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/s/collection_metadata.h"
+#include "mongo/s/d_chunk_heat.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/s/stale_exception.h"
@@ -111,6 +112,13 @@ namespace mongo {
     // TODO: Determine queueing behavior we want here
     MONGO_EXPORT_SERVER_PARAMETER( queueForMigrationCommit, bool, true );
 
+    // Maximum number of documents execInsertGroup() inserts in one unit of work; less than 2
+    // inserts every document on its own.
+    MONGO_EXPORT_SERVER_PARAMETER( internalInsertMaxBatchSize, int, 64 );
+
+    // Also limits the size of such a group, so its unit of work stays small.
+    const int kInsertGroupMaxBytes = 256 * 1024;
+
     using mongoutils::str::stream;
 
     WriteBatchExecutor::WriteBatchExecutor( OperationContext* txn,
@@ -590,7 +598,7 @@ namespace mongo {
 
         currentOp->done();
         int executionTime = currentOp->debug().executionTime = currentOp->totalTimeMillis();
-        currentOp->debug().recordStats();
+        currentOp->debug().recordStats(currentOp->totalTimeMicros());
         if (currentOp->getOp() == dbInsert) {
             // This is a wrapped operation, so make sure to count this part of the op
             // SERVER-13339: Properly fix the handling of context in the insert path.
@@ -876,6 +884,12 @@ namespace mongo {
                 elapsedTracker.resetLastTime();
             }
 
+            const size_t numGrouped = execInsertGroup(&state);
+            if (numGrouped > 0) {
+                state.currIndex += numGrouped - 1;
+                continue;
+            }
+
             WriteErrorDetail* error = NULL;
             execOneInsert(&state, &error);
             if (error) {
@@ -1122,6 +1136,10 @@ namespace mongo {
             }
         }
 
+        if (!result->getError() && !state->request->isInsertIndexRequest()) {
+            chunkHeatTracker.noteInsert(state->request->getTargetingNS(), insertDoc);
+        }
+
         // Errors release the write lock, as a matter of policy.
         if (result->getError()) {
             state->txn->recoveryUnit()->commitAndRestart();
@@ -1149,6 +1167,76 @@ namespace mongo {
         }
     }
 
+    size_t WriteBatchExecutor::execInsertGroup(ExecInsertsState* state) {
+        const size_t maxDocs = std::max(internalInsertMaxBatchSize, 0);
+        if (maxDocs < 2 || state->request->isInsertIndexRequest())
+            return 0;
+
+        std::vector<BSONObj> docs;
+        int bytes = 0;
+        for (size_t i = state->currIndex;
+             i < state->request->sizeWriteOps() &&
+             docs.size() < maxDocs &&
+             bytes < kInsertGroupMaxBytes;
+             ++i) {
+
+            const StatusWith<BSONObj>& normalizedInsert(state->normalizedInserts[i]);
+            if (!normalizedInsert.isOK())
+                break;
+
+            docs.push_back(normalizedInsert.getValue().isEmpty() ?
+                           state->request->getInsertRequest()->getDocumentsAt(i) :
+                           normalizedInsert.getValue());
+            bytes += docs.back().objsize();
+        }
+
+        if (docs.size() < 2)
+            return 0;
+
+        if (state->currIndex + docs.size() == state->request->sizeWriteOps()) {
+            setupSynchronousCommit(_txn);
+        }
+
+        try {
+            WriteOpResult lockResult;
+            if (!state->lockAndCheck(&lockResult)) {
+                // The same check fails again, and is reported, for the first document.
+                state->unlock();
+                return 0;
+            }
+
+            WriteUnitOfWork wunit(_txn);
+            if (!state->getCollection()->insertDocuments(_txn, docs, true).isOK())
+                return 0;
+            wunit.commit();
+        }
+        catch (const DBException& ex) {
+            if (ErrorCodes::isInterruption(ex.toStatus().code()))
+                throw;
+
+            // Includes write conflicts, which are retried one document at a time.
+            _txn->recoveryUnit()->commitAndRestart();
+            state->unlock();
+            return 0;
+        }
+
+        // Account for each document as if it had been inserted on its own.
+        for (size_t i = 0; i < docs.size(); ++i) {
+            BatchItemRef currInsertItem(state->request, state->currIndex + i);
+            CurOp currentOp(_txn->getClient());
+            beginCurrentOp( &currentOp, _txn->getClient(), currInsertItem );
+            incOpStats(currInsertItem);
+
+            WriteOpResult result;
+            result.getStats().n = 1;
+
+            incWriteStats(currInsertItem, result.getStats(), NULL, &currentOp);
+            finishCurrentOp(_txn, &currentOp, NULL);
+        }
+
+        return docs.size();
+    }
+
     /**
      * Perform a single insert into a collection.  Requires the insert be preprocessed and the
      * collection already has been created.
@@ -1233,6 +1321,8 @@ namespace mongo {
         // Updates from the write commands path can yield.
         request.setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
+        chunkHeatTracker.noteWrite(nsString.ns(), request.getQuery());
+
         int attempt = 0;
         bool createCollection = false;
         for ( int fakeLoop = 0; fakeLoop < 1; fakeLoop++ ) {
@@ -1401,6 +1491,8 @@ namespace mongo {
         // Deletes running through the write commands path can yield.
         request.setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
+        chunkHeatTracker.noteWrite(nss.ns(), request.getQuery());
+
         int attempt = 1;
         while ( 1 ) {
             try {
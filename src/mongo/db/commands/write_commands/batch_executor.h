@@ -101,6 +101,14 @@ namespace mongo {
          */
         void execOneInsert( ExecInsertsState* state, WriteErrorDetail** error );
 
+        /**
+         * Tries to insert a run of documents starting at the current insert, in one unit of work.
+         * Returns how many were inserted, which is 0 if the run was too short or any of it
+         * failed; in that case nothing was inserted and each document should go through
+         * execOneInsert() instead, which reports errors for the right item.
+         */
+        size_t execInsertGroup( ExecInsertsState* state );
+
         /**
          * Executes an update item (which may update many documents or upsert), and returns the
          * upserted _id on upsert or error on failure.
@@ -429,13 +429,8 @@ namespace {
     // Have more buckets than CPUs to reduce contention on lock and caches
     const unsigned LockManager::_numLockBuckets(128);
 
-    // Balance scalability of intent locks against potential added cost of conflicting locks.
-    // The exact value doesn't appear very important, but should be power of two
-    const unsigned LockManager::_numPartitions = 32;
-
     LockManager::LockManager() {
         _lockBuckets = new LockBucket[_numLockBuckets];
-        _partitions = new Partition[_numPartitions];
     }
 
     LockManager::~LockManager() {
@@ -447,7 +442,6 @@ namespace {
         }
 
         delete[] _lockBuckets;
-        delete[] _partitions;
     }
 
     LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -140,8 +140,9 @@ namespace mongo {
 
         // Each locker maps to a partition that is used for resources acquired in intent modes
         // modes and potentially other modes that don't conflict with themselves. This avoids
-        // contention on the regular LockHead in the lock manager.
-        struct Partition {
+        // contention on the regular LockHead in the lock manager. Partitions are aligned so that
+        // lockers using different partitions never write to the same cache line.
+        struct MONGO_COMPILER_ALIGN_TYPE(128) Partition {
             Partition() : mutex("LockManager") { }
             PartitionedLockHead* find(ResourceId resId);
             PartitionedLockHead* findOrInsert(ResourceId resId);
@@ -183,8 +184,14 @@ namespace mongo {
         static const unsigned _numLockBuckets;
         LockBucket* _lockBuckets;
 
-        static const unsigned _numPartitions;
-        Partition* _partitions;
+        // Balance scalability of intent locks against potential added cost of conflicting locks.
+        // With at least as many partitions as concurrently active lockers, uncontended intent
+        // locks only touch their locker's own partition. The exact value doesn't appear very
+        // important, but should be power of two.
+        enum { _numPartitions = 64 };
+
+        // Held inline rather than allocated, since operator new does not honor the alignment.
+        mutable Partition _partitions[_numPartitions];
     };
 
 
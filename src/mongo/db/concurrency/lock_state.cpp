@@ -37,6 +37,7 @@
 #include "mongo/platform/compiler.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/synchronization.h"
+#include "mongo/util/cycle_clock.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -89,7 +90,9 @@ namespace {
             AtomicLockStats stats;
         };
 
-        enum { NumPartitions = 8 };
+        // As many partitions as LockManager has for intent locks, so that lockers which do not
+        // contend there do not contend on the statistics either.
+        enum { NumPartitions = 64 };
 
 
         AtomicLockStats& _get(LockerId id) {
@@ -134,6 +137,9 @@ namespace {
     // Partitioned global lock statistics, so we don't hit the same bucket
     PartitionedInstanceWideLockStats globalStats;
 
+    // Number of lock requests currently waiting to be granted, see getNumLockWaiters()
+    AtomicInt32 numLockWaiters(0);
+
 
     /**
      * Whether the particular lock's release should be held until the end of the operation. We
@@ -650,7 +656,7 @@ namespace {
 
         if (result == LOCK_WAITING) {
             // Start counting the wait time so that lockComplete can update that metric
-            _requestStartTime = curTimeMicros64();
+            _requestStartTime = CycleClock::now();
             globalStats.recordWait(_id, resId, mode);
             _stats.recordWait(resId, mode);
         }
@@ -676,6 +682,7 @@ namespace {
         }
 
         LockResult result;
+        numLockWaiters.addAndFetch(1);
 
         // Don't go sleeping without bound in order to be able to report long waits or wake up for
         // deadlock detection.
@@ -686,7 +693,8 @@ namespace {
             result = _notify.wait(waitTimeMs);
 
             // Account for the time spent waiting on the notification object
-            const uint64_t elapsedTimeMicros = curTimeMicros64() - _requestStartTime;
+            const uint64_t elapsedTimeMicros =
+                CycleClock::toNanos(CycleClock::now() - _requestStartTime) / 1000;
             globalStats.recordWaitTime(_id, resId, mode, elapsedTimeMicros);
             _stats.recordWaitTime(resId, mode, elapsedTimeMicros);
 
@@ -719,6 +727,8 @@ namespace {
             }
         }
 
+        numLockWaiters.subtractAndFetch(1);
+
         // Cleanup the state, since this is an unused lock now
         if (result != LOCK_OK) {
             LockRequestsMap::Iterator it = _requests.find(resId);
@@ -896,6 +906,10 @@ namespace {
         return &globalLockManager;
     }
 
+    int getNumLockWaiters() {
+        return numLockWaiters.load();
+    }
+
     void reportGlobalLockingStats(SingleThreadedLockStats* outStats) {
         globalStats.report(outStats);
     }
@@ -203,9 +203,9 @@ namespace mongo {
         // and condition variable every time.
         CondVarLockGrantNotification _notify;
 
-        // Timer for measuring duration and timeouts. This value is set when lock acquisition is
-        // about to wait and is sampled at grant time.
-        uint64_t _requestStartTime;
+        // CycleClock reading for measuring duration and timeouts. This value is set when lock
+        // acquisition is about to wait and is sampled at grant time.
+        long long _requestStartTime;
 
         // Per-locker locking statistics. Reported in the slow-query log message and through
         // db.currentOp. Complementary to the per-instance locking statistics.
@@ -323,4 +323,9 @@ namespace mongo {
      */
     LockManager* getGlobalLockManager();
 
+    /**
+     * Returns how many lock requests are waiting to be granted right now, on any resource.
+     */
+    int getNumLockWaiters();
+
 } // namespace mongo
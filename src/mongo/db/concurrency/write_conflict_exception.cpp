@@ -31,12 +31,73 @@
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kWrite
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
+namespace {
+
+    // The first retries don't sleep. After that the backoff doubles with each attempt, from
+    // kMinBackoffMicros up to kMaxBackoffMicros.
+    const int kAttemptsWithoutBackoff = 4;
+    const int kMinBackoffMicros = 100;
+    const int kMaxBackoffMicros = 10 * 1000;
+
+    // Conflicts on namespaces beyond the first kMaxNamespaces are not counted.
+    const size_t kMaxNamespaces = 1000;
+
+    // One in kRecordSampleRate conflicting records is kept in a sample of at most
+    // kMaxSampledRecords, of which the kNumReportedRecords most conflicted are reported.
+    const unsigned kRecordSampleRate = 8;
+    const size_t kMaxSampledRecords = 64;
+    const size_t kNumReportedRecords = 10;
+
+    struct SampledRecord {
+        SampledRecord(StringData ns, const RecordId& loc)
+            : ns(ns.toString()), loc(loc), conflicts(0) { }
+
+        std::string ns;
+        RecordId loc;
+        long long conflicts;
+    };
+
+    bool moreConflicts(const SampledRecord& lhs, const SampledRecord& rhs) {
+        return lhs.conflicts > rhs.conflicts;
+    }
+
+    SimpleMutex statsMutex("writeConflictStats");
+    StringMap<long long> conflictsByNamespace;
+    std::vector<SampledRecord> sampledRecords;
+    AtomicUInt32 recordsNoted(0);
+
+    AtomicUInt64 randomState(0);
+
+    /**
+     * Returns a pseudo-random number (splitmix64), good enough to spread out the retries of the
+     * writers which conflicted with each other.
+     */
+    uint64_t nextRandom() {
+        const uint64_t golden = 0x9E3779B97F4A7C15ULL;
+        uint64_t z = randomState.fetchAndAdd(golden) + golden;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+}  // namespace
+
     bool WriteConflictException::trace = false;
 
     WriteConflictException::WriteConflictException()
@@ -56,20 +117,79 @@ namespace mongo {
                << " on " << ns
                << ", attempt: " << attempt << " retrying";
 
-        // All numbers below chosen by guess and check against a few random benchmarks.
-        if (attempt < 4) {
-            // no-op
+        {
+            SimpleMutex::scoped_lock lk(statsMutex);
+            if (conflictsByNamespace.size() < kMaxNamespaces ||
+                conflictsByNamespace.find(ns) != conflictsByNamespace.end()) {
+                conflictsByNamespace[ns]++;
+            }
         }
-        else if (attempt < 10) {
-            sleepmillis(1);
+
+        if (attempt < kAttemptsWithoutBackoff) {
+            return;
+        }
+
+        const int doublings = std::min(attempt - kAttemptsWithoutBackoff, 7);
+        const int backoffMicros = std::min(kMinBackoffMicros << doublings, kMaxBackoffMicros);
+        sleepmicros(backoffMicros / 2 + nextRandom() % (backoffMicros / 2 + 1));
+    }
+
+    void WriteConflictException::noteConflictingRecord(StringData ns, const RecordId& loc) {
+        if (recordsNoted.fetchAndAdd(1) % kRecordSampleRate != 0) {
+            return;
         }
-        else if (attempt < 100) {
-            sleepmillis(5);
+
+        SimpleMutex::scoped_lock lk(statsMutex);
+        std::vector<SampledRecord>::iterator minIt = sampledRecords.end();
+        for (std::vector<SampledRecord>::iterator it = sampledRecords.begin();
+             it != sampledRecords.end();
+             ++it) {
+            if (it->loc == loc && it->ns == ns) {
+                it->conflicts++;
+                return;
+            }
+            if (minIt == sampledRecords.end() || it->conflicts < minIt->conflicts) {
+                minIt = it;
+            }
         }
-        else {
-            sleepmillis(10);
+
+        if (sampledRecords.size() < kMaxSampledRecords) {
+            sampledRecords.push_back(SampledRecord(ns, loc));
+            sampledRecords.back().conflicts = 1;
+            return;
         }
 
+        // Take over the least conflicted record's count, so that a record which starts
+        // conflicting a lot can still make it to the top.
+        const long long conflicts = minIt->conflicts + 1;
+        *minIt = SampledRecord(ns, loc);
+        minIt->conflicts = conflicts;
+    }
+
+    void WriteConflictException::reportStats(BSONObjBuilder* builder) {
+        SimpleMutex::scoped_lock lk(statsMutex);
+
+        BSONObjBuilder namespaces(builder->subobjStart("namespaces"));
+        for (StringMap<long long>::const_iterator it = conflictsByNamespace.begin();
+             it != conflictsByNamespace.end();
+             ++it) {
+            namespaces.appendNumber(it->first, it->second);
+        }
+        namespaces.doneFast();
+
+        std::vector<SampledRecord> records(sampledRecords);
+        std::sort(records.begin(), records.end(), moreConflicts);
+        if (records.size() > kNumReportedRecords) {
+            records.resize(kNumReportedRecords, SampledRecord(StringData(), RecordId()));
+        }
+
+        BSONArrayBuilder hottest(builder->subarrayStart("sampledRecords"));
+        for (size_t i = 0; i < records.size(); i++) {
+            hottest.append(BSON("ns" << records[i].ns
+                             << "recordId" << static_cast<long long>(records[i].loc.repr())
+                             << "conflicts" << records[i].conflicts));
+        }
+        hottest.doneFast();
     }
 
     namespace {
@@ -32,6 +32,7 @@
 
 #include <exception>
 
+#include "mongo/db/record_id.h"
 #include "mongo/util/assert_util.h"
 
 #define MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN do { int wcr__Attempts = 0; do { try
@@ -49,6 +50,8 @@
 
 namespace mongo {
 
+    class BSONObjBuilder;
+
     /**
      * This is thrown if during a write, two or more operations conflict with each other.
      * For example if two operations get the same version of a document, and then both try to
@@ -60,7 +63,9 @@ namespace mongo {
 
         /**
          * Will log a message if sensible and will do an exponential backoff to make sure
-         * we don't hammer the same doc over and over.
+         * we don't hammer the same doc over and over. The sleep is picked at random from the
+         * upper half of the backoff, so that the writers which conflicted retry at different
+         * times. Also counts the conflict against 'ns' for reportStats().
          * @param attempt - what attempt is this, 1 based
          * @param operation - e.g. "update"
          */
@@ -68,6 +73,18 @@ namespace mongo {
                                   StringData operation,
                                   StringData ns);
 
+        /**
+         * Notes that a write to 'loc' in 'ns' hit a write conflict, for the sample of the most
+         * conflicted records kept for reportStats(). Only some of the calls are kept.
+         */
+        static void noteConflictingRecord(StringData ns, const RecordId& loc);
+
+        /**
+         * Appends the number of write conflicts retried on each namespace, and the most
+         * conflicted records of the sample.
+         */
+        static void reportStats(BSONObjBuilder* builder);
+
         /**
          * If true, will call printStackTrace on every WriteConflictException created.
          * Can be set via setParameter named traceWriteConflictExceptions.
@@ -39,6 +39,8 @@ namespace mongo {
 
     int ConnPoolOptions::maxConnsPerHost(200);
     int ConnPoolOptions::maxShardedConnsPerHost(200);
+    int ConnPoolOptions::maxInUseShardedConnsPerHost(-1);
+    int ConnPoolOptions::inUseWaitTimeoutMillis(20 * 1000);
 
     namespace {
 
@@ -56,6 +58,20 @@ namespace mongo {
                                         true,
                                         false /* can't change at runtime */);
 
+        ExportedServerParameter<int> //
+        maxInUseShardedConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                             "connPoolMaxInUseShardedConnsPerHost",
+                                             &ConnPoolOptions::maxInUseShardedConnsPerHost,
+                                             true,
+                                             false /* can't change at runtime */);
+
+        ExportedServerParameter<int> //
+        inUseWaitTimeoutMillisParameter(ServerParameterSet::getGlobal(),
+                                        "connPoolInUseWaitTimeoutMillis",
+                                        &ConnPoolOptions::inUseWaitTimeoutMillis,
+                                        true,
+                                        false /* can't change at runtime */);
+
         MONGO_INITIALIZER(InitializeConnectionPools)(InitializerContext* context) {
 
             // Initialize the sharded and unsharded outgoing connection pools
@@ -69,6 +85,8 @@ namespace mongo {
 
             shardConnectionPool.setName("sharded connection pool");
             shardConnectionPool.setMaxPoolSize(ConnPoolOptions::maxShardedConnsPerHost);
+            shardConnectionPool.setMaxInUse(ConnPoolOptions::maxInUseShardedConnsPerHost);
+            shardConnectionPool.setInUseWaitTimeoutMillis(ConnPoolOptions::inUseWaitTimeoutMillis);
 
             return Status::OK();
         }
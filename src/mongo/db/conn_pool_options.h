@@ -49,6 +49,16 @@ namespace mongo {
          * Maximum connections per host the sharded conn pool should use
          */
         static int maxShardedConnsPerHost;
+
+        /**
+         * Maximum connections per host the sharded conn pool may hand out at once, -1 for no limit
+         */
+        static int maxInUseShardedConnsPerHost;
+
+        /**
+         * How long a request waits for a host at its in-use limit before failing
+         */
+        static int inUseWaitTimeoutMillis;
     };
 
 }
@@ -40,7 +40,10 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/json.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/top.h"
+#include "mongo/util/coarse_clock.h"
+#include "mongo/util/cycle_clock.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 
@@ -378,13 +381,13 @@ namespace mongo {
         // If our accurate time source thinks time is not up yet, calculate the next target for
         // our approximate time source.
         if (_targetEpochMicros > now) {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis() +
+            _approxTargetServerMillis = CoarseClock::elapsedMillis() +
                                         static_cast<int64_t>((_targetEpochMicros - now) / 1000);
         }
         // Otherwise, set our approximate time source target such that it thinks time is already
         // up.
         else {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis();
+            _approxTargetServerMillis = CoarseClock::elapsedMillis();
         }
     }
 
@@ -394,7 +397,7 @@ namespace mongo {
         }
 
         // Does our approximate time source think time is not up yet?  If so, return early.
-        if (_approxTargetServerMillis > Listener::getElapsedTimeMillis()) {
+        if (_approxTargetServerMillis > CoarseClock::elapsedMillis()) {
             return false;
         }
 
@@ -402,7 +405,7 @@ namespace mongo {
         // Does our accurate time source think time is not up yet?  If so, readjust the target for
         // our approximate time source and return early.
         if (_targetEpochMicros > now) {
-            _approxTargetServerMillis = Listener::getElapsedTimeMillis() +
+            _approxTargetServerMillis = CoarseClock::elapsedMillis() +
                                         static_cast<int64_t>((_targetEpochMicros - now) / 1000);
             return false;
         }
@@ -457,7 +460,64 @@ namespace mongo {
     static ServerStatusMetricField<Counter64> displayWriteConflicts( "operation.writeConflicts",
                                                                      &writeConflictsCounter );
 
-    void OpDebug::recordStats() {
+namespace {
+
+    // Latencies of all operations, by the operation types of opcounters. Indexed by OpLatencyType.
+    enum OpLatencyType {
+        kQueryLatency,
+        kGetMoreLatency,
+        kInsertLatency,
+        kUpdateLatency,
+        kDeleteLatency,
+        kCommandLatency,
+        kNumOpLatencyTypes
+    };
+
+    const char* const opLatencyTypeNames[kNumOpLatencyTypes] = {
+        "query",
+        "getmore",
+        "insert",
+        "update",
+        "delete",
+        "command",
+    };
+
+    PartitionedLatencyHistogram opLatencies[kNumOpLatencyTypes];
+
+    PartitionedLatencyHistogram* opLatencyHistogram(int op, bool isCommand) {
+        switch (op) {
+        case dbQuery:
+            return &opLatencies[isCommand ? kCommandLatency : kQueryLatency];
+        case dbGetMore:
+            return &opLatencies[kGetMoreLatency];
+        case dbInsert:
+            return &opLatencies[kInsertLatency];
+        case dbUpdate:
+            return &opLatencies[kUpdateLatency];
+        case dbDelete:
+            return &opLatencies[kDeleteLatency];
+        default:
+            return NULL;
+        }
+    }
+
+}  // namespace
+
+    // static
+    void OpDebug::appendLatencyHistograms(BSONObjBuilder* builder) {
+        for (int i = 0; i < kNumOpLatencyTypes; i++) {
+            if (opLatencies[i].getCount() == 0) {
+                continue;
+            }
+            builder->append(opLatencyTypeNames[i], opLatencies[i].getReport());
+        }
+    }
+
+    void OpDebug::recordStats(long long executionMicros) {
+        if (PartitionedLatencyHistogram* histogram = opLatencyHistogram(op, iscommand)) {
+            histogram->recordMicros(executionMicros);
+        }
+
         if ( nreturned > 0 )
             returnedCounter.increment( nreturned );
         if ( ninserted > 0 )
@@ -510,6 +570,11 @@ namespace mongo {
         cursorExhausted = false;
         keyUpdates = 0;  // unsigned, so -1 not possible
         writeConflicts = 0;
+        peakMemoryBytes = -1;
+        ticketWaitMicros = 0;
+        storageTimeCycles = 0;
+        yieldMicros = 0;
+        writeConcernWaitMicros = 0;
         planSummary = "";
         execStats.reset();
 
@@ -523,6 +588,7 @@ namespace mongo {
 
 #define OPDEBUG_TOSTRING_HELP(x) if( x >= 0 ) s << " " #x ":" << (x)
 #define OPDEBUG_TOSTRING_HELP_BOOL(x) if( x ) s << " " #x ":" << (x)
+#define OPDEBUG_TOSTRING_HELP_TIME(x) if( x > 0 ) s << " " #x ":" << (x)
     string OpDebug::report(const CurOp& curop, const SingleThreadedLockStats& lockStats) const {
         StringBuilder s;
         if ( iscommand )
@@ -581,6 +647,7 @@ namespace mongo {
         OPDEBUG_TOSTRING_HELP_BOOL( cursorExhausted );
         OPDEBUG_TOSTRING_HELP( keyUpdates );
         OPDEBUG_TOSTRING_HELP( writeConflicts );
+        OPDEBUG_TOSTRING_HELP( peakMemoryBytes );
 
         if ( extra.len() )
             s << " " << extra.str();
@@ -593,6 +660,12 @@ namespace mongo {
 
         s << " numYields:" << curop.numYields();
 
+        const long long storageTimeMicros = CycleClock::toNanos(storageTimeCycles) / 1000;
+        OPDEBUG_TOSTRING_HELP_TIME( ticketWaitMicros );
+        OPDEBUG_TOSTRING_HELP_TIME( storageTimeMicros );
+        OPDEBUG_TOSTRING_HELP_TIME( yieldMicros );
+        OPDEBUG_TOSTRING_HELP_TIME( writeConcernWaitMicros );
+
         OPDEBUG_TOSTRING_HELP( nreturned );
         if (responseLength > 0) {
             s << " reslen:" << responseLength;
@@ -646,6 +719,7 @@ namespace mongo {
 
 #define OPDEBUG_APPEND_NUMBER(x) if( x != -1 ) b.appendNumber( #x , (x) )
 #define OPDEBUG_APPEND_BOOL(x) if( x ) b.appendBool( #x , (x) )
+#define OPDEBUG_APPEND_TIME(x) if( x > 0 ) b.appendNumber( #x , (x) )
     void OpDebug::append(const CurOp& curop,
                          const SingleThreadedLockStats& lockStats,
                          BSONObjBuilder& b) const {
@@ -689,8 +763,15 @@ namespace mongo {
         OPDEBUG_APPEND_BOOL( cursorExhausted );
         OPDEBUG_APPEND_NUMBER( keyUpdates );
         OPDEBUG_APPEND_NUMBER( writeConflicts );
+        OPDEBUG_APPEND_NUMBER( peakMemoryBytes );
         b.appendNumber("numYield", curop.numYields());
 
+        const long long storageTimeMicros = CycleClock::toNanos(storageTimeCycles) / 1000;
+        OPDEBUG_APPEND_TIME( ticketWaitMicros );
+        OPDEBUG_APPEND_TIME( storageTimeMicros );
+        OPDEBUG_APPEND_TIME( yieldMicros );
+        OPDEBUG_APPEND_TIME( writeConcernWaitMicros );
+
         {
             BSONObjBuilder locks(b.subobjStart("locks"));
             lockStats.report(&locks);
@@ -127,7 +127,17 @@ namespace mongo {
 
         void reset();
 
-        void recordStats();
+        /**
+         * Records this operation in the document and operation counters, and its latency,
+         * "executionMicros", in the latency histogram for its operation type.
+         */
+        void recordStats(long long executionMicros);
+
+        /**
+         * Appends a LatencyHistogram report for each operation type that has been recorded by
+         * recordStats().
+         */
+        static void appendLatencyHistograms(BSONObjBuilder* builder);
 
         std::string report(const CurOp& curop, const SingleThreadedLockStats& lockStats) const;
 
@@ -174,6 +184,15 @@ namespace mongo {
         bool cursorExhausted; // true if the cursor has been closed at end a find/getMore operation
         int keyUpdates;
         long long writeConflicts;
+        long long peakMemoryBytes; // peak memory tracked for the operation, see MemoryTracker
+
+        // Where the operation waited, besides for its locks: for a storage engine ticket, in the
+        // storage engine reads of its query plans (in CycleClock cycles), in yields, and for the
+        // write concern.
+        long long ticketWaitMicros;
+        long long storageTimeCycles;
+        long long yieldMicros;
+        long long writeConcernWaitMicros;
         ThreadSafeString planSummary; // a brief std::string describing the query solution
 
         // New Query Framework debugging/profiling info
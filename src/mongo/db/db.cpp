@@ -75,9 +75,10 @@
 #include "mongo/db/op_observer.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repair_database.h"
-#include "mongo/db/repl/network_interface_impl.h"
+#include "mongo/db/repl/network_interface_asio.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_coordinator_external_state_impl.h"
@@ -93,11 +94,13 @@
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/ttl.h"
+#include "mongo/db/warmup.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_clock.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exception_filter_win32.h"
@@ -151,11 +154,24 @@ namespace mongo {
     QueryResult::View emptyMoreResult(long long);
 
     class MyMessageHandler : public MessageHandler {
+        struct DetachedClient : public ConnectionState {
+            explicit DetachedClient(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+            ServiceContext::UniqueClient client;
+        };
+
     public:
         virtual void connected( AbstractMessagingPort* p ) {
             Client::initThread("conn", p);
         }
 
+        virtual std::unique_ptr<ConnectionState> detachConnection() {
+            return std::unique_ptr<ConnectionState>(new DetachedClient(Client::releaseCurrent()));
+        }
+
+        virtual void attachConnection(std::unique_ptr<ConnectionState> state) {
+            Client::setCurrent(std::move(static_cast<DetachedClient*>(state.get())->client));
+        }
+
         virtual void process(Message& m , AbstractMessagingPort* port) {
             OperationContextImpl txn;
             while ( true ) {
@@ -181,11 +197,23 @@ namespace mongo {
                             b.appendNum((int) 0 /*size set later in appendData()*/);
                             b.appendNum(header.getId());
                             b.appendNum(header.getResponseTo());
-                            b.appendNum((int) dbGetMore);
-                            b.appendNum((int) 0);
-                            b.appendStr(ns);
-                            b.appendNum((int) 0); // ntoreturn
-                            b.appendNum(cursorid);
+                            if (dbresponse.exhaustCommand.isEmpty()) {
+                                b.appendNum((int) dbGetMore);
+                                b.appendNum((int) 0);
+                                b.appendStr(ns);
+                                b.appendNum((int) 0); // ntoreturn
+                                b.appendNum(cursorid);
+                            }
+                            else {
+                                // An exhaust find or getMore command continues with a getMore
+                                // command, which runs with the exhaust flag again.
+                                b.appendNum((int) dbQuery);
+                                b.appendNum((int) QueryOption_Exhaust);
+                                b.appendStr(ns);
+                                b.appendNum((int) 0); // ntoskip
+                                b.appendNum((int) -1); // ntoreturn
+                                dbresponse.exhaustCommand.appendSelfToBufBuilder(b);
+                            }
                             m.appendData(b.buf(), b.len());
                             b.decouple();
                             DEV log() << "exhaust=true sending more" << endl;
@@ -405,6 +433,7 @@ namespace mongo {
 
         MessageServer* server = createServer(options, new MyMessageHandler());
         server->setAsTimeTracker();
+        CoarseClock::start();
 
         // This is what actually creates the sockets, but does not yet listen on them because we
         // do not want connections to just hang if recovery takes a very long time.
@@ -564,7 +593,7 @@ namespace mongo {
                 exitCleanly(EXIT_NEED_UPGRADE);
             }
 
-            getDeleter()->startWorkers();
+            startDeleterWorkers();
 
             restartInProgressIndexesFromLastShutdown(&txn);
 
@@ -587,6 +616,8 @@ namespace mongo {
                 startTTLBackgroundJob();
             }
 
+            startConfiguredWarmup();
+            startPlanCacheSnapshotter();
         }
 
         startClientCursorMonitor();
@@ -766,7 +797,7 @@ MONGO_INITIALIZER_WITH_PREREQUISITES(CreateReplicationManager, ("SetGlobalEnviro
     repl::ReplicationCoordinatorImpl* replCoord = new repl::ReplicationCoordinatorImpl(
             getGlobalReplSettings(),
             new repl::ReplicationCoordinatorExternalStateImpl,
-            new repl::NetworkInterfaceImpl,
+            new repl::NetworkInterfaceASIO,
             new repl::TopologyCoordinatorImpl(Seconds(repl::maxSyncSourceLagSecs)),
             static_cast<int64_t>(curTimeMillis64()));
     repl::setGlobalReplicationCoordinator(replCoord);
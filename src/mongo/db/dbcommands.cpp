@@ -96,6 +96,7 @@
 #include "mongo/util/md5.hpp"
 #include "mongo/util/print.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -1193,6 +1194,78 @@ namespace mongo {
             subobj.appendOID(kGLEStatsElectionIdFieldName, const_cast<OID*>(&oid));
             subobj.done();
         }
+
+        /**
+         * The options execCommand handles for every command, found in one pass over the command
+         * object rather than with a lookup apiece.  The elements point into the command object.
+         */
+        struct GenericCommandOptions {
+            explicit GenericCommandOptions(const BSONObj& cmdObj) : hasDollarMaxTimeMS(false) {
+                // As with BSONObj::getField(), the first of several fields of one name wins.
+                BSONForEach(e, cmdObj) {
+                    const StringData name = e.fieldNameStringData();
+                    if (name == "help") {
+                        if (help.eoo()) {
+                            help = e;
+                        }
+                    }
+                    else if (name == LiteParsedQuery::cmdOptionMaxTimeMS) {
+                        if (maxTimeMS.eoo()) {
+                            maxTimeMS = e;
+                        }
+                    }
+                    else if (name == "$maxTimeMS") {
+                        hasDollarMaxTimeMS = true;
+                    }
+                }
+            }
+
+            BSONElement help;
+            BSONElement maxTimeMS;
+            bool hasDollarMaxTimeMS;
+        };
+
+        /**
+         * Returns whether a command wrapped as a query, or sent with query options, should be
+         * allowed on a secondary, as Query::hasReadPreference() would, and whether it has a
+         * $maxTimeMS query option.  Takes a single pass over 'queryObj', where those take several.
+         */
+        void parseCommandQueryOptions(const BSONObj& queryObj,
+                                      bool* hasReadPreference,
+                                      bool* hasDollarMaxTimeMS) {
+            bool isComplex = false;
+            bool hasReadPreferenceField = false;
+            BSONElement queryOptions;
+            *hasDollarMaxTimeMS = false;
+
+            BSONForEach(e, queryObj) {
+                const StringData name = e.fieldNameStringData();
+                if (name[0] == '$') {
+                    if (name == "$query") {
+                        isComplex = true;
+                    }
+                    else if (name == Query::ReadPrefField.name()) {
+                        hasReadPreferenceField = true;
+                    }
+                    else if (name == "$queryOptions") {
+                        if (queryOptions.eoo()) {
+                            queryOptions = e;
+                        }
+                    }
+                    else if (name == "$maxTimeMS") {
+                        *hasDollarMaxTimeMS = true;
+                    }
+                }
+                else if (name == "query") {
+                    isComplex = true;
+                }
+            }
+
+            *hasReadPreference =
+                (isComplex && hasReadPreferenceField) ||
+                (queryOptions.isABSONObj() &&
+                 queryOptions.Obj().hasField(Query::ReadPrefField.name()));
+        }
     }
 
     /**
@@ -1213,7 +1286,9 @@ namespace mongo {
         std::string dbname = nsToDatabase( cmdns );
         scoped_ptr<MaintenanceModeSetter> mmSetter;
 
-        if ( cmdObj["help"].trueValue() ) {
+        const GenericCommandOptions options(cmdObj);
+
+        if (options.help.trueValue()) {
             txn->getCurOp()->ensureStarted();
             stringstream ss;
             ss << "help for: " << c->name << " ";
@@ -1305,12 +1380,12 @@ namespace mongo {
         }
 
         // Handle command option maxTimeMS.
-        StatusWith<int> maxTimeMS = LiteParsedQuery::parseMaxTimeMSCommand(cmdObj);
+        StatusWith<int> maxTimeMS = LiteParsedQuery::parseMaxTimeMS(options.maxTimeMS);
         if (!maxTimeMS.isOK()) {
             appendCommandStatus(result, false, maxTimeMS.getStatus().reason());
             return;
         }
-        if (cmdObj.hasField("$maxTimeMS")) {
+        if (options.hasDollarMaxTimeMS) {
             appendCommandStatus(result,
                                 false,
                                 "no such command option $maxTimeMS; use maxTimeMS instead");
@@ -1334,7 +1409,9 @@ namespace mongo {
 
         c->_commandsExecuted.increment();
 
+        Timer commandTimer;
         retval = _execCommand(txn, c, dbname, cmdObj, queryOptions, errmsg, result);
+        c->_commandLatency.recordMicros(commandTimer.micros());
 
         if ( !retval ){
             c->_commandsFailed.increment();
@@ -1366,12 +1443,14 @@ namespace mongo {
                       BufBuilder& b,
                       BSONObjBuilder& anObjBuilder,
                       int queryOptions) {
-        string dbname = nsToDatabase( ns );
-
         const char *p = strchr(ns, '.');
         if ( !p ) return false;
         if ( strcmp(p, ".$cmd") != 0 ) return false;
 
+        bool hasReadPreference;
+        bool hasDollarMaxTimeMS;
+        parseCommandQueryOptions(_cmdobj, &hasReadPreference, &hasDollarMaxTimeMS);
+
         BSONObj jsobj;
         {
             BSONElement e = _cmdobj.firstElement();
@@ -1380,7 +1459,7 @@ namespace mongo {
                                          : str::equals("query", e.fieldName())))
             {
                 jsobj = e.embeddedObject();
-                if (_cmdobj.hasField("$maxTimeMS")) {
+                if (hasDollarMaxTimeMS) {
                     Command::appendCommandStatus(anObjBuilder,
                                                  false,
                                                  "cannot use $maxTimeMS query option with "
@@ -1398,7 +1477,7 @@ namespace mongo {
 
         // Treat the command the same as if it has slaveOk bit on if it has a read
         // preference setting. This is to allow these commands to run on a secondary.
-        if (Query::hasReadPreference(_cmdobj)) {
+        if (hasReadPreference) {
             queryOptions |= QueryOption_SlaveOk;
         }
 
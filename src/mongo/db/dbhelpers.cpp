@@ -59,6 +59,7 @@
 #include "mongo/db/range_arithmetic.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
@@ -76,9 +77,17 @@ namespace mongo {
     using std::set;
     using std::string;
     using std::stringstream;
+    using std::vector;
 
     using logger::LogComponent;
 
+    // Number of documents removeRange deletes in one write unit of work, under one
+    // acquisition of the collection lock.
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 128);
+
+    // How long removeRange sleeps, without holding any locks, between batches of deletes.
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchDelayMS, int, 0);
+
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
     void Helpers::ensureIndex(OperationContext* txn,
@@ -357,7 +366,15 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
+        const size_t batchSize = std::max(rangeDeleterBatchSize, 1);
+
         while ( 1 ) {
+            // Nothing below yields, so interruptions are only noticed here.
+            txn->checkForInterrupt();
+
+            long long numDeletedInBatch = 0;
+            bool done = false;
+
             // Scoping for write lock.
             {
                 OldClientWriteContext ctx(txn, ns);
@@ -374,36 +391,45 @@ namespace mongo {
                                                                        maxInclusive,
                                                                        InternalPlanner::FORWARD,
                                                                        InternalPlanner::IXSCAN_FETCH));
-                exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
+                // The whole batch is read and deleted without yielding, so that none of the
+                // documents can change or go away in between.
+                exec->setYieldPolicy(PlanExecutor::YIELD_MANUAL);
+
+                vector<RecordId> locs;
+                vector<BSONObj> docs;
+                int batchBytes = 0;
                 RecordId rloc;
                 BSONObj obj;
-                PlanExecutor::ExecState state;
-                // This may yield so we cannot touch nsd after this.
-                state = exec->getNext(&obj, &rloc);
+                PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+                while ( locs.size() < batchSize && batchBytes < BSONObjMaxUserSize ) {
+                    state = exec->getNext(&obj, &rloc);
+                    if (PlanExecutor::ADVANCED != state) { break; }
+
+                    locs.push_back(rloc);
+                    docs.push_back(obj.getOwned());
+                    batchBytes += obj.objsize();
+                }
                 exec.reset();
-                if (PlanExecutor::IS_EOF == state) { break; }
 
                 if (PlanExecutor::DEAD == state) {
                     warning(LogComponent::kSharding) << "cursor died: aborting deletion for "
                               << min << " to " << max << " in " << ns
                               << endl;
-                    break;
+                    done = true;
                 }
-
-                if (PlanExecutor::FAILURE == state) {
+                else if (PlanExecutor::FAILURE == state) {
                     warning(LogComponent::kSharding) << "cursor error while trying to delete "
                               << min << " to " << max
                               << " in " << ns << ": "
                               << WorkingSetCommon::toStatusString(obj) << endl;
-                    break;
+                    done = true;
+                }
+                else if (PlanExecutor::IS_EOF == state) {
+                    done = true;
                 }
 
-                verify(PlanExecutor::ADVANCED == state);
-
-                WriteUnitOfWork wuow(txn);
-
-                if ( onlyRemoveOrphanedDocs ) {
+                if ( onlyRemoveOrphanedDocs && !locs.empty() ) {
                     // Do a final check in the write lock to make absolutely sure that our
                     // collection hasn't been modified in a way that invalidates our migration
                     // cleanup.
@@ -415,26 +441,38 @@ namespace mongo {
                     // In write lock, so will be the most up-to-date version
                     CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
 
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        ShardKeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractShardKeyFromDoc(obj);
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
-
-                    if ( !docIsOrphan ) {
-                        warning(LogComponent::kSharding)
-                                  << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
+                    for ( size_t i = 0; i < docs.size(); i++ ) {
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            ShardKeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractShardKeyFromDoc(docs[i]);
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning(LogComponent::kSharding)
+                                      << "aborting migration cleanup for chunk " << min
+                                      << " to " << max
+                                      << ( metadataNow ?
+                                           (string) " at document " + docs[i].toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+
+                            // Still delete the orphans that precede it.
+                            locs.resize(i);
+                            docs.resize(i);
+                            done = true;
+                            break;
+                        }
                     }
                 }
 
+                if ( locs.empty() )
+                    break;
+
                 if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(ns)) {
                     warning() << "stepped down from primary while deleting chunk; "
                               << "orphaning data in " << ns
@@ -442,19 +480,24 @@ namespace mongo {
                     return numDeleted;
                 }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                WriteUnitOfWork wuow(txn);
+                for ( size_t i = 0; i < locs.size(); i++ ) {
+                    if ( callback )
+                        callback->goingToDelete( docs[i] );
 
-                BSONObj deletedId;
-                collection->deleteDocument( txn, rloc, false, false, &deletedId );
+                    BSONObj deletedId;
+                    collection->deleteDocument( txn, locs[i], false, false, &deletedId );
+                }
                 wuow.commit();
-                numDeleted++;
+
+                numDeletedInBatch = locs.size();
+                numDeleted += numDeletedInBatch;
             }
 
             // TODO remove once the yielding below that references this timer has been removed
             Timer secondaryThrottleTime;
 
-            if (writeConcern.shouldWaitForOtherNodes() && numDeleted > 0) {
+            if (writeConcern.shouldWaitForOtherNodes() && numDeletedInBatch > 0) {
                 repl::ReplicationCoordinator::StatusAndDuration replStatus =
                         repl::getGlobalReplicationCoordinator()->awaitReplication(
                                 txn,
@@ -470,6 +513,14 @@ namespace mongo {
                 }
                 millisWaitingForReplication += replStatus.duration.total_milliseconds();
             }
+
+            if ( done )
+                break;
+
+            const int batchDelayMillis = rangeDeleterBatchDelayMS;
+            if ( batchDelayMillis > 0 ) {
+                sleepmillis( batchDelayMillis );
+            }
         }
         
         if (writeConcern.shouldWaitForOtherNodes())
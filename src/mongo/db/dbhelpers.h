@@ -165,7 +165,8 @@ namespace mongo {
          *
          * Returns -1 when no usable index exists
          *
-         * Does oplog the individual document deletions.
+         * Does oplog the individual document deletions. Documents are deleted in batches of
+         * rangeDeleterBatchSize, each in one WriteUnitOfWork under one acquisition of the lock.
          * // TODO: Refactor this mechanism, it is growing too large
          */
         static long long removeRange( OperationContext* txn,
@@ -179,14 +179,23 @@ namespace mongo {
         BufBuilder b(32768);
         b.skip(sizeof(QueryResult::Value));
         b.appendBuf(data, size);
-        QueryResult::View qr = b.buf();
+        replyToQuery(queryResultFlags, p, requestMsg, b, nReturned, startingFrom, cursorId);
+    }
+
+    void replyToQuery(int queryResultFlags,
+                      AbstractMessagingPort* p, Message& requestMsg,
+                      BufBuilder& payload,
+                      int nReturned, int startingFrom,
+                      long long cursorId) {
+        verify(payload.len() >= static_cast<int>(sizeof(QueryResult::Value)));
+        QueryResult::View qr = payload.buf();
         qr.setResultFlags(queryResultFlags);
-        qr.msgdata().setLen(b.len());
+        qr.msgdata().setLen(payload.len());
         qr.msgdata().setOperation(opReply);
         qr.setCursorId(cursorId);
         qr.setStartingFrom(startingFrom);
         qr.setNReturned(nReturned);
-        b.decouple();
+        payload.decouple();
         Message resp(qr.view2ptr(), true);
         p->reply(requestMsg, resp, requestMsg.header().getId());
     }
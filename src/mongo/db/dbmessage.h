@@ -309,6 +309,9 @@ namespace mongo {
         Message *response;
         MSGID responseTo;
         std::string exhaustNS; /* points to ns if exhaust mode. 0=normal mode*/
+        // For an exhaust find or getMore command, the getMore command to run on exhaustNS next.
+        // Empty for a legacy exhaust query, which continues with an OP_GET_MORE.
+        BSONObj exhaustCommand;
         DbResponse(Message *r, MSGID rt) : response(r), responseTo(rt){ }
         DbResponse() {
             response = 0;
@@ -323,6 +326,16 @@ namespace mongo {
                       long long cursorId = 0
                       );
 
+    /**
+     * Replies with the documents appended to 'payload', which must have started by skipping
+     * sizeof(QueryResult::Value) bytes for the header.  The header is filled in place and the
+     * buffer is handed to the reply as is, so large batches are not copied again.
+     */
+    void replyToQuery(int queryResultFlags,
+                      AbstractMessagingPort* p, Message& requestMsg,
+                      BufBuilder& payload,
+                      int nReturned, int startingFrom,
+                      long long cursorId);
 
     /* object reply helper. */
     void replyToQuery(int queryResultFlags,
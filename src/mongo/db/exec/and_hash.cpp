@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/and_hash.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/and_common-inl.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -41,6 +43,57 @@ namespace {
     // Stage execution will fail once size of all buffered data exceeds this threshold.
     const size_t kDefaultMaxMemUsageBytes = 32 * 1024 * 1024;
 
+    // Sizing of the bloom filter in front of the RecordIds kept when only those are needed. With
+    // 10 bits per RecordId and 3 probes, about 2% of the RecordIds not in the intersection get
+    // past the filter.
+    const size_t kBloomFilterBitsPerRecordId = 10;
+    const int kBloomFilterProbes = 3;
+
+    uint64_t hashRecordId(const mongo::RecordId& loc) {
+        // The finalizer of MurmurHash3, since consecutive RecordIds are common.
+        uint64_t h = static_cast<uint64_t>(loc.repr());
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    /**
+     * Calls 'probe' with the position of each bit for 'loc' in a filter of 'numBits' bits.
+     * Positions are derived from one hash by double hashing.
+     */
+    template <typename Probe>
+    bool forEachBloomBit(const mongo::RecordId& loc, uint64_t numBits, Probe probe) {
+        const uint64_t h = hashRecordId(loc);
+        const uint64_t h1 = h & 0xffffffffULL;
+        const uint64_t h2 = (h >> 32) | 1;
+        for (int i = 0; i < kBloomFilterProbes; ++i) {
+            if (!probe((h1 + i * h2) % numBits)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    struct SetBloomBit {
+        explicit SetBloomBit(std::vector<uint64_t>* bits) : bits(bits) {}
+        bool operator()(uint64_t bit) const {
+            (*bits)[bit / 64] |= (1ULL << (bit % 64));
+            return true;
+        }
+        std::vector<uint64_t>* bits;
+    };
+
+    struct TestBloomBit {
+        explicit TestBloomBit(const std::vector<uint64_t>& bits) : bits(bits) {}
+        bool operator()(uint64_t bit) const {
+            return bits[bit / 64] & (1ULL << (bit % 64));
+        }
+        const std::vector<uint64_t>& bits;
+    };
+
 } // namespace
 
 namespace mongo {
@@ -53,30 +106,42 @@ namespace mongo {
     // static
     const char* AndHashStage::kStageType = "AND_HASH";
 
-    AndHashStage::AndHashStage(WorkingSet* ws, 
+    AndHashStage::AndHashStage(OperationContext* txn,
+                               WorkingSet* ws,
                                const MatchExpression* filter,
                                const Collection* collection)
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _recordIdsOnly(false),
+          _probeHint(0),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
           _memUsage(0),
-          _maxMemUsage(kDefaultMaxMemUsageBytes) {}
+          _maxMemUsage(kDefaultMaxMemUsageBytes),
+          _memoryCharge(MemoryTracker::kAndHash) {
+        _memoryCharge.setOperationContext(txn);
+    }
 
-    AndHashStage::AndHashStage(WorkingSet* ws, 
+    AndHashStage::AndHashStage(OperationContext* txn,
+                               WorkingSet* ws,
                                const MatchExpression* filter,
                                const Collection* collection,
                                size_t maxMemUsage)
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _recordIdsOnly(false),
+          _probeHint(0),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
           _memUsage(0),
-          _maxMemUsage(maxMemUsage) {}
+          _maxMemUsage(maxMemUsage),
+          _memoryCharge(MemoryTracker::kAndHash) {
+        _memoryCharge.setOperationContext(txn);
+    }
 
     AndHashStage::~AndHashStage() {
         for (size_t i = 0; i < _children.size(); ++i) { delete _children[i]; }
@@ -84,6 +149,16 @@ namespace mongo {
 
     void AndHashStage::addChild(PlanStage* child) { _children.push_back(child); }
 
+    void AndHashStage::setRecordIdsOnly() {
+        invariant(NULL == _filter);
+        invariant(_lookAheadResults.empty());
+        _recordIdsOnly = true;
+    }
+
+    bool AndHashStage::intersectionEmpty() const {
+        return _recordIdsOnly ? _recordIds.empty() : _dataMap.empty();
+    }
+
     size_t AndHashStage::getMemUsage() const {
         return _memUsage;
     }
@@ -98,7 +173,7 @@ namespace mongo {
         // Or we're streaming in results from the last child.
 
         // If there's nothing to probe against, we're EOF.
-        if (_dataMap.empty()) { return true; }
+        if (intersectionEmpty()) { return true; }
 
         // Otherwise, we're done when the last child is done.
         invariant(_children.size() >= 2);
@@ -109,8 +184,8 @@ namespace mongo {
     PlanStage::StageState AndHashStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -189,6 +264,16 @@ namespace mongo {
                 return PlanStage::FAILURE;
             }
 
+            Status chargeStatus = _memoryCharge.set(_memUsage);
+            if (!chargeStatus.isOK()) {
+                mongoutils::str::stream ss;
+                ss << "hashed AND stage buffered data usage of " << _memUsage
+                   << " bytes exceeds memory budget: " << chargeStatus.reason();
+                Status status(ErrorCodes::ExceededMemoryLimit, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+                return PlanStage::FAILURE;
+            }
+
             if (0 == _currentChild) {
                 return readFirstChild(out);
             }
@@ -207,7 +292,7 @@ namespace mongo {
         // hash map.
 
         // We should be EOF if we're not hashing results and the dataMap is empty.
-        verify(!_dataMap.empty());
+        verify(!intersectionEmpty());
 
         // We probe _dataMap with the last child.
         verify(_currentChild == _children.size() - 1);
@@ -228,6 +313,21 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        if (_recordIdsOnly) {
+            const size_t pos = findRecordId(member->loc);
+            if (pos == _recordIds.size() || _recordIdsSeen[pos]) {
+                // Not in every previous child, or already returned.
+                _ws->free(*out);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+
+            // There's no filter, and the parent doesn't need key data from other children.
+            _recordIdsSeen[pos] = true;
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         DataMap::iterator it = _dataMap.find(member->loc);
         if (_dataMap.end() == it) {
             // Child's output wasn't in every previous child.  Throw it out.
@@ -287,6 +387,15 @@ namespace mongo {
                 return PlanStage::NEED_TIME;
             }
 
+            if (_recordIdsOnly) {
+                // Duplicates are taken care of by sortRecordIds().
+                _recordIds.push_back(member->loc);
+                _memUsage += sizeof(RecordId);
+                _ws->free(id);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+
             if (!_dataMap.insert(std::make_pair(member->loc, id)).second) {
                 // Didn't insert because we already had this loc inside the map. This should only
                 // happen if we're seeing a newer copy of the same doc in a more recent snapshot.
@@ -306,14 +415,19 @@ namespace mongo {
             // Done reading child 0.
             _currentChild = 1;
 
+            if (_recordIdsOnly) {
+                sortRecordIds();
+            }
+
             // If our first child was empty, don't scan any others, no possible results.
-            if (_dataMap.empty()) {
+            if (intersectionEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
 
             ++_commonStats.needTime;
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_recordIdsOnly ? _recordIds.size()
+                                                                  : _dataMap.size());
 
             return PlanStage::NEED_TIME;
         }
@@ -360,7 +474,13 @@ namespace mongo {
             }
 
             verify(member->hasLoc());
-            if (_dataMap.end() == _dataMap.find(member->loc)) {
+            if (_recordIdsOnly) {
+                const size_t pos = findRecordId(member->loc);
+                if (pos != _recordIds.size()) {
+                    _recordIdsSeen[pos] = true;
+                }
+            }
+            else if (_dataMap.end() == _dataMap.find(member->loc)) {
                 // Ignore.  It's not in any previous child.
             }
             else {
@@ -382,6 +502,10 @@ namespace mongo {
             // Finished with a child.
             ++_currentChild;
 
+            if (_recordIdsOnly) {
+                keepSeenRecordIds();
+            }
+
             // Keep elements of _dataMap that are in _seenMap.
             DataMap::iterator it = _dataMap.begin();
             while (it != _dataMap.end()) {
@@ -399,14 +523,15 @@ namespace mongo {
                 else { ++it; }
             }
 
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_recordIdsOnly ? _recordIds.size()
+                                                                  : _dataMap.size());
 
             _seenMap.clear();
 
             // _dataMap is now the intersection of the first _currentChild nodes.
 
             // If we have nothing to AND with after finishing any child, stop.
-            if (_dataMap.empty()) {
+            if (intersectionEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
@@ -446,8 +571,76 @@ namespace mongo {
         }
     }
 
+    void AndHashStage::sortRecordIds() {
+        std::sort(_recordIds.begin(), _recordIds.end());
+        _recordIds.erase(std::unique(_recordIds.begin(), _recordIds.end()), _recordIds.end());
+        std::vector<RecordId>(_recordIds).swap(_recordIds);
+
+        _recordIdsSeen.assign(_recordIds.size(), false);
+        buildBloomFilter();
+    }
+
+    void AndHashStage::keepSeenRecordIds() {
+        size_t kept = 0;
+        for (size_t i = 0; i < _recordIds.size(); ++i) {
+            if (_recordIdsSeen[i]) {
+                _recordIds[kept++] = _recordIds[i];
+            }
+        }
+        _recordIds.resize(kept);
+        std::vector<RecordId>(_recordIds).swap(_recordIds);
+
+        _recordIdsSeen.assign(_recordIds.size(), false);
+        _probeHint = 0;
+        buildBloomFilter();
+    }
+
+    void AndHashStage::buildBloomFilter() {
+        const size_t numWords =
+            (_recordIds.size() * kBloomFilterBitsPerRecordId + 63) / 64 + 1;
+        _bloomFilter.assign(numWords, 0);
+
+        SetBloomBit setBit(&_bloomFilter);
+        for (size_t i = 0; i < _recordIds.size(); ++i) {
+            forEachBloomBit(_recordIds[i], numWords * 64, setBit);
+        }
+
+        _memUsage = _recordIds.size() * sizeof(RecordId)
+                  + _recordIdsSeen.size() / 8
+                  + _bloomFilter.size() * sizeof(uint64_t);
+    }
+
+    size_t AndHashStage::findRecordId(const RecordId& loc) {
+        const size_t notFound = _recordIds.size();
+        if (!forEachBloomBit(loc, _bloomFilter.size() * 64, TestBloomBit(_bloomFilter))) {
+            return notFound;
+        }
+
+        std::vector<RecordId>::const_iterator begin = _recordIds.begin();
+        std::vector<RecordId>::const_iterator end = _recordIds.end();
+        if (_probeHint < _recordIds.size() && _recordIds[_probeHint] <= loc) {
+            // Gallop forward from where the last search ended.
+            size_t low = _probeHint;
+            size_t step = 1;
+            while (low + step < _recordIds.size() && _recordIds[low + step] < loc) {
+                low += step;
+                step *= 2;
+            }
+            begin += low;
+            end = _recordIds.begin() + std::min(low + step + 1, _recordIds.size());
+        }
+
+        std::vector<RecordId>::const_iterator it = std::lower_bound(begin, end, loc);
+        _probeHint = it - _recordIds.begin();
+        if (it == _recordIds.end() || *it != loc) {
+            return notFound;
+        }
+        return _probeHint;
+    }
+
     void AndHashStage::saveState() {
         ++_commonStats.yields;
+        _memoryCharge.setOperationContext(NULL);
 
         for (size_t i = 0; i < _children.size(); ++i) {
             _children[i]->saveState();
@@ -456,6 +649,7 @@ namespace mongo {
 
     void AndHashStage::restoreState(OperationContext* opCtx) {
         ++_commonStats.unyields;
+        _memoryCharge.setOperationContext(opCtx);
 
         for (size_t i = 0; i < _children.size(); ++i) {
             _children[i]->restoreState(opCtx);
@@ -484,6 +678,56 @@ namespace mongo {
             }
         }
 
+        if (_recordIdsOnly) {
+            std::vector<bool>::iterator seen = _recordIdsSeen.end();
+            std::vector<RecordId>::iterator it;
+            if (0 == _currentChild) {
+                // Not sorted yet.
+                it = std::find(_recordIds.begin(), _recordIds.end(), dl);
+            }
+            else {
+                const size_t pos = findRecordId(dl);
+                it = _recordIds.begin() + pos;
+                if (pos != _recordIds.size()) {
+                    seen = _recordIdsSeen.begin() + pos;
+                }
+            }
+
+            if (_recordIds.end() == it) { return; }
+
+            if (!_hashingChildren && *seen) {
+                // Already returned.
+                return;
+            }
+
+            // Same as below, but there's no WSM for it yet.
+            if (_hashingChildren) {
+                ++_specificStats.flaggedInProgress;
+            }
+            else {
+                ++_specificStats.flaggedButPassed;
+            }
+
+            WorkingSetID id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(id);
+            member->loc = dl;
+            member->state = WorkingSetMember::LOC_AND_IDX;
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            _ws->flagForReview(id);
+
+            if (0 == _currentChild) {
+                _recordIds.erase(std::remove(_recordIds.begin(), _recordIds.end(), dl),
+                                 _recordIds.end());
+                _memUsage = _recordIds.size() * sizeof(RecordId);
+            }
+            else {
+                _recordIds.erase(it);
+                _recordIdsSeen.erase(seen);
+                _probeHint = 0;
+            }
+            return;
+        }
+
         // If it's a deletion, we have to forget about the RecordId, and since the AND-ing is by
         // RecordId we can't continue processing it even with the object.
         //
@@ -34,6 +34,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/memory_tracker.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_set.h"
 
@@ -49,18 +50,24 @@ namespace mongo {
      * is fetched and added to the WorkingSet as "flagged for further review."  Because this stage
      * operates with RecordIds, we are unable to evaluate the AND for the invalidated RecordId, and it
      * must be fully matched later.
+     *
+     * If the parent only needs the RecordIds of the results, see setRecordIdsOnly(), the outputs
+     * of all children but the last are kept as a sorted array of RecordIds instead, which takes a
+     * small fraction of the memory of the hash table and its WorkingSetMembers.
      */
     class AndHashStage : public PlanStage {
     public:
-        AndHashStage(WorkingSet* ws,
+        AndHashStage(OperationContext* txn,
+                     WorkingSet* ws,
                      const MatchExpression* filter,
                      const Collection* collection);
 
         /**
          * For testing only. Allows tests to set memory usage threshold.
          */
-        AndHashStage(WorkingSet* ws, 
-                     const MatchExpression* filter, 
+        AndHashStage(OperationContext* txn,
+                     WorkingSet* ws,
+                     const MatchExpression* filter,
                      const Collection* collection,
                      size_t maxMemUsage);
 
@@ -68,6 +75,13 @@ namespace mongo {
 
         void addChild(PlanStage* child);
 
+        /**
+         * Tells this stage that its results are only used for their RecordIds, e.g. because the
+         * parent fetches them. Index key data from all children but the last is then dropped.
+         * Only allowed for stages without a filter, and must be called before work().
+         */
+        void setRecordIdsOnly();
+
         /**
          * Returns memory usage.
          * For testing only.
@@ -100,6 +114,25 @@ namespace mongo {
         StageState hashOtherChildren(WorkingSetID* out);
         StageState workChild(size_t childNo, WorkingSetID* out);
 
+        /** True if no RecordId is left that could be in the intersection. */
+        bool intersectionEmpty() const;
+
+        //
+        // Used instead of _dataMap and _seenMap if _recordIdsOnly is set.
+        //
+
+        /** Sorts and dedups _recordIds once the first child is done, and sets up the filter. */
+        void sortRecordIds();
+
+        /** Drops all entries of _recordIds that were not seen by the child just finished. */
+        void keepSeenRecordIds();
+
+        /** Rebuilds _bloomFilter from _recordIds and recomputes _memUsage. */
+        void buildBloomFilter();
+
+        /** Returns the position of 'loc' in the sorted _recordIds, or _recordIds.size(). */
+        size_t findRecordId(const RecordId& loc);
+
         // Not owned by us.
         const Collection* _collection;
 
@@ -127,6 +160,24 @@ namespace mongo {
         typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
         SeenMap _seenMap;
 
+        // See setRecordIdsOnly().
+        bool _recordIdsOnly;
+
+        // The intersection of the children read so far. Sorted once the first child is done.
+        std::vector<RecordId> _recordIds;
+
+        // Parallel to a sorted _recordIds. Marks what the child being read produced, or while
+        // probing with the last child, what was already returned.
+        std::vector<bool> _recordIdsSeen;
+
+        // A bloom filter over _recordIds, which rejects most RecordIds not in the intersection
+        // without searching for them.
+        std::vector<uint64_t> _bloomFilter;
+
+        // Where the last search of _recordIds ended. Children producing RecordIds in increasing
+        // order are searched for from there, which amounts to merging them with _recordIds.
+        size_t _probeHint;
+
         // True if we're still intersecting _children[0..._children.size()-1].
         bool _hashingChildren;
 
@@ -145,6 +196,10 @@ namespace mongo {
         // Upper limit for buffered data memory usage.
         // Defaults to 32 MB (See kMaxBytes in and_hash.cpp).
         size_t _maxMemUsage;
+
+        // Charges _memUsage to the AND_HASH subsystem and to the operation, which may have
+        // budgets of their own.
+        MemoryCharge _memoryCharge;
     };
 
 }  // namespace mongo
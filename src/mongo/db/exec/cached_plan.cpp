@@ -37,6 +37,7 @@
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/background_replanner.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
@@ -71,10 +72,10 @@ namespace mongo {
     }
 
     Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeCycles. There's lots of
         // execution work that happens here, so this is needed for the time accounting to
         // make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         // If we work this many times during the trial period, then we will replan the
         // query from scratch.
@@ -160,7 +161,26 @@ namespace mongo {
         }
 
         // If we're here, the trial period took more than 'maxWorksBeforeReplan' work cycles. This
-        // plan is taking too long, so we replan from scratch.
+        // plan is taking too long, so we replan from scratch, either in the background while this
+        // query carries on with the cached plan or right here.
+        PlanCache* cache = _collection->infoCache()->getPlanCache();
+        if (internalQueryCacheBackgroundReplan) {
+            BackgroundReplanner* replanner = BackgroundReplanner::get();
+            if (replanner &&
+                replanner->schedule(*_canonicalQuery, cache->computeKey(*_canonicalQuery))) {
+                LOG(1) << "Execution of cached plan required "
+                       << maxWorksBeforeReplan
+                       << " works, but was originally cached with only "
+                       << _decisionWorks
+                       << " works. Continuing with the cached plan and replanning in the"
+                       << " background query: "
+                       << _canonicalQuery->toStringShort()
+                       << " plan summary: "
+                       << Explain::getPlanSummary(_root.get());
+                return Status::OK();
+            }
+        }
+
         LOG(1) << "Execution of cached plan required "
                << maxWorksBeforeReplan
                << " works, but was originally cached with only "
@@ -170,6 +190,7 @@ namespace mongo {
                << " plan summary before replan: "
                << Explain::getPlanSummary(_root.get());
 
+        cache->noteReplan(false);
         const bool shouldCache = true;
         return replan(yieldPolicy, shouldCache);
     }
@@ -270,8 +291,8 @@ namespace mongo {
     PlanStage::StageState CachedPlanStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -88,6 +88,9 @@ namespace mongo {
          * Feedback from the trial period is passed to the plan cache. If the performance is lower
          * than expected, the old plan is evicted and a new plan is selected from scratch (again
          * yielding according to 'yieldPolicy'). Otherwise, the cached plan is run.
+         *
+         * With internalQueryCacheBackgroundReplan, a plan which performs worse than expected is
+         * instead handed to the BackgroundReplanner and this query keeps running the cached plan.
          */
         Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
@@ -36,10 +36,13 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/storage/record_fetcher.h"
+#include "mongo/util/cycle_clock.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 #include "mongo/db/client.h" // XXX-ERH
 
@@ -58,8 +61,10 @@ namespace mongo {
         : _txn(txn),
           _workingSet(workingSet),
           _filter(filter),
+          _compiledFilter(Filter::compile(filter)),
           _params(params),
           _isDead(false),
+          _returnPinnedRecords(false),
           _wsidForFetch(_workingSet->allocate()),
           _commonStats(kStageType) {
         // Explain reports the direction of the collection scan.
@@ -75,8 +80,8 @@ namespace mongo {
     PlanStage::StageState CollectionScan::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (_isDead) { return PlanStage::DEAD; }
 
@@ -121,6 +126,22 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        // Move past the pinned document we returned last time. If it was deleted while we yielded,
+        // restoring the iterator already moved it on.
+        if (!_pendingAdvance.isNull()) {
+            try {
+                if (_iter->curr() == _pendingAdvance) {
+                    _iter->getNext();
+                }
+            }
+            catch (const WriteConflictException& wce) {
+                // If getNext thows, it leaves us on the original document.
+                *out = WorkingSet::INVALID_ID;
+                return PlanStage::NEED_YIELD;
+            }
+            _pendingAdvance = RecordId();
+        }
+
         // Should we try getNext() on the underlying _iter?
         if (isEOF())
             return PlanStage::IS_EOF;
@@ -152,6 +173,27 @@ namespace mongo {
             }
         }
 
+        // The time spent reading the document and advancing the iterator is added to
+        // storageTimeCycles, of the stage and of the operation.
+        const long long storageStart = CycleClock::now();
+
+        if (_returnPinnedRecords) {
+            // The document is only valid while the iterator stays on it, so advance on the next
+            // call instead.
+            const Snapshotted<BSONObj> obj(_txn->recoveryUnit()->getSnapshotId(),
+                                           _iter->dataForPinned(curr).releaseToBson());
+            _pendingAdvance = curr;
+            _addStorageTime(CycleClock::now() - storageStart);
+
+            WorkingSetID id = _workingSet->allocate();
+            WorkingSetMember* member = _workingSet->get(id);
+            member->loc = curr;
+            member->obj = obj;
+            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+
+            return returnIfMatches(member, id, out);
+        }
+
         // Do this before advancing because it is more efficient while the iterator is still on this
         // document.
         const Snapshotted<BSONObj> obj = Snapshotted<BSONObj>(_txn->recoveryUnit()->getSnapshotId(),
@@ -167,6 +209,7 @@ namespace mongo {
             *out = WorkingSet::INVALID_ID;
             return PlanStage::NEED_YIELD;
         }
+        _addStorageTime(CycleClock::now() - storageStart);
 
         WorkingSetID id = _workingSet->allocate();
         WorkingSetMember* member = _workingSet->get(id);
@@ -177,12 +220,23 @@ namespace mongo {
         return returnIfMatches(member, id, out);
     }
 
+    PlanStage::StageState CollectionScan::workBatch(size_t maxWorks,
+                                                    vector<WorkingSetID>* results,
+                                                    WorkingSetID* out) {
+        return workBatchWith(this, maxWorks, results, out);
+    }
+
+    void CollectionScan::_addStorageTime(long long cycles) {
+        _commonStats.storageTimeCycles += cycles;
+        _txn->getCurOp()->debug().storageTimeCycles += cycles;
+    }
+
     PlanStage::StageState CollectionScan::returnIfMatches(WorkingSetMember* member,
                                                           WorkingSetID memberID,
                                                           WorkingSetID* out) {
         ++_specificStats.docsTested;
 
-        if (Filter::passes(member, _filter)) {
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
             *out = memberID;
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
@@ -194,6 +248,14 @@ namespace mongo {
         }
     }
 
+    bool CollectionScan::returnPinnedRecords() {
+        if (_params.collection && _params.collection->isCapped()) {
+            return false;
+        }
+        _returnPinnedRecords = true;
+        return true;
+    }
+
     bool CollectionScan::isEOF() {
         if ((0 != _params.maxScan) && (_specificStats.docsTested >= _params.maxScan)) {
             return true;
@@ -242,7 +304,10 @@ namespace mongo {
         _txn = opCtx;
         ++_commonStats.unyields;
         if (NULL != _iter) {
-            if (!_iter->restoreState(opCtx)) {
+            Timer timer;
+            const bool restored = _iter->restoreState(opCtx);
+            _commonStats.restoreStateMicros += timer.micros();
+            if (!restored) {
                 warning() << "Collection dropped or state deleted during yield of CollectionScan: "
                           << opCtx->getNS();
                 _isDead = true;
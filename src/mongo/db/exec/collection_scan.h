@@ -33,6 +33,7 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -55,6 +56,10 @@ namespace mongo {
                        const MatchExpression* filter);
 
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return !_returnPinnedRecords; }
         virtual bool isEOF();
 
         virtual void invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type);
@@ -71,6 +76,22 @@ namespace mongo {
 
         virtual const SpecificStats* getSpecificStats() const;
 
+        const CollectionScanParams& getParams() const { return _params; }
+
+        const MatchExpression* getFilter() const { return _filter; }
+
+        /**
+         * Makes the documents this stage returns point straight into the storage engine's buffers
+         * (see RecordIterator::dataForPinned()) instead of being copied. To keep them valid, the
+         * iterator is only advanced past a document on the next call to work(). Each document is
+         * therefore only valid until the next call to work() or saveState(), so this may only be
+         * used when every consumer copies or discards a result before asking for the next one.
+         *
+         * Returns false, and has no effect, on capped collections: restoring the iterator after a
+         * yield is only safe for them once it has moved past the returned document.
+         */
+        bool returnPinnedRecords();
+
         static const char* kStageType;
 
     private:
@@ -82,6 +103,11 @@ namespace mongo {
                                    WorkingSetID memberID,
                                    WorkingSetID* out);
 
+        /**
+         * Adds "cycles" spent in the storage engine to the stats and to the operation's OpDebug.
+         */
+        void _addStorageTime(long long cycles);
+
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
@@ -91,6 +117,9 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // The compiled form of _filter, if it has one.
+        boost::scoped_ptr<CompiledMatchExpression> _compiledFilter;
+
         boost::scoped_ptr<RecordIterator> _iter;
 
         CollectionScanParams _params;
@@ -99,6 +128,13 @@ namespace mongo {
 
         RecordId _lastSeenLoc;
 
+        // See returnPinnedRecords().
+        bool _returnPinnedRecords;
+
+        // When returning pinned records, the last document returned, which _iter still has to be
+        // advanced past. Null if there is none.
+        RecordId _pendingAdvance;
+
         // We allocate a working set member with this id on construction of the stage. It gets
         // used for all fetch requests, changing the RecordId as appropriate.
         const WorkingSetID _wsidForFetch;
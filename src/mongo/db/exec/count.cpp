@@ -30,9 +30,17 @@
 
 #include "mongo/db/exec/count.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/count_scan.h"
+#include "mongo/db/exec/parallel_collection_scanner.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
@@ -53,12 +61,14 @@ namespace mongo {
           _leftToSkip(request.skip),
           _ws(ws),
           _child(child),
+          _triedFastCount(false),
+          _fastCounted(false),
           _commonStats(kStageType) { }
 
     CountStage::~CountStage() { }
 
     bool CountStage::isEOF() {
-        if (_specificStats.trivialCount) {
+        if (_specificStats.trivialCount || _fastCounted) {
             return true;
         }
 
@@ -71,7 +81,12 @@ namespace mongo {
 
     void CountStage::trivialCount() {
         invariant(_collection);
-        long long nCounted = _collection->numRecords(_txn);
+        countFromTotal(_collection->numRecords(_txn));
+        _specificStats.trivialCount = true;
+    }
+
+    void CountStage::countFromTotal(long long nMatched) {
+        long long nCounted = nMatched;
 
         if (0 != _request.skip) {
             nCounted -= _request.skip;
@@ -91,14 +106,133 @@ namespace mongo {
 
         _specificStats.nCounted = nCounted;
         _specificStats.nSkipped = _request.skip;
-        _specificStats.trivialCount = true;
+    }
+
+namespace {
+
+    class CountingWorker : public ParallelCollectionScanner::Worker {
+    public:
+        CountingWorker() : nMatched(0) { }
+
+        virtual void run(ParallelCollectionScanner::Reader* reader) {
+            BSONObj obj;
+            while (reader->getNext(&obj)) {
+                nMatched++;
+            }
+        }
+
+        long long nMatched;
+    };
+
+}  // namespace
+
+    bool CountStage::parallelCount() {
+        if (internalQueryParallelScanThreads < 2 ||
+            NULL == _collection ||
+            STAGE_COLLSCAN != _child->stageType()) {
+            return false;
+        }
+
+        const CollectionScan* scan = static_cast<const CollectionScan*>(_child.get());
+        const CollectionScanParams& params = scan->getParams();
+        if (!params.start.isNull() ||
+            params.direction != CollectionScanParams::FORWARD ||
+            params.tailable ||
+            params.maxScan != 0 ||
+            !ParallelCollectionScanner::canEvaluateInParallel(scan->getFilter())) {
+            return false;
+        }
+
+        ParallelCollectionScanner scanner(_txn, _collection, scan->getFilter());
+        if (scanner.numPartitions() < 2) {
+            return false;
+        }
+
+        const size_t numThreads = std::min(scanner.numPartitions(),
+                                           static_cast<size_t>(internalQueryParallelScanThreads));
+        OwnedPointerVector<CountingWorker> counters;
+        std::vector<ParallelCollectionScanner::Worker*> workers;
+        for (size_t i = 0; i < numThreads; ++i) {
+            counters.push_back(new CountingWorker());
+            workers.push_back(counters[i]);
+        }
+
+        uassertStatusOK(scanner.run(workers));
+
+        long long nMatched = 0;
+        for (size_t i = 0; i < counters.size(); ++i) {
+            nMatched += counters[i]->nMatched;
+        }
+
+        countFromTotal(nMatched);
+        _fastCounted = true;
+        return true;
+    }
+
+    bool CountStage::approximateCount() {
+        if (!_request.approximate ||
+            NULL == _collection ||
+            STAGE_COUNT_SCAN != _child->stageType()) {
+            return false;
+        }
+
+        long long estimate;
+        try {
+            CountScan* scan = static_cast<CountScan*>(_child.get());
+            if (!scan->estimateCount(_collection->numRecords(_txn), &estimate)) {
+                return false;
+            }
+        }
+        catch (const WriteConflictException& wce) {
+            // Count the range exactly instead.
+            return false;
+        }
+
+        countFromTotal(estimate);
+        _specificStats.approximate = true;
+        _fastCounted = true;
+        return true;
+    }
+
+    PlanStage::StageState CountStage::workChildBatch(WorkingSetID* out) {
+        // Don't take more results than the limit needs.
+        long long maxWorks = internalQueryExecWorkBatchSize;
+        if (_request.limit > 0) {
+            const long long needed = _leftToSkip + _request.limit - _specificStats.nCounted;
+            maxWorks = std::min(maxWorks, std::max(needed, 1LL));
+        }
+
+        _batchResults.clear();
+        const StageState state = _child->workBatch(maxWorks, &_batchResults, out);
+        for (size_t i = 0; i < _batchResults.size(); ++i) {
+            countResult(_batchResults[i]);
+        }
+        return state;
+    }
+
+    void CountStage::countResult(WorkingSetID id) {
+        // We got a result. If we're still skipping, then decrement the number left to skip.
+        // Otherwise increment the count until we hit the limit.
+        if (_leftToSkip > 0) {
+            _leftToSkip--;
+            _specificStats.nSkipped++;
+        }
+        else {
+            _specificStats.nCounted++;
+        }
+
+        // Count doesn't need the actual results, so we just discard any valid working
+        // set members that got returned from the child.
+        if (WorkingSet::INVALID_ID != id) {
+            _ws->free(id);
+        }
     }
 
     PlanStage::StageState CountStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         // This stage never returns a working set member.
         *out = WorkingSet::INVALID_ID;
@@ -118,8 +252,25 @@ namespace mongo {
         // For non-trivial counts, we should always have a child stage from which we can retrieve
         // results.
         invariant(_child.get());
+
+        if (!_triedFastCount) {
+            _triedFastCount = true;
+            if (approximateCount() || parallelCount()) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+        }
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState state = _child->work(&id);
+        PlanStage::StageState state;
+        if (internalQueryExecWorkBatchSize > 0 && _child->supportsWorkBatch()) {
+            state = workChildBatch(&id);
+        }
+        else {
+            state = _child->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                countResult(id);
+            }
+        }
 
         if (PlanStage::IS_EOF == state) {
             _commonStats.isEOF = true;
@@ -139,23 +290,6 @@ namespace mongo {
             }
             return state;
         }
-        else if (PlanStage::ADVANCED == state) {
-            // We got a result. If we're still skipping, then decrement the number left to skip.
-            // Otherwise increment the count until we hit the limit.
-            if (_leftToSkip > 0) {
-                _leftToSkip--;
-                _specificStats.nSkipped++;
-            }
-            else {
-                _specificStats.nCounted++;
-            }
-
-            // Count doesn't need the actual results, so we just discard any valid working
-            // set members that got returned from the child.
-            if (WorkingSet::INVALID_ID != id) {
-                _ws->free(id);
-            }
-        }
         else if (PlanStage::NEED_YIELD == state) {
             *out = id;
             _commonStats.needYield++;
@@ -38,6 +38,8 @@ namespace mongo {
      * A description of a request for a count operation. Copyable.
      */
     struct CountRequest {
+        CountRequest() : limit(0), skip(0), explain(false), approximate(false) { }
+
         // Namespace to operate on (e.g. "foo.bar").
         std::string ns;
 
@@ -62,6 +64,10 @@ namespace mongo {
 
         // Whether this is an explain of a count.
         bool explain;
+
+        // Whether an estimate will do when the count is over a range of a single index. See
+        // CountScan::estimateCount().
+        bool approximate;
     };
 
     /**
@@ -111,6 +117,38 @@ namespace mongo {
          */
         void trivialCount();
 
+        /**
+         * If the child is a plain scan of the whole collection and parallel scans are enabled,
+         * counts the matching documents with a ParallelCollectionScanner instead of working the
+         * child. Returns true if it did, in which case the result is in '_specificStats'.
+         *
+         * Throws if the operation is interrupted during the scan.
+         */
+        bool parallelCount();
+
+        /**
+         * If an approximate count was requested and the child is a COUNT_SCAN, sets the count
+         * from its estimate. Returns true if it did.
+         */
+        bool approximateCount();
+
+        /**
+         * Works the child for a batch of results, counting those it returns, and returns the
+         * state it ended with.
+         */
+        StageState workChildBatch(WorkingSetID* out);
+
+        /**
+         * Skips or counts one result of the child, and frees its working set member.
+         */
+        void countResult(WorkingSetID id);
+
+        /**
+         * Sets the count given the number of documents matching the query, applying the skip
+         * and limit.
+         */
+        void countFromTotal(long long nMatched);
+
         // Transactional context for read locks. Not owned by us.
         OperationContext* _txn;
 
@@ -128,6 +166,14 @@ namespace mongo {
 
         boost::scoped_ptr<PlanStage> _child;
 
+        // Whether approximateCount() and parallelCount() have been tried, and whether one of
+        // them produced the count.
+        bool _triedFastCount;
+        bool _fastCounted;
+
+        // Results of the child's last workBatch().
+        std::vector<WorkingSetID> _batchResults;
+
         CommonStats _commonStats;
         CountStats _specificStats;
     };
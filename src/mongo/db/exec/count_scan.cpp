@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/count_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -37,6 +39,14 @@ namespace mongo {
     using std::auto_ptr;
     using std::vector;
 
+    namespace {
+        // estimateCount() counts up to this many entries before it resorts to sampling.
+        const long long kMaxEntriesToCount = 10 * 1000;
+
+        // The number of random index entries estimateCount() samples.
+        const int kNumSamples = 1000;
+    }
+
     // static
     const char* CountScan::kStageType = "COUNT_SCAN";
 
@@ -66,14 +76,15 @@ namespace mongo {
         ++_commonStats.works;
         if (_commonStats.isEOF) return PlanStage::IS_EOF;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         boost::optional<IndexKeyEntry> entry;
         const bool needInit = !_cursor;
         try {
-            // We don't care about the keys.
-            const auto kWantLoc = SortedDataInterface::Cursor::kWantLoc;
+            // We don't care about the keys, and only need the RecordIds to dedup.
+            const auto kWantLoc = _shouldDedup ? SortedDataInterface::Cursor::kWantLoc
+                                               : SortedDataInterface::Cursor::kJustExistance;
 
             if (needInit) {
                 // First call to work().  Perform cursor init.
@@ -114,6 +125,77 @@ namespace mongo {
         return PlanStage::ADVANCED;
     }
 
+    PlanStage::StageState CountScan::workBatch(size_t maxWorks,
+                                               vector<WorkingSetID>* results,
+                                               WorkingSetID* out) {
+        return workBatchWith(this, maxWorks, results, out);
+    }
+
+    bool CountScan::estimateCount(long long numRecords, long long* out) {
+        invariant(!_cursor);
+
+        // Only then does the index have an entry for every document in the collection.
+        if (_shouldDedup || _descriptor->isSparse() || _descriptor->isPartial()) {
+            return false;
+        }
+
+        // Small ranges are counted exactly. Sampling wouldn't see them anyway.
+        long long numCounted = 0;
+        {
+            std::unique_ptr<SortedDataInterface::Cursor> cursor = _iam->newCursor(_txn);
+            cursor->setEndPosition(_params.endKey, _params.endKeyInclusive);
+
+            const auto kJustExistance = SortedDataInterface::Cursor::kJustExistance;
+            for (boost::optional<IndexKeyEntry> entry =
+                     cursor->seek(_params.startKey, _params.startKeyInclusive, kJustExistance);
+                 entry;
+                 entry = cursor->next(kJustExistance)) {
+                ++_specificStats.keysExamined;
+                if (++numCounted > kMaxEntriesToCount) {
+                    break;
+                }
+            }
+        }
+
+        if (numCounted <= kMaxEntriesToCount) {
+            *out = numCounted;
+            return true;
+        }
+
+        std::unique_ptr<SortedDataInterface::RandomCursor> random =
+            _iam->newRandomCursor(_txn);
+        if (!random) {
+            return false;
+        }
+
+        const Ordering ordering = Ordering::make(_descriptor->keyPattern());
+        int numSampled = 0;
+        int numInRange = 0;
+        for (; numSampled < kNumSamples; ++numSampled) {
+            boost::optional<IndexKeyEntry> entry = random->next();
+            if (!entry) {
+                break;
+            }
+            ++_specificStats.keysExamined;
+
+            const int startCmp = entry->key.woCompare(_params.startKey, ordering, false);
+            const int endCmp = entry->key.woCompare(_params.endKey, ordering, false);
+            if ((startCmp > 0 || (startCmp == 0 && _params.startKeyInclusive)) &&
+                (endCmp < 0 || (endCmp == 0 && _params.endKeyInclusive))) {
+                ++numInRange;
+            }
+        }
+
+        if (numSampled == 0) {
+            return false;
+        }
+
+        const long long estimate =
+            static_cast<long long>(static_cast<double>(numRecords) * numInRange / numSampled);
+        *out = std::max(numCounted, estimate);
+        return true;
+    }
+
     bool CountScan::isEOF() {
         return _commonStats.isEOF;
     }
@@ -71,6 +71,10 @@ namespace mongo {
         virtual ~CountScan() { }
 
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return true; }
         virtual bool isEOF();
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -88,6 +92,17 @@ namespace mongo {
 
         static const char* kStageType;
 
+        /**
+         * Estimates the number of entries between the start and end keys, for a count which will
+         * make do with an approximate answer. Counts the first entries, and if there are more than
+         * a few thousand, samples the index with a random cursor and scales the fraction of
+         * samples in range by 'numRecords', the size of the collection. Returns false if the
+         * estimate can't be made that way, in which case the range should be counted exactly.
+         *
+         * Must be called before work().
+         */
+        bool estimateCount(long long numRecords, long long* out);
+
     private:
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
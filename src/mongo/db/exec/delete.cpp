@@ -63,6 +63,8 @@ namespace mongo {
           _child(child),
           _idRetrying(WorkingSet::INVALID_ID),
           _idReturning(WorkingSet::INVALID_ID),
+          _batchBytes(0),
+          _batchFull(false),
           _commonStats(kStageType) { }
 
     DeleteStage::~DeleteStage() {}
@@ -76,18 +78,30 @@ namespace mongo {
         }
         return _idRetrying == WorkingSet::INVALID_ID
             && _idReturning == WorkingSet::INVALID_ID
+            && _batch.empty()
             && _child->isEOF();
     }
 
+    bool DeleteStage::isBatching() const {
+        return _params.isMulti
+            && !_params.returnDeleted
+            && !_params.isExplain
+            && _params.maxBatchDocs > 1;
+    }
+
     PlanStage::StageState DeleteStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_collection); // If isEOF() returns false, we must have a collection.
 
+        if (isBatching()) {
+            return workBatched(out);
+        }
+
         // It is possible that after a delete was executed, a WriteConflictException occurred
         // and prevented us from returning ADVANCED with the old version of the document.
         if (_idReturning != WorkingSet::INVALID_ID) {
@@ -258,6 +272,150 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState DeleteStage::workBatched(WorkingSetID* out) {
+        if (!_batchFull && !_child->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            const StageState status = _child->work(&id);
+
+            if (PlanStage::ADVANCED == status) {
+                WorkingSetMember* member = _ws->get(id);
+                if (!member->hasLoc()) {
+                    // See work().
+                    _ws->free(id);
+                    ++_specificStats.nInvalidateSkips;
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
+                }
+                invariant(member->hasObj());
+
+                _batch.push_back(id);
+                _batchLocs[member->loc] = id;
+                _batchBytes += member->obj.value().objsize();
+                _batchFull = _batch.size() >= _params.maxBatchDocs
+                          || _batchBytes >= _params.maxBatchBytes;
+            }
+            else if (PlanStage::FAILURE == status) {
+                *out = id;
+                if (WorkingSet::INVALID_ID == id) {
+                    const std::string errmsg = "delete stage failed to read in results from child";
+                    *out = WorkingSetCommon::allocateStatusMember(
+                        _ws, Status(ErrorCodes::InternalError, errmsg));
+                }
+                return PlanStage::FAILURE;
+            }
+            else if (PlanStage::NEED_YIELD == status) {
+                // The batch is re-checked against the new snapshot before it's deleted.
+                *out = id;
+                ++_commonStats.needYield;
+                return status;
+            }
+            else if (PlanStage::IS_EOF != status) {
+                ++_commonStats.needTime;
+                return status;
+            }
+
+            if (!_batchFull && !_child->isEOF()) {
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        if (_batch.empty()) {
+            return PlanStage::IS_EOF;
+        }
+        _batchFull = true;
+        return deleteBatch(out);
+    }
+
+    PlanStage::StageState DeleteStage::deleteBatch(WorkingSetID* out) {
+        try {
+            _child->saveState();
+            if (supportsDocLocking()) {
+                WorkingSetCommon::prepareForSnapshotChange(_ws);
+            }
+        }
+        catch ( const WriteConflictException& wce ) {
+            std::terminate();
+        }
+
+        size_t numDeleted = 0;
+        try {
+            const bool deleteCappedOK = false;
+            const bool deleteNoWarn = false;
+            const SnapshotId snapshotId = _txn->recoveryUnit()->getSnapshotId();
+
+            WriteUnitOfWork wunit(_txn);
+
+            for (size_t i = 0; i < _batch.size(); ++i) {
+                WorkingSetMember* member = _ws->get(_batch[i]);
+                if (!member->hasLoc()) {
+                    // Invalidated while waiting in the batch.
+                    continue;
+                }
+
+                // As in work(), make sure we delete the latest version of a document which still
+                // matches. The snapshot changes when the plan yields, or when a previous attempt
+                // at this batch conflicted.
+                if (snapshotId != member->obj.snapshotId()) {
+                    if (!WorkingSetCommon::fetch(_txn, member, _collection)) {
+                        continue;
+                    }
+                    if (_params.canonicalQuery &&
+                        !_params.canonicalQuery->root()->matchesBSON(member->obj.value(), NULL)) {
+                        continue;
+                    }
+                }
+
+                // Deleting the document invalidates its RecordId, which we don't need to hear.
+                const RecordId rloc = member->loc;
+                _batchLocs.erase(rloc);
+
+                BSONObj deletedId;
+                _collection->deleteDocument(_txn, rloc, deleteCappedOK, deleteNoWarn,
+                                            _params.shouldCallLogOp ? &deletedId : NULL);
+                ++numDeleted;
+            }
+
+            wunit.commit();
+        }
+        catch ( const WriteConflictException& wce ) {
+            // Nothing in the batch was deleted. Keep it, along with the RecordIds dropped from
+            // '_batchLocs' above, and retry after yielding.
+            for (size_t i = 0; i < _batch.size(); ++i) {
+                WorkingSetMember* member = _ws->get(_batch[i]);
+                if (member->hasLoc()) {
+                    _batchLocs[member->loc] = _batch[i];
+                }
+            }
+            *out = WorkingSet::INVALID_ID;
+            _commonStats.needYield++;
+            return NEED_YIELD;
+        }
+
+        _specificStats.docsDeleted += numDeleted;
+        for (size_t i = 0; i < _batch.size(); ++i) {
+            _ws->free(_batch[i]);
+        }
+        _batch.clear();
+        _batchLocs.clear();
+        _batchBytes = 0;
+        _batchFull = false;
+
+        // As in work(), restore the state outside of the WriteUnitOfWork. Nothing needs retrying
+        // if this conflicts, since the deletes were committed.
+        try {
+            _child->restoreState(_txn);
+        }
+        catch ( const WriteConflictException& wce ) {
+            *out = WorkingSet::INVALID_ID;
+            _commonStats.needYield++;
+            return NEED_YIELD;
+        }
+
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
     void DeleteStage::saveState() {
         _txn = NULL;
         ++_commonStats.yields;
@@ -280,6 +438,17 @@ namespace mongo {
     void DeleteStage::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
         ++_commonStats.invalidates;
         _child->invalidate(txn, dl, type);
+
+        // A batched document which is invalidated is force-fetched, and then skipped by
+        // deleteBatch() since it no longer has a RecordId.
+        BatchLocMap::iterator it = _batchLocs.find(dl);
+        if (_batchLocs.end() != it) {
+            WorkingSetMember* member = _ws->get(it->second);
+            verify(member->loc == dl);
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            _batchLocs.erase(it);
+            ++_specificStats.nInvalidateSkips;
+        }
     }
 
     vector<PlanStage*> DeleteStage::getChildren() const {
@@ -29,9 +29,11 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -46,7 +48,9 @@ namespace mongo {
             fromMigrate(false),
             isExplain(false),
             returnDeleted(false),
-            canonicalQuery(NULL) { }
+            canonicalQuery(NULL),
+            maxBatchDocs(1),
+            maxBatchBytes(0) { }
 
         // Should we delete all documents returned from the child (a "multi delete"), or at most one
         // (a "single delete")?
@@ -67,6 +71,12 @@ namespace mongo {
 
         // The parsed query predicate for this delete. Not owned here.
         CanonicalQuery* canonicalQuery;
+
+        // A multi delete which doesn't return the deleted documents deletes up to this many
+        // documents, and up to about maxBatchBytes of them, in one storage transaction. 1 deletes
+        // every document in a transaction of its own.
+        size_t maxBatchDocs;
+        size_t maxBatchBytes;
     };
 
     /**
@@ -74,6 +84,11 @@ namespace mongo {
      * document was requested to be returned, then ADVANCED is returned after deleting a document.
      * Otherwise, NEED_TIME is returned after deleting a document.
      *
+     * If batching is enabled in the params, the documents are gathered from the child and the
+     * whole batch is deleted within a single WriteUnitOfWork, so that the writes and their oplog
+     * entries are committed together. The batch is re-checked against the current snapshot before
+     * it is deleted, since the plan may yield while it fills up.
+     *
      * Callers of work() must be holding a write lock (and, for shouldCallLogOp=true deletes,
      * callers must have had the replication coordinator approve the write).
      */
@@ -114,6 +129,25 @@ namespace mongo {
         static long long getNumDeleted(PlanExecutor* exec);
 
     private:
+        typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> BatchLocMap;
+
+        /**
+         * Whether documents are deleted in batches rather than one at a time.
+         */
+        bool isBatching() const;
+
+        /**
+         * Adds the next result of the child to the batch, and deletes the batch once it is full or
+         * the child is done.
+         */
+        StageState workBatched(WorkingSetID* out);
+
+        /**
+         * Deletes every document in the batch which still matches within one WriteUnitOfWork.
+         * Keeps the batch and returns NEED_YIELD on a write conflict, so that it is retried.
+         */
+        StageState deleteBatch(WorkingSetID* out);
+
         // Transactional context.  Not owned by us.
         OperationContext* _txn;
 
@@ -135,6 +169,19 @@ namespace mongo {
         // If not WorkingSet::INVALID_ID, we return this member to our caller.
         WorkingSetID _idReturning;
 
+        // The members waiting to be deleted together, when batching.
+        std::vector<WorkingSetID> _batch;
+
+        // The RecordIds of the members in '_batch' which haven't been invalidated, so that an
+        // invalidation can force-fetch the member holding its RecordId.
+        BatchLocMap _batchLocs;
+
+        // Total size of the documents in '_batch'.
+        size_t _batchBytes;
+
+        // Set once '_batch' is ready to be deleted, until the delete commits.
+        bool _batchFull;
+
         // Stats
         CommonStats _commonStats;
         DeleteStats _specificStats;
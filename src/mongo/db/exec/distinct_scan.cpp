@@ -64,8 +64,8 @@ namespace mongo {
         ++_commonStats.works;
         if (_commonStats.isEOF) return PlanStage::IS_EOF;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         boost::optional<IndexKeyEntry> kv;
         try {
@@ -30,8 +30,11 @@
 
 #include "mongo/db/exec/fetch.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
@@ -44,6 +47,33 @@ namespace mongo {
     using std::auto_ptr;
     using std::vector;
 
+    namespace {
+
+        /**
+         * Orders WSMs by RecordId, with any that don't have one first.
+         */
+        class RecordIdOrder {
+        public:
+            explicit RecordIdOrder(WorkingSet* ws) : _ws(ws) { }
+
+            bool operator()(WorkingSetID lhs, WorkingSetID rhs) const {
+                const WorkingSetMember* lhsMember = _ws->get(lhs);
+                const WorkingSetMember* rhsMember = _ws->get(rhs);
+                if (!rhsMember->hasLoc()) {
+                    return false;
+                }
+                if (!lhsMember->hasLoc()) {
+                    return true;
+                }
+                return lhsMember->loc < rhsMember->loc;
+            }
+
+        private:
+            WorkingSet* _ws;
+        };
+
+    }  // namespace
+
     // static
     const char* FetchStage::kStageType = "FETCH";
 
@@ -57,7 +87,12 @@ namespace mongo {
           _ws(ws),
           _child(child),
           _filter(filter),
+          _compiledFilter(Filter::compile(filter)),
           _idRetrying(WorkingSet::INVALID_ID),
+          _hasBatchPendingStatus(false),
+          _batchPendingStatus(NEED_TIME),
+          _batchPendingId(WorkingSet::INVALID_ID),
+          _sortRecordIds(false),
           _commonStats(kStageType) { }
 
     FetchStage::~FetchStage() { }
@@ -69,75 +104,167 @@ namespace mongo {
             return false;
         }
 
+        if (!_batchPending.empty() || _hasBatchPendingStatus) {
+            // We still have to process results or a status our child returned in a batch.
+            return false;
+        }
+
         return _child->isEOF();
     }
 
     PlanStage::StageState FetchStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
-        // Either retry the last WSM we worked on or get a new one from our child.
+        // Either retry the last WSM we worked on, take what's left over from a batch, or get a
+        // new one from our child.
         WorkingSetID id;
         StageState status;
-        if (_idRetrying == WorkingSet::INVALID_ID) {
-            status = _child->work(&id);
-        }
-        else {
+        if (_idRetrying != WorkingSet::INVALID_ID) {
             status = ADVANCED;
             id = _idRetrying;
             _idRetrying = WorkingSet::INVALID_ID;
         }
+        else if (!_batchPending.empty()) {
+            status = ADVANCED;
+            id = _batchPending.front();
+            _batchPending.pop_front();
+        }
+        else if (_hasBatchPendingStatus) {
+            status = _batchPendingStatus;
+            id = _batchPendingId;
+            _hasBatchPendingStatus = false;
+        }
+        else {
+            status = _child->work(&id);
+        }
 
         if (PlanStage::ADVANCED == status) {
-            WorkingSetMember* member = _ws->get(id);
+            return fetchAndFilter(id, out);
+        }
+
+        return passOnChildStatus(status, id, out);
+    }
+
+    PlanStage::StageState FetchStage::workBatch(size_t maxWorks,
+                                                vector<WorkingSetID>* results,
+                                                WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
+
+        if (isEOF()) {
+            ++_commonStats.works;
+            return PlanStage::IS_EOF;
+        }
+
+        if (WorkingSet::INVALID_ID != _idRetrying) {
+            _batchPending.push_front(_idRetrying);
+            _idRetrying = WorkingSet::INVALID_ID;
+        }
 
-            // If there's an obj there, there is no fetching to perform.
-            if (member->hasObj()) {
-                ++_specificStats.alreadyHasObj;
+        if (_batchPending.empty() && !_hasBatchPendingStatus) {
+            const size_t childWorksBefore = _child->getCommonStats()->works;
+            _batchPendingStatus = _child->workBatch(maxWorks, &_childResults, &_batchPendingId);
+            _commonStats.works += _child->getCommonStats()->works - childWorksBefore;
+
+            _hasBatchPendingStatus = (ADVANCED != _batchPendingStatus &&
+                                      NEED_TIME != _batchPendingStatus);
+            if (_sortRecordIds && _childResults.size() > 1) {
+                std::stable_sort(_childResults.begin(), _childResults.end(),
+                                 RecordIdOrder(_ws));
             }
-            else {
-                // We need a valid loc to fetch from and this is the only state that has one.
-                verify(WorkingSetMember::LOC_AND_IDX == member->state);
-                verify(member->hasLoc());
-
-                // We might need to retrieve 'nextLoc' from secondary storage, in which case we send
-                // a NEED_YIELD request up to the PlanExecutor.
-                std::auto_ptr<RecordFetcher> fetcher(_collection->documentNeedsFetch(_txn,
-                                                                                     member->loc));
-                if (NULL != fetcher.get()) {
-                    // There's something to fetch. Hand the fetcher off to the WSM, and pass up
-                    // a fetch request.
-                    _idRetrying = id;
-                    member->setFetcher(fetcher.release());
-                    *out = id;
-                    _commonStats.needYield++;
-                    return NEED_YIELD;
-                }
+            _batchPending.insert(_batchPending.end(), _childResults.begin(), _childResults.end());
+            _childResults.clear();
+        }
+        else {
+            ++_commonStats.works;
+        }
 
-                // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
-                // as well as an unowned object
-                try {
-                    if (!WorkingSetCommon::fetch(_txn, member, _collection)) {
-                        _ws->free(id);
-                        _commonStats.needTime++;
-                        return NEED_TIME;
-                    }
-                }
-                catch (const WriteConflictException& wce) {
-                    _idRetrying = id;
-                    *out = WorkingSet::INVALID_ID;
-                    _commonStats.needYield++;
-                    return NEED_YIELD;
-                }
+        const size_t numResultsBefore = results->size();
+        while (!_batchPending.empty()) {
+            const WorkingSetID id = _batchPending.front();
+            _batchPending.pop_front();
+
+            WorkingSetID fetchedId = WorkingSet::INVALID_ID;
+            const StageState status = fetchAndFilter(id, &fetchedId);
+            if (ADVANCED == status) {
+                results->push_back(fetchedId);
             }
+            else if (NEED_YIELD == status) {
+                // The rest of the batch waits in _batchPending until we're called again.
+                *out = fetchedId;
+                return status;
+            }
+        }
+
+        if (_hasBatchPendingStatus) {
+            // We've caught up with our child, so pass on whatever ended its batch.
+            _hasBatchPendingStatus = false;
+            return passOnChildStatus(_batchPendingStatus, _batchPendingId, out);
+        }
 
-            return returnIfMatches(member, id, out);
+        return results->size() > numResultsBefore ? ADVANCED : NEED_TIME;
+    }
+
+    PlanStage::StageState FetchStage::fetchAndFilter(WorkingSetID id, WorkingSetID* out) {
+        WorkingSetMember* member = _ws->get(id);
+
+        // If there's an obj there, there is no fetching to perform.
+        if (member->hasObj()) {
+            ++_specificStats.alreadyHasObj;
         }
-        else if (PlanStage::FAILURE == status) {
+        else {
+            // We need a valid loc to fetch from and this is the only state that has one.
+            verify(WorkingSetMember::LOC_AND_IDX == member->state);
+            verify(member->hasLoc());
+
+            // We might need to retrieve 'nextLoc' from secondary storage, in which case we send
+            // a NEED_YIELD request up to the PlanExecutor.
+            std::auto_ptr<RecordFetcher> fetcher(_collection->documentNeedsFetch(_txn,
+                                                                                 member->loc));
+            if (NULL != fetcher.get()) {
+                // There's something to fetch. Hand the fetcher off to the WSM, and pass up
+                // a fetch request.
+                _idRetrying = id;
+                member->setFetcher(fetcher.release());
+                *out = id;
+                _commonStats.needYield++;
+                return NEED_YIELD;
+            }
+
+            // The doc is already in memory, so go ahead and grab it. Now we have a RecordId
+            // as well as an unowned object
+            try {
+                // Adds the time spent reading the document to storageTimeCycles, of the stage and
+                // of the operation.
+                ScopedTimer storageTimer(&_commonStats.storageTimeCycles,
+                                         &_txn->getCurOp()->debug().storageTimeCycles);
+
+                if (!WorkingSetCommon::fetch(_txn, member, _collection)) {
+                    _ws->free(id);
+                    _commonStats.needTime++;
+                    return NEED_TIME;
+                }
+            }
+            catch (const WriteConflictException& wce) {
+                _idRetrying = id;
+                *out = WorkingSet::INVALID_ID;
+                _commonStats.needYield++;
+                return NEED_YIELD;
+            }
+        }
+
+        return returnIfMatches(member, id, out);
+    }
+
+    PlanStage::StageState FetchStage::passOnChildStatus(StageState status,
+                                                        WorkingSetID id,
+                                                        WorkingSetID* out) {
+        if (PlanStage::FAILURE == status) {
             *out = id;
             // If a stage fails, it may create a status WSM to indicate why it
             // failed, in which case 'id' is valid.  If ID is invalid, we
@@ -182,11 +309,24 @@ namespace mongo {
         // It's possible that the loc getting invalidated is the one we're about to
         // fetch. In this case we do a "forced fetch" and put the WSM in owned object state.
         if (WorkingSet::INVALID_ID != _idRetrying) {
-            WorkingSetMember* member = _ws->get(_idRetrying);
-            if (member->hasLoc() && (member->loc == dl)) {
-                // Fetch it now and kill the diskloc.
-                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
-            }
+            invalidateIfMatches(txn, _idRetrying, dl);
+        }
+
+        // The same goes for anything our child returned in a batch that we haven't fetched yet.
+        for (std::deque<WorkingSetID>::const_iterator it = _batchPending.begin();
+             it != _batchPending.end();
+             ++it) {
+            invalidateIfMatches(txn, *it, dl);
+        }
+    }
+
+    void FetchStage::invalidateIfMatches(OperationContext* txn,
+                                         WorkingSetID id,
+                                         const RecordId& dl) {
+        WorkingSetMember* member = _ws->get(id);
+        if (member->hasLoc() && (member->loc == dl)) {
+            // Fetch it now and kill the diskloc.
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
         }
     }
 
@@ -209,7 +349,7 @@ namespace mongo {
         // predicate.
         ++_specificStats.docsExamined;
 
-        if (Filter::passes(member, _filter)) {
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
             if (NULL != _filter) {
                 ++_specificStats.matchTested;
             }
@@ -29,10 +29,13 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <deque>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -57,6 +60,17 @@ namespace mongo {
 
         virtual bool isEOF();
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return true; }
+
+        /**
+         * Fetch each batch of our child's results in RecordId order rather than in the order
+         * the child returned them, so that storage is read sequentially. Only safe when nothing
+         * above us depends on our child's order.
+         */
+        void setSortRecordIds() { _sortRecordIds = true; }
 
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -83,6 +97,22 @@ namespace mongo {
         StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID,
                                    WorkingSetID* out);
 
+        /**
+         * Fetches the document for the child's result 'id', if necessary, and passes it through
+         * returnIfMatches(). May also return NEED_YIELD, in which case 'id' becomes _idRetrying.
+         */
+        StageState fetchAndFilter(WorkingSetID id, WorkingSetID* out);
+
+        /**
+         * Handles a non-ADVANCED status returned by our child, with its WSID 'id'.
+         */
+        StageState passOnChildStatus(StageState status, WorkingSetID id, WorkingSetID* out);
+
+        /**
+         * Force-fetches the member 'id' if it refers to 'dl'.
+         */
+        void invalidateIfMatches(OperationContext* txn, WorkingSetID id, const RecordId& dl);
+
         OperationContext* _txn;
 
         // Collection which is used by this stage. Used to resolve record ids retrieved by child
@@ -96,9 +126,28 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // The compiled form of _filter, if it has one.
+        boost::scoped_ptr<CompiledMatchExpression> _compiledFilter;
+
         // If not Null, we use this rather than asking our child what to do next.
         WorkingSetID _idRetrying;
 
+        // Results of our child's last workBatch() that we haven't fetched yet, because fetching
+        // one of them required a yield. Used before asking our child for anything else.
+        std::deque<WorkingSetID> _batchPending;
+
+        // The status that ended our child's last batch, if it was anything other than ADVANCED
+        // or NEED_TIME. It is passed on once _batchPending has been drained.
+        bool _hasBatchPendingStatus;
+        StageState _batchPendingStatus;
+        WorkingSetID _batchPendingId;
+
+        // Buffer for our child's results, kept around to avoid reallocating it for every batch.
+        std::vector<WorkingSetID> _childResults;
+
+        // See setSortRecordIds().
+        bool _sortRecordIds;
+
         // Stats
         CommonStats _commonStats;
         FetchStats _specificStats;
@@ -30,7 +30,9 @@
 
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/matcher/matchable.h"
+#include "mongo/db/query/query_knobs.h"
 
 namespace mongo {
 
@@ -158,6 +160,28 @@ namespace mongo {
             return filter->matches(&doc, NULL);
         }
 
+        /**
+         * Same as above, but uses 'compiled', the compiled form of 'filter', if it isn't NULL and
+         * 'wsm' has an object.
+         */
+        static bool passes(WorkingSetMember* wsm,
+                           const MatchExpression* filter,
+                           const CompiledMatchExpression* compiled) {
+            if (NULL != compiled && wsm->hasObj()) {
+                return compiled->matchesBSON(wsm->obj.value());
+            }
+            return passes(wsm, filter);
+        }
+
+        /**
+         * Returns the compiled form of 'filter' for a stage to use with passes() above, owned by
+         * the caller, or NULL if 'filter' is NULL, can't be compiled or compiling is disabled.
+         */
+        static CompiledMatchExpression* compile(const MatchExpression* filter) {
+            if (NULL == filter || !internalQueryCompileMatchExpressions) { return NULL; }
+            return CompiledMatchExpression::compile(filter);
+        }
+
         static bool passes(const BSONObj& keyData,
                            const BSONObj& keyPattern,
                            const MatchExpression* filter) {
@@ -44,11 +44,15 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/expression_index.h"
 #include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/index/expression_params.h"
 #include "mongo/util/log.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <algorithm>
+#include <cmath>
 
 namespace mongo {
 
@@ -904,6 +908,75 @@ namespace mongo {
 
     static const string kS2IndexNearStage("GEO_NEAR_2DSPHERE");
 
+    namespace {
+
+        // Queries whose points fall in the same cell at this level (roughly 10km across) share a
+        // cached density.
+        const int kDensityCacheCellLevel = 10;
+
+        // The first annulus of a query with a cached density is sized to hold about one default
+        // batch of results.
+        const double kFirstIntervalResults = 101;
+
+        typedef LRUKeyValue<string, double> DensityCache;
+
+        // Protects everything below.
+        boost::mutex densityCacheMutex;
+
+        // Created on first use, and again whenever internalGeoNearDensityCacheSize changes.
+        scoped_ptr<DensityCache> densityCache;
+        size_t densityCacheMaxSize = 0;
+
+        /**
+         * Documents per square meter found near a point by an earlier query of the same shape, or
+         * a negative number if there is none.
+         */
+        double getCachedDensity(const string& key) {
+            boost::lock_guard<boost::mutex> lk(densityCacheMutex);
+            double* density;
+            if (densityCache && densityCache->get(key, &density).isOK()) {
+                return *density;
+            }
+            return -1;
+        }
+
+        void cacheDensity(const string& key, double density) {
+            const int maxEntries = internalGeoNearDensityCacheSize;
+            if (maxEntries <= 0) {
+                return;
+            }
+
+            boost::lock_guard<boost::mutex> lk(densityCacheMutex);
+            if (!densityCache || densityCacheMaxSize != static_cast<size_t>(maxEntries)) {
+                densityCache.reset(new DensityCache(maxEntries));
+                densityCacheMaxSize = maxEntries;
+            }
+            densityCache->add(key, new double(density));
+        }
+
+        // Area, in square meters, of the spherical cap with the given radius in meters.
+        double capArea(double radius) {
+            const double angle = std::min(radius / kRadiusOfEarthInMeters, M_PI);
+            return 2 * M_PI * kRadiusOfEarthInMeters * kRadiusOfEarthInMeters * (1 - cos(angle));
+        }
+
+        // Radius, in meters, of the spherical cap with the given area in square meters.
+        double capRadius(double area) {
+            const double cosAngle =
+                1 - area / (2 * M_PI * kRadiusOfEarthInMeters * kRadiusOfEarthInMeters);
+            if (cosAngle <= -1) {
+                return M_PI * kRadiusOfEarthInMeters;
+            }
+            return acos(cosAngle) * kRadiusOfEarthInMeters;
+        }
+
+        // Distance to add to "inner" so that the annulus between them is expected to hold
+        // "numResults" documents when they are spread with the given density.
+        double annulusWidthFor(double inner, double density, double numResults) {
+            return capRadius(capArea(inner) + numResults / density) - inner;
+        }
+    }
+
     GeoNear2DSphereStage::GeoNear2DSphereStage(const GeoNearParams& nearParams,
                                                OperationContext* txn,
                                                WorkingSet* workingSet,
@@ -922,6 +995,19 @@ namespace mongo {
 
         getNearStats()->keyPattern = s2Index->keyPattern();
         getNearStats()->indexName = s2Index->indexName();
+
+        // Densities differ wildly between places, and for the same place between indexes,
+        // bounds on the other indexed fields and filters, so all of those are part of the key.
+        const S2CellId centerId = nearParams.nearQuery->centroid->cell.id();
+        const int cellLevel = std::min(kDensityCacheCellLevel, centerId.level());
+        _densityCacheKey = mongoutils::str::stream()
+            << s2Index->parentNS() << '|' << s2Index->indexName()
+            << '|' << centerId.parent(cellLevel).toString()
+            << '|' << nearParams.baseBounds.toString();
+        if (nearParams.filter) {
+            _densityCacheKey += '|';
+            _densityCacheKey += nearParams.filter->toString();
+        }
     }
 
     GeoNear2DSphereStage::~GeoNear2DSphereStage() {
@@ -1166,6 +1252,18 @@ namespace mongo {
                                                            WorkingSetID* out)
     {
         if (!_densityEstimator) {
+            const double cachedDensity = getCachedDensity(_densityCacheKey);
+            if (cachedDensity > 0) {
+                // Keep the first annulus small so that the first results come back quickly;
+                // later annuli are sized from what we actually find.
+                _boundsIncrement = annulusWidthFor(_fullBounds.getInner(),
+                                                   cachedDensity,
+                                                   kFirstIntervalResults);
+                if (_boundsIncrement > 0.0) {
+                    return IS_EOF;
+                }
+            }
+
             _densityEstimator.reset(new DensityEstimator(_s2Index, &_nearParams));
         }
 
@@ -1229,13 +1327,34 @@ namespace mongo {
 
         if (!stats->intervalStats.empty()) {
 
-            const IntervalStats& lastIntervalStats = stats->intervalStats.back();
+            // Size the next annulus from the density of everything found so far, rather than
+            // from the last annulus alone, so that a single unusually full or empty annulus
+            // doesn't throw the estimate off.
+            long long numResultsBuffered = 0;
+            for (vector<IntervalStats>::const_iterator it = stats->intervalStats.begin();
+                 it != stats->intervalStats.end(); ++it) {
+                numResultsBuffered += it->numResultsBuffered;
+            }
 
-            // TODO: Generally we want small numbers of results fast, then larger numbers later
-            if (lastIntervalStats.numResultsBuffered < 300)
-                _boundsIncrement *= 2;
-            else if (lastIntervalStats.numResultsBuffered > 600)
-                _boundsIncrement /= 2;
+            const double searchedArea =
+                capArea(_currBounds.getOuter()) - capArea(_fullBounds.getInner());
+            const double lastIncrement = _boundsIncrement;
+
+            if (numResultsBuffered == 0 || searchedArea <= 0) {
+                // Nothing here yet, so widen quickly rather than scan a long run of empty annuli.
+                _boundsIncrement *= 4;
+            }
+            else {
+                const double density = numResultsBuffered / searchedArea;
+                cacheDensity(_densityCacheKey, density);
+
+                const int targetResults = std::max(1, internalGeoNearQueryTargetIntervalResults);
+                _boundsIncrement = annulusWidthFor(_currBounds.getOuter(), density, targetResults);
+
+                // Data is rarely uniform, so don't trust the estimate too far in either direction.
+                _boundsIncrement = std::max(lastIncrement / 4,
+                                            std::min(lastIncrement * 8, _boundsIncrement));
+            }
         }
 
         invariant(_boundsIncrement > 0.0);
@@ -114,6 +114,10 @@ namespace mongo {
         // Amount to increment the next bounds by
         double _boundsIncrement;
 
+        // Identifies this query's shape and location in the cache of densities found by earlier
+        // queries
+        std::string _densityCacheKey;
+
         class DensityEstimator;
         boost::scoped_ptr<DensityEstimator> _densityEstimator;
     };
@@ -170,6 +174,10 @@ namespace mongo {
         // Amount to increment the next bounds by
         double _boundsIncrement;
 
+        // Identifies this query's shape and location in the cache of densities found by earlier
+        // queries
+        std::string _densityCacheKey;
+
         class DensityEstimator;
         boost::scoped_ptr<DensityEstimator> _densityEstimator;
     };
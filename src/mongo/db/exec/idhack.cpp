@@ -37,6 +37,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/index/btree_access_method.h"
+#include "mongo/db/storage/id_keys.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/s/d_state.h"
 
@@ -55,6 +56,8 @@ namespace mongo {
           _workingSet(ws),
           _key(query->getQueryObj()["_id"].wrap()),
           _done(false),
+          _lookupCache(NULL),
+          _lookupCacheGeneration(0),
           _idBeingPagedIn(WorkingSet::INVALID_ID),
           _commonStats(kStageType) {
         if (NULL != query->getProj()) {
@@ -73,6 +76,8 @@ namespace mongo {
           _key(key),
           _done(false),
           _addKeyMetadata(false),
+          _lookupCache(NULL),
+          _lookupCacheGeneration(0),
           _idBeingPagedIn(WorkingSet::INVALID_ID),
           _commonStats(kStageType) { }
 
@@ -91,8 +96,8 @@ namespace mongo {
     PlanStage::StageState IDHackStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (_done) { return PlanStage::IS_EOF; }
 
@@ -102,32 +107,68 @@ namespace mongo {
             WorkingSetMember* member = _workingSet->get(id);
 
             invariant(WorkingSetCommon::fetchIfUnfetched(_txn, member, _collection));
+            addToLookupCache(member);
 
             return advance(id, member, out);
         }
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         try {
-            // Use the index catalog to get the id index.
-            const IndexCatalog* catalog = _collection->getIndexCatalog();
-
-            // Find the index we use.
-            IndexDescriptor* idDesc = catalog->findIdIndex(_txn);
-            if (NULL == idDesc) {
-                _done = true;
-                return PlanStage::IS_EOF;
+            _lookupCache = getLookupCache();
+            if (NULL != _lookupCache) {
+                RecordId loc;
+                BSONObj doc;
+                if (_lookupCache->find(_key, &loc, &doc)) {
+                    id = _workingSet->allocate();
+                    WorkingSetMember* member = _workingSet->get(id);
+                    member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+                    member->loc = loc;
+                    member->obj = Snapshotted<BSONObj>(_txn->recoveryUnit()->getSnapshotId(),
+                                                       doc);
+                    _lookupCache = NULL;
+                    return advance(id, member, out);
+                }
+
+                // Only a document read from a snapshot opened after the generation was taken
+                // may be cached.
+                _lookupCacheGeneration = _lookupCache->getGeneration();
+                _txn->recoveryUnit()->commitAndRestart();
             }
 
-            // Look up the key by going directly to the index.
-            RecordId loc = catalog->getIndex(idDesc)->findSingle(_txn, _key);
-
-            // Key not found.
-            if (loc.isNull()) {
-                _done = true;
-                return PlanStage::IS_EOF;
+            RecordId loc;
+            if (_collection->getRecordStore()->keyedById()) {
+                // The document can only be at the RecordId made from its _id, so there is no
+                // need to go through the _id index. An _id without one can't have been inserted.
+                StatusWith<RecordId> key = idkeys::keyForId(_key.firstElement());
+                if (!key.isOK()) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
+                loc = key.getValue();
+            }
+            else {
+                // Use the index catalog to get the id index.
+                const IndexCatalog* catalog = _collection->getIndexCatalog();
+
+                // Find the index we use.
+                IndexDescriptor* idDesc = catalog->findIdIndex(_txn);
+                if (NULL == idDesc) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
+
+                // Look up the key by going directly to the index.
+                loc = catalog->getIndex(idDesc)->findSingle(_txn, _key);
+
+                // Key not found.
+                if (loc.isNull()) {
+                    _done = true;
+                    return PlanStage::IS_EOF;
+                }
+
+                ++_specificStats.keysExamined;
             }
 
-            ++_specificStats.keysExamined;
             ++_specificStats.docsExamined;
 
             // Create a new WSM for the result document.
@@ -157,6 +198,7 @@ namespace mongo {
                 _done = true;
                 return IS_EOF;
             }
+            addToLookupCache(member);
 
             return advance(id, member, out);
         }
@@ -171,6 +213,30 @@ namespace mongo {
         }
     }
 
+    IdLookupCache* IDHackStage::getLookupCache() const {
+        if (!IdLookupCache::isEnabled() || _collection->isCapped()) {
+            return NULL;
+        }
+
+        // Readers only: a writer may see, and must not cache, its own uncommitted writes.
+        const Locker* locker = _txn->lockState();
+        if (locker->inAWriteUnitOfWork()
+                || locker->isCollectionLockedForMode(_collection->ns().ns(), MODE_IX)) {
+            return NULL;
+        }
+
+        return _collection->infoCache()->getIdLookupCache().get();
+    }
+
+    void IDHackStage::addToLookupCache(WorkingSetMember* member) {
+        if (NULL == _lookupCache) {
+            return;
+        }
+
+        _lookupCache->add(_key, _lookupCacheGeneration, member->loc, member->obj.value());
+        _lookupCache = NULL;
+    }
+
     PlanStage::StageState IDHackStage::advance(WorkingSetID id,
                                                WorkingSetMember* member,
                                                WorkingSetID* out) {
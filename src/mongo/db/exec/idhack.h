@@ -82,6 +82,16 @@ namespace mongo {
          */
         StageState advance(WorkingSetID id, WorkingSetMember* member, WorkingSetID* out);
 
+        /**
+         * Returns the collection's _id lookup cache if this read can use it, NULL otherwise.
+         */
+        IdLookupCache* getLookupCache() const;
+
+        /**
+         * Caches the document fetched into 'member', if it was looked up to be cached.
+         */
+        void addToLookupCache(WorkingSetMember* member);
+
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
@@ -100,6 +110,11 @@ namespace mongo {
         // Do we need to add index key metadata for $returnKey?
         bool _addKeyMetadata;
 
+        // The cache to add the document we find to, if any, along with the generation of the
+        // cache from before the document was looked up. Not owned here.
+        IdLookupCache* _lookupCache;
+        unsigned long long _lookupCacheGeneration;
+
         // If we want to return a RecordId and it points to something that's not in memory,
         // we return a "please page this in" result. We add a RecordFetcher given back to us by the
         // storage engine to the WSM. The RecordFetcher is used by the PlanExecutor when it handles
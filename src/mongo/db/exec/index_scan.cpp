@@ -33,6 +33,7 @@
 #include "mongo/db/exec/index_scan.h"
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_computed_data.h"
@@ -40,6 +41,7 @@
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace {
 
@@ -131,12 +133,17 @@ namespace mongo {
     PlanStage::StageState IndexScan::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         // Get the next kv pair from the index, if any.
         boost::optional<IndexKeyEntry> kv;
         try {
+            // Adds the time spent positioning the index cursor to storageTimeCycles, of the stage
+            // and of the operation.
+            ScopedTimer storageTimer(&_commonStats.storageTimeCycles,
+                                     &_txn->getCurOp()->debug().storageTimeCycles);
+
             switch (_scanState) {
             case INITIALIZING: kv = initIndexScan(); break;
             case GETTING_NEXT: kv = _indexCursor->next(); break;
@@ -231,6 +238,12 @@ namespace mongo {
         return PlanStage::ADVANCED;
     }
 
+    PlanStage::StageState IndexScan::workBatch(size_t maxWorks,
+                                               std::vector<WorkingSetID>* results,
+                                               WorkingSetID* out) {
+        return workBatchWith(this, maxWorks, results, out);
+    }
+
     bool IndexScan::isEOF() {
         return _commonStats.isEOF;
     }
@@ -258,7 +271,11 @@ namespace mongo {
         _txn = opCtx;
         ++_commonStats.unyields;
 
-        if (_indexCursor) _indexCursor->restore(opCtx);
+        if (_indexCursor) {
+            Timer timer;
+            _indexCursor->restore(opCtx);
+            _commonStats.restoreStateMicros += timer.micros();
+        }
     }
 
     void IndexScan::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
@@ -300,6 +317,15 @@ namespace mongo {
 
             _specificStats.indexBounds = _params.bounds.toBSON();
 
+            BSONObjBuilder geoCovering;
+            for (size_t i = 0; i < _params.bounds.fields.size(); ++i) {
+                const OrderedIntervalList& oil = _params.bounds.fields[i];
+                if (!oil.coveringStats.isEmpty()) {
+                    geoCovering.append(oil.name, oil.coveringStats);
+                }
+            }
+            _specificStats.geoCovering = geoCovering.obj();
+
             _specificStats.direction = _params.direction;
         }
 
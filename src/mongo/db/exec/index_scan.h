@@ -103,6 +103,10 @@ namespace mongo {
         virtual ~IndexScan() { }
 
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return true; }
         virtual bool isEOF();
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -28,6 +28,8 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/util/mongoutils/str.h"
@@ -50,8 +52,8 @@ namespace mongo {
     PlanStage::StageState LimitStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (0 == _numToReturn) {
             // We've returned as many results as we're limited to.
@@ -91,6 +93,51 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState LimitStage::workBatch(size_t maxWorks,
+                                                vector<WorkingSetID>* results,
+                                                WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
+
+        if (0 == _numToReturn) {
+            // We've returned as many results as we're limited to.
+            ++_commonStats.works;
+            return PlanStage::IS_EOF;
+        }
+
+        // Each unit of work produces at most one result, so capping the number of works also
+        // keeps us from reading past the limit.
+        const size_t numToWork = std::min(maxWorks, static_cast<size_t>(_numToReturn));
+        const size_t numResultsBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        StageState status = _child->workBatch(numToWork, results, out);
+        _commonStats.works += _child->getCommonStats()->works - childWorksBefore;
+
+        const size_t numAdvanced = results->size() - numResultsBefore;
+        _numToReturn -= numAdvanced;
+        _commonStats.advanced += numAdvanced;
+
+        if (PlanStage::FAILURE == status) {
+            // If a stage fails, it may create a status WSM to indicate why it
+            // failed, in which case 'id' is valid.  If ID is invalid, we
+            // create our own error message.
+            if (WorkingSet::INVALID_ID == *out) {
+                mongoutils::str::stream ss;
+                ss << "limit stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_TIME == status) {
+            ++_commonStats.needTime;
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+        }
+
+        return status;
+    }
+
     void LimitStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
@@ -50,6 +50,10 @@ namespace mongo {
 
         virtual bool isEOF();
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return true; }
 
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
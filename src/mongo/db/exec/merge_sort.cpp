@@ -28,21 +28,55 @@
 
 #include "mongo/db/exec/merge_sort.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
     using std::auto_ptr;
-    using std::list;
     using std::string;
     using std::vector;
 
     // static
     const char* MergeSortStage::kStageType = "SORT_MERGE";
 
+    // static
+    const size_t MergeSortStage::kNoChild = std::numeric_limits<size_t>::max();
+
+namespace {
+
+    /**
+     * Returns 'pattern' with each value replaced by the direction the comparison uses for it.
+     */
+    BSONObj directionsOf(const BSONObj& pattern) {
+        BSONObjBuilder bob;
+        BSONObjIterator it(pattern);
+        while (it.more()) {
+            BSONElement patternElt = it.next();
+            bob.append(patternElt.fieldName(), -1 == patternElt.number() ? -1 : 1);
+        }
+        return bob.obj();
+    }
+
+    /**
+     * KeyStrings only record the direction of the first 32 fields of an ordering.
+     */
+    bool canUseKeyString(const BSONObj& pattern) {
+        return internalQueryExecSortUseKeyStrings && pattern.nFields() <= 32;
+    }
+
+    // How many results to read at a time from children which support PlanStage::workBatch().
+    const size_t kChildBatchSize = 16;
+
+}  // namespace
+
     MergeSortStage::MergeSortStage(const MergeSortStageParams& params,
                                    WorkingSet* ws,
                                    const Collection* collection)
@@ -50,7 +84,9 @@ namespace mongo {
           _ws(ws),
           _pattern(params.pattern),
           _dedup(params.dedup),
-          _merging(StageWithValueComparison(ws, params.pattern)),
+          _comparison(ws, params.pattern),
+          _treeBuilt(false),
+          _pendingChild(0),
           _commonStats(kStageType) { }
 
     MergeSortStage::~MergeSortStage() {
@@ -59,129 +95,105 @@ namespace mongo {
 
     void MergeSortStage::addChild(PlanStage* child) {
         _children.push_back(child);
-
-        // We have to call work(...) on every child before we can pick a min.
-        _noResultToMerge.push(child);
+        _childResults.push_back(ChildResults());
     }
 
     bool MergeSortStage::isEOF() {
-        // If we have no more results to return, and we have no more children that we can call
-        // work(...) on to get results, we're done.
-        return _merging.empty() && _noResultToMerge.empty();
+        // We're done once the tree is built, no child is waiting to have its next result played
+        // and even the winner has no results left.
+        if (_children.empty()) {
+            return true;
+        }
+        return _treeBuilt
+            && kNoChild == _pendingChild
+            && _childResults[_tree[0]].results.empty();
     }
 
     PlanStage::StageState MergeSortStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
-        if (!_noResultToMerge.empty()) {
-            // We have some child that we don't have a result from.  Each child must have a result
-            // in order to pick the minimum result among all our children.  Work a child.
-            PlanStage* child = _noResultToMerge.front();
-            WorkingSetID id = WorkingSet::INVALID_ID;
-            StageState code = child->work(&id);
+        if (kNoChild != _pendingChild) {
+            // Every child must have a result, or be EOF, in order to pick the minimum result
+            // among all our children.
+            const size_t child = _pendingChild;
+            ChildResults& childResults = _childResults[child];
+            if (childResults.results.empty() && !childResults.eof) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                StageState code = readChild(child, &id);
 
-            if (PlanStage::ADVANCED == code) {
-                // If we're deduping...
-                if (_dedup) {
-                    WorkingSetMember* member = _ws->get(id);
-
-                    if (!member->hasLoc()) {
-                        // Can't dedup data unless there's a RecordId.  We go ahead and use its
-                        // result.
-                        _noResultToMerge.pop();
-                    }
-                    else {
-                        ++_specificStats.dupsTested;
-                        // ...and there's a diskloc and and we've seen the RecordId before
-                        if (_seen.end() != _seen.find(member->loc)) {
-                            // ...drop it.
-                            _ws->free(id);
-                            ++_commonStats.needTime;
-                            ++_specificStats.dupsDropped;
-                            return PlanStage::NEED_TIME;
-                        }
-                        else {
-                            // Otherwise, note that we've seen it.
-                            _seen.insert(member->loc);
-                            // We're going to use the result from the child, so we remove it from
-                            // the queue of children without a result.
-                            _noResultToMerge.pop();
-                        }
+                if (PlanStage::FAILURE == code) {
+                    *out = id;
+                    // If a stage fails, it may create a status WSM to indicate why it
+                    // failed, in which case 'id' is valid.  If ID is invalid, we
+                    // create our own error message.
+                    if (WorkingSet::INVALID_ID == id) {
+                        mongoutils::str::stream ss;
+                        ss << "merge sort stage failed to read in results from child";
+                        Status status(ErrorCodes::InternalError, ss);
+                        *out = WorkingSetCommon::allocateStatusMember( _ws, status);
                     }
+                    return code;
                 }
-                else {
-                    // Not deduping.  We use any result we get from the child.  Remove the child
-                    // from the queue of things without a result.
-                    _noResultToMerge.pop();
+                else if (PlanStage::NEED_YIELD == code) {
+                    *out = id;
+                    ++_commonStats.needYield;
+                    return code;
+                }
+                else if (PlanStage::DEAD == code) {
+                    return code;
                 }
 
-                // Store the result in our list.
-                StageWithValue value;
-                value.id = id;
-                value.stage = child;
-                _mergingData.push_front(value);
-
-                // Insert the result (indirectly) into our priority queue.
-                _merging.push(_mergingData.begin());
-
-                ++_commonStats.needTime;
-                return PlanStage::NEED_TIME;
-            }
-            else if (PlanStage::IS_EOF == code) {
-                // There are no more results possible from this child.  Don't bother with it
-                // anymore.
-                _noResultToMerge.pop();
-                ++_commonStats.needTime;
-                return PlanStage::NEED_TIME;
-            }
-            else if (PlanStage::FAILURE == code) {
-                *out = id;
-                // If a stage fails, it may create a status WSM to indicate why it
-                // failed, in which case 'id' is valid.  If ID is invalid, we
-                // create our own error message.
-                if (WorkingSet::INVALID_ID == id) {
-                    mongoutils::str::stream ss;
-                    ss << "merge sort stage failed to read in results from child";
-                    Status status(ErrorCodes::InternalError, ss);
-                    *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+                if (childResults.results.empty() && !childResults.eof) {
+                    // Either the child needs more time, or we dropped what it returned.
+                    ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
                 }
-                return code;
+            }
+
+            if (_treeBuilt) {
+                replay(child);
+                _pendingChild = kNoChild;
             }
             else {
-                if (PlanStage::NEED_TIME == code) {
+                ++_pendingChild;
+                if (_pendingChild < _children.size()) {
                     ++_commonStats.needTime;
+                    return PlanStage::NEED_TIME;
                 }
-                else if (PlanStage::NEED_YIELD == code) {
-                    *out = id;
-                    ++_commonStats.needYield;
-                }
+                buildTree();
+                _pendingChild = kNoChild;
+            }
 
-                return code;
+            if (isEOF()) {
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
             }
         }
 
-        // If we're here, for each non-EOF child, we have a valid WSID.
-        verify(!_merging.empty());
-
-        // Get the 'min' WSID.  _merging is a priority queue so its top is the smallest.
-        MergingRef top = _merging.top();
-        _merging.pop();
+        // If we're here, for each non-EOF child, we have a valid WSID, and the tree has the
+        // smallest of them as its winner.
+        const size_t winner = _tree[0];
+        ChildResults& winnerResults = _childResults[winner];
+        verify(!winnerResults.results.empty());
 
-        // Since we're returning the WSID that came from top->stage, we need to work(...) it again
-        // to get a new result.
-        _noResultToMerge.push(top->stage);
+        *out = winnerResults.results.front().id;
+        winnerResults.results.pop_front();
 
-        // Save the ID that we're returning and remove the returned result from our data.
-        WorkingSetID idToTest = top->id;
-        _mergingData.erase(top);
+        // Since we're returning the winner's result, it needs its next result played up the
+        // tree.  If that comes from a batch we already read, play it right away.
+        if (winnerResults.results.empty() && !winnerResults.eof) {
+            _pendingChild = winner;
+        }
+        else {
+            replay(winner);
+        }
 
         // Return the min.
-        *out = idToTest;
         ++_commonStats.advanced;
 
         // But don't return it if it's flagged.
@@ -192,6 +204,106 @@ namespace mongo {
         return PlanStage::ADVANCED;
     }
 
+    PlanStage::StageState MergeSortStage::readChild(size_t i, WorkingSetID* out) {
+        PlanStage* child = _children[i];
+        ChildResults& childResults = _childResults[i];
+
+        _batch.clear();
+        StageState code;
+        if (child->supportsWorkBatch()) {
+            code = child->workBatch(kChildBatchSize, &_batch, out);
+        }
+        else {
+            code = child->work(out);
+            if (PlanStage::ADVANCED == code) {
+                _batch.push_back(*out);
+            }
+        }
+
+        if (PlanStage::IS_EOF == code) {
+            // There are no more results possible from this child.
+            childResults.eof = true;
+        }
+
+        for (size_t j = 0; j < _batch.size(); ++j) {
+            const WorkingSetID id = _batch[j];
+            WorkingSetMember* member = _ws->get(id);
+
+            // If we're deduping, and can, because there's a RecordId, drop the RecordIds
+            // we've seen before.
+            if (_dedup && member->hasLoc()) {
+                ++_specificStats.dupsTested;
+                if (!_seen.insert(member->loc).second) {
+                    _ws->free(id);
+                    ++_specificStats.dupsDropped;
+                    continue;
+                }
+            }
+
+            childResults.results.push_back(BufferedResult());
+            BufferedResult& result = childResults.results.back();
+            result.id = id;
+            if (_comparison.usesKeyString()) {
+                result.sortKey = _comparison.makeSortKey(member);
+            }
+        }
+
+        return code;
+    }
+
+    bool MergeSortStage::beats(size_t lhs, size_t rhs) const {
+        const std::deque<BufferedResult>& lhsResults = _childResults[lhs].results;
+        const std::deque<BufferedResult>& rhsResults = _childResults[rhs].results;
+        if (lhsResults.empty()) {
+            return false;
+        }
+        if (rhsResults.empty()) {
+            return true;
+        }
+
+        // Break ties by child, so that the order doesn't depend on when results were read.
+        const int cmp = _comparison.compare(lhsResults.front(), rhsResults.front());
+        return cmp < 0 || (0 == cmp && lhs < rhs);
+    }
+
+    void MergeSortStage::buildTree() {
+        const size_t numChildren = _children.size();
+        _tree.assign(numChildren, 0);
+
+        // winners[n] is the child which won the match at node n.  The leaves, from numChildren
+        // on, are the children themselves.
+        vector<size_t> winners(2 * numChildren);
+        for (size_t i = 0; i < numChildren; ++i) {
+            winners[numChildren + i] = i;
+        }
+        for (size_t n = numChildren - 1; n >= 1; --n) {
+            const size_t left = winners[2 * n];
+            const size_t right = winners[2 * n + 1];
+            if (beats(right, left)) {
+                winners[n] = right;
+                _tree[n] = left;
+            }
+            else {
+                winners[n] = left;
+                _tree[n] = right;
+            }
+        }
+
+        _tree[0] = numChildren > 1 ? winners[1] : 0;
+        _treeBuilt = true;
+    }
+
+    void MergeSortStage::replay(size_t i) {
+        const size_t numChildren = _children.size();
+        size_t winner = i;
+        for (size_t n = (numChildren + i) / 2; n >= 1; n /= 2) {
+            if (beats(_tree[n], winner)) {
+                std::swap(_tree[n], winner);
+            }
+        }
+        _tree[0] = winner;
+    }
+
     void MergeSortStage::saveState() {
         ++_commonStats.yields;
         for (size_t i = 0; i < _children.size(); ++i) {
@@ -214,14 +326,19 @@ namespace mongo {
             _children[i]->invalidate(txn, dl, type);
         }
 
-        // Go through our data and see if we're holding on to the invalidated loc.
-        for (list<StageWithValue>::iterator valueIt = _mergingData.begin(); valueIt != _mergingData.end(); valueIt++) {
-            WorkingSetMember* member = _ws->get(valueIt->id);
-            if (member->hasLoc() && (dl == member->loc)) {
-                // Force a fetch and flag.  We could possibly merge this result back in later.
-                WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
-                _ws->flagForReview(valueIt->id);
-                ++_specificStats.forcedFetches;
+        // Go through our data and see if we're holding on to the invalidated loc.  Their sort
+        // keys don't change.
+        for (size_t i = 0; i < _childResults.size(); ++i) {
+            std::deque<BufferedResult>& results = _childResults[i].results;
+            for (std::deque<BufferedResult>::iterator it = results.begin(); it != results.end();
+                 ++it) {
+                WorkingSetMember* member = _ws->get(it->id);
+                if (member->hasLoc() && (dl == member->loc)) {
+                    // Force a fetch and flag.  We could possibly merge this result back in later.
+                    WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+                    _ws->flagForReview(it->id);
+                    ++_specificStats.forcedFetches;
+                }
             }
         }
 
@@ -230,13 +347,34 @@ namespace mongo {
         if (_dedup) { _seen.erase(dl); }
     }
 
-    // Is lhs less than rhs?  Note that priority_queue is a max heap by default so we invert
-    // the return from the expected value.
-    bool MergeSortStage::StageWithValueComparison::operator()(
-        const MergingRef& lhs, const MergingRef& rhs) {
+    MergeSortStage::SortKeyComparison::SortKeyComparison(WorkingSet* ws, const BSONObj& pattern)
+        : _ws(ws),
+          _pattern(pattern),
+          _useKeyString(canUseKeyString(pattern)),
+          _ordering(Ordering::make(_useKeyString ? directionsOf(pattern) : BSONObj())) { }
+
+    std::string MergeSortStage::SortKeyComparison::makeSortKey(WorkingSetMember* member) const {
+        BSONObjBuilder keyBob;
+        BSONObjIterator it(_pattern);
+        while (it.more()) {
+            BSONElement elt;
+            verify(member->getFieldDotted(it.next().fieldName(), &elt));
+            keyBob.appendAs(elt, "");
+        }
+
+        const KeyString keyString(keyBob.obj(), _ordering);
+        return std::string(keyString.getBuffer(), keyString.getSize());
+    }
+
+    int MergeSortStage::SortKeyComparison::compare(const BufferedResult& lhs,
+                                                   const BufferedResult& rhs) const {
+        if (_useKeyString) {
+            return KeyString::compare(lhs.sortKey.data(), lhs.sortKey.size(),
+                                      rhs.sortKey.data(), rhs.sortKey.size());
+        }
 
-        WorkingSetMember* lhsMember = _ws->get(lhs->id);
-        WorkingSetMember* rhsMember = _ws->get(rhs->id);
+        WorkingSetMember* lhsMember = _ws->get(lhs.id);
+        WorkingSetMember* rhsMember = _ws->get(rhs.id);
 
         BSONObjIterator it(_pattern);
         while (it.more()) {
@@ -252,13 +390,10 @@ namespace mongo {
             // false means don't compare field name.
             int x = lhsElt.woCompare(rhsElt, false);
             if (-1 == patternElt.number()) { x = -x; }
-            if (x != 0) { return x > 0; }
+            if (x != 0) { return x; }
         }
 
-        // A comparator for use with sort is required to model a strict weak ordering, so
-        // to satisfy irreflexivity we must return 'false' for elements that we consider
-        // equivalent under the pattern.
-        return false;
+        return 0;
     }
 
     vector<PlanStage*> MergeSortStage::getChildren() const {
@@ -28,10 +28,11 @@
 
 #pragma once
 
-#include <list>
-#include <queue>
+#include <deque>
+#include <string>
 #include <vector>
 
+#include "mongo/bson/ordering.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
@@ -50,6 +51,9 @@ namespace mongo {
      * AKA the SERVER-1205 stage.  Allows very efficient handling of the following query:
      * find($or[{a:1}, {b:1}]).sort({c:1}) with indices {a:1, c:1} and {b:1, c:1}.
      *
+     * The children's next results are kept in a loser tree, so that picking the next smallest
+     * one takes log(N) comparisons of sort keys that were encoded once.
+     *
      * Preconditions: For each field in 'pattern' all inputs in the child must handle a
      * getFieldDotted for that field.
      */
@@ -82,6 +86,9 @@ namespace mongo {
         static const char* kStageType;
 
     private:
+        // A value of _pendingChild meaning no child.
+        static const size_t kNoChild;
+
         // Not owned by us.
         const Collection* _collection;
 
@@ -100,52 +107,91 @@ namespace mongo {
         // Owned by us.  All the children we're reading from.
         std::vector<PlanStage*> _children;
 
-        // In order to pick the next smallest value, we need each child work(...) until it produces
-        // a result.  This is the queue of children that haven't given us a result yet.
-        std::queue<PlanStage*> _noResultToMerge;
-
-        // There is some confusing STL wrangling going on below.  Here's a guide:
-        //
-        // We want to keep a priority_queue of results so we can quickly return the min result.
-        //
-        // If we receive an invalidate, we need to iterate over any cached state to see if the
-        // invalidate is relevant.
-        //
-        // We can't iterate over a priority_queue, so we keep the actual cached state in a list and
-        // have a priority_queue of iterators into that list.
-        //
-        // Why an iterator instead of a pointer?  We need to be able to use the information in the
-        // priority_queue to remove the item from the list and quickly.
-
-        struct StageWithValue {
-            StageWithValue() : id(WorkingSet::INVALID_ID), stage(NULL) { }
+        // A result read from a child, with its sort key encoded as a KeyString if the comparison
+        // uses them.
+        struct BufferedResult {
+            BufferedResult() : id(WorkingSet::INVALID_ID) { }
             WorkingSetID id;
-            PlanStage* stage;
+            std::string sortKey;
         };
 
-        // We have a priority queue of these.
-        typedef std::list<StageWithValue>::iterator MergingRef;
+        // The results read from _children[i] but not returned yet are in _childResults[i], in
+        // order.  Children which support it are read a batch of results at a time.
+        struct ChildResults {
+            ChildResults() : eof(false) { }
+            std::deque<BufferedResult> results;
+            bool eof;
+        };
+        std::vector<ChildResults> _childResults;
 
-        // The comparison function used in our priority queue.
-        class StageWithValueComparison {
+        // Compares the sort keys of two results.
+        class SortKeyComparison {
         public:
-            StageWithValueComparison(WorkingSet* ws, BSONObj pattern)
-                : _ws(ws), _pattern(pattern) {}
+            SortKeyComparison(WorkingSet* ws, const BSONObj& pattern);
+
+            /**
+             * Returns <0, 0 or >0 as 'lhs' sorts before, with or after 'rhs'.
+             */
+            int compare(const BufferedResult& lhs, const BufferedResult& rhs) const;
+
+            bool usesKeyString() const { return _useKeyString; }
 
-            // Is lhs less than rhs?  Note that priority_queue is a max heap by default so we invert
-            // the return from the expected value.
-            bool operator()(const MergingRef& lhs, const MergingRef& rhs);
+            /**
+             * Returns the sort key of 'member' as a KeyString, which compares like the fields
+             * of 'member' do in the pattern's directions.
+             */
+            std::string makeSortKey(WorkingSetMember* member) const;
 
         private:
             WorkingSet* _ws;
             BSONObj _pattern;
+            bool _useKeyString;
+            Ordering _ordering;
         };
 
-        // The min heap of the results we're returning.
-        std::priority_queue<MergingRef, std::vector<MergingRef>, StageWithValueComparison> _merging;
+        SortKeyComparison _comparison;
+
+        /**
+         * Reads more results from _children[i] into _childResults[i], and returns how that
+         * went, like work() would: ADVANCED if at least one result was kept.
+         */
+        StageState readChild(size_t i, WorkingSetID* out);
+
+        /**
+         * Whether the next result of _children[lhs] sorts before the next result of
+         * _children[rhs].  A child without results sorts after everything.
+         */
+        bool beats(size_t lhs, size_t rhs) const;
+
+        /**
+         * Builds the tournament tree once every child has a result or is EOF.
+         */
+        void buildTree();
+
+        /**
+         * Plays the next result of _children[i] up the tree, after the previous one was returned.
+         */
+        void replay(size_t i);
+
+        // A loser tree over the children's next results.  _tree[0] is the child with the
+        // smallest next result, and each internal node _tree[n], for n from 1 to the number of
+        // children - 1, is the child which lost the match played there.  The children are the
+        // leaves: child i is node number i + the number of children, and node n plays the
+        // winners from nodes 2n and 2n + 1.
+        //
+        // After the winner's result is returned, only its path to the root has to be played
+        // again, which takes log(number of children) comparisons.
+        std::vector<size_t> _tree;
+
+        // False until every child has a result or is EOF, and the tree is built.
+        bool _treeBuilt;
+
+        // Before the tree is built, the next child to read from.  After, the child whose result
+        // was just returned, and which needs its next one to be played, if any.
+        size_t _pendingChild;
 
-        // The data referred to by the _merging queue above.
-        std::list<StageWithValue> _mergingData;
+        // Where readChild() reads children's results into, kept to reuse its memory.
+        std::vector<WorkingSetID> _batch;
 
         // Stats
         CommonStats _commonStats;
@@ -160,7 +206,8 @@ namespace mongo {
         // How we're sorting.
         BSONObj pattern;
 
-        // Do we deduplicate on RecordId?
+        // Do we deduplicate on RecordId?  Only needed when the children can return the same
+        // RecordId.
         bool dedup;
     };
 
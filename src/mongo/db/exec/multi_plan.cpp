@@ -43,8 +43,10 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/index_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/log.h"
@@ -101,8 +103,8 @@ namespace mongo {
     }
 
     PlanStage::StageState MultiPlanStage::work(WorkingSetID* out) {
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (_failure) {
             *out = _statusMemberId;
@@ -223,14 +225,16 @@ namespace mongo {
     }
 
     Status MultiPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeCycles. There's lots of
         // execution work that happens here, so this is needed for the time accounting to
         // make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         size_t numWorks = getTrialPeriodWorks(_txn, _collection);
         size_t numResults = getTrialPeriodNumToReturn(*_query);
 
+        pruneByEstimatedCost(numWorks);
+
         // Work the plans, stopping when a plan hits EOF or returns some
         // fixed number of results.
         for (size_t ix = 0; ix < numWorks; ++ix) {
@@ -309,6 +313,74 @@ namespace mongo {
         return Status::OK();
     }
 
+    namespace {
+
+        void getIndexScans(const QuerySolutionNode* node, vector<const IndexScanNode*>* out) {
+            if (STAGE_IXSCAN == node->getType()) {
+                out->push_back(static_cast<const IndexScanNode*>(node));
+            }
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                getIndexScans(node->children[i], out);
+            }
+        }
+
+    }  // namespace
+
+    void MultiPlanStage::pruneByEstimatedCost(size_t numWorks) {
+        if (!internalQueryPlannerUseIndexStatistics || _candidates.size() < 2) {
+            return;
+        }
+
+        const long long numRecords = _collection->numRecords(_txn);
+        IndexStatisticsMap indexStats;
+        vector<double> costs;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            const QuerySolutionNode* root = _candidates[ix].solution->root.get();
+
+            vector<const IndexScanNode*> scans;
+            getIndexScans(root, &scans);
+            for (size_t i = 0; i < scans.size(); ++i) {
+                const BSONObj& keyPattern = scans[i]->indexKeyPattern;
+                if (indexStats.count(keyPattern)) {
+                    continue;
+                }
+                const IndexDescriptor* desc =
+                    _collection->getIndexCatalog()->findIndexByKeyPattern(_txn, keyPattern);
+                if (NULL == desc) {
+                    return;
+                }
+                indexStats[keyPattern] =
+                    _collection->infoCache()->getIndexStatistics(_txn, desc);
+            }
+
+            PlanCostEstimate estimate;
+            if (!estimatePlanCost(root, indexStats, numRecords, &estimate)) {
+                LOG(5) << "Can't estimate the cost of candidate " << ix << ", keeping all";
+                return;
+            }
+            costs.push_back(estimate.totalCost());
+        }
+
+        const double minCost = *std::min_element(costs.begin(), costs.end());
+        const double maxCost = std::max(static_cast<double>(numWorks),
+                                        internalQueryPlannerStatisticsPruneRatio * minCost);
+
+        vector<CandidatePlan> kept;
+        for (size_t ix = 0; ix < _candidates.size(); ++ix) {
+            if (costs[ix] <= maxCost) {
+                kept.push_back(_candidates[ix]);
+                continue;
+            }
+
+            LOG(2) << "Dropping query plan with estimated cost " << costs[ix]
+                   << " against best estimate " << minCost << ": "
+                   << Explain::getPlanSummary(_candidates[ix].root);
+            delete _candidates[ix].solution;
+            delete _candidates[ix].root;
+        }
+        _candidates.swap(kept);
+    }
+
     vector<PlanStageStats*> MultiPlanStage::generateCandidateStats() {
         OwnedPointerVector<PlanStageStats> candidateStats;
 
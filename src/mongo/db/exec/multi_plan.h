@@ -163,6 +163,14 @@ namespace mongo {
          */
         bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy);
 
+        /**
+         * Drops the candidates whose cost, estimated from sampled index statistics, is many
+         * times that of the cheapest candidate, so that the trial period doesn't have to run
+         * them. Candidates which cost less than 'numWorks' are always kept, and all of them are
+         * kept if the cost of one can't be estimated.
+         */
+        void pruneByEstimatedCost(size_t numWorks);
+
         /**
          * Checks whether we need to perform either a timing-based yield or a yield for a document
          * fetch. If so, then uses 'yieldPolicy' to actually perform the yield.
@@ -0,0 +1,227 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_collection_scanner.h"
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+    // How often the calling thread checks for interruption while the workers run.
+    const int kInterruptCheckMillis = 50;
+
+    // How many documents a worker reads between checks of whether the scan was stopped.
+    const int kAbortCheckInterval = 1024;
+
+    /**
+     * State shared by the worker threads of one run().
+     */
+    class ScanState {
+    public:
+        ScanState(const std::vector<RecordIterator*>& iterators,
+                  const MatchExpression* filter,
+                  size_t numWorkers)
+            : _iterators(iterators),
+              _filter(filter),
+              _workersRunning(numWorkers),
+              _status(Status::OK()) { }
+
+        void runWorker(ParallelCollectionScanner::Worker* worker) {
+            try {
+                WorkerReader reader(this);
+                worker->run(&reader);
+            }
+            catch (const DBException& e) {
+                abort(e.toStatus());
+            }
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (--_workersRunning == 0) {
+                _done.notify_all();
+            }
+        }
+
+        /**
+         * Waits for all workers to finish, checking 'txn' for interruption meanwhile and
+         * stopping the workers if it was. Returns the first error seen.
+         */
+        Status waitForWorkers(OperationContext* txn) {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            while (_workersRunning > 0) {
+                _done.timed_wait(lk, boost::posix_time::milliseconds(kInterruptCheckMillis));
+
+                Status interruptStatus = txn->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK() && _status.isOK()) {
+                    _status = interruptStatus;
+                    _aborted.store(1);
+                }
+            }
+            return _status;
+        }
+
+    private:
+        class WorkerReader : public ParallelCollectionScanner::Reader {
+        public:
+            explicit WorkerReader(ScanState* state)
+                : _state(state),
+                  _it(NULL),
+                  _untilAbortCheck(kAbortCheckInterval) { }
+
+            virtual bool getNext(BSONObj* obj) {
+                while (true) {
+                    if (--_untilAbortCheck == 0) {
+                        if (_state->_aborted.load()) {
+                            return false;
+                        }
+                        _untilAbortCheck = kAbortCheckInterval;
+                    }
+
+                    if (!_it || _it->isEOF()) {
+                        if (_state->_aborted.load()) {
+                            return false;
+                        }
+                        const size_t partition = _state->_nextPartition.fetchAndAdd(1);
+                        if (partition >= _state->_iterators.size()) {
+                            return false;
+                        }
+                        _it = _state->_iterators[partition];
+                        continue;
+                    }
+
+                    const RecordId loc = _it->getNext();
+                    if (loc.isNull()) {
+                        _it = NULL;
+                        continue;
+                    }
+
+                    _data = _it->dataFor(loc);
+                    *obj = _data.toBson();
+                    if (!_state->_filter || _state->_filter->matchesBSON(*obj)) {
+                        return true;
+                    }
+                }
+            }
+
+        private:
+            ScanState* const _state;
+            RecordIterator* _it;
+            RecordData _data;
+            int _untilAbortCheck;
+        };
+
+        void abort(const Status& status) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_status.isOK()) {
+                _status = status;
+            }
+            _aborted.store(1);
+        }
+
+        const std::vector<RecordIterator*>& _iterators;
+        const MatchExpression* const _filter;
+
+        AtomicUInt64 _nextPartition;
+        AtomicUInt32 _aborted;
+
+        // Protects the members below.
+        boost::mutex _mutex;
+        boost::condition_variable _done;
+        size_t _workersRunning;
+        Status _status;
+    };
+
+}  // namespace
+
+    ParallelCollectionScanner::ParallelCollectionScanner(OperationContext* txn,
+                                                         const Collection* collection,
+                                                         const MatchExpression* filter)
+        : _txn(txn),
+          _filter(filter),
+          _iterators(collection->getManyIterators(txn)) { }
+
+    // static
+    bool ParallelCollectionScanner::canEvaluateInParallel(const MatchExpression* filter) {
+        if (!filter) {
+            return true;
+        }
+
+        // $where runs JavaScript in the operation's scope, which is single threaded. Text and
+        // geoNear predicates are never answered by a collection scan.
+        switch (filter->matchType()) {
+        case MatchExpression::WHERE:
+        case MatchExpression::TEXT:
+        case MatchExpression::GEO_NEAR:
+            return false;
+        default:
+            break;
+        }
+
+        for (size_t i = 0; i < filter->numChildren(); ++i) {
+            if (!canEvaluateInParallel(filter->getChild(i))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Status ParallelCollectionScanner::run(const std::vector<Worker*>& workers) {
+        invariant(!workers.empty());
+
+        ScanState state(_iterators.vector(), _filter, workers.size());
+
+        std::vector<boost::thread*> threads;
+        for (size_t i = 0; i < workers.size(); ++i) {
+            threads.push_back(new boost::thread(stdx::bind(&ScanState::runWorker,
+                                                           &state,
+                                                           workers[i])));
+        }
+
+        Status status = state.waitForWorkers(_txn);
+
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        return status;
+    }
+
+}  // namespace mongo
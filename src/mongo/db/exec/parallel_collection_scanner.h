@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/storage/record_store.h"
+
+namespace mongo {
+
+    class Collection;
+    class MatchExpression;
+    class OperationContext;
+
+    /**
+     * Scans a whole collection with several threads, for operations such as count and $group
+     * which can keep partial state per thread and combine it at the end.
+     *
+     * The collection is split into the partitions returned by Collection::getManyIterators()
+     * (for mmapv1, one per extent). Each thread repeatedly claims the next unscanned partition,
+     * so threads which get small partitions simply take more of them.
+     *
+     * The caller must hold at least a MODE_IS lock on the collection from construction until
+     * run() returns. The scan never yields, so it sees the collection as of the moment it starts.
+     * Worker threads have no OperationContext of their own; the calling thread checks for
+     * interruption while they run.
+     */
+    class ParallelCollectionScanner {
+        MONGO_DISALLOW_COPYING(ParallelCollectionScanner);
+    public:
+        /**
+         * Hands the documents that match the filter to one worker, claiming further partitions
+         * as the current one runs out.
+         */
+        class Reader {
+        public:
+            /**
+             * Sets '*obj' to the next matching document, which stays valid until the next call.
+             * Returns false once the collection is exhausted or the scan has been stopped.
+             */
+            virtual bool getNext(BSONObj* obj) = 0;
+
+        protected:
+            ~Reader() { }
+        };
+
+        /**
+         * The per-thread part of a parallel operation. Each worker runs on its own thread and
+         * keeps its own partial state, so it needs no synchronization of its own.
+         */
+        class Worker {
+        public:
+            virtual ~Worker() { }
+
+            /**
+             * Consumes documents from 'reader' until it returns false. May throw a DBException,
+             * which stops the whole scan and is returned from run().
+             */
+            virtual void run(Reader* reader) = 0;
+        };
+
+        /**
+         * Neither 'collection' nor 'filter' is owned. 'filter' may be NULL to match everything.
+         */
+        ParallelCollectionScanner(OperationContext* txn,
+                                  const Collection* collection,
+                                  const MatchExpression* filter);
+
+        /**
+         * Returns false if 'filter' cannot safely be evaluated by several threads at once, for
+         * example because it contains a $where.
+         */
+        static bool canEvaluateInParallel(const MatchExpression* filter);
+
+        /**
+         * The number of partitions the collection was split into. With fewer than two there is
+         * nothing to gain over a plain collection scan and callers should use one instead.
+         */
+        size_t numPartitions() const { return _iterators.size(); }
+
+        /**
+         * Runs each of 'workers' on a thread of its own and returns once all of them are done.
+         *
+         * Returns a non-OK status if the operation was interrupted or a worker threw. In that
+         * case the workers' state is incomplete and must be discarded.
+         */
+        Status run(const std::vector<Worker*>& workers);
+
+    private:
+        OperationContext* const _txn;
+        const MatchExpression* const _filter;
+        OwnedPointerVector<RecordIterator> _iterators;
+    };
+
+}  // namespace mongo
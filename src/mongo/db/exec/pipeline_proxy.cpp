@@ -109,6 +109,43 @@ namespace mongo {
         _stash.push_back(obj);
     }
 
+    bool PipelineProxyStage::appendBatch(BSONObjBuilder* batch, long long maxDocs, int maxBytes) {
+        for (long long n = 0; n < maxDocs; n++) {
+            const int start = batch->len();
+            const std::string fieldName = BSONObjBuilder::numStr(n);
+
+            if (!_stash.empty()) {
+                batch->append(fieldName, _stash.back());
+                _stash.pop_back();
+            }
+            else {
+                boost::optional<Document> next = _pipeline->output()->getNext();
+                if (!next) {
+                    return false;
+                }
+
+                BSONObjBuilder doc(batch->subobjStart(fieldName));
+                if (_includeMetaData) {
+                    next->toBsonWithMetaData(&doc);
+                }
+                else {
+                    next->toBson(&doc);
+                }
+                doc.doneFast();
+            }
+
+            if (n > 0 && batch->len() > maxBytes) {
+                // Too big, so this will be the first result of the next batch. Only this copy is
+                // made, once per batch.
+                BSONElement last(batch->bb().buf() + start);
+                _stash.push_back(last.Obj().getOwned());
+                batch->bb().setlen(start);
+                break;
+            }
+        }
+        return true;
+    }
+
     vector<PlanStage*> PipelineProxyStage::getChildren() const {
         vector<PlanStage*> empty;
         return empty;
@@ -68,6 +68,14 @@ namespace mongo {
          */
         void pushBack(const BSONObj& obj);
 
+        /**
+         * Writes up to 'maxDocs' results into 'batch' as the elements of an array, each written
+         * straight from its Document rather than converted to a BSONObj first. Stops before
+         * 'batch' would grow past 'maxBytes', keeping the result that didn't fit for later,
+         * unless it is the first one. Returns false if the pipeline was exhausted.
+         */
+        bool appendBatch(BSONObjBuilder* batch, long long maxDocs, int maxBytes);
+
         /**
          * Return a shared pointer to the PlanExecutor that feeds the pipeline. The returned
          * pointer may be NULL.
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/invalidation_type.h"
@@ -184,6 +186,46 @@ namespace mongo {
          */
         virtual StageState work(WorkingSetID* out) = 0;
 
+        /**
+         * Batched version of work(): performs up to 'maxWorks' units of work, appending every
+         * result produced along the way to 'results', so that a whole tree can be run for many
+         * results per virtual call.
+         *
+         * Returns ADVANCED if at least one result was appended and NEED_TIME if none was, unless a
+         * unit of work returned IS_EOF, NEED_YIELD, DEAD or FAILURE. In that case the batch stops
+         * there and that state is returned, with *out set exactly as work() would have set it.
+         * Results appended before such a state are still valid and precede it in the output
+         * stream, so the caller must consume them first.
+         *
+         * The default implementation simply calls work() repeatedly. Stages that can do better
+         * override it along with supportsWorkBatch().
+         */
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out) {
+            const size_t numResultsBefore = results->size();
+            for (size_t i = 0; i < maxWorks; i++) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                const StageState state = work(&id);
+                if (ADVANCED == state) {
+                    results->push_back(id);
+                }
+                else if (NEED_TIME != state) {
+                    *out = id;
+                    return state;
+                }
+            }
+
+            return results->size() > numResultsBefore ? ADVANCED : NEED_TIME;
+        }
+
+        /**
+         * Returns true if this stage implements workBatch() natively, rather than relying on the
+         * default implementation. PlanExecutor only runs a tree in batches if every stage in it
+         * does.
+         */
+        virtual bool supportsWorkBatch() const { return false; }
+
         /**
          * Returns true if no more work can be done on the query / out of results.
          */
@@ -283,6 +325,31 @@ namespace mongo {
          */
         virtual const SpecificStats* getSpecificStats() const = 0;
 
+    protected:
+        /**
+         * Same as the default workBatch(), but calls Stage::work() directly instead of through the
+         * vtable. Leaf stages implement workBatch() by passing 'this'.
+         */
+        template <typename Stage>
+        static StageState workBatchWith(Stage* stage,
+                                        size_t maxWorks,
+                                        std::vector<WorkingSetID>* results,
+                                        WorkingSetID* out) {
+            const size_t numResultsBefore = results->size();
+            for (size_t i = 0; i < maxWorks; i++) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                const StageState state = stage->Stage::work(&id);
+                if (ADVANCED == state) {
+                    results->push_back(id);
+                }
+                else if (NEED_TIME != state) {
+                    *out = id;
+                    return state;
+                }
+            }
+
+            return results->size() > numResultsBefore ? ADVANCED : NEED_TIME;
+        }
     };
 
 }  // namespace mongo
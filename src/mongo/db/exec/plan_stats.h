@@ -61,11 +61,13 @@ namespace mongo {
                         works(0),
                         yields(0),
                         unyields(0),
+                        restoreStateMicros(0),
                         invalidates(0),
                         advanced(0),
                         needTime(0),
                         needYield(0),
-                        executionTimeMillis(0),
+                        executionTimeCycles(0),
+                        storageTimeCycles(0),
                         isEOF(false) { }
         // String giving the type of the stage. Not owned.
         const char* stageTypeStr;
@@ -74,6 +76,9 @@ namespace mongo {
         size_t works;
         size_t yields;
         size_t unyields;
+        // Time spent repositioning storage cursors in restoreState(). Only stages that read from
+        // storage directly record it.
+        long long restoreStateMicros;
         size_t invalidates;
 
         // How many times was this state the return value of work(...)?
@@ -85,8 +90,14 @@ namespace mongo {
         // is no filter affixed, then 'filter' should be an empty BSONObj.
         BSONObj filter;
 
-        // Time elapsed while working inside this stage.
-        long long executionTimeMillis;
+        // Time elapsed while working inside this stage, including its children, in CycleClock
+        // cycles.
+        long long executionTimeCycles;
+
+        // The part of executionTimeCycles spent in calls into the storage engine made by this
+        // stage itself, such as advancing or seeking a cursor or fetching a record.  Only stages
+        // that read from storage directly record it.
+        long long storageTimeCycles;
 
         // TODO: have some way of tracking WSM sizes (or really any series of #s).  We can measure
         // the size of our inputs and the size of our outputs.  We can do a lot with the WS here.
@@ -224,7 +235,7 @@ namespace mongo {
     };
 
     struct CountStats : public SpecificStats {
-        CountStats() : nCounted(0), nSkipped(0), trivialCount(false) { }
+        CountStats() : nCounted(0), nSkipped(0), trivialCount(false), approximate(false) { }
 
         virtual SpecificStats* clone() const {
             CountStats* specific = new CountStats(*this);
@@ -240,6 +251,9 @@ namespace mongo {
         // A "trivial count" is one that we can answer by calling numRecords() on the
         // collection, without actually going through any query logic.
         bool trivialCount;
+
+        // Whether nCounted is an estimate rather than an exact count.
+        bool approximate;
     };
 
     struct CountScanStats : public SpecificStats {
@@ -377,6 +391,7 @@ namespace mongo {
             // BSON objects have to be explicitly copied.
             specific->keyPattern = keyPattern.getOwned();
             specific->indexBounds = indexBounds.getOwned();
+            specific->geoCovering = geoCovering.getOwned();
             return specific;
         }
 
@@ -394,6 +409,10 @@ namespace mongo {
         // used.
         BSONObj indexBounds;
 
+        // For each field whose bounds come from a 2d covering, how they were made. Empty if
+        // there are none.
+        BSONObj geoCovering;
+
         // >1 if we're traversing the index along with its order. <1 if we're traversing it
         // against the order.
         int direction;
@@ -477,7 +496,7 @@ namespace mongo {
     };
 
     struct SortStats : public SpecificStats {
-        SortStats() : forcedFetches(0), memUsage(0), memLimit(0) { }
+        SortStats() : forcedFetches(0), memUsage(0), memLimit(0), usedDisk(false) { }
 
         virtual ~SortStats() { }
 
@@ -495,6 +514,9 @@ namespace mongo {
         // What's our memory limit?
         size_t memLimit;
 
+        // Did we exceed the memory limit and sort externally?
+        bool usedDisk;
+
         // The number of results to return from the sort.
         size_t limit;
 
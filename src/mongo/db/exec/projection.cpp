@@ -50,13 +50,17 @@ namespace mongo {
     // static
     const char* ProjectionStage::kStageType = "PROJECTION";
 
+    // static
+    const size_t ProjectionStage::kMaxListInclusionFields;
+
     ProjectionStage::ProjectionStage(const ProjectionStageParams& params,
                                      WorkingSet* ws,
                                      PlanStage* child)
         : _ws(ws),
           _child(child),
           _commonStats(kStageType),
-          _projImpl(params.projImpl) {
+          _projImpl(params.projImpl),
+          _numKeyFieldsUsed(0) {
 
         _projObj = params.projObj;
 
@@ -76,6 +80,20 @@ namespace mongo {
             // Figure out what fields are in the projection.
             getSimpleInclusionFields(_projObj, &_includedFields);
 
+            if (_includedFields.size() <= kMaxListInclusionFields) {
+                // _id is almost always the first field of a document, so look for it first.
+                if (_includedFields.count(kIdField)) {
+                    _includedFieldList.push_back(kIdField);
+                }
+                for (FieldSet::const_iterator it = _includedFields.begin();
+                     it != _includedFields.end();
+                     ++it) {
+                    if (*it != kIdField) {
+                        _includedFieldList.push_back(*it);
+                    }
+                }
+            }
+
             // If we're pulling data out of one index we can pre-compute the indices of the fields
             // in the key that we pull data from and avoid looking up the field name each time.
             if (ProjectionStageParams::COVERED_ONE_INDEX == params.projImpl) {
@@ -99,6 +117,7 @@ namespace mongo {
                         // If we are including this key field store its field name.
                         _keyFieldNames.push_back(*fieldIt);
                         _includeKey.push_back(true);
+                        _numKeyFieldsUsed = _includeKey.size();
                     }
                 }
             }
@@ -151,6 +170,29 @@ namespace mongo {
         }
     }
 
+    // static
+    void ProjectionStage::transformSimpleInclusion(const BSONObj& in,
+                                                   const vector<StringData>& includedFields,
+                                                   BSONObjBuilder& bob) {
+        invariant(includedFields.size() <= kMaxListInclusionFields);
+
+        // One bit per included field, cleared once the field has been seen.
+        unsigned int missing = (1U << includedFields.size()) - 1;
+
+        BSONObjIterator inputIt(in);
+        while (missing && inputIt.more()) {
+            BSONElement elt = inputIt.next();
+            StringData fieldName = elt.fieldNameStringData();
+            for (size_t i = 0; i < includedFields.size(); ++i) {
+                if (includedFields[i] == fieldName) {
+                    bob.append(elt);
+                    missing &= ~(1U << i);
+                    break;
+                }
+            }
+        }
+    }
+
     Status ProjectionStage::transform(WorkingSetMember* member) {
         // The default no-fast-path case.
         if (ProjectionStageParams::NO_FAST_PATH == _projImpl) {
@@ -170,7 +212,12 @@ namespace mongo {
             invariant(member->hasObj());
 
             // Apply the SIMPLE_DOC projection.
-            transformSimpleInclusion(member->obj.value(), _includedFields, bob);
+            if (!_includedFieldList.empty()) {
+                transformSimpleInclusion(member->obj.value(), _includedFieldList, bob);
+            }
+            else {
+                transformSimpleInclusion(member->obj.value(), _includedFields, bob);
+            }
         }
         else {
             invariant(ProjectionStageParams::COVERED_ONE_INDEX == _projImpl);
@@ -178,9 +225,9 @@ namespace mongo {
             invariant(1 == member->keyData.size());
             size_t keyIndex = 0;
 
-            // Look at every key element...
+            // Look at every key element up to the last one we include...
             BSONObjIterator keyIterator(member->keyData[0].keyData);
-            while (keyIterator.more()) {
+            while (keyIndex < _numKeyFieldsUsed && keyIterator.more()) {
                 BSONElement elt = keyIterator.next();
                 // If we're supposed to include it...
                 if (_includeKey[keyIndex]) {
@@ -205,8 +252,8 @@ namespace mongo {
     PlanStage::StageState ProjectionStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
@@ -250,6 +297,58 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState ProjectionStage::workBatch(size_t maxWorks,
+                                                     vector<WorkingSetID>* results,
+                                                     WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
+
+        const size_t numResultsBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        StageState status = _child->workBatch(maxWorks, results, out);
+        _commonStats.works += _child->getCommonStats()->works - childWorksBefore;
+
+        for (size_t i = numResultsBefore; i < results->size(); i++) {
+            WorkingSetMember* member = _ws->get((*results)[i]);
+            // Punt to our specific projection impl.
+            Status projStatus = transform(member);
+            if (!projStatus.isOK()) {
+                warning() << "Couldn't execute projection, status = "
+                          << projStatus.toString() << endl;
+
+                // The results we've already projected are still returned ahead of the failure.
+                for (size_t j = i; j < results->size(); j++) {
+                    _ws->free((*results)[j]);
+                }
+                results->resize(i);
+                *out = WorkingSetCommon::allocateStatusMember(_ws, projStatus);
+                return PlanStage::FAILURE;
+            }
+
+            ++_commonStats.advanced;
+        }
+
+        if (PlanStage::FAILURE == status) {
+            // If a stage fails, it may create a status WSM to indicate why it
+            // failed, in which case 'id' is valid.  If ID is invalid, we
+            // create our own error message.
+            if (WorkingSet::INVALID_ID == *out) {
+                mongoutils::str::stream ss;
+                ss << "projection stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_TIME == status) {
+            _commonStats.needTime++;
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            _commonStats.needYield++;
+        }
+
+        return status;
+    }
+
     void ProjectionStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/projection_exec.h"
@@ -84,6 +85,10 @@ namespace mongo {
 
         virtual bool isEOF();
         virtual StageState work(WorkingSetID* out);
+        virtual StageState workBatch(size_t maxWorks,
+                                     std::vector<WorkingSetID>* results,
+                                     WorkingSetID* out);
+        virtual bool supportsWorkBatch() const { return true; }
 
         virtual void saveState();
         virtual void restoreState(OperationContext* opCtx);
@@ -119,6 +124,19 @@ namespace mongo {
                                              const FieldSet& includedFields,
                                              BSONObjBuilder& bob);
 
+        // Projections including at most this many fields are matched against a list rather than
+        // the hashed FieldSet.
+        static const size_t kMaxListInclusionFields = 16;
+
+        /**
+         * Same as above, for projections of at most kMaxListInclusionFields fields.  The field
+         * names in 'includedFields' are compared in order, so the most likely ones go first, and
+         * the copy stops as soon as each of them has been found in 'in'.
+         */
+        static void transformSimpleInclusion(const BSONObj& in,
+                                             const std::vector<StringData>& includedFields,
+                                             BSONObjBuilder& bob);
+
         static const char* kStageType;
 
     private:
@@ -144,6 +162,10 @@ namespace mongo {
         // Has the field names present in the simple projection.
         unordered_set<StringData, StringData::Hasher> _includedFields;
 
+        // The same field names with _id first, when there are few enough of them to scan the list.
+        // Empty otherwise.
+        std::vector<StringData> _includedFieldList;
+
         //
         // Used for the COVERED_ONE_INDEX path.
         //
@@ -155,6 +177,9 @@ namespace mongo {
 
         // If the i-th entry of _includeKey is true this is the field name for the i-th key field.
         std::vector<StringData> _keyFieldNames;
+
+        // The number of leading key fields we need to look at to find all of the included ones.
+        size_t _numKeyFieldsUsed;
     };
 
 }  // namespace mongo
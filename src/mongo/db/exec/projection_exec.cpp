@@ -389,7 +389,8 @@ namespace mongo {
             }
 
             // Case 2: no array projection for this field.
-            Matchers::const_iterator matcher = _matchers.find(elt.fieldName());
+            Matchers::const_iterator matcher = _matchers.empty() ? _matchers.end()
+                                                                 : _matchers.find(elt.fieldName());
             if (_matchers.end() == matcher) {
                 Status s = append(bob, elt, details, arrayOpType);
                 if (!s.isOK()) {
@@ -417,18 +418,15 @@ namespace mongo {
                 BSONArrayBuilder arrBuilder;
                 BSONObjBuilder subBob;
 
-                if (in.getField(elt.fieldName()).eoo()) {
-                    return Status(ErrorCodes::InternalError,
-                                  "$elemMatch called on document element with eoo");
-                }
-
-                if (in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()).eoo()) {
+                // 'elt' is the field the matcher applies to, so there is no need to look it up in
+                // 'in' again.
+                BSONElement matchedElt = elt.Obj().getField(arrayDetails.elemMatchKey());
+                if (matchedElt.eoo()) {
                     return Status(ErrorCodes::InternalError,
                                   "$elemMatch called on array element with eoo");
                 }
 
-                arrBuilder.append(
-                    in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()));
+                arrBuilder.append(matchedElt);
                 subBob.appendArray(matcher->first, arrBuilder.arr());
                 Status status = append(bob, subBob.done().firstElement(), details, arrayOpType);
                 if (!status.isOK()) {
@@ -470,6 +468,13 @@ namespace mongo {
                 break;
             }
             case Object: {
+                if (_fields.empty() && _meta.empty()) {
+                    // Nothing below this level is projected, so the object is either kept whole
+                    // or emptied.
+                    bob->append(bob->numStr(index++), _include ? elt.embeddedObject() : BSONObj());
+                    break;
+                }
+
                 BSONObjBuilder subBob;
                 BSONObjIterator jt(elt.embeddedObject());
                 while (jt.more()) {
@@ -495,7 +500,7 @@ namespace mongo {
         // Skip if the field name matches a computed $meta field.
         // $meta projection fields can exist at the top level of
         // the result document and the field names cannot be dotted.
-        if (_meta.find(elt.fieldName()) != _meta.end()) {
+        if (!_meta.empty() && _meta.find(elt.fieldName()) != _meta.end()) {
             return Status::OK();
         }
 
@@ -169,6 +169,11 @@ namespace {
 
         // $elemMatch on unknown field z
         testTransform("{a: {$elemMatch: {z: 1}}}", "{}", s, true, "{}");
+
+        // Only the field with the matcher is narrowed down.
+        testTransform("{a: {$elemMatch: {x: 2}}, b: 1}", "{}",
+                      "{b: 1, a: [{x: 1}, {x: 2, y: 10}], c: 3}", true,
+                      "{b: 1, a: [{x: 2, y: 10}]}");
     }
 
     //
@@ -200,6 +205,14 @@ namespace {
         testTransform("{a: {$slice: [10, 10]}}", "{}", "{a: [4, 6, 8]}", true, "{a: []}");
     }
 
+    TEST(ProjectionExecTest, TransformSliceNestedObjects) {
+        // Objects in a sliced array are kept whole.
+        testTransform("{a: {$slice: 2}}", "{}", "{a: [{x: 1, y: {z: 2}}, [{x: 3}], {x: 4}], b: 5}",
+                      true, "{a: [{x: 1, y: {z: 2}}, [{x: 3}]], b: 5}");
+        testTransform("{a: {$slice: -1}, b: 1}", "{}", "{a: [{x: 1}, {x: 2}], b: 5, c: 6}",
+                      true, "{a: [{x: 2}], b: 5}");
+    }
+
     //
     // $meta
     // $meta projections add computed values to the projected object.
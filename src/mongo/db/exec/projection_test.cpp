@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for the simple inclusion fast paths of ProjectionStage.
+ */
+
+#include "mongo/db/exec/projection.h"
+
+#include <vector>
+
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    using std::vector;
+
+    /**
+     * Applies the simple inclusion projection 'projStr' to 'objStr' through both the hashed and
+     * the list implementations, and checks that each produces 'expectedStr'.
+     */
+    void testSimpleInclusion(const char* projStr, const char* objStr, const char* expectedStr) {
+        BSONObj proj = fromjson(projStr);
+        BSONObj obj = fromjson(objStr);
+        BSONObj expected = fromjson(expectedStr);
+
+        ProjectionStage::FieldSet fieldSet;
+        ProjectionStage::getSimpleInclusionFields(proj, &fieldSet);
+        vector<StringData> fieldList(fieldSet.begin(), fieldSet.end());
+
+        BSONObjBuilder setBob;
+        ProjectionStage::transformSimpleInclusion(obj, fieldSet, setBob);
+        ASSERT_EQUALS(expected, setBob.obj());
+
+        BSONObjBuilder listBob;
+        ProjectionStage::transformSimpleInclusion(obj, fieldList, listBob);
+        ASSERT_EQUALS(expected, listBob.obj());
+    }
+
+    TEST(ProjectionStageTest, SimpleInclusionIdOnly) {
+        testSimpleInclusion("{_id: 1}", "{_id: 1, a: 2, b: 3}", "{_id: 1}");
+        testSimpleInclusion("{_id: 1}", "{a: 2, b: 3, _id: 1}", "{_id: 1}");
+        testSimpleInclusion("{_id: 1}", "{a: 2, b: 3}", "{}");
+    }
+
+    TEST(ProjectionStageTest, SimpleInclusionKeepsDocumentOrder) {
+        testSimpleInclusion("{b: 1, a: 1}", "{_id: 1, a: 2, b: 3, c: 4}", "{_id: 1, a: 2, b: 3}");
+        testSimpleInclusion("{a: 1, _id: 0}", "{_id: 1, a: 2, b: 3}", "{a: 2}");
+        testSimpleInclusion("{c: 1}", "{_id: 1, a: 2}", "{_id: 1}");
+    }
+
+    TEST(ProjectionStageTest, SimpleInclusionDoesNotMatchPrefixes) {
+        testSimpleInclusion("{ab: 1, _id: 0}", "{a: 1, abc: 2, ab: 3}", "{ab: 3}");
+    }
+
+    TEST(ProjectionStageTest, SimpleInclusionManyFields) {
+        BSONObjBuilder projBob;
+        BSONObjBuilder objBob;
+        BSONObjBuilder expectedBob;
+        for (size_t i = 0; i < ProjectionStage::kMaxListInclusionFields; ++i) {
+            std::string field = "f" + BSONObjBuilder::numStr(i);
+            projBob.append(field, 1);
+            objBob.append(field, int(i));
+            objBob.append("x" + field, int(i));
+            expectedBob.append(field, int(i));
+        }
+        projBob.append("_id", 0);
+
+        ProjectionStage::FieldSet fieldSet;
+        BSONObj proj = projBob.obj();
+        ProjectionStage::getSimpleInclusionFields(proj, &fieldSet);
+        ASSERT_EQUALS(ProjectionStage::kMaxListInclusionFields, fieldSet.size());
+        vector<StringData> fieldList(fieldSet.begin(), fieldSet.end());
+
+        BSONObjBuilder bob;
+        ProjectionStage::transformSimpleInclusion(objBob.obj(), fieldList, bob);
+        ASSERT_EQUALS(expectedBob.obj(), bob.obj());
+    }
+
+}  // namespace
@@ -30,18 +30,22 @@
 
 #include "mongo/db/exec/scoped_timer.h"
 
-#include "mongo/util/net/listen.h"
+#include "mongo/util/cycle_clock.h"
 
 namespace mongo {
 
-    ScopedTimer::ScopedTimer(long long* counter) :
+    ScopedTimer::ScopedTimer(long long* counter, long long* secondCounter) :
         _counter(counter),
-        _start(Listener::getElapsedTimeMillis()) {
+        _secondCounter(secondCounter),
+        _start(CycleClock::now()) {
     }
 
     ScopedTimer::~ScopedTimer() {
-        long long elapsed = Listener::getElapsedTimeMillis() - _start;
+        const long long elapsed = CycleClock::now() - _start;
         *_counter += elapsed;
+        if (_secondCounter) {
+            *_secondCounter += elapsed;
+        }
     }
 
 }  // namespace mongo
@@ -28,18 +28,20 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include "mongo/base/disallow_copying.h"
 
 namespace mongo {
 
     /**
-     * This class increments a counter by a rough estimate of the time elapsed since its
-     * construction when it goes out of scope.
+     * This class increments a counter by the CycleClock cycles elapsed since its construction when
+     * it goes out of scope, and "secondCounter" as well if there is one.
      */
     class ScopedTimer {
         MONGO_DISALLOW_COPYING(ScopedTimer);
     public:
-        ScopedTimer(long long* counter);
+        ScopedTimer(long long* counter, long long* secondCounter = NULL);
 
         ~ScopedTimer();
 
@@ -49,8 +51,9 @@ namespace mongo {
 
         // Reference to the counter that we are incrementing with the elapsed time.
         long long* _counter;
+        long long* _secondCounter;
 
-        // Time at which the timer was constructed.
+        // CycleClock reading at which the timer was constructed.
         long long _start;
     };
 
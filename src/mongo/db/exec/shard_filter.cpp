@@ -33,7 +33,6 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
-#include "mongo/s/shard_key_pattern.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -47,7 +46,11 @@ namespace mongo {
     ShardFilterStage::ShardFilterStage(const CollectionMetadataPtr& metadata,
                                        WorkingSet* ws,
                                        PlanStage* child)
-        : _ws(ws), _child(child), _commonStats(kStageType), _metadata(metadata) { }
+        : _ws(ws),
+          _child(child),
+          _commonStats(kStageType),
+          _metadata(metadata),
+          _shardKeyPattern(metadata ? new ShardKeyPattern(metadata->getKeyPattern()) : NULL) { }
 
     ShardFilterStage::~ShardFilterStage() { }
 
@@ -56,8 +59,8 @@ namespace mongo {
     PlanStage::StageState ShardFilterStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         // If we've returned as many results as we're limited to, isEOF will be true.
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -71,10 +74,9 @@ namespace mongo {
             // aborted migrations
             if (_metadata) {
 
-                ShardKeyPattern shardKeyPattern(_metadata->getKeyPattern());
                 WorkingSetMember* member = _ws->get(*out);
                 WorkingSetMatchableDocument matchable(member);
-                BSONObj shardKey = shardKeyPattern.extractShardKeyFromMatchable(matchable);
+                BSONObj shardKey = _shardKeyPattern->extractShardKeyFromMatchable(matchable);
 
                 if (shardKey.isEmpty()) {
 
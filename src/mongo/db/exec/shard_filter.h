@@ -34,6 +34,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/record_id.h"
 #include "mongo/s/d_state.h"
+#include "mongo/s/shard_key_pattern.h"
 
 namespace mongo {
 
@@ -107,6 +108,9 @@ namespace mongo {
         // Note: it is important that this is the metadata from the time this stage is constructed.
         // See class comment for details.
         const CollectionMetadataPtr _metadata;
+
+        // Parsed from the metadata's key pattern once, rather than for every document.
+        const boost::scoped_ptr<ShardKeyPattern> _shardKeyPattern;
     };
 
 }  // namespace mongo
@@ -27,6 +27,9 @@
 */
 
 #include "mongo/db/exec/skip.h"
+
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/util/mongoutils/str.h"
@@ -49,8 +52,8 @@ namespace mongo {
     PlanStage::StageState SkipStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         WorkingSetID id = WorkingSet::INVALID_ID;
         StageState status = _child->work(&id);
@@ -94,6 +97,56 @@ namespace mongo {
         return status;
     }
 
+    PlanStage::StageState SkipStage::workBatch(size_t maxWorks,
+                                               vector<WorkingSetID>* results,
+                                               WorkingSetID* out) {
+        // Adds the amount of time taken by workBatch() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
+
+        const size_t numResultsBefore = results->size();
+        const size_t childWorksBefore = _child->getCommonStats()->works;
+        StageState status = _child->workBatch(maxWorks, results, out);
+        _commonStats.works += _child->getCommonStats()->works - childWorksBefore;
+
+        // If we're still skipping results, drop as many of the new ones as we need to.
+        const size_t numReturned = results->size() - numResultsBefore;
+        const size_t numSkipped = std::min(numReturned, static_cast<size_t>(_toSkip));
+        if (numSkipped > 0) {
+            const vector<WorkingSetID>::iterator first = results->begin() + numResultsBefore;
+            for (vector<WorkingSetID>::iterator it = first; it != first + numSkipped; ++it) {
+                _ws->free(*it);
+            }
+            results->erase(first, first + numSkipped);
+            _toSkip -= numSkipped;
+            _commonStats.needTime += numSkipped;
+        }
+        _commonStats.advanced += numReturned - numSkipped;
+
+        if (PlanStage::ADVANCED == status && numReturned == numSkipped) {
+            // Everything the child returned was dropped.
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::FAILURE == status) {
+            // If a stage fails, it may create a status WSM to indicate why it
+            // failed, in which case 'id' is valid.  If ID is invalid, we
+            // create our own error message.
+            if (WorkingSet::INVALID_ID == *out) {
+                mongoutils::str::stream ss;
+                ss << "skip stage failed to read in results from child";
+                Status status(ErrorCodes::InternalError, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+            }
+        }
+        else if (PlanStage::NEED_TIME == status) {
+            ++_commonStats.needTime;
+        }
+        else if (PlanStage::NEED_YIELD == status) {
+            ++_commonStats.needYield;
+        }
+
+        return status;
+    }
+
     void SkipStage::saveState() {
         ++_commonStats.yields;
         _child->saveState();
@@ -41,6 +41,8 @@
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage_options.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -52,6 +54,60 @@ namespace mongo {
     // static
     const char* SortStage::kStageType = "SORT";
 
+namespace {
+
+    // Fields of the values given to the external sorter.
+    const char kObjField[] = "o";
+    const char kLocField[] = "l";
+    const char kTextScoreField[] = "s";
+
+    /**
+     * KeyStrings only record the direction of the first 32 fields of an ordering.
+     */
+    bool canUseKeyString(const BSONObj& pattern) {
+        return internalQueryExecSortUseKeyStrings && pattern.nFields() <= 32;
+    }
+
+    /**
+     * Orders the external sorter's data the same way WorkingSetComparator orders buffered data.
+     * When the buffered data is ordered by KeyString, the sorter's keys hold the KeyString as
+     * their only field, as BinData.
+     */
+    class ExternalSortComparator {
+    public:
+        ExternalSortComparator(const BSONObj& pattern, bool useKeyString)
+            : _pattern(pattern), _useKeyString(useKeyString) { }
+
+        int operator()(const std::pair<BSONObj, BSONObj>& lhs,
+                       const std::pair<BSONObj, BSONObj>& rhs) const {
+            int result;
+            if (_useKeyString) {
+                int lhsSize;
+                int rhsSize;
+                const char* lhsData = lhs.first.firstElement().binData(lhsSize);
+                const char* rhsData = rhs.first.firstElement().binData(rhsSize);
+                result = KeyString::compare(lhsData, lhsSize, rhsData, rhsSize);
+            }
+            else {
+                // False means ignore field names.
+                result = lhs.first.woCompare(rhs.first, _pattern, false);
+            }
+            if (0 != result) {
+                return result;
+            }
+
+            const long long lhsLoc = lhs.second[kLocField].numberLong();
+            const long long rhsLoc = rhs.second[kLocField].numberLong();
+            return lhsLoc < rhsLoc ? -1 : (lhsLoc > rhsLoc ? 1 : 0);
+        }
+
+    private:
+        BSONObj _pattern;
+        bool _useKeyString;
+    };
+
+}  // namespace
+
     SortStageKeyGenerator::SortStageKeyGenerator(const Collection* collection,
                                                  const BSONObj& sortSpec,
                                                  const BSONObj& queryObj) {
@@ -273,11 +329,21 @@ namespace mongo {
         }
     }
 
-    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) { }
+    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p)
+        : pattern(p),
+          useKeyString(canUseKeyString(p)),
+          ordering(Ordering::make(useKeyString ? p : BSONObj())) { }
 
     bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const {
-        // False means ignore field names.
-        int result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
+        int result;
+        if (useKeyString) {
+            result = KeyString::compare(lhs.sortKeyString.data(), lhs.sortKeyString.size(),
+                                        rhs.sortKeyString.data(), rhs.sortKeyString.size());
+        }
+        else {
+            // False means ignore field names.
+            result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
+        }
         if (0 != result) {
             return result < 0;
         }
@@ -294,10 +360,13 @@ namespace mongo {
           _pattern(params.pattern),
           _query(params.query),
           _limit(params.limit),
+          _allowDiskUse(params.allowDiskUse),
           _sorted(false),
           _resultIterator(_data.end()),
           _commonStats(kStageType),
-          _memUsage(0) {
+          _memUsage(0),
+          _memoryCharge(MemoryTracker::kSort) {
+        _memoryCharge.setOperationContext(params.opCtx);
     }
 
     SortStage::~SortStage() { }
@@ -305,14 +374,20 @@ namespace mongo {
     bool SortStage::isEOF() {
         // We're done when our child has no more results, we've sorted the child's results, and
         // we've returned all sorted results.
-        return _child->isEOF() && _sorted && (_data.end() == _resultIterator);
+        if (!_child->isEOF() || !_sorted) {
+            return false;
+        }
+        if (_sorterIterator) {
+            return !_sorterIterator->more();
+        }
+        return _data.end() == _resultIterator;
     }
 
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (NULL == _sortKeyGen) {
             // This is heavy and should be done as part of work().
@@ -329,12 +404,33 @@ namespace mongo {
 
         const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
         if (_memUsage > maxBytes) {
-            mongoutils::str::stream ss;
-            ss << "sort stage buffered data usage of " << _memUsage
-               << " bytes exceeds internal limit of " << maxBytes << " bytes";
-            Status status(ErrorCodes::Overflow, ss);
-            *out = WorkingSetCommon::allocateStatusMember( _ws, status);
-            return PlanStage::FAILURE;
+            if (!_allowDiskUse) {
+                mongoutils::str::stream ss;
+                ss << "sort stage buffered data usage of " << _memUsage
+                   << " bytes exceeds internal limit of " << maxBytes << " bytes. Use"
+                   << " allowDiskUse to allow sorting to use temporary files.";
+                Status status(ErrorCodes::Overflow, ss);
+                *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+                return PlanStage::FAILURE;
+            }
+
+            spillToSorter();
+        }
+        else {
+            Status chargeStatus = _memoryCharge.set(_memUsage);
+            if (!chargeStatus.isOK()) {
+                if (!_allowDiskUse) {
+                    mongoutils::str::stream ss;
+                    ss << "sort stage buffered data usage of " << _memUsage
+                       << " bytes exceeds memory budget: " << chargeStatus.reason() << ". Use"
+                       << " allowDiskUse to allow sorting to use temporary files.";
+                    Status status(ErrorCodes::ExceededMemoryLimit, ss);
+                    *out = WorkingSetCommon::allocateStatusMember( _ws, status);
+                    return PlanStage::FAILURE;
+                }
+
+                spillToSorter();
+            }
         }
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -361,10 +457,16 @@ namespace mongo {
                 // The data remains in the WorkingSet and we wrap the WSID with the sort key.
                 SortableDataItem item;
                 Status sortKeyStatus = _sortKeyGen->getSortKey(*member, &item.sortKey);
-                if (!_sortKeyGen->getSortKey(*member, &item.sortKey).isOK()) {
+                if (!sortKeyStatus.isOK()) {
                     *out = WorkingSetCommon::allocateStatusMember(_ws, sortKeyStatus);
                     return PlanStage::FAILURE;
                 }
+                if (_sortKeyComparator->useKeyString) {
+                    // Encoded once here, so that every comparison is a byte comparison.
+                    const KeyString keyString(item.sortKey, _sortKeyComparator->ordering);
+                    item.sortKeyString.assign(keyString.getBuffer(), keyString.getSize());
+                    item.sortKey = BSONObj();
+                }
                 item.wsid = id;
                 if (member->hasLoc()) {
                     // The RecordId breaks ties when sorting two WSMs with the same sort key.
@@ -379,8 +481,14 @@ namespace mongo {
             else if (PlanStage::IS_EOF == code) {
                 // TODO: We don't need the lock for this.  We could ask for a yield and do this work
                 // unlocked.  Also, this is performing a lot of work for one call to work(...)
-                sortBuffer();
-                _resultIterator = _data.begin();
+                if (_sorter) {
+                    _sorterIterator.reset(_sorter->done());
+                    _sorter.reset();
+                }
+                else {
+                    sortBuffer();
+                    _resultIterator = _data.begin();
+                }
                 _sorted = true;
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -410,8 +518,14 @@ namespace mongo {
         }
 
         // Returning results.
-        verify(_resultIterator != _data.end());
         verify(_sorted);
+        if (_sorterIterator) {
+            *out = nextFromSorter();
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
+        verify(_resultIterator != _data.end());
         *out = _resultIterator->wsid;
         _resultIterator++;
 
@@ -428,11 +542,13 @@ namespace mongo {
 
     void SortStage::saveState() {
         ++_commonStats.yields;
+        _memoryCharge.setOperationContext(NULL);
         _child->saveState();
     }
 
     void SortStage::restoreState(OperationContext* opCtx) {
         ++_commonStats.unyields;
+        _memoryCharge.setOperationContext(opCtx);
         _child->restoreState(opCtx);
     }
 
@@ -512,6 +628,11 @@ namespace mongo {
      *     sortBuffer() - Copies items from set to vectors.
      */
     void SortStage::addToBuffer(const SortableDataItem& item) {
+        if (_sorter) {
+            addToSorter(item);
+            return;
+        }
+
         // Holds ID of working set member to be freed at end of this function.
         WorkingSetID wsidToFree = WorkingSet::INVALID_ID;
 
@@ -593,4 +714,86 @@ namespace mongo {
         }
     }
 
+    void SortStage::spillToSorter() {
+        invariant(!_sorter);
+
+        SortOptions opts;
+        opts.limit = _limit;
+        opts.maxMemoryUsageBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes);
+        opts.extSortAllowed = true;
+        opts.tempDir = storageGlobalParams.dbpath + "/_tmp";
+
+        LOG(1) << "sort stage buffered " << _memUsage << " bytes, sorting externally in "
+               << opts.tempDir;
+
+        _sorter.reset(ExternalSorter::make(opts,
+                                           ExternalSortComparator(
+                                               _sortKeyGen->getSortComparator(),
+                                               _sortKeyComparator->useKeyString)));
+
+        for (vector<SortableDataItem>::const_iterator it = _data.begin(); it != _data.end();
+             ++it) {
+            addToSorter(*it);
+        }
+        vector<SortableDataItem>().swap(_data);
+
+        if (_dataSet) {
+            for (SortableDataItemSet::const_iterator it = _dataSet->begin();
+                 it != _dataSet->end(); ++it) {
+                addToSorter(*it);
+            }
+            _dataSet.reset();
+        }
+
+        _memUsage = 0;
+        _memoryCharge.set(0);
+        _specificStats.usedDisk = true;
+    }
+
+    void SortStage::addToSorter(const SortableDataItem& item) {
+        WorkingSetMember* member = _ws->get(item.wsid);
+
+        BSONObjBuilder valueBob;
+        valueBob.append(kObjField, member->obj.value());
+        valueBob.append(kLocField, static_cast<long long>(item.loc.repr()));
+        if (member->hasComputed(WSM_COMPUTED_TEXT_SCORE)) {
+            const TextScoreComputedData* scoreData = static_cast<const TextScoreComputedData*>(
+                    member->getComputed(WSM_COMPUTED_TEXT_SCORE));
+            valueBob.append(kTextScoreField, scoreData->getScore());
+        }
+        if (_sortKeyComparator->useKeyString) {
+            BSONObjBuilder keyBob;
+            keyBob.appendBinData("", item.sortKeyString.size(), BinDataGeneral,
+                                 item.sortKeyString.data());
+            _sorter->add(keyBob.obj(), valueBob.obj());
+        }
+        else {
+            _sorter->add(item.sortKey, valueBob.obj());
+        }
+
+        // The sorter holds a copy of the document, so it no longer depends on the RecordId.
+        if (member->hasLoc()) {
+            _wsidByDiskLoc.erase(member->loc);
+        }
+        _ws->free(item.wsid);
+    }
+
+    WorkingSetID SortStage::nextFromSorter() {
+        const ExternalSorter::Data data = _sorterIterator->next();
+
+        WorkingSetID id = _ws->allocate();
+        WorkingSetMember* member = _ws->get(id);
+        member->obj = Snapshotted<BSONObj>(SnapshotId(), data.second[kObjField].Obj().getOwned());
+        member->state = WorkingSetMember::OWNED_OBJ;
+
+        BSONElement scoreElt = data.second[kTextScoreField];
+        if (!scoreElt.eoo()) {
+            member->addComputed(new TextScoreComputedData(scoreElt.numberDouble()));
+        }
+        return id;
+    }
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -29,14 +29,18 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <string>
 #include <vector>
 #include <set>
 
+#include "mongo/bson/ordering.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/memory_tracker.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 
@@ -47,7 +51,7 @@ namespace mongo {
     // Parameters that must be provided to a SortStage
     class SortStageParams {
     public:
-        SortStageParams() : collection(NULL), limit(0) { }
+        SortStageParams() : collection(NULL), limit(0), allowDiskUse(false), opCtx(NULL) { }
 
         // Used for resolving RecordIds to BSON
         const Collection* collection;
@@ -60,6 +64,13 @@ namespace mongo {
 
         // Equal to 0 for no limit.
         size_t limit;
+
+        // If true, buffered data that exceeds the memory limit is sorted externally in files
+        // under the dbpath, rather than failing the sort.
+        bool allowDiskUse;
+
+        // The operation the buffered data is charged to, if any.
+        OperationContext* opCtx;
     };
 
     /**
@@ -139,6 +150,11 @@ namespace mongo {
      *
      * Preconditions: For each field in 'pattern', all inputs in the child must handle a
      * getFieldDotted for that field.
+     *
+     * If allowed to use disk, the stage moves everything it has buffered into an external Sorter
+     * once it exceeds internalQueryExecMaxBlockingSortBytes, and sends every later result there
+     * too. Results that went through the Sorter are returned as owned objects without a RecordId,
+     * just like buffered results whose RecordId was invalidated.
      */
     class SortStage : public PlanStage {
     public:
@@ -191,6 +207,8 @@ namespace mongo {
         // Equal to 0 for no limit.
         size_t _limit;
 
+        bool _allowDiskUse;
+
         //
         // Sort key generation
         //
@@ -208,6 +226,9 @@ namespace mongo {
         struct SortableDataItem {
             WorkingSetID wsid;
             BSONObj sortKey;
+            // When the comparator uses KeyStrings, the sort key encoded as one, and 'sortKey' is
+            // left empty.
+            std::string sortKeyString;
             // Since we must replicate the behavior of a covered sort as much as possible we use the
             // RecordId to break sortKey ties.
             // See sorta.js.
@@ -217,13 +238,17 @@ namespace mongo {
         // Comparison object for data buffers (vector and set).
         // Items are compared on (sortKey, loc). This is also how the items are
         // ordered in the indices.
-        // Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker.
+        // Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker, or, if
+        // 'useKeyString' is set, by comparing the bytes of their KeyStrings, which orders them
+        // the same way.
         struct WorkingSetComparator {
             explicit WorkingSetComparator(BSONObj p);
 
             bool operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const;
 
             BSONObj pattern;
+            bool useKeyString;
+            Ordering ordering;
         };
 
         /**
@@ -240,6 +265,23 @@ namespace mongo {
          */
         void sortBuffer();
 
+        /**
+         * Moves all buffered data into a newly created external sorter. Later results are added
+         * to the sorter rather than buffered.
+         */
+        void spillToSorter();
+
+        /**
+         * Adds 'item' to the external sorter and frees its working set member.
+         */
+        void addToSorter(const SortableDataItem& item);
+
+        /**
+         * Takes the next result from the external sorter and returns it in a new working set
+         * member.
+         */
+        WorkingSetID nextFromSorter();
+
         // Comparator for data buffer
         // Initialization follows sort key generator
         boost::scoped_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -258,6 +300,16 @@ namespace mongo {
         // Iterates through _data post-sort returning it.
         std::vector<SortableDataItem>::iterator _resultIterator;
 
+        // Once the buffered data has exceeded the memory limit, the sort key of each result maps
+        // to an object holding the document, its RecordId and its text score, if any. Any data
+        // still in _data or _dataSet at that point is moved into the sorter, so that only one of
+        // them holds data.
+        typedef Sorter<BSONObj, BSONObj> ExternalSorter;
+        boost::scoped_ptr<ExternalSorter> _sorter;
+
+        // Iterates through the output of _sorter post-sort returning it.
+        boost::scoped_ptr<ExternalSorter::Iterator> _sorterIterator;
+
         // We buffer a lot of data and we want to look it up by RecordId quickly upon invalidation.
         typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
         DataMap _wsidByDiskLoc;
@@ -271,6 +323,10 @@ namespace mongo {
 
         // The usage in bytes of all buffered data that we're sorting.
         size_t _memUsage;
+
+        // Charges _memUsage to the sort subsystem and to the operation, which may have budgets of
+        // their own.  Exceeding either is handled like exceeding the blocking sort limit.
+        MemoryCharge _memoryCharge;
     };
 
 }  // namespace mongo
@@ -34,6 +34,7 @@
 
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -238,4 +239,32 @@ namespace {
                  "{output: [{a: 3}]}");
     }
 
+    //
+    // Sort keys compared as KeyStrings
+    // The results must be the same as when the BSON sort keys are compared.
+    //
+
+    void testWorkBothComparisons(const char* patternStr, int limit, const char* inputStr,
+                                 const char* expectedStr) {
+        const bool oldUseKeyStrings = internalQueryExecSortUseKeyStrings;
+        internalQueryExecSortUseKeyStrings = true;
+        testWork(patternStr, "{}", limit, inputStr, expectedStr);
+        internalQueryExecSortUseKeyStrings = false;
+        testWork(patternStr, "{}", limit, inputStr, expectedStr);
+        internalQueryExecSortUseKeyStrings = oldUseKeyStrings;
+    }
+
+    TEST(SortStageTest, SortMixedTypesCompound) {
+        const char* input = "{input: [{a: 'x', b: 1}, {a: 2.5, b: 2}, {a: null, b: 3},"
+                            " {a: 2, b: 1}, {a: {c: 1}, b: 1}, {a: 2, b: -1},"
+                            " {b: 0}, {a: NumberLong(3), b: 9}, {a: 'w', b: 1}]}";
+        testWorkBothComparisons("{a: 1, b: -1}", 0, input,
+                                "{output: [{a: null, b: 3}, {b: 0}, {a: 2, b: 1},"
+                                " {a: 2, b: -1}, {a: 2.5, b: 2}, {a: NumberLong(3), b: 9},"
+                                " {a: 'w', b: 1}, {a: 'x', b: 1}, {a: {c: 1}, b: 1}]}");
+        testWorkBothComparisons("{a: -1, b: 1}", 3, input,
+                                "{output: [{a: {c: 1}, b: 1}, {a: 'x', b: 1},"
+                                " {a: 'w', b: 1}]}");
+    }
+
 }  // namespace
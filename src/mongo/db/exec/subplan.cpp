@@ -52,6 +52,9 @@ namespace mongo {
     // static
     const char* SubplanStage::kStageType = "SUBPLAN";
 
+    // static
+    const size_t SubplanStage::kNoSuchBranch = static_cast<size_t>(-1);
+
     SubplanStage::SubplanStage(OperationContext* txn,
                                Collection* collection,
                                WorkingSet* ws,
@@ -108,9 +111,9 @@ namespace mongo {
     }
 
     Status SubplanStage::planSubqueries() {
-        // Adds the amount of time taken by planSubqueries() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by planSubqueries() to executionTimeCycles. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         MatchExpression* orExpr = _query->root();
 
@@ -122,6 +125,10 @@ namespace mongo {
 
         const WhereCallbackReal whereCallback(_txn, _collection->ns().db());
 
+        // The first branch of each shape which has to be planned.
+        PlanCache* planCache = _collection->infoCache()->getPlanCache();
+        std::map<PlanCacheKey, size_t> plannedShapes;
+
         for (size_t i = 0; i < orExpr->numChildren(); ++i) {
             // We need a place to shove the results from planning this branch.
             _branchResults.push_back(new BranchPlanningResult());
@@ -150,39 +157,51 @@ namespace mongo {
             // cache. If there's no cached plan, then we generate and rank plans using the MPS.
             CachedSolution* rawCS;
             if (PlanCache::shouldCacheQuery(*branchResult->canonicalQuery.get()) &&
-                _collection->infoCache()->getPlanCache()->get(*branchResult->canonicalQuery.get(),
-                                                              &rawCS).isOK()) {
+                planCache->get(*branchResult->canonicalQuery.get(), &rawCS).isOK()) {
                 // We have a CachedSolution. Store it for later.
                 LOG(5) << "Subplanner: cached plan found for child " << i << " of "
                        << orExpr->numChildren();
 
                 branchResult->cachedSolution.reset(rawCS);
+                continue;
             }
-            else {
-                // No CachedSolution found. We'll have to plan from scratch.
-                LOG(5) << "Subplanner: planning child " << i << " of " << orExpr->numChildren();
 
-                // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
-                // considering any plan that's a collscan.
-                Status status = QueryPlanner::plan(*branchResult->canonicalQuery.get(),
-                                                   _plannerParams,
-                                                   &branchResult->solutions.mutableVector());
+            // If an earlier branch of the same shape is being planned, this branch will use its
+            // plan. Ranking both would pick the same plan, only taking twice as long.
+            const PlanCacheKey shape = planCache->computeKey(*branchResult->canonicalQuery.get());
+            std::map<PlanCacheKey, size_t>::const_iterator planned = plannedShapes.find(shape);
+            if (plannedShapes.end() != planned) {
+                LOG(5) << "Subplanner: child " << i << " of " << orExpr->numChildren()
+                       << " has the same shape as child " << planned->second;
 
-                if (!status.isOK()) {
-                    mongoutils::str::stream ss;
-                    ss << "Can't plan for subchild "
-                       << branchResult->canonicalQuery->toString()
-                       << " " << status.reason();
-                    return Status(ErrorCodes::BadValue, ss);
-                }
-                LOG(5) << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+                branchResult->sameShapeAs = planned->second;
+                continue;
+            }
+            plannedShapes[shape] = i;
 
-                if (0 == branchResult->solutions.size()) {
-                    // If one child doesn't have an indexed solution, bail out.
-                    mongoutils::str::stream ss;
-                    ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
-                    return Status(ErrorCodes::BadValue, ss);
-                }
+            // No CachedSolution found. We'll have to plan from scratch.
+            LOG(5) << "Subplanner: planning child " << i << " of " << orExpr->numChildren();
+
+            // We don't set NO_TABLE_SCAN because peeking at the cache data will keep us from
+            // considering any plan that's a collscan.
+            Status status = QueryPlanner::plan(*branchResult->canonicalQuery.get(),
+                                               _plannerParams,
+                                               &branchResult->solutions.mutableVector());
+
+            if (!status.isOK()) {
+                mongoutils::str::stream ss;
+                ss << "Can't plan for subchild "
+                   << branchResult->canonicalQuery->toString()
+                   << " " << status.reason();
+                return Status(ErrorCodes::BadValue, ss);
+            }
+            LOG(5) << "Subplanner: got " << branchResult->solutions.size() << " solutions";
+
+            if (0 == branchResult->solutions.size()) {
+                // If one child doesn't have an indexed solution, bail out.
+                mongoutils::str::stream ss;
+                ss << "No solutions for subchild " << branchResult->canonicalQuery->toString();
+                return Status(ErrorCodes::BadValue, ss);
             }
         }
 
@@ -191,6 +210,30 @@ namespace mongo {
 
     namespace {
 
+        /**
+         * On success, applies the index tags from 'branchTree' (which represent the winning plan
+         * for 'orChild') to 'orChild', and adds them to 'compositeCacheData'.
+         */
+        Status tagOrChildAccordingToTree(PlanCacheIndexTree* compositeCacheData,
+                                         const PlanCacheIndexTree* branchTree,
+                                         MatchExpression* orChild,
+                                         const std::map<BSONObj, size_t>& indexMap) {
+            // Add the index assignments to our original query.
+            Status tagStatus = QueryPlanner::tagAccordingToCache(orChild, branchTree, indexMap);
+
+            if (!tagStatus.isOK()) {
+                mongoutils::str::stream ss;
+                ss << "Failed to extract indices from subchild "
+                   << orChild->toString();
+                return Status(ErrorCodes::BadValue, ss);
+            }
+
+            // Add the child's cache data to the cache data we're creating for the main query.
+            compositeCacheData->children.push_back(branchTree->clone());
+
+            return Status::OK();
+        }
+
         /**
          * On success, applies the index tags from 'branchCacheData' (which represent the winning
          * plan for 'orChild') to 'compositeCacheData'.
@@ -216,22 +259,10 @@ namespace mongo {
                 return Status(ErrorCodes::BadValue, ss);
             }
 
-            // Add the index assignments to our original query.
-            Status tagStatus = QueryPlanner::tagAccordingToCache(orChild,
-                                                                 branchCacheData->tree.get(),
-                                                                 indexMap);
-
-            if (!tagStatus.isOK()) {
-                mongoutils::str::stream ss;
-                ss << "Failed to extract indices from subchild "
-                   << orChild->toString();
-                return Status(ErrorCodes::BadValue, ss);
-            }
-
-            // Add the child's cache data to the cache data we're creating for the main query.
-            compositeCacheData->children.push_back(branchCacheData->tree->clone());
-
-            return Status::OK();
+            return tagOrChildAccordingToTree(compositeCacheData,
+                                             branchCacheData->tree.get(),
+                                             orChild,
+                                             indexMap);
         }
 
     } // namespace
@@ -248,7 +279,20 @@ namespace mongo {
             MatchExpression* orChild = orExpr->getChild(i);
             BranchPlanningResult* branchResult = _branchResults[i];
 
-            if (branchResult->cachedSolution.get()) {
+            if (kNoSuchBranch != branchResult->sameShapeAs) {
+                // Use the index tags of the earlier branch's winning plan, which were the first
+                // to be added to the cache data of all branches.
+                invariant(branchResult->sameShapeAs < i);
+                Status tagStatus = tagOrChildAccordingToTree(
+                    cacheData.get(),
+                    cacheData->children[branchResult->sameShapeAs],
+                    orChild,
+                    _indexMap);
+                if (!tagStatus.isOK()) {
+                    return tagStatus;
+                }
+            }
+            else if (branchResult->cachedSolution.get()) {
                 // We can get the index tags we need out of the cache.
                 Status tagStatus = tagOrChildAccordingToCache(
                     cacheData.get(),
@@ -325,18 +369,13 @@ namespace mongo {
                     return Status(ErrorCodes::BadValue, ss);
                 }
 
-                // Add the index assignments to our original query.
-                Status tagStatus = QueryPlanner::tagAccordingToCache(
-                    orChild, bestSoln->cacheData->tree.get(), _indexMap);
-
+                Status tagStatus = tagOrChildAccordingToTree(cacheData.get(),
+                                                             bestSoln->cacheData->tree.get(),
+                                                             orChild,
+                                                             _indexMap);
                 if (!tagStatus.isOK()) {
-                    mongoutils::str::stream ss;
-                    ss << "Failed to extract indices from subchild "
-                       << orChild->toString();
-                    return Status(ErrorCodes::BadValue, ss);
+                    return tagStatus;
                 }
-
-                cacheData->children.push_back(bestSoln->cacheData->tree->clone());
             }
         }
 
@@ -446,9 +485,9 @@ namespace mongo {
     }
 
     Status SubplanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
-        // Adds the amount of time taken by pickBestPlan() to executionTimeMillis. There's lots of
+        // Adds the amount of time taken by pickBestPlan() to executionTimeCycles. There's lots of
         // work that happens here, so this is needed for the time accounting to make sense.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         // Plan each branch of the $or.
         Status subplanningStatus = planSubqueries();
@@ -475,8 +514,8 @@ namespace mongo {
     PlanStage::StageState SubplanStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -546,6 +585,10 @@ namespace mongo {
         return NULL != _branchResults[i]->cachedSolution.get();
     }
 
+    bool SubplanStage::branchPlannedLikeEarlierBranch(size_t i) const {
+        return kNoSuchBranch != _branchResults[i]->sameShapeAs;
+    }
+
     const CommonStats* SubplanStage::getCommonStats() const {
         return &_commonStats;
     }
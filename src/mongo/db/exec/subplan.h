@@ -62,6 +62,10 @@ namespace mongo {
      *   executions of C. These subsequent executions of shape C could be either as a clause in
      *   another rooted $or query, or shape C as its own query.
      *
+     *   --Clauses of the same shape as an earlier clause of the same query, such as the clauses of
+     *   {$or: [{a: 1, b: 2}, {a: 3, b: 4}]}, are neither planned nor ranked but use the winning
+     *   plan of the earlier clause, just as they would if it had been read from the plan cache.
+     *
      *   --Plans for entire rooted $or queries are neither written to nor read from the plan cache.
      */
     class SubplanStage : public PlanStage {
@@ -118,6 +122,12 @@ namespace mongo {
          */
         bool branchPlannedFromCache(size_t i) const;
 
+        /**
+         * Returns true if the i-th branch used the plan of an earlier branch of the same shape,
+         * otherwise returns false.
+         */
+        bool branchPlannedLikeEarlierBranch(size_t i) const;
+
     private:
         /**
          * A class used internally in order to keep track of the results of planning
@@ -126,7 +136,7 @@ namespace mongo {
         struct BranchPlanningResult {
             MONGO_DISALLOW_COPYING(BranchPlanningResult);
         public:
-            BranchPlanningResult() { }
+            BranchPlanningResult() : sameShapeAs(kNoSuchBranch) { }
 
             // A parsed version of one branch of the $or.
             boost::scoped_ptr<CanonicalQuery> canonicalQuery;
@@ -139,8 +149,14 @@ namespace mongo {
 
             // Query solutions resulting from planning the $or branch.
             OwnedPointerVector<QuerySolution> solutions;
+
+            // The index of an earlier branch with the same shape, whose winning plan this branch
+            // uses instead of being planned, or kNoSuchBranch.
+            size_t sameShapeAs;
         };
 
+        static const size_t kNoSuchBranch;
+
         /**
          * Plan each branch of the $or independently, and store the resulting
          * lists of query solutions in '_solutions'.
@@ -28,6 +28,9 @@
 
 #include "mongo/db/exec/text.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
@@ -48,6 +51,18 @@ namespace mongo {
     // static
     const char* TextStage::kStageType = "TEXT";
 
+    namespace {
+
+        // In top-k mode, the documents buffered so far are checked for whether they settle the
+        // top k at most once every this many keys, or every eighth of the number of buffered
+        // documents if that is larger, so that checking stays linear in the keys read.
+        const size_t kMinKeysBetweenTopKChecks = 128;
+
+        // The terms which found a document are recorded in a bit mask.
+        const size_t kMaxTopKTerms = 64;
+
+    }  // namespace
+
     TextStage::TextStage(OperationContext* txn,
                          const TextStageParams& params,
                          WorkingSet* ws,
@@ -60,10 +75,49 @@ namespace mongo {
           _commonStats(kStageType),
           _internalState(INIT_SCANS),
           _currentIndexScanner(0),
+          _numCandidateScanners(0),
+          _negatedTermsFromIndex(false),
+          _phrasesFromIndex(false),
+          _indexDecidesMatch(false),
+          _topK(false),
+          _keysSinceTopKCheck(0),
           _idRetrying(WorkingSet::INVALID_ID) {
         _scoreIterator = _scores.end();
         _specificStats.indexPrefix = _params.indexPrefix;
         _specificStats.indexName = _params.index->indexName();
+
+        // The terms in index keys are lower cased, so the index can only settle case-insensitive
+        // queries.  Version 1 indexes tokenize documents differently from the matcher.
+        const FTSQuery& query = _params.query;
+        const fts::TextIndexVersion version = _params.spec.getTextIndexVersion();
+        if (query.getCaseSensitive() || version == fts::TEXT_INDEX_VERSION_1) {
+            return;
+        }
+
+        _negatedTermsFromIndex = true;
+
+        // Only version 3 indexes store term positions, and only positional phrases can be
+        // matched with them.
+        bool allPhrasesFromIndex = true;
+        const std::vector<fts::PhraseTerms>* phrases[] = {
+            &query.getPositivePhrTerms(), &query.getNegatedPhrTerms()
+        };
+        for (size_t i = 0; i < 2; i++) {
+            for (size_t j = 0; j < phrases[i]->size(); j++) {
+                const fts::PhraseTerms& phraseTerms = (*phrases[i])[j];
+                if (version != fts::TEXT_INDEX_VERSION_3 ||
+                    !fts::FTSPositions::isPositional(phraseTerms)) {
+                    allPhrasesFromIndex = false;
+                    continue;
+                }
+                for (size_t k = 0; k < phraseTerms.size(); k++) {
+                    _phraseTerms.insert(phraseTerms[k].term);
+                }
+            }
+        }
+
+        _phrasesFromIndex = !_phraseTerms.empty();
+        _indexDecidesMatch = allPhrasesFromIndex;
     }
 
     TextStage::~TextStage() { }
@@ -75,8 +129,8 @@ namespace mongo {
     PlanStage::StageState TextStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
         invariant(_internalState != DONE);
@@ -163,6 +217,7 @@ namespace mongo {
             }
             _scores.erase(scoreIt);
         }
+        _positions.erase(dl);
     }
 
     vector<PlanStage*> TextStage::getChildren() const {
@@ -198,13 +253,30 @@ namespace mongo {
 
         _specificStats.parsedTextQuery = _params.query.toBSON();
 
+        // The terms whose keys find the documents to return come first, followed by the terms
+        // whose keys are only needed to filter those documents.
+        const std::set<std::string>& termsForBounds = _params.query.getTermsForBounds();
+        _scannerTerms.assign(termsForBounds.begin(), termsForBounds.end());
+        _numCandidateScanners = _scannerTerms.size();
+
+        std::set<std::string> filterTerms(_phraseTerms);
+        if (_negatedTermsFromIndex) {
+            const std::set<std::string>& negatedTerms = _params.query.getNegatedTerms();
+            filterTerms.insert(negatedTerms.begin(), negatedTerms.end());
+        }
+        for (std::set<std::string>::const_iterator it = filterTerms.begin();
+             it != filterTerms.end();
+             ++it) {
+            if (!termsForBounds.count(*it)) {
+                _scannerTerms.push_back(*it);
+            }
+        }
+
         // Get all the index scans for each term in our query.
         // TODO it would be more efficient to only have one active scan at a time and create the
         // next when each finishes.
-        for (std::set<std::string>::const_iterator it = _params.query.getTermsForBounds().begin();
-             it != _params.query.getTermsForBounds().end();
-             ++it) {
-            const string& term = *it;
+        for (size_t i = 0; i < _scannerTerms.size(); ++i) {
+            const string& term = _scannerTerms[i];
             IndexScanParams params;
             params.bounds.startKey = FTSIndexFormat::getIndexKey(MAX_WEIGHT,
                                                                  term,
@@ -222,11 +294,27 @@ namespace mongo {
         }
 
         // If we have no terms we go right to EOF.
-        if (0 == _scanners.size()) {
+        if (0 == _numCandidateScanners) {
+            _scanners.clear();
             _internalState = DONE;
             return PlanStage::IS_EOF;
         }
 
+        // Reading stops early only if no document is rejected after its score is known, which
+        // rules out negations, phrases, and case-sensitive matching of the fetched documents.
+        const FTSQuery& query = _params.query;
+        _topK = _params.limit > 0
+                && !query.getCaseSensitive()
+                && query.getNegatedTerms().empty()
+                && query.getPositivePhr().empty()
+                && query.getNegatedPhr().empty()
+                && _scanners.size() == _numCandidateScanners
+                && _numCandidateScanners <= kMaxTopKTerms;
+        if (_topK) {
+            _scanFrontiers.assign(_numCandidateScanners, MAX_WEIGHT);
+            _scansDone.assign(_numCandidateScanners, false);
+        }
+
         // Transition to the next state.
         _internalState = READING_TERMS;
         return PlanStage::NEED_TIME;
@@ -249,10 +337,24 @@ namespace mongo {
         }
 
         if (PlanStage::ADVANCED == childState) {
-            return addTerm(id, out);
+            if (_currentIndexScanner >= _numCandidateScanners) {
+                return addFilterTerm(id);
+            }
+            const StageState addState = addTerm(id, out);
+            if (_topK && PlanStage::NEED_TIME == addState) {
+                ++_keysSinceTopKCheck;
+                return nextTopKScan();
+            }
+            return addState;
         }
         else if (PlanStage::IS_EOF == childState) {
             // Done with this scan.
+            if (_topK) {
+                _scanFrontiers[_currentIndexScanner] = 0;
+                _scansDone[_currentIndexScanner] = true;
+                return nextTopKScan();
+            }
+
             ++_currentIndexScanner;
 
             if (_currentIndexScanner < _scanners.size()) {
@@ -261,11 +363,7 @@ namespace mongo {
             }
 
             // If we're here we are done reading results.  Move to the next state.
-            _scoreIterator = _scores.begin();
-            _internalState = RETURNING_RESULTS;
-
-            // Don't need to keep these around.
-            _scanners.clear();
+            finishReadingTerms();
             return PlanStage::NEED_TIME;
         }
         else {
@@ -286,6 +384,141 @@ namespace mongo {
         }
     }
 
+    PlanStage::StageState TextStage::nextTopKScan() {
+        if (_keysSinceTopKCheck >= std::max(kMinKeysBetweenTopKChecks, _scores.size() / 8)) {
+            _keysSinceTopKCheck = 0;
+            if (topKDecided()) {
+                finishReadingTerms();
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        // Move on to the next scan which isn't done yet.
+        for (size_t i = 1; i <= _numCandidateScanners; ++i) {
+            const size_t next = (_currentIndexScanner + i) % _numCandidateScanners;
+            if (!_scansDone[next]) {
+                _currentIndexScanner = next;
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        // All the keys have been read, so every buffered score is complete.
+        finishReadingTerms();
+        return PlanStage::NEED_TIME;
+    }
+
+    bool TextStage::topKDecided() {
+        const size_t k = _params.limit;
+
+        // The most a document can still gain from the keys which haven't been read yet, and what
+        // a document which hasn't been found at all can still score.
+        double unreadBound = 0;
+        for (size_t i = 0; i < _numCandidateScanners; ++i) {
+            unreadBound += _scanFrontiers[i];
+        }
+
+        vector<double> lowerBounds;
+        lowerBounds.reserve(_scores.size());
+        for (ScoreMap::const_iterator it = _scores.begin(); it != _scores.end(); ++it) {
+            if (it->second.score >= 0) {
+                lowerBounds.push_back(it->second.score);
+            }
+        }
+        if (lowerBounds.size() < k) {
+            return false;
+        }
+
+        std::nth_element(lowerBounds.begin(),
+                         lowerBounds.begin() + (k - 1),
+                         lowerBounds.end(),
+                         std::greater<double>());
+        const double kthScore = lowerBounds[k - 1];
+        if (unreadBound > kthScore) {
+            return false;
+        }
+
+        // Documents scoring below the k-th best so far must not be able to overtake it.
+        // Documents which tie with it are kept if they can still gain, or if they are needed to
+        // make up k documents.
+        size_t numAbove = 0;
+        for (size_t i = 0; i < lowerBounds.size(); ++i) {
+            if (lowerBounds[i] > kthScore) {
+                ++numAbove;
+            }
+        }
+        size_t numTiesNeeded = k - numAbove;
+
+        vector<RecordId> dropped;
+        for (ScoreMap::iterator it = _scores.begin(); it != _scores.end(); ++it) {
+            TextRecordData* textRecordData = &it->second;
+            if (textRecordData->score < 0) {
+                continue;
+            }
+
+            double upperBound = textRecordData->score;
+            for (size_t i = 0; i < _numCandidateScanners; ++i) {
+                if (!(textRecordData->termsSeen & (1ULL << i))) {
+                    upperBound += _scanFrontiers[i];
+                }
+            }
+
+            if (textRecordData->score > kthScore) {
+                continue;
+            }
+            if (upperBound > kthScore) {
+                if (textRecordData->score < kthScore) {
+                    return false;
+                }
+                continue;
+            }
+            if (textRecordData->score == kthScore && numTiesNeeded > 0) {
+                --numTiesNeeded;
+                continue;
+            }
+            dropped.push_back(it->first);
+        }
+
+        for (size_t i = 0; i < dropped.size(); ++i) {
+            ScoreMap::iterator it = _scores.find(dropped[i]);
+            _ws->free(it->second.wsid);
+            _scores.erase(it);
+        }
+
+        // The documents left may be missing the scores of terms whose keys weren't read.
+        for (ScoreMap::iterator it = _scores.begin(); it != _scores.end(); ++it) {
+            TextRecordData* textRecordData = &it->second;
+            for (size_t i = 0; i < _numCandidateScanners; ++i) {
+                if (!_scansDone[i] && !(textRecordData->termsSeen & (1ULL << i))) {
+                    textRecordData->partialScore = true;
+                    break;
+                }
+            }
+        }
+        return true;
+    }
+
+    void TextStage::finishReadingTerms() {
+        _scoreIterator = _scores.begin();
+        _internalState = RETURNING_RESULTS;
+
+        // Don't need to keep these around.
+        _scanners.clear();
+    }
+
+    double TextStage::scoreFetchedDocument(const BSONObj& obj) const {
+        fts::TermFrequencyMap termFrequencies;
+        _params.spec.scoreDocument(obj, &termFrequencies);
+
+        double score = 0;
+        for (size_t i = 0; i < _numCandidateScanners; ++i) {
+            fts::TermFrequencyMap::const_iterator it = termFrequencies.find(_scannerTerms[i]);
+            if (it != termFrequencies.end()) {
+                score += it->second;
+            }
+        }
+        return score;
+    }
+
     PlanStage::StageState TextStage::returnResults(WorkingSetID* out) {
         if (_scoreIterator == _scores.end()) {
             _internalState = DONE;
@@ -302,7 +535,23 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        // Reject the documents the index shows don't contain the right phrases without fetching
+        // them.
+        if (_phrasesFromIndex) {
+            const RecordId loc = _scoreIterator->first;
+            const bool rejected = textRecordData.allPositions && phrasesRejectFromIndex(loc);
+            _positions.erase(loc);
+            if (rejected) {
+                _scoreIterator++;
+                _ws->free(textRecordData.wsid);
+                return PlanStage::NEED_TIME;
+            }
+        }
+
         WorkingSetMember* wsm = _ws->get(textRecordData.wsid);
+        if (!wsm->hasObj()) {
+            ++_specificStats.fetches;
+        }
         try {
             if (!WorkingSetCommon::fetchIfUnfetched(_txn, wsm, _params.index->getCollection())) {
                 _scoreIterator++;
@@ -320,13 +569,17 @@ namespace mongo {
 
         _scoreIterator++;
 
-        // Filter for phrases and negated terms
-        if (!_ftsMatcher.matches(wsm->obj.value())) {
+        // Filter for phrases and negated terms, unless the index keys already did.
+        const bool matchedFromIndex = _indexDecidesMatch && textRecordData.allPositions;
+        if (!matchedFromIndex && !_ftsMatcher.matches(wsm->obj.value())) {
             _ws->free(textRecordData.wsid);
             return PlanStage::NEED_TIME;
         }
 
         // Populate the working set member with the text score and return it.
+        if (textRecordData.partialScore) {
+            textRecordData.score = scoreFetchedDocument(wsm->obj.value());
+        }
         wsm->addComputed(new TextScoreComputedData(textRecordData.score));
         *out = textRecordData.wsid;
         return PlanStage::ADVANCED;
@@ -403,6 +656,24 @@ namespace mongo {
         invariant(1 == wsm->keyData.size());
         const IndexKeyDatum newKeyData = wsm->keyData.back(); // copy to keep it around.
 
+        // Locate score within possibly compound key: {prefix,term,score,suffix,positions}, where
+        // only version 3 keys end with positions.
+        BSONObjIterator keyIt(newKeyData.keyData);
+        for (unsigned i = 0; i < _params.spec.numExtraBefore(); i++) {
+            keyIt.next();
+        }
+
+        keyIt.next(); // Skip past 'term'.
+
+        BSONElement scoreElement = keyIt.next();
+        double documentTermScore = scoreElement.number();
+
+        // The scan returns keys in descending score order, so no other document can get more
+        // from this term.
+        if (_topK) {
+            _scanFrontiers[_currentIndexScanner] = documentTermScore;
+        }
+
         TextRecordData* textRecordData = &_scores[wsm->loc];
         double* documentAggregateScore = &textRecordData->score;
 
@@ -446,10 +717,6 @@ namespace mongo {
                     return NEED_TIME;
                 }
             }
-            else {
-                // If we're here, we're going to return the doc, and we do a fetch later.
-                ++_specificStats.fetches;
-            }
         }
         else {
             // We already have a working set member for this RecordId. Free the new
@@ -469,20 +736,83 @@ namespace mongo {
             return NEED_TIME;
         }
 
-        // Locate score within possibly compound key: {prefix,term,score,suffix}.
-        BSONObjIterator keyIt(newKeyData.keyData);
-        for (unsigned i = 0; i < _params.spec.numExtraBefore(); i++) {
-            keyIt.next();
+        // Aggregate relevance score, term keys.
+        *documentAggregateScore += documentTermScore;
+        if (_topK) {
+            textRecordData->termsSeen |= 1ULL << _currentIndexScanner;
         }
 
-        keyIt.next(); // Skip past 'term'.
+        addPositions(wsm->loc, newKeyData.keyData);
+        return NEED_TIME;
+    }
 
-        BSONElement scoreElement = keyIt.next();
-        double documentTermScore = scoreElement.number();
+    PlanStage::StageState TextStage::addFilterTerm(WorkingSetID wsid) {
+        WorkingSetMember* wsm = _ws->get(wsid);
+        invariant(wsm->state == WorkingSetMember::LOC_AND_IDX);
+        invariant(1 == wsm->keyData.size());
+        const RecordId loc = wsm->loc;
+        const BSONObj key = wsm->keyData.back().keyData;
+        _ws->free(wsid);
 
-        // Aggregate relevance score, term keys.
-        *documentAggregateScore += documentTermScore;
+        ++_specificStats.keysExamined;
+
+        // Only the documents found by the other scans are of interest.
+        ScoreMap::iterator scoreIt = _scores.find(loc);
+        if (scoreIt == _scores.end() || scoreIt->second.score < 0) {
+            return NEED_TIME;
+        }
+
+        const string& term = _scannerTerms[_currentIndexScanner];
+        if (_negatedTermsFromIndex && _params.query.getNegatedTerms().count(term)) {
+            // The document contains a negated term, so we don't need to look at it any further.
+            TextRecordData* textRecordData = &scoreIt->second;
+            _ws->free(textRecordData->wsid);
+            textRecordData->wsid = WorkingSet::INVALID_ID;
+            textRecordData->score = -1;
+            _positions.erase(loc);
+            return NEED_TIME;
+        }
+
+        addPositions(loc, key);
         return NEED_TIME;
     }
 
+    void TextStage::addPositions(const RecordId& loc, const BSONObj& key) {
+        const string& term = _scannerTerms[_currentIndexScanner];
+        if (!_phrasesFromIndex || !_phraseTerms.count(term)) {
+            return;
+        }
+
+        fts::TermPositions* positions = &_positions[loc][term];
+        if (!FTSIndexFormat::getKeyPositions(_params.spec, key, positions)) {
+            // Fall back to matching the fetched document.
+            _scores[loc].allPositions = false;
+        }
+    }
+
+    bool TextStage::phrasesRejectFromIndex(const RecordId& loc) const {
+        // A document without positions contains none of the phrase terms.
+        const fts::TermPositionsMap noPositions;
+        PositionsMap::const_iterator it = _positions.find(loc);
+        const fts::TermPositionsMap& positions = (it == _positions.end()) ? noPositions
+                                                                          : it->second;
+
+        const FTSQuery& query = _params.query;
+        for (size_t i = 0; i < query.getPositivePhrTerms().size(); i++) {
+            const fts::PhraseTerms& phraseTerms = query.getPositivePhrTerms()[i];
+            if (fts::FTSPositions::isPositional(phraseTerms) &&
+                !fts::FTSPositions::phraseOccurs(phraseTerms, positions)) {
+                return true;
+            }
+        }
+        for (size_t i = 0; i < query.getNegatedPhrTerms().size(); i++) {
+            const fts::PhraseTerms& phraseTerms = query.getNegatedPhrTerms()[i];
+            if (fts::FTSPositions::isPositional(phraseTerms) &&
+                fts::FTSPositions::phraseOccurs(phraseTerms, positions)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 }  // namespace mongo
@@ -42,6 +42,8 @@
 
 #include <map>
 #include <queue>
+#include <set>
+#include <string>
 #include <vector>
 
 namespace mongo {
@@ -55,7 +57,7 @@ namespace mongo {
     class OperationContext;
 
     struct TextStageParams {
-        TextStageParams(const FTSSpec& s) : spec(s) {}
+        TextStageParams(const FTSSpec& s) : spec(s), limit(0) {}
 
         // Text index descriptor.  IndexCatalog owns this.
         IndexDescriptor* index;
@@ -68,6 +70,10 @@ namespace mongo {
 
         // The text query.
         FTSQuery query;
+
+        // If non-zero, only the 'limit' best scoring documents need to be returned.  More may be
+        // returned when scores tie.
+        size_t limit;
     };
 
     /**
@@ -143,6 +149,50 @@ namespace mongo {
          */
         StageState addTerm(WorkingSetID wsid, WorkingSetID* out);
 
+        /**
+         * Helper called from readFromSubScanners for the keys of a term that is only read to
+         * filter the documents found by the other scans: rejects documents that contain a
+         * negated term, and records the positions of phrase terms.
+         */
+        StageState addFilterTerm(WorkingSetID wsid);
+
+        /**
+         * Records the positions of '_scannerTerms[_currentIndexScanner]' stored in 'key' for the
+         * document at 'loc', if they are needed to match phrases.
+         */
+        void addPositions(const RecordId& loc, const BSONObj& key);
+
+        /**
+         * Returns true if the term positions read from the index show that the document at
+         * 'loc' can't match the query's phrases.
+         */
+        bool phrasesRejectFromIndex(const RecordId& loc) const;
+
+        /**
+         * Used when only the '_params.limit' best scoring documents are needed, after each key or
+         * EOF read from a candidate scan.  The candidate scans take turns, and reading stops as
+         * soon as topKDecided() shows that the keys read so far leave no room for other documents
+         * to make it into the top k.
+         */
+        StageState nextTopKScan();
+
+        /**
+         * Returns true, after dropping the documents which can't be among the best scoring, if
+         * no document can still overtake the best '_params.limit' ones found so far.
+         */
+        bool topKDecided();
+
+        /**
+         * Moves on to returning the buffered documents.
+         */
+        void finishReadingTerms();
+
+        /**
+         * Scores 'obj' against the candidate terms.  Used for documents that are returned before
+         * all of their keys have been read.
+         */
+        double scoreFetchedDocument(const BSONObj& obj) const;
+
         /**
          * Possibly return a result.  FYI, this may perform a fetch directly if it is needed to
          * evaluate all filters.
@@ -178,14 +228,53 @@ namespace mongo {
         // Which _scanners are we currently reading from?
         size_t _currentIndexScanner;
 
+        // The term each of _scanners reads.  The first _numCandidateScanners find the documents
+        // to return; the rest only read the keys of negated terms and phrase terms.
+        std::vector<std::string> _scannerTerms;
+        size_t _numCandidateScanners;
+
+        // Can documents containing negated terms be rejected based on the index alone?
+        bool _negatedTermsFromIndex;
+
+        // Can phrases be matched with the term positions stored in the index?  If so, these are
+        // the terms whose positions are needed.
+        bool _phrasesFromIndex;
+        std::set<std::string> _phraseTerms;
+
+        // If the index decides the negated terms and all phrases, documents which pass those
+        // checks don't need to be checked again after they are fetched.
+        bool _indexDecidesMatch;
+
+        // Are we reading only as many keys as needed to find the '_params.limit' best scoring
+        // documents?  Only possible if no documents are rejected after their scores are known.
+        bool _topK;
+
+        // In top-k mode, the score in the last key read by each candidate scan, which bounds the
+        // scores it can still return, and whether the scan is done.
+        std::vector<double> _scanFrontiers;
+        std::vector<bool> _scansDone;
+        size_t _keysSinceTopKCheck;
+
         // If not Null, we use this rather than asking our child what to do next.
         WorkingSetID _idRetrying;
 
         // Map each buffered record id to this data.
         struct TextRecordData {
-            TextRecordData() : wsid(WorkingSet::INVALID_ID), score(0.0) { }
+            TextRecordData() : wsid(WorkingSet::INVALID_ID),
+                               score(0.0),
+                               allPositions(true),
+                               termsSeen(0),
+                               partialScore(false) { }
             WorkingSetID wsid;
             double score;
+
+            // False if some term had too many positions to be stored in its index key.
+            bool allPositions;
+
+            // In top-k mode, a bit for each candidate scan which found this document, and whether
+            // 'score' is missing terms that were not read before reading stopped.
+            unsigned long long termsSeen;
+            bool partialScore;
         };
 
         // Temporary score data filled out by sub-scans.  Used in READING_TERMS and
@@ -194,6 +283,10 @@ namespace mongo {
         typedef unordered_map<RecordId, TextRecordData, RecordId::Hasher> ScoreMap;
         ScoreMap _scores;
         ScoreMap::const_iterator _scoreIterator;
+
+        // Positions of the phrase terms in the documents in _scores, when _phrasesFromIndex.
+        typedef unordered_map<RecordId, fts::TermPositionsMap, RecordId::Hasher> PositionsMap;
+        PositionsMap _positions;
     };
 
 } // namespace mongo
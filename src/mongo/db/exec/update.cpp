@@ -38,8 +38,10 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/op_observer.h"
+#include "mongo/db/ops/replacement_diff.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/explain.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
@@ -425,6 +427,24 @@ namespace mongo {
             return Status::OK();
         }
 
+        /**
+         * Returns an owned copy of 'obj' with the in-place updates in 'damages' applied to it.
+         */
+        BSONObj applyDamages(const BSONObj& obj,
+                             const char* damageSource,
+                             const mb::DamageVector& damages) {
+            SharedBuffer buffer = SharedBuffer::allocate(obj.objsize());
+            memcpy(buffer.get(), obj.objdata(), obj.objsize());
+            for (mb::DamageVector::const_iterator it = damages.begin();
+                 it != damages.end();
+                 ++it) {
+                memcpy(buffer.get() + it->targetOffset,
+                       damageSource + it->sourceOffset,
+                       it->size);
+            }
+            return BSONObj(buffer);
+        }
+
     } // namespace
 
     // static
@@ -462,84 +482,103 @@ namespace mongo {
         // If asked to return new doc, default to the oldObj, in case nothing changes.
         BSONObj newObj = oldObj.value();
 
-        // Ask the driver to apply the mods. It may be that the driver can apply those "in
-        // place", that is, some values of the old document just get adjusted without any
-        // change to the binary layout on the bson layer. It may be that a whole new document
-        // is needed to accomodate the new bson layout of the resulting document. In any event,
-        // only enable in-place mutations if the underlying storage engine offers support for
-        // writing damage events.
-        _doc.reset(oldObj.value(),
-                   (_collection->getRecordStore()->updateWithDamagesSupported() ?
-                    mutablebson::Document::kInPlaceEnabled :
-                    mutablebson::Document::kInPlaceDisabled));
+        const std::vector<FieldRef*>* immutableFields = NULL;
+        if (lifecycle)
+            immutableFields = lifecycle->getImmutableFields();
 
-        BSONObj logObj;
+        const bool damagesSupported = _collection->getRecordStore()->updateWithDamagesSupported();
 
-        FieldRefSet updatedFields;
+        BSONObj logObj;
         bool docWasModified = false;
 
-        Status status = Status::OK();
-        if (!driver->needMatchDetails()) {
-            // If we don't need match details, avoid doing the rematch
-            status = driver->update(StringData(), &_doc, &logObj, &updatedFields, &docWasModified);
-        }
-        else {
-            // If there was a matched field, obtain it.
-            MatchDetails matchDetails;
-            matchDetails.requestElemMatchKey();
+        // Simple $set/$inc/$unset updates of top-level fields are spliced into a new document
+        // directly, without a mutable document. They leave _id and the immutable fields alone
+        // and only write values that are fine for storage, so there is nothing to validate.
+        // Where damages can be written the mutable document may update in place instead, which
+        // is cheaper still.
+        const bool simple = !damagesSupported &&
+                            driver->isSimpleUpdate(immutableFields) &&
+                            mongoutils::str::equals(oldObj.value().firstElementFieldName(),
+                                                    "_id") &&
+                            driver->updateSimple(oldObj.value(), &newObj, &logObj, &docWasModified);
 
-            dassert(cq);
-            verify(cq->root()->matchesBSON(oldObj.value(), &matchDetails));
-
-            string matchedField;
-            if (matchDetails.hasElemMatchKey())
-                matchedField = matchDetails.elemMatchKey();
-
-            // TODO: Right now, each mod checks in 'prepare' that if it needs positional
-            // data, that a non-empty StringData() was provided. In principle, we could do
-            // that check here in an else clause to the above conditional and remove the
-            // checks from the mods.
+        const char* source = NULL;
+        bool inPlace = false;
+
+        if (!simple) {
+            // Ask the driver to apply the mods. It may be that the driver can apply those "in
+            // place", that is, some values of the old document just get adjusted without any
+            // change to the binary layout on the bson layer. It may be that a whole new
+            // document is needed to accomodate the new bson layout of the resulting document.
+            // In any event, only enable in-place mutations if the underlying storage engine
+            // offers support for writing damage events.
+            _doc.reset(oldObj.value(),
+                       (damagesSupported ?
+                        mutablebson::Document::kInPlaceEnabled :
+                        mutablebson::Document::kInPlaceDisabled));
+
+            FieldRefSet updatedFields;
+
+            Status status = Status::OK();
+            if (!driver->needMatchDetails()) {
+                // If we don't need match details, avoid doing the rematch
+                status = driver->update(StringData(), &_doc, &logObj, &updatedFields,
+                                        &docWasModified);
+            }
+            else {
+                // If there was a matched field, obtain it.
+                MatchDetails matchDetails;
+                matchDetails.requestElemMatchKey();
 
-            status = driver->update(matchedField, &_doc, &logObj, &updatedFields, &docWasModified);
-        }
+                dassert(cq);
+                verify(cq->root()->matchesBSON(oldObj.value(), &matchDetails));
 
-        if (!status.isOK()) {
-            uasserted(16837, status.reason());
-        }
+                string matchedField;
+                if (matchDetails.hasElemMatchKey())
+                    matchedField = matchDetails.elemMatchKey();
 
-        // Ensure _id exists and is first
-        uassertStatusOK(ensureIdAndFirst(_doc));
+                // TODO: Right now, each mod checks in 'prepare' that if it needs positional
+                // data, that a non-empty StringData() was provided. In principle, we could do
+                // that check here in an else clause to the above conditional and remove the
+                // checks from the mods.
 
-        // See if the changes were applied in place
-        const char* source = NULL;
-        const bool inPlace = _doc.getInPlaceUpdates(&_damages, &source);
+                status = driver->update(matchedField, &_doc, &logObj, &updatedFields,
+                                        &docWasModified);
+            }
 
-        if (inPlace && _damages.empty()) {
-            // An interesting edge case. A modifier didn't notice that it was really a no-op
-            // during its 'prepare' phase. That represents a missed optimization, but we still
-            // shouldn't do any real work. Toggle 'docWasModified' to 'false'.
-            //
-            // Currently, an example of this is '{ $pushAll : { x : [] } }' when the 'x' array
-            // exists.
-            docWasModified = false;
-        }
+            if (!status.isOK()) {
+                uasserted(16837, status.reason());
+            }
 
-        if (docWasModified) {
+            // Ensure _id exists and is first
+            uassertStatusOK(ensureIdAndFirst(_doc));
 
-            // Verify that no immutable fields were changed and data is valid for storage.
+            // See if the changes were applied in place
+            inPlace = _doc.getInPlaceUpdates(&_damages, &source);
 
-            if (!(!_txn->writesAreReplicated() || request->isFromMigration())) {
-                const std::vector<FieldRef*>* immutableFields = NULL;
-                if (lifecycle)
-                    immutableFields = lifecycle->getImmutableFields();
+            if (inPlace && _damages.empty()) {
+                // An interesting edge case. A modifier didn't notice that it was really a no-op
+                // during its 'prepare' phase. That represents a missed optimization, but we
+                // still shouldn't do any real work. Toggle 'docWasModified' to 'false'.
+                //
+                // Currently, an example of this is '{ $pushAll : { x : [] } }' when the 'x'
+                // array exists.
+                docWasModified = false;
+            }
 
-                uassertStatusOK(validate(oldObj.value(),
-                                         updatedFields,
-                                         _doc,
-                                         immutableFields,
-                                         driver->modOptions()) );
+            if (docWasModified) {
+                // Verify that no immutable fields were changed and data is valid for storage.
+                if (!(!_txn->writesAreReplicated() || request->isFromMigration())) {
+                    uassertStatusOK(validate(oldObj.value(),
+                                             updatedFields,
+                                             _doc,
+                                             immutableFields,
+                                             driver->modOptions()) );
+                }
             }
+        }
 
+        if (docWasModified) {
             // Prepare to write back the modified document
             WriteUnitOfWork wunit(_txn);
 
@@ -564,6 +603,13 @@ namespace mongo {
                             source,
                             _damages,
                             args);
+
+                    // Only MMAPv1 writes the damages into the memory 'oldObj' points to.  Other
+                    // storage engines write a new copy of the record, so the new version of the
+                    // document has to be made here if it's going to be returned.
+                    if (request->shouldReturnNewDocs()) {
+                        newObj = applyDamages(oldObj.value(), source, _damages);
+                    }
                 }
 
                 _specificStats.fastmod = true;
@@ -572,12 +618,30 @@ namespace mongo {
             else {
                 // The updates were not in place. Apply them through the file manager.
 
-                newObj = _doc.getObject();
+                if (!simple) {
+                    newObj = _doc.getObject();
+                }
                 uassert(17419,
                         str::stream() << "Resulting document after update is larger than "
                         << BSONObjMaxUserSize,
                         newObj.objsize() <= BSONObjMaxUserSize);
 
+                // A replacement usually changes only a few fields of the document. If so, log
+                // just those rather than the whole new document.
+                if (driver->isDocReplacement() &&
+                        !logObj.isEmpty() &&
+                        !request->isExplain() &&
+                        internalQueryExecReplacementDiffPercent > 0) {
+                    const long long maxBytes =
+                        static_cast<long long>(newObj.objsize()) *
+                        internalQueryExecReplacementDiffPercent / 100;
+                    BSONObj diff = makeReplacementDiff(oldObj.value(), newObj,
+                                                       static_cast<int>(maxBytes));
+                    if (!diff.isEmpty()) {
+                        logObj = diff;
+                    }
+                }
+
                 // Don't actually do the write if this is an explain.
                 if (!request->isExplain()) {
                     invariant(_collection);
@@ -593,6 +657,7 @@ namespace mongo {
                             newObj,
                             true,
                             driver->modsAffectIndices(),
+                            driver->modifiedIndexedPaths(),
                             _params.opDebug,
                             args);
                     uassertStatusOK(res.getStatus());
@@ -768,8 +833,8 @@ namespace mongo {
     PlanStage::StageState UpdateStage::work(WorkingSetID* out) {
         ++_commonStats.works;
 
-        // Adds the amount of time taken by work() to executionTimeMillis.
-        ScopedTimer timer(&_commonStats.executionTimeMillis);
+        // Adds the amount of time taken by work() to executionTimeCycles.
+        ScopedTimer timer(&_commonStats.executionTimeCycles);
 
         if (isEOF()) { return PlanStage::IS_EOF; }
 
@@ -41,9 +41,7 @@ namespace mongo {
     WorkingSet::WorkingSet() : _freeList(INVALID_ID) { }
 
     WorkingSet::~WorkingSet() {
-        for (size_t i = 0; i < _data.size(); i++) {
-            delete _data[i].member;
-        }
+        _freeMemberBlocks();
     }
 
     WorkingSetID WorkingSet::allocate() {
@@ -52,9 +50,10 @@ namespace mongo {
             // vector::resize being amortized O(1) for efficient allocation. Note that the free list
             // remains empty until something is returned by a call to free().
             WorkingSetID id = _data.size();
+            WorkingSetMember* member = _allocateMember(id);
             _data.resize(_data.size() + 1);
             _data.back().nextFreeOrSelf = id;
-            _data.back().member = new WorkingSetMember();
+            _data.back().member = member;
             return id;
         }
 
@@ -92,9 +91,7 @@ namespace mongo {
     }
 
     void WorkingSet::clear() {
-        for (size_t i = 0; i < _data.size(); i++) {
-            delete _data[i].member;
-        }
+        _freeMemberBlocks();
         _data.clear();
 
         // Since working set is now empty, the free list pointer should
@@ -104,6 +101,24 @@ namespace mongo {
         _flagged.clear();
     }
 
+    WorkingSetMember* WorkingSet::_allocateMember(WorkingSetID id) {
+        const size_t block = id / kMembersPerBlock;
+        if (block == _memberBlocks.size()) {
+            _memberBlocks.push_back(new WorkingSetMember[kMembersPerBlock]);
+            if (block == 0) {
+                _data.reserve(kMembersPerBlock);
+            }
+        }
+        return &_memberBlocks[block][id % kMembersPerBlock];
+    }
+
+    void WorkingSet::_freeMemberBlocks() {
+        for (size_t i = 0; i < _memberBlocks.size(); i++) {
+            delete[] _memberBlocks[i];
+        }
+        _memberBlocks.clear();
+    }
+
     //
     // Iteration
     //
@@ -169,10 +169,25 @@ namespace mongo {
             // Free list link if freed. Points to self if in use.
             WorkingSetID nextFreeOrSelf;
 
-            // Owning pointer
+            // Points into _memberBlocks.
             WorkingSetMember* member;
         };
 
+        /**
+         * Returns the member for the new WorkingSetID 'id', allocating another block if needed.
+         */
+        WorkingSetMember* _allocateMember(WorkingSetID id);
+
+        void _freeMemberBlocks();
+
+        // Members are allocated kMembersPerBlock at a time rather than one by one, so that most
+        // queries make a single allocation for all of them. Blocks never move, so the pointers
+        // returned by get() stay valid as the working set grows.
+        static const size_t kMembersPerBlock = 16;
+
+        // Member i lives at _memberBlocks[i / kMembersPerBlock][i % kMembersPerBlock].
+        std::vector<WorkingSetMember*> _memberBlocks;
+
         // All WorkingSetIDs are indexes into this, except for INVALID_ID.
         // Elements are added to _freeList rather than removed when freed.
         std::vector<MemberHolder> _data;
@@ -245,4 +245,33 @@ namespace {
         ASSERT_EQ(counter, 1);
     }
 
+    // Members are allocated in blocks; growing the working set must not move existing members.
+    TEST(WorkingSetTest, MembersStayPutWhileGrowing) {
+        WorkingSet ws;
+
+        std::vector<WorkingSetID> ids;
+        std::vector<WorkingSetMember*> members;
+        for (int i = 0; i < 100; i++) {
+            ids.push_back(ws.allocate());
+            members.push_back(ws.get(ids.back()));
+            members.back()->loc = RecordId(i);
+            members.back()->state = WorkingSetMember::LOC_AND_IDX;
+        }
+
+        for (int i = 0; i < 100; i++) {
+            ASSERT_EQUALS(members[i], ws.get(ids[i]));
+            ASSERT_EQUALS(RecordId(i), ws.get(ids[i])->loc);
+        }
+
+        // Freed members are reused before new ones are allocated.
+        ws.free(ids[50]);
+        ASSERT_EQUALS(ids[50], ws.allocate());
+        ASSERT_EQUALS(members[50], ws.get(ids[50]));
+        ASSERT_EQUALS(WorkingSetMember::INVALID, ws.get(ids[50])->state);
+
+        ws.clear();
+        WorkingSetID id = ws.allocate();
+        ASSERT_EQUALS(WorkingSetMember::INVALID, ws.get(id)->state);
+    }
+
 }  // namespace
@@ -45,13 +45,17 @@ namespace fts {
     using std::string;
 
     BasicFTSTokenizer::BasicFTSTokenizer(const FTSLanguage* language)
-        : _language(language), _stemmer(language), _stopWords(StopWords::getStopWords(language)) {
+        : _language(language),
+          _stemmer(language),
+          _stopWords(StopWords::getStopWords(language)),
+          _numTokens(0) {
     }
 
     void BasicFTSTokenizer::reset(StringData document, Options options) {
         _options = options;
         _document = document.toString();
         _tokenizer = stdx::make_unique<Tokenizer>(_language, _document);
+        _numTokens = 0;
     }
 
     bool BasicFTSTokenizer::moveNext() {
@@ -63,10 +67,9 @@ namespace fts {
             }
 
             Token token = _tokenizer->next();
+            _numTokens++;
 
-            string word = token.data.toString();
-
-            word = tolowerString(token.data);
+            string word = tolowerASCII(token.data);
 
             // Stop words are case-sensitive so we need them to be lower cased to check
             // against the stop word list
@@ -88,5 +91,9 @@ namespace fts {
         return _stem;
     }
 
+    unsigned BasicFTSTokenizer::getPosition() const {
+        return _numTokens - 1;
+    }
+
 } // namespace fts
 } // namespace mongo
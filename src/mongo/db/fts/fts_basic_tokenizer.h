@@ -64,6 +64,8 @@ namespace fts {
 
         StringData get() const final;
 
+        unsigned getPosition() const final;
+
     private:
         const FTSLanguage* const _language;
         const Stemmer _stemmer;
@@ -74,6 +76,9 @@ namespace fts {
         Options _options;
 
         std::string _stem;
+
+        // Number of tokens consumed from _tokenizer so far.
+        unsigned _numTokens;
     };
 
 } // namespace fts
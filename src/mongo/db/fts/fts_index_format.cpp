@@ -72,7 +72,8 @@ namespace mongo {
                     return term.size();
                 }
                 else {
-                    invariant( TEXT_INDEX_VERSION_2 == textIndexVersion );
+                    invariant( TEXT_INDEX_VERSION_2 == textIndexVersion ||
+                               TEXT_INDEX_VERSION_3 == textIndexVersion );
                     if ( term.size() <= termKeyPrefixLength ) {
                         return term.size();
                     }
@@ -116,8 +117,12 @@ namespace mongo {
             }
 
 
+            // New in textIndexVersion 3: each key ends with the positions of its term.
+            const bool storePositions = spec.getTextIndexVersion() == TEXT_INDEX_VERSION_3;
+
             TermFrequencyMap term_freqs;
-            spec.scoreDocument( obj, &term_freqs );
+            TermPositionsMap term_positions;
+            spec.scoreDocument( obj, &term_freqs, storePositions ? &term_positions : NULL );
 
             // create index keys from raw scores
             // only 1 per string
@@ -142,7 +147,10 @@ namespace mongo {
                     8 /* term overhead */ +
                     /* term size (could be truncated/hashed) */
                     guessTermSize( term, spec.getTextIndexVersion() ) +
-                    extraSize;
+                    extraSize +
+                    ( storePositions ?
+                        7 /* bindata overhead */ + 1 /* flags */ +
+                          FTSPositions::kMaxEncodedSize : 0 );
 
                 BSONObjBuilder b(guess); // builds a BSON object with guess length.
                 for ( unsigned k = 0; k < extrasBefore.size(); k++ ) {
@@ -152,6 +160,9 @@ namespace mongo {
                 for ( unsigned k = 0; k < extrasAfter.size(); k++ ) {
                     b.appendAs( extrasAfter[k], "" );
                 }
+                if ( storePositions ) {
+                    FTSPositions::append( &b, term_positions[term] );
+                }
                 BSONObj res = b.obj();
 
                 verify( guess >= res.objsize() );
@@ -183,6 +194,20 @@ namespace mongo {
             return b.obj();
         }
 
+        bool FTSIndexFormat::getKeyPositions( const FTSSpec& spec,
+                                              const BSONObj& key,
+                                              TermPositions* positions ) {
+            invariant( TEXT_INDEX_VERSION_3 == spec.getTextIndexVersion() );
+
+            // Skip the prefix, term, weight and suffix.
+            BSONObjIterator it( key );
+            const size_t numToSkip = spec.numExtraBefore() + 2 + spec.numExtraAfter();
+            for ( size_t i = 0; i < numToSkip; i++ ) {
+                it.next();
+            }
+            return FTSPositions::decode( it.next(), positions );
+        }
+
         void FTSIndexFormat::_appendIndexKey( BSONObjBuilder& b, double weight, const string& term,
                                               TextIndexVersion textIndexVersion ) {
             verify( weight >= 0 && weight <= MAX_WEIGHT ); // FTSmaxweight =  defined in fts_header
@@ -194,7 +219,8 @@ namespace mongo {
             // See comments at the top of file for termKeyPrefixLength.
             // Apply hash for text index version 2 to long terms (longer than 32 characters).
             else {
-                invariant( TEXT_INDEX_VERSION_2 == textIndexVersion );
+                invariant( TEXT_INDEX_VERSION_2 == textIndexVersion ||
+                           TEXT_INDEX_VERSION_3 == textIndexVersion );
                 if ( term.size() <= termKeyPrefixLength ) {
                     b.append( "", term );
                 }
@@ -33,6 +33,7 @@
 #include <string>
 
 #include "mongo/base/string_data.h"
+#include "mongo/db/fts/fts_positions.h"
 #include "mongo/db/fts/fts_util.h"
 
 namespace mongo {
@@ -60,6 +61,17 @@ namespace mongo {
                                         const BSONObj& indexPrefix,
                                         TextIndexVersion textIndexVersion );
 
+            /**
+             * Decodes the term positions at the end of a TEXT_INDEX_VERSION_3 index key.
+             * @param spec, the spec of the index 'key' belongs to
+             * @param key, an index key, as generated by getKeys()
+             * @param positions, output parameter for the positions
+             * @return false if 'key' holds only some of the term's positions.
+             */
+            static bool getKeyPositions( const FTSSpec& spec,
+                                         const BSONObj& key,
+                                         TermPositions* positions );
+
         private:
             /**
              * Helper method to get return entry from the FTSIndex as a BSONObj
@@ -202,5 +202,62 @@ namespace mongo {
             assertEqualsIndexKeys( expectedKeys, keys);
         }
 
+        TEST( FTSIndexFormat, Version3KeysEndWithPositions ) {
+            FTSSpec spec( FTSSpec::fixSpec( BSON( "key" << BSON( "data" << "text" << "x" << 1 ) <<
+                                                  "textIndexVersion" << 3 ) ) );
+            BSONObjSet keys;
+            FTSIndexFormat::getKeys( spec,
+                                     BSON( "data" << BSON_ARRAY( "the cat sat on the cat" <<
+                                                                 "cat" ) << "x" << 5 ),
+                                     &keys );
+
+            // "the" and "on" are stop words.
+            ASSERT_EQUALS( 2U, keys.size() );
+            for ( BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i ) {
+                BSONObj key = *i;
+                ASSERT_EQUALS( 4, key.nFields() );
+                BSONObjIterator it( key );
+                const string term = it.next().String();
+                ASSERT( it.next().numberDouble() > 0 );
+                ASSERT_EQUALS( 5, it.next().numberInt() );
+                ASSERT_EQUALS( BinData, it.next().type() );
+
+                TermPositions positions;
+                ASSERT( FTSIndexFormat::getKeyPositions( spec, key, &positions ) );
+                TermPositions expected;
+                if ( term == "cat" ) {
+                    // The second string starts after the gap that follows the first.
+                    expected.push_back( 1 );
+                    expected.push_back( 5 );
+                    expected.push_back( 6 + FTSPositions::kStringGap );
+                }
+                else {
+                    ASSERT_EQUALS( "sat", term );
+                    expected.push_back( 2 );
+                }
+                ASSERT( expected == positions );
+            }
+        }
+
+        TEST( FTSIndexFormat, Version3TruncatesLongPositionLists ) {
+            FTSSpec spec( FTSSpec::fixSpec( BSON( "key" << BSON( "data" << "text" ) <<
+                                                  "textIndexVersion" << 3 ) ) );
+            string text;
+            for ( int i = 0; i < 1000; i++ ) {
+                text += "cat ";
+            }
+            BSONObjSet keys;
+            FTSIndexFormat::getKeys( spec, BSON( "data" << text ), &keys );
+
+            ASSERT_EQUALS( 1U, keys.size() );
+            TermPositions positions;
+            ASSERT_FALSE( FTSIndexFormat::getKeyPositions( spec, *keys.begin(), &positions ) );
+            ASSERT_EQUALS( static_cast<size_t>( FTSPositions::kMaxEncodedSize ),
+                           positions.size() );
+            for ( size_t i = 0; i < positions.size(); i++ ) {
+                ASSERT_EQUALS( i, positions[i] );
+            }
+        }
+
     }
 }
@@ -197,6 +197,7 @@ namespace mongo {
             verify( !languageName.empty() );
             language->_canonicalName = languageName.toString();
             switch ( textIndexVersion ) {
+            case TEXT_INDEX_VERSION_3:
             case TEXT_INDEX_VERSION_2:
                 languageMapV2[ languageName.toString() ] = language;
                 return; 
@@ -213,6 +214,7 @@ namespace mongo {
                                                  StringData alias,
                                                  TextIndexVersion textIndexVersion ) {
             switch ( textIndexVersion ) {
+            case TEXT_INDEX_VERSION_3:
             case TEXT_INDEX_VERSION_2:
                 languageMapV2[ alias.toString() ] = language;
                 return;
@@ -236,6 +238,8 @@ namespace mongo {
         StatusWithFTSLanguage FTSLanguage::make( StringData langName,
                                                  TextIndexVersion textIndexVersion ) {
             switch ( textIndexVersion ) {
+                // TEXT_INDEX_VERSION_3 indexes support the same languages as TEXT_INDEX_VERSION_2.
+                case TEXT_INDEX_VERSION_3:
                 case TEXT_INDEX_VERSION_2: {
                     LanguageMapV2::const_iterator it = languageMapV2.find( langName.toString() );
                     if ( it == languageMapV2.end() ) {
@@ -146,7 +146,9 @@ namespace mongo {
 
         bool FTSMatcher::positivePhrasesMatch( const BSONObj& obj ) const {
             for ( size_t i = 0; i < _query.getPositivePhr().size(); i++ ) {
-                if ( !_phraseMatch( _query.getPositivePhr()[i], obj ) ) {
+                if ( !_phraseMatch( _query.getPositivePhr()[i],
+                                    _query.getPositivePhrTerms()[i],
+                                    obj ) ) {
                     return false;
                 }
             }
@@ -156,7 +158,9 @@ namespace mongo {
 
         bool FTSMatcher::negativePhrasesMatch( const BSONObj& obj ) const {
             for ( size_t i = 0; i < _query.getNegatedPhr().size(); i++ ) {
-                if ( _phraseMatch( _query.getNegatedPhr()[i], obj ) ) {
+                if ( _phraseMatch( _query.getNegatedPhr()[i],
+                                   _query.getNegatedPhrTerms()[i],
+                                   obj ) ) {
                     return false;
                 }
             }
@@ -164,17 +168,51 @@ namespace mongo {
             return true;
         }
 
-        bool FTSMatcher::_phraseMatch( const string& phrase, const BSONObj& obj ) const {
+        bool FTSMatcher::_phraseMatch( const string& phrase,
+                                       const PhraseTerms& phraseTerms,
+                                       const BSONObj& obj ) const {
+            const bool positional = _spec.getTextIndexVersion() == TEXT_INDEX_VERSION_3 &&
+                                    FTSPositions::isPositional( phraseTerms );
+
             FTSElementIterator it( _spec, obj );
 
             while ( it.more() ) {
                 FTSIteratorValue val = it.next();
-                if ( phraseMatches( phrase, val._text, _query.getCaseSensitive() ) ) {
+                if ( positional ?
+                        _phraseTermsMatch_string( phraseTerms, val._language, val._text ) :
+                        phraseMatches( phrase, val._text, _query.getCaseSensitive() ) ) {
                     return true;
                 }
             }
 
             return false;
         }
+
+        bool FTSMatcher::_phraseTermsMatch_string( const PhraseTerms& phraseTerms,
+                                                   const FTSLanguage* language,
+                                                   const string& raw ) const {
+            std::unique_ptr<FTSTokenizer> tokenizer(language->createTokenizer());
+
+            tokenizer->reset(raw.c_str(), _query.getCaseSensitive() ?
+                static_cast<FTSTokenizer::Options>(FTSTokenizer::FilterStopWords
+                                                   | FTSTokenizer::GenerateCaseSensitiveTokens) :
+                FTSTokenizer::FilterStopWords);
+
+            // Positions of the phrase's terms in 'raw'; 'raw' is tokenized the same way as when
+            // it was indexed.
+            TermPositionsMap positions;
+            for ( size_t i = 0; i < phraseTerms.size(); i++ ) {
+                positions[phraseTerms[i].term];
+            }
+
+            while (tokenizer->moveNext()) {
+                TermPositionsMap::iterator it = positions.find(tokenizer->get().toString());
+                if ( it != positions.end() ) {
+                    it->second.push_back(tokenizer->getPosition());
+                }
+            }
+
+            return FTSPositions::phraseOccurs( phraseTerms, positions );
+        }
     }
 }
@@ -50,6 +50,8 @@ namespace mongo {
              * 2) The object contains zero negative terms.
              * 3) The object contains all positive phrases.
              * 4) The object contains zero negative phrases.
+             *
+             * See _phraseMatch() for what it means for an object to contain a phrase.
              */
             bool matches( const BSONObj& obj ) const;
 
@@ -96,9 +98,22 @@ namespace mongo {
                                           const std::string& raw ) const;
 
             /**
-             * Returns whether 'obj' contains the exact string 'phrase' in any indexed fields.
+             * Returns whether 'obj' contains 'phrase' in any indexed fields.  For
+             * TEXT_INDEX_VERSION_3, a positional phrase (see FTSPositions::isPositional()) is
+             * contained if its terms, 'phraseTerms', are found in the same order and at the same
+             * distances from each other; otherwise the exact string 'phrase' must be found.
              */
-            bool _phraseMatch( const std::string& phrase, const BSONObj& obj ) const;
+            bool _phraseMatch( const std::string& phrase,
+                               const PhraseTerms& phraseTerms,
+                               const BSONObj& obj ) const;
+
+            /**
+             * Returns whether the string 'raw' contains the terms 'phraseTerms' at the right
+             * positions.  'language' specifies the language for 'raw'.
+             */
+            bool _phraseTermsMatch_string( const PhraseTerms& phraseTerms,
+                                           const FTSLanguage* language,
+                                           const std::string& raw ) const;
 
             // TODO These should be unowned pointers instead of owned copies.
             const FTSQuery _query;
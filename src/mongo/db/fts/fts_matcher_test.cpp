@@ -216,5 +216,42 @@ namespace mongo {
                                                            "-\"John\" -\"Running\"" ) );
         }
 
+        TEST( FTSMatcher, Version3PhrasesMatchTermPositions ) {
+            FTSQuery q;
+            ASSERT_OK( q.parse( "foo \"running the tables\" -\"top-notch\"", "english", false,
+                                TEXT_INDEX_VERSION_3 ) );
+            FTSMatcher m( q,
+                          FTSSpec( FTSSpec::fixSpec( BSON( "key" << BSON( "$**" << "text" ) <<
+                                                           "textIndexVersion" << 3 ) ) ) );
+
+            // Terms are compared after stemming, and stop words match any one word.
+            ASSERT( m.positivePhrasesMatch( BSON( "x" << "Running the tables" ) ) );
+            ASSERT( m.positivePhrasesMatch( BSON( "x" << "we run a table" ) ) );
+            ASSERT( !m.positivePhrasesMatch( BSON( "x" << "running tables" ) ) );
+            ASSERT( !m.positivePhrasesMatch( BSON( "x" << "running the big tables" ) ) );
+
+            // Parts of words and phrases across strings don't match.
+            ASSERT( !m.positivePhrasesMatch( BSON( "x" << "overrunning the tablespace" ) ) );
+            ASSERT( !m.positivePhrasesMatch( BSON( "x" << BSON_ARRAY( "running the" <<
+                                                                      "tables" ) ) ) );
+
+            // Delimiters take up a position.
+            ASSERT( !m.negativePhrasesMatch( BSON( "x" << "top-notch" ) ) );
+            ASSERT( !m.negativePhrasesMatch( BSON( "x" << "top.notch" ) ) );
+            ASSERT( m.negativePhrasesMatch( BSON( "x" << "top notch" ) ) );
+        }
+
+        TEST( FTSMatcher, Version3PhrasesOfStopWordsMatchSubstrings ) {
+            FTSQuery q;
+            ASSERT_OK( q.parse( "foo \"and the\"", "english", false, TEXT_INDEX_VERSION_3 ) );
+            FTSMatcher m( q,
+                          FTSSpec( FTSSpec::fixSpec( BSON( "key" << BSON( "$**" << "text" ) <<
+                                                           "textIndexVersion" << 3 ) ) ) );
+
+            ASSERT( m.positivePhrasesMatch( BSON( "x" << "foo and the bar" ) ) );
+            ASSERT( m.positivePhrasesMatch( BSON( "x" << "sand they" ) ) );
+            ASSERT( !m.positivePhrasesMatch( BSON( "x" << "foo and bar" ) ) );
+        }
+
     }
 }
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/fts/fts_positions.h"
+
+#include <algorithm>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace fts {
+
+    namespace {
+        // First byte of the encoded positions.
+        const char kPositionsComplete = 1;
+        const char kPositionsIncomplete = 0;
+
+        // Appends "value" as a base 128 varint, unless that would make "buf" longer than
+        // "maxSize".  Returns whether it was appended.
+        bool appendVarint(std::string* buf, unsigned value, size_t maxSize) {
+            char bytes[5];
+            size_t size = 0;
+            do {
+                bytes[size] = value & 0x7f;
+                value >>= 7;
+                if (value) {
+                    bytes[size] |= 0x80;
+                }
+                size++;
+            } while (value);
+
+            if (buf->size() + size > maxSize) {
+                return false;
+            }
+            buf->append(bytes, size);
+            return true;
+        }
+    }
+
+    const unsigned FTSPositions::kStringGap;
+    const int FTSPositions::kMaxEncodedSize;
+
+    void FTSPositions::append(BSONObjBuilder* b, const TermPositions& positions) {
+        // Each position is stored as its distance from the previous one.
+        std::string buf(1, kPositionsComplete);
+        unsigned previous = 0;
+        for (TermPositions::const_iterator it = positions.begin(); it != positions.end(); ++it) {
+            dassert(it == positions.begin() || *it > previous);
+            if (!appendVarint(&buf, *it - previous, kMaxEncodedSize + 1)) {
+                buf[0] = kPositionsIncomplete;
+                break;
+            }
+            previous = *it;
+        }
+        b->appendBinData("", buf.size(), BinDataGeneral, buf.data());
+    }
+
+    bool FTSPositions::decode(const BSONElement& e, TermPositions* out) {
+        out->clear();
+        if (e.type() != BinData) {
+            return false;
+        }
+
+        int len;
+        const unsigned char* data =
+            reinterpret_cast<const unsigned char*>(e.binDataClean(len));
+        if (len < 1) {
+            return false;
+        }
+
+        unsigned previous = 0;
+        unsigned value = 0;
+        int shift = 0;
+        for (int i = 1; i < len; i++) {
+            value |= static_cast<unsigned>(data[i] & 0x7f) << shift;
+            if (data[i] & 0x80) {
+                shift += 7;
+                continue;
+            }
+            previous += value;
+            out->push_back(previous);
+            value = 0;
+            shift = 0;
+        }
+
+        return data[0] == kPositionsComplete;
+    }
+
+    bool FTSPositions::isPositional(const PhraseTerms& phrase) {
+        return !phrase.empty() && phrase.back().offset < kStringGap;
+    }
+
+    bool FTSPositions::phraseOccurs(const PhraseTerms& phrase, const TermPositionsMap& positions) {
+        dassert(isPositional(phrase));
+
+        std::vector<const TermPositions*> termPositions;
+        for (PhraseTerms::const_iterator it = phrase.begin(); it != phrase.end(); ++it) {
+            TermPositionsMap::const_iterator found = positions.find(it->term);
+            if (found == positions.end()) {
+                return false;
+            }
+            termPositions.push_back(&found->second);
+        }
+
+        // Try each occurrence of the first term as the start of the phrase.
+        const TermPositions& starts = *termPositions[0];
+        for (TermPositions::const_iterator start = starts.begin(); start != starts.end(); ++start) {
+            bool matched = true;
+            for (size_t i = 1; i < phrase.size() && matched; i++) {
+                matched = std::binary_search(termPositions[i]->begin(),
+                                             termPositions[i]->end(),
+                                             *start + phrase[i].offset);
+            }
+            if (matched) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace fts
+} // namespace mongo
@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/platform/unordered_map.h"
+
+namespace mongo {
+
+    class BSONElement;
+    class BSONObjBuilder;
+
+namespace fts {
+
+    /**
+     * The positions of one term's occurrences in a document, in increasing order.
+     *
+     * Positions count every token of every string indexed from the document, including stop
+     * words and delimiters (see FTSTokenizer::getPosition()). The positions of the strings that
+     * follow each other in the document are at least FTSPositions::kStringGap apart, so that no
+     * phrase can match across two of them.
+     */
+    typedef std::vector<unsigned> TermPositions;
+
+    typedef unordered_map<std::string, TermPositions> TermPositionsMap;
+
+    /**
+     * A term of a phrase, and its position relative to the phrase's first term.  Stop words and
+     * delimiters aren't terms of the phrase, but they do take up positions, so they match any
+     * one token of a document.
+     */
+    struct PhraseTerm {
+        PhraseTerm(const std::string& term, unsigned offset) : term(term), offset(offset) {}
+
+        std::string term;
+        unsigned offset;
+    };
+
+    typedef std::vector<PhraseTerm> PhraseTerms;
+
+    /**
+     * Encoding of term positions in TEXT_INDEX_VERSION_3 index keys, and phrase matching over
+     * them.
+     */
+    class FTSPositions {
+    public:
+        static const unsigned kStringGap = 64;
+
+        // The most bytes append() adds to a key for the positions themselves.  A term with too
+        // many positions to fit is stored with as many as fit, and marked as incomplete.
+        static const int kMaxEncodedSize = 128;
+
+        /**
+         * Appends "positions" to "b" as an unnamed BinData element.
+         */
+        static void append(BSONObjBuilder* b, const TermPositions& positions);
+
+        /**
+         * Decodes an element written by append() into "out".  Returns false if the element only
+         * holds some of the term's positions.
+         */
+        static bool decode(const BSONElement& e, TermPositions* out);
+
+        /**
+         * Returns true if "phrase" is matched by the positions of its terms: it has at least one
+         * term, and it is shorter than kStringGap.  Other phrases are matched as substrings.
+         */
+        static bool isPositional(const PhraseTerms& phrase);
+
+        /**
+         * Returns true if the terms of "phrase" occur at the right distances from each other in a
+         * document whose terms occur at "positions".  "phrase" must be positional.
+         */
+        static bool phraseOccurs(const PhraseTerms& phrase, const TermPositionsMap& positions);
+    };
+
+} // namespace fts
+} // namespace mongo
@@ -100,10 +100,16 @@ namespace mongo {
                             unsigned phraseLength = t.offset - phraseStart;
                             StringData phrase = StringData( query ).substr( phraseStart,
                                                                             phraseLength );
-                            if ( inNegation )
+                            if ( inNegation ) {
                                 _negatedPhrases.push_back( normalizeString( phrase ) );
-                            else
+                                _negatedPhraseTerms.push_back(
+                                    _getPhraseTerms( tokenizer.get(), phrase ) );
+                            }
+                            else {
                                 _positivePhrases.push_back( normalizeString( phrase ) );
+                                _positivePhraseTerms.push_back(
+                                    _getPhraseTerms( tokenizer.get(), phrase ) );
+                            }
                             inNegation = false;
                             inPhrase = false;
                         }
@@ -165,6 +171,39 @@ namespace mongo {
             }
         }
 
+        PhraseTerms FTSQuery::_getPhraseTerms( FTSTokenizer* tokenizer,
+                                               StringData phrase ) const {
+            const FTSTokenizer::Options options = _caseSensitive ?
+                static_cast<FTSTokenizer::Options>( FTSTokenizer::FilterStopWords |
+                                                    FTSTokenizer::GenerateCaseSensitiveTokens ) :
+                FTSTokenizer::FilterStopWords;
+
+            // Every token takes up a position, just as when the document was indexed, but only
+            // words which aren't stop words are terms of the phrase.
+            PhraseTerms terms;
+            unsigned position = 0;
+            unsigned firstTermPosition = 0;
+
+            Tokenizer i( _language, phrase );
+            while ( i.more() ) {
+                Token t = i.next();
+                if ( t.type == Token::TEXT ) {
+                    const string word = t.data.toString();
+                    tokenizer->reset( word.c_str(), options );
+                    if ( tokenizer->moveNext() ) {
+                        if ( terms.empty() ) {
+                            firstTermPosition = position;
+                        }
+                        terms.push_back( PhraseTerm( tokenizer->get().toString(),
+                                                     position - firstTermPosition ) );
+                    }
+                }
+                position++;
+            }
+
+            return terms;
+        }
+
         string FTSQuery::normalizeString(StringData str) const {
             if (_caseSensitive) {
                 return str.toString();
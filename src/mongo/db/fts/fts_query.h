@@ -34,6 +34,7 @@
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/db/fts/fts_positions.h"
 #include "mongo/db/fts/stemmer.h"
 #include "mongo/db/fts/stop_words.h"
 #include "mongo/util/stringutils.h"
@@ -58,6 +59,14 @@ namespace mongo {
             const std::vector<std::string>& getPositivePhr() const { return _positivePhrases; }
             const std::vector<std::string>& getNegatedPhr() const { return _negatedPhrases; }
 
+            // The terms of each of getPositivePhr() and getNegatedPhr(), in the same order.
+            const std::vector<PhraseTerms>& getPositivePhrTerms() const {
+                return _positivePhraseTerms;
+            }
+            const std::vector<PhraseTerms>& getNegatedPhrTerms() const {
+                return _negatedPhraseTerms;
+            }
+
             const std::set<std::string>& getTermsForBounds() const {
                 return _termsForBounds;
             }
@@ -83,6 +92,8 @@ namespace mongo {
                            const std::string& token,
                            bool negated );
 
+            PhraseTerms _getPhraseTerms( FTSTokenizer* tokenizer, StringData phrase ) const;
+
             const FTSLanguage* _language;
             bool _caseSensitive;
 
@@ -98,6 +109,10 @@ namespace mongo {
             // Negated phrases.
             std::vector<std::string> _negatedPhrases;
 
+            // Terms of the positive and negated phrases.
+            std::vector<PhraseTerms> _positivePhraseTerms;
+            std::vector<PhraseTerms> _negatedPhraseTerms;
+
             // Terms for bounds.
             std::set<std::string> _termsForBounds;
         };
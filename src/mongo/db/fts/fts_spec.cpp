@@ -76,17 +76,19 @@ namespace mongo {
                      "found invalid spec for text index, expected number for textIndexVersion",
                      textIndexVersionElt.isNumber() );
 
-            // We currently support TEXT_INDEX_VERSION_1 (deprecated) and TEXT_INDEX_VERSION_2.
-            // Reject all other values.
+            // We currently support TEXT_INDEX_VERSION_1 (deprecated), TEXT_INDEX_VERSION_2 and
+            // TEXT_INDEX_VERSION_3.  Reject all other values.
             massert( 17364,
                      str::stream() << "attempt to use unsupported textIndexVersion " <<
                          textIndexVersionElt.numberInt() << "; versions supported: " <<
-                         TEXT_INDEX_VERSION_2 << ", " << TEXT_INDEX_VERSION_1,
-                     textIndexVersionElt.numberInt() == TEXT_INDEX_VERSION_2 ||
+                         TEXT_INDEX_VERSION_3 << ", " << TEXT_INDEX_VERSION_2 << ", " <<
+                         TEXT_INDEX_VERSION_1,
+                     textIndexVersionElt.numberInt() == TEXT_INDEX_VERSION_3 ||
+                         textIndexVersionElt.numberInt() == TEXT_INDEX_VERSION_2 ||
                          textIndexVersionElt.numberInt() == TEXT_INDEX_VERSION_1 );
 
-            _textIndexVersion = ( textIndexVersionElt.numberInt() == TEXT_INDEX_VERSION_2 ) ?
-                                TEXT_INDEX_VERSION_2 : TEXT_INDEX_VERSION_1;
+            _textIndexVersion =
+                static_cast<TextIndexVersion>( textIndexVersionElt.numberInt() );
 
             // Initialize _defaultLanguage.  Note that the FTSLanguage constructor requires
             // textIndexVersion, since language parsing is version-specific.
@@ -159,34 +161,47 @@ namespace mongo {
             return swl.getValue();
         }
 
-        void FTSSpec::scoreDocument( const BSONObj& obj, TermFrequencyMap* term_freqs ) const {
+        void FTSSpec::scoreDocument( const BSONObj& obj,
+                                     TermFrequencyMap* term_freqs,
+                                     TermPositionsMap* positions ) const {
             if ( _textIndexVersion == TEXT_INDEX_VERSION_1 ) {
+                invariant( !positions );
                 return _scoreDocumentV1( obj, term_freqs );
             }
 
             FTSElementIterator it( *this, obj );
 
+            unsigned nextPosition = 0;
             while ( it.more() ) {
                 FTSIteratorValue val = it.next();
                 std::unique_ptr<FTSTokenizer> tokenizer(val._language->createTokenizer());
-                _scoreStringV2( tokenizer.get(), val._text, term_freqs, val._weight );
+                _scoreStringV2( tokenizer.get(), val._text, term_freqs, val._weight,
+                                positions, &nextPosition );
             }
         }
 
         void FTSSpec::_scoreStringV2( FTSTokenizer* tokenizer,
                                       StringData raw,
                                       TermFrequencyMap* docScores,
-                                      double weight ) const {
+                                      double weight,
+                                      TermPositionsMap* positions,
+                                      unsigned* nextPosition ) const {
 
             ScoreHelperMap terms;
 
             unsigned numTokens = 0;
+            unsigned lastPosition = 0;
 
             tokenizer->reset(raw.rawData(), FTSTokenizer::FilterStopWords );
 
             while (tokenizer->moveNext()) {
                 string term = tokenizer->get().toString();
 
+                if ( positions ) {
+                    lastPosition = *nextPosition + tokenizer->getPosition();
+                    (*positions)[term].push_back( lastPosition );
+                }
+
                 ScoreHelperStruct& data = terms[term];
 
                 if ( data.exp ) {
@@ -222,6 +237,10 @@ namespace mongo {
                 score += ( weight * data.freq * coeff * adjustment );
                 verify( score <= MAX_WEIGHT );
             }
+
+            if ( positions && numTokens ) {
+                *nextPosition = lastPosition + 1 + FTSPositions::kStringGap;
+            }
         }
 
         Status FTSSpec::getIndexPrefix( const BSONObj& query, BSONObj* out ) const {
@@ -460,7 +479,8 @@ namespace mongo {
                     textIndexVersion = e.numberInt();
                     uassert( 16730,
                              str::stream() << "bad textIndexVersion: " << textIndexVersion,
-                             textIndexVersion == TEXT_INDEX_VERSION_2 );
+                             textIndexVersion == TEXT_INDEX_VERSION_2 ||
+                                 textIndexVersion == TEXT_INDEX_VERSION_3 );
                 }
                 else {
                     b.append( e );
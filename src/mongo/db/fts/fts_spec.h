@@ -35,6 +35,7 @@
 #include <string>
 
 #include "mongo/db/fts/fts_language.h"
+#include "mongo/db/fts/fts_positions.h"
 #include "mongo/db/fts/fts_util.h"
 #include "mongo/db/fts/stemmer.h"
 #include "mongo/db/fts/stop_words.h"
@@ -94,8 +95,12 @@ namespace mongo {
              * Calculates term/score pairs for a BSONObj as applied to this spec.
              * @arg obj  document to traverse; can be a subdocument or array
              * @arg term_freqs  output parameter to store (term,score) results
+             * @arg positions  if not NULL, output parameter to store the positions of each term;
+             *                 not supported for TEXT_INDEX_VERSION_1
              */
-            void scoreDocument( const BSONObj& obj, TermFrequencyMap* term_freqs ) const;
+            void scoreDocument( const BSONObj& obj,
+                                TermFrequencyMap* term_freqs,
+                                TermPositionsMap* positions = NULL ) const;
 
             /**
              * given a query, pulls out the pieces (in order) that go in the index first
@@ -112,17 +117,22 @@ namespace mongo {
 
         private:
             //
-            // Helper methods.  Invoked for TEXT_INDEX_VERSION_2 spec objects only.
+            // Helper methods.  Invoked for TEXT_INDEX_VERSION_2 and TEXT_INDEX_VERSION_3 spec
+            // objects only.
             //
 
             /**
              * Calculate the term scores for 'raw' and update 'term_freqs' with the result.  Parses
-             * 'raw' using 'tools', and weights term scores based on 'weight'.
+             * 'raw' using 'tools', and weights term scores based on 'weight'.  If 'positions' is
+             * not NULL, also appends the positions of the terms, counting from '*nextPosition',
+             * and advances '*nextPosition' past the end of 'raw'.
              */
             void _scoreStringV2( FTSTokenizer* tokenizer,
                                  StringData raw,
                                  TermFrequencyMap* term_freqs,
-                                 double weight ) const;
+                                 double weight,
+                                 TermPositionsMap* positions,
+                                 unsigned* nextPosition ) const;
 
         public:
             /**
@@ -86,6 +86,12 @@ namespace fts {
          * Returned StringData is valid until next call to moveNext().
          */
         virtual StringData get() const = 0;
+
+        /**
+         * Returns the position of the current token in the document, counting every token of
+         * the document (including stop words and delimiters) from 0.
+         */
+        virtual unsigned getPosition() const = 0;
     };
 
 } // namespace fts
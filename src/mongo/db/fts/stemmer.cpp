@@ -32,18 +32,39 @@
 #include <string>
 
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
+namespace {
+
+    /**
+     * The stems of the words a thread has seen, by language.  Languages are singletons, so they
+     * are keyed by address.  Once full, the cache starts over.
+     */
+    struct StemCache {
+        StemCache() : numStems(0) { }
+
+        typedef unordered_map<std::string, std::string> Stems;
+        unordered_map<const fts::FTSLanguage*, Stems> stemsByLanguage;
+        size_t numStems;
+    };
+
+}  // namespace
+
+    TSP_DECLARE(StemCache, stemCache);
+    TSP_DEFINE(StemCache, stemCache);
+
     namespace fts {
 
         using std::string;
 
-        Stemmer::Stemmer( const FTSLanguage* language ) {
-            _stemmer = NULL;
-            if ( language->str() != "none" )
-                _stemmer = sb_stemmer_new(language->str().c_str(), "UTF_8");
+        const size_t Stemmer::kMaxCachedStemsPerThread = 16 * 1024;
+
+        Stemmer::Stemmer( const FTSLanguage* language )
+            : _language( language ), _stemmer( NULL ) {
         }
 
         Stemmer::~Stemmer() {
@@ -54,9 +75,22 @@ namespace mongo {
         }
 
         string Stemmer::stem( StringData word ) const {
-            if ( !_stemmer )
+            if ( _language->str() == "none" )
                 return word.toString();
 
+            StemCache* cache = stemCache.getMake();
+            StemCache::Stems* stems = &cache->stemsByLanguage[_language];
+            const string key = word.toString();
+            StemCache::Stems::const_iterator it = stems->find( key );
+            if ( it != stems->end() )
+                return it->second;
+
+            if ( !_stemmer ) {
+                _stemmer = sb_stemmer_new(_language->str().c_str(), "UTF_8");
+                if ( !_stemmer )
+                    return word.toString();
+            }
+
             const sb_symbol* sb_sym = sb_stemmer_stem( _stemmer,
                                                        (const sb_symbol*)word.rawData(),
                                                        word.size() );
@@ -66,7 +100,16 @@ namespace mongo {
                 invariant( false );
             }
 
-            return string( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
+            const string stemmed( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
+
+            if ( cache->numStems >= kMaxCachedStemsPerThread ) {
+                cache->stemsByLanguage.clear();
+                cache->numStems = 0;
+                stems = &cache->stemsByLanguage[_language];
+            }
+            ( *stems )[key] = stemmed;
+            cache->numStems++;
+            return stemmed;
         }
 
     }
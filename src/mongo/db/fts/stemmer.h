@@ -45,6 +45,9 @@ namespace mongo {
          * maintains case
          * but works
          * running/Running -> run/Run
+         *
+         * Each thread remembers the stems of the words it has seen most recently, for each
+         * language, so that repeated words are only stemmed once.
          */
         class Stemmer {
             MONGO_DISALLOW_COPYING( Stemmer );
@@ -53,8 +56,17 @@ namespace mongo {
             ~Stemmer();
 
             std::string stem( StringData word ) const;
+
+            /**
+             * Maximum number of stems each thread keeps, over all languages.
+             */
+            static const size_t kMaxCachedStemsPerThread;
+
         private:
-            struct sb_stemmer* _stemmer;
+            const FTSLanguage* _language;
+
+            // Created the first time a word isn't found in the cache.
+            mutable struct sb_stemmer* _stemmer;
         };
     }
 }
@@ -33,6 +33,7 @@
 
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/fts/stemmer.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
     namespace fts {
@@ -49,5 +50,35 @@ namespace mongo {
             ASSERT_EQUALS( "Unite", s.stem( "United" ) );
         }
 
+        TEST( English, RepeatedWordsKeepTheirStems ) {
+            Stemmer s( &languageEnglishV2 );
+            for ( int i = 0; i < 3; i++ ) {
+                ASSERT_EQUALS( "run", s.stem( "running" ) );
+                ASSERT_EQUALS( "Run", s.stem( "Running" ) );
+            }
+
+            // Another stemmer for the same language sees the same stems.
+            Stemmer other( &languageEnglishV2 );
+            ASSERT_EQUALS( "run", other.stem( "running" ) );
+        }
+
+        TEST( Stemmer, CachedStemsAreKeptApartByLanguage ) {
+            Stemmer english( &languageEnglishV2 );
+            Stemmer french( &languageFrenchV2 );
+            ASSERT_EQUALS( "run", english.stem( "running" ) );
+            ASSERT_EQUALS( "running", french.stem( "running" ) );
+            ASSERT_EQUALS( "continu", english.stem( "continuous" ) );
+            ASSERT_EQUALS( "continuous", french.stem( "continuous" ) );
+        }
+
+        TEST( Stemmer, StemsAreRightAfterTheCacheFillsUp ) {
+            Stemmer s( &languageEnglishV2 );
+            for ( size_t i = 0; i < Stemmer::kMaxCachedStemsPerThread + 10; i++ ) {
+                s.stem( std::string( mongoutils::str::stream() << "word" << i << "ing" ) );
+            }
+            ASSERT_EQUALS( "run", s.stem( "running" ) );
+            ASSERT_EQUALS( "run", s.stem( "running" ) );
+        }
+
     }
 }
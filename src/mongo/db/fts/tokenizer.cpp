@@ -28,9 +28,18 @@
 *    it in the license file.
 */
 
-#include <string>
+#include "mongo/platform/basic.h"
 
 #include "mongo/db/fts/tokenizer.h"
+
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MONGO_FTS_TOKENIZER_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#include "mongo/platform/bits.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stringutils.h"
 
@@ -57,9 +66,14 @@ namespace mongo {
             Token::Type type = _type( _raw[start] );
             if ( type == Token::WHITESPACE ) invariant( false );
 
-            if ( type == Token::TEXT )
-                while ( _pos < _raw.size() && _type( _raw[_pos] ) == type )
+            if ( type == Token::TEXT ) {
+                while ( true ) {
+                    _pos = _skipPlainText( _pos );
+                    if ( _pos >= _raw.size() || _type( _raw[_pos] ) != type )
+                        break;
                     _pos++;
+                }
+            }
 
             StringData ret = _raw.substr( start, _pos - start );
             bool old = _previousWhiteSpace;
@@ -76,6 +90,37 @@ namespace mongo {
         }
 
 
+        unsigned Tokenizer::_skipPlainText( unsigned pos ) const {
+#ifdef MONGO_FTS_TOKENIZER_USE_SSE2
+            const char* data = _raw.rawData();
+            const __m128i caseBit = _mm_set1_epi8( 0x20 );
+            const __m128i beforeA = _mm_set1_epi8( 'a' - 1 );
+            const __m128i afterZ = _mm_set1_epi8( 'z' + 1 );
+            const __m128i before0 = _mm_set1_epi8( '0' - 1 );
+            const __m128i after9 = _mm_set1_epi8( '9' + 1 );
+
+            for ( ; pos + 16 <= _raw.size(); pos += 16 ) {
+                const __m128i v =
+                    _mm_loadu_si128( reinterpret_cast<const __m128i*>( data + pos ) );
+
+                // The comparisons are signed, so bytes with the high bit set, which are part of
+                // multi-byte characters, are neither letters nor digits.  They are picked up
+                // directly by the movemask of 'v'.
+                const __m128i lower = _mm_or_si128( v, caseBit );
+                const __m128i letters = _mm_and_si128( _mm_cmpgt_epi8( lower, beforeA ),
+                                                       _mm_cmplt_epi8( lower, afterZ ) );
+                const __m128i digits = _mm_and_si128( _mm_cmpgt_epi8( v, before0 ),
+                                                      _mm_cmplt_epi8( v, after9 ) );
+                const unsigned plain =
+                    _mm_movemask_epi8( _mm_or_si128( letters, digits ) ) | _mm_movemask_epi8( v );
+                if ( plain != 0xffff ) {
+                    return pos + countTrailingZeros64( ~plain & 0xffff );
+                }
+            }
+#endif
+            return pos;
+        }
+
         Token::Type Tokenizer::_type( char c ) const {
             switch ( c ) {
             case ' ':
@@ -137,6 +182,29 @@ namespace mongo {
             }
         }
 
+        std::string tolowerASCII( StringData str ) {
+            std::string lower( str.rawData(), str.size() );
+            size_t i = 0;
+#ifdef MONGO_FTS_TOKENIZER_USE_SSE2
+            const __m128i beforeUpperA = _mm_set1_epi8( 'A' - 1 );
+            const __m128i afterUpperZ = _mm_set1_epi8( 'Z' + 1 );
+            const __m128i caseBit = _mm_set1_epi8( 0x20 );
+            for ( ; i + 16 <= lower.size(); i += 16 ) {
+                __m128i* chunk = reinterpret_cast<__m128i*>( &lower[i] );
+                const __m128i v = _mm_loadu_si128( chunk );
+                const __m128i upper = _mm_and_si128( _mm_cmpgt_epi8( v, beforeUpperA ),
+                                                     _mm_cmplt_epi8( v, afterUpperZ ) );
+                _mm_storeu_si128( chunk, _mm_or_si128( v, _mm_and_si128( upper, caseBit ) ) );
+            }
+#endif
+            for ( ; i < lower.size(); i++ ) {
+                const char c = lower[i];
+                if ( c >= 'A' && c <= 'Z' )
+                    lower[i] = c + ( 'a' - 'A' );
+            }
+            return lower;
+        }
+
     }
 
 }
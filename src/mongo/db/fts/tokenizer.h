@@ -71,12 +71,25 @@ namespace mongo {
             Token::Type _type( char c ) const;
             bool _skipWhitespace();
 
+            /**
+             * Returns the position of the first byte at or after 'pos' which isn't an ASCII
+             * letter, an ASCII digit or part of a multi-byte UTF-8 character.  Such bytes are
+             * TEXT in every language, so runs of them don't need to be classified one by one.
+             */
+            unsigned _skipPlainText( unsigned pos ) const;
+
             unsigned _pos;
             bool _previousWhiteSpace;
             const StringData _raw;
             bool _english;
         };
 
+        /**
+         * Returns 'str' with its ASCII letters lower cased, which is what tolowerString() does
+         * in the "C" locale the server runs in.
+         */
+        std::string tolowerASCII( StringData str );
+
     }
 }
 
@@ -126,6 +126,48 @@ namespace mongo {
             ASSERT_EQUALS( "car", c.data.toString() );
         }
 
+
+        TEST( Tokenizer, LongWords ) {
+            // Words longer than the chunks the tokenizer scans at once, ending at every offset.
+            for ( size_t length = 1; length < 40; length++ ) {
+                std::string word;
+                for ( size_t j = 0; j < length; j++ ) {
+                    word += "aZ9\xc3\xa9_"[j % 6];
+                }
+                const std::string text = word + "-" + word + "'s " + word;
+                Tokenizer i( &languageFrenchV2, text );
+
+                ASSERT_EQUALS( word, i.next().data.toString() );
+                ASSERT_EQUALS( "-", i.next().data.toString() );
+                ASSERT_EQUALS( word, i.next().data.toString() );
+                ASSERT_EQUALS( "s", i.next().data.toString() );
+                ASSERT_EQUALS( word, i.next().data.toString() );
+                ASSERT( !i.more() );
+            }
+        }
+
+        TEST( Tokenizer, LongEnglishWordsWithQuotes ) {
+            Tokenizer i( &languageEnglishV2,
+                         "abcdefghijklmnopqrstuvwxyz's,0123456789012345678' x" );
+
+            ASSERT_EQUALS( "abcdefghijklmnopqrstuvwxyz's", i.next().data.toString() );
+            ASSERT_EQUALS( ",", i.next().data.toString() );
+            ASSERT_EQUALS( "0123456789012345678'", i.next().data.toString() );
+            ASSERT_EQUALS( "x", i.next().data.toString() );
+            ASSERT( !i.more() );
+        }
+
+        TEST( Tokenizer, LowerASCII ) {
+            ASSERT_EQUALS( "", tolowerASCII( "" ) );
+            ASSERT_EQUALS( "abc", tolowerASCII( "AbC" ) );
+            ASSERT_EQUALS( "the quick brown fox jumps over the lazy dog @[`{",
+                           tolowerASCII( "The QUICK Brown Fox Jumps Over The Lazy DOG @[`{" ) );
+
+            // Only ASCII letters are lower cased.
+            ASSERT_EQUALS( "\xc3\x89" "cole \xc3\x89" "cole \xc3\xa9" "cole",
+                           tolowerASCII( "\xc3\x89" "COLE \xc3\x89" "cole \xc3\xa9" "Cole" ) );
+        }
+
     }
 }
 
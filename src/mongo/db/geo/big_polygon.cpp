@@ -176,6 +176,10 @@ namespace mongo {
         return *_borderPoly;
     }
 
+    const S2Loop& BigSimplePolygon::GetLoop() const {
+        return *_loop;
+    }
+
     const S2Polyline& BigSimplePolygon::GetLineBorder() const {
         if (_borderLine)
             return *_borderLine;
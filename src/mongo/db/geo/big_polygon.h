@@ -80,6 +80,8 @@ namespace mongo {
 
         const S2Polyline& GetLineBorder() const;
 
+        const S2Loop& GetLoop() const;
+
         //
         // S2Region interface
         //
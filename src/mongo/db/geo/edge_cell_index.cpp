@@ -0,0 +1,316 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/geo/edge_cell_index.h"
+
+#include <algorithm>
+#include <boost/thread/lock_guard.hpp>
+#include <boost/thread/mutex.hpp>
+#include <memory>
+#include <string>
+
+#include "mongo/db/query/lru_key_value.h"
+#include "third_party/s2/s2cap.h"
+#include "third_party/s2/s2edgeutil.h"
+
+namespace mongo {
+
+namespace {
+
+    // A cell with more edges than this is split, unless it is already this small.
+    const size_t kMaxEdgesPerCell = 16;
+    const int kMaxCellLevel = 24;
+
+    // Widens the radius within which edges are considered to pass through a cell, so that no
+    // edge is missed because of rounding.
+    const double kRadiusSlackRadians = 1e-12;
+
+    // Upper bounds on the indexes kept for reuse by later queries.
+    const size_t kMaxCachedIndexes = 128;
+    const size_t kMaxCacheBytes = 64 * 1024 * 1024;
+
+    struct CachedIndex {
+        boost::shared_ptr<const EdgeCellIndex> index;
+        size_t bytes;
+    };
+
+    typedef LRUKeyValue<std::string, CachedIndex> IndexCache;
+
+    // Protects everything below.
+    boost::mutex indexCacheMutex;
+    IndexCache indexCache(kMaxCachedIndexes);
+    size_t indexCacheBytes = 0;
+
+    S1Angle cellRadius(const S2Cell& cell) {
+        return S1Angle::Radians(cell.GetCapBound().angle().radians() + kRadiusSlackRadians);
+    }
+
+    void appendLoopKey(const S2Loop& loop, std::string* key) {
+        const int numVertices = loop.num_vertices();
+        key->append(reinterpret_cast<const char*>(&numVertices), sizeof(numVertices));
+        for (int i = 0; i < numVertices; ++i) {
+            key->append(reinterpret_cast<const char*>(&loop.vertex(i)), sizeof(S2Point));
+        }
+    }
+
+    std::string polygonKey(const S2Polygon& polygon) {
+        std::string key("P");
+        for (int i = 0; i < polygon.num_loops(); ++i) {
+            appendLoopKey(*polygon.loop(i), &key);
+        }
+        return key;
+    }
+
+    std::string loopKey(const S2Loop& loop) {
+        std::string key("L");
+        appendLoopKey(loop, &key);
+        return key;
+    }
+
+    boost::shared_ptr<const EdgeCellIndex> findCached(const std::string& key) {
+        boost::lock_guard<boost::mutex> lk(indexCacheMutex);
+        CachedIndex* cached;
+        if (indexCache.get(key, &cached).isOK()) {
+            return cached->index;
+        }
+        return boost::shared_ptr<const EdgeCellIndex>();
+    }
+
+    template <typename Region>
+    boost::shared_ptr<const EdgeCellIndex> getCached(const std::string& key,
+                                                     const Region& region) {
+        boost::shared_ptr<const EdgeCellIndex> found = findCached(key);
+        if (found) {
+            return found;
+        }
+
+        // Built without holding the lock, so concurrent queries aren't held up by it.
+        boost::shared_ptr<const EdgeCellIndex> index(new EdgeCellIndex(region));
+
+        std::auto_ptr<CachedIndex> entry(new CachedIndex());
+        entry->index = index;
+        entry->bytes = key.size() + index->memUsage();
+        if (entry->bytes > kMaxCacheBytes / 8) {
+            // Not worth pushing out many smaller indexes for.
+            return index;
+        }
+
+        boost::lock_guard<boost::mutex> lk(indexCacheMutex);
+        if (indexCache.hasKey(key)) {
+            // Another query got here first.
+            return index;
+        }
+
+        indexCacheBytes += entry->bytes;
+        std::auto_ptr<CachedIndex> evicted = indexCache.add(key, entry.release());
+        if (evicted.get()) {
+            indexCacheBytes -= evicted->bytes;
+        }
+
+        while (indexCacheBytes > kMaxCacheBytes) {
+            IndexCache::KVListConstIt oldest = indexCache.end();
+            --oldest;
+            indexCacheBytes -= oldest->second->bytes;
+            const std::string oldestKey = oldest->first;
+            indexCache.remove(oldestKey);
+        }
+
+        return index;
+    }
+
+} // namespace
+
+    boost::shared_ptr<const EdgeCellIndex> EdgeCellIndex::get(const S2Polygon& polygon) {
+        if (polygon.num_vertices() < kMinVertices) {
+            return boost::shared_ptr<const EdgeCellIndex>();
+        }
+
+        return getCached(polygonKey(polygon), polygon);
+    }
+
+    boost::shared_ptr<const EdgeCellIndex> EdgeCellIndex::get(const S2Loop& loop) {
+        if (loop.num_vertices() < kMinVertices) {
+            return boost::shared_ptr<const EdgeCellIndex>();
+        }
+
+        return getCached(loopKey(loop), loop);
+    }
+
+    boost::shared_ptr<const EdgeCellIndex> EdgeCellIndex::find(const S2Polygon& polygon) {
+        if (polygon.num_vertices() < kMinVertices) {
+            return boost::shared_ptr<const EdgeCellIndex>();
+        }
+        return findCached(polygonKey(polygon));
+    }
+
+    boost::shared_ptr<const EdgeCellIndex> EdgeCellIndex::find(const S2Loop& loop) {
+        if (loop.num_vertices() < kMinVertices) {
+            return boost::shared_ptr<const EdgeCellIndex>();
+        }
+        return findCached(loopKey(loop));
+    }
+
+    EdgeCellIndex::EdgeCellIndex(const S2Polygon& polygon) : _numCellEdges(0) {
+        for (int i = 0; i < polygon.num_loops(); ++i) {
+            addLoopEdges(*polygon.loop(i));
+        }
+        build(polygon);
+    }
+
+    EdgeCellIndex::EdgeCellIndex(const S2Loop& loop) : _numCellEdges(0) {
+        addLoopEdges(loop);
+        build(loop);
+    }
+
+    void EdgeCellIndex::addLoopEdges(const S2Loop& loop) {
+        for (int i = 0; i < loop.num_vertices(); ++i) {
+            Edge edge;
+            edge.from = loop.vertex(i);
+            edge.to = loop.vertex(i + 1);
+            _edges.push_back(edge);
+        }
+    }
+
+    template <typename Region>
+    void EdgeCellIndex::build(const Region& region) {
+        std::vector<int> all(_edges.size());
+        for (size_t i = 0; i < all.size(); ++i) {
+            all[i] = i;
+        }
+
+        // Only the centers of the faces are tested against the whole region. Every other cell
+        // center is found from its parent's by counting the edges crossed in between.
+        // Faces and their children are visited in order, which leaves _cells sorted by id.
+        for (int face = 0; face < 6; ++face) {
+            S2Cell faceCell(S2CellId::FromFacePosLevel(face, 0, 0));
+            split(faceCell, region.Contains(faceCell.GetCenter()), all);
+        }
+    }
+
+    void EdgeCellIndex::split(const S2Cell& cell,
+                              bool centerInside,
+                              const std::vector<int>& candidates) {
+        const S2Point center = cell.GetCenter();
+        const S1Angle radius = cellRadius(cell);
+
+        std::vector<int> edges;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            const Edge& edge = _edges[candidates[i]];
+            if (S2EdgeUtil::GetDistance(center, edge.from, edge.to) <= radius) {
+                edges.push_back(candidates[i]);
+            }
+        }
+
+        if (edges.size() <= kMaxEdgesPerCell || cell.level() >= kMaxCellLevel) {
+            _cells.push_back(Cell());
+            Cell& indexed = _cells.back();
+            indexed.id = cell.id();
+            indexed.centerInside = centerInside;
+            indexed.edges.swap(edges);
+            _numCellEdges += indexed.edges.size();
+            return;
+        }
+
+        // Cells are convex, so any edge crossing the way from our center to a child's passes
+        // through this cell.
+        S2Cell children[4];
+        cell.Subdivide(children);
+        for (int i = 0; i < 4; ++i) {
+            const S2Point childCenter = children[i].GetCenter();
+            bool childCenterInside = centerInside;
+            for (size_t j = 0; j < edges.size(); ++j) {
+                const Edge& edge = _edges[edges[j]];
+                childCenterInside ^=
+                    S2EdgeUtil::EdgeOrVertexCrossing(center, childCenter, edge.from, edge.to);
+            }
+            split(children[i], childCenterInside, edges);
+        }
+    }
+
+    const EdgeCellIndex::Cell& EdgeCellIndex::findCell(const S2Point& point) const {
+        const S2CellId leaf = S2CellId::FromPoint(point);
+
+        // The cells partition the sphere, so the first one ending at or after 'leaf' holds it.
+        size_t lo = 0;
+        size_t hi = _cells.size() - 1;
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (_cells[mid].id.range_max() < leaf) {
+                lo = mid + 1;
+            }
+            else {
+                hi = mid;
+            }
+        }
+        return _cells[lo];
+    }
+
+    bool EdgeCellIndex::containsInCell(const Cell& cell, const S2Point& point) const {
+        const S2Point center = cell.id.ToPoint();
+        if (point == center) {
+            return cell.centerInside;
+        }
+
+        bool inside = cell.centerInside;
+        for (size_t i = 0; i < cell.edges.size(); ++i) {
+            const Edge& edge = _edges[cell.edges[i]];
+            inside ^= S2EdgeUtil::EdgeOrVertexCrossing(center, point, edge.from, edge.to);
+        }
+        return inside;
+    }
+
+    bool EdgeCellIndex::contains(const S2Point& point) const {
+        return containsInCell(findCell(point), point);
+    }
+
+    bool EdgeCellIndex::mayIntersect(const S2Cell& leafCell) const {
+        const S2Point center = leafCell.GetCenter();
+        const Cell& cell = findCell(center);
+        if (containsInCell(cell, center)) {
+            return true;
+        }
+
+        // Any edge touching the leaf cell passes through the indexed cell holding it.
+        const S1Angle radius = cellRadius(leafCell);
+        for (size_t i = 0; i < cell.edges.size(); ++i) {
+            const Edge& edge = _edges[cell.edges[i]];
+            if (S2EdgeUtil::GetDistance(center, edge.from, edge.to) <= radius) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t EdgeCellIndex::memUsage() const {
+        return sizeof(*this) + _edges.capacity() * sizeof(Edge) + _cells.capacity() * sizeof(Cell)
+               + _numCellEdges * sizeof(int);
+    }
+
+} // namespace mongo
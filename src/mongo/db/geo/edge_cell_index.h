@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/geo/s2.h"
+#include "third_party/s2/s2cell.h"
+#include "third_party/s2/s2cellid.h"
+#include "third_party/s2/s2loop.h"
+#include "third_party/s2/s2polygon.h"
+
+namespace mongo {
+
+    /**
+     * The edges of a polygon, or of a big polygon's loop, bucketed by the S2 cells they pass
+     * through. Each cell also knows whether its center is inside, so a point is tested only
+     * against the few edges between it and the center of its cell instead of against every edge
+     * of the polygon.
+     *
+     * An index can't be changed once built, and may be shared by any number of threads. get()
+     * keeps the indexes of large polygons for reuse by every query on the same geometry.
+     */
+    class EdgeCellIndex {
+        MONGO_DISALLOW_COPYING(EdgeCellIndex);
+    public:
+
+        // Polygons with fewer vertices than this aren't worth indexing.
+        static const int kMinVertices = 128;
+
+        /**
+         * Returns the index of 'polygon', building it unless an equal polygon was recently
+         * indexed. Returns NULL if the polygon is too small to need one.
+         */
+        static boost::shared_ptr<const EdgeCellIndex> get(const S2Polygon& polygon);
+
+        /**
+         * Returns the index of 'loop', whose inside is to its left regardless of its area, as in
+         * a BigSimplePolygon. Returns NULL if the loop is too small to need one.
+         */
+        static boost::shared_ptr<const EdgeCellIndex> get(const S2Loop& loop);
+
+        /**
+         * Like get(), but returns NULL instead of building an index which isn't kept for reuse.
+         */
+        static boost::shared_ptr<const EdgeCellIndex> find(const S2Polygon& polygon);
+        static boost::shared_ptr<const EdgeCellIndex> find(const S2Loop& loop);
+
+        explicit EdgeCellIndex(const S2Polygon& polygon);
+        explicit EdgeCellIndex(const S2Loop& loop);
+
+        /**
+         * Same as the Contains() of the indexed polygon or loop.
+         */
+        bool contains(const S2Point& point) const;
+
+        /**
+         * Same as the MayIntersect() of the indexed polygon or loop, for a leaf cell: whether
+         * the cell's center is inside, or any edge passes close enough to touch the cell.
+         */
+        bool mayIntersect(const S2Cell& leafCell) const;
+
+        /**
+         * Approximate memory used by the index.
+         */
+        size_t memUsage() const;
+
+    private:
+
+        struct Edge {
+            S2Point from;
+            S2Point to;
+        };
+
+        struct Cell {
+            S2CellId id;
+            bool centerInside;
+            // Offsets into _edges of the edges which may pass through the cell.
+            std::vector<int> edges;
+        };
+
+        template <typename Region>
+        void build(const Region& region);
+
+        void addLoopEdges(const S2Loop& loop);
+
+        // Buckets 'candidates', the edges which may pass through the parent of 'cell', into the
+        // descendants of 'cell'.
+        void split(const S2Cell& cell, bool centerInside, const std::vector<int>& candidates);
+
+        const Cell& findCell(const S2Point& point) const;
+
+        // Whether 'point' is inside, given the cell it lies in.
+        bool containsInCell(const Cell& cell, const S2Point& point) const;
+
+        std::vector<Edge> _edges;
+
+        // Cells partitioning the sphere, ordered by id.
+        std::vector<Cell> _cells;
+        size_t _numCellEdges;
+    };
+
+} // namespace mongo
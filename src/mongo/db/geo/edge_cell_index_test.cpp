@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/geo/edge_cell_index.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <cmath>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "third_party/s2/s2latlng.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::vector;
+
+    // A star-shaped loop of 'numVertices' vertices around (lat, lng), with 'numArms' arms.
+    S2Loop* starLoop(double lat, double lng, double radiusDegrees, int numVertices, int numArms) {
+        vector<S2Point> points;
+        for (int i = 0; i < numVertices; ++i) {
+            const double angle = 2 * M_PI * i / numVertices;
+            const double r = radiusDegrees * (1 + 0.3 * sin(numArms * angle));
+            points.push_back(
+                S2LatLng::FromDegrees(lat + r * sin(angle), lng + r * cos(angle)).ToPoint());
+        }
+        S2Loop* loop = new S2Loop(points);
+        loop->Normalize();
+        return loop;
+    }
+
+    double randomUnit(PseudoRandom* random) {
+        return static_cast<double>(random->nextInt32() & 0x7fffffff) / 0x7fffffff;
+    }
+
+    // Points around (lat, lng), and some anywhere on the sphere.
+    vector<S2Point> testPoints(double lat, double lng, double spreadDegrees) {
+        PseudoRandom random(12345);
+        vector<S2Point> points;
+        for (int i = 0; i < 4000; ++i) {
+            points.push_back(S2LatLng::FromDegrees(
+                lat + spreadDegrees * (2 * randomUnit(&random) - 1),
+                lng + spreadDegrees * (2 * randomUnit(&random) - 1)).ToPoint());
+        }
+        for (int i = 0; i < 1000; ++i) {
+            points.push_back(S2LatLng::FromDegrees(180 * randomUnit(&random) - 90,
+                                                   360 * randomUnit(&random) - 180).ToPoint());
+        }
+        return points;
+    }
+
+    template <typename Region>
+    void assertSameAnswers(const Region& region, const EdgeCellIndex& index,
+                           const vector<S2Point>& points) {
+        int numInside = 0;
+        for (size_t i = 0; i < points.size(); ++i) {
+            const bool inside = region.Contains(points[i]);
+            ASSERT_EQUALS(inside, index.contains(points[i]));
+            numInside += inside;
+
+            const S2Cell cell(points[i]);
+            ASSERT_EQUALS(region.MayIntersect(cell), index.mayIntersect(cell));
+        }
+        ASSERT_GREATER_THAN(numInside, 0);
+        ASSERT_LESS_THAN(numInside, static_cast<int>(points.size()));
+    }
+
+    TEST(EdgeCellIndex, MatchesPolygon) {
+        vector<S2Loop*> loops;
+        loops.push_back(starLoop(40, -70, 1.0, 2000, 7));
+        S2Polygon polygon(&loops);
+
+        EdgeCellIndex index(polygon);
+        assertSameAnswers(polygon, index, testPoints(40, -70, 1.5));
+    }
+
+    TEST(EdgeCellIndex, MatchesPolygonWithHoleAndShells) {
+        vector<S2Loop*> loops;
+        loops.push_back(starLoop(10, 20, 2.0, 1000, 5));
+        loops.push_back(starLoop(10, 20, 0.5, 300, 3));
+        loops.push_back(starLoop(10, 25.5, 0.5, 500, 11));
+        S2Polygon polygon(&loops);
+        ASSERT_EQUALS(3, polygon.num_loops());
+
+        EdgeCellIndex index(polygon);
+        assertSameAnswers(polygon, index, testPoints(10, 22, 4));
+    }
+
+    TEST(EdgeCellIndex, MatchesBigLoop) {
+        // Everything but a star, which is more than a hemisphere.
+        boost::scoped_ptr<S2Loop> star(starLoop(-30, 100, 3.0, 1500, 9));
+        star->Invert();
+        ASSERT_GREATER_THAN(star->GetArea(), 2 * M_PI);
+
+        EdgeCellIndex index(*star);
+        assertSameAnswers(*star, index, testPoints(-30, 100, 4));
+    }
+
+    TEST(EdgeCellIndex, SharedByEqualPolygons) {
+        vector<S2Loop*> loops;
+        loops.push_back(starLoop(-5, -5, 1.0, 500, 4));
+        S2Polygon polygon(&loops);
+
+        vector<S2Loop*> sameLoops;
+        sameLoops.push_back(starLoop(-5, -5, 1.0, 500, 4));
+        S2Polygon samePolygon(&sameLoops);
+
+        vector<S2Loop*> otherLoops;
+        otherLoops.push_back(starLoop(-5, -5, 1.0, 501, 4));
+        S2Polygon otherPolygon(&otherLoops);
+
+        ASSERT_FALSE(EdgeCellIndex::find(polygon));
+        boost::shared_ptr<const EdgeCellIndex> index = EdgeCellIndex::get(polygon);
+        ASSERT(index);
+        ASSERT_EQUALS(index.get(), EdgeCellIndex::find(samePolygon).get());
+        ASSERT_EQUALS(index.get(), EdgeCellIndex::get(samePolygon).get());
+        ASSERT_NOT_EQUALS(index.get(), EdgeCellIndex::get(otherPolygon).get());
+
+        // A loop gets its own index, even with the same vertices as a polygon.
+        ASSERT_NOT_EQUALS(index.get(), EdgeCellIndex::get(*polygon.loop(0)).get());
+    }
+
+    TEST(EdgeCellIndex, NoneForSmallPolygons) {
+        vector<S2Loop*> loops;
+        loops.push_back(starLoop(0, 0, 1.0, EdgeCellIndex::kMinVertices - 1, 3));
+        S2Polygon polygon(&loops);
+        ASSERT_FALSE(EdgeCellIndex::get(polygon));
+        ASSERT_FALSE(EdgeCellIndex::get(*polygon.loop(0)));
+        ASSERT_FALSE(EdgeCellIndex::find(polygon));
+    }
+
+} // namespace
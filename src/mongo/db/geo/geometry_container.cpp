@@ -28,15 +28,58 @@
 
 #include "mongo/db/geo/geometry_container.h"
 
+#include "mongo/db/geo/edge_cell_index.h"
 #include "mongo/db/geo/geoconstants.h"
 #include "mongo/db/geo/geoparser.h"
 #include "mongo/util/mongoutils/str.h"
+#include "third_party/s2/s2regioncoverer.h"
 
 namespace mongo {
 
     using mongoutils::str::equals;
 
-    GeometryContainer::GeometryContainer() {
+namespace {
+
+    // Number of points tested against a polygon before its interior covering is built.
+    const int kPointTestsBeforeInteriorCovering = 32;
+
+    // Size of the interior covering. Points in one cell of it match without testing them
+    // against the edges of the polygon.
+    const int kInteriorCoveringMaxCells = 256;
+
+    // Number of points tested against a polygon before looking for an edge index kept by an
+    // earlier query, and before building one. Building an index of a polygon costs about as much
+    // as testing a few thousand points against it.
+    const int kPointTestsBeforeEdgeIndexLookup = 16;
+    const int kPointTestsBeforeEdgeIndexBuild = 1024;
+
+    // Tests a point, and the leaf cell holding it, against 'region' or its edge index.
+    template <typename Region>
+    bool containsPoint(const Region& region,
+                       const EdgeCellIndex* index,
+                       const S2Cell& otherCell,
+                       const S2Point& otherPoint) {
+        if (NULL != index && otherCell.is_leaf()) {
+            return index->contains(otherPoint) || index->mayIntersect(otherCell);
+        }
+        if (region.Contains(otherPoint)) { return true; }
+        return region.MayIntersect(otherCell);
+    }
+
+    template <typename Region>
+    bool mayIntersect(const Region& region, const EdgeCellIndex* index, const S2Cell& otherCell) {
+        if (NULL != index && otherCell.is_leaf()) {
+            return index->mayIntersect(otherCell);
+        }
+        return region.MayIntersect(otherCell);
+    }
+
+} // namespace
+
+    GeometryContainer::GeometryContainer()
+        : _numPointContainsTests(0),
+          _edgeIndexesLoaded(false),
+          _numEdgeIndexPointTests(0) {
     }
 
     bool GeometryContainer::isSimpleContainer() const {
@@ -375,15 +418,63 @@ namespace mongo {
         return poly.MayIntersect(otherCell);
     }
 
+    bool GeometryContainer::interiorContains(const S2Point& otherPoint) const {
+        if (!_interiorCovering) {
+            if (++_numPointContainsTests < kPointTestsBeforeInteriorCovering) {
+                return false;
+            }
+
+            S2RegionCoverer coverer;
+            coverer.set_max_cells(kInteriorCoveringMaxCells);
+            _interiorCovering.reset(new S2CellUnion());
+            coverer.GetInteriorCellUnion(*_polygon->s2Polygon, _interiorCovering.get());
+        }
+
+        return _interiorCovering->Contains(otherPoint);
+    }
+
+    template <typename Region>
+    boost::shared_ptr<const EdgeCellIndex> getEdgeIndex(const Region& region, bool build) {
+        return build ? EdgeCellIndex::get(region) : EdgeCellIndex::find(region);
+    }
+
+    const EdgeCellIndex* GeometryContainer::edgeIndex(size_t i) const {
+        if (!_edgeIndexesLoaded) {
+            ++_numEdgeIndexPointTests;
+            if (kPointTestsBeforeEdgeIndexLookup == _numEdgeIndexPointTests
+                || kPointTestsBeforeEdgeIndexBuild == _numEdgeIndexPointTests) {
+                const bool build = kPointTestsBeforeEdgeIndexBuild == _numEdgeIndexPointTests;
+                _edgeIndexesLoaded = build;
+                _edgeIndexes.clear();
+
+                if (NULL != _polygon && NULL != _polygon->s2Polygon) {
+                    _edgeIndexes.push_back(getEdgeIndex(*_polygon->s2Polygon, build));
+                }
+                else if (NULL != _polygon && NULL != _polygon->bigPolygon) {
+                    _edgeIndexes.push_back(getEdgeIndex(_polygon->bigPolygon->GetLoop(), build));
+                }
+                else if (NULL != _multiPolygon) {
+                    const vector<S2Polygon*>& polys = _multiPolygon->polygons.vector();
+                    for (size_t j = 0; j < polys.size(); ++j) {
+                        _edgeIndexes.push_back(getEdgeIndex(*polys[j], build));
+                    }
+                }
+            }
+        }
+
+        return i < _edgeIndexes.size() ? _edgeIndexes[i].get() : NULL;
+    }
+
     bool GeometryContainer::contains(const S2Cell& otherCell, const S2Point& otherPoint) const {
         if (NULL != _polygon && (NULL != _polygon->s2Polygon)) {
-            return containsPoint(*_polygon->s2Polygon, otherCell, otherPoint);
+            // Many points are usually tested against the same polygon, and the cell union
+            // answers for most of those inside it much faster than the polygon can.
+            if (interiorContains(otherPoint)) { return true; }
+            return containsPoint(*_polygon->s2Polygon, edgeIndex(0), otherCell, otherPoint);
         }
 
         if (NULL != _polygon && (NULL != _polygon->bigPolygon)) {
-            if (_polygon->bigPolygon->Contains(otherPoint))
-                return true;
-            return _polygon->bigPolygon->MayIntersect(otherCell);
+            return containsPoint(*_polygon->bigPolygon, edgeIndex(0), otherCell, otherPoint);
         }
 
         if (NULL != _cap && (_cap->crs == SPHERE)) {
@@ -393,7 +484,9 @@ namespace mongo {
         if (NULL != _multiPolygon) {
             const vector<S2Polygon*>& polys = _multiPolygon->polygons.vector();
             for (size_t i = 0; i < polys.size(); ++i) {
-                if (containsPoint(*polys[i], otherCell, otherPoint)) { return true; }
+                if (containsPoint(*polys[i], edgeIndex(i), otherCell, otherPoint)) {
+                    return true;
+                }
             }
         }
 
@@ -578,9 +671,9 @@ namespace mongo {
         } else if (NULL != _line) {
             return _line->line.MayIntersect(otherPoint);
         } else if (NULL != _polygon && NULL != _polygon->s2Polygon) {
-            return _polygon->s2Polygon->MayIntersect(otherPoint);
+            return mayIntersect(*_polygon->s2Polygon, edgeIndex(0), otherPoint);
         } else if (NULL != _polygon && NULL != _polygon->bigPolygon) {
-            return _polygon->bigPolygon->MayIntersect(otherPoint);
+            return mayIntersect(*_polygon->bigPolygon, edgeIndex(0), otherPoint);
         } else if (NULL != _multiPoint) {
             const vector<S2Cell>& cells = _multiPoint->cells;
             for (size_t i = 0; i < cells.size(); ++i) {
@@ -594,7 +687,7 @@ namespace mongo {
         } else if (NULL != _multiPolygon) {
             const vector<S2Polygon*>& polys = _multiPolygon->polygons.vector();
             for (size_t i = 0; i < polys.size(); ++i) {
-                if (polys[i]->MayIntersect(otherPoint)) { return true; }
+                if (mayIntersect(*polys[i], edgeIndex(i), otherPoint)) { return true; }
             }
         } else if (NULL != _geometryCollection) {
             const GeometryCollection& c = *_geometryCollection;
@@ -29,14 +29,19 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/geo/shapes.h"
+#include "third_party/s2/s2cellunion.h"
 #include "third_party/s2/s2regionunion.h"
 
 namespace mongo {
 
+    class EdgeCellIndex;
+
     class GeometryContainer {
         MONGO_DISALLOW_COPYING(GeometryContainer);
     public:
@@ -140,6 +145,14 @@ namespace mongo {
         bool contains(const S2Polyline& otherLine) const;
         bool contains(const S2Polygon& otherPolygon) const;
 
+        // Returns true if 'otherPoint' is in a cell known to be inside _polygon. False means
+        // nothing; the point has to be tested against the polygon itself.
+        bool interiorContains(const S2Point& otherPoint) const;
+
+        // Returns the edge index of the i-th polygon of _polygon or _multiPolygon, or NULL if
+        // points are to be tested against the polygon itself.
+        const EdgeCellIndex* edgeIndex(size_t i) const;
+
         // Only one of these shared_ptrs should be non-NULL.  S2Region is a
         // superclass but it only supports testing against S2Cells.  We need
         // the most specific class we can get.
@@ -157,6 +170,17 @@ namespace mongo {
         // TODO: _s2Region is currently generated immediately - don't necessarily need to do this
         boost::scoped_ptr<S2RegionUnion> _s2Region;
         boost::scoped_ptr<R2Region> _r2Region;
+
+        // Cells covering the interior of an S2 _polygon, built once enough points have been
+        // tested against it to pay for it. See interiorContains().
+        mutable boost::scoped_ptr<S2CellUnion> _interiorCovering;
+        mutable int _numPointContainsTests;
+
+        // Looked up, then built, once enough points have been tested to pay for it. Large
+        // polygons share their index with every other query on the same polygon. See edgeIndex().
+        mutable std::vector<boost::shared_ptr<const EdgeCellIndex> > _edgeIndexes;
+        mutable bool _edgeIndexesLoaded;
+        mutable int _numEdgeIndexPointTests;
     };
 
 } // namespace mongo
@@ -445,17 +445,19 @@ namespace mongo {
     }
 
     void GeoHash::appendHashMax(BSONObjBuilder* builder, const char* fieldName) const {
-        // The max bound of a GeoHash region has all the unused suffix bits set to 1
-        long long suffixMax = ~(geoBitSets.allX[_bits] | geoBitSets.allY[_bits]);
-        long long hashMax = _hash | suffixMax;
-
-        appendHashToBuilder(hashMax, builder, fieldName);
+        appendHashToBuilder(getHashMax(), builder, fieldName);
     }
 
     long long GeoHash::getHash() const {
         return _hash;
     }
 
+    long long GeoHash::getHashMax() const {
+        // The max bound of a GeoHash region has all the unused suffix bits set to 1
+        long long suffixMax = ~(geoBitSets.allX[_bits] | geoBitSets.allY[_bits]);
+        return _hash | suffixMax;
+    }
+
     unsigned GeoHash::getBits() const {
         return _bits;
     }
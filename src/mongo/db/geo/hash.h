@@ -114,6 +114,8 @@ namespace mongo {
         void appendHashMax(BSONObjBuilder* builder, const char* fieldName) const;
 
         long long getHash() const;
+        // The hash with all the unused suffix bits set to 1, the last hash within this cell.
+        long long getHashMax() const;
         unsigned getBits() const;
 
         GeoHash commonPrefix(const GeoHash& other) const;
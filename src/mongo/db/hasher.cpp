@@ -36,39 +36,45 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/bson/util/builder.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/startup_test.h"
+#include "third_party/murmurhash3/MurmurHash3.h"
 
 namespace mongo {
 
     using boost::scoped_ptr;
 
-    Hasher::Hasher( HashSeed seed ) : _seed( seed ) {
-        md5_init( &_md5State );
-        md5_append( &_md5State , reinterpret_cast< const md5_byte_t * >( & _seed ) , sizeof( _seed ) );
-    }
+namespace {
 
-    void Hasher::addData( const void * keyData , size_t numBytes ) {
-        md5_append( &_md5State , static_cast< const md5_byte_t * >( keyData ), numBytes );
-    }
+    /**
+     * Collects the same input a Hasher would digest, and hashes it in one go with MurmurHash3,
+     * which has no incremental interface.  Elements are small, so the input rarely leaves the
+     * stack.
+     */
+    class MurmurHasher : private boost::noncopyable {
+    public:
+        explicit MurmurHasher( HashSeed seed ) : _seed( seed ) { }
 
-    void Hasher::finish( HashDigest out ) {
-        md5_finish( &_md5State , out );
-    }
+        void addData( const void * keyData , size_t numBytes ) {
+            _buf.appendBuf( keyData , numBytes );
+        }
 
-    long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ){
-        scoped_ptr<Hasher> h( HasherFactory::createHasher( seed ) );
-        recursiveHash( h.get() , e , false );
-        HashDigest d;
-        h->finish(d);
-        //HashDigest is actually 16 bytes, but we just get 8 via truncation
-        // NOTE: assumes little-endian
-        return *reinterpret_cast< long long int * >( d );
-    }
+        long long int finish64() {
+            long long int out[2];
+            MurmurHash3_x64_128( _buf.buf() , _buf.len() , _seed , out );
+            return out[0];
+        }
 
-    void BSONElementHasher::recursiveHash( Hasher* h ,
-                                           const BSONElement& e ,
-                                           bool includeFieldName ) {
+    private:
+        StackBufBuilder _buf;
+        HashSeed _seed;
+    };
+
+    template <typename H>
+    void recursiveHashImpl( H* h , const BSONElement& e , bool includeFieldName ) {
 
         int canonicalType = e.canonicalType();
         h->addData( &canonicalType , sizeof( canonicalType ) );
@@ -104,16 +110,63 @@ namespace mongo {
             BSONObjIterator i(b);
             while( i.moreWithEOO() ) {
                 BSONElement el = i.next();
-                recursiveHash( h , el ,  true );
+                recursiveHashImpl( h , el ,  true );
             }
         }
     }
 
+} // namespace
+
+    Hasher::Hasher( HashSeed seed ) : _seed( seed ) {
+        md5_init( &_md5State );
+        md5_append( &_md5State , reinterpret_cast< const md5_byte_t * >( & _seed ) , sizeof( _seed ) );
+    }
+
+    void Hasher::addData( const void * keyData , size_t numBytes ) {
+        md5_append( &_md5State , static_cast< const md5_byte_t * >( keyData ), numBytes );
+    }
+
+    void Hasher::finish( HashDigest out ) {
+        md5_finish( &_md5State , out );
+    }
+
+    long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ){
+        scoped_ptr<Hasher> h( HasherFactory::createHasher( seed ) );
+        recursiveHash( h.get() , e , false );
+        HashDigest d;
+        h->finish(d);
+        //HashDigest is actually 16 bytes, but we just get 8 via truncation
+        // NOTE: assumes little-endian
+        return *reinterpret_cast< long long int * >( d );
+    }
+
+    long long int BSONElementHasher::hash64( const BSONElement& e ,
+                                             HashSeed seed ,
+                                             int hashVersion ) {
+        if ( hashVersion == HASH_VERSION_MD5 ) {
+            return hash64( e , seed );
+        }
+
+        massert( 28711 , mongoutils::str::stream() << "unknown hashVersion " << hashVersion ,
+                 hashVersion == HASH_VERSION_MURMUR3 );
+        MurmurHasher h( seed );
+        recursiveHashImpl( &h , e , false );
+        return h.finish64();
+    }
+
+    void BSONElementHasher::recursiveHash( Hasher* h ,
+                                           const BSONElement& e ,
+                                           bool includeFieldName ) {
+        recursiveHashImpl( h , e , includeFieldName );
+    }
+
     struct HasherUnitTest : public StartupTest {
         void run() {
             // Hard-coded check to ensure the hash function is consistent across platforms
             BSONObj o = BSON( "check" << 42 );
             verify( BSONElementHasher::hash64( o.firstElement(), 0 ) == -944302157085130861LL );
+            verify( BSONElementHasher::hash64( o.firstElement(), 0, 0 ) == -944302157085130861LL );
+            verify( BSONElementHasher::hash64( o.firstElement(), 0, 1 ) == 8715208212397937794LL );
         }
     } hasherUnitTest;
 }
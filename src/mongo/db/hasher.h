@@ -89,6 +89,21 @@ namespace mongo {
          */
         static const int DEFAULT_HASH_SEED = 0;
 
+        /* The versions of the hash function, as stored in the "hashVersion" field of hashed
+         * index specs. Version 0 truncates an MD5 digest and is the only one hashed sharding
+         * understands. Version 1 is the 64-bit half of MurmurHash3_x64_128 over the same
+         * input, which is several times cheaper to compute.
+         *
+         * WARNING: the output of an existing version must never change.
+         */
+        static const int HASH_VERSION_MD5 = 0;
+        static const int HASH_VERSION_MURMUR3 = 1;
+
+        /* Returns true if "hashVersion" names one of the versions above. */
+        static bool isValidHashVersion( int hashVersion ) {
+            return hashVersion == HASH_VERSION_MD5 || hashVersion == HASH_VERSION_MURMUR3;
+        }
+
         /* This computes a 64-bit hash of the value part of BSONElement "e",
          * preceded by the seed "seed".  Squashes element (and any sub-elements)
          * of the same canonical type, so hash({a:{b:4}}) will be the same
@@ -103,6 +118,11 @@ namespace mongo {
          */
         static long long int hash64( const BSONElement& e , HashSeed seed );
 
+        /* Same as above, using version "hashVersion" of the hash function, which must be
+         * valid (see isValidHashVersion).
+         */
+        static long long int hash64( const BSONElement& e , HashSeed seed , int hashVersion );
+
         /* This incrementally computes the hash of BSONElement "e"
          * using hash function "h".  If "includeFieldName" is true,
          * then the name of the field is hashed in between the type of
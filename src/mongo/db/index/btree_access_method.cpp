@@ -68,4 +68,24 @@ namespace mongo {
         _keyGenerator->getKeys(obj, keys);
     }
 
+    std::vector<std::string> BtreeAccessMethod::getExtractedPaths() const {
+        std::vector<std::string> paths;
+        if (!_keyGenerator->supportsExtractedFields()) {
+            return paths;
+        }
+
+        BSONObjIterator it(_descriptor->keyPattern());
+        while (it.more()) {
+            paths.push_back(it.next().fieldName());
+        }
+        return paths;
+    }
+
+    void BtreeAccessMethod::getKeysFromExtracted(const BSONObj& obj,
+                                                 const std::vector<BSONElement>& extracted,
+                                                 const std::vector<size_t>& remainingOffsets,
+                                                 BSONObjSet* keys) const {
+        _keyGenerator->getKeysFromExtracted(obj, extracted, remainingOffsets, keys);
+    }
+
 }  // namespace mongo
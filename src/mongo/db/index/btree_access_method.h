@@ -48,6 +48,13 @@ namespace mongo {
     public:
         BtreeAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree );
 
+        virtual std::vector<std::string> getExtractedPaths() const;
+
+        virtual void getKeysFromExtracted(const BSONObj& obj,
+                                          const std::vector<BSONElement>& extracted,
+                                          const std::vector<size_t>& remainingOffsets,
+                                          BSONObjSet* keys) const;
+
     private:
         virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
@@ -62,17 +62,7 @@ namespace {
     void BtreeKeyGenerator::getKeys(const BSONObj &obj, BSONObjSet *keys) const {
         if (_isIdIndex) {
             // we special case for speed
-            BSONElement e = obj["_id"];
-            if ( e.eoo() ) {
-                keys->insert(_nullKey);
-            }
-            else {
-                int size = e.size() + 5 /* bson over head*/ - 3 /* remove _id string */;
-                BSONObjBuilder b(size);
-                b.appendAs(e, "");
-                keys->insert(b.obj());
-                invariant(keys->begin()->objsize() == size);
-            }
+            getIdKey(obj["_id"], keys);
             return;
         }
 
@@ -84,6 +74,47 @@ namespace {
         }
     }
 
+    void BtreeKeyGenerator::getKeysFromExtracted(const BSONObj& obj,
+                                                 const std::vector<BSONElement>& extracted,
+                                                 const std::vector<size_t>& remainingOffsets,
+                                                 BSONObjSet* keys) const {
+        invariant(extracted.size() == _fieldNames.size());
+        invariant(remainingOffsets.size() == _fieldNames.size());
+
+        if (_isIdIndex) {
+            getIdKey(extracted[0], keys);
+            return;
+        }
+
+        getKeysImplFromExtracted(_fieldNames, _fixed, obj, extracted, remainingOffsets, keys);
+        if (keys->empty() && ! _isSparse) {
+            keys->insert(_nullKey);
+        }
+    }
+
+    void BtreeKeyGenerator::getKeysImplFromExtracted(
+            std::vector<const char*> fieldNames,
+            std::vector<BSONElement> fixed,
+            const BSONObj& obj,
+            const std::vector<BSONElement>& extracted,
+            const std::vector<size_t>& remainingOffsets,
+            BSONObjSet* keys) const {
+        invariant(false);
+    }
+
+    void BtreeKeyGenerator::getIdKey(const BSONElement& e, BSONObjSet* keys) const {
+        if ( e.eoo() ) {
+            keys->insert(_nullKey);
+        }
+        else {
+            int size = e.size() + 5 /* bson over head*/ - 3 /* remove _id string */;
+            BSONObjBuilder b(size);
+            b.appendAs(e, "");
+            keys->insert(b.obj());
+            invariant(keys->begin()->objsize() == size);
+        }
+    }
+
     static void assertParallelArrays( const char *first, const char *second ) {
         std::stringstream ss;
         ss << "cannot index parallel arrays [" << first << "] [" << second << "]";
@@ -214,11 +245,18 @@ namespace {
         }
     }
 
+    namespace {
+        std::vector<std::string> toStrings(const std::vector<const char*>& fieldNames) {
+            return std::vector<std::string>(fieldNames.begin(), fieldNames.end());
+        }
+    }  // namespace
+
     BtreeKeyGeneratorV1::BtreeKeyGeneratorV1(std::vector<const char*> fieldNames,
                                              std::vector<BSONElement> fixed,
                                              bool isSparse)
         : BtreeKeyGenerator(fieldNames, fixed, isSparse),
-          _emptyPositionalInfo(fieldNames.size()) {
+          _emptyPositionalInfo(fieldNames.size()),
+          _topLevelExtractor(toStrings(fieldNames)) {
     }
 
     BSONElement BtreeKeyGeneratorV1::extractNextElement(const BSONObj &obj,
@@ -283,7 +321,26 @@ namespace {
                                           std::vector<BSONElement> fixed,
                                           const BSONObj& obj,
                                           BSONObjSet* keys) const {
-        getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo);
+        // There is no positional info at the top level, so extractNextElement() would just call
+        // getFieldDottedOrArray() for each field. Look them all up in one pass instead.
+        std::vector<BSONElement> extracted;
+        std::vector<size_t> remainingOffsets;
+        _topLevelExtractor.extract(obj, &extracted, &remainingOffsets);
+        getKeysImplFromExtracted(fieldNames, fixed, obj, extracted, remainingOffsets, keys);
+    }
+
+    void BtreeKeyGeneratorV1::getKeysImplFromExtracted(
+            std::vector<const char*> fieldNames,
+            std::vector<BSONElement> fixed,
+            const BSONObj& obj,
+            const std::vector<BSONElement>& extracted,
+            const std::vector<size_t>& remainingOffsets,
+            BSONObjSet* keys) const {
+        for (size_t i = 0; i < fieldNames.size(); ++i) {
+            fieldNames[i] += remainingOffsets[i];
+        }
+
+        getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo, &extracted);
     }
 
     void BtreeKeyGeneratorV1::getKeysImplWithArray(
@@ -292,21 +349,24 @@ namespace {
             const BSONObj& obj,
             BSONObjSet* keys,
             unsigned numNotFound,
-            const std::vector<PositionalPathInfo>& positionalInfo) const {
+            const std::vector<PositionalPathInfo>& positionalInfo,
+            const std::vector<BSONElement>* extracted) const {
         BSONElement arrElt;
         std::set<unsigned> arrIdxs;
         bool mayExpandArrayUnembedded = true;
         for (unsigned i = 0; i < fieldNames.size(); ++i) {
-            if ( *fieldNames[ i ] == '\0' ) {
+            bool arrayNestedArray = false;
+            BSONElement e;
+            if (extracted) {
+                e = (*extracted)[i];
+            }
+            else if ( *fieldNames[ i ] == '\0' ) {
                 continue;
             }
-
-            bool arrayNestedArray;
-            // Extract element matching fieldName[ i ] from object xor array.
-            BSONElement e = extractNextElement(obj,
-                                               positionalInfo[i],
-                                               &fieldNames[i],
-                                               &arrayNestedArray);
+            else {
+                // Extract element matching fieldName[ i ] from object xor array.
+                e = extractNextElement(obj, positionalInfo[i], &fieldNames[i], &arrayNestedArray);
+            }
 
             if ( e.eoo() ) {
                 // if field not present, set to null
@@ -30,6 +30,7 @@
 
 #include <vector>
 #include <set>
+#include "mongo/bson/bson_field_extractor.h"
 #include "mongo/db/jsobj.h"
 
 namespace mongo {
@@ -48,6 +49,21 @@ namespace mongo {
 
         void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+        /**
+         * Returns whether getKeysFromExtracted() may be called.
+         */
+        virtual bool supportsExtractedFields() const { return false; }
+
+        /**
+         * Generates the same keys as getKeys(), from the elements getFieldDottedOrArray() finds
+         * in 'obj' for each field of the key pattern, and the offset it leaves in each field name,
+         * as a BSONFieldExtractor over the fields of many indexes finds them all at once.
+         */
+        void getKeysFromExtracted(const BSONObj& obj,
+                                  const std::vector<BSONElement>& extracted,
+                                  const std::vector<size_t>& remainingOffsets,
+                                  BSONObjSet* keys) const;
+
         static const int ParallelArraysCode;
 
     protected:
@@ -65,6 +81,15 @@ namespace mongo {
                                  const BSONObj& obj,
                                  BSONObjSet* keys) const = 0;
 
+        virtual void getKeysImplFromExtracted(std::vector<const char*> fieldNames,
+                                              std::vector<BSONElement> fixed,
+                                              const BSONObj& obj,
+                                              const std::vector<BSONElement>& extracted,
+                                              const std::vector<size_t>& remainingOffsets,
+                                              BSONObjSet* keys) const;
+
+        void getIdKey(const BSONElement& id, BSONObjSet* keys) const;
+
         std::vector<BSONElement> _fixed;
     };
 
@@ -91,6 +116,8 @@ namespace mongo {
 
         virtual ~BtreeKeyGeneratorV1() { }
 
+        virtual bool supportsExtractedFields() const { return true; }
+
     private:
         /**
          * Stores info regarding traversal of a positional path. A path through a document is
@@ -158,15 +185,27 @@ namespace mongo {
                                  const BSONObj& obj,
                                  BSONObjSet* keys) const;
 
+        virtual void getKeysImplFromExtracted(std::vector<const char*> fieldNames,
+                                              std::vector<BSONElement> fixed,
+                                              const BSONObj& obj,
+                                              const std::vector<BSONElement>& extracted,
+                                              const std::vector<size_t>& remainingOffsets,
+                                              BSONObjSet* keys) const;
+
         /**
          * This recursive method does the heavy-lifting for getKeysImpl().
+         *
+         * If 'extracted' is not NULL, it holds the element for each of 'fieldNames' already
+         * looked up in 'obj' (and 'fieldNames' has been advanced past the traversed part of each
+         * path), so extractNextElement() is not called.
          */
         void getKeysImplWithArray(std::vector<const char*> fieldNames,
                                   std::vector<BSONElement> fixed,
                                   const BSONObj& obj,
                                   BSONObjSet* keys,
                                   unsigned numNotFound,
-                                  const std::vector<PositionalPathInfo>& positionalInfo) const;
+                                  const std::vector<PositionalPathInfo>& positionalInfo,
+                                  const std::vector<BSONElement>* extracted = NULL) const;
         /**
          * A call to getKeysImplWithArray() begins by calling this for each field in the key
          * pattern. It uses getFieldDottedOrArray() to traverse the path '*field' in 'obj'.
@@ -220,6 +259,9 @@ namespace mongo {
                                  const std::vector<PositionalPathInfo>& positionalInfo) const;
 
         const std::vector<PositionalPathInfo> _emptyPositionalInfo;
+
+        // Finds all of the key pattern's fields at the top level of a document in a single pass.
+        const BSONFieldExtractor _topLevelExtractor;
     };
 
 }  // namespace mongo
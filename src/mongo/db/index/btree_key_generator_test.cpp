@@ -28,9 +28,11 @@
 
 #include "mongo/db/index/btree_key_generator.h"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
 #include <iostream>
 
+#include "mongo/bson/bson_field_extractor.h"
 #include "mongo/db/json.h"
 #include "mongo/unittest/unittest.h"
 
@@ -97,7 +99,37 @@ namespace {
         keyGen->getKeys(obj, &actualKeys);
 
         //
-        // Step 3: check that the results match the expected result.
+        // Step 3: generate them again from the elements an extractor over the key pattern's
+        // fields, among the fields of other indexes, finds in 'obj'.
+        //
+        vector<std::string> paths;
+        paths.push_back("a");
+        paths.push_back("a.b.c");
+        paths.push_back("x.y");
+        vector<size_t> positions;
+        for (size_t i = 0; i < fieldNames.size(); ++i) {
+            vector<std::string>::iterator path =
+                std::find(paths.begin(), paths.end(), fieldNames[i]);
+            positions.push_back(path - paths.begin());
+            if (path == paths.end()) {
+                paths.push_back(fieldNames[i]);
+            }
+        }
+        vector<BSONElement> allExtracted;
+        vector<size_t> allRemainingOffsets;
+        BSONFieldExtractor(paths).extract(obj, &allExtracted, &allRemainingOffsets);
+
+        vector<BSONElement> extracted;
+        vector<size_t> remainingOffsets;
+        for (size_t i = 0; i < positions.size(); ++i) {
+            extracted.push_back(allExtracted[positions[i]]);
+            remainingOffsets.push_back(allRemainingOffsets[positions[i]]);
+        }
+        BSONObjSet extractedKeys;
+        keyGen->getKeysFromExtracted(obj, extracted, remainingOffsets, &extractedKeys);
+
+        //
+        // Step 4: check that the results match the expected result.
         //
         bool match = keysetsMatch(expectedKeys, actualKeys);
         if (!match) {
@@ -105,7 +137,13 @@ namespace {
                  << "Actual: " << dumpKeyset(actualKeys) << endl;
         }
 
-        return match;
+        bool extractedMatch = keysetsMatch(expectedKeys, extractedKeys);
+        if (!extractedMatch) {
+            cout << "Expected: " << dumpKeyset(expectedKeys) << ", "
+                 << "Generated from extracted fields: " << dumpKeyset(extractedKeys) << endl;
+        }
+
+        return match && extractedMatch;
     }
 
     //
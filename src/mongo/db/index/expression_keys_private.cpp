@@ -330,7 +330,15 @@ namespace mongo {
                                             BSONObjSet* keys) {
 
         const char* cstr = hashedField.c_str();
-        BSONElement fieldVal = obj.getFieldDottedOrArray(cstr);
+        getHashKeysForElement(obj.getFieldDottedOrArray(cstr), seed, hashVersion, isSparse, keys);
+    }
+
+    // static
+    void ExpressionKeysPrivate::getHashKeysForElement(const BSONElement& fieldVal,
+                                                      HashSeed seed,
+                                                      int hashVersion,
+                                                      bool isSparse,
+                                                      BSONObjSet* keys) {
         uassert(16766, "Error: hashed indexes do not currently support array values",
                 fieldVal.type() != Array );
 
@@ -348,8 +356,9 @@ namespace mongo {
     long long int ExpressionKeysPrivate::makeSingleHashKey(const BSONElement& e,
                                                            HashSeed seed,
                                                            int v) {
-        massert(16767, "Only HashVersion 0 has been defined" , v == 0 );
-        return BSONElementHasher::hash64(e, seed);
+        massert(16767, "Only HashVersions 0 and 1 have been defined",
+                BSONElementHasher::isValidHashVersion(v));
+        return BSONElementHasher::hash64(e, seed, v);
     }
 
     // static
@@ -82,6 +82,16 @@ namespace mongo {
                                 bool isSparse,
                                 BSONObjSet* keys);
 
+        /**
+         * Like getHashKeys(), from 'fieldVal', the element getFieldDottedOrArray() finds at the
+         * hashed field.
+         */
+        static void getHashKeysForElement(const BSONElement& fieldVal,
+                                          HashSeed seed,
+                                          int hashVersion,
+                                          bool isSparse,
+                                          BSONObjSet* keys);
+
         /**
          * Hashing function used by both getHashKeys and the cursors we create.
          * Exposed for testing in dbtests/namespacetests.cpp and
@@ -30,6 +30,7 @@
 #include "mongo/db/index/expression_keys_private.h"
 #include "mongo/db/index/expression_params.h"
 #include "mongo/db/index/hash_access_method.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -49,10 +50,30 @@ namespace mongo {
                                           &_seed,
                                           &_hashVersion,
                                           &_hashedField);
+
+        uassert(28712, mongoutils::str::stream() << "Unknown hashVersion " << _hashVersion
+                                                << " for hashed index, only 0 and 1 are supported",
+                BSONElementHasher::isValidHashVersion(_hashVersion));
     }
 
     void HashAccessMethod::getKeys(const BSONObj& obj, BSONObjSet* keys) const {
         ExpressionKeysPrivate::getHashKeys(obj, _hashedField, _seed, _hashVersion, _descriptor->isSparse(), keys);
     }
 
+    std::vector<std::string> HashAccessMethod::getExtractedPaths() const {
+        return std::vector<std::string>(1, _hashedField);
+    }
+
+    void HashAccessMethod::getKeysFromExtracted(const BSONObj& obj,
+                                                const std::vector<BSONElement>& extracted,
+                                                const std::vector<size_t>& remainingOffsets,
+                                                BSONObjSet* keys) const {
+        invariant(extracted.size() == 1);
+        ExpressionKeysPrivate::getHashKeysForElement(extracted[0],
+                                                     _seed,
+                                                     _hashVersion,
+                                                     _descriptor->isSparse(),
+                                                     keys);
+    }
+
 }  // namespace mongo
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/status.h"
 #include "mongo/db/hasher.h"  // For HashSeed.
@@ -45,6 +46,13 @@ namespace mongo {
     public:
         HashAccessMethod(IndexCatalogEntry* btreeState, SortedDataInterface* btree);
 
+        virtual std::vector<std::string> getExtractedPaths() const;
+
+        virtual void getKeysFromExtracted(const BSONObj& obj,
+                                          const std::vector<BSONElement>& extracted,
+                                          const std::vector<size_t>& remainingOffsets,
+                                          BSONObjSet* keys) const;
+
     private:
         virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
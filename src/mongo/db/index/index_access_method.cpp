@@ -103,12 +103,20 @@ namespace mongo {
                                      const RecordId& loc,
                                      const InsertDeleteOptions& options,
                                      int64_t* numInserted) {
-        *numInserted = 0;
-
         BSONObjSet keys;
         // Delegate to the subclass.
         getKeys(obj, &keys);
 
+        return insertKeys(txn, keys, loc, options, numInserted);
+    }
+
+    Status IndexAccessMethod::insertKeys(OperationContext* txn,
+                                         const BSONObjSet& keys,
+                                         const RecordId& loc,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numInserted) {
+        *numInserted = 0;
+
         Status ret = Status::OK();
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
             Status status = _newInterface->insert(txn, *i, loc, options.dupsAllowed);
@@ -172,6 +180,11 @@ namespace mongo {
         return _newInterface->newCursor(txn, isForward);
     }
 
+    std::unique_ptr<SortedDataInterface::RandomCursor> IndexAccessMethod::newRandomCursor(
+            OperationContext* txn) const {
+        return _newInterface->newRandomCursor(txn);
+    }
+
     // Remove the provided doc from the index.
     Status IndexAccessMethod::remove(OperationContext* txn,
                                      const BSONObj &obj,
@@ -181,6 +194,15 @@ namespace mongo {
 
         BSONObjSet keys;
         getKeys(obj, &keys);
+
+        return removeKeys(txn, keys, loc, options, numDeleted);
+    }
+
+    Status IndexAccessMethod::removeKeys(OperationContext* txn,
+                                         const BSONObjSet& keys,
+                                         const RecordId& loc,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numDeleted) {
         *numDeleted = 0;
 
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
@@ -191,6 +213,17 @@ namespace mongo {
         return Status::OK();
     }
 
+    std::vector<std::string> IndexAccessMethod::getExtractedPaths() const {
+        return std::vector<std::string>();
+    }
+
+    void IndexAccessMethod::getKeysFromExtracted(const BSONObj& obj,
+                                                 const std::vector<BSONElement>& extracted,
+                                                 const std::vector<size_t>& remainingOffsets,
+                                                 BSONObjSet* keys) const {
+        getKeys(obj, keys);
+    }
+
     // Return keys in l that are not in r.
     // Lifted basically verbatim from elsewhere.
     static void setDifference(const BSONObjSet &l, const BSONObjSet &r, vector<BSONObj*> *diff) {
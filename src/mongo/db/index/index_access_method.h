@@ -80,6 +80,15 @@ namespace mongo {
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Like insert(), for the 'keys' already generated for the document at 'loc'.
+         */
+        Status insertKeys(OperationContext* txn,
+                          const BSONObjSet& keys,
+                          const RecordId& loc,
+                          const InsertDeleteOptions& options,
+                          int64_t* numInserted);
+
         /**
          * Analogous to above, but remove the records instead of inserting them.  If not NULL,
          * numDeleted will be set to the number of keys removed from the index for the document.
@@ -90,6 +99,15 @@ namespace mongo {
                       const InsertDeleteOptions& options,
                       int64_t* numDeleted);
 
+        /**
+         * Like remove(), for the 'keys' already generated for the document at 'loc'.
+         */
+        Status removeKeys(OperationContext* txn,
+                          const BSONObjSet& keys,
+                          const RecordId& loc,
+                          const InsertDeleteOptions& options,
+                          int64_t* numDeleted);
+
         /**
          * Checks whether the index entries for the document 'from', which is placed at location
          * 'loc' on disk, can be changed to the index entries for the doc 'to'. Provides a ticket
@@ -124,6 +142,13 @@ namespace mongo {
         std::unique_ptr<SortedDataInterface::Cursor> newCursor(OperationContext* txn,
                                                                bool isForward = true) const;
 
+        /**
+         * Returns a cursor returning entries of 'this' index in random order, or an empty pointer
+         * if the storage engine doesn't support it.
+         */
+        std::unique_ptr<SortedDataInterface::RandomCursor> newRandomCursor(
+                OperationContext* txn) const;
+
         // ------ index level operations ------
 
 
@@ -186,6 +211,10 @@ namespace mongo {
         public:
             /**
              * Insert into the BulkBuilder as-if inserting into an IndexAccessMethod.
+             *
+             * Only generates keys and adds them to the external sorter, so 'txn' is not used and
+             * may be NULL. This lets multiple BulkBuilders be filled on different threads, as
+             * long as each one is only used by one thread at a time.
              */
             Status insert(OperationContext* txn,
                           const BSONObj& obj,
@@ -235,6 +264,24 @@ namespace mongo {
          */
         virtual void getKeys(const BSONObj &obj, BSONObjSet *keys) const = 0;
 
+        /**
+         * Returns the paths getKeys() looks up in a document, if it can instead generate the keys
+         * from the elements getFieldDottedOrArray() finds at them with getKeysFromExtracted(), so
+         * that one BSONFieldExtractor can find the paths of many indexes at once. Returns an empty
+         * vector otherwise, which is the default.
+         */
+        virtual std::vector<std::string> getExtractedPaths() const;
+
+        /**
+         * Fills 'keys' with the same keys as getKeys(), from 'extracted', the element found in
+         * 'obj' for each of getExtractedPaths(), and the offset left in each path in
+         * 'remainingOffsets'. The default just calls getKeys().
+         */
+        virtual void getKeysFromExtracted(const BSONObj& obj,
+                                          const std::vector<BSONElement>& extracted,
+                                          const std::vector<size_t>& remainingOffsets,
+                                          BSONObjSet* keys) const;
+
     protected:
         // Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
         bool ignoreKeyTooLong(OperationContext* txn);
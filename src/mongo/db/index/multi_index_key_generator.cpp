@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/multi_index_key_generator.h"
+
+#include <map>
+
+#include "mongo/db/index/index_access_method.h"
+
+namespace mongo {
+
+    MultiIndexKeyGenerator::MultiIndexKeyGenerator(
+            const std::vector<const IndexAccessMethod*>& indexes) {
+        std::map<std::string, size_t> pathPositions;
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            Index index;
+            index.accessMethod = indexes[i];
+
+            const std::vector<std::string> paths = index.accessMethod->getExtractedPaths();
+            for (size_t j = 0; j < paths.size(); ++j) {
+                std::map<std::string, size_t>::const_iterator it = pathPositions.find(paths[j]);
+                if (it == pathPositions.end()) {
+                    it = pathPositions.insert(std::make_pair(paths[j], _paths.size())).first;
+                    _paths.push_back(paths[j]);
+                }
+                index.pathPositions.push_back(it->second);
+            }
+
+            _indexes.push_back(index);
+        }
+
+        if (!_paths.empty()) {
+            _extractor.reset(new BSONFieldExtractor(_paths));
+        }
+    }
+
+    void MultiIndexKeyGenerator::getKeys(const BSONObj& obj,
+                                         const std::vector<bool>& wanted,
+                                         std::vector<BSONObjSet>* keys) const {
+        invariant(wanted.size() == _indexes.size());
+        keys->clear();
+        keys->resize(_indexes.size());
+
+        std::vector<BSONElement> extracted;
+        std::vector<size_t> remainingOffsets;
+        bool haveExtracted = false;
+
+        std::vector<BSONElement> indexExtracted;
+        std::vector<size_t> indexRemainingOffsets;
+        for (size_t i = 0; i < _indexes.size(); ++i) {
+            if (!wanted[i]) {
+                continue;
+            }
+
+            const Index& index = _indexes[i];
+            if (index.pathPositions.empty()) {
+                index.accessMethod->getKeys(obj, &(*keys)[i]);
+                continue;
+            }
+
+            if (!haveExtracted) {
+                _extractor->extract(obj, &extracted, &remainingOffsets);
+                haveExtracted = true;
+            }
+
+            indexExtracted.clear();
+            indexRemainingOffsets.clear();
+            for (size_t j = 0; j < index.pathPositions.size(); ++j) {
+                indexExtracted.push_back(extracted[index.pathPositions[j]]);
+                indexRemainingOffsets.push_back(remainingOffsets[index.pathPositions[j]]);
+            }
+            index.accessMethod->getKeysFromExtracted(obj,
+                                                     indexExtracted,
+                                                     indexRemainingOffsets,
+                                                     &(*keys)[i]);
+        }
+    }
+
+}  // namespace mongo
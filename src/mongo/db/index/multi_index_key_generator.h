@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bson_field_extractor.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class IndexAccessMethod;
+
+    /**
+     * Generates a document's keys for all of the indexes of a collection at once.
+     *
+     * Each index's getKeys() looks up the paths of its own key pattern, so with many indexes the
+     * top level of the document, and every shared prefix, is walked once per index. Instead, the
+     * paths of all of the indexes that can generate their keys from extracted elements are looked
+     * up with a single BSONFieldExtractor, in one walk of the document, and handed to each of
+     * them. The other indexes still call getKeys().
+     *
+     * Build one when the set of indexes changes, and reuse it for every document.
+     */
+    class MultiIndexKeyGenerator {
+        MONGO_DISALLOW_COPYING(MultiIndexKeyGenerator);
+    public:
+        explicit MultiIndexKeyGenerator(const std::vector<const IndexAccessMethod*>& indexes);
+
+        size_t numIndexes() const { return _indexes.size(); }
+
+        /**
+         * Fills '(*keys)[i]' with the keys of 'obj' for the i-th index given to the constructor,
+         * for each i where 'wanted[i]' is true. The other sets are left empty.
+         */
+        void getKeys(const BSONObj& obj,
+                     const std::vector<bool>& wanted,
+                     std::vector<BSONObjSet>* keys) const;
+
+    private:
+        struct Index {
+            const IndexAccessMethod* accessMethod;
+
+            // Where each of the index's paths is in '_paths', or empty if the index generates its
+            // keys from the whole document.
+            std::vector<size_t> pathPositions;
+        };
+
+        std::vector<Index> _indexes;
+
+        // The distinct paths of all of the indexes, and an extractor over them.
+        std::vector<std::string> _paths;
+        boost::scoped_ptr<BSONFieldExtractor> _extractor;
+    };
+
+}  // namespace mongo
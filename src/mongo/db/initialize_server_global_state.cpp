@@ -51,7 +51,9 @@
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/logger/logger.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
 #include "mongo/logger/message_event_utf8_encoder.h"
@@ -198,6 +200,34 @@ namespace mongo {
             quickExit(EXIT_FAILURE);
     }
 
+    // Whether log files are written by a background thread rather than by the logging threads
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logAsyncWrites, bool, false);
+
+    // How many log messages may wait for the background writer before logging threads wait for
+    // it, or drop their messages if logAsyncDropWhenFull is set
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logAsyncMaxQueuedMessages, int, 10000);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(logAsyncDropWhenFull, bool, false);
+
+namespace {
+
+    logger::MessageLogDomain::AppenderAutoPtr makeFileAppender(
+            logger::RotatableFileWriter* writer) {
+        if (logAsyncWrites) {
+            return logger::MessageLogDomain::AppenderAutoPtr(
+                    new logger::AsyncRotatableFileAppender<logger::MessageEventEphemeral>(
+                            new logger::MessageEventDetailsEncoder,
+                            writer,
+                            std::max(logAsyncMaxQueuedMessages, 1),
+                            logAsyncDropWhenFull));
+        }
+
+        return logger::MessageLogDomain::AppenderAutoPtr(
+                new logger::RotatableFileAppender<logger::MessageEventEphemeral>(
+                        new logger::MessageEventDetailsEncoder, writer));
+    }
+
+} // namespace
+
     MONGO_INITIALIZER_GENERAL(ServerLogRedirection,
                               ("GlobalLogManager", "EndStartupOptionHandling", "ForkServer"),
                               ("default"))(
@@ -208,7 +238,6 @@ namespace mongo {
         using logger::MessageEventDetailsEncoder;
         using logger::MessageEventWithContextEncoder;
         using logger::MessageLogDomain;
-        using logger::RotatableFileAppender;
         using logger::StatusWithRotatableFileWriter;
 
         if (serverGlobalParams.logWithSyslog) {
@@ -283,14 +312,9 @@ namespace mongo {
 
             LogManager* manager = logger::globalLogManager();
             manager->getGlobalDomain()->clearAppenders();
-            manager->getGlobalDomain()->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+            manager->getGlobalDomain()->attachAppender(makeFileAppender(writer.getValue()));
             manager->getNamedDomain("javascriptOutput")->attachAppender(
-                    MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+                    makeFileAppender(writer.getValue()));
 
             if (serverGlobalParams.logAppend && exists) {
                 log() << "***** SERVER RESTARTED *****" << endl;
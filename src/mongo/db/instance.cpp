@@ -33,11 +33,13 @@
 #include "mongo/platform/basic.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <algorithm>
 #include <boost/thread/thread.hpp>
 #include <fstream>
 #include <memory>
 
 #include "mongo/base/status.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -64,6 +66,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/memory_tracker.h"
 #include "mongo/db/mongod_options.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/op_observer.h"
@@ -82,6 +85,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/catalog/catalog_manager.h"
@@ -206,6 +210,44 @@ namespace {
 
 } // namespace
 
+    /**
+     * Returns the getMore command which continues the find or getMore command 'cmdObj' of an
+     * exhaust request, given its 'reply', and sets '*cursorId' to the cursor it reads. Returns an
+     * empty object if 'cmdObj' is another command, failed, or read the whole result.
+     */
+    static BSONObj nextExhaustCommand(const BSONObj& cmdObj,
+                                      const BSONObj& reply,
+                                      long long* cursorId) {
+        BSONObj cmd = cmdObj;
+        if (cmd.firstElement().isABSONObj() &&
+            (str::equals(cmd.firstElementFieldName(), "$query") ||
+             str::equals(cmd.firstElementFieldName(), "query"))) {
+            cmd = cmd.firstElement().Obj();
+        }
+        if (!str::equals(cmd.firstElementFieldName(), "find") &&
+            !str::equals(cmd.firstElementFieldName(), "getMore")) {
+            return BSONObj();
+        }
+
+        if (!reply["ok"].trueValue()) {
+            return BSONObj();
+        }
+        BSONObj cursor = reply.getObjectField("cursor");
+        *cursorId = cursor["id"].numberLong();
+        if (0 == *cursorId) {
+            return BSONObj();
+        }
+
+        BSONObjBuilder b;
+        b.append("getMore", *cursorId);
+        b.append("collection", NamespaceString(cursor.getStringField("ns")).coll());
+        // Like the ntoreturn of a legacy exhaust query, the batch size applies to every batch.
+        if (cmd["batchSize"].isNumber() && cmd["batchSize"].numberInt() > 0) {
+            b.append("batchSize", cmd["batchSize"].numberInt());
+        }
+        return b.obj();
+    }
+
     static void receivedCommand(OperationContext* txn,
                                 const NamespaceString& nss,
                                 Client& client,
@@ -239,10 +281,10 @@ namespace {
                                          << ") for $cmd type ns - can only be 1 or -1",
                     nToReturn == 1 || nToReturn == -1);
 
-            BufBuilder bb;
+            BufBuilder bb(BufferPool::suggestedSize());
             bb.skip(sizeof(QueryResult::Value));
 
-            BSONObjBuilder cmdResBuf;
+            BSONObjBuilder cmdResBuf(BufferPool::suggestedSize());
             if (!runCommands(txn,
                              queryMessage.ns,
                              queryMessage.query,
@@ -269,6 +311,19 @@ namespace {
             response->setData(qr.view2ptr(), true);
 
             invariant(!response->empty());
+
+            if (queryMessage.queryOptions & QueryOption_Exhaust) {
+                long long cursorId = 0;
+                dbResponse.exhaustCommand =
+                    nextExhaustCommand(queryMessage.query, BSONObj(qr.data()), &cursorId);
+                if (!dbResponse.exhaustCommand.isEmpty()) {
+                    // As for a legacy exhaust query, the client reads replies until one without a
+                    // cursor id, and the server sends them without waiting for getMores.
+                    qr.setCursorId(cursorId);
+                    op->debug().exhaust = true;
+                    dbResponse.exhaustNS = nss.ns();
+                }
+            }
         }
         catch (const AssertionException& exception) {
             response.reset(new Message());
@@ -578,6 +633,11 @@ namespace {
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
 
+        const long long peakMemoryBytes = MemoryTracker::forOperation(txn)->peakBytes();
+        if (peakMemoryBytes > 0) {
+            debug.peakMemoryBytes = peakMemoryBytes;
+        }
+
         logThreshold += currentOp.getExpectedLatencyMs();
 
         if ( shouldLog || debug.executionTime > logThreshold ) {
@@ -602,7 +662,7 @@ namespace {
             }
         }
 
-        debug.recordStats();
+        debug.recordStats(currentOp.totalTimeMicros());
         debug.reset();
     }
 
@@ -853,6 +913,7 @@ namespace {
         bool exhaust = false;
         QueryResult::View msgdata = 0;
         Timestamp last;
+        CappedInsertNotifierData notifierData;
         while( 1 ) {
             bool isCursorAuthorized = false;
             try {
@@ -884,7 +945,8 @@ namespace {
                                   curop,
                                   pass,
                                   exhaust,
-                                  &isCursorAuthorized);
+                                  &isCursorAuthorized,
+                                  &notifierData);
             }
             catch ( AssertionException& e ) {
                 if ( isCursorAuthorized ) {
@@ -915,7 +977,16 @@ namespace {
                     }
                 }
                 pass++;
-                if (kDebugBuild)
+                if (notifierData.notifier) {
+                    // Wait for an insert into the capped collection, but look again at least once
+                    // a second so that the operation can be killed.
+                    const int remainingMillis = std::max(0, 4000 - timer->millis());
+                    notifierData.notifier->waitForInsert(
+                            notifierData.lastEOFVersion,
+                            Milliseconds(std::min(1000, remainingMillis)));
+                    notifierData.notifier.reset();
+                }
+                else if (kDebugBuild)
                     sleepmillis(20);
                 else
                     sleepmillis(2);
@@ -1286,6 +1357,7 @@ namespace {
         }
 #endif
 
+        logger::flushAllAppenders();
         quickExit(rc);
     }
 
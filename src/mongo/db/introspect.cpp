@@ -32,14 +32,26 @@
 
 #include "mongo/db/introspect.h"
 
+#include <boost/thread/condition_variable.hpp>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "mongo/base/counter.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_set.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/scopeguard.h"
 
@@ -48,9 +60,28 @@ namespace mongo {
     using boost::scoped_ptr;
     using std::endl;
     using std::string;
+    using std::vector;
+
+    // Whether profile entries are queued for a background thread to write, instead of being
+    // written by the profiled operation itself
+    MONGO_EXPORT_SERVER_PARAMETER(profilerWriteAsync, bool, false);
+
+    // How many profile entries may be waiting to be written before new ones are dropped
+    MONGO_EXPORT_SERVER_PARAMETER(profilerQueueMaxEntries, int, 10000);
 
 namespace {
 
+    Counter64 profilerQueuedCounter;
+    Counter64 profilerDroppedCounter;
+    Counter64 profilerWrittenCounter;
+
+    ServerStatusMetricField<Counter64> profilerQueuedDisplay("profiler.queued",
+                                                             &profilerQueuedCounter);
+    ServerStatusMetricField<Counter64> profilerDroppedDisplay("profiler.dropped",
+                                                              &profilerDroppedCounter);
+    ServerStatusMetricField<Counter64> profilerWrittenDisplay("profiler.written",
+                                                              &profilerWrittenCounter);
+
     void _appendUserInfo(const CurOp& c,
                          BSONObjBuilder& builder,
                          AuthorizationSession* authSession) {
@@ -79,6 +110,146 @@ namespace {
 
     }
 
+    /**
+     * Inserts 'entries' into the profile collection of 'dbName', creating the collection if it
+     * was dropped and that is safe under the locks 'txn' already holds.
+     */
+    void insertProfileEntries(OperationContext* txn,
+                              const string& dbName,
+                              const vector<BSONObj>& entries) {
+        const bool wasLocked = txn->lockState()->isLocked();
+
+        bool acquireDbXLock = false;
+        while (true) {
+            ScopedTransaction scopedXact(txn, MODE_IX);
+
+            boost::scoped_ptr<AutoGetDb> autoGetDb;
+            if (acquireDbXLock) {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
+                if (autoGetDb->getDb()) {
+                    createProfileCollection(txn, autoGetDb->getDb());
+                }
+            }
+            else {
+                autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
+            }
+
+            Database* const db = autoGetDb->getDb();
+            if (!db) {
+                // Database disappeared
+                log() << "note: not profiling because db went away for " << dbName;
+                break;
+            }
+
+            Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
+
+            Collection* const coll = db->getCollection(db->getProfilingNS());
+            if (coll) {
+                WriteUnitOfWork wuow(txn);
+                for (vector<BSONObj>::const_iterator it = entries.begin();
+                     it != entries.end(); ++it) {
+                    coll->insertDocument(txn, *it, false);
+                }
+                wuow.commit();
+
+                break;
+            }
+            else if (!acquireDbXLock &&
+                        (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
+                // Try to create the collection only if we are not under lock, in order to
+                // avoid deadlocks due to lock conversion. This would only be hit if someone
+                // deletes the profiler collection after setting profile level.
+                acquireDbXLock = true;
+            }
+            else {
+                // Cannot write the profile information
+                break;
+            }
+        }
+    }
+
+    /**
+     * Writes queued profile entries in batches, so that profiled operations neither wait for
+     * the profile collection's locks nor for the insert.
+     */
+    class ProfileWriter : public BackgroundJob {
+    public:
+        ProfileWriter() : _started(false) { }
+
+        virtual string name() const { return "ProfileWriter"; }
+
+        /**
+         * Queues 'entry' for the profile collection of 'dbName'.  Returns false, dropping the
+         * entry, if the queue is full.
+         */
+        bool enqueue(const string& dbName, const BSONObj& entry) {
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                if (_queue.size() >= static_cast<size_t>(std::max(profilerQueueMaxEntries, 0))) {
+                    return false;
+                }
+
+                _queue.push_back(std::make_pair(dbName, entry));
+
+                if (!_started) {
+                    _started = true;
+                    go();
+                }
+            }
+            _queueNotEmpty.notify_one();
+            return true;
+        }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            while (!inShutdown()) {
+                Queue batch;
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (_queue.empty() && !inShutdown()) {
+                        _queueNotEmpty.timed_wait(lk, boost::posix_time::seconds(1));
+                    }
+                    batch.swap(_queue);
+                }
+
+                writeBatch(batch);
+            }
+        }
+
+    private:
+        typedef std::deque<std::pair<string, BSONObj> > Queue;
+
+        void writeBatch(const Queue& batch) {
+            std::map<string, vector<BSONObj> > byDb;
+            for (Queue::const_iterator it = batch.begin(); it != batch.end(); ++it) {
+                byDb[it->first].push_back(it->second);
+            }
+
+            for (std::map<string, vector<BSONObj> >::const_iterator it = byDb.begin();
+                 it != byDb.end(); ++it) {
+                try {
+                    OperationContextImpl txn;
+                    insertProfileEntries(&txn, it->first, it->second);
+                    profilerWrittenCounter.increment(it->second.size());
+                }
+                catch (const DBException& ex) {
+                    warning() << "Caught exception while writing " << it->second.size()
+                              << " profile entries for " << it->first << ": " << ex.toString();
+                }
+            }
+        }
+
+        boost::mutex _mutex;
+        boost::condition_variable _queueNotEmpty;
+        Queue _queue;
+        bool _started;
+    };
+
+    // Never deleted, the writer thread may outlive static destruction
+    ProfileWriter* const profileWriter = new ProfileWriter();
+
 } // namespace
 
 
@@ -102,56 +273,21 @@ namespace {
 
         const BSONObj p = b.done();
 
-        const bool wasLocked = txn->lockState()->isLocked();
-
         const string dbName(nsToDatabase(txn->getCurOp()->getNS()));
 
-        try {
-            bool acquireDbXLock = false;
-            while (true) {
-                ScopedTransaction scopedXact(txn, MODE_IX);
-
-                boost::scoped_ptr<AutoGetDb> autoGetDb;
-                if (acquireDbXLock) {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_X));
-                    if (autoGetDb->getDb()) {
-                        createProfileCollection(txn, autoGetDb->getDb());
-                    }
-                }
-                else {
-                    autoGetDb.reset(new AutoGetDb(txn, dbName, MODE_IX));
-                }
-
-                Database* const db = autoGetDb->getDb();
-                if (!db) {
-                    // Database disappeared
-                    log() << "note: not profiling because db went away for "
-                          << txn->getCurOp()->getNS();
-                    break;
-                }
-
-                Lock::CollectionLock collLock(txn->lockState(), db->getProfilingNS(), MODE_IX);
-
-                Collection* const coll = db->getCollection(db->getProfilingNS());
-                if (coll) {
-                    WriteUnitOfWork wuow(txn);
-                    coll->insertDocument(txn, p, false);
-                    wuow.commit();
-
-                    break;
-                }
-                else if (!acquireDbXLock &&
-                            (!wasLocked || txn->lockState()->isDbLockedForMode(dbName, MODE_X))) {
-                    // Try to create the collection only if we are not under lock, in order to
-                    // avoid deadlocks due to lock conversion. This would only be hit if someone
-                    // deletes the profiler collection after setting profile level.
-                    acquireDbXLock = true;
-                }
-                else {
-                    // Cannot write the profile information
-                    break;
-                }
+        if (profilerWriteAsync) {
+            if (profileWriter->enqueue(dbName, p.getOwned())) {
+                profilerQueuedCounter.increment();
             }
+            else {
+                profilerDroppedCounter.increment();
+            }
+            return;
+        }
+
+        try {
+            insertProfileEntries(txn, dbName, vector<BSONObj>(1, p));
+            profilerWrittenCounter.increment();
         }
         catch (const AssertionException& assertionEx) {
             warning() << "Caught Assertion while trying to profile "
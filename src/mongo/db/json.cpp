@@ -29,10 +29,17 @@
 
 #include "mongo/db/json.h"
 
+#include <algorithm>
 #include <boost/scoped_ptr.hpp>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define MONGO_JSON_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "mongo/base/parse_number.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/bits.h"
 #include "mongo/platform/cstdint.h"
 #include "mongo/platform/strtoll.h"
 #include "mongo/util/base64.h"
@@ -65,7 +72,6 @@ namespace mongo {
         PAT_RESERVE_SIZE = 4096,
         OPT_RESERVE_SIZE = 64,
         FIELD_RESERVE_SIZE = 4096,
-        STRINGVAL_RESERVE_SIZE = 4096,
         BINDATA_RESERVE_SIZE = 4096,
         BINDATATYPE_RESERVE_SIZE = 4096,
         NS_RESERVE_SIZE = 64,
@@ -86,12 +92,36 @@ namespace mongo {
                  *SINGLEQUOTE = "'",
                  *DOUBLEQUOTE = "\"";
 
+namespace {
+
+    inline bool isFieldStartChar(char c) {
+        return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' || c == '$';
+    }
+
+    inline bool isFieldChar(char c) {
+        return isFieldStartChar(c) || ('0' <= c && c <= '9');
+    }
+
+    inline bool isDigit(char c) {
+        return '0' <= c && c <= '9';
+    }
+
+} // namespace
+
     JParse::JParse(StringData str)
         : _buf(str.rawData())
         , _input(_buf)
         , _input_end(_input + str.size())
     {}
 
+    inline void JParse::skipWhitespace() {
+        // 'isspace()' takes an 'int' (signed), so (default signed) 'char's get sign-extended
+        // and therefore 'corrupted' unless we force them to be unsigned
+        while (_input < _input_end && isspace(*reinterpret_cast<const unsigned char*>(_input))) {
+            ++_input;
+        }
+    }
+
     Status JParse::parseError(StringData msg) {
         std::ostringstream ossmsg;
         ossmsg << msg;
@@ -104,6 +134,29 @@ namespace mongo {
 
     Status JParse::value(StringData fieldName, BSONObjBuilder& builder) {
         MONGO_JSON_DEBUG("fieldName: " << fieldName);
+        const char* const valueStart = _input;
+        skipWhitespace();
+        // Strings and plain numbers are by far the most common values, so look for them before
+        // trying each of the keywords below.
+        if (_input < _input_end) {
+            if (*_input == '"' || *_input == '\'') {
+                std::string storage;
+                StringData valueString;
+                Status ret = quotedString(&valueString, &storage);
+                if (ret != Status::OK()) {
+                    return ret;
+                }
+                builder.append(fieldName, valueString);
+                return Status::OK();
+            }
+            if (isDigit(*_input) ||
+                    (*_input == '-' && _input + 1 < _input_end && isDigit(_input[1]))) {
+                return number(fieldName, builder);
+            }
+        }
+        // Keep the error offsets reported below where they have always been.
+        _input = valueStart;
+
         if (peekToken(LBRACE)) {
             Status ret = object(fieldName, builder);
             if (ret != Status::OK()) {
@@ -164,15 +217,6 @@ namespace mongo {
                 return ret;
             }
         }
-        else if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
-            std::string valueString;
-            valueString.reserve(STRINGVAL_RESERVE_SIZE);
-            Status ret = quotedString(&valueString);
-            if (ret != Status::OK()) {
-                return ret;
-            }
-            builder.append(fieldName, valueString);
-        }
         else if (readToken("true")) {
             builder.append(fieldName, true);
         }
@@ -223,9 +267,9 @@ namespace mongo {
         }
 
         // Special object
-        std::string firstField;
-        firstField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&firstField);
+        std::string firstFieldStorage;
+        StringData firstField;
+        Status ret = field(&firstField, &firstFieldStorage);
         if (ret != Status::OK()) {
             return ret;
         }
@@ -338,10 +382,10 @@ namespace mongo {
             if (valueRet != Status::OK()) {
                 return valueRet;
             }
+            std::string fieldNameStorage;
             while (readToken(COMMA)) {
-                std::string fieldName;
-                fieldName.reserve(FIELD_RESERVE_SIZE);
-                Status fieldRet = field(&fieldName);
+                StringData fieldName;
+                Status fieldRet = field(&fieldName, &fieldNameStorage);
                 if (fieldRet != Status::OK()) {
                     return fieldRet;
                 }
@@ -979,6 +1023,39 @@ namespace mongo {
     }
 
     Status JParse::number(StringData fieldName, BSONObjBuilder& builder) {
+        // Integers of up to 18 digits can't overflow a long long, so parse those here rather
+        // than through both strtod and strtoll.  Anything that strtod could read further (a
+        // fraction, an exponent or a hex number) takes the slow path below.
+        const char* p = _input;
+        const bool negative = (p < _input_end && *p == '-');
+        if (negative) {
+            ++p;
+        }
+        const char* const digits = p;
+        long long retInt = 0;
+        while (p < _input_end && p - digits < 19 && isDigit(*p)) {
+            retInt = retInt * 10 + (*p++ - '0');
+        }
+        const std::ptrdiff_t numDigits = p - digits;
+        if (numDigits > 0 && numDigits <= 18 &&
+                (p >= _input_end || !(isDigit(*p) || *p == '.' || *p == 'e' || *p == 'E' ||
+                                      *p == 'x' || *p == 'X'))) {
+            if (negative) {
+                retInt = -retInt;
+            }
+            if (retInt == static_cast<int>(retInt)) {
+                builder.append(fieldName, static_cast<int>(retInt));
+            }
+            else {
+                builder.append(fieldName, retInt);
+            }
+            _input = p;
+            if (_input >= _input_end) {
+                return parseError("Trailing number at end of input");
+            }
+            return Status::OK();
+        }
+
         char* endptrll;
         char* endptrd;
         long long retll;
@@ -1050,6 +1127,55 @@ namespace mongo {
         }
     }
 
+    Status JParse::field(StringData* result, std::string* storage) {
+        MONGO_JSON_DEBUG("");
+        skipWhitespace();
+        if (_input < _input_end && (*_input == '"' || *_input == '\'')) {
+            return quotedString(result, storage);
+        }
+        if (_input < _input_end && isFieldStartChar(*_input)) {
+            const char* q = _input + 1;
+            while (q < _input_end && isFieldChar(*q)) {
+                ++q;
+            }
+            // A name running up to the end of the input is an error, which field() reports.
+            if (q < _input_end && *q != '\0') {
+                *result = StringData(_input, q - _input);
+                _input = q;
+                return Status::OK();
+            }
+        }
+        storage->clear();
+        Status ret = field(storage);
+        if (ret == Status::OK()) {
+            *result = *storage;
+        }
+        return ret;
+    }
+
+    Status JParse::quotedString(StringData* result, std::string* storage) {
+        MONGO_JSON_DEBUG("");
+        skipWhitespace();
+        if (_input < _input_end && (*_input == '"' || *_input == '\'')) {
+            const char quote = *_input;
+            const char* const start = _input + 1;
+            const char* const end = plainRun(start, quote);
+            if (end < _input_end && *end == quote) {
+                *result = StringData(start, end - start);
+                _input = end + 1;
+                return Status::OK();
+            }
+        }
+        // Escape sequences, control characters and unterminated strings are left to the
+        // general parser.
+        storage->clear();
+        Status ret = quotedString(storage);
+        if (ret == Status::OK()) {
+            *result = *storage;
+        }
+        return ret;
+    }
+
     Status JParse::quotedString(std::string* result) {
         MONGO_JSON_DEBUG("");
         if (readToken(DOUBLEQUOTE)) {
@@ -1086,6 +1212,10 @@ namespace mongo {
         if (_input >= _input_end) {
             return parseError("Unexpected end of input");
         }
+        // With a single terminal character and no allowed set, runs of ordinary characters
+        // can be copied all at once.
+        const bool copyRuns = allowedSet == NULL && terminalSet[0] != '\0' &&
+                              terminalSet[1] == '\0';
         const char* q = _input;
         while (q < _input_end && !match(*q, terminalSet)) {
             MONGO_JSON_DEBUG("q: " << q);
@@ -1147,6 +1277,11 @@ namespace mongo {
                 }
                 ++q;
             }
+            else if (copyRuns) {
+                const char* runEnd = plainRun(q + 1, *terminalSet);
+                result->append(q, runEnd);
+                q = runEnd;
+            }
             else {
                 result->push_back(*q++);
             }
@@ -1175,6 +1310,32 @@ namespace mongo {
         return oss.str();
     }
 
+    const char* JParse::plainRun(const char* p, char quote) const {
+#ifdef MONGO_JSON_USE_SSE2
+        const __m128i quotes = _mm_set1_epi8(quote);
+        const __m128i backslashes = _mm_set1_epi8('\\');
+        const __m128i lastControl = _mm_set1_epi8(0x1F);
+        while (_input_end - p >= 16) {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // The bytes left unchanged by an unsigned max with 0x1F are the control characters.
+            const __m128i stops = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(chunk, quotes),
+                                 _mm_cmpeq_epi8(chunk, backslashes)),
+                    _mm_cmpeq_epi8(_mm_max_epu8(chunk, lastControl), lastControl));
+            const int stopMask = _mm_movemask_epi8(stops);
+            if (stopMask != 0) {
+                return p + countTrailingZeros64(stopMask);
+            }
+            p += 16;
+        }
+#endif
+        while (p < _input_end && *p != quote && *p != '\\' &&
+               static_cast<unsigned char>(*p) > 0x1F) {
+            ++p;
+        }
+        return p;
+    }
+
     inline bool JParse::peekToken(const char* token) {
         return readTokenImpl(token, false);
     }
@@ -1209,9 +1370,9 @@ namespace mongo {
 
     bool JParse::readField(StringData expectedField) {
         MONGO_JSON_DEBUG("expectedField: " << expectedField);
-        std::string nextField;
-        nextField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&nextField);
+        std::string nextFieldStorage;
+        StringData nextField;
+        Status ret = field(&nextField, &nextFieldStorage);
         if (ret != Status::OK()) {
             return false;
         }
@@ -1263,8 +1424,12 @@ namespace mongo {
             if (len) *len = 0;
             return BSONObj();
         }
-        JParse jparse(jsonString);
-        BSONObjBuilder builder;
+        const StringData input(jsonString);
+        JParse jparse(input);
+        // The BSON is usually about as long as the JSON text, so size the buffer for it up front
+        // instead of growing it over and over while parsing a large document.
+        BSONObjBuilder builder(std::max(512, static_cast<int>(std::min(
+                input.size(), static_cast<size_t>(BSONObjMaxUserSize)))));
         Status ret = Status::OK();
         try {
             ret = jparse.parse(builder);
@@ -360,6 +360,13 @@ namespace mongo {
              */
             Status field(std::string* result);
 
+            /**
+             * Same as field(std::string*), but when the field name has no escape sequences
+             * 'result' points directly into the input buffer and 'storage' is left untouched.
+             * Otherwise the unescaped name is built in 'storage' and 'result' points to it.
+             */
+            Status field(StringData* result, std::string* storage);
+
             /*
              * std::string :
              *     " "
@@ -369,6 +376,12 @@ namespace mongo {
              */
             Status quotedString(std::string* result);
 
+            /**
+             * Same as quotedString(std::string*), with the same use of 'storage' as
+             * field(StringData*, std::string*).
+             */
+            Status quotedString(StringData* result, std::string* storage);
+
             /*
              * CHARS :
              *     CHAR
@@ -413,6 +426,18 @@ namespace mongo {
              */
             std::string encodeUTF8(unsigned char first, unsigned char second) const;
 
+            /**
+             * @return a pointer to the first character in [p, _input_end) which is 'quote', a
+             * backslash or a control character, or _input_end if there is none.  The characters
+             * before it can be copied as they are.
+             */
+            const char* plainRun(const char* p, char quote) const;
+
+            /**
+             * Advances our buffer past any whitespace.
+             */
+            inline void skipWhitespace();
+
             /**
              * @return true if the given token matches the next non whitespace
              * sequence in our buffer, and false if the token doesn't match or
@@ -0,0 +1,326 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_compiled.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+    template <typename T>
+    bool compareValues(MatchExpression::MatchType type, T lhs, T rhs) {
+        switch (type) {
+        case MatchExpression::LT:
+            return lhs < rhs;
+        case MatchExpression::LTE:
+            return lhs <= rhs;
+        case MatchExpression::EQ:
+            return lhs == rhs;
+        case MatchExpression::GT:
+            return lhs > rhs;
+        case MatchExpression::GTE:
+            return lhs >= rhs;
+        default:
+            invariant(false);
+        }
+    }
+
+}  // namespace
+
+    struct CompiledMatchExpression::MatchState {
+        explicit MatchState(const BSONObj& d) : doc(d), sawArray(false) {
+            std::fill(resolved, resolved + kMaxPaths, false);
+        }
+
+        const BSONObj& doc;
+        BSONElement elements[kMaxPaths];
+        bool resolved[kMaxPaths];
+        bool sawArray;
+    };
+
+    CompiledMatchExpression::Instruction::Instruction(Op o, size_t e)
+        : op(o),
+          end(e),
+          path(0),
+          leaf(NULL),
+          compareType(MatchExpression::EQ),
+          longRhs(0),
+          doubleRhs(0) {
+    }
+
+    CompiledMatchExpression::PathNode::PathNode(size_t p, StringData f, StringData full)
+        : parent(p),
+          field(f.toString()),
+          fullPath(full.toString()) {
+    }
+
+    CompiledMatchExpression::CompiledMatchExpression(const MatchExpression* root)
+        : _root(root) {
+    }
+
+    // static
+    CompiledMatchExpression* CompiledMatchExpression::compile(const MatchExpression* root) {
+        std::auto_ptr<CompiledMatchExpression> compiled(new CompiledMatchExpression(root));
+        if (!compiled->_compileNode(root)) {
+            return NULL;
+        }
+        return compiled.release();
+    }
+
+    bool CompiledMatchExpression::_compileNode(const MatchExpression* expr) {
+        Instruction::Op op;
+        switch (expr->matchType()) {
+        case MatchExpression::AND:
+            op = Instruction::kAnd;
+            break;
+        case MatchExpression::OR:
+            op = Instruction::kOr;
+            break;
+        case MatchExpression::NOR:
+            op = Instruction::kNor;
+            break;
+        case MatchExpression::NOT:
+            op = Instruction::kNot;
+            break;
+        case MatchExpression::ATOMIC:
+            _program.push_back(Instruction(Instruction::kTrue, _program.size() + 1));
+            return true;
+        case MatchExpression::ALWAYS_FALSE:
+            _program.push_back(Instruction(Instruction::kFalse, _program.size() + 1));
+            return true;
+        case MatchExpression::LTE:
+        case MatchExpression::LT:
+        case MatchExpression::EQ:
+        case MatchExpression::GT:
+        case MatchExpression::GTE:
+        case MatchExpression::REGEX:
+        case MatchExpression::MOD:
+        case MatchExpression::EXISTS:
+        case MatchExpression::MATCH_IN:
+            return _compileLeaf(static_cast<const LeafMatchExpression*>(expr));
+        default:
+            // Array operators need the multikey semantics, and the special operators either
+            // aren't simple predicates over one element or can't be answered without an index.
+            return false;
+        }
+
+        const size_t index = _program.size();
+        _program.push_back(Instruction(op, 0));
+        for (size_t i = 0; i < expr->numChildren(); i++) {
+            if (!_compileNode(expr->getChild(i))) {
+                return false;
+            }
+        }
+        _program[index].end = _program.size();
+        return true;
+    }
+
+    bool CompiledMatchExpression::_compileLeaf(const LeafMatchExpression* leaf) {
+        if (leaf->path().empty()) {
+            return false;
+        }
+
+        const int path = _getPathNode(leaf->path());
+        if (path < 0) {
+            return false;
+        }
+
+        Instruction instruction(Instruction::kLeaf, _program.size() + 1);
+        instruction.path = path;
+        instruction.leaf = leaf;
+        instruction.compareType = leaf->matchType();
+
+        if (leaf->matchType() != MatchExpression::REGEX &&
+            leaf->matchType() != MatchExpression::MOD &&
+            leaf->matchType() != MatchExpression::EXISTS &&
+            leaf->matchType() != MatchExpression::MATCH_IN) {
+            const BSONElement& rhs = static_cast<const ComparisonMatchExpression*>(leaf)->getRHS();
+            if (rhs.type() == NumberInt || rhs.type() == NumberLong) {
+                instruction.op = Instruction::kCompareLong;
+                instruction.longRhs = rhs.numberLong();
+            }
+            else if (rhs.type() == NumberDouble && !std::isnan(rhs.numberDouble())) {
+                instruction.op = Instruction::kCompareDouble;
+                instruction.doubleRhs = rhs.numberDouble();
+            }
+            else if (rhs.type() == String && leaf->matchType() == MatchExpression::EQ) {
+                instruction.op = Instruction::kStringEquals;
+                instruction.stringRhs = StringData(rhs.valuestr(), rhs.valuestrsize() - 1);
+            }
+        }
+
+        _program.push_back(instruction);
+        return true;
+    }
+
+    int CompiledMatchExpression::_getPathNode(StringData path) {
+        for (size_t i = 0; i < _paths.size(); i++) {
+            if (_paths[i].fullPath == path) {
+                return i;
+            }
+        }
+
+        size_t parent = PathNode::kNoParent;
+        StringData field = path;
+        const size_t lastDot = path.rfind('.');
+        if (lastDot != std::string::npos) {
+            const int parentNode = _getPathNode(path.substr(0, lastDot));
+            if (parentNode < 0) {
+                return -1;
+            }
+            parent = parentNode;
+            field = path.substr(lastDot + 1);
+        }
+
+        if (_paths.size() >= kMaxPaths) {
+            return -1;
+        }
+        _paths.push_back(PathNode(parent, field, path));
+        return _paths.size() - 1;
+    }
+
+    bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+        MatchState state(doc);
+        size_t pc = 0;
+        const bool result = _run(&pc, &state);
+        if (state.sawArray) {
+            return _root->matchesBSON(doc);
+        }
+        return result;
+    }
+
+    BSONElement CompiledMatchExpression::_resolve(size_t node, MatchState* state) const {
+        if (state->resolved[node]) {
+            return state->elements[node];
+        }
+
+        const PathNode& path = _paths[node];
+        BSONElement element;
+        if (path.parent == PathNode::kNoParent) {
+            element = state->doc.getField(path.field);
+        }
+        else {
+            BSONElement parent = _resolve(path.parent, state);
+            if (parent.type() == Object) {
+                element = parent.embeddedObject().getField(path.field);
+            }
+        }
+
+        if (element.type() == Array) {
+            state->sawArray = true;
+        }
+
+        state->elements[node] = element;
+        state->resolved[node] = true;
+        return element;
+    }
+
+    bool CompiledMatchExpression::_run(size_t* pc, MatchState* state) const {
+        const Instruction& instruction = _program[*pc];
+
+        switch (instruction.op) {
+        case Instruction::kAnd:
+        case Instruction::kOr:
+        case Instruction::kNor: {
+            // AND stops at the first false child, OR and NOR at the first true one.
+            const bool stopOn = instruction.op != Instruction::kAnd;
+            ++*pc;
+            while (*pc < instruction.end) {
+                const bool childResult = _run(pc, state);
+                if (state->sawArray) {
+                    *pc = instruction.end;
+                    return false;
+                }
+                if (childResult == stopOn) {
+                    *pc = instruction.end;
+                    return instruction.op == Instruction::kOr;
+                }
+            }
+            return instruction.op != Instruction::kOr;
+        }
+        case Instruction::kNot:
+            ++*pc;
+            return !_run(pc, state);
+        case Instruction::kTrue:
+            *pc = instruction.end;
+            return true;
+        case Instruction::kFalse:
+            *pc = instruction.end;
+            return false;
+        default:
+            break;
+        }
+
+        // A leaf.
+        *pc = instruction.end;
+        const BSONElement element = _resolve(instruction.path, state);
+        if (state->sawArray) {
+            return false;
+        }
+
+        switch (instruction.op) {
+        case Instruction::kCompareLong:
+            if (element.type() == NumberInt || element.type() == NumberLong) {
+                return compareValues(instruction.compareType,
+                                     element.numberLong(),
+                                     instruction.longRhs);
+            }
+            break;
+        case Instruction::kCompareDouble:
+            if (element.type() == NumberDouble) {
+                const double value = element._numberDouble();
+                // NaN only matches NaN, and the operand isn't NaN.
+                if (std::isnan(value)) {
+                    return false;
+                }
+                return compareValues(instruction.compareType, value, instruction.doubleRhs);
+            }
+            break;
+        case Instruction::kStringEquals:
+            if (element.type() == String) {
+                return StringData(element.valuestr(), element.valuestrsize() - 1) ==
+                    instruction.stringRhs;
+            }
+            break;
+        default:
+            break;
+        }
+
+        return instruction.leaf->matchesSingleElement(element);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,167 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+    class LeafMatchExpression;
+
+    /**
+     * A MatchExpression flattened into a program for matching BSON documents quickly.
+     *
+     * Every path in the expression is resolved at most once per document, and paths that share a
+     * prefix (e.g. "a.b" and "a.c") resolve the prefix only once. The tree becomes a linear array
+     * of instructions in which each logical node records where its subtree ends, so that it can be
+     * skipped once the result is known. Comparisons of numbers and string equality are done
+     * directly instead of through the generic element comparison.
+     *
+     * Only documents without arrays along the paths of the expression are matched by the program.
+     * Arrays bring in the full multikey semantics, so documents with one are matched by the
+     * original expression instead.
+     *
+     * Holds pointers into the expression it was compiled from, which must outlive it and must
+     * not be changed.
+     */
+    class CompiledMatchExpression {
+        MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+    public:
+        /**
+         * Returns a new CompiledMatchExpression for 'root', owned by the caller, or NULL if
+         * 'root' uses an operator that can't be compiled.
+         */
+        static CompiledMatchExpression* compile(const MatchExpression* root);
+
+        /**
+         * Returns the same as root->matchesBSON(doc), without match details.
+         */
+        bool matchesBSON(const BSONObj& doc) const;
+
+        size_t numInstructions() const { return _program.size(); }
+        size_t numPaths() const { return _paths.size(); }
+
+    private:
+        // Compiling gives up on expressions with more distinct paths and path prefixes than this,
+        // which keeps the per document state on the stack.
+        static const size_t kMaxPaths = 32;
+
+        struct Instruction {
+            enum Op {
+                // Logical nodes. The children follow, up to 'end'.
+                kAnd,
+                kOr,
+                kNor,
+                kNot,
+
+                // Constants.
+                kTrue,
+                kFalse,
+
+                // leaf->matchesSingleElement() on the element at 'path'.
+                kLeaf,
+
+                // Comparisons of a NumberInt or NumberLong at 'path' with 'longRhs'.
+                kCompareLong,
+
+                // Comparisons of a NumberDouble at 'path' with 'doubleRhs'.
+                kCompareDouble,
+
+                // Equality of a String at 'path' with 'stringRhs'.
+                kStringEquals,
+            };
+
+            Instruction(Op op, size_t end);
+
+            Op op;
+
+            // Index of the instruction following this one's subtree.
+            size_t end;
+
+            // For leaves.
+            size_t path;
+            const LeafMatchExpression* leaf;
+            MatchExpression::MatchType compareType;
+            long long longRhs;
+            double doubleRhs;
+            StringData stringRhs;
+        };
+
+        // A path, or the prefix of one, in the expression. Paths are resolved by looking up
+        // 'field' in the object at the parent path, or in the document for top level fields.
+        struct PathNode {
+            static const size_t kNoParent = static_cast<size_t>(-1);
+
+            PathNode(size_t parent, StringData field, StringData fullPath);
+
+            size_t parent;
+            std::string field;
+            std::string fullPath;
+        };
+
+        struct MatchState;
+
+        explicit CompiledMatchExpression(const MatchExpression* root);
+
+        /**
+         * Appends the instructions for 'expr'. Returns false if it can't be compiled.
+         */
+        bool _compileNode(const MatchExpression* expr);
+        bool _compileLeaf(const LeafMatchExpression* leaf);
+
+        /**
+         * Returns the index of the node for 'path', adding it and its prefixes if needed, or -1
+         * if there would be too many.
+         */
+        int _getPathNode(StringData path);
+
+        /**
+         * Runs the instruction at '*pc' and advances '*pc' past its subtree.
+         */
+        bool _run(size_t* pc, MatchState* state) const;
+
+        /**
+         * The element at path 'node' in the document, or EOO if it doesn't exist. Sets
+         * state->sawArray if resolving the path meets an array.
+         */
+        BSONElement _resolve(size_t node, MatchState* state) const;
+
+        const MatchExpression* const _root;
+        std::vector<Instruction> _program;
+        std::vector<PathNode> _paths;
+    };
+
+}  // namespace mongo
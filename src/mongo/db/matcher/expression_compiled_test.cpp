@@ -0,0 +1,151 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/unittest/unittest.h"
+
+#include "mongo/db/matcher/expression_compiled.h"
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+
+namespace mongo {
+
+    using boost::scoped_ptr;
+
+namespace {
+
+    const char* const kDocs[] = {
+        "{}",
+        "{a: 1}",
+        "{a: 1.5}",
+        "{a: NumberLong(3)}",
+        "{a: NaN}",
+        "{a: 'x'}",
+        "{a: 'xy'}",
+        "{a: null}",
+        "{a: {b: 1, c: 'x'}}",
+        "{a: {b: {c: 2}}}",
+        "{a: {b: [1, 2]}}",
+        "{a: [1, 5, 'x']}",
+        "{a: [{b: 1}, {b: 3}]}",
+        "{a: 5, b: 'x', c: {d: 4}}",
+        "{a: 2, b: 3, c: null}",
+        "{a: {'0': 4}}",
+    };
+
+    /**
+     * Checks that 'query' compiles and that its compiled form agrees with the expression on every
+     * document in kDocs.
+     */
+    void assertSameMatches(const char* query) {
+        StatusWithMatchExpression result = MatchExpressionParser::parse(fromjson(query));
+        ASSERT_OK(result.getStatus());
+        scoped_ptr<MatchExpression> expr(result.getValue());
+
+        scoped_ptr<CompiledMatchExpression> compiled(CompiledMatchExpression::compile(expr.get()));
+        ASSERT(compiled) << query;
+
+        for (size_t i = 0; i < sizeof(kDocs) / sizeof(kDocs[0]); i++) {
+            BSONObj doc = fromjson(kDocs[i]);
+            ASSERT_EQUALS(expr->matchesBSON(doc), compiled->matchesBSON(doc))
+                << query << " on " << kDocs[i];
+        }
+    }
+
+    TEST(CompiledMatchExpressionTest, Comparisons) {
+        assertSameMatches("{a: 1}");
+        assertSameMatches("{a: {$gt: 1}}");
+        assertSameMatches("{a: {$gte: 1.5}}");
+        assertSameMatches("{a: {$lt: NumberLong(3)}}");
+        assertSameMatches("{a: {$lte: 3}}");
+        assertSameMatches("{a: NaN}");
+        assertSameMatches("{a: {$gt: NaN}}");
+        assertSameMatches("{a: 'x'}");
+        assertSameMatches("{a: {$gt: 'x'}}");
+        assertSameMatches("{a: null}");
+        assertSameMatches("{a: {b: 1, c: 'x'}}");
+        assertSameMatches("{a: {$lt: {$maxKey: 1}}}");
+    }
+
+    TEST(CompiledMatchExpressionTest, OtherLeaves) {
+        assertSameMatches("{a: /^x/}");
+        assertSameMatches("{a: {$mod: [2, 1]}}");
+        assertSameMatches("{a: {$exists: true}}");
+        assertSameMatches("{a: {$exists: false}}");
+        assertSameMatches("{a: {$in: [1, 'x', null]}}");
+        assertSameMatches("{a: {$nin: [1, 'x']}}");
+        assertSameMatches("{a: {$ne: 1}}");
+    }
+
+    TEST(CompiledMatchExpressionTest, DottedPaths) {
+        assertSameMatches("{'a.b': 1}");
+        assertSameMatches("{'a.b.c': {$gte: 2}}");
+        assertSameMatches("{'a.b': 1, 'a.c': 'x'}");
+        assertSameMatches("{'a.0': 4}");
+        assertSameMatches("{'a.b': null}");
+        assertSameMatches("{'c.d': {$exists: true}}");
+    }
+
+    TEST(CompiledMatchExpressionTest, LogicalOperators) {
+        assertSameMatches("{a: {$gt: 1, $lt: 5}}");
+        assertSameMatches("{$or: [{a: 1}, {b: 'x'}]}");
+        assertSameMatches("{$nor: [{a: 1}, {b: 'x'}]}");
+        assertSameMatches("{a: {$not: {$gt: 2}}}");
+        assertSameMatches("{$and: [{$or: [{a: 5}, {a: 2}]}, {$or: [{b: 'x'}, {b: 3}]}]}");
+        assertSameMatches("{$or: [{'a.b': 1}, {c: null}], a: {$exists: true}}");
+    }
+
+    TEST(CompiledMatchExpressionTest, SharesPathPrefixes) {
+        StatusWithMatchExpression result =
+            MatchExpressionParser::parse(fromjson("{'a.b': 1, 'a.c': 2, a: {$exists: true}}"));
+        ASSERT_OK(result.getStatus());
+        scoped_ptr<MatchExpression> expr(result.getValue());
+
+        scoped_ptr<CompiledMatchExpression> compiled(CompiledMatchExpression::compile(expr.get()));
+        ASSERT(compiled);
+        // "a", "a.b" and "a.c".
+        ASSERT_EQUALS(3U, compiled->numPaths());
+        // The AND and its three children.
+        ASSERT_EQUALS(4U, compiled->numInstructions());
+    }
+
+    TEST(CompiledMatchExpressionTest, ArrayOperatorsAreNotCompiled) {
+        StatusWithMatchExpression result =
+            MatchExpressionParser::parse(fromjson("{a: 1, b: {$elemMatch: {$gt: 1}}}"));
+        ASSERT_OK(result.getStatus());
+        scoped_ptr<MatchExpression> expr(result.getValue());
+
+        ASSERT(!CompiledMatchExpression::compile(expr.get()));
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -30,8 +30,15 @@
 
 #include "mongo/db/matcher/expression_leaf.h"
 
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <cctype>
 #include <cmath>
+#include <cstring>
+#include <map>
 #include <pcrecpp.h>
+#include <utility>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
@@ -219,8 +226,103 @@ namespace mongo {
         return options;
     }
 
+    namespace {
+
+        typedef boost::shared_ptr<const pcrecpp::RE> CompiledRegex;
+        typedef std::map<std::pair<std::string, std::string>, CompiledRegex> RegexCache;
+
+        // Compiled regexes are shared by all expressions with the same regex and flags, so that
+        // the same query coming in again, or being cloned by the planner, doesn't compile again.
+        // The cache is emptied whenever it fills up.
+        const size_t kRegexCacheMaxEntries = 1000;
+        const size_t kRegexCacheMaxPatternSize = 4096;
+
+        boost::mutex regexCacheMutex;
+        RegexCache regexCache;
+
+        CompiledRegex compileRegex( const std::string& regex, const std::string& flags ) {
+            if ( regex.size() > kRegexCacheMaxPatternSize ) {
+                return CompiledRegex( new pcrecpp::RE( regex.c_str(),
+                                                       flags2options( flags.c_str() ) ) );
+            }
+
+            const RegexCache::key_type key( regex, flags );
+            {
+                boost::lock_guard<boost::mutex> lk( regexCacheMutex );
+                RegexCache::const_iterator it = regexCache.find( key );
+                if ( it != regexCache.end() )
+                    return it->second;
+            }
+
+            // Compile outside the mutex. If another thread gets there first we use its regex.
+            CompiledRegex re( new pcrecpp::RE( regex.c_str(), flags2options( flags.c_str() ) ) );
+
+            boost::lock_guard<boost::mutex> lk( regexCacheMutex );
+            if ( regexCache.size() >= kRegexCacheMaxEntries )
+                regexCache.clear();
+            return regexCache.insert( std::make_pair( key, re ) ).first->second;
+        }
+
+        bool isAscii( StringData str ) {
+            for ( size_t i = 0; i < str.size(); i++ ) {
+                if ( static_cast<unsigned char>( str[i] ) >= 0x80 )
+                    return false;
+            }
+            return true;
+        }
+
+        char asciiToLower( char c ) {
+            return ( c >= 'A' && c <= 'Z' ) ? c - 'A' + 'a' : c;
+        }
+
+        /**
+         * Whether 'str' contains 'lowerNeedle', which is all lower case, ignoring ASCII case.
+         */
+        bool containsIgnoringAsciiCase( StringData str, StringData lowerNeedle ) {
+            if ( lowerNeedle.size() > str.size() )
+                return false;
+            const size_t last = str.size() - lowerNeedle.size();
+            for ( size_t i = 0; i <= last; i++ ) {
+                size_t j = 0;
+                while ( j < lowerNeedle.size() && asciiToLower( str[i + j] ) == lowerNeedle[j] )
+                    j++;
+                if ( j == lowerNeedle.size() )
+                    return true;
+            }
+            return false;
+        }
+
+        /**
+         * Appends the characters at the start of 'regex' which match themselves to 'literal', and
+         * returns the position of the first one which doesn't.
+         */
+        size_t parseLiteral( StringData regex, std::string* literal ) {
+            size_t i = 0;
+            while ( i < regex.size() ) {
+                const char c = regex[i];
+                if ( c == '\\' ) {
+                    // A backslash followed by a non-alphanumeric character stands for that
+                    // character, otherwise it starts an escape sequence.
+                    if ( i + 1 == regex.size() ||
+                         isalnum( static_cast<unsigned char>( regex[i + 1] ) ) )
+                        return i;
+                    literal->push_back( regex[i + 1] );
+                    i += 2;
+                    continue;
+                }
+                // The metacharacters from man pcrepattern.
+                if ( c == '\0' || strchr( "^$.[|()?*+{", c ) )
+                    return i;
+                literal->push_back( c );
+                i++;
+            }
+            return i;
+        }
+
+    }  // namespace
+
     RegexMatchExpression::RegexMatchExpression()
-        : LeafMatchExpression( REGEX ) {}
+        : LeafMatchExpression( REGEX ), _literalKind( kNoLiteral ) {}
 
     RegexMatchExpression::~RegexMatchExpression() {}
 
@@ -250,21 +352,96 @@ namespace mongo {
 
         _regex = regex.toString();
         _flags = options.toString();
-        _re.reset( new pcrecpp::RE( _regex.c_str(), flags2options( _flags.c_str() ) ) );
+        _re = compileRegex( _regex, _flags );
+        _analyzeLiteral();
 
         return initPath( path );
     }
 
+    void RegexMatchExpression::_analyzeLiteral() {
+        _literalKind = kNoLiteral;
+        _literal.clear();
+
+        // A regex which doesn't compile matches nothing.
+        if ( !_re->error().empty() )
+            return;
+
+        bool caseless = false;
+        bool multiline = false;
+        for ( size_t i = 0; i < _flags.size(); i++ ) {
+            switch ( _flags[i] ) {
+            case 'i': caseless = true; break;
+            case 'm': multiline = true; break;
+            case 's': break;
+            default: return; // 'x' changes which characters are literal.
+            }
+        }
+
+        // Only ASCII literals, so that matching bytes is the same as matching UTF-8 characters.
+        std::string literal;
+        if ( parseLiteral( _regex, &literal ) == _regex.size() ) {
+            if ( !isAscii( literal ) )
+                return;
+            if ( caseless ) {
+                std::transform( literal.begin(), literal.end(), literal.begin(), asciiToLower );
+                _literalKind = kCaselessLiteral;
+            }
+            else {
+                _literalKind = kLiteral;
+            }
+            _literal = literal;
+            return;
+        }
+
+        // An alternation anywhere could make the prefix optional.
+        if ( caseless || _regex.find( '|' ) != std::string::npos )
+            return;
+
+        StringData rest( _regex );
+        if ( rest.startsWith( "\\A" ) )
+            rest = rest.substr( 2 );
+        else if ( rest.startsWith( "^" ) && !multiline )
+            rest = rest.substr( 1 );
+        else
+            return;
+
+        const size_t end = parseLiteral( rest, &literal );
+        if ( end < rest.size() && strchr( "?*{", rest[end] ) && !literal.empty() ) {
+            // The quantifier applies to the last character, which may not be there.
+            literal.resize( literal.size() - 1 );
+        }
+
+        if ( !literal.empty() && isAscii( literal ) ) {
+            _literalKind = kRequiredPrefix;
+            _literal = literal;
+        }
+    }
+
     bool RegexMatchExpression::matchesSingleElement( const BSONElement& e ) const {
         //log() << "RegexMatchExpression::matchesSingleElement _regex: " << _regex << " e: " << e << std::endl;
         switch (e.type()) {
         case String:
-        case Symbol:
-            // TODO
-            //if (rm._prefix.empty())
-                return _re->PartialMatch(e.valuestr());
-                //else
-                //return !strncmp(e.valuestr(), rm._prefix.c_str(), rm._prefix.size());
+        case Symbol: {
+            // The regex sees the string up to its first NUL.
+            const StringData str( e.valuestr() );
+            switch ( _literalKind ) {
+            case kLiteral:
+                return str.find( _literal ) != std::string::npos;
+            case kCaselessLiteral:
+                if ( containsIgnoringAsciiCase( str, _literal ) )
+                    return true;
+                if ( isAscii( str ) )
+                    return false;
+                break;
+            case kRequiredPrefix:
+                if ( !str.startsWith( _literal ) )
+                    return false;
+                break;
+            case kNoLiteral:
+                break;
+            }
+            return _re->PartialMatch( e.valuestr() );
+        }
         case RegEx:
             return _regex == e.regex() && _flags == e.regexFlags();
         default:
@@ -442,6 +619,7 @@ namespace mongo {
     ArrayFilterEntries::ArrayFilterEntries(){
         _hasNull = false;
         _hasEmptyArray = false;
+        _equalitiesSorted = true;
     }
 
     ArrayFilterEntries::~ArrayFilterEntries() {
@@ -466,10 +644,39 @@ namespace mongo {
         if ( e.type() == Array && e.Obj().isEmpty() )
             _hasEmptyArray = true;
 
-        _equalities.insert( e );
+        if ( _equalitiesSorted && !_equalities.empty() &&
+             !BSONElementCmpWithoutField()( _equalities.back(), e ) ) {
+            _equalitiesSorted = false;
+        }
+        _equalities.push_back( e );
         return Status::OK();
     }
 
+    namespace {
+        bool equalWithoutField( const BSONElement& l, const BSONElement& r ) {
+            return l.woCompare( r, false ) == 0;
+        }
+    }
+
+    void ArrayFilterEntries::sortEqualities() const {
+        if ( _equalitiesSorted )
+            return;
+
+        // Stable, so that of equal elements the first one added is kept, as with a set.
+        std::stable_sort( _equalities.begin(), _equalities.end(), BSONElementCmpWithoutField() );
+        _equalities.erase( std::unique( _equalities.begin(), _equalities.end(), equalWithoutField ),
+                           _equalities.end() );
+        _equalitiesSorted = true;
+    }
+
+    bool ArrayFilterEntries::contains( const BSONElement& elem ) const {
+        sortEqualities();
+        return std::binary_search( _equalities.begin(),
+                                   _equalities.end(),
+                                   elem,
+                                   BSONElementCmpWithoutField() );
+    }
+
     Status ArrayFilterEntries::addRegex( RegexMatchExpression* expr ) {
         _regexes.push_back( expr );
         return Status::OK();
@@ -485,20 +692,21 @@ namespace mongo {
             if ( !_regexes[i]->equivalent( other._regexes[i] ) )
                 return false;
 
-        return _equalities == other._equalities;
+        return equalities() == other.equalities();
     }
 
     void ArrayFilterEntries::copyTo( ArrayFilterEntries& toFillIn ) const {
         toFillIn._hasNull = _hasNull;
         toFillIn._hasEmptyArray = _hasEmptyArray;
         toFillIn._equalities = _equalities;
+        toFillIn._equalitiesSorted = _equalitiesSorted;
         for ( unsigned i = 0; i < _regexes.size(); i++ )
             toFillIn._regexes.push_back( static_cast<RegexMatchExpression*>(_regexes[i]->shallowClone()) );
     }
 
     void ArrayFilterEntries::debugString( StringBuilder& debug ) const {
         debug << "[ ";
-        for (BSONElementSet::const_iterator it = _equalities.begin();
+        for (std::vector<BSONElement>::const_iterator it = equalities().begin();
                 it != _equalities.end(); ++it) {
             debug << it->toString( false ) << " ";
         }
@@ -510,7 +718,7 @@ namespace mongo {
     }
 
     void ArrayFilterEntries::toBSON(BSONArrayBuilder* out) const {
-        for (BSONElementSet::const_iterator it = _equalities.begin();
+        for (std::vector<BSONElement>::const_iterator it = equalities().begin();
                 it != _equalities.end(); ++it) {
             out->append(*it);
         }
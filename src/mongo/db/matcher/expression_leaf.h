@@ -31,6 +31,8 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <vector>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
@@ -219,9 +221,31 @@ namespace mongo {
         const std::string& getFlags() const { return _flags; }
 
     private:
+        /**
+         * How matchesSingleElement() can answer for a string without running the regex.
+         */
+        enum LiteralKind {
+            // Always run the regex.
+            kNoLiteral,
+            // The regex matches exactly the strings containing _literal.
+            kLiteral,
+            // The same, ignoring case. Strings with non-ASCII characters which don't contain
+            // _literal ignoring ASCII case still run the regex, as those characters may fold.
+            kCaselessLiteral,
+            // Only strings starting with _literal can match.
+            kRequiredPrefix,
+        };
+
+        void _analyzeLiteral();
+
         std::string _regex;
         std::string _flags;
-        boost::scoped_ptr<pcrecpp::RE> _re;
+
+        // Shared with every other expression for the same regex and flags.
+        boost::shared_ptr<const pcrecpp::RE> _re;
+
+        LiteralKind _literalKind;
+        std::string _literal;
     };
 
     class ModMatchExpression : public LeafMatchExpression {
@@ -285,6 +309,10 @@ namespace mongo {
      * holds the entries of an $in or $all
      * either scalars or regex
      */
+    /**
+     * The equalities are kept in a flat array which is sorted, without duplicates, before the
+     * first lookup, so that very large $in lists are cheap to build and to probe.
+     */
     class ArrayFilterEntries {
         MONGO_DISALLOW_COPYING( ArrayFilterEntries );
     public:
@@ -294,8 +322,22 @@ namespace mongo {
         Status addEquality( const BSONElement& e );
         Status addRegex( RegexMatchExpression* expr );
 
-        const BSONElementSet& equalities() const { return _equalities; }
-        bool contains( const BSONElement& elem ) const { return _equalities.count(elem) > 0; }
+        /**
+         * Sorts the equalities added so far. Lookups do it when needed, but entries used by
+         * several threads at once must have been sorted already.
+         */
+        void sortEqualities() const;
+
+        /**
+         * The distinct equalities in BSONElementCmpWithoutField order. Of equal elements such as
+         * 1 and 1.0, the one added first is kept.
+         */
+        const std::vector<BSONElement>& equalities() const {
+            sortEqualities();
+            return _equalities;
+        }
+
+        bool contains( const BSONElement& elem ) const;
 
         size_t numRegexes() const { return _regexes.size(); }
         RegexMatchExpression* regex( int idx ) const { return _regexes[idx]; }
@@ -303,7 +345,7 @@ namespace mongo {
         bool hasNull() const { return _hasNull; }
         bool singleNull() const { return size() == 1 && _hasNull; }
         bool hasEmptyArray() const { return _hasEmptyArray; }
-        int size() const { return _equalities.size() + _regexes.size(); }
+        int size() const { return equalities().size() + _regexes.size(); }
 
         bool equivalent( const ArrayFilterEntries& other ) const;
 
@@ -316,7 +358,10 @@ namespace mongo {
     private:
         bool _hasNull; // if _equalities has a jstNULL element in it
         bool _hasEmptyArray;
-        BSONElementSet _equalities;
+
+        mutable std::vector<BSONElement> _equalities;
+        // Whether _equalities is sorted and deduplicated.
+        mutable bool _equalitiesSorted;
         std::vector<RegexMatchExpression*> _regexes;
     };
 
@@ -1048,6 +1048,55 @@ namespace mongo {
         ASSERT( regex.matchesSingleElement( multiByteCharacter.firstElement() ) );
     }
 
+    TEST( RegexMatchExpression, MatchesElementLiteral ) {
+        RegexMatchExpression regex;
+        ASSERT( regex.init( "", "b\\.c\\/", "s" ).isOK() );
+        ASSERT( regex.matchesSingleElement( BSON( "x" << "ab.c/d" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "abxc/d" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "AB.C/D" ).firstElement() ) );
+
+        RegexMatchExpression empty;
+        ASSERT( empty.init( "", "", "" ).isOK() );
+        ASSERT( empty.matchesSingleElement( BSON( "x" << "" ).firstElement() ) );
+    }
+
+    TEST( RegexMatchExpression, MatchesElementCaseInsensitiveLiteral ) {
+        RegexMatchExpression regex;
+        ASSERT( regex.init( "", "kB", "i" ).isOK() );
+        ASSERT( regex.matchesSingleElement( BSON( "x" << "xxKbxx" ).firstElement() ) );
+        ASSERT( regex.matchesSingleElement( BSON( "x" << "\xc2\xa5kb" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "k b" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "\xc2\xa5k" ).firstElement() ) );
+    }
+
+    TEST( RegexMatchExpression, MatchesElementRequiredPrefix ) {
+        RegexMatchExpression regex;
+        ASSERT( regex.init( "", "^abc*d", "" ).isOK() );
+        ASSERT( regex.matchesSingleElement( BSON( "x" << "abd" ).firstElement() ) );
+        ASSERT( regex.matchesSingleElement( BSON( "x" << "abcccd" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "abc" ).firstElement() ) );
+        ASSERT( !regex.matchesSingleElement( BSON( "x" << "xabd" ).firstElement() ) );
+
+        // With the multiline flag '^' also matches after a newline.
+        RegexMatchExpression multiline;
+        ASSERT( multiline.init( "", "^ab.", "m" ).isOK() );
+        ASSERT( multiline.matchesSingleElement( BSON( "x" << "x\nabc" ).firstElement() ) );
+
+        RegexMatchExpression alternation;
+        ASSERT( alternation.init( "", "^ab|c", "" ).isOK() );
+        ASSERT( alternation.matchesSingleElement( BSON( "x" << "xc" ).firstElement() ) );
+    }
+
+    TEST( RegexMatchExpression, SharesCompiledRegex ) {
+        RegexMatchExpression r1;
+        RegexMatchExpression r2;
+        ASSERT( r1.init( "a", "^b.*c", "" ).isOK() );
+        ASSERT( r2.init( "b", "^b.*c", "" ).isOK() );
+        ASSERT( r1.matchesBSON( BSON( "a" << "bxc" ), NULL ) );
+        ASSERT( r2.matchesBSON( BSON( "b" << "bxc" ), NULL ) );
+        ASSERT( !r2.matchesBSON( BSON( "b" << "bx" ), NULL ) );
+    }
+
     TEST( RegexMatchExpression, MatchesScalar ) {
         RegexMatchExpression regex;
         ASSERT( regex.init( "a", "b", "" ).isOK() );
@@ -1479,6 +1528,46 @@ namespace mongo {
     }
 
 
+    TEST( InMatchExpression, MatchesManyUnsorted ) {
+        BSONArrayBuilder values;
+        for ( int i = 0; i < 1000; i++ ) {
+            values.append( ( i * 7919 ) % 1000 );
+            values.append( "s" + BSONObjBuilder::numStr( i ) );
+        }
+        BSONObj operand = values.arr();
+        InMatchExpression in;
+        in.init( "a" );
+        BSONObjIterator it( operand );
+        while ( it.more() ) {
+            in.getArrayFilterEntries()->addEquality( it.next() );
+        }
+        ASSERT_EQUALS( 2000, in.getData().size() );
+
+        ASSERT( in.matchesBSON( BSON( "a" << 0 ), NULL ) );
+        ASSERT( in.matchesBSON( BSON( "a" << 999.0 ), NULL ) );
+        ASSERT( in.matchesBSON( BSON( "a" << "s500" ), NULL ) );
+        ASSERT( !in.matchesBSON( BSON( "a" << 1000 ), NULL ) );
+        ASSERT( !in.matchesBSON( BSON( "a" << 0.5 ), NULL ) );
+        ASSERT( !in.matchesBSON( BSON( "a" << "s1000" ), NULL ) );
+    }
+
+    TEST( InMatchExpression, KeepsFirstOfEqualValues ) {
+        BSONObj operand = BSON_ARRAY( 2 << 1.0 << 1 << 2LL );
+        InMatchExpression in;
+        in.init( "a" );
+        in.getArrayFilterEntries()->addEquality( operand[0] );
+        in.getArrayFilterEntries()->addEquality( operand[1] );
+        in.getArrayFilterEntries()->addEquality( operand[2] );
+        in.getArrayFilterEntries()->addEquality( operand[3] );
+
+        const std::vector<BSONElement>& equalities = in.getData().equalities();
+        ASSERT_EQUALS( 2U, equalities.size() );
+        ASSERT_EQUALS( NumberDouble, equalities[0].type() );
+        ASSERT_EQUALS( NumberInt, equalities[1].type() );
+        ASSERT( in.matchesBSON( BSON( "a" << 1 ), NULL ) );
+        ASSERT( in.matchesBSON( BSON( "a" << 2.0 ), NULL ) );
+    }
+
     TEST( InMatchExpression, MatchesScalar ) {
         BSONObj operand = BSON_ARRAY( 5 );
         InMatchExpression in;
@@ -637,6 +637,8 @@ namespace mongo {
                     return s;
             }
         }
+
+        entries->sortEqualities();
         return Status::OK();
 
     }
@@ -129,7 +129,8 @@ namespace mongo {
 
     bool WhereMatchExpression::matches( const MatchableDocument* doc, MatchDetails* details ) const {
         verify( _func );
-        BSONObj obj = doc->toBSON();
+        // Both "obj" and "this" wrap the document, make them share one owned copy of it
+        BSONObj obj = doc->toBSON().getOwned();
 
         if ( ! _userScope.isEmpty() ) {
             _scope->init( &_userScope );
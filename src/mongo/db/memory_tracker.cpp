@@ -0,0 +1,208 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/memory_tracker.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    // The budgets of the trackers, in bytes.  0 means unlimited.  When a consumer goes over
+    // budget it does what it does when it goes over its own limit: spill to disk if it can and
+    // is allowed to, fail otherwise.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryMemoryBudgetBytes, long long, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQuerySortMemoryBudgetBytes, long long, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryGroupMemoryBudgetBytes, long long, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryAndHashMemoryBudgetBytes, long long, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryOperationMemoryBudgetBytes, long long, 0);
+
+namespace {
+
+    struct OperationMemoryTracker {
+        OperationMemoryTracker()
+            : tracker("operation", NULL, &internalQueryOperationMemoryBudgetBytes) { }
+
+        MemoryTracker tracker;
+    };
+
+    const auto operationMemoryTracker =
+        OperationContext::declareDecoration<OperationMemoryTracker>();
+
+}  // namespace
+
+    MemoryTracker::MemoryTracker(StringData name,
+                                 MemoryTracker* parent,
+                                 const long long* budgetBytes)
+        : _name(name.toString()),
+          _parent(parent),
+          _budgetBytes(budgetBytes) { }
+
+    long long MemoryTracker::_budget() const {
+        return _budgetBytes ? *_budgetBytes : 0;
+    }
+
+    void MemoryTracker::_updatePeak(long long current) {
+        long long peak = _peakBytes.load();
+        while (current > peak) {
+            const long long seen = _peakBytes.compareAndSwap(peak, current);
+            if (seen == peak) {
+                break;
+            }
+            peak = seen;
+        }
+    }
+
+    Status MemoryTracker::charge(long long bytes) {
+        for (MemoryTracker* tracker = this; tracker; tracker = tracker->_parent) {
+            const long long budget = tracker->_budget();
+            const long long current = tracker->_currentBytes.addAndFetch(bytes);
+            if (budget > 0 && current > budget) {
+                // Undo this tracker and the ones charged before it.
+                tracker->_currentBytes.subtractAndFetch(bytes);
+                for (MemoryTracker* charged = this; charged != tracker;
+                     charged = charged->_parent) {
+                    charged->_currentBytes.subtractAndFetch(bytes);
+                }
+                return Status(ErrorCodes::ExceededMemoryLimit,
+                              str::stream() << "using " << bytes << " more bytes would exceed"
+                                            << " the " << budget << " byte memory budget for "
+                                            << tracker->_name);
+            }
+        }
+
+        // Only count the peaks once the charge succeeded.
+        for (MemoryTracker* tracker = this; tracker; tracker = tracker->_parent) {
+            tracker->_updatePeak(tracker->_currentBytes.load());
+        }
+        return Status::OK();
+    }
+
+    void MemoryTracker::forceCharge(long long bytes) {
+        for (MemoryTracker* tracker = this; tracker; tracker = tracker->_parent) {
+            tracker->_updatePeak(tracker->_currentBytes.addAndFetch(bytes));
+        }
+    }
+
+    void MemoryTracker::release(long long bytes) {
+        for (MemoryTracker* tracker = this; tracker; tracker = tracker->_parent) {
+            const long long current = tracker->_currentBytes.subtractAndFetch(bytes);
+            dassert(current >= 0);
+        }
+    }
+
+    void MemoryTracker::appendStats(BSONObjBuilder* builder) const {
+        builder->appendNumber("currentBytes", currentBytes());
+        builder->appendNumber("peakBytes", peakBytes());
+        builder->appendNumber("budgetBytes", _budget());
+    }
+
+    // static
+    MemoryTracker* MemoryTracker::global() {
+        static MemoryTracker* const tracker =
+            new MemoryTracker("query", NULL, &internalQueryMemoryBudgetBytes);
+        return tracker;
+    }
+
+    // static
+    MemoryTracker* MemoryTracker::forSubsystem(Subsystem subsystem) {
+        static MemoryTracker* const trackers[kNumSubsystems] = {
+            new MemoryTracker("sort", global(), &internalQuerySortMemoryBudgetBytes),
+            new MemoryTracker("group", global(), &internalQueryGroupMemoryBudgetBytes),
+            new MemoryTracker("andHash", global(), &internalQueryAndHashMemoryBudgetBytes),
+        };
+        invariant(subsystem >= 0 && subsystem < kNumSubsystems);
+        return trackers[subsystem];
+    }
+
+    // static
+    MemoryTracker* MemoryTracker::forOperation(OperationContext* txn) {
+        return &operationMemoryTracker(txn).tracker;
+    }
+
+    MemoryCharge::MemoryCharge(MemoryTracker::Subsystem subsystem)
+        : _subsystem(MemoryTracker::forSubsystem(subsystem)),
+          _operation(NULL),
+          _bytes(0),
+          _peakBytes(0) { }
+
+    MemoryCharge::~MemoryCharge() {
+        set(0);
+    }
+
+    Status MemoryCharge::set(long long bytes) {
+        const long long delta = bytes - _bytes;
+        if (delta > 0) {
+            Status status = _subsystem->charge(delta);
+            if (!status.isOK()) {
+                return status;
+            }
+            if (_operation) {
+                status = _operation->charge(delta);
+                if (!status.isOK()) {
+                    _subsystem->release(delta);
+                    return status;
+                }
+            }
+        }
+        else if (delta < 0) {
+            _subsystem->release(-delta);
+            if (_operation) {
+                _operation->release(-delta);
+            }
+        }
+
+        _bytes = bytes;
+        if (_bytes > _peakBytes) {
+            _peakBytes = _bytes;
+        }
+        return Status::OK();
+    }
+
+    void MemoryCharge::setOperationContext(OperationContext* txn) {
+        MemoryTracker* operation = txn ? MemoryTracker::forOperation(txn) : NULL;
+        if (operation == _operation) {
+            return;
+        }
+
+        if (_operation) {
+            _operation->release(_bytes);
+        }
+        // The memory is already in use, so the new operation takes it over its budget if it must.
+        if (operation) {
+            operation->forceCharge(_bytes);
+        }
+        _operation = operation;
+    }
+
+}  // namespace mongo
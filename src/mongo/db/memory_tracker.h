@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class OperationContext;
+
+    /**
+     * Counts the bytes of memory charged to it against an optional budget.  Trackers form a
+     * hierarchy: a charge is made against a tracker and all its ancestors, and fails without
+     * charging anything if any of their budgets would be exceeded.
+     *
+     * There is one global tracker for all tracked query memory, with one child per subsystem
+     * below it, and one tracker per operation, attached to its OperationContext.  Consumers
+     * charge both through a MemoryCharge.
+     *
+     * All methods are thread safe.
+     */
+    class MemoryTracker {
+        MONGO_DISALLOW_COPYING(MemoryTracker);
+    public:
+        /**
+         * The consumers which have a budget of their own.
+         */
+        enum Subsystem {
+            kSort,
+            kGroup,
+            kAndHash,
+            kNumSubsystems,
+        };
+
+        /**
+         * 'budgetBytes' is read on every charge, so that it can be a server parameter.  If it is
+         * NULL or points to a value <= 0, the tracker only counts.
+         */
+        MemoryTracker(StringData name, MemoryTracker* parent, const long long* budgetBytes);
+
+        /**
+         * Adds 'bytes' to this tracker and its ancestors, unless that takes any of them over its
+         * budget, in which case nothing is charged and ExceededMemoryLimit is returned.
+         */
+        Status charge(long long bytes);
+
+        /**
+         * Adds 'bytes' to this tracker and its ancestors, whatever their budgets.
+         */
+        void forceCharge(long long bytes);
+
+        /**
+         * Subtracts 'bytes', which must have been charged before, from this tracker and its
+         * ancestors.
+         */
+        void release(long long bytes);
+
+        const std::string& name() const { return _name; }
+
+        long long currentBytes() const { return _currentBytes.load(); }
+        long long peakBytes() const { return _peakBytes.load(); }
+
+        /**
+         * Appends the current and peak usage and the budget of this tracker.
+         */
+        void appendStats(BSONObjBuilder* builder) const;
+
+        /**
+         * The tracker for all tracked query memory in this process.
+         */
+        static MemoryTracker* global();
+
+        /**
+         * The tracker for 'subsystem', a child of global().
+         */
+        static MemoryTracker* forSubsystem(Subsystem subsystem);
+
+        /**
+         * The tracker for the memory used by the operation 'txn'.  It has no parent.
+         */
+        static MemoryTracker* forOperation(OperationContext* txn);
+
+    private:
+        long long _budget() const;
+
+        /**
+         * Raises the peak of this tracker to 'current' if it is higher.
+         */
+        void _updatePeak(long long current);
+
+        const std::string _name;
+        MemoryTracker* const _parent;
+        const long long* const _budgetBytes;
+
+        AtomicInt64 _currentBytes;
+        AtomicInt64 _peakBytes;
+    };
+
+    /**
+     * The memory used by one consumer, such as a plan stage, charged to the tracker of its
+     * subsystem and to the tracker of the operation it runs in, if any.  Everything it still
+     * holds is released on destruction.
+     *
+     * Consumers keep their own count of the bytes they use and report it with set(), so that
+     * only the difference with what was charged before goes to the trackers.
+     *
+     * Not thread safe.
+     */
+    class MemoryCharge {
+        MONGO_DISALLOW_COPYING(MemoryCharge);
+    public:
+        explicit MemoryCharge(MemoryTracker::Subsystem subsystem);
+        ~MemoryCharge();
+
+        /**
+         * Charges or releases the difference between 'bytes' and what is charged now.  Growing
+         * fails with ExceededMemoryLimit, leaving the charge as it was, if that would exceed the
+         * budget of any tracker.  Shrinking always succeeds.
+         */
+        Status set(long long bytes);
+
+        /**
+         * Moves the charge to the operation 'txn', which may be NULL for none.  Operations end
+         * before the consumers they run can, for instance when a cursor outlives a getMore, so
+         * consumers detach on PlanStage::saveState() and attach again on restoreState().
+         */
+        void setOperationContext(OperationContext* txn);
+
+        long long bytes() const { return _bytes; }
+        long long peakBytes() const { return _peakBytes; }
+
+    private:
+        MemoryTracker* const _subsystem;
+        MemoryTracker* _operation;
+        long long _bytes;
+        long long _peakBytes;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,108 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/memory_tracker.h"
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    TEST(MemoryTrackerTest, ChargesAncestors) {
+        MemoryTracker parent("parent", NULL, NULL);
+        MemoryTracker child("child", &parent, NULL);
+
+        ASSERT_OK(child.charge(100));
+        ASSERT_OK(parent.charge(10));
+        ASSERT_EQUALS(100, child.currentBytes());
+        ASSERT_EQUALS(110, parent.currentBytes());
+
+        child.release(60);
+        ASSERT_EQUALS(40, child.currentBytes());
+        ASSERT_EQUALS(50, parent.currentBytes());
+        ASSERT_EQUALS(100, child.peakBytes());
+        ASSERT_EQUALS(110, parent.peakBytes());
+    }
+
+    TEST(MemoryTrackerTest, OverBudgetChargesNothing) {
+        long long parentBudget = 100;
+        long long childBudget = 0;
+        MemoryTracker parent("parent", NULL, &parentBudget);
+        MemoryTracker child("child", &parent, &childBudget);
+
+        ASSERT_OK(child.charge(80));
+        ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, child.charge(30).code());
+        ASSERT_EQUALS(80, child.currentBytes());
+        ASSERT_EQUALS(80, parent.currentBytes());
+        ASSERT_EQUALS(80, child.peakBytes());
+
+        // The budget of the child applies as well, and is read on every charge.
+        childBudget = 90;
+        ASSERT_EQUALS(ErrorCodes::ExceededMemoryLimit, child.charge(15).code());
+        ASSERT_EQUALS(80, parent.currentBytes());
+        ASSERT_OK(child.charge(10));
+        ASSERT_EQUALS(90, parent.currentBytes());
+
+        // Forced charges go over budget.
+        child.forceCharge(20);
+        ASSERT_EQUALS(110, child.currentBytes());
+        ASSERT_EQUALS(110, parent.peakBytes());
+    }
+
+    TEST(MemoryChargeTest, FollowsOperation) {
+        MemoryTracker* sort = MemoryTracker::forSubsystem(MemoryTracker::kSort);
+        const long long sortBefore = sort->currentBytes();
+        OperationContextNoop first;
+        OperationContextNoop second;
+
+        {
+            MemoryCharge charge(MemoryTracker::kSort);
+            charge.setOperationContext(&first);
+            ASSERT_OK(charge.set(1000));
+            ASSERT_OK(charge.set(400));
+            ASSERT_EQUALS(sortBefore + 400, sort->currentBytes());
+            ASSERT_EQUALS(400, MemoryTracker::forOperation(&first)->currentBytes());
+            ASSERT_EQUALS(1000, MemoryTracker::forOperation(&first)->peakBytes());
+
+            charge.setOperationContext(NULL);
+            ASSERT_EQUALS(0, MemoryTracker::forOperation(&first)->currentBytes());
+            charge.setOperationContext(&second);
+            ASSERT_EQUALS(400, MemoryTracker::forOperation(&second)->currentBytes());
+            ASSERT_EQUALS(1000, charge.peakBytes());
+        }
+
+        ASSERT_EQUALS(0, MemoryTracker::forOperation(&second)->currentBytes());
+        ASSERT_EQUALS(400, MemoryTracker::forOperation(&second)->peakBytes());
+        ASSERT_EQUALS(sortBefore, sort->currentBytes());
+    }
+
+}  // namespace
+}  // namespace mongo
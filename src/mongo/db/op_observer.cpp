@@ -31,6 +31,7 @@
 #include "mongo/db/op_observer.h"
 
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/catalog/projection_cache.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/commands/dbhash.h"
 #include "mongo/db/dbdirectclient.h"
@@ -63,6 +64,7 @@ namespace mongo {
         getGlobalAuthorizationManager()->logOp(txn, "i", ns.ns().c_str(), doc, nullptr);
         logOpForSharding(txn, "i", ns.ns().c_str(), doc, nullptr, fromMigrate);
         logOpForDbHash(txn, ns.ns().c_str());
+        getGlobalProjectionCache()->noteWrite(txn, ns.ns());
         if (strstr(ns.ns().c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -79,6 +81,7 @@ namespace mongo {
                                                &args.criteria);
         logOpForSharding(txn, "u", args.ns.c_str(), args.update, &args.criteria, args.fromMigrate);
         logOpForDbHash(txn, args.ns.c_str());
+        getGlobalProjectionCache()->noteWrite(txn, args.ns);
         if (strstr(args.ns.c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -93,6 +96,7 @@ namespace mongo {
         getGlobalAuthorizationManager()->logOp(txn, "d", ns.c_str(), idDoc, nullptr);
         logOpForSharding(txn, "d", ns.c_str(), idDoc, nullptr, fromMigrate);
         logOpForDbHash(txn, ns.c_str());
+        getGlobalProjectionCache()->noteWrite(txn, ns);
         if (strstr(ns.c_str(), ".system.js")) {
             Scope::storedFuncMod(txn);
         }
@@ -134,6 +138,7 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        getGlobalProjectionCache()->dropDatabase(nsToDatabaseSubstring(dbName));
     }
 
     void OpObserver::onDropCollection(OperationContext* txn,
@@ -145,6 +150,7 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        getGlobalProjectionCache()->dropCollection(collectionName.ns());
     }
 
     void OpObserver::onDropIndex(OperationContext* txn,
@@ -171,6 +177,8 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        getGlobalProjectionCache()->dropCollection(fromCollection.ns());
+        getGlobalProjectionCache()->dropCollection(toCollection.ns());
     }
 
     void OpObserver::onApplyOps(OperationContext* txn,
@@ -192,6 +200,7 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        getGlobalProjectionCache()->dropCollection(collectionName.ns());
     }
 
     void OpObserver::onEmptyCapped(OperationContext* txn, const NamespaceString& collectionName) {
@@ -202,6 +211,7 @@ namespace mongo {
 
         getGlobalAuthorizationManager()->logOp(txn, "c", dbName.c_str(), cmdObj, nullptr);
         logOpForDbHash(txn, dbName.c_str());
+        getGlobalProjectionCache()->dropCollection(collectionName.ns());
     }
 
 } // namespace mongo
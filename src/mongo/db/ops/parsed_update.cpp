@@ -80,12 +80,15 @@ namespace mongo {
         const WhereCallbackReal whereCallback(_txn, _request->getNamespaceString().db());
 
         // Limit should only used for the findAndModify command when a sort is specified. If a sort
-        // is requested, we want to use a top-k sort for efficiency reasons, so should pass the
-        // limit through. Generally, a update stage expects to be able to skip documents that were
-        // deleted/modified under it, but a limit could inhibit that and give an EOF when the update
-        // has not actually updated a document. This behavior is fine for findAndModify, but should
-        // not apply to update in general.
-        long long limit = (!_request->isMulti() && !_request->getSort().isEmpty()) ? -1 : 0;
+        // is requested, we want to use a top-k sort for efficiency reasons, so pass the limit
+        // through. The limit is a soft one, though: a findAndModify on a queue collection often
+        // loses the first document it finds to a concurrent findAndModify, and the update stage
+        // must then go on to the next one rather than give an EOF without having updated any
+        // document. The update stage stops after its first document anyway. With a soft limit, a
+        // sort provided by an index goes on along the same index scan, and a blocking sort is
+        // split into a top-k sort followed by a full one, which only runs when the top document
+        // was taken.
+        long long limit = (!_request->isMulti() && !_request->getSort().isEmpty()) ? 1 : 0;
 
         // The projection needs to be applied after the update operation, so we specify an empty
         // BSONObj as the projection during canonicalization.
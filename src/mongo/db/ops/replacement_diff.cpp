@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ops/replacement_diff.h"
+
+#include <cstring>
+
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+namespace {
+
+    // Matches what LogBuilder writes for an $unset.
+    const bool kUnsetValue = true;
+
+    // Bytes a $set or $unset entry for 'path' takes besides its value: type byte, path and its
+    // terminating NUL.
+    int entryOverhead(StringData path) {
+        return 1 + static_cast<int>(path.size()) + 1;
+    }
+
+    bool sameBytes(const BSONElement& lhs, const BSONElement& rhs) {
+        return lhs.type() == rhs.type() &&
+               lhs.valuesize() == rhs.valuesize() &&
+               std::memcmp(lhs.value(), rhs.value(), lhs.valuesize()) == 0;
+    }
+
+    // Field names that can't be put in a path, or that $set would read as something else.
+    bool canBePathPart(StringData name) {
+        return !name.empty() && name[0] != '$' && name.find('.') == std::string::npos;
+    }
+
+    class DiffBuilder {
+    public:
+        explicit DiffBuilder(int maxBytes) : _bytesLeft(maxBytes), _numEntries(0) {}
+
+        /**
+         * Adds the entries turning 'oldObj' into 'newObj', the sub-document at 'prefix' (empty at
+         * the top level). Returns false if there are none that do it, or they're too big.
+         */
+        bool diff(const BSONObj& oldObj, const BSONObj& newObj, const std::string& prefix) {
+            StringMap<BSONElement> newFields;
+            BSONForEach(newElem, newObj) {
+                const StringData name = newElem.fieldNameStringData();
+                if (!canBePathPart(name) || newFields.find(name) != newFields.end()) {
+                    return false;
+                }
+                newFields[name] = newElem;
+            }
+
+            // Every field kept by newObj has to come in the same order as in oldObj and ahead of
+            // the new fields, since a $set of a missing field appends it to the end.
+            BSONObjIterator newIt(newObj);
+            StringMap<bool> oldFields;
+            BSONForEach(oldElem, oldObj) {
+                const StringData name = oldElem.fieldNameStringData();
+                if (!canBePathPart(name) || oldFields.find(name) != oldFields.end()) {
+                    return false;
+                }
+                oldFields[name] = true;
+
+                const std::string path = prefix + name.toString();
+                if (newFields.find(name) == newFields.end()) {
+                    if (!addUnset(path)) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                const BSONElement newElem = newIt.next();
+                if (newElem.fieldNameStringData() != name) {
+                    return false;
+                }
+
+                if (sameBytes(oldElem, newElem)) {
+                    continue;
+                }
+
+                if (oldElem.type() == Object && newElem.type() == Object &&
+                        !newElem.Obj().isEmpty()) {
+                    if (!diff(oldElem.Obj(), newElem.Obj(), path + '.')) {
+                        return false;
+                    }
+                    continue;
+                }
+
+                if (!addSet(path, newElem)) {
+                    return false;
+                }
+            }
+
+            while (newIt.more()) {
+                const BSONElement newElem = newIt.next();
+                if (oldFields.find(newElem.fieldNameStringData()) != oldFields.end()) {
+                    return false;
+                }
+                if (!addSet(prefix + newElem.fieldName(), newElem)) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        /**
+         * Returns the update, which is empty if no entries were added.
+         */
+        BSONObj done() {
+            if (!_numEntries) {
+                return BSONObj();
+            }
+
+            BSONObjBuilder update;
+            const BSONObj sets = _sets.obj();
+            const BSONObj unsets = _unsets.obj();
+            if (!sets.isEmpty()) {
+                update.append("$set", sets);
+            }
+            if (!unsets.isEmpty()) {
+                update.append("$unset", unsets);
+            }
+            return update.obj();
+        }
+
+    private:
+        bool addSet(const std::string& path, const BSONElement& value) {
+            if (!use(entryOverhead(path) + value.valuesize())) {
+                return false;
+            }
+            _sets.appendAs(value, path);
+            return true;
+        }
+
+        bool addUnset(const std::string& path) {
+            if (!use(entryOverhead(path) + 1)) {
+                return false;
+            }
+            _unsets.append(path, kUnsetValue);
+            return true;
+        }
+
+        bool use(int bytes) {
+            _numEntries++;
+            _bytesLeft -= bytes;
+            return _bytesLeft > 0;
+        }
+
+        int _bytesLeft;
+        int _numEntries;
+        BSONObjBuilder _sets;
+        BSONObjBuilder _unsets;
+    };
+
+} // namespace
+
+    BSONObj makeReplacementDiff(const BSONObj& oldObj, const BSONObj& newObj, int maxBytes) {
+        // The builder gives up once the entries alone reach maxBytes, and the whole update,
+        // $set and $unset wrappers included, is checked at the end.
+        DiffBuilder builder(maxBytes);
+        if (!builder.diff(oldObj, newObj, "")) {
+            return BSONObj();
+        }
+
+        BSONObj diff = builder.done();
+        if (diff.objsize() >= maxBytes) {
+            return BSONObj();
+        }
+        return diff;
+    }
+
+} // namespace mongo
@@ -0,0 +1,47 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Returns an update made of $set and $unset operators that turns 'oldObj' into exactly
+     * 'newObj', field order included, for logging a replacement-style update in place of the
+     * whole new document. Fields are compared by their bytes, and sub-documents found on both
+     * sides are diffed field by field with dotted paths.
+     *
+     * Returns an empty object if the documents are the same, if no such update exists (for
+     * example when kept fields were reordered, or new fields come before kept ones), or if it
+     * wouldn't be smaller than 'maxBytes'.
+     */
+    BSONObj makeReplacementDiff(const BSONObj& oldObj, const BSONObj& newObj, int maxBytes);
+
+} // namespace mongo
@@ -0,0 +1,148 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/ops/replacement_diff.h"
+
+#include "mongo/bson/mutable/document.h"
+#include "mongo/db/json.h"
+#include "mongo/db/ops/update_driver.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    const int kNoLimit = BSONObjMaxInternalSize;
+
+    // Applies 'update' to 'oldObj' the way a secondary would.
+    BSONObj apply(const BSONObj& oldObj, const BSONObj& update) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(update));
+        ASSERT_FALSE(driver.isDocReplacement());
+
+        mutablebson::Document doc(oldObj);
+        ASSERT_OK(driver.update(StringData(), &doc));
+        BSONObj newObj = doc.getObject();
+
+        if (driver.isSimpleUpdate(NULL)) {
+            BSONObj simpleObj;
+            bool modified = false;
+            ASSERT(driver.updateSimple(oldObj, &simpleObj, NULL, &modified));
+            ASSERT(simpleObj.binaryEqual(newObj));
+        }
+        return newObj;
+    }
+
+    // Checks that the diff from 'oldJson' to 'newJson' is 'diffJson', and that it turns the old
+    // document into exactly the new one.
+    void assertDiff(const char* oldJson, const char* newJson, const char* diffJson) {
+        const BSONObj oldObj = fromjson(oldJson);
+        const BSONObj newObj = fromjson(newJson);
+        const BSONObj diff = makeReplacementDiff(oldObj, newObj, kNoLimit);
+        ASSERT_EQUALS(fromjson(diffJson), diff);
+        const BSONObj applied = apply(oldObj, diff);
+        ASSERT(applied.binaryEqual(newObj)) << applied << " != " << newObj;
+    }
+
+    void assertNoDiff(const char* oldJson, const char* newJson) {
+        ASSERT(makeReplacementDiff(fromjson(oldJson), fromjson(newJson), kNoLimit).isEmpty());
+    }
+
+    TEST(ReplacementDiff, ChangedField) {
+        assertDiff("{_id: 1, a: 1, b: 'x', c: 3}",
+                   "{_id: 1, a: 1, b: 'y', c: 3}",
+                   "{$set: {b: 'y'}}");
+    }
+
+    TEST(ReplacementDiff, ChangedType) {
+        assertDiff("{_id: 1, a: 1, b: 2}",
+                   "{_id: 1, a: 1.0, b: 2}",
+                   "{$set: {a: 1.0}}");
+    }
+
+    TEST(ReplacementDiff, AddedAndRemovedFields) {
+        assertDiff("{_id: 1, a: 1, b: 2, c: 3}",
+                   "{_id: 1, a: 1, c: 3, d: 4, e: 5}",
+                   "{$set: {d: 4, e: 5}, $unset: {b: true}}");
+    }
+
+    TEST(ReplacementDiff, NestedFields) {
+        assertDiff("{_id: 1, a: {b: 1, c: {d: 2, e: 3}}, f: [1, 2]}",
+                   "{_id: 1, a: {b: 1, c: {d: 5}, g: 1}, f: [1, 3]}",
+                   "{$set: {'a.c.d': 5, 'a.g': 1, f: [1, 3]}, $unset: {'a.c.e': true}}");
+    }
+
+    TEST(ReplacementDiff, ObjectReplacedByOtherType) {
+        assertDiff("{_id: 1, a: {b: 1}, c: [1]}",
+                   "{_id: 1, a: [1], c: {d: 1}}",
+                   "{$set: {a: [1], c: {d: 1}}}");
+    }
+
+    TEST(ReplacementDiff, EmptyObjects) {
+        assertDiff("{_id: 1, a: {b: 1}}", "{_id: 1, a: {}}", "{$set: {a: {}}}");
+        assertDiff("{_id: 1, a: {}}", "{_id: 1, a: {b: 1}}", "{$set: {'a.b': 1}}");
+    }
+
+    TEST(ReplacementDiff, SameDocument) {
+        assertNoDiff("{_id: 1, a: {b: 1}}", "{_id: 1, a: {b: 1}}");
+    }
+
+    TEST(ReplacementDiff, ReorderedFields) {
+        assertNoDiff("{_id: 1, a: 1, b: 2}", "{_id: 1, b: 2, a: 1}");
+        assertNoDiff("{_id: 1, a: {b: 1, c: 2}}", "{_id: 1, a: {c: 2, b: 1}}");
+    }
+
+    TEST(ReplacementDiff, NewFieldBeforeKeptField) {
+        assertNoDiff("{_id: 1, a: 1, b: 2}", "{_id: 1, a: 1, c: 3, b: 2}");
+    }
+
+    TEST(ReplacementDiff, FieldNamesThatCantBePaths) {
+        assertNoDiff("{_id: 1, a: {'b.c': 1}}", "{_id: 1, a: {'b.c': 2}}");
+        assertNoDiff("{_id: 1, a: {$b: 1}}", "{_id: 1, a: {$b: 2}}");
+        assertNoDiff("{_id: 1, a: 1}", "{_id: 1, a: 1, '': 2}");
+    }
+
+    TEST(ReplacementDiff, DuplicateFieldNames) {
+        assertNoDiff("{_id: 1, a: 1, b: 2}", "{_id: 1, a: 1, b: 2, b: 3}");
+        assertNoDiff("{_id: 1, a: 1, a: 2}", "{_id: 1, a: 3}");
+    }
+
+    TEST(ReplacementDiff, TooLarge) {
+        const BSONObj oldObj = fromjson("{_id: 1, a: 'aaaaaaaaaa', b: 'bbbbbbbbbb'}");
+        const BSONObj newObj = fromjson("{_id: 1, a: 'cccccccccc', b: 'dddddddddd'}");
+        const BSONObj diff = makeReplacementDiff(oldObj, newObj, kNoLimit);
+        ASSERT_FALSE(diff.isEmpty());
+        ASSERT_EQUALS(diff, makeReplacementDiff(oldObj, newObj, diff.objsize() + 1));
+        ASSERT(makeReplacementDiff(oldObj, newObj, diff.objsize()).isEmpty());
+        ASSERT(makeReplacementDiff(oldObj, newObj, diff.objsize() - 10).isEmpty());
+    }
+
+} // namespace
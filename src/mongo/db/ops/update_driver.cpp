@@ -42,6 +42,7 @@
 #include "mongo/db/ops/path_support.h"
 #include "mongo/util/embedded_builder.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/safe_num.h"
 
 namespace mongo {
 
@@ -141,9 +142,78 @@ namespace mongo {
         // replacement.
         _replacementMode = false;
 
+        parseSimpleMods(updateExpr);
+
         return Status::OK();
     }
 
+    void UpdateDriver::parseSimpleMods(const BSONObj& updateExpr) {
+        // Past a handful of mods the quadratic duplicate check below isn't worth it.
+        static const size_t kMaxSimpleMods = 32;
+
+        if (_positional || _mods.size() > kMaxSimpleMods) {
+            return;
+        }
+
+        _simpleUpdateExpr = updateExpr.getOwned();
+
+        BSONObjIterator outerIter(_simpleUpdateExpr);
+        while (outerIter.more()) {
+            BSONElement outerModElem = outerIter.next();
+            modifiertable::ModifierType modType = modifiertable::getType(outerModElem.fieldName());
+            if (modType != modifiertable::MOD_SET &&
+                modType != modifiertable::MOD_INC &&
+                modType != modifiertable::MOD_UNSET) {
+                _simpleMods.clear();
+                break;
+            }
+
+            BSONObjIterator innerIter(outerModElem.embeddedObject());
+            while (innerIter.more()) {
+                BSONElement innerModElem = innerIter.next();
+                StringData fieldName = innerModElem.fieldNameStringData();
+
+                bool simple = !fieldName.empty() &&
+                              fieldName[0] != '$' &&
+                              fieldName.find('.') == std::string::npos &&
+                              fieldName != "_id";
+
+                // Objects and arrays would have to be checked for storage.
+                if (modType == modifiertable::MOD_SET &&
+                    (innerModElem.type() == Object || innerModElem.type() == Array)) {
+                    simple = false;
+                }
+
+                // Two mods over the same field are a conflict. Let update() report it.
+                for (size_t i = 0; simple && i < _simpleMods.size(); ++i) {
+                    simple = _simpleMods[i].elem.fieldNameStringData() != fieldName;
+                }
+
+                if (!simple) {
+                    _simpleMods.clear();
+                    break;
+                }
+
+                SimpleMod mod;
+                mod.type = modType;
+                mod.elem = innerModElem;
+                _simpleMods.push_back(mod);
+            }
+
+            if (_simpleMods.empty()) {
+                break;
+            }
+        }
+
+        if (_simpleMods.size() != _mods.size()) {
+            _simpleMods.clear();
+        }
+
+        if (_simpleMods.empty()) {
+            _simpleUpdateExpr = BSONObj();
+        }
+    }
+
     inline Status UpdateDriver::addAndParse(const modifiertable::ModifierType type,
                                             const BSONElement& elem) {
         if (elem.eoo()) {
@@ -240,6 +310,7 @@ namespace mongo {
         }
 
         _affectIndices = (isDocReplacement() && (_indexedFields != NULL));
+        _modifiedIndexedPaths.clear();
 
         _logDoc.reset();
         LogBuilder logBuilder(_logDoc.root());
@@ -290,12 +361,14 @@ namespace mongo {
                 // non-in-place mode.
                 //
                 // TODO: make mightBeIndexed and fieldRef like each other.
-                if (!_affectIndices &&
-                    !execInfo.noOp &&
+                if (!execInfo.noOp &&
                     _indexedFields &&
                     _indexedFields->mightBeIndexed(execInfo.fieldRef[i]->dottedField())) {
-                    _affectIndices = true;
-                    doc->disableInPlaceUpdates();
+                    _modifiedIndexedPaths.push_back(execInfo.fieldRef[i]->dottedField().toString());
+                    if (!_affectIndices) {
+                        _affectIndices = true;
+                        doc->disableInPlaceUpdates();
+                    }
                 }
             }
 
@@ -326,6 +399,176 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool UpdateDriver::isSimpleUpdate(const vector<FieldRef*>* immutablePaths) const {
+        if (_simpleMods.empty()) {
+            return false;
+        }
+
+        if (immutablePaths) {
+            for (size_t i = 0; i < immutablePaths->size(); ++i) {
+                StringData firstPart = (*immutablePaths)[i]->getPart(0);
+                for (size_t j = 0; j < _simpleMods.size(); ++j) {
+                    if (_simpleMods[j].elem.fieldNameStringData() == firstPart) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+    bool UpdateDriver::updateSimple(const BSONObj& oldObj,
+                                    BSONObj* newObj,
+                                    BSONObj* logOpRec,
+                                    bool* docWasModified) {
+        dassert(!_simpleMods.empty());
+
+        // What happens to the field of each mod, in the same order as '_simpleMods'.
+        enum Outcome { NOT_FOUND, NO_OP, SET_TO_MOD_VALUE, SET_TO_NEW_NUMBER, REMOVED };
+        std::vector<Outcome> outcomes(_simpleMods.size(), NOT_FOUND);
+        std::vector<SafeNum> newNumbers(_simpleMods.size());
+
+        BSONObjBuilder bob(oldObj.objsize() + 64);
+
+        BSONObjIterator it(oldObj);
+        while (it.more()) {
+            const BSONElement elt = it.next();
+            const StringData fieldName = elt.fieldNameStringData();
+
+            size_t i = 0;
+            while (i < _simpleMods.size() &&
+                   _simpleMods[i].elem.fieldNameStringData() != fieldName) {
+                ++i;
+            }
+
+            if (i == _simpleMods.size()) {
+                bob.append(elt);
+                continue;
+            }
+
+            if (outcomes[i] != NOT_FOUND) {
+                // The field appears twice in the document.
+                return false;
+            }
+
+            const BSONElement& modElem = _simpleMods[i].elem;
+            switch (_simpleMods[i].type) {
+            case modifiertable::MOD_SET:
+                if (elt.woCompare(modElem, false /* ignore field name */) == 0) {
+                    outcomes[i] = NO_OP;
+                    bob.append(elt);
+                }
+                else {
+                    outcomes[i] = SET_TO_MOD_VALUE;
+                    bob.appendAs(modElem, fieldName);
+                }
+                break;
+
+            case modifiertable::MOD_INC: {
+                if (!elt.isNumber()) {
+                    return false;
+                }
+                const SafeNum currentValue(elt);
+                newNumbers[i] = currentValue + SafeNum(modElem);
+                if (!newNumbers[i].isValid()) {
+                    return false;
+                }
+                if (newNumbers[i].isIdentical(currentValue)) {
+                    outcomes[i] = NO_OP;
+                    bob.append(elt);
+                }
+                else {
+                    outcomes[i] = SET_TO_NEW_NUMBER;
+                    newNumbers[i].toBSON(fieldName, &bob);
+                }
+                break;
+            }
+
+            default:
+                dassert(_simpleMods[i].type == modifiertable::MOD_UNSET);
+                outcomes[i] = REMOVED;
+                break;
+            }
+        }
+
+        // Fields missing from the document are created at its end, or are left alone by $unset.
+        for (size_t i = 0; i < _simpleMods.size(); ++i) {
+            if (outcomes[i] != NOT_FOUND) {
+                continue;
+            }
+            if (_simpleMods[i].type == modifiertable::MOD_UNSET) {
+                outcomes[i] = NO_OP;
+                continue;
+            }
+            outcomes[i] = SET_TO_MOD_VALUE;
+            bob.append(_simpleMods[i].elem);
+        }
+
+        _affectIndices = false;
+        _modifiedIndexedPaths.clear();
+        bool modified = false;
+        for (size_t i = 0; i < _simpleMods.size(); ++i) {
+            if (outcomes[i] == NO_OP) {
+                continue;
+            }
+            modified = true;
+            if (_indexedFields &&
+                _indexedFields->mightBeIndexed(_simpleMods[i].elem.fieldNameStringData())) {
+                _affectIndices = true;
+                _modifiedIndexedPaths.push_back(_simpleMods[i].elem.fieldName());
+            }
+        }
+
+        if (_logOp && logOpRec) {
+            // Lay the entry out as LogBuilder would: one section per kind of change, in the
+            // order in which the first change of that kind shows up in the mods.
+            BSONObjBuilder setBob;
+            BSONObjBuilder unsetBob;
+            bool haveSets = false;
+            bool haveUnsets = false;
+            bool unsetsFirst = false;
+            for (size_t i = 0; i < _simpleMods.size(); ++i) {
+                const BSONElement& modElem = _simpleMods[i].elem;
+                switch (outcomes[i]) {
+                case SET_TO_MOD_VALUE:
+                    setBob.append(modElem);
+                    haveSets = true;
+                    break;
+                case SET_TO_NEW_NUMBER:
+                    newNumbers[i].toBSON(modElem.fieldNameStringData(), &setBob);
+                    haveSets = true;
+                    break;
+                case REMOVED:
+                    unsetsFirst = unsetsFirst || !haveSets;
+                    unsetBob.append(modElem.fieldNameStringData(), true);
+                    haveUnsets = true;
+                    break;
+                default:
+                    break;
+                }
+            }
+
+            BSONObjBuilder logBob;
+            if (haveUnsets && unsetsFirst) {
+                logBob.append("$unset", unsetBob.obj());
+            }
+            if (haveSets) {
+                logBob.append("$set", setBob.obj());
+            }
+            if (haveUnsets && !unsetsFirst) {
+                logBob.append("$unset", unsetBob.obj());
+            }
+            *logOpRec = logBob.obj();
+        }
+
+        *newObj = modified ? bob.obj() : oldObj;
+        if (docWasModified) {
+            *docWasModified = modified;
+        }
+        return true;
+    }
+
     size_t UpdateDriver::numMods() const {
         return _mods.size();
     }
@@ -338,6 +581,10 @@ namespace mongo {
         return _affectIndices;
     }
 
+    const std::vector<std::string>* UpdateDriver::modifiedIndexedPaths() const {
+        return isDocReplacement() ? NULL : &_modifiedIndexedPaths;
+    }
+
     void UpdateDriver::refreshIndexKeys(const UpdateIndexData* indexedFields) {
         _indexedFields = indexedFields;
     }
@@ -390,6 +637,8 @@ namespace mongo {
             delete *it;
         }
         _mods.clear();
+        _simpleMods.clear();
+        _simpleUpdateExpr = BSONObj();
         _indexedFields = NULL;
         _replacementMode = false;
         _positional = false;
@@ -101,6 +101,31 @@ namespace mongo {
                       FieldRefSet* updatedFields = NULL,
                       bool* docWasModified = NULL);
 
+        /**
+         * Returns true if the parsed update is made only of $set, $inc and $unset mods over
+         * distinct, non-dotted top-level fields other than _id, with $set values that are not
+         * objects or arrays, and if none of those fields is the first part of any of the
+         * 'immutablePaths' (which may be NULL). Such an update can be applied with
+         * updateSimple().
+         */
+        bool isSimpleUpdate(const std::vector<FieldRef*>* immutablePaths) const;
+
+        /**
+         * Applies a simple update (see isSimpleUpdate()) to 'oldObj' in a single pass over its
+         * fields, splicing 'newObj' together without a mutable document. Unchanged fields keep
+         * their place and new fields are appended in mod order, as update() would do. If the
+         * driver's '_logOp' mode is on and 'logOpRec' is not NULL, fills in the latter with the
+         * oplog entry for the update.
+         *
+         * Returns false, without touching the out parameters, if the mods can't be applied
+         * that way to 'oldObj' (for instance, an $inc over a non-numeric value, or a field that
+         * appears twice). The caller should then go through update(), which reports any error.
+         */
+        bool updateSimple(const BSONObj& oldObj,
+                          BSONObj* newObj,
+                          BSONObj* logOpRec,
+                          bool* docWasModified);
+
         //
         // Accessors
         //
@@ -112,6 +137,12 @@ namespace mongo {
         bool modsAffectIndices() const;
         void refreshIndexKeys(const UpdateIndexData* indexedFields);
 
+        /**
+         * Returns the paths changed by the last update which might be indexed, so that only the
+         * indexes over them need new keys, or NULL if the whole document was replaced.
+         */
+        const std::vector<std::string>* modifiedIndexedPaths() const;
+
         bool logOp() const;
         void setLogOp(bool logOp);
 
@@ -138,6 +169,9 @@ namespace mongo {
         /** Resets the state of the class associated with mods (not the error state) */
         void clear();
 
+        /** Fills in '_simpleMods' if the freshly parsed 'updateExpr' is a simple update. */
+        void parseSimpleMods(const BSONObj& updateExpr);
+
         /** Create the modifier and add it to the back of the modifiers vector */
         inline Status addAndParse(const modifiertable::ModifierType type,
                                   const BSONElement& elem);
@@ -152,6 +186,15 @@ namespace mongo {
         // Collection of update mod instances. Owned here.
         std::vector<ModifierInterface*> _mods;
 
+        // If the update is simple (see isSimpleUpdate()), the type of each mod and the element
+        // of '_simpleUpdateExpr' it came from, in the same order as '_mods'. Empty otherwise.
+        struct SimpleMod {
+            modifiertable::ModifierType type;
+            BSONElement elem;
+        };
+        std::vector<SimpleMod> _simpleMods;
+        BSONObj _simpleUpdateExpr;
+
         // What are the list of fields in the collection over which the update is going to be
         // applied that participate in indices?
         //
@@ -172,6 +215,10 @@ namespace mongo {
         // at each call to update.
         bool _affectIndices;
 
+        // Which of the fields changed by the mods might participate in an index. Is set anew at
+        // each call to update.
+        std::vector<std::string> _modifiedIndexedPaths;
+
         // Do any of the mods require positional match details when calling 'prepare'?
         bool _positional;
 
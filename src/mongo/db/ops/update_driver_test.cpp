@@ -126,6 +126,162 @@ namespace {
         ASSERT_FALSE(driver.isDocReplacement());
     }
 
+    //
+    // Simple updates, applied without a mutable document
+    //
+
+    /**
+     * Applies 'updateStr' to 'docStr' through both UpdateDriver::update() and
+     * UpdateDriver::updateSimple(), and checks that they agree on the new document, the oplog
+     * entry and whether anything changed.
+     */
+    void assertSimpleUpdateMatches(const char* updateStr, const char* docStr) {
+        UpdateDriver::Options opts;
+        opts.logOp = true;
+
+        UpdateDriver driver(opts);
+        ASSERT_OK(driver.parse(fromjson(updateStr)));
+        ASSERT_TRUE(driver.isSimpleUpdate(NULL));
+
+        const BSONObj docObj = fromjson(docStr);
+
+        Document doc(docObj);
+        BSONObj logObj;
+        bool modified = false;
+        ASSERT_OK(driver.update(StringData(), &doc, &logObj, NULL, &modified));
+
+        BSONObj simpleObj;
+        BSONObj simpleLogObj;
+        bool simpleModified = false;
+        ASSERT_TRUE(driver.updateSimple(docObj, &simpleObj, &simpleLogObj, &simpleModified));
+
+        ASSERT_EQUALS(modified, simpleModified);
+        ASSERT_EQUALS(doc.getObject(), simpleObj);
+        ASSERT_EQUALS(logObj, simpleLogObj);
+    }
+
+    TEST(SimpleUpdate, Set) {
+        assertSimpleUpdateMatches("{$set: {a: 2}}", "{_id: 1, a: 1, b: 1}");
+        assertSimpleUpdateMatches("{$set: {a: 'x', c: 3}}", "{_id: 1, a: 1, b: 1}");
+        assertSimpleUpdateMatches("{$set: {a: 1}}", "{_id: 1, a: 1}");
+        assertSimpleUpdateMatches("{$set: {c: 1, b: 2}}", "{_id: 1}");
+    }
+
+    TEST(SimpleUpdate, Inc) {
+        assertSimpleUpdateMatches("{$inc: {a: 1}}", "{_id: 1, a: 1, b: 1}");
+        assertSimpleUpdateMatches("{$inc: {a: 1.5}}", "{_id: 1, a: 1}");
+        assertSimpleUpdateMatches("{$inc: {a: NumberLong(1)}}", "{_id: 1, a: 2147483647}");
+        assertSimpleUpdateMatches("{$inc: {a: 0}}", "{_id: 1, a: 1}");
+        assertSimpleUpdateMatches("{$inc: {c: 5}}", "{_id: 1, a: 1}");
+    }
+
+    TEST(SimpleUpdate, Unset) {
+        assertSimpleUpdateMatches("{$unset: {a: 1}}", "{_id: 1, a: 1, b: 1}");
+        assertSimpleUpdateMatches("{$unset: {c: 1}}", "{_id: 1, a: 1}");
+    }
+
+    TEST(SimpleUpdate, Mixed) {
+        assertSimpleUpdateMatches("{$set: {status: 'done'}, $inc: {n: 1}, $unset: {lock: 1}}",
+                                  "{_id: 1, lock: 'x', n: 4, status: 'running'}");
+        assertSimpleUpdateMatches("{$unset: {a: 1}, $set: {b: 1}}", "{_id: 1, a: 1}");
+        assertSimpleUpdateMatches("{$unset: {c: 1}, $set: {b: 1}, $unset: {a: 1}}",
+                                  "{_id: 1, a: 1}");
+    }
+
+    TEST(SimpleUpdate, NotSimple) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+
+        ASSERT_OK(driver.parse(fromjson("{$set: {'a.b': 1}}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: {b: 1}}}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+        ASSERT_OK(driver.parse(fromjson("{$set: {_id: 1}}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+        ASSERT_OK(driver.parse(fromjson("{$push: {a: 1}}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: 1}, $inc: {a: 1}}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+        ASSERT_OK(driver.parse(fromjson("{a: 1}")));
+        ASSERT_FALSE(driver.isSimpleUpdate(NULL));
+
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: 1}}")));
+        ASSERT_TRUE(driver.isSimpleUpdate(NULL));
+        OwnedPointerVector<FieldRef> immutablePaths;
+        immutablePaths.push_back(new FieldRef("b"));
+        ASSERT_TRUE(driver.isSimpleUpdate(&immutablePaths.vector()));
+        immutablePaths.push_back(new FieldRef("a.c"));
+        ASSERT_FALSE(driver.isSimpleUpdate(&immutablePaths.vector()));
+    }
+
+    TEST(SimpleUpdate, FallsBack) {
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        BSONObj newObj;
+        BSONObj logObj;
+        bool modified = false;
+
+        // $inc over a non-numeric value is left to update() to report.
+        ASSERT_OK(driver.parse(fromjson("{$inc: {a: 1}}")));
+        ASSERT_FALSE(driver.updateSimple(fromjson("{_id: 1, a: 'x'}"), &newObj, &logObj,
+                                         &modified));
+
+        // So is a field that appears twice.
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: 1}}")));
+        ASSERT_FALSE(driver.updateSimple(BSON("_id" << 1 << "a" << 2 << "a" << 3), &newObj,
+                                         &logObj, &modified));
+        ASSERT_TRUE(newObj.isEmpty());
+    }
+
+    TEST(ModifiedIndexedPaths, Mods) {
+        UpdateIndexData indexed;
+        indexed.addPath("a");
+        indexed.addPath("b.c");
+
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        driver.refreshIndexKeys(&indexed);
+
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: 2, 'b.c': 3, d: 4}}")));
+        Document doc(fromjson("{a: 1, b: {c: 1}, d: 1}"));
+        ASSERT_OK(driver.update(StringData(), &doc));
+        ASSERT_TRUE(driver.modsAffectIndices());
+        ASSERT_TRUE(driver.modifiedIndexedPaths());
+        ASSERT_EQUALS(2U, driver.modifiedIndexedPaths()->size());
+        ASSERT_EQUALS("a", (*driver.modifiedIndexedPaths())[0]);
+        ASSERT_EQUALS("b.c", (*driver.modifiedIndexedPaths())[1]);
+
+        // No-ops don't count.
+        ASSERT_OK(driver.parse(fromjson("{$set: {a: 1, d: 2}}")));
+        Document doc2(fromjson("{a: 1, d: 1}"));
+        ASSERT_OK(driver.update(StringData(), &doc2));
+        ASSERT_FALSE(driver.modsAffectIndices());
+        ASSERT_EQUALS(0U, driver.modifiedIndexedPaths()->size());
+    }
+
+    TEST(ModifiedIndexedPaths, SimpleAndReplacement) {
+        UpdateIndexData indexed;
+        indexed.addPath("a");
+
+        UpdateDriver::Options opts;
+        UpdateDriver driver(opts);
+        driver.refreshIndexKeys(&indexed);
+
+        ASSERT_OK(driver.parse(fromjson("{$inc: {a: 1, b: 1}}")));
+        BSONObj newObj;
+        BSONObj logObj;
+        bool modified = false;
+        ASSERT_TRUE(driver.updateSimple(fromjson("{_id: 1, a: 1, b: 1}"), &newObj, &logObj,
+                                        &modified));
+        ASSERT_TRUE(driver.modifiedIndexedPaths());
+        ASSERT_EQUALS(1U, driver.modifiedIndexedPaths()->size());
+        ASSERT_EQUALS("a", (*driver.modifiedIndexedPaths())[0]);
+
+        // Every index may be affected by a replacement.
+        ASSERT_OK(driver.parse(fromjson("{a: 1}")));
+        ASSERT_FALSE(driver.modifiedIndexedPaths());
+    }
+
     //
     // Tests of creating a base for an upsert from a query document
     // $or, $and, $all get special handling, as does the _id field
@@ -44,11 +44,20 @@ namespace {
 
     void AccumulatorAvg::processInternal(const Value& input, bool merging) {
         if (!merging) {
-            // non numeric types have no impact on average
-            if (!input.numeric())
+            switch (input.getType()) {
+            case NumberInt:
+                _total += input.getInt();
+                break;
+            case NumberLong:
+                _total += input.getLong();
+                break;
+            case NumberDouble:
+                _total += input.getDouble();
+                break;
+            default:
+                // non numeric types have no impact on average
                 return;
-
-            _total += input.getDouble();
+            }
             _count += 1;
         }
         else {
@@ -36,25 +36,31 @@ namespace mongo {
     using boost::intrusive_ptr;
 
     void AccumulatorSum::processInternal(const Value& input, bool merging) {
-        // do nothing with non numeric types
-        if (!input.numeric())
-            return;
-
-        // upgrade to the widest type required to hold the result
-        totalType = Value::getWidestNumeric(totalType, input.getType());
-
-        if (totalType == NumberInt || totalType == NumberLong) {
-            long long v = input.coerceToLong();
+        // Dispatch on the input's type just once, rather than once to check that it is numeric,
+        // again to widen the total's type and again to coerce it. Both totals are kept up to date
+        // for integral inputs; once the total's type is double, only doubleTotal is used.
+        switch (input.getType()) {
+        case NumberInt: {
+            const int v = input.getInt();
             longTotal += v;
             doubleTotal += v;
+            return;
         }
-        else if (totalType == NumberDouble) {
-            double v = input.coerceToDouble();
+        case NumberLong: {
+            const long long v = input.getLong();
+            if (totalType == NumberInt)
+                totalType = NumberLong;
+            longTotal += v;
             doubleTotal += v;
+            return;
         }
-        else {
-            // non numerics should have returned above so we should never get here
-            verify(false);
+        case NumberDouble:
+            totalType = NumberDouble;
+            doubleTotal += input.getDouble();
+            return;
+        default:
+            // do nothing with non numeric types
+            return;
         }
     }
 
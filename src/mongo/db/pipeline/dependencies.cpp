@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/field_path.h"
@@ -139,35 +141,57 @@ namespace {
         return Value(std::move(values));
     }
 
+    // Up to this many needed fields are tracked so that documentHelper can stop reading a wide
+    // object once it has found all of them.
+    const size_t kMaxTrackedFields = 16;
+
     // Handles object-typed values including the top-level for ParsedDeps::extractFields
     Document documentHelper(const BSONObj& bson, const Document& neededFields) {
-        MutableDocument md(neededFields.size());
+        const size_t numNeeded = neededFields.size();
+        MutableDocument md(numNeeded);
+
+        const bool trackFound = numNeeded <= kMaxTrackedFields;
+        Position found[kMaxTrackedFields];
+        size_t numFound = 0;
 
         BSONObjIterator it(bson);
         while (it.more()) {
             BSONElement bsonElement (it.next());
             StringData fieldName = bsonElement.fieldNameStringData();
-            Value isNeeded = neededFields[fieldName];
+            const Position pos = neededFields.positionOf(fieldName);
 
-            if (isNeeded.missing())
+            if (!pos.found())
                 continue;
 
+            Value isNeeded = neededFields[pos];
+
+            if (trackFound && std::find(found, found + numFound, pos) == found + numFound) {
+                found[numFound++] = pos;
+            }
+            // Later duplicates of a field already added are shadowed by the first one, so once
+            // every needed field has been seen the rest of the object can be skipped.
+            const bool foundAll = trackFound && numFound == numNeeded;
+
             if (isNeeded.getType() == Bool) {
                 md.addField(fieldName, Value(bsonElement));
-                continue;
             }
-
-            dassert(isNeeded.getType() == Object);
-
-            if (bsonElement.type() == Object) {
-                Document sub = documentHelper(bsonElement.embeddedObject(), isNeeded.getDocument());
-                md.addField(fieldName, Value(sub));
+            else {
+                dassert(isNeeded.getType() == Object);
+
+                if (bsonElement.type() == Object) {
+                    Document sub = documentHelper(bsonElement.embeddedObject(),
+                                                  isNeeded.getDocument());
+                    md.addField(fieldName, Value(sub));
+                }
+
+                if (bsonElement.type() == Array) {
+                    md.addField(fieldName, arrayHelper(bsonElement.embeddedObject(),
+                                                       isNeeded.getDocument()));
+                }
             }
 
-            if (bsonElement.type() == Array) {
-                md.addField(fieldName, arrayHelper(bsonElement.embeddedObject(),
-                                                   isNeeded.getDocument()));
-            }
+            if (foundAll)
+                break;
         }
 
         return md.freeze();
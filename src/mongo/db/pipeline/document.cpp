@@ -253,12 +253,16 @@ namespace mongo {
 
     BSONObj Document::toBsonWithMetaData() const {
         BSONObjBuilder bb;
-        toBson(&bb);
-        if (hasTextScore())
-            bb.append(metaFieldTextScore, getTextScore());
+        toBsonWithMetaData(&bb);
         return bb.obj();
     }
 
+    void Document::toBsonWithMetaData(BSONObjBuilder* pBuilder) const {
+        toBson(pBuilder);
+        if (hasTextScore())
+            pBuilder->append(metaFieldTextScore, getTextScore());
+    }
+
     Document Document::fromBsonWithMetaData(const BSONObj& bson) {
         MutableDocument md;
 
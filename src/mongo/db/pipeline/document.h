@@ -150,6 +150,7 @@ namespace mongo {
          * Output is parseable by fromBsonWithMetaData
          */
         BSONObj toBsonWithMetaData() const;
+        void toBsonWithMetaData(BSONObjBuilder* pBsonObjBuilder) const;
 
         /**
          * Like Document(BSONObj) but treats top-level fields with special names as metadata.
@@ -41,6 +41,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/matcher.h"
+#include "mongo/db/memory_tracker.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/expression_context.h"
@@ -232,6 +233,12 @@ namespace mongo {
 
             virtual bool isCapped(const NamespaceString& ns) = 0;
 
+            /**
+             * Inserts 'objs' into the existing collection 'ns' as one batch, adding an _id to
+             * those which have none.  Nothing is inserted if an error is returned.
+             */
+            virtual Status insert(const NamespaceString& ns, const std::vector<BSONObj>& objs) = 0;
+
             // Add new methods as needed.
         };
 
@@ -438,6 +445,10 @@ namespace mongo {
         virtual GetDepsReturn getDependencies(DepsTracker* deps) const;
         virtual void dispose();
         virtual Value serialize(bool explain = false) const;
+        virtual void serializeToArray(std::vector<Value>& array, bool explain = false) const;
+
+        /// Absorbs a following ascending $sort on _id, see setSortedOutput().
+        virtual bool coalesce(const boost::intrusive_ptr<DocumentSource>& nextSource);
 
         /**
           Create a new grouping DocumentSource.
@@ -467,6 +478,34 @@ namespace mongo {
         /// Tell this source if it is doing a merge from shards. Defaults to false.
         void setDoingMerge(bool doingMerge) { _doingMerge = doingMerge; }
 
+        /**
+         * Returns the dotted path of the input field the documents are grouped by, or an empty
+         * string if the group key is anything other than a single field of the input.
+         */
+        std::string getGroupByFieldPath() const;
+
+        /**
+         * Tell this source that its input arrives ordered by the group key, so that each group
+         * can be returned as soon as the next one starts instead of collecting every group in
+         * the hash table first. Defaults to false.
+         */
+        void setStreaming(bool streaming) { _streaming = streaming; }
+
+        /**
+         * Calls setStreaming() with whether an input ordered by 'sortPattern' keeps documents
+         * with equal group keys together, and the output in the order setSortedOutput() asks
+         * for. The caller has to make sure arrays sort as whole values, as $sort does but
+         * multikey indexes don't.
+         */
+        void setStreamingIfSortedBy(const BSONObj& sortPattern);
+
+        /**
+         * Tell this source to return the groups in ascending order of _id, as a following
+         * {$sort: {_id: 1}} would. Spilled groups are then merged in order instead of being
+         * hash partitioned. Defaults to false.
+         */
+        void setSortedOutput(bool sortedOutput) { _sortedOutput = sortedOutput; }
+
         /**
           Create a grouping DocumentSource from BSON.
 
@@ -489,6 +528,9 @@ namespace mongo {
         static const char groupName[];
 
     private:
+        typedef std::vector<boost::intrusive_ptr<Accumulator> > Accumulators;
+        typedef boost::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
+
         DocumentSourceGroup(const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
         /// Spill groups map to disk and returns an iterator to the file.
@@ -497,6 +539,29 @@ namespace mongo {
         // Only used by spill. Would be function-local if that were legal in C++03.
         class SpillSTLComparator;
 
+        /**
+         * Hash-partitioned alternative to spill(), used when _numSpillPartitions > 0.
+         *
+         * Writes every in-memory group belonging to a partition that was spilled before to that
+         * partition's file, then adds the largest remaining partitions until at least half of
+         * the tracked memory is freed. Groups of partitions that are never spilled stay in memory
+         * and are returned directly; each spilled partition is later re-aggregated on its own by
+         * loadNextPartition().
+         */
+        void spillPartitions();
+
+        /// Closes the current partition files and queues them for loadNextPartition().
+        void finishPartitionedSpill();
+
+        /// Re-aggregates the next queued spilled partition into the (emptied) groups map.
+        void loadNextPartition();
+
+        /// Which partition the group with key "id" falls in, at the current _partitionLevel.
+        size_t partitionFor(const Value& id) const;
+
+        /// Approximate memory used by a group, as counted against _maxMemoryUsageBytes.
+        static int groupMemoryUsage(const Value& id, const Accumulators& accumulators);
+
         /*
           Before returning anything, this source must fetch everything from
           the underlying source and group it.  populate() is used to do that
@@ -504,8 +569,14 @@ namespace mongo {
           boolean indicates that this has been done.
          */
         void populate();
+
+        /// Charges _memoryUsageBytes, returning false if that is over a memory budget.
+        bool chargeMemory();
         bool populated;
 
+        /// getNext() when _streaming: accumulates the input up to where the group key changes.
+        boost::optional<Document> getNextStreaming();
+
         /**
          * Parses the raw id expression into _idExpressions and possibly _idFieldNames.
          */
@@ -523,8 +594,6 @@ namespace mongo {
         Value expandId(const Value& val);
 
 
-        typedef std::vector<boost::intrusive_ptr<Accumulator> > Accumulators;
-        typedef boost::unordered_map<Value, Accumulators, Value::Hash> GroupsMap;
         GroupsMap groups;
 
         /*
@@ -547,9 +616,33 @@ namespace mongo {
         Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
         bool _doingMerge;
+        bool _streaming;
+        bool _sortedOutput;
         bool _spilled;
         const bool _extSortAllowed;
         const int _maxMemoryUsageBytes;
+        int _memoryUsageBytes; // approximate memory used by groups
+
+        // Charges _memoryUsageBytes to the group subsystem and, while populating, to the
+        // operation.  Going over their budgets spills like going over _maxMemoryUsageBytes.
+        MemoryCharge _memoryCharge;
+
+        // Number of hash partitions to spill into, or 0 to spill by sorting the whole map.
+        const int _numSpillPartitions;
+
+        // Seed of the partitioning hash; bumped for each round of re-aggregating a partition so
+        // that a partition which still doesn't fit in memory splits up differently.
+        int _partitionLevel;
+
+        // Open file for each partition spilled at the current _partitionLevel, or NULL.
+        std::vector<boost::shared_ptr<SortedFileWriter<Value, Value> > > _partitionWriters;
+
+        // Spilled partitions that still have to be re-aggregated.
+        struct SpilledPartition {
+            boost::shared_ptr<Sorter<Value, Value>::Iterator> data;
+            int level;
+        };
+        std::vector<SpilledPartition> _spilledPartitions;
         boost::scoped_ptr<Variables> _variables;
         std::vector<std::string> _idFieldNames; // used when id is a document
         std::vector<boost::intrusive_ptr<Expression> > _idExpressions;
@@ -557,11 +650,20 @@ namespace mongo {
         // only used when !_spilled
         GroupsMap::iterator groupsIterator;
 
+        // only used when !_spilled and _sortedOutput: the groups in order, and the next one.
+        std::vector<GroupsMap::iterator> _sortedGroups;
+        size_t _nextSortedGroup;
+
         // only used when _spilled
         boost::scoped_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
         std::pair<Value, Value> _firstPartOfNextGroup;
         Value _currentId;
         Accumulators _currentAccumulators;
+
+        // only used when _streaming: the first input of the next group, which is still set as
+        // the ROOT of _variables, and its key.
+        boost::optional<Document> _firstDocOfNextGroup;
+        Value _nextId;
     };
 
 
@@ -604,6 +706,12 @@ namespace mongo {
         static bool isTextQuery(const BSONObj& query);
         bool isTextQuery() const { return _isTextQuery; }
 
+        /**
+         * Adds the paths of the fields the query reads to 'paths'. Returns false if the query
+         * depends on anything but named fields, as $where does.
+         */
+        bool getQueryFieldPaths(std::vector<std::string>* paths) const;
+
     private:
         DocumentSourceMatch(const BSONObj &query,
             const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
@@ -715,10 +823,14 @@ namespace mongo {
         // Sets _tempsNs and prepares it to receive data.
         void prepTempCollection();
 
-        void spill(DBClientBase* conn, const std::vector<BSONObj>& toInsert);
+        // Builds the indexes of _outputNs on _tempNs, once all the data is in.
+        void buildTempIndexes();
+
+        void spill(const std::vector<BSONObj>& toInsert);
 
         bool _done;
 
+        std::vector<BSONObj> _indexSpecs; // indexes of _outputNs, to copy to _tempNs.
         NamespaceString _tempNs; // output goes here as it is being processed.
         const NamespaceString _outputNs; // output will go here after all data is processed.
     };
@@ -753,6 +865,9 @@ namespace mongo {
         /** projection as specified by the user */
         BSONObj getRaw() const { return _raw; }
 
+        /** Whether the top-level field 'fieldName' is passed through as it is. */
+        bool keepsField(StringData fieldName) const;
+
     private:
         DocumentSourceProject(const boost::intrusive_ptr<ExpressionContext>& pExpCtx,
                               const boost::intrusive_ptr<ExpressionObject>& exprObj);
@@ -847,6 +962,14 @@ namespace mongo {
 
         boost::intrusive_ptr<DocumentSourceLimit> getLimitSrc() const { return limitSrc; }
 
+        /**
+         * Tell this source that its input already arrives ordered by the first 'numKeys' fields
+         * of the sort key, as by an index which isn't multikey on them. The input is then only
+         * sorted among documents with equal values for those fields, returned as each such run
+         * ends, and no more input is read once the limit is reached. Defaults to 0.
+         */
+        void setPresortedPrefix(size_t numKeys) { _presortedPrefix = numKeys; }
+
         static const char sortName[];
 
     private:
@@ -867,6 +990,18 @@ namespace mongo {
 
         SortOptions makeSortOptions() const;
 
+        /// getNext() when _presortedPrefix > 0.
+        boost::optional<Document> getNextByPrefix();
+
+        /// Sorts the next run of input with an equal presorted prefix into _output.
+        void sortNextPrefixRun();
+
+        /**
+         * Extracts the first _presortedPrefix fields of the sort key, counting missing values as
+         * null, since the index those come from doesn't tell them apart.
+         */
+        std::vector<Value> extractPrefix(const Document& d) const;
+
         // These are used to merge pre-sorted results from a DocumentSourceMergeCursors or a
         // DocumentSourceCommandShards depending on whether we have finished upgrading to 2.6 or
         // not.
@@ -904,6 +1039,11 @@ namespace mongo {
         bool _done;
         bool _mergingPresorted;
         boost::scoped_ptr<MySorter::Iterator> _output;
+
+        // only used when _presortedPrefix > 0
+        size_t _presortedPrefix;
+        long long _numReturned;
+        boost::optional<Document> _firstOfNextRun; // none once the input is exhausted
     };
 
     class DocumentSourceLimit : public DocumentSource
@@ -1043,6 +1183,9 @@ namespace mongo {
 
         static const char unwindName[];
 
+        /** The dotted path of the array being unwound. */
+        std::string getUnwindPath() const { return _unwindPath->getPath(false); }
+
     private:
         DocumentSourceUnwind(const boost::intrusive_ptr<ExpressionContext> &pExpCtx);
 
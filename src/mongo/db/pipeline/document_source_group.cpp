@@ -36,6 +36,7 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
 
@@ -44,6 +45,62 @@ namespace mongo {
     using std::pair;
     using std::vector;
 
+    // Number of hash partitions $group spills into when it runs out of memory. 0 selects the
+    // older strategy of sorting and spilling the whole hash table, then merging the sorted files.
+    MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupSpillPartitions, int, 16);
+
+namespace {
+
+    // Re-aggregating a spilled partition repartitions it again if it still doesn't fit in
+    // memory, but only this many times; past that the groups are simply kept in memory, as
+    // happens for a single group that is too big to spill usefully.
+    const int kMaxPartitionLevel = 8;
+
+    /**
+     * Serializes the partial state of a group's accumulators as a single Value, in the format
+     * mergeAccumulatorStates() consumes.
+     */
+    Value serializeAccumulatorStates(const vector<intrusive_ptr<Accumulator> >& accumulators) {
+        switch (accumulators.size()) {
+        case 0: // no values, essentially a distinct
+            return Value();
+
+        case 1: // just one value, use optimized serialization as single Value
+            return accumulators[0]->getValue(/*toBeMerged=*/true);
+
+        default: { // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accumulators.size());
+            for (size_t i = 0; i < accumulators.size(); i++) {
+                states.push_back(accumulators[i]->getValue(/*toBeMerged=*/true));
+            }
+            return Value(std::move(states));
+        }
+        }
+    }
+
+    void mergeAccumulatorStates(const vector<intrusive_ptr<Accumulator> >& accumulators,
+                                const Value& states) {
+        switch (accumulators.size()) { // mirrors switch in serializeAccumulatorStates()
+        case 0:
+            break;
+
+        case 1:
+            accumulators[0]->process(states, /*merging=*/true);
+            break;
+
+        default: {
+            const vector<Value>& accumulatorStates = states.getArray();
+            for (size_t i = 0; i < accumulators.size(); i++) {
+                accumulators[i]->process(accumulatorStates[i], /*merging=*/true);
+            }
+            break;
+        }
+        }
+    }
+
+}  // namespace
+
     const char DocumentSourceGroup::groupName[] = "$group";
 
     const char *DocumentSourceGroup::getSourceName() const {
@@ -53,6 +110,9 @@ namespace mongo {
     boost::optional<Document> DocumentSourceGroup::getNext() {
         pExpCtx->checkForInterrupt();
 
+        if (_streaming)
+            return getNextStreaming();
+
         if (!populated)
             populate();
 
@@ -100,25 +160,97 @@ namespace mongo {
 
             return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
 
-        } else {
-            if (groups.empty())
+        } else if (_sortedOutput) {
+            if (_nextSortedGroup >= _sortedGroups.size())
                 return boost::none;
 
+            const GroupsMap::iterator& group = _sortedGroups[_nextSortedGroup];
+            Document out = makeDocument(group->first, group->second, pExpCtx->inShard);
+
+            if (++_nextSortedGroup == _sortedGroups.size())
+                dispose();
+
+            return out;
+        } else {
+            while (groupsIterator == groups.end()) {
+                if (_spilledPartitions.empty())
+                    return boost::none;
+
+                loadNextPartition();
+            }
+
             Document out = makeDocument(groupsIterator->first,
                                         groupsIterator->second,
                                         pExpCtx->inShard);
 
-            if (++groupsIterator == groups.end())
+            if (++groupsIterator == groups.end() && _spilledPartitions.empty())
                 dispose();
 
             return out;
         }
     }
 
+    boost::optional<Document> DocumentSourceGroup::getNextStreaming() {
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+
+        if (!populated) {
+            _currentAccumulators.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators.push_back(vpAccumulatorFactory[i]());
+            }
+
+            _firstDocOfNextGroup = pSource->getNext();
+            if (_firstDocOfNextGroup) {
+                _variables->setRoot(*_firstDocOfNextGroup);
+                _nextId = computeId(_variables.get());
+            }
+            populated = true;
+        }
+
+        if (!_firstDocOfNextGroup)
+            return boost::none;
+
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _currentAccumulators[i]->reset(); // prep accumulators for a new group
+        }
+
+        /* treat missing values the same as NULL SERVER-4674 */
+        _currentId = _nextId.missing() ? Value(BSONNULL) : _nextId;
+        while (true) {
+            // Inside of this loop, ROOT is the current document being processed. At loop exit,
+            // it is the first document of the next group, if there is one.
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _currentAccumulators[i]->process(vpExpression[i]->evaluate(_variables.get()),
+                                                 _doingMerge);
+            }
+            _variables->clearRoot();
+
+            _firstDocOfNextGroup = pSource->getNext();
+            if (!_firstDocOfNextGroup) {
+                Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+                dispose();
+                return out;
+            }
+
+            _variables->setRoot(*_firstDocOfNextGroup);
+            _nextId = computeId(_variables.get());
+            if (_nextId.missing())
+                _nextId = Value(BSONNULL);
+            if (Value::compare(_nextId, _currentId) != 0)
+                return makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
+        }
+    }
+
     void DocumentSourceGroup::dispose() {
         // free our resources
+        std::vector<GroupsMap::iterator>().swap(_sortedGroups);
         GroupsMap().swap(groups);
         _sorterIterator.reset();
+        _partitionWriters.clear();
+        _spilledPartitions.clear();
+        _memoryCharge.set(0);
+
+        _firstDocOfNextGroup = boost::none;
 
         // make us look done
         groupsIterator = groups.end();
@@ -138,6 +270,20 @@ namespace mongo {
         for (size_t i = 0; i < vFieldName.size(); i++) {
              vpExpression[i] = vpExpression[i]->optimize();
         }
+
+        // Evaluate subexpressions repeated across the _id and the accumulators once per document.
+        vector<intrusive_ptr<Expression>*> expressions;
+        for (size_t i = 0; i < _idExpressions.size(); i++) {
+            expressions.push_back(&_idExpressions[i]);
+        }
+        for (size_t i = 0; i < vpExpression.size(); i++) {
+            expressions.push_back(&vpExpression[i]);
+        }
+        const Variables::Id firstSharedId = _variables->getNumVars();
+        const Variables::Id numVars =
+            Expression::shareCommonSubexpressions(expressions, firstSharedId);
+        _variables.reset(new Variables(numVars));
+        _variables->clearOnNewRoot(firstSharedId);
     }
 
     Value DocumentSourceGroup::serialize(bool explain) const {
@@ -173,9 +319,44 @@ namespace mongo {
             insides["$doingMerge"] = Value(true);
         }
 
+        if (explain && _streaming) {
+            insides["$streaming"] = Value(true);
+        }
+
         return Value(DOC(getSourceName() << insides.freeze()));
     }
 
+    void DocumentSourceGroup::serializeToArray(vector<Value>& array, bool explain) const {
+        array.push_back(serialize(explain));
+        if (_sortedOutput) {
+            array.push_back(Value(DOC(DocumentSourceSort::sortName << DOC("_id" << 1))));
+        }
+    }
+
+    bool DocumentSourceGroup::coalesce(const intrusive_ptr<DocumentSource>& nextSource) {
+        DocumentSourceSort* sort = dynamic_cast<DocumentSourceSort*>(nextSource.get());
+        if (_sortedOutput || !sort || sort->getLimitSrc())
+            return false;
+
+        const BSONObj sortPattern = sort->serializeSortKey(/*explain*/false).toBson();
+        if (sortPattern.nFields() != 1 ||
+                !str::equals(sortPattern.firstElementFieldName(), "_id") ||
+                sortPattern.firstElement().number() < 0)
+            return false;
+
+        _sortedOutput = true;
+        return true;
+    }
+
+    void DocumentSourceGroup::setStreamingIfSortedBy(const BSONObj& sortPattern) {
+        const BSONElement firstSortKey = sortPattern.firstElement();
+        const std::string path = getGroupByFieldPath();
+        _streaming = !path.empty()
+                  && firstSortKey.isNumber()
+                  && path == firstSortKey.fieldNameStringData()
+                  && !(_sortedOutput && firstSortKey.number() < 0);
+    }
+
     DocumentSource::GetDepsReturn DocumentSourceGroup::getDependencies(DepsTracker* deps) const {
         // add the _id
         for (size_t i = 0; i < _idExpressions.size(); i++) {
@@ -202,9 +383,16 @@ namespace mongo {
         : DocumentSource(pExpCtx)
         , populated(false)
         , _doingMerge(false)
+        , _streaming(false)
+        , _sortedOutput(false)
         , _spilled(false)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
         , _maxMemoryUsageBytes(100*1024*1024)
+        , _memoryUsageBytes(0)
+        , _memoryCharge(MemoryTracker::kGroup)
+        , _numSpillPartitions(std::max(0, internalDocumentSourceGroupSpillPartitions))
+        , _partitionLevel(0)
+        , _nextSortedGroup(0)
     {}
 
     void DocumentSourceGroup::addAccumulator(
@@ -353,22 +541,37 @@ namespace mongo {
         };
     }
 
+    namespace {
+        struct GroupIteratorLess {
+            template <typename Iterator>
+            bool operator() (const Iterator& lhs, const Iterator& rhs) const {
+                return Value::compare(lhs->first, rhs->first) < 0;
+            }
+        };
+    }
+
     void DocumentSourceGroup::populate() {
         const size_t numAccumulators = vpAccumulatorFactory.size();
         dassert(numAccumulators == vpExpression.size());
 
         // pushed to on spill()
         vector<shared_ptr<Sorter<Value, Value>::Iterator> > sortedFiles;
-        int memoryUsageBytes = 0;
+        _memoryUsageBytes = 0;
+        _memoryCharge.setOperationContext(pExpCtx->opCtx);
 
         // This loop consumes all input from pSource and buckets it based on pIdExpression.
         while (boost::optional<Document> input = pSource->getNext()) {
-            if (memoryUsageBytes > _maxMemoryUsageBytes) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes || !chargeMemory()) {
                 uassert(16945, "Exceeded memory limit for $group, but didn't allow external sort."
                                " Pass allowDiskUse:true to opt in.",
                         _extSortAllowed);
-                sortedFiles.push_back(spill());
-                memoryUsageBytes = 0;
+                if (_numSpillPartitions > 0 && !_sortedOutput) {
+                    spillPartitions();
+                }
+                else {
+                    sortedFiles.push_back(spill());
+                    _memoryUsageBytes = 0;
+                }
             }
 
             _variables->setRoot(*input);
@@ -389,7 +592,7 @@ namespace mongo {
             const bool inserted = groups.size() != oldSize;
 
             if (inserted) {
-                memoryUsageBytes += id.getApproximateSize();
+                _memoryUsageBytes += id.getApproximateSize();
 
                 // Add the accumulators
                 group.reserve(numAccumulators);
@@ -399,7 +602,7 @@ namespace mongo {
             } else {
                 for (size_t i = 0; i < numAccumulators; i++) {
                     // subtract old mem usage. New usage added back after processing.
-                    memoryUsageBytes -= group[i]->memUsageForSorter();
+                    _memoryUsageBytes -= group[i]->memUsageForSorter();
                 }
             }
 
@@ -407,7 +610,7 @@ namespace mongo {
             dassert(numAccumulators == group.size());
             for (size_t i = 0; i < numAccumulators; i++) {
                 group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-                memoryUsageBytes += group[i]->memUsageForSorter();
+                _memoryUsageBytes += group[i]->memUsageForSorter();
             }
 
             // We are done with the ROOT document so release it.
@@ -420,12 +623,22 @@ namespace mongo {
                         && !_extSortAllowed // don't change behavior when testing external sort
                         && sortedFiles.size() < 20 // don't open too many FDs
                         ) {
-                    sortedFiles.push_back(spill());
+                    if (_numSpillPartitions > 0 && !_sortedOutput) {
+                        // Spilling once is enough to route the remaining groups of the spilled
+                        // partitions to disk, and repeating it would be quadratic.
+                        if (_partitionWriters.empty())
+                            spillPartitions();
+                    }
+                    else {
+                        sortedFiles.push_back(spill());
+                    }
                 }
             }
         }
 
         // These blocks do any final steps necessary to prepare to output results.
+        finishPartitionedSpill();
+
         if (!sortedFiles.empty()) {
             _spilled = true;
             if (!groups.empty()) {
@@ -434,6 +647,7 @@ namespace mongo {
 
             // We won't be using groups again so free its memory.
             GroupsMap().swap(groups);
+            _memoryCharge.set(0);
 
             _sorterIterator.reset(
                     Sorter<Value,Value>::Iterator::merge(
@@ -450,11 +664,187 @@ namespace mongo {
         } else {
             // start the group iterator
             groupsIterator = groups.begin();
+
+            if (_sortedOutput) {
+                _sortedGroups.reserve(groups.size());
+                for (GroupsMap::iterator it = groups.begin(); it != groups.end(); ++it) {
+                    _sortedGroups.push_back(it);
+                }
+                std::sort(_sortedGroups.begin(), _sortedGroups.end(), GroupIteratorLess());
+            }
         }
 
+        // The groups left in memory stay charged to the subsystem until dispose(), but not to
+        // this operation, which can end before they are all returned.
+        _memoryCharge.setOperationContext(NULL);
         populated = true;
     }
 
+    bool DocumentSourceGroup::chargeMemory() {
+        return _memoryCharge.set(_memoryUsageBytes).isOK();
+    }
+
+    int DocumentSourceGroup::groupMemoryUsage(const Value& id, const Accumulators& accumulators) {
+        int bytes = id.getApproximateSize();
+        for (size_t i = 0; i < accumulators.size(); i++) {
+            bytes += accumulators[i]->memUsageForSorter();
+        }
+        return bytes;
+    }
+
+    size_t DocumentSourceGroup::partitionFor(const Value& id) const {
+        size_t seed = _partitionLevel;
+        id.hash_combine(seed);
+        boost::hash_combine(seed, _partitionLevel);
+        return seed % _numSpillPartitions;
+    }
+
+    void DocumentSourceGroup::spillPartitions() {
+        invariant(_numSpillPartitions > 0);
+
+        if (_partitionLevel > kMaxPartitionLevel) {
+            // Repartitioning hasn't been able to make this fit; see kMaxPartitionLevel.
+            return;
+        }
+
+        const size_t numPartitions = _numSpillPartitions;
+        if (_partitionWriters.empty()) {
+            _partitionWriters.resize(numPartitions);
+        }
+
+        vector<long long> partitionBytes(numPartitions, 0);
+        for (GroupsMap::const_iterator it = groups.begin(); it != groups.end(); ++it) {
+            partitionBytes[partitionFor(it->first)] += groupMemoryUsage(it->first, it->second);
+        }
+
+        // Partitions that have already been spilled go to disk regardless, since we'll have to
+        // read their file back later anyway.
+        vector<bool> spillPartition(numPartitions, false);
+        long long bytesToFree = 0;
+        for (size_t i = 0; i < numPartitions; i++) {
+            if (_partitionWriters[i]) {
+                spillPartition[i] = true;
+                bytesToFree += partitionBytes[i];
+            }
+        }
+
+        while (bytesToFree < _memoryUsageBytes / 2) {
+            size_t largest = numPartitions;
+            for (size_t i = 0; i < numPartitions; i++) {
+                if (!spillPartition[i] &&
+                    partitionBytes[i] > 0 &&
+                    (largest == numPartitions || partitionBytes[i] > partitionBytes[largest])) {
+                    largest = i;
+                }
+            }
+
+            if (largest == numPartitions)
+                break;
+
+            spillPartition[largest] = true;
+            bytesToFree += partitionBytes[largest];
+        }
+
+        for (GroupsMap::iterator it = groups.begin(); it != groups.end();) {
+            const size_t partition = partitionFor(it->first);
+            if (!spillPartition[partition]) {
+                ++it;
+                continue;
+            }
+
+            if (!_partitionWriters[partition]) {
+                _partitionWriters[partition].reset(
+                    new SortedFileWriter<Value, Value>(SortOptions().TempDir(pExpCtx->tempDir)));
+            }
+
+            // Despite the name, SortedFileWriter doesn't require its input to be sorted. We only
+            // ever read these files back sequentially.
+            _partitionWriters[partition]->addAlreadySorted(it->first,
+                                                           serializeAccumulatorStates(it->second));
+            it = groups.erase(it);
+        }
+
+        _memoryUsageBytes -= bytesToFree;
+    }
+
+    void DocumentSourceGroup::finishPartitionedSpill() {
+        if (_partitionWriters.empty())
+            return;
+
+        // Everything left in memory for a spilled partition joins the rest of it on disk; the
+        // groups of partitions that never spilled are complete and stay where they are.
+        for (GroupsMap::iterator it = groups.begin(); it != groups.end();) {
+            const boost::shared_ptr<SortedFileWriter<Value, Value> >& writer =
+                _partitionWriters[partitionFor(it->first)];
+            if (!writer) {
+                ++it;
+                continue;
+            }
+
+            _memoryUsageBytes -= groupMemoryUsage(it->first, it->second);
+            writer->addAlreadySorted(it->first, serializeAccumulatorStates(it->second));
+            it = groups.erase(it);
+        }
+
+        for (size_t i = 0; i < _partitionWriters.size(); i++) {
+            if (_partitionWriters[i]) {
+                SpilledPartition partition;
+                partition.data.reset(_partitionWriters[i]->done());
+                partition.level = _partitionLevel;
+                _spilledPartitions.push_back(partition);
+            }
+        }
+        _partitionWriters.clear();
+    }
+
+    void DocumentSourceGroup::loadNextPartition() {
+        invariant(!_spilledPartitions.empty());
+
+        // Take the most recently spilled partition first, so that the partitions split off a
+        // partition that didn't fit in memory are processed before anything else is opened.
+        SpilledPartition partition = _spilledPartitions.back();
+        _spilledPartitions.pop_back();
+
+        GroupsMap().swap(groups);
+        _memoryUsageBytes = 0;
+        _partitionLevel = partition.level + 1;
+
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        while (partition.data->more()) {
+            pExpCtx->checkForInterrupt();
+
+            if (_memoryUsageBytes > _maxMemoryUsageBytes || !chargeMemory()) {
+                spillPartitions();
+            }
+
+            const pair<Value, Value> record = partition.data->next();
+
+            const size_t oldSize = groups.size();
+            Accumulators& group = groups[record.first];
+            if (groups.size() != oldSize) {
+                _memoryUsageBytes += record.first.getApproximateSize();
+                group.reserve(numAccumulators);
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    group.push_back(vpAccumulatorFactory[i]());
+                }
+            }
+            else {
+                for (size_t i = 0; i < numAccumulators; i++) {
+                    _memoryUsageBytes -= group[i]->memUsageForSorter();
+                }
+            }
+
+            mergeAccumulatorStates(group, record.second);
+
+            for (size_t i = 0; i < numAccumulators; i++) {
+                _memoryUsageBytes += group[i]->memUsageForSorter();
+            }
+        }
+
+        finishPartitionedSpill();
+        groupsIterator = groups.begin();
+    }
+
     class DocumentSourceGroup::SpillSTLComparator {
     public:
         bool operator() (const GroupsMap::value_type* lhs, const GroupsMap::value_type* rhs) const {
@@ -536,6 +926,24 @@ namespace mongo {
         }
     }
 
+    std::string DocumentSourceGroup::getGroupByFieldPath() const {
+        if (_idExpressions.size() != 1)
+            return "";
+
+        const ExpressionFieldPath* fieldPath =
+            dynamic_cast<const ExpressionFieldPath*>(_idExpressions[0].get());
+        if (!fieldPath)
+            return "";
+
+        // Only paths into the input document itself, as opposed to other variables.
+        const FieldPath& path = fieldPath->getFieldPath();
+        if (path.getPathLength() < 2 ||
+                (path.getFieldName(0) != "CURRENT" && path.getFieldName(0) != "ROOT"))
+            return "";
+
+        return path.tail().getPath(false);
+    }
+
     Value DocumentSourceGroup::computeId(Variables* vars) {
         // If only one expression return result directly
         if (_idExpressions.size() == 1)
@@ -600,6 +1008,7 @@ namespace mongo {
     intrusive_ptr<DocumentSource> DocumentSourceGroup::getMergeSource() {
         intrusive_ptr<DocumentSourceGroup> pMerger(DocumentSourceGroup::create(pExpCtx));
         pMerger->setDoingMerge(true);
+        pMerger->setSortedOutput(_sortedOutput);
 
         VariablesIdGenerator idGenerator;
         VariablesParseState vps(&idGenerator);
@@ -292,6 +292,34 @@ namespace {
     }
 }
 
+namespace {
+    bool addFieldPaths(const BSONObj& query, vector<string>* paths) {
+        BSONForEach(field, query) {
+            const StringData name = field.fieldNameStringData();
+            if (name[0] != '$') {
+                paths->push_back(name.toString());
+            }
+            else if (name == "$and" || name == "$or" || name == "$nor") {
+                if (field.type() != Array)
+                    return false;
+                BSONForEach(clause, field.Obj()) {
+                    if (clause.type() != Object || !addFieldPaths(clause.Obj(), paths))
+                        return false;
+                }
+            }
+            else if (name != "$comment") {
+                // $where, $text and the like.
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+    bool DocumentSourceMatch::getQueryFieldPaths(vector<string>* paths) const {
+        return addFieldPaths(getQuery(), paths);
+    }
+
     BSONObj DocumentSourceMatch::redactSafePortion() const {
         return redactSafePortionTopLevel(getQuery()).toBson();
     }
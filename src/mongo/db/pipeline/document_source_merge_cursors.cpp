@@ -130,9 +130,14 @@ namespace mongo {
             bool ok = (*it)->cursor.initLazyFinish(retry); // blocks here for first batch
 
             uassert(17028,
-                    "error reading response from " + _cursors.back()->connection->toString(),
+                    "error reading response from " + (*it)->connection->toString(),
                     ok);
             verify(!retry);
+
+            // Later batches are read over pooled connections. This lets each shard be asked for
+            // its next batch ahead of time, so that they all produce them at once.
+            (*it)->cursor.attach(&(*it)->connection);
+            (*it)->cursor.requestMoreLazy();
         }
 
         _currentCursor = _cursors.begin();
@@ -153,17 +158,35 @@ namespace mongo {
         if (_unstarted)
             start();
 
-        // purge eof cursors and release their connections
-        while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
+        while (!_cursors.empty()) {
+            // Prefer a shard whose results have already arrived over waiting on the next one.
+            for (size_t i = 0; i < _cursors.size(); i++) {
+                if ((*_currentCursor)->cursor.moreInCurrentBatch())
+                    break;
+                if (++_currentCursor == _cursors.end())
+                    _currentCursor = _cursors.begin();
+            }
+
+            if ((*_currentCursor)->cursor.more())
+                break;
+
+            // purge eof cursors and release their connections
             (*_currentCursor)->connection.done();
-            _cursors.erase(_currentCursor);
-            _currentCursor = _cursors.begin();
+            _currentCursor = _cursors.erase(_currentCursor);
+            if (_currentCursor == _cursors.end())
+                _currentCursor = _cursors.begin();
         }
 
         if (_cursors.empty())
             return boost::none;
 
-        const Document next = nextSafeFrom(&((*_currentCursor)->cursor));
+        DBClientCursor* cursor = &((*_currentCursor)->cursor);
+        const Document next = nextSafeFrom(cursor);
+
+        // Once a batch is used up, have its shard start on the next one while the results from
+        // the other shards are returned.
+        if (!cursor->moreInCurrentBatch())
+            cursor->requestMoreLazy();
 
         // advance _currentCursor, wrapping if needed
         if (++_currentCursor == _cursors.end())
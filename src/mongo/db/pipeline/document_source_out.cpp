@@ -83,28 +83,43 @@ namespace mongo {
                     ok);
         }
 
-        // copy indexes on _outputNs to _tempNs
+        // The indexes on _outputNs are copied to _tempNs after the data is loaded, so that each
+        // is built in one pass over it rather than maintained on every insert. They are read
+        // now so that those of the collection being replaced are the ones copied.
         const std::list<BSONObj> indexes = conn->getIndexSpecs(_outputNs);
         for (std::list<BSONObj>::const_iterator it = indexes.begin(); it != indexes.end(); ++it) {
             MutableDocument index((Document(*it)));
             index.remove("_id"); // indexes shouldn't have _ids but some existing ones do
-            index["ns"] = Value(_tempNs.ns());
+            index.remove("ns");
+            if (index.peek()["name"].getString() == "_id_") {
+                continue; // created along with the collection
+            }
+            _indexSpecs.push_back(index.freeze().toBson());
+        }
+    }
+
+    void DocumentSourceOut::buildTempIndexes() {
+        DBClientBase* conn = _mongod->directClient();
 
-            BSONObj indexBson = index.freeze().toBson();
-            conn->insert(_tempNs.getSystemIndexesCollection(), indexBson);
-            BSONObj err = conn->getLastErrorDetailed();
+        for (vector<BSONObj>::const_iterator it = _indexSpecs.begin();
+             it != _indexSpecs.end();
+             ++it) {
+            BSONObj info;
+            bool ok = conn->runCommand(_tempNs.db().toString(),
+                                       BSON("createIndexes" << _tempNs.coll()
+                                         << "indexes" << BSON_ARRAY(*it)),
+                                       info);
             uassert(16995, str::stream() << "copying index for $out failed."
-                                         << " index: " << indexBson
-                                         << " error: " <<  err,
-                    DBClientWithCommands::getLastErrorString(err).empty());
+                                         << " index: " << *it
+                                         << " error: " << info,
+                    ok);
         }
     }
 
-    void DocumentSourceOut::spill(DBClientBase* conn, const vector<BSONObj>& toInsert) {
-        conn->insert(_tempNs.ns(), toInsert);
-        BSONObj err = conn->getLastErrorDetailed();
-        uassert(16996, str::stream() << "insert for $out failed: " << err,
-                DBClientWithCommands::getLastErrorString(err).empty());
+    void DocumentSourceOut::spill(const vector<BSONObj>& toInsert) {
+        Status status = _mongod->insert(_tempNs, toInsert);
+        uassert(16996, str::stream() << "insert for $out failed: " << status.toString(),
+                status.isOK());
     }
 
     boost::optional<Document> DocumentSourceOut::getNext() {
@@ -116,7 +131,6 @@ namespace mongo {
         _done = true;
 
         verify(_mongod);
-        DBClientBase* conn = _mongod->directClient();
 
         prepTempCollection();
         verify(_tempNs.size() != 0);
@@ -127,7 +141,7 @@ namespace mongo {
             BSONObj toInsert = next->toBson();
             bufferedBytes += toInsert.objsize();
             if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
-                spill(conn, bufferedObjects);
+                spill(bufferedObjects);
                 bufferedObjects.clear();
                 bufferedBytes = toInsert.objsize();
             }
@@ -135,7 +149,9 @@ namespace mongo {
         }
 
         if (!bufferedObjects.empty())
-            spill(conn, bufferedObjects);
+            spill(bufferedObjects);
+
+        buildTempIndexes();
 
         // Checking again to make sure we didn't become sharded while running.
         uassert(17018, str::stream() << "namespace '" << _outputNs.ns()
@@ -147,7 +163,7 @@ namespace mongo {
                            << "dropTarget" << true
                            );
         BSONObj info;
-        bool ok = conn->runCommand("admin", rename, info);
+        bool ok = _mongod->directClient()->runCommand("admin", rename, info);
         uassert(16997,  str::stream() << "renameCollection for $out failed: " << info,
                 ok);
 
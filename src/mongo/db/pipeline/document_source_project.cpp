@@ -82,6 +82,15 @@ namespace mongo {
     void DocumentSourceProject::optimize() {
         intrusive_ptr<Expression> pE(pEO->optimize());
         pEO = boost::dynamic_pointer_cast<ExpressionObject>(pE);
+
+        // Evaluate subexpressions repeated across the computed fields once per document.
+        vector<intrusive_ptr<Expression>*> fields;
+        pEO->addChildren(&fields);
+        const Variables::Id firstSharedId = _variables->getNumVars();
+        const Variables::Id numVars =
+            Expression::shareCommonSubexpressions(fields, firstSharedId);
+        _variables.reset(new Variables(numVars));
+        _variables->clearOnNewRoot(firstSharedId);
     }
 
     Value DocumentSourceProject::serialize(bool explain) const {
@@ -119,6 +128,23 @@ namespace mongo {
         return pProject;
     }
 
+    bool DocumentSourceProject::keepsField(StringData fieldName) const {
+        const BSONElement spec = _raw[fieldName];
+        if (spec.eoo()) {
+            // _id is included unless it is excluded.
+            return fieldName == "_id";
+        }
+        if (spec.isNumber() || spec.type() == Bool) {
+            return spec.trueValue();
+        }
+        if (spec.type() == String) {
+            // {a: "$a"} keeps a as well.
+            const StringData path = spec.valueStringData();
+            return path.startsWith("$") && path.substr(1) == fieldName;
+        }
+        return false;
+    }
+
     DocumentSource::GetDepsReturn DocumentSourceProject::getDependencies(DepsTracker* deps) const {
         vector<string> path; // empty == top-level
         pEO->addDependencies(deps, &path);
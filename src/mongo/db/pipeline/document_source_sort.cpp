@@ -56,6 +56,9 @@ namespace mongo {
     boost::optional<Document> DocumentSourceSort::getNext() {
         pExpCtx->checkForInterrupt();
 
+        if (_presortedPrefix)
+            return getNextByPrefix();
+
         if (!populated)
             populate();
 
@@ -65,12 +68,68 @@ namespace mongo {
         return _output->next().second;
     }
 
+    boost::optional<Document> DocumentSourceSort::getNextByPrefix() {
+        if (!populated) {
+            _firstOfNextRun = pSource->getNext();
+            populated = true;
+        }
+
+        while (!_output || !_output->more()) {
+            if (!_firstOfNextRun || (limitSrc && _numReturned >= limitSrc->getLimit()))
+                return boost::none;
+
+            sortNextPrefixRun();
+        }
+
+        _numReturned++;
+        return _output->next().second;
+    }
+
+    void DocumentSourceSort::sortNextPrefixRun() {
+        SortOptions opts = makeSortOptions();
+        if (limitSrc) {
+            // Only as many as are still missing can come from this run.
+            opts.limit = limitSrc->getLimit() - _numReturned;
+        }
+        scoped_ptr<MySorter> sorter(MySorter::make(opts, Comparator(*this)));
+
+        const vector<Value> prefix = extractPrefix(*_firstOfNextRun);
+        sorter->add(extractKey(*_firstOfNextRun), *_firstOfNextRun);
+        while ((_firstOfNextRun = pSource->getNext())) {
+            const vector<Value> nextPrefix = extractPrefix(*_firstOfNextRun);
+            bool samePrefix = true;
+            for (size_t i = 0; samePrefix && i < prefix.size(); i++) {
+                samePrefix = Value::compare(prefix[i], nextPrefix[i]) == 0;
+            }
+            if (!samePrefix)
+                break;
+
+            sorter->add(extractKey(*_firstOfNextRun), *_firstOfNextRun);
+        }
+
+        _output.reset(sorter->done());
+    }
+
+    vector<Value> DocumentSourceSort::extractPrefix(const Document& d) const {
+        Variables vars(0, d);
+        vector<Value> prefix;
+        prefix.reserve(_presortedPrefix);
+        for (size_t i = 0; i < _presortedPrefix; i++) {
+            Value key = vSortKey[i]->evaluate(&vars);
+            prefix.push_back(key.nullish() ? Value(BSONNULL) : key);
+        }
+        return prefix;
+    }
+
     void DocumentSourceSort::serializeToArray(vector<Value>& array, bool explain) const {
         if (explain) { // always one Value for combined $sort + $limit
             array.push_back(Value(DOC(getSourceName() <<
                 DOC("sortKey" << serializeSortKey(explain)
                  << "mergePresorted" << (_mergingPresorted ? Value(true) : Value())
-                 << "limit" << (limitSrc ? Value(limitSrc->getLimit()) : Value())))));
+                 << "limit" << (limitSrc ? Value(limitSrc->getLimit()) : Value())
+                 << "presortedPrefix" << (_presortedPrefix
+                                          ? Value(static_cast<int>(_presortedPrefix))
+                                          : Value())))));
         }
         else { // one Value for $sort and maybe a Value for $limit
             MutableDocument inner (serializeSortKey(explain));
@@ -86,6 +145,7 @@ namespace mongo {
 
     void DocumentSourceSort::dispose() {
         _output.reset();
+        _firstOfNextRun = boost::none;
         pSource->dispose();
     }
 
@@ -93,6 +153,8 @@ namespace mongo {
         : DocumentSource(pExpCtx)
         , populated(false)
         , _mergingPresorted(false)
+        , _presortedPrefix(0)
+        , _numReturned(0)
     {}
 
     long long DocumentSourceSort::getLimit() const {
@@ -100,6 +100,9 @@ namespace mongo {
         // clone. Because the value at the end will be replaced, everything
         // along the path leading to that will be replaced in order not to share
         // that change with any other clones (or the original).
+        //
+        // When nothing else holds on to the previous output, nothing is shared and the value
+        // is replaced in place, so a wide document isn't copied once per array element.
 
         if (_inputArray.getType() == Array) {
             if (_index == _inputArray.getArrayLength())
@@ -138,8 +141,11 @@ namespace mongo {
             if (!input)
                 return boost::none; // input exhausted
 
-            // Try to extract an output document from the new input document.
+            // Try to extract an output document from the new input document. The input is
+            // released first, leaving the unwinder with the only reference to it unless the
+            // source keeps one, so that even the first element is set without a copy.
             _unwinder->resetDocument(*input);
+            input = boost::none;
             out = _unwinder->getNext();
         }
 
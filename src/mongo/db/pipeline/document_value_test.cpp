@@ -461,6 +461,33 @@ namespace DocumentTests {
             }
         };
 
+        /** Moving a Value leaves the source missing and keeps the storage's ref count. */
+        class Move {
+        public:
+            void run() {
+                Value array(BSON_ARRAY("a long string which is not stored inline" << 2));
+                Value copy = array;
+                Value moved(std::move(array));
+                ASSERT(array.missing());
+                ASSERT_EQUALS(copy, moved);
+
+                Value assigned;
+                assigned = std::move(moved);
+                ASSERT(moved.missing());
+                ASSERT_EQUALS(copy, assigned);
+
+                // Growing a vector moves its Values.
+                vector<Value> values;
+                for (int i = 0; i < 100; i++) {
+                    values.push_back(Value(std::string(str::stream() << "long string " << i)));
+                }
+                for (int i = 0; i < 100; i++) {
+                    ASSERT_EQUALS(Value(std::string(str::stream() << "long string " << i)),
+                                  values[i]);
+                }
+            }
+        };
+
         /** Int type. */
         class Int {
         public:
@@ -1427,6 +1454,7 @@ namespace DocumentTests {
             add<Document::AllTypesDoc>();
 
             add<Value::BSONArrayTest>();
+            add<Value::Move>();
             add<Value::Int>();
             add<Value::Long>();
             add<Value::Double>();
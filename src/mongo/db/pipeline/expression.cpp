@@ -181,6 +181,88 @@ namespace mongo {
         return ((options & INCLUSION_OK) != 0);
     }
 
+namespace {
+    typedef std::map<string, size_t> SubexpressionCounts;
+    typedef std::map<string, intrusive_ptr<ExpressionCommonSubexpression> > SharedSubexpressions;
+
+    /**
+     * Cheap expressions aren't worth remembering, and ExpressionObjects can't be replaced as
+     * their parents treat them specially.
+     */
+    bool isShareable(const Expression* expr) {
+        return !dynamic_cast<const ExpressionConstant*>(expr)
+            && !dynamic_cast<const ExpressionFieldPath*>(expr)
+            && !dynamic_cast<const ExpressionObject*>(expr)
+            && !dynamic_cast<const ExpressionCommonSubexpression*>(expr);
+    }
+
+    /// Equivalent expressions serialize the same.
+    string subexpressionKey(const Expression* expr) {
+        BSONObjBuilder builder;
+        expr->serialize(false).addToBsonObj(&builder, "");
+        const BSONObj key = builder.done();
+        return string(key.objdata(), key.objsize());
+    }
+
+    void countSubexpressions(Expression* expr, SubexpressionCounts* counts) {
+        if (isShareable(expr)) {
+            (*counts)[subexpressionKey(expr)]++;
+        }
+
+        vector<intrusive_ptr<Expression>*> children;
+        expr->addChildren(&children);
+        for (size_t i = 0; i < children.size(); i++) {
+            countSubexpressions(children[i]->get(), counts);
+        }
+    }
+
+    void shareSubexpressions(intrusive_ptr<Expression>* slot,
+                             const SubexpressionCounts& counts,
+                             SharedSubexpressions* shared,
+                             Variables::Id* nextId) {
+        Expression* expr = slot->get();
+        string key;
+        if (isShareable(expr)) {
+            key = subexpressionKey(expr);
+            SharedSubexpressions::const_iterator it = shared->find(key);
+            if (it != shared->end()) {
+                *slot = it->second;
+                return;
+            }
+        }
+
+        // Outermost first, so that each repeated tree is shared as a whole.
+        vector<intrusive_ptr<Expression>*> children;
+        expr->addChildren(&children);
+        for (size_t i = 0; i < children.size(); i++) {
+            shareSubexpressions(children[i], counts, shared, nextId);
+        }
+
+        if (!key.empty() && counts.find(key)->second > 1) {
+            intrusive_ptr<ExpressionCommonSubexpression> common =
+                ExpressionCommonSubexpression::create(*slot, (*nextId)++);
+            (*shared)[key] = common;
+            *slot = common;
+        }
+    }
+} // namespace
+
+    Variables::Id Expression::shareCommonSubexpressions(
+            const vector<intrusive_ptr<Expression>*>& roots,
+            Variables::Id firstFreeId) {
+        SubexpressionCounts counts;
+        for (size_t i = 0; i < roots.size(); i++) {
+            countSubexpressions(roots[i]->get(), &counts);
+        }
+
+        SharedSubexpressions shared;
+        Variables::Id nextId = firstFreeId;
+        for (size_t i = 0; i < roots.size(); i++) {
+            shareSubexpressions(roots[i], counts, &shared, &nextId);
+        }
+        return nextId;
+    }
+
     string Expression::removeFieldPrefix(const string &prefixedField) {
         uassert(16419, str::stream()<<"field path must not contain embedded null characters" << prefixedField.find("\0") << "," ,
                 prefixedField.find('\0') == string::npos);
@@ -610,6 +692,49 @@ namespace {
         return Value(DOC(name << DOC_ARRAY(pExpression->serialize(explain))));
     }
 
+    void ExpressionCoerceToBool::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        children->push_back(&pExpression);
+    }
+
+    /* ------------------ ExpressionCommonSubexpression -------------------- */
+
+    intrusive_ptr<ExpressionCommonSubexpression> ExpressionCommonSubexpression::create(
+            const intrusive_ptr<Expression>& expression,
+            Variables::Id id) {
+        return new ExpressionCommonSubexpression(expression, id);
+    }
+
+    ExpressionCommonSubexpression::ExpressionCommonSubexpression(
+            const intrusive_ptr<Expression>& expression,
+            Variables::Id id)
+        : _expression(expression)
+        , _id(id)
+    {}
+
+    intrusive_ptr<Expression> ExpressionCommonSubexpression::optimize() {
+        _expression = _expression->optimize();
+        return this;
+    }
+
+    void ExpressionCommonSubexpression::addDependencies(DepsTracker* deps,
+                                                        vector<string>* path) const {
+        _expression->addDependencies(deps);
+    }
+
+    Value ExpressionCommonSubexpression::evaluateInternal(Variables* vars) const {
+        // A missing result isn't told apart from one not computed yet, and is recomputed.
+        Value result = vars->getValue(_id);
+        if (result.missing()) {
+            result = _expression->evaluateInternal(vars);
+            vars->setValue(_id, result);
+        }
+        return result;
+    }
+
+    Value ExpressionCommonSubexpression::serialize(bool explain) const {
+        return _expression->serialize(explain);
+    }
+
     /* ----------------------- ExpressionCompare --------------------------- */
 
     REGISTER_EXPRESSION("$cmp",
@@ -991,6 +1116,10 @@ namespace {
         _date->addDependencies(deps);
     }
 
+    void ExpressionDateToString::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        children->push_back(&_date);
+    }
+
     /* ---------------------- ExpressionDayOfMonth ------------------------- */
 
     Value ExpressionDayOfMonth::evaluateInternal(Variables* vars) const {
@@ -1089,6 +1218,14 @@ namespace {
         return true;
     }
 
+    void ExpressionObject::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        for (FieldMap::iterator it = _expressions.begin(); it != _expressions.end(); ++it) {
+            if (it->second) {
+                children->push_back(&it->second);
+            }
+        }
+    }
+
     void ExpressionObject::addDependencies(DepsTracker* deps, vector<string>* path) const {
         string pathStr;
         if (path) {
@@ -1577,6 +1714,13 @@ namespace {
         _subExpression->addDependencies(deps);
     }
 
+    void ExpressionLet::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        // The variables are evaluated in the enclosing scope, but 'in' sees them.
+        for (VariableMap::iterator it = _variables.begin(); it != _variables.end(); ++it) {
+            children->push_back(&it->second.expression);
+        }
+    }
+
 
     /* ------------------------- ExpressionMap ----------------------------- */
 
@@ -1689,6 +1833,11 @@ namespace {
         _each->addDependencies(deps);
     }
 
+    void ExpressionMap::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        // 'in' is evaluated with the variable bound to each element.
+        children->push_back(&_input);
+    }
+
     /* ------------------------- ExpressionMeta ----------------------------- */
 
     REGISTER_EXPRESSION("$meta", ExpressionMeta::parse);
@@ -1974,6 +2123,12 @@ namespace {
         }
     }
 
+    void ExpressionNary::addChildren(vector<intrusive_ptr<Expression>*>* children) {
+        for (ExpressionVector::iterator i = vpOperand.begin(); i != vpOperand.end(); ++i) {
+            children->push_back(&*i);
+        }
+    }
+
     void ExpressionNary::addOperand(const intrusive_ptr<Expression>& pExpression) {
         vpOperand.push_back(pExpression);
     }
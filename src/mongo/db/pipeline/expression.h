@@ -58,12 +58,13 @@ namespace mongo {
         typedef size_t Id;
 
         // This is only for expressions that use no variables (even ROOT).
-        Variables() :_numVars(0) {}
+        Variables() :_numVars(0), _firstClearedId(0) {}
     
         explicit Variables(size_t numVars, const Document& root = Document())
             : _root(root)
             , _rest(numVars == 0 ? NULL : new Value[numVars])
             , _numVars(numVars)
+            , _firstClearedId(numVars)
         {}
 
         static void uassertValidNameForUserWrite(StringData varName);
@@ -74,7 +75,18 @@ namespace mongo {
         /**
          * Use this instead of setValue for setting ROOT
          */
-        void setRoot(const Document& root) { _root = root; }
+        void setRoot(const Document& root) {
+            _root = root;
+            for (size_t i = _firstClearedId; i < _numVars; i++) {
+                _rest[i] = Value();
+            }
+        }
+
+        /**
+         * Makes setRoot() clear the variables from 'firstId' on, which hold the values
+         * ExpressionCommonSubexpression computed from the previous ROOT.
+         */
+        void clearOnNewRoot(Id firstId) { _firstClearedId = firstId; }
         void clearRoot() { _root = Document(); }
         const Document& getRoot() const { return _root; }
 
@@ -86,10 +98,14 @@ namespace mongo {
          */
         Document getDocument(Id id) const;
 
+        /// The number of variables other than ROOT.
+        size_t getNumVars() const { return _numVars; }
+
     private:
         Document _root;
         const boost::scoped_array<Value> _rest;
         const size_t _numVars;
+        size_t _firstClearedId;
     };
 
     /**
@@ -184,6 +200,26 @@ namespace mongo {
         /** simple expressions are just inclusion exclusion as supported by ExpressionObject */
         virtual bool isSimple() { return false; }
 
+        /**
+         * Adds pointers to this expression's subexpressions to 'children', so that they can be
+         * replaced. Only those evaluated with the same variables as this expression are added,
+         * not, for example, the 'in' of a $let.
+         */
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children) {}
+
+        /**
+         * Replaces the subexpressions which appear more than once among the trees in 'roots',
+         * or within one of them, with a single ExpressionCommonSubexpression, so that each is
+         * evaluated at most once per ROOT. The trees should already be optimized.
+         *
+         * The shared subexpressions use the variable ids from 'firstFreeId' on, which the
+         * Variables must clear for each new ROOT; see Variables::clearOnNewRoot(). Returns the
+         * number of variables the trees now need.
+         */
+        static Variables::Id shareCommonSubexpressions(
+            const std::vector<boost::intrusive_ptr<Expression>*>& roots,
+            Variables::Id firstFreeId);
+
 
         /**
          * Serialize the Expression tree recursively.
@@ -296,6 +332,7 @@ namespace mongo {
         virtual boost::intrusive_ptr<Expression> optimize();
         virtual Value serialize(bool explain) const;
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
 
         /*
           Add an operand to the n-ary expression.
@@ -404,6 +441,7 @@ namespace mongo {
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual Value serialize(bool explain) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
 
         static boost::intrusive_ptr<ExpressionCoerceToBool> create(
             const boost::intrusive_ptr<Expression> &pExpression);
@@ -416,6 +454,32 @@ namespace mongo {
     };
 
 
+    /**
+     * Stands in for each occurrence of a subexpression that appears more than once, and remembers
+     * its value in a variable until ROOT changes. Created by shareCommonSubexpressions(), never
+     * parsed; it serializes as the subexpression itself.
+     */
+    class ExpressionCommonSubexpression : public Expression {
+    public:
+        // virtuals from Expression
+        virtual boost::intrusive_ptr<Expression> optimize();
+        virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual Value evaluateInternal(Variables* vars) const;
+        virtual Value serialize(bool explain) const;
+
+        static boost::intrusive_ptr<ExpressionCommonSubexpression> create(
+            const boost::intrusive_ptr<Expression>& expression,
+            Variables::Id id);
+
+    private:
+        ExpressionCommonSubexpression(const boost::intrusive_ptr<Expression>& expression,
+                                      Variables::Id id);
+
+        boost::intrusive_ptr<Expression> _expression;
+        const Variables::Id _id; // holds the value of _expression, once evaluated for ROOT
+    };
+
+
     class ExpressionCompare : public ExpressionFixedArity<ExpressionCompare, 2> {
     public:
 
@@ -503,6 +567,7 @@ namespace mongo {
         virtual Value serialize(bool explain) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
 
         static boost::intrusive_ptr<Expression> parse(
             BSONElement expr,
@@ -648,6 +713,7 @@ namespace mongo {
         virtual Value serialize(bool explain) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
 
         static boost::intrusive_ptr<Expression> parse(
             BSONElement expr,
@@ -681,6 +747,7 @@ namespace mongo {
         virtual Value serialize(bool explain) const;
         virtual Value evaluateInternal(Variables* vars) const;
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
 
         static boost::intrusive_ptr<Expression> parse(
             BSONElement expr,
@@ -772,6 +839,7 @@ namespace mongo {
         virtual boost::intrusive_ptr<Expression> optimize();
         virtual bool isSimple();
         virtual void addDependencies(DepsTracker* deps, std::vector<std::string>* path=NULL) const;
+        virtual void addChildren(std::vector<boost::intrusive_ptr<Expression>*>* children);
         /** Only evaluates non inclusion expressions.  For inclusions, use addToDocument(). */
         virtual Value evaluateInternal(Variables* vars) const;
         virtual Value serialize(bool explain) const;
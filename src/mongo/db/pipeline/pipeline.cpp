@@ -216,36 +216,64 @@ namespace mongo {
 
         // The order in which optimizations are applied can have significant impact on the
         // efficiency of the final pipeline. Be Careful!
-        Optimizations::Local::moveMatchBeforeSort(pPipeline.get());
-        Optimizations::Local::moveLimitBeforeSkip(pPipeline.get());
+        Optimizations::Local::moveMatchesEarlier(pPipeline.get());
+        Optimizations::Local::moveLimitsEarlier(pPipeline.get());
         Optimizations::Local::coalesceAdjacent(pPipeline.get());
         Optimizations::Local::optimizeEachDocumentSource(pPipeline.get());
         Optimizations::Local::duplicateMatchBeforeInitalRedact(pPipeline.get());
+        Optimizations::Local::streamGroupsAfterSort(pPipeline.get());
 
         return pPipeline;
     }
 
-    void Pipeline::Optimizations::Local::moveMatchBeforeSort(Pipeline* pipeline) {
-        // TODO Keep moving matches across multiple sorts as moveLimitBeforeSkip does below.
-        // TODO Check sort for limit. Not an issue currently due to order optimizations are applied,
-        // but should be fixed.
+namespace {
+    /** Whether one of the dotted paths is the other or a parent of it. */
+    bool pathsOverlap(StringData a, StringData b) {
+        if (a.size() > b.size())
+            std::swap(a, b);
+        return b.startsWith(a) && (a.size() == b.size() || b[a.size()] == '.');
+    }
+
+    /** Whether 'match' filters the same documents when run before 'previous'. */
+    bool canMoveMatchBefore(const DocumentSourceMatch* match, DocumentSource* previous) {
+        // TODO Check sort for limit. Not an issue currently due to order optimizations are
+        // applied, but should be fixed.
+        if (dynamic_cast<DocumentSourceSort*>(previous))
+            return true;
+
+        DocumentSourceProject* project = dynamic_cast<DocumentSourceProject*>(previous);
+        DocumentSourceUnwind* unwind = dynamic_cast<DocumentSourceUnwind*>(previous);
+        if (!project && !unwind)
+            return false;
+
+        vector<string> paths;
+        if (!match->getQueryFieldPaths(&paths))
+            return false;
+
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (project && !project->keepsField(paths[i].substr(0, paths[i].find('.'))))
+                return false;
+            if (unwind && pathsOverlap(paths[i], unwind->getUnwindPath()))
+                return false;
+        }
+        return true;
+    }
+}  // namespace
+
+    void Pipeline::Optimizations::Local::moveMatchesEarlier(Pipeline* pipeline) {
         SourceContainer& sources = pipeline->sources;
         for (size_t srcn = sources.size(), srci = 1; srci < srcn; ++srci) {
-            intrusive_ptr<DocumentSource> &pSource = sources[srci];
-            DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch *>(pSource.get());
-            if (match && !match->isTextQuery()) {
-                intrusive_ptr<DocumentSource> &pPrevious = sources[srci - 1];
-                if (dynamic_cast<DocumentSourceSort *>(pPrevious.get())) {
-                    /* swap this item with the previous */
-                    intrusive_ptr<DocumentSource> pTemp(pPrevious);
-                    pPrevious = pSource;
-                    pSource = pTemp;
-                }
+            DocumentSourceMatch* match = dynamic_cast<DocumentSourceMatch *>(sources[srci].get());
+            if (!match || match->isTextQuery())
+                continue;
+
+            for (size_t i = srci; i > 0 && canMoveMatchBefore(match, sources[i - 1].get()); i--) {
+                swap(sources[i], sources[i - 1]);
             }
         }
     }
 
-    void Pipeline::Optimizations::Local::moveLimitBeforeSkip(Pipeline* pipeline) {
+    void Pipeline::Optimizations::Local::moveLimitsEarlier(Pipeline* pipeline) {
         SourceContainer& sources = pipeline->sources;
         if (sources.empty())
             return;
@@ -255,9 +283,13 @@ namespace mongo {
                 dynamic_cast<DocumentSourceLimit*>(sources[i].get());
             DocumentSourceSkip* skip =
                 dynamic_cast<DocumentSourceSkip*>(sources[i-1].get());
-            if (limit && skip) {
-                // Increase limit by skip since the skipped docs now pass through the $limit
-                limit->setLimit(limit->getLimit() + skip->getSkip());
+            // A $project neither adds nor removes documents.
+            const bool project = dynamic_cast<DocumentSourceProject*>(sources[i-1].get());
+            if (limit && (skip || project)) {
+                if (skip) {
+                    // Increase limit by skip since the skipped docs now pass through the $limit
+                    limit->setLimit(limit->getLimit() + skip->getSkip());
+                }
                 swap(sources[i], sources[i-1]);
 
                 // Start at back again. This is needed to handle cases with more than 1 $limit
@@ -325,6 +357,17 @@ namespace mongo {
         }
     }
 
+    void Pipeline::Optimizations::Local::streamGroupsAfterSort(Pipeline* pipeline) {
+        SourceContainer& sources = pipeline->sources;
+        for (size_t srcn = sources.size(), srci = 1; srci < srcn; ++srci) {
+            DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(sources[srci].get());
+            DocumentSourceSort* sort = dynamic_cast<DocumentSourceSort*>(sources[srci - 1].get());
+            if (group && sort) {
+                group->setStreamingIfSortedBy(sort->serializeSortKey(/*explain*/false).toBson());
+            }
+        }
+    }
+
     void Pipeline::addRequiredPrivileges(Command* commandTemplate,
                                          const string& db,
                                          BSONObj cmdObj,
@@ -366,6 +409,7 @@ namespace mongo {
         Optimizations::Sharded::findSplitPoint(shardPipeline.get(), this);
         Optimizations::Sharded::moveFinalUnwindFromShardsToMerger(shardPipeline.get(), this);
         Optimizations::Sharded::limitFieldsSentFromShardsToMerger(shardPipeline.get(), this);
+        Optimizations::Sharded::mergeSortedGroupsFromShards(shardPipeline.get(), this);
 
         return shardPipeline;
     }
@@ -441,6 +485,25 @@ namespace mongo {
                 shardPipe->pCtx));
     }
 
+    void Pipeline::Optimizations::Sharded::mergeSortedGroupsFromShards(Pipeline* shardPipe,
+                                                                       Pipeline* mergePipe) {
+        if (shardPipe->sources.empty() || mergePipe->sources.empty())
+            return;
+
+        DocumentSourceGroup* shardGroup =
+            dynamic_cast<DocumentSourceGroup*>(shardPipe->sources.back().get());
+        DocumentSourceGroup* mergeGroup =
+            dynamic_cast<DocumentSourceGroup*>(mergePipe->sources.front().get());
+        if (!shardGroup || !mergeGroup)
+            return;
+
+        const BSONObj byId = BSON("_id" << 1);
+        shardGroup->setSortedOutput(true);
+        intrusive_ptr<DocumentSourceSort> sort = DocumentSourceSort::create(mergePipe->pCtx, byId);
+        mergePipe->sources.push_front(sort->getMergeSource());
+        mergeGroup->setStreamingIfSortedBy(byId);
+    }
+
     BSONObj Pipeline::getInitialQuery() const {
         if (sources.empty())
             return BSONObj();
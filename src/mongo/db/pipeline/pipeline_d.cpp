@@ -30,23 +30,39 @@
 
 #include "mongo/db/pipeline/pipeline_d.h"
 
+#include <algorithm>
 #include <boost/make_shared.hpp>
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <deque>
+#include <memory>
+#include <set>
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/projection_cache.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/parallel_collection_scanner.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/ops/insert.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/s/d_state.h"
 
 namespace mongo {
 
     using boost::intrusive_ptr;
+    using boost::scoped_ptr;
     using boost::shared_ptr;
     using std::string;
 
@@ -76,10 +92,252 @@ namespace {
             return collection && collection->isCapped();
         }
 
+        Status insert(const NamespaceString& ns, const std::vector<BSONObj>& objs) {
+            OperationContext* txn = _ctx->opCtx;
+            invariant(txn);
+
+            std::vector<BSONObj> docs;
+            docs.reserve(objs.size());
+            for (size_t i = 0; i < objs.size(); i++) {
+                StatusWith<BSONObj> fixed = fixDocumentForInsert(objs[i]);
+                if (!fixed.isOK()) {
+                    return fixed.getStatus();
+                }
+                docs.push_back(fixed.getValue().isEmpty() ? objs[i] : fixed.getValue());
+            }
+
+            // Unlike inserts through the DBDirectClient, which take the locks and commit a unit
+            // of work per document, the whole batch goes to the record store and indexes at once.
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                ScopedTransaction transaction(txn, MODE_IX);
+                AutoGetDb autoDb(txn, ns.db(), MODE_IX);
+                Lock::CollectionLock collLock(txn->lockState(), ns.ns(), MODE_IX);
+
+                if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(
+                        ns.db())) {
+                    return Status(ErrorCodes::NotMaster, "not master");
+                }
+
+                Collection* collection =
+                    autoDb.getDb() ? autoDb.getDb()->getCollection(ns) : NULL;
+                if (!collection) {
+                    return Status(ErrorCodes::NamespaceNotFound,
+                                  str::stream() << "collection " << ns.ns() << " was dropped");
+                }
+
+                WriteUnitOfWork wunit(txn);
+                Status status = collection->insertDocuments(txn, docs, true);
+                if (!status.isOK()) {
+                    return status;
+                }
+                wunit.commit();
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "$out", ns.ns());
+
+            return Status::OK();
+        }
+
     private:
         intrusive_ptr<ExpressionContext> _ctx;
         DBDirectClient _client;
     };
+
+    /**
+     * Feeds the documents read by one thread of a parallel collection scan into that thread's
+     * $group.
+     */
+    class DocumentSourceParallelScanReader : public DocumentSource {
+    public:
+        DocumentSourceParallelScanReader(ParallelCollectionScanner::Reader* reader,
+                                         const boost::optional<ParsedDeps>& deps,
+                                         const intrusive_ptr<ExpressionContext>& expCtx)
+            : DocumentSource(expCtx),
+              _reader(reader),
+              _dependencies(deps) { }
+
+        virtual boost::optional<Document> getNext() {
+            BSONObj obj;
+            if (!_reader->getNext(&obj)) {
+                return boost::none;
+            }
+            return _dependencies ? _dependencies->extractFields(obj) : Document(obj);
+        }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+        virtual Value serialize(bool explain = false) const {
+            return Value();
+        }
+
+    private:
+        ParallelCollectionScanner::Reader* const _reader;
+        const boost::optional<ParsedDeps> _dependencies;
+    };
+
+    /**
+     * Runs a copy of the pipeline's $group, in shard mode so that its output can be merged, over
+     * the documents one thread of a parallel collection scan reads.
+     *
+     * Everything it uses is its own, since Documents and Expressions are not thread safe: the
+     * $group is re-parsed from its spec, and the dependencies are parsed separately per worker.
+     */
+    class PartialGroupWorker : public ParallelCollectionScanner::Worker {
+    public:
+        PartialGroupWorker(const BSONObj& groupSpec,
+                           const boost::optional<ParsedDeps>& deps,
+                           const intrusive_ptr<ExpressionContext>& expCtx)
+            : _groupSpec(groupSpec.copy()),
+              _dependencies(deps),
+              _expCtx(expCtx) { }
+
+        virtual void run(ParallelCollectionScanner::Reader* reader) {
+            intrusive_ptr<DocumentSource> input(
+                new DocumentSourceParallelScanReader(reader, _dependencies, _expCtx));
+            intrusive_ptr<DocumentSource> group =
+                DocumentSourceGroup::createFromBson(_groupSpec.firstElement(), _expCtx);
+            group->setSource(input.get());
+
+            while (boost::optional<Document> next = group->getNext()) {
+                partials.push_back(*next);
+            }
+            group->dispose();
+        }
+
+        std::deque<Document> partials;
+
+    private:
+        const BSONObj _groupSpec;
+        const boost::optional<ParsedDeps> _dependencies;
+        const intrusive_ptr<ExpressionContext> _expCtx;
+    };
+
+    /**
+     * Returns the partial groups computed by the threads of a parallel collection scan, to be
+     * combined by the merging $group that follows.
+     */
+    class DocumentSourcePartialGroups : public DocumentSource {
+    public:
+        DocumentSourcePartialGroups(const intrusive_ptr<ExpressionContext>& expCtx)
+            : DocumentSource(expCtx) { }
+
+        virtual boost::optional<Document> getNext() {
+            pExpCtx->checkForInterrupt();
+
+            if (_partials.empty()) {
+                return boost::none;
+            }
+            Document next = _partials.front();
+            _partials.pop_front();
+            return next;
+        }
+
+        virtual const char* getSourceName() const { return "$parallelGroupPartials"; }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+        virtual Value serialize(bool explain = false) const {
+            return Value(DOC(getSourceName() << static_cast<long long>(_partials.size())));
+        }
+
+        virtual void dispose() {
+            _partials.clear();
+        }
+
+        void add(std::deque<Document>* partials) {
+            _partials.insert(_partials.end(), partials->begin(), partials->end());
+            partials->clear();
+        }
+
+    private:
+        std::deque<Document> _partials;
+    };
+
+    /**
+     * Adds the top-level fields that "expr" reads to "fields". Returns false if "expr" cannot be
+     * evaluated against just those fields of a document.
+     */
+    bool addFilterFields(const MatchExpression* expr, std::set<std::string>* fields) {
+        switch (expr->matchType()) {
+        case MatchExpression::WHERE:
+        case MatchExpression::TEXT:
+        case MatchExpression::GEO_NEAR:
+            return false;
+        default:
+            break;
+        }
+
+        const StringData path = expr->path();
+        if (!path.empty()) {
+            fields->insert(path.substr(0, path.find('.')).toString());
+        }
+
+        // The children of an $elemMatch have paths relative to the array elements.
+        if (expr->matchType() == MatchExpression::ELEM_MATCH_OBJECT ||
+            expr->matchType() == MatchExpression::ELEM_MATCH_VALUE) {
+            return true;
+        }
+
+        for (size_t i = 0; i < expr->numChildren(); ++i) {
+            if (!addFilterFields(expr->getChild(i), fields)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Feeds the pipeline from the projection cache of a collection, filtering the cached rows
+     * with the pipeline's initial $match.
+     */
+    class DocumentSourceProjectionCache : public DocumentSource {
+    public:
+        /**
+         * Takes ownership of "filter", which may be NULL and must have been parsed from "query".
+         */
+        DocumentSourceProjectionCache(const shared_ptr<const ProjectionCache::Rows>& rows,
+                                      const BSONObj& query,
+                                      MatchExpression* filter,
+                                      const boost::optional<ParsedDeps>& deps,
+                                      const intrusive_ptr<ExpressionContext>& expCtx)
+            : DocumentSource(expCtx),
+              _rows(rows),
+              _iterator(new ProjectionCache::Rows::Iterator(*rows)),
+              _query(query),
+              _filter(filter),
+              _dependencies(deps) { }
+
+        virtual boost::optional<Document> getNext() {
+            while (_iterator && _iterator->more()) {
+                pExpCtx->checkForInterrupt();
+
+                const BSONObj row = _iterator->next();
+                if (_filter && !_filter->matchesBSON(row)) {
+                    continue;
+                }
+                return _dependencies->extractFields(row);
+            }
+            return boost::none;
+        }
+
+        virtual const char* getSourceName() const { return "$projectionCache"; }
+
+        virtual bool isValidInitialSource() const { return true; }
+
+        virtual Value serialize(bool explain = false) const {
+            return Value(DOC(getSourceName() << DOC("query" << Document(_query))));
+        }
+
+        virtual void dispose() {
+            _iterator.reset();
+            _rows.reset();
+        }
+
+    private:
+        shared_ptr<const ProjectionCache::Rows> _rows;
+        scoped_ptr<ProjectionCache::Rows::Iterator> _iterator;
+        const BSONObj _query;
+        const scoped_ptr<MatchExpression> _filter;
+        const boost::optional<ParsedDeps> _dependencies;
+    };
 }
 
     shared_ptr<PlanExecutor> PipelineD::prepareCursorSource(
@@ -202,6 +460,18 @@ namespace {
                     // need to reinsert coalesced $limit after removing $sort
                     sources.push_front(sortStage->getLimitSrc());
                 }
+
+                streamSortedGroup(txn, collection, sortObj, pPipeline);
+            }
+            else if (sortStage->getLimitSrc() || queryObj.isEmpty()) {
+                // Try to have an index provide the order of a prefix of the sort instead. With a
+                // limit, this stops reading input once enough results are final; otherwise it
+                // only narrows the sort, so it is left out when the query could pick a more
+                // selective index than the one providing the order.
+                rawExec = getPresortedPrefixExecutor(txn, collection, queryObj, sortObj,
+                                                     projectionForQuery, runnerOptions, sortStage,
+                                                     pExpCtx);
+                exec.reset(rawExec);
             }
         }
 
@@ -227,6 +497,24 @@ namespace {
         }
 
 
+        if (!sortInRunner) {
+            intrusive_ptr<DocumentSource> cached = scanProjectionCache(
+                txn, collection, exec.get(), queryObj, deps, pPipeline, pExpCtx);
+            if (cached) {
+                // The cached rows replace the scan, so there is no cursor to hand on.
+                pPipeline->addInitialSource(cached);
+                return boost::shared_ptr<PlanExecutor>();
+            }
+
+            intrusive_ptr<DocumentSource> partials =
+                groupInParallel(txn, collection, exec.get(), deps, pPipeline, pExpCtx);
+            if (partials) {
+                // The scan is complete, so there is no cursor to hand on.
+                pPipeline->addInitialSource(partials);
+                return boost::shared_ptr<PlanExecutor>();
+            }
+        }
+
         // DocumentSourceCursor expects a yielding PlanExecutor that has had its state saved. We
         // deregister the PlanExecutor so that it can be registered with ClientCursor.
         exec->deregisterExec();
@@ -252,4 +540,240 @@ namespace {
         return exec;
     }
 
+    intrusive_ptr<DocumentSource> PipelineD::scanProjectionCache(
+            OperationContext* txn,
+            Collection* collection,
+            PlanExecutor* exec,
+            const BSONObj& queryObj,
+            const DepsTracker& deps,
+            const intrusive_ptr<Pipeline>& pPipeline,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        // On a shard, a SHARDING_FILTER stage above the scan skips orphaned documents, which
+        // the cached rows could not tell apart, so only bare collection scans qualify.
+        if (NULL == collection ||
+            pPipeline->isExplain() ||
+            deps.needWholeDocument ||
+            deps.needTextScore ||
+            STAGE_COLLSCAN != exec->getRootStage()->stageType()) {
+            return NULL;
+        }
+
+        const CollectionScan* scan = static_cast<const CollectionScan*>(exec->getRootStage());
+        const CollectionScanParams& params = scan->getParams();
+        if (!params.start.isNull() ||
+            params.direction != CollectionScanParams::FORWARD ||
+            params.tailable ||
+            params.maxScan != 0) {
+            return NULL;
+        }
+
+        std::set<std::string> topLevelFields;
+        for (std::set<std::string>::const_iterator it = deps.fields.begin();
+             it != deps.fields.end();
+             ++it) {
+            topLevelFields.insert(it->substr(0, it->find('.')));
+        }
+
+        // The filter is parsed again so that it belongs to the pipeline rather than to the
+        // PlanExecutor, which goes away once the rows are chosen.
+        const BSONObj query = queryObj.getOwned();
+        std::unique_ptr<MatchExpression> filter;
+        if (!query.isEmpty()) {
+            StatusWithMatchExpression parsed = MatchExpressionParser::parse(query);
+            if (!parsed.isOK()) {
+                return NULL;
+            }
+            filter.reset(parsed.getValue());
+            if (!addFilterFields(filter.get(), &topLevelFields)) {
+                return NULL;
+            }
+        }
+
+        const shared_ptr<const ProjectionCache::Rows> rows =
+            getGlobalProjectionCache()->getRows(
+                txn,
+                collection,
+                std::vector<std::string>(topLevelFields.begin(), topLevelFields.end()));
+        if (!rows) {
+            return NULL;
+        }
+
+        return new DocumentSourceProjectionCache(rows,
+                                                 query,
+                                                 filter.release(),
+                                                 deps.toParsedDeps(),
+                                                 pExpCtx);
+    }
+
+    PlanExecutor* PipelineD::getPresortedPrefixExecutor(
+            OperationContext* txn,
+            Collection* collection,
+            const BSONObj& queryObj,
+            const BSONObj& sortObj,
+            const BSONObj& projectionForQuery,
+            size_t runnerOptions,
+            const intrusive_ptr<DocumentSourceSort>& sortStage,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        if (NULL == collection) {
+            return NULL;
+        }
+
+        // Only plain fields, on which no index is multikey, are sorted in the same order by an
+        // index as by $sort.
+        std::vector<BSONElement> keys;
+        BSONForEach(key, sortObj) {
+            if (!key.isNumber() || isMultikeyPath(txn, collection, key.fieldName())) {
+                break;
+            }
+            keys.push_back(key);
+        }
+
+        const WhereCallbackReal whereCallback(pExpCtx->opCtx, pExpCtx->ns.db());
+        for (size_t numKeys = std::min(keys.size(), size_t(sortObj.nFields() - 1));
+             numKeys > 0;
+             numKeys--) {
+            BSONObjBuilder prefix;
+            for (size_t i = 0; i < numKeys; i++) {
+                prefix.append(keys[i]);
+            }
+
+            CanonicalQuery* cq;
+            if (!CanonicalQuery::canonicalize(pExpCtx->ns,
+                                              queryObj,
+                                              prefix.obj(),
+                                              projectionForQuery,
+                                              &cq,
+                                              whereCallback).isOK()) {
+                return NULL;
+            }
+
+            PlanExecutor* rawExec;
+            if (getExecutor(txn,
+                            collection,
+                            cq,
+                            PlanExecutor::YIELD_AUTO,
+                            &rawExec,
+                            runnerOptions).isOK()) {
+                sortStage->setPresortedPrefix(numKeys);
+                return rawExec;
+            }
+        }
+        return NULL;
+    }
+
+    bool PipelineD::isMultikeyPath(OperationContext* txn,
+                                   Collection* collection,
+                                   const string& path) {
+        IndexCatalog::IndexIterator indexes =
+            collection->getIndexCatalog()->getIndexIterator(txn, false);
+        while (indexes.more()) {
+            const IndexDescriptor* desc = indexes.next();
+            if (!desc->keyPattern()[path].eoo() && desc->isMultikey(txn)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void PipelineD::streamSortedGroup(OperationContext* txn,
+                                      Collection* collection,
+                                      const BSONObj& sortObj,
+                                      const intrusive_ptr<Pipeline>& pPipeline) {
+        Pipeline::SourceContainer& sources = pPipeline->sources;
+        Pipeline::SourceContainer::iterator it = sources.begin();
+        if (it != sources.end() && dynamic_cast<DocumentSourceLimit*>(it->get())) {
+            // A $limit keeps the order of its input.
+            ++it;
+        }
+        if (NULL == collection || it == sources.end()) {
+            return;
+        }
+
+        DocumentSourceGroup* group = dynamic_cast<DocumentSourceGroup*>(it->get());
+        if (!group) {
+            return;
+        }
+
+        // Documents with equal keys are adjacent if the group key leads the sort, unless a key is
+        // an array: in an index, those sort by one of their elements, in between the other keys.
+        // The $group may have been set to stream by the $sort the index now replaces.
+        const string path = group->getGroupByFieldPath();
+        if (!path.empty() && isMultikeyPath(txn, collection, path)) {
+            group->setStreaming(false);
+            return;
+        }
+
+        group->setStreamingIfSortedBy(sortObj);
+    }
+
+    intrusive_ptr<DocumentSource> PipelineD::groupInParallel(
+            OperationContext* txn,
+            Collection* collection,
+            PlanExecutor* exec,
+            const DepsTracker& deps,
+            const intrusive_ptr<Pipeline>& pPipeline,
+            const intrusive_ptr<ExpressionContext>& pExpCtx) {
+        Pipeline::SourceContainer& sources = pPipeline->sources;
+        if (internalQueryParallelScanThreads < 2 ||
+            NULL == collection ||
+            pPipeline->isExplain() ||
+            deps.needTextScore ||
+            sources.empty() ||
+            STAGE_COLLSCAN != exec->getRootStage()->stageType()) {
+            return NULL;
+        }
+
+        intrusive_ptr<DocumentSourceGroup> group =
+            dynamic_cast<DocumentSourceGroup*>(sources.front().get());
+        if (!group) {
+            return NULL;
+        }
+
+        const CollectionScan* scan = static_cast<const CollectionScan*>(exec->getRootStage());
+        const CollectionScanParams& params = scan->getParams();
+        if (!params.start.isNull() ||
+            params.direction != CollectionScanParams::FORWARD ||
+            params.tailable ||
+            params.maxScan != 0 ||
+            !ParallelCollectionScanner::canEvaluateInParallel(scan->getFilter())) {
+            return NULL;
+        }
+
+        ParallelCollectionScanner scanner(txn, collection, scan->getFilter());
+        if (scanner.numPartitions() < 2) {
+            return NULL;
+        }
+
+        const BSONObj groupSpec = group->serialize().getDocument().toBson();
+        const size_t numThreads = std::min(scanner.numPartitions(),
+                                           static_cast<size_t>(internalQueryParallelScanThreads));
+
+        OwnedPointerVector<PartialGroupWorker> groupWorkers;
+        std::vector<ParallelCollectionScanner::Worker*> workers;
+        for (size_t i = 0; i < numThreads; ++i) {
+            // Workers have no OperationContext; the scanner checks for interruption instead.
+            intrusive_ptr<ExpressionContext> workerCtx(new ExpressionContext(NULL, pExpCtx->ns));
+            workerCtx->inShard = true;
+            workerCtx->extSortAllowed = pExpCtx->extSortAllowed;
+            workerCtx->tempDir = pExpCtx->tempDir;
+
+            groupWorkers.push_back(new PartialGroupWorker(groupSpec,
+                                                          deps.toParsedDeps(),
+                                                          workerCtx));
+            workers.push_back(groupWorkers[i]);
+        }
+
+        uassertStatusOK(scanner.run(workers));
+
+        intrusive_ptr<DocumentSourcePartialGroups> partials(
+            new DocumentSourcePartialGroups(pExpCtx));
+        for (size_t i = 0; i < groupWorkers.size(); ++i) {
+            partials->add(&groupWorkers[i]->partials);
+        }
+
+        sources.pop_front();
+        sources.push_front(group->getMergeSource());
+        return partials;
+    }
+
 } // namespace mongo
@@ -32,8 +32,12 @@
 #include <boost/shared_ptr.hpp>
 
 namespace mongo {
+    class BSONObj;
     class Collection;
+    class DocumentSource;
     class DocumentSourceCursor;
+    class DocumentSourceSort;
+    struct DepsTracker;
     struct ExpressionContext;
     class OperationContext;
     class Pipeline;
@@ -80,6 +84,69 @@ namespace mongo {
 
     private:
         PipelineD(); // does not exist:  prevent instantiation
+
+        /**
+         * If 'exec' is a plain scan of the whole collection, and the pipeline and its initial
+         * query 'queryObj' only read top-level fields for which the collection keeps a
+         * ProjectionCache, returns a source which reads the cached rows instead. Returns NULL
+         * otherwise.
+         */
+        static boost::intrusive_ptr<DocumentSource> scanProjectionCache(
+            OperationContext* txn,
+            Collection* collection,
+            PlanExecutor* exec,
+            const BSONObj& queryObj,
+            const DepsTracker& deps,
+            const boost::intrusive_ptr<Pipeline>& pPipeline,
+            const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+        /**
+         * Returns an executor for 'queryObj' which provides the order of the longest proper
+         * prefix of 'sortObj' that an index can provide, and tells 'sortStage' how much of its
+         * key is presorted. Returns NULL if no index provides the order of the first field.
+         */
+        static PlanExecutor* getPresortedPrefixExecutor(
+            OperationContext* txn,
+            Collection* collection,
+            const BSONObj& queryObj,
+            const BSONObj& sortObj,
+            const BSONObj& projectionForQuery,
+            size_t runnerOptions,
+            const boost::intrusive_ptr<DocumentSourceSort>& sortStage,
+            const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+        /// Whether an index on the field with the dotted 'path' is multikey.
+        static bool isMultikeyPath(OperationContext* txn,
+                                   Collection* collection,
+                                   const std::string& path);
+
+        /**
+         * Called once the query plan provides the order of 'sortObj': if the pipeline now starts
+         * with a $group, possibly behind a $limit, on the leading field of that order, and no
+         * index on the field is multikey, lets the $group stream its input. Otherwise makes sure
+         * the $group doesn't stream.
+         */
+        static void streamSortedGroup(
+            OperationContext* txn,
+            Collection* collection,
+            const BSONObj& sortObj,
+            const boost::intrusive_ptr<Pipeline>& pPipeline);
+
+        /**
+         * If the pipeline now starts with a $group and 'exec' is a plain scan of the whole
+         * collection which can be split up, runs the $group on internalQueryParallelScanThreads
+         * threads and replaces it with a merging $group over their partial results.
+         *
+         * Returns the source of the partial results, which must become the pipeline's initial
+         * source, or NULL if the pipeline was left untouched.
+         */
+        static boost::intrusive_ptr<DocumentSource> groupInParallel(
+            OperationContext* txn,
+            Collection* collection,
+            PlanExecutor* exec,
+            const DepsTracker& deps,
+            const boost::intrusive_ptr<Pipeline>& pPipeline,
+            const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
     };
 
 } // namespace mongo
@@ -44,23 +44,24 @@ namespace mongo {
     class Pipeline::Optimizations::Local {
     public:
         /** 
-         * Moves matches before any adjacent sort phases.
+         * Moves matches (excluding $text) before any preceding sort phases, and before
+         * projects which keep the fields they read, and unwinds of other fields.
          *
-         * This means we sort fewer items.  Neither sorts, nor matches (excluding $text)
-         * change the documents in the stream, so this transformation shouldn't affect
-         * the result.
+         * This means we sort, project and unwind fewer items, and a match which reaches the
+         * front of the pipeline can use an index. None of these phases change the fields the
+         * match reads, so this transformation shouldn't affect the result.
          */
-        static void moveMatchBeforeSort(Pipeline* pipeline);
+        static void moveMatchesEarlier(Pipeline* pipeline);
 
         /**
-         * Moves limits before any adjacent skip phases.
+         * Moves limits before any preceding skip and project phases.
          *
          * This is more optimal for sharding since currently, we can only split
          * the pipeline at a single source and it is better to limit the results
          * coming from each shard. This also enables other optimizations like
-         * coalescing the limit into a sort.
+         * coalescing the limit into a sort or into the initial cursor.
          */
-        static void moveLimitBeforeSkip(Pipeline* pipeline);
+        static void moveLimitsEarlier(Pipeline* pipeline);
 
         /**
          * Runs through the DocumentSources, and give each one the opportunity
@@ -87,6 +88,15 @@ namespace mongo {
          * BSONObjs converted to Documents.
          */
         static void duplicateMatchBeforeInitalRedact(Pipeline* pipeline);
+
+        /**
+         * Lets each $group directly after a $sort which keeps equal group keys together return
+         * each group once the next one starts, instead of holding all of them in memory.
+         *
+         * This must be run after coalesceAdjacent, since a $group absorbing a following $sort
+         * decides the order its output must be in.
+         */
+        static void streamGroupsAfterSort(Pipeline* pipeline);
     };
 
     /**
@@ -120,5 +130,13 @@ namespace mongo {
          * convert less source BSON into Documents.
          */
         static void limitFieldsSentFromShardsToMerger(Pipeline* shardPipe, Pipeline* mergePipe);
+
+        /**
+         * If the shards end with a $group, has them return their partial groups sorted by _id,
+         * and the merger merge the sorted streams and combine them one group at a time. The
+         * merger then holds one group at a time instead of every key in the cluster, and shards
+         * which don't know how to sort the groups themselves just run the $sort they are sent.
+         */
+        static void mergeSortedGroupsFromShards(Pipeline* shardPipe, Pipeline* mergePipe);
     };
 } // namespace mongo
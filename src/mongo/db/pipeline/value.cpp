@@ -169,6 +169,8 @@ namespace mongo {
 
         case Array: {
             intrusive_ptr<RCVector> vec (new RCVector);
+            // Counting the elements first is much cheaper than regrowing the vector.
+            vec->vec.reserve(elem.embeddedObject().nFields());
             BSONForEach(sub, elem.embeddedObject()) {
                 vec->vec.push_back(Value(sub));
             }
@@ -228,6 +230,7 @@ namespace mongo {
 
     Value::Value(const BSONArray& arr) : _storage(Array) {
         intrusive_ptr<RCVector> vec (new RCVector);
+        vec->vec.reserve(arr.nFields());
         BSONForEach(sub, arr) {
             vec->vec.push_back(Value(sub));
         }
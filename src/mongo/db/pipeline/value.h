@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <utility>
 
 #include "mongo/db/pipeline/value_internal.h"
 #include "mongo/platform/unordered_set.h"
@@ -68,6 +69,15 @@ namespace mongo {
          */
 
         Value(): _storage() {} // "Missing" value
+
+        // Moving a Value steals its reference instead of doing an atomic increment and
+        // decrement, which matters when vectors of Values grow or are shuffled around.
+        Value(const Value& other) : _storage(other._storage) {}
+        Value(Value&& other) BOOST_NOEXCEPT : _storage(std::move(other._storage)) {}
+        Value& operator=(Value other) {
+            _storage.swap(other._storage);
+            return *this;
+        }
         explicit Value(bool value)                : _storage(Bool, value) {}
         explicit Value(int value)                 : _storage(NumberInt, value) {}
         explicit Value(long long value)           : _storage(NumberLong, value) {}
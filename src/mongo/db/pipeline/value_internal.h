@@ -102,6 +102,12 @@ namespace mongo {
             memcpyed();
         }
 
+        /// Takes over rhs's reference, if any, leaving rhs "missing" without touching ref counts
+        ValueStorage(ValueStorage&& rhs) BOOST_NOEXCEPT {
+            memcpy(this, &rhs, sizeof(*this));
+            rhs.zero(); // EOO with no refCounter
+        }
+
         ~ValueStorage() {
             DEV verifyRefCountingIfShould();
             if (refCounter)
@@ -42,7 +42,9 @@
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/service_context.h"
 #include "mongo/db/stats/timer_stats.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
 
@@ -122,34 +124,37 @@ namespace {
     }
 
     // page in the data pages for a record associated with an object
-    void prefetchRecordPages(OperationContext* txn,
+    // returns true and sets 'result' to the record's document if it was found
+    bool prefetchRecordPages(OperationContext* txn,
                              Database* db,
                              const char* ns,
-                             const BSONObj& obj) {
+                             const BSONObj& obj,
+                             BSONObj* result) {
 
         BSONElement _id;
         if( obj.getObjectID(_id) ) {
             TimerHolder timer(&prefetchDocStats);
             BSONObjBuilder builder;
             builder.append(_id);
-            BSONObj result;
             try {
-                if (Helpers::findById(txn, db, ns, builder.done(), result)) {
+                if (Helpers::findById(txn, db, ns, builder.done(), *result)) {
                     // do we want to use Record::touch() here?  it's pretty similar.
                     volatile char _dummy_char = '\0';
 
                     // Touch the first word on every page in order to fault it into memory
-                    for (int i = 0; i < result.objsize(); i += g_minOSPageSizeBytes) {
-                        _dummy_char += *(result.objdata() + i);
+                    for (int i = 0; i < result->objsize(); i += g_minOSPageSizeBytes) {
+                        _dummy_char += *(result->objdata() + i);
                     }
                     // hit the last page, in case we missed it above
-                    _dummy_char += *(result.objdata() + result.objsize() - 1);
+                    _dummy_char += *(result->objdata() + result->objsize() - 1);
+                    return true;
                 }
             }
             catch(const DBException& e) {
                 LOG(2) << "ignoring exception in prefetchRecordPages(): " << e.what() << endl;
             }
         }
+        return false;
     }
 } // namespace
 
@@ -178,10 +183,13 @@ namespace {
         BSONObj obj = op.getObjectField(opField);
         const char *ns = op.getStringField("ns");
 
-        // This will have to change for engines other than MMAP V1, because they might not have
-        // means for directly prefetching pages from the collection. For this purpose, acquire S
-        // lock on the database, instead of optimizing with IS.
-        Lock::CollectionLock collLock(txn->lockState(), ns, MODE_S);
+        // MMAP V1 has no means of prefetching pages from the collection under intent locks, so
+        // acquire S lock on the database there, instead of optimizing with IS. Engines with
+        // document level locking read through their own snapshot, so the IS lock held by the
+        // caller is enough and the prefetchers don't block each other.
+        const bool docLocking =
+            getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking();
+        Lock::CollectionLock collLock(txn->lockState(), ns, docLocking ? MODE_IS : MODE_S);
 
         Collection* collection = db->getCollection( ns );
         if (!collection) {
@@ -201,24 +209,23 @@ namespace {
         //     will be an insert. to do that we could do the prefetchRecordPage first and if DNE
         //     then we do #1.
         // 
-        // note that on deletes 'obj' does not have all the keys we would want to prefetch on.
-        // a way to achieve that would be to prefetch the record first, and then afterwards do 
-        // this part.
+        // on updates and deletes 'obj' only identifies the document, so it does not have all the
+        // keys we would want to prefetch on.  the record is prefetched first, since the op reads
+        // it anyway, and the index keys it will remove are prefetched from the current version.
         //
-        prefetchIndexPages(txn, collection, prefetchConfig, obj);
-
         // do not prefetch the data for inserts; it doesn't exist yet
-        // 
-        // we should consider doing the record prefetch for the delete op case as we hit the record
-        // when we delete.  note if done we only want to touch the first page.
-        // 
-        // update: do record prefetch. 
-        if ((*opType == 'u') &&
+        BSONObj keysFrom = obj;
+        if ((*opType == 'u' || *opType == 'd') &&
             // do not prefetch the data for capped collections because
             // they typically do not have an _id index for findById() to use.
             !collection->isCapped()) {
-            prefetchRecordPages(txn, db, ns, obj);
+            BSONObj current;
+            if (prefetchRecordPages(txn, db, ns, obj, &current)) {
+                keysFrom = current;
+            }
         }
+
+        prefetchIndexPages(txn, collection, prefetchConfig, keysFrom);
     }
 
     class ReplIndexPrefetch : public ServerParameter {
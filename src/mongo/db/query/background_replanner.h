@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/query/plan_cache.h"
+
+namespace mongo {
+
+    class CanonicalQuery;
+
+    /**
+     * Re-plans degraded plan cache entries off the query path.
+     *
+     * When internalQueryCacheBackgroundReplan is on, a CachedPlanStage whose cached plan takes
+     * too long during its trial period hands the query to the installed replanner and carries on
+     * with the cached plan. The replanner later runs the full multi-plan trial on its own thread
+     * and overwrites the cache entry with the new winner.
+     *
+     * The implementation needs the catalog and locking, so it lives with the server and is
+     * installed at startup. Unit tests which link only the query libraries have none installed.
+     */
+    class BackgroundReplanner {
+    public:
+        virtual ~BackgroundReplanner() { }
+
+        /**
+         * Queues a replan of the plan cache entry 'key' for 'query'. Never blocks.
+         *
+         * Returns false if the replan could not be queued, in which case the caller should
+         * replan inline. Returns true if it was queued or a replan of the same entry is pending.
+         */
+        virtual bool schedule(const CanonicalQuery& query, const PlanCacheKey& key) = 0;
+
+        /**
+         * Returns the installed replanner, or NULL if there is none.
+         */
+        static BackgroundReplanner* get();
+
+        /**
+         * Installs 'replanner', which must live for the rest of the process.
+         */
+        static void set(BackgroundReplanner* replanner);
+    };
+
+}  // namespace mongo
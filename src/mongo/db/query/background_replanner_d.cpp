@@ -0,0 +1,262 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/background_replanner.h"
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <memory>
+#include <set>
+
+#include "mongo/base/init.h"
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/multi_plan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/stage_builder.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+namespace {
+
+    // Replans beyond this many waiting are refused, and the queries which asked for them replan
+    // inline as they would with background replanning off.
+    const size_t kMaxQueuedReplans = 128;
+
+    // How long the replanner thread waits for work before re-checking for shutdown.
+    const int kIdleWaitMillis = 1000;
+
+    /**
+     * Everything needed to re-create the canonical query of a plan cache entry on the replanner
+     * thread. The BSON is owned, since the query which scheduled the replan may be long gone.
+     */
+    struct ReplanTask {
+        std::string ns;
+        std::string pendingKey;
+        BSONObj query;
+        BSONObj sort;
+        BSONObj proj;
+    };
+
+    class BackgroundReplannerImpl : public BackgroundReplanner {
+    public:
+        BackgroundReplannerImpl() : _started(false) { }
+
+        virtual bool schedule(const CanonicalQuery& query, const PlanCacheKey& key) {
+            if (inShutdown()) {
+                return false;
+            }
+
+            ReplanTask task;
+            task.ns = query.ns();
+            // Plan cache keys are per collection, so the namespace is part of the identity.
+            task.pendingKey = task.ns + '\0' + key;
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_pending.count(task.pendingKey)) {
+                return true;
+            }
+            if (_queue.size() >= kMaxQueuedReplans) {
+                return false;
+            }
+            if (!_started) {
+                boost::thread(stdx::bind(&BackgroundReplannerImpl::_run, this));
+                _started = true;
+            }
+
+            const LiteParsedQuery& pq = query.getParsed();
+            task.query = pq.getFilter().getOwned();
+            task.sort = pq.getSort().getOwned();
+            task.proj = pq.getProj().getOwned();
+
+            _pending.insert(task.pendingKey);
+            _queue.push_back(task);
+            _workAvailable.notify_one();
+            return true;
+        }
+
+    private:
+        void _run() {
+            Client::initThread("planCacheReplanner");
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            while (!inShutdown()) {
+                ReplanTask task;
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    if (_queue.empty()) {
+                        _workAvailable.timed_wait(lk,
+                                                  boost::posix_time::milliseconds(kIdleWaitMillis));
+                        continue;
+                    }
+                    task = _queue.front();
+                    _queue.pop_front();
+                }
+
+                try {
+                    _replan(task);
+                }
+                catch (const DBException& e) {
+                    LOG(1) << "background replan of " << task.ns << " query " << task.query
+                           << " failed: " << e.toString();
+                }
+
+                // Only now may the same entry be queued again, so that queries which keep finding
+                // the degraded plan while it is replanned do not queue it over and over.
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _pending.erase(task.pendingKey);
+            }
+        }
+
+        void _replan(const ReplanTask& task) {
+            OperationContextImpl txn;
+            AutoGetCollectionForRead ctx(&txn, task.ns);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return;
+            }
+
+            const NamespaceString nss(task.ns);
+            const WhereCallbackReal whereCallback(&txn, nss.db());
+            CanonicalQuery* rawCanonicalQuery;
+            Status status = CanonicalQuery::canonicalize(task.ns,
+                                                         task.query,
+                                                         task.sort,
+                                                         task.proj,
+                                                         &rawCanonicalQuery,
+                                                         whereCallback);
+            if (!status.isOK()) {
+                return;
+            }
+            std::unique_ptr<CanonicalQuery> canonicalQuery(rawCanonicalQuery);
+
+            // The entry may have been flushed, e.g. by writes or an index build, since the
+            // replan was queued. The next query of this shape will then plan from scratch anyway.
+            PlanCache* cache = collection->infoCache()->getPlanCache();
+            if (!cache->contains(*canonicalQuery)) {
+                return;
+            }
+
+            QueryPlannerParams plannerParams;
+            fillOutPlannerParams(&txn, collection, canonicalQuery.get(), &plannerParams);
+
+            std::vector<QuerySolution*> rawSolutions;
+            status = QueryPlanner::plan(*canonicalQuery, plannerParams, &rawSolutions);
+            if (!status.isOK()) {
+                return;
+            }
+            OwnedPointerVector<QuerySolution> solutions(rawSolutions);
+
+            if (solutions.size() < 2) {
+                // A single solution is never cached, so all we can do is evict the stale entry.
+                cache->remove(*canonicalQuery);
+                cache->noteReplan(true);
+                return;
+            }
+
+            // Run the same trial as an inline replan. The winner overwrites the cache entry.
+            WorkingSet* ws = new WorkingSet();
+            MultiPlanStage* multiPlanStage =
+                new MultiPlanStage(&txn, collection, canonicalQuery.get(), true);
+            for (size_t ix = 0; ix < solutions.size(); ++ix) {
+                if (solutions[ix]->cacheData.get()) {
+                    solutions[ix]->cacheData->indexFilterApplied =
+                        plannerParams.indexFiltersApplied;
+                }
+
+                PlanStage* nextPlanRoot;
+                verify(StageBuilder::build(&txn, collection, *solutions[ix], ws, &nextPlanRoot));
+
+                // Takes ownership of 'solutions[ix]' and 'nextPlanRoot'.
+                multiPlanStage->addPlan(solutions.releaseAt(ix), nextPlanRoot, ws);
+            }
+
+            const std::string queryString = canonicalQuery->toStringShort();
+
+            // Takes ownership of 'ws', 'multiPlanStage' and 'canonicalQuery', and picks the best
+            // plan, yielding like any other query.
+            PlanExecutor* rawExec;
+            status = PlanExecutor::make(&txn,
+                                        ws,
+                                        multiPlanStage,
+                                        canonicalQuery.release(),
+                                        collection,
+                                        PlanExecutor::YIELD_AUTO,
+                                        &rawExec);
+            if (!status.isOK()) {
+                LOG(1) << "background replan of " << task.ns << " query " << queryString
+                       << " failed: " << status.toString();
+                return;
+            }
+            std::unique_ptr<PlanExecutor> exec(rawExec);
+
+            cache->noteReplan(true);
+            LOG(1) << "background replan of " << task.ns << " query " << queryString
+                   << " chose plan " << Explain::getPlanSummary(exec->getRootStage());
+        }
+
+        // Protects the members below.
+        boost::mutex _mutex;
+        boost::condition_variable _workAvailable;
+        std::deque<ReplanTask> _queue;
+
+        // Queued and running replans, by ReplanTask::pendingKey.
+        std::set<std::string> _pending;
+
+        bool _started;
+    };
+
+}  // namespace
+
+    MONGO_INITIALIZER(InstallBackgroundReplanner)(InitializerContext* context) {
+        BackgroundReplanner::set(new BackgroundReplannerImpl());
+        return Status::OK();
+    }
+
+}  // namespace mongo
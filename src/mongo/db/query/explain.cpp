@@ -34,6 +34,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/exec/multi_plan.h"
+#include "mongo/db/memory_tracker.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/query_planner.h"
@@ -42,6 +43,7 @@
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/cycle_clock.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/version.h"
 
@@ -227,13 +229,21 @@ namespace mongo {
         // Some top-level exec stats get pulled out of the root stage.
         if (verbosity >= ExplainCommon::EXEC_STATS) {
             bob->appendNumber("nReturned", stats.common.advanced);
-            bob->appendNumber("executionTimeMillisEstimate", stats.common.executionTimeMillis);
+            const long long executionTimeNanos =
+                CycleClock::toNanos(stats.common.executionTimeCycles);
+            bob->appendNumber("executionTimeMillisEstimate", executionTimeNanos / 1000000);
+            bob->appendNumber("executionTimeMicros", executionTimeNanos / 1000);
+            if (stats.common.storageTimeCycles > 0) {
+                bob->appendNumber("storageTimeMicros",
+                                  CycleClock::toNanos(stats.common.storageTimeCycles) / 1000);
+            }
             bob->appendNumber("works", stats.common.works);
             bob->appendNumber("advanced", stats.common.advanced);
             bob->appendNumber("needTime", stats.common.needTime);
             bob->appendNumber("needYield", stats.common.needYield);
             bob->appendNumber("saveState", stats.common.yields);
             bob->appendNumber("restoreState", stats.common.unyields);
+            bob->appendNumber("restoreStateMicros", stats.common.restoreStateMicros);
             bob->appendNumber("isEOF", stats.common.isEOF);
             bob->appendNumber("invalidates", stats.common.invalidates);
         }
@@ -279,6 +289,9 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("nCounted", spec->nCounted);
                 bob->appendNumber("nSkipped", spec->nSkipped);
+                if (spec->approximate) {
+                    bob->appendBool("approximate", true);
+                }
             }
         }
         else if (STAGE_COUNT_SCAN == stats.stageType) {
@@ -356,6 +369,10 @@ namespace mongo {
                 bob->append("indexBounds", spec->indexBounds);
             }
 
+            if (!spec->geoCovering.isEmpty()) {
+                bob->append("geoCovering", spec->geoCovering);
+            }
+
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
                 bob->appendNumber("dupsTested", spec->dupsTested);
@@ -403,6 +420,7 @@ namespace mongo {
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("memUsage", spec->memUsage);
                 bob->appendNumber("memLimit", spec->memLimit);
+                bob->appendBool("usedDisk", spec->usedDisk);
             }
 
             if (spec->limit > 0) {
@@ -550,7 +568,8 @@ namespace mongo {
             out->appendNumber("executionTimeMillis", totalTimeMillis);
         }
         else {
-            out->appendNumber("executionTimeMillisEstimate", stats->common.executionTimeMillis);
+            out->appendNumber("executionTimeMillisEstimate",
+                              CycleClock::toNanos(stats->common.executionTimeCycles) / 1000000);
         }
 
         // Flatten the stats tree into a list.
@@ -649,6 +668,8 @@ namespace mongo {
             OperationContext* opCtx = exec->getOpCtx();
             long long totalTimeMillis = opCtx->getCurOp()->elapsedMillis();
             generateExecStats(winningStats.get(), verbosity, &execBob, totalTimeMillis);
+            execBob.appendNumber("peakTrackedMemoryBytes",
+                                 MemoryTracker::forOperation(opCtx)->peakBytes());
 
             // Also generate exec stats for all plans, if the verbosity level is high enough.
             // These stats reflect what happened during the trial period that ranked the plans.
@@ -718,7 +739,9 @@ namespace mongo {
         // root stage of the plan tree.
         const CommonStats* common = root->getCommonStats();
         statsOut->nReturned = common->advanced;
-        statsOut->executionTimeMillis = common->executionTimeMillis;
+        const long long executionTimeNanos = CycleClock::toNanos(common->executionTimeCycles);
+        statsOut->executionTimeMillis = executionTimeNanos / 1000000;
+        statsOut->executionTimeMicros = executionTimeNanos / 1000;
 
         // The other fields are aggregations over the stages in the plan tree. We flatten
         // the tree into a list and then compute these aggregations.
@@ -51,6 +51,7 @@ namespace mongo {
                              totalKeysExamined(0),
                              totalDocsExamined(0),
                              executionTimeMillis(0),
+                             executionTimeMicros(0),
                              isIdhack(false),
                              hasSortStage(false) { }
 
@@ -66,6 +67,9 @@ namespace mongo {
         // The number of milliseconds spent inside the root stage's work() method.
         long long executionTimeMillis;
 
+        // The same, in microseconds.
+        long long executionTimeMicros;
+
         // Did this plan use the fast path for key-value retrievals on the _id index?
         bool isIdhack;
 
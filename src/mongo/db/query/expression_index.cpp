@@ -28,6 +28,10 @@
 
 #include "mongo/db/query/expression_index.h"
 
+#include <algorithm>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
 #include <iostream>
 
 #include "third_party/s2/s2regioncoverer.h"
@@ -36,14 +40,58 @@
 #include "mongo/db/geo/hash.h"
 #include "mongo/db/geo/r2_region_coverer.h"
 #include "mongo/db/hasher.h"
+#include "mongo/db/query/expression_index_knobs.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
     using std::set;
 
-    BSONObj ExpressionMapping::hash(const BSONElement& value) {
+namespace {
+
+    // Upper bound on the memory taken by cached 2dsphere coverings, no matter how many entries
+    // internalGeoQueryCoveringCacheSize allows.
+    const size_t kMaxCoveringCacheBytes = 32 * 1024 * 1024;
+
+    // Caps internalGeoQuery2DCoveringLevels, as the cell budget doubles with each level.
+    const int kMaxCoveringLevels = 8;
+
+    struct CachedCovering {
+        std::vector<Interval> intervals;
+        size_t bytes;
+    };
+
+    typedef LRUKeyValue<std::string, CachedCovering> CoveringCache;
+
+    // Protects everything below.
+    boost::mutex coveringCacheMutex;
+
+    // Created on first use, and again whenever internalGeoQueryCoveringCacheSize changes.
+    boost::scoped_ptr<CoveringCache> coveringCache;
+    size_t coveringCacheMaxSize = 0;
+    size_t coveringCacheBytes = 0;
+
+    int getCoarsestIndexedLevel(const BSONObj& indexInfoObj) {
+        BSONElement ce = indexInfoObj["coarsestIndexedLevel"];
+        if (ce.isNumber()) {
+            return ce.numberInt();
+        }
+        return S2::kAvgEdge.GetClosestLevel(100 * 1000.0 / kRadiusOfEarthInMeters);
+    }
+
+} // namespace
+
+    BSONObj ExpressionMapping::hash(const BSONElement& value, const BSONObj& indexInfoObj) {
+        // Hash the way the index does, see ExpressionParams::parseHashParams.
+        HashSeed seed = BSONElementHasher::DEFAULT_HASH_SEED;
+        if (!indexInfoObj["seed"].eoo()) {
+            seed = indexInfoObj["seed"].numberInt();
+        }
+        const int hashVersion = indexInfoObj["hashVersion"].numberInt();
+
         BSONObjBuilder bob;
-        bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED));
+        bob.append("", BSONElementHasher::hash64(value, seed, hashVersion));
         return bob.obj();
     }
 
@@ -75,27 +123,58 @@ namespace mongo {
         verify(paramStatus.isOK()); // We validated the parameters when creating the index
 
         GeoHashConverter hashConverter(hashParams);
-        R2RegionCoverer coverer(&hashConverter);
-        coverer.setMaxLevel(hashConverter.getBits());
-        coverer.setMaxCells(maxCoveringCells);
-
-        // TODO: Maybe slightly optimize by returning results in order
-        vector<GeoHash> unorderedCovering;
-        coverer.getCovering(region, &unorderedCovering);
-        set<GeoHash> covering(unorderedCovering.begin(), unorderedCovering.end());
+        unsigned maxLevel = hashConverter.getBits();
+        int maxCells = maxCoveringCells;
+
+        // Cells much finer than the region only trim its boundary a little more, at the cost of
+        // an index interval each. So refine a few levels below the cells whose area is closest to
+        // the region's, with enough cells to trace its boundary at the finest of them.
+        const int levels = std::max(0, std::min(static_cast<int>(internalGeoQuery2DCoveringLevels),
+                                                kMaxCoveringLevels));
+        if (levels > 0) {
+            const double regionEdge = sqrt(region.getR2Bounds().area());
+            unsigned areaLevel = 0;
+            while (areaLevel < maxLevel && hashConverter.sizeEdge(areaLevel + 1) >= regionEdge) {
+                areaLevel++;
+            }
+            maxLevel = std::min(maxLevel, areaLevel + levels);
+            maxCells = std::max(maxCells, 4 << levels);
+        }
 
-        for (set<GeoHash>::const_iterator it = covering.begin(); it != covering.end();
-            ++it) {
+        R2RegionCoverer coverer(&hashConverter);
+        coverer.setMaxLevel(maxLevel);
+        coverer.setMaxCells(maxCells);
+
+        vector<GeoHash> covering;
+        coverer.getCovering(region, &covering);
+        std::sort(covering.begin(), covering.end());
+
+        // Cells are disjoint, so one whose hashes follow on from the previous cell's extends
+        // that cell's interval instead of starting its own.
+        size_t first = 0;
+        while (first < covering.size()) {
+            size_t last = first;
+            while (last + 1 < covering.size() &&
+                   static_cast<unsigned long long>(covering[last].getHashMax()) + 1 ==
+                       static_cast<unsigned long long>(covering[last + 1].getHash())) {
+                last++;
+            }
 
-            const GeoHash& geoHash = *it;
             BSONObjBuilder builder;
-            geoHash.appendHashMin(&builder, "");
-            geoHash.appendHashMax(&builder, "");
-
+            covering[first].appendHashMin(&builder, "");
+            covering[last].appendHashMax(&builder, "");
             oil->intervals.push_back(IndexBoundsBuilder::makeRangeInterval(builder.obj(),
                                                                            true,
                                                                            true));
+            first = last + 1;
         }
+
+        BSONObjBuilder stats;
+        stats.append("cells", static_cast<int>(covering.size()));
+        stats.append("intervals", static_cast<int>(oil->intervals.size()));
+        stats.append("maxLevel", static_cast<int>(maxLevel));
+        stats.append("maxCells", maxCells);
+        oil->coveringStats = stats.obj();
     }
 
     // TODO: what should we really pass in for indexInfoObj?
@@ -103,15 +182,7 @@ namespace mongo {
                                           const BSONObj& indexInfoObj,
                                           OrderedIntervalList* oilOut) {
 
-        int coarsestIndexedLevel;
-        BSONElement ce = indexInfoObj["coarsestIndexedLevel"];
-        if (ce.isNumber()) {
-            coarsestIndexedLevel = ce.numberInt();
-        }
-        else {
-            coarsestIndexedLevel =
-                S2::kAvgEdge.GetClosestLevel(100 * 1000.0 / kRadiusOfEarthInMeters);
-        }
+        const int coarsestIndexedLevel = getCoarsestIndexedLevel(indexInfoObj);
 
         // The min level of our covering is the level whose cells are the closest match to the
         // *area* of the region (or the max indexed level, whichever is smaller) The max level
@@ -209,4 +280,88 @@ namespace mongo {
         }
     }
 
+    void ExpressionMapping::cover2dsphereCached(const S2Region& region,
+                                                const BSONObj& geometryObj,
+                                                const BSONObj& indexInfoObj,
+                                                OrderedIntervalList* oilOut) {
+        const int maxEntries = internalGeoQueryCoveringCacheSize;
+        if (maxEntries <= 0) {
+            cover2dsphere(region, indexInfoObj, oilOut);
+            return;
+        }
+
+        // The covering only depends on the geometry and the coarsest indexed level.
+        std::string key = mongoutils::str::stream() << getCoarsestIndexedLevel(indexInfoObj)
+                                                    << '|';
+        key.append(geometryObj.objdata(), geometryObj.objsize());
+
+        {
+            boost::lock_guard<boost::mutex> lk(coveringCacheMutex);
+            CachedCovering* cached;
+            if (coveringCache && coveringCache->get(key, &cached).isOK()) {
+                oilOut->intervals.insert(oilOut->intervals.end(),
+                                         cached->intervals.begin(),
+                                         cached->intervals.end());
+                return;
+            }
+        }
+
+        // Computed without holding the lock, so concurrent queries aren't held up by it.
+        OrderedIntervalList computed;
+        cover2dsphere(region, indexInfoObj, &computed);
+        oilOut->intervals.insert(oilOut->intervals.end(),
+                                 computed.intervals.begin(),
+                                 computed.intervals.end());
+
+        std::auto_ptr<CachedCovering> entry(new CachedCovering());
+        entry->intervals.swap(computed.intervals);
+        entry->bytes = key.size();
+        for (size_t i = 0; i < entry->intervals.size(); ++i) {
+            entry->bytes += sizeof(Interval) + entry->intervals[i]._intervalData.objsize();
+        }
+
+        if (entry->bytes > kMaxCoveringCacheBytes / 16) {
+            // Not worth pushing out many smaller coverings for.
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> lk(coveringCacheMutex);
+        if (!coveringCache || coveringCacheMaxSize != static_cast<size_t>(maxEntries)) {
+            coveringCache.reset(new CoveringCache(maxEntries));
+            coveringCacheMaxSize = maxEntries;
+            coveringCacheBytes = 0;
+        }
+
+        if (coveringCache->hasKey(key)) {
+            // Another query got here first.
+            return;
+        }
+
+        coveringCacheBytes += entry->bytes;
+        std::auto_ptr<CachedCovering> evicted = coveringCache->add(key, entry.release());
+        if (evicted.get()) {
+            coveringCacheBytes -= evicted->bytes;
+        }
+
+        while (coveringCacheBytes > kMaxCoveringCacheBytes) {
+            CoveringCache::KVListConstIt oldest = coveringCache->end();
+            --oldest;
+            coveringCacheBytes -= oldest->second->bytes;
+            const std::string oldestKey = oldest->first;
+            coveringCache->remove(oldestKey);
+        }
+    }
+
+    size_t ExpressionMapping::clearCoveringCache() {
+        boost::lock_guard<boost::mutex> lk(coveringCacheMutex);
+        if (!coveringCache) {
+            return 0;
+        }
+
+        const size_t size = coveringCache->size();
+        coveringCache->clear();
+        coveringCacheBytes = 0;
+        return size;
+    }
+
 }  // namespace mongo
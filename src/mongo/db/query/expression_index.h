@@ -44,7 +44,10 @@ namespace mongo {
     class ExpressionMapping {
     public:
 
-        static BSONObj hash(const BSONElement& value);
+        /**
+         * Returns the key a hashed index described by 'indexInfoObj' stores for 'value'.
+         */
+        static BSONObj hash(const BSONElement& value, const BSONObj& indexInfoObj);
 
         static void cover2d(const R2Region& region,
                             const BSONObj& indexInfoObj,
@@ -55,6 +58,22 @@ namespace mongo {
         static void cover2dsphere(const S2Region& region,
                                   const BSONObj& indexInfoObj,
                                   OrderedIntervalList* oilOut);
+
+        /**
+         * Same as cover2dsphere(), but reuses the intervals computed for an earlier call with an
+         * equal 'geometryObj', the BSON that 'region' was parsed from, if they are still cached.
+         * See internalGeoQueryCoveringCacheSize.
+         */
+        static void cover2dsphereCached(const S2Region& region,
+                                        const BSONObj& geometryObj,
+                                        const BSONObj& indexInfoObj,
+                                        OrderedIntervalList* oilOut);
+
+        /**
+         * Empties the cache used by cover2dsphereCached(), and returns how many coverings were in
+         * it. For testing.
+         */
+        static size_t clearCoveringCache();
     };
 
 }  // namespace mongo
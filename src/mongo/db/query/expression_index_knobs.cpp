@@ -36,4 +36,12 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalGeoNearQuery2DMaxCoveringCells, int, 16);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalGeoQuery2DCoveringLevels, int, 4);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalGeoQueryCoveringCacheSize, int, 1024);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalGeoNearQueryTargetIntervalResults, int, 300);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalGeoNearDensityCacheSize, int, 1024);
+
 }  // namespace mongo
@@ -44,4 +44,29 @@ namespace mongo {
      */
     extern int internalGeoNearQuery2DMaxCoveringCells;
 
+    /**
+     * How many levels finer than the cells the area of a query region a 2D covering may use.
+     * The cell budget grows to match, so that the region's boundary can be traced at the finest
+     * level. 0 covers with the fixed number of cells of the knobs above, at any level.
+     */
+    extern int internalGeoQuery2DCoveringLevels;
+
+    /**
+     * The maximum number of 2dsphere query coverings to keep for reuse by later queries with the
+     * same geometry; 0 disables caching.
+     */
+    extern int internalGeoQueryCoveringCacheSize;
+
+    /**
+     * The number of results each 2dsphere $near search annulus is sized to contain, based on the
+     * density of documents found so far.
+     */
+    extern int internalGeoNearQueryTargetIntervalResults;
+
+    /**
+     * The maximum number of document densities remembered from earlier 2dsphere $near queries,
+     * used to size the first annulus of later queries near the same place; 0 disables caching.
+     */
+    extern int internalGeoNearDensityCacheSize;
+
 }  // namespace mongo
@@ -48,12 +48,14 @@
 #include "mongo/db/query/find_constants.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/s/chunk_version.h"
+#include "mongo/s/d_chunk_heat.h"
 #include "mongo/s/d_state.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/util/fail_point_service.h"
@@ -90,14 +92,14 @@ namespace mongo {
     }
 
     ScopedRecoveryUnitSwapper::~ScopedRecoveryUnitSwapper() {
-        _txn->recoveryUnit()->commitAndRestart();
-
         if (_dismissed) {
             // Just clean up the recovery unit which we originally got from the ClientCursor.
+            _txn->recoveryUnit()->commitAndRestart();
             delete _txn->releaseRecoveryUnit();
         }
         else {
             // Swap the RU back into the ClientCursor for subsequent getMores.
+            _txn->recoveryUnit()->endCursorBatch();
             _cc->setOwnedRecoveryUnit(_txn->releaseRecoveryUnit());
         }
 
@@ -249,7 +251,8 @@ namespace mongo {
                               CurOp& curop,
                               int pass,
                               bool& exhaust,
-                              bool* isCursorAuthorized) {
+                              bool* isCursorAuthorized,
+                              CappedInsertNotifierData* notifierData) {
 
         // For testing, we may want to fail if we receive a getmore.
         if (MONGO_FAIL_POINT(failReceivedGetmore)) {
@@ -387,6 +390,13 @@ namespace mongo {
             PlanExecutor* exec = cc->getExecutor();
             const int queryOptions = cc->queryOptions();
 
+            // Note the version before looking for results, so that the caller's wait for more
+            // ends at once if something is inserted after the executor reaches EOF.
+            if ((queryOptions & QueryOption_AwaitData) && ctx && ctx->getCollection()->isCapped()) {
+                notifierData->notifier = ctx->getCollection()->getCappedInsertNotifier();
+                notifierData->lastEOFVersion = notifierData->notifier->getVersion();
+            }
+
             // Get results out of the executor.
             exec->restoreState(txn);
 
@@ -395,6 +405,7 @@ namespace mongo {
             while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
                 // Add result to output buffer.
                 bb.appendBuf((void*)obj.objdata(), obj.objsize());
+                chunkHeatTracker.noteRead(ns, obj);
 
                 // Count the result.
                 ++numResults;
@@ -593,6 +604,12 @@ namespace mongo {
             return "";
         }
 
+        // Results are copied into the reply buffer before the next one is asked for, both here and
+        // in getMore().
+        if (internalQueryFindPinnedRecords) {
+            exec->returnPinnedRecords();
+        }
+
         // We freak out later if this changes before we're done with the query.
         const ChunkVersion shardingVersionAtStart = shardingState.getVersion(nss.ns());
 
@@ -631,6 +648,7 @@ namespace mongo {
         while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
             // Add result to output buffer.
             bb.appendBuf((void*)obj.objdata(), obj.objsize());
+            chunkHeatTracker.noteRead(nss.ns(), obj);
 
             // Count the result.
             ++numResults;
@@ -706,7 +724,7 @@ namespace mongo {
             else {
                 // We stash away the RecoveryUnit in the ClientCursor.  It's used for subsequent
                 // getMore requests.  The calling OpCtx gets a fresh RecoveryUnit.
-                txn->recoveryUnit()->commitAndRestart();
+                txn->recoveryUnit()->endCursorBatch();
                 cc->setOwnedRecoveryUnit(txn->releaseRecoveryUnit());
                 StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
                 txn->setRecoveryUnit(storageEngine->newRecoveryUnit());
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <string>
 
 #include "mongo/db/clientcursor.h"
@@ -38,8 +39,21 @@
 
 namespace mongo {
 
+    class CappedInsertNotifier;
     class OperationContext;
 
+    /**
+     * Filled in by getMore() for an AwaitData cursor on a capped collection, so that the caller can
+     * wait for an insert rather than poll: the collection's notifier, and its version from before
+     * the getMore looked for results.
+     */
+    struct CappedInsertNotifierData {
+        CappedInsertNotifierData() : lastEOFVersion(0) { }
+
+        boost::shared_ptr<CappedInsertNotifier> notifier;
+        uint64_t lastEOFVersion;
+    };
+
     class ScopedRecoveryUnitSwapper {
     public:
         ScopedRecoveryUnitSwapper(ClientCursor* cc, OperationContext* txn);
@@ -150,7 +164,8 @@ namespace mongo {
                               CurOp& curop,
                               int pass,
                               bool& exhaust,
-                              bool* isCursorAuthorized);
+                              bool* isCursorAuthorized,
+                              CappedInsertNotifierData* notifierData);
 
     /**
      * Run the query 'q' and place the result in 'result'.
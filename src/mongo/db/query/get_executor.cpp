@@ -115,6 +115,7 @@ namespace mongo {
     namespace {
         // The body is below in the "count hack" section but getExecutor calls it.
         bool turnIxscanIntoCount(QuerySolution* soln);
+        bool removeFetchForCount(QuerySolution* soln);
 
         bool filteredIndexBad(const MatchExpression* filter, CanonicalQuery* query) {
             if (!filter)
@@ -324,10 +325,13 @@ namespace mongo {
                                                             &qs);
 
                 if (status.isOK()) {
-                    verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
-                    if ((plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
-                        && turnIxscanIntoCount(qs)) {
+                    // The solution has to be rewritten before the stages are built from it.
+                    const bool isFastCount =
+                        (plannerParams.options & QueryPlannerParams::PRIVATE_IS_COUNT)
+                        && (turnIxscanIntoCount(qs) || removeFetchForCount(qs));
 
+                    verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
+                    if (isFastCount) {
                         LOG(2) << "Using fast count: " << canonicalQuery->toStringShort()
                                << ", planSummary: " << Explain::getPlanSummary(*rootOut);
                     }
@@ -398,6 +402,13 @@ namespace mongo {
                         return Status::OK();
                     }
                 }
+
+                // None of them can count with a COUNT_SCAN, but those which only need to count
+                // index entries can still do so without fetching documents. These are still
+                // ranked against each other as usual.
+                for (size_t i = 0; i < solutions.size(); ++i) {
+                    removeFetchForCount(solutions[i]);
+                }
             }
 
             if (1 == solutions.size()) {
@@ -722,6 +733,8 @@ namespace {
         deleteStageParams.fromMigrate = request->isFromMigrate();
         deleteStageParams.isExplain = request->isExplain();
         deleteStageParams.returnDeleted = request->shouldReturnDeleted();
+        deleteStageParams.maxBatchDocs = std::max(1, internalQueryExecDeleteBatchDocs);
+        deleteStageParams.maxBatchBytes = std::max(0, internalQueryExecDeleteBatchBytes);
 
         auto_ptr<WorkingSet> ws(new WorkingSet());
         PlanExecutor::YieldPolicy policy = parsedDelete->canYield() ? PlanExecutor::YIELD_AUTO :
@@ -1098,6 +1111,60 @@ namespace {
             return true;
         }
 
+        /**
+         * Returns true if the entries 'node' returns match the query exactly, because it is an
+         * index scan or a union of them, so that a count doesn't have to fetch their documents.
+         */
+        bool countsWithoutFetch(const QuerySolutionNode* node) {
+            if (STAGE_IXSCAN == node->getType()) {
+                // An index scan's filter is applied to index keys only, and the scan dedups
+                // multikey entries itself.
+                return true;
+            }
+
+            if (STAGE_OR != node->getType() || NULL != node->filter.get()) {
+                return false;
+            }
+
+            // The OR stage dedups the RecordIds its children return.
+            const OrNode* orn = static_cast<const OrNode*>(node);
+            if (!orn->dedup) {
+                return false;
+            }
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                if (!countsWithoutFetch(node->children[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Returns 'true' if the solution 'soln' fetches documents only to count them, in which
+         * case the unfiltered FETCH at its root is removed. This covers index bounds with many
+         * intervals and index scans with filters on other fields of the index, which can't be
+         * answered with a single COUNT_SCAN.
+         *
+         * Otherwise, returns 'false'.
+         */
+        bool removeFetchForCount(QuerySolution* soln) {
+            QuerySolutionNode* root = soln->root.get();
+
+            if (STAGE_FETCH != root->getType() || NULL != root->filter.get()) {
+                return false;
+            }
+
+            QuerySolutionNode* child = root->children[0];
+            if (!countsWithoutFetch(child)) {
+                return false;
+            }
+
+            // Detach the child so that deleting the fetch doesn't delete it.
+            root->children.clear();
+            soln->root.reset(child);
+            return true;
+        }
+
         /**
          * Returns true if indices contains an index that can be
          * used with DistinctNode. Sets indexOut to the array index
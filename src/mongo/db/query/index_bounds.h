@@ -50,6 +50,9 @@ namespace mongo {
         // TODO: We could drop this.  Only used in IndexBounds::isValidFor.
         std::string name;
 
+        // How the intervals were derived from a 2d covering, if they were. Shown by explain.
+        BSONObj coveringStats;
+
         bool isValidFor(int expectedOrientation) const;
         std::string toString() const;
 
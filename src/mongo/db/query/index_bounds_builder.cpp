@@ -30,7 +30,9 @@
 
 #include "mongo/db/query/index_bounds_builder.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <limits>
 
 #include "mongo/base/string_data.h"
@@ -161,6 +163,47 @@ namespace mongo {
     }
 
 
+    // static
+    void IndexBoundsBuilder::simpleRegexAlternatives(const char* regex, const char* flags,
+                                                     vector<string>* prefixesOut,
+                                                     BoundsTightness* tightnessOut) {
+        *tightnessOut = IndexBoundsBuilder::INEXACT_COVERED;
+        prefixesOut->clear();
+
+        // Without groups, classes or escapes every '|' separates two top level alternatives.
+        const StringData regexData(regex);
+        if (regexData.find('|') == std::string::npos ||
+            strpbrk(regex, "()[\\") ||
+            strchr(flags, 'x')) {
+            return;
+        }
+
+        BoundsTightness tightness = IndexBoundsBuilder::EXACT;
+        size_t start = 0;
+        while (start <= regexData.size()) {
+            size_t end = regexData.find('|', start);
+            if (end == std::string::npos) {
+                end = regexData.size();
+            }
+
+            const string alternative = regexData.substr(start, end - start).toString();
+            BoundsTightness alternativeTightness;
+            const string prefix = simpleRegex(alternative.c_str(), flags, &alternativeTightness);
+            if (prefix.empty()) {
+                prefixesOut->clear();
+                return;
+            }
+
+            prefixesOut->push_back(prefix);
+            if (alternativeTightness != IndexBoundsBuilder::EXACT) {
+                tightness = alternativeTightness;
+            }
+            start = end + 1;
+        }
+
+        *tightnessOut = tightness;
+    }
+
     // static
     void IndexBoundsBuilder::allValuesForField(const BSONElement& elt, OrderedIntervalList* out) {
         // ARGH, BSONValue would make this shorter.
@@ -349,7 +392,7 @@ namespace mongo {
         }
         else if (MatchExpression::EQ == expr->matchType()) {
             const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-            translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+            translateEquality(node->getData(), isHashed, index, oilOut, tightnessOut);
         }
         else if (MatchExpression::LTE == expr->matchType()) {
             const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
@@ -545,9 +588,11 @@ namespace mongo {
             // Create our various intervals.
 
             IndexBoundsBuilder::BoundsTightness tightness;
-            for (BSONElementSet::iterator it = afr.equalities().begin();
+            // The equalities are sorted, so for most of them the intervals come out in order and
+            // unionize() doesn't have to sort them.
+            for (std::vector<BSONElement>::const_iterator it = afr.equalities().begin();
                  it != afr.equalities().end(); ++it) {
-                translateEquality(*it, isHashed, oilOut, &tightness);
+                translateEquality(*it, isHashed, index, oilOut, &tightness);
                 if (tightness != IndexBoundsBuilder::EXACT) {
                     *tightnessOut = tightness;
                 }
@@ -584,7 +629,10 @@ namespace mongo {
             if (mongoutils::str::equals("2dsphere", elt.valuestrsafe())) {
                 verify(gme->getGeoExpression().getGeometry().hasS2Region());
                 const S2Region& region = gme->getGeoExpression().getGeometry().getS2Region();
-                ExpressionMapping::cover2dsphere(region, index.infoObj, oilOut);
+                ExpressionMapping::cover2dsphereCached(region,
+                                                       gme->getRawObj(),
+                                                       index.infoObj,
+                                                       oilOut);
                 *tightnessOut = IndexBoundsBuilder::INEXACT_FETCH;
             }
             else if (mongoutils::str::equals("2d", elt.valuestrsafe())) {
@@ -691,48 +739,54 @@ namespace mongo {
         // This can happen.
         if (iv.empty()) { return; }
 
-        // Step 1: sort.
-        std::sort(iv.begin(), iv.end(), IntervalComparison);
+        // Step 1: sort, unless the intervals are in order already, as they mostly are for an
+        // $in.
+        if (!std::is_sorted(iv.begin(), iv.end(), IntervalComparison)) {
+            std::sort(iv.begin(), iv.end(), IntervalComparison);
+        }
 
-        // Step 2: Walk through and merge.
-        size_t i = 0;
-        while (i < iv.size() - 1) {
-            // Compare i with i + 1.
-            Interval::IntervalComparison cmp = iv[i].compare(iv[i + 1]);
+        // Step 2: Walk through and merge. iv[0..last] are the merged intervals so far, and
+        // iv[last] is the one the next interval may merge with.
+        size_t last = 0;
+        for (size_t i = 1; i < iv.size(); ++i) {
+            Interval::IntervalComparison cmp = iv[last].compare(iv[i]);
 
             // This means our sort didn't work.
             verify(Interval::INTERVAL_SUCCEEDS != cmp);
 
             // Intervals are correctly ordered.
             if (Interval::INTERVAL_PRECEDES == cmp) {
-                // We can move to the next pair.
-                ++i;
+                // Keep interval i as the next merged interval.
+                ++last;
+                if (last != i) {
+                    iv[last] = iv[i];
+                }
             }
             else if (Interval::INTERVAL_EQUALS == cmp || Interval::INTERVAL_WITHIN == cmp) {
-                // Interval 'i' is equal to i+1, or is contained within i+1.
-                // Remove interval i and don't move to the next value of 'i'.
-                iv.erase(iv.begin() + i);
+                // Interval 'last' is equal to i, or is contained within i.
+                iv[last] = iv[i];
             }
             else if (Interval::INTERVAL_CONTAINS == cmp) {
-                // Interval 'i' contains i+1, remove i+1 and don't move to the next value of 'i'.
-                iv.erase(iv.begin() + i + 1);
+                // Interval 'last' contains i, so drop i.
             }
             else if (Interval::INTERVAL_OVERLAPS_BEFORE == cmp
                      || Interval::INTERVAL_PRECEDES_COULD_UNION == cmp) {
-                // We want to merge intervals i and i+1.
-                // Interval 'i' starts before interval 'i+1'.
+                // We want to merge intervals 'last' and i.
+                // Interval 'last' starts before interval i.
                 BSONObjBuilder bob;
-                bob.appendAs(iv[i].start, "");
-                bob.appendAs(iv[i + 1].end, "");
+                bob.appendAs(iv[last].start, "");
+                bob.appendAs(iv[i].end, "");
                 BSONObj data = bob.obj();
-                bool startInclusive = iv[i].startInclusive;
-                bool endInclusive = iv[i + 1].endInclusive;
-                iv.erase(iv.begin() + i);
-                // iv[i] is now the former iv[i + 1]
-                iv[i] = makeRangeInterval(data, startInclusive, endInclusive);
-                // Don't increment 'i'.
+                bool startInclusive = iv[last].startInclusive;
+                bool endInclusive = iv[i].endInclusive;
+                iv[last] = makeRangeInterval(data, startInclusive, endInclusive);
+            }
+            else {
+                // Can't happen with sorted intervals.
+                verify(false);
             }
         }
+        iv.resize(last + 1);
     }
 
     // static
@@ -790,6 +844,7 @@ namespace mongo {
                                             OrderedIntervalList* oilOut, BoundsTightness* tightnessOut) {
 
         const string start = simpleRegex(rme->getString().c_str(), rme->getFlags().c_str(), tightnessOut);
+        vector<string> prefixes;
 
         // Note that 'tightnessOut' is set by simpleRegex above.
         if (!start.empty()) {
@@ -798,29 +853,47 @@ namespace mongo {
             oilOut->intervals.push_back(makeRangeInterval(start, end, true, false));
         }
         else {
-            BSONObjBuilder bob;
-            bob.appendMinForType("", String);
-            bob.appendMaxForType("", String);
-            BSONObj dataObj = bob.obj();
-            verify(dataObj.isOwned());
-            oilOut->intervals.push_back(makeRangeInterval(dataObj, true, false));
+            simpleRegexAlternatives(rme->getString().c_str(), rme->getFlags().c_str(),
+                                    &prefixes, tightnessOut);
+            if (!prefixes.empty()) {
+                // One range per alternative, instead of scanning every string.
+                for (size_t i = 0; i < prefixes.size(); ++i) {
+                    string end = prefixes[i];
+                    end[end.size() - 1]++;
+                    oilOut->intervals.push_back(makeRangeInterval(prefixes[i], end, true, false));
+                }
+            }
+            else {
+                BSONObjBuilder bob;
+                bob.appendMinForType("", String);
+                bob.appendMaxForType("", String);
+                BSONObj dataObj = bob.obj();
+                verify(dataObj.isOwned());
+                oilOut->intervals.push_back(makeRangeInterval(dataObj, true, false));
+            }
         }
 
         // Regexes are after strings.
         BSONObjBuilder bob;
         bob.appendRegex("", rme->getString(), rme->getFlags());
         oilOut->intervals.push_back(makePointInterval(bob.obj()));
+
+        if (prefixes.size() > 1) {
+            // The alternatives can come in any order, and overlap.
+            unionize(oilOut);
+        }
     }
 
     // static
     void IndexBoundsBuilder::translateEquality(const BSONElement& data, bool isHashed,
+                                               const IndexEntry& index,
                                                OrderedIntervalList* oil, BoundsTightness* tightnessOut) {
         // We have to copy the data out of the parse tree and stuff it into the index
         // bounds.  BSONValue will be useful here.
         if (Array != data.type()) {
             BSONObj dataObj;
             if (isHashed) {
-                dataObj = ExpressionMapping::hash(data);
+                dataObj = ExpressionMapping::hash(data, index.infoObj);
             }
             else {
                 dataObj = objFromElement(data);
@@ -150,6 +150,18 @@ namespace mongo {
                                   const char* flags,
                                   BoundsTightness* tightnessOut);
 
+        /**
+         * For a regex which is an alternation of simple regexes, like /^foo|^bar/, fills out
+         * 'prefixesOut' with the prefix of each alternative.  'prefixesOut' is left empty if
+         * any alternative has no prefix, or if the alternation is not at the top level.
+         *
+         * The tightness is EXACT only if every alternative is fully described by its prefix.
+         */
+        static void simpleRegexAlternatives(const char* regex,
+                                            const char* flags,
+                                            std::vector<std::string>* prefixesOut,
+                                            BoundsTightness* tightnessOut);
+
         /**
          * Returns an Interval from minKey to maxKey
          */
@@ -161,6 +173,7 @@ namespace mongo {
 
         static void translateEquality(const BSONElement& data,
                                       bool isHashed,
+                                      const IndexEntry& index,
                                       OrderedIntervalList* oil,
                                       BoundsTightness* tightnessOut);
 
@@ -34,8 +34,11 @@
 
 #include <limits>
 #include <memory>
+#include "mongo/db/geo/hash.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/expression_index.h"
+#include "mongo/db/query/expression_index_knobs.h"
 #include "mongo/unittest/unittest.h"
 
 using namespace mongo;
@@ -530,6 +533,28 @@ namespace {
         ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_FETCH);
     }
 
+    TEST(IndexBoundsBuilderTest, TranslateInManyUnsortedWithDuplicates) {
+        IndexEntry testIndex = IndexEntry(BSONObj());
+        BSONArrayBuilder values;
+        for (int i = 999; i >= 0; i--) {
+            values.append(i);
+            values.append(static_cast<double>(i));
+        }
+        BSONObj obj = BSON("a" << BSON("$in" << values.arr()));
+        auto_ptr<MatchExpression> expr(parseMatchExpression(obj));
+        BSONElement elt = obj.firstElement();
+        OrderedIntervalList oil;
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), elt, testIndex, &oil, &tightness);
+        ASSERT_EQUALS(oil.name, "a");
+        ASSERT_EQUALS(oil.intervals.size(), 1000U);
+        for (int i = 0; i < 1000; i++) {
+            ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[i].compare(
+                Interval(BSON("" << i << "" << i), true, true)));
+        }
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::EXACT);
+    }
+
     //
     // $exists tests
     //
@@ -937,10 +962,72 @@ namespace {
         ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_COVERED);
     }
 
+    TEST(SimpleRegexTest, RootedAlternatives) {
+        IndexBoundsBuilder::BoundsTightness tightness;
+        vector<string> prefixes;
+        IndexBoundsBuilder::simpleRegexAlternatives("^foo|\\Abar|^ba", "", &prefixes,
+                                                    &tightness);
+        ASSERT_EQUALS(prefixes.size(), 3U);
+        ASSERT_EQUALS(prefixes[0], "foo");
+        ASSERT_EQUALS(prefixes[1], "bar");
+        ASSERT_EQUALS(prefixes[2], "ba");
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::EXACT);
+    }
+
+    TEST(SimpleRegexTest, RootedAlternativesInexact) {
+        IndexBoundsBuilder::BoundsTightness tightness;
+        vector<string> prefixes;
+        IndexBoundsBuilder::simpleRegexAlternatives("^foo.*x|^bar", "", &prefixes, &tightness);
+        ASSERT_EQUALS(prefixes.size(), 2U);
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_COVERED);
+    }
+
+    TEST(SimpleRegexTest, AlternativesNeedEveryPrefix) {
+        IndexBoundsBuilder::BoundsTightness tightness;
+        vector<string> prefixes;
+        IndexBoundsBuilder::simpleRegexAlternatives("^foo|bar", "", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        IndexBoundsBuilder::simpleRegexAlternatives("^foo|^", "", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        IndexBoundsBuilder::simpleRegexAlternatives("^foo|^bar", "m", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_COVERED);
+    }
+
+    TEST(SimpleRegexTest, AlternativesNotTopLevel) {
+        IndexBoundsBuilder::BoundsTightness tightness;
+        vector<string> prefixes;
+        IndexBoundsBuilder::simpleRegexAlternatives("^(a(a|$)|^b", "", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        IndexBoundsBuilder::simpleRegexAlternatives("^a[|]|^b", "", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        IndexBoundsBuilder::simpleRegexAlternatives("^a\\|^b", "", &prefixes, &tightness);
+        ASSERT(prefixes.empty());
+        ASSERT_EQUALS(tightness, IndexBoundsBuilder::INEXACT_COVERED);
+    }
+
     //
     // Regex bounds
     //
 
+    TEST(IndexBoundsBuilderTest, RootedAlternativesRegex) {
+        IndexEntry testIndex = IndexEntry(BSONObj());
+        BSONObj obj = fromjson("{a: /^xy|^abc|^ab/}");
+        auto_ptr<MatchExpression> expr(parseMatchExpression(obj));
+        BSONElement elt = obj.firstElement();
+        OrderedIntervalList oil;
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), elt, testIndex, &oil, &tightness);
+        ASSERT_EQUALS(oil.intervals.size(), 3U);
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[0].compare(
+            Interval(fromjson("{'': 'ab', '': 'ac'}"), true, false)));
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[1].compare(
+            Interval(fromjson("{'': 'xy', '': 'xz'}"), true, false)));
+        ASSERT_EQUALS(Interval::INTERVAL_EQUALS, oil.intervals[2].compare(
+            Interval(fromjson("{'': /^xy|^abc|^ab/, '': /^xy|^abc|^ab/}"), true, true)));
+        ASSERT(tightness == IndexBoundsBuilder::EXACT);
+    }
+
     TEST(IndexBoundsBuilderTest, SimpleNonPrefixRegex) {
         IndexEntry testIndex = IndexEntry(BSONObj());
         BSONObj obj = fromjson("{a: /foo/}");
@@ -1318,4 +1405,117 @@ namespace {
         ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
     }
 
+    //
+    // 2dsphere covering cache
+    //
+
+    void translate2dsphere(const BSONObj& query, OrderedIntervalList* oil) {
+        IndexEntry testIndex = IndexEntry(BSON("loc" << "2dsphere"));
+        auto_ptr<MatchExpression> expr(parseMatchExpression(query));
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), testIndex.keyPattern.firstElement(),
+                                      testIndex, oil, &tightness);
+        ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
+    }
+
+    TEST(IndexBoundsBuilderTest, CachedS2CoveringsMatchFreshOnes) {
+        BSONObj square = fromjson("{loc: {$geoWithin: {$geometry: {type: 'Polygon', coordinates: "
+                                  "[[[0, 0], [0, 1], [1, 1], [1, 0], [0, 0]]]}}}}");
+        BSONObj triangle = fromjson("{loc: {$geoIntersects: {$geometry: {type: 'Polygon', "
+                                    "coordinates: [[[10, 10], [12, 10], [11, 12], [10, 10]]]}}}}");
+
+        const int oldCacheSize = internalGeoQueryCoveringCacheSize;
+        ExpressionMapping::clearCoveringCache();
+
+        // Without the cache.
+        internalGeoQueryCoveringCacheSize = 0;
+        OrderedIntervalList uncached;
+        translate2dsphere(square, &uncached);
+        ASSERT_EQUALS(0U, ExpressionMapping::clearCoveringCache());
+
+        // Computed and stored, then looked up.
+        internalGeoQueryCoveringCacheSize = 10;
+        OrderedIntervalList first;
+        translate2dsphere(square, &first);
+        OrderedIntervalList second;
+        translate2dsphere(square, &second);
+        OrderedIntervalList other;
+        translate2dsphere(triangle, &other);
+
+        ASSERT_GREATER_THAN(uncached.intervals.size(), 0U);
+        ASSERT_EQUALS(uncached.intervals.size(), first.intervals.size());
+        ASSERT_EQUALS(uncached.intervals.size(), second.intervals.size());
+        for (size_t i = 0; i < uncached.intervals.size(); ++i) {
+            ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                          uncached.intervals[i].compare(first.intervals[i]));
+            ASSERT_EQUALS(Interval::INTERVAL_EQUALS,
+                          uncached.intervals[i].compare(second.intervals[i]));
+        }
+        ASSERT_EQUALS(2U, ExpressionMapping::clearCoveringCache());
+
+        internalGeoQueryCoveringCacheSize = oldCacheSize;
+    }
+
+    void translate2d(const BSONObj& query, OrderedIntervalList* oil) {
+        IndexEntry testIndex = IndexEntry(BSON("loc" << "2d"));
+        auto_ptr<MatchExpression> expr(parseMatchExpression(query));
+        IndexBoundsBuilder::BoundsTightness tightness;
+        IndexBoundsBuilder::translate(expr.get(), testIndex.keyPattern.firstElement(),
+                                      testIndex, oil, &tightness);
+        ASSERT(tightness == IndexBoundsBuilder::INEXACT_FETCH);
+    }
+
+    bool coveredBy2dBounds(const OrderedIntervalList& oil, double x, double y) {
+        GeoHashConverter::Parameters params;
+        ASSERT_OK(GeoHashConverter::parseParameters(BSONObj(), &params));
+        GeoHashConverter converter(params);
+        BSONObjBuilder builder;
+        converter.hash(x, y).appendHashMin(&builder, "");
+        BSONObj key = builder.obj();
+        for (size_t i = 0; i < oil.intervals.size(); ++i) {
+            if (key.firstElement().woCompare(oil.intervals[i].start, false) >= 0 &&
+                key.firstElement().woCompare(oil.intervals[i].end, false) <= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    TEST(IndexBoundsBuilderTest, Adaptive2dCoveringMergesAdjacentCells) {
+        OrderedIntervalList oil;
+        translate2d(fromjson("{loc: {$geoWithin: {$box: [[0, 0], [1, 1]]}}}"), &oil);
+
+        ASSERT_GREATER_THAN(oil.intervals.size(), 0U);
+        ASSERT_EQUALS(static_cast<int>(oil.intervals.size()),
+                      oil.coveringStats["intervals"].numberInt());
+        ASSERT_LESS_THAN_OR_EQUALS(oil.coveringStats["intervals"].numberInt(),
+                                   oil.coveringStats["cells"].numberInt());
+        ASSERT_LESS_THAN(oil.coveringStats["maxLevel"].numberInt(), 26);
+
+        // Merged intervals are still disjoint and in order.
+        for (size_t i = 1; i < oil.intervals.size(); ++i) {
+            ASSERT_LESS_THAN(oil.intervals[i - 1].end.woCompare(oil.intervals[i].start, false), 0);
+        }
+
+        for (double x = 0; x <= 1; x += 0.125) {
+            for (double y = 0; y <= 1; y += 0.125) {
+                ASSERT(coveredBy2dBounds(oil, x, y));
+            }
+        }
+    }
+
+    TEST(IndexBoundsBuilderTest, Fixed2dCoveringWithNoExtraLevels) {
+        const int oldLevels = internalGeoQuery2DCoveringLevels;
+        internalGeoQuery2DCoveringLevels = 0;
+        OrderedIntervalList oil;
+        translate2d(fromjson("{loc: {$geoWithin: {$center: [[10, 10], 2]}}}"), &oil);
+        internalGeoQuery2DCoveringLevels = oldLevels;
+
+        ASSERT_EQUALS(26, oil.coveringStats["maxLevel"].numberInt());
+        ASSERT_EQUALS(internalGeoPredicateQuery2DMaxCoveringCells,
+                      oil.coveringStats["maxCells"].numberInt());
+        ASSERT(coveredBy2dBounds(oil, 10, 10));
+        ASSERT(coveredBy2dBounds(oil, 11.9, 10));
+    }
+
 }  // namespace
@@ -0,0 +1,238 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+    using std::vector;
+
+    namespace {
+
+        class KeyLess {
+        public:
+            explicit KeyLess(const BSONObj& keyPattern) : _ord(Ordering::make(keyPattern)) { }
+
+            bool operator()(const BSONObj& lhs, const BSONObj& rhs) const {
+                return lhs.woCompare(rhs, _ord, false) < 0;
+            }
+
+        private:
+            const Ordering _ord;
+        };
+
+        bool estimateNode(const QuerySolutionNode* node,
+                          const IndexStatisticsMap& indexStats,
+                          long long numRecords,
+                          PlanCostEstimate* out) {
+            vector<PlanCostEstimate> children(node->children.size());
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                if (!estimateNode(node->children[i], indexStats, numRecords, &children[i])) {
+                    return false;
+                }
+            }
+
+            switch (node->getType()) {
+            case STAGE_COLLSCAN: {
+                out->streamingCost = numRecords;
+                out->numResults = numRecords;
+                return true;
+            }
+            case STAGE_IXSCAN: {
+                const IndexScanNode* ixn = static_cast<const IndexScanNode*>(node);
+                if (ixn->indexIsMultiKey) {
+                    return false;
+                }
+
+                IndexStatisticsMap::const_iterator it = indexStats.find(ixn->indexKeyPattern);
+                if (indexStats.end() == it || NULL == it->second.get()) {
+                    return false;
+                }
+
+                const double numKeys = it->second->estimateKeys(ixn->bounds, ixn->direction,
+                                                                numRecords);
+                if (numKeys < 0) {
+                    return false;
+                }
+                out->streamingCost = numKeys;
+                out->numResults = numKeys;
+                return true;
+            }
+            case STAGE_FETCH: {
+                *out = children[0];
+                out->streamingCost += children[0].numResults;
+                return true;
+            }
+            case STAGE_SORT: {
+                const SortNode* sn = static_cast<const SortNode*>(node);
+                const double n = children[0].numResults;
+                out->blockingCost = children[0].totalCost() + n * std::log(std::max(n, 2.0));
+                out->numResults = (sn->limit > 0) ? std::min(n, static_cast<double>(sn->limit))
+                                                  : n;
+                out->streamingCost = out->numResults;
+                return true;
+            }
+            case STAGE_LIMIT: {
+                const LimitNode* ln = static_cast<const LimitNode*>(node);
+                *out = children[0];
+                if (out->numResults > ln->limit) {
+                    // Only as much of the streaming work is done as it takes to find the
+                    // first 'limit' results.
+                    out->streamingCost *= ln->limit / out->numResults;
+                    out->numResults = ln->limit;
+                }
+                return true;
+            }
+            case STAGE_SKIP: {
+                const SkipNode* sn = static_cast<const SkipNode*>(node);
+                *out = children[0];
+                out->numResults = std::max(0.0, out->numResults - sn->skip);
+                return true;
+            }
+            case STAGE_AND_HASH: {
+                // All children but the last are read into the hash table before the first
+                // result comes out.
+                out->numResults = children.back().numResults;
+                for (size_t i = 0; i < children.size(); ++i) {
+                    if (i + 1 < children.size()) {
+                        out->blockingCost += children[i].totalCost();
+                    }
+                    else {
+                        out->blockingCost += children[i].blockingCost;
+                        out->streamingCost += children[i].streamingCost;
+                    }
+                    out->numResults = std::min(out->numResults, children[i].numResults);
+                }
+                return true;
+            }
+            case STAGE_AND_SORTED: {
+                out->numResults = children[0].numResults;
+                for (size_t i = 0; i < children.size(); ++i) {
+                    out->blockingCost += children[i].blockingCost;
+                    out->streamingCost += children[i].streamingCost;
+                    out->numResults = std::min(out->numResults, children[i].numResults);
+                }
+                return true;
+            }
+            case STAGE_OR:
+            case STAGE_SORT_MERGE: {
+                for (size_t i = 0; i < children.size(); ++i) {
+                    out->blockingCost += children[i].blockingCost;
+                    out->streamingCost += children[i].streamingCost;
+                    out->numResults += children[i].numResults;
+                }
+                out->numResults = std::min(out->numResults, static_cast<double>(numRecords));
+                return true;
+            }
+            case STAGE_KEEP_MUTATIONS:
+            case STAGE_PROJECTION:
+            case STAGE_SHARDING_FILTER: {
+                *out = children[0];
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+
+    }  // namespace
+
+    IndexStatistics::IndexStatistics(const BSONObj& keyPattern,
+                                     const vector<BSONObj>& samples,
+                                     long long numKeys)
+        : _keyPattern(keyPattern.getOwned()),
+          _samples(samples),
+          _numKeys(numKeys),
+          _numDistinctKeys(0) {
+        const KeyLess less(_keyPattern);
+        std::sort(_samples.begin(), _samples.end(), less);
+
+        // Estimate the number of distinct keys from the number of keys which were sampled once,
+        // and those which were sampled more than once (the GEE estimator).
+        size_t numSampled = 0;
+        size_t numSampledOnce = 0;
+        for (size_t i = 0; i < _samples.size(); ) {
+            size_t j = i + 1;
+            while (j < _samples.size() && !less(_samples[i], _samples[j])) {
+                ++j;
+            }
+            ++numSampled;
+            if (j == i + 1) {
+                ++numSampledOnce;
+            }
+            i = j;
+        }
+
+        if (!_samples.empty()) {
+            const double scale = std::sqrt(static_cast<double>(numKeys) / _samples.size());
+            _numDistinctKeys = std::max(1.0, scale * numSampledOnce + (numSampled - numSampledOnce));
+            _numDistinctKeys = std::min(_numDistinctKeys,
+                                        std::max(1.0, static_cast<double>(numKeys)));
+        }
+    }
+
+    double IndexStatistics::estimateKeys(const IndexBounds& bounds,
+                                         int direction,
+                                         long long numKeys) const {
+        if (bounds.isSimpleRange) {
+            return -1;
+        }
+        if (_samples.empty() || numKeys <= 0) {
+            return 0;
+        }
+
+        IndexBoundsChecker checker(&bounds, _keyPattern, direction);
+        size_t numMatched = 0;
+        for (size_t i = 0; i < _samples.size(); ++i) {
+            if (checker.isValidKey(_samples[i])) {
+                ++numMatched;
+            }
+        }
+
+        if (0 == numMatched) {
+            return numKeys / _numDistinctKeys;
+        }
+        return static_cast<double>(numKeys) * numMatched / _samples.size();
+    }
+
+    bool estimatePlanCost(const QuerySolutionNode* root,
+                          const IndexStatisticsMap& indexStats,
+                          long long numRecords,
+                          PlanCostEstimate* out) {
+        *out = PlanCostEstimate();
+        return estimateNode(root, indexStats, numRecords, out);
+    }
+
+}  // namespace mongo
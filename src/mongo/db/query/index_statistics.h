@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
+
+namespace mongo {
+
+    class QuerySolutionNode;
+
+    /**
+     * Statistics about the keys of one index, taken from a random sample of its entries. They
+     * are used to estimate how many keys an index scan examines, so that the planner can drop
+     * candidate plans which are clearly worse than others before running them.
+     *
+     * Only kept for indexes with one entry per document, whose number of keys is then the number
+     * of records in the collection. Immutable once built.
+     */
+    class IndexStatistics {
+        MONGO_DISALLOW_COPYING(IndexStatistics);
+    public:
+        /**
+         * Builds the statistics of the index with 'keyPattern' from 'samples', index keys without
+         * field names drawn at random from an index of 'numKeys' entries. Repeated draws of the
+         * same entry are expected.
+         */
+        IndexStatistics(const BSONObj& keyPattern,
+                        const std::vector<BSONObj>& samples,
+                        long long numKeys);
+
+        const BSONObj& keyPattern() const { return _keyPattern; }
+
+        size_t sampleSize() const { return _samples.size(); }
+
+        /**
+         * The number of entries in the index when it was sampled.
+         */
+        long long numKeys() const { return _numKeys; }
+
+        /**
+         * Estimate of the number of distinct keys in the index.
+         */
+        double numDistinctKeys() const { return _numDistinctKeys; }
+
+        /**
+         * Estimates how many of 'numKeys' index entries fall within 'bounds'. Sampled keys are
+         * counted against the bounds, and bounds which match none of them are assumed to match
+         * about one distinct key. Returns a negative number if 'bounds' are a simple range, which
+         * we can't check sampled keys against.
+         */
+        double estimateKeys(const IndexBounds& bounds, int direction, long long numKeys) const;
+
+    private:
+        const BSONObj _keyPattern;
+
+        // Sorted in index order.
+        std::vector<BSONObj> _samples;
+
+        const long long _numKeys;
+
+        double _numDistinctKeys;
+    };
+
+    /**
+     * The statistics of the indexes of one collection, by key pattern.
+     */
+    typedef std::map<BSONObj, boost::shared_ptr<const IndexStatistics>, BSONObjCmp>
+        IndexStatisticsMap;
+
+    /**
+     * A rough estimate of the work done by a query solution.
+     */
+    struct PlanCostEstimate {
+        PlanCostEstimate() : blockingCost(0), streamingCost(0), numResults(0) { }
+
+        double totalCost() const { return blockingCost + streamingCost; }
+
+        // Work done before the first result can be returned, by blocking stages and their
+        // children.
+        double blockingCost;
+
+        // Work done while producing all of the results, which a limit cuts short.
+        double streamingCost;
+
+        // Estimated number of results.
+        double numResults;
+    };
+
+    /**
+     * Estimates the cost of the solution rooted at 'root' in a collection of 'numRecords'
+     * records, given the statistics of its indexes. Examining an index key or a document counts
+     * as one unit of work.
+     *
+     * Returns false if the solution has a stage whose cost we don't know how to estimate, or scans
+     * an index we have no statistics for.
+     */
+    bool estimatePlanCost(const QuerySolutionNode* root,
+                          const IndexStatisticsMap& indexStats,
+                          long long numRecords,
+                          PlanCostEstimate* out);
+
+}  // namespace mongo
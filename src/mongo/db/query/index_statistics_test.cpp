@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for mongo/db/query/index_statistics.h
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/index_statistics.h"
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/unittest/unittest.h"
+
+using namespace mongo;
+
+namespace {
+
+    using boost::shared_ptr;
+    using std::vector;
+
+    const long long kNumKeys = 100000;
+
+    /**
+     * Samples 1000 keys of an index on {a: 1} whose values of 'a' repeat every 'period' keys.
+     */
+    shared_ptr<const IndexStatistics> makeStats(int period) {
+        vector<BSONObj> samples;
+        for (int i = 0; i < 1000; ++i) {
+            samples.push_back(BSON("" << (i % period)));
+        }
+        return shared_ptr<const IndexStatistics>(
+            new IndexStatistics(BSON("a" << 1), samples, kNumKeys));
+    }
+
+    IndexBounds pointBounds(int value) {
+        OrderedIntervalList oil("a");
+        oil.intervals.push_back(Interval(BSON("" << value << "" << value), true, true));
+        IndexBounds bounds;
+        bounds.fields.push_back(oil);
+        return bounds;
+    }
+
+    IndexScanNode* makeIndexScan(int value) {
+        IndexScanNode* ixn = new IndexScanNode();
+        ixn->indexKeyPattern = BSON("a" << 1);
+        ixn->bounds = pointBounds(value);
+        return ixn;
+    }
+
+    FetchNode* makeFetch(QuerySolutionNode* child) {
+        FetchNode* fetch = new FetchNode();
+        fetch->children.push_back(child);
+        return fetch;
+    }
+
+    TEST(IndexStatisticsTest, DistinctKeysOfRepeatedValues) {
+        shared_ptr<const IndexStatistics> stats = makeStats(100);
+        ASSERT_EQUALS(1000U, stats->sampleSize());
+        ASSERT_EQUALS(100, stats->numDistinctKeys());
+    }
+
+    TEST(IndexStatisticsTest, DistinctKeysOfUniqueValues) {
+        // None of the sampled keys repeat, so most keys weren't sampled.
+        shared_ptr<const IndexStatistics> stats = makeStats(1000);
+        ASSERT_EQUALS(10000, stats->numDistinctKeys());
+    }
+
+    TEST(IndexStatisticsTest, EstimateSampledKeys) {
+        shared_ptr<const IndexStatistics> stats = makeStats(100);
+        ASSERT_EQUALS(1000, stats->estimateKeys(pointBounds(5), 1, kNumKeys));
+
+        // Estimates scale with the number of keys in the index.
+        ASSERT_EQUALS(2000, stats->estimateKeys(pointBounds(5), 1, 2 * kNumKeys));
+    }
+
+    TEST(IndexStatisticsTest, EstimateUnsampledKeys) {
+        ASSERT_EQUALS(1000, makeStats(100)->estimateKeys(pointBounds(200), 1, kNumKeys));
+        ASSERT_EQUALS(10, makeStats(1000)->estimateKeys(pointBounds(2000), 1, kNumKeys));
+    }
+
+    TEST(IndexStatisticsTest, CantEstimateSimpleRange) {
+        IndexBounds bounds;
+        bounds.isSimpleRange = true;
+        bounds.startKey = BSON("" << 1);
+        bounds.endKey = BSON("" << 2);
+        ASSERT_LESS_THAN(makeStats(100)->estimateKeys(bounds, 1, kNumKeys), 0);
+    }
+
+    TEST(IndexStatisticsTest, EstimateEmptyIndex) {
+        IndexStatistics stats(BSON("a" << 1), vector<BSONObj>(), 0);
+        ASSERT_EQUALS(0, stats.estimateKeys(pointBounds(5), 1, 0));
+    }
+
+    TEST(PlanCostEstimateTest, IndexScanCheaperThanCollectionScan) {
+        IndexStatisticsMap indexStats;
+        indexStats[BSON("a" << 1)] = makeStats(100);
+
+        PlanCostEstimate estimate;
+        std::auto_ptr<QuerySolutionNode> collscan(new CollectionScanNode());
+        ASSERT(estimatePlanCost(collscan.get(), indexStats, kNumKeys, &estimate));
+        ASSERT_EQUALS(kNumKeys, estimate.totalCost());
+
+        // Every key examined is also fetched.
+        std::auto_ptr<QuerySolutionNode> fetch(makeFetch(makeIndexScan(5)));
+        ASSERT(estimatePlanCost(fetch.get(), indexStats, kNumKeys, &estimate));
+        ASSERT_EQUALS(2000, estimate.totalCost());
+        ASSERT_EQUALS(1000, estimate.numResults);
+    }
+
+    TEST(PlanCostEstimateTest, LimitCutsStreamingWork) {
+        IndexStatisticsMap indexStats;
+        indexStats[BSON("a" << 1)] = makeStats(100);
+
+        LimitNode* limit = new LimitNode();
+        limit->limit = 10;
+        limit->children.push_back(makeFetch(makeIndexScan(5)));
+        std::auto_ptr<QuerySolutionNode> root(limit);
+
+        PlanCostEstimate estimate;
+        ASSERT(estimatePlanCost(root.get(), indexStats, kNumKeys, &estimate));
+        ASSERT_EQUALS(20, estimate.totalCost());
+        ASSERT_EQUALS(10, estimate.numResults);
+    }
+
+    TEST(PlanCostEstimateTest, LimitDoesntCutBlockingSort) {
+        IndexStatisticsMap indexStats;
+        indexStats[BSON("a" << 1)] = makeStats(100);
+
+        SortNode* sort = new SortNode();
+        sort->limit = 10;
+        sort->children.push_back(makeFetch(makeIndexScan(5)));
+        LimitNode* limit = new LimitNode();
+        limit->limit = 10;
+        limit->children.push_back(sort);
+        std::auto_ptr<QuerySolutionNode> root(limit);
+
+        PlanCostEstimate estimate;
+        ASSERT(estimatePlanCost(root.get(), indexStats, kNumKeys, &estimate));
+        ASSERT_GREATER_THAN(estimate.blockingCost, 2000);
+        ASSERT_EQUALS(10, estimate.numResults);
+    }
+
+    TEST(PlanCostEstimateTest, HashIntersectionBuildsAllButLastChild) {
+        IndexStatisticsMap indexStats;
+        indexStats[BSON("a" << 1)] = makeStats(100);
+
+        AndHashNode* andHash = new AndHashNode();
+        andHash->children.push_back(makeIndexScan(5));
+        andHash->children.push_back(makeIndexScan(6));
+        std::auto_ptr<QuerySolutionNode> root(andHash);
+
+        PlanCostEstimate estimate;
+        ASSERT(estimatePlanCost(root.get(), indexStats, kNumKeys, &estimate));
+        ASSERT_EQUALS(1000, estimate.blockingCost);
+        ASSERT_EQUALS(1000, estimate.streamingCost);
+    }
+
+    TEST(PlanCostEstimateTest, CantEstimateWithoutStatistics) {
+        IndexStatisticsMap indexStats;
+        std::auto_ptr<QuerySolutionNode> fetch(makeFetch(makeIndexScan(5)));
+
+        PlanCostEstimate estimate;
+        ASSERT_FALSE(estimatePlanCost(fetch.get(), indexStats, kNumKeys, &estimate));
+
+        // Nor for multikey indexes, which have more than one key per document.
+        indexStats[BSON("a" << 1)] = makeStats(100);
+        static_cast<IndexScanNode*>(fetch->children[0])->indexIsMultiKey = true;
+        ASSERT_FALSE(estimatePlanCost(fetch.get(), indexStats, kNumKeys, &estimate));
+    }
+
+}  // namespace
@@ -70,6 +70,11 @@ namespace mongo {
          */
         static StatusWith<int> parseMaxTimeMSQuery(const BSONObj& queryObj);
 
+        /**
+         * Same as parseMaxTimeMSCommand, but for an element already found in the object.
+         */
+        static StatusWith<int> parseMaxTimeMS(const BSONElement& maxTimeMSElt);
+
         /**
          * Helper function to identify text search sort key
          * Example: {a: {$meta: "textScore"}}
@@ -138,6 +143,12 @@ namespace mongo {
         bool isSnapshot() const { return _snapshot; }
         bool hasReadPref() const { return _hasReadPref; }
 
+        /**
+         * True if a blocking sort may write to temporary files rather than fail once it exceeds
+         * its memory limit.
+         */
+        bool allowDiskUse() const { return _allowDiskUse; }
+
         bool isTailable() const { return _tailable; }
         bool isSlaveOk() const { return _slaveOk; }
         bool isOplogReplay() const { return _oplogReplay; }
@@ -195,8 +206,6 @@ namespace mongo {
 
         Status initFullQuery(const BSONObj& top);
 
-        static StatusWith<int> parseMaxTimeMS(const BSONElement& maxTimeMSElt);
-
         /**
          * Updates the projection object with a $meta projection for the returnKey option.
          */
@@ -243,6 +252,7 @@ namespace mongo {
         bool _showRecordId;
         bool _snapshot;
         bool _hasReadPref;
+        bool _allowDiskUse;
 
         // Options that can be specified in the OP_QUERY 'flags' header.
         bool _tailable;
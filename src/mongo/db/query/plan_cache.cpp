@@ -525,11 +525,29 @@ namespace {
     // PlanCache
     //
 
-    PlanCache::PlanCache() : _cache(internalQueryCacheSize) { }
+    namespace {
 
-    PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize), _ns(ns) { }
+        // Every plan cache currently in existence, for serverStatus. Allocated on the heap and
+        // never freed so that caches destroyed during shutdown never see a destroyed registry.
+        boost::mutex* const planCacheRegistryMutex = new boost::mutex();
+        std::set<const PlanCache*>* const planCacheRegistry = new std::set<const PlanCache*>();
 
-    PlanCache::~PlanCache() { }
+    }  // namespace
+
+    PlanCache::PlanCache() : _cache(internalQueryCacheSize) {
+        boost::lock_guard<boost::mutex> lk(*planCacheRegistryMutex);
+        planCacheRegistry->insert(this);
+    }
+
+    PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize), _ns(ns) {
+        boost::lock_guard<boost::mutex> lk(*planCacheRegistryMutex);
+        planCacheRegistry->insert(this);
+    }
+
+    PlanCache::~PlanCache() {
+        boost::lock_guard<boost::mutex> lk(*planCacheRegistryMutex);
+        planCacheRegistry->erase(this);
+    }
 
     Status PlanCache::add(const CanonicalQuery& query,
                           const std::vector<QuerySolution*>& solns,
@@ -581,9 +599,11 @@ namespace {
         PlanCacheEntry* entry;
         Status cacheStatus = _cache.get(key, &entry);
         if (!cacheStatus.isOK()) {
+            _misses.fetchAndAdd(1);
             return cacheStatus;
         }
         invariant(entry);
+        _hits.fetchAndAdd(1);
 
         *crOut = new CachedSolution(key, *entry);
 
@@ -624,7 +644,8 @@ namespace {
         _writeOperations.store(0);
     }
 
-    PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
+    // static
+    PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) {
         str::stream ss;
         encodePlanCacheKeyTree(cq.root(), &ss);
         encodePlanCacheKeySort(cq.getParsed().getSort(), &ss);
@@ -684,4 +705,47 @@ namespace {
         clear();
     }
 
+    void PlanCache::noteReplan(bool background) {
+        if (background) {
+            _backgroundReplans.fetchAndAdd(1);
+        }
+        else {
+            _replans.fetchAndAdd(1);
+        }
+    }
+
+    void PlanCache::appendStats(BSONObjBuilder* b) const {
+        b->appendNumber("hits", _hits.load());
+        b->appendNumber("misses", _misses.load());
+        b->appendNumber("replans", _replans.load());
+        b->appendNumber("backgroundReplans", _backgroundReplans.load());
+    }
+
+    // static
+    void PlanCache::appendAllStats(BSONObjBuilder* b) {
+        boost::lock_guard<boost::mutex> lk(*planCacheRegistryMutex);
+        for (std::set<const PlanCache*>::const_iterator it = planCacheRegistry->begin();
+             it != planCacheRegistry->end(); ++it) {
+            if ((*it)->_ns.empty()) {
+                continue;
+            }
+            BSONObjBuilder nsBuilder(b->subobjStart((*it)->_ns));
+            (*it)->appendStats(&nsBuilder);
+            nsBuilder.doneFast();
+        }
+    }
+
+    // static
+    std::vector<std::string> PlanCache::getAllNamespaces() {
+        std::vector<std::string> namespaces;
+        boost::lock_guard<boost::mutex> lk(*planCacheRegistryMutex);
+        for (std::set<const PlanCache*>::const_iterator it = planCacheRegistry->begin();
+             it != planCacheRegistry->end(); ++it) {
+            if (!(*it)->_ns.empty() && (*it)->size() > 0) {
+                namespaces.push_back((*it)->_ns);
+            }
+        }
+        return namespaces;
+    }
+
 }  // namespace mongo
@@ -341,9 +341,10 @@ namespace mongo {
          * be cached.
          *
          * This is provided in the public API simply as a convenience for consumers who need some
-         * description of query shape (e.g. index filters).
+         * description of query shape (e.g. index filters). It doesn't depend on the contents
+         * of any cache.
          */
-        PlanCacheKey computeKey(const CanonicalQuery&) const;
+        static PlanCacheKey computeKey(const CanonicalQuery&);
 
         /**
          * Returns a copy of a cache entry.
@@ -382,6 +383,29 @@ namespace mongo {
          */
         void notifyOfWriteOp();
 
+        /**
+         * Counts a replan of one of this cache's entries. 'background' is true if the replan was
+         * run by the background replanner rather than inline by the query that found the cached
+         * plan to be degraded.
+         */
+        void noteReplan(bool background);
+
+        /**
+         * Appends the hit, miss and replan counters of this cache.
+         */
+        void appendStats(BSONObjBuilder* b) const;
+
+        /**
+         * Appends the counters of every live plan cache which belongs to a collection, as one
+         * subobject per namespace.
+         */
+        static void appendAllStats(BSONObjBuilder* b);
+
+        /**
+         * Returns the namespaces of the collections whose plan caches have entries.
+         */
+        static std::vector<std::string> getAllNamespaces();
+
     private:
         /**
          * Releases resources associated with each cache entry
@@ -403,6 +427,14 @@ namespace mongo {
          */
         AtomicInt32 _writeOperations;
 
+        // Lookups through get() which did and did not find an entry.
+        mutable AtomicInt64 _hits;
+        mutable AtomicInt64 _misses;
+
+        // Entries found to be degraded and replanned inline or in the background.
+        AtomicInt64 _replans;
+        AtomicInt64 _backgroundReplans;
+
         /**
          * Full namespace of collection.
          */
@@ -0,0 +1,263 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+    const char kTypeTags[] = "tags";
+    const char kTypeWholeIndexScan[] = "wholeIndexScan";
+    const char kTypeCollscan[] = "collscan";
+
+    // The stage name shown for the trial stats of a restored entry, e.g. by planCacheListPlans.
+    const char kRestoredStageName[] = "PLAN_CACHE_SNAPSHOT";
+
+    void appendTree(const PlanCacheIndexTree& tree, BSONObjBuilder* b) {
+        if (tree.entry.get()) {
+            b->append("index", tree.entry->name);
+            b->append("keyPattern", tree.entry->keyPattern);
+            b->appendNumber("pos", static_cast<long long>(tree.index_pos));
+        }
+
+        if (!tree.children.empty()) {
+            BSONArrayBuilder childrenBuilder(b->subarrayStart("children"));
+            for (size_t i = 0; i < tree.children.size(); ++i) {
+                BSONObjBuilder childBuilder(childrenBuilder.subobjStart());
+                appendTree(*tree.children[i], &childBuilder);
+                childBuilder.doneFast();
+            }
+            childrenBuilder.doneFast();
+        }
+    }
+
+    Status treeFromBSON(const BSONObj& obj,
+                        const std::vector<IndexEntry>& indices,
+                        PlanCacheIndexTree** out) {
+        std::auto_ptr<PlanCacheIndexTree> tree(new PlanCacheIndexTree());
+
+        BSONElement indexElt = obj["index"];
+        if (!indexElt.eoo()) {
+            BSONElement keyPatternElt = obj["keyPattern"];
+            BSONElement posElt = obj["pos"];
+            if (String != indexElt.type() || Object != keyPatternElt.type() ||
+                !posElt.isNumber() || posElt.numberLong() < 0) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "bad index in plan cache tree " << obj);
+            }
+
+            const BSONObj keyPattern = keyPatternElt.Obj();
+            std::vector<IndexEntry>::const_iterator it = indices.begin();
+            for (; it != indices.end(); ++it) {
+                if (it->name == indexElt.valuestr() && 0 == it->keyPattern.woCompare(keyPattern)) {
+                    break;
+                }
+            }
+            if (indices.end() == it) {
+                return Status(ErrorCodes::IndexNotFound,
+                              str::stream() << "no index " << indexElt.valuestr() << " with key "
+                                            << keyPattern);
+            }
+
+            tree->setIndexEntry(*it);
+            tree->index_pos = static_cast<size_t>(posElt.numberLong());
+        }
+
+        BSONElement childrenElt = obj["children"];
+        if (!childrenElt.eoo()) {
+            if (Array != childrenElt.type()) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "bad children in plan cache tree " << obj);
+            }
+            BSONObjIterator it(childrenElt.Obj());
+            while (it.more()) {
+                BSONElement childElt = it.next();
+                if (Object != childElt.type()) {
+                    return Status(ErrorCodes::BadValue,
+                                  str::stream() << "bad child in plan cache tree " << obj);
+                }
+                PlanCacheIndexTree* child;
+                Status status = treeFromBSON(childElt.Obj(), indices, &child);
+                if (!status.isOK()) {
+                    return status;
+                }
+                tree->children.push_back(child);
+            }
+        }
+
+        *out = tree.release();
+        return Status::OK();
+    }
+
+}  // namespace
+
+    BSONObj planCacheEntryToBSON(const PlanCacheEntry& entry) {
+        BSONObjBuilder b;
+        b.append("query", entry.query);
+        b.append("sort", entry.sort);
+        b.append("projection", entry.projection);
+
+        BSONArrayBuilder plansBuilder(b.subarrayStart("plans"));
+        for (size_t i = 0; i < entry.plannerData.size(); ++i) {
+            const SolutionCacheData& data = *entry.plannerData[i];
+            BSONObjBuilder planBuilder(plansBuilder.subobjStart());
+            switch (data.solnType) {
+            case SolutionCacheData::USE_INDEX_TAGS_SOLN:
+                planBuilder.append("type", kTypeTags);
+                break;
+            case SolutionCacheData::WHOLE_IXSCAN_SOLN:
+                planBuilder.append("type", kTypeWholeIndexScan);
+                planBuilder.append("direction", data.wholeIXSolnDir);
+                break;
+            case SolutionCacheData::COLLSCAN_SOLN:
+                planBuilder.append("type", kTypeCollscan);
+                break;
+            }
+            planBuilder.append("indexFilterApplied", data.indexFilterApplied);
+
+            if (entry.decision.get() && i < entry.decision->stats.size()) {
+                planBuilder.appendNumber(
+                    "works", static_cast<long long>(entry.decision->stats[i]->common.works));
+                planBuilder.append("score", entry.decision->scores[i]);
+            }
+
+            if (data.tree.get()) {
+                BSONObjBuilder treeBuilder(planBuilder.subobjStart("tree"));
+                appendTree(*data.tree, &treeBuilder);
+                treeBuilder.doneFast();
+            }
+            planBuilder.doneFast();
+        }
+        plansBuilder.doneFast();
+
+        return b.obj();
+    }
+
+    Status solutionCacheDataFromBSON(const BSONObj& obj,
+                                     const std::vector<IndexEntry>& indices,
+                                     SolutionCacheData** out) {
+        std::auto_ptr<SolutionCacheData> data(new SolutionCacheData());
+
+        const std::string type = obj.getStringField("type");
+        if (kTypeTags == type) {
+            data->solnType = SolutionCacheData::USE_INDEX_TAGS_SOLN;
+        }
+        else if (kTypeWholeIndexScan == type) {
+            data->solnType = SolutionCacheData::WHOLE_IXSCAN_SOLN;
+            data->wholeIXSolnDir = obj["direction"].numberInt() < 0 ? -1 : 1;
+        }
+        else if (kTypeCollscan == type) {
+            data->solnType = SolutionCacheData::COLLSCAN_SOLN;
+        }
+        else {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "unknown plan cache solution type in " << obj);
+        }
+        data->indexFilterApplied = obj["indexFilterApplied"].trueValue();
+
+        BSONElement treeElt = obj["tree"];
+        if (Object == treeElt.type()) {
+            PlanCacheIndexTree* tree;
+            Status status = treeFromBSON(treeElt.Obj(), indices, &tree);
+            if (!status.isOK()) {
+                return status;
+            }
+            data->tree.reset(tree);
+        }
+
+        // Every type but a collection scan needs a tree, and a whole index scan its index.
+        if (SolutionCacheData::COLLSCAN_SOLN != data->solnType && !data->tree.get()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "no tree in plan cache solution " << obj);
+        }
+        if (SolutionCacheData::WHOLE_IXSCAN_SOLN == data->solnType && !data->tree->entry.get()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "no index in whole index scan solution " << obj);
+        }
+
+        *out = data.release();
+        return Status::OK();
+    }
+
+    Status planCacheEntryFromBSON(const BSONObj& obj,
+                                  const std::vector<IndexEntry>& indices,
+                                  OwnedPointerVector<QuerySolution>* solutionsOut,
+                                  PlanRankingDecision** decisionOut) {
+        BSONElement plansElt = obj["plans"];
+        if (Array != plansElt.type() || plansElt.Obj().isEmpty()) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "no plans in plan cache entry " << obj);
+        }
+
+        OwnedPointerVector<QuerySolution> solutions;
+        std::auto_ptr<PlanRankingDecision> decision(new PlanRankingDecision());
+        BSONObjIterator it(plansElt.Obj());
+        while (it.more()) {
+            BSONElement planElt = it.next();
+            if (Object != planElt.type()) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "bad plan in plan cache entry " << obj);
+            }
+            const BSONObj plan = planElt.Obj();
+
+            SolutionCacheData* data;
+            Status status = solutionCacheDataFromBSON(plan, indices, &data);
+            if (!status.isOK()) {
+                return status;
+            }
+            QuerySolution* solution = new QuerySolution();
+            solution->cacheData.reset(data);
+            solutions.mutableVector().push_back(solution);
+
+            // The plans were saved in ranking order, each with what its trial found.
+            CommonStats common(kRestoredStageName);
+            common.works = static_cast<size_t>(std::max(0LL, plan["works"].numberLong()));
+            decision->stats.mutableVector().push_back(new PlanStageStats(common, STAGE_UNKNOWN));
+            decision->scores.push_back(plan["score"].numberDouble());
+            decision->candidateOrder.push_back(decision->candidateOrder.size());
+        }
+
+        solutionsOut->clear();
+        solutionsOut->mutableVector().swap(solutions.mutableVector());
+        *decisionOut = decision.release();
+        return Status::OK();
+    }
+
+}  // namespace mongo
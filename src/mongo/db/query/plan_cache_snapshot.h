@@ -0,0 +1,96 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    struct IndexEntry;
+    class PlanCacheEntry;
+    struct PlanRankingDecision;
+    struct QuerySolution;
+    struct SolutionCacheData;
+
+    /**
+     * Serializes 'entry' so that it can be put back into the plan cache after a restart, or on
+     * another node. Stores the query shape and, for each plan in ranking order, the data the
+     * planner rebuilds it from, along with the works and score of its trial:
+     *
+     *   {query: {...}, sort: {...}, projection: {...},
+     *    plans: [{type: "tags" | "wholeIndexScan" | "collscan", direction: 1,
+     *             indexFilterApplied: false, works: 123, score: 1.5,
+     *             tree: {index: "a_1", keyPattern: {a: 1}, pos: 0, children: [...]}}, ...]}
+     *
+     * Indexes are recorded by name and key pattern only, since the rest of their description
+     * must be looked up again when the entry is restored.
+     */
+    BSONObj planCacheEntryToBSON(const PlanCacheEntry& entry);
+
+    /**
+     * Rebuilds the planner data of one plan serialized by planCacheEntryToBSON(), taking the
+     * indexes it uses from 'indices'. Fails if the plan is malformed, or if one of its indexes
+     * is no longer in 'indices' with the same name and key pattern.
+     *
+     * On success the caller owns '*out'.
+     */
+    Status solutionCacheDataFromBSON(const BSONObj& obj,
+                                     const std::vector<IndexEntry>& indices,
+                                     SolutionCacheData** out);
+
+    /**
+     * Rebuilds from an entry serialized by planCacheEntryToBSON() the solutions and ranking
+     * decision that PlanCache::add() takes. The solutions carry only their cache data. The
+     * decision has the stats of each plan's trial reduced to its works.
+     *
+     * On success the caller owns '*decisionOut'.
+     */
+    Status planCacheEntryFromBSON(const BSONObj& obj,
+                                  const std::vector<IndexEntry>& indices,
+                                  OwnedPointerVector<QuerySolution>* solutionsOut,
+                                  PlanRankingDecision** decisionOut);
+
+    /**
+     * Starts the thread which, while planCacheSnapshotIntervalSecs is set, saves the plan cache
+     * entries of every collection to admin.system.plancache that often, and restores them when
+     * the server starts.
+     */
+    void startPlanCacheSnapshotter();
+
+    /**
+     * Makes the snapshotter restore the saved entries again, e.g. when this node becomes
+     * primary and starts taking the queries its plan cache has not seen yet. Never blocks.
+     */
+    void requestPlanCacheSnapshotLoad();
+
+}  // namespace mongo
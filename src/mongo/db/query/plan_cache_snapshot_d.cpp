@@ -0,0 +1,315 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_cache_snapshot.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbdirectclient.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+    // How often to save the plan caches, or 0 to neither save nor restore them.
+    MONGO_EXPORT_SERVER_PARAMETER(planCacheSnapshotIntervalSecs, int, 0);
+
+    // One document per collection, {_id: <ns>, savedAt: <date>, entries: [...]}. The collection
+    // is replicated so that a secondary which becomes primary finds the plans of the old one.
+    const char kSnapshotNs[] = "admin.system.plancache";
+
+    // Caps the entries saved for a collection. They are saved most recently used first.
+    const int kMaxSnapshotBytes = 4 * 1024 * 1024;
+
+    AtomicUInt32 loadRequested;
+
+    class PlanCacheSnapshotter : public BackgroundJob {
+    public:
+        PlanCacheSnapshotter() { }
+
+        virtual std::string name() const { return "PlanCacheSnapshotter"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            bool loaded = false;
+            long long lastSaveMillis = curTimeMillis64();
+            while (!inShutdown()) {
+                sleepsecs(1);
+
+                const int intervalSecs = planCacheSnapshotIntervalSecs;
+                if (intervalSecs <= 0) {
+                    continue;
+                }
+
+                try {
+                    if (!loaded || loadRequested.swap(0)) {
+                        loaded = true;
+                        _loadAll();
+                        continue;
+                    }
+
+                    if (curTimeMillis64() - lastSaveMillis < intervalSecs * 1000LL) {
+                        continue;
+                    }
+                    lastSaveMillis = curTimeMillis64();
+
+                    if (lockedForWriting()) {
+                        continue;
+                    }
+                    _saveAll();
+                }
+                catch (const DBException& e) {
+                    warning() << "plan cache snapshot failed: " << e.toString();
+                }
+            }
+        }
+
+    private:
+        void _saveAll() {
+            if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(
+                    nsToDatabaseSubstring(kSnapshotNs))) {
+                return;
+            }
+
+            OperationContextImpl txn;
+            const std::vector<std::string> namespaces = PlanCache::getAllNamespaces();
+            size_t numEntries = 0;
+            for (size_t i = 0; i < namespaces.size(); ++i) {
+                // Plans on a node's own collections are no use anywhere else.
+                if (nsToDatabaseSubstring(namespaces[i]) == "local" ||
+                    namespaces[i] == kSnapshotNs) {
+                    continue;
+                }
+
+                const BSONObj doc = _snapshotCollection(&txn, namespaces[i], &numEntries);
+                if (doc.isEmpty()) {
+                    continue;
+                }
+                if (!_write(&txn, doc)) {
+                    return;
+                }
+            }
+
+            LOG(1) << "saved " << numEntries << " plan cache entries of " << namespaces.size()
+                   << " collections to " << kSnapshotNs;
+        }
+
+        // Returns the snapshot document of 'ns', or an empty object if it has no collection.
+        BSONObj _snapshotCollection(OperationContext* txn,
+                                    const std::string& ns,
+                                    size_t* numEntries) {
+            AutoGetCollectionForRead ctx(txn, ns);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return BSONObj();
+            }
+
+            OwnedPointerVector<PlanCacheEntry> entries(
+                collection->infoCache()->getPlanCache()->getAllEntries());
+
+            BSONObjBuilder b;
+            b.append("_id", ns);
+            b.appendDate("savedAt", jsTime());
+            BSONArrayBuilder entriesBuilder(b.subarrayStart("entries"));
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const BSONObj entry = planCacheEntryToBSON(*entries[i]);
+                if (entriesBuilder.len() + entry.objsize() > kMaxSnapshotBytes) {
+                    break;
+                }
+                entriesBuilder.append(entry);
+                ++*numEntries;
+            }
+            entriesBuilder.doneFast();
+            return b.obj();
+        }
+
+        // Returns false if this node can no longer write the snapshot.
+        bool _write(OperationContext* txn, const BSONObj& doc) {
+            MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                ScopedTransaction transaction(txn, MODE_IX);
+                Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(kSnapshotNs), MODE_X);
+                if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(
+                        nsToDatabaseSubstring(kSnapshotNs))) {
+                    return false;
+                }
+
+                WriteUnitOfWork wunit(txn);
+                Helpers::upsert(txn, kSnapshotNs, doc);
+                wunit.commit();
+            } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "planCacheSnapshot", kSnapshotNs);
+            return true;
+        }
+
+        void _loadAll() {
+            OperationContextImpl txn;
+
+            std::vector<BSONObj> docs;
+            {
+                DBDirectClient client(&txn);
+                std::auto_ptr<DBClientCursor> cursor = client.query(kSnapshotNs, Query());
+                while (cursor.get() && cursor->more()) {
+                    docs.push_back(cursor->nextSafe().getOwned());
+                }
+            }
+
+            size_t numLoaded = 0;
+            size_t numEntries = 0;
+            for (size_t i = 0; i < docs.size(); ++i) {
+                if (String != docs[i]["_id"].type() || Array != docs[i]["entries"].type()) {
+                    continue;
+                }
+                const std::string ns = docs[i]["_id"].String();
+
+                AutoGetCollectionForRead ctx(&txn, ns);
+                Collection* collection = ctx.getCollection();
+                BSONObjIterator it(docs[i]["entries"].Obj());
+                while (it.more()) {
+                    BSONElement entryElt = it.next();
+                    ++numEntries;
+                    if (collection && Object == entryElt.type() &&
+                        _loadEntry(&txn, collection, ns, entryElt.Obj())) {
+                        ++numLoaded;
+                    }
+                }
+            }
+
+            if (numEntries) {
+                log() << "restored " << numLoaded << " of " << numEntries
+                      << " plan cache entries from " << kSnapshotNs;
+            }
+        }
+
+        /**
+         * Puts the saved 'entry' back into the plan cache of 'collection', unless a query of its
+         * shape was planned since, or its plans no longer fit the collection's indexes.
+         */
+        bool _loadEntry(OperationContext* txn,
+                        Collection* collection,
+                        const std::string& ns,
+                        const BSONObj& entry) {
+            const NamespaceString nss(ns);
+            const WhereCallbackReal whereCallback(txn, nss.db());
+            CanonicalQuery* rawCanonicalQuery;
+            Status status = CanonicalQuery::canonicalize(ns,
+                                                         entry.getObjectField("query"),
+                                                         entry.getObjectField("sort"),
+                                                         entry.getObjectField("projection"),
+                                                         &rawCanonicalQuery,
+                                                         whereCallback);
+            if (!status.isOK()) {
+                return false;
+            }
+            std::unique_ptr<CanonicalQuery> canonicalQuery(rawCanonicalQuery);
+
+            PlanCache* cache = collection->infoCache()->getPlanCache();
+            if (!PlanCache::shouldCacheQuery(*canonicalQuery) || cache->contains(*canonicalQuery)) {
+                return false;
+            }
+
+            QueryPlannerParams plannerParams;
+            fillOutPlannerParams(txn, collection, canonicalQuery.get(), &plannerParams);
+
+            OwnedPointerVector<QuerySolution> solutions;
+            PlanRankingDecision* rawDecision;
+            status = planCacheEntryFromBSON(entry, plannerParams.indices, &solutions, &rawDecision);
+            if (!status.isOK()) {
+                LOG(2) << "not restoring plan cache entry " << entry << ": " << status.toString();
+                return false;
+            }
+            std::unique_ptr<PlanRankingDecision> decision(rawDecision);
+
+            // Index filters set or cleared since the entry was saved change which plans the
+            // planner may choose.
+            if (solutions[0]->cacheData->indexFilterApplied != plannerParams.indexFiltersApplied) {
+                return false;
+            }
+
+            // The planner must still be able to build the winning plan from its cache data.
+            {
+                PlanCacheEntry candidate(solutions.vector(), decision->clone());
+                CachedSolution cachedSolution(cache->computeKey(*canonicalQuery), candidate);
+                QuerySolution* rawSolution;
+                status = QueryPlanner::planFromCache(*canonicalQuery,
+                                                     plannerParams,
+                                                     cachedSolution,
+                                                     &rawSolution);
+                if (!status.isOK()) {
+                    LOG(2) << "not restoring plan cache entry " << entry << ": "
+                           << status.toString();
+                    return false;
+                }
+                delete rawSolution;
+            }
+
+            return cache->add(*canonicalQuery, solutions.vector(), decision.release()).isOK();
+        }
+    };
+
+}  // namespace
+
+    void startPlanCacheSnapshotter() {
+        PlanCacheSnapshotter* snapshotter = new PlanCacheSnapshotter();
+        snapshotter->go();
+    }
+
+    void requestPlanCacheSnapshotLoad() {
+        loadRequested.store(1);
+    }
+
+}  // namespace mongo
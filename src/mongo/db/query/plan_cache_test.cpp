@@ -39,6 +39,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
@@ -383,6 +384,38 @@ namespace {
         ASSERT_EQUALS(planCache.size(), 1U);
     }
 
+    TEST(PlanCacheTest, StatsCountHitsMissesAndReplans) {
+        PlanCache planCache("test.stats");
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        QuerySolution qs;
+        qs.cacheData.reset(new SolutionCacheData());
+        qs.cacheData->tree.reset(new PlanCacheIndexTree());
+        std::vector<QuerySolution*> solns;
+        solns.push_back(&qs);
+
+        CachedSolution* rawCached;
+        ASSERT_NOT_OK(planCache.get(*cq, &rawCached));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        ASSERT_OK(planCache.get(*cq, &rawCached));
+        delete rawCached;
+        ASSERT_OK(planCache.get(*cq, &rawCached));
+        delete rawCached;
+        planCache.noteReplan(false);
+        planCache.noteReplan(true);
+        planCache.noteReplan(true);
+
+        BSONObjBuilder bob;
+        planCache.appendStats(&bob);
+        ASSERT_EQUALS(fromjson("{hits: 2, misses: 1, replans: 1, backgroundReplans: 2}"),
+                      bob.obj());
+
+        // Caches which belong to a collection are reported under its namespace.
+        BSONObjBuilder allBob;
+        PlanCache::appendAllStats(&allBob);
+        BSONObj all = allBob.obj();
+        ASSERT_EQUALS(2, all["test.stats"].Obj()["hits"].numberLong());
+    }
+
     TEST(PlanCacheTest, NotifyOfWriteOp) {
         PlanCache planCache;
         auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -722,6 +755,47 @@ namespace {
             delete planSoln;
         }
 
+        /**
+         * Returns the snapshot of a cache entry made of the solution matching 'solnJson', with
+         * 'works' and 'score' for its trial.
+         */
+        BSONObj snapshotSolution(const string& solnJson, size_t works, double score) const {
+            QuerySolution* bestSoln = firstMatchingSolution(solnJson);
+            QuerySolution qs;
+            qs.cacheData.reset(bestSoln->cacheData->clone());
+            std::vector<QuerySolution*> solutions;
+            solutions.push_back(&qs);
+            PlanRankingDecision* decision = createDecision(1U);
+            decision->stats[0]->common.works = works;
+            decision->scores[0] = score;
+            PlanCacheEntry entry(solutions, decision);
+            return planCacheEntryToBSON(entry);
+        }
+
+        /**
+         * Like assertPlanCacheRecoversSolution(), but passes the cache data of the solution
+         * through a plan cache snapshot first.
+         */
+        void assertSnapshotRecoversSolution(const BSONObj& query,
+                                            const BSONObj& sort,
+                                            const BSONObj& proj,
+                                            const string& solnJson) {
+            BSONObj snapshot = snapshotSolution(solnJson, 10U, 1.5);
+
+            OwnedPointerVector<QuerySolution> restored;
+            PlanRankingDecision* rawDecision;
+            ASSERT_OK(planCacheEntryFromBSON(snapshot, params.indices, &restored, &rawDecision));
+            scoped_ptr<PlanRankingDecision> decision(rawDecision);
+            ASSERT_EQUALS(1U, restored.size());
+            ASSERT_EQUALS(1U, decision->stats.size());
+            ASSERT_EQUALS(10U, decision->stats[0]->common.works);
+            ASSERT_EQUALS(1.5, decision->scores[0]);
+
+            QuerySolution* planSoln = planQueryFromCache(query, sort, proj, *restored[0]);
+            assertSolutionMatches(planSoln, solnJson);
+            delete planSoln;
+        }
+
         /**
          * Check that the solution will not be cached. The planner will store
          * cache data inside non-cachable solutions, but will not do so for
@@ -973,6 +1047,72 @@ namespace {
             "{sort: {pattern: {c: 1}, limit: 0, node: {cscan: {dir: 1}}}}");
     }
 
+    //
+    // Restoring plans from a plan cache snapshot.
+    //
+
+    TEST_F(CachePlanSelectionTest, SnapshotRecoversIndexTags) {
+        addIndex(BSON("a" << 1));
+        addIndex(BSON("b" << 1 << "c" << 1));
+        BSONObj query = fromjson("{$or: [{a: 20}, {b: 21, c: 5}]}");
+        runQuery(query);
+        assertSnapshotRecoversSolution(query, BSONObj(), BSONObj(),
+            "{fetch: {filter: null, node: {or: {nodes: ["
+                "{ixscan: {filter: null, pattern: {a: 1}}}, "
+                "{ixscan: {filter: null, pattern: {b: 1, c: 1}}}]}}}}");
+    }
+
+    TEST_F(CachePlanSelectionTest, SnapshotRecoversWholeIndexScan) {
+        addIndex(BSON("_id" << 1));
+        runQuerySortProj(BSONObj(), fromjson("{_id: -1}"), BSONObj());
+        assertSnapshotRecoversSolution(BSONObj(), fromjson("{_id: -1}"), BSONObj(),
+            "{fetch: {filter: null, node: {ixscan: {filter: null, pattern: {_id: 1}}}}}");
+    }
+
+    TEST_F(CachePlanSelectionTest, SnapshotRecoversCollscan) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(BSON("b" << 4));
+        assertSnapshotRecoversSolution(BSON("b" << 4), BSONObj(), BSONObj(),
+            "{cscan: {filter: {b: 4}, dir: 1}}");
+    }
+
+    TEST_F(CachePlanSelectionTest, SnapshotNotRestoredWithoutItsIndex) {
+        addIndex(BSON("a" << 1));
+        runQuery(BSON("a" << 5));
+        BSONObj snapshot = snapshotSolution(
+            "{fetch: {filter: null, node: {ixscan: {pattern: {a: 1}}}}}", 1U, 1.0);
+
+        // The index was dropped and re-created with a different key.
+        params.indices.back().keyPattern = BSON("a" << -1);
+        OwnedPointerVector<QuerySolution> restored;
+        PlanRankingDecision* decision;
+        ASSERT_EQUALS(ErrorCodes::IndexNotFound,
+                      planCacheEntryFromBSON(snapshot, params.indices, &restored, &decision));
+
+        // Also if it was renamed.
+        params.indices.back().keyPattern = BSON("a" << 1);
+        params.indices.back().name = "a_1_renamed";
+        ASSERT_EQUALS(ErrorCodes::IndexNotFound,
+                      planCacheEntryFromBSON(snapshot, params.indices, &restored, &decision));
+    }
+
+    TEST(PlanCacheSnapshotTest, RejectsMalformedEntries) {
+        std::vector<IndexEntry> indices;
+        OwnedPointerVector<QuerySolution> restored;
+        PlanRankingDecision* decision;
+        ASSERT_NOT_OK(planCacheEntryFromBSON(fromjson("{query: {a: 1}}"),
+                                             indices, &restored, &decision));
+        ASSERT_NOT_OK(planCacheEntryFromBSON(fromjson("{query: {a: 1}, plans: []}"),
+                                             indices, &restored, &decision));
+        ASSERT_NOT_OK(planCacheEntryFromBSON(fromjson("{plans: [{type: 'bogus'}]}"),
+                                             indices, &restored, &decision));
+        ASSERT_NOT_OK(planCacheEntryFromBSON(fromjson("{plans: [{type: 'tags'}]}"),
+                                             indices, &restored, &decision));
+        ASSERT_NOT_OK(planCacheEntryFromBSON(
+                          fromjson("{plans: [{type: 'wholeIndexScan', tree: {}}]}"),
+                          indices, &restored, &decision));
+    }
+
     //
     // Check queries that, at least for now, are not cached.
     //
@@ -34,6 +34,7 @@
 
 #include "mongo/db/query/indexability.h"
 #include "mongo/db/query/index_tag.h"
+#include "mongo/db/query/planner_ixselect.h"
 #include "mongo/util/log.h"
 
 namespace {
@@ -72,6 +73,7 @@ namespace mongo {
         : _root(params.root),
           _indices(params.indices),
           _ixisect(params.intersect),
+          _skipScan(params.skipScan),
           _orLimit(params.maxSolutionsPerOr),
           _intersectLimit(params.maxIntersectPerAnd) { }
 
@@ -222,8 +224,22 @@ namespace mongo {
             // In order to definitely use an index it must be prefixed with our field.
             // We don't consider notFirst indices here because we must be AND-related to a node
             // that uses the first spot in that index, and we currently do not know that
-            // unless we're in an AND node.
-            if (0 == rt->first.size()) { return false; }
+            // unless we're in an AND node.  The exception is skip scanning, which we only
+            // consider if no index is prefixed with our field.
+            vector<IndexID> skipScanIndices;
+            vector<size_t> skipScanPositions;
+            if (0 == rt->first.size()) {
+                if (NULL == context.elemMatchExpr) {
+                    for (size_t i = 0; i < rt->notFirst.size(); ++i) {
+                        size_t pos;
+                        if (skipScanPosition(rt->notFirst[i], rt->path, &pos)) {
+                            skipScanIndices.push_back(rt->notFirst[i]);
+                            skipScanPositions.push_back(pos);
+                        }
+                    }
+                }
+                if (skipScanIndices.empty()) { return false; }
+            }
 
             // We know we can use an index, so grab a memo spot.
             size_t myMemoID;
@@ -232,7 +248,13 @@ namespace mongo {
 
             assign->pred.reset(new PredicateAssignment());
             assign->pred->expr = node;
-            assign->pred->first.swap(rt->first);
+            if (skipScanIndices.empty()) {
+                assign->pred->first.swap(rt->first);
+            }
+            else {
+                assign->pred->first.swap(skipScanIndices);
+                assign->pred->positions.swap(skipScanPositions);
+            }
             return true;
         }
         else if (Indexability::isBoundsGeneratingNot(node)) {
@@ -390,7 +412,8 @@ namespace mongo {
             // If none of our children can use indices, bail out.
             if (idxToFirst.empty()
                 && (subnodes.size() == 0)
-                && (mandatorySubnodes.size() == 0)) {
+                && (mandatorySubnodes.size() == 0)
+                && !canSkipScanAny(idxToNotFirst)) {
                 return false;
             }
 
@@ -652,6 +675,58 @@ namespace mongo {
             state.assignments.push_back(indexAssign);
             andAssignment->choices.push_back(state);
         }
+
+        // If no index is prefixed by one of our predicates, try skip scanning the indices that
+        // have predicates over their other fields.
+        if (idxToFirst.empty()) {
+            for (IndexToPredMap::const_iterator it = idxToNotFirst.begin();
+                 it != idxToNotFirst.end(); ++it) {
+                if (!canSkipScan(it->first)) {
+                    continue;
+                }
+
+                OneIndexAssignment indexAssign;
+                indexAssign.index = it->first;
+                compound(it->second, (*_indices)[it->first], &indexAssign);
+                if (indexAssign.preds.empty()) {
+                    continue;
+                }
+
+                AndEnumerableState state;
+                state.assignments.push_back(indexAssign);
+                andAssignment->choices.push_back(state);
+            }
+        }
+    }
+
+    bool PlanEnumerator::canSkipScan(IndexID idx) const {
+        return _skipScan && QueryPlannerIXSelect::canSkipScan((*_indices)[idx]);
+    }
+
+    bool PlanEnumerator::canSkipScanAny(const IndexToPredMap& idxToNotFirst) const {
+        for (IndexToPredMap::const_iterator it = idxToNotFirst.begin();
+             it != idxToNotFirst.end(); ++it) {
+            if (canSkipScan(it->first)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool PlanEnumerator::skipScanPosition(IndexID idx, const string& path, size_t* pos) const {
+        if (!canSkipScan(idx)) {
+            return false;
+        }
+
+        BSONObjIterator it((*_indices)[idx].keyPattern);
+        it.next(); // the leading field, which we skip
+        for (size_t i = 1; it.more(); ++i) {
+            if (path == it.next().fieldName()) {
+                *pos = i;
+                return true;
+            }
+        }
+        return false;
     }
 
     void PlanEnumerator::enumerateAndIntersect(const IndexToPredMap& idxToFirst,
@@ -1154,7 +1229,8 @@ namespace mongo {
             PredicateAssignment* pa = assign->pred.get();
             verify(NULL == pa->expr->getTag());
             verify(pa->indexToAssign < pa->first.size());
-            pa->expr->setTag(new IndexTag(pa->first[pa->indexToAssign]));
+            const size_t pos = pa->positions.empty() ? 0 : pa->positions[pa->indexToAssign];
+            pa->expr->setTag(new IndexTag(pa->first[pa->indexToAssign], pos));
         }
         else if (NULL != assign->orAssignment) {
             OrAssignment* oa = assign->orAssignment.get();
@@ -43,6 +43,7 @@ namespace mongo {
     struct PlanEnumeratorParams {
 
         PlanEnumeratorParams() : intersect(false),
+                                 skipScan(false),
                                  maxSolutionsPerOr(internalQueryEnumerationMaxOrSolutions),
                                  maxIntersectPerAnd(internalQueryEnumerationMaxIntersectPerAnd) { }
 
@@ -50,6 +51,10 @@ namespace mongo {
         // an indexed solution?
         bool intersect;
 
+        // Do we assign predicates over non-leading fields to indices that can be skip scanned,
+        // when no index is prefixed by a predicate? See QueryPlannerIXSelect::canSkipScan.
+        bool skipScan;
+
         // Not owned here.
         MatchExpression* root;
 
@@ -178,6 +183,11 @@ namespace mongo {
             PredicateAssignment() : indexToAssign(0) { }
 
             std::vector<IndexID> first;
+
+            // Which field of each index in 'first' the predicate is over. Empty if they're all
+            // over the leading field, which is the case unless we're skip scanning.
+            std::vector<size_t> positions;
+
             // Not owned here.
             MatchExpression* expr;
 
@@ -403,6 +413,22 @@ namespace mongo {
          * Try to assign predicates in 'tryCompound' to 'thisIndex' as compound assignments.
          * Output the assignments in 'assign'.
          */
+        /**
+         * Returns true if we may skip scan the index 'idx'.
+         */
+        bool canSkipScan(IndexID idx) const;
+
+        /**
+         * Returns true if we may skip scan any of the indices in 'idxToNotFirst'.
+         */
+        bool canSkipScanAny(const IndexToPredMap& idxToNotFirst) const;
+
+        /**
+         * If we may skip scan the index 'idx' for a predicate over 'path', sets '*pos' to the
+         * position of 'path' in the index and returns true.
+         */
+        bool skipScanPosition(IndexID idx, const std::string& path, size_t* pos) const;
+
         void compound(const std::vector<MatchExpression*>& tryCompound,
                       const IndexEntry& thisIndex,
                       OneIndexAssignment* assign);
@@ -438,6 +464,9 @@ namespace mongo {
         // Do we output >1 index per AND (index intersection)?
         bool _ixisect;
 
+        // See PlanEnumeratorParams::skipScan.
+        bool _skipScan;
+
         // How many enumerations are we willing to produce from each OR?
         size_t _orLimit;
 
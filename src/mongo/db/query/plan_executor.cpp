@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/db/query/plan_executor.h"
 
 #include <boost/shared_ptr.hpp>
@@ -34,6 +36,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/exec/cached_plan.h"
+#include "mongo/db/exec/collection_scan.h"
 #include "mongo/db/exec/multi_plan.h"
 #include "mongo/db/exec/pipeline_proxy.h"
 #include "mongo/db/exec/plan_stage.h"
@@ -42,10 +45,16 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/db/query/query_samples.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/storage/record_fetcher.h"
 
+#include "mongo/util/log.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -75,8 +84,107 @@ namespace mongo {
             return NULL;
         }
 
+        /**
+         * Returns true if every stage in the tree rooted at 'root' implements
+         * PlanStage::workBatch().
+         */
+        bool treeSupportsWorkBatch(const PlanStage* root) {
+            if (!root->supportsWorkBatch()) {
+                return false;
+            }
+
+            vector<PlanStage*> children = root->getChildren();
+            for (size_t i = 0; i < children.size(); i++) {
+                if (!treeSupportsWorkBatch(children[i])) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
     }
 
+    /**
+     * Hands out the results of PlanStage::workBatch() one at a time, so that getNext() can treat
+     * a batched plan just like one it calls work() on.
+     */
+    class WorkBatchBuffer {
+        MONGO_DISALLOW_COPYING(WorkBatchBuffer);
+    public:
+        WorkBatchBuffer()
+            : _next(0),
+              _hasEndState(false),
+              _endState(PlanStage::NEED_TIME),
+              _endId(WorkingSet::INVALID_ID) { }
+
+        /**
+         * Returns the next buffered result, or the state that ended the last batch once all of
+         * its results have been returned. Asks 'root' for a new batch when there's nothing left.
+         */
+        PlanStage::StageState work(PlanStage* root, WorkingSetID* out) {
+            if (_next == _results.size()) {
+                if (!_hasEndState) {
+                    _results.clear();
+                    _next = 0;
+                    _endId = WorkingSet::INVALID_ID;
+                    _endState = root->workBatch(internalQueryExecWorkBatchSize,
+                                                &_results,
+                                                &_endId);
+                    _hasEndState = (PlanStage::ADVANCED != _endState &&
+                                    PlanStage::NEED_TIME != _endState);
+                }
+
+                if (_results.empty()) {
+                    if (!_hasEndState) {
+                        return PlanStage::NEED_TIME;
+                    }
+                    _hasEndState = false;
+                    *out = _endId;
+                    return _endState;
+                }
+            }
+
+            *out = _results[_next++];
+            return PlanStage::ADVANCED;
+        }
+
+        /**
+         * Returns true if there are no results or pending state left from the last batch.
+         */
+        bool empty() const {
+            return _next == _results.size() && !_hasEndState;
+        }
+
+        /**
+         * Buffered results are no longer protected by the stage that produced them, so we have
+         * to force-fetch any of them that refer to 'dl', as stages that buffer results do.
+         */
+        void invalidate(OperationContext* txn,
+                        WorkingSet* workingSet,
+                        const Collection* collection,
+                        const RecordId& dl) {
+            for (size_t i = _next; i < _results.size(); i++) {
+                WorkingSetMember* member = workingSet->get(_results[i]);
+                if (member->hasLoc() && member->loc == dl) {
+                    WorkingSetCommon::fetchAndInvalidateLoc(txn, member, collection);
+                }
+            }
+        }
+
+    private:
+        std::vector<WorkingSetID> _results;
+
+        // Index of the next result in _results to hand out.
+        size_t _next;
+
+        // The state that ended the last batch, if it was anything other than ADVANCED or
+        // NEED_TIME. It is returned once all of the batch's results have been.
+        bool _hasEndState;
+        PlanStage::StageState _endState;
+        WorkingSetID _endId;
+    };
+
     // static
     Status PlanExecutor::make(OperationContext* opCtx,
                               WorkingSet* ws,
@@ -157,7 +265,16 @@ namespace mongo {
           _root(rt),
           _ns(ns),
           _killed(false),
-          _yieldPolicy(new PlanYieldPolicy(this, YIELD_MANUAL)) {
+          _yieldPolicy(new PlanYieldPolicy(this, YIELD_MANUAL)),
+          _sampled(QuerySamples::shouldSample()) {
+        if (internalQueryExecWorkBatchSize > 0 && treeSupportsWorkBatch(_root.get())) {
+            _workBatch.reset(new WorkBatchBuffer());
+        }
+
+        if (NULL != _cq.get() && NULL != _collection && QueryShapeStats::isEnabled()) {
+            _shapeStats = _collection->infoCache()->getQueryShapeStats();
+        }
+
         // We may still need to initialize _ns from either _collection or _cq.
         if (!_ns.empty()) {
             // We already have an _ns set, so there's nothing more to do.
@@ -206,7 +323,39 @@ namespace mongo {
         return Status::OK();
     }
 
-    PlanExecutor::~PlanExecutor() { }
+    PlanExecutor::~PlanExecutor() {
+        if (_shapeStats) {
+            try {
+                PlanSummaryStats stats;
+                Explain::getSummaryStats(this, &stats);
+                _shapeStats->record(*_cq, stats, Explain::getPlanSummary(this));
+            }
+            catch (const DBException& ex) {
+                warning() << "couldn't record query shape statistics for " << _ns << causedBy(ex);
+            }
+        }
+
+        if (!_sampled) {
+            return;
+        }
+
+        try {
+            BSONObjBuilder sample;
+            sample.append("ns", _ns);
+            sample.appendDate("ts", jsTime());
+            if (NULL != _cq.get()) {
+                sample.append("query", _cq->getParsed().getFilter());
+            }
+            boost::scoped_ptr<PlanStageStats> stats(_root->getStats());
+            BSONObjBuilder stagesBob(sample.subobjStart("executionStages"));
+            Explain::statsToBSON(*stats, &stagesBob, ExplainCommon::EXEC_STATS);
+            stagesBob.doneFast();
+            QuerySamples::add(sample.obj());
+        }
+        catch (const DBException& ex) {
+            warning() << "couldn't record a query sample for " << _ns << causedBy(ex);
+        }
+    }
 
     // static
     std::string PlanExecutor::statestr(ExecState s) {
@@ -249,6 +398,35 @@ namespace mongo {
         return _opCtx;
     }
 
+    bool PlanExecutor::returnPinnedRecords() {
+        // Find a collection scan below stages that hand each result up as soon as they get it.
+        PlanStage* stage = _root.get();
+        while (stage->stageType() != STAGE_COLLSCAN) {
+            switch (stage->stageType()) {
+            case STAGE_LIMIT:
+            case STAGE_PROJECTION:
+            case STAGE_SHARDING_FILTER:
+            case STAGE_SKIP:
+                break;
+            default:
+                return false;
+            }
+
+            const std::vector<PlanStage*> children = stage->getChildren();
+            invariant(children.size() == 1U);
+            stage = children[0];
+        }
+
+        if (!static_cast<CollectionScan*>(stage)->returnPinnedRecords()) {
+            return false;
+        }
+
+        // Results handed out in batches would outlive the position they are pinned to.
+        invariant(!_workBatch || _workBatch->empty());
+        _workBatch.reset();
+        return true;
+    }
+
     void PlanExecutor::saveState() {
         if (!_killed) {
             _root->saveState();
@@ -297,7 +475,13 @@ namespace mongo {
     }
 
     void PlanExecutor::invalidate(OperationContext* txn, const RecordId& dl, InvalidationType type) {
-        if (!_killed) { _root->invalidate(txn, dl, type); }
+        if (!_killed) {
+            _root->invalidate(txn, dl, type);
+
+            if (_workBatch) {
+                _workBatch->invalidate(txn, _workingSet.get(), _collection, dl);
+            }
+        }
     }
 
     PlanExecutor::ExecState PlanExecutor::getNext(BSONObj* objOut, RecordId* dlOut) {
@@ -329,8 +513,9 @@ namespace mongo {
             //   1) The yield policy's timer elapsed, or
             //   2) some stage requested a yield due to a document fetch, or
             //   3) we need to yield and retry due to a WriteConflictException.
-            // In all cases, the actual yielding happens here.
-            if (_yieldPolicy->shouldYield()) {
+            // In all cases, the actual yielding happens here. Results left over from a batch are
+            // returned before yielding, since the stages that produced them have moved on.
+            if ((!_workBatch || _workBatch->empty()) && _yieldPolicy->shouldYield()) {
                 _yieldPolicy->yield(fetcher.get());
 
                 if (_killed) {
@@ -343,7 +528,8 @@ namespace mongo {
             fetcher.reset();
 
             WorkingSetID id = WorkingSet::INVALID_ID;
-            PlanStage::StageState code = _root->work(&id);
+            PlanStage::StageState code = _workBatch ? _workBatch->work(_root.get(), &id)
+                                                    : _root->work(&id);
 
             if (code != PlanStage::NEED_YIELD)
                 writeConflictsInARow = 0;
@@ -440,7 +626,7 @@ namespace mongo {
     }
 
     bool PlanExecutor::isEOF() {
-        return _killed || _root->isEOF();
+        return _killed || ((!_workBatch || _workBatch->empty()) && _root->isEOF());
     }
 
     void PlanExecutor::registerExec() {
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "mongo/base/status.h"
 #include "mongo/db/invalidation_type.h"
@@ -44,7 +45,9 @@ namespace mongo {
     class PlanExecutor;
     struct PlanStageStats;
     class PlanYieldPolicy;
+    class QueryShapeStats;
     class WorkingSet;
+    class WorkBatchBuffer;
 
     /**
      * A PlanExecutor is the abstraction that knows how to crank a tree of stages into execution.
@@ -227,6 +230,16 @@ namespace mongo {
         // Methods that just pass down to the PlanStage tree.
         //
 
+        /**
+         * If the plan ends in a collection scan whose results reach getNext() as they are, makes
+         * that scan return documents which point into the storage engine's buffers instead of
+         * copying each of them; see CollectionScan::returnPinnedRecords(). Returns true if it did.
+         *
+         * Only call this before the first getNext(), and only if the caller copies or discards an
+         * object returned by getNext() before calling getNext() or saveState() again.
+         */
+        bool returnPinnedRecords();
+
         /**
          * Save any state required to either
          * 1. hibernate waiting for a getMore, or
@@ -419,6 +432,19 @@ namespace mongo {
         // TODO make this a non-pointer member. This requires some header shuffling so that this
         // file includes plan_yield_policy.h rather than the other way around.
         const boost::scoped_ptr<PlanYieldPolicy> _yieldPolicy;
+
+        // Holds the results of the last PlanStage::workBatch() call on _root that haven't been
+        // returned yet. NULL unless every stage in the tree supports batched execution, in which
+        // case getNext() pulls results from here instead of calling work() on _root directly.
+        boost::scoped_ptr<WorkBatchBuffer> _workBatch;
+
+        // Whether the execution stats of this plan are kept in the QuerySamples buffer when it is
+        // destroyed.
+        const bool _sampled;
+
+        // The query shape statistics of _collection, which this plan adds to when it is
+        // destroyed. NULL if there is no canonical query or the statistics are turned off.
+        boost::shared_ptr<QueryShapeStats> _shapeStats;
     };
 
 }  // namespace mongo
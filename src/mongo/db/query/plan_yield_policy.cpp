@@ -30,11 +30,14 @@
 
 #include "mongo/db/query/plan_yield_policy.h"
 
+#include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_yield.h"
+#include "mongo/util/coarse_clock.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -42,17 +45,34 @@ namespace mongo {
         : _policy(policy),
           _forceYield(false),
           _elapsedTracker(internalQueryExecYieldIterations, internalQueryExecYieldPeriodMS),
+          _lastYieldMillis(CoarseClock::elapsedMillis()),
           _planYielding(exec) { }
 
     bool PlanYieldPolicy::shouldYield() {
         if (!allowedToYield()) return false;
-        invariant(!_planYielding->getOpCtx()->lockState()->inAWriteUnitOfWork());
+        OperationContext* opCtx = _planYielding->getOpCtx();
+        invariant(!opCtx->lockState()->inAWriteUnitOfWork());
         if (_forceYield) return true;
-        return _elapsedTracker.intervalHasElapsed();
+        if (!_elapsedTracker.intervalHasElapsed()) return false;
+
+        // Yielding costs a snapshot restore, which is wasted if nobody wants our locks.
+        const int uncontendedPeriodMS = internalQueryExecUncontendedYieldPeriodMS;
+        if (uncontendedPeriodMS <= 0 ||
+            getNumLockWaiters() > 0 ||
+            CoarseClock::elapsedMillis() - _lastYieldMillis >= uncontendedPeriodMS) {
+            return true;
+        }
+
+        // Notice a killOp as soon as if we had yielded.
+        if (_policy == PlanExecutor::YIELD_AUTO) {
+            opCtx->checkForInterrupt();
+        }
+        return false;
     }
 
     void PlanYieldPolicy::resetTimer() {
         _elapsedTracker.resetLastTime();
+        _lastYieldMillis = CoarseClock::elapsedMillis();
     }
 
     bool PlanYieldPolicy::yield(RecordFetcher* fetcher) {
@@ -60,6 +80,7 @@ namespace mongo {
         invariant(allowedToYield());
 
         _forceYield = false;
+        _lastYieldMillis = CoarseClock::elapsedMillis();
 
         OperationContext* opCtx = _planYielding->getOpCtx();
         invariant(opCtx);
@@ -88,6 +109,7 @@ namespace mongo {
                     invariant(!"WriteConflictException not allowed in saveState");
                 }
 
+                Timer yieldTimer;
                 if (_policy == PlanExecutor::WRITE_CONFLICT_RETRY_ONLY) {
                     // Just reset the snapshot. Leave all LockManager locks alone.
                     opCtx->recoveryUnit()->commitAndRestart();
@@ -96,6 +118,7 @@ namespace mongo {
                     // Release and reacquire locks.
                     QueryYield::yieldAllLocks(opCtx, fetcher);
                 }
+                opCtx->getCurOp()->debug().yieldMicros += yieldTimer.micros();
 
                 return _planYielding->restoreStateWithoutRetrying(opCtx);
             }
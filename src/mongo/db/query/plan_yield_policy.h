@@ -48,7 +48,8 @@ namespace mongo {
         /**
          * Used by YIELD_AUTO plan executors in order to check whether it is time to yield.
          * PlanExecutors give up their locks periodically in order to be fair to other
-         * threads.
+         * threads. While no other thread waits for a lock, they yield less often (see
+         * internalQueryExecUncontendedYieldPeriodMS), but still check for interruption.
          */
         bool shouldYield();
 
@@ -88,6 +89,9 @@ namespace mongo {
         bool _forceYield;
         ElapsedTracker _elapsedTracker;
 
+        // When this last yielded or reset its timer, as CoarseClock::elapsedMillis().
+        long long _lastYieldMillis;
+
         // The plan executor which this yield policy is responsible for yielding. Must
         // not outlive the plan executor.
         PlanExecutor* const _planYielding;
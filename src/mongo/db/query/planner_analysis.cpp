@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/util/log.h"
@@ -244,6 +245,18 @@ namespace mongo {
             }
         }
 
+        /**
+         * Lets every fetch in the tree rooted at 'root' read its input in RecordId order.
+         */
+        void setFetchesSortRecordIds(QuerySolutionNode* root) {
+            if (STAGE_FETCH == root->getType()) {
+                static_cast<FetchNode*>(root)->sortRecordIds = true;
+            }
+            for (size_t i = 0; i < root->children.size(); ++i) {
+                setFetchesSortRecordIds(root->children[i]);
+            }
+        }
+
         bool hasNode(QuerySolutionNode* root, StageType type) {
             if (type == root->getType()) {
                 return true;
@@ -381,6 +394,13 @@ namespace mongo {
         // get our sort order via ixscan blow-up.
         MergeSortNode* merge = new MergeSortNode();
         merge->sort = desiredSort;
+
+        // The scans exploded from one index scan have disjoint bounds, so unless the index is
+        // multikey no document is returned by two of them.
+        if (1 == leafNodes.size()
+            && !static_cast<IndexScanNode*>(leafNodes[0])->indexIsMultiKey) {
+            merge->dedup = false;
+        }
         for (size_t i = 0; i < leafNodes.size(); ++i) {
             IndexScanNode* isn = static_cast<IndexScanNode*>(leafNodes[i]);
             explodeScan(isn, desiredSort, fieldsToExplode[i], &merge->children);
@@ -465,6 +485,7 @@ namespace mongo {
         SortNode* sort = new SortNode();
         sort->pattern = sortObj;
         sort->query = query.getParsed().getFilter();
+        sort->allowDiskUse = query.getParsed().allowDiskUse();
         sort->children.push_back(solnRoot);
         solnRoot = sort;
         // When setting the limit on the sort, we need to consider both
@@ -477,6 +498,15 @@ namespace mongo {
             sort->limit = size_t(query.getParsed().getNumToReturn()) +
                           size_t(query.getParsed().getSkip());
 
+            // A text stage sorted by nothing but its score only has to produce the documents
+            // which can make it past the sort's limit.
+            QuerySolutionNode* sortChild = sort->children[0];
+            if (STAGE_TEXT == sortChild->getType()
+                && 1 == sortObj.nFields()
+                && LiteParsedQuery::isTextScoreMeta(sortObj.firstElement())) {
+                static_cast<TextNode*>(sortChild)->limit = sort->limit;
+            }
+
             // This is a SORT with a limit. The wire protocol has a single quantity
             // called "numToReturn" which could mean either limit or batchSize.
             // We have no idea what the client intended. One way to handle the ambiguity
@@ -745,6 +775,15 @@ namespace mongo {
             solnRoot = limit;
         }
 
+        // Without a sort, nothing depends on the order the fetched documents come out in, except
+        // for the distance order of near queries.
+        if (internalQueryFetchSortsRecordIds
+            && query.getParsed().getSort().isEmpty()
+            && !hasNode(solnRoot, STAGE_GEO_NEAR_2D)
+            && !hasNode(solnRoot, STAGE_GEO_NEAR_2DSPHERE)) {
+            setFetchesSortRecordIds(solnRoot);
+        }
+
         soln->root.reset(solnRoot);
         return soln.release();
     }
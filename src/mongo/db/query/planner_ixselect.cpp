@@ -121,6 +121,38 @@ namespace mongo {
         }
     }
 
+    // static
+    bool QueryPlannerIXSelect::canSkipScan(const IndexEntry& index) {
+        // Multikey indices can't compound predicates freely, and special indices don't build
+        // bounds field by field.
+        return INDEX_BTREE == index.type
+            && !index.multikey
+            && index.keyPattern.nFields() > 1;
+    }
+
+    // static
+    void QueryPlannerIXSelect::findSkipScanIndices(const unordered_set<string>& fields,
+                                                   const vector<IndexEntry>& allIndices,
+                                                   vector<IndexEntry>* out) {
+        for (size_t i = 0; i < allIndices.size(); ++i) {
+            if (!canSkipScan(allIndices[i])) {
+                continue;
+            }
+
+            BSONObjIterator it(allIndices[i].keyPattern);
+            if (fields.end() != fields.find(it.next().fieldName())) {
+                // Already relevant.
+                continue;
+            }
+            while (it.more()) {
+                if (fields.end() != fields.find(it.next().fieldName())) {
+                    out->push_back(allIndices[i]);
+                    break;
+                }
+            }
+        }
+    }
+
     // static
     bool QueryPlannerIXSelect::compatible(const BSONElement& elt,
                                           const IndexEntry& index,
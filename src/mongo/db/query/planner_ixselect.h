@@ -58,6 +58,20 @@ namespace mongo {
                                         const std::vector<IndexEntry>& indices,
                                         std::vector<IndexEntry>* out);
 
+        /**
+         * Returns true if the index can be scanned for predicates over its non-leading fields
+         * alone, skipping between the distinct values of the fields before them.
+         */
+        static bool canSkipScan(const IndexEntry& index);
+
+        /**
+         * Add to 'out' the indices which aren't prefixed by any of 'fields', but which we could
+         * skip scan because they have one of 'fields' after their leading field.
+         */
+        static void findSkipScanIndices(const unordered_set<std::string>& fields,
+                                        const std::vector<IndexEntry>& indices,
+                                        std::vector<IndexEntry>* out);
+
         /**
          * Return true if the index key pattern field 'elt' (which belongs to 'index') can be used
          * to answer the predicate 'node'.
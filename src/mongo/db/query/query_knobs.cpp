@@ -38,12 +38,20 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanEvaluationMaxResults, int, 101);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerUseIndexStatistics, bool, false);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryIndexStatisticsSampleSize, int, 500);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerStatisticsPruneRatio, double, 10.0);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheSize, int, 5000);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheBackgroundReplan, bool, false);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheWriteOpsBetweenFlush, int, 1000);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
@@ -58,14 +66,35 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableHashIntersection, bool, false);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerEnableSkipScan, bool, false);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, true);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecSortUseKeyStrings, bool, true);
+
     // Yield every 128 cycles or 10ms.
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
 
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecUncontendedYieldPeriodMS, int, 1000);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecWorkBatchSize, int, 64);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecDeleteBatchDocs, int, 64);
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecDeleteBatchBytes, int, 2 * 1024 * 1024);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryParallelScanThreads, int, 0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryFindPinnedRecords, bool, false);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryCompileMatchExpressions, bool, true);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryFetchSortsRecordIds, bool, false);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecReplacementDiffPercent, int, 50);
+
 }  // namespace mongo
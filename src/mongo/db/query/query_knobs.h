@@ -48,12 +48,27 @@ namespace mongo {
     // Do we give a big ranking bonus to intersection plans?
     extern bool internalQueryForceIntersectionPlans;
 
+    // Do we estimate the cost of candidate plans from sampled index statistics, and drop the
+    // ones that are clearly worse than the best before the trial period?
+    extern bool internalQueryPlannerUseIndexStatistics;
+
+    // How many index entries are sampled for the statistics of each index?
+    extern int internalQueryIndexStatisticsSampleSize;
+
+    // How many times the best plan's estimated cost must a candidate's be before it is dropped?
+    extern double internalQueryPlannerStatisticsPruneRatio;
+
     // Do we have ixisect on at all?
     extern bool internalQueryPlannerEnableIndexIntersection;
 
     // Do we use hash-based intersection for rooted $and queries?
     extern bool internalQueryPlannerEnableHashIntersection;
 
+    // Do we consider compound indices whose leading field the query doesn't constrain, when no
+    // index is prefixed by a queried field?  The index scan skips from one leading value to the
+    // next, and the plan is ranked against a collection scan.
+    extern bool internalQueryPlannerEnableSkipScan;
+
     //
     // plan cache
     //
@@ -69,6 +84,10 @@ namespace mongo {
     // and replanning?
     extern double internalQueryCacheEvictionRatio;
 
+    // If true, a query whose cached plan exceeds the eviction ratio keeps running the cached plan
+    // and the entry is replanned by a background thread, instead of the query replanning inline.
+    extern bool internalQueryCacheBackgroundReplan;
+
     // How many write ops should we allow in a collection before tossing all cache entries?
     extern int internalQueryCacheWriteOpsBetweenFlush;
 
@@ -98,10 +117,50 @@ namespace mongo {
 
     extern int internalQueryExecMaxBlockingSortBytes;
 
+    // Whether blocking and merging sorts encode each sort key once as a KeyString and compare
+    // the encoded bytes, instead of comparing the BSON sort keys field by field.
+    extern bool internalQueryExecSortUseKeyStrings;
+
     // Yield after this many "should yield?" checks.
     extern int internalQueryExecYieldIterations;
 
     // Yield if it's been at least this many milliseconds since we last yielded.
     extern int internalQueryExecYieldPeriodMS;
 
+    // When either of the above says to yield but no operation is waiting for a lock, keep running
+    // instead, up to this many milliseconds since the last yield. 0 always yields.
+    extern int internalQueryExecUncontendedYieldPeriodMS;
+
+    // How many units of work PlanExecutor asks for at a time from plans whose stages all support
+    // PlanStage::workBatch(). 0 always calls work() one result at a time.
+    extern int internalQueryExecWorkBatchSize;
+
+    // How many documents, and up to how many bytes of them, a multi delete deletes in one
+    // storage transaction. 1 deletes each document in its own transaction.
+    extern int internalQueryExecDeleteBatchDocs;
+    extern int internalQueryExecDeleteBatchBytes;
+
+    // How many threads count and aggregation $group use to scan a whole collection, when its
+    // record store can be split into several partitions. 0 or 1 always scans on one thread.
+    extern int internalQueryParallelScanThreads;
+
+    // Whether find and getMore copy the documents of a plain collection scan from the storage
+    // engine's buffers straight into the reply, instead of copying each one out first. See
+    // PlanExecutor::returnPinnedRecords().
+    extern bool internalQueryFindPinnedRecords;
+
+    // Whether collection scans and fetches match documents with a CompiledMatchExpression of
+    // their filter, when it can be compiled.
+    extern bool internalQueryCompileMatchExpressions;
+
+    // Whether fetches in plans with no required output order read each batch of their child's
+    // results in RecordId order, rather than index order, so that storage is read sequentially.
+    // Only has an effect on plans that run with PlanStage::workBatch().
+    extern bool internalQueryFetchSortsRecordIds;
+
+    // Replacement-style updates are logged as the $set and $unset operators that turn the old
+    // document into the new one, when those take under this percentage of the new document's
+    // size. 0 always logs the whole new document.
+    extern int internalQueryExecReplacementDiffPercent;
+
 }  // namespace mongo
@@ -216,6 +216,51 @@ namespace mongo {
         }
     }
 
+    /**
+     * Returns true if 'oil' is [MinKey, MaxKey], in either direction.
+     */
+    static bool isAllValues(const OrderedIntervalList& oil) {
+        if (1 != oil.intervals.size()) {
+            return false;
+        }
+        const Interval& ival = oil.intervals[0];
+        if (!ival.startInclusive || !ival.endInclusive) {
+            return false;
+        }
+        return (MinKey == ival.start.type() && MaxKey == ival.end.type())
+            || (MaxKey == ival.start.type() && MinKey == ival.end.type());
+    }
+
+    /**
+     * Returns true if the tree rooted at 'node' has an index scan which leaves the leading field
+     * of its index unbounded but bounds a later one.
+     */
+    static bool hasSkipScan(const QuerySolutionNode* node) {
+        if (STAGE_IXSCAN == node->getType()) {
+            const IndexBounds& bounds = static_cast<const IndexScanNode*>(node)->bounds;
+            if (bounds.isSimpleRange || bounds.fields.size() < 2) {
+                return false;
+            }
+
+            if (!isAllValues(bounds.fields[0])) {
+                return false;
+            }
+            for (size_t i = 1; i < bounds.fields.size(); ++i) {
+                if (!isAllValues(bounds.fields[i])) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        for (size_t i = 0; i < node->children.size(); ++i) {
+            if (hasSkipScan(node->children[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     QuerySolution* buildCollscanSoln(const CanonicalQuery& query,
                                      bool tailable,
                                      const QueryPlannerParams& params) {
@@ -524,6 +569,10 @@ namespace mongo {
 
         if (hintIndex.isEmpty()) {
             QueryPlannerIXSelect::findRelevantIndices(fields, params.indices, &relevantIndices);
+            if (internalQueryPlannerEnableSkipScan) {
+                QueryPlannerIXSelect::findSkipScanIndices(fields, params.indices,
+                                                          &relevantIndices);
+            }
         }
         else {
             // Sigh.  If the hint is specified it might be using the index name.
@@ -736,6 +785,7 @@ namespace mongo {
             // The enumerator spits out trees tagged with IndexTag(s).
             PlanEnumeratorParams enumParams;
             enumParams.intersect = params.options & QueryPlannerParams::INDEX_INTERSECTION;
+            enumParams.skipScan = internalQueryPlannerEnableSkipScan;
             enumParams.root = query.root();
             enumParams.indices = &relevantIndices;
 
@@ -910,7 +960,14 @@ namespace mongo {
         // No indexed plans?  We must provide a collscan if possible or else we can't run the query.
         bool collscanNeeded = (0 == out->size() && canTableScan);
 
-        if (possibleToCollscan && (collscanRequested || collscanNeeded)) {
+        // Skip scans are only faster than a collscan if the leading fields they skip over have
+        // few distinct values, which we can't tell here. Let the plan ranker decide.
+        bool collscanCompetes = canTableScan && !out->empty();
+        for (size_t i = 0; collscanCompetes && i < out->size(); ++i) {
+            collscanCompetes = hasSkipScan((*out)[i]->root.get());
+        }
+
+        if (possibleToCollscan && (collscanRequested || collscanNeeded || collscanCompetes)) {
             QuerySolution* collscan = buildCollscanSoln(query, false, params);
             if (NULL != collscan) {
                 SolutionCacheData* scd = new SolutionCacheData();
@@ -3366,6 +3366,78 @@ namespace {
                                 "{ixscan: {filter: null, pattern: {a: 1, b: 1}}}}}");
     }
 
+    //
+    // Skip scans of compound indices whose leading field isn't constrained.
+    //
+
+    TEST_F(QueryPlannerTest, SkipScanDisabledByDefault) {
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(fromjson("{b: 5}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanSingleField) {
+        bool oldEnableSkipScan = internalQueryPlannerEnableSkipScan;
+        internalQueryPlannerEnableSkipScan = true;
+
+        addIndex(BSON("a" << 1 << "b" << 1));
+        runQuery(fromjson("{b: 5}"));
+
+        // The collscan competes with the skip scan.
+        assertNumSolutions(2U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1}, "
+                                "bounds: {a: [['MinKey','MaxKey',true,true]], "
+                                "b: [[5,5,true,true]]}}}}}");
+
+        internalQueryPlannerEnableSkipScan = oldEnableSkipScan;
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanCompound) {
+        bool oldEnableSkipScan = internalQueryPlannerEnableSkipScan;
+        internalQueryPlannerEnableSkipScan = true;
+
+        addIndex(BSON("a" << 1 << "b" << 1 << "c" << 1));
+        runQuery(fromjson("{b: 5, c: {$gt: 1}}"));
+
+        assertNumSolutions(2U);
+        assertSolutionExists("{cscan: {dir: 1}}");
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {a: 1, b: 1, c: 1}, "
+                                "bounds: {a: [['MinKey','MaxKey',true,true]], "
+                                "b: [[5,5,true,true]], c: [[1,Infinity,false,true]]}}}}}");
+
+        internalQueryPlannerEnableSkipScan = oldEnableSkipScan;
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedWithPrefixIndex) {
+        bool oldEnableSkipScan = internalQueryPlannerEnableSkipScan;
+        internalQueryPlannerEnableSkipScan = true;
+
+        addIndex(BSON("a" << 1 << "b" << 1));
+        addIndex(BSON("b" << 1));
+        runQuery(fromjson("{b: 5}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{fetch: {filter: null, node: {ixscan: {pattern: {b: 1}}}}}");
+
+        internalQueryPlannerEnableSkipScan = oldEnableSkipScan;
+    }
+
+    TEST_F(QueryPlannerTest, SkipScanNotUsedWithMultikeyIndex) {
+        bool oldEnableSkipScan = internalQueryPlannerEnableSkipScan;
+        internalQueryPlannerEnableSkipScan = true;
+
+        addIndex(BSON("a" << 1 << "b" << 1), true);
+        runQuery(fromjson("{b: 5}"));
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{cscan: {dir: 1, filter: {b: 5}}}");
+
+        internalQueryPlannerEnableSkipScan = oldEnableSkipScan;
+    }
+
     //
     // Test bad input to query planner helpers.
     //
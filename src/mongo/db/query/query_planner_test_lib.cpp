@@ -266,7 +266,7 @@ namespace mongo {
             return geoObj == node->indexKeyPattern;
         }
         else if (STAGE_TEXT == trueSoln->getType()) {
-            // {text: {search: "somestr", language: "something", filter: {blah: 1}}}
+            // {text: {search: "somestr", language: "something", limit: 5, filter: {blah: 1}}}
             const TextNode* node = static_cast<const TextNode*>(trueSoln);
             BSONElement el = testSoln["text"];
             if (el.eoo() || !el.isABSONObj()) { return false; }
@@ -304,6 +304,13 @@ namespace mongo {
                 }
             }
 
+            BSONElement limitElt = textObj["limit"];
+            if (!limitElt.eoo()) {
+                if (!limitElt.isNumber() || size_t(limitElt.numberLong()) != node->limit) {
+                    return false;
+                }
+            }
+
             BSONElement filter = textObj["filter"];
             if (!filter.eoo()) {
                 if (filter.isNull()) {
@@ -340,4 +340,32 @@ namespace {
         assertSolutionExists("{text: {search: 'blah', caseSensitive: true}}");
     }
 
+
+    TEST_F(QueryPlannerTest, TextScoreSortLimitIsPushedToText) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'blah'}}"),
+                                  fromjson("{score: {$meta: 'textScore'}}"),
+                                  fromjson("{score: {$meta: 'textScore'}}"),
+                                  5, 10);
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{skip: {n: 5, node: "
+                                "{proj: {spec: {score: {$meta: 'textScore'}}, node: "
+                                    "{sort: {pattern: {score: {$meta: 'textScore'}}, limit: 15, "
+                                            "node: {text: {search: 'blah', limit: 15}}}}}}}}");
+    }
+
+    TEST_F(QueryPlannerTest, TextCompoundSortLimitIsNotPushedToText) {
+        addIndex(BSON("_fts" << "text" << "_ftsx" << 1));
+        runQuerySortProjSkipLimit(fromjson("{$text: {$search: 'blah'}}"),
+                                  fromjson("{score: {$meta: 'textScore'}, a: 1}"),
+                                  fromjson("{score: {$meta: 'textScore'}}"),
+                                  0, 10);
+
+        assertNumSolutions(1U);
+        assertSolutionExists("{proj: {spec: {score: {$meta: 'textScore'}}, node: "
+                                "{sort: {pattern: {score: {$meta: 'textScore'}, a: 1}, limit: 10, "
+                                        "node: {text: {search: 'blah', limit: 0}}}}}}");
+    }
+
 }  // namespace
@@ -0,0 +1,98 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_samples.h"
+
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_SERVER_PARAMETER(querySampleRate, double, 0.0);
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(querySampleBufferSize, int, 100);
+
+    namespace {
+
+        // Counts the plans considered for sampling, to pick one in every 1/querySampleRate.
+        AtomicUInt64 plansSeen;
+
+        boost::mutex samplesMutex;
+        std::deque<BSONObj> samples;
+
+    }  // namespace
+
+    // static
+    bool QuerySamples::shouldSample() {
+        const double rate = querySampleRate;
+        if (rate <= 0) {
+            return false;
+        }
+        if (rate >= 1) {
+            return true;
+        }
+
+        // Sample the plans at which the running total of the rate passes an integer.
+        const unsigned long long seen = plansSeen.fetchAndAdd(1);
+        return static_cast<unsigned long long>((seen + 1) * rate) >
+               static_cast<unsigned long long>(seen * rate);
+    }
+
+    // static
+    void QuerySamples::add(const BSONObj& sample) {
+        if (querySampleBufferSize <= 0) {
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> lk(samplesMutex);
+        while (samples.size() >= static_cast<size_t>(querySampleBufferSize)) {
+            samples.pop_front();
+        }
+        samples.push_back(sample.getOwned());
+    }
+
+    // static
+    void QuerySamples::appendSamples(BSONArrayBuilder* out) {
+        boost::lock_guard<boost::mutex> lk(samplesMutex);
+        for (std::deque<BSONObj>::const_iterator it = samples.begin(); it != samples.end(); ++it) {
+            out->append(*it);
+        }
+    }
+
+    // static
+    void QuerySamples::clear() {
+        boost::lock_guard<boost::mutex> lk(samplesMutex);
+        samples.clear();
+    }
+
+}  // namespace mongo
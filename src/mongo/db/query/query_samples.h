@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Keeps the execution stats of a sample of the query plans the server runs, so that slow
+     * queries can be diagnosed after the fact.  Samples are kept in a ring buffer of the most
+     * recent querySampleBufferSize plans.  The querySampleRate server parameter sets the fraction
+     * of plans sampled, and is 0 by default.
+     */
+    class QuerySamples {
+        MONGO_DISALLOW_COPYING(QuerySamples);
+    public:
+        /**
+         * Returns true if the plan executor being created should be sampled.  Cheap when
+         * sampling is off.
+         */
+        static bool shouldSample();
+
+        /**
+         * Adds a sample, evicting the oldest one if the buffer is full.
+         */
+        static void add(const BSONObj& sample);
+
+        /**
+         * Appends the samples in the buffer, oldest first, to 'out'.
+         */
+        static void appendSamples(BSONArrayBuilder* out);
+
+        /**
+         * Discards all the samples in the buffer.
+         */
+        static void clear();
+
+    private:
+        QuerySamples();
+    };
+
+}  // namespace mongo
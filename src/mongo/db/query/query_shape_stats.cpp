@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(queryShapeStatsMaxShapes, int, 100);
+
+    namespace {
+
+        typedef std::pair<const PlanCacheKey*, const QueryShapeStats::Entry*> KeyAndEntry;
+
+        bool takesLonger(const KeyAndEntry& lhs, const KeyAndEntry& rhs) {
+            return lhs.second->totalMicros > rhs.second->totalMicros;
+        }
+
+    }  // namespace
+
+    // static
+    bool QueryShapeStats::isEnabled() {
+        return queryShapeStatsMaxShapes > 0;
+    }
+
+    QueryShapeStats::QueryShapeStats()
+        : _entries(std::max(queryShapeStatsMaxShapes, 1)),
+          _evictions(0) { }
+
+    void QueryShapeStats::record(const CanonicalQuery& query,
+                                 const PlanSummaryStats& stats,
+                                 const std::string& planSummary) {
+        const PlanCacheKey key = PlanCache::computeKey(query);
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        Entry* entry;
+        if (_entries.get(key, &entry).isOK()) {
+            if (entry->lastPlanSummary != planSummary) {
+                entry->planChanges++;
+                entry->lastPlanSummary = planSummary;
+            }
+        }
+        else {
+            entry = new Entry();
+            entry->query = query.getParsed().getFilter().getOwned();
+            entry->sort = query.getParsed().getSort().getOwned();
+            entry->projection = query.getParsed().getProj().getOwned();
+            entry->lastPlanSummary = planSummary;
+            std::auto_ptr<Entry> evicted = _entries.add(key, entry);
+            if (evicted.get()) {
+                _evictions++;
+            }
+        }
+
+        entry->executions++;
+        entry->totalMicros += stats.executionTimeMicros;
+        entry->maxMicros = std::max(entry->maxMicros, stats.executionTimeMicros);
+        entry->keysExamined += stats.totalKeysExamined;
+        entry->docsExamined += stats.totalDocsExamined;
+        entry->nReturned += stats.nReturned;
+    }
+
+    void QueryShapeStats::append(BSONArrayBuilder* out) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
+        std::vector<KeyAndEntry> entries;
+        entries.reserve(_entries.size());
+        for (LRUKeyValue<PlanCacheKey, Entry>::KVListConstIt it = _entries.begin();
+             it != _entries.end();
+             ++it) {
+            entries.push_back(KeyAndEntry(&it->first, it->second));
+        }
+        std::stable_sort(entries.begin(), entries.end(), takesLonger);
+
+        for (std::vector<KeyAndEntry>::const_iterator it = entries.begin();
+             it != entries.end();
+             ++it) {
+            const Entry& entry = *it->second;
+            BSONObjBuilder bob(out->subobjStart());
+            bob.append("query", entry.query);
+            bob.append("sort", entry.sort);
+            bob.append("projection", entry.projection);
+            bob.append("executions", entry.executions);
+            bob.append("totalMicros", entry.totalMicros);
+            bob.append("maxMicros", entry.maxMicros);
+            bob.append("keysExamined", entry.keysExamined);
+            bob.append("docsExamined", entry.docsExamined);
+            bob.append("nReturned", entry.nReturned);
+            bob.append("planChanges", entry.planChanges);
+            bob.append("planSummary", entry.lastPlanSummary);
+            bob.doneFast();
+        }
+    }
+
+    long long QueryShapeStats::evictions() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _evictions;
+    }
+
+    void QueryShapeStats::clear() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _entries.clear();
+        _evictions = 0;
+    }
+
+}  // namespace mongo
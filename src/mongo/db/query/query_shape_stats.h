@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/mutex.hpp>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/lru_key_value.h"
+#include "mongo/db/query/plan_cache.h"
+
+namespace mongo {
+
+    class CanonicalQuery;
+    struct PlanSummaryStats;
+
+    /**
+     * Execution statistics of the queries run against one collection, added up by query shape.
+     * Shapes are told apart by their plan cache key. The table holds up to queryShapeStatsMaxShapes
+     * shapes, and makes room for a new one by dropping the one that ran longest ago.
+     *
+     * Plan executors with a canonical query add to it when they are destroyed, so a query that
+     * takes several batches is counted once, with the totals of all of them.
+     */
+    class QueryShapeStats {
+        MONGO_DISALLOW_COPYING(QueryShapeStats);
+    public:
+        struct Entry {
+            Entry() : executions(0),
+                      totalMicros(0),
+                      maxMicros(0),
+                      keysExamined(0),
+                      docsExamined(0),
+                      nReturned(0),
+                      planChanges(0) { }
+
+            // The first query seen with this shape.
+            BSONObj query;
+            BSONObj sort;
+            BSONObj projection;
+
+            long long executions;
+
+            // Time spent executing the plans, not counting the time between batches.
+            long long totalMicros;
+            long long maxMicros;
+
+            long long keysExamined;
+            long long docsExamined;
+            long long nReturned;
+
+            // The number of executions whose plan differed from the one before.
+            long long planChanges;
+            std::string lastPlanSummary;
+        };
+
+        /**
+         * Returns false if query shape statistics are turned off, by setting
+         * queryShapeStatsMaxShapes to 0.
+         */
+        static bool isEnabled();
+
+        QueryShapeStats();
+
+        /**
+         * Adds one execution of 'query' to the statistics of its shape.
+         */
+        void record(const CanonicalQuery& query,
+                    const PlanSummaryStats& stats,
+                    const std::string& planSummary);
+
+        /**
+         * Appends a document for each shape to 'out', the shapes that took the most time first.
+         */
+        void append(BSONArrayBuilder* out) const;
+
+        /**
+         * The number of shapes dropped to make room for others since the table was created or
+         * last cleared.
+         */
+        long long evictions() const;
+
+        void clear();
+
+    private:
+        mutable boost::mutex _mutex;
+        LRUKeyValue<PlanCacheKey, Entry> _entries;
+        long long _evictions;
+    };
+
+}  // namespace mongo
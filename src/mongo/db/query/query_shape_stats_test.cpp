@@ -0,0 +1,199 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <memory>
+
+#include "mongo/db/json.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/explain.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::auto_ptr;
+    using std::string;
+    using std::vector;
+
+    static const char* ns = "test.query_shape_stats";
+
+    CanonicalQuery* canonicalize(const string& queryStr,
+                                 const string& sortStr = "{}",
+                                 const string& projStr = "{}") {
+        CanonicalQuery* cq;
+        ASSERT_OK(CanonicalQuery::canonicalize(ns,
+                                               fromjson(queryStr),
+                                               fromjson(sortStr),
+                                               fromjson(projStr),
+                                               &cq));
+        return cq;
+    }
+
+    PlanSummaryStats makeStats(long long micros,
+                               size_t keysExamined,
+                               size_t docsExamined,
+                               size_t nReturned) {
+        PlanSummaryStats stats;
+        stats.executionTimeMicros = micros;
+        stats.totalKeysExamined = keysExamined;
+        stats.totalDocsExamined = docsExamined;
+        stats.nReturned = nReturned;
+        return stats;
+    }
+
+    vector<BSONObj> getShapes(const QueryShapeStats& shapeStats) {
+        BSONArrayBuilder arr;
+        shapeStats.append(&arr);
+        BSONObj shapes = arr.arr();
+        vector<BSONObj> out;
+        BSONObjIterator it(shapes);
+        while (it.more()) {
+            out.push_back(it.next().Obj().getOwned());
+        }
+        return out;
+    }
+
+    TEST(QueryShapeStatsTest, QueriesOfOneShapeAddUp) {
+        ASSERT(QueryShapeStats::isEnabled());
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> first(canonicalize("{a: 1, b: {$gt: 5}}", "{c: 1}"));
+        auto_ptr<CanonicalQuery> second(canonicalize("{a: 7, b: {$gt: 'x'}}", "{c: 1}"));
+        shapeStats.record(*first, makeStats(10, 3, 2, 1), "IXSCAN { a: 1 }");
+        shapeStats.record(*second, makeStats(30, 5, 4, 2), "IXSCAN { a: 1 }");
+
+        vector<BSONObj> shapes = getShapes(shapeStats);
+        ASSERT_EQUALS(shapes.size(), 1U);
+        const BSONObj& shape = shapes[0];
+        ASSERT_EQUALS(shape["query"].Obj(), fromjson("{a: 1, b: {$gt: 5}}"));
+        ASSERT_EQUALS(shape["sort"].Obj(), fromjson("{c: 1}"));
+        ASSERT_EQUALS(shape["projection"].Obj(), BSONObj());
+        ASSERT_EQUALS(shape["executions"].numberLong(), 2);
+        ASSERT_EQUALS(shape["totalMicros"].numberLong(), 40);
+        ASSERT_EQUALS(shape["maxMicros"].numberLong(), 30);
+        ASSERT_EQUALS(shape["keysExamined"].numberLong(), 8);
+        ASSERT_EQUALS(shape["docsExamined"].numberLong(), 6);
+        ASSERT_EQUALS(shape["nReturned"].numberLong(), 3);
+        ASSERT_EQUALS(shape["planChanges"].numberLong(), 0);
+        ASSERT_EQUALS(shape["planSummary"].String(), "IXSCAN { a: 1 }");
+    }
+
+    TEST(QueryShapeStatsTest, SortAndProjectionArePartOfTheShape) {
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> plain(canonicalize("{a: 1}"));
+        auto_ptr<CanonicalQuery> sorted(canonicalize("{a: 1}", "{b: -1}"));
+        auto_ptr<CanonicalQuery> projected(canonicalize("{a: 1}", "{}", "{_id: 0, a: 1}"));
+        shapeStats.record(*plain, makeStats(1, 0, 0, 0), "COLLSCAN");
+        shapeStats.record(*sorted, makeStats(1, 0, 0, 0), "COLLSCAN");
+        shapeStats.record(*projected, makeStats(1, 0, 0, 0), "COLLSCAN");
+        ASSERT_EQUALS(getShapes(shapeStats).size(), 3U);
+    }
+
+    TEST(QueryShapeStatsTest, ShapesThatTookLongestComeFirst) {
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> quick(canonicalize("{a: 1}"));
+        auto_ptr<CanonicalQuery> slow(canonicalize("{b: 1}"));
+        auto_ptr<CanonicalQuery> often(canonicalize("{c: 1}"));
+        shapeStats.record(*quick, makeStats(5, 0, 0, 0), "COLLSCAN");
+        shapeStats.record(*slow, makeStats(100, 0, 0, 0), "COLLSCAN");
+        for (int i = 0; i < 10; i++) {
+            shapeStats.record(*often, makeStats(6, 0, 0, 0), "COLLSCAN");
+        }
+
+        vector<BSONObj> shapes = getShapes(shapeStats);
+        ASSERT_EQUALS(shapes.size(), 3U);
+        ASSERT_EQUALS(shapes[0]["query"].Obj(), fromjson("{b: 1}"));
+        ASSERT_EQUALS(shapes[1]["query"].Obj(), fromjson("{c: 1}"));
+        ASSERT_EQUALS(shapes[1]["totalMicros"].numberLong(), 60);
+        ASSERT_EQUALS(shapes[1]["maxMicros"].numberLong(), 6);
+        ASSERT_EQUALS(shapes[2]["query"].Obj(), fromjson("{a: 1}"));
+    }
+
+    TEST(QueryShapeStatsTest, CountsPlanChanges) {
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1, b: 1}"));
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "IXSCAN { a: 1 }");
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "IXSCAN { a: 1 }");
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "IXSCAN { b: 1 }");
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "IXSCAN { a: 1 }");
+
+        vector<BSONObj> shapes = getShapes(shapeStats);
+        ASSERT_EQUALS(shapes.size(), 1U);
+        ASSERT_EQUALS(shapes[0]["executions"].numberLong(), 4);
+        ASSERT_EQUALS(shapes[0]["planChanges"].numberLong(), 2);
+        ASSERT_EQUALS(shapes[0]["planSummary"].String(), "IXSCAN { a: 1 }");
+    }
+
+    TEST(QueryShapeStatsTest, DropsLeastRecentlyRunShapeWhenFull) {
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> oldest(canonicalize("{field0: 1}"));
+        shapeStats.record(*oldest, makeStats(1000, 0, 0, 0), "COLLSCAN");
+
+        // The default limit is 100 shapes.
+        for (int i = 1; i < 100; i++) {
+            auto_ptr<CanonicalQuery> cq(
+                canonicalize(str::stream() << "{field" << i << ": 1}"));
+            shapeStats.record(*cq, makeStats(1, 0, 0, 0), "COLLSCAN");
+        }
+        ASSERT_EQUALS(getShapes(shapeStats).size(), 100U);
+        ASSERT_EQUALS(shapeStats.evictions(), 0);
+
+        // Running the oldest shape again keeps it in the table.
+        shapeStats.record(*oldest, makeStats(1000, 0, 0, 0), "COLLSCAN");
+        auto_ptr<CanonicalQuery> newest(canonicalize("{newField: 1}"));
+        shapeStats.record(*newest, makeStats(1, 0, 0, 0), "COLLSCAN");
+
+        vector<BSONObj> shapes = getShapes(shapeStats);
+        ASSERT_EQUALS(shapes.size(), 100U);
+        ASSERT_EQUALS(shapeStats.evictions(), 1);
+        ASSERT_EQUALS(shapes[0]["query"].Obj(), fromjson("{field0: 1}"));
+        ASSERT_EQUALS(shapes[0]["executions"].numberLong(), 2);
+        for (size_t i = 0; i < shapes.size(); i++) {
+            ASSERT_NOT_EQUALS(shapes[i]["query"].Obj(), fromjson("{field1: 1}"));
+        }
+    }
+
+    TEST(QueryShapeStatsTest, ClearRemovesEverything) {
+        QueryShapeStats shapeStats;
+        auto_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "COLLSCAN");
+        shapeStats.clear();
+        ASSERT(getShapes(shapeStats).empty());
+        ASSERT_EQUALS(shapeStats.evictions(), 0);
+
+        shapeStats.record(*cq, makeStats(1, 0, 0, 0), "COLLSCAN");
+        vector<BSONObj> shapes = getShapes(shapeStats);
+        ASSERT_EQUALS(shapes.size(), 1U);
+        ASSERT_EQUALS(shapes[0]["executions"].numberLong(), 1);
+    }
+
+}  // namespace
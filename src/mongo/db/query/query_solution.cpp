@@ -80,6 +80,10 @@ namespace mongo {
         *ss << "caseSensitive= " << caseSensitive << '\n';
         addIndent(ss, indent + 1);
         *ss << "indexPrefix = " << indexPrefix.toString() << '\n';
+        if (0 != limit) {
+            addIndent(ss, indent + 1);
+            *ss << "limit = " << limit << '\n';
+        }
         if (NULL != filter) {
             addIndent(ss, indent + 1);
             *ss << " filter = " << filter->toString();
@@ -97,6 +101,7 @@ namespace mongo {
         copy->language = this->language;
         copy->caseSensitive = this->caseSensitive;
         copy->indexPrefix = this->indexPrefix;
+        copy->limit = this->limit;
 
         return copy;
     }
@@ -365,11 +370,15 @@ namespace mongo {
     // FetchNode
     //
 
-    FetchNode::FetchNode() { }
+    FetchNode::FetchNode() : sortRecordIds(false) { }
 
     void FetchNode::appendToString(mongoutils::str::stream* ss, int indent) const {
         addIndent(ss, indent);
         *ss << "FETCH\n";
+        if (sortRecordIds) {
+            addIndent(ss, indent + 1);
+            *ss << "sortRecordIds = true\n";
+        }
         if (NULL != filter) {
             addIndent(ss, indent + 1);
             StringBuilder sb;
@@ -388,6 +397,7 @@ namespace mongo {
         cloneBaseData(copy);
 
         copy->_sorts = this->_sorts;
+        copy->sortRecordIds = this->sortRecordIds;
 
         return copy;
     }
@@ -645,6 +655,7 @@ namespace mongo {
         copy->pattern = this->pattern;
         copy->query = this->query;
         copy->limit = this->limit;
+        copy->allowDiskUse = this->allowDiskUse;
 
         return copy;
     }
@@ -218,7 +218,7 @@ namespace mongo {
     };
 
     struct TextNode : public QuerySolutionNode {
-        TextNode() { }
+        TextNode() : limit(0) { }
         virtual ~TextNode() { }
 
         virtual StageType getType() const { return STAGE_TEXT; }
@@ -245,6 +245,10 @@ namespace mongo {
         // text node while creating the text leaf node and convert them into a BSONObj index prefix
         // when we finish the text leaf node.
         BSONObj indexPrefix;
+
+        // If non-zero, the text node only needs to return the 'limit' best scoring documents,
+        // because its parent sorts by text score and keeps only that many.
+        size_t limit;
     };
 
     struct CollectionScanNode : public QuerySolutionNode {
@@ -382,6 +386,10 @@ namespace mongo {
         QuerySolutionNode* clone() const;
 
         BSONObjSet _sorts;
+
+        // True if the results don't need to come out in our child's order, so that each batch
+        // can be fetched in RecordId order.
+        bool sortRecordIds;
     };
 
     struct IndexScanNode : public QuerySolutionNode {
@@ -499,7 +507,7 @@ namespace mongo {
     };
 
     struct SortNode : public QuerySolutionNode {
-        SortNode() : limit(0) { }
+        SortNode() : limit(0), allowDiskUse(false) { }
         virtual ~SortNode() { }
 
         virtual StageType getType() const { return STAGE_SORT; }
@@ -530,6 +538,9 @@ namespace mongo {
 
         // Sum of both limit and skip count in the parsed query.
         size_t limit;
+
+        // Whether the sort may spill to disk rather than fail when it runs out of memory.
+        bool allowDiskUse;
     };
 
     struct LimitNode : public QuerySolutionNode {
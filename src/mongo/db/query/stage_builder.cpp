@@ -100,7 +100,18 @@ namespace mongo {
             const FetchNode* fn = static_cast<const FetchNode*>(root);
             PlanStage* childStage = buildStages(txn, collection, qsol, fn->children[0], ws);
             if (NULL == childStage) { return NULL; }
-            return new FetchStage(txn, ws, childStage, fn->filter.get(), collection);
+
+            // The fetch only needs RecordIds from a hashed AND, which lets it use less memory.
+            if (STAGE_AND_HASH == fn->children[0]->getType()
+                && NULL == fn->children[0]->filter.get()) {
+                static_cast<AndHashStage*>(childStage)->setRecordIdsOnly();
+            }
+
+            FetchStage* fetch = new FetchStage(txn, ws, childStage, fn->filter.get(), collection);
+            if (fn->sortRecordIds) {
+                fetch->setSortRecordIds();
+            }
+            return fetch;
         }
         else if (STAGE_SORT == root->getType()) {
             const SortNode* sn = static_cast<const SortNode*>(root);
@@ -111,6 +122,8 @@ namespace mongo {
             params.pattern = sn->pattern;
             params.query = sn->query;
             params.limit = sn->limit;
+            params.allowDiskUse = sn->allowDiskUse;
+            params.opCtx = txn;
             return new SortStage(params, ws, childStage);
         }
         else if (STAGE_PROJECTION == root->getType()) {
@@ -152,7 +165,7 @@ namespace mongo {
         }
         else if (STAGE_AND_HASH == root->getType()) {
             const AndHashNode* ahn = static_cast<const AndHashNode*>(root);
-            auto_ptr<AndHashStage> ret(new AndHashStage(ws, ahn->filter.get(), collection));
+            auto_ptr<AndHashStage> ret(new AndHashStage(txn, ws, ahn->filter.get(), collection));
             for (size_t i = 0; i < ahn->children.size(); ++i) {
                 PlanStage* childStage = buildStages(txn, collection, qsol, ahn->children[i], ws);
                 if (NULL == childStage) { return NULL; }
@@ -259,6 +272,7 @@ namespace mongo {
             params.index = index;
             params.spec = fam->getSpec();
             params.indexPrefix = node->indexPrefix;
+            params.limit = node->limit;
 
             const std::string& language = ("" == node->language
                                            ? fam->getSpec().defaultLanguage().str()
@@ -32,6 +32,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -72,6 +73,16 @@ namespace {
         container->erase(iter);
         return true;
     }
+
+    struct NSMatches {
+        explicit NSMatches(mongo::StringData ns) : ns(ns) {}
+
+        bool operator()(const mongo::RangeDeleteEntry* entry) const {
+            return entry->options.range.ns == ns;
+        }
+
+        const mongo::StringData ns;
+    };
 }
 
 namespace mongo {
@@ -189,9 +200,11 @@ namespace mongo {
 
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(stdx::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(size_t numWorkers) {
+        if (_workers.size() == 0) {
+            for (size_t i = 0; i < numWorkers; i++) {
+                _workers.create_thread(stdx::bind(&RangeDeleter::doWork, this));
+            }
         }
     }
 
@@ -201,9 +214,7 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
-        }
+        _workers.join_all();
 
         boost::unique_lock<boost::mutex> sl(_queueMutex);
         while (_deletesInProgress > 0) {
@@ -406,6 +417,16 @@ namespace {
         return result;
     }
 
+    void RangeDeleter::prioritizeDeletes(StringData ns) {
+        boost::lock_guard<boost::mutex> sl(_queueMutex);
+
+        // Stable, so the deletes keep their order within each namespace.
+        std::stable_partition(_taskQueue.begin(), _taskQueue.end(),
+                              NSMatches(ns));
+        std::stable_partition(_notReadyQueue.begin(), _notReadyQueue.end(),
+                              NSMatches(ns));
+    }
+
     void RangeDeleter::getStatsHistory(std::vector<DeleteJobStats*>* stats) const {
         stats->clear();
         stats->reserve(kDeleteJobsHistory);
@@ -451,7 +472,7 @@ namespace {
 
             {
                 boost::unique_lock<boost::mutex> sl(_queueMutex);
-                while (_taskQueue.empty()) {
+                while ((nextTask = takeNextTask_inlock()) == NULL) {
                     _taskQueueNotEmptyCV.timed_wait(
                         sl, duration::milliseconds(kNotEmptyTimeoutMillis));
 
@@ -460,55 +481,53 @@ namespace {
                         return;
                     }
 
-                    if (_taskQueue.empty()) {
-                        // Try to check if some deletes are ready and move them to the
-                        // ready queue.
-
-                        TaskList::iterator iter = _notReadyQueue.begin();
-                        while (iter != _notReadyQueue.end()) {
-                            RangeDeleteEntry* entry = *iter;
-
-                            set<CursorId> cursorsNow;
-                            {
-                                if (entry->options.waitForOpenCursors) {
-                                    _env->getCursorIds(txn.get(),
-                                                       entry->options.range.ns,
-                                                       &cursorsNow);
-                                }
-                            }
+                    // Try to check if some deletes are ready and move them to the
+                    // ready queue.
 
-                            set<CursorId> cursorsLeft;
-                            std::set_intersection(entry->cursorsToWait.begin(),
-                                                  entry->cursorsToWait.end(),
-                                                  cursorsNow.begin(),
-                                                  cursorsNow.end(),
-                                                  std::inserter(cursorsLeft,
-                                                                cursorsLeft.end()));
-
-                            entry->cursorsToWait.swap(cursorsLeft);
-
-                            if (entry->cursorsToWait.empty()) {
-                               (*iter)->stats.queueEndTS = jsTime();
-                                _taskQueue.push_back(*iter);
-                                _taskQueueNotEmptyCV.notify_one();
-                                iter = _notReadyQueue.erase(iter);
-                            }
-                            else {
-                                logCursorsWaiting(entry);
-                                ++iter;
+                    TaskList::iterator iter = _notReadyQueue.begin();
+                    while (iter != _notReadyQueue.end()) {
+                        RangeDeleteEntry* entry = *iter;
+
+                        set<CursorId> cursorsNow;
+                        {
+                            if (entry->options.waitForOpenCursors) {
+                                _env->getCursorIds(txn.get(),
+                                                   entry->options.range.ns,
+                                                   &cursorsNow);
                             }
                         }
+
+                        set<CursorId> cursorsLeft;
+                        std::set_intersection(entry->cursorsToWait.begin(),
+                                              entry->cursorsToWait.end(),
+                                              cursorsNow.begin(),
+                                              cursorsNow.end(),
+                                              std::inserter(cursorsLeft,
+                                                            cursorsLeft.end()));
+
+                        entry->cursorsToWait.swap(cursorsLeft);
+
+                        if (entry->cursorsToWait.empty()) {
+                           (*iter)->stats.queueEndTS = jsTime();
+                            _taskQueue.push_back(*iter);
+                            _taskQueueNotEmptyCV.notify_one();
+                            iter = _notReadyQueue.erase(iter);
+                        }
+                        else {
+                            logCursorsWaiting(entry);
+                            ++iter;
+                        }
                     }
                 }
 
                 if (stopRequested()) {
+                    // Leave the task queued, it is cleaned up along with this deleter.
+                    _taskQueue.push_front(nextTask);
+                    _workerNamespaces.erase(nextTask->options.range.ns);
                     log() << "stopping range deleter worker" << endl;
                     return;
                 }
 
-                nextTask = _taskQueue.front();
-                _taskQueue.pop_front();
-
                 _deletesInProgress++;
             }
 
@@ -543,10 +562,18 @@ namespace {
                                   nextTask->options.range.maxKey);
                 deletePtrElement(&_deleteSet, &setEntry);
                 _deletesInProgress--;
+                _workerNamespaces.erase(nextTask->options.range.ns);
+
+                if (_deletesInProgress == 0) {
+                    _nothingInProgressCV.notify_one();
+                }
 
                 if (nextTask->notifyDone) {
                     nextTask->notifyDone->notifyOne();
                 }
+
+                // Other workers may be waiting for deletes of this namespace.
+                _taskQueueNotEmptyCV.notify_all();
             }
 
             recordDelStats(new DeleteJobStats(nextTask->stats));
@@ -555,6 +582,18 @@ namespace {
         }
     }
 
+    RangeDeleteEntry* RangeDeleter::takeNextTask_inlock() {
+        for (TaskList::iterator iter = _taskQueue.begin(); iter != _taskQueue.end(); ++iter) {
+            RangeDeleteEntry* entry = *iter;
+            if (_workerNamespaces.insert(entry->options.range.ns).second) {
+                _taskQueue.erase(iter);
+                return entry;
+            }
+        }
+
+        return NULL;
+    }
+
     bool RangeDeleter::canEnqueue_inlock(StringData ns,
                                          const BSONObj& min,
                                          const BSONObj& max,
@@ -580,6 +619,18 @@ namespace {
         return _deleteSet.size();
     }
 
+    size_t RangeDeleter::getTotalDeletes(StringData ns) const {
+        boost::lock_guard<boost::mutex> sl(_queueMutex);
+
+        size_t count = 0;
+        for (NSMinMaxSet::const_iterator it = _deleteSet.begin(); it != _deleteSet.end(); ++it) {
+            if ((*it)->ns == ns) {
+                count++;
+            }
+        }
+        return count;
+    }
+
     size_t RangeDeleter::getPendingDeletes() const {
         boost::lock_guard<boost::mutex> sl(_queueMutex);
         return _notReadyQueue.size() + _taskQueue.size();
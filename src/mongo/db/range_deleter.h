@@ -61,9 +61,11 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has a configurable number of worker threads attacking the queue, each
+     *   working on one job at a time. Workers never work on two queued jobs of the same
+     *   namespace at once, so concurrent jobs are always on different collections. If we want
+     *   an immediate deletion, that job is going to be performed on the thread that is
+     *   requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -96,15 +98,15 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts numWorkers background threads to work on this queue. Does nothing if the
+         * worker threads are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(size_t numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -152,6 +154,12 @@ namespace mongo {
                        const RangeDeleterOptions& options,
                        std::string* errMsg);
 
+        /**
+         * Moves the queued deletes for the given namespace ahead of the deletes for all other
+         * namespaces, for example because they keep new chunks of it from being migrated here.
+         */
+        void prioritizeDeletes(StringData ns);
+
         //
         // Introspection methods
         //
@@ -160,6 +168,8 @@ namespace mongo {
         void getStatsHistory(std::vector<DeleteJobStats*>* stats) const;
 
         size_t getTotalDeletes() const;
+        // Same as above, restricted to the deletes for the given namespace.
+        size_t getTotalDeletes(StringData ns) const;
         size_t getPendingDeletes() const;
         size_t getDeletesInProgress() const;
 
@@ -186,9 +196,15 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /**
+         * Removes from _taskQueue and returns the first task for a namespace that no other
+         * worker is deleting from, or returns NULL if there is no such task.
+         */
+        RangeDeleteEntry* takeNextTask_inlock();
+
         /** Returns true if the range doesn't intersect with one other range */
         bool canEnqueue_inlock(StringData ns,
                                const BSONObj& min,
@@ -201,7 +217,7 @@ namespace mongo {
         boost::scoped_ptr<RangeDeleterEnv> _env;
 
         // Initially not active. Must be started explicitly.
-        boost::scoped_ptr<boost::thread> _worker;
+        boost::thread_group _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -240,6 +256,9 @@ namespace mongo {
         // Keeps track of number of tasks that are in progress, including the inline deletes.
         size_t _deletesInProgress;
 
+        // Namespaces of the queued deletes that workers are currently working on.
+        std::set<std::string> _workerNamespaces;
+
         // Protects _statsHistory
         mutable mutex _statsHistoryMutex;
         std::deque<DeleteJobStats*> _statsHistory;
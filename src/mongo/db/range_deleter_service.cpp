@@ -28,8 +28,11 @@
 
 #include "mongo/db/range_deleter_service.h"
 
+#include <algorithm>
+
 #include "mongo/base/init.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/server_parameters.h"
 
 namespace {
 
@@ -38,6 +41,10 @@ namespace {
 
 namespace mongo {
 
+    // Number of threads working on queued range deletes; deletes for different collections
+    // run concurrently when this is more than one.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(rangeDeleterWorkers, int, 1);
+
     MONGO_INITIALIZER(RangeDeleterInit)(InitializerContext* context) {
         _deleter = new RangeDeleter(new RangeDeleterDBEnv);
         return Status::OK();
@@ -46,4 +53,8 @@ namespace mongo {
     RangeDeleter* getDeleter() {
         return _deleter;
     }
+
+    void startDeleterWorkers() {
+        _deleter->startWorkers(std::max(rangeDeleterWorkers, 1));
+    }
 }
@@ -36,4 +36,9 @@ namespace mongo {
      * Gets the global instance of the deleter and starts it.
      */
     RangeDeleter* getDeleter();
+
+    /**
+     * Starts the workers of the global deleter, as many as the rangeDeleterWorkers parameter.
+     */
+    void startDeleterWorkers();
 }
@@ -38,6 +38,7 @@
 #include "mongo/db/write_concern_options.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace {
 
@@ -404,4 +405,141 @@ namespace {
         mongo::repl::setGlobalReplicationCoordinator(NULL);
     }
 
+    // Tests that several workers delete ranges of different namespaces at the same time, but
+    // never two ranges of the same namespace.
+    TEST(QueuedDelete, ConcurrentWorkersDifferentNamespaces) {
+        const string ns1("test.user");
+        const string ns2("test.other");
+
+        boost::scoped_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+            new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+        mongo::repl::setGlobalReplicationCoordinator(mock.get());
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        deleter.startWorkers(3);
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns1,
+                                                                     BSON("x" << 0),
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone1,
+                                        NULL /* errMsg not needed */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns1,
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 20),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone2,
+                                        NULL /* errMsg not needed */));
+
+        Notification notifyDone3;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns2,
+                                                                     BSON("x" << 0),
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone3,
+                                        NULL /* errMsg not needed */));
+
+        // Both namespaces are being worked on, while the second range of ns1 has to wait even
+        // though there is an idle worker.
+        env->waitForNthPausedDelete(2u);
+        ASSERT_EQUALS(2U, deleter.getDeletesInProgress());
+        ASSERT_EQUALS(1U, deleter.getPendingDeletes());
+        ASSERT_EQUALS(2U, deleter.getTotalDeletes(ns1));
+        ASSERT_EQUALS(1U, deleter.getTotalDeletes(ns2));
+
+        // Paused deletes are resumed one at a time, and deletes starting in between may not
+        // pause at all, so keep resuming until everything is done.
+        while (deleter.getTotalDeletes() > 0) {
+            env->resumeOneDelete();
+            mongo::sleepmillis(10);
+        }
+
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+        notifyDone3.waitToBeNotified();
+
+        ASSERT_EQUALS(0U, deleter.getTotalDeletes());
+
+        deleter.stopWorkers();
+
+        mongo::repl::setGlobalReplicationCoordinator(NULL);
+    }
+
+    // Tests that prioritized namespaces have their queued deletes performed before the ones
+    // queued earlier for other namespaces.
+    TEST(QueuedDelete, PrioritizeNamespace) {
+        const string ns("test.user");
+        const string priorityNS("test.priority");
+
+        boost::scoped_ptr<mongo::repl::ReplicationCoordinatorMock> mock(
+            new mongo::repl::ReplicationCoordinatorMock(replSettings));
+
+        mongo::repl::setGlobalReplicationCoordinator(mock.get());
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+
+        deleter.startWorkers();
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns,
+                                                                     BSON("x" << 0),
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone1,
+                                        NULL /* errMsg not needed */));
+
+        env->waitForNthPausedDelete(1u);
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(ns,
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 20),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone2,
+                                        NULL /* errMsg not needed */));
+
+        Notification notifyDone3;
+        ASSERT_TRUE(deleter.queueDelete(noTxn,
+                                        RangeDeleterOptions(KeyRange(priorityNS,
+                                                                     BSON("x" << 0),
+                                                                     BSON("x" << 10),
+                                                                     BSON("x" << 1))),
+                                        &notifyDone3,
+                                        NULL /* errMsg not needed */));
+
+        deleter.prioritizeDeletes(priorityNS);
+
+        env->resumeOneDelete();
+        notifyDone1.waitToBeNotified();
+
+        env->waitForNthPausedDelete(2u);
+        env->resumeOneDelete();
+        notifyDone3.waitToBeNotified();
+
+        DeletedRange deleted(env->getLastDelete());
+        ASSERT_EQUALS(priorityNS, deleted.ns);
+        ASSERT_EQUALS(1U, deleter.getPendingDeletes());
+
+        env->resumeOneDelete();
+        notifyDone2.waitToBeNotified();
+
+        deleter.stopWorkers();
+
+        mongo::repl::setGlobalReplicationCoordinator(NULL);
+    }
+
 } // unnamed namespace
@@ -45,10 +45,12 @@
 #include "mongo/db/repl/replication_coordinator_impl.h"
 #include "mongo/db/repl/rs_rollback.h"
 #include "mongo/db/repl/rs_sync.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -60,6 +62,36 @@ namespace {
     const char hashFieldName[] = "h";
     int SleepToAllowBatchingMillis = 2;
     const int BatchIsSmallish = 40000; // bytes
+
+    // Stream the oplog from the sync source with QueryOption_Exhaust: the sync source sends each
+    // batch as soon as the previous one is sent instead of waiting for a getMore, which saves a
+    // round trip per batch.  TCP flow control stops it when the buffer below is full.
+    MONGO_EXPORT_SERVER_PARAMETER(replOplogFetchExhaust, bool, true);
+
+    // The most oplog entries, in bytes, fetched ahead of the applier.  Changes take effect at the
+    // next batch.
+    int replBufferMaxSizeBytes = 256 * 1024 * 1024;
+
+    class ReplBufferMaxSizeBytesParameter : public ExportedServerParameter<int> {
+    public:
+        ReplBufferMaxSizeBytesParameter()
+            : ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                           "replBufferMaxSizeBytes",
+                                           &replBufferMaxSizeBytes,
+                                           true, // Change at startup
+                                           true) {} // Change at runtime
+
+    protected:
+        virtual Status validate(const int& potentialNewValue) {
+            // The buffer must be able to hold any single oplog entry.
+            if (potentialNewValue < BSONObjMaxInternalSize) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "replBufferMaxSizeBytes must be at least "
+                                            << BSONObjMaxInternalSize);
+            }
+            return Status::OK();
+        }
+    } replBufferMaxSizeBytesParameter;
 } // namespace
 
     MONGO_FP_DECLARE(rsBgSyncProduce);
@@ -102,7 +134,7 @@ namespace {
         return static_cast<size_t>(o.objsize());
     }
 
-    BackgroundSync::BackgroundSync() : _buffer(bufferMaxSizeGauge, &getSize),
+    BackgroundSync::BackgroundSync() : _buffer(replBufferMaxSizeBytes, &getSize),
                                        _lastOpTimeFetched(std::numeric_limits<int>::max(),
                                                           0),
                                        _lastAppliedHash(0),
@@ -112,6 +144,7 @@ namespace {
                                        _replCoord(getGlobalReplicationCoordinator()),
                                        _initialSyncRequestedFlag(false),
                                        _indexPrefetchConfig(PREFETCH_ALL) {
+        bufferMaxSizeGauge = replBufferMaxSizeBytes;
     }
 
     BackgroundSync* BackgroundSync::get() {
@@ -250,6 +283,12 @@ namespace {
             _replCoord->signalUpstreamUpdater();
         }
 
+        int queryOptions = _syncSourceReader.getTailingQueryOptions() & ~QueryOption_Exhaust;
+        if (replOplogFetchExhaust) {
+            queryOptions |= QueryOption_Exhaust;
+        }
+        _syncSourceReader.setTailingQueryOptions(queryOptions);
+
         _syncSourceReader.tailingQueryGTE(rsOplogName.c_str(), lastOpTimeFetched);
 
         // if target cut connections between connecting and querying (for
@@ -258,6 +297,9 @@ namespace {
             return;
         }
 
+        // Otherwise the sync source keeps sending batches until the connection is closed.
+        ON_BLOCK_EXIT_OBJ(_syncSourceReader, &OplogReader::resetIfExhausting);
+
         if (_rollbackIfNeeded(txn, _syncSourceReader)) {
             stop();
             return;
@@ -269,8 +311,15 @@ namespace {
                 // (whenever we run out of items in the
                 // current cursor batch)
 
+                // Pick up changes to the buffer size.
+                if (_buffer.maxSize() != static_cast<size_t>(replBufferMaxSizeBytes)) {
+                    _buffer.setMaxSize(replBufferMaxSizeBytes);
+                    bufferMaxSizeGauge = replBufferMaxSizeBytes;
+                }
+
+                // A streaming sync source doesn't wait for us, so there is no point waiting.
                 int bs = _syncSourceReader.currentBatchMessageSize();
-                if( bs > 0 && bs < BatchIsSmallish ) {
+                if( bs > 0 && bs < BatchIsSmallish && !_syncSourceReader.isExhausting() ) {
                     // on a very low latency network, if we don't wait a little, we'll be 
                     // getting ops to write almost one at a time.  this will both be expensive
                     // for the upstream server as well as potentially defeating our parallel 
@@ -395,6 +444,11 @@ namespace {
 
         if (!r.more()) {
             try {
+                // The connection is only free once the cursor is gone.
+                r.resetCursor();
+                if (!r.conn()) {
+                    return true;
+                }
                 BSONObj theirLastOp = r.getLastOp(rsOplogName.c_str());
                 if (theirLastOp.isEmpty()) {
                     error() << "empty query result from " << hn << " oplog";
@@ -97,6 +97,9 @@ namespace {
                                              this,
                                              stdx::placeholders::_1,
                                              stdx::placeholders::_2)),
+          _maxActiveCollectionCloners(1),
+          _numActiveCollectionCloners(0),
+          _startCollectionClonerStatus(Status::OK()),
           // TODO: replace with executor database worker when it is available.
           _scheduleDbWorkFn(stdx::bind(&ReplicationExecutor::scheduleWorkWithGlobalExclusiveLock,
                                        _executor,
@@ -124,6 +127,8 @@ namespace {
         output << " database: " << _dbname;
         output << " listCollections filter" << _listCollectionsFilter;
         output << " active: " << _active;
+        output << " active collection cloners: " << _numActiveCollectionCloners
+               << " (max " << _maxActiveCollectionCloners << ")";
         output << " collection info objects (empty if listCollections is in progress): "
                << _collectionInfos.size();
         return output;
@@ -152,15 +157,34 @@ namespace {
     }
 
     void DatabaseCloner::cancel() {
+        std::vector<CollectionCloner*> startedCollectionCloners;
         {
             boost::lock_guard<boost::mutex> lk(_mutex);
 
             if (!_active) {
                 return;
             }
+
+            if (!_collectionCloners.empty()) {
+                for (auto i = _collectionCloners.begin(); i != _currentCollectionClonerIter; ++i) {
+                    startedCollectionCloners.push_back(&*i);
+                }
+            }
         }
 
         _listCollectionsFetcher.cancel();
+
+        // Collection cloners invoke _collectionClonerCallback, which takes _mutex.
+        for (auto&& collectionCloner : startedCollectionCloners) {
+            collectionCloner->cancel();
+        }
+    }
+
+    void DatabaseCloner::setMaxActiveCollectionCloners(size_t maxActiveCollectionCloners) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
+        invariant(maxActiveCollectionCloners > 0);
+        _maxActiveCollectionCloners = maxActiveCollectionCloners;
     }
 
     void DatabaseCloner::wait() {
@@ -279,21 +303,8 @@ namespace {
             collectionCloner.setScheduleDbWorkFn(_scheduleDbWorkFn);
         }
 
-        // Start first collection cloner.
         _currentCollectionClonerIter = _collectionCloners.begin();
-
-        LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
-
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace()
-                   << ": " << startStatus;
-            _work(startStatus);
-            return;
-        }
-
-        _active = true;
+        _startCollectionCloners_inlock();
     }
 
     void DatabaseCloner::_collectionClonerCallback(const Status& status,
@@ -301,30 +312,46 @@ namespace {
         boost::lock_guard<boost::mutex> lk(_mutex);
 
         _active = false;
+        invariant(_numActiveCollectionCloners > 0);
+        _numActiveCollectionCloners--;
 
         // Forward collection cloner result to caller.
         // Failure to clone a collection does not stop the database cloner
         // from cloning the rest of the collections in the listCollections result.
         _collectionWork(status, nss);
 
-        _currentCollectionClonerIter++;
+        _startCollectionCloners_inlock();
+    }
+
+    void DatabaseCloner::_startCollectionCloners_inlock() {
+        while (_startCollectionClonerStatus.isOK() &&
+               _numActiveCollectionCloners < _maxActiveCollectionCloners &&
+               _currentCollectionClonerIter != _collectionCloners.end()) {
+
+            CollectionCloner& collectionCloner = *_currentCollectionClonerIter;
 
-        LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+            LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
 
-        if (_currentCollectionClonerIter != _collectionCloners.end()) {
-            Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
+            ++_currentCollectionClonerIter;
+            _numActiveCollectionCloners++;
+
+            Status startStatus = _startCollectionCloner(collectionCloner);
             if (!startStatus.isOK()) {
                 LOG(1) << "    failed to start collection cloning on "
-                       << _currentCollectionClonerIter->getSourceNamespace()
+                       << collectionCloner.getSourceNamespace()
                        << ": " << startStatus;
-                _work(startStatus);
-                return;
+                _numActiveCollectionCloners--;
+                _startCollectionClonerStatus = startStatus;
             }
+        }
+
+        if (_numActiveCollectionCloners > 0) {
             _active = true;
             return;
         }
 
-        _work(Status::OK());
+        _active = false;
+        _work(_startCollectionClonerStatus);
     }
 
 } // namespace repl
@@ -118,6 +118,14 @@ namespace repl {
 
         void cancel() override;
 
+        /**
+         * Sets how many collection cloners may be active at the same time. Defaults to 1, which
+         * clones the collections one after another in listCollections order.
+         *
+         * Must be called before start().
+         */
+        void setMaxActiveCollectionCloners(size_t maxActiveCollectionCloners);
+
         //
         // Testing only functions below.
         //
@@ -152,6 +160,12 @@ namespace repl {
          */
         void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+        /**
+         * Starts collection cloners until there are _maxActiveCollectionCloners of them active or
+         * none are left to start. Calls _work once none are left and all have completed.
+         */
+        void _startCollectionCloners_inlock();
+
         // Not owned by us.
         ReplicationExecutor* _executor;
 
@@ -188,8 +202,17 @@ namespace repl {
         std::vector<NamespaceString> _collectionNamespaces;
 
         std::list<CollectionCloner> _collectionCloners;
+
+        // Next collection cloner to start.
         std::list<CollectionCloner>::iterator _currentCollectionClonerIter;
 
+        size_t _maxActiveCollectionCloners;
+        size_t _numActiveCollectionCloners;
+
+        // Set when a collection cloner could not be started. No further cloners are started and
+        // this is passed to _work once the active ones have completed.
+        Status _startCollectionClonerStatus;
+
         // Function for scheduling database work using the executor.
         CollectionCloner::ScheduleDbWorkFn _scheduleDbWorkFn;
 
@@ -501,4 +501,62 @@ namespace {
         }
     }
 
+    TEST_F(DatabaseClonerTest, CreateCollectionsInParallel) {
+        databaseCloner->setMaxActiveCollectionCloners(2);
+        ASSERT_OK(databaseCloner->start());
+
+        // Replace scheduleDbWork function so that all callbacks (including exclusive tasks)
+        // will run through network interface.
+        auto&& executor = getExecutor();
+        databaseCloner->setScheduleDbWorkFn([&](const ReplicationExecutor::CallbackFn& workFn) {
+            return executor.scheduleWork(workFn);
+        });
+
+        processNetworkResponse(createListCollectionsResponse(0, BSON_ARRAY(
+            BSON("name" << "a" << "options" << BSONObj()) <<
+            BSON("name" << "b" << "options" << BSONObj()) <<
+            BSON("name" << "c" << "options" << BSONObj()))));
+
+        // The first two collections are cloned at the same time.
+        auto net = getNet();
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noiA = net->getNextReadyRequest();
+        ASSERT_EQUALS(BSON("listIndexes" << "a"), noiA->getRequest().cmdObj);
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noiB = net->getNextReadyRequest();
+        ASSERT_EQUALS(BSON("listIndexes" << "b"), noiB->getRequest().cmdObj);
+        ASSERT_FALSE(net->hasReadyRequests());
+
+        // Collection "b" completing first makes room for "c".
+        scheduleNetworkResponse(noiB, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        finishProcessingNetworkResponse();
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+
+        ASSERT_EQUALS(1U, collectionWorkResults.size());
+        ASSERT_EQUALS(NamespaceString(dbname, "b").ns(), collectionWorkResults.front().second.ns());
+
+        ASSERT_TRUE(net->hasReadyRequests());
+        auto noiC = net->getNextReadyRequest();
+        ASSERT_EQUALS(BSON("listIndexes" << "c"), noiC->getRequest().cmdObj);
+
+        scheduleNetworkResponse(noiA, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        finishProcessingNetworkResponse();
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+
+        ASSERT_EQUALS(getDefaultStatus(), getStatus());
+        ASSERT_TRUE(databaseCloner->isActive());
+
+        scheduleNetworkResponse(noiC, createListIndexesResponse(0, BSON_ARRAY(idIndexSpec)));
+        finishProcessingNetworkResponse();
+        processNetworkResponse(createCursorResponse(0, BSONArray()));
+
+        ASSERT_OK(getStatus());
+        ASSERT_FALSE(databaseCloner->isActive());
+
+        ASSERT_EQUALS(3U, collectionWorkResults.size());
+        for (auto&& result : collectionWorkResults) {
+            ASSERT_OK(result.first);
+        }
+    }
+
 } // namespace
@@ -0,0 +1,720 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplication
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/network_interface_asio.h"
+
+#include <cstring>
+
+#include "mongo/client/constants.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/repl/network_interface_impl.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    void assembleRequest(const std::string& ns,
+                         BSONObj query,
+                         int nToReturn,
+                         int nToSkip,
+                         const BSONObj* fieldsToReturn,
+                         int queryOptions,
+                         Message& toSend);
+
+namespace repl {
+
+namespace {
+
+    // When false, all commands are run by the blocking NetworkInterfaceImpl.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replEventLoopNetworking, bool, true);
+
+    // 5 Minutes (Note: Must be larger than kMaxConnectionAge below)
+    const long long kCleanUpInterval = 5 * 60 * 1000;
+    const Seconds kMaxConnectionAge(30);
+
+    const size_t kHeaderSize = sizeof(MSGHEADER::Value);
+
+    /**
+     * Returns true if the idle connection "socket" was not closed by the other side.
+     */
+    bool isStillConnected(boost::asio::ip::tcp::socket* socket) {
+        boost::system::error_code ec;
+        socket->non_blocking(true, ec);
+        if (ec) {
+            return false;
+        }
+        char c;
+        const size_t n = socket->receive(boost::asio::buffer(&c, 1),
+                                         boost::asio::socket_base::message_peek,
+                                         ec);
+        socket->non_blocking(false, ec);
+        // An idle connection has nothing to read, so anything other than would_block means the
+        // connection was closed, or is out of sync.
+        return n == 0 && ec == boost::asio::error::would_block;
+    }
+
+    void closeSocket(boost::asio::ip::tcp::socket* socket) {
+        boost::system::error_code ec;
+        socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+        socket->close(ec);
+    }
+
+    /**
+     * Extracts the command result from the OP_REPLY "reply", which answered the message with id
+     * "requestId".
+     */
+    StatusWith<BSONObj> parseCommandReply(const std::vector<char>& reply, MSGID requestId) {
+        const MsgData::ConstView md(&reply[0]);
+        if (md.getOperation() != opReply || md.getResponseTo() != requestId) {
+            return StatusWith<BSONObj>(ErrorCodes::ProtocolError,
+                                       str::stream() << "Unexpected message with operation " <<
+                                       md.getOperation() << " in response to " << requestId);
+        }
+        QueryResult::View qr(const_cast<char*>(&reply[0]));
+        const int dataLen = md.getLen() - static_cast<int>(sizeof(QueryResult::Value));
+        if (qr.getNReturned() != 1 || dataLen < BSONObj::kMinBSONLength) {
+            return StatusWith<BSONObj>(ErrorCodes::ProtocolError,
+                                       str::stream() << "Command reply contains " <<
+                                       qr.getNReturned() << " documents");
+        }
+        const BSONObj obj(qr.data());
+        if (obj.objsize() > dataLen) {
+            return StatusWith<BSONObj>(ErrorCodes::ProtocolError,
+                                       "Command reply document is longer than the message");
+        }
+        if (qr.getResultFlags() & ResultFlag_ErrSet) {
+            const BSONElement code = obj["code"];
+            return StatusWith<BSONObj>(code.isNumber() ?
+                                           ErrorCodes::fromInt(code.numberInt()) :
+                                           ErrorCodes::UnknownError,
+                                       getErrField(obj).valuestrsafe());
+        }
+        return StatusWith<BSONObj>(obj.getOwned());
+    }
+
+} // namespace
+
+    /**
+     * State of a command run on the event loop.  Shared by the steps of the command, of which only
+     * the first to finish it has any effect.
+     */
+    struct NetworkInterfaceASIO::AsyncOp {
+        AsyncOp(boost::asio::io_service* io,
+                const ReplicationExecutor::CallbackHandle& theHandle,
+                const ReplicationExecutor::RemoteCommandRequest& theRequest,
+                const RemoteCommandCompletionFn& theOnFinish,
+                Date_t now) :
+            cbHandle(theHandle),
+            request(theRequest),
+            onFinish(theOnFinish),
+            resolver(*io),
+            timer(*io),
+            connectionCreationDate(0ULL),
+            reusedConnection(false),
+            retried(false),
+            received(false),
+            finished(false),
+            timedOut(false),
+            requestId(0),
+            scheduledDate(now),
+            startDate(0ULL) {}
+
+        ReplicationExecutor::CallbackHandle cbHandle;
+        ReplicationExecutor::RemoteCommandRequest request;
+        RemoteCommandCompletionFn onFinish;
+
+        boost::asio::ip::tcp::resolver resolver;
+        boost::asio::deadline_timer timer;
+        SocketPtr socket;
+        Date_t connectionCreationDate;
+
+        // Whether the connection came from the pool, and whether the command is on its second one.
+        bool reusedConnection;
+        bool retried;
+
+        // Whether any part of the reply was received.
+        bool received;
+
+        bool finished;
+        bool timedOut;
+
+        Message toSend;
+        MSGID requestId;
+        char header[kHeaderSize];
+        std::vector<char> reply;
+
+        // When startCommand() was called, and when the event loop started the command.
+        Date_t scheduledDate;
+        Date_t startDate;
+    };
+
+    NetworkInterfaceASIO::NetworkInterfaceASIO() :
+        _lastCleanUpTime(0ULL),
+        _blockingNet(new NetworkInterfaceImpl),
+        _isExecutorRunnable(false),
+        _inShutdown(false),
+        _numFinished(0),
+        _numTimedOut(0),
+        _numCanceled(0),
+        _numBlocking(0),
+        _numConnectionsCreated(0),
+        _totalQueueMillis(0),
+        _totalNetworkMillis(0) {}
+
+    NetworkInterfaceASIO::~NetworkInterfaceASIO() {}
+
+    std::string NetworkInterfaceASIO::getDiagnosticString() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        str::stream output;
+        output << "NetworkASIO";
+        output << " inShutdown:" << _inShutdown;
+        output << " inProgress:" << _inProgress.size();
+        output << " finished:" << _numFinished;
+        output << " timedOut:" << _numTimedOut;
+        output << " canceled:" << _numCanceled;
+        output << " connectionsCreated:" << _numConnectionsCreated;
+        output << " queueMillis:" << _totalQueueMillis;
+        output << " networkMillis:" << _totalNetworkMillis;
+        output << " execRunable:" << _isExecutorRunnable;
+        output << " blocking:" << _numBlocking << " (" << _blockingNet->getDiagnosticString() << ")";
+        return output;
+    }
+
+    void NetworkInterfaceASIO::startup() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        invariant(!_inShutdown);
+        if (_thread) {
+            return;
+        }
+        _blockingNet->startup();
+        _work.reset(new boost::asio::io_service::work(_io));
+        _thread.reset(new boost::thread(stdx::bind(&NetworkInterfaceASIO::_runEventLoop, this)));
+    }
+
+    void NetworkInterfaceASIO::shutdown() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        _inShutdown = true;
+        lk.unlock();
+
+        // Stopping the io service abandons the commands in progress, like the worker threads of
+        // NetworkInterfaceImpl do, as the executor is shutting down.
+        _work.reset();
+        _io.stop();
+        if (_thread) {
+            _thread->join();
+        }
+        _blockingNet->shutdown();
+
+        for (HostConnectionMap::iterator hostConns = _connections.begin();
+             hostConns != _connections.end();
+             ++hostConns) {
+            for (ConnectionList::iterator iter = hostConns->second.begin();
+                 iter != hostConns->second.end();
+                 ++iter) {
+                closeSocket(iter->socket.get());
+            }
+        }
+        _connections.clear();
+
+        lk.lock();
+        for (AsyncOpList::iterator iter = _inProgress.begin(); iter != _inProgress.end(); ++iter) {
+            if ((*iter)->socket) {
+                closeSocket((*iter)->socket.get());
+            }
+        }
+        _inProgress.clear();
+    }
+
+    void NetworkInterfaceASIO::_runEventLoop() {
+        setThreadName("ReplExecNetASIO");
+        LOG(1) << "thread starting";
+        _io.run();
+        LOG(1) << "thread shutting down";
+    }
+
+    void NetworkInterfaceASIO::signalWorkAvailable() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (!_isExecutorRunnable) {
+            _isExecutorRunnable = true;
+            _isExecutorRunnableCondition.notify_one();
+        }
+    }
+
+    void NetworkInterfaceASIO::waitForWork() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (!_isExecutorRunnable) {
+            _isExecutorRunnableCondition.wait(lk);
+        }
+        _isExecutorRunnable = false;
+    }
+
+    void NetworkInterfaceASIO::waitForWorkUntil(Date_t when) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (!_isExecutorRunnable) {
+            const Milliseconds waitTime(when - now());
+            if (waitTime <= Milliseconds(0)) {
+                break;
+            }
+            _isExecutorRunnableCondition.timed_wait(lk, waitTime);
+        }
+        _isExecutorRunnable = false;
+    }
+
+    Date_t NetworkInterfaceASIO::now() {
+        return curTimeMillis64();
+    }
+
+    bool NetworkInterfaceASIO::_needsBlockingNetwork() const {
+        if (!replEventLoopNetworking) {
+            return true;
+        }
+        if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+            return true;
+        }
+        const int sslMode = sslGlobalParams.sslMode.load();
+        return sslMode == SSLParams::SSLMode_preferSSL || sslMode == SSLParams::SSLMode_requireSSL;
+    }
+
+    void NetworkInterfaceASIO::startCommand(
+            const ReplicationExecutor::CallbackHandle& cbHandle,
+            const ReplicationExecutor::RemoteCommandRequest& request,
+            const RemoteCommandCompletionFn& onFinish) {
+        LOG(2) << "Scheduling " << request.cmdObj.firstElementFieldName() << " to " <<
+            request.target;
+        AsyncOpPtr op(new AsyncOp(&_io, cbHandle, request, onFinish, now()));
+        if (_needsBlockingNetwork()) {
+            _startBlockingCommand(op);
+            return;
+        }
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _inProgress.push_back(op);
+        }
+        _io.post(stdx::bind(&NetworkInterfaceASIO::_beginCommand, this, op));
+    }
+
+    void NetworkInterfaceASIO::_startBlockingCommand(const AsyncOpPtr& op) {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            ++_numBlocking;
+        }
+        _blockingNet->startCommand(op->cbHandle,
+                                   op->request,
+                                   stdx::bind(&NetworkInterfaceASIO::_finishBlockingCommand,
+                                              this,
+                                              op->onFinish,
+                                              stdx::placeholders::_1));
+    }
+
+    void NetworkInterfaceASIO::_finishBlockingCommand(const RemoteCommandCompletionFn& onFinish,
+                                                      const ResponseStatus& response) {
+        onFinish(response);
+        // The blocking network interface only wakes up the executor waiting on it, not on us.
+        signalWorkAvailable();
+    }
+
+    void NetworkInterfaceASIO::cancelCommand(const ReplicationExecutor::CallbackHandle& cbHandle) {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            for (AsyncOpList::iterator iter = _inProgress.begin();
+                 iter != _inProgress.end();
+                 ++iter) {
+                if ((*iter)->cbHandle == cbHandle) {
+                    _io.post(stdx::bind(&NetworkInterfaceASIO::_cancelCommand, this, *iter));
+                    return;
+                }
+            }
+        }
+        _blockingNet->cancelCommand(cbHandle);
+    }
+
+    void NetworkInterfaceASIO::_cancelCommand(const AsyncOpPtr& op) {
+        if (op->finished) {
+            return;
+        }
+        LOG(2) << "Canceled sending " << op->request.cmdObj.firstElementFieldName() << " to " <<
+            op->request.target;
+        _finishCommand(op, ResponseStatus(ErrorCodes::CallbackCanceled, "Callback canceled"));
+    }
+
+    void NetworkInterfaceASIO::_beginCommand(const AsyncOpPtr& op) {
+        if (op->finished) {
+            return;
+        }
+        const Date_t nowDate = now();
+        if (op->startDate == 0ULL) {
+            op->startDate = nowDate;
+        }
+
+        if (op->request.expirationDate != ReplicationExecutor::kNoExpirationDate) {
+            if (op->request.expirationDate <= nowDate) {
+                _finishCommand(op, ResponseStatus(
+                        ErrorCodes::ExceededTimeLimit,
+                        str::stream() << "Went to run command, but it was too late. "
+                        "Expiration was set to " <<
+                        dateToISOStringUTC(op->request.expirationDate)));
+                return;
+            }
+            if (!op->retried) {
+                op->timer.expires_from_now(Milliseconds(op->request.expirationDate - nowDate));
+                op->timer.async_wait(stdx::bind(&NetworkInterfaceASIO::_onTimeout,
+                                                this,
+                                                op,
+                                                stdx::placeholders::_1));
+            }
+        }
+
+        if (!op->retried) {
+            op->socket = _acquireConnection(op->request.target,
+                                            nowDate,
+                                            &op->connectionCreationDate);
+        }
+        if (op->socket) {
+            op->reusedConnection = true;
+            _sendCommand(op);
+            return;
+        }
+
+        op->reusedConnection = false;
+        op->socket.reset(new boost::asio::ip::tcp::socket(_io));
+        op->connectionCreationDate = nowDate;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            ++_numConnectionsCreated;
+        }
+        const boost::asio::ip::tcp::resolver::query query(
+                op->request.target.host(),
+                str::stream() << op->request.target.port());
+        op->resolver.async_resolve(query,
+                                   stdx::bind(&NetworkInterfaceASIO::_onResolve,
+                                              this,
+                                              op,
+                                              stdx::placeholders::_1,
+                                              stdx::placeholders::_2));
+    }
+
+    void NetworkInterfaceASIO::_onResolve(const AsyncOpPtr& op,
+                                          const boost::system::error_code& ec,
+                                          boost::asio::ip::tcp::resolver::iterator endpoints) {
+        if (op->finished) {
+            return;
+        }
+        if (ec) {
+            _failCommand(op, "resolve", ec);
+            return;
+        }
+        boost::asio::async_connect(*op->socket,
+                                   endpoints,
+                                   stdx::bind(&NetworkInterfaceASIO::_onConnect,
+                                              this,
+                                              op,
+                                              stdx::placeholders::_1));
+    }
+
+    void NetworkInterfaceASIO::_onConnect(const AsyncOpPtr& op,
+                                          const boost::system::error_code& ec) {
+        if (op->finished) {
+            return;
+        }
+        if (ec) {
+            _failCommand(op, "connect", ec);
+            return;
+        }
+        boost::system::error_code ignored;
+        op->socket->set_option(boost::asio::ip::tcp::no_delay(true), ignored);
+        _sendCommand(op);
+    }
+
+    void NetworkInterfaceASIO::_sendCommand(const AsyncOpPtr& op) {
+        op->toSend.reset();
+        assembleRequest(op->request.dbname + ".$cmd",
+                        op->request.cmdObj,
+                        -1,
+                        0,
+                        NULL,
+                        QueryOption_SlaveOk,
+                        op->toSend);
+        op->requestId = nextMessageId();
+        op->toSend.header().setId(op->requestId);
+        op->toSend.header().setResponseTo(0);
+
+        boost::asio::async_write(*op->socket,
+                                 boost::asio::buffer(op->toSend.singleData().view2ptr(),
+                                                     op->toSend.size()),
+                                 stdx::bind(&NetworkInterfaceASIO::_onSend,
+                                            this,
+                                            op,
+                                            stdx::placeholders::_1));
+    }
+
+    void NetworkInterfaceASIO::_onSend(const AsyncOpPtr& op, const boost::system::error_code& ec) {
+        if (op->finished) {
+            return;
+        }
+        if (ec) {
+            _failCommand(op, "send", ec);
+            return;
+        }
+        boost::asio::async_read(*op->socket,
+                                boost::asio::buffer(op->header, kHeaderSize),
+                                stdx::bind(&NetworkInterfaceASIO::_onReceiveHeader,
+                                           this,
+                                           op,
+                                           stdx::placeholders::_1));
+    }
+
+    void NetworkInterfaceASIO::_onReceiveHeader(const AsyncOpPtr& op,
+                                                const boost::system::error_code& ec) {
+        if (op->finished) {
+            return;
+        }
+        if (ec) {
+            _failCommand(op, "receive", ec);
+            return;
+        }
+        op->received = true;
+        const int len = MSGHEADER::ConstView(op->header).getMessageLength();
+        if (len < static_cast<int>(sizeof(QueryResult::Value)) ||
+                static_cast<size_t>(len) > MaxMessageSizeBytes) {
+            _finishCommand(op, ResponseStatus(ErrorCodes::ProtocolError,
+                                              str::stream() << "Invalid reply length " << len <<
+                                              " from " << op->request.target.toString()));
+            return;
+        }
+        op->reply.resize(len);
+        memcpy(&op->reply[0], op->header, kHeaderSize);
+        boost::asio::async_read(*op->socket,
+                                boost::asio::buffer(&op->reply[kHeaderSize], len - kHeaderSize),
+                                stdx::bind(&NetworkInterfaceASIO::_onReceiveBody,
+                                           this,
+                                           op,
+                                           stdx::placeholders::_1));
+    }
+
+    void NetworkInterfaceASIO::_onReceiveBody(const AsyncOpPtr& op,
+                                              const boost::system::error_code& ec) {
+        if (op->finished) {
+            return;
+        }
+        if (ec) {
+            _failCommand(op, "receive", ec);
+            return;
+        }
+        StatusWith<BSONObj> result = parseCommandReply(op->reply, op->requestId);
+        if (!result.isOK()) {
+            _finishCommand(op, ResponseStatus(result.getStatus()));
+            return;
+        }
+
+        // Servers that don't support the find and getMore commands are sent the legacy queries
+        // by the blocking network interface.
+        // TODO: Perform down conversion based on wire protocol version.
+        if (getStatusFromCommandResult(result.getValue()).code() == ErrorCodes::CommandNotFound) {
+            const StringData commandName = op->request.cmdObj.firstElement().fieldNameStringData();
+            if (commandName == "find" || commandName == "getMore") {
+                // Give the connection back without running the completion function.
+                using std::swap;
+                RemoteCommandCompletionFn onFinish;
+                swap(onFinish, op->onFinish);
+                _finishCommand(op, ResponseStatus(Response(result.getValue(), Milliseconds(0))));
+                op->onFinish = onFinish;
+                _startBlockingCommand(op);
+                return;
+            }
+        }
+
+        _finishCommand(op, ResponseStatus(Response(result.getValue(),
+                                                   Milliseconds(now() - op->startDate))));
+    }
+
+    void NetworkInterfaceASIO::_onTimeout(const AsyncOpPtr& op,
+                                          const boost::system::error_code& ec) {
+        if (op->finished || ec == boost::asio::error::operation_aborted) {
+            return;
+        }
+        op->timedOut = true;
+        _finishCommand(op, ResponseStatus(
+                ErrorCodes::ExceededTimeLimit,
+                str::stream() << "Operation timed out, request was " <<
+                op->request.getDiagnosticString()));
+    }
+
+    void NetworkInterfaceASIO::_failCommand(const AsyncOpPtr& op,
+                                            const std::string& context,
+                                            const boost::system::error_code& ec) {
+        if (op->reusedConnection && !op->received && !op->retried) {
+            LOG(2) << "Retrying " << op->request.cmdObj.firstElementFieldName() << " to " <<
+                op->request.target << " on a new connection after " << context << " error: " <<
+                ec.message();
+            closeSocket(op->socket.get());
+            op->socket.reset();
+            op->retried = true;
+            _beginCommand(op);
+            return;
+        }
+        _finishCommand(op, ResponseStatus(
+                ErrorCodes::HostUnreachable,
+                str::stream() << "Failed to " << context << " " <<
+                op->request.cmdObj.firstElementFieldName() << " to " <<
+                op->request.target.toString() << "; " << ec.message()));
+    }
+
+    void NetworkInterfaceASIO::_finishCommand(const AsyncOpPtr& op,
+                                              const ResponseStatus& response) {
+        invariant(!op->finished);
+        op->finished = true;
+
+        boost::system::error_code ignored;
+        op->timer.cancel(ignored);
+        op->resolver.cancel();
+
+        const Date_t finishDate = now();
+        if (op->socket) {
+            // Only connections which completed an exchange are in a state to be reused.
+            if (response.isOK() &&
+                    finishDate < op->connectionCreationDate +
+                                 kMaxConnectionAge.total_milliseconds()) {
+                _connections[op->request.target].push_front(PooledConnection(op->socket, op->connectionCreationDate));
+            }
+            else {
+                closeSocket(op->socket.get());
+            }
+            op->socket.reset();
+        }
+
+        const Date_t startDate = op->startDate == 0ULL ? finishDate : op->startDate;
+        const long long queueMillis = startDate - op->scheduledDate;
+        const long long networkMillis = finishDate - startDate;
+        LOG(2) << "Network status of sending " << op->request.cmdObj.firstElementFieldName() <<
+            " to " << op->request.target << " was " << response.getStatus() << "; queued " <<
+            queueMillis << "ms, on the network " << networkMillis << "ms";
+
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            ++_numFinished;
+            if (op->timedOut) {
+                ++_numTimedOut;
+            }
+            if (response.getStatus() == ErrorCodes::CallbackCanceled) {
+                ++_numCanceled;
+            }
+            _totalQueueMillis += queueMillis;
+            _totalNetworkMillis += networkMillis;
+            for (AsyncOpList::iterator iter = _inProgress.begin();
+                 iter != _inProgress.end();
+                 ++iter) {
+                if (*iter == op) {
+                    _inProgress.erase(iter);
+                    break;
+                }
+            }
+        }
+
+        if (op->onFinish) {
+            op->onFinish(response);
+            signalWorkAvailable();
+        }
+    }
+
+    NetworkInterfaceASIO::SocketPtr NetworkInterfaceASIO::_acquireConnection(
+            const HostAndPort& target,
+            Date_t now,
+            Date_t* creationDate) {
+        if (now > _lastCleanUpTime + kCleanUpInterval) {
+            _cleanUpConnections(now);
+        }
+
+        HostConnectionMap::iterator hostConns = _connections.find(target);
+        if (hostConns == _connections.end()) {
+            return SocketPtr();
+        }
+        while (!hostConns->second.empty()) {
+            PooledConnection conn = hostConns->second.front();
+            hostConns->second.pop_front();
+            if (now < conn.creationDate + kMaxConnectionAge.total_milliseconds() &&
+                    isStillConnected(conn.socket.get())) {
+                *creationDate = conn.creationDate;
+                return conn.socket;
+            }
+            closeSocket(conn.socket.get());
+        }
+        _connections.erase(hostConns);
+        return SocketPtr();
+    }
+
+    void NetworkInterfaceASIO::_cleanUpConnections(Date_t now) {
+        HostConnectionMap::iterator hostConns = _connections.begin();
+        while (hostConns != _connections.end()) {
+            ConnectionList::iterator iter = hostConns->second.begin();
+            while (iter != hostConns->second.end()) {
+                if (now < iter->creationDate + kMaxConnectionAge.total_milliseconds()) {
+                    ++iter;
+                }
+                else {
+                    closeSocket(iter->socket.get());
+                    hostConns->second.erase(iter++);
+                }
+            }
+            if (hostConns->second.empty()) {
+                _connections.erase(hostConns++);
+            }
+            else {
+                ++hostConns;
+            }
+        }
+        _lastCleanUpTime = now;
+    }
+
+    void NetworkInterfaceASIO::runCallbackWithGlobalExclusiveLock(
+            const stdx::function<void (OperationContext*)>& callback) {
+        Client::initThreadIfNotAlready();
+        OperationContextImpl txn;
+        ScopedTransaction transaction(&txn, MODE_X);
+        Lock::GlobalWrite lk(txn.lockState());
+        callback(&txn);
+    }
+
+}  // namespace repl
+} // namespace mongo
@@ -0,0 +1,205 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "mongo/db/repl/replication_executor.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/stdx/list.h"
+#include "mongo/util/net/hostandport.h"
+
+namespace mongo {
+namespace repl {
+
+    class NetworkInterfaceImpl;
+
+    /**
+     * Implementation of the network interface used by the ReplicationExecutor inside mongod, which
+     * runs remote commands with non-blocking sockets driven by a single event loop thread.
+     *
+     * Each command acquires a connection to its target from a pool of idle connections, or opens
+     * a new one, writes the command, and reads the reply, without ever blocking the event loop.
+     * A slow or unreachable member therefore only delays the commands sent to it, and a command's
+     * expiration date is enforced with a timer, which closes its connection instead of keeping a
+     * thread waiting on the socket.  As with NetworkInterfaceImpl, connections are retired
+     * unconditionally after they have been connected for a certain maximum period.
+     *
+     * The event loop does not speak internal authentication or SSL, nor downconvert find and
+     * getMore commands for servers which don't support them.  Those commands are handed to a
+     * NetworkInterfaceImpl owned by this interface, which runs them in its worker threads.
+     *
+     * The time each command waited to be started by the event loop and the time it spent on the
+     * network are logged at log level 2, and their totals are part of the diagnostic string.
+     */
+    class NetworkInterfaceASIO : public ReplicationExecutor::NetworkInterface {
+    public:
+        NetworkInterfaceASIO();
+        virtual ~NetworkInterfaceASIO();
+        virtual std::string getDiagnosticString();
+        virtual void startup();
+        virtual void shutdown();
+        virtual void waitForWork();
+        virtual void waitForWorkUntil(Date_t when);
+        virtual void signalWorkAvailable();
+        virtual Date_t now();
+        virtual void startCommand(
+                const ReplicationExecutor::CallbackHandle& cbHandle,
+                const ReplicationExecutor::RemoteCommandRequest& request,
+                const RemoteCommandCompletionFn& onFinish);
+        virtual void cancelCommand(const ReplicationExecutor::CallbackHandle& cbHandle);
+        virtual void runCallbackWithGlobalExclusiveLock(
+                const stdx::function<void (OperationContext*)>& callback);
+
+    private:
+        struct AsyncOp;
+        typedef boost::shared_ptr<AsyncOp> AsyncOpPtr;
+        typedef boost::shared_ptr<boost::asio::ip::tcp::socket> SocketPtr;
+        typedef stdx::list<AsyncOpPtr> AsyncOpList;
+
+        /**
+         * An idle connection in the pool.
+         */
+        struct PooledConnection {
+            PooledConnection(const SocketPtr& theSocket, Date_t date) :
+                socket(theSocket), creationDate(date) {}
+
+            SocketPtr socket;
+            Date_t creationDate;
+        };
+        typedef stdx::list<PooledConnection> ConnectionList;
+        typedef unordered_map<HostAndPort, ConnectionList> HostConnectionMap;
+
+        /**
+         * Body of the event loop thread.
+         */
+        void _runEventLoop();
+
+        /**
+         * Returns true if commands have to be run by the blocking network interface, because they
+         * need authenticated or SSL connections, or replEventLoopNetworking is off.
+         */
+        bool _needsBlockingNetwork() const;
+
+        /**
+         * Hands "op" to the blocking network interface.
+         */
+        void _startBlockingCommand(const AsyncOpPtr& op);
+
+        /**
+         * Completion function of commands run by the blocking network interface.
+         */
+        void _finishBlockingCommand(const RemoteCommandCompletionFn& onFinish,
+                                    const ResponseStatus& response);
+
+        // The steps of a command on the event loop, in order.  Each one either moves the command to
+        // the next step or finishes it with an error.
+        void _beginCommand(const AsyncOpPtr& op);
+        void _onResolve(const AsyncOpPtr& op,
+                        const boost::system::error_code& ec,
+                        boost::asio::ip::tcp::resolver::iterator endpoints);
+        void _onConnect(const AsyncOpPtr& op, const boost::system::error_code& ec);
+        void _sendCommand(const AsyncOpPtr& op);
+        void _onSend(const AsyncOpPtr& op, const boost::system::error_code& ec);
+        void _onReceiveHeader(const AsyncOpPtr& op, const boost::system::error_code& ec);
+        void _onReceiveBody(const AsyncOpPtr& op, const boost::system::error_code& ec);
+        void _onTimeout(const AsyncOpPtr& op, const boost::system::error_code& ec);
+        void _cancelCommand(const AsyncOpPtr& op);
+
+        /**
+         * Finishes "op" with a network error, retrying it on a new connection if it failed on a
+         * pooled connection before anything was received, as the target may have closed it.
+         */
+        void _failCommand(const AsyncOpPtr& op,
+                          const std::string& context,
+                          const boost::system::error_code& ec);
+
+        /**
+         * Finishes "op" with "response", returning its connection to the pool if the exchange
+         * completed, and runs its completion function.  Later steps of "op" do nothing.
+         */
+        void _finishCommand(const AsyncOpPtr& op, const ResponseStatus& response);
+
+        /**
+         * Returns an idle connection to "target", or an empty pointer if there is none.
+         */
+        SocketPtr _acquireConnection(const HostAndPort& target, Date_t now, Date_t* creationDate);
+
+        /**
+         * Closes idle connections which are too old, to all hosts.
+         */
+        void _cleanUpConnections(Date_t now);
+
+        // Mutex guarding _inProgress, _isExecutorRunnable, _inShutdown and the statistics.
+        boost::mutex _mutex;
+
+        // Io service running the event loop, and keeping it running while there is no work.
+        boost::asio::io_service _io;
+        boost::scoped_ptr<boost::asio::io_service::work> _work;
+
+        // The event loop thread.
+        boost::scoped_ptr<boost::thread> _thread;
+
+        // Commands which were started but are not finished yet.
+        AsyncOpList _inProgress;
+
+        // Idle connections, only accessed on the event loop.
+        HostConnectionMap _connections;
+        Date_t _lastCleanUpTime;
+
+        // Network interface running the commands the event loop can't.
+        boost::scoped_ptr<NetworkInterfaceImpl> _blockingNet;
+
+        // Condition signaled to indicate that the executor, blocked in waitForWorkUntil or
+        // waitForWork, should wake up.
+        boost::condition_variable _isExecutorRunnableCondition;
+
+        // Flag indicating whether or not the executor associated with this interface is runnable.
+        bool _isExecutorRunnable;
+
+        // Flag indicating when this interface is being shut down (because shutdown() has executed).
+        bool _inShutdown;
+
+        // Statistics about finished commands.
+        long long _numFinished;
+        long long _numTimedOut;
+        long long _numCanceled;
+        long long _numBlocking;
+        long long _numConnectionsCreated;
+        long long _totalQueueMillis;
+        long long _totalNetworkMillis;
+    };
+
+}  // namespace repl
+} // namespace mongo
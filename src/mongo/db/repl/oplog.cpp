@@ -72,6 +72,7 @@
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/storage_options.h"
@@ -107,6 +108,10 @@ namespace {
 
     static std::string _oplogCollectionName;
 
+    // When true, secondaries build replicated foreground indexes in the background too, so that
+    // applying the oplog carries on while they are built.
+    MONGO_EXPORT_SERVER_PARAMETER(replIndexBuildsInBackground, bool, false);
+
     // so we can fail the same way
     void checkOplogInsert( StatusWith<RecordId> result ) {
         massert( 17322,
@@ -637,6 +642,20 @@ namespace {
 
             const char *p = strchr(ns, '.');
             if ( p && nsToCollectionSubstring( p ) == "system.indexes" ) {
+                if (!o["background"].trueValue() && replIndexBuildsInBackground &&
+                    !txn->writesAreReplicated()) {
+                    // Only the build is changed: later operations are applied while it runs,
+                    // like those the primary applies during a background build.
+                    BSONObjBuilder spec;
+                    BSONForEach(elem, o) {
+                        if (!str::equals(elem.fieldName(), "background")) {
+                            spec.append(elem);
+                        }
+                    }
+                    spec.append("background", true);
+                    o = spec.obj();
+                }
+
                 if (o["background"].trueValue()) {
                     IndexBuilder* builder = new IndexBuilder(o);
                     // This spawns a new thread and returns immediately.
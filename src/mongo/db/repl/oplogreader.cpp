@@ -77,7 +77,7 @@ namespace repl {
         return authenticateInternalUser(conn);
     }
 
-    OplogReader::OplogReader() {
+    OplogReader::OplogReader() : _exhausting(false) {
         _tailingQueryOptions = QueryOption_SlaveOk;
         _tailingQueryOptions |= QueryOption_CursorTailable | QueryOption_OplogReplay;
         
@@ -107,6 +107,23 @@ namespace repl {
         return true;
     }
 
+    void OplogReader::resetCursor() {
+        const bool streaming = _exhausting && cursor.get() && cursor->getCursorId() != 0;
+        cursor.reset();
+        _exhausting = false;
+        if (streaming) {
+            const HostAndPort host = _host;
+            resetConnection();
+            connect(host);
+        }
+    }
+
+    void OplogReader::resetIfExhausting() {
+        if (_exhausting && cursor.get() && cursor->getCursorId() != 0) {
+            resetConnection();
+        }
+    }
+
     void OplogReader::tailCheck() {
         if( cursor.get() && cursor->isDead() ) {
             log() << "old cursor isDead, will initiate a new one" << std::endl;
@@ -128,6 +145,7 @@ namespace repl {
         verify( !haveCursor() );
         LOG(2) << ns << ".find(" << query.toString() << ')' << endl;
         cursor.reset( _conn->query( ns, query, 0, 0, fields, _tailingQueryOptions ).release() );
+        _exhausting = haveCursor() && (_tailingQueryOptions & QueryOption_Exhaust);
     }
 
     void OplogReader::tailingQueryGTE(const char *ns, Timestamp optime, const BSONObj* fields ) {
@@ -61,18 +61,39 @@ namespace repl {
         boost::shared_ptr<DBClientCursor> cursor;
         int _tailingQueryOptions;
 
+        // True while the cursor is a QueryOption_Exhaust cursor, so that the sync source may still
+        // be sending it batches on _conn.
+        bool _exhausting;
+
         // If _conn was actively connected, _host represents the current HostAndPort of the
         // connection.
         HostAndPort _host;
     public:
         OplogReader();
         ~OplogReader() { }
-        void resetCursor() { cursor.reset(); }
+
+        /**
+         * Drops the cursor.  If the sync source may still be sending it batches, the connection
+         * can't be used for anything else, so it is reopened; if that fails, conn() is NULL.
+         */
+        void resetCursor();
+
+        /**
+         * Drops the cursor and the connection if the sync source may still be sending the cursor
+         * batches, otherwise does nothing.
+         */
+        void resetIfExhausting();
+
         void resetConnection() {
             cursor.reset();
             _conn.reset();
             _host = HostAndPort();
+            _exhausting = false;
         }
+
+        /** true if the cursor is streamed by the sync source (see QueryOption_Exhaust) */
+        bool isExhausting() const { return _exhausting; }
+
         DBClientConnection* conn() { return _conn.get(); }
         BSONObj findOne(const char *ns, const Query& q) {
             return conn()->findOne(ns, q, 0, QueryOption_SlaveOk);
@@ -179,6 +179,13 @@ namespace repl {
          * for "txn".
          */
         virtual void dropAllTempCollections(OperationContext* txn) = 0;
+
+        /**
+         * Starts reading the configured warmup collections and indexes into cache in the
+         * background, so that the new primary doesn't serve its first requests from disk, and
+         * restores the saved plan cache entries so that it doesn't have to plan them all again.
+         */
+        virtual void startCacheWarmup() = 0;
     };
 
 } // namespace repl
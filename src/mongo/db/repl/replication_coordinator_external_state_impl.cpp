@@ -56,6 +56,8 @@
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/repl/last_vote.h"
 #include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/query/plan_cache_snapshot.h"
+#include "mongo/db/warmup.h"
 #include "mongo/s/d_state.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
@@ -335,5 +337,10 @@ namespace {
         }
     }
 
+    void ReplicationCoordinatorExternalStateImpl::startCacheWarmup() {
+        startConfiguredWarmup();
+        requestPlanCacheSnapshotLoad();
+    }
+
 } // namespace repl
 } // namespace mongo
@@ -65,6 +65,7 @@ namespace repl {
         virtual void signalApplierToChooseNewSyncSource();
         virtual OperationContext* createOperationContext(const std::string& threadName);
         virtual void dropAllTempCollections(OperationContext* txn);
+        virtual void startCacheWarmup();
 
         std::string getNextOpContextThreadName();
 
@@ -193,5 +193,7 @@ namespace repl {
 
     void ReplicationCoordinatorExternalStateMock::dropAllTempCollections(OperationContext* txn) {}
 
+    void ReplicationCoordinatorExternalStateMock::startCacheWarmup() {}
+
 } // namespace repl
 } // namespace mongo
@@ -71,6 +71,7 @@ namespace repl {
         virtual void signalApplierToChooseNewSyncSource();
         virtual OperationContext* createOperationContext(const std::string& threadName);
         virtual void dropAllTempCollections(OperationContext* txn);
+        virtual void startCacheWarmup();
 
         /**
          * Adds "host" to the list of hosts that this mock will match when responding to "isSelf"
@@ -108,27 +108,59 @@ namespace {
     struct ReplicationCoordinatorImpl::WaiterInfo {
 
         /**
-         * Constructor takes the list of waiters and enqueues itself on the list, removing itself
-         * in the destructor.
+         * Constructor takes the list of waiters and enqueues itself on the list and in the index,
+         * removing itself in the destructor.
          */
         WaiterInfo(std::vector<WaiterInfo*>* _list,
+                   WaiterIndex* _index,
                    unsigned int _opID,
                    const Timestamp* _opTime,
                    const WriteConcernOptions* _writeConcern,
                    boost::condition_variable* _condVar) : list(_list),
+                                                          index(_index),
+                                                          indexed(false),
                                                           master(true),
                                                           opID(_opID),
                                                           opTime(_opTime),
                                                           writeConcern(_writeConcern),
                                                           condVar(_condVar) {
             list->push_back(this);
+            addToIndex();
         }
 
         ~WaiterInfo() {
+            removeFromIndex();
             list->erase(std::remove(list->begin(), list->end(), this), list->end());
         }
 
+        WaiterGroupKey groupKey() const {
+            return WaiterGroupKey(writeConcern->wMode,
+                                  writeConcern->wMode.empty() ? writeConcern->wNumNodes : 0);
+        }
+
+        void addToIndex() {
+            if (!indexed) {
+                posInIndex = (*index)[groupKey()].insert(std::make_pair(*opTime, this));
+                indexed = true;
+            }
+        }
+
+        void removeFromIndex() {
+            if (indexed) {
+                WaiterIndex::iterator group = index->find(groupKey());
+                invariant(group != index->end());
+                group->second.erase(posInIndex);
+                if (group->second.empty()) {
+                    index->erase(group);
+                }
+                indexed = false;
+            }
+        }
+
         std::vector<WaiterInfo*>* list;
+        WaiterIndex* index;
+        bool indexed; // Cleared by _wakeReadyWaiters_inlock() when it takes us out of the index
+        WaitersByOpTime::iterator posInIndex; // Valid while indexed
         bool master; // Set to false to indicate that stepDown was called while waiting
         const unsigned int opID;
         const Timestamp* opTime;
@@ -582,6 +614,7 @@ namespace {
         _canAcceptNonLocalWrites = true;
         lk.unlock();
         _externalState->dropAllTempCollections(txn);
+        _externalState->startCacheWarmup();
         log() << "transition to primary complete; database writes are now permitted" << rsLog;
     }
 
@@ -1014,9 +1047,16 @@ namespace {
 
         // Must hold _mutex before constructing waitInfo as it will modify _replicationWaiterList
         boost::condition_variable condVar;
-        WaiterInfo waitInfo(
-                &_replicationWaiterList, txn->getOpID(), &opTime, &writeConcern, &condVar);
+        WaiterInfo waitInfo(&_replicationWaiterList,
+                            &_replicationWaiterIndex,
+                            txn->getOpID(),
+                            &opTime,
+                            &writeConcern,
+                            &condVar);
         while (!_doneWaitingForReplication_inlock(opTime, writeConcern)) {
+            // Woken but not done, e.g. because the config changed, so wait to be woken again.
+            waitInfo.addToIndex();
+
             const int elapsed = timer->millis();
 
             Status interruptedStatus = txn->checkForInterruptNoAssert();
@@ -2134,11 +2174,24 @@ namespace {
      }
 
     void ReplicationCoordinatorImpl::_wakeReadyWaiters_inlock(){
-        for (std::vector<WaiterInfo*>::iterator it = _replicationWaiterList.begin();
-                it != _replicationWaiterList.end(); ++it) {
-            WaiterInfo* info = *it;
-            if (_doneWaitingForReplication_inlock(*info->opTime, *info->writeConcern)) {
+        WaiterIndex::iterator group = _replicationWaiterIndex.begin();
+        while (group != _replicationWaiterIndex.end()) {
+            WaitersByOpTime& waiters = group->second;
+            while (!waiters.empty()) {
+                WaiterInfo* info = waiters.begin()->second;
+                if (!_doneWaitingForReplication_inlock(*info->opTime, *info->writeConcern)) {
+                    break;
+                }
                 info->condVar->notify_all();
+                waiters.erase(waiters.begin());
+                info->indexed = false;
+            }
+
+            if (waiters.empty()) {
+                _replicationWaiterIndex.erase(group++);
+            }
+            else {
+                ++group;
             }
         }
     }
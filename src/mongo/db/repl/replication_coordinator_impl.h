@@ -32,6 +32,9 @@
 #include <boost/thread.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition_variable.hpp>
+#include <map>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "mongo/base/status.h"
@@ -327,6 +330,13 @@ namespace repl {
         // Struct that holds information about clients waiting for replication.
         struct WaiterInfo;
 
+        // Waiters with the same write concern, by the optime they wait for.  Once the first one
+        // isn't done waiting, neither are the ones waiting for later optimes.
+        typedef std::multimap<Timestamp, WaiterInfo*> WaitersByOpTime;
+        // Waiter groups by write concern: the wMode, or "" and wNumNodes.
+        typedef std::pair<std::string, int> WaiterGroupKey;
+        typedef std::map<WaiterGroupKey, WaitersByOpTime> WaiterIndex;
+
         // Struct that holds information about nodes in this replication group, mainly used for
         // tracking replication progress for write concern satisfaction.
         struct SlaveInfo {
@@ -396,6 +406,8 @@ namespace repl {
 
         /**
          * Helper to wake waiters in _replicationWaiterList that are doneWaitingForReplication.
+         * Only looks at the waiters in _replicationWaiterIndex, up to the first one of each write
+         * concern that isn't done, and takes the woken ones out of the index.
          */
         void _wakeReadyWaiters_inlock();
 
@@ -883,6 +895,10 @@ namespace repl {
         // WaiterInfos.
         std::vector<WaiterInfo*> _replicationWaiterList;                                  // (M)
 
+        // The waiters in _replicationWaiterList which haven't been woken since they last checked
+        // whether they are done waiting.
+        WaiterIndex _replicationWaiterIndex;                                              // (M)
+
         // Set to true when we are in the process of shutting down replication.
         bool _inShutdown;                                                                 // (M)
 
@@ -738,6 +738,55 @@ namespace {
         awaiter.reset();
     }
 
+    TEST_F(ReplCoordTest, AwaitReplicationManyWaitersWokenInOpTimeOrder) {
+        OperationContextNoop txn;
+        assertStartSuccess(
+                BSON("_id" << "mySet" <<
+                     "version" << 2 <<
+                     "members" << BSON_ARRAY(BSON("host" << "node1:12345" << "_id" << 0) <<
+                                             BSON("host" << "node2:12345" << "_id" << 1) <<
+                                             BSON("host" << "node3:12345" << "_id" << 2))),
+                HostAndPort("node1", 12345));
+        ASSERT(getReplCoord()->setFollowerMode(MemberState::RS_SECONDARY));
+        getReplCoord()->setMyLastOptime(Timestamp(100, 0));
+        simulateSuccessfulElection();
+
+        Timestamp time1(100, 1);
+        Timestamp time2(100, 2);
+
+        WriteConcernOptions twoNodes;
+        twoNodes.wTimeout = WriteConcernOptions::kNoTimeout;
+        twoNodes.wNumNodes = 2;
+        WriteConcernOptions threeNodes = twoNodes;
+        threeNodes.wNumNodes = 3;
+
+        // Waiters with the same write concern are woken in optime order, and each write concern
+        // is checked separately.
+        ReplicationAwaiter twoNodesTime1(getReplCoord(), &txn);
+        twoNodesTime1.setOpTime(time1);
+        twoNodesTime1.setWriteConcern(twoNodes);
+        ReplicationAwaiter twoNodesTime2(getReplCoord(), &txn);
+        twoNodesTime2.setOpTime(time2);
+        twoNodesTime2.setWriteConcern(twoNodes);
+        ReplicationAwaiter threeNodesTime1(getReplCoord(), &txn);
+        threeNodesTime1.setOpTime(time1);
+        threeNodesTime1.setWriteConcern(threeNodes);
+
+        twoNodesTime2.start(&txn);
+        twoNodesTime1.start(&txn);
+        threeNodesTime1.start(&txn);
+        getReplCoord()->setMyLastOptime(time2);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 1, time1));
+        ASSERT_OK(twoNodesTime1.getResult().status);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 2, time1));
+        ASSERT_OK(threeNodesTime1.getResult().status);
+
+        ASSERT_OK(getReplCoord()->setLastOptime_forTest(2, 2, time2));
+        ASSERT_OK(twoNodesTime2.getResult().status);
+    }
+
     TEST_F(ReplCoordTest, AwaitReplicationTimeout) {
         OperationContextNoop txn;
         assertStartSuccess(
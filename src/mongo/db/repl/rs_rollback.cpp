@@ -33,6 +33,7 @@
 
 #include "mongo/db/repl/rs_rollback.h"
 
+#include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "mongo/db/auth/authorization_manager.h"
@@ -368,6 +369,51 @@ namespace {
         }
     }
 
+    /**
+     * Fetches the current version of the documents in ["begin", "end"), which must all be in the
+     * same namespace, from the sync source with one $in query.  Appends each document with the
+     * version fetched, or an empty object if the sync source doesn't have it, to "goodVersions".
+     */
+    void refetchBatch(DBClientConnection* them,
+                      set<DocID>::const_iterator begin,
+                      set<DocID>::const_iterator end,
+                      list< pair<DocID, BSONObj> >* goodVersions,
+                      unsigned long long* totalSize) {
+        const char* ns = begin->ns;
+        BSONArrayBuilder ids;
+        for (set<DocID>::const_iterator it = begin; it != end; ++it) {
+            ids.append(it->_id);
+        }
+
+        std::unique_ptr<DBClientCursor> cursor = them->query(ns,
+                                                             BSON("_id" << BSON("$in" <<
+                                                                                ids.arr())),
+                                                             0,
+                                                             0,
+                                                             NULL,
+                                                             QueryOption_SlaveOk);
+        uassert(28705, str::stream() << "rollback refetch query on " << ns << " failed",
+                cursor.get());
+
+        map<BSONObj, BSONObj, BSONObjCmp> found;
+        while (cursor->more()) {
+            BSONObj good = cursor->nextSafe().getOwned();
+            *totalSize += good.objsize();
+            uassert(13410, "replSet too much data to roll back",
+                    *totalSize < 300 * 1024 * 1024);
+            found[good["_id"].wrap()] = good;
+        }
+
+        for (set<DocID>::const_iterator it = begin; it != end; ++it) {
+            // note a missing document is returned as an empty object, indicating we should
+            // delete it
+            map<BSONObj, BSONObj, BSONObjCmp>::const_iterator good = found.find(it->_id.wrap());
+            goodVersions->push_back(pair<DocID, BSONObj>(*it,
+                                                         good == found.end() ? BSONObj() :
+                                                                               good->second));
+        }
+    }
+
     bool copyCollectionFromRemote(OperationContext* txn,
                                   const string& host,
                                   const string& ns,
@@ -397,28 +443,41 @@ namespace {
 
         BSONObj newMinValid;
 
-        // fetch all the goodVersions of each document from current primary
+        // fetch all the goodVersions of each document from current primary, in batches of
+        // documents of the same namespace
+        const size_t kMaxBatchDocs = 1000;
+        const int kMaxBatchIdBytes = 1024 * 1024;
         DocID doc;
         unsigned long long numFetched = 0;
+        time_t lastProgressUpdate = time(0);
+        const time_t progressUpdateGap = 10;
         try {
-            for (set<DocID>::iterator it = fixUpInfo.toRefetch.begin();
-                    it != fixUpInfo.toRefetch.end();
-                    it++) {
+            set<DocID>::const_iterator it = fixUpInfo.toRefetch.begin();
+            while (it != fixUpInfo.toRefetch.end()) {
                 doc = *it;
 
-                verify(!doc._id.eoo());
+                set<DocID>::const_iterator batchEnd = it;
+                size_t batchDocs = 0;
+                int batchIdBytes = 0;
+                while (batchEnd != fixUpInfo.toRefetch.end() &&
+                       strcmp(batchEnd->ns, doc.ns) == 0 &&
+                       batchDocs < kMaxBatchDocs &&
+                       batchIdBytes < kMaxBatchIdBytes) {
+                    verify(!batchEnd->_id.eoo());
+                    batchIdBytes += batchEnd->_id.size();
+                    batchDocs++;
+                    batchEnd++;
+                }
 
-                {
-                    // TODO : slow.  lots of round trips.
-                    numFetched++;
-                    BSONObj good = them->findOne(doc.ns, doc._id.wrap(),
-                                                     NULL, QueryOption_SlaveOk).getOwned();
-                    totalSize += good.objsize();
-                    uassert(13410, "replSet too much data to roll back",
-                            totalSize < 300 * 1024 * 1024);
-
-                    // note good might be eoo, indicating we should delete it
-                    goodVersions.push_back(pair<DocID, BSONObj>(doc,good));
+                refetchBatch(them, it, batchEnd, &goodVersions, &totalSize);
+                numFetched += batchDocs;
+                it = batchEnd;
+
+                time_t now = time(0);
+                if (now - lastProgressUpdate > progressUpdateGap) {
+                    log() << "rollback refetched " << numFetched << " out of "
+                          << fixUpInfo.toRefetch.size() << " documents";
+                    lastProgressUpdate = now;
                 }
             }
             newMinValid = oplogreader->getLastOp(rsOplogName);
@@ -582,8 +641,9 @@ namespace {
                 oplogCollection);
 
         unsigned deletes = 0, updates = 0;
-        time_t lastProgressUpdate = time(0);
-        time_t progressUpdateGap = 10;
+        lastProgressUpdate = time(0);
+        // goodVersions is ordered by namespace, so the context is only set up once per collection
+        boost::scoped_ptr<OldClientContext> nsCtx;
         for (list<pair<DocID, BSONObj> >::iterator it = goodVersions.begin();
                 it != goodVersions.end();
                 it++) {
@@ -608,8 +668,11 @@ namespace {
                 if (!removeSaver)
                     removeSaver.reset(new Helpers::RemoveSaver("rollback", "", doc.ns));
 
-                // todo: lots of overhead in context, this can be faster
-                OldClientContext ctx(txn, doc.ns);
+                if (!nsCtx || strcmp(nsCtx->ns(), doc.ns) != 0) {
+                    nsCtx.reset();
+                    nsCtx.reset(new OldClientContext(txn, doc.ns));
+                }
+                OldClientContext& ctx = *nsCtx;
 
                 // Add the doc to our rollback file
                 BSONObj obj;
@@ -732,6 +795,7 @@ namespace {
             }
         }
 
+        nsCtx.reset();
         removeSavers.clear(); // this effectively closes all of them
         log() << "rollback 5 d:" << deletes << " u:" << updates;
         log() << "rollback 6";
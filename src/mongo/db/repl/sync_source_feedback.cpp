@@ -32,6 +32,7 @@
 
 #include "mongo/db/repl/sync_source_feedback.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/client/constants.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -39,12 +40,14 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/internal_user_auth.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostandport.h"
@@ -56,7 +59,32 @@ namespace mongo {
 
 namespace repl {
 
+namespace {
+    // Position updates are sent upstream at most once per this many milliseconds.  The position
+    // changes meanwhile, including those forwarded from members chained through us, are sent in
+    // the next update, at the cost of delaying write concern acknowledgement by up to that long.
+    // 0 sends each update as soon as the previous one is done.
+    MONGO_EXPORT_SERVER_PARAMETER(replUpdatePositionCoalesceMillis, int, 0);
+
+    // The number of replSetUpdatePosition commands sent upstream
+    Counter64 updatesSentStats;
+    ServerStatusMetricField<Counter64> displayUpdatesSent("repl.network.updatePosition.sent",
+                                                          &updatesSentStats);
+    // The number of position changes which were sent along with another one
+    Counter64 updatesCoalescedStats;
+    ServerStatusMetricField<Counter64> displayUpdatesCoalesced(
+                                                    "repl.network.updatePosition.coalesced",
+                                                    &updatesCoalescedStats);
+    // The time spent waiting for more position changes before sending an update
+    Counter64 coalesceWaitMillisStats;
+    ServerStatusMetricField<Counter64> displayCoalesceWaitMillis(
+                                                    "repl.network.updatePosition.waitMillis",
+                                                    &coalesceWaitMillisStats);
+} // namespace
+
     SyncSourceFeedback::SyncSourceFeedback() : _positionChanged(false),
+                                               _positionChanges(0),
+                                               _lastUpdateMillis(0),
                                                _shutdownSignaled(false) {}
     SyncSourceFeedback::~SyncSourceFeedback() {}
 
@@ -101,9 +129,28 @@ namespace repl {
     void SyncSourceFeedback::forwardSlaveProgress() {
         boost::unique_lock<boost::mutex> lock(_mtx);
         _positionChanged = true;
+        _positionChanges++;
         _cond.notify_all();
     }
 
+    void SyncSourceFeedback::_waitToCoalesce_inlock(boost::unique_lock<boost::mutex>* lock) {
+        const int windowMillis = replUpdatePositionCoalesceMillis;
+        if (windowMillis <= 0) {
+            return;
+        }
+
+        const unsigned long long start = curTimeMillis64();
+        const unsigned long long sendAt = _lastUpdateMillis + windowMillis;
+        unsigned long long now = start;
+        while (now < sendAt && !_shutdownSignaled) {
+            _cond.timed_wait(*lock, boost::posix_time::milliseconds(sendAt - now));
+            now = curTimeMillis64();
+        }
+        if (now > start) {
+            coalesceWaitMillisStats.increment(now - start);
+        }
+    }
+
     Status SyncSourceFeedback::updateUpstream(OperationContext* txn) {
         ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
         if (replCoord->getMemberState().primary()) {
@@ -123,6 +170,7 @@ namespace repl {
         LOG(2) << "Sending slave oplog progress to upstream updater: " << cmd.done();
         try {
             _connection->runCommand("admin", cmd.obj(), res);
+            updatesSentStats.increment();
         }
         catch (const DBException& e) {
             log() << "SyncSourceFeedback error sending update: " << e.what() << endl;
@@ -163,6 +211,7 @@ namespace repl {
 
         ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
         while (true) { // breaks once _shutdownSignaled is true
+            long long positionChanges;
             {
                 boost::unique_lock<boost::mutex> lock(_mtx);
                 while (!_positionChanged && !_shutdownSignaled) {
@@ -173,7 +222,14 @@ namespace repl {
                     break;
                 }
 
+                _waitToCoalesce_inlock(&lock);
+                if (_shutdownSignaled) {
+                    break;
+                }
+
                 _positionChanged = false;
+                positionChanges = _positionChanges;
+                _positionChanges = 0;
             }
 
             MemberState state = replCoord->getMemberState();
@@ -202,10 +258,16 @@ namespace repl {
                 }
             }
             Status status = updateUpstream(&txn);
+            _lastUpdateMillis = curTimeMillis64();
             if (!status.isOK()) {
                 sleepmillis(500);
                 boost::unique_lock<boost::mutex> lock(_mtx);
                 _positionChanged = true;
+                _positionChanges += positionChanges;
+                continue;
+            }
+            if (positionChanges > 1) {
+                updatesCoalescedStats.increment(positionChanges - 1);
             }
         }
     }
@@ -79,16 +79,24 @@ namespace repl {
         /// Connect to sync target.
         bool _connect(OperationContext* txn, const HostAndPort& host);
 
+        /// Waits until replUpdatePositionCoalesceMillis have passed since the last update was sent,
+        /// or shutdown() is called, so that the position changes meanwhile go in one update.
+        void _waitToCoalesce_inlock(boost::unique_lock<boost::mutex>* lock);
+
         // the member we are currently syncing from
         HostAndPort _syncTarget;
         // our connection to our sync target
         boost::scoped_ptr<DBClientConnection> _connection;
-        // protects cond, _shutdownSignaled, and _positionChanged.
+        // protects cond, _shutdownSignaled, _positionChanged and _positionChanges.
         boost::mutex _mtx;
         // used to alert our thread of changes which need to be passed up the chain
         boost::condition _cond;
         // used to indicate a position change which has not yet been pushed along
         bool _positionChanged;
+        // number of forwardSlaveProgress() calls since the last update was prepared
+        long long _positionChanges;
+        // when the last update was sent, only used by the run() thread
+        unsigned long long _lastUpdateMillis;
         // Once this is set to true the _run method will terminate
         bool _shutdownSignaled;
     };
@@ -39,6 +39,7 @@
 
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/commands/fsync.h"
@@ -46,6 +47,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/prefetch.h"
@@ -55,10 +57,16 @@
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replica_set_config.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/numa_placement.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -88,6 +96,114 @@ namespace repl {
     static ServerStatusMetricField<TimerStats> displayOpBatchesApplied(
                                                     "repl.apply.batches",
                                                     &applyBatchStats );
+
+    // Latency distribution of each ApplyOps worker pool round
+    static LatencyHistogram applyBatchLatency;
+    static ServerStatusMetricField<LatencyHistogram> displayBatchLatency(
+                                                    "repl.apply.batchLatency",
+                                                    &applyBatchLatency );
+
+    // Number of ops handed to each writer thread
+    static AtomicInt64 writerOpsApplied[replWriterThreadCount];
+
+    class WriterOpsAppliedMetric : public ServerStatusMetric {
+    public:
+        WriterOpsAppliedMetric() : ServerStatusMetric("repl.apply.writers") {}
+
+        virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+            BSONArrayBuilder writers(b.subarrayStart(_leafName));
+            for (int i = 0; i < replWriterThreadCount; i++) {
+                writers.append(writerOpsApplied[i].loadRelaxed());
+            }
+            writers.doneFast();
+        }
+    } writerOpsAppliedMetric;
+
+namespace {
+    const char kPartitionAuto[] = "auto";
+    const char kPartitionByNamespace[] = "namespace";
+    const char kPartitionById[] = "_id";
+
+    std::string replWriterPartitioning = kPartitionAuto;
+
+    /**
+     * Controls how the ops of a batch are spread across the writer threads:
+     *   - "namespace": all ops on a collection go to the same writer.
+     *   - "_id": CRUD ops on a collection are spread across writers by the hash of the _id of
+     *     the document they touch, which keeps the ops on a single document in order.
+     *   - "auto" (the default): "_id" if the storage engine supports document level locking,
+     *     "namespace" otherwise.
+     * Ops on capped collections are always partitioned by namespace, since their insertion
+     * order must match the primary's.
+     */
+    class ReplWriterPartitioningParameter : public ExportedServerParameter<std::string> {
+    public:
+        ReplWriterPartitioningParameter()
+            : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                   "replWriterPartitioning",
+                                                   &replWriterPartitioning,
+                                                   true, // Change at startup
+                                                   false) {} // Change at runtime
+
+    protected:
+        virtual Status validate(const std::string& potentialNewValue) {
+            if (potentialNewValue != kPartitionAuto &&
+                potentialNewValue != kPartitionByNamespace &&
+                potentialNewValue != kPartitionById) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "replWriterPartitioning must be one of \""
+                                            << kPartitionAuto << "\", \""
+                                            << kPartitionByNamespace << "\" or \""
+                                            << kPartitionById << "\"");
+            }
+            return Status::OK();
+        }
+    } replWriterPartitioningParameter;
+
+    // Largest number of consecutive inserts on one collection, and their total size, that a
+    // writer applies as a single bulk insert. 1 applies every insert on its own.
+    MONGO_EXPORT_SERVER_PARAMETER(replWriterInsertBatchSize, int, 64);
+    const int kMaxInsertBatchBytes = 1024 * 1024;
+
+    /**
+     * Returns whether 'op' is an insert which applyInsertBatch() can group with others: a
+     * plain document insert, not an index build through system.indexes.
+     */
+    bool isBatchableInsert(const BSONObj& op) {
+        const char* opType = op.getStringField("op");
+        if (opType[0] != 'i' || opType[1] != '\0') {
+            return false;
+        }
+        StringData ns = op.getStringField("ns");
+        return nsIsFull(ns) && nsToCollectionSubstring(ns) != "system.indexes";
+    }
+
+    /**
+     * Returns the end of the run of batchable inserts on the same collection starting at
+     * 'begin', not going past 'end' or the batch size limits.
+     */
+    std::vector<BSONObj>::const_iterator endOfInsertBatch(
+            std::vector<BSONObj>::const_iterator begin,
+            std::vector<BSONObj>::const_iterator end) {
+        if (replWriterInsertBatchSize <= 1 || !isBatchableInsert(*begin)) {
+            return begin + 1;
+        }
+
+        StringData ns = begin->getStringField("ns");
+        int bytes = begin->objsize();
+        std::vector<BSONObj>::const_iterator it = begin + 1;
+        for (; it != end && it - begin < replWriterInsertBatchSize; ++it) {
+            if (bytes + it->objsize() > kMaxInsertBatchBytes ||
+                !isBatchableInsert(*it) ||
+                ns != it->getStringField("ns")) {
+                break;
+            }
+            bytes += it->objsize();
+        }
+        return it;
+    }
+}  // namespace
+
     void initializePrefetchThread() {
         if (!ClientBasic::getCurrent()) {
             Client::initThreadIfNotAlready();
@@ -219,6 +335,69 @@ namespace repl {
         return false;
     }
 
+    bool SyncTail::applyInsertBatch(OperationContext* txn,
+                                    std::vector<BSONObj>::const_iterator begin,
+                                    std::vector<BSONObj>::const_iterator end) {
+        if (inShutdown()) {
+            return false;
+        }
+
+        txn->getCurOp()->reset();
+
+        const std::string ns = begin->getStringField("ns");
+        std::vector<BSONObj> docs;
+        docs.reserve(end - begin);
+        for (std::vector<BSONObj>::const_iterator it = begin; it != end; ++it) {
+            BSONElement o = (*it)["o"];
+            if (!o.isABSONObj() || !o.Obj().hasField("_id")) {
+                // Let syncApply() report it.
+                return false;
+            }
+            docs.push_back(o.Obj());
+        }
+
+        try {
+            Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IX);
+            Lock::CollectionLock collectionLock(txn->lockState(), ns, MODE_IX);
+
+            Database* db = dbHolder().get(txn, nsToDatabaseSubstring(ns));
+            Collection* collection = db ? db->getCollection(ns) : NULL;
+            if (!collection) {
+                // syncApply() creates it.
+                return false;
+            }
+
+            txn->setReplicatedWrites(false);
+
+            WriteUnitOfWork wunit(txn);
+            // Inserts are applied as upserts by _id since they may be replayed, and a bulk
+            // insert of a replayed document fails; the caller then applies them one by one.
+            Status status = collection->insertDocuments(txn, docs, false);
+            if (!status.isOK()) {
+                LOG(2) << "applying " << docs.size() << " inserts on " << ns
+                       << " one at a time: " << status;
+                return false;
+            }
+            wunit.commit();
+        }
+        catch (const WriteConflictException&) {
+            LOG(2) << "WriteConflictException while applying " << docs.size()
+                   << " inserts on " << ns << ", applying them one at a time.";
+            return false;
+        }
+        catch (const DBException& e) {
+            LOG(2) << "applying " << docs.size() << " inserts on " << ns
+                   << " one at a time: " << causedBy(e);
+            return false;
+        }
+
+        for (size_t i = 0; i < docs.size(); i++) {
+            replOpCounters.gotInsert();
+            opsAppliedStats.increment();
+        }
+        return true;
+    }
+
     // The pool threads call this to prefetch each op
     void SyncTail::prefetchOp(const BSONObj& op) {
         initializePrefetchThread();
@@ -258,27 +437,35 @@ namespace repl {
     // Doles out all the work to the writer pool threads and waits for them to complete
     void SyncTail::applyOps(const std::vector< std::vector<BSONObj> >& writerVectors) {
         TimerHolder timer(&applyBatchStats);
-        for (std::vector< std::vector<BSONObj> >::const_iterator it = writerVectors.begin();
-             it != writerVectors.end();
-             ++it) {
-            if (!it->empty()) {
-                _writerPool.schedule(_applyFunc, boost::cref(*it), this);
+        const unsigned long long startMicros = curTimeMicros64();
+        for (size_t i = 0; i < writerVectors.size(); i++) {
+            if (!writerVectors[i].empty()) {
+                writerOpsApplied[i].fetchAndAdd(writerVectors[i].size());
+                // Ops are split across writer vectors by namespace hash, so keeping each
+                // vector on the same thread from batch to batch keeps its collections warm.
+                _writerPool.scheduleWithAffinity(
+                        i, stdx::bind(_applyFunc, boost::cref(writerVectors[i]), this));
             }
         }
         _writerPool.join();
+        applyBatchLatency.recordMicros(curTimeMicros64() - startMicros);
     }
 
     // Doles out all the work to the writer pool threads and waits for them to complete
     Timestamp SyncTail::multiApply(OperationContext* txn, std::deque<BSONObj>& ops) {
 
-        if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
-            // Use a ThreadPool to prefetch all the operations in a batch.
+        // Use a ThreadPool to prefetch all the operations in a batch.  On storage engines other
+        // than MMAP V1 this reads the documents and index keys the ops touch into the engine's
+        // cache, unless replIndexPrefetch is "none".
+        if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1() ||
+                BackgroundSync::get()->getIndexPrefetchConfig() !=
+                    BackgroundSync::PREFETCH_NONE) {
             prefetchOps(ops);
         }
         
         std::vector< std::vector<BSONObj> > writerVectors(replWriterThreadCount);
 
-        fillWriterVectors(ops, &writerVectors);
+        fillWriterVectors(txn, ops, &writerVectors);
         LOG(2) << "replication batch size is " << ops.size() << endl;
         // We must grab this because we're going to grab write locks later.
         // We hold this mutex the entire time we're writing; it doesn't matter
@@ -321,9 +508,17 @@ namespace repl {
         return lastOpTime;
     }
 
-    void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops,
+    void SyncTail::fillWriterVectors(OperationContext* txn,
+                                     const std::deque<BSONObj>& ops,
                                      std::vector< std::vector<BSONObj> >* writerVectors) {
 
+        const bool partitionById = replWriterPartitioning == kPartitionById ||
+            (replWriterPartitioning == kPartitionAuto &&
+             getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking());
+
+        // Whether each namespace seen in this batch is a capped collection.
+        std::map<StringData, bool> cappedCache;
+
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
@@ -336,8 +531,9 @@ namespace repl {
 
             const char* opType = it->getField( "op" ).valuestrsafe();
 
-            if (getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking() &&
-                isCrudOpType(opType)) {
+            if (partitionById &&
+                isCrudOpType(opType) &&
+                !isCappedCollection(txn, StringData(ns, len - 1), &cappedCache)) {
                 BSONElement id;
                 switch (opType[0]) {
                 case 'u':
@@ -356,6 +552,28 @@ namespace repl {
             (*writerVectors)[hash % writerVectors->size()].push_back(*it);
         }
     }
+    bool SyncTail::isCappedCollection(OperationContext* txn,
+                                      StringData ns,
+                                      std::map<StringData, bool>* cache) {
+        std::map<StringData, bool>::const_iterator it = cache->find(ns);
+        if (it != cache->end()) {
+            return it->second;
+        }
+
+        bool isCapped = false;
+        {
+            Lock::DBLock dbLock(txn->lockState(), nsToDatabaseSubstring(ns), MODE_IS);
+            Database* db = dbHolder().get(txn, ns);
+            if (db) {
+                Collection* collection = db->getCollection(ns);
+                isCapped = collection && collection->isCapped();
+            }
+        }
+
+        (*cache)[ns] = isCapped;
+        return isCapped;
+    }
+
     void SyncTail::oplogApplication(OperationContext* txn, const Timestamp& endOpTime) {
         _applyOplogUntil(txn, endOpTime);
     }
@@ -649,6 +867,7 @@ namespace {
         if (!ClientBasic::getCurrent()) {
             Client::initThreadIfNotAlready();
             AuthorizationSession::get(cc())->grantInternalAuthorization();
+            NumaPlacement::bindCurrentThread(NumaPlacement::kReplWriters);
         }
     }
 
@@ -664,23 +883,30 @@ namespace {
 
         bool convertUpdatesToUpserts = true;
 
-        for (std::vector<BSONObj>::const_iterator it = ops.begin();
-             it != ops.end();
-             ++it) {
-            try {
-                if (!st->syncApply(&txn, *it, convertUpdatesToUpserts)) {
-                    fassertFailedNoTrace(16359);
-                }
+        std::vector<BSONObj>::const_iterator it = ops.begin();
+        while (it != ops.end()) {
+            std::vector<BSONObj>::const_iterator batchEnd = endOfInsertBatch(it, ops.end());
+            if (batchEnd - it > 1 && st->applyInsertBatch(&txn, it, batchEnd)) {
+                it = batchEnd;
+                continue;
             }
-            catch (const DBException& e) {
-                error() << "writer worker caught exception: " << causedBy(e)
-                        << " on: " << it->toString();
 
-                if (inShutdown()) {
-                    return;
+            for (; it != batchEnd; ++it) {
+                try {
+                    if (!st->syncApply(&txn, *it, convertUpdatesToUpserts)) {
+                        fassertFailedNoTrace(16359);
+                    }
                 }
+                catch (const DBException& e) {
+                    error() << "writer worker caught exception: " << causedBy(e)
+                            << " on: " << it->toString();
+
+                    if (inShutdown()) {
+                        return;
+                    }
 
-                fassertFailedNoTrace(16360);
+                    fassertFailedNoTrace(16360);
+                }
             }
         }
     }
@@ -695,32 +921,40 @@ namespace {
         // allow us to get through the magic barrier
         txn.lockState()->setIsBatchWriter(true);
 
-        for (std::vector<BSONObj>::const_iterator it = ops.begin();
-             it != ops.end();
-             ++it) {
-            try {
-                if (!st->syncApply(&txn, *it)) {
+        std::vector<BSONObj>::const_iterator it = ops.begin();
+        while (it != ops.end()) {
+            std::vector<BSONObj>::const_iterator batchEnd = endOfInsertBatch(it, ops.end());
+            if (batchEnd - it > 1 && st->applyInsertBatch(&txn, it, batchEnd)) {
+                it = batchEnd;
+                continue;
+            }
+
+            for (; it != batchEnd; ++it) {
+                try {
+                    if (!st->syncApply(&txn, *it)) {
 
-                    if (st->shouldRetry(&txn, *it)) {
-                        if (!st->syncApply(&txn, *it)) {
-                            fassertFailedNoTrace(15915);
+                        if (st->shouldRetry(&txn, *it)) {
+                            if (!st->syncApply(&txn, *it)) {
+                                fassertFailedNoTrace(15915);
+                            }
                         }
-                    }
 
-                    // If shouldRetry() returns false, fall through.
-                    // This can happen if the document that was moved and missed by Cloner
-                    // subsequently got deleted and no longer exists on the Sync Target at all
+                        // If shouldRetry() returns false, fall through.
+                        // This can happen if the document that was moved and missed by Cloner
+                        // subsequently got deleted and no longer exists on the Sync Target at
+                        // all
+                    }
                 }
-            }
-            catch (const DBException& e) {
-                error() << "writer worker caught exception: " << causedBy(e)
-                        << " on: " << it->toString();
+                catch (const DBException& e) {
+                    error() << "writer worker caught exception: " << causedBy(e)
+                            << " on: " << it->toString();
 
-                if (inShutdown()) {
-                    return;
-                }
+                    if (inShutdown()) {
+                        return;
+                    }
 
-                fassertFailedNoTrace(16361);
+                    fassertFailedNoTrace(16361);
+                }
             }
         }
     }
@@ -29,6 +29,8 @@
 #pragma once
 
 #include <deque>
+#include <map>
+#include <vector>
 
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/repl/sync.h"
@@ -54,6 +56,18 @@ namespace repl {
                                const BSONObj &o,
                                bool convertUpdateToUpsert = false);
 
+        /**
+         * Applies the insert ops in [begin, end), which must all be for the same collection
+         * and not index builds, as a single bulk insert in one unit of work.
+         *
+         * Returns false, having applied none of them, if the batch cannot be applied as a whole
+         * (the collection doesn't exist yet, a document is already there on replay, ...); the
+         * caller must then apply the ops one at a time with syncApply().
+         */
+        bool applyInsertBatch(OperationContext* txn,
+                              std::vector<BSONObj>::const_iterator begin,
+                              std::vector<BSONObj>::const_iterator end);
+
         /**
          * Runs _applyOplogUntil(stopOpTime)
          */
@@ -128,8 +142,14 @@ namespace repl {
         // Doles out all the work to the writer pool threads and waits for them to complete
         void applyOps(const std::vector< std::vector<BSONObj> >& writerVectors);
 
-        void fillWriterVectors(const std::deque<BSONObj>& ops,
+        void fillWriterVectors(OperationContext* txn,
+                               const std::deque<BSONObj>& ops,
                                std::vector< std::vector<BSONObj> >* writerVectors);
+
+        // Returns whether "ns" is a capped collection, consulting and filling "cache" first.
+        static bool isCappedCollection(OperationContext* txn,
+                                       StringData ns,
+                                       std::map<StringData, bool>* cache);
         void handleSlaveDelay(const BSONObj& op);
 
         // persistent pool of worker threads for writing ops to the databases
@@ -60,6 +60,7 @@
 #include "mongo/s/mongos_options.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/print.h"
 #include "mongo/util/unowned_ptr.h"
@@ -70,6 +71,17 @@ namespace mongo {
         using boost::shared_ptr;
         using namespace mongoutils;
 
+        // Spill files are written in chunks of this size, so that every write is large and
+        // starts at an offset that is a multiple of it.
+        const size_t kFileWriteSize = 1024 * 1024;
+
+        // Bounds on the size of the chunks spill files are read in. See SortedFileWriter.
+        const size_t kMinFileReadSize = 64 * 1024;
+        const size_t kMaxFileReadSize = 1024 * 1024;
+
+        // Most groups of runs merged at the same time before the final merge.
+        const size_t kMaxMergeThreads = 4;
+
         // We need to use the "real" errno everywhere, not GetLastError() on Windows
         inline std::string myErrnoWithDescription() {
             int errnoCopy = errno;
@@ -164,9 +176,13 @@ namespace mongo {
 
             FileIterator(const std::string& fileName,
                          const Settings& settings,
-                         boost::shared_ptr<FileDeleter> fileDeleter)
+                         boost::shared_ptr<FileDeleter> fileDeleter,
+                         size_t readSize)
                 : _settings(settings)
                 , _done(false)
+                , _readSize(readSize)
+                , _readPos(0)
+                , _readEnd(0)
                 , _fileName(fileName)
                 , _fileDeleter(fileDeleter)
                 , _file(_fileName.c_str(), std::ios::in | std::ios::binary)
@@ -213,24 +229,34 @@ namespace mongo {
                 const bool compressed = rawSize < 0;
                 const int32_t blockSize = std::abs(rawSize);
 
-                _buffer.reset(new char[blockSize]);
-                read(_buffer.get(), blockSize);
-                massert(16816, "file too short?", !_done);
+                // Use the block where it is when it was read in whole, since _readBuffer isn't
+                // refilled before the next call to fill().
+                const char* block;
+                if (_readEnd - _readPos >= static_cast<size_t>(blockSize)) {
+                    block = _readBuffer.get() + _readPos;
+                    _readPos += blockSize;
+                }
+                else {
+                    _buffer.reset(new char[blockSize]);
+                    read(_buffer.get(), blockSize);
+                    massert(16816, "file too short?", !_done);
+                    block = _buffer.get();
+                }
 
                 if (!compressed) {
-                    _reader.reset(new BufReader(_buffer.get(), blockSize));
+                    _reader.reset(new BufReader(block, blockSize));
                     return;
                 }
 
-                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+                dassert(snappy::IsValidCompressedBuffer(block, blockSize));
 
                 size_t uncompressedSize;
                 massert(17061, "couldn't get uncompressed length",
-                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                        snappy::GetUncompressedLength(block, blockSize, &uncompressedSize));
 
                 boost::scoped_array<char> decompressionBuffer(new char[uncompressedSize]);
                 massert(17062, "decompression failed",
-                        snappy::RawUncompress(_buffer.get(),
+                        snappy::RawUncompress(block,
                                               blockSize,
                                               decompressionBuffer.get()));
 
@@ -241,22 +267,46 @@ namespace mongo {
 
             // sets _done to true on EOF - asserts on any other error
             void read(void* out, size_t size) {
-                _file.read(reinterpret_cast<char*>(out), size);
-                if (!_file.good()) {
-                    if (_file.eof()) {
-                        _done = true;
-                        return;
+                char* dest = reinterpret_cast<char*>(out);
+                while (size > 0) {
+                    if (_readPos == _readEnd) {
+                        refill();
+                        if (_readEnd == 0) {
+                            _done = true;
+                            return;
+                        }
                     }
 
+                    const size_t toCopy = std::min(size, _readEnd - _readPos);
+                    memcpy(dest, _readBuffer.get() + _readPos, toCopy);
+                    _readPos += toCopy;
+                    dest += toCopy;
+                    size -= toCopy;
+                }
+            }
+
+            // Reads the next _readSize bytes of the file into _readBuffer. Every read starts at a
+            // multiple of _readSize, and only the last one is short.
+            void refill() {
+                if (!_readBuffer)
+                    _readBuffer.reset(new char[_readSize]);
+
+                _file.read(_readBuffer.get(), _readSize);
+                if (_file.bad() || (_file.fail() && !_file.eof())) {
                     msgasserted(16817, str::stream() << "error reading file \""
                                                      << _fileName << "\": "
                                                      << myErrnoWithDescription());
                 }
-                verify(_file.gcount() == static_cast<std::streamsize>(size));
+                _readPos = 0;
+                _readEnd = _file.gcount();
             }
 
             const Settings _settings;
             bool _done;
+            const size_t _readSize;
+            boost::scoped_array<char> _readBuffer; // the chunk of the file last read
+            size_t _readPos; // next unconsumed byte of _readBuffer
+            size_t _readEnd; // number of valid bytes in _readBuffer
             boost::scoped_array<char> _buffer;
             boost::scoped_ptr<BufReader> _reader;
             std::string _fileName;
@@ -388,6 +438,128 @@ namespace mongo {
             STLComparator _greater; // named so calls make sense
         };
 
+        /** Merges a group of consecutive spilled runs into a single new one */
+        template <typename Key, typename Value, typename Comparator>
+        class GroupMerge {
+        public:
+            typedef SortIteratorInterface<Key, Value> Iterator;
+            typedef std::pair<Key, Value> Data;
+            typedef std::pair<typename Key::SorterDeserializeSettings
+                             ,typename Value::SorterDeserializeSettings
+                             > Settings;
+
+            GroupMerge(const std::vector<shared_ptr<Iterator> >& inputs,
+                       const SortOptions& opts,
+                       const Comparator& comp,
+                       const Settings& settings)
+                : _inputs(inputs)
+                , _opts(opts)
+                , _comp(comp)
+                , _settings(settings)
+                , _errorCode(0)
+            {}
+
+            // Runs on a ThreadPool worker, so errors are kept for rethrowError().
+            void run() {
+                try {
+                    boost::scoped_ptr<Iterator> merged(Iterator::merge(_inputs, _opts, _comp));
+                    SortedFileWriter<Key, Value> writer(_opts, _settings);
+                    while (merged->more()) {
+                        const Data data = merged->next();
+                        writer.addAlreadySorted(data.first, data.second);
+                    }
+
+                    // Deletes the input files before the output is closed.
+                    merged.reset();
+                    _inputs.clear();
+                    _output.reset(writer.done());
+                }
+                catch (const DBException& e) {
+                    _errorCode = e.getCode();
+                    _error = e.what();
+                }
+                catch (const std::exception& e) {
+                    _errorCode = 28713;
+                    _error = str::stream() << "error merging sorted runs: " << e.what();
+                }
+            }
+
+            void rethrowError() const {
+                if (_errorCode)
+                    msgasserted(_errorCode, _error);
+            }
+
+            const shared_ptr<Iterator>& output() const { return _output; }
+
+        private:
+            std::vector<shared_ptr<Iterator> > _inputs;
+            const SortOptions _opts;
+            const Comparator _comp;
+            const Settings _settings;
+            shared_ptr<Iterator> _output;
+            int _errorCode;
+            std::string _error;
+        };
+
+        /**
+         * Merges spilled runs ahead of the final merge until at most opts.maxMergeFanIn are
+         * left, so that the final merge reads a bounded number of files in large chunks
+         * instead of seeking between hundreds of them.
+         *
+         * Each pass merges just enough groups of consecutive runs to get under the fan-in, up
+         * to kMaxMergeThreads groups at a time. Merged runs keep their place in 'runs', which
+         * keeps the sort stable.
+         */
+        template <typename Key, typename Value, typename Comparator>
+        void mergeRunsToFanIn(
+                std::vector<shared_ptr<SortIteratorInterface<Key, Value> > >* runs,
+                const SortOptions& opts,
+                const Comparator& comp,
+                const typename GroupMerge<Key, Value, Comparator>::Settings& settings) {
+            typedef SortIteratorInterface<Key, Value> Iterator;
+            typedef GroupMerge<Key, Value, Comparator> Merge;
+
+            const size_t fanIn = std::max(opts.maxMergeFanIn, size_t(2));
+            while (runs->size() > fanIn) {
+                // Merging a group of N runs into one reduces the number of runs by N - 1.
+                size_t excess = runs->size() - fanIn;
+                std::vector<shared_ptr<Merge> > merges;
+                std::vector<size_t> mergePositions;
+                std::vector<shared_ptr<Iterator> > remaining;
+                for (size_t i = 0; i < runs->size(); ) {
+                    const size_t groupSize = std::min(std::min(fanIn, excess + 1),
+                                                      runs->size() - i);
+                    if (groupSize < 2) {
+                        remaining.push_back((*runs)[i++]);
+                        continue;
+                    }
+
+                    const std::vector<shared_ptr<Iterator> > group(runs->begin() + i,
+                                                                   runs->begin() + i + groupSize);
+                    merges.push_back(boost::make_shared<Merge>(group, opts, comp, settings));
+                    mergePositions.push_back(remaining.size());
+                    remaining.push_back(shared_ptr<Iterator>());
+                    excess -= groupSize - 1;
+                    i += groupSize;
+                }
+                runs->clear();
+
+                {
+                    ThreadPool workers(std::min(merges.size(), kMaxMergeThreads), "SorterMerge");
+                    for (size_t i = 0; i < merges.size(); i++) {
+                        workers.schedule(&Merge::run, merges[i].get());
+                    }
+                    workers.join();
+                }
+
+                for (size_t i = 0; i < merges.size(); i++) {
+                    merges[i]->rethrowError();
+                    remaining[mergePositions[i]] = merges[i]->output();
+                }
+                runs->swap(remaining);
+            }
+        }
+
         template <typename Key, typename Value, typename Comparator>
         class NoLimitSorter : public Sorter<Key, Value> {
         public:
@@ -423,6 +595,7 @@ namespace mongo {
                 }
 
                 spill();
+                mergeRunsToFanIn(&_iters, _opts, _comp, _settings);
                 return Iterator::merge(_iters, _opts, _comp);
             }
 
@@ -614,6 +787,7 @@ namespace mongo {
                 }
 
                 spill();
+                mergeRunsToFanIn(&_iters, _opts, _comp, _settings);
                 return Iterator::merge(_iters, _opts, _comp);
             }
 
@@ -786,6 +960,13 @@ namespace mongo {
     SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
                                                    const Settings& settings)
         : _settings(settings)
+        // Give each file open in a merge an equal share of the memory budget, counting
+        // the files read by every group merged at the same time.
+        , _readSize(std::max(sorter::kMinFileReadSize,
+                             std::min(sorter::kMaxFileReadSize,
+                                      opts.maxMemoryUsageBytes /
+                                          (std::max(opts.maxMergeFanIn, size_t(2)) *
+                                           sorter::kMaxMergeThreads))))
     {
         namespace str = mongoutils::str;
 
@@ -835,29 +1016,48 @@ namespace mongo {
         snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
         verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
+        if (compressed.size() < size_t(_buffer.len()/10*9)) {
+            const int32_t size = -int32_t(compressed.size()); // negative means compressed
+            _fileBuffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            _fileBuffer.append(compressed.data(), compressed.size());
+        } else {
+            const int32_t size = _buffer.len();
+            _fileBuffer.append(reinterpret_cast<const char*>(&size), sizeof(size));
+            _fileBuffer.append(_buffer.buf(), _buffer.len());
+        }
+
+        _buffer.reset();
+
+        if (_fileBuffer.size() >= sorter::kFileWriteSize)
+            writeFileBuffer(false);
+    }
+
+    template <typename Key, typename Value>
+    void SortedFileWriter<Key, Value>::writeFileBuffer(bool all) {
+        namespace str = mongoutils::str;
+
+        const size_t toWrite = all ? _fileBuffer.size()
+                                   : _fileBuffer.size() / sorter::kFileWriteSize
+                                                        * sorter::kFileWriteSize;
         try {
-            if (compressed.size() < size_t(_buffer.len()/10*9)) {
-                const int32_t size = -int32_t(compressed.size()); // negative means compressed
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(compressed.data(), compressed.size());
-            } else {
-                const int32_t size = _buffer.len();
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(_buffer.buf(), _buffer.len());
-            }
+            _file.write(_fileBuffer.data(), toWrite);
         } catch (const std::exception&) {
             msgasserted(16821, str::stream() << "error writing to file \"" << _fileName << "\": "
                                              << sorter::myErrnoWithDescription());
         }
 
-        _buffer.reset();
+        _fileBuffer.erase(0, toWrite);
     }
 
     template <typename Key, typename Value>
     SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
         spill();
+        writeFileBuffer(true);
         _file.close();
-        return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter);
+        return new sorter::FileIterator<Key, Value>(_fileName,
+                                                    _settings,
+                                                    _fileDeleter,
+                                                    _readSize);
     }
 
     //
@@ -98,11 +98,14 @@ namespace mongo {
         bool extSortAllowed; /// If false, uassert if more mem needed than allowed.
         std::string tempDir; /// Directory to directly place files in.
                              /// Must be explicitly set if extSortAllowed is true.
+        size_t maxMergeFanIn; /// Most spill files merged at once. Runs beyond this are first
+                              /// merged into larger ones, in parallel.
 
         SortOptions()
             : limit(0)
             , maxMemoryUsageBytes(64*1024*1024)
             , extSortAllowed(false)
+            , maxMergeFanIn(64)
         {}
 
         /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
@@ -126,6 +129,11 @@ namespace mongo {
             tempDir = newTempDir;
             return *this;
         }
+
+        SortOptions& MaxMergeFanIn(size_t newMaxMergeFanIn) {
+            maxMergeFanIn = newMaxMergeFanIn;
+            return *this;
+        }
     };
 
     /// This is the output from the sorting framework
@@ -200,11 +208,16 @@ namespace mongo {
     private:
         void spill();
 
+        /// Writes out the full sorter::kFileWriteSize chunks of _fileBuffer, or all of it.
+        void writeFileBuffer(bool all);
+
         const Settings _settings;
+        const size_t _readSize; // size of the reads done by the returned Iterator
         std::string _fileName;
         boost::shared_ptr<sorter::FileDeleter> _fileDeleter; // Must outlive _file
         std::ofstream _file;
-        BufBuilder _buffer;
+        BufBuilder _buffer; // the block being built
+        std::string _fileBuffer; // finished blocks not yet written to _file
     };
 }
 
@@ -224,6 +237,7 @@ namespace mongo {
     template class ::mongo::sorter::MergeIterator<Key, Value, Comparator>; \
     template class ::mongo::sorter::InMemIterator<Key, Value>; \
     template class ::mongo::sorter::FileIterator<Key, Value>; \
+    template class ::mongo::sorter::GroupMerge<Key, Value, Comparator>; \
     /* factory functions */ \
     template ::mongo::SortIteratorInterface<Key, Value>* \
                 ::mongo::SortIteratorInterface<Key, Value>::merge<Comparator>( \
@@ -500,6 +500,14 @@ namespace mongo {
             boost::scoped_array<int> _array;
         };
 
+        template <bool Random=true>
+        class LotsOfDataNarrowMerge : public LotsOfDataLittleMemory<Random> {
+            SortOptions adjustSortOptions(SortOptions opts) {
+                // Takes several passes of intermediate merges to get down to 3 files.
+                return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).MaxMergeFanIn(3);
+            }
+        };
+
 
         template <long long Limit, bool Random=true>
         class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -541,6 +549,8 @@ namespace mongo {
             add<SorterTests::Dupes>();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/false> >();
             add<SorterTests::LotsOfDataLittleMemory</*random=*/true> >();
+            add<SorterTests::LotsOfDataNarrowMerge</*random=*/false> >();
+            add<SorterTests::LotsOfDataNarrowMerge</*random=*/true> >();
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/false> >(); // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<1,/*random=*/true> >();  // limit=1 is special case
             add<SorterTests::LotsOfDataWithLimit<100,/*random=*/false> >(); // fits in mem
@@ -42,6 +42,7 @@
 #include "mongo/db/storage_options.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/log.h"
+#include "mongo/util/numa_placement.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/version.h"
 
@@ -205,7 +206,8 @@ namespace {
                     }
                     // if the text following the space doesn't begin with 'interleave', then
                     // issue the warning.
-                    else if (line.find("interleave", where) != where) {
+                    else if (line.find("interleave", where) != where &&
+                             !NumaPlacement::enabled()) {
                         log() << startupWarningsLog;
                         log() << "** WARNING: You are running on a NUMA machine."
                               << startupWarningsLog;
@@ -45,37 +45,37 @@ namespace mongo {
 
     void OpCounters::incInsertInWriteLock(int n) {
         RARELY _checkWrap();
-        _insert.fetchAndAdd(n);
+        _counters.add(Insert, n);
     }
 
     void OpCounters::gotInsert() {
         RARELY _checkWrap();
-        _insert.fetchAndAdd(1);
+        _counters.add(Insert, 1);
     }
 
     void OpCounters::gotQuery() {
         RARELY _checkWrap();
-        _query.fetchAndAdd(1);
+        _counters.add(Query, 1);
     }
 
     void OpCounters::gotUpdate() {
         RARELY _checkWrap();
-        _update.fetchAndAdd(1);
+        _counters.add(Update, 1);
     }
 
     void OpCounters::gotDelete() {
         RARELY _checkWrap();
-        _delete.fetchAndAdd(1);
+        _counters.add(Delete, 1);
     }
 
     void OpCounters::gotGetMore() {
         RARELY _checkWrap();
-        _getmore.fetchAndAdd(1);
+        _counters.add(GetMore, 1);
     }
 
     void OpCounters::gotCommand() {
         RARELY _checkWrap();
-        _command.fetchAndAdd(1);
+        _counters.add(Command, 1);
     }
 
     void OpCounters::gotOp( int op , bool isCommand ) {
@@ -100,66 +100,40 @@ namespace mongo {
     }
 
     void OpCounters::_checkWrap() {
-        const unsigned MAX = 1 << 30;
+        const long long MAX = 1 << 30;
         
-        bool wrap =
-            _insert.loadRelaxed() > MAX ||
-            _query.loadRelaxed() > MAX ||
-            _update.loadRelaxed() > MAX ||
-            _delete.loadRelaxed() > MAX ||
-            _getmore.loadRelaxed() > MAX ||
-            _command.loadRelaxed() > MAX;
+        bool wrap = false;
+        for ( int counter = 0; counter < NumCounters && !wrap; ++counter ) {
+            wrap = _counters.get(counter) > MAX;
+        }
         
         if ( wrap ) {
-            _insert.store(0);
-            _query.store(0);
-            _update.store(0);
-            _delete.store(0);
-            _getmore.store(0);
-            _command.store(0);
+            _counters.reset();
         }
     }
 
     BSONObj OpCounters::getObj() const {
         BSONObjBuilder b;
-        b.append( "insert" , _insert.loadRelaxed() );
-        b.append( "query" , _query.loadRelaxed() );
-        b.append( "update" , _update.loadRelaxed() );
-        b.append( "delete" , _delete.loadRelaxed() );
-        b.append( "getmore" , _getmore.loadRelaxed() );
-        b.append( "command" , _command.loadRelaxed() );
+        b.append( "insert" , static_cast<unsigned>( _counters.get(Insert) ) );
+        b.append( "query" , static_cast<unsigned>( _counters.get(Query) ) );
+        b.append( "update" , static_cast<unsigned>( _counters.get(Update) ) );
+        b.append( "delete" , static_cast<unsigned>( _counters.get(Delete) ) );
+        b.append( "getmore" , static_cast<unsigned>( _counters.get(GetMore) ) );
+        b.append( "command" , static_cast<unsigned>( _counters.get(Command) ) );
         return b.obj();
     }
 
     void NetworkCounter::hit( long long bytesIn , long long bytesOut ) {
-        const long long MAX = 1ULL << 60;
-
-        // don't care about the race as its just a counter
-        bool overflow = _bytesIn > MAX || _bytesOut > MAX;
-
-        if ( overflow ) {
-            _lock.lock();
-            _overflows++;
-            _bytesIn = bytesIn;
-            _bytesOut = bytesOut;
-            _requests = 1;
-            _lock.unlock();
-        }
-        else {
-            _lock.lock();
-            _bytesIn += bytesIn;
-            _bytesOut += bytesOut;
-            _requests++;
-            _lock.unlock();
-        }
+        // The partitions are 64 bit, so unlike a single total they can't realistically overflow
+        _counters.add(BytesIn, bytesIn);
+        _counters.add(BytesOut, bytesOut);
+        _counters.add(Requests, 1);
     }
 
     void NetworkCounter::append( BSONObjBuilder& b ) {
-        _lock.lock();
-        b.appendNumber( "bytesIn" , _bytesIn );
-        b.appendNumber( "bytesOut" , _bytesOut );
-        b.appendNumber( "numRequests" , _requests );
-        _lock.unlock();
+        b.appendNumber( "bytesIn" , _counters.get(BytesIn) );
+        b.appendNumber( "bytesOut" , _counters.get(BytesOut) );
+        b.appendNumber( "numRequests" , _counters.get(Requests) );
     }
 
 
@@ -0,0 +1,180 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace mongo {
+
+namespace {
+
+    // Spreads recording threads across partitions where the current CPU is not known.
+    AtomicUInt32 partitionGen;
+
+    /**
+     * Returns the largest latency counted in bucket "bucket", or for the last bucket, which has no
+     * upper bound, the smallest.
+     */
+    long long bucketBoundMicros(int bucket) {
+        if (bucket == 0) {
+            return 0;
+        }
+        if (bucket == LatencyHistogram::kNumBuckets - 1) {
+            return 1LL << (bucket - 1);
+        }
+        return (1LL << bucket) - 1;
+    }
+
+}  // namespace
+
+    LatencyHistogram::Counts::Counts() : count(0), totalMicros(0) {
+        std::fill(buckets, buckets + kNumBuckets, 0LL);
+    }
+
+    void LatencyHistogram::Counts::add(const LatencyHistogram& histogram) {
+        count += histogram.getCount();
+        totalMicros += histogram.getTotalMicros();
+        for (int i = 0; i < kNumBuckets; i++) {
+            buckets[i] += histogram.getBucketCount(i);
+        }
+    }
+
+    long long LatencyHistogram::Counts::getPercentileMicros(double quantile) const {
+        // The buckets are read one by one while other threads record, so sum them up rather than
+        // trusting "count".
+        long long total = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            total += buckets[i];
+        }
+        if (total == 0) {
+            return 0;
+        }
+
+        const long long rank = std::max(1LL, static_cast<long long>(std::ceil(quantile * total)));
+        long long seen = 0;
+        for (int i = 0; i < kNumBuckets; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                return bucketBoundMicros(i);
+            }
+        }
+        return bucketBoundMicros(kNumBuckets - 1);
+    }
+
+    BSONObj LatencyHistogram::Counts::toBSON() const {
+        BSONObjBuilder b;
+        b.appendNumber("count", count);
+        b.appendNumber("totalMicros", totalMicros);
+        b.appendNumber("p50Micros", getPercentileMicros(0.5));
+        b.appendNumber("p99Micros", getPercentileMicros(0.99));
+        b.appendNumber("p999Micros", getPercentileMicros(0.999));
+
+        BSONArrayBuilder bucketsBuilder(b.subarrayStart("buckets"));
+        for (int i = 0; i < kNumBuckets; i++) {
+            if (buckets[i] == 0) {
+                continue;
+            }
+            BSONObjBuilder bucket(bucketsBuilder.subobjStart());
+            bucket.appendNumber("lowerBoundMicros", i == 0 ? 0LL : 1LL << (i - 1));
+            bucket.appendNumber("count", buckets[i]);
+            bucket.doneFast();
+        }
+        bucketsBuilder.doneFast();
+
+        return b.obj();
+    }
+
+    int LatencyHistogram::bucketFor(long long micros) {
+        int bucket = 0;
+        while (micros > 0 && bucket < kNumBuckets - 1) {
+            micros >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    void LatencyHistogram::recordMicros(long long micros) {
+        if (micros < 0) {
+            // The clock went backwards; count it as instantaneous.
+            micros = 0;
+        }
+        _count.fetchAndAdd(1);
+        _totalMicros.fetchAndAdd(micros);
+        _buckets[bucketFor(micros)].fetchAndAdd(1);
+    }
+
+    long long LatencyHistogram::getBucketCount(int bucket) const {
+        invariant(bucket >= 0 && bucket < kNumBuckets);
+        return _buckets[bucket].loadRelaxed();
+    }
+
+    BSONObj LatencyHistogram::getReport() const {
+        Counts counts;
+        counts.add(*this);
+        return counts.toBSON();
+    }
+
+    void PartitionedLatencyHistogram::recordMicros(long long micros) {
+        _partitions[_currentPartition()].histogram.recordMicros(micros);
+    }
+
+    LatencyHistogram::Counts PartitionedLatencyHistogram::getCounts() const {
+        LatencyHistogram::Counts counts;
+        for (int i = 0; i < kNumPartitions; i++) {
+            counts.add(_partitions[i].histogram);
+        }
+        return counts;
+    }
+
+    long long PartitionedLatencyHistogram::getCount() const {
+        long long count = 0;
+        for (int i = 0; i < kNumPartitions; i++) {
+            count += _partitions[i].histogram.getCount();
+        }
+        return count;
+    }
+
+    // static
+    int PartitionedLatencyHistogram::_currentPartition() {
+#ifdef __linux__
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return cpu % kNumPartitions;
+        }
+#endif
+        return partitionGen.addAndFetch(1) % kNumPartitions;
+    }
+
+}  // namespace mongo
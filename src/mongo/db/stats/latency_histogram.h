@@ -0,0 +1,135 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Thread-safe histogram of operation latencies, in microseconds.
+     *
+     * Bucket 0 counts latencies below 1 microsecond and bucket i (i > 0) counts latencies in
+     * [2^(i-1), 2^i) microseconds; the last bucket also counts everything larger. Recording is a
+     * couple of relaxed atomic increments, so it is cheap enough for hot paths.
+     */
+    class LatencyHistogram {
+    public:
+        static const int kNumBuckets = 32;
+
+        /**
+         * A plain copy of the counts of one or more histograms, used to aggregate and report them.
+         */
+        struct Counts {
+            Counts();
+
+            void add(const LatencyHistogram& histogram);
+
+            /**
+             * Returns an upper bound on the latency below which fraction "quantile" of the recorded
+             * latencies fall: the upper bound of the bucket holding that latency. The last bucket
+             * has no upper bound, so its lower bound is returned instead. Returns 0 if empty.
+             */
+            long long getPercentileMicros(double quantile) const;
+
+            /**
+             * See LatencyHistogram::getReport().
+             */
+            BSONObj toBSON() const;
+
+            long long count;
+            long long totalMicros;
+            long long buckets[kNumBuckets];
+        };
+
+        void recordMicros(long long micros);
+
+        /**
+         * Returns the number of recorded latencies that fall in bucket "bucket".
+         */
+        long long getBucketCount(int bucket) const;
+
+        long long getCount() const { return _count.loadRelaxed(); }
+        long long getTotalMicros() const { return _totalMicros.loadRelaxed(); }
+
+        /**
+         * Returns the bucket "micros" is counted in.
+         */
+        static int bucketFor(long long micros);
+
+        /**
+         * Returns { count: <n>, totalMicros: <n>, p50Micros: <n>, p99Micros: <n>,
+         * p999Micros: <n>, buckets: [ { lowerBoundMicros: <n>, count: <n> }, ... ] }, where only
+         * non-empty buckets are listed. The percentiles are computed as for
+         * Counts::getPercentileMicros().
+         */
+        BSONObj getReport() const;
+        operator BSONObj() const { return getReport(); }
+
+    private:
+        AtomicInt64 _count;
+        AtomicInt64 _totalMicros;
+        AtomicInt64 _buckets[kNumBuckets];
+    };
+
+    /**
+     * A LatencyHistogram split into a few partitions chosen by the current CPU, so that threads
+     * recording at the same time on different cores rarely touch the same cache lines. Meant for
+     * process-wide histograms that every operation records into; reading it sums the partitions.
+     */
+    class PartitionedLatencyHistogram {
+    public:
+        static const int kNumPartitions = 16;
+
+        void recordMicros(long long micros);
+
+        LatencyHistogram::Counts getCounts() const;
+
+        long long getCount() const;
+
+        /**
+         * Same format as LatencyHistogram::getReport().
+         */
+        BSONObj getReport() const { return getCounts().toBSON(); }
+        operator BSONObj() const { return getReport(); }
+
+    private:
+        static const size_t kCacheLineSize = 64;
+
+        struct Partition {
+            LatencyHistogram histogram;
+            char padding[kCacheLineSize - sizeof(LatencyHistogram) % kCacheLineSize];
+        };
+
+        static int _currentPartition();
+
+        Partition _partitions[kNumPartitions];
+    };
+
+}  // namespace mongo
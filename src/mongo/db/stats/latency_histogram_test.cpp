@@ -0,0 +1,119 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST(LatencyHistogramTest, BucketBoundaries) {
+        ASSERT_EQUALS(0, LatencyHistogram::bucketFor(0));
+        ASSERT_EQUALS(1, LatencyHistogram::bucketFor(1));
+        ASSERT_EQUALS(2, LatencyHistogram::bucketFor(2));
+        ASSERT_EQUALS(2, LatencyHistogram::bucketFor(3));
+        ASSERT_EQUALS(3, LatencyHistogram::bucketFor(4));
+        ASSERT_EQUALS(11, LatencyHistogram::bucketFor(1024));
+        ASSERT_EQUALS(LatencyHistogram::kNumBuckets - 1,
+                      LatencyHistogram::bucketFor(1LL << 62));
+    }
+
+    TEST(LatencyHistogramTest, Record) {
+        LatencyHistogram histogram;
+        histogram.recordMicros(0);
+        histogram.recordMicros(3);
+        histogram.recordMicros(2);
+        histogram.recordMicros(-5);
+
+        ASSERT_EQUALS(4, histogram.getCount());
+        ASSERT_EQUALS(5, histogram.getTotalMicros());
+        ASSERT_EQUALS(2, histogram.getBucketCount(0));
+        ASSERT_EQUALS(0, histogram.getBucketCount(1));
+        ASSERT_EQUALS(2, histogram.getBucketCount(2));
+    }
+
+    TEST(LatencyHistogramTest, ReportListsNonEmptyBuckets) {
+        LatencyHistogram histogram;
+        histogram.recordMicros(5);
+        histogram.recordMicros(6);
+        histogram.recordMicros(100);
+
+        BSONObj report = histogram.getReport();
+        ASSERT_EQUALS(3, report["count"].numberLong());
+        ASSERT_EQUALS(111, report["totalMicros"].numberLong());
+
+        std::vector<BSONElement> buckets = report["buckets"].Array();
+        ASSERT_EQUALS(2U, buckets.size());
+        ASSERT_EQUALS(4, buckets[0]["lowerBoundMicros"].numberLong());
+        ASSERT_EQUALS(2, buckets[0]["count"].numberLong());
+        ASSERT_EQUALS(64, buckets[1]["lowerBoundMicros"].numberLong());
+        ASSERT_EQUALS(1, buckets[1]["count"].numberLong());
+    }
+
+    TEST(LatencyHistogramTest, Percentiles) {
+        LatencyHistogram::Counts empty;
+        ASSERT_EQUALS(0, empty.getPercentileMicros(0.5));
+
+        LatencyHistogram histogram;
+        for (int i = 0; i < 990; i++) {
+            histogram.recordMicros(5);
+        }
+        for (int i = 0; i < 9; i++) {
+            histogram.recordMicros(100);
+        }
+        histogram.recordMicros(5000);
+
+        LatencyHistogram::Counts counts;
+        counts.add(histogram);
+        ASSERT_EQUALS(7, counts.getPercentileMicros(0.5));
+        ASSERT_EQUALS(7, counts.getPercentileMicros(0.99));
+        ASSERT_EQUALS(127, counts.getPercentileMicros(0.999));
+        ASSERT_EQUALS(8191, counts.getPercentileMicros(1.0));
+
+        BSONObj report = histogram.getReport();
+        ASSERT_EQUALS(7, report["p50Micros"].numberLong());
+        ASSERT_EQUALS(127, report["p999Micros"].numberLong());
+    }
+
+    TEST(LatencyHistogramTest, PartitionedSumsPartitions) {
+        PartitionedLatencyHistogram histogram;
+        histogram.recordMicros(5);
+        histogram.recordMicros(6);
+        histogram.recordMicros(100);
+
+        ASSERT_EQUALS(3, histogram.getCount());
+        LatencyHistogram::Counts counts = histogram.getCounts();
+        ASSERT_EQUALS(111, counts.totalMicros);
+        ASSERT_EQUALS(2, counts.buckets[LatencyHistogram::bucketFor(5)]);
+        ASSERT_EQUALS(1, counts.buckets[LatencyHistogram::bucketFor(100)]);
+        ASSERT_EQUALS(3, histogram.getReport()["count"].numberLong());
+    }
+
+} // namespace
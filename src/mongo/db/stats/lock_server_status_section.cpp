@@ -121,6 +121,9 @@ namespace {
 
         virtual bool includeByDefault() const { return true; }
 
+        // Sums the stats of every lock resource.
+        virtual bool isExpensive() const { return true; }
+
         virtual BSONObj generateSection(OperationContext* txn,
                                         const BSONElement& configElement) const {
             BSONObjBuilder ret;
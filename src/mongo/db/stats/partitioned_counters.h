@@ -0,0 +1,88 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/compiler.h"
+
+namespace mongo {
+
+    /**
+     * Returns the partition of partitioned statistics which the calling thread updates. Threads
+     * are spread over the partitions in the order they first ask.
+     */
+    size_t currentStatsPartition();
+
+    /**
+     * A set of NumCounters counters which many threads update at once, such as the opcounters.
+     * Each thread adds to its own partition, a cache line holding a copy of every counter, so that
+     * concurrent threads rarely write to the same cache line. Reads sum the partitions, and are
+     * not atomic with respect to concurrent additions or to the other counters.
+     */
+    template <int NumCounters>
+    class PartitionedCounters {
+        MONGO_DISALLOW_COPYING(PartitionedCounters);
+    public:
+
+        enum { NumPartitions = 64 };
+
+        PartitionedCounters() { }
+
+        void add(int counter, long long n) {
+            _partitions[currentStatsPartition() % NumPartitions].values[counter].fetchAndAdd(n);
+        }
+
+        long long get(int counter) const {
+            long long total = 0;
+            for (int i = 0; i < NumPartitions; i++) {
+                total += _partitions[i].values[counter].loadRelaxed();
+            }
+            return total;
+        }
+
+        void reset() {
+            for (int i = 0; i < NumPartitions; i++) {
+                for (int counter = 0; counter < NumCounters; counter++) {
+                    _partitions[i].values[counter].store(0);
+                }
+            }
+        }
+
+    private:
+
+        // Aligned like the partitions of the lock statistics, to avoid false sharing.
+        struct MONGO_COMPILER_ALIGN_TYPE(128) Partition {
+            AtomicInt64 values[NumCounters];
+        };
+
+        Partition _partitions[NumPartitions];
+    };
+
+}  // namespace mongo
@@ -0,0 +1,86 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/db/stats/partitioned_counters.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    typedef PartitionedCounters<2> TestCounters;
+
+    void addMany(TestCounters* counters, size_t* partition) {
+        *partition = currentStatsPartition();
+        for (int i = 0; i < 1000; i++) {
+            counters->add(0, 1);
+            counters->add(1, 2);
+        }
+    }
+
+    TEST(PartitionedCountersTest, AddGetReset) {
+        TestCounters counters;
+        ASSERT_EQUALS(0, counters.get(0));
+
+        counters.add(0, 5);
+        counters.add(1, -2);
+        counters.add(0, 1);
+        ASSERT_EQUALS(6, counters.get(0));
+        ASSERT_EQUALS(-2, counters.get(1));
+
+        counters.reset();
+        ASSERT_EQUALS(0, counters.get(0));
+        ASSERT_EQUALS(0, counters.get(1));
+    }
+
+    TEST(PartitionedCountersTest, SumsThreads) {
+        TestCounters counters;
+        const int numThreads = 8;
+        size_t partitions[numThreads];
+
+        boost::thread_group threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.create_thread(stdx::bind(&addMany, &counters, &partitions[i]));
+        }
+        threads.join_all();
+
+        ASSERT_EQUALS(numThreads * 1000, counters.get(0));
+        ASSERT_EQUALS(numThreads * 2000, counters.get(1));
+
+        // Every thread got its own partition
+        for (int i = 1; i < numThreads; i++) {
+            ASSERT_NOT_EQUALS(partitions[0], partitions[i]);
+        }
+    }
+
+}  // namespace
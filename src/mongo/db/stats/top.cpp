@@ -89,6 +89,37 @@ namespace {
 
         CollectionData& coll = _usage[ns];
         _record( coll, op, lockType, micros, command );
+        _recordLatency( ns, op, micros, command );
+    }
+
+    void Top::_recordLatency( StringData ns, int op, long long micros, bool command ) {
+        LatencyHistogram LatencyData::* histogram;
+        switch ( op ) {
+        case dbUpdate:
+            histogram = &LatencyData::update;
+            break;
+        case dbInsert:
+            histogram = &LatencyData::insert;
+            break;
+        case dbQuery:
+            histogram = command ? &LatencyData::commands : &LatencyData::queries;
+            break;
+        case dbGetMore:
+            histogram = &LatencyData::getmore;
+            break;
+        case dbDelete:
+            histogram = &LatencyData::remove;
+            break;
+        default:
+            // Other operations only count towards the totals
+            return;
+        }
+
+        std::shared_ptr<LatencyData>& latencies = _latencies[ns];
+        if ( !latencies ) {
+            latencies = std::make_shared<LatencyData>();
+        }
+        ((*latencies).*histogram).recordMicros( micros );
     }
 
     void Top::_record( CollectionData& c, int op, int lockType, long long micros, bool command ) {
@@ -136,6 +167,7 @@ namespace {
     void Top::collectionDropped( StringData ns ) {
         SimpleMutex::scoped_lock lk(_lock);
         _usage.erase(ns);
+        _latencies.erase(ns);
         _lastDropped = ns.toString();
     }
 
@@ -180,6 +212,40 @@ namespace {
         }
     }
 
+    void Top::appendLatencyHistograms( BSONObjBuilder& b ) const {
+        SimpleMutex::scoped_lock lk( _lock );
+
+        vector<string> names;
+        for ( LatencyMap::const_iterator i = _latencies.begin(); i != _latencies.end(); ++i ) {
+            names.push_back( i->first );
+        }
+
+        std::sort( names.begin(), names.end() );
+
+        for ( size_t i=0; i<names.size(); i++ ) {
+            BSONObjBuilder bb( b.subobjStart( names[i] ) );
+
+            const LatencyData& latencies = *_latencies.find(names[i])->second;
+
+            _appendLatencyEntry( bb, "queries", latencies.queries );
+            _appendLatencyEntry( bb, "getmore", latencies.getmore );
+            _appendLatencyEntry( bb, "insert", latencies.insert );
+            _appendLatencyEntry( bb, "update", latencies.update );
+            _appendLatencyEntry( bb, "remove", latencies.remove );
+            _appendLatencyEntry( bb, "commands", latencies.commands );
+
+            bb.done();
+        }
+    }
+
+    void Top::_appendLatencyEntry( BSONObjBuilder& b,
+                                   const char* statsName,
+                                   const LatencyHistogram& histogram ) const {
+        if ( histogram.getCount() == 0 )
+            return;
+        b.append( statsName, histogram.getReport() );
+    }
+
     void Top::_appendStatsEntry( BSONObjBuilder& b, const char * statsName, const UsageData& map ) const {
         BSONObjBuilder bb( b.subobjStart( statsName ) );
         bb.appendNumber( "time", map.time );
@@ -30,7 +30,9 @@
 #pragma once
 
 #include <boost/date_time/posix_time/posix_time.hpp>
+#include <memory>
 
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -82,19 +84,45 @@ namespace mongo {
 
         typedef StringMap<CollectionData> UsageMap;
 
+        /**
+         * Latency distributions of the operations on one collection, by operation type.
+         * Histograms are not copyable, so unlike CollectionData they are kept out of UsageMap.
+         */
+        struct LatencyData {
+            LatencyHistogram queries;
+            LatencyHistogram getmore;
+            LatencyHistogram insert;
+            LatencyHistogram update;
+            LatencyHistogram remove;
+            LatencyHistogram commands;
+        };
+
+        typedef StringMap<std::shared_ptr<LatencyData> > LatencyMap;
+
     public:
         void record( StringData ns, int op, int lockType, long long micros, bool command );
         void append( BSONObjBuilder& b );
         void cloneMap(UsageMap& out) const;
         void collectionDropped( StringData ns );
 
+        /**
+         * Appends a subobject per collection with a LatencyHistogram report for each operation
+         * type that has been recorded for it.
+         */
+        void appendLatencyHistograms( BSONObjBuilder& b ) const;
+
     private:
         void _appendToUsageMap( BSONObjBuilder& b, const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b, const char * statsName, const UsageData& map ) const;
+        void _appendLatencyEntry( BSONObjBuilder& b,
+                                  const char* statsName,
+                                  const LatencyHistogram& histogram ) const;
         void _record( CollectionData& c, int op, int lockType, long long micros, bool command );
+        void _recordLatency( StringData ns, int op, long long micros, bool command );
 
         mutable SimpleMutex _lock;
         UsageMap _usage;
+        LatencyMap _latencies;
         std::string _lastDropped;
     };
 
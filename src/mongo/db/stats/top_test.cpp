@@ -28,8 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/jsobj.h"
 #include "mongo/db/stats/top.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
 
 namespace {
 
@@ -39,4 +41,32 @@ namespace {
         Top().collectionDropped("coll");
     }
 
+    TEST(TopTest, LatencyHistogramsByOpType) {
+        Top top;
+        top.record("test.coll", dbInsert, 1, 10, false);
+        top.record("test.coll", dbInsert, 1, 20, false);
+        top.record("test.coll", dbQuery, -1, 300, true);
+        top.record("test.other", dbQuery, -1, 5, false);
+        top.record("test.other", dbKillCursors, 0, 5, false);
+
+        BSONObjBuilder b;
+        top.appendLatencyHistograms(b);
+        BSONObj histograms = b.obj();
+
+        BSONObj coll = histograms["test.coll"].Obj();
+        ASSERT_EQUALS(2, coll["insert"]["count"].numberLong());
+        ASSERT_EQUALS(30, coll["insert"]["totalMicros"].numberLong());
+        ASSERT_EQUALS(1, coll["commands"]["count"].numberLong());
+        ASSERT_FALSE(coll.hasField("queries"));
+
+        BSONObj other = histograms["test.other"].Obj();
+        ASSERT_EQUALS(1, other["queries"]["count"].numberLong());
+        ASSERT_EQUALS(1, other.nFields());
+
+        top.collectionDropped("test.coll");
+        BSONObjBuilder afterDrop;
+        top.appendLatencyHistograms(afterDrop);
+        ASSERT_FALSE(afterDrop.obj().hasField("test.coll"));
+    }
+
 } // namespace
@@ -0,0 +1,434 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/field_name_dictionary.h"
+
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+
+#include "mongo/base/data_view.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+    // Every encoded document starts with this, followed by the size of the BSON document.
+    const unsigned char kFormatVersion = 1;
+
+    // Written in place of the type of an array whose field names aren't "0", "1", ..., so that
+    // they are kept like the names of an object's fields.
+    const unsigned char kNamedArray = 0x40;
+
+    // Deeper documents can't be stored, so this only guards against damaged data.
+    const int kMaxDepth = 256;
+
+    /**
+     * Sets '*size' to the size of every value of 'type', or to -1 if it varies from value to
+     * value. Returns false if 'type' isn't a BSON type.
+     */
+    bool valueSizeOf(BSONType type, int* size) {
+        switch (type) {
+        case NumberDouble:
+        case Date:
+        case bsonTimestamp:
+        case NumberLong:
+            *size = 8;
+            return true;
+        case NumberInt:
+            *size = 4;
+            return true;
+        case jstOID:
+            *size = OID::kOIDSize;
+            return true;
+        case Bool:
+            *size = 1;
+            return true;
+        case Undefined:
+        case jstNULL:
+        case MinKey:
+        case MaxKey:
+            *size = 0;
+            return true;
+        case String:
+        case BinData:
+        case RegEx:
+        case DBRef:
+        case Code:
+        case Symbol:
+        case CodeWScope:
+            *size = -1;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * Writes 'index' out in decimal, the way arrays name their elements, and returns its length.
+     * 'buf' must have room for ten characters.
+     */
+    size_t formatIndex(unsigned index, char* buf) {
+        char digits[10];
+        size_t len = 0;
+        do {
+            digits[len++] = '0' + index % 10;
+            index /= 10;
+        } while (index);
+        std::reverse_copy(digits, digits + len, buf);
+        return len;
+    }
+
+    bool hasIndexNames(const BSONObj& array) {
+        unsigned index = 0;
+        BSONObjIterator it(array);
+        while (it.more()) {
+            char buf[10];
+            const size_t len = formatIndex(index++, buf);
+            if (it.next().fieldNameStringData() != StringData(buf, len)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void appendVarint(BufBuilder* out, unsigned value) {
+        while (value >= 0x80) {
+            out->appendUChar(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        out->appendUChar(static_cast<unsigned char>(value));
+    }
+
+    Status damaged(const std::string& what) {
+        return Status(ErrorCodes::InvalidBSON,
+                      str::stream() << "can't decode stored document: " << what);
+    }
+} // namespace
+
+    class FieldNameDictionary::Reader {
+    public:
+        Reader(const char* data, size_t len) : _pos(data), _end(data + len) {}
+
+        bool atEnd() const { return _pos == _end; }
+
+        bool readByte(unsigned char* out) {
+            if (_pos == _end) {
+                return false;
+            }
+            *out = static_cast<unsigned char>(*_pos++);
+            return true;
+        }
+
+        bool readVarint(unsigned* out) {
+            unsigned value = 0;
+            for (int shift = 0; shift < 32; shift += 7) {
+                unsigned char byte;
+                if (!readByte(&byte)) {
+                    return false;
+                }
+                value |= static_cast<unsigned>(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) {
+                    *out = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool readCString(StringData* out) {
+            const char* nul = static_cast<const char*>(memchr(_pos, '\0', _end - _pos));
+            if (!nul) {
+                return false;
+            }
+            *out = StringData(_pos, nul - _pos);
+            _pos = nul + 1;
+            return true;
+        }
+
+        bool readBytes(size_t len, const char** out) {
+            if (static_cast<size_t>(_end - _pos) < len) {
+                return false;
+            }
+            *out = _pos;
+            _pos += len;
+            return true;
+        }
+
+    private:
+        const char* _pos;
+        const char* _end;
+    };
+
+    FieldNameDictionary::FieldNameDictionary(Store* store)
+        : _store(store),
+          _numTokens(0) {
+        std::fill(_chunks, _chunks + kMaxNames / kNamesPerChunk, static_cast<std::string*>(NULL));
+    }
+
+    FieldNameDictionary::~FieldNameDictionary() {
+        for (size_t i = 0; i < kMaxNames / kNamesPerChunk; i++) {
+            delete[] _chunks[i];
+        }
+    }
+
+    Status FieldNameDictionary::load(unsigned token, StringData name) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (token != kFirstToken + _numTokens.load()) {
+            return Status(ErrorCodes::BadValue, str::stream()
+                          << "field name token " << token << " is out of order, expected "
+                          << kFirstToken + _numTokens.load());
+        }
+        if (_numTokens.load() == kMaxNames) {
+            return Status(ErrorCodes::BadValue, "too many field name tokens");
+        }
+        _setName_inlock(token, name);
+        return Status::OK();
+    }
+
+    Status FieldNameDictionary::encode(const BSONObj& obj, BufBuilder* out) {
+        out->appendUChar(kFormatVersion);
+        appendVarint(out, obj.objsize());
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        Status status = _encodeElements_inlock(obj, true, out);
+        if (!status.isOK()) {
+            return status;
+        }
+        out->appendChar(EOO);
+        return Status::OK();
+    }
+
+    Status FieldNameDictionary::_encodeElements_inlock(const BSONObj& obj,
+                                                       bool withNames,
+                                                       BufBuilder* out) {
+        BSONObjIterator it(obj);
+        while (it.more()) {
+            const BSONElement elem = it.next();
+            const BSONType type = elem.type();
+            const bool namedArray = type == Array && !hasIndexNames(elem.embeddedObject());
+            out->appendUChar(namedArray ? kNamedArray : static_cast<unsigned char>(type));
+
+            if (withNames) {
+                const StringData name = elem.fieldNameStringData();
+                unsigned token;
+                Status status = _tokenFor_inlock(name, &token);
+                if (!status.isOK()) {
+                    return status;
+                }
+                appendVarint(out, token);
+                if (token == 0) {
+                    out->appendStr(name);
+                }
+            }
+
+            if (type == Object || type == Array) {
+                Status status = _encodeElements_inlock(elem.embeddedObject(),
+                                                       type == Object || namedArray,
+                                                       out);
+                if (!status.isOK()) {
+                    return status;
+                }
+                out->appendChar(EOO);
+                continue;
+            }
+
+            int size;
+            invariant(valueSizeOf(type, &size));
+            if (size < 0) {
+                appendVarint(out, elem.valuesize());
+            }
+            out->appendBuf(elem.value(), elem.valuesize());
+        }
+        return Status::OK();
+    }
+
+    Status FieldNameDictionary::_tokenFor_inlock(StringData name, unsigned* token) {
+        StringMap<unsigned>::const_iterator it = _tokensByName.find(name);
+        if (it != _tokensByName.end()) {
+            *token = it->second;
+            return Status::OK();
+        }
+
+        const unsigned numTokens = _numTokens.load();
+        if (numTokens == kMaxNames || name.size() > kMaxNameLength) {
+            *token = 0;
+            return Status::OK();
+        }
+
+        // Nobody can use the token until _setName_inlock() publishes it, so it is saved first.
+        const unsigned newToken = kFirstToken + numTokens;
+        if (_store) {
+            Status status = _store->save(newToken, name);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        _setName_inlock(newToken, name);
+        *token = newToken;
+        return Status::OK();
+    }
+
+    void FieldNameDictionary::_setName_inlock(unsigned token, StringData name) {
+        const unsigned index = token - kFirstToken;
+        std::string*& chunk = _chunks[index / kNamesPerChunk];
+        if (!chunk) {
+            chunk = new std::string[kNamesPerChunk];
+        }
+        chunk[index % kNamesPerChunk] = name.toString();
+        _tokensByName[name] = token;
+
+        // decode() reads the names without the mutex, so the count goes up last.
+        _numTokens.store(index + 1);
+    }
+
+    // static
+    int FieldNameDictionary::decodedSize(const char* data, size_t len) {
+        Reader reader(data, len);
+        unsigned char version;
+        unsigned size;
+        if (!reader.readByte(&version) || version != kFormatVersion ||
+            !reader.readVarint(&size) || size > static_cast<unsigned>(BSONObjMaxInternalSize)) {
+            return -1;
+        }
+        return size;
+    }
+
+    Status FieldNameDictionary::decode(const char* data, size_t len, BufBuilder* out) const {
+        Reader reader(data, len);
+        unsigned char version;
+        unsigned size;
+        if (!reader.readByte(&version) || version != kFormatVersion) {
+            return damaged("unknown format");
+        }
+        if (!reader.readVarint(&size) || size > static_cast<unsigned>(BSONObjMaxInternalSize)) {
+            return damaged("bad size");
+        }
+
+        const int start = out->len();
+        Status status = _decodeElements(&reader, true, 0, out);
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!reader.atEnd()) {
+            return damaged("data past the end of the document");
+        }
+        if (static_cast<unsigned>(out->len() - start) != size) {
+            return damaged("wrong size");
+        }
+        return Status::OK();
+    }
+
+    Status FieldNameDictionary::_decodeElements(Reader* reader,
+                                                bool withNames,
+                                                int depth,
+                                                BufBuilder* out) const {
+        if (depth > kMaxDepth) {
+            return damaged("nested too deeply");
+        }
+
+        const int start = out->len();
+        out->skip(sizeof(int32_t));
+
+        for (unsigned index = 0; ; index++) {
+            unsigned char typeByte;
+            if (!reader->readByte(&typeByte)) {
+                return damaged("truncated");
+            }
+            if (typeByte == EOO) {
+                break;
+            }
+
+            const bool namedArray = typeByte == kNamedArray;
+            const BSONType type = namedArray
+                ? Array
+                : static_cast<BSONType>(static_cast<signed char>(typeByte));
+            int size;
+            if (type != Object && type != Array && !valueSizeOf(type, &size)) {
+                return damaged(str::stream() << "unknown type " << static_cast<int>(typeByte));
+            }
+            out->appendChar(static_cast<char>(type));
+
+            if (withNames) {
+                unsigned token;
+                if (!reader->readVarint(&token)) {
+                    return damaged("truncated field name");
+                }
+                if (token == 0) {
+                    StringData name;
+                    if (!reader->readCString(&name)) {
+                        return damaged("truncated field name");
+                    }
+                    out->appendStr(name);
+                }
+                else {
+                    const unsigned tokenIndex = token - kFirstToken;
+                    if (token < kFirstToken || tokenIndex >= _numTokens.load()) {
+                        return damaged(str::stream() << "unknown field name token " << token);
+                    }
+                    out->appendStr(_chunks[tokenIndex / kNamesPerChunk]
+                                          [tokenIndex % kNamesPerChunk]);
+                }
+            }
+            else {
+                char buf[10];
+                out->appendBuf(buf, formatIndex(index, buf));
+                out->appendChar('\0');
+            }
+
+            if (type == Object || type == Array) {
+                Status status = _decodeElements(reader, type == Object || namedArray, depth + 1,
+                                                out);
+                if (!status.isOK()) {
+                    return status;
+                }
+                continue;
+            }
+
+            if (size < 0) {
+                unsigned varSize;
+                if (!reader->readVarint(&varSize)) {
+                    return damaged("truncated value");
+                }
+                size = varSize;
+            }
+            const char* value;
+            if (!reader->readBytes(size, &value)) {
+                return damaged("truncated value");
+            }
+            out->appendBuf(value, size);
+        }
+
+        out->appendChar(EOO);
+        DataView(out->buf() + start).write(tagLittleEndian<int32_t>(out->len() - start));
+        return Status::OK();
+    }
+
+} // namespace mongo
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+    class BSONObj;
+
+    /**
+     * Shrinks documents for storage by replacing their field names with small tokens from a
+     * per-collection dictionary, and turns stored documents back into BSON.
+     *
+     * Names get a token the first time a document that has them is encoded, and keep it for the
+     * life of the dictionary. A new token is saved to the dictionary's Store before any encoded
+     * document can use it, so a document never refers to a token that isn't durable before it
+     * is. Once the dictionary is full, or for very long names, the name is kept in the encoded
+     * document instead.
+     *
+     * Encoding takes a mutex. Decoding doesn't lock at all: tokens are only ever added, and a
+     * token is published only after its name is in place.
+     */
+    class FieldNameDictionary {
+        MONGO_DISALLOW_COPYING(FieldNameDictionary);
+    public:
+        /**
+         * Where the tokens of a dictionary are kept.
+         */
+        class Store {
+        public:
+            virtual ~Store() {}
+
+            /**
+             * Durably records that 'token' stands for 'name'. Must not be part of the caller's
+             * transaction, since the token can be used by others as soon as this returns.
+             */
+            virtual Status save(unsigned token, StringData name) = 0;
+        };
+
+        // Tokens start here. Zero means the name follows in the encoded document.
+        static const unsigned kFirstToken = 1;
+        static const unsigned kMaxNames = 64 * 1024;
+        static const size_t kMaxNameLength = 256;
+
+        /**
+         * Takes ownership of 'store', which may be NULL for a dictionary that is never saved.
+         */
+        explicit FieldNameDictionary(Store* store);
+        ~FieldNameDictionary();
+
+        /**
+         * Adds a token saved by an earlier dictionary for the same collection. The saved tokens
+         * must all be loaded in order, starting with kFirstToken, before the first call to
+         * encode() or decode().
+         */
+        Status load(unsigned token, StringData name);
+
+        /**
+         * Appends the encoded form of 'obj' to 'out', adding and saving tokens for any new names.
+         * Fails only if saving a token fails.
+         */
+        Status encode(const BSONObj& obj, BufBuilder* out);
+
+        /**
+         * Appends the BSON document that 'data' is the encoded form of to 'out'.
+         */
+        Status decode(const char* data, size_t len, BufBuilder* out) const;
+
+        /**
+         * Returns the size of the BSON document that 'data' is the encoded form of, which is
+         * kept at the start of it, or -1 if 'data' isn't an encoded document.
+         */
+        static int decodedSize(const char* data, size_t len);
+
+        /**
+         * The number of names that have a token.
+         */
+        unsigned size() const { return _numTokens.load(); }
+
+    private:
+        class Reader;
+
+        static const unsigned kNamesPerChunk = 1024;
+
+        /**
+         * Sets '*token' to the token for 'name', or to zero if the name is to be written out in
+         * full.
+         */
+        Status _tokenFor_inlock(StringData name, unsigned* token);
+
+        void _setName_inlock(unsigned token, StringData name);
+
+        Status _encodeElements_inlock(const BSONObj& obj, bool withNames, BufBuilder* out);
+
+        Status _decodeElements(Reader* reader, bool withNames, int depth, BufBuilder* out) const;
+
+        boost::scoped_ptr<Store> _store;
+
+        // Protects everything below except the names already published through _numTokens.
+        boost::mutex _mutex;
+
+        StringMap<unsigned> _tokensByName;
+
+        // Names by token, allocated kNamesPerChunk at a time so that they never move.
+        std::string* _chunks[kMaxNames / kNamesPerChunk];
+
+        // Tokens below kFirstToken + _numTokens can be decoded.
+        AtomicUInt32 _numTokens;
+    };
+
+} // namespace mongo
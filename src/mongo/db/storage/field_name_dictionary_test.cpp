@@ -0,0 +1,239 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/field_name_dictionary.h"
+
+#include <map>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    class MapStore : public FieldNameDictionary::Store {
+    public:
+        explicit MapStore(std::map<unsigned, std::string>* saved) : _saved(saved), fail(false) {}
+
+        virtual Status save(unsigned token, StringData name) {
+            if (fail) {
+                return Status(ErrorCodes::InternalError, "failed to save");
+            }
+            (*_saved)[token] = name.toString();
+            return Status::OK();
+        }
+
+    private:
+        std::map<unsigned, std::string>* _saved;
+
+    public:
+        bool fail;
+    };
+
+    std::string encode(FieldNameDictionary* dict, const BSONObj& obj) {
+        BufBuilder out;
+        ASSERT_OK(dict->encode(obj, &out));
+        return std::string(out.buf(), out.len());
+    }
+
+    BSONObj decode(const FieldNameDictionary& dict, const std::string& encoded) {
+        BufBuilder out;
+        ASSERT_OK(dict.decode(encoded.data(), encoded.size(), &out));
+        return BSONObj(out.buf()).getOwned();
+    }
+
+    void assertRoundTrips(FieldNameDictionary* dict, const BSONObj& obj) {
+        const BSONObj decoded = decode(*dict, encode(dict, obj));
+        ASSERT_TRUE(obj.binaryEqual(decoded)) << obj << " decoded as " << decoded;
+    }
+
+    TEST(FieldNameDictionary, RoundTripsEveryType) {
+        FieldNameDictionary dict(NULL);
+
+        BSONObjBuilder bob;
+        bob.append("double", 1.5);
+        bob.append("string", "some text");
+        bob.append("emptyString", "");
+        bob.append("object", BSON("a" << 1 << "b" << BSON("c" << "d")));
+        bob.append("emptyObject", BSONObj());
+        bob.append("array", BSON_ARRAY(1 << "two" << BSON("three" << 3) << BSON_ARRAY(4 << 5)));
+        bob.append("emptyArray", BSONArray());
+        const char bin[] = "\x01\x02\x00\x03";
+        bob.appendBinData("binData", sizeof(bin), BinDataGeneral, bin);
+        bob.appendUndefined("undefined");
+        bob.append("oid", OID::gen());
+        bob.append("bool", true);
+        bob.appendDate("date", Date_t(123456789ULL));
+        bob.appendNull("null");
+        bob.appendRegex("regex", "^a.*b$", "i");
+        bob.appendDBRef("dbref", "test.coll", OID::gen());
+        bob.appendCode("code", "function() { return 1; }");
+        bob.appendSymbol("symbol", "sym");
+        bob.appendCodeWScope("codeWScope", "return x;", BSON("x" << 1));
+        bob.append("int", 7);
+        bob.appendTimestamp("timestamp", 1234567ULL);
+        bob.append("long", 1LL << 40);
+        bob.appendMinKey("minKey");
+        bob.appendMaxKey("maxKey");
+        bob.append("", "empty name");
+        assertRoundTrips(&dict, bob.obj());
+
+        assertRoundTrips(&dict, BSONObj());
+    }
+
+    TEST(FieldNameDictionary, RoundTripsArraysWithOtherNames) {
+        FieldNameDictionary dict(NULL);
+
+        BSONObjBuilder bob;
+        {
+            BSONObjBuilder arr(bob.subarrayStart("skips"));
+            arr.append("0", 1);
+            arr.append("2", 2);
+        }
+        {
+            BSONObjBuilder arr(bob.subarrayStart("named"));
+            arr.append("x", 1);
+            arr.append("y", BSON_ARRAY(1 << 2));
+        }
+        BSONArrayBuilder big(bob.subarrayStart("big"));
+        for (int i = 0; i < 1000; i++) {
+            big.append(i);
+        }
+        big.done();
+        assertRoundTrips(&dict, bob.obj());
+    }
+
+    TEST(FieldNameDictionary, ShrinksRepeatedNames) {
+        FieldNameDictionary dict(NULL);
+        const BSONObj obj = fromjson("{customerIdentifier: 1, shippingAddress: {streetName: 'a', "
+                                     "postalCode: 'b'}, lineItems: [{productIdentifier: 1}, "
+                                     "{productIdentifier: 2}]}");
+        const std::string encoded = encode(&dict, obj);
+        ASSERT_LESS_THAN(encoded.size() * 2, static_cast<size_t>(obj.objsize()));
+        ASSERT_EQUALS(6U, dict.size());
+        ASSERT_EQUALS(obj, decode(dict, encoded));
+        ASSERT_EQUALS(obj.objsize(),
+                      FieldNameDictionary::decodedSize(encoded.data(), encoded.size()));
+
+        // Known names don't add tokens.
+        encode(&dict, fromjson("{lineItems: [], customerIdentifier: 2}"));
+        ASSERT_EQUALS(6U, dict.size());
+    }
+
+    TEST(FieldNameDictionary, SavesTokensBeforeUsingThem) {
+        std::map<unsigned, std::string> saved;
+        FieldNameDictionary dict(new MapStore(&saved));
+
+        const std::string encoded = encode(&dict, BSON("a" << 1 << "b" << BSON("c" << 2)));
+        ASSERT_EQUALS(3U, saved.size());
+        ASSERT_EQUALS("a", saved[FieldNameDictionary::kFirstToken]);
+        ASSERT_EQUALS("b", saved[FieldNameDictionary::kFirstToken + 1]);
+        ASSERT_EQUALS("c", saved[FieldNameDictionary::kFirstToken + 2]);
+
+        // A dictionary loaded from what was saved decodes the same documents.
+        FieldNameDictionary reloaded(NULL);
+        for (std::map<unsigned, std::string>::const_iterator it = saved.begin();
+             it != saved.end();
+             ++it) {
+            ASSERT_OK(reloaded.load(it->first, it->second));
+        }
+        ASSERT_EQUALS(BSON("a" << 1 << "b" << BSON("c" << 2)), decode(reloaded, encoded));
+
+        // New names continue from the loaded tokens.
+        encode(&reloaded, BSON("d" << 1));
+        ASSERT_EQUALS(4U, reloaded.size());
+        ASSERT_EQUALS(BSON("d" << 1), decode(reloaded, encode(&reloaded, BSON("d" << 1))));
+    }
+
+    TEST(FieldNameDictionary, FailedSaveDoesNotUseToken) {
+        std::map<unsigned, std::string> saved;
+        MapStore* store = new MapStore(&saved);
+        FieldNameDictionary dict(store);
+
+        store->fail = true;
+        BufBuilder out;
+        ASSERT_NOT_OK(dict.encode(BSON("a" << 1), &out));
+        ASSERT_EQUALS(0U, dict.size());
+
+        store->fail = false;
+        assertRoundTrips(&dict, BSON("a" << 1));
+        ASSERT_EQUALS("a", saved[FieldNameDictionary::kFirstToken]);
+    }
+
+    TEST(FieldNameDictionary, LoadMustBeInOrder) {
+        FieldNameDictionary dict(NULL);
+        ASSERT_NOT_OK(dict.load(FieldNameDictionary::kFirstToken + 1, "b"));
+        ASSERT_OK(dict.load(FieldNameDictionary::kFirstToken, "a"));
+        ASSERT_NOT_OK(dict.load(FieldNameDictionary::kFirstToken, "a"));
+        ASSERT_OK(dict.load(FieldNameDictionary::kFirstToken + 1, "b"));
+    }
+
+    TEST(FieldNameDictionary, KeepsLongNamesInDocument) {
+        FieldNameDictionary dict(NULL);
+        const std::string longName(FieldNameDictionary::kMaxNameLength + 1, 'x');
+        assertRoundTrips(&dict, BSON(longName << 1 << "short" << 2));
+        ASSERT_EQUALS(1U, dict.size());
+    }
+
+    TEST(FieldNameDictionary, KeepsNamesInDocumentOnceFull) {
+        FieldNameDictionary dict(NULL);
+        for (unsigned i = 0; i < FieldNameDictionary::kMaxNames; i++) {
+            ASSERT_OK(dict.load(FieldNameDictionary::kFirstToken + i,
+                                BSONObjBuilder::numStr(i)));
+        }
+        assertRoundTrips(&dict, BSON("new" << 1 << "7" << BSON("other" << 2)));
+        ASSERT_EQUALS(FieldNameDictionary::kMaxNames, dict.size());
+    }
+
+    TEST(FieldNameDictionary, RejectsDamagedData) {
+        FieldNameDictionary dict(NULL);
+        const std::string encoded = encode(&dict, BSON("a" << "text" << "b" << BSON("c" << 1)));
+
+        for (size_t len = 0; len < encoded.size(); len++) {
+            BufBuilder out;
+            ASSERT_NOT_OK(dict.decode(encoded.data(), len, &out)) << len;
+        }
+
+        BufBuilder out;
+        ASSERT_NOT_OK(dict.decode((encoded + "x").data(), encoded.size() + 1, &out));
+
+        std::string badVersion = encoded;
+        badVersion[0] = 9;
+        ASSERT_NOT_OK(dict.decode(badVersion.data(), badVersion.size(), &out));
+        ASSERT_EQUALS(-1, FieldNameDictionary::decodedSize(badVersion.data(), badVersion.size()));
+
+        // Tokens the dictionary doesn't have.
+        FieldNameDictionary empty(NULL);
+        ASSERT_NOT_OK(empty.decode(encoded.data(), encoded.size(), &out));
+    }
+
+} // namespace
+} // namespace mongo
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/id_keys.h"
+
+#include <cmath>
+#include <limits>
+
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/util/debug_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace idkeys {
+
+namespace {
+    // Doubles above this can't hold every integer, so they don't compare like longs.
+    const double kMaxExactDouble = 9007199254740992.0; // 2^53
+
+    StatusWith<RecordId> keyForInteger(long long id) {
+        // RecordId(0) is the null RecordId and RecordId::max() is reserved, so non-negative _ids
+        // move up by one. RecordId::min() is reserved as well.
+        if (id == std::numeric_limits<long long>::min())
+            return StatusWith<RecordId>(ErrorCodes::BadValue, "_id too low");
+        if (id >= std::numeric_limits<long long>::max() - 1)
+            return StatusWith<RecordId>(ErrorCodes::BadValue, "_id too high");
+
+        return StatusWith<RecordId>(RecordId(id < 0 ? id : id + 1));
+    }
+} // namespace
+
+    StatusWith<RecordId> keyForId(const BSONElement& id) {
+        switch (id.type()) {
+        case NumberInt:
+        case NumberLong:
+            return keyForInteger(id.numberLong());
+
+        case NumberDouble: {
+            const double value = id.numberDouble();
+            if (std::floor(value) != value || std::fabs(value) > kMaxExactDouble) {
+                return StatusWith<RecordId>(ErrorCodes::BadValue,
+                                            "_id must be a whole number of at most 2^53");
+            }
+            return keyForInteger(static_cast<long long>(value));
+        }
+
+        default:
+            return StatusWith<RecordId>(ErrorCodes::BadValue,
+                                        str::stream() << "_id must be a number, not "
+                                                      << typeName(id.type()));
+        }
+    }
+
+    StatusWith<RecordId> extractKey(const char* data, int len) {
+        DEV invariant(validateBSON(data, len).isOK());
+
+        const BSONObj obj(data);
+        const BSONElement elem = obj["_id"];
+        if (elem.eoo())
+            return StatusWith<RecordId>(ErrorCodes::BadValue, "no _id field");
+
+        return keyForId(elem);
+    }
+
+}  // namespace idkeys
+}  // namespace mongo
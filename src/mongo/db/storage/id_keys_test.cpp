@@ -0,0 +1,102 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/id_keys.h"
+
+#include <limits>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    RecordId keyFor(const BSONObj& obj) {
+        StatusWith<RecordId> key = idkeys::keyForId(obj["_id"]);
+        ASSERT_OK(key.getStatus());
+        return key.getValue();
+    }
+
+    void assertNoKey(const BSONObj& obj) {
+        ASSERT_NOT_OK(idkeys::keyForId(obj["_id"]).getStatus());
+    }
+
+    TEST(IdKeys, EqualNumbersGetTheSameKey) {
+        ASSERT_EQUALS(keyFor(BSON("_id" << 5)), keyFor(BSON("_id" << 5LL)));
+        ASSERT_EQUALS(keyFor(BSON("_id" << 5)), keyFor(BSON("_id" << 5.0)));
+        ASSERT_EQUALS(keyFor(BSON("_id" << -7)), keyFor(BSON("_id" << -7.0)));
+    }
+
+    TEST(IdKeys, KeysSortLikeIds) {
+        const long long maxLong = std::numeric_limits<long long>::max();
+        const long long minLong = std::numeric_limits<long long>::min();
+        const BSONObj ids[] = {BSON("_id" << minLong + 1),
+                               BSON("_id" << -9007199254740992.0),
+                               BSON("_id" << -2),
+                               BSON("_id" << -1),
+                               BSON("_id" << 0),
+                               BSON("_id" << 1),
+                               BSON("_id" << 9007199254740992.0),
+                               BSON("_id" << maxLong - 2)};
+        for (size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); i++) {
+            const RecordId key = keyFor(ids[i]);
+            ASSERT(!key.isNull());
+            ASSERT_GREATER_THAN(key, RecordId::min());
+            ASSERT_LESS_THAN(key, RecordId::max());
+            if (i > 0) {
+                ASSERT_LESS_THAN(keyFor(ids[i - 1]), key);
+            }
+        }
+    }
+
+    TEST(IdKeys, IdsWithoutKeys) {
+        assertNoKey(BSON("_id" << "1"));
+        assertNoKey(BSON("_id" << BSON("a" << 1)));
+        assertNoKey(BSON("_id" << OID::gen()));
+        assertNoKey(BSON("_id" << 1.5));
+        assertNoKey(BSON("_id" << 18014398509481984.0));
+        assertNoKey(BSON("_id" << std::numeric_limits<long long>::min()));
+        assertNoKey(BSON("_id" << std::numeric_limits<long long>::max() - 1));
+        assertNoKey(BSON("_id" << std::numeric_limits<long long>::max()));
+    }
+
+    TEST(IdKeys, ExtractKey) {
+        const BSONObj doc = BSON("a" << 1 << "_id" << 3);
+        StatusWith<RecordId> key = idkeys::extractKey(doc.objdata(), doc.objsize());
+        ASSERT_OK(key.getStatus());
+        ASSERT_EQUALS(keyFor(doc), key.getValue());
+
+        const BSONObj noId = BSON("a" << 1);
+        ASSERT_NOT_OK(idkeys::extractKey(noId.objdata(), noId.objsize()).getStatus());
+    }
+
+} // namespace
+} // namespace mongo
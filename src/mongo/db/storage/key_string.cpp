@@ -37,6 +37,11 @@
 #include <boost/scoped_array.hpp>
 #include <cmath>
 
+#if defined(__SSE2__) || defined(_M_X64)
+#define MONGO_KEY_STRING_USE_SSE2
+#include <emmintrin.h>
+#endif
+
 #include "mongo/base/data_view.h"
 #include "mongo/platform/bits.h"
 #include "mongo/util/hex.h"
@@ -1082,25 +1087,49 @@ namespace mongo {
     }
 
     int KeyString::compare(const KeyString& other) const {
-        int a = getSize();
-        int b = other.getSize();
+        return compare(getBuffer(), getSize(), other.getBuffer(), other.getSize());
+    }
 
-        int min = std::min(a, b);
+    // static
+    int KeyString::compare(const char* a, size_t aSize, const char* b, size_t bSize) {
+        const size_t min = std::min(aSize, bSize);
+
+#ifdef MONGO_KEY_STRING_USE_SSE2
+        const unsigned char* ua = reinterpret_cast<const unsigned char*>(a);
+        const unsigned char* ub = reinterpret_cast<const unsigned char*>(b);
+
+        size_t i = 0;
+        for (; i + 16 <= min; i += 16) {
+            const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ua + i));
+            const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ub + i));
+            const unsigned equalBytes = _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+            if (equalBytes != 0xffff) {
+                const size_t pos = i + countTrailingZeros64(~equalBytes & 0xffff);
+                return ua[pos] < ub[pos] ? -1 : 1;
+            }
+        }
 
-        int cmp = memcmp(getBuffer(), other.getBuffer(), min);
+        for (; i < min; i++) {
+            if (ua[i] != ub[i]) {
+                return ua[i] < ub[i] ? -1 : 1;
+            }
+        }
+#else
+        int cmp = memcmp(a, b, min);
 
         if (cmp) {
             if (cmp < 0)
                 return -1;
             return 1;
         }
+#endif
 
         // keys match
 
-        if (a == b)
+        if (aSize == bSize)
             return 0;
 
-        return a < b ? -1 : 1;
+        return aSize < bSize ? -1 : 1;
     }
     
     void KeyString::TypeBits::resetFromBuffer(BufReader* reader) {
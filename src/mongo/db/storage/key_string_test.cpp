@@ -844,3 +844,47 @@ TEST(KeyStringTest, RecordIds) {
     }
 }
 
+
+TEST(KeyStringTest, CompareBuffers) {
+    // Cover lengths on both sides of the 16 byte blocks compared at a time, with the first
+    // difference at every position.
+    for (size_t size = 0; size < 50; size++) {
+        std::string base(size, '\0');
+        for (size_t i = 0; i < size; i++) {
+            // Leave room to increment any byte without wrapping around. Include bytes with the
+            // high bit set, which must compare as unsigned.
+            base[i] = static_cast<char>((i * 37) % 250);
+        }
+
+        ASSERT_EQUALS(0, KeyString::compare(base.data(), size, base.data(), size));
+
+        for (size_t pos = 0; pos < size; pos++) {
+            std::string bigger = base;
+            bigger[pos]++;
+
+            ASSERT_EQUALS(-1, KeyString::compare(base.data(), size, bigger.data(), size));
+            ASSERT_EQUALS(1, KeyString::compare(bigger.data(), size, base.data(), size));
+
+            // What follows the first difference doesn't matter.
+            ASSERT_EQUALS(-1, KeyString::compare(base.data(), size, bigger.data(), pos + 1));
+        }
+
+        // A prefix sorts before the whole.
+        if (size > 0) {
+            ASSERT_EQUALS(-1, KeyString::compare(base.data(), size - 1, base.data(), size));
+            ASSERT_EQUALS(1, KeyString::compare(base.data(), size, base.data(), size - 1));
+        }
+    }
+}
+
+TEST(KeyStringTest, CompareCompoundKeysWithSharedPrefix) {
+    const std::string tenant(40, 't');
+    KeyString a(BSON("" << tenant << "" << Timestamp(5, 1) << "" << 1), ALL_ASCENDING);
+    KeyString b(BSON("" << tenant << "" << Timestamp(5, 2) << "" << 0), ALL_ASCENDING);
+    KeyString c(BSON("" << tenant << "" << Timestamp(5, 2) << "" << 1), ALL_ASCENDING);
+
+    ASSERT_LESS_THAN(a.compare(b), 0);
+    ASSERT_LESS_THAN(b.compare(c), 0);
+    ASSERT_GREATER_THAN(c.compare(a), 0);
+    ASSERT_EQUALS(0, c.compare(c));
+}
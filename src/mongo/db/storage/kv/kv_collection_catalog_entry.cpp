@@ -32,6 +32,7 @@
 
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/storage/kv/kv_catalog.h"
+#include "mongo/db/storage/kv/kv_drop_pending_ident_reaper.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 
 namespace mongo {
@@ -71,7 +72,7 @@ namespace mongo {
         virtual void commit() {
             // Intentionally ignoring failure here. Since we've removed the metadata pointing to the
             // index, we should never see it again anyway.
-            _cce->_engine->dropIdent(_opCtx, _ident);
+            _cce->_reaper->dropIdent(_opCtx, _ident);
         }
 
         OperationContext* const _opCtx;
@@ -81,12 +82,14 @@ namespace mongo {
 
 
     KVCollectionCatalogEntry::KVCollectionCatalogEntry( KVEngine* engine,
+                                                        KVDropPendingIdentReaper* reaper,
                                                         KVCatalog* catalog,
                                                         StringData ns,
                                                         StringData ident,
                                                         RecordStore* rs)
         : BSONCollectionCatalogEntry( ns ),
           _engine( engine ),
+          _reaper( reaper ),
           _catalog( catalog ),
           _ident( ident.toString() ),
           _recordStore( rs ) {
@@ -37,11 +37,13 @@
 namespace mongo {
 
     class KVCatalog;
+    class KVDropPendingIdentReaper;
     class KVEngine;
 
     class KVCollectionCatalogEntry : public BSONCollectionCatalogEntry {
     public:
         KVCollectionCatalogEntry( KVEngine* engine,
+                                  KVDropPendingIdentReaper* reaper,
                                   KVCatalog* catalog,
                                   StringData ns,
                                   StringData ident,
@@ -89,6 +91,7 @@ namespace mongo {
         class RemoveIndexChange;
 
         KVEngine* _engine; // not owned
+        KVDropPendingIdentReaper* _reaper; // not owned
         KVCatalog* _catalog; // not owned
         std::string _ident;
         boost::scoped_ptr<RecordStore> _recordStore; // owned
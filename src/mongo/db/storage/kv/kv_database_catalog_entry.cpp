@@ -93,7 +93,7 @@ namespace mongo {
             // Intentionally ignoring failure here. Since we've removed the metadata pointing to the
             // collection, we should never see it again anyway.
             if (_dropOnCommit)
-                _dce->_engine->getEngine()->dropIdent( _opCtx, _ident );
+                _dce->_engine->getDropPendingIdentReaper()->dropIdent( _opCtx, _ident );
         }
 
         virtual void rollback() {
@@ -226,7 +226,9 @@ namespace mongo {
 
         txn->recoveryUnit()->registerChange(new AddCollectionChange(txn, this, ns, ident, true));
         _collections[ns.toString()] =
-            new KVCollectionCatalogEntry( _engine->getEngine(), _engine->getCatalog(),
+            new KVCollectionCatalogEntry( _engine->getEngine(),
+                                          _engine->getDropPendingIdentReaper(),
+                                          _engine->getCatalog(),
                                           ns, ident, rs );
 
         return Status::OK();
@@ -235,24 +237,28 @@ namespace mongo {
     void KVDatabaseCatalogEntry::initCollection( OperationContext* opCtx,
                                                  const std::string& ns,
                                                  bool forRepair ) {
-        invariant(!_collections.count(ns));
+        // Using a NULL rs when repairing since we don't want to open this record store before it
+        // has been repaired. This also ensures that if we try to use it, it will blow up.
+        initCollection( ns, forRepair ? NULL : openRecordStore( opCtx, ns ) );
+    }
 
+    RecordStore* KVDatabaseCatalogEntry::openRecordStore( OperationContext* opCtx,
+                                                          const std::string& ns ) const {
         const std::string ident = _engine->getCatalog()->getCollectionIdent( ns );
+        BSONCollectionCatalogEntry::MetaData md = _engine->getCatalog()->getMetaData(opCtx, ns);
+        RecordStore* rs = _engine->getEngine()->getRecordStore( opCtx, ns, ident, md.options );
+        invariant( rs );
+        return rs;
+    }
 
-        RecordStore* rs;
-        if (forRepair) {
-            // Using a NULL rs since we don't want to open this record store before it has been
-            // repaired. This also ensures that if we try to use it, it will blow up.
-            rs = NULL;
-        }
-        else {
-            BSONCollectionCatalogEntry::MetaData md = _engine->getCatalog()->getMetaData(opCtx, ns);
-            rs = _engine->getEngine()->getRecordStore( opCtx, ns, ident, md.options );
-            invariant( rs );
-        }
+    void KVDatabaseCatalogEntry::initCollection( const std::string& ns, RecordStore* rs ) {
+        invariant(!_collections.count(ns));
+
+        const std::string ident = _engine->getCatalog()->getCollectionIdent( ns );
 
         // No change registration since this is only for committed collections
         _collections[ns] = new KVCollectionCatalogEntry( _engine->getEngine(),
+                                                         _engine->getDropPendingIdentReaper(),
                                                          _engine->getCatalog(),
                                                          ns,
                                                          ident,
@@ -318,7 +324,9 @@ namespace mongo {
         txn->recoveryUnit()->registerChange(
             new AddCollectionChange(txn, this, toNS, identTo, false));
         _collections[toNS.toString()] =
-            new KVCollectionCatalogEntry( _engine->getEngine(), _engine->getCatalog(),
+            new KVCollectionCatalogEntry( _engine->getEngine(),
+                                          _engine->getDropPendingIdentReaper(),
+                                          _engine->getCatalog(),
                                           toNS, identTo, rs );
 
         return Status::OK();
@@ -89,6 +89,19 @@ namespace mongo {
                              const std::string& ns,
                              bool forRepair );
 
+        /**
+         * Adds the committed collection 'ns', taking ownership of its record store 'rs'. 'rs' is
+         * NULL for collections that are still to be repaired.
+         */
+        void initCollection( const std::string& ns, RecordStore* rs );
+
+        /**
+         * Opens the record store of the committed collection 'ns'. Does not modify this entry,
+         * so several threads may open record stores at once, each with its own 'opCtx', if the
+         * engine supportsConcurrentIdentOpening().
+         */
+        RecordStore* openRecordStore( OperationContext* opCtx, const std::string& ns ) const;
+
         void initCollectionBeforeRepair(OperationContext* opCtx, const std::string& ns);
         void reinitCollectionAfterRepair(OperationContext* opCtx, const std::string& ns);
 
@@ -0,0 +1,168 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/kv/kv_drop_pending_ident_reaper.h"
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // Dropped idents of at least this many bytes are reclaimed by a background thread rather than
+    // by the operation which dropped them. A negative value drops everything immediately.
+    MONGO_EXPORT_SERVER_PARAMETER(storageEngineBackgroundDropMinBytes, long long,
+                                  64 * 1024 * 1024);
+
+    // Pause between two background drops, to spread out the I/O they cause.
+    MONGO_EXPORT_SERVER_PARAMETER(storageEngineBackgroundDropDelayMillis, int, 100);
+
+    KVDropPendingIdentReaper::KVDropPendingIdentReaper( KVEngine* engine )
+        : _engine( engine ),
+          _shutdown( false ) {
+        _thread.reset(new boost::thread(
+            stdx::bind(&KVDropPendingIdentReaper::_reaperThreadMain, this)));
+    }
+
+    KVDropPendingIdentReaper::~KVDropPendingIdentReaper() {
+        shutdown();
+    }
+
+    void KVDropPendingIdentReaper::dropIdent( OperationContext* opCtx, StringData ident ) {
+        const long long minBytes = storageEngineBackgroundDropMinBytes;
+        bool inBackground = false;
+        if ( minBytes >= 0 ) {
+            try {
+                // The caller may be committing its unit of work, so don't use its recovery unit.
+                OperationContextNoop sizeCtx( _engine->newRecoveryUnit() );
+                inBackground = _engine->getIdentSize( &sizeCtx, ident ) >= minBytes;
+            }
+            catch ( const DBException& e ) {
+                warning() << "could not get the size of dropped ident " << ident << ": "
+                          << e.what();
+                inBackground = true;
+            }
+        }
+
+        if ( inBackground ) {
+            boost::lock_guard<boost::mutex> lk( _mutex );
+            if ( !_shutdown ) {
+                _pending.push_back( ident.toString() );
+                _condition.notify_one();
+                return;
+            }
+        }
+
+        // Intentionally ignoring failure, as the callers already do.
+        _engine->dropIdent( opCtx, ident );
+    }
+
+    void KVDropPendingIdentReaper::dropIdentInBackground( StringData ident ) {
+        {
+            boost::lock_guard<boost::mutex> lk( _mutex );
+            if ( !_shutdown ) {
+                _pending.push_back( ident.toString() );
+                _condition.notify_one();
+                return;
+            }
+        }
+
+        OperationContextNoop opCtx( _engine->newRecoveryUnit() );
+        _engine->dropIdent( &opCtx, ident );
+    }
+
+    size_t KVDropPendingIdentReaper::numPending() const {
+        boost::lock_guard<boost::mutex> lk( _mutex );
+        return _pending.size();
+    }
+
+    void KVDropPendingIdentReaper::shutdown() {
+        if ( !_thread )
+            return;
+
+        size_t numLeft;
+        {
+            boost::lock_guard<boost::mutex> lk( _mutex );
+            _shutdown = true;
+            numLeft = _pending.size();
+        }
+        _condition.notify_one();
+        _thread->join();
+        _thread.reset();
+
+        if ( numLeft ) {
+            log() << "leaving " << numLeft << " dropped idents to be removed at the next startup";
+        }
+    }
+
+    void KVDropPendingIdentReaper::_reaperThreadMain() {
+        setThreadName( "DropPendingIdentReaper" );
+
+        boost::unique_lock<boost::mutex> lk( _mutex );
+        while ( true ) {
+            while ( !_shutdown && _pending.empty() ) {
+                _condition.wait( lk );
+            }
+            if ( _shutdown )
+                break;
+
+            const std::string ident = _pending.front();
+            lk.unlock();
+
+            Timer timer;
+            try {
+                OperationContextNoop opCtx( _engine->newRecoveryUnit() );
+                _engine->dropIdent( &opCtx, ident );
+                log() << "dropped ident " << ident << " in the background in "
+                      << timer.millis() << "ms";
+            }
+            catch ( const DBException& e ) {
+                // The ident is unused, so it will be dropped at the next startup anyway.
+                warning() << "background drop of ident " << ident << " failed: " << e.what();
+            }
+
+            lk.lock();
+            _pending.pop_front();
+
+            const int delayMillis = storageEngineBackgroundDropDelayMillis;
+            if ( delayMillis > 0 && !_pending.empty() && !_shutdown ) {
+                _condition.timed_wait( lk, boost::posix_time::milliseconds( delayMillis ) );
+            }
+        }
+    }
+
+}
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+    class KVEngine;
+    class OperationContext;
+
+    /**
+     * Reclaims the storage of dropped collections and indexes. Once the catalog no longer refers
+     * to an ident, dropping it is only a matter of freeing space, which for a large table can take
+     * a long time. Idents of at least storageEngineBackgroundDropMinBytes are queued and dropped
+     * one at a time by a background thread, pausing storageEngineBackgroundDropDelayMillis between
+     * drops, so that the drop command returns and releases its locks right away. Smaller idents
+     * are dropped immediately.
+     *
+     * Idents still queued at shutdown are left alone: as the catalog no longer refers to them,
+     * they are dropped as unused idents at the next startup.
+     */
+    class KVDropPendingIdentReaper {
+        MONGO_DISALLOW_COPYING(KVDropPendingIdentReaper);
+    public:
+        /**
+         * @param engine - not owned, must outlive this
+         */
+        explicit KVDropPendingIdentReaper( KVEngine* engine );
+        ~KVDropPendingIdentReaper();
+
+        /**
+         * Drops 'ident', which nothing may refer to anymore, now or in the background.
+         */
+        void dropIdent( OperationContext* opCtx, StringData ident );
+
+        /**
+         * Queues 'ident' for the background thread whatever its size.
+         */
+        void dropIdentInBackground( StringData ident );
+
+        /**
+         * Number of idents waiting to be dropped, including one being dropped.
+         */
+        size_t numPending() const;
+
+        /**
+         * Stops the background thread, leaving the queued idents. Idents dropped afterwards are
+         * dropped immediately.
+         */
+        void shutdown();
+
+    private:
+        void _reaperThreadMain();
+
+        KVEngine* const _engine;
+
+        mutable boost::mutex _mutex;
+        boost::condition_variable _condition;
+        std::deque<std::string> _pending; // guarded by _mutex, the front is the one being dropped
+        bool _shutdown; // guarded by _mutex
+
+        boost::scoped_ptr<boost::thread> _thread;
+    };
+
+}
@@ -0,0 +1,110 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/kv/kv_drop_pending_ident_reaper.h"
+
+#include <set>
+
+#include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/devnull/devnull_kv_engine.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using namespace mongo;
+
+    /**
+     * Devnull KV engine which reports idents starting with "big" as large, and records the
+     * idents it drops.
+     */
+    class DropRecordingKVEngine : public DevNullKVEngine {
+    public:
+        virtual Status dropIdent( OperationContext* opCtx,
+                                  StringData ident ) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _dropped.insert(ident.toString());
+            return Status::OK();
+        }
+
+        virtual int64_t getIdentSize( OperationContext* opCtx,
+                                      StringData ident ) {
+            return ident.startsWith("big") ? 1024LL * 1024 * 1024 : 1;
+        }
+
+        bool wasDropped(const std::string& ident) const {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _dropped.count(ident);
+        }
+
+    private:
+        mutable boost::mutex _mutex;
+        std::set<std::string> _dropped;
+    };
+
+    void waitForReaper(const KVDropPendingIdentReaper& reaper) {
+        for (int i = 0; i < 1000 && reaper.numPending(); i++) {
+            sleepmillis(10);
+        }
+        ASSERT_EQUALS(0U, reaper.numPending());
+    }
+
+    TEST(KVDropPendingIdentReaperTest, SmallIdentIsDroppedImmediately) {
+        DropRecordingKVEngine engine;
+        KVDropPendingIdentReaper reaper(&engine);
+        OperationContextNoop ctx;
+        reaper.dropIdent(&ctx, "small");
+        ASSERT_TRUE(engine.wasDropped("small"));
+    }
+
+    TEST(KVDropPendingIdentReaperTest, LargeIdentsAreDroppedInBackground) {
+        DropRecordingKVEngine engine;
+        KVDropPendingIdentReaper reaper(&engine);
+        OperationContextNoop ctx;
+        reaper.dropIdent(&ctx, "big1");
+        reaper.dropIdent(&ctx, "big2");
+        reaper.dropIdentInBackground("small");
+        waitForReaper(reaper);
+        ASSERT_TRUE(engine.wasDropped("big1"));
+        ASSERT_TRUE(engine.wasDropped("big2"));
+        ASSERT_TRUE(engine.wasDropped("small"));
+    }
+
+    TEST(KVDropPendingIdentReaperTest, DropAfterShutdownIsImmediate) {
+        DropRecordingKVEngine engine;
+        KVDropPendingIdentReaper reaper(&engine);
+        reaper.shutdown();
+        OperationContextNoop ctx;
+        reaper.dropIdent(&ctx, "big");
+        ASSERT_TRUE(engine.wasDropped("big"));
+        ASSERT_EQUALS(0U, reaper.numPending());
+    }
+
+}  // namespace
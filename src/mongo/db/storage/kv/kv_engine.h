@@ -109,6 +109,12 @@ namespace mongo {
          */
         virtual bool supportsDirectoryPerDB() const = 0;
 
+        /**
+         * Returns true if getRecordStore() may be called from several threads at once, each with
+         * its own OperationContext, which lets startup open the record stores in parallel.
+         */
+        virtual bool supportsConcurrentIdentOpening() const { return false; }
+
         virtual Status okToRename( OperationContext* opCtx,
                                    StringData fromNS,
                                    StringData toNS,
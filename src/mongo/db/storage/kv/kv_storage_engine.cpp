@@ -33,19 +33,34 @@
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/kv/kv_database_catalog_entry.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
     using std::string;
     using std::vector;
 
+    // Number of threads opening the collections' record stores at startup, for engines which
+    // support it.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(storageEngineStartupThreads, int, 8);
+
     namespace {
         const std::string catalogInfo = "_mdb_catalog";
+
+        void openRecordStoreOnWorker(KVEngine* engine,
+                                     const KVDatabaseCatalogEntry* db,
+                                     const std::string* ns,
+                                     RecordStore** out) {
+            OperationContextNoop opCtx(engine->newRecoveryUnit());
+            *out = db->openRecordStore(&opCtx, *ns);
+        }
     }
 
     class KVStorageEngine::RemoveDBChange : public RecoveryUnit::Change {
@@ -74,6 +89,7 @@ namespace mongo {
                                       const KVStorageEngineOptions& options )
         : _options( options )
         , _engine( engine )
+        , _dropPendingIdentReaper( new KVDropPendingIdentReaper( engine ) )
         , _supportsDocLocking(_engine->supportsDocLocking()) {
 
         uassert(28601, "Storage engine does not support --directoryperdb",
@@ -87,6 +103,10 @@ namespace mongo {
             engine->repairIdent(&opCtx, catalogInfo);
         }
 
+        Timer timer;
+        long long catalogMillis = 0;
+        long long openMillis = 0;
+        size_t numCollections = 0;
         {
             WriteUnitOfWork uow( &opCtx );
 
@@ -113,10 +133,11 @@ namespace mongo {
 
             std::vector<std::string> collections;
             _catalog->getAllCollections( &collections );
+            numCollections = collections.size();
 
+            std::vector<KVDatabaseCatalogEntry*> collectionDbs( collections.size() );
             for ( size_t i = 0; i < collections.size(); i++ ) {
-                std::string coll = collections[i];
-                NamespaceString nss( coll );
+                NamespaceString nss( collections[i] );
                 string dbName = nss.db().toString();
 
                 // No rollback since this is only for committed dbs.
@@ -124,9 +145,19 @@ namespace mongo {
                 if ( !db ) {
                     db = new KVDatabaseCatalogEntry( dbName, this );
                 }
+                collectionDbs[i] = db;
+            }
+            catalogMillis = timer.millis();
 
-                db->initCollection( &opCtx, coll, options.forRepair );
+            // Record stores aren't opened before they have been repaired.
+            std::vector<RecordStore*> recordStores( collections.size(), NULL );
+            if ( !options.forRepair ) {
+                _openRecordStores( collections, collectionDbs, &opCtx, &recordStores );
             }
+            for ( size_t i = 0; i < collections.size(); i++ ) {
+                collectionDbs[i]->initCollection( collections[i], recordStores[i] );
+            }
+            openMillis = timer.millis() - catalogMillis;
 
             uow.commit();
         }
@@ -160,15 +191,48 @@ namespace mongo {
                     continue;
                 log() << "dropping unused ident: " << toRemove;
                 WriteUnitOfWork wuow( &opCtx );
-                _engine->dropIdent( &opCtx, toRemove );
+                _dropPendingIdentReaper->dropIdent( &opCtx, toRemove );
                 wuow.commit();
             }
         }
 
+        const long long totalMillis = timer.millis();
+        log() << "opened catalog of " << numCollections << " collections in " << totalMillis
+              << "ms (reading catalog: " << catalogMillis << "ms, opening record stores: "
+              << openMillis << "ms, dropping unused idents: "
+              << totalMillis - catalogMillis - openMillis << "ms)";
+    }
+
+    void KVStorageEngine::_openRecordStores( const std::vector<std::string>& collections,
+                                             const std::vector<KVDatabaseCatalogEntry*>& dbs,
+                                             OperationContext* opCtx,
+                                             std::vector<RecordStore*>* out ) {
+        const size_t numThreads =
+            std::min( static_cast<size_t>( std::max( 0, static_cast<int>(
+                                                         storageEngineStartupThreads ) ) ),
+                      collections.size() / 2 );
+        if ( numThreads > 1 && _engine->supportsConcurrentIdentOpening() ) {
+            ThreadPool workers( numThreads, "KVStartup" );
+            for ( size_t i = 0; i < collections.size(); i++ ) {
+                workers.schedule( &openRecordStoreOnWorker,
+                                  _engine.get(), dbs[i], &collections[i], &(*out)[i] );
+            }
+            workers.join();
+        }
+
+        // Opens whatever isn't open yet here, where failures are fatal, including record stores
+        // whose opening failed on a worker.
+        for ( size_t i = 0; i < collections.size(); i++ ) {
+            if ( !(*out)[i] ) {
+                (*out)[i] = dbs[i]->openRecordStore( opCtx, collections[i] );
+            }
+        }
     }
 
     void KVStorageEngine::cleanShutdown() {
 
+        _dropPendingIdentReaper->shutdown();
+
         for ( DBMap::const_iterator it = _dbs.begin(); it != _dbs.end(); ++it ) {
             delete it->second;
         }
@@ -32,11 +32,13 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/thread/mutex.hpp>
 
 #include "mongo/db/storage/kv/kv_catalog.h"
+#include "mongo/db/storage/kv/kv_drop_pending_ident_reaper.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/storage_engine.h"
 
@@ -97,14 +99,31 @@ namespace mongo {
         KVCatalog* getCatalog() { return _catalog.get(); }
         const KVCatalog* getCatalog() const { return _catalog.get(); }
 
+        KVDropPendingIdentReaper* getDropPendingIdentReaper() {
+            return _dropPendingIdentReaper.get();
+        }
+
     private:
         class RemoveDBChange;
 
+        /**
+         * Opens the record store of each of the committed 'collections', which belong to 'dbs',
+         * into 'out', on several threads if the engine supports it.
+         */
+        void _openRecordStores( const std::vector<std::string>& collections,
+                                const std::vector<KVDatabaseCatalogEntry*>& dbs,
+                                OperationContext* opCtx,
+                                std::vector<RecordStore*>* out );
+
         KVStorageEngineOptions _options;
 
         // This must be the first member so it is destroyed last.
         boost::scoped_ptr<KVEngine> _engine;
 
+        // Drops the idents of dropped collections and indexes. Declared right after _engine so
+        // that it is stopped before anything else is destroyed.
+        boost::scoped_ptr<KVDropPendingIdentReaper> _dropPendingIdentReaper;
+
         const bool _supportsDocLocking;
 
         boost::scoped_ptr<RecordStore> _catalogRecordStore;
@@ -35,6 +35,7 @@
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/instance.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/mmap_v1_options.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/util/exit.h"
@@ -45,13 +46,31 @@ namespace mongo {
 
     using std::endl;
 
+    namespace {
+
+        // The rate at which the data files are written back between the syncdelay flushes, or 0
+        // to only write them at the flushes.
+        MONGO_EXPORT_SERVER_PARAMETER(dataFileWritebackMBPerSecond, int, 0);
+
+        // How often the writeback is started for the next part of the files.
+        const long long kWritebackIntervalMillis = 100;
+
+        // What is written back at once is a multiple of this, which is a multiple of page sizes.
+        const unsigned long long kWritebackUnitBytes = 1024 * 1024;
+
+    } // namespace
+
     DataFileSync dataFileSync;
 
     DataFileSync::DataFileSync()
         : ServerStatusSection( "backgroundFlushing" ),
           _total_time( 0 ),
           _flushes( 0 ),
-          _last() {
+          _last(),
+          _writebackBytes( 0 ),
+          _writebackPasses( 0 ),
+          _writebackPassStart( 0 ),
+          _lastWritebackPassMillis( 0 ) {
 
     }
 
@@ -76,7 +95,7 @@ namespace mongo {
                 continue;
             }
 
-            sleepmillis((long long) std::max(0.0, (storageGlobalParams.syncdelay * 1000) - time_flushing));
+            _writebackFor((long long) std::max(0.0, (storageGlobalParams.syncdelay * 1000) - time_flushing));
 
             if ( inShutdown() ) {
                 // occasional issue trying to flush during shutdown when sleep interrupted
@@ -108,9 +127,58 @@ namespace mongo {
         b.appendNumber( "average_ms" , (_flushes ? (_total_time / double(_flushes)) : 0.0) );
         b.appendNumber( "last_ms" , _last_time );
         b.append("last_finished", _last);
+
+        if (dataFileWritebackMBPerSecond > 0 || _writebackPasses > 0) {
+            // A page written to just after the writeback went past it waits for up to a whole pass
+            // before it is written back, unless a flush comes first.
+            BSONObjBuilder wb(b.subobjStart("writeback"));
+            wb.appendNumber("MBPerSecond", dataFileWritebackMBPerSecond);
+            wb.appendNumber("MB", static_cast<long long>(_writebackBytes / (1024 * 1024)));
+            wb.appendNumber("passes", _writebackPasses);
+            wb.appendNumber("last_pass_ms", _lastWritebackPassMillis);
+            wb.appendNumber("current_pass_ms",
+                            _writebackPassStart ?
+                                static_cast<long long>(curTimeMillis64() - _writebackPassStart) :
+                                0LL);
+            wb.done();
+        }
         return b.obj();
     }
 
+    void DataFileSync::_writebackFor(long long ms) {
+        const unsigned long long deadline = curTimeMillis64() + ms;
+        while (!inShutdown()) {
+            const unsigned long long now = curTimeMillis64();
+            if (now >= deadline) {
+                break;
+            }
+            sleepmillis(std::min(kWritebackIntervalMillis, static_cast<long long>(deadline - now)));
+
+            const int rate = dataFileWritebackMBPerSecond;
+            if (rate <= 0 || inShutdown()) {
+                continue;
+            }
+
+            const unsigned long long units = std::max(1ULL,
+                static_cast<unsigned long long>(rate) * kWritebackIntervalMillis *
+                (1024 * 1024) / 1000 / kWritebackUnitBytes);
+
+            if (!_writebackPassStart) {
+                _writebackPassStart = curTimeMillis64();
+            }
+            bool passCompleted = false;
+            _writebackBytes += MongoFile::writebackNext(&_writebackCursor,
+                                                        units * kWritebackUnitBytes,
+                                                        &passCompleted);
+            if (passCompleted) {
+                const unsigned long long end = curTimeMillis64();
+                _writebackPasses++;
+                _lastWritebackPassMillis = end - _writebackPassStart;
+                _writebackPassStart = end;
+            }
+        }
+    }
+
     void DataFileSync::_flushed(int ms) {
         _flushes++;
         _total_time += ms;
@@ -30,11 +30,14 @@
 
 #include "mongo/db/commands/server_status.h"
 #include "mongo/util/background.h"
+#include "mongo/util/mmap.h"
 
 namespace mongo {
 
     /**
-     * does background async flushes of mmapped files
+     * does background async flushes of mmapped files.  with dataFileWritebackMBPerSecond set it
+     * also starts the writeback of the files a little at a time in between, so that the flushes
+     * find less to write.
      */
     class DataFileSync : public BackgroundJob , public ServerStatusSection {
     public:
@@ -51,11 +54,21 @@ namespace mongo {
     private:
         void _flushed(int ms);
 
+        /** starts writebacks during the ms until the next flush is due */
+        void _writebackFor(long long ms);
+
         long long _total_time;
         long long _flushes;
         int _last_time;
         Date_t _last;
 
+        // Incremental writeback, only changed by the DataFileSync thread
+        MongoFile::WritebackCursor _writebackCursor;
+        unsigned long long _writebackBytes;
+        long long _writebackPasses;
+        unsigned long long _writebackPassStart; // curTimeMillis64() the current pass started at
+        long long _lastWritebackPassMillis;
+
     };
 
     extern DataFileSync dataFileSync;
@@ -47,6 +47,8 @@
          to be too frequent.
        there could be a slow down immediately after remapping as fresh copy-on-writes for commonly written pages will
          be required.  so doing these remaps fractionally is helpful. 
+       only the 1MB regions of each private view written to since their last remap (as noted in PREPLOGBUFFER)
+         are remapped, a fraction of them at a time, so this doesn't take longer with the size of the data.
 
    mutexes:
 
@@ -73,6 +75,7 @@
 
 #include "mongo/db/storage/mmap_v1/dur.h"
 
+#include <algorithm>
 #include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/shared_ptr.hpp>
@@ -84,6 +87,7 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/aligned_builder.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
@@ -113,10 +117,35 @@ namespace dur {
 
 namespace {
 
-    // Used to activate the flush thread
+    // Used to activate the flush thread. The flush thread only holds flushMutex while it waits
+    // for the next commit to become due, so notifiers take it to avoid lost wakeups.
     boost::mutex flushMutex;
     boost::condition_variable flushRequested;
 
+    // Set under flushMutex when a commit must start right away, e.g. for fsync or shutdown.
+    bool flushForced = false;
+
+    // The number of awaitCommit() calls ever made. The flush thread compares it to its value
+    // at the previous commit to know how many j:true acknowledgements are waiting.
+    AtomicUInt64 journalWaitersArrived;
+
+    // Set once the uncommitted bytes have passed journalGroupCommitBytes, so that writers only
+    // wake the flush thread once per commit.
+    AtomicUInt32 sizeCommitRequested(0);
+
+    // A commit starts as soon as this many j:true acknowledgements are waiting.
+    MONGO_EXPORT_SERVER_PARAMETER(journalGroupCommitWaiters, int, 16);
+
+    // Once a j:true acknowledgement is waiting, the commit starts at most this long after it
+    // arrived, so that the waiters which arrive meanwhile are journaled together. The window is
+    // further capped at half the recent journal write time: waiters which arrive during a write
+    // go into the next commit anyway, so a longer window would only add latency. 0 commits as
+    // soon as any acknowledgement is waiting.
+    MONGO_EXPORT_SERVER_PARAMETER(journalGroupCommitWindowMicros, int, 2000);
+
+    // A commit starts as soon as this many bytes of write intents are pending.
+    MONGO_EXPORT_SERVER_PARAMETER(journalGroupCommitBytes, int, UncommittedBytesLimit / 2);
+
     // This is waited on for getlasterror acknowledgements. It means that data has been written to
     // the journal, but not necessarily applied to the shared view, so it is all right to
     // acknowledge the user operation, but NOT all right to delete the journal files for example.
@@ -337,48 +366,75 @@ namespace {
             return;
         }
 
-        unsigned ntodo = (unsigned) (sz * fraction);
-        if( ntodo < 1 ) ntodo = 1;
-        if( ntodo > sz ) ntodo = sz;
+        // Only the regions of the private views written to since they were last remapped hold
+        // copy-on-write pages, so only those are remapped, and the fraction is of their total
+        // size.  The time spent here scales with how much was written rather than with the size
+        // of the data files.
+        unsigned long long dirtyBytes = 0;
+        for (set<MongoFile*>::const_iterator it = files.begin(); it != files.end(); ++it) {
+            if ((*it)->isDurableMappedFile()) {
+                dirtyBytes += ((DurableMappedFile*) *it)->dirtyBytes();
+            }
+        }
+        if (dirtyBytes == 0) {
+            return;
+        }
+
+        const unsigned long long budget =
+            fraction >= 1 ? dirtyBytes : static_cast<unsigned long long>(dirtyBytes * fraction);
 
         const set<MongoFile*>::iterator b = files.begin();
         const set<MongoFile*>::iterator e = files.end();
         set<MongoFile*>::iterator i = b;
 
         // Skip to our starting position as remembered from the last remap cycle
+        remapFileToStartAt %= sz;
         for (unsigned x = 0; x < remapFileToStartAt; x++) {
             i++;
-            if (i == e) i = b;
         }
 
-        // Mark where to start on the next cycle
         const unsigned startedAt = remapFileToStartAt;
-        remapFileToStartAt = (remapFileToStartAt + ntodo) % sz;
+        unsigned long long remapped = 0;
+        unsigned nfiles = 0;
 
         Timer t;
 
-        for (unsigned x = 0; x < ntodo; x++) {
+        for (unsigned x = 0; x < sz && remapped < budget; x++) {
+            // Mark where to start on the next cycle: this file again if it is left with regions
+            // to remap, else the next one.
+            remapFileToStartAt = (startedAt + x) % sz;
+
             if ((*i)->isDurableMappedFile()) {
                 DurableMappedFile* const mmf = (DurableMappedFile*) *i;
 
-                // Sanity check that the contents of the shared and the private view match so we
-                // don't end up overwriting data.
-                if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalParanoid) {
-                    debugValidateFileMapsMatch(mmf);
-                }
-
                 if (mmf->willNeedRemap()) {
-                    mmf->remapThePrivateView();
-                }
+                    // Sanity check that the contents of the shared and the private view match so
+                    // we don't end up overwriting data.
+                    if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalParanoid) {
+                        debugValidateFileMapsMatch(mmf);
+                    }
 
-                i++;
+                    remapped += mmf->remapDirtyRegions(budget - remapped);
+                    nfiles++;
+                }
 
-                if (i == e) i = b;
+                if (!mmf->willNeedRemap()) {
+                    remapFileToStartAt = (startedAt + x + 1) % sz;
+                }
             }
+            else {
+                remapFileToStartAt = (startedAt + x + 1) % sz;
+            }
+
+            i++;
+            if (i == e) i = b;
         }
 
-        LOG(3) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " n:" << ntodo
-               << ' ' << t.millis() << "ms";
+        stats.curr()->_remapPrivateViewBytes += remapped;
+
+        LOG(3) << "journal REMAPPRIVATEVIEW done startedAt: " << startedAt << " files:" << nfiles
+               << " remapped:" << remapped / (1024 * 1024) << "MB of " << dirtyBytes / (1024 * 1024)
+               << "MB " << t.millis() << "ms";
     }
 
 
@@ -428,6 +484,63 @@ namespace {
         _currIdx = newCurrIdx;
     }
 
+namespace {
+
+    /**
+     * Reports a histogram of counts kept in a LatencyHistogram's power-of-two buckets.
+     */
+    BSONObj countHistogramReport(const LatencyHistogram& histogram) {
+        BSONObjBuilder b;
+        b.appendNumber("count", histogram.getCount());
+        b.appendNumber("total", histogram.getTotalMicros());
+
+        BSONArrayBuilder buckets(b.subarrayStart("buckets"));
+        for (int i = 0; i < LatencyHistogram::kNumBuckets; i++) {
+            const long long count = histogram.getBucketCount(i);
+            if (count == 0) {
+                continue;
+            }
+            BSONObjBuilder bucket(buckets.subobjStart());
+            bucket.appendNumber("lowerBound", i == 0 ? 0LL : 1LL << (i - 1));
+            bucket.appendNumber("count", count);
+            bucket.doneFast();
+        }
+        buckets.doneFast();
+
+        return b.obj();
+    }
+
+    /**
+     * The group commit window in effect, as described for journalGroupCommitWindowMicros.
+     */
+    uint64_t groupCommitWindowMicros() {
+        const uint64_t configured = std::max(journalGroupCommitWindowMicros, 0);
+        const uint64_t recentWrite = std::max(stats.recentJournalWriteMicros.load(), 0LL);
+        if (recentWrite == 0) {
+            return configured;
+        }
+        return std::min(configured, recentWrite / 2);
+    }
+
+    uint64_t groupCommitBytes() {
+        if (journalGroupCommitBytes <= 0) {
+            return UncommittedBytesLimit / 2;
+        }
+        return std::min(static_cast<uint64_t>(journalGroupCommitBytes),
+                        static_cast<uint64_t>(UncommittedBytesLimit));
+    }
+
+    /**
+     * Makes the flush thread start a commit right away.
+     */
+    void forceFlush() {
+        boost::lock_guard<boost::mutex> lk(flushMutex);
+        flushForced = true;
+        flushRequested.notify_one();
+    }
+
+}  // namespace
+
     BSONObj Stats::asObj() const {
         // Use the previous statistic
         const S& stats = _stats[(_currIdx - 1) % (sizeof(_stats) / sizeof(_stats[0]))];
@@ -435,6 +548,14 @@ namespace {
         BSONObjBuilder builder;
         stats._asObj(&builder);
 
+        BSONObjBuilder groupCommit(builder.subobjStart("groupCommit"));
+        groupCommit.append("journalWriteLatency", journalWriteLatency.getReport());
+        groupCommit.append("waitersPerCommit", countHistogramReport(commitBatchWaiters));
+        groupCommit.append("bytesPerCommit", countHistogramReport(commitBatchBytes));
+        groupCommit.appendNumber("windowMicros",
+                                 static_cast<long long>(groupCommitWindowMicros()));
+        groupCommit.doneFast();
+
         return builder.obj();
     }
 
@@ -470,9 +591,10 @@ namespace {
         b << "commits" << _commits
           << "journaledMB" << _journaledBytes / 1000000.0
           << "writeToDataFilesMB" << _writeToDataFilesBytes / 1000000.0
+          << "remapPrivateViewMB" << _remapPrivateViewBytes / 1000000.0
           << "compression" << _journaledBytes / (_uncompressedBytes + 1.0)
           << "commitsInWriteLock" << _commitsInWriteLock
-          << "earlyCommits" << 0
+          << "earlyCommits" << _earlyCommits
           << "timeMs" << BSON("dt" << _durationMillis <<
                               "prepLogBuffer" << (unsigned) (_prepLogBufferMicros / 1000) <<
                               "writeToJournal" << (unsigned) (_writeToJournalMicros / 1000) <<
@@ -510,8 +632,7 @@ namespace {
 
         AutoYieldFlushLockForMMAPV1Commit flushLockYield(txn->lockState());
 
-        // There is always just one waiting anyways
-        flushRequested.notify_one();
+        forceFlush();
 
         // commitNotify.waitFor ensures that whatever was scheduled for journaling before this
         // call has been persisted to the journal file. This does not mean that this data has been
@@ -522,7 +643,19 @@ namespace {
     }
 
     bool DurableImpl::awaitCommit() {
-        commitNotify.awaitBeyondNow();
+        // Any commit numbered after 'when' covers this thread's writes, and commit numbers are
+        // only assigned by the flush thread, so waitFor(when) waits for the next commit.
+        const NotifyAll::When when = commitNotify.now();
+
+        // Counted after taking 'when', so that a waiter included in a commit's count is also
+        // covered by that commit.
+        {
+            boost::lock_guard<boost::mutex> lk(flushMutex);
+            journalWaitersArrived.fetchAndAdd(1);
+            flushRequested.notify_one();
+        }
+
+        commitNotify.waitFor(when);
         return true;
     }
 
@@ -542,13 +675,17 @@ namespace {
     }
 
     bool DurableImpl::commitIfNeeded() {
-        if (MONGO_likely(commitJob.bytes() < UncommittedBytesLimit)) {
+        const size_t bytes = commitJob.bytes();
+        if (MONGO_likely(bytes < groupCommitBytes())) {
             return false;
         }
 
-        // Just wake up the flush thread
-        flushRequested.notify_one();
-        return true;
+        // Just wake up the flush thread, once per commit
+        if (sizeCommitRequested.swap(1) == 0) {
+            boost::lock_guard<boost::mutex> lk(flushMutex);
+            flushRequested.notify_one();
+        }
+        return bytes >= UncommittedBytesLimit;
     }
 
     void DurableImpl::syncDataAndTruncateJournal(OperationContext* txn) {
@@ -580,8 +717,7 @@ namespace {
     void DurableImpl::commitAndStopDurThread() {
         NotifyAll::When when = commitNotify.now();
 
-        // There is always just one waiting anyways
-        flushRequested.notify_one();
+        forceFlush();
 
         // commitNotify.waitFor ensures that whatever was scheduled for journaling before this
         // call has been persisted to the journal file. This does not mean that this data has been
@@ -656,6 +792,55 @@ namespace {
     }
 
 
+    /**
+     * Blocks the flush thread until the next commit is due, which is when the first of these
+     * happens:
+     *  - a commit is forced,
+     *  - journalGroupCommitWaiters j:true acknowledgements are waiting,
+     *  - groupCommitBytes() bytes of write intents are pending,
+     *  - the group commit window has passed since the first waiting acknowledgement arrived, or
+     *  - 'intervalMillis' have passed.
+     *
+     * 'waitersCommitted' is the value of journalWaitersArrived covered by the previous commit.
+     * Returns true if the commit is due before the interval ran out.
+     */
+    static bool waitForGroupCommit(unsigned intervalMillis, uint64_t waitersCommitted) {
+        const uint64_t intervalEnd = curTimeMicros64() + intervalMillis * 1000ULL;
+        const uint64_t maxWaiters = std::max(journalGroupCommitWaiters, 1);
+        uint64_t firstWaiterMicros = 0;
+
+        boost::unique_lock<boost::mutex> lock(flushMutex);
+        while (true) {
+            if (flushForced) {
+                flushForced = false;
+                return true;
+            }
+
+            const uint64_t waiters = journalWaitersArrived.load() - waitersCommitted;
+            if (waiters >= maxWaiters || commitJob.bytes() >= groupCommitBytes()) {
+                return true;
+            }
+
+            const uint64_t now = curTimeMicros64();
+            uint64_t wakeAt = intervalEnd;
+            if (waiters > 0) {
+                if (firstWaiterMicros == 0) {
+                    firstWaiterMicros = now;
+                }
+                wakeAt = std::min(wakeAt, firstWaiterMicros + groupCommitWindowMicros());
+                if (now >= wakeAt) {
+                    return true;
+                }
+            }
+
+            if (now >= intervalEnd) {
+                return false;
+            }
+
+            flushRequested.timed_wait(lock, boost::posix_time::microseconds(wakeAt - now));
+        }
+    }
+
     /**
      * The main durability thread loop. There is a single instance of this function running.
      */
@@ -683,39 +868,22 @@ namespace {
         uint64_t estimatedPrivateMapSize(0);
         uint64_t remapLastTimestamp(0);
 
+        // The value of journalWaitersArrived covered by the most recent commit
+        uint64_t waitersCommitted(0);
+
         while (shutdownRequested.loadRelaxed() == 0) {
             unsigned ms = mmapv1GlobalOptions.journalCommitInterval;
             if (ms == 0) {
                 ms = samePartition ? 100 : 30;
             }
 
-            // +1 so it never goes down to zero
-            const unsigned oneThird = (ms / 3) + 1;
-
             // Reset the stats based on the reset interval
             if (stats.curr()->getCurrentDurationMillis() > DurStatsResetIntervalMillis) {
                 stats.reset();
             }
 
             try {
-                boost::unique_lock<boost::mutex> lock(flushMutex);
-
-                for (unsigned i = 0; i <= 2; i++) {
-                    if (flushRequested.timed_wait(lock, Milliseconds(oneThird))) {
-                        // Someone forced a flush
-                        break;
-                    }
-
-                    if (commitNotify.nWaiting()) {
-                        // One or more getLastError j:true is pending
-                        break;
-                    }
-
-                    if (commitJob.bytes() > UncommittedBytesLimit / 2) {
-                        // The number of written bytes is growing
-                        break;
-                    }
-                }
+                const bool earlyCommit = waitForGroupCommit(ms, waitersCommitted);
 
                 // The commit logic itself
                 LOG(4) << "groupCommit begin";
@@ -725,10 +893,17 @@ namespace {
                 OperationContextImpl txn;
                 AutoAcquireFlushLockForMMAPV1Commit autoFlushLock(txn.lockState());
 
+                // Read before the commit number is taken, so that every waiter counted here took
+                // its own number earlier and is covered by this commit. See awaitCommit().
+                const uint64_t waitersArrived = journalWaitersArrived.load();
+
                 // We need to snapshot the commitNumber after the flush lock has been obtained,
                 // because at this point we know that we have a stable snapshot of the data.
                 const NotifyAll::When commitNumber(commitNotify.now());
 
+                stats.commitBatchWaiters.recordMicros(waitersArrived - waitersCommitted);
+                waitersCommitted = waitersArrived;
+
                 LOG(4) << "Processing commit number " << commitNumber;
 
                 if (!commitJob.hasWritten()) {
@@ -750,6 +925,7 @@ namespace {
                     PREPLOGBUFFER(buffer->getHeader(), buffer->getBuilder());
 
                     estimatedPrivateMapSize += commitJob.bytes();
+                    stats.commitBatchBytes.recordMicros(commitJob.bytes());
                     commitCounter++;
 
                     // Now that the write intents have been copied to the buffer, the commit job is
@@ -757,6 +933,7 @@ namespace {
                     // the S flush lock, because otherwise someone might have done a write and this
                     // would wipe out their changes without ever being committed.
                     commitJob.committingReset();
+                    sizeCommitRequested.store(0);
 
                     double systemMemoryPressurePercentage =
                         ProcessInfo::getSystemMemoryPressurePercentage();
@@ -842,6 +1019,9 @@ namespace {
 
                 stats.curr()->_commits++;
                 stats.curr()->_commitsMicros += t.micros();
+                if (earlyCommit) {
+                    stats.curr()->_earlyCommits++;
+                }
 
                 LOG(4) << "groupCommit end";
             }
@@ -38,6 +38,7 @@
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include "mongo/base/data_view.h"
 #include "mongo/base/init.h"
 #include "mongo/config.h"
 #include "mongo/db/client.h"
@@ -50,6 +51,7 @@
 #include "mongo/platform/random.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/file.h"
 #include "mongo/util/hex.h"
@@ -139,16 +141,27 @@ namespace mongo {
             reserved = 0;
             magic[0] = magic[1] = magic[2] = magic[3] = '\n';
 
-            Checksum c;
-            c.gen(begin, (unsigned) len);
-            memcpy(hash, c.bytes, sizeof(hash));
+            memset(hash, 0, sizeof(hash));
+            DataView(reinterpret_cast<char*>(hash)).write<LittleEndian<uint32_t>>(
+                crc32c(0, begin, len));
         }
 
-        bool JSectFooter::checkHash(const void* begin, int len) const {
+        bool JSectFooter::checkHash(const void* begin, int len, bool legacyChecksum) const {
             if( !magicOk() ) { 
                 log() << "journal footer not valid" << endl;
                 return false;
             }
+            if (!legacyChecksum) {
+                unsigned char computed[sizeof(hash)];
+                memset(computed, 0, sizeof(computed));
+                DataView(reinterpret_cast<char*>(computed)).write<LittleEndian<uint32_t>>(
+                    crc32c(0, begin, len));
+                if (memcmp(hash, computed, sizeof(hash)) == 0)
+                    return true;
+                log() << "journal checkHash mismatch, got: " << toHex(computed, 4)
+                      << " expected: " << toHex(hash, sizeof(hash)) << endl;
+                return false;
+            }
             Checksum c;
             c.gen(begin, len);
             DEV log() << "checkHash len:" << len << " hash:" << toHex(hash, 16) << " current:" << toHex(c.bytes, 16) << endl;
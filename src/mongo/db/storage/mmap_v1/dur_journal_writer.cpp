@@ -41,6 +41,7 @@
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 namespace dur {
@@ -206,6 +207,15 @@ namespace {
         }
     }
 
+    void JournalWriter::_recordJournalWrite(long long micros) {
+        stats.journalWriteLatency.recordMicros(micros);
+
+        // Only this thread updates the average, so a plain load and store suffice.
+        const long long previous = stats.recentJournalWriteMicros.load();
+        stats.recentJournalWriteMicros.store(previous == 0 ? micros
+                                                           : (previous * 7 + micros) / 8);
+    }
+
     void JournalWriter::_journalWriterThread() {
         Client::initThread("journal writer");
 
@@ -238,7 +248,9 @@ namespace {
                        << ", size " << buffer->_builder.len() << " bytes)";
 
                 // This performs synchronous I/O to the journal file and will block.
+                Timer journalTimer;
                 WRITETOJOURNAL(buffer->_header, buffer->_builder);
+                _recordJournalWrite(journalTimer.micros());
 
                 // Data is now persisted in the journal, which is sufficient for acknowledging
                 // getLastError
@@ -162,6 +162,11 @@ namespace dur {
 
         void _journalWriterThread();
 
+        /**
+         * Records how long a journal write took in the durability statistics.
+         */
+        void _recordJournalWrite(long long micros);
+
 
         // This gets notified as journal buffers are written. It is not owned and needs to outlive
         // the journal writer object.
@@ -53,10 +53,12 @@ namespace mongo {
 
             // x4142 is asci--readable if you look at the file with head/less -- thus the starting values were near
             // that.  simply incrementing the version # is safe on a fwd basis.
+            // Sections of CurrentVersion files have a crc32c in their footer, those of
+            // LegacyChecksumVersion files a Checksum.  Both are read.
 #if defined(_NOCOMPRESS)
-            enum { CurrentVersion = 0x4148 };
+            enum { LegacyChecksumVersion = 0x4148, CurrentVersion = 0x414a };
 #else
-            enum { CurrentVersion = 0x4149 };
+            enum { LegacyChecksumVersion = 0x4149, CurrentVersion = 0x414b };
 #endif
             unsigned short _version;
 
@@ -72,7 +74,10 @@ namespace mongo {
             char reserved3[8026]; // 8KB total for the file header
             char txt2[2];         // "\n\n" at the end
 
-            bool versionOk() const { return _version == CurrentVersion; }
+            bool versionOk() const {
+                return _version == CurrentVersion || _version == LegacyChecksumVersion;
+            }
+            bool legacyChecksum() const { return _version == LegacyChecksumVersion; }
             bool valid() const { return magic[0] == 'j' && txt2[1] == '\n' && fileId; }
         };
 
@@ -100,7 +105,7 @@ namespace mongo {
         };
 
         /** an individual write operation within a group commit section.  Either the entire section should
-            be applied, or nothing.  (We check the md5 for the whole section before doing anything on recovery.)
+            be applied, or nothing.  (We check the checksum for the whole section before doing anything on recovery.)
         */
         struct JEntry {
             enum OpCodes {
@@ -146,11 +151,13 @@ namespace mongo {
             }
         };
 
-        /** group commit section footer. md5 is a key field. */
+        /** group commit section footer. the checksum of the section is a key field. */
         struct JSectFooter {
             JSectFooter();
             JSectFooter(const void* begin, int len); // needs buffer to compute hash
             unsigned sentinel;
+            // the crc32c of the section, little endian, in the first 4 bytes and zeroes after, or
+            // a Checksum in journal files of JHeader::LegacyChecksumVersion
             unsigned char hash[16];
             unsigned long long reserved;
             char magic[4]; // "\n\n\n\n"
@@ -158,9 +165,10 @@ namespace mongo {
             /** used by recovery to see if buffer is valid
                 @param begin the buffer
                 @param len buffer len
+                @param legacyChecksum whether the journal file is of JHeader::LegacyChecksumVersion
                 @return true if buffer looks valid
             */
-            bool checkHash(const void* begin, int len) const;
+            bool checkHash(const void* begin, int len, bool legacyChecksum) const;
 
             bool magicOk() const { return *((unsigned*)magic) == 0x0a0a0a0a; }
         };
@@ -83,12 +83,8 @@ namespace mongo {
             size_t ofs = 1;
             DurableMappedFile *mmf = findMMF_inlock(i->start(), /*out*/ofs);
 
-            if( MONGO_unlikely(!mmf->willNeedRemap()) ) {
-                // tag this mmf as needed a remap of its private view later.
-                // usually it will already be dirty/already set, so we do the if above first
-                // to avoid possibility of cpu cache line contention
-                mmf->setWillNeedRemap();
-            }
+            // tag the written part of this mmf as needing a remap of its private view later.
+            mmf->setWillNeedRemap(ofs, i->length());
 
             // since we have already looked up the mmf, we go ahead and remember the write view location
             // so we don't have to find the DurableMappedFile again later in WRITETODATAFILES()
@@ -40,6 +40,7 @@
 #include <sys/stat.h>
 
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/dur_commitjob.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
@@ -50,11 +51,14 @@
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -78,6 +82,11 @@ namespace mongo {
      */
     class JournalSectionCorruptException {};
 
+    // Number of threads used by journal recovery to checksum, uncompress and parse sections, and
+    // to apply the writes of a section to different data files. Sections are still applied one at
+    // a time, in journal order. 1 recovers on the startup thread only.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalRecoveryThreads, int, 4);
+
     namespace dur {
 
         // The singleton recovery job object
@@ -102,6 +111,56 @@ namespace mongo {
             boost::shared_ptr<DurOp> op;
         };
 
+        class JournalSectionIterator;
+
+        /** a section of a journal file, checksummed and parsed ahead of being applied */
+        struct PreparedSection {
+            PreparedSection(const JSectHeader *h, const void *data, unsigned len,
+                            const JSectFooter *f)
+                : h(h), data(data), len(len), f(f),
+                  skip(false), corrupt(false), error(Status::OK()) {
+            }
+
+            const JSectHeader *h;
+            const void *data;
+            unsigned len;
+            const JSectFooter *f;
+
+            bool skip; // already in the data files
+            bool corrupt; // processing stops here, as if the file ended abruptly
+            Status error; // rethrown when the section is reached
+
+            // owns the uncompressed buffer the entries point into
+            boost::shared_ptr<JournalSectionIterator> iterator;
+            vector<ParsedJournalEntry> entries;
+        };
+
+        namespace {
+
+            // Sections prepared ahead of being applied, as a multiple of the number of threads,
+            // and at most this many bytes of compressed sections.
+            const size_t kSectionsPerThread = 4;
+            const unsigned kMaxPreparedBytes = 64 * 1024 * 1024;
+
+            // Fewer consecutive writes than this are applied on the recovering thread.
+            const size_t kMinParallelWrites = 64;
+
+            struct FileWrites {
+                FileWrites() : bytes(0) { }
+                vector<const JEntry*> writes; // in journal order
+                long long bytes;
+            };
+
+            void copyWrites(char* view, const vector<const JEntry*>* writes) {
+                for (vector<const JEntry*>::const_iterator i = writes->begin();
+                     i != writes->end();
+                     ++i) {
+                    memcpy(view + (*i)->ofs, (*i)->srcData(), (*i)->len);
+                }
+            }
+
+        } // namespace
+
 
         /**
          * Get journal filenames, in order. Throws if unexpected content found.
@@ -254,8 +313,10 @@ namespace mongo {
 
         RecoveryJob::RecoveryJob()
             : _recovering(false),
+              _legacyChecksums(false),
               _lastDataSyncedFromLastRun(0),
-              _lastSeqMentionedInConsoleLog(1) {
+              _lastSeqMentionedInConsoleLog(1),
+              _workers(NULL) {
 
         }
 
@@ -376,8 +437,28 @@ namespace mongo {
             }
 
             Last last;
-            for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
-                applyEntry(last, *i, apply, dump);
+            if (_workers && apply && !dump) {
+                vector<ParsedJournalEntry>::const_iterator i = entries.begin();
+                while (i != entries.end()) {
+                    if (!i->e) {
+                        applyEntry(last, *i, apply, dump);
+                        ++i;
+                        continue;
+                    }
+
+                    // DurOps may close or drop files, so only the writes between them are batched.
+                    vector<ParsedJournalEntry>::const_iterator end = i;
+                    while (end != entries.end() && end->e) {
+                        ++end;
+                    }
+                    applyWrites(last, i, end);
+                    i = end;
+                }
+            }
+            else {
+                for (vector<ParsedJournalEntry>::const_iterator i = entries.begin(); i != entries.end(); ++i) {
+                    applyEntry(last, *i, apply, dump);
+                }
             }
 
             if (dump) {
@@ -385,30 +466,153 @@ namespace mongo {
             }
         }
 
+        void RecoveryJob::applyWrites(Last& last,
+                                      vector<ParsedJournalEntry>::const_iterator begin,
+                                      vector<ParsedJournalEntry>::const_iterator end) {
+            if (static_cast<size_t>(end - begin) < kMinParallelWrites) {
+                for (vector<ParsedJournalEntry>::const_iterator i = begin; i != end; ++i) {
+                    write(last, *i);
+                }
+                return;
+            }
+
+            // Writes to the same file may overlap so they stay in journal order, but writes to
+            // different files can be applied at the same time. Files are opened and writes checked
+            // here so that the workers only copy.
+            typedef map<DurableMappedFile*, FileWrites> WritesByFile;
+            WritesByFile byFile;
+            for (vector<ParsedJournalEntry>::const_iterator i = begin; i != end; ++i) {
+                verify(i->e);
+                verify(i->dbName);
+
+                DurableMappedFile *mmf = last.newEntry(*i, *this);
+                if ((i->e->ofs + i->e->len) <= mmf->length()) {
+                    verify(mmf->view_write());
+                    verify(i->e->srcData());
+
+                    FileWrites& fileWrites = byFile[mmf];
+                    fileWrites.writes.push_back(i->e);
+                    fileWrites.bytes += i->e->len;
+                }
+                else {
+                    massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
+                }
+            }
+
+            for (WritesByFile::const_iterator i = byFile.begin(); i != byFile.end(); ++i) {
+                char* view = static_cast<char*>(i->first->view_write());
+                if (byFile.size() == 1) {
+                    copyWrites(view, &i->second.writes);
+                }
+                else {
+                    _workers->schedule(&copyWrites, view, &i->second.writes);
+                }
+                stats.curr()->_writeToDataFilesBytes += i->second.bytes;
+            }
+            _workers->join();
+        }
+
+        void RecoveryJob::checkSection(const JSectHeader *h, const void *p, unsigned len,
+                                       const JSectFooter *f) const {
+            verify( ((const char *)h) + sizeof(JSectHeader) == p );
+            if (!f->checkHash(h, len + sizeof(JSectHeader), _legacyChecksums)) {
+                log() << "journal section checksum doesn't match";
+                throw JournalSectionCorruptException();
+            }
+        }
+
+        bool RecoveryJob::alreadyApplied(const JSectHeader& h) const {
+            return _lastDataSyncedFromLastRun > h.seqNumber + ExtraKeepTimeMs;
+        }
+
+        void RecoveryJob::logSkippedSection(const JSectHeader& h) {
+            if( h.seqNumber != _lastSeqMentionedInConsoleLog ) {
+                static int n;
+                if( ++n < 10 ) {
+                    log() << "recover skipping application of section seq:" << h.seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
+                }
+                else if( n == 10 ) { 
+                    log() << "recover skipping application of section more..." << endl;
+                }
+                _lastSeqMentionedInConsoleLog = h.seqNumber;
+            }
+        }
+
+        void RecoveryJob::prepareSection(PreparedSection* section) const {
+            try {
+                checkSection(section->h, section->data, section->len, section->f);
+                if (alreadyApplied(*section->h)) {
+                    section->skip = true;
+                    return;
+                }
+
+                section->iterator.reset(new JournalSectionIterator(*section->h,
+                                                                   section->data,
+                                                                   section->len,
+                                                                   _recovering));
+                ParsedJournalEntry e;
+                while (!section->iterator->atEof()) {
+                    section->iterator->next(e);
+                    section->entries.push_back(e);
+                }
+            }
+            catch (const JournalSectionCorruptException&) {
+                section->corrupt = true;
+            }
+            catch (const BufReader::eof&) {
+                section->corrupt = true;
+            }
+            catch (const DBException& e) {
+                section->error = e.toStatus();
+            }
+            catch (const std::exception& e) {
+                section->error = Status(ErrorCodes::InternalError, e.what());
+            }
+        }
+
+        void RecoveryJob::processSections(vector<PreparedSection>* pending) {
+            // Whatever happens, these sections are not looked at again.
+            vector<PreparedSection> sections;
+            sections.swap(*pending);
+
+            for (size_t i = 0; i < sections.size(); i++) {
+                _workers->schedule(&RecoveryJob::prepareSection, this, &sections[i]);
+            }
+            _workers->join();
+
+            LockMongoFilesShared lkFiles; // for RecoveryJob::Last
+            boost::lock_guard<boost::mutex> lk(_mx);
+
+            for (size_t i = 0; i < sections.size(); i++) {
+                const PreparedSection& section = sections[i];
+                if (section.corrupt) {
+                    throw JournalSectionCorruptException();
+                }
+                uassertStatusOK(section.error);
+
+                if (section.skip) {
+                    logSkippedSection(*section.h);
+                }
+                else {
+                    applyEntries(section.entries);
+                }
+
+                // ctrl c check
+                uassert(ErrorCodes::Interrupted, "interrupted during journal recovery", !inShutdown());
+            }
+        }
+
         void RecoveryJob::processSection(const JSectHeader *h, const void *p, unsigned len, const JSectFooter *f) {
             LockMongoFilesShared lkFiles; // for RecoveryJob::Last
             boost::lock_guard<boost::mutex> lk(_mx);
 
             // Check the footer checksum before doing anything else.
             if (_recovering) {
-                verify( ((const char *)h) + sizeof(JSectHeader) == p );
-                if (!f->checkHash(h, len + sizeof(JSectHeader))) {
-                    log() << "journal section checksum doesn't match";
-                    throw JournalSectionCorruptException();
-                }
+                checkSection(h, p, len, f);
             }
 
-            if( _recovering && _lastDataSyncedFromLastRun > h->seqNumber + ExtraKeepTimeMs ) {
-                if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
-                    static int n;
-                    if( ++n < 10 ) {
-                        log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
-                    }
-                    else if( n == 10 ) { 
-                        log() << "recover skipping application of section more..." << endl;
-                    }
-                    _lastSeqMentionedInConsoleLog = h->seqNumber;
-                }
+            if( _recovering && alreadyApplied(*h) ) {
+                logSkippedSection(*h);
                 return;
             }
 
@@ -449,6 +653,11 @@ namespace mongo {
             @return true if this is detected to be the last file (ends abruptly)
         */
         bool RecoveryJob::processFileBuffer(const void *p, unsigned len) {
+            // Sections read but not yet applied, when recovering with workers.
+            vector<PreparedSection> pending;
+            unsigned pendingBytes = 0;
+            const size_t maxPending = _workers ? journalRecoveryThreads * kSectionsPerThread : 0;
+
             try {
                 unsigned long long fileId;
                 BufReader br(p,len);
@@ -475,6 +684,7 @@ namespace mongo {
                         uasserted(13536, str::stream() << "journal version number mismatch " << h._version);
                     }
                     fileId = h.fileId;
+                    _legacyChecksums = h.legacyChecksum();
                     if (mmapv1GlobalOptions.journalOptions &
                         MMAPV1Options::JournalDumpJournal) {
                         log() << "JHeader::fileId=" << fileId << endl;
@@ -491,6 +701,9 @@ namespace mongo {
                             log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
                             log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
                         }
+                        if (!pending.empty()) {
+                            processSections(&pending);
+                        }
                         return true;
                     }
                     unsigned slen = h.sectionLen();
@@ -498,13 +711,35 @@ namespace mongo {
                     const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
                     const char *data = hdr + sizeof(JSectHeader);
                     const char *footer = data + dataLen;
+                    if (_workers) {
+                        pending.push_back(PreparedSection((const JSectHeader*) hdr, data, dataLen,
+                                                          (const JSectFooter*) footer));
+                        pendingBytes += slen;
+                        if (pending.size() >= maxPending || pendingBytes >= kMaxPreparedBytes) {
+                            processSections(&pending);
+                            pendingBytes = 0;
+                        }
+                        continue;
+                    }
                     processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
 
                     // ctrl c check
                     uassert(ErrorCodes::Interrupted, "interrupted during journal recovery", !inShutdown());
                 }
+
+                if (!pending.empty()) {
+                    processSections(&pending);
+                }
             }
             catch (const BufReader::eof&) {
+                // The sections read before the file ended are complete, so they still apply.
+                if (!pending.empty()) {
+                    try {
+                        processSections(&pending);
+                    }
+                    catch (const JournalSectionCorruptException&) {
+                    }
+                }
                 if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalDumpJournal)
                     log() << "ABRUPT END" << endl;
                 return true; // abrupt end
@@ -544,6 +779,15 @@ namespace mongo {
             LockMongoFilesExclusive lkFiles; // for RecoveryJob::Last
             _recovering = true;
 
+            boost::scoped_ptr<ThreadPool> workers;
+            if (journalRecoveryThreads > 1) {
+                workers.reset(new ThreadPool(journalRecoveryThreads, "JournalRecovery"));
+                _workers = workers.get();
+                log() << "recover using " << journalRecoveryThreads << " threads" << endl;
+            }
+            ON_BLOCK_EXIT([this] { _workers = NULL; });
+            Timer timer;
+
             // load the last sequence number synced to the datafiles on disk before the last crash
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
@@ -567,7 +811,7 @@ namespace mongo {
 
             log() << "recover cleaning up" << endl;
             removeJournalFiles();
-            log() << "recover done" << endl;
+            log() << "recover done in " << timer.millis() << "ms" << endl;
             okToCleanUp = true;
             _recovering = false;
         }
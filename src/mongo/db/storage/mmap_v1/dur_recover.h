@@ -33,6 +33,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/shared_ptr.hpp>
 #include <list>
+#include <vector>
 
 #include "mongo/db/storage/mmap_v1/dur_journalformat.h"
 #include "mongo/util/concurrency/mutex.h"
@@ -41,9 +42,14 @@ namespace mongo {
 
     class DurableMappedFile;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     namespace dur {
 
         struct ParsedJournalEntry;
+        struct PreparedSection;
 
         /** call go() to execute a recovery from existing journal files.
          */
@@ -80,6 +86,24 @@ namespace mongo {
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const std::vector<ParsedJournalEntry> &entries);
+
+            /** applies consecutive basic writes, those to different data files concurrently */
+            void applyWrites(Last& last,
+                             std::vector<ParsedJournalEntry>::const_iterator begin,
+                             std::vector<ParsedJournalEntry>::const_iterator end);
+
+            /** throws JournalSectionCorruptException if the section's checksum doesn't match */
+            void checkSection(const JSectHeader *h, const void *p, unsigned len,
+                              const JSectFooter *f) const;
+            /** true if the section was already written to the data files before the crash */
+            bool alreadyApplied(const JSectHeader& h) const;
+            void logSkippedSection(const JSectHeader& h);
+
+            /** checksums, uncompresses and parses a section. Runs on the recovery workers. */
+            void prepareSection(PreparedSection* section) const;
+            /** prepares the sections concurrently, then applies them in journal order */
+            void processSections(std::vector<PreparedSection>* sections);
+
             bool processFileBuffer(const void *, unsigned len);
             bool processFile(boost::filesystem::path journalfile);
             void _close(); // doesn't lock
@@ -92,9 +116,17 @@ namespace mongo {
             // Are we in recovery or WRITETODATAFILES
             bool _recovering;
 
+            // Whether the sections of the journal file being recovered have a Checksum in their
+            // footer rather than a crc32c.
+            bool _legacyChecksums;
+
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
 
+            // Threads preparing sections and applying writes while recovering, NULL otherwise or
+            // if journalRecoveryThreads is 1.
+            threadpool::ThreadPool* _workers;
+
 
             static RecoveryJob& _instance;
         };
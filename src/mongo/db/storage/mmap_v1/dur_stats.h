@@ -29,6 +29,8 @@
 */
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/stats/latency_histogram.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
     namespace dur {
@@ -60,9 +62,14 @@ namespace mongo {
                 unsigned _commits;
                 unsigned _commitsInWriteLock;
 
+                // Commits made before journalCommitInterval ran out, because of waiters, a forced
+                // flush or the amount of uncommitted data.
+                unsigned _earlyCommits;
+
                 uint64_t _journaledBytes;
                 uint64_t _uncompressedBytes;
                 uint64_t _writeToDataFilesBytes;
+                uint64_t _remapPrivateViewBytes;
 
                 uint64_t _prepLogBufferMicros;
                 uint64_t _writeToJournalMicros;
@@ -81,6 +88,20 @@ namespace mongo {
             const S* curr() const { return &_stats[_currIdx]; }
             S* curr() { return &_stats[_currIdx]; }
 
+            // The statistics below cover the whole life of the process rather than an interval,
+            // and may be updated from any thread.
+
+            // Time to write and sync each journal section, recorded by the journal writer.
+            LatencyHistogram journalWriteLatency;
+
+            // Moving average of journalWriteLatency, which bounds the group commit window.
+            AtomicInt64 recentJournalWriteMicros;
+
+            // How many j:true waiters and how many bytes of write intents each commit covered.
+            // These use the histogram's power-of-two buckets for counts rather than times.
+            LatencyHistogram commitBatchWaiters;
+            LatencyHistogram commitBatchBytes;
+
         private:
             S _stats[5];
             unsigned _currIdx;
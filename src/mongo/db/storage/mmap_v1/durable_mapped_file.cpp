@@ -38,6 +38,7 @@
 
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "mongo/db/concurrency/d_concurrency.h"
@@ -60,10 +61,83 @@ namespace mongo {
     using std::pair;
     using std::string;
 
+    void DurableMappedFile::markDirty(size_t ofs, unsigned len) {
+        if (_dirtyRegions.empty()) {
+            _dirtyRegions.resize((length() + RemapRegionSize - 1) / RemapRegionSize);
+        }
+        const size_t first = ofs / RemapRegionSize;
+        const size_t last = std::min((ofs + std::max(len, 1U) - 1) / RemapRegionSize,
+                                     _dirtyRegions.size() - 1);
+        for (size_t region = first; region <= last; region++) {
+            if (!_dirtyRegions[region]) {
+                _dirtyRegions[region] = true;
+                _numDirtyRegions++;
+            }
+        }
+    }
+
+    void DurableMappedFile::clearDirtyRegions() {
+        _dirtyRegions.assign(_dirtyRegions.size(), false);
+        _numDirtyRegions = 0;
+    }
+
+    unsigned long long DurableMappedFile::remapDirtyRegions(unsigned long long maxBytes) {
+        verify(storageGlobalParams.dur);
+
+        if (_numDirtyRegions == 0) {
+            return 0;
+        }
+
+#ifdef _WIN32
+        // Remapping part of a view isn't atomic here, see MemoryMappedFile::remapPrivateView, so
+        // the whole view is remapped at once.
+        const unsigned long long remapped = dirtyBytes();
+        remapThePrivateView();
+        return remapped;
+#else
+        const size_t numRegions = _dirtyRegions.size();
+        const unsigned long long fileLen = length();
+        unsigned long long remapped = 0;
+
+        size_t region = _nextRegionToRemap < numRegions ? _nextRegionToRemap : 0;
+        for (size_t scanned = 0; scanned < numRegions && _numDirtyRegions > 0; ) {
+            if (!_dirtyRegions[region]) {
+                region = (region + 1) % numRegions;
+                scanned++;
+                continue;
+            }
+
+            // Remap the run of dirty regions starting here with one call, not wrapping around
+            // and not going too far past maxBytes.
+            size_t end = region;
+            while (end < numRegions && _dirtyRegions[end] &&
+                   (remapped == 0 || remapped < maxBytes)) {
+                _dirtyRegions[end] = false;
+                _numDirtyRegions--;
+                remapped += RemapRegionSize;
+                end++;
+            }
+            const unsigned long long ofs = static_cast<unsigned long long>(region) *
+                                           RemapRegionSize;
+            const unsigned long long runEnd =
+                std::min(static_cast<unsigned long long>(end) * RemapRegionSize, fileLen);
+            remapPrivateViewRange(_view_private, ofs, runEnd - ofs);
+
+            scanned += end - region;
+            region = end % numRegions;
+            if (remapped >= maxBytes) {
+                break;
+            }
+        }
+        _nextRegionToRemap = region;
+        return remapped;
+#endif
+    }
+
     void DurableMappedFile::remapThePrivateView() {
         verify(storageGlobalParams.dur);
 
-        _willNeedRemap = false;
+        clearDirtyRegions();
 
         // todo 1.9 : it turns out we require that we always remap to the same address.
         // so the remove / add isn't necessary and can be removed?
@@ -283,7 +357,7 @@ namespace mongo {
         return false;
     }
 
-    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false) {
+    DurableMappedFile::DurableMappedFile() : _numDirtyRegions(0), _nextRegionToRemap(0) {
         _view_write = _view_private = 0;
     }
 
@@ -31,6 +31,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/util/mmap.h"
 #include "mongo/util/paths.h"
 
@@ -88,27 +90,60 @@ namespace mongo {
         int fileSuffixNo() const { return _fileSuffixNo; }
         HANDLE getFd() { return MemoryMappedFile::getFd(); }
 
+        /** granularity at which written parts of the private view are tracked and remapped */
+        static const size_t RemapRegionSize = 1024 * 1024;
+
         /** true if we have written.
             set in PREPLOGBUFFER, it is NOT set immediately on write intent declaration.
-            reset to false in REMAPPRIVATEVIEW
+            reset to false in REMAPPRIVATEVIEW, once every region written to is remapped
+        */
+        bool willNeedRemap() const { return _numDirtyRegions > 0; }
+
+        /** notes that len bytes at offset ofs of the private view are written.  called in
+            PREPLOGBUFFER only, like the remap functions in REMAPPRIVATEVIEW, so not threadsafe.
         */
-        bool willNeedRemap() { return _willNeedRemap; }
-        void setWillNeedRemap() { _willNeedRemap = true; }
+        void setWillNeedRemap(size_t ofs, unsigned len) {
+            size_t region = ofs / RemapRegionSize;
+            // usually the region is already dirty, so this is checked first
+            if( MONGO_likely(region < _dirtyRegions.size() && _dirtyRegions[region] &&
+                             (ofs + len - 1) / RemapRegionSize == region) ) {
+                return;
+            }
+            markDirty(ofs, len);
+        }
 
+        /** bytes of the private view in regions written to since they were last remapped */
+        unsigned long long dirtyBytes() const {
+            return static_cast<unsigned long long>(_numDirtyRegions) * RemapRegionSize;
+        }
+
+        /** remaps the whole private view */
         void remapThePrivateView();
 
+        /** remaps regions written to, resuming after the one last remapped, until at least
+            maxBytes are remapped or none are left.  remaps at least one region.
+            @return bytes remapped
+        */
+        unsigned long long remapDirtyRegions(unsigned long long maxBytes);
+
         virtual bool isDurableMappedFile() { return true; }
 
     private:
 
         void *_view_write;
         void *_view_private;
-        bool _willNeedRemap;
+
+        // one per RemapRegionSize bytes of the private view, true if written to since remapped
+        std::vector<bool> _dirtyRegions;
+        size_t _numDirtyRegions;
+        size_t _nextRegionToRemap;
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
         void setPath(const std::string& pathAndFileName);
         bool finishOpening();
+        void markDirty(size_t ofs, unsigned len);
+        void clearDirtyRegions();
     };
 
 
@@ -172,6 +172,12 @@ namespace mongo {
          * Caller takes owernship of CacheHint
          */
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint ) = 0;
+
+        /**
+         * Tell the system that the 'len' bytes starting 'offset' bytes into this extent will be
+         * read soon, so that it can start reading them from disk. Does not wait for the reads.
+         */
+        virtual void readAhead( const DiskLoc& extentLoc, int offset, int len ) const = 0;
     };
 
 }
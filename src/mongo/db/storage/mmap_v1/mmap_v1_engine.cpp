@@ -37,6 +37,7 @@
 #include <fstream>
 
 #include "mongo/db/mongod_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/data_file_sync.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/storage/mmap_v1/dur_journal.h"
@@ -59,6 +60,10 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // Number of threads allocating data files, so that several databases, or several files of a
+    // fast growing one, are preallocated at the same time.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(mmapv1FileAllocatorThreads, int, 2);
+
 namespace {
 
 #if !defined(__sun)
@@ -222,7 +227,7 @@ namespace {
 
         acquirePathLock(this, storageGlobalParams.repair, lockFile);
 
-        FileAllocator::get()->start();
+        FileAllocator::get()->start(mmapv1FileAllocatorThreads);
 
         MONGO_ASSERT_ON_EXCEPTION_WITH_MSG( clearTmpFiles(), "clear tmp files" );
     }
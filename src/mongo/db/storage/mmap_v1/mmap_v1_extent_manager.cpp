@@ -49,8 +49,10 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/file.h"
+#include "mongo/util/file_allocator.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -67,6 +69,9 @@ namespace mongo {
     static Counter64 needsFetchFailCounter;
     MONGO_FP_DECLARE(recordNeedsFetchFail);
 
+    // The most data files preallocated ahead of the one a database is filling.
+    static const int kMaxFilesPreallocatedAhead = 4;
+
     // Used to make sure the compiler doesn't get too smart on us when we're
     // trying to touch records.
     volatile int __record_touch_dummy = 1;
@@ -113,7 +118,8 @@ namespace mongo {
         : _dbname(dbname.toString()),
           _path(path.toString()),
           _directoryPerDB(directoryPerDB),
-          _rid(RESOURCE_METADATA, dbname) {
+          _rid(RESOURCE_METADATA, dbname),
+          _lastFileAddedMicros(0) {
         StorageEngine* engine = getGlobalServiceContext()->getGlobalStorageEngine();
         invariant(engine->isMmapV1());
         MMAPV1Engine* mmapEngine = static_cast<MMAPV1Engine*>(engine);
@@ -253,16 +259,33 @@ namespace mongo {
 
         // Preallocate is asynchronous
         if (preallocateNextFile) {
-            auto_ptr<DataFile> nextFile(new DataFile(allocFileId + 1));
-            const string nextFileName = _fileName(allocFileId + 1).string();
+            const int filesAhead = _filesToPreallocate();
+            for (int i = 1; i <= filesAhead; i++) {
+                DataFile nextFile(allocFileId + i);
+                const string nextFileName = _fileName(allocFileId + i).string();
 
-            nextFile->open(txn, nextFileName.c_str(), minSize, false);
+                nextFile.open(txn, nextFileName.c_str(), minSize, true);
+            }
         }
 
         // Returns the last file added
         return _files[allocFileId];
     }
 
+    int MmapV1ExtentManager::_filesToPreallocate() {
+        const long long nowMicros = curTimeMicros64();
+        const long long fillMicros = nowMicros - _lastFileAddedMicros;
+        _lastFileAddedMicros = nowMicros;
+
+        // While the database fills its files faster than a file can be allocated, keep enough
+        // files allocating in parallel that the next one is ready before the current one is full.
+        const long long allocationMicros = FileAllocator::get()->lastAllocationMicros();
+        if (fillMicros <= 0) {
+            return kMaxFilesPreallocatedAhead;
+        }
+        return std::min<long long>(kMaxFilesPreallocatedAhead, 1 + allocationMicros / fillMicros);
+    }
+
     int MmapV1ExtentManager::numFiles() const {
         return _files.size();
     }
@@ -396,7 +419,9 @@ namespace mongo {
         // no space in an existing file
         // allocate files until we either get one big enough or hit maxSize
         for ( int i = 0; i < 8; i++ ) {
-            DataFile* f = _addAFile( txn, size, false );
+            // A database that grows past its first file likely keeps growing, so have the files
+            // after the new one allocated in the background before writers need them.
+            DataFile* f = _addAFile( txn, size, numFiles() > 0 );
 
             if ( f->getHeader()->unusedLength >= size ) {
                 return _createExtentInFile( txn, numFiles() - 1, f, size, enforceQuota );
@@ -650,6 +675,12 @@ namespace mongo {
                                      MAdvise::Sequential );
     }
 
+    void MmapV1ExtentManager::readAhead( const DiskLoc& extentLoc, int offset, int len ) const {
+        Extent* e = getExtent( extentLoc );
+        invariant( offset >= 0 && len >= 0 && offset + len <= e->length );
+        MAdvise::willNeed( reinterpret_cast<char*>( e ) + offset, len );
+    }
+
     MmapV1ExtentManager::FilesArray::~FilesArray() {
         for (int i = 0; i < size(); i++) {
             delete _files[i];
@@ -155,6 +155,8 @@ namespace mongo {
 
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint );
 
+        virtual void readAhead( const DiskLoc& extentLoc, int offset, int len ) const;
+
     private:
         /**
          * will return NULL if nothing suitable in free list
@@ -167,6 +169,12 @@ namespace mongo {
 
         DataFile* _addAFile( OperationContext* txn, int sizeNeeded, bool preallocateNextFile );
 
+        /**
+         * Returns how many files after the one just added should be preallocated, based on how
+         * fast the database has been filling its files. Called whenever a file is added.
+         */
+        int _filesToPreallocate();
+
 
         /**
          * Shared record retrieval logic used by the public recordForV1() and likelyInPhysicalMem()
@@ -201,6 +209,9 @@ namespace mongo {
         // engine is valid. Not owned here.
         RecordAccessTracker* _recordAccessTracker;
 
+        // When the latest data file was added, for predicting when the next ones are needed.
+        long long _lastFileAddedMicros;
+
         /**
          * Simple wrapper around an array object to allow append-only modification of the array,
          * as well as concurrent read-accesses. This class has a minimal interface to keep
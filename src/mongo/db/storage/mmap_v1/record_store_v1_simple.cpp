@@ -68,6 +68,13 @@ namespace mongo {
     static ServerStatusMetricField<Counter64> dFreelist3( "storage.freelist.search.scanned",
                                                           &freelistIterations );
 
+    // How many deleted records are merged per write unit of work, which bounds how much a
+    // freeSpaceOnly compact journals at once.
+    static const int kMergesPerWriteUnit = 1000;
+
+    // The most deleted records collection stats walk to report the free space.
+    static const long long kMaxDeletedRecsInStats = 100 * 1000;
+
     SimpleRecordStoreV1::SimpleRecordStoreV1( OperationContext* txn,
                                               StringData ns,
                                               RecordStoreV1MetaData* details,
@@ -435,11 +442,143 @@ namespace mongo {
 
     }
 
+    void SimpleRecordStoreV1::_unlinkDeletedRec( OperationContext* txn,
+                                                 DeletedListLinks* links,
+                                                 const DiskLoc& dloc ) {
+        const DeletedListLinks::iterator it = links->find( dloc );
+        invariant( it != links->end() );
+        const DeletedListLink link = it->second;
+        links->erase( it );
+
+        const DiskLoc next = drec( dloc )->nextDeleted();
+        if ( link.prev.isNull() ) {
+            _details->setDeletedListEntry( txn, link.bucket, next );
+        }
+        else {
+            *txn->recoveryUnit()->writing( &drec( link.prev )->nextDeleted() ) = next;
+        }
+
+        if ( !next.isNull() ) {
+            (*links)[next] = link;
+        }
+    }
+
+    Status SimpleRecordStoreV1::_mergeAdjacentDeletedRecs( OperationContext* txn,
+                                                           CompactStats* stats ) {
+        Timer t;
+
+        // Only the deleted lists are merged; anything still in the legacy grab bag is left for
+        // allocations to drain.
+        DeletedListLinks links;
+        for ( int b = 0; b < Buckets; b++ ) {
+            DeletedListLink link( DiskLoc(), b );
+            for ( DiskLoc loc = _details->deletedListEntry( b );
+                  !loc.isNull();
+                  loc = drec( loc )->nextDeleted() ) {
+                links[loc] = link;
+                link = DeletedListLink( loc, b );
+                if ( links.size() % 4096 == 0 )
+                    txn->checkForInterrupt();
+            }
+        }
+
+        // In disk order, so that adjacent deleted records are next to each other.
+        std::vector<DiskLoc> deleted;
+        deleted.reserve( links.size() );
+        for ( DeletedListLinks::const_iterator it = links.begin(); it != links.end(); ++it ) {
+            deleted.push_back( it->first );
+        }
+
+        size_t i = 0;
+        while ( i < deleted.size() ) {
+            txn->checkForInterrupt();
+
+            WriteUnitOfWork wunit( txn );
+            int merges = 0;
+            while ( i < deleted.size() && merges < kMergesPerWriteUnit ) {
+                const DiskLoc first = deleted[i];
+                DeletedRecord* const firstRec = drec( first );
+                int length = firstRec->lengthWithHeaders();
+
+                size_t end = i + 1;
+                for ( ; end < deleted.size(); end++ ) {
+                    const DiskLoc next = deleted[end];
+                    if ( next.a() != first.a() || next.getOfs() != first.getOfs() + length )
+                        break;
+                    const DeletedRecord* const nextRec = drec( next );
+                    if ( nextRec->extentOfs() != firstRec->extentOfs() )
+                        break;
+                    length += nextRec->lengthWithHeaders();
+                }
+
+                if ( end > i + 1 ) {
+                    for ( size_t j = i; j < end; j++ ) {
+                        _unlinkDeletedRec( txn, &links, deleted[j] );
+                    }
+                    txn->recoveryUnit()->writingInt( firstRec->lengthWithHeaders() ) = length;
+
+                    const int b = bucket( length );
+                    const DiskLoc oldHead = _details->deletedListEntry( b );
+                    addDeletedRec( txn, first );
+                    links[first] = DeletedListLink( DiskLoc(), b );
+                    if ( !oldHead.isNull() ) {
+                        links[oldHead] = DeletedListLink( first, b );
+                    }
+
+                    merges += end - i - 1;
+                    stats->freeRecordsMerged += end - i - 1;
+                }
+                i = end;
+            }
+            wunit.commit();
+        }
+
+        log() << "compact merged " << stats->freeRecordsMerged << " of " << deleted.size()
+              << " deleted records in " << t.millis() << "ms";
+        return Status::OK();
+    }
+
+    void SimpleRecordStoreV1::appendCustomStats( OperationContext* txn,
+                                                 BSONObjBuilder* result,
+                                                 double scale ) const {
+        RecordStoreV1Base::appendCustomStats( txn, result, scale );
+
+        long long numRecords = 0;
+        long long numBytes = 0;
+        int largest = 0;
+        bool complete = true;
+        for ( int b = 0; b < Buckets && complete; b++ ) {
+            for ( DiskLoc loc = _details->deletedListEntry( b );
+                  !loc.isNull();
+                  loc = drec( loc )->nextDeleted() ) {
+                if ( numRecords == kMaxDeletedRecsInStats ) {
+                    complete = false;
+                    break;
+                }
+                const int length = drec( loc )->lengthWithHeaders();
+                numRecords++;
+                numBytes += length;
+                largest = std::max( largest, length );
+            }
+        }
+
+        BSONObjBuilder freeList( result->subobjStart( "freeList" ) );
+        freeList.appendNumber( "records", numRecords );
+        freeList.appendNumber( "size", static_cast<long long>( numBytes / scale ) );
+        freeList.appendNumber( "largestRecord", static_cast<long long>( largest / scale ) );
+        freeList.appendBool( "complete", complete );
+        freeList.done();
+    }
+
     Status SimpleRecordStoreV1::compact( OperationContext* txn,
                                          RecordStoreCompactAdaptor* adaptor,
                                          const CompactOptions* options,
                                          CompactStats* stats ) {
 
+        if ( options->freeSpaceOnly ) {
+            return _mergeAdjacentDeletedRecs( txn, stats );
+        }
+
         std::vector<DiskLoc> extents;
         for( DiskLoc extLocation = _details->firstExtent(txn);
              !extLocation.isNull();
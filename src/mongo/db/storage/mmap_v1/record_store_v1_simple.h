@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <map>
+
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/storage/mmap_v1/diskloc.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_base.h"
@@ -69,6 +71,10 @@ namespace mongo {
                                 const CompactOptions* options,
                                 CompactStats* stats );
 
+        virtual void appendCustomStats( OperationContext* txn,
+                                        BSONObjBuilder* result,
+                                        double scale ) const;
+
     protected:
         virtual bool isCapped() const { return false; }
         virtual bool shouldPadInserts() const {
@@ -82,9 +88,35 @@ namespace mongo {
         virtual void addDeletedRec(OperationContext* txn,
                                    const DiskLoc& dloc);
     private:
+        /**
+         * Where a deleted record is linked from: the previous record in its deleted list, or the
+         * head of deleted list 'bucket' if 'prev' is null.
+         */
+        struct DeletedListLink {
+            DeletedListLink() : bucket(-1) {}
+            DeletedListLink(const DiskLoc& p, int b) : prev(p), bucket(b) {}
+
+            DiskLoc prev;
+            int bucket;
+        };
+        typedef std::map<DiskLoc, DeletedListLink> DeletedListLinks;
+
         DiskLoc _allocFromExistingExtents( OperationContext* txn,
                                            int lengthWithHeaders );
 
+        /**
+         * Merges each run of physically adjacent deleted records into one larger deleted record,
+         * without moving any documents. Commits after every few merges.
+         */
+        Status _mergeAdjacentDeletedRecs( OperationContext* txn, CompactStats* stats );
+
+        /**
+         * Unlinks 'dloc' from its deleted list and 'links', which must describe all deleted lists.
+         */
+        void _unlinkDeletedRec( OperationContext* txn,
+                                DeletedListLinks* links,
+                                const DiskLoc& dloc );
+
         void _compactExtent(OperationContext* txn,
                             const DiskLoc diskloc,
                             int extentNumber,
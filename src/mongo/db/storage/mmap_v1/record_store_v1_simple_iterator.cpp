@@ -28,13 +28,21 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple_iterator.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/extent_manager.h"
+#include "mongo/db/storage/mmap_v1/record.h"
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
 namespace mongo {
 
+    // How far ahead of a forward collection scan, in bytes, the OS is asked to read the
+    // collection's extents. Zero disables readahead.
+    MONGO_EXPORT_SERVER_PARAMETER(mmapv1CollectionScanReadaheadBytes, int, 8 * 1024 * 1024);
+
     //
     // Regular / non-capped collection traversal
     //
@@ -46,7 +54,8 @@ namespace mongo {
             : _txn(txn)
             , _curr(DiskLoc::fromRecordId(start))
             , _recordStore(collection)
-            , _direction(dir) {
+            , _direction(dir)
+            , _readAheadChunk(-1) {
 
         if (_curr.isNull()) {
 
@@ -85,6 +94,8 @@ namespace mongo {
                 _curr = e->lastRecord;
             }
         }
+
+        _readAheadFrom(_curr);
     }
 
     bool SimpleRecordStoreV1Iterator::isEOF() {
@@ -100,6 +111,7 @@ namespace mongo {
         if (!isEOF()) {
             if (CollectionScanParams::FORWARD == _direction) {
                 _curr = _recordStore->getNextRecord( _txn, _curr );
+                _readAheadFrom(_curr);
             }
             else {
                 _curr = _recordStore->getPrevRecord( _txn, _curr );
@@ -109,6 +121,44 @@ namespace mongo {
         return ret.toRecordId();
     }
 
+    void SimpleRecordStoreV1Iterator::_readAheadFrom(const DiskLoc& loc) {
+        const int window = mmapv1CollectionScanReadaheadBytes;
+        if (window <= 0 || loc.isNull() || CollectionScanParams::FORWARD != _direction) {
+            return;
+        }
+
+        const ExtentManager* em = _recordStore->_extentManager;
+        const DiskLoc extentLoc = em->recordForV1(loc)->myExtentLoc(loc);
+        const int chunkSize = std::max(window / 2, 64 * 1024);
+        const int chunk = (loc.getOfs() - extentLoc.getOfs()) / chunkSize;
+        if (chunk == _readAheadChunk && extentLoc == _readAheadExtent) {
+            return;
+        }
+        _readAheadExtent = extentLoc;
+        _readAheadChunk = chunk;
+
+        // Request the 'window' bytes after the end of the current chunk, following the extent
+        // chain. The previous request already covered about half of them, so each request only
+        // causes about half a window of new reads.
+        DiskLoc currExtentLoc = extentLoc;
+        int offset = (chunk + 1) * chunkSize;
+        int remaining = window;
+        while (remaining > 0) {
+            const Extent* e = em->getExtent(currExtentLoc);
+            if (offset < e->length) {
+                const int len = std::min(remaining, e->length - offset);
+                em->readAhead(currExtentLoc, offset, len);
+                remaining -= len;
+            }
+
+            if (e->xnext.isNull()) {
+                break;
+            }
+            currExtentLoc = e->xnext;
+            offset = 0;
+        }
+    }
+
     void SimpleRecordStoreV1Iterator::invalidate(const RecordId& dl) {
         // Just move past the thing being deleted.
         if (dl == _curr.toRecordId()) {
@@ -69,6 +69,13 @@ namespace mongo {
         const SimpleRecordStoreV1* _recordStore;
 
         CollectionScanParams::Direction _direction;
+
+        // Forward scans have the OS read ahead of them. Each extent is split into chunks of half
+        // the readahead window; whenever the scan enters a new chunk, the window following that
+        // chunk is requested. These identify the chunk that was last entered.
+        void _readAheadFrom(const DiskLoc& loc);
+        DiskLoc _readAheadExtent;
+        int _readAheadChunk;
     };
 
 }  // namespace mongo
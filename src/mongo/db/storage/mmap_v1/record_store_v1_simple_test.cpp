@@ -30,6 +30,7 @@
 
 #include "mongo/db/storage/mmap_v1/record_store_v1_simple.h"
 
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/storage/mmap_v1/extent.h"
 #include "mongo/db/storage/mmap_v1/record.h"
@@ -537,4 +538,52 @@ namespace {
             assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
         }
     }
+
+    TEST( SimpleRecordStoreV1, CompactFreeSpaceOnlyMergesAdjacentDeletedRecords ) {
+        OperationContextNoop txn;
+        DummyExtentManager em;
+        DummyRecordStoreV1MetaData* md = new DummyRecordStoreV1MetaData( false, 0 );
+        SimpleRecordStoreV1 rs( &txn, "test.foo", md, &em, false );
+
+        {
+            LocAndSize recs[] = {
+                {DiskLoc(0, 1000), 100},
+                {DiskLoc(0, 1400), 100},
+                {DiskLoc(1, 1100), 100},
+                {}
+            };
+            LocAndSize drecs[] = {
+                {DiskLoc(0, 1100), 100},
+                {DiskLoc(0, 1200), 100},
+                {DiskLoc(0, 1300), 100},
+                {DiskLoc(1, 1000), 100},
+                {DiskLoc(1, 1200), 100},
+                {}
+            };
+            initializeV1RS(&txn, recs, drecs, NULL, &em, md);
+        }
+
+        CompactOptions options;
+        options.freeSpaceOnly = true;
+        CompactStats stats;
+        ASSERT_OK( rs.compact( &txn, NULL, &options, &stats ) );
+        ASSERT_EQUALS( 2, stats.freeRecordsMerged );
+
+        {
+            // The documents stay where they were.
+            LocAndSize recs[] = {
+                {DiskLoc(0, 1000), 100},
+                {DiskLoc(0, 1400), 100},
+                {DiskLoc(1, 1100), 100},
+                {}
+            };
+            LocAndSize drecs[] = {
+                {DiskLoc(1, 1000), 100},
+                {DiskLoc(1, 1200), 100},
+                {DiskLoc(0, 1100), 300},
+                {}
+            };
+            assertStateV1RS(&txn, recs, drecs, NULL, &em, md);
+        }
+    }
 }
@@ -302,6 +302,9 @@ namespace mongo {
         return new CacheHint();
     }
 
+    void DummyExtentManager::readAhead( const DiskLoc& extentLoc, int offset, int len ) const {
+    }
+
 namespace {
     void accumulateExtentSizeRequirements(const LocAndSize* las, std::map<int, size_t>* sizes) {
         if (!las)
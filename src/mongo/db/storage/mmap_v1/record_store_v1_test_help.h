@@ -148,6 +148,8 @@ namespace mongo {
 
         virtual CacheHint* cacheHint( const DiskLoc& extentLoc, const HintType& hint );
 
+        virtual void readAhead( const DiskLoc& extentLoc, int offset, int len ) const;
+
     protected:
         struct ExtentInfo {
             char* data;
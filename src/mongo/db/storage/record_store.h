@@ -115,6 +115,13 @@ namespace mongo {
         // normally this will just go back to the RecordStore and convert
         // but this gives the iterator an oppurtnity to optimize
         virtual RecordData dataFor( const RecordId& loc ) const = 0;
+
+        /**
+         * Like dataFor(), but for the record the iterator is positioned on, the result may point
+         * straight into the storage engine's buffers instead of being copied. It is then only
+         * valid until the iterator is moved, saved or destroyed.
+         */
+        virtual RecordData dataForPinned( const RecordId& loc ) const { return dataFor( loc ); }
     };
 
 
@@ -140,6 +147,13 @@ namespace mongo {
 
         virtual void setCappedDeleteCallback(CappedDocumentDeleteCallback*) {invariant( false );}
 
+        /**
+         * Returns true if this record store keeps each document at the RecordId that
+         * idkeys::keyForId() makes from its _id, so that a document can be found by _id with
+         * findRecord() alone. Inserts of documents whose _id has no such RecordId fail.
+         */
+        virtual bool keyedById() const { return false; }
+
         /**
          * @param extraInfo - optional more debug info
          * @param level - optional, level of debug info to put in (higher is more)
@@ -171,6 +185,33 @@ namespace mongo {
                                                   const DocWriter* doc,
                                                   bool enforceQuota ) = 0;
 
+        /**
+         * Inserts each of 'docs' as a record, in order, appending its RecordId to 'locs'.
+         *
+         * Stops at the first failure and returns it; the records inserted up to then are left
+         * in place for the caller to roll back with the rest of its unit of work.
+         *
+         * The default implementation calls insertRecord() once per document. Record stores that
+         * can share per-insert work (cursors, id allocation, size accounting) across a batch
+         * override this.
+         */
+        virtual Status insertRecords( OperationContext* txn,
+                                      const std::vector<BSONObj>& docs,
+                                      std::vector<RecordId>* locs,
+                                      bool enforceQuota ) {
+            locs->reserve(locs->size() + docs.size());
+            for (size_t i = 0; i < docs.size(); i++) {
+                StatusWith<RecordId> loc = insertRecord(txn,
+                                                        docs[i].objdata(),
+                                                        docs[i].objsize(),
+                                                        enforceQuota);
+                if (!loc.isOK())
+                    return loc.getStatus();
+                locs->push_back(loc.getValue());
+            }
+            return Status::OK();
+        }
+
         /**
          * @param notifier - Only used by record stores which do not support doc-locking.
          *                   In the case of a document move, this is called after the document
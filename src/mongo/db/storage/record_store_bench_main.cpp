@@ -0,0 +1,421 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * Throughput benchmarks for a RecordStore, built against the same newHarnessHelper() the engine's
+ * record store unit tests use.  Each benchmark runs for a fixed time at every requested thread
+ * count, and the results are printed as a single JSON document.
+ *
+ * Usage: <engine>_record_store_bench [--threads 1,2,4,8] [--seconds 5] [--records 10000]
+ *                                    [--recordSize 100] [--scanLength 100]
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/record_store_test_harness.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/signal_handlers_synchronous.h"
+#include "mongo/util/stringutils.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+    using boost::scoped_ptr;
+    using std::string;
+    using std::vector;
+
+    struct BenchOptions {
+        BenchOptions() : seconds(5), numRecords(10000), recordSize(100), scanLength(100) {
+            threads.push_back(1);
+            threads.push_back(2);
+            threads.push_back(4);
+            threads.push_back(8);
+        }
+
+        vector<int> threads;
+        int seconds;
+        int numRecords;
+        int recordSize;
+        int scanLength;
+    };
+
+    /**
+     * State shared by the threads of one benchmark run.  Engines without document level locking
+     * rely on the collection lock to keep writers apart, which 'writeMutex' stands in for.  No
+     * benchmark mixes reads with writes.
+     */
+    class BenchContext {
+    public:
+        BenchContext(HarnessHelper* helper, RecordStore* rs, const BenchOptions& options)
+            : helper(helper),
+              rs(rs),
+              options(options),
+              record(options.recordSize, 'x'),
+              docLocking(helper->supportsDocLocking()) { }
+
+        HarnessHelper* const helper;
+        RecordStore* const rs;
+        const BenchOptions& options;
+        const string record;
+
+        // Populated before the threads start and only read by them, except that a thread may
+        // replace the locations in its own slice after an update moves a record.
+        vector<RecordId> locs;
+
+        const bool docLocking;
+        boost::mutex writeMutex;
+    };
+
+    class WriteLock {
+    public:
+        explicit WriteLock(BenchContext* ctx) : _lk(ctx->writeMutex, boost::defer_lock) {
+            if (!ctx->docLocking) {
+                _lk.lock();
+            }
+        }
+
+    private:
+        boost::unique_lock<boost::mutex> _lk;
+    };
+
+    typedef long long (*BenchFunc)(BenchContext* ctx, int threadId, int numThreads);
+
+    StatusWith<RecordId> insertOne(OperationContext* txn, BenchContext* ctx) {
+        while (true) {
+            try {
+                WriteLock lk(ctx);
+                WriteUnitOfWork wuow(txn);
+                StatusWith<RecordId> res = ctx->rs->insertRecord(txn,
+                                                                 ctx->record.c_str(),
+                                                                 ctx->record.size(),
+                                                                 false);
+                if (res.isOK()) {
+                    wuow.commit();
+                }
+                return res;
+            }
+            catch (const WriteConflictException&) {
+            }
+        }
+    }
+
+    bool timeLeft(const Timer& timer, const BenchContext* ctx) {
+        return timer.seconds() < ctx->options.seconds;
+    }
+
+    long long benchInsert(BenchContext* ctx, int threadId, int numThreads) {
+        scoped_ptr<OperationContext> txn(ctx->helper->newOperationContext());
+        long long ops = 0;
+        for (Timer timer; timeLeft(timer, ctx); ops++) {
+            invariantOK(insertOne(txn.get(), ctx).getStatus());
+        }
+        return ops;
+    }
+
+    /**
+     * Each thread updates the records of its own slice of 'locs', so that the threads don't
+     * conflict with each other and a moved record only changes a location no one else reads.
+     */
+    long long benchUpdate(BenchContext* ctx, int threadId, int numThreads) {
+        scoped_ptr<OperationContext> txn(ctx->helper->newOperationContext());
+        const size_t sliceSize = ctx->locs.size() / numThreads;
+        const size_t sliceStart = sliceSize * threadId;
+        PseudoRandom random(static_cast<int32_t>(threadId + 1));
+
+        long long ops = 0;
+        for (Timer timer; timeLeft(timer, ctx); ops++) {
+            RecordId& loc = ctx->locs[sliceStart + random.nextInt64(sliceSize)];
+            try {
+                WriteLock lk(ctx);
+                WriteUnitOfWork wuow(txn.get());
+                StatusWith<RecordId> res = ctx->rs->updateRecord(txn.get(),
+                                                                 loc,
+                                                                 ctx->record.c_str(),
+                                                                 ctx->record.size(),
+                                                                 false,
+                                                                 NULL);
+                invariantOK(res.getStatus());
+                wuow.commit();
+                loc = res.getValue();
+            }
+            catch (const WriteConflictException&) {
+            }
+        }
+        return ops;
+    }
+
+    long long benchPointRead(BenchContext* ctx, int threadId, int numThreads) {
+        scoped_ptr<OperationContext> txn(ctx->helper->newOperationContext());
+        PseudoRandom random(static_cast<int32_t>(threadId + 1));
+
+        long long ops = 0;
+        for (Timer timer; timeLeft(timer, ctx); ops++) {
+            const RecordId loc = ctx->locs[random.nextInt64(ctx->locs.size())];
+            RecordData data;
+            ctx->rs->findRecord(txn.get(), loc, &data);
+        }
+        return ops;
+    }
+
+    /**
+     * One operation reads 'scanLength' records, starting from a random one.
+     */
+    long long benchRangeScan(BenchContext* ctx, int threadId, int numThreads) {
+        scoped_ptr<OperationContext> txn(ctx->helper->newOperationContext());
+        PseudoRandom random(static_cast<int32_t>(threadId + 1));
+
+        long long ops = 0;
+        for (Timer timer; timeLeft(timer, ctx); ops++) {
+            const RecordId start = ctx->locs[random.nextInt64(ctx->locs.size())];
+            scoped_ptr<RecordIterator> it(ctx->rs->getIterator(txn.get(), start));
+            for (int i = 0; i < ctx->options.scanLength && !it->isEOF(); i++) {
+                it->dataFor(it->getNext());
+            }
+        }
+        return ops;
+    }
+
+    /**
+     * One operation is a yield of a collection scan: the cursor is saved, the snapshot released
+     * and the cursor restored before it moves to the next record.  Returns -1 if the record
+     * store has nothing to iterate over, as with devnull.
+     */
+    long long benchSaveRestore(BenchContext* ctx, int threadId, int numThreads) {
+        scoped_ptr<OperationContext> txn(ctx->helper->newOperationContext());
+
+        long long ops = 0;
+        Timer timer;
+        while (timeLeft(timer, ctx)) {
+            scoped_ptr<RecordIterator> it(ctx->rs->getIterator(txn.get()));
+            while (!it->isEOF() && timeLeft(timer, ctx)) {
+                it->getNext();
+                it->saveState();
+                txn->recoveryUnit()->commitAndRestart();
+                if (!it->restoreState(txn.get())) {
+                    break;
+                }
+                ops++;
+            }
+            if (ops == 0) {
+                return -1;
+            }
+        }
+        return ops;
+    }
+
+    void runThread(BenchFunc func, BenchContext* ctx, int threadId, int numThreads,
+                   long long* ops) {
+        *ops = func(ctx, threadId, numThreads);
+    }
+
+    /**
+     * Every run starts from a new harness, and so from a new and freshly populated record store.
+     */
+    BSONObj runBenchmark(const string& name,
+                         BenchFunc func,
+                         const BenchOptions& options,
+                         int numThreads) {
+        scoped_ptr<HarnessHelper> helper(newHarnessHelper());
+        scoped_ptr<RecordStore> rs(helper->newNonCappedRecordStore());
+        BenchContext ctx(helper.get(), rs.get(), options);
+
+        {
+            scoped_ptr<OperationContext> txn(helper->newOperationContext());
+            for (int i = 0; i < options.numRecords; i++) {
+                StatusWith<RecordId> res = insertOne(txn.get(), &ctx);
+                invariantOK(res.getStatus());
+                ctx.locs.push_back(res.getValue());
+            }
+        }
+
+        vector<long long> ops(numThreads);
+        Timer timer;
+        {
+            boost::thread_group threads;
+            for (int i = 0; i < numThreads; i++) {
+                threads.create_thread(boost::bind(&runThread, func, &ctx, i, numThreads,
+                                                  &ops[i]));
+            }
+            threads.join_all();
+        }
+        const double seconds = timer.micros() / 1000000.0;
+
+        long long totalOps = 0;
+        bool supported = true;
+        for (int i = 0; i < numThreads; i++) {
+            if (ops[i] < 0) {
+                supported = false;
+            }
+            totalOps += ops[i];
+        }
+
+        BSONObjBuilder result;
+        result.append("benchmark", name);
+        result.append("threads", numThreads);
+        if (!supported) {
+            result.append("supported", false);
+            return result.obj();
+        }
+        result.append("ops", totalOps);
+        result.append("seconds", seconds);
+        result.append("opsPerSecond", totalOps / seconds);
+        return result.obj();
+    }
+
+    bool parseThreads(const string& value, vector<int>* threads) {
+        threads->clear();
+        vector<string> parts;
+        splitStringDelim(value, &parts, ',');
+        for (size_t i = 0; i < parts.size(); i++) {
+            const int n = atoi(parts[i].c_str());
+            if (n <= 0) {
+                return false;
+            }
+            threads->push_back(n);
+        }
+        return !threads->empty();
+    }
+
+    bool parseOptions(int argc, char** argv, BenchOptions* options) {
+        for (int i = 1; i < argc; i += 2) {
+            const string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "missing value for " << arg << std::endl;
+                return false;
+            }
+            const string value = argv[i + 1];
+            if (arg == "--threads") {
+                if (!parseThreads(value, &options->threads)) {
+                    std::cerr << "bad --threads: " << value << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            int* target = NULL;
+            if (arg == "--seconds") {
+                target = &options->seconds;
+            }
+            else if (arg == "--records") {
+                target = &options->numRecords;
+            }
+            else if (arg == "--recordSize") {
+                target = &options->recordSize;
+            }
+            else if (arg == "--scanLength") {
+                target = &options->scanLength;
+            }
+            else {
+                std::cerr << "unknown option " << arg << std::endl;
+                return false;
+            }
+            *target = atoi(value.c_str());
+            if (*target <= 0) {
+                std::cerr << "bad " << arg << ": " << value << std::endl;
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < options->threads.size(); i++) {
+            if (options->threads[i] > options->numRecords) {
+                std::cerr << "--records must be at least the number of threads" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+}  // namespace
+}  // namespace mongo
+
+int main(int argc, char** argv, char** envp) {
+    using namespace mongo;
+
+    setupSynchronousSignalHandlers();
+    runGlobalInitializersOrDie(argc, argv, envp);
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, &options)) {
+        return EXIT_FAILURE;
+    }
+
+    struct Benchmark {
+        const char* name;
+        BenchFunc func;
+    };
+    const Benchmark benchmarks[] = {
+        {"insert", benchInsert},
+        {"update", benchUpdate},
+        {"pointRead", benchPointRead},
+        {"rangeScan", benchRangeScan},
+        {"saveRestore", benchSaveRestore},
+    };
+
+    string engine;
+    {
+        scoped_ptr<HarnessHelper> helper(newHarnessHelper());
+        scoped_ptr<RecordStore> rs(helper->newNonCappedRecordStore());
+        engine = rs->name();
+    }
+
+    BSONArrayBuilder results;
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        for (size_t j = 0; j < options.threads.size(); j++) {
+            results.append(runBenchmark(benchmarks[i].name,
+                                        benchmarks[i].func,
+                                        options,
+                                        options.threads[j]));
+        }
+    }
+
+    BSONObjBuilder out;
+    out.append("engine", engine);
+    out.append("seconds", options.seconds);
+    out.append("records", options.numRecords);
+    out.append("recordSize", options.recordSize);
+    out.append("scanLength", options.scanLength);
+    out.append("results", results.arr());
+    std::cout << out.obj().jsonString(Strict, 1) << std::endl;
+    return EXIT_SUCCESS;
+}
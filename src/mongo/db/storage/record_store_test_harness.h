@@ -48,6 +48,11 @@ namespace mongo {
         virtual OperationContext* newOperationContext() {
             return new OperationContextNoop( newRecoveryUnit() );
         }
+
+        /**
+         * Whether concurrent writers may use the record stores without a collection lock.
+         */
+        virtual bool supportsDocLocking() { return false; }
     };
 
     HarnessHelper* newHarnessHelper();
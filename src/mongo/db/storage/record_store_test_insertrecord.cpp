@@ -32,6 +32,8 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "mongo/db/jsobj.h"
+
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/record_data.h"
 #include "mongo/db/storage/record_store.h"
@@ -183,4 +185,61 @@ namespace mongo {
         }
     }
 
+    // Insert a batch of records at once, then verify each can be read back at the RecordId it
+    // was given, and that the size counters include all of them.
+    TEST( RecordStoreTestHarness, InsertRecords ) {
+        scoped_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+        scoped_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+
+        std::vector<BSONObj> docs;
+        long long dataSize = 0;
+        for ( int i = 0; i < 10; i++ ) {
+            docs.push_back( BSON( "_id" << i << "s" << std::string( i, 'x' ) ) );
+            dataSize += docs.back().objsize();
+        }
+
+        std::vector<RecordId> locs;
+        {
+            scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                ASSERT_OK( rs->insertRecords( opCtx.get(), docs, &locs, false ) );
+                uow.commit();
+            }
+        }
+
+        ASSERT_EQUALS( docs.size(), locs.size() );
+        {
+            scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( static_cast<long long>( docs.size() ),
+                           rs->numRecords( opCtx.get() ) );
+            // Some record stores count per-record overhead as well.
+            ASSERT_GREATER_THAN_OR_EQUALS( rs->dataSize( opCtx.get() ), dataSize );
+            dataSize = rs->dataSize( opCtx.get() );
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                ASSERT_EQUALS( docs[i], rs->dataFor( opCtx.get(), locs[i] ).toBson() );
+                if ( i > 0 ) {
+                    ASSERT_NOT_EQUALS( locs[i - 1], locs[i] );
+                }
+            }
+        }
+
+        // A batch which is rolled back leaves nothing behind.
+        {
+            scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            {
+                WriteUnitOfWork uow( opCtx.get() );
+                std::vector<RecordId> rolledBack;
+                ASSERT_OK( rs->insertRecords( opCtx.get(), docs, &rolledBack, false ) );
+            }
+        }
+
+        {
+            scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            ASSERT_EQUALS( static_cast<long long>( docs.size() ),
+                           rs->numRecords( opCtx.get() ) );
+            ASSERT_EQUALS( dataSize, rs->dataSize( opCtx.get() ) );
+        }
+    }
+
 } // namespace mongo
@@ -100,6 +100,21 @@ namespace mongo {
          */
         virtual void commitAndRestart() = 0;
 
+        /**
+         * Called instead of commitAndRestart() when a cursor's RecoveryUnit is stashed between
+         * getMore batches.  An engine may keep its snapshot open so that the next batch can
+         * resume without repositioning its cursors.  The default ends the snapshot.
+         */
+        virtual void endCursorBatch() { commitAndRestart(); }
+
+        /**
+         * Called periodically on the RecoveryUnits of idle cursors, from a thread other than
+         * the one that stashed them, but never while the cursor is in use.  Engines that keep
+         * snapshots open across batches should release them here once they are no longer worth
+         * keeping.
+         */
+        virtual void releaseIdleSnapshot() { }
+
         virtual SnapshotId getSnapshotId() const = 0;
 
         /**
@@ -337,6 +337,26 @@ namespace mongo {
         virtual std::unique_ptr<Cursor> newCursor(OperationContext* txn,
                                                   bool isForward = true) const = 0;
 
+        /**
+         * Returns entries of the index in random order, each call to next() returning another
+         * one, with repeats, or boost::none if the index is empty. Entries aren't guaranteed to
+         * be equally likely, but should be close enough to estimate the distribution of keys.
+         */
+        class RandomCursor {
+        public:
+            virtual ~RandomCursor() = default;
+
+            virtual boost::optional<IndexKeyEntry> next() = 0;
+        };
+
+        /**
+         * Returns a RandomCursor over 'this' index, or an empty pointer if the implementation
+         * doesn't support them. The cursor may not outlive the current transaction.
+         */
+        virtual std::unique_ptr<RandomCursor> newRandomCursor(OperationContext* txn) const {
+            return {};
+        }
+
         //
         // Index creation
         //
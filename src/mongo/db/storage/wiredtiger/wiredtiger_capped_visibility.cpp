@@ -0,0 +1,164 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_capped_visibility.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    BOOST_STATIC_ASSERT((WiredTigerCappedVisibility::kMaxUncommitted &
+                         (WiredTigerCappedVisibility::kMaxUncommitted - 1)) == 0);
+
+    const int64_t WiredTigerCappedVisibility::kMaxUncommitted;
+
+    WiredTigerCappedVisibility::WiredTigerCappedVisibility(bool reservesRecordIds,
+                                                           const RecordId& nextRecordId)
+        : _reservesRecordIds(reservesRecordIds),
+          _finished(new AtomicInt64[kMaxUncommitted]) {
+
+        const int64_t firstTicket = reservesRecordIds ? nextRecordId.repr() : 0;
+        _nextTicket.store(firstTicket);
+        _oldest.store(firstTicket);
+        _highestSeen.store(0);
+
+        // No ticket is ever negative, so no slot starts out finished.
+        for (int64_t i = 0; i < kMaxUncommitted; i++) {
+            _finished[i].store(-1);
+        }
+
+        if (!reservesRecordIds) {
+            _registered.reset(new AtomicInt64[kMaxUncommitted]);
+            _registeredLocs.reset(new AtomicInt64[kMaxUncommitted]);
+            for (int64_t i = 0; i < kMaxUncommitted; i++) {
+                _registered[i].store(-1);
+            }
+        }
+    }
+
+    RecordId WiredTigerCappedVisibility::reserve() {
+        invariant(_reservesRecordIds);
+        _checkRoom();
+
+        const int64_t ticket = _nextTicket.fetchAndAdd(1);
+        RecordId loc(ticket);
+        invariant(loc.isNormal());
+
+        // Threads that passed _checkRoom() at the same time can overshoot the ring by at most
+        // their number; wait for the owner of this slot to finish rather than lose this id.
+        while (ticket - _advance() >= kMaxUncommitted) {
+            boost::this_thread::yield();
+        }
+        return loc;
+    }
+
+    int64_t WiredTigerCappedVisibility::registerRecordId(const RecordId& loc) {
+        invariant(!_reservesRecordIds);
+        _checkRoom();
+
+        const int64_t ticket = _nextTicket.load();
+        const size_t slot = _slot(ticket);
+
+        // Readers check '_registered' after reading the RecordId, so it has to stop naming the
+        // slot's previous ticket before the RecordId changes.
+        _registered[slot].store(-1);
+        _registeredLocs[slot].store(loc.repr());
+        _registered[slot].store(ticket);
+        _nextTicket.store(ticket + 1);
+
+        noteInserted(loc);
+        return ticket;
+    }
+
+    void WiredTigerCappedVisibility::finish(int64_t ticket) {
+        _finished[_slot(ticket)].store(ticket);
+        _advance();
+    }
+
+    RecordId WiredTigerCappedVisibility::oldestUncommitted() const {
+        while (true) {
+            const int64_t oldest = _advance();
+            if (oldest >= _nextTicket.load()) {
+                return RecordId();
+            }
+
+            if (_reservesRecordIds) {
+                return RecordId(oldest);
+            }
+
+            const size_t slot = _slot(oldest);
+            const int64_t loc = _registeredLocs[slot].load();
+            if (_registered[slot].load() == oldest) {
+                return RecordId(loc);
+            }
+            // The ticket finished and its slot was reused while we were looking; start again.
+        }
+    }
+
+    void WiredTigerCappedVisibility::noteInserted(const RecordId& loc) {
+        int64_t highest = _highestSeen.load();
+        while (loc.repr() > highest) {
+            const int64_t old = _highestSeen.compareAndSwap(highest, loc.repr());
+            if (old == highest) {
+                break;
+            }
+            highest = old;
+        }
+    }
+
+    RecordId WiredTigerCappedVisibility::oplogReadTill() const {
+        // Read the highest RecordId first: everything registered up to it was registered before
+        // the search for the oldest uncommitted insert starts, and so is either found by it or
+        // already committed.
+        const RecordId highest(_highestSeen.load());
+        const RecordId oldest = oldestUncommitted();
+        return oldest.isNull() ? highest : oldest;
+    }
+
+    int64_t WiredTigerCappedVisibility::_advance() const {
+        int64_t oldest = _oldest.load();
+        while (oldest < _nextTicket.load() && _finished[_slot(oldest)].load() == oldest) {
+            const int64_t old = _oldest.compareAndSwap(oldest, oldest + 1);
+            // Either we moved it, or someone else moved it at least as far.
+            oldest = (old == oldest) ? oldest + 1 : old;
+        }
+        return oldest;
+    }
+
+    void WiredTigerCappedVisibility::_checkRoom() const {
+        if (_nextTicket.load() - _advance() >= kMaxUncommitted) {
+            throw WriteConflictException();
+        }
+    }
+
+} // namespace mongo
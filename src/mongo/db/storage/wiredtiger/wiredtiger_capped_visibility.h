@@ -0,0 +1,134 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/scoped_array.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Tracks the uncommitted inserts into a capped collection, so that readers can stop before
+     * the oldest one and never see a committed record after a gap that may still fill in.
+     *
+     * Every insert takes a ticket, in RecordId order, and owns the slot for its ticket in a fixed
+     * ring until it commits or rolls back. The oldest uncommitted ticket is a low-water mark that
+     * whoever finds the slot under it finished moves forward, so taking a ticket, finishing one
+     * and finding the oldest uncommitted RecordId are all lock-free.
+     */
+    class WiredTigerCappedVisibility {
+        MONGO_DISALLOW_COPYING(WiredTigerCappedVisibility);
+    public:
+        /**
+         * The most inserts that can be uncommitted at once.
+         */
+        static const int64_t kMaxUncommitted = 4096;
+
+        /**
+         * If 'reservesRecordIds' is true, the tickets are the RecordIds themselves, starting at
+         * 'nextRecordId', and are handed out by reserve(). Otherwise the caller picks each
+         * RecordId and passes it to registerRecordId(), which is how the oplog works.
+         */
+        WiredTigerCappedVisibility(bool reservesRecordIds, const RecordId& nextRecordId);
+
+        /**
+         * Reserves the next RecordId for an insert and returns it; its ticket is its repr().
+         * Safe to call from any number of threads at once.
+         *
+         * Throws WriteConflictException if kMaxUncommitted inserts are already uncommitted.
+         */
+        RecordId reserve();
+
+        /**
+         * Registers an uncommitted insert at 'loc', which must be greater than every RecordId
+         * registered so far, and returns its ticket. Callers must serialize these calls, as they
+         * do to pick increasing RecordIds in the first place.
+         *
+         * Throws WriteConflictException if kMaxUncommitted inserts are already uncommitted.
+         */
+        int64_t registerRecordId(const RecordId& loc);
+
+        /**
+         * Marks the insert holding 'ticket' as committed or rolled back.
+         */
+        void finish(int64_t ticket);
+
+        /**
+         * Returns the RecordId of the oldest uncommitted insert, or a null RecordId if there is
+         * none.
+         */
+        RecordId oldestUncommitted() const;
+
+        /**
+         * Records that 'loc' was inserted without being registered, as oplog entries applied on
+         * secondaries are.
+         */
+        void noteInserted(const RecordId& loc);
+
+        /**
+         * Returns the highest RecordId an oplog reader may see: the oldest uncommitted one, which
+         * is only visible once it commits, or the highest registered or inserted one if nothing
+         * is uncommitted.
+         */
+        RecordId oplogReadTill() const;
+
+    private:
+        static size_t _slot(int64_t ticket) {
+            return static_cast<size_t>(ticket) & (kMaxUncommitted - 1);
+        }
+
+        /**
+         * Moves '_oldest' past every finished ticket and returns it.
+         */
+        int64_t _advance() const;
+
+        /**
+         * Throws WriteConflictException if there is no room for another uncommitted insert.
+         */
+        void _checkRoom() const;
+
+        const bool _reservesRecordIds;
+
+        AtomicInt64 _nextTicket;
+        mutable AtomicInt64 _oldest; // every ticket below this has finished
+        AtomicInt64 _highestSeen;
+
+        // For each slot, the last ticket that finished in it.
+        boost::scoped_array<AtomicInt64> _finished;
+
+        // For each slot, the ticket registered in it and its RecordId. Only used when RecordIds
+        // are registered.
+        boost::scoped_array<AtomicInt64> _registered;
+        boost::scoped_array<AtomicInt64> _registeredLocs;
+    };
+
+} // namespace mongo
@@ -0,0 +1,147 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_capped_visibility.h"
+
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    TEST(WiredTigerCappedVisibilityTest, ReserveInOrder) {
+        WiredTigerCappedVisibility visibility(true, RecordId(10));
+        ASSERT(visibility.oldestUncommitted().isNull());
+
+        ASSERT_EQUALS(RecordId(10), visibility.reserve());
+        ASSERT_EQUALS(RecordId(11), visibility.reserve());
+        ASSERT_EQUALS(RecordId(12), visibility.reserve());
+        ASSERT_EQUALS(RecordId(10), visibility.oldestUncommitted());
+
+        // Finishing a newer insert doesn't make older ones visible.
+        visibility.finish(11);
+        ASSERT_EQUALS(RecordId(10), visibility.oldestUncommitted());
+
+        visibility.finish(10);
+        ASSERT_EQUALS(RecordId(12), visibility.oldestUncommitted());
+
+        visibility.finish(12);
+        ASSERT(visibility.oldestUncommitted().isNull());
+        ASSERT_EQUALS(RecordId(13), visibility.reserve());
+    }
+
+    TEST(WiredTigerCappedVisibilityTest, RegisterRecordIds) {
+        WiredTigerCappedVisibility visibility(false, RecordId());
+        visibility.noteInserted(RecordId(5));
+        ASSERT(visibility.oldestUncommitted().isNull());
+        ASSERT_EQUALS(RecordId(5), visibility.oplogReadTill());
+
+        int64_t first = visibility.registerRecordId(RecordId(100));
+        int64_t second = visibility.registerRecordId(RecordId(250));
+        ASSERT_EQUALS(RecordId(100), visibility.oldestUncommitted());
+        ASSERT_EQUALS(RecordId(100), visibility.oplogReadTill());
+
+        visibility.finish(first);
+        ASSERT_EQUALS(RecordId(250), visibility.oldestUncommitted());
+
+        visibility.finish(second);
+        ASSERT(visibility.oldestUncommitted().isNull());
+        ASSERT_EQUALS(RecordId(250), visibility.oplogReadTill());
+
+        // Inserts that aren't registered only move the read point.
+        visibility.noteInserted(RecordId(300));
+        visibility.noteInserted(RecordId(260));
+        ASSERT_EQUALS(RecordId(300), visibility.oplogReadTill());
+    }
+
+    TEST(WiredTigerCappedVisibilityTest, SlotsAreReused) {
+        WiredTigerCappedVisibility visibility(false, RecordId());
+        for (int64_t i = 1; i <= 3 * WiredTigerCappedVisibility::kMaxUncommitted; i++) {
+            int64_t ticket = visibility.registerRecordId(RecordId(i));
+            ASSERT_EQUALS(RecordId(i), visibility.oldestUncommitted());
+            visibility.finish(ticket);
+        }
+        ASSERT(visibility.oldestUncommitted().isNull());
+    }
+
+    TEST(WiredTigerCappedVisibilityTest, TooManyUncommitted) {
+        WiredTigerCappedVisibility visibility(true, RecordId(1));
+        for (int64_t i = 0; i < WiredTigerCappedVisibility::kMaxUncommitted; i++) {
+            visibility.reserve();
+        }
+        ASSERT_THROWS(visibility.reserve(), WriteConflictException);
+
+        visibility.finish(1);
+        ASSERT_EQUALS(RecordId(WiredTigerCappedVisibility::kMaxUncommitted + 1),
+                      visibility.reserve());
+    }
+
+    void reserveAndFinish(WiredTigerCappedVisibility* visibility, int iterations, bool* ok) {
+        for (int i = 0; i < iterations; i++) {
+            RecordId loc = visibility->reserve();
+
+            // Nothing at or after an uncommitted insert may be visible.
+            RecordId oldest = visibility->oldestUncommitted();
+            if (oldest.isNull() || loc < oldest) {
+                *ok = false;
+            }
+
+            visibility->finish(loc.repr());
+        }
+    }
+
+    TEST(WiredTigerCappedVisibilityTest, ConcurrentInserts) {
+        const int kThreads = 8;
+        const int kIterations = 20000;
+
+        WiredTigerCappedVisibility visibility(true, RecordId(1));
+        std::vector<boost::thread*> threads;
+        bool ok[kThreads];
+        for (int i = 0; i < kThreads; i++) {
+            ok[i] = true;
+            threads.push_back(new boost::thread(
+                stdx::bind(reserveAndFinish, &visibility, kIterations, &ok[i])));
+        }
+        for (int i = 0; i < kThreads; i++) {
+            threads[i]->join();
+            delete threads[i];
+            ASSERT(ok[i]);
+        }
+
+        ASSERT(visibility.oldestUncommitted().isNull());
+        ASSERT_EQUALS(RecordId(kThreads * kIterations + 1), visibility.reserve());
+    }
+
+} // namespace
+} // namespace mongo
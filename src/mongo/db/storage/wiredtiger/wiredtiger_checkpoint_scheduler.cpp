@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+
+namespace mongo {
+
+namespace {
+
+    // Checkpoints shorter than this are mostly fixed costs, and say little about bandwidth.
+    const long long kMinMillisForBandwidth = 100;
+
+    // The weight of the latest checkpoint in the bandwidth estimate.
+    const double kBandwidthWeight = 0.3;
+
+}  // namespace
+
+    WiredTigerCheckpointScheduler::WiredTigerCheckpointScheduler(const Options& options)
+        : _options(options),
+          _bytesPerMilli(0),
+          _lastDurationMillis(0),
+          _maxDurationMillis(0),
+          _totalDurationMillis(0),
+          _lastBytesWritten(0),
+          _totalBytesWritten(0) {
+        std::fill(_numCheckpoints, _numCheckpoints + kNumReasons, 0);
+    }
+
+    WiredTigerCheckpointScheduler::Reason WiredTigerCheckpointScheduler::checkpointDue(
+            long long millisSinceLast,
+            uint64_t dirtyBytes,
+            uint64_t cacheBytes) const {
+        if (millisSinceLast >= _options.maxIntervalMillis) {
+            return kInterval;
+        }
+        if (millisSinceLast < _options.minIntervalMillis || dirtyBytes == 0) {
+            return kNotDue;
+        }
+        if (_options.dirtyTriggerPercent > 0 && cacheBytes > 0
+            && 100.0 * dirtyBytes >= _options.dirtyTriggerPercent * cacheBytes) {
+            return kDirty;
+        }
+        if (_options.targetMillis > 0 && _bytesPerMilli > 0
+            && dirtyBytes >= _bytesPerMilli * _options.targetMillis) {
+            return kTarget;
+        }
+        return kNotDue;
+    }
+
+    void WiredTigerCheckpointScheduler::checkpointDone(Reason reason,
+                                                       long long durationMillis,
+                                                       uint64_t bytesWritten) {
+        ++_numCheckpoints[reason];
+        _lastDurationMillis = durationMillis;
+        _maxDurationMillis = std::max(_maxDurationMillis, durationMillis);
+        _totalDurationMillis += durationMillis;
+        _lastBytesWritten = bytesWritten;
+        _totalBytesWritten += bytesWritten;
+
+        if (durationMillis >= kMinMillisForBandwidth && bytesWritten > 0) {
+            const double bytesPerMilli = static_cast<double>(bytesWritten) / durationMillis;
+            _bytesPerMilli = _bytesPerMilli > 0
+                ? kBandwidthWeight * bytesPerMilli + (1 - kBandwidthWeight) * _bytesPerMilli
+                : bytesPerMilli;
+        }
+    }
+
+    void WiredTigerCheckpointScheduler::appendStats(BSONObjBuilder* builder) const {
+        long long total = 0;
+        for (int i = 0; i < kNumReasons; i++) {
+            total += _numCheckpoints[i];
+        }
+        builder->appendNumber("checkpoints", total);
+        builder->appendNumber("checkpointsForInterval", _numCheckpoints[kInterval]);
+        builder->appendNumber("checkpointsForDirtyCache", _numCheckpoints[kDirty]);
+        builder->appendNumber("checkpointsForTargetTime", _numCheckpoints[kTarget]);
+        builder->appendNumber("lastDurationMillis", _lastDurationMillis);
+        builder->appendNumber("maxDurationMillis", _maxDurationMillis);
+        builder->appendNumber("totalDurationMillis", _totalDurationMillis);
+        builder->appendNumber("lastBytesWritten", static_cast<long long>(_lastBytesWritten));
+        builder->appendNumber("totalBytesWritten", static_cast<long long>(_totalBytesWritten));
+        builder->append("bytesPerMilli", _bytesPerMilli);
+    }
+
+}  // namespace mongo
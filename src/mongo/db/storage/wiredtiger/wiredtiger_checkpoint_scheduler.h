@@ -0,0 +1,116 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "mongo/base/disallow_copying.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Decides when mongod takes the next WiredTiger checkpoint, in place of WiredTiger's own
+     * fixed checkpoint interval, and keeps statistics about the checkpoints taken.
+     *
+     * A checkpoint writes out everything dirty in the cache, so the longer the wait between
+     * checkpoints, the bigger the burst of writes. Rather than wait out the whole interval, the
+     * scheduler starts a checkpoint as soon as the dirty part of the cache reaches a share of it,
+     * or would take longer than a target time to write out at the bandwidth the recent
+     * checkpoints achieved. Checkpoints are never closer together than a minimum interval, and
+     * never further apart than a maximum one.
+     *
+     * Not thread safe; the engine serializes calls.
+     */
+    class WiredTigerCheckpointScheduler {
+        MONGO_DISALLOW_COPYING(WiredTigerCheckpointScheduler);
+    public:
+        struct Options {
+            Options() : minIntervalMillis(0),
+                        maxIntervalMillis(0),
+                        dirtyTriggerPercent(0),
+                        targetMillis(0) {}
+
+            long long minIntervalMillis;
+            long long maxIntervalMillis;
+            double dirtyTriggerPercent;  // 0 for no trigger on the dirty share of the cache
+            long long targetMillis;  // 0 for no trigger on the time to write the dirty data
+        };
+
+        /**
+         * Why a checkpoint is due.
+         */
+        enum Reason {
+            kNotDue = 0,
+            kInterval,  // the maximum interval is up
+            kDirty,  // the dirty share of the cache reached dirtyTriggerPercent
+            kTarget,  // writing the dirty data would take longer than targetMillis
+            kNumReasons
+        };
+
+        explicit WiredTigerCheckpointScheduler(const Options& options);
+
+        /**
+         * Returns why a checkpoint is due now, 'millisSinceLast' after the last one ended, with
+         * 'dirtyBytes' of the 'cacheBytes' cache dirty, or kNotDue.
+         */
+        Reason checkpointDue(long long millisSinceLast,
+                             uint64_t dirtyBytes,
+                             uint64_t cacheBytes) const;
+
+        /**
+         * Records a checkpoint taken for 'reason', which took 'durationMillis' and wrote
+         * 'bytesWritten'.
+         */
+        void checkpointDone(Reason reason, long long durationMillis, uint64_t bytesWritten);
+
+        /**
+         * Returns the estimated write bandwidth of checkpoints in bytes per millisecond, or 0
+         * before one large enough to tell was taken.
+         */
+        double bytesPerMilli() const { return _bytesPerMilli; }
+
+        void appendStats(BSONObjBuilder* builder) const;
+
+    private:
+        const Options _options;
+
+        // A moving average over the recent checkpoints.
+        double _bytesPerMilli;
+
+        long long _numCheckpoints[kNumReasons];
+        long long _lastDurationMillis;
+        long long _maxDurationMillis;
+        long long _totalDurationMillis;
+        uint64_t _lastBytesWritten;
+        uint64_t _totalBytesWritten;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    typedef WiredTigerCheckpointScheduler Scheduler;
+
+    Scheduler::Options makeOptions() {
+        Scheduler::Options options;
+        options.minIntervalMillis = 5000;
+        options.maxIntervalMillis = 60000;
+        options.dirtyTriggerPercent = 5;
+        options.targetMillis = 2000;
+        return options;
+    }
+
+    const uint64_t kCacheBytes = 1000 * 1000 * 1000;
+
+    TEST(WiredTigerCheckpointSchedulerTest, MaxInterval) {
+        Scheduler scheduler(makeOptions());
+        ASSERT_EQUALS(Scheduler::kNotDue, scheduler.checkpointDue(59999, 0, kCacheBytes));
+        ASSERT_EQUALS(Scheduler::kInterval, scheduler.checkpointDue(60000, 0, kCacheBytes));
+        ASSERT_EQUALS(Scheduler::kInterval,
+                      scheduler.checkpointDue(60000, kCacheBytes / 2, kCacheBytes));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, DirtyTrigger) {
+        Scheduler scheduler(makeOptions());
+        ASSERT_EQUALS(Scheduler::kNotDue,
+                      scheduler.checkpointDue(10000, kCacheBytes / 20 - 1, kCacheBytes));
+        ASSERT_EQUALS(Scheduler::kDirty,
+                      scheduler.checkpointDue(10000, kCacheBytes / 20, kCacheBytes));
+
+        // Never closer together than the minimum interval.
+        ASSERT_EQUALS(Scheduler::kNotDue,
+                      scheduler.checkpointDue(4999, kCacheBytes / 2, kCacheBytes));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, TargetTime) {
+        Scheduler scheduler(makeOptions());
+        ASSERT_EQUALS(0, scheduler.bytesPerMilli());
+
+        // Too short to estimate the bandwidth from.
+        scheduler.checkpointDone(Scheduler::kInterval, 10, 1000 * 1000);
+        ASSERT_EQUALS(0, scheduler.bytesPerMilli());
+        ASSERT_EQUALS(Scheduler::kNotDue,
+                      scheduler.checkpointDue(10000, kCacheBytes / 100, kCacheBytes));
+
+        // 10KB a millisecond: 2 seconds' worth is 20MB, 2% of the cache.
+        scheduler.checkpointDone(Scheduler::kInterval, 1000, 10 * 1000 * 1000);
+        ASSERT_EQUALS(10 * 1000, scheduler.bytesPerMilli());
+        ASSERT_EQUALS(Scheduler::kNotDue,
+                      scheduler.checkpointDue(10000, 20 * 1000 * 1000 - 1, kCacheBytes));
+        ASSERT_EQUALS(Scheduler::kTarget,
+                      scheduler.checkpointDue(10000, 20 * 1000 * 1000, kCacheBytes));
+
+        // The estimate follows the recent checkpoints.
+        scheduler.checkpointDone(Scheduler::kTarget, 1000, 20 * 1000 * 1000);
+        ASSERT_GREATER_THAN(scheduler.bytesPerMilli(), 10 * 1000);
+        ASSERT_LESS_THAN(scheduler.bytesPerMilli(), 20 * 1000);
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, TriggersOff) {
+        Scheduler::Options options = makeOptions();
+        options.dirtyTriggerPercent = 0;
+        options.targetMillis = 0;
+        Scheduler scheduler(options);
+        scheduler.checkpointDone(Scheduler::kInterval, 1000, 10 * 1000 * 1000);
+        ASSERT_EQUALS(Scheduler::kNotDue,
+                      scheduler.checkpointDue(59999, kCacheBytes, kCacheBytes));
+        ASSERT_EQUALS(Scheduler::kInterval,
+                      scheduler.checkpointDue(60000, kCacheBytes, kCacheBytes));
+    }
+
+    TEST(WiredTigerCheckpointSchedulerTest, Stats) {
+        Scheduler scheduler(makeOptions());
+        scheduler.checkpointDone(Scheduler::kInterval, 300, 1000);
+        scheduler.checkpointDone(Scheduler::kDirty, 200, 3000);
+        scheduler.checkpointDone(Scheduler::kDirty, 100, 2000);
+
+        BSONObjBuilder builder;
+        scheduler.appendStats(&builder);
+        BSONObj stats = builder.obj();
+        ASSERT_EQUALS(3, stats["checkpoints"].numberLong());
+        ASSERT_EQUALS(1, stats["checkpointsForInterval"].numberLong());
+        ASSERT_EQUALS(2, stats["checkpointsForDirtyCache"].numberLong());
+        ASSERT_EQUALS(0, stats["checkpointsForTargetTime"].numberLong());
+        ASSERT_EQUALS(100, stats["lastDurationMillis"].numberLong());
+        ASSERT_EQUALS(300, stats["maxDurationMillis"].numberLong());
+        ASSERT_EQUALS(600, stats["totalDurationMillis"].numberLong());
+        ASSERT_EQUALS(2000, stats["lastBytesWritten"].numberLong());
+        ASSERT_EQUALS(6000, stats["totalBytesWritten"].numberLong());
+    }
+
+}  // namespace
+}  // namespace mongo
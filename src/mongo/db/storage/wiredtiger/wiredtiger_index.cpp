@@ -98,6 +98,21 @@ namespace {
         return bb.obj();
     }
 
+    /**
+     * Returns whether 'loc' is in the list of RecordIds and TypeBits stored as the value of a
+     * unique index entry.
+     */
+    bool uniqueValueHasLoc(const WT_ITEM& value, const RecordId& loc) {
+        BufReader br(value.data, value.size);
+        while (br.remaining()) {
+            if (KeyString::decodeRecordId(&br) == loc)
+                return true;
+
+            KeyString::TypeBits::fromBuffer(&br); // Just calling this to advance reader.
+        }
+        return false;
+    }
+
     Status checkKeySize(const BSONObj& key) {
         if ( key.objsize() >= TempKeyMaxSize ) {
             string msg = mongoutils::str::stream()
@@ -395,14 +410,7 @@ namespace {
         // consider that to be a dup.
         WT_ITEM value;
         invariantWTOK( c->get_value(c,&value) );
-        BufReader br(value.data, value.size);
-        while (br.remaining()) {
-            if (KeyString::decodeRecordId(&br) == loc)
-                return false;
-
-            KeyString::TypeBits::fromBuffer(&br); // Just calling this to advance reader.
-        }
-        return true;
+        return !uniqueValueHasLoc(value, loc);
     }
 
     Status WiredTigerIndex::initAsEmpty(OperationContext* txn) {
@@ -662,8 +670,14 @@ namespace {
             if (!_txn) return; // still saved
 
             _savedForCheck = _txn->recoveryUnit();
+            _savedSnapshotId = SnapshotId();
 
-            if (!wt_keeptxnopen()) {
+            WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(_txn);
+            if (ru->inActiveTxn() && WiredTigerRecoveryUnit::snapshotsOutliveBatches()) {
+                // Keep our position in case the snapshot is still open when we are restored.
+                _savedSnapshotId = ru->getSnapshotId();
+            }
+            else {
                 try {
                     _cursor.reset();
                 }
@@ -689,7 +703,10 @@ namespace {
             invariant( _savedForCheck == txn->recoveryUnit() );
             _txn = txn;
 
-            if (!wt_keeptxnopen()) {
+            WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+            const bool sameSnapshot = !_savedSnapshotId.isNull() && ru->inActiveTxn() &&
+                ru->getSnapshotId() == _savedSnapshotId;
+            if (!sameSnapshot) {
                 if (!_eof) {
                     // Ensure an active session exists, so any restored cursors will bind to it
                     WiredTigerRecoveryUnit::get(txn)->getSession(txn);
@@ -820,6 +837,10 @@ namespace {
         // Ensures we have the same RU at restore time.
         RecoveryUnit* _savedForCheck;
 
+        // Set if _cursor kept its position when saved, which it can use if restored in the same
+        // snapshot.
+        SnapshotId _savedSnapshotId;
+
         // These are where this cursor instance is. They are not changed in the face of a failing
         // next().
         KeyString _key;
@@ -928,8 +949,63 @@ namespace {
         }
     };
 
+    /**
+     * Returns random entries of the index using a next_random WiredTiger cursor, which descends
+     * to a random leaf page and so favors entries on sparsely filled pages.
+     */
+    class WiredTigerIndexRandomCursor final : public SortedDataInterface::RandomCursor {
+    public:
+        WiredTigerIndexRandomCursor(const WiredTigerIndex& idx, OperationContext* txn)
+            : _idx(idx),
+              _cursor(NULL) {
+            WT_SESSION* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+            invariantWTOK(session->open_cursor(session, idx.uri().c_str(), NULL,
+                                               "next_random=true", &_cursor));
+        }
+
+        ~WiredTigerIndexRandomCursor() {
+            _cursor->close(_cursor);
+        }
+
+        boost::optional<IndexKeyEntry> next() override {
+            int ret = WT_OP_CHECK(_cursor->next(_cursor));
+            if (ret == WT_NOTFOUND) return {};
+            invariantWTOK(ret);
+
+            WT_ITEM key;
+            WT_ITEM value;
+            invariantWTOK(_cursor->get_key(_cursor, &key));
+            invariantWTOK(_cursor->get_value(_cursor, &value));
+
+            // See updateLocAndTypeBits() of the cursors above for the two formats.
+            BufReader br(value.data, value.size);
+            RecordId loc;
+            if (_idx.unique()) {
+                loc = KeyString::decodeRecordId(&br);
+            }
+            else {
+                loc = KeyString::decodeRecordIdAtEnd(key.data, key.size);
+            }
+            KeyString::TypeBits typeBits;
+            typeBits.resetFromBuffer(&br);
+
+            return {{KeyString::toBson(static_cast<const char*>(key.data), key.size,
+                                       _idx.ordering(), typeBits),
+                     loc}};
+        }
+
+    private:
+        const WiredTigerIndex& _idx; // not owned
+        WT_CURSOR* _cursor; // owned
+    };
+
 } // namespace
 
+    std::unique_ptr<SortedDataInterface::RandomCursor> WiredTigerIndex::newRandomCursor(
+            OperationContext* txn) const {
+        return stdx::make_unique<WiredTigerIndexRandomCursor>(*this, txn);
+    }
+
     WiredTigerIndexUnique::WiredTigerIndexUnique( OperationContext* ctx,
                                                   const std::string& uri,
                                                   const IndexDescriptor* desc )
@@ -965,19 +1041,28 @@ namespace {
         int ret = WT_OP_CHECK(c->insert(c));
 
         if ( ret != WT_DUPLICATE_KEY ) {
+            // The common case: the insert itself checked that the key isn't in the index yet.
             return wtRCToStatus( ret );
         }
 
-        // we might be in weird mode where there might be multiple values
-        // we put them all in the "list"
-        // Note that we can't omit AllZeros when there are multiple locs for a value. When we remove
-        // down to a single value, it will be cleaned up.
         ret = WT_OP_CHECK(c->search(c));
         invariantWTOK( ret );
 
         WT_ITEM old;
         invariantWTOK( c->get_value(c, &old ) );
 
+        if (!dupsAllowed) {
+            // Only inserting the same loc again isn't a duplicate, so there is no need to build
+            // the new list of locs.
+            if (uniqueValueHasLoc(old, loc))
+                return Status::OK(); // already in index
+            return dupKeyError(key);
+        }
+
+        // we might be in weird mode where there might be multiple values
+        // we put them all in the "list"
+        // Note that we can't omit AllZeros when there are multiple locs for a value. When we remove
+        // down to a single value, it will be cleaned up.
         bool insertedLoc = false;
 
         value.resetToEmpty();
@@ -998,9 +1083,6 @@ namespace {
             value.appendTypeBits(KeyString::TypeBits::fromBuffer(&br));
         }
 
-        if (!dupsAllowed)
-            return dupKeyError(key);
-
         if (!insertedLoc) {
             // This loc is higher than all currently in the index for this key
             value.appendRecordId(loc);
@@ -106,6 +106,8 @@ namespace mongo {
 
         virtual Status initAsEmpty(OperationContext* txn);
 
+        std::unique_ptr<RandomCursor> newRandomCursor(OperationContext* txn) const override;
+
         const std::string& uri() const { return _uri; }
 
         uint64_t instanceId() const { return _instanceId; }
@@ -44,14 +44,33 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_server_status.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/util/background.h"
+#include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     namespace {
+        /**
+         * Resizes the ticket pools that limit concurrent WiredTiger transactions once a second.
+         */
+        class WiredTigerTicketAdjuster : public BackgroundJob {
+        public:
+            virtual std::string name() const { return "WTTicketAdjuster"; }
+
+            virtual void run() {
+                while (!inShutdown()) {
+                    sleepmillis(1000);
+                    WiredTigerRecoveryUnit::adjustTicketPools();
+                }
+            }
+        };
+
         class WiredTigerFactory : public StorageEngine::Factory {
         public:
             virtual ~WiredTigerFactory(){}
@@ -69,6 +88,7 @@ namespace mongo {
                 // Intentionally leaked.
                 new WiredTigerServerStatusSection(kv);
                 new WiredTigerEngineRuntimeConfigParameter(kv);
+                (new WiredTigerTicketAdjuster())->go();
 
                 KVStorageEngineOptions options;
                 options.directoryPerDB = params.directoryperdb;
@@ -33,11 +33,14 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 
+#include <algorithm>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/operations.hpp>
 
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_checkpoint_scheduler.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -47,7 +50,9 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 #if !defined(__has_feature)
 #define __has_feature(x) 0
@@ -56,8 +61,34 @@
 namespace mongo {
 
     using std::set;
+
+    // How often changed collection sizes are written to the size storer table, in milliseconds.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerSizeStorerSyncPeriodMillis, int, 1000);
+
+    // If true, mongod takes the checkpoints itself, as the WiredTigerCheckpointScheduler paces
+    // them, rather than have WiredTiger take one every syncPeriodSecs.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCheckpointScheduling, bool, false);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCheckpointMinIntervalMillis, int, 5000);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCheckpointDirtyTriggerPercent, double, 5.0);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(wiredTigerCheckpointTargetMillis, int, 2000);
+
     using std::string;
 
+namespace {
+
+    // How often the checkpoint thread looks at the cache.
+    const int kCheckpointPollMillis = 250;
+
+    uint64_t getConnectionStat(WT_SESSION* session, int statisticsKey) {
+        StatusWith<uint64_t> result = WiredTigerUtil::getStatisticsValue(session,
+                                                                         "statistics:",
+                                                                         "statistics=(fast)",
+                                                                         statisticsKey);
+        return result.isOK() ? result.getValue() : 0;
+    }
+
+}  // namespace
+
 
     WiredTigerKVEngine::WiredTigerKVEngine( const std::string& path,
                                             const std::string& extraOpenOptions,
@@ -66,7 +97,8 @@ namespace mongo {
         : _eventHandler(WiredTigerUtil::defaultEventHandlers()),
           _path( path ),
           _durable( durable ),
-          _sizeStorerSyncTracker( 100000, 60 * 1000 ) {
+          _sizeStorerSyncShutdown( false ),
+          _checkpointShutdown( false ) {
 
         size_t cacheSizeGB = wiredTigerGlobalOptions.cacheSizeGB;
         if (cacheSizeGB == 0) {
@@ -105,7 +137,11 @@ namespace mongo {
             ss << "log=(enabled=true,archive=true,path=journal,compressor=";
             ss << wiredTigerGlobalOptions.journalCompressor << "),";
         }
-        ss << "checkpoint=(wait=" << wiredTigerGlobalOptions.checkpointDelaySecs;
+        // A syncPeriodSecs of 0 turns the timed checkpoints off, whoever takes them.
+        const bool scheduleCheckpoints = wiredTigerCheckpointScheduling &&
+            wiredTigerGlobalOptions.checkpointDelaySecs > 0;
+        ss << "checkpoint=(wait=";
+        ss << (scheduleCheckpoints ? 0 : wiredTigerGlobalOptions.checkpointDelaySecs);
         ss << ",log_size=2GB),";
         ss << "statistics_log=(wait=" << wiredTigerGlobalOptions.statisticsLogDelaySecs << "),";
         ss << extraOpenOptions;
@@ -134,6 +170,21 @@ namespace mongo {
             _sizeStorer.reset(new WiredTigerSizeStorer(_conn, _sizeStorerUri));
             _sizeStorer->fillCache();
         }
+
+        _sizeStorerSyncThread.reset(new boost::thread(
+            stdx::bind(&WiredTigerKVEngine::_sizeStorerSyncThreadMain, this)));
+
+        if (scheduleCheckpoints) {
+            WiredTigerCheckpointScheduler::Options options;
+            options.maxIntervalMillis = wiredTigerGlobalOptions.checkpointDelaySecs * 1000LL;
+            options.minIntervalMillis = std::min(options.maxIntervalMillis,
+                static_cast<long long>(std::max(0, wiredTigerCheckpointMinIntervalMillis)));
+            options.dirtyTriggerPercent = wiredTigerCheckpointDirtyTriggerPercent;
+            options.targetMillis = wiredTigerCheckpointTargetMillis;
+            _checkpointScheduler.reset(new WiredTigerCheckpointScheduler(options));
+            _checkpointThread.reset(new boost::thread(
+                stdx::bind(&WiredTigerKVEngine::_checkpointThreadMain, this)));
+        }
     }
 
 
@@ -147,6 +198,8 @@ namespace mongo {
 
     void WiredTigerKVEngine::cleanShutdown() {
         log() << "WiredTigerKVEngine shutting down";
+        _stopCheckpointThread();
+        _stopSizeStorerSyncThread();
         syncSizeInfo(true);
         if (_conn) {
             // these must be the last things we do before _conn->close();
@@ -236,6 +289,101 @@ namespace mongo {
         }
     }
 
+    void WiredTigerKVEngine::_sizeStorerSyncThreadMain() {
+        boost::unique_lock<boost::mutex> lk( _sizeStorerSyncMutex );
+        while ( !_sizeStorerSyncShutdown ) {
+            const int periodMillis = std::max( 1, wiredTigerSizeStorerSyncPeriodMillis );
+            _sizeStorerSyncCondition.timed_wait( lk,
+                                                 boost::posix_time::milliseconds( periodMillis ) );
+            if ( _sizeStorerSyncShutdown )
+                break;
+
+            lk.unlock();
+            syncSizeInfo(false);
+            lk.lock();
+        }
+    }
+
+    void WiredTigerKVEngine::_stopSizeStorerSyncThread() {
+        if ( !_sizeStorerSyncThread )
+            return;
+
+        {
+            boost::lock_guard<boost::mutex> lk( _sizeStorerSyncMutex );
+            _sizeStorerSyncShutdown = true;
+        }
+        _sizeStorerSyncCondition.notify_one();
+        _sizeStorerSyncThread->join();
+        _sizeStorerSyncThread.reset();
+    }
+
+    void WiredTigerKVEngine::_checkpointThreadMain() {
+        WiredTigerSession session(_conn);
+        WT_SESSION* s = session.getSession();
+        Timer sinceLast;
+
+        boost::unique_lock<boost::mutex> lk( _checkpointMutex );
+        while ( !_checkpointShutdown ) {
+            _checkpointCondition.timed_wait( lk,
+                                             boost::posix_time::milliseconds(
+                                                 kCheckpointPollMillis ) );
+            if ( _checkpointShutdown )
+                break;
+
+            const WiredTigerCheckpointScheduler::Reason reason =
+                _checkpointScheduler->checkpointDue(
+                    sinceLast.millis(),
+                    getConnectionStat(s, WT_STAT_CONN_CACHE_BYTES_DIRTY),
+                    getConnectionStat(s, WT_STAT_CONN_CACHE_BYTES_MAX));
+            if ( reason == WiredTigerCheckpointScheduler::kNotDue )
+                continue;
+
+            lk.unlock();
+            // The bytes written while the checkpoint runs include some written by eviction, which
+            // doesn't stop for the checkpoint and competes with it for the same bandwidth anyway.
+            const uint64_t bytesWrittenBefore = getConnectionStat(s, WT_STAT_CONN_BLOCK_BYTE_WRITE);
+            Timer duration;
+            const int ret = s->checkpoint(s, NULL);
+            const long long durationMillis = duration.millis();
+            const uint64_t bytesWrittenAfter = getConnectionStat(s, WT_STAT_CONN_BLOCK_BYTE_WRITE);
+            lk.lock();
+
+            if ( ret != 0 ) {
+                warning() << "WiredTiger checkpoint failed: " << wtRCToStatus(ret);
+                continue;
+            }
+            LOG(1) << "WiredTiger checkpoint took " << durationMillis << "ms";
+            _checkpointScheduler->checkpointDone(
+                reason,
+                durationMillis,
+                bytesWrittenAfter > bytesWrittenBefore ? bytesWrittenAfter - bytesWrittenBefore
+                                                       : 0);
+            sinceLast.reset();
+        }
+    }
+
+    void WiredTigerKVEngine::_stopCheckpointThread() {
+        if ( !_checkpointThread )
+            return;
+
+        {
+            boost::lock_guard<boost::mutex> lk( _checkpointMutex );
+            _checkpointShutdown = true;
+        }
+        _checkpointCondition.notify_one();
+        _checkpointThread->join();
+        _checkpointThread.reset();
+    }
+
+    bool WiredTigerKVEngine::appendCheckpointStats(BSONObjBuilder* builder) const {
+        if ( !_checkpointScheduler )
+            return false;
+
+        boost::lock_guard<boost::mutex> lk( _checkpointMutex );
+        _checkpointScheduler->appendStats(builder);
+        return true;
+    }
+
     RecoveryUnit* WiredTigerKVEngine::newRecoveryUnit() {
         return new WiredTigerRecoveryUnit( _sessionCache.get() );
     }
@@ -326,7 +474,23 @@ namespace mongo {
 
         WiredTigerSession session(_conn);
 
-        int ret = session.getSession()->drop( session.getSession(), uri.c_str(), "force" );
+        // A record store's field name dictionary goes with it. Dropping one that isn't there
+        // succeeds, since the drop is forced.
+        const string fieldNamesUri = WiredTigerRecordStore::fieldNamesUri( uri );
+        int ret = session.getSession()->drop( session.getSession(), fieldNamesUri.c_str(),
+                                              "force" );
+        if ( ret == EBUSY ) {
+            {
+                boost::lock_guard<boost::mutex> lk( _identToDropMutex );
+                _identToDrop.insert( fieldNamesUri );
+            }
+            _sessionCache->closeAll();
+        }
+        else {
+            invariantWTOK( ret );
+        }
+
+        ret = session.getSession()->drop( session.getSession(), uri.c_str(), "force" );
         LOG(1) << "WT drop of  " << uri << " res " << ret;
 
         if ( ret == 0 ) {
@@ -349,10 +513,6 @@ namespace mongo {
     }
 
     bool WiredTigerKVEngine::haveDropsQueued() const {
-        if ( _sizeStorerSyncTracker.intervalHasElapsed() ) {
-            _sizeStorerSyncTracker.resetLastTime();
-            syncSizeInfo(false);
-        }
         boost::lock_guard<boost::mutex> lk( _identToDropMutex );
         return !_identToDrop.empty();
     }
@@ -441,6 +601,8 @@ namespace mongo {
             StringData ident = key.substr(idx+1);
             if ( ident == "sizeStorer" )
                 continue;
+            if ( WiredTigerRecordStore::isFieldNamesIdent( ident ) )
+                continue;
 
             all.push_back( ident.toString() );
         }
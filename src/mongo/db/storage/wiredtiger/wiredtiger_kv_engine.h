@@ -35,17 +35,20 @@
 #include <string>
 
 #include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include <wiredtiger.h>
 
 #include "mongo/bson/ordering.h"
 #include "mongo/db/storage/kv/kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
-#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
+    class BSONObjBuilder;
+    class WiredTigerCheckpointScheduler;
     class WiredTigerSessionCache;
     class WiredTigerSizeStorer;
 
@@ -64,6 +67,8 @@ namespace mongo {
 
         virtual bool supportsDirectoryPerDB() const;
 
+        virtual bool supportsConcurrentIdentOpening() const { return true; }
+
         virtual bool isDurable() const { return _durable; }
 
         virtual RecoveryUnit* newRecoveryUnit();
@@ -115,11 +120,18 @@ namespace mongo {
         int reconfigure(const char* str);
 
         WT_CONNECTION* getConnection() { return _conn; }
+        WiredTigerSessionCache* getSessionCache() const { return _sessionCache.get(); }
         void dropAllQueued();
         bool haveDropsQueued() const;
 
         void syncSizeInfo(bool sync) const;
 
+        /**
+         * Appends the statistics of the checkpoints mongod took itself, and returns true, if
+         * wiredTigerCheckpointScheduling is on. Returns false otherwise.
+         */
+        bool appendCheckpointStats(BSONObjBuilder* builder) const;
+
         /**
          * Initializes a background job to remove excess documents in the oplog collections.
          * This applies to the capped collections in the local.oplog.* namespaces (specifically
@@ -138,6 +150,20 @@ namespace mongo {
         std::string _uri( StringData ident ) const;
         bool _drop( StringData ident );
 
+        /**
+         * Body of the thread that writes changed collection sizes to the size storer every
+         * wiredTigerSizeStorerSyncPeriodMillis, until _stopSizeStorerSyncThread() is called.
+         */
+        void _sizeStorerSyncThreadMain();
+        void _stopSizeStorerSyncThread();
+
+        /**
+         * Body of the thread that takes a checkpoint whenever the _checkpointScheduler says one
+         * is due, until _stopCheckpointThread() is called.
+         */
+        void _checkpointThreadMain();
+        void _stopCheckpointThread();
+
         WT_CONNECTION* _conn;
         WT_EVENT_HANDLER _eventHandler;
         boost::scoped_ptr<WiredTigerSessionCache> _sessionCache;
@@ -152,7 +178,17 @@ namespace mongo {
 
         boost::scoped_ptr<WiredTigerSizeStorer> _sizeStorer;
         std::string _sizeStorerUri;
-        mutable ElapsedTracker _sizeStorerSyncTracker;
+
+        boost::scoped_ptr<boost::thread> _sizeStorerSyncThread;
+        boost::mutex _sizeStorerSyncMutex;
+        boost::condition_variable _sizeStorerSyncCondition;
+        bool _sizeStorerSyncShutdown; // guarded by _sizeStorerSyncMutex
+
+        boost::scoped_ptr<WiredTigerCheckpointScheduler> _checkpointScheduler;
+        boost::scoped_ptr<boost::thread> _checkpointThread;
+        mutable boost::mutex _checkpointMutex; // guards _checkpointScheduler
+        boost::condition_variable _checkpointCondition;
+        bool _checkpointShutdown; // guarded by _checkpointMutex
     };
 
 }
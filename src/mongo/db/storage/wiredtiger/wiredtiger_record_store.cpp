@@ -35,15 +35,23 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 
+#include <boost/scoped_array.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_array.hpp>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
 #include <wiredtiger.h>
 
 #include "mongo/base/checked_cast.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/storage/field_name_dictionary.h"
+#include "mongo/db/storage/id_keys.h"
 #include "mongo/db/storage/oplog_hack.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_capped_visibility.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -55,6 +63,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 //#define RS_ITERATOR_TRACE(x) log() << "WTRS::Iterator " << x
 #define RS_ITERATOR_TRACE(x)
@@ -68,7 +77,11 @@ namespace {
 
     static const int kMinimumRecordStoreVersion = 1;
     static const int kCurrentRecordStoreVersion = 1; // New record stores use this by default.
-    static const int kMaximumRecordStoreVersion = 1;
+    // Record stores keyed by _id use this, so that versions that would take the next RecordId
+    // for inserts refuse to open them. So do record stores with a field name dictionary, whose
+    // records aren't BSON.
+    static const int kKeyedByIdRecordStoreVersion = 2;
+    static const int kMaximumRecordStoreVersion = 2;
     BOOST_STATIC_ASSERT(kCurrentRecordStoreVersion >= kMinimumRecordStoreVersion);
     BOOST_STATIC_ASSERT(kCurrentRecordStoreVersion <= kMaximumRecordStoreVersion);
 
@@ -81,6 +94,43 @@ namespace {
         return (appMetadata.getValue().getIntField("oplogKeyExtractionVersion") == 1);
     }
 
+    bool shouldKeyById(OperationContext* opCtx, const std::string& uri) {
+        StatusWith<BSONObj> appMetadata = WiredTigerUtil::getApplicationMetadata(opCtx, uri);
+        if (!appMetadata.isOK()) {
+            return false;
+        }
+
+        return (appMetadata.getValue().getIntField("idKeyExtractionVersion") == 1);
+    }
+
+    bool shouldUseFieldNameDictionary(OperationContext* opCtx, const std::string& uri) {
+        StatusWith<BSONObj> appMetadata = WiredTigerUtil::getApplicationMetadata(opCtx, uri);
+        if (!appMetadata.isOK()) {
+            return false;
+        }
+
+        return (appMetadata.getValue().getIntField("fieldNameDictionaryVersion") == 1);
+    }
+
+    const char kFieldNamesSuffix[] = ".fieldNames";
+
+    // The size of the BSON document a record holds.
+    int bsonSize(const FieldNameDictionary* fieldNames, const WT_ITEM& value) {
+        if (!fieldNames) {
+            return value.size;
+        }
+        const int size =
+            FieldNameDictionary::decodedSize(static_cast<const char*>(value.data), value.size);
+        massert(28714, "can't read the size of a record with a field name dictionary", size >= 0);
+        return size;
+    }
+
+    // Oplog stone statistics, reported in the wiredTiger section of serverStatus.
+    AtomicInt64 oplogStonesCount;
+    AtomicInt64 oplogStonesTruncations;
+    AtomicInt64 oplogStonesTotalTruncateMicros;
+    AtomicInt64 oplogStonesLastTruncateMicros;
+
 } // namespace
 
     MONGO_FP_DECLARE(WTWriteConflictException);
@@ -89,6 +139,378 @@ namespace {
 
     const long long WiredTigerRecordStore::kCollectionScanOnCreationThreshold = 10000;
 
+    /**
+     * Keeps the tokens of a record store's field name dictionary in a table of their own, keyed
+     * by token. Each token is committed on its own, outside of the transaction of the insert or
+     * update that adds it.
+     */
+    class WiredTigerRecordStore::FieldNameStore : public FieldNameDictionary::Store {
+    public:
+        FieldNameStore(WiredTigerSessionCache* sessionCache, const std::string& uri)
+            : _sessionCache(sessionCache),
+              _uri(uri),
+              _cursorId(WiredTigerSession::genCursorId()) {
+        }
+
+        /**
+         * Creates the table if it doesn't exist yet, and loads the tokens in it into 'dict'.
+         */
+        void createAndLoad(FieldNameDictionary* dict) {
+            WiredTigerSession* session = _sessionCache->getSession();
+            ON_BLOCK_EXIT(&WiredTigerSessionCache::releaseSession, _sessionCache, session);
+            WT_SESSION* s = session->getSession();
+            invariantWTOK(s->create(s, _uri.c_str(),
+                                    "type=file,key_format=q,value_format=u,checksum=on"));
+
+            WT_CURSOR* c = session->getCursor(_uri, _cursorId, true);
+            invariant(c);
+            int ret;
+            while ((ret = c->next(c)) == 0) {
+                int64_t token;
+                invariantWTOK(c->get_key(c, &token));
+                WT_ITEM name;
+                invariantWTOK(c->get_value(c, &name));
+                fassert(28715, dict->load(token, StringData(
+                    static_cast<const char*>(name.data), name.size)));
+            }
+            invariant(ret == WT_NOTFOUND);
+            session->releaseCursor(_cursorId, c);
+        }
+
+        virtual Status save(unsigned token, StringData name) {
+            WiredTigerSession* session = _sessionCache->getSession();
+            ON_BLOCK_EXIT(&WiredTigerSessionCache::releaseSession, _sessionCache, session);
+            WT_SESSION* s = session->getSession();
+
+            WT_CURSOR* c = session->getCursor(_uri, _cursorId, true);
+            invariant(c);
+            invariantWTOK(s->begin_transaction(s, NULL));
+            c->set_key(c, static_cast<int64_t>(token));
+            WiredTigerItem value(name.rawData(), name.size());
+            c->set_value(c, value.Get());
+            int ret = WT_OP_CHECK(c->insert(c));
+            session->releaseCursor(_cursorId, c);
+            if (ret) {
+                invariantWTOK(s->rollback_transaction(s, NULL));
+                return wtRCToStatus(ret, "WiredTigerRecordStore::FieldNameStore::save");
+            }
+            return wtRCToStatus(s->commit_transaction(s, NULL));
+        }
+
+    private:
+        WiredTigerSessionCache* const _sessionCache;
+        const std::string _uri;
+        const uint64_t _cursorId;
+    };
+
+    /**
+     * Divides an oplog into "stones": consecutive ranges of records holding roughly
+     * '_minBytesPerStone' bytes each. Once there are more full stones than are needed to hold
+     * 'cappedMaxSize' bytes, the background thread removes the oldest stone with a single range
+     * truncate, instead of inserts walking and deleting the oldest records themselves.
+     *
+     * The counts of a stone are approximate: inserts that commit out of order are counted in the
+     * stone they commit in, and stones created at startup from random samples use averages.
+     */
+    class WiredTigerRecordStore::OplogStones {
+    public:
+        struct Stone {
+            int64_t records;
+            int64_t bytes;
+            RecordId lastRecord; // the highest RecordId in the stone
+        };
+
+        OplogStones(OperationContext* txn, WiredTigerRecordStore* rs);
+        ~OplogStones();
+
+        /**
+         * Sets 'stone' to the oldest stone and returns true if it is no longer needed to hold
+         * 'cappedMaxSize' bytes, otherwise returns false.
+         */
+        bool peekOldestStoneIfNeeded(Stone* stone) const;
+
+        void popOldestStone();
+
+        /**
+         * Counts an insert of 'bytes' bytes at 'loc' towards the newest stone once 'txn'
+         * commits, and starts a new stone if that fills it.
+         */
+        void updateCurrentStoneAfterInsertOnCommit(OperationContext* txn,
+                                                   int64_t bytes,
+                                                   const RecordId& loc);
+
+        void clearStonesOnCommit(OperationContext* txn);
+
+        /**
+         * Drops the stones at or after 'firstRemoved', after everything from there on has been
+         * deleted by temp_cappedTruncateAfter().
+         */
+        void updateStonesAfterCappedTruncateAfter(int64_t recordsRemoved,
+                                                  int64_t bytesRemoved,
+                                                  const RecordId& firstRemoved);
+
+    private:
+        class InsertChange;
+        class TruncateChange;
+
+        static const int64_t kMinStonesToKeep = 10;
+        static const int64_t kMaxStonesToKeep = 100;
+
+        // How many random samples are taken for each stone when sizing stones at startup.
+        static const int64_t kRandomSamplesPerStone = 10;
+
+        void _createNewStoneIfNeeded(const RecordId& lastRecord);
+        void _pushStone_inlock(const Stone& stone);
+        void _calculateStonesByScanning(OperationContext* txn);
+        void _calculateStonesBySampling(OperationContext* txn,
+                                        int64_t numRecords,
+                                        int64_t dataSize);
+
+        WiredTigerRecordStore* _rs; // not owned
+
+        size_t _numStonesToKeep;
+        int64_t _minBytesPerStone;
+
+        // Records and bytes committed since the newest stone was created.
+        AtomicInt64 _currentRecords;
+        AtomicInt64 _currentBytes;
+
+        mutable boost::mutex _mutex; // protects '_stones'
+        std::deque<Stone> _stones; // oldest stone is at the front
+    };
+
+    const int64_t WiredTigerRecordStore::OplogStones::kMinStonesToKeep;
+    const int64_t WiredTigerRecordStore::OplogStones::kMaxStonesToKeep;
+    const int64_t WiredTigerRecordStore::OplogStones::kRandomSamplesPerStone;
+
+    class WiredTigerRecordStore::OplogStones::InsertChange : public RecoveryUnit::Change {
+    public:
+        InsertChange(OplogStones* stones, int64_t bytes, const RecordId& loc)
+            : _stones(stones), _bytes(bytes), _loc(loc) {}
+
+        virtual void commit() {
+            _stones->_currentRecords.addAndFetch(1);
+            if (_stones->_currentBytes.addAndFetch(_bytes) >= _stones->_minBytesPerStone) {
+                _stones->_createNewStoneIfNeeded(_loc);
+            }
+        }
+
+        virtual void rollback() {}
+
+    private:
+        OplogStones* _stones;
+        const int64_t _bytes;
+        const RecordId _loc;
+    };
+
+    class WiredTigerRecordStore::OplogStones::TruncateChange : public RecoveryUnit::Change {
+    public:
+        TruncateChange(OplogStones* stones) : _stones(stones) {}
+
+        virtual void commit() {
+            boost::lock_guard<boost::mutex> lk(_stones->_mutex);
+            oplogStonesCount.subtractAndFetch(_stones->_stones.size());
+            _stones->_stones.clear();
+            _stones->_currentRecords.store(0);
+            _stones->_currentBytes.store(0);
+        }
+
+        virtual void rollback() {}
+
+    private:
+        OplogStones* _stones;
+    };
+
+    WiredTigerRecordStore::OplogStones::OplogStones(OperationContext* txn,
+                                                    WiredTigerRecordStore* rs)
+        : _rs(rs) {
+        invariant(rs->isCapped());
+        const int64_t maxSize = rs->cappedMaxSize();
+        _numStonesToKeep = std::min(kMaxStonesToKeep,
+                                    std::max(kMinStonesToKeep,
+                                             maxSize / BSONObjMaxInternalSize));
+        _minBytesPerStone = std::max(int64_t(1), maxSize / int64_t(_numStonesToKeep));
+        _currentRecords.store(0);
+        _currentBytes.store(0);
+
+        const int64_t numRecords = rs->_numRecords.load();
+        const int64_t dataSize = rs->_dataSize.load();
+        if (numRecords <= 0 || dataSize <= 0) {
+            return;
+        }
+
+        // Sampling only pays off when it reads a small fraction of the records.
+        const int64_t numSamples = kRandomSamplesPerStone * (dataSize / _minBytesPerStone);
+        if (numSamples * 10 >= numRecords) {
+            _calculateStonesByScanning(txn);
+        }
+        else {
+            _calculateStonesBySampling(txn, numRecords, dataSize);
+        }
+
+        LOG(1) << "divided " << rs->ns() << " into " << _stones.size() << " stones of about "
+               << _minBytesPerStone << " bytes each, keeping " << _numStonesToKeep;
+    }
+
+    WiredTigerRecordStore::OplogStones::~OplogStones() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        oplogStonesCount.subtractAndFetch(_stones.size());
+    }
+
+    bool WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded(Stone* stone) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (_stones.size() <= _numStonesToKeep) {
+            return false;
+        }
+        *stone = _stones.front();
+        return true;
+    }
+
+    void WiredTigerRecordStore::OplogStones::popOldestStone() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        invariant(!_stones.empty());
+        _stones.pop_front();
+        oplogStonesCount.subtractAndFetch(1);
+    }
+
+    void WiredTigerRecordStore::OplogStones::updateCurrentStoneAfterInsertOnCommit(
+            OperationContext* txn,
+            int64_t bytes,
+            const RecordId& loc) {
+        txn->recoveryUnit()->registerChange(new InsertChange(this, bytes, loc));
+    }
+
+    void WiredTigerRecordStore::OplogStones::clearStonesOnCommit(OperationContext* txn) {
+        txn->recoveryUnit()->registerChange(new TruncateChange(this));
+    }
+
+    void WiredTigerRecordStore::OplogStones::updateStonesAfterCappedTruncateAfter(
+            int64_t recordsRemoved,
+            int64_t bytesRemoved,
+            const RecordId& firstRemoved) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
+        int64_t records = _currentRecords.load();
+        int64_t bytes = _currentBytes.load();
+        while (!_stones.empty() && _stones.back().lastRecord >= firstRemoved) {
+            records += _stones.back().records;
+            bytes += _stones.back().bytes;
+            _stones.pop_back();
+            oplogStonesCount.subtractAndFetch(1);
+        }
+
+        _currentRecords.store(std::max(int64_t(0), records - recordsRemoved));
+        _currentBytes.store(std::max(int64_t(0), bytes - bytesRemoved));
+    }
+
+    void WiredTigerRecordStore::OplogStones::_createNewStoneIfNeeded(const RecordId& lastRecord) {
+        boost::unique_lock<boost::mutex> lk(_mutex, boost::try_to_lock);
+        if (!lk.owns_lock()) {
+            // Someone else is already creating a stone.
+            return;
+        }
+
+        const int64_t bytes = _currentBytes.load();
+        if (bytes < _minBytesPerStone) {
+            return;
+        }
+
+        if (!_stones.empty() && lastRecord <= _stones.back().lastRecord) {
+            // This insert committed after a later one ended the previous stone; the next insert
+            // to commit will close this one.
+            return;
+        }
+
+        const int64_t records = _currentRecords.load();
+        const Stone stone = { records, bytes, lastRecord };
+        _pushStone_inlock(stone);
+        _currentRecords.subtractAndFetch(records);
+        _currentBytes.subtractAndFetch(bytes);
+    }
+
+    void WiredTigerRecordStore::OplogStones::_pushStone_inlock(const Stone& stone) {
+        _stones.push_back(stone);
+        oplogStonesCount.addAndFetch(1);
+    }
+
+    void WiredTigerRecordStore::OplogStones::_calculateStonesByScanning(OperationContext* txn) {
+        LOG(1) << "scanning " << _rs->ns() << " to divide it into stones";
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        WiredTigerCursor curwrap( _rs->_uri, _rs->_instanceId, true, txn);
+        WT_CURSOR* c = curwrap.get();
+
+        int64_t records = 0;
+        int64_t bytes = 0;
+        int ret;
+        while ((ret = c->next(c)) == 0) {
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            WT_ITEM value;
+            invariantWTOK(c->get_value(c, &value));
+
+            records++;
+            bytes += value.size;
+            if (bytes >= _minBytesPerStone) {
+                const Stone stone = { records, bytes, _fromKey(key) };
+                _pushStone_inlock(stone);
+                records = 0;
+                bytes = 0;
+            }
+        }
+        invariant(ret == WT_NOTFOUND);
+
+        _currentRecords.store(records);
+        _currentBytes.store(bytes);
+    }
+
+    void WiredTigerRecordStore::OplogStones::_calculateStonesBySampling(OperationContext* txn,
+                                                                        int64_t numRecords,
+                                                                        int64_t dataSize) {
+        const double avgRecordSize = static_cast<double>(dataSize) / numRecords;
+        const int64_t recordsPerStone =
+            std::max(int64_t(1), static_cast<int64_t>(std::ceil(_minBytesPerStone /
+                                                                 avgRecordSize)));
+        const int64_t bytesPerStone = static_cast<int64_t>(recordsPerStone * avgRecordSize);
+        const int64_t numSamples = kRandomSamplesPerStone * (numRecords / recordsPerStone);
+
+        LOG(1) << "taking " << numSamples << " samples of " << _rs->ns()
+               << " to divide it into stones";
+
+        WT_SESSION* session = WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+        WT_CURSOR* c;
+        invariantWTOK(session->open_cursor(session, _rs->_uri.c_str(), NULL,
+                                           "next_random=true", &c));
+        ON_BLOCK_EXIT(c->close, c);
+
+        std::vector<RecordId> samples;
+        samples.reserve(numSamples);
+        for (int64_t i = 0; i < numSamples; i++) {
+            int ret = c->next(c);
+            if (ret == WT_NOTFOUND) {
+                break;
+            }
+            invariantWTOK(ret);
+            int64_t key;
+            invariantWTOK(c->get_key(c, &key));
+            samples.push_back(_fromKey(key));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        // Every kRandomSamplesPerStone'th sample approximates the end of a stone.
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        for (size_t i = kRandomSamplesPerStone - 1; i < samples.size();
+             i += kRandomSamplesPerStone) {
+            const Stone stone = { recordsPerStone, bytesPerStone, samples[i] };
+            _pushStone_inlock(stone);
+        }
+
+        _currentRecords.store(std::max(int64_t(0),
+                                       numRecords - recordsPerStone * int64_t(_stones.size())));
+        _currentBytes.store(std::max(int64_t(0),
+                                     dataSize - bytesPerStone * int64_t(_stones.size())));
+    }
+
     StatusWith<std::string> WiredTigerRecordStore::parseOptionsField(const BSONObj options) {
         StringBuilder ss;
         BSONForEach(elem, options) {
@@ -102,6 +524,22 @@ namespace {
                 }
                 ss << elem.valueStringData() << ',';
             }
+            else if (elem.fieldNameStringData() == "fieldNameDictionary") {
+                // Recorded in the app_metadata by generateCreateString().
+                if (!elem.isBoolean()) {
+                    return StatusWith<std::string>(ErrorCodes::TypeMismatch, str::stream()
+                                                   << "storageEngine.wiredTiger."
+                                                   << "fieldNameDictionary must be a boolean");
+                }
+            }
+            else if (elem.fieldNameStringData() == "keyedById") {
+                // Recorded in the app_metadata by generateCreateString().
+                if (!elem.isBoolean()) {
+                    return StatusWith<std::string>(ErrorCodes::TypeMismatch, str::stream()
+                                                   << "storageEngine.wiredTiger.keyedById "
+                                                   << "must be a boolean");
+                }
+            }
             else {
                 // Return error on first unrecognized field.
                 return StatusWith<std::string>(ErrorCodes::InvalidOptions, str::stream()
@@ -146,6 +584,20 @@ namespace {
 
         ss << customOptions.getValue();
 
+        const BSONObj wtOptions = options.storageEngine.getObjectField(kWiredTigerEngineName);
+        const bool keyedById = wtOptions["keyedById"].trueValue();
+        if (keyedById && (options.capped || NamespaceString::oplog(ns))) {
+            return StatusWith<std::string>(ErrorCodes::InvalidOptions,
+                                           "storageEngine.wiredTiger.keyedById can't be used "
+                                           "with capped collections");
+        }
+        const bool fieldNameDictionary = wtOptions["fieldNameDictionary"].trueValue();
+        if (fieldNameDictionary && (options.capped || NamespaceString::oplog(ns))) {
+            return StatusWith<std::string>(ErrorCodes::InvalidOptions,
+                                           "storageEngine.wiredTiger.fieldNameDictionary can't "
+                                           "be used with capped collections");
+        }
+
         if ( NamespaceString::oplog(ns) ) {
             // force file for oplog
             ss << "type=file,";
@@ -159,15 +611,33 @@ namespace {
         ss << "key_format=q,value_format=u";
 
         // Record store metadata
-        ss << ",app_metadata=(formatVersion=" << kCurrentRecordStoreVersion;
+        ss << ",app_metadata=(formatVersion="
+           << (keyedById || fieldNameDictionary ? kKeyedByIdRecordStoreVersion
+                                                : kCurrentRecordStoreVersion);
         if (NamespaceString::oplog(ns)) {
             ss << ",oplogKeyExtractionVersion=1";
         }
+        if (keyedById) {
+            ss << ",idKeyExtractionVersion=1";
+        }
+        if (fieldNameDictionary) {
+            ss << ",fieldNameDictionaryVersion=1";
+        }
         ss << ")";
 
         return StatusWith<std::string>(ss);
     }
 
+    // static
+    std::string WiredTigerRecordStore::fieldNamesUri(StringData uri) {
+        return uri.toString() + kFieldNamesSuffix;
+    }
+
+    // static
+    bool WiredTigerRecordStore::isFieldNamesIdent(StringData ident) {
+        return ident.endsWith(kFieldNamesSuffix);
+    }
+
     WiredTigerRecordStore::WiredTigerRecordStore(OperationContext* ctx,
                                                  StringData ns,
                                                  StringData uri,
@@ -187,8 +657,8 @@ namespace {
               _cappedDeleteCallback( cappedDeleteCallback ),
               _cappedDeleteCheckCount(0),
               _useOplogHack(shouldUseOplogHack(ctx, _uri)),
+              _keyedById(shouldKeyById(ctx, _uri)),
               _sizeStorer( sizeStorer ),
-              _sizeStorerCounter(0),
               _shuttingDown(false)
     {
         Status versionStatus = WiredTigerUtil::checkApplicationMetadataFormatVersion(
@@ -197,6 +667,15 @@ namespace {
             fassertFailedWithStatusNoTrace(28548, versionStatus);
         }
 
+        if (shouldUseFieldNameDictionary(ctx, _uri)) {
+            // Every token has to be known before the first record is read.
+            FieldNameStore* store =
+                new FieldNameStore(WiredTigerRecoveryUnit::get(ctx)->getSessionCache(),
+                                   fieldNamesUri(_uri));
+            _fieldNames.reset(new FieldNameDictionary(store));
+            store->createAndLoad(_fieldNames.get());
+        }
+
         if (_isCapped) {
             invariant(_cappedMaxSize > 0);
             invariant(_cappedMaxDocs == -1 || _cappedMaxDocs > 0);
@@ -220,7 +699,6 @@ namespace {
         else {
             RecordId maxLoc = iterator->curr();
             int64_t max = _makeKey( maxLoc );
-            _oplog_highestSeen = maxLoc;
             _nextIdNum.store( 1 + max );
 
             if ( _sizeStorer ) {
@@ -252,7 +730,23 @@ namespace {
 
         }
 
+        if ( _isCapped ) {
+            // Oplog entries come with their own RecordIds, other capped inserts reserve the
+            // next one.
+            _cappedVisibility.reset(
+                new WiredTigerCappedVisibility( !_useOplogHack, RecordId( _nextIdNum.load() ) ) );
+            if ( _nextIdNum.load() > 1 ) {
+                _cappedVisibility->noteInserted( RecordId( _nextIdNum.load() - 1 ) );
+            }
+        }
+
         _hasBackgroundThread = WiredTigerKVEngine::initRsOplogBackgroundThread(ns);
+
+        if (_isOplog && _hasBackgroundThread) {
+            // The background thread truncates the oplog a stone at a time, so inserts don't need
+            // to delete anything.
+            _oplogStones.reset(new OplogStones(ctx, this));
+        }
     }
 
     WiredTigerRecordStore::~WiredTigerRecordStore() {
@@ -322,6 +816,19 @@ namespace {
         int ret = cursor->get_value(cursor.get(), &value);
         invariantWTOK(ret);
 
+        if (_fieldNames) {
+            BufBuilder bson(bsonSize(_fieldNames.get(), value));
+            Status status = _fieldNames->decode(static_cast<const char*>(value.data), value.size,
+                                                &bson);
+            if (!status.isOK()) {
+                msgasserted(28716, str::stream() << "can't read record in " << ns() << ": "
+                                                 << status.reason());
+            }
+            SharedBuffer data = SharedBuffer::allocate(bson.len());
+            memcpy(data.get(), bson.buf(), bson.len());
+            return RecordData(data, bson.len());
+        }
+
         SharedBuffer data = SharedBuffer::allocate(value.size);
         memcpy( data.get(), value.data, value.size );
         return RecordData(data, value.size);
@@ -360,15 +867,17 @@ namespace {
         WT_CURSOR *c = cursor.get();
         c->set_key(c, _makeKey(loc));
         int ret = WT_OP_CHECK(c->search(c));
+        _noteIfWriteConflict(ret, loc);
         invariantWTOK(ret);
 
         WT_ITEM old_value;
         ret = c->get_value(c, &old_value);
         invariantWTOK(ret);
 
-        int old_length = old_value.size;
+        int old_length = bsonSize(_fieldNames.get(), old_value);
 
         ret = WT_OP_CHECK(c->remove(c));
+        _noteIfWriteConflict(ret, loc);
         invariantWTOK(ret);
 
         _changeNumRecords(txn, -1);
@@ -395,6 +904,11 @@ namespace {
         // This variable isn't thread safe, but has loose semantics anyway.
         dassert( !_isOplog || _cappedMaxDocs == -1 );
 
+        if (_oplogStones) {
+            // The background thread truncates whole stones; see reclaimOplog().
+            return 0;
+        }
+
         if (!cappedAndNeedDelete())
             return 0;
 
@@ -546,6 +1060,74 @@ namespace {
         return docsRemoved;
     }
 
+    int64_t WiredTigerRecordStore::reclaimOplog(OperationContext* txn) {
+        invariant(_oplogStones);
+
+        int64_t recordsRemoved = 0;
+        OplogStones::Stone stone;
+        while (!_shuttingDown && _oplogStones->peekOldestStoneIfNeeded(&stone)) {
+            LOG(1) << "truncating " << ns() << " through " << stone.lastRecord << " to remove "
+                   << stone.records << " records totaling " << stone.bytes << " bytes";
+
+            Timer timer;
+            try {
+                WriteUnitOfWork wuow(txn);
+
+                WT_SESSION* session =
+                    WiredTigerRecoveryUnit::get(txn)->getSession(txn)->getSession();
+                WiredTigerCursor stopWrap( _uri, _instanceId, true, txn);
+                WT_CURSOR* stop = stopWrap.get();
+                stop->set_key(stop, _makeKey(stone.lastRecord));
+                invariantWTOK(WT_OP_CHECK(session->truncate(session, NULL, NULL, stop, NULL)));
+
+                _changeNumRecords(txn, -stone.records);
+                _increaseDataSize(txn, -stone.bytes);
+                wuow.commit();
+            }
+            catch (const WriteConflictException& wce) {
+                LOG(1) << "got conflict truncating " << ns() << ", will try again later";
+                break;
+            }
+
+            _oplogStones->popOldestStone();
+            recordsRemoved += stone.records;
+
+            const long long micros = timer.micros();
+            oplogStonesTruncations.addAndFetch(1);
+            oplogStonesTotalTruncateMicros.addAndFetch(micros);
+            oplogStonesLastTruncateMicros.store(micros);
+        }
+
+        return recordsRemoved;
+    }
+
+    // static
+    void WiredTigerRecordStore::appendOplogStonesStats(BSONObjBuilder* b) {
+        b->appendNumber("stones", oplogStonesCount.load());
+        b->appendNumber("truncations", oplogStonesTruncations.load());
+        b->appendNumber("totalTruncateMicros", oplogStonesTotalTruncateMicros.load());
+        b->appendNumber("lastTruncateMicros", oplogStonesLastTruncateMicros.load());
+    }
+
+    class WiredTigerRecordStore::CappedInsertChange : public RecoveryUnit::Change {
+    public:
+        CappedInsertChange( WiredTigerRecordStore* rs, int64_t ticket )
+            : _rs( rs ), _ticket( ticket ) {
+        }
+
+        virtual void commit() {
+            _rs->_cappedVisibility->finish( _ticket );
+        }
+
+        virtual void rollback() {
+            _rs->_cappedVisibility->finish( _ticket );
+        }
+
+    private:
+        WiredTigerRecordStore* _rs;
+        const int64_t _ticket;
+    };
+
     StatusWith<RecordId> WiredTigerRecordStore::extractAndCheckLocForOplog(const char* data,
                                                                            int len) {
         return oploghack::extractKey(data, len);
@@ -566,29 +1148,56 @@ namespace {
             if (!status.isOK())
                 return status;
             loc = status.getValue();
-            if ( loc > _oplog_highestSeen ) {
-                boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-                if ( loc > _oplog_highestSeen ) {
-                    _oplog_highestSeen = loc;
-                }
-            }
+            if ( _cappedVisibility )
+                _cappedVisibility->noteInserted( loc );
         }
         else if ( _isCapped ) {
-            boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-            loc = _nextId();
-            _addUncommitedDiskLoc_inlock( txn, loc );
+            loc = _cappedVisibility->reserve();
+            txn->recoveryUnit()->registerChange( new CappedInsertChange( this, loc.repr() ) );
+        }
+        else if ( _keyedById ) {
+            StatusWith<RecordId> status = idkeys::extractKey(data, len);
+            if (!status.isOK())
+                return status;
+            loc = status.getValue();
         }
         else {
             loc = _nextId();
         }
 
+        BufBuilder encoded;
+        const char* stored = data;
+        int storedLen = len;
+        if ( _fieldNames ) {
+            Status status = _fieldNames->encode(BSONObj(data), &encoded);
+            if (!status.isOK())
+                return StatusWith<RecordId>(status);
+            stored = encoded.buf();
+            storedLen = encoded.len();
+        }
+
         WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
         curwrap.assertInActiveTxn();
         WT_CURSOR *c = curwrap.get();
         invariant( c );
 
         c->set_key(c, _makeKey(loc));
-        WiredTigerItem value(data, len);
+        if ( _keyedById ) {
+            // Record store cursors overwrite, so a second document with the same _id would
+            // replace the first instead of failing like it does in the _id index.
+            int ret = WT_OP_CHECK(c->search(c));
+            if (ret == 0) {
+                return StatusWith<RecordId>(ErrorCodes::DuplicateKey, str::stream()
+                                            << "E11000 duplicate key error collection: " << ns()
+                                            << " for the RecordId of its _id");
+            }
+            if (ret != WT_NOTFOUND) {
+                return StatusWith<RecordId>(wtRCToStatus(ret,
+                                                         "WiredTigerRecordStore::insertRecord"));
+            }
+            c->set_key(c, _makeKey(loc));
+        }
+        WiredTigerItem value(stored, storedLen);
         c->set_value(c, value.Get());
         int ret = WT_OP_CHECK(c->insert(c));
         if (ret) {
@@ -598,26 +1207,65 @@ namespace {
         _changeNumRecords( txn, 1 );
         _increaseDataSize( txn, len );
 
-        cappedDeleteAsNeeded(txn, loc);
+        if ( _oplogStones ) {
+            _oplogStones->updateCurrentStoneAfterInsertOnCommit( txn, len, loc );
+        }
+        else {
+            cappedDeleteAsNeeded(txn, loc);
+        }
 
         return StatusWith<RecordId>( loc );
     }
 
-    void WiredTigerRecordStore::dealtWithCappedLoc( const RecordId& loc ) {
-        boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-        SortedDiskLocs::iterator it = std::find(_uncommittedDiskLocs.begin(),
-                                                _uncommittedDiskLocs.end(),
-                                                loc);
-        invariant(it != _uncommittedDiskLocs.end());
-        _uncommittedDiskLocs.erase(it);
+    Status WiredTigerRecordStore::insertRecords( OperationContext* txn,
+                                                 const std::vector<BSONObj>& docs,
+                                                 std::vector<RecordId>* locs,
+                                                 bool enforceQuota ) {
+        // Capped collections and the oplog track each uncommitted insert individually.
+        if ( _isCapped || _useOplogHack || _keyedById || _fieldNames || docs.size() < 2 ) {
+            return RecordStore::insertRecords( txn, docs, locs, enforceQuota );
+        }
+
+        const RecordId first = _nextIds( docs.size() );
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+
+        locs->reserve( locs->size() + docs.size() );
+        int pendingLength = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            if ( pendingLength > std::numeric_limits<int>::max() - docs[i].objsize() ) {
+                _increaseDataSize( txn, pendingLength );
+                pendingLength = 0;
+            }
+
+            const RecordId loc( first.repr() + i );
+            c->set_key(c, _makeKey(loc));
+            WiredTigerItem value(docs[i].objdata(), docs[i].objsize());
+            c->set_value(c, value.Get());
+            int ret = WT_OP_CHECK(c->insert(c));
+            if (ret) {
+                return wtRCToStatus(ret, "WiredTigerRecordStore::insertRecords");
+            }
+            locs->push_back( loc );
+            pendingLength += docs[i].objsize();
+        }
+
+        _changeNumRecords( txn, docs.size() );
+        _increaseDataSize( txn, pendingLength );
+
+        return Status::OK();
     }
 
     bool WiredTigerRecordStore::isCappedHidden( const RecordId& loc ) const {
-        boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-        if (_uncommittedDiskLocs.empty()) {
+        if ( !_cappedVisibility ) {
+            // Still in the constructor, when nothing can be uncommitted.
             return false;
         }
-        return _uncommittedDiskLocs.front() <= loc;
+        RecordId oldest = _cappedVisibility->oldestUncommitted();
+        return !oldest.isNull() && oldest <= loc;
     }
 
     StatusWith<RecordId> WiredTigerRecordStore::insertRecord( OperationContext* txn,
@@ -637,24 +1285,46 @@ namespace {
                                                               int len,
                                                               bool enforceQuota,
                                                               UpdateNotifier* notifier ) {
+        if ( _keyedById ) {
+            StatusWith<RecordId> key = idkeys::extractKey(data, len);
+            if (!key.isOK() || key.getValue() != loc) {
+                return StatusWith<RecordId>(ErrorCodes::ImmutableField,
+                                            "can't change the _id of a document in a "
+                                            "collection keyed by _id");
+            }
+        }
+
         WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
         curwrap.assertInActiveTxn();
         WT_CURSOR *c = curwrap.get();
         invariant( c );
         c->set_key(c, _makeKey(loc));
         int ret = WT_OP_CHECK(c->search(c));
+        _noteIfWriteConflict(ret, loc);
         invariantWTOK(ret);
 
         WT_ITEM old_value;
         ret = c->get_value(c, &old_value);
         invariantWTOK(ret);
 
-        int old_length = old_value.size;
+        int old_length = bsonSize(_fieldNames.get(), old_value);
+
+        BufBuilder encoded;
+        const char* stored = data;
+        int storedLen = len;
+        if ( _fieldNames ) {
+            Status status = _fieldNames->encode(BSONObj(data), &encoded);
+            if (!status.isOK())
+                return StatusWith<RecordId>(status);
+            stored = encoded.buf();
+            storedLen = encoded.len();
+        }
 
         c->set_key(c, _makeKey(loc));
-        WiredTigerItem value(data, len);
+        WiredTigerItem value(stored, storedLen);
         c->set_value(c, value.Get());
         ret = WT_OP_CHECK(c->insert(c));
+        _noteIfWriteConflict(ret, loc);
         invariantWTOK(ret);
 
         _increaseDataSize(txn, len - old_length);
@@ -665,7 +1335,8 @@ namespace {
     }
 
     bool WiredTigerRecordStore::updateWithDamagesSupported() const {
-        return false;
+        // Damages are offsets into the BSON, which isn't what a field name dictionary stores.
+        return !_fieldNames;
     }
 
     Status WiredTigerRecordStore::updateWithDamages( OperationContext* txn,
@@ -673,17 +1344,37 @@ namespace {
                                                      const RecordData& oldRec,
                                                      const char* damageSource,
                                                      const mutablebson::DamageVector& damages ) {
-        invariant(false);
+        // WiredTiger can't overwrite part of a value, so the damages are applied to a copy of
+        // the old record, which is then written whole.  The caller still gets to skip building
+        // a new document and updating indexes.  The size of the record doesn't change.
+        const int len = oldRec.size();
+        boost::scoped_array<char> data( new char[len] );
+        memcpy( data.get(), oldRec.data(), len );
+
+        mutablebson::DamageVector::const_iterator where = damages.begin();
+        const mutablebson::DamageVector::const_iterator end = damages.end();
+        for( ; where != end; ++where ) {
+            const char* sourcePtr = damageSource + where->sourceOffset;
+            char* targetPtr = data.get() + where->targetOffset;
+            memcpy( targetPtr, sourcePtr, where->size );
+        }
+
+        WiredTigerCursor curwrap( _uri, _instanceId, true, txn);
+        curwrap.assertInActiveTxn();
+        WT_CURSOR *c = curwrap.get();
+        invariant( c );
+        c->set_key(c, _makeKey(loc));
+        WiredTigerItem value(data.get(), len);
+        c->set_value(c, value.Get());
+        int ret = WT_OP_CHECK(c->insert(c));
+        _noteIfWriteConflict(ret, loc);
+        invariantWTOK(ret);
+
+        return Status::OK();
     }
 
     void WiredTigerRecordStore::_oplogSetStartHack( WiredTigerRecoveryUnit* wru ) const {
-        boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-        if ( _uncommittedDiskLocs.empty() ) {
-            wru->setOplogReadTill( _oplog_highestSeen );
-        }
-        else {
-            wru->setOplogReadTill( _uncommittedDiskLocs.front() );
-        }
+        wru->setOplogReadTill( _cappedVisibility->oplogReadTill() );
     }
 
     RecordIterator* WiredTigerRecordStore::getIterator(
@@ -730,6 +1421,10 @@ namespace {
         _changeNumRecords(txn, -numRecords(txn));
         _increaseDataSize(txn, -dataSize(txn));
 
+        if (_oplogStones) {
+            _oplogStones->clearStonesOnCommit(txn);
+        }
+
         return Status::OK();
     }
 
@@ -843,6 +1538,11 @@ namespace {
             }
         }
 
+        if (_fieldNames) {
+            bob.append("fieldNameDictionary",
+                       BSON("names" << static_cast<int>(_fieldNames->size())));
+        }
+
         std::string type, sourceURI;
         WiredTigerUtil::fetchTypeAndSourceURI(txn, _uri, &type, &sourceURI);
         StatusWith<std::string> metadataResult = WiredTigerUtil::getMetadata(txn, sourceURI);
@@ -875,38 +1575,14 @@ namespace {
         if ( !loc.isOK() )
             return loc.getStatus();
 
-        boost::lock_guard<boost::mutex> lk( _uncommittedDiskLocsMutex );
-        _addUncommitedDiskLoc_inlock( txn, loc.getValue() );
-        return Status::OK();
-    }
-
-    class WiredTigerRecordStore::CappedInsertChange : public RecoveryUnit::Change {
-    public:
-        CappedInsertChange( WiredTigerRecordStore* rs, const RecordId& loc )
-            : _rs( rs ), _loc( loc ) {
-        }
-
-        virtual void commit() {
-            _rs->dealtWithCappedLoc( _loc );
-        }
-
-        virtual void rollback() {
-            _rs->dealtWithCappedLoc( _loc );
+        if ( !_useOplogHack ) {
+            // Inserts pick their own RecordIds, and track them as they do.
+            return Status::OK();
         }
 
-    private:
-        WiredTigerRecordStore* _rs;
-        RecordId _loc;
-    };
-
-    void WiredTigerRecordStore::_addUncommitedDiskLoc_inlock( OperationContext* txn,
-                                                              const RecordId& loc ) {
-        // todo: make this a dassert at some point
-        invariant( _uncommittedDiskLocs.empty() ||
-                   _uncommittedDiskLocs.back() < loc );
-        _uncommittedDiskLocs.push_back( loc );
-        txn->recoveryUnit()->registerChange( new CappedInsertChange( this, loc ) );
-        _oplog_highestSeen = loc;
+        int64_t ticket = _cappedVisibility->registerRecordId( loc.getValue() );
+        txn->recoveryUnit()->registerChange( new CappedInsertChange( this, ticket ) );
+        return Status::OK();
     }
 
     boost::optional<RecordId> WiredTigerRecordStore::oplogStartHack(
@@ -952,6 +1628,14 @@ namespace {
         return out;
     }
 
+    RecordId WiredTigerRecordStore::_nextIds(int64_t n) {
+        invariant(!_useOplogHack);
+        RecordId out = RecordId(_nextIdNum.fetchAndAdd(n));
+        invariant(out.isNormal());
+        invariant(RecordId(out.repr() + n - 1).isNormal());
+        return out;
+    }
+
     WiredTigerRecoveryUnit* WiredTigerRecordStore::_getRecoveryUnit( OperationContext* txn ) {
         return checked_cast<WiredTigerRecoveryUnit*>( txn->recoveryUnit() );
     }
@@ -1004,15 +1688,17 @@ namespace {
                 _dataSize.store( 0 );
             }
         }
-
-        if ( _sizeStorer && _sizeStorerCounter++ % 1000 == 0 ) {
-            _sizeStorer->storeToCache( _uri, _numRecords.load(), _dataSize.load() );
-        }
     }
 
     int64_t WiredTigerRecordStore::_makeKey( const RecordId& loc ) {
         return loc.repr();
     }
+
+    void WiredTigerRecordStore::_noteIfWriteConflict( int ret, const RecordId& loc ) const {
+        if ( ret == WT_ROLLBACK ) {
+            WriteConflictException::noteConflictingRecord( ns(), loc );
+        }
+    }
     RecordId WiredTigerRecordStore::_fromKey( int64_t key ) {
         return RecordId(key);
     }
@@ -1173,7 +1859,13 @@ namespace {
         // the cursor and recoveryUnit are valid on restore
         // so we just record the recoveryUnit to make sure
         _savedRecoveryUnit = _txn->recoveryUnit();
-        if ( _cursor && !wt_keeptxnopen() ) {
+        _savedSnapshotId = SnapshotId();
+        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(_txn);
+        if ( _cursor && ru->inActiveTxn() && WiredTigerRecoveryUnit::snapshotsOutliveBatches() ) {
+            // Keep our position in case the snapshot is still open when we are restored.
+            _savedSnapshotId = ru->getSnapshotId();
+        }
+        else if ( _cursor ) {
             try {
                 _cursor->reset();
             }
@@ -1212,7 +1904,10 @@ namespace {
         }
 
         invariant( _savedRecoveryUnit == txn->recoveryUnit() );
-        if ( needRestore || !wt_keeptxnopen() ) {
+        WiredTigerRecoveryUnit* ru = WiredTigerRecoveryUnit::get(txn);
+        const bool sameSnapshot = !_savedSnapshotId.isNull() && ru->inActiveTxn() &&
+            ru->getSnapshotId() == _savedSnapshotId;
+        if ( needRestore || !sameSnapshot ) {
             // This will ensure an active session exists, so any restored cursors will bind to it
             invariant(WiredTigerRecoveryUnit::get(txn)->getSession(txn) == _cursor->getSession());
 
@@ -1258,17 +1953,46 @@ namespace {
         }
     }
 
+    RecordData WiredTigerRecordStore::Iterator::dataForPinned( const RecordId& loc ) const {
+        if (loc != _loc || _rs._fieldNames) {
+            return dataFor(loc);
+        }
+
+        dassert(loc == _curr());
+        // The value stays valid until the cursor moves or is reset.
+        WT_CURSOR *c = _cursor->get();
+        WT_ITEM value;
+        int ret = c->get_value(c, &value);
+        invariantWTOK(ret);
+        return RecordData(static_cast<const char*>(value.data), value.size);
+    }
+
     void WiredTigerRecordStore::temp_cappedTruncateAfter( OperationContext* txn,
                                                           RecordId end,
                                                           bool inclusive ) {
         WriteUnitOfWork wuow(txn);
         boost::scoped_ptr<RecordIterator> iter( getIterator( txn, end ) );
+        RecordId firstRemoved;
+        int64_t recordsRemoved = 0;
+        int64_t bytesRemoved = 0;
         while( !iter->isEOF() ) {
             RecordId loc = iter->getNext();
             if ( end < loc || ( inclusive && end == loc ) ) {
+                if ( _oplogStones ) {
+                    if ( recordsRemoved == 0 )
+                        firstRemoved = loc;
+                    recordsRemoved++;
+                    bytesRemoved += iter->dataFor( loc ).size();
+                }
                 deleteRecord( txn, loc );
             }
         }
         wuow.commit();
+
+        if ( _oplogStones && recordsRemoved > 0 ) {
+            _oplogStones->updateStonesAfterCappedTruncateAfter( recordsRemoved,
+                                                                bytesRemoved,
+                                                                firstRemoved );
+        }
     }
 }
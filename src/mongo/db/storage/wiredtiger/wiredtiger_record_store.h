@@ -40,6 +40,7 @@
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/capped_callback.h"
+#include "mongo/db/storage/snapshot.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/fail_point_service.h"
 
@@ -51,7 +52,9 @@
 
 namespace mongo {
 
+    class FieldNameDictionary;
     class RecoveryUnit;
+    class WiredTigerCappedVisibility;
     class WiredTigerCursor;
     class WiredTigerRecoveryUnit;
     class WiredTigerSizeStorer;
@@ -90,6 +93,18 @@ namespace mongo {
                                                             const CollectionOptions &options,
                                                             StringData extraStrings);
 
+        /**
+         * The table that keeps the field name dictionary of the record store at 'uri', for
+         * record stores created with storageEngine.wiredTiger.fieldNameDictionary.
+         */
+        static std::string fieldNamesUri(StringData uri);
+
+        /**
+         * Whether 'ident' is the table of a field name dictionary rather than a record store or
+         * an index of its own.
+         */
+        static bool isFieldNamesIdent(StringData ident);
+
         WiredTigerRecordStore(OperationContext* txn,
                               StringData ns,
                               StringData uri,
@@ -131,6 +146,11 @@ namespace mongo {
                                                   const DocWriter* doc,
                                                   bool enforceQuota );
 
+        virtual Status insertRecords( OperationContext* txn,
+                                      const std::vector<BSONObj>& docs,
+                                      std::vector<RecordId>* locs,
+                                      bool enforceQuota );
+
         virtual StatusWith<RecordId> updateRecord( OperationContext* txn,
                                                   const RecordId& oldLocation,
                                                   const char* data,
@@ -188,6 +208,8 @@ namespace mongo {
                                             long long numRecords,
                                             long long dataSize);
 
+        virtual bool keyedById() const { return _keyedById; }
+
         bool isOplog() const { return _isOplog; }
         bool usingOplogHack() const { return _useOplogHack; }
 
@@ -202,7 +224,6 @@ namespace mongo {
 
         void setSizeStorer( WiredTigerSizeStorer* ss ) { _sizeStorer = ss; }
 
-        void dealtWithCappedLoc( const RecordId& loc );
         bool isCappedHidden( const RecordId& loc ) const;
 
         bool inShutdown() const;
@@ -213,6 +234,25 @@ namespace mongo {
                                             const RecordId& justInserted);
 
         boost::timed_mutex& cappedDeleterMutex() { return _cappedDeleterMutex; }
+
+        /**
+         * True for an oplog that the background thread truncates a stone at a time, rather than
+         * deleting its oldest records as it goes.
+         */
+        bool usingOplogStones() const { return _oplogStones.get() != NULL; }
+
+        /**
+         * Truncates the oldest stones of the oplog for as long as the remaining ones are enough
+         * to hold cappedMaxSize() bytes. Must be called with cappedDeleterMutex() held.
+         * Returns the approximate number of records removed.
+         */
+        int64_t reclaimOplog(OperationContext* txn);
+
+        /**
+         * Appends the number of oplog stones and how long truncating them has taken.
+         */
+        static void appendOplogStonesStats(BSONObjBuilder* b);
+
     private:
 
         class Iterator : public RecordIterator {
@@ -232,6 +272,7 @@ namespace mongo {
             virtual void saveState();
             virtual bool restoreState(OperationContext *txn);
             virtual RecordData dataFor( const RecordId& loc ) const;
+            virtual RecordData dataForPinned( const RecordId& loc ) const;
 
         private:
             void _getNext();
@@ -241,6 +282,7 @@ namespace mongo {
             const WiredTigerRecordStore& _rs;
             OperationContext* _txn;
             RecoveryUnit* _savedRecoveryUnit; // only used to sanity check between save/restore
+            SnapshotId _savedSnapshotId; // set if _cursor kept its position when saved
             const bool _forward;
             bool _forParallelCollectionScan;
             boost::scoped_ptr<WiredTigerCursor> _cursor;
@@ -254,20 +296,30 @@ namespace mongo {
         class CappedInsertChange;
         class NumRecordsChange;
         class DataSizeChange;
+        class OplogStones;
+        class FieldNameStore;
 
         static WiredTigerRecoveryUnit* _getRecoveryUnit( OperationContext* txn );
 
         static int64_t _makeKey(const RecordId &loc);
         static RecordId _fromKey(int64_t k);
 
-        void _addUncommitedDiskLoc_inlock( OperationContext* txn, const RecordId& loc );
-
         RecordId _nextId();
+
+        /**
+         * Reserves 'n' consecutive ids and returns the first.
+         */
+        RecordId _nextIds(int64_t n);
         void _setId(RecordId loc);
         bool cappedAndNeedDelete() const;
         void _changeNumRecords(OperationContext* txn, int64_t diff);
         void _increaseDataSize(OperationContext* txn, int amount);
         RecordData _getData( const WiredTigerCursor& cursor) const;
+
+        /**
+         * Adds 'loc' to the sample of conflicting records if 'ret' is a write conflict.
+         */
+        void _noteIfWriteConflict( int ret, const RecordId& loc ) const;
         StatusWith<RecordId> extractAndCheckLocForOplog(const char* data, int len);
         void _oplogSetStartHack( WiredTigerRecoveryUnit* wru ) const;
 
@@ -286,21 +338,31 @@ namespace mongo {
 
         const bool _useOplogHack;
 
-        typedef std::vector<RecordId> SortedDiskLocs;
-        SortedDiskLocs _uncommittedDiskLocs;
-        RecordId _oplog_visibleTo;
-        RecordId _oplog_highestSeen;
-        mutable boost::mutex _uncommittedDiskLocsMutex;
+        // Created with storageEngine.wiredTiger.keyedById, so that each record is kept at the
+        // RecordId made from its _id instead of at the next one in line.
+        const bool _keyedById;
+
+        // Created with storageEngine.wiredTiger.fieldNameDictionary, so that records are stored
+        // with tokens from this instead of their field names. Sizes are still counted in BSON
+        // bytes.
+        boost::scoped_ptr<FieldNameDictionary> _fieldNames;
+
+        // Tracks uncommitted inserts for capped collections, including the oplog.
+        boost::scoped_ptr<WiredTigerCappedVisibility> _cappedVisibility;
 
         AtomicInt64 _nextIdNum;
         AtomicInt64 _dataSize;
         AtomicInt64 _numRecords;
 
-        WiredTigerSizeStorer* _sizeStorer; // not owned, can be NULL
-        int _sizeStorerCounter;
+        // Not owned, can be NULL. It reads '_numRecords' and '_dataSize' itself when it syncs,
+        // so changing them doesn't involve it.
+        WiredTigerSizeStorer* _sizeStorer;
 
         bool _shuttingDown;
         bool _hasBackgroundThread;
+
+        // Only set for an oplog with a background thread.
+        boost::scoped_ptr<OplogStones> _oplogStones;
     };
 
     // WT failpoint to throw write conflict exceptions randomly
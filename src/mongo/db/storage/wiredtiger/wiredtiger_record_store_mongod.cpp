@@ -100,6 +100,11 @@ namespace mongo {
                     OldClientContext ctx(&txn, _ns, false);
                     WiredTigerRecordStore* rs =
                         checked_cast<WiredTigerRecordStore*>(collection->getRecordStore());
+                    if (rs->usingOplogStones()) {
+                        boost::lock_guard<boost::timed_mutex> lock(rs->cappedDeleterMutex());
+                        return rs->reclaimOplog(&txn);
+                    }
+
                     WriteUnitOfWork wuow(&txn);
                     boost::lock_guard<boost::timed_mutex> lock(rs->cappedDeleterMutex());
                     int64_t removed = rs->cappedDeleteAsNeeded_inlock(&txn, RecordId::max());
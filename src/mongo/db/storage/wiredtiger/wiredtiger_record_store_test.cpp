@@ -40,6 +40,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
+#include "mongo/db/storage/id_keys.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
@@ -89,12 +90,16 @@ namespace mongo {
 
         virtual RecordStore* newNonCappedRecordStore() { return newNonCappedRecordStore("a.b"); }
         RecordStore* newNonCappedRecordStore(const std::string& ns) {
+            return newNonCappedRecordStore(ns, CollectionOptions());
+        }
+        RecordStore* newNonCappedRecordStore(const std::string& ns,
+                                             const CollectionOptions& options) {
             WiredTigerRecoveryUnit* ru = new WiredTigerRecoveryUnit( _sessionCache );
             OperationContextNoop txn( ru );
             string uri = "table:" + ns;
 
             StatusWith<std::string> result =
-                WiredTigerRecordStore::generateCreateString(ns, CollectionOptions(), "");
+                WiredTigerRecordStore::generateCreateString(ns, options, "");
             ASSERT_TRUE(result.isOK());
             std::string config = result.getValue();
 
@@ -138,6 +143,8 @@ namespace mongo {
             return new WiredTigerRecoveryUnit( _sessionCache );
         }
 
+        virtual bool supportsDocLocking() { return true; }
+
         WT_CONNECTION* conn() const { return _conn; }
 
     private:
@@ -371,6 +378,49 @@ namespace mongo {
         rs.reset( NULL ); // this has to be deleted before ss
     }
 
+    // Syncing the size storer writes the current sizes of live record stores, and only writes
+    // each of them again once it has changed.
+    TEST(WiredTigerRecordStoreTest, SizeStorerSyncReadsLiveRecordStores) {
+        scoped_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+        string uri;
+        {
+            scoped_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+            uri = checked_cast<WiredTigerRecordStore*>( rs.get() )->getURI();
+        }
+
+        string sizeStorerUri = "table:sizeStorer";
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri);
+        scoped_ptr<RecordStore> rs;
+        {
+            scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+            rs.reset( new WiredTigerRecordStore( opCtx.get(), "a.b", uri,
+                                                 false, -1, -1, NULL, &ss ) );
+        }
+
+        for ( int round = 1; round <= 2; round++ ) {
+            {
+                scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+                WriteUnitOfWork uow( opCtx.get() );
+                for ( int i = 0; i < 10; i++ ) {
+                    ASSERT_OK( rs->insertRecord( opCtx.get(), "abc", 4, false ).getStatus() );
+                }
+                uow.commit();
+            }
+
+            ss.syncCache(true);
+
+            WiredTigerSizeStorer reader(harnessHelper->conn(), sizeStorerUri);
+            reader.fillCache();
+            long long numRecords;
+            long long dataSize;
+            reader.loadFromCache( uri, &numRecords, &dataSize );
+            ASSERT_EQUALS( 10 * round, numRecords );
+            ASSERT_EQUALS( 40 * round, dataSize );
+        }
+
+        rs.reset( NULL ); // this has to be deleted before ss
+    }
+
 namespace {
 
     class GoodValidateAdaptor : public ValidateAdaptor {
@@ -638,6 +688,191 @@ namespace {
         ASSERT_EQ(rs->oplogStartHack(opCtx.get(), RecordId(0,1)), boost::none);
     }
 
+    TEST(WiredTigerRecordStoreTest, GenerateCreateStringKeyedById) {
+        CollectionOptions options;
+        options.storageEngine = fromjson("{wiredTiger: {keyedById: true}}");
+        StatusWith<std::string> result =
+            WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_OK(result.getStatus());
+        ASSERT_NOT_EQUALS(std::string::npos, result.getValue().find("idKeyExtractionVersion=1"));
+
+        options.capped = true;
+        result = WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_EQUALS(ErrorCodes::InvalidOptions, result.getStatus());
+
+        options.capped = false;
+        options.storageEngine = fromjson("{wiredTiger: {keyedById: 1}}");
+        result = WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_EQUALS(ErrorCodes::TypeMismatch, result.getStatus());
+    }
+
+    TEST(WiredTigerRecordStoreTest, KeyedById) {
+        WiredTigerHarnessHelper harnessHelper;
+        CollectionOptions options;
+        options.storageEngine = fromjson("{wiredTiger: {keyedById: true}}");
+        scoped_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.keyed", options));
+        ASSERT_TRUE(rs->keyedById());
+
+        scoped_ptr<RecordStore> other(harnessHelper.newNonCappedRecordStore("a.other"));
+        ASSERT_FALSE(other->keyedById());
+
+        scoped_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        const BSONObj five = BSON("_id" << 5 << "a" << 1);
+        const RecordId fiveLoc = idkeys::keyForId(five["_id"]).getValue();
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), five.objdata(),
+                                                        five.objsize(), false);
+            ASSERT_OK(res.getStatus());
+            ASSERT_EQ(fiveLoc, res.getValue());
+            wuow.commit();
+        }
+
+        // Another document with an _id equal to 5 has nowhere to go.
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            const BSONObj dup = BSON("_id" << 5.0 << "a" << 2);
+            ASSERT_EQUALS(ErrorCodes::DuplicateKey,
+                          rs->insertRecord(opCtx.get(), dup.objdata(), dup.objsize(), false)
+                              .getStatus());
+        }
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            const BSONObj noKey = BSON("_id" << "five");
+            ASSERT_NOT_OK(rs->insertRecord(opCtx.get(), noKey.objdata(), noKey.objsize(), false)
+                              .getStatus());
+        }
+        ASSERT_EQUALS(five, rs->dataFor(opCtx.get(), fiveLoc).toBson());
+        ASSERT_EQUALS(1, rs->numRecords(opCtx.get()));
+
+        // Batches of inserts are keyed the same way.
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            std::vector<BSONObj> docs;
+            docs.push_back(BSON("_id" << 7));
+            docs.push_back(BSON("_id" << -3LL));
+            std::vector<RecordId> locs;
+            ASSERT_OK(rs->insertRecords(opCtx.get(), docs, &locs, false));
+            ASSERT_EQUALS(2U, locs.size());
+            ASSERT_EQ(idkeys::keyForId(docs[0]["_id"]).getValue(), locs[0]);
+            ASSERT_EQ(idkeys::keyForId(docs[1]["_id"]).getValue(), locs[1]);
+            wuow.commit();
+        }
+
+        // Records keep their RecordIds on update, so the _id can't change.
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            const BSONObj updated = BSON("_id" << 5 << "a" << 3 << "b" << 4);
+            StatusWith<RecordId> res = rs->updateRecord(opCtx.get(), fiveLoc, updated.objdata(),
+                                                        updated.objsize(), false, NULL);
+            ASSERT_OK(res.getStatus());
+            ASSERT_EQ(fiveLoc, res.getValue());
+
+            const BSONObj moved = BSON("_id" << 6 << "a" << 3);
+            ASSERT_EQUALS(ErrorCodes::ImmutableField,
+                          rs->updateRecord(opCtx.get(), fiveLoc, moved.objdata(),
+                                           moved.objsize(), false, NULL).getStatus());
+            wuow.commit();
+        }
+        ASSERT_EQUALS(BSON("_id" << 5 << "a" << 3 << "b" << 4),
+                      rs->dataFor(opCtx.get(), fiveLoc).toBson());
+
+        // A scan returns the documents in _id order.
+        scoped_ptr<RecordIterator> it(rs->getIterator(opCtx.get()));
+        ASSERT_EQUALS(-3, it->dataFor(it->getNext()).toBson()["_id"].numberInt());
+        ASSERT_EQUALS(5, it->dataFor(it->getNext()).toBson()["_id"].numberInt());
+        ASSERT_EQUALS(7, it->dataFor(it->getNext()).toBson()["_id"].numberInt());
+        ASSERT_TRUE(it->isEOF());
+    }
+
+    TEST(WiredTigerRecordStoreTest, GenerateCreateStringFieldNameDictionary) {
+        CollectionOptions options;
+        options.storageEngine = fromjson("{wiredTiger: {fieldNameDictionary: true}}");
+        StatusWith<std::string> result =
+            WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_OK(result.getStatus());
+        ASSERT_NOT_EQUALS(std::string::npos,
+                          result.getValue().find("fieldNameDictionaryVersion=1"));
+
+        options.capped = true;
+        result = WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_EQUALS(ErrorCodes::InvalidOptions, result.getStatus());
+
+        options.capped = false;
+        options.storageEngine = fromjson("{wiredTiger: {fieldNameDictionary: 'yes'}}");
+        result = WiredTigerRecordStore::generateCreateString("a.b", options, "");
+        ASSERT_EQUALS(ErrorCodes::TypeMismatch, result.getStatus());
+
+        ASSERT_TRUE(WiredTigerRecordStore::isFieldNamesIdent(
+            WiredTigerRecordStore::fieldNamesUri("collection-1-2")));
+        ASSERT_FALSE(WiredTigerRecordStore::isFieldNamesIdent("collection-1-2"));
+    }
+
+    TEST(WiredTigerRecordStoreTest, FieldNameDictionary) {
+        WiredTigerHarnessHelper harnessHelper;
+        CollectionOptions options;
+        options.storageEngine = fromjson("{wiredTiger: {fieldNameDictionary: true}}");
+        scoped_ptr<RecordStore> rs(harnessHelper.newNonCappedRecordStore("a.dict", options));
+        ASSERT_FALSE(rs->updateWithDamagesSupported());
+
+        scoped_ptr<OperationContext> opCtx(harnessHelper.newOperationContext());
+
+        std::vector<BSONObj> docs;
+        docs.push_back(fromjson("{_id: 1, customerName: 'a', address: {streetName: 'b'}}"));
+        docs.push_back(fromjson("{_id: 2, customerName: 'c', orders: [{quantity: 1}]}"));
+        docs.push_back(fromjson("{_id: 3, address: {streetName: 'd', postalCode: 'e'}}"));
+        std::vector<RecordId> locs;
+        long long bsonBytes = 0;
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            ASSERT_OK(rs->insertRecords(opCtx.get(), docs, &locs, false));
+            wuow.commit();
+        }
+        for (size_t i = 0; i < docs.size(); i++) {
+            ASSERT_EQUALS(docs[i], rs->dataFor(opCtx.get(), locs[i]).toBson());
+            bsonBytes += docs[i].objsize();
+        }
+        // Sizes are counted in BSON bytes, not in what is stored.
+        ASSERT_EQUALS(bsonBytes, rs->dataSize(opCtx.get()));
+
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            const BSONObj updated = fromjson("{_id: 2, customerName: 'c', newField: 5}");
+            ASSERT_OK(rs->updateRecord(opCtx.get(), locs[1], updated.objdata(),
+                                       updated.objsize(), false, NULL).getStatus());
+            rs->deleteRecord(opCtx.get(), locs[0]);
+            wuow.commit();
+            bsonBytes += updated.objsize() - docs[1].objsize() - docs[0].objsize();
+            docs[1] = updated;
+        }
+        ASSERT_EQUALS(bsonBytes, rs->dataSize(opCtx.get()));
+
+        {
+            scoped_ptr<RecordIterator> it(rs->getIterator(opCtx.get()));
+            ASSERT_EQUALS(docs[1], it->dataForPinned(it->getNext()).toBson());
+            ASSERT_EQUALS(docs[2], it->dataFor(it->getNext()).toBson());
+            ASSERT_TRUE(it->isEOF());
+        }
+
+        // A record store opened later reads the same documents with the saved tokens, and adds
+        // to them.
+        rs.reset();
+        rs.reset(new WiredTigerRecordStore(opCtx.get(), "a.dict", "table:a.dict"));
+        ASSERT_EQUALS(docs[1], rs->dataFor(opCtx.get(), locs[1]).toBson());
+        ASSERT_EQUALS(docs[2], rs->dataFor(opCtx.get(), locs[2]).toBson());
+        ASSERT_EQUALS(bsonBytes, rs->dataSize(opCtx.get()));
+        {
+            WriteUnitOfWork wuow(opCtx.get());
+            const BSONObj doc = fromjson("{_id: 4, customerName: 'f', anotherField: 6}");
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), doc.objdata(), doc.objsize(), false);
+            ASSERT_OK(res.getStatus());
+            wuow.commit();
+            ASSERT_EQUALS(doc, rs->dataFor(opCtx.get(), res.getValue()).toBson());
+        }
+    }
+
     TEST(WiredTigerRecordStoreTest, CappedOrder) {
         scoped_ptr<WiredTigerHarnessHelper> harnessHelper( new WiredTigerHarnessHelper() );
         scoped_ptr<RecordStore> rs(harnessHelper->newCappedRecordStore("a.b", 100000,10000));
@@ -37,14 +37,22 @@
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/json.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/util/concurrency/fair_ticket_queue.h"
+#include "mongo/util/concurrency/ticket_pool_controller.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -88,7 +96,8 @@ namespace mongo {
         _everStartedWrite( false ),
         _currentlySquirreled( false ),
         _syncing( false ),
-        _noTicketNeeded( false ) {
+        _noTicketNeeded( false ),
+        _ticketQueue( NULL ) {
     }
 
     WiredTigerRecoveryUnit::~WiredTigerRecoveryUnit() {
@@ -98,6 +107,7 @@ namespace mongo {
             _sessionCache->releaseSession( _session );
             _session = NULL;
         }
+        _releaseTicket();
     }
 
     void WiredTigerRecoveryUnit::reportState( BSONObjBuilder* b ) const {
@@ -221,12 +231,151 @@ namespace mongo {
         }
     }
 
+    // How long a read-only snapshot may be kept open between the getMore batches of a cursor,
+    // so the next batch resumes where the last one stopped without repositioning. 0 disables.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCursorPinMillis, int, 0);
+
+    namespace {
+        // Snapshots aren't kept once this much of the cache is in use, as eviction can't free
+        // anything they might still read.
+        const double kCursorPinMaxCacheFill = 0.8;
+        const long long kCachePressureCheckMillis = 1000;
+
+        AtomicInt64 lastCachePressureCheck;
+        AtomicUInt32 cacheUnderPressure;
+
+        AtomicInt64 snapshotsKept;
+        AtomicInt64 snapshotsReleasedIdle;
+
+        /**
+         * Reading the cache statistics opens a cursor, so only one caller a second does it and
+         * everyone else uses the answer it got.
+         */
+        bool isCacheUnderPressure(WT_SESSION* session) {
+            const long long now = curTimeMillis64();
+            const long long last = lastCachePressureCheck.load();
+            if (now - last < kCachePressureCheckMillis ||
+                lastCachePressureCheck.compareAndSwap(last, now) != last) {
+                return cacheUnderPressure.load();
+            }
+
+            StatusWith<uint64_t> inUse = WiredTigerUtil::getStatisticsValue(
+                session, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_INUSE);
+            StatusWith<uint64_t> max = WiredTigerUtil::getStatisticsValue(
+                session, "statistics:", "statistics=(fast)", WT_STAT_CONN_CACHE_BYTES_MAX);
+            const bool underPressure = !inUse.isOK() || !max.isOK() ||
+                inUse.getValue() > kCursorPinMaxCacheFill * max.getValue();
+            cacheUnderPressure.store(underPressure);
+            return underPressure;
+        }
+    }
+
+    bool WiredTigerRecoveryUnit::snapshotsOutliveBatches() {
+        return wiredTigerCursorPinMillis > 0;
+    }
+
+    bool WiredTigerRecoveryUnit::_shouldKeepSnapshot() {
+        const int budgetMillis = wiredTigerCursorPinMillis;
+        return budgetMillis > 0 &&
+            !_everStartedWrite &&
+            _timer.millis() < budgetMillis &&
+            !isCacheUnderPressure(_session->getSession());
+    }
+
+    void WiredTigerRecoveryUnit::endCursorBatch() {
+        invariant(_depth == 0);
+        if (!_active) {
+            return;
+        }
+        if (_shouldKeepSnapshot()) {
+            snapshotsKept.fetchAndAdd(1);
+            return;
+        }
+        _txnClose(false);
+    }
+
+    void WiredTigerRecoveryUnit::releaseIdleSnapshot() {
+        if (!_active || _depth > 0 || _shouldKeepSnapshot()) {
+            return;
+        }
+        snapshotsReleasedIdle.fetchAndAdd(1);
+        _txnClose(false);
+    }
+
     void WiredTigerRecoveryUnit::setOplogReadTill( const RecordId& loc ) {
         _oplogReadTill = loc;
     }
 
+    // When set, the ticket pools are resized between the min and max sizes as throughput and
+    // queueing call for; see adjustTicketPools().
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTickets, bool, false);
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketsMin, int, 16);
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerAdaptiveTicketsMax, int, 1024);
+
+    // When set, operations that find no free ticket queue per database, and the databases are
+    // served by weighted fair queuing; see wiredTigerTicketWeights.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerFairTicketScheduling, bool, false);
+
     namespace {
 
+        /**
+         * The share of the tickets given to each database while operations queue for them, as a
+         * document like { premium : 4, analytics : 0.5 }. Databases left out have weight 1.
+         */
+        class TicketWeightsParameter : public ServerParameter {
+            MONGO_DISALLOW_COPYING(TicketWeightsParameter);
+        public:
+            TicketWeightsParameter()
+                : ServerParameter(ServerParameterSet::getGlobal(), "wiredTigerTicketWeights") { }
+
+            virtual void append(OperationContext* txn, BSONObjBuilder& b,
+                                const std::string& name) {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                b.append(name, _weights);
+            }
+
+            virtual Status set(const BSONElement& newValueElement) {
+                if (!newValueElement.isABSONObj()) {
+                    return Status(ErrorCodes::TypeMismatch,
+                                  str::stream() << name() << " must be a document");
+                }
+                return _set(newValueElement.Obj());
+            }
+
+            virtual Status setFromString(const std::string& str) {
+                try {
+                    return _set(fromjson(str));
+                }
+                catch (const DBException& ex) {
+                    return ex.toStatus();
+                }
+            }
+
+            double weightOf(const std::string& db) {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                const BSONElement weight = _weights[db];
+                return weight.eoo() ? 1 : weight.numberDouble();
+            }
+
+        private:
+            Status _set(const BSONObj& weights) {
+                BSONForEach(weight, weights) {
+                    if (!weight.isNumber() || !(weight.numberDouble() > 0)) {
+                        return Status(ErrorCodes::BadValue,
+                                      str::stream() << "the weight of database "
+                                                    << weight.fieldNameStringData()
+                                                    << " must be a positive number");
+                    }
+                }
+
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _weights = weights.getOwned();
+                return Status::OK();
+            }
+
+            boost::mutex _mutex;
+            BSONObj _weights;
+        } ticketWeights;
 
         class TicketServerParameter : public ServerParameter {
             MONGO_DISALLOW_COPYING(TicketServerParameter);
@@ -271,33 +420,123 @@ namespace mongo {
             TicketHolder* _holder;
         };
 
-        TicketHolder openWriteTransaction(128);
-        TicketServerParameter openWriteTransactionParam(&openWriteTransaction,
+        /**
+         * A TicketHolder together with what adjustTicketPools() needs to know about its use.
+         */
+        struct TicketPool {
+            explicit TicketPool(int num)
+                : holder(num),
+                  queue(&holder),
+                  lastAcquisitions(0),
+                  lastWaits(0) { }
+
+            void append(BSONObjBuilder* b) const {
+                b->append("out", holder.used());
+                b->append("available", holder.available());
+                b->append("totalTickets", holder.outof());
+                b->append("waits", waitTimes.getReport());
+
+                FairTicketQueue::GroupStatsMap queues;
+                queue.getStats(&queues);
+                BSONObjBuilder queuesBuilder(b->subobjStart("queues"));
+                for (FairTicketQueue::GroupStatsMap::const_iterator it = queues.begin();
+                     it != queues.end();
+                     ++it) {
+                    BSONObjBuilder group(queuesBuilder.subobjStart(it->first));
+                    group.append("queued", it->second.queued);
+                    group.appendNumber("waits", it->second.waits);
+                    group.appendNumber("totalWaitMicros", it->second.totalWaitMicros);
+                    group.appendNumber("maxWaitMicros", it->second.maxWaitMicros);
+                    group.doneFast();
+                }
+                queuesBuilder.doneFast();
+            }
+
+            TicketHolder holder;
+
+            // Used instead of waiting on the holder when wiredTigerFairTicketScheduling is set.
+            FairTicketQueue queue;
+
+            AtomicInt64 acquisitions;
+
+            // Only acquisitions that had to wait for a ticket are recorded.
+            LatencyHistogram waitTimes;
+
+            // Only used by adjustTicketPools(), which runs on a single thread.
+            TicketPoolController controller;
+            long long lastAcquisitions;
+            long long lastWaits;
+        };
+
+        TicketPool openWriteTransaction(128);
+        TicketServerParameter openWriteTransactionParam(&openWriteTransaction.holder,
                                                         "wiredTigerConcurrentWriteTransactions");
 
-        TicketHolder openReadTransaction(128);
-        TicketServerParameter openReadTransactionParam(&openReadTransaction,
+        TicketPool openReadTransaction(128);
+        TicketServerParameter openReadTransactionParam(&openReadTransaction.holder,
                                                        "wiredTigerConcurrentReadTransactions");
 
+        void adjustTicketPool(TicketPool* pool, const char* name, int minSize, int maxSize) {
+            const long long acquisitions = pool->acquisitions.load();
+            const long long waits = pool->waitTimes.getCount();
+            TicketPoolController::Sample sample;
+            sample.acquisitions = acquisitions - pool->lastAcquisitions;
+            sample.waits = waits - pool->lastWaits;
+            pool->lastAcquisitions = acquisitions;
+            pool->lastWaits = waits;
+
+            if (!wiredTigerAdaptiveTickets) {
+                return;
+            }
+
+            const int currentSize = pool->holder.outof();
+            const int newSize = pool->controller.nextSize(currentSize, sample, minSize, maxSize);
+            if (newSize == currentSize) {
+                return;
+            }
+
+            // Shrinking waits for the tickets to be returned.
+            const Status status = pool->holder.resize(newSize);
+            if (!status.isOK()) {
+                LOG(1) << "could not resize " << name << " ticket pool: " << status;
+                return;
+            }
+            pool->queue.dispatch();
+            LOG(1) << "resized " << name << " ticket pool from " << currentSize << " to "
+                   << newSize << " after " << sample.acquisitions << " acquisitions, "
+                   << sample.waits << " of which waited";
+        }
+
     }
 
     void WiredTigerRecoveryUnit::appendGlobalStats(BSONObjBuilder& b) {
         BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
         {
             BSONObjBuilder bbb(bb.subobjStart("write"));
-            bbb.append("out", openWriteTransaction.used());
-            bbb.append("available", openWriteTransaction.available());
-            bbb.append("totalTickets", openWriteTransaction.outof());
+            openWriteTransaction.append(&bbb);
             bbb.done();
         }
         {
             BSONObjBuilder bbb(bb.subobjStart("read"));
-            bbb.append("out", openReadTransaction.used());
-            bbb.append("available", openReadTransaction.available());
-            bbb.append("totalTickets", openReadTransaction.outof());
+            openReadTransaction.append(&bbb);
             bbb.done();
         }
+        bb.appendBool("adaptive", wiredTigerAdaptiveTickets);
+        bb.appendBool("fairScheduling", wiredTigerFairTicketScheduling);
         bb.done();
+
+        BSONObjBuilder pins(b.subobjStart("cursorSnapshots"));
+        pins.appendNumber("keptBetweenBatches", snapshotsKept.load());
+        pins.appendNumber("releasedWhileIdle", snapshotsReleasedIdle.load());
+        pins.done();
+    }
+
+    void WiredTigerRecoveryUnit::adjustTicketPools() {
+        // TicketHolder::resize() refuses fewer than 5 tickets.
+        const int minSize = std::max(5, static_cast<int>(wiredTigerAdaptiveTicketsMin));
+        const int maxSize = std::max(minSize, static_cast<int>(wiredTigerAdaptiveTicketsMax));
+        adjustTicketPool(&openWriteTransaction, "write", minSize, maxSize);
+        adjustTicketPool(&openReadTransaction, "read", minSize, maxSize);
     }
 
     void WiredTigerRecoveryUnit::_txnClose( bool commit ) {
@@ -315,7 +554,7 @@ namespace mongo {
         }
         _active = false;
         _myTransactionCount++;
-        _ticket.reset(NULL);
+        _releaseTicket();
     }
 
     SnapshotId WiredTigerRecoveryUnit::getSnapshotId() const {
@@ -349,10 +588,44 @@ namespace mongo {
             writeLocked = _everStartedWrite;
         }
 
-        TicketHolder* holder = writeLocked ? &openWriteTransaction : &openReadTransaction;
+        TicketPool* pool = writeLocked ? &openWriteTransaction : &openReadTransaction;
+
+        if (wiredTigerFairTicketScheduling && opCtx != NULL) {
+            // Queue behind anyone already queued, even if a ticket was just released.
+            if (pool->queue.queued() > 0 || !pool->holder.tryAcquire()) {
+                const std::string db = nsToDatabase(opCtx->getCurOp()->getNS());
+                const long long waitMicros =
+                    pool->queue.waitForTicket(db, ticketWeights.weightOf(db));
+                // Whoever queued may have been served by now, leaving a free ticket.
+                if (waitMicros > 0) {
+                    pool->waitTimes.recordMicros(waitMicros);
+                    opCtx->getCurOp()->debug().ticketWaitMicros += waitMicros;
+                }
+            }
+        }
+        else if (!pool->holder.tryAcquire()) {
+            Timer timer;
+            pool->holder.waitForTicket();
+            const long long waitMicros = timer.micros();
+            pool->waitTimes.recordMicros(waitMicros);
+            if (opCtx != NULL) {
+                opCtx->getCurOp()->debug().ticketWaitMicros += waitMicros;
+            }
+        }
+        pool->acquisitions.fetchAndAdd(1);
+        _ticket.reset(&pool->holder);
+        _ticketQueue = &pool->queue;
+    }
+
+    void WiredTigerRecoveryUnit::_releaseTicket() {
+        if (!_ticket.hasTicket()) {
+            return;
+        }
+        _ticket.reset(NULL);
 
-        holder->waitForTicket();
-        _ticket.reset(holder);
+        // Pass the ticket on to whoever queued for it, if fair scheduling is or was in use.
+        _ticketQueue->dispatch();
+        _ticketQueue = NULL;
     }
 
     void WiredTigerRecoveryUnit::_txnOpen(OperationContext* opCtx) {
@@ -370,7 +643,7 @@ namespace mongo {
     void WiredTigerRecoveryUnit::beingReleasedFromOperationContext() {
         LOG(2) << "WiredTigerRecoveryUnit::beingReleased";
         _currentlySquirreled = true;
-        if ( _active == false && !wt_keeptxnopen() ) {
+        if ( _active == false ) {
             _commit();
         }
     }
@@ -46,6 +46,7 @@
 namespace mongo {
 
     class BSONObjBuilder;
+    class FairTicketQueue;
     class WiredTigerSession;
     class WiredTigerSessionCache;
 
@@ -73,6 +74,9 @@ namespace mongo {
 
         virtual void commitAndRestart();
 
+        virtual void endCursorBatch();
+        virtual void releaseIdleSnapshot();
+
         // un-used API
         virtual void* writingPtr(void* data, size_t len) { invariant(!"don't call writingPtr"); }
 
@@ -97,9 +101,24 @@ namespace mongo {
 
         static WiredTigerRecoveryUnit* get(OperationContext *txn);
 
+        /**
+         * True if snapshots may stay open between getMore batches (wiredTigerCursorPinMillis),
+         * in which case cursors should keep their position when saved.
+         */
+        static bool snapshotsOutliveBatches();
+
         static void appendGlobalStats(BSONObjBuilder& b);
+
+        /**
+         * If wiredTigerAdaptiveTickets is set, resizes the read and write ticket pools based on
+         * their throughput and queueing since the previous call. Meant to be called once a
+         * second from a single thread.
+         */
+        static void adjustTicketPools();
     private:
 
+        bool _shouldKeepSnapshot();
+
         void _abort();
         void _commit();
 
@@ -123,7 +142,11 @@ namespace mongo {
 
         bool _noTicketNeeded;
         void _getTicket(OperationContext* opCtx);
+        void _releaseTicket();
         TicketHolderReleaser _ticket;
+
+        // The queue of the pool _ticket came from, told when the ticket is given back.
+        FairTicketQueue* _ticketQueue;
     };
 
     /**
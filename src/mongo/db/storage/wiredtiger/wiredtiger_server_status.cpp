@@ -80,6 +80,25 @@ namespace mongo {
 
         WiredTigerRecoveryUnit::appendGlobalStats(bob);
 
+        {
+            BSONObjBuilder oplogStonesBuilder(bob.subobjStart("oplogStones"));
+            WiredTigerRecordStore::appendOplogStonesStats(&oplogStonesBuilder);
+            oplogStonesBuilder.done();
+        }
+
+        {
+            BSONObjBuilder sessionCacheBuilder(bob.subobjStart("sessionCache"));
+            _engine->getSessionCache()->appendStats(&sessionCacheBuilder);
+            sessionCacheBuilder.done();
+        }
+
+        {
+            BSONObjBuilder checkpointBuilder;
+            if (_engine->appendCheckpointStats(&checkpointBuilder)) {
+                bob.append("checkpointScheduler", checkpointBuilder.obj());
+            }
+        }
+
         return bob.obj();
     }
 
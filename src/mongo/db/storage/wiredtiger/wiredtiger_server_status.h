@@ -43,6 +43,7 @@ namespace mongo {
     public:
         WiredTigerServerStatusSection(WiredTigerKVEngine* engine);
         virtual bool includeByDefault() const;
+        virtual bool isExpensive() const { return true; }
         virtual BSONObj generateSection(OperationContext* txn,
                                         const BSONElement& configElement) const;
     private:
@@ -31,21 +31,36 @@
 
 #define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
 
-#include <boost/thread.hpp>
+#include "mongo/platform/basic.h"
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
-    WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, int cachePartition, int epoch)
-        : _cachePartition(cachePartition),
-          _epoch(epoch),
+    // The most idle cursors a session keeps open for reuse, over all tables. 0 disables caching.
+    MONGO_EXPORT_SERVER_PARAMETER(wiredTigerCursorCacheSize, int, 100);
+
+    WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, long long epoch)
+        : _epoch(epoch),
+          _nextIdle(NULL),
           _session(NULL),
-          _cursorsOut(0) {
+          _cursorsOut(0),
+          _cursorHits(0),
+          _cursorOpens(0),
+          _cursorEvictions(0) {
 
         int ret = conn->open_session(conn, NULL, "isolation=snapshot", &_session);
         invariantWTOK(ret);
@@ -61,15 +76,16 @@ namespace mongo {
     WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri,
                                             uint64_t id,
                                             bool forRecordStore) {
-        {
-            Cursors& cursors = _curmap[id];
-            if ( !cursors.empty() ) {
-                WT_CURSOR* save = cursors.back();
-                cursors.pop_back();
+        for (Cursors::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
+            if (i->id == id) {
+                WT_CURSOR* save = i->cursor;
+                _cursors.erase(i);
                 _cursorsOut++;
+                _cursorHits++;
                 return save;
             }
         }
+        _cursorOpens++;
         WT_CURSOR* c = NULL;
         int ret = _session->open_cursor(_session,
                                         uri.c_str(),
@@ -87,34 +103,56 @@ namespace mongo {
         invariant( cursor );
         _cursorsOut--;
 
-        Cursors& cursors = _curmap[id];
-        if ( cursors.size() > 10u ) {
+        const size_t cacheSize = std::max(0, wiredTigerCursorCacheSize);
+        if (cacheSize == 0) {
             invariantWTOK( cursor->close(cursor) );
+            return;
         }
-        else {
-            invariantWTOK( cursor->reset( cursor ) );
-            cursors.push_back( cursor );
+
+        invariantWTOK( cursor->reset( cursor ) );
+        _cursors.push_front(CachedCursor(id, cursor));
+
+        while (_cursors.size() > cacheSize) {
+            WT_CURSOR* evicted = _cursors.back().cursor;
+            _cursors.pop_back();
+            invariantWTOK( evicted->close(evicted) );
+            _cursorEvictions++;
         }
     }
 
     void WiredTigerSession::closeAllCursors() {
         invariant( _session );
-        for (CursorMap::iterator i = _curmap.begin(); i != _curmap.end(); ++i ) {
-            Cursors& cursors = i->second;
-            for ( size_t j = 0; j < cursors.size(); j++ ) {
-                WT_CURSOR *cursor = cursors[j];
-                if (cursor) {
-                    int ret = cursor->close(cursor);
-                    invariantWTOK(ret);
-                }
+        for (Cursors::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
+            WT_CURSOR* cursor = i->cursor;
+            if (cursor) {
+                int ret = cursor->close(cursor);
+                invariantWTOK(ret);
             }
         }
-        _curmap.clear();
+        _cursors.clear();
     }
 
     namespace {
         AtomicUInt64 nextCursorId(1);
         AtomicUInt64 cachePartitionGen(0);
+
+        /**
+         * Counts a getSession() or releaseSession() call as in progress for its lifetime.
+         */
+        class InFlightGuard {
+            MONGO_DISALLOW_COPYING(InFlightGuard);
+        public:
+            explicit InFlightGuard(AtomicUInt32* inFlight) : _inFlight(inFlight) {
+                _inFlight->fetchAndAdd(1);
+            }
+
+            ~InFlightGuard() {
+                _inFlight->fetchAndSubtract(1);
+            }
+
+        private:
+            AtomicUInt32* const _inFlight;
+        };
     }
     // static
     uint64_t WiredTigerSession::genCursorId() {
@@ -124,12 +162,12 @@ namespace mongo {
     // -----------------------
 
     WiredTigerSessionCache::WiredTigerSessionCache( WiredTigerKVEngine* engine )
-        : _engine( engine ), _conn( engine->getConnection() ), _shuttingDown(0) {
+        : _engine( engine ), _conn( engine->getConnection() ), _epoch(0), _shuttingDown(0) {
 
     }
 
     WiredTigerSessionCache::WiredTigerSessionCache( WT_CONNECTION* conn )
-        : _engine( NULL ), _conn( conn ), _shuttingDown(0) {
+        : _engine( NULL ), _conn( conn ), _epoch(0), _shuttingDown(0) {
 
     }
 
@@ -141,69 +179,140 @@ namespace mongo {
         if (_shuttingDown.load()) return;
         _shuttingDown.store(1);
 
-        {
-            // This ensures that any calls, which are currently inside of getSession/releaseSession
-            // will be able to complete before we start cleaning up the pool. Any others, which are
-            // about to enter will return immediately because of _shuttingDown == true.
-            boost::lock_guard<boost::shared_mutex> lk(_shutdownLock);
+        // This ensures that any calls, which are currently inside of getSession/releaseSession
+        // will be able to complete before we start cleaning up the pool. Any others, which are
+        // about to enter will return immediately because of _shuttingDown == true.
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            while (_cache[i].inFlight.load() != 0) {
+                sleepmillis(1);
+            }
         }
 
         closeAll();
     }
 
     void WiredTigerSessionCache::closeAll() {
-        for (int i = 0; i < NumSessionCachePartitions; i++) {
-            SessionPool swapPool;
+        // Sessions created before this point are closed rather than cached when released.
+        _epoch.fetchAndAdd(1);
 
-            {
-                boost::unique_lock<SpinLock> scopedLock(_cache[i].lock);
-                _cache[i].pool.swap(swapPool);
-                _cache[i].epoch++;
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            WiredTigerSession* session = _cache[i].head.swap(NULL);
+            while (session) {
+                WiredTigerSession* next = session->_nextIdle;
+                delete session;
+                session = next;
             }
+        }
+    }
 
-            // New sessions will be created if need be outside of the lock
-            for (size_t i = 0; i < swapPool.size(); i++) {
-                delete swapPool[i];
+    // static
+    int WiredTigerSessionCache::_currentPartition() {
+#ifdef __linux__
+        const int cpu = sched_getcpu();
+        if (cpu >= 0) {
+            return cpu % NumSessionCachePartitions;
+        }
+#endif
+        // Spread sessions uniformly across the cache partitions
+        return cachePartitionGen.addAndFetch(1) % NumSessionCachePartitions;
+    }
+
+    // static
+    void WiredTigerSessionCache::_push(SessionCachePartition* partition,
+                                       WiredTigerSession* first,
+                                       WiredTigerSession* last) {
+        // Only the sessions being pushed are dereferenced, and they belong to the caller, so this
+        // is safe even if the top of the stack is popped and pushed again concurrently.
+        WiredTigerSession* head = partition->head.load();
+        while (true) {
+            last->_nextIdle = head;
+            WiredTigerSession* seen = partition->head.compareAndSwap(head, first);
+            if (seen == head) {
+                return;
             }
+            head = seen;
+        }
+    }
 
-            swapPool.clear();
+    // static
+    WiredTigerSession* WiredTigerSessionCache::_pop(SessionCachePartition* partition) {
+        // Popping just the top session would need to read its _nextIdle while another thread
+        // may have taken, released or even closed it (the ABA problem). Instead we take the whole
+        // stack, which leaves us the only owner of every session on it, and put back the rest.
+        WiredTigerSession* session = partition->head.swap(NULL);
+        if (!session) {
+            return NULL;
+        }
+
+        WiredTigerSession* rest = session->_nextIdle;
+        session->_nextIdle = NULL;
+
+        if (rest && partition->head.compareAndSwap(NULL, rest) != NULL) {
+            // Sessions were released to this partition in the meantime, so we have to link them
+            // in behind the rest of the stack.
+            WiredTigerSession* last = rest;
+            while (last->_nextIdle) {
+                last = last->_nextIdle;
+            }
+            _push(partition, rest, last);
         }
+
+        return session;
     }
 
     WiredTigerSession* WiredTigerSessionCache::getSession() {
-        boost::shared_lock<boost::shared_mutex> shutdownLock(_shutdownLock);
+        const int cachePartition = _currentPartition();
+        SessionCachePartition& partition = _cache[cachePartition];
+        InFlightGuard inFlight(&partition.inFlight);
 
         // We should never be able to get here after _shuttingDown is set, because no new
         // operations should be allowed to start.
-        invariant(!_shuttingDown.loadRelaxed());
+        invariant(!_shuttingDown.load());
 
-        // Spread sessions uniformly across the cache partitions
-        const int cachePartition = cachePartitionGen.addAndFetch(1) % NumSessionCachePartitions;
+        const long long epoch = _epoch.load();
 
-        int epoch;
+        // Prefer a session from our own partition, then one from any other partition.
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            SessionCachePartition& source =
+                _cache[(cachePartition + i) % NumSessionCachePartitions];
 
-        {
-            boost::unique_lock<SpinLock> cachePartitionLock(_cache[cachePartition].lock);
-            epoch = _cache[cachePartition].epoch;
+            // Avoid the atomic swap in _pop() for partitions which are obviously empty.
+            if (source.head.loadRelaxed() == NULL) {
+                continue;
+            }
 
-            if (!_cache[cachePartition].pool.empty()) {
-                WiredTigerSession* cachedSession = _cache[cachePartition].pool.back();
-                _cache[cachePartition].pool.pop_back();
+            while (WiredTigerSession* cachedSession = _pop(&source)) {
+                if (cachedSession->_getEpoch() != epoch) {
+                    // Released concurrently with closeAll(), so never closed.
+                    delete cachedSession;
+                    continue;
+                }
+
+                if (i == 0) {
+                    partition.hits.fetchAndAdd(1);
+                }
+                else {
+                    partition.steals.fetchAndAdd(1);
+                }
 
                 return cachedSession;
             }
         }
 
-        // Outside of the cache partition lock, but on release will be put back on the cache
-        return new WiredTigerSession(_conn, cachePartition, epoch);
+        partition.misses.fetchAndAdd(1);
+
+        // On release this will be put back on the cache
+        return new WiredTigerSession(_conn, epoch);
     }
 
     void WiredTigerSessionCache::releaseSession( WiredTigerSession* session ) {
         invariant( session );
         invariant(session->cursorsOut() == 0);
 
-        boost::shared_lock<boost::shared_mutex> shutdownLock(_shutdownLock);
-        if (_shuttingDown.loadRelaxed()) {
+        SessionCachePartition& partition = _cache[_currentPartition()];
+        InFlightGuard inFlight(&partition.inFlight);
+
+        if (_shuttingDown.load()) {
             // Leak the session in order to avoid race condition with clean shutdown, where the
             // storage engine is ripped from underneath transactions, which are not "active"
             // (i.e., do not have any locks), but are just about to delete the recovery unit.
@@ -220,22 +329,22 @@ namespace mongo {
             invariant(range == 0);
         }
 
-        const int cachePartition = session->_getCachePartition();
-        bool returnedToCache = false;
+        partition.cursorHits.fetchAndAdd(session->_cursorHits);
+        partition.cursorOpens.fetchAndAdd(session->_cursorOpens);
+        partition.cursorEvictions.fetchAndAdd(session->_cursorEvictions);
+        session->_cursorHits = 0;
+        session->_cursorOpens = 0;
+        session->_cursorEvictions = 0;
 
-        if (cachePartition >= 0) {
-            boost::unique_lock<SpinLock> cachePartitionLock(_cache[cachePartition].lock);
+        // Sessions go back to the partition of the CPU we're on now, which is the one the next
+        // session from this CPU will be taken from.
+        const long long epoch = _epoch.load();
+        invariant(session->_getEpoch() <= epoch);
 
-            invariant(session->_getEpoch() <= _cache[cachePartition].epoch);
-
-            if (session->_getEpoch() == _cache[cachePartition].epoch) {
-                _cache[cachePartition].pool.push_back(session);
-                returnedToCache = true;
-            }
+        if (session->_getEpoch() >= 0 && session->_getEpoch() == epoch) {
+            _push(&partition, session, session);
         }
-
-        // Do all cleanup outside of the cache partition spinlock.
-        if (!returnedToCache) {
+        else {
             delete session;
         }
 
@@ -243,4 +352,28 @@ namespace mongo {
             _engine->dropAllQueued();
         }
     }
+
+    void WiredTigerSessionCache::appendStats(BSONObjBuilder* b) const {
+        long long hits = 0;
+        long long steals = 0;
+        long long misses = 0;
+        long long cursorHits = 0;
+        long long cursorOpens = 0;
+        long long cursorEvictions = 0;
+        for (int i = 0; i < NumSessionCachePartitions; i++) {
+            hits += _cache[i].hits.loadRelaxed();
+            steals += _cache[i].steals.loadRelaxed();
+            misses += _cache[i].misses.loadRelaxed();
+            cursorHits += _cache[i].cursorHits.loadRelaxed();
+            cursorOpens += _cache[i].cursorOpens.loadRelaxed();
+            cursorEvictions += _cache[i].cursorEvictions.loadRelaxed();
+        }
+
+        b->appendNumber("hits", hits);
+        b->appendNumber("steals", steals);
+        b->appendNumber("misses", misses);
+        b->appendNumber("cursorHits", cursorHits);
+        b->appendNumber("cursorOpens", cursorOpens);
+        b->appendNumber("cursorEvictions", cursorEvictions);
+    }
 }
@@ -31,24 +31,24 @@
 
 #pragma once
 
-#include <map>
+#include <list>
 #include <string>
-#include <vector>
-
-#include <boost/thread/mutex.hpp>
-#include <boost/thread/shared_mutex.hpp>
 
 #include <wiredtiger.h>
 
 #include "mongo/platform/atomic_word.h"
-#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/platform/compiler.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
+    class BSONObjBuilder;
     class WiredTigerKVEngine;
 
     /**
-     * This is a structure that caches 1 cursor for each uri.
+     * This is a structure that caches idle cursors, keyed by the id of the table (or index) they
+     * are open on, up to a total of wiredTigerCursorCacheSize.  The least recently released
+     * cursors are closed first.
      * The idea is that there is a pool of these somewhere.
      * NOT THREADSAFE
      */
@@ -59,14 +59,11 @@ namespace mongo {
          * Creates a new WT session on the specified connection.
          *
          * @param conn WT connection
-         * @param cachePartition If the session comes from the session cache, this indicates to
-         *          which partition it should be returned. Value of -1 means it doesn't come from
-         *          cache and that it should not be cached, but closed directly.
          * @param epoch In which session cache cleanup epoch was this session instantiated. Value
-         *          of -1 means that this value is not necessary since the session will not be
-         *          cached.
+         *          of -1 means that the session doesn't come from the cache and should not be
+         *          cached, but closed directly.
          */
-        WiredTigerSession(WT_CONNECTION* conn, int cachePartition = -1, int epoch = -1);
+        WiredTigerSession(WT_CONNECTION* conn, long long epoch = -1);
         ~WiredTigerSession();
 
         WT_SESSION* getSession() const { return _session; }
@@ -90,22 +87,49 @@ namespace mongo {
     private:
         friend class WiredTigerSessionCache;
 
-        typedef std::vector<WT_CURSOR*> Cursors;
-        typedef std::map<uint64_t, Cursors> CursorMap;
+        struct CachedCursor {
+            CachedCursor(uint64_t id, WT_CURSOR* cursor) : id(id), cursor(cursor) { }
+
+            uint64_t id;
+            WT_CURSOR* cursor;
+        };
+
+        // Most recently released first.
+        typedef std::list<CachedCursor> Cursors;
 
 
         // Used internally by WiredTigerSessionCache
-        int _getEpoch() const { return _epoch; }
-        int _getCachePartition() const { return _cachePartition; }
+        long long _getEpoch() const { return _epoch; }
 
 
-        const int _cachePartition;
-        const int _epoch;
+        const long long _epoch;
+
+        // Next session in the idle stack of a WiredTigerSessionCache partition, while this
+        // session is in it.
+        WiredTigerSession* _nextIdle;
+
         WT_SESSION* _session; // owned
-        CursorMap _curmap; // owned
+        Cursors _cursors; // owned
         int _cursorsOut;
+
+        // Counts since this session was last released to a WiredTigerSessionCache, which adds
+        // them to its stats.
+        long long _cursorHits;
+        long long _cursorOpens;
+        long long _cursorEvictions;
     };
 
+    /**
+     * Caches idle WT sessions for reuse.
+     *
+     * Idle sessions are kept in one of a number of partitions, selected by the CPU the calling
+     * thread runs on, so that threads on different cores rarely touch the same cache lines. Each
+     * partition is a lock-free stack. A thread whose partition is empty steals from the others
+     * before opening a new session.
+     *
+     * closeAll() starts a new epoch. Sessions from earlier epochs are closed rather than reused,
+     * whether they are idle in the cache or get released later.
+     */
     class WiredTigerSessionCache {
     public:
 
@@ -122,36 +146,69 @@ namespace mongo {
 
         WT_CONNECTION* conn() const { return _conn; }
 
-    private:
-        typedef std::vector<WiredTigerSession*> SessionPool;
+        /**
+         * Appends the number of getSession() calls satisfied from the caller's own partition
+         * (hits), from another partition (steals) and by opening a new session (misses), and the
+         * same for the cursors of released sessions: the number taken from their cursor caches,
+         * the number opened and the number closed to keep the caches within their bounds.
+         */
+        void appendStats(BSONObjBuilder* b) const;
 
+    private:
         enum { NumSessionCachePartitions = 64 };
 
-        struct SessionCachePartition {
-            SessionCachePartition() : epoch(0) { }
+        // Aligned so that no two partitions share a cache line.
+        struct MONGO_COMPILER_ALIGN_TYPE(64) SessionCachePartition {
+            SessionCachePartition() : head(NULL) { }
             ~SessionCachePartition() {
-                invariant(pool.empty());
+                invariant(head.load() == NULL);
             }
 
-            SpinLock lock;
-            int epoch;
-            SessionPool pool;
+            // Top of the stack of idle sessions, linked through WiredTigerSession::_nextIdle.
+            AtomicWord<WiredTigerSession*> head;
+
+            // Number of getSession()/releaseSession() calls in progress that picked this
+            // partition. Used to wait for them to finish on shutdown.
+            AtomicUInt32 inFlight;
+
+            AtomicUInt64 hits;
+            AtomicUInt64 steals;
+            AtomicUInt64 misses;
+
+            AtomicUInt64 cursorHits;
+            AtomicUInt64 cursorOpens;
+            AtomicUInt64 cursorEvictions;
         };
 
+        /**
+         * Returns the partition for the CPU the calling thread is running on.
+         */
+        static int _currentPartition();
+
+        /**
+         * Pushes the chain of sessions from 'first' to 'last' onto the idle stack of 'partition'.
+         */
+        static void _push(SessionCachePartition* partition,
+                          WiredTigerSession* first,
+                          WiredTigerSession* last);
+
+        /**
+         * Pops a session from the idle stack of 'partition', or returns NULL if it is empty.
+         */
+        static WiredTigerSession* _pop(SessionCachePartition* partition);
 
         WiredTigerKVEngine* _engine; // not owned, might be NULL
         WT_CONNECTION* _conn; // not owned
 
-        // Partitioned cache of WT sessions. The partition key is not important, but it is
-        // important that sessions be returned to the same partition they were taken from in order
-        // to have some form of balance between the partitions.
         SessionCachePartition _cache[NumSessionCachePartitions];
 
-        // Regular operations take it in shared mode. Shutdown sets the _shuttingDown flag and
-        // then takes it in exclusive mode. This ensures that all threads, which would return
-        // sessions to the cache would leak them.
-        boost::shared_mutex _shutdownLock;
-        AtomicUInt32 _shuttingDown; // Used as boolean - 0 = false, 1 = true
+        // Incremented by closeAll().
+        AtomicInt64 _epoch;
+
+        // Used as boolean - 0 = false, 1 = true. Threads in getSession/releaseSession register
+        // with their partition's inFlight count before checking it, so shuttingDown() only has to
+        // set it and wait for those counts to drain.
+        AtomicUInt32 _shuttingDown;
     };
 
 }
@@ -0,0 +1,141 @@
+// wiredtiger_session_cache_test.cpp
+
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    class WiredTigerConnection {
+    public:
+        WiredTigerConnection() : _dbpath("wt_test"), _conn(NULL) {
+            int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create,", &_conn);
+            ASSERT_OK(wtRCToStatus(ret));
+            ASSERT(_conn);
+        }
+
+        ~WiredTigerConnection() {
+            _conn->close(_conn, NULL);
+        }
+
+        WT_CONNECTION* get() const { return _conn; }
+
+    private:
+        unittest::TempDir _dbpath;
+        WT_CONNECTION* _conn;
+    };
+
+    BSONObj getStats(const WiredTigerSessionCache& cache) {
+        BSONObjBuilder bob;
+        cache.appendStats(&bob);
+        return bob.obj();
+    }
+
+    void getAndReleaseSessions(WiredTigerSessionCache* cache, int iterations) {
+        for (int i = 0; i < iterations; i++) {
+            WiredTigerSession* session = cache->getSession();
+            ASSERT(session->getSession());
+            cache->releaseSession(session);
+        }
+    }
+
+    TEST(WiredTigerSessionCacheTest, ReusesReleasedSessions) {
+        WiredTigerConnection conn;
+        WiredTigerSessionCache cache(conn.get());
+
+        WiredTigerSession* first = cache.getSession();
+        ASSERT_EQUALS(1, getStats(cache)["misses"].numberLong());
+        cache.releaseSession(first);
+
+        // Whichever partition the session went back to, it is found again.
+        WiredTigerSession* second = cache.getSession();
+        ASSERT_EQUALS(first, second);
+        cache.releaseSession(second);
+
+        BSONObj stats = getStats(cache);
+        ASSERT_EQUALS(1, stats["misses"].numberLong());
+        ASSERT_EQUALS(1, stats["hits"].numberLong() + stats["steals"].numberLong());
+    }
+
+    TEST(WiredTigerSessionCacheTest, CloseAllInvalidatesOutstandingSessions) {
+        WiredTigerConnection conn;
+        WiredTigerSessionCache cache(conn.get());
+
+        WiredTigerSession* cached = cache.getSession();
+        WiredTigerSession* outstanding = cache.getSession();
+        cache.releaseSession(cached);
+
+        cache.closeAll();
+
+        // The outstanding session is from the previous epoch, so it is closed, not cached.
+        cache.releaseSession(outstanding);
+
+        WiredTigerSession* session = cache.getSession();
+        ASSERT_EQUALS(3, getStats(cache)["misses"].numberLong());
+        cache.releaseSession(session);
+    }
+
+    TEST(WiredTigerSessionCacheTest, ConcurrentGetAndRelease) {
+        WiredTigerConnection conn;
+        WiredTigerSessionCache cache(conn.get());
+
+        const int kThreads = 8;
+        const int kIterations = 1000;
+
+        std::vector<boost::thread*> threads;
+        for (int i = 0; i < kThreads; i++) {
+            threads.push_back(
+                new boost::thread(stdx::bind(getAndReleaseSessions, &cache, kIterations)));
+        }
+        for (int i = 0; i < kThreads; i++) {
+            threads[i]->join();
+            delete threads[i];
+        }
+
+        BSONObj stats = getStats(cache);
+        ASSERT_EQUALS(kThreads * kIterations,
+                      stats["hits"].numberLong() +
+                      stats["steals"].numberLong() +
+                      stats["misses"].numberLong());
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -228,9 +228,15 @@ namespace mongo {
         invariantWTOK(session->commit_transaction(session, NULL));
 
         {
+            // Entries that changed again while we were writing stay dirty.
             boost::lock_guard<boost::mutex> lk( _entriesMutex );
-            for (Map::iterator it = _entries.begin(); it != _entries.end(); ++it) {
-                it->second.dirty = false;
+            for (Map::iterator it = myMap.begin(); it != myMap.end(); ++it) {
+                Map::iterator current = _entries.find(it->first);
+                if (current != _entries.end() &&
+                    current->second.numRecords == it->second.numRecords &&
+                    current->second.dataSize == it->second.dataSize) {
+                    current->second.dirty = false;
+                }
             }
         }
     }
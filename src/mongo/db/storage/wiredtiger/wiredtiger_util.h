@@ -45,10 +45,6 @@ namespace mongo {
     class OperationContext;
     class WiredTigerConfigParser;
 
-    inline bool wt_keeptxnopen() {
-        return false;
-    }
-
     Status wtRCToStatus_slow(int retCode, const char* prefix );
 
     /**
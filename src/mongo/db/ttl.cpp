@@ -43,6 +43,7 @@
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
@@ -52,14 +53,17 @@
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
 #include "mongo/util/background.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
     using std::set;
     using std::endl;
     using std::list;
+    using std::map;
     using std::string;
     using std::vector;
 
@@ -72,9 +76,104 @@ namespace mongo {
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorSleepSecs, int, 60 ); //used for testing
 
+    // Number of threads TTL indexes are processed on; with more than one, the TTL indexes of
+    // different collections are processed concurrently.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER( ttlMonitorThreads, int, 1 );
+
+    // Maximum number of documents removed by one delete, each under its own locks, while
+    // catching up on a TTL index; 0 removes all expired documents of an index at once.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorBatchSize, int, 0 );
+
+    // Limits how many documents per second all TTL threads together delete; 0 is unlimited.
+    MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorMaxDeletesPerSecond, int, 0 );
+
+namespace {
+
+    /**
+     * Paces TTL deletes, shared by all TTL threads, to ttlMonitorMaxDeletesPerSecond.
+     */
+    class TTLRateLimiter {
+    public:
+        TTLRateLimiter() : _nextMicros(0) {}
+
+        /**
+         * Accounts for 'numDeleted' documents and sleeps for as long as it takes to stay within
+         * the rate. Must be called without holding any locks.
+         */
+        void paceDeletes(long long numDeleted) {
+            const int rate = ttlMonitorMaxDeletesPerSecond;
+            if (rate <= 0 || numDeleted <= 0)
+                return;
+
+            unsigned long long startMicros;
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                const unsigned long long now = curTimeMicros64();
+                startMicros = std::max(now, _nextMicros);
+                _nextMicros = startMicros + numDeleted * 1000 * 1000 / rate;
+            }
+
+            const unsigned long long now = curTimeMicros64();
+            if (startMicros > now) {
+                sleepmicros(startMicros - now);
+            }
+        }
+
+    private:
+        boost::mutex _mutex;
+
+        // When the deletes accounted for so far are allowed to have happened.
+        unsigned long long _nextMicros;
+    };
+
+    TTLRateLimiter ttlRateLimiter;
+
+    /**
+     * What the last TTL pass did for an index.
+     */
+    struct TTLIndexStats {
+        TTLIndexStats() : deleted(0), batches(0), caughtUp(true) {}
+
+        long long deleted;
+        long long batches;
+
+        // False if the pass left expired documents behind, e.g. because of rate limiting.
+        bool caughtUp;
+    };
+
+    boost::mutex ttlIndexStatsMutex;
+
+    // Keyed by "<ns>.$<index name>", replaced at the end of every TTL pass.
+    map<string, TTLIndexStats> ttlIndexStats;
+
+    class TTLIndexesSSS : public ServerStatusSection {
+    public:
+        TTLIndexesSSS() : ServerStatusSection("ttlIndexes") {}
+
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder b;
+            boost::lock_guard<boost::mutex> lk(ttlIndexStatsMutex);
+            for (map<string, TTLIndexStats>::const_iterator it = ttlIndexStats.begin();
+                 it != ttlIndexStats.end(); ++it) {
+                BSONObjBuilder indexBuilder(b.subobjStart(it->first));
+                indexBuilder.appendNumber("deletedLastPass", it->second.deleted);
+                indexBuilder.appendNumber("batchesLastPass", it->second.batches);
+                indexBuilder.append("caughtUp", it->second.caughtUp);
+                indexBuilder.doneFast();
+            }
+            return b.obj();
+        }
+
+    } ttlIndexesSSS;
+
+} // namespace
+
     class TTLMonitor : public BackgroundJob {
     public:
-        TTLMonitor(){}
+        TTLMonitor() : _passStats(NULL), _passDeadlineMillis(0) {}
         virtual ~TTLMonitor(){}
 
         virtual string name() const { return "TTLMonitor"; }
@@ -85,6 +184,10 @@ namespace mongo {
             Client::initThread( name().c_str() );
             AuthorizationSession::get(cc())->grantInternalAuthorization();
 
+            if ( ttlMonitorThreads > 1 ) {
+                _workers.reset( new ThreadPool( ttlMonitorThreads, "TTLMonitorWorker" ) );
+            }
+
             while ( ! inShutdown() ) {
                 sleepsecs( ttlMonitorSleepSecs );
 
@@ -114,6 +217,16 @@ namespace mongo {
 
     private:
 
+        // Lets concurrent work on the TTL indexes of different collections; NULL if TTL
+        // indexes are processed one at a time on the TTLMonitor thread.
+        boost::scoped_ptr<ThreadPool> _workers;
+
+        // Stats of the TTL pass in progress, protected by ttlIndexStatsMutex.
+        map<string, TTLIndexStats>* _passStats;
+
+        // Indexes with more expired documents than one batch stop being worked on after this.
+        long long _passDeadlineMillis;
+
         void doTTLPass() {
             // Count it as active from the moment the TTL thread wakes up
             OperationContextImpl txn;
@@ -129,6 +242,10 @@ namespace mongo {
 
             ttlPasses.increment();
 
+            map<string, TTLIndexStats> passStats;
+            _passStats = &passStats;
+            _passDeadlineMillis = curTimeMillis64() + 1000LL * std::max(ttlMonitorSleepSecs, 1);
+
             for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
                 string db = *i;
 
@@ -138,19 +255,88 @@ namespace mongo {
                 for ( vector<BSONObj>::const_iterator it = indexes.begin();
                       it != indexes.end(); ++it ) {
 
-                    BSONObj idx = *it;
-                    try {
-                        if ( !doTTLForIndex( &txn, db, idx ) ) {
-                            break;  // stop processing TTL indexes on this database
-                        }
-                    } catch (const DBException& dbex) {
-                        error() << "Error processing ttl index: " << idx
-                                << " -- " << dbex.toString();
-                        // continue on to the next index
+                    if ( _workers ) {
+                        _workers->schedule( &TTLMonitor::doTTLForIndexOnWorker, this, db, *it );
                         continue;
                     }
+
+                    if ( !doTTLForIndexAndLog( &txn, db, *it ) ) {
+                        break;  // stop processing TTL indexes on this database
+                    }
                 }
             }
+
+            if ( _workers ) {
+                _workers->join();
+            }
+
+            _passStats = NULL;
+            boost::lock_guard<boost::mutex> lk( ttlIndexStatsMutex );
+            ttlIndexStats.swap( passStats );
+        }
+
+        void doTTLForIndexOnWorker( const string& dbName, const BSONObj& idx ) {
+            Client::initThreadIfNotAlready();
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            OperationContextImpl txn;
+            doTTLForIndexAndLog( &txn, dbName, idx );
+        }
+
+        /**
+         * Runs doTTLForIndex(), logging rather than throwing errors.
+         */
+        bool doTTLForIndexAndLog( OperationContext* txn, const string& dbName,
+                                  const BSONObj& idx ) {
+            try {
+                return doTTLForIndex( txn, dbName, idx );
+            }
+            catch ( const WriteConflictException& ) {
+                LOG(1) << "Got WriteConflictException in TTL thread";
+            }
+            catch ( const DBException& dbex ) {
+                error() << "Error processing ttl index: " << idx
+                        << " -- " << dbex.toString();
+            }
+            // continue on to the next index
+            return true;
+        }
+
+        /**
+         * Returns a query matching at most about ttlMonitorBatchSize of the documents matched by
+         * 'query', those earliest in the order of the TTL index 'key', or 'query' itself if
+         * it matches fewer than that.
+         */
+        BSONObj getBatchQuery( OperationContext* txn, const string& ns, const BSONObj& key,
+                               const BSONObj& query ) {
+            const int batchSize = ttlMonitorBatchSize;
+            if ( batchSize <= 0 ) {
+                return query;
+            }
+
+            const StringData field = key.firstElementFieldName();
+            const BSONObj fields = BSON( field << 1 << "_id" << 0 );
+
+            DBDirectClient client( txn );
+            std::auto_ptr<DBClientCursor> cursor =
+                client.query( ns, Query( query ).sort( key ).hint( key ), 1, batchSize, &fields );
+            if ( !cursor.get() || !cursor->more() ) {
+                return query;
+            }
+            const BSONObj boundaryDoc = cursor->nextSafe();
+
+            // Everything up to and including the first document past the batch is expired, and
+            // there is at least one of those, so each batch makes progress even when many
+            // documents expire at the same time. Arrays sort by their smallest element, which
+            // leaves no single boundary value, so those are deleted along with the rest.
+            BSONElement boundary = boundaryDoc.getFieldDotted( field );
+            if ( boundary.type() != Date ) {
+                return query;
+            }
+
+            BSONObjBuilder b;
+            b.appendDate( "$lte", boundary.date() );
+            return BSON( field << b.obj() );
         }
 
         /**
@@ -234,7 +420,50 @@ namespace mongo {
 
             LOG(1) << "TTL -- ns: " << ns << "key:" << key << " query: " << query << endl;
 
-            long long numDeleted = 0;
+            const string statsKey = ns + ".$" + idx["name"].String();
+            TTLIndexStats stats;
+            bool caughtUp = false;
+            bool keepGoing = true;
+            while ( keepGoing && !caughtUp ) {
+                if ( stats.batches > 0 &&
+                     ( inShutdown() || curTimeMillis64() > _passDeadlineMillis ) ) {
+                    // Leave the rest to the next pass, so other indexes get their turn.
+                    break;
+                }
+
+                const BSONObj batchQuery = getBatchQuery( txn, ns, key, query );
+                caughtUp = ( batchQuery == query );
+
+                long long numDeleted = 0;
+                keepGoing = deleteExpired( txn, dbName, ns, key, batchQuery, &numDeleted );
+
+                ttlDeletedDocuments.increment(numDeleted);
+                LOG(1) << "\tTTL deleted: " << numDeleted << endl;
+
+                stats.deleted += numDeleted;
+                stats.batches++;
+                ttlRateLimiter.paceDeletes( numDeleted );
+            }
+
+            stats.caughtUp = caughtUp;
+            {
+                boost::lock_guard<boost::mutex> lk( ttlIndexStatsMutex );
+                if ( _passStats ) {
+                    (*_passStats)[statsKey] = stats;
+                }
+            }
+            return keepGoing;
+        }
+
+        /**
+         * Deletes the documents of 'ns' matching 'query' in one operation, once the TTL index on
+         * 'key' is ready, and sets 'numDeleted' to how many were removed.
+         *
+         * @return true if caller should continue processing TTL indexes of collections
+         *         on the specified database, and false otherwise
+         */
+        bool deleteExpired( OperationContext* txn, const string& dbName, const string& ns,
+                            const BSONObj& key, const BSONObj& query, long long* numDeleted ) {
             int attempt = 1;
             while (1) {
                 ScopedTransaction scopedXact(txn, MODE_IX);
@@ -265,12 +494,12 @@ namespace mongo {
                 }
 
                 try {
-                    numDeleted = deleteObjects(txn,
-                                               db,
-                                               ns,
-                                               query,
-                                               PlanExecutor::YIELD_AUTO,
-                                               false);
+                    *numDeleted = deleteObjects(txn,
+                                                db,
+                                                ns,
+                                                query,
+                                                PlanExecutor::YIELD_AUTO,
+                                                false);
                     break;
                 }
                 catch (const WriteConflictException& dle) {
@@ -278,8 +507,6 @@ namespace mongo {
                 }
             }
 
-            ttlDeletedDocuments.increment(numDeleted);
-            LOG(1) << "\tTTL deleted: " << numDeleted << endl;
             return true;
         }
     };
@@ -0,0 +1,421 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/warmup.h"
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <memory>
+
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_executor.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/progress_meter.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    // Collections and indexes read into cache at startup and when this node becomes primary, in
+    // the format of parseWarmupTargets().
+    std::string warmupNamespaces;
+
+    // Number of threads a warmup reads documents and indexes on.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(warmupThreads, int, 2);
+
+    // Limits how many megabytes per second all warmup threads together read; 0 is unlimited.
+    MONGO_EXPORT_SERVER_PARAMETER(warmupMaxMBPerSecond, int, 0);
+
+namespace {
+
+    class WarmupNamespacesParameter : public ExportedServerParameter<std::string> {
+    public:
+        WarmupNamespacesParameter()
+            : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                   "warmupNamespaces",
+                                                   &warmupNamespaces,
+                                                   true, // Change at startup
+                                                   false) {} // Change at runtime
+
+    protected:
+        virtual Status validate(const std::string& potentialNewValue) {
+            vector<WarmupTarget> targets;
+            return parseWarmupTargets(potentialNewValue, &targets);
+        }
+    } warmupNamespacesParameter;
+
+    // How many documents or keys are read between checks for interruption and pacing.
+    const int kItemsPerCheck = 128;
+
+    /**
+     * Paces the reads of all warmup threads to warmupMaxMBPerSecond.
+     */
+    class WarmupRateLimiter {
+    public:
+        WarmupRateLimiter() : _nextMicros(0) {}
+
+        /**
+         * Accounts for 'numBytes' read and returns for how many microseconds the caller must
+         * wait to stay within the rate.
+         */
+        unsigned long long accountFor(long long numBytes) {
+            const int rate = warmupMaxMBPerSecond;
+            if (rate <= 0 || numBytes <= 0)
+                return 0;
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            const unsigned long long now = curTimeMicros64();
+            const unsigned long long startMicros = std::max(now, _nextMicros);
+            _nextMicros = startMicros + numBytes * 1000 * 1000 / (rate * 1024LL * 1024);
+            return startMicros - now;
+        }
+
+    private:
+        boost::mutex _mutex;
+
+        // When the reads accounted for so far are allowed to have happened.
+        unsigned long long _nextMicros;
+    };
+
+    WarmupRateLimiter warmupRateLimiter;
+
+    // 1 while a warmup is running.
+    AtomicUInt32 warmupRunning;
+
+    /**
+     * Waits for 'micros' with all locks of 'txn' released and 'exec' saved. Returns false if
+     * 'exec' was killed in the meantime, for example because its collection was dropped.
+     */
+    bool waitWithoutLocks(OperationContext* txn, PlanExecutor* exec, unsigned long long micros) {
+        exec->saveState();
+
+        Locker* locker = txn->lockState();
+        Locker::LockSnapshot snapshot;
+        const bool unlocked = locker->saveLockStateAndUnlock(&snapshot);
+        if (unlocked) {
+            txn->recoveryUnit()->commitAndRestart();
+        }
+
+        sleepmicros(micros);
+
+        if (unlocked) {
+            locker->restoreLockState(snapshot);
+        }
+        return exec->restoreState(txn);
+    }
+
+    /**
+     * Returns a key with MinKey for every ascending field of 'keyPattern' and MaxKey for every
+     * descending one, or the reverse if 'end' is true, so that keys from the first to the second
+     * cover the whole index.
+     */
+    BSONObj indexBoundary(const BSONObj& keyPattern, bool end) {
+        BSONObjBuilder b;
+        BSONObjIterator it(keyPattern);
+        while (it.more()) {
+            const BSONElement field = it.next();
+            const bool descending = field.isNumber() && field.number() < 0;
+            if (descending == end) {
+                b.appendMinKey("");
+            }
+            else {
+                b.appendMaxKey("");
+            }
+        }
+        return b.obj();
+    }
+
+    /**
+     * Reads all documents of 'ns' if 'indexName' is empty, or else all keys of that index.
+     * Returns how many bytes were read.
+     */
+    long long warmCollectionOrIndex(OperationContext* txn,
+                                    const string& ns,
+                                    const string& indexName) {
+        AutoGetCollectionForRead ctx(txn, ns);
+        Collection* collection = ctx.getCollection();
+        if (!collection) {
+            LOG(1) << "not warming " << ns << ": collection not found";
+            return 0;
+        }
+
+        std::auto_ptr<PlanExecutor> exec;
+        if (indexName.empty()) {
+            exec.reset(InternalPlanner::collectionScan(txn, ns, collection));
+        }
+        else {
+            const IndexDescriptor* desc =
+                collection->getIndexCatalog()->findIndexByName(txn, indexName);
+            if (!desc) {
+                LOG(1) << "not warming index " << indexName << " of " << ns << ": not found";
+                return 0;
+            }
+            exec.reset(InternalPlanner::indexScan(txn, collection, desc,
+                                                  indexBoundary(desc->keyPattern(), false),
+                                                  indexBoundary(desc->keyPattern(), true),
+                                                  true));
+        }
+        exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+        const string what = indexName.empty() ? string("documents")
+                                              : string(str::stream() << "index " << indexName);
+        ProgressMeterHolder progress(*txn->setMessage("warmup",
+                                                      "Warmup: " + ns + " " + what,
+                                                      collection->numRecords(txn),
+                                                      10));
+
+        long long numBytes = 0;
+        long long unpacedBytes = 0;
+        int sinceCheck = 0;
+        BSONObj obj;
+        PlanExecutor::ExecState state;
+        while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, NULL))) {
+            progress.hit();
+            numBytes += obj.objsize();
+            unpacedBytes += obj.objsize();
+
+            if (++sinceCheck < kItemsPerCheck) {
+                continue;
+            }
+            sinceCheck = 0;
+
+            txn->checkForInterrupt();
+            if (inShutdown()) {
+                return numBytes;
+            }
+
+            const unsigned long long waitMicros = warmupRateLimiter.accountFor(unpacedBytes);
+            unpacedBytes = 0;
+            if (waitMicros > 0 && !waitWithoutLocks(txn, exec.get(), waitMicros)) {
+                LOG(1) << "stopped warming " << what << " of " << ns << ": it went away";
+                return numBytes;
+            }
+        }
+
+        if (PlanExecutor::IS_EOF != state) {
+            LOG(1) << "stopped warming " << what << " of " << ns << ": "
+                   << WorkingSetCommon::toStatusString(obj);
+        }
+        return numBytes;
+    }
+
+    void warmCollectionOrIndexOnWorker(const string& ns, const string& indexName) {
+        Client::initThreadIfNotAlready();
+        AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+        OperationContextImpl txn;
+        txn.getCurOp()->reset(HostAndPort(), dbQuery);
+
+        const string what = indexName.empty() ? string("documents")
+                                              : string(str::stream() << "index " << indexName);
+        try {
+            Timer timer;
+            const long long numBytes = warmCollectionOrIndex(&txn, ns, indexName);
+            log() << "warmed " << what << " of " << ns << ": read " << numBytes << " bytes in "
+                  << timer.millis() << "ms";
+        }
+        catch (const DBException& ex) {
+            warning() << "warming " << what << " of " << ns << " failed: " << ex.toString();
+        }
+    }
+
+    class WarmupJob : public BackgroundJob {
+    public:
+        explicit WarmupJob(const vector<WarmupTarget>& targets)
+            : BackgroundJob(true /* self-delete */),
+              _targets(targets) {}
+
+        virtual string name() const { return "Warmup"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            AuthorizationSession::get(cc())->grantInternalAuthorization();
+
+            Timer timer;
+            size_t numTasks = 0;
+            try {
+                ThreadPool workers(std::max(1, static_cast<int>(warmupThreads)), "WarmupWorker");
+                for (size_t i = 0; i < _targets.size(); ++i) {
+                    const WarmupTarget& target = _targets[i];
+
+                    if (target.data) {
+                        workers.schedule(&warmCollectionOrIndexOnWorker, target.ns, string());
+                        ++numTasks;
+                    }
+
+                    const vector<string> indexNames = getIndexNames(target);
+                    for (size_t j = 0; j < indexNames.size(); ++j) {
+                        workers.schedule(&warmCollectionOrIndexOnWorker, target.ns,
+                                         indexNames[j]);
+                        ++numTasks;
+                    }
+                }
+                workers.join();
+
+                log() << "warmup of " << numTasks << " collections and indexes done in "
+                      << timer.seconds() << "s";
+            }
+            catch (const DBException& ex) {
+                warning() << "warmup failed: " << ex.toString();
+            }
+
+            warmupRunning.store(0);
+        }
+
+    private:
+        static vector<string> getIndexNames(const WarmupTarget& target) {
+            if (!target.allIndexes) {
+                return target.indexNames;
+            }
+
+            vector<string> indexNames;
+            OperationContextImpl txn;
+            AutoGetCollectionForRead ctx(&txn, target.ns);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return indexNames;
+            }
+
+            IndexCatalog::IndexIterator it =
+                collection->getIndexCatalog()->getIndexIterator(&txn, false);
+            while (it.more()) {
+                indexNames.push_back(it.next()->indexName());
+            }
+            return indexNames;
+        }
+
+        const vector<WarmupTarget> _targets;
+    };
+
+} // namespace
+
+    Status parseWarmupTargets(StringData list, vector<WarmupTarget>* out) {
+        // Keep the targets in the order they were first listed in.
+        std::map<string, size_t> byNs;
+
+        size_t start = 0;
+        while (start < list.size()) {
+            size_t end = list.find(',', start);
+            if (string::npos == end) {
+                end = list.size();
+            }
+            const StringData entry = list.substr(start, end - start);
+            start = end + 1;
+            if (entry.empty()) {
+                continue;
+            }
+
+            string ns = entry.toString();
+            string indexName;
+            const size_t indexStart = entry.find(".$");
+            if (string::npos != indexStart) {
+                ns = entry.substr(0, indexStart).toString();
+                indexName = entry.substr(indexStart + 2).toString();
+                if (indexName.empty()) {
+                    return Status(ErrorCodes::BadValue,
+                                  str::stream() << "no index name in warmup entry " << entry);
+                }
+            }
+
+            const NamespaceString nss(ns);
+            if (!nss.isValid() || !nss.isNormal()) {
+                return Status(ErrorCodes::InvalidNamespace,
+                              str::stream() << "bad namespace in warmup entry " << entry);
+            }
+
+            std::map<string, size_t>::const_iterator it = byNs.find(ns);
+            if (byNs.end() == it) {
+                it = byNs.insert(std::make_pair(ns, out->size())).first;
+                out->push_back(WarmupTarget());
+                out->back().ns = ns;
+            }
+
+            WarmupTarget& target = (*out)[it->second];
+            if (indexName.empty()) {
+                target.data = true;
+                target.allIndexes = true;
+                target.indexNames.clear();
+            }
+            else if (!target.allIndexes) {
+                target.indexNames.push_back(indexName);
+            }
+        }
+        return Status::OK();
+    }
+
+    Status startWarmup(const vector<WarmupTarget>& targets) {
+        if (targets.empty()) {
+            return Status::OK();
+        }
+
+        if (0 != warmupRunning.compareAndSwap(0, 1)) {
+            return Status(ErrorCodes::ConflictingOperationInProgress,
+                          "a warmup is already running");
+        }
+
+        WarmupJob* job = new WarmupJob(targets);
+        job->go();
+        return Status::OK();
+    }
+
+    void startConfiguredWarmup() {
+        vector<WarmupTarget> targets;
+        Status status = parseWarmupTargets(warmupNamespaces, &targets);
+        if (status.isOK()) {
+            status = startWarmup(targets);
+        }
+        if (!status.isOK()) {
+            warning() << "not warming " << warmupNamespaces << ": " << status.toString();
+        }
+    }
+
+}  // namespace mongo
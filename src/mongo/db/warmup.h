@@ -0,0 +1,78 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+
+namespace mongo {
+
+    /**
+     * A collection whose documents and/or indexes should be read into the storage engine's cache.
+     */
+    struct WarmupTarget {
+        WarmupTarget() : data(false), allIndexes(false) { }
+
+        std::string ns;
+
+        // Whether to read the documents.
+        bool data;
+
+        // Whether to read every index, or else just those in 'indexNames'.
+        bool allIndexes;
+        std::vector<std::string> indexNames;
+    };
+
+    /**
+     * Parses a comma separated list of "<db>.<collection>" entries, which warm a collection's
+     * documents and all of its indexes, and "<db>.<collection>.$<index name>" entries, which
+     * warm just one index. Entries for the same collection are merged.
+     */
+    Status parseWarmupTargets(StringData list, std::vector<WarmupTarget>* out);
+
+    /**
+     * Starts reading 'targets' on a background thread and returns immediately. The documents and
+     * each index of every target are read as separate tasks on up to warmupThreads threads,
+     * which report their progress in currentOp and altogether read at most
+     * warmupMaxMBPerSecond.
+     *
+     * Returns ConflictingOperationInProgress if an earlier warmup is still running.
+     */
+    Status startWarmup(const std::vector<WarmupTarget>& targets);
+
+    /**
+     * Starts warming the targets in the warmupNamespaces startup parameter, if there are any.
+     * Called at startup, and when this node becomes primary.
+     */
+    void startConfiguredWarmup();
+
+}  // namespace mongo
@@ -33,10 +33,12 @@
 #include "mongo/base/counter.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/stats/latency_histogram.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/storage/storage_engine.h"
 #include "mongo/db/write_concern_options.h"
@@ -49,6 +51,16 @@ namespace mongo {
     static ServerStatusMetricField<TimerStats> displayGleLatency("getLastError.wtime",
                                                                  &gleWtimeStats );
 
+    // How long replication took to satisfy write concerns, for w:majority and for the others.
+    static LatencyHistogram gleWtimeMajorityLatency;
+    static ServerStatusMetricField<LatencyHistogram> displayGleMajorityLatency(
+                                                            "getLastError.wtimeLatency.majority",
+                                                            &gleWtimeMajorityLatency );
+    static LatencyHistogram gleWtimeOtherLatency;
+    static ServerStatusMetricField<LatencyHistogram> displayGleOtherLatency(
+                                                            "getLastError.wtimeLatency.other",
+                                                            &gleWtimeOtherLatency );
+
     static Counter64 gleWtimeouts;
     static ServerStatusMetricField<Counter64> gleWtimeoutsDisplay("getLastError.wtimeouts",
                                                                   &gleWtimeouts );
@@ -240,6 +252,8 @@ namespace mongo {
         }
 
         result->syncMillis = syncTimer.millis();
+        OpDebug& opDebug = txn->getCurOp()->debug();
+        opDebug.writeConcernWaitMicros += syncTimer.micros();
 
         // Now wait for replication
 
@@ -256,10 +270,17 @@ namespace mongo {
 
         // Now we wait for replication
         // Note that replica set stepdowns and gle mode changes are thrown as errors
+        const unsigned long long startMicros = curTimeMicros64();
         repl::ReplicationCoordinator::StatusAndDuration replStatus =
                 repl::getGlobalReplicationCoordinator()->awaitReplication(txn,
                                                                           replOpTime,
                                                                           writeConcern);
+        opDebug.writeConcernWaitMicros += curTimeMicros64() - startMicros;
+        if (replStatus.status.isOK()) {
+            LatencyHistogram& latency = writeConcern.wMode == WriteConcernOptions::kMajority ?
+                    gleWtimeMajorityLatency : gleWtimeOtherLatency;
+            latency.recordMicros(curTimeMicros64() - startMicros);
+        }
         if (replStatus.status == ErrorCodes::ExceededTimeLimit) {
             gleWtimeouts.increment();
             replStatus.status = Status(ErrorCodes::WriteConcernFailed,
@@ -1622,6 +1622,37 @@ namespace DocumentSourceTests {
             }
         };
 
+        /**
+         * Outputs which are released before the next one are reused in place, but must not be
+         * changed when they are kept.
+         */
+        class KeepSomeResults : public Base {
+        public:
+            void run() {
+                client.insert( ns, fromjson( "{_id:0,a:{b:[1,2,3,4]},c:1}" ) );
+                client.insert( ns, fromjson( "{_id:1,a:{b:[5,6]},c:2}" ) );
+                createSource();
+                createUnwind( "$a.b" );
+
+                vector<Document> kept;
+                int n = 0;
+                while (boost::optional<Document> current = unwind()->getNext()) {
+                    if (n++ % 2 == 0) {
+                        kept.push_back(*current);
+                    }
+                }
+                assertExhausted();
+
+                BSONArrayBuilder bsonKept;
+                for (size_t i = 0; i < kept.size(); ++i) {
+                    bsonKept << kept[i];
+                }
+                ASSERT_EQUALS( fromjson( "{'':[{_id:0,a:{b:1},c:1},{_id:0,a:{b:3},c:1},"
+                                               "{_id:1,a:{b:5},c:2}]}" )[ "" ].embeddedObject(),
+                               bsonKept.arr() );
+            }
+        };
+
     } // namespace DocumentSourceUnwind
 
     namespace DocumentSourceGeoNear {
@@ -1954,6 +1985,7 @@ namespace DocumentSourceTests {
             add<DocumentSourceUnwind::SeveralDocuments>();
             add<DocumentSourceUnwind::SeveralMoreDocuments>();
             add<DocumentSourceUnwind::Dependencies>();
+            add<DocumentSourceUnwind::KeepSomeResults>();
 
             add<DocumentSourceGeoNear::LimitCoalesce>();
 
@@ -575,6 +575,96 @@ namespace ExpressionTests {
         
     } // namespace CoerceToBool
 
+    namespace CommonSubexpression {
+
+        class Base {
+        public:
+            virtual ~Base() {}
+        protected:
+            intrusive_ptr<Expression> parse(const char* json) {
+                BSONObj obj = fromjson(json);
+                _specs.push_back(obj);
+                return Expression::parseOperand(obj.firstElement(), VariablesParseState(&_ids));
+            }
+            VariablesIdGenerator _ids;
+        private:
+            vector<BSONObj> _specs;
+        };
+
+        /** A subexpression repeated across trees is shared, and still serializes the same. */
+        class SharedAcrossTrees : public Base {
+        public:
+            void run() {
+                intrusive_ptr<Expression> sum =
+                    parse("{'':{$add:[{$multiply:['$a','$b']},1]}}")->optimize();
+                intrusive_ptr<Expression> product =
+                    parse("{'':{$multiply:['$a','$b']}}")->optimize();
+
+                vector<intrusive_ptr<Expression>*> roots;
+                roots.push_back(&sum);
+                roots.push_back(&product);
+                ASSERT_EQUALS(1U, Expression::shareCommonSubexpressions(roots,
+                                                                        _ids.getIdCount()));
+
+                ASSERT(dynamic_cast<ExpressionCommonSubexpression*>(product.get()));
+                assertBinaryEqual(fromjson("{$add:[{$multiply:['$a','$b']},{$const:1}]}"),
+                                  expressionToBson(sum));
+                assertBinaryEqual(fromjson("{$multiply:['$a','$b']}"), expressionToBson(product));
+
+                Variables vars(1);
+                vars.clearOnNewRoot(0);
+                vars.setRoot(fromBson(BSON("a" << 2 << "b" << 3)));
+                ASSERT_EQUALS(Value(7), sum->evaluate(&vars));
+                ASSERT_EQUALS(Value(6), product->evaluate(&vars));
+
+                // A new ROOT is evaluated afresh.
+                vars.setRoot(fromBson(BSON("a" << 4 << "b" << 5)));
+                ASSERT_EQUALS(Value(20), product->evaluate(&vars));
+                ASSERT_EQUALS(Value(21), sum->evaluate(&vars));
+            }
+        };
+
+        /** Trees which appear only once, and field paths, are left as they are. */
+        class NothingRepeated : public Base {
+        public:
+            void run() {
+                intrusive_ptr<Expression> sum = parse("{'':{$add:['$a','$b']}}")->optimize();
+                intrusive_ptr<Expression> product =
+                    parse("{'':{$multiply:['$a','$b']}}")->optimize();
+                vector<intrusive_ptr<Expression>*> roots;
+                roots.push_back(&sum);
+                roots.push_back(&product);
+                ASSERT_EQUALS(0U, Expression::shareCommonSubexpressions(roots, 0));
+                ASSERT(!dynamic_cast<ExpressionCommonSubexpression*>(sum.get()));
+                ASSERT(!dynamic_cast<ExpressionCommonSubexpression*>(product.get()));
+            }
+        };
+
+        /** The 'in' of a $let can see other values of CURRENT, so it isn't shared. */
+        class NotWithinLet : public Base {
+        public:
+            void run() {
+                intrusive_ptr<Expression> product =
+                    parse("{'':{$multiply:['$a','$b']}}")->optimize();
+                intrusive_ptr<Expression> let =
+                    parse("{'':{$let:{vars:{CURRENT:'$sub'},in:{$multiply:['$a','$b']}}}}")
+                        ->optimize();
+                vector<intrusive_ptr<Expression>*> roots;
+                roots.push_back(&product);
+                roots.push_back(&let);
+                const Variables::Id numVars =
+                    Expression::shareCommonSubexpressions(roots, _ids.getIdCount());
+                ASSERT_EQUALS(_ids.getIdCount(), numVars);
+
+                Variables vars(numVars);
+                vars.setRoot(fromBson(fromjson("{a:1,b:2,sub:{a:3,b:4}}")));
+                ASSERT_EQUALS(Value(2), product->evaluate(&vars));
+                ASSERT_EQUALS(Value(12), let->evaluate(&vars));
+            }
+        };
+
+    } // namespace CommonSubexpression
+
     namespace Compare {
 
         class OptimizeBase {
@@ -3499,6 +3589,9 @@ namespace ExpressionTests {
             add<CoerceToBool::Dependencies>();
             add<CoerceToBool::AddToBsonObj>();
             add<CoerceToBool::AddToBsonArray>();
+            add<CommonSubexpression::SharedAcrossTrees>();
+            add<CommonSubexpression::NothingRepeated>();
+            add<CommonSubexpression::NotWithinLet>();
 
             add<Compare::EqLt>();
             add<Compare::EqEq>();
@@ -112,6 +112,8 @@ namespace mongo {
 
         int runDbTests(int argc, char** argv) {
             frameworkGlobalParams.perfHist = 1;
+            frameworkGlobalParams.perfTrials = 1;
+            frameworkGlobalParams.perfWarmupMillis = 0;
             frameworkGlobalParams.seed = time( 0 );
             frameworkGlobalParams.runsPerTest = 1;
 
@@ -33,6 +33,7 @@
 #include <boost/filesystem/operations.hpp>
 #include <iostream>
 
+#include "mongo/base/parse_number.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/query/find.h"
@@ -43,6 +44,7 @@
 #include "mongo/util/log.h"
 #include "mongo/util/options_parser/startup_options.h"
 #include "mongo/util/password.h"
+#include "mongo/util/stringutils.h"
 
 namespace mongo {
 
@@ -86,6 +88,18 @@ namespace mongo {
         options->addOptionChaining("perfHist", "perfHist", moe::Unsigned,
                 "number of back runs of perf stats to display");
 
+        options->addOptionChaining("perfTrials", "perfTrials", moe::Unsigned,
+                "number of timed trials of each perf test");
+
+        options->addOptionChaining("perfWarmupMillis", "perfWarmupMillis", moe::Unsigned,
+                "milliseconds to run each perf test before timing it");
+
+        options->addOptionChaining("perfThreads", "perfThreads", moe::String,
+                "comma separated thread counts to run threaded perf tests with");
+
+        options->addOptionChaining("perfJson", "perfJson", moe::String,
+                "file to append perf test results to, one JSON document per line");
+
         options->addOptionChaining("storage.engine", "storageEngine", moe::String,
                                    "what storage engine to use")
                .setDefault(moe::Value(std::string("mmapv1")));
@@ -148,6 +162,36 @@ namespace mongo {
             frameworkGlobalParams.perfHist = params["perfHist"].as<unsigned>();
         }
 
+        if (params.count("perfTrials")) {
+            frameworkGlobalParams.perfTrials = params["perfTrials"].as<unsigned>();
+            if (frameworkGlobalParams.perfTrials == 0) {
+                return Status(ErrorCodes::BadValue, "perfTrials must be at least 1");
+            }
+        }
+
+        if (params.count("perfWarmupMillis")) {
+            frameworkGlobalParams.perfWarmupMillis = params["perfWarmupMillis"].as<unsigned>();
+        }
+
+        if (params.count("perfThreads")) {
+            std::vector<std::string> counts;
+            splitStringDelim(params["perfThreads"].as<string>(), &counts, ',');
+            for (size_t i = 0; i < counts.size(); ++i) {
+                int count = 0;
+                Status status = parseNumberFromString(counts[i], &count);
+                if (!status.isOK() || count <= 0) {
+                    return Status(ErrorCodes::BadValue,
+                                  str::stream() << "invalid perfThreads thread count: "
+                                                << counts[i]);
+                }
+                frameworkGlobalParams.perfThreadCounts.push_back(count);
+            }
+        }
+
+        if (params.count("perfJson")) {
+            frameworkGlobalParams.perfJsonPath = params["perfJson"].as<string>();
+        }
+
         bool nodur = false;
         if( params.count("nodur") ) {
             nodur = true;
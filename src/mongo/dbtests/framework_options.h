@@ -44,6 +44,10 @@ namespace mongo {
 
     struct FrameworkGlobalParams {
         unsigned perfHist;
+        unsigned perfTrials;
+        unsigned perfWarmupMillis;
+        std::vector<int> perfThreadCounts;
+        std::string perfJsonPath;
         unsigned long long seed;
         int runsPerTest;
         std::string dbpathSpec;
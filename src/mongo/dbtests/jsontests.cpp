@@ -2675,6 +2675,53 @@ namespace JsonTests {
             }
         };
 
+        class EscapesAfterPlainRuns {
+        public:
+            void run() {
+                // Move each escape sequence across the boundaries of the chunks plain
+                // characters are scanned in.
+                for (size_t i = 0; i < 40; ++i) {
+                    const string before(i, 'a');
+                    const string after(39 - i, 'b');
+                    ASSERT_EQUALS(BSON("x" << before + "\"" + after << "y" << before + "'"),
+                                  fromjson("{ \"x\" : \"" + before + "\\\"" + after +
+                                           "\", y : '" + before + "\\'' }"));
+                    ASSERT_EQUALS(BSON("x" << before + "\\" + after),
+                                  fromjson("{ x : \"" + before + "\\\\" + after + "\" }"));
+                    ASSERT_EQUALS(BSON("x" << before + "\xc3\xa9" + after),
+                                  fromjson("{ x : \"" + before + "\\u00e9" + after + "\" }"));
+                    ASSERT_EQUALS(BSON(before + "\t" + after << 1),
+                                  fromjson("{ \"" + before + "\\t" + after + "\" : 1 }"));
+                    ASSERT_THROWS(fromjson("{ x : \"" + before + "\x01" + after + "\" }"),
+                                  MsgAssertionException);
+                    ASSERT_THROWS(fromjson("{ x : \"" + before + after), MsgAssertionException);
+                }
+            }
+        };
+
+        class NumericBoundaries {
+        public:
+            void run() {
+                BSONObjBuilder b;
+                b.append("a", 999999999999999999LL);
+                b.append("b", -999999999999999999LL);
+                b.append("c", 1000000000000000000LL);
+                b.append("d", 2147483647);
+                b.append("e", 2147483648LL);
+                b.append("f", -2147483647 - 1);
+                b.append("g", -2147483649LL);
+                b.append("h", 0);
+                b.append("i", 16.0);
+                b.append("j", 100.0);
+                b.append("k", 7);
+                ASSERT_EQUALS(b.obj(),
+                              fromjson("{ a : 999999999999999999, b : -999999999999999999, "
+                                       "c : 1000000000000000000, d : 2147483647, "
+                                       "e : 2147483648, f : -2147483648, g : -2147483649, "
+                                       "h : -0, i : 0x10, j : 10e1, k : 007 }"));
+            }
+        };
+
     } // namespace FromJsonTests
 
     class All : public Suite {
@@ -2938,6 +2985,8 @@ namespace JsonTests {
             add< FromJsonTests::NullFieldUnquoted >();
             add< FromJsonTests::MinKey >();
             add< FromJsonTests::MaxKey >();
+            add< FromJsonTests::EscapesAfterPlainRuns >();
+            add< FromJsonTests::NumericBoundaries >();
         }
     };
 
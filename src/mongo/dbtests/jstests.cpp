@@ -157,6 +157,31 @@ namespace JSTests {
         }
     };
 
+    /** Functions are compiled once per scope, including ones installed under a name. */
+    class CompiledFunctionCache {
+    public:
+        void run() {
+            scoped_ptr<Scope> s( globalScriptEngine->newScope() );
+            const char* code = "function( z ){ return z * 2; }";
+
+            ScriptingFunction func = s->createFunction( code );
+            ASSERT( func );
+            ASSERT_EQUALS( func , s->createFunction( code ) );
+
+            s->setFunction( "twice" , code );
+            s->setFunction( "again" , code );
+            ASSERT( s->exec( "assert( twice === again ); assert.eq( 6, twice( 3 ) );" ,
+                             "test" , false , true , false ) );
+
+            // code which fails to compile doesn't throw off the numbering of later functions
+            ASSERT_THROWS( s->createFunction( "function( {" ) , UserException );
+            ScriptingFunction next = s->createFunction( "function(){ return 17; }" );
+            ASSERT_NOT_EQUALS( func , next );
+            s->invoke( next , 0 , 0 );
+            ASSERT_EQUALS( 17 , s->getNumber( "__returnValue" ) );
+        }
+    };
+
     /** Installs a tee for auditing log messages in the same thread. */
     class LogRecordingScope {
     public:
@@ -2081,6 +2106,7 @@ namespace JSTests {
             add< ResetScope >();
             add< FalseTests >();
             add< SimpleFunctions >();
+            add< CompiledFunctionCache >();
             add< ExecLogError >();
             add< InvokeLogError >();
             add< ExecTimeout >();
@@ -38,11 +38,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
 #include <boost/thread/condition.hpp>
 #include <boost/version.hpp>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <fstream>
@@ -52,21 +54,27 @@
 #include "mongo/db/client.h"
 #include "mongo/db/db.h"
 #include "mongo/db/dbdirectclient.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/json.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/pipeline/document.h"
 #include "mongo/db/storage/mmap_v1/durable_mapped_file.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/btree/key.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mmap.h"
+#include "mongo/util/string_map.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
 #include "mongo/db/concurrency/lock_state.h"
@@ -185,6 +193,94 @@ namespace PerfTests {
     }
 
 
+    /**
+     * The timings of the trials of one perf test, reported to --perfJson.
+     */
+    class PerfSamples {
+    public:
+        /** Records a batch of "n" operations which took "us" microseconds. */
+        void addBatch(unsigned long long n, long long us) {
+            if( n > 0 )
+                _opMicros.push_back(static_cast<double>(us) / n);
+        }
+
+        /** Records a trial which performed "n" operations in "us" microseconds. */
+        void addTrial(unsigned long long n, long long us) {
+            _trialRps.push_back(n * 1000.0 * 1000.0 / (us > 0 ? us : 1));
+        }
+
+        /**
+         * The mean, standard deviation and range of the trials' rates, and percentiles of the
+         * time per operation.  Operations are timed a batch at a time, so the percentiles are of
+         * each batch's average.
+         */
+        BSONObj toBSON(const string& test, int threads) const {
+            bob b;
+            b.append("test", test);
+            b.append("threads", threads);
+            b.append("trials", static_cast<int>(_trialRps.size()));
+            b.append("warmupMillis", static_cast<int>(frameworkGlobalParams.perfWarmupMillis));
+
+            if( !_trialRps.empty() ) {
+                double sum = 0;
+                for( size_t i = 0; i < _trialRps.size(); i++ )
+                    sum += _trialRps[i];
+                const double mean = sum / _trialRps.size();
+                double squares = 0;
+                for( size_t i = 0; i < _trialRps.size(); i++ )
+                    squares += (_trialRps[i] - mean) * (_trialRps[i] - mean);
+                const double stddev = _trialRps.size() > 1 ?
+                        std::sqrt(squares / (_trialRps.size() - 1)) : 0;
+                b.append("rps", BSON("mean" << mean
+                                  << "stddev" << stddev
+                                  << "min" << *std::min_element(_trialRps.begin(),
+                                                                _trialRps.end())
+                                  << "max" << *std::max_element(_trialRps.begin(),
+                                                                _trialRps.end())));
+            }
+
+            if( !_opMicros.empty() ) {
+                vector<double> sorted(_opMicros);
+                std::sort(sorted.begin(), sorted.end());
+                b.append("opMicros", BSON("p50" << percentile(sorted, 0.5)
+                                       << "p90" << percentile(sorted, 0.9)
+                                       << "p99" << percentile(sorted, 0.99)
+                                       << "p999" << percentile(sorted, 0.999)));
+            }
+
+            b.append("storageEngine", storageGlobalParams.engine);
+            b.appendBool("dur", storageGlobalParams.dur);
+            b.append("version", versionString);
+            b.append("git", gitVersion());
+            DEV b.append("DEBUG", true);
+            return b.obj();
+        }
+
+    private:
+        static double percentile(const vector<double>& sorted, double quantile) {
+            size_t index = static_cast<size_t>(std::ceil(quantile * sorted.size()));
+            return sorted[index > 0 ? index - 1 : 0];
+        }
+
+        vector<double> _trialRps;
+        vector<double> _opMicros;
+    };
+
+    /** Appends the results of a perf test to the --perfJson file, if there is one. */
+    void reportJson(const string& test, int threads, const PerfSamples& samples) {
+        if( frameworkGlobalParams.perfJsonPath.empty() )
+            return;
+
+        std::ofstream out(frameworkGlobalParams.perfJsonPath.c_str(),
+                          std::ios::out | std::ios::app);
+        if( !out.good() ) {
+            warning() << "couldn't open " << frameworkGlobalParams.perfJsonPath
+                      << " to save perf results" << endl;
+            return;
+        }
+        out << samples.toBSON(test, threads).jsonString() << '\n';
+    }
+
     class B : public ClientBase {
         string _ns;
     protected:
@@ -308,6 +404,11 @@ namespace PerfTests {
         */
         virtual bool testThreaded() { return false; }
 
+        /** the numbers of threads testThreaded() runs timed2() with. results for other than 8
+            threads have the thread count appended to the test name.
+        */
+        virtual std::vector<int> threadCounts() { return std::vector<int>(1, 8); }
+
         int howLong() { 
             int hlm = howLongMillis();
             DEV {
@@ -319,59 +420,101 @@ namespace PerfTests {
 
         void run() {
 
-            unsigned long long n = 0;
-
             _ns = string("perftest.") + name();
             client()->dropCollection(ns());
             prep();
             int hlm = howLong();
-            mongo::Timer t;
-            n = 0;
-            const unsigned int Batch = batchSize();
 
             if( hlm == 0 ) {
                 // means just do once
+                PerfSamples samples;
+                mongo::Timer t;
                 timed();
+                client()->getLastError(); // block until all ops are finished
+                const long long us = t.micros();
+                say(0, us, name());
+                samples.addBatch(1, us);
+                samples.addTrial(1, us);
+                reportJson(name(), 1, samples);
             }
             else {
-                do {
-                    unsigned int i;
-                    for( i = 0; i < Batch; i++ )
-                        timed();
-                    n += i;
-                } while( t.micros() < (hlm * 1000) );
+                runTrials(name(), hlm, false);
             }
 
-            client()->getLastError(); // block until all ops are finished
-
-            say(n, t.micros(), name());
-
             post();
 
             string test2name = name2();
             {
                 if( test2name != name() ) {
                     dur::stats.curr()->reset();
-                    mongo::Timer t;
-                    unsigned long long n = 0;
-                    while( 1 ) {
-                        unsigned int i;
-                        for( i = 0; i < Batch; i++ )
-                            timed2(client());
-                        n += i;
-                        if( t.millis() > hlm )
-                            break;
-                    }
-                    say(n, t.micros(), test2name);
+                    runTrials(test2name, hlm, true);
                 }
             }
 
             if( testThreaded() ) {
-                const int nThreads = 8;
-                //cout << "testThreaded nThreads:" << nThreads << endl;
+                const std::vector<int> counts = frameworkGlobalParams.perfThreadCounts.empty() ?
+                        threadCounts() : frameworkGlobalParams.perfThreadCounts;
+                for( size_t i = 0; i < counts.size(); i++ ) {
+                    const int nThreads = counts[i];
+                    //cout << "testThreaded nThreads:" << nThreads << endl;
+                    string threadedName = test2name + "-threaded";
+                    if( nThreads != 8 )
+                        threadedName += str::stream() << nThreads;
+                    PerfSamples samples;
+                    for( unsigned trial = 0; trial < frameworkGlobalParams.perfTrials; trial++ ) {
+                        mongo::Timer t;
+                        const unsigned long long result = launchThreads(nThreads);
+                        const long long us = t.micros();
+                        say(result/nThreads, us, threadedName);
+                        samples.addTrial(result/nThreads, us);
+                    }
+                    reportJson(threadedName, nThreads, samples);
+                }
+            }
+        }
+
+        /**
+         * Runs timed(), or timed2() if "second", for --perfWarmupMillis and then for "hlm"
+         * milliseconds in each of --perfTrials trials, reporting each trial as "testName".
+         */
+        void runTrials(const string& testName, int hlm, bool second) {
+            const unsigned int Batch = batchSize();
+            PerfSamples samples;
+
+            const long long warmupMillis = frameworkGlobalParams.perfWarmupMillis;
+            mongo::Timer warmup;
+            while( warmup.millis() < warmupMillis ) {
+                runBatch(Batch, second);
+            }
+
+            for( unsigned trial = 0; trial < frameworkGlobalParams.perfTrials; trial++ ) {
                 mongo::Timer t;
-                const unsigned long long result = launchThreads(nThreads);
-                say(result/nThreads, t.micros(), test2name+"-threaded");
+                unsigned long long n = 0;
+                do {
+                    mongo::Timer batchTimer;
+                    runBatch(Batch, second);
+                    n += Batch;
+                    samples.addBatch(Batch, batchTimer.micros());
+                } while( t.micros() < (hlm * 1000) );
+
+                client()->getLastError(); // block until all ops are finished
+                const long long us = t.micros();
+                say(n, us, testName);
+                samples.addTrial(n, us);
+            }
+
+            reportJson(testName, 1, samples);
+        }
+
+        void runBatch(unsigned int Batch, bool second) {
+            if( second ) {
+                DBClientBase* c = client();
+                for( unsigned int i = 0; i < Batch; i++ )
+                    timed2(c);
+            }
+            else {
+                for( unsigned int i = 0; i < Batch; i++ )
+                    timed();
             }
         }
 
@@ -496,6 +639,207 @@ namespace PerfTests {
         }
     };
 
+    /**
+     * Compares KeyStrings for compound keys that differ only in their last field, like those of
+     * an index on {tenantId: 1, ts: 1, x: 1}.
+     */
+    class KeyStringCompare : public B {
+    public:
+        KeyString a, b;
+        string name() { return "KeyString-compare-sharedPrefix"; }
+        virtual int howLongMillis() { return 3000; }
+        KeyStringCompare() :
+          a(BSON("" << string(24, 't') << "" << Timestamp(1000, 1) << "" << 1),
+            Ordering::make(BSONObj())),
+          b(BSON("" << string(24, 't') << "" << Timestamp(1000, 1) << "" << 2),
+            Ordering::make(BSONObj()))
+          {}
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            verify( a.compare(b) < 0 );
+            verify( b.compare(a) > 0 );
+        }
+    };
+
+    /**
+     * The same comparison as KeyStringCompare, done with plain memcmp for reference.
+     */
+    class KeyStringMemcmp : public KeyStringCompare {
+    public:
+        string name() { return "KeyString-memcmp-sharedPrefix"; }
+        void timed() {
+            const size_t size = std::min(a.getSize(), b.getSize());
+            verify( memcmp(a.getBuffer(), b.getBuffer(), size) < 0 );
+            verify( memcmp(b.getBuffer(), a.getBuffer(), size) > 0 );
+        }
+    };
+
+    /**
+     * Looks up field name sized keys in a map of 200 of them, with as many misses as hits.
+     */
+    template <typename Map>
+    class MapLookup : public B {
+    public:
+        Map map;
+        std::vector<string> keys;
+        size_t next;
+        MapLookup() : next(0) {
+            for ( int i = 0; i < 200; i++ ) {
+                const string key = str::stream() << "field" << i;
+                map[key] = i;
+                keys.push_back(key);
+                keys.push_back(str::stream() << "other" << i);
+            }
+        }
+        virtual int howLongMillis() { return 3000; }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            const string& key = keys[next];
+            next = (next + 1) % keys.size();
+            const bool found = map.find(key) != map.end();
+            verify( found == (key.compare(0, 5, "field") == 0) );
+        }
+    };
+
+    class StringMapLookup : public MapLookup< StringMap<int> > {
+    public:
+        string name() { return "StringMap-lookup"; }
+    };
+
+    class GroupedStringMapLookup : public MapLookup< GroupedStringMap<int> > {
+    public:
+        string name() { return "GroupedStringMap-lookup"; }
+    };
+
+    /**
+     * Parses a document shaped like those sent to the REST interface: quoted field names, mostly
+     * strings and small integers, and an occasional escape sequence.
+     */
+    class FromJson : public B {
+    public:
+        string json;
+        string name() { return "fromjson"; }
+        virtual int howLongMillis() { return 3000; }
+        virtual bool showDurStats() { return false; }
+        FromJson() {
+            str::stream ss;
+            ss << "{ \"_id\" : \"user-000123\", \"profile\" : { \"name\" : \"Jane Q. Public\", "
+               << "\"bio\" : \"Likes \\\"quoted\\\" text\\nand newlines\", \"age\" : 37 }, "
+               << "\"tags\" : [";
+            for ( int i = 0; i < 20; i++ ) {
+                ss << ( i ? ", " : "" ) << "\"tag-number-" << i << "\"";
+            }
+            ss << "], \"scores\" : [";
+            for ( int i = 0; i < 20; i++ ) {
+                ss << ( i ? ", " : "" ) << i * 1000 + 7;
+            }
+            ss << "], \"ratio\" : 0.25, \"active\" : true, \"ts\" : 1420070400000 }";
+            json = ss;
+        }
+        void timed() {
+            verify( fromjson(json).nFields() == 7 );
+        }
+    };
+
+    /**
+     * Encodes the compound key of KeyStringCompare.
+     */
+    class KeyStringEncode : public B {
+    public:
+        BSONObj key;
+        string name() { return "KeyString-encode-compound"; }
+        virtual int howLongMillis() { return 3000; }
+        KeyStringEncode() :
+          key(BSON("" << string(24, 't') << "" << Timestamp(1000, 1) << "" << 1))
+          {}
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            KeyString ks(key, Ordering::make(BSONObj()));
+            verify( ks.getSize() > 0 );
+        }
+    };
+
+    /**
+     * Decodes the compound key of KeyStringCompare back into BSON.
+     */
+    class KeyStringDecode : public KeyStringEncode {
+    public:
+        KeyString ks;
+        string name() { return "KeyString-decode-compound"; }
+        KeyStringDecode() : ks(key, Ordering::make(BSONObj())) {}
+        void timed() {
+            BSONObj decoded = KeyString::toBson(ks.getBuffer(), ks.getSize(),
+                                                Ordering::make(BSONObj()), ks.getTypeBits());
+            verify( decoded.nFields() == 3 );
+        }
+    };
+
+    /**
+     * Hashes a shard-key-like value with the given hashVersion, as hashed indexes do on every
+     * insert and mongos does to target hashed-sharded writes.
+     */
+    template <int HashVersion>
+    class HashElement : public B {
+    public:
+        BSONObj obj;
+        string name() {
+            return str::stream() << "BSONElementHasher-hash64-v" << HashVersion;
+        }
+        virtual int howLongMillis() { return 3000; }
+        HashElement() : obj(BSON("user" << string(24, 'u'))) {}
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            long long h = BSONElementHasher::hash64(obj.firstElement(),
+                                                    BSONElementHasher::DEFAULT_HASH_SEED,
+                                                    HashVersion);
+            verify( h != 0 );
+        }
+    };
+
+    /**
+     * Evaluates a parsed query predicate against a document, the way collection scans do.
+     */
+    class MatchExpressionEval : public B {
+    public:
+        boost::scoped_ptr<MatchExpression> expr;
+        BSONObj doc;
+        string name() { return "MatchExpression-matchesBSON"; }
+        virtual int howLongMillis() { return 3000; }
+        MatchExpressionEval() :
+          doc(BSON("_id" << 1 << "a" << 10 << "b" << "xyz" << "c" << BSON_ARRAY(1 << 2 << 3)
+                     << "d" << BSON("e" << 5)))
+          {
+            StatusWithMatchExpression parsed = MatchExpressionParser::parse(
+                BSON("a" << BSON("$gt" << 5) << "b" << BSON("$in" << BSON_ARRAY("abc" << "xyz"))
+                     << "c" << 2 << "d.e" << BSON("$lte" << 5)));
+            verify( parsed.isOK() );
+            expr.reset(parsed.getValue());
+          }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            verify( expr->matchesBSON(doc) );
+        }
+    };
+
+    /**
+     * Converts a document to a pipeline Document and back, as aggregation stages do.
+     */
+    class DocumentRoundTrip : public B {
+    public:
+        BSONObj doc;
+        string name() { return "Document-fromBson-toBson"; }
+        virtual int howLongMillis() { return 3000; }
+        DocumentRoundTrip() :
+          doc(BSON("_id" << 1 << "a" << 10 << "b" << "xyz" << "c" << BSON_ARRAY(1 << 2 << 3)
+                     << "d" << BSON("e" << 5 << "f" << 2.5)))
+          {}
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            Document converted(doc);
+            verify( converted.toBson().nFields() == 5 );
+        }
+    };
+
     unsigned long long aaa;
 
     class Timer : public B {
@@ -551,6 +895,26 @@ namespace PerfTests {
             c.notify_one();
         }
     };
+    // Fan out a batch of small tasks and wait for them, as the repl writer pool does per batch.
+    class ThreadPoolScheduleJoin : public B {
+    public:
+        ThreadPoolScheduleJoin() : _pool(8, "perftest worker ") { }
+        string name() { return "threadpool-schedule-join"; }
+        virtual int howLongMillis() { return 500; }
+        virtual bool showDurStats() { return false; }
+        void timed() {
+            for (int i = 0; i < 16; i++) {
+                _pool.scheduleWithAffinity(i, stdx::bind(&ThreadPoolScheduleJoin::work, this));
+            }
+            _pool.join();
+        }
+    private:
+        void work() {
+            _counter.fetchAndAdd(1);
+        }
+        ThreadPool _pool;
+        AtomicUInt32 _counter;
+    };
     class boostmutexspeed : public B {
     public:
         string name() { return "boost::mutex"; }
@@ -660,6 +1024,15 @@ namespace PerfTests {
         }
         virtual bool showDurStats() { return false; }
         virtual bool testThreaded() { return true; }
+        virtual std::vector<int> threadCounts() {
+            // Shows how intent locks on the global and database resources scale with the
+            // number of threads.
+            std::vector<int> counts;
+            for (int n = 1; n <= 64; n *= 2) {
+                counts.push_back(n);
+            }
+            return counts;
+        }
         virtual void prep() {
             resId.reset(new ResourceId(RESOURCE_COLLECTION, std::string("TestDB.collection")));
             locker.reset(new MMAPV1LockerImpl());
@@ -748,6 +1121,31 @@ namespace PerfTests {
         locker_uncontestedS() : locker_test_uncontested(MODE_S, MODE_IS) { }
     };
 
+    /**
+     * All threads take the same database in an intent mode, as operations on different
+     * collections of one database do.
+     */
+    class locker_dbIntent : public locker_test {
+    public:
+        locker_dbIntent() : locker_test(MODE_IX, MODE_IX) { }
+        virtual string name() {
+            return (str::stream() << "locker_dbIntent" << lockMode);
+        }
+
+        virtual void prep() {
+            resId.reset(new ResourceId(RESOURCE_DATABASE, std::string("TestDB")));
+            locker.reset(new MMAPV1LockerImpl());
+        }
+
+        virtual void prepThreaded() {
+            resId.reset(new ResourceId(RESOURCE_DATABASE, std::string("TestDB")));
+            id.reset(new int);
+            lock.lock();
+            lock.unlock();
+            locker.reset(new MMAPV1LockerImpl());
+        }
+    };
+
     class CTM : public B {
     public:
         CTM() : last(0), delts(0), n(0) { }
@@ -775,6 +1173,22 @@ namespace PerfTests {
                 cout << "      avg timer granularity: " << ((double)delts)/n << "ms " << endl;
         }
     };
+    // Generating OIDs from many threads at once, as mongos does for the documents of insert
+    // batches.
+    class OIDGen : public B {
+    public:
+        string name() { return "OID::gen"; }
+        virtual int howLongMillis() { return 500; }
+        virtual bool showDurStats() { return false; }
+        virtual bool testThreaded() { return true; }
+        virtual string name2() { return name(); }
+        void timed() {
+            aaa += OID::gen().getIncrement().bytes[2];
+        }
+        virtual void timed2(DBClientBase*) {
+            timed();
+        }
+    };
     class CTMicros : public B {
     public:
         CTMicros() : last(0), delts(0), n(0) { }
@@ -1146,6 +1560,24 @@ namespace PerfTests {
         }
     };
 
+    /**
+     * Inserts documents 100 at a time, through the storage engine's batched insert path.
+     */
+    class InsertBatch : public B {
+        unsigned i;
+    public:
+        virtual int howLongMillis() { return profiling ? 30000 : 5000; }
+        virtual unsigned batchSize() { return 1; }
+        InsertBatch() : i(0) {}
+        string name() { return "insert-batch100"; }
+        void timed() {
+            vector<BSONObj> docs;
+            for( int j = 0; j < 100; j++ )
+                docs.push_back( BSON( "_id" << i++ << "x" << 99 ) );
+            client()->insert( ns(), docs );
+        }
+    };
+
     class InsertRandom : public B {
     public:
         virtual int howLongMillis() { return profiling ? 30000 : 5000; }
@@ -1445,7 +1877,9 @@ namespace PerfTests {
                 add< locker_uncontestedX >();
                 add< locker_contestedS >();
                 add< locker_uncontestedS >();
+                add< locker_dbIntent >();
                 add< NotifyOne >();
+                add< ThreadPoolScheduleJoin >();
                 add< simplemutexspeed >();
                 add< boostmutexspeed >();
                 add< boosttimed_mutexspeed >();
@@ -1457,7 +1891,19 @@ namespace PerfTests {
 #endif
                 add< CTM >();
                 add< CTMicros >();
+                add< OIDGen >();
                 add< KeyTest >();
+                add< KeyStringCompare >();
+                add< KeyStringMemcmp >();
+                add< KeyStringEncode >();
+                add< KeyStringDecode >();
+                add< StringMapLookup >();
+                add< GroupedStringMapLookup >();
+                add< FromJson >();
+                add< HashElement<BSONElementHasher::HASH_VERSION_MD5> >();
+                add< HashElement<BSONElementHasher::HASH_VERSION_MURMUR3> >();
+                add< MatchExpressionEval >();
+                add< DocumentRoundTrip >();
                 add< Bldr >();
                 add< StkBldr >();
                 add< BSONIter >();
@@ -1471,6 +1917,7 @@ namespace PerfTests {
                 add< Update1 >();
                 add< MoreIndexes<Update1> >();
                 add< InsertBig >();
+                add< InsertBatch >();
                 add< FailPointTest<false, false> >();
                 add< FailPointTest<true, false> >();
                 add< FailPointTest<true, true> >();
@@ -45,6 +45,100 @@ namespace PipelineTests {
     namespace Optimizations {
         using namespace mongo;
 
+        namespace Local {
+            class Base {
+            public:
+                // These return json arrays of pipeline operators
+                virtual string inputPipeJson() = 0;
+                virtual string outputPipeJson() = 0;
+
+                virtual void run() {
+                    const BSONObj inputBson = fromjson("{pipeline: " + inputPipeJson() + "}");
+                    const BSONObj outputExpected = fromjson("{pipeline: " + outputPipeJson() + "}");
+
+                    intrusive_ptr<ExpressionContext> ctx =
+                        new ExpressionContext(&_opCtx, NamespaceString("a.collection"));
+                    string errmsg;
+                    intrusive_ptr<Pipeline> pipeline =
+                        Pipeline::parseCommand(errmsg, inputBson, ctx);
+                    ASSERT_EQUALS(errmsg, "");
+                    ASSERT(pipeline != NULL);
+
+                    ASSERT_EQUALS(pipeline->serialize()["pipeline"],
+                                  Value(outputExpected["pipeline"]));
+                }
+
+                virtual ~Base() {};
+
+            private:
+                OperationContextImpl _opCtx;
+            };
+
+            class MatchBeforeSort : public Base {
+                string inputPipeJson() { return "[{$sort: {b: 1}}, {$match: {a: 1}}]"; }
+                string outputPipeJson() { return "[{$match: {a: 1}}, {$sort: {b: 1}}]"; }
+            };
+
+            class MatchBeforeProjectKeepingFields : public Base {
+                string inputPipeJson() {
+                    return "[{$project: {_id: true, a: true, b: '$b', c: '$d'}}"
+                           ",{$match: {_id: 1, 'a.x': 1, $or: [{b: 1}, {b: 2}]}}]";
+                }
+                string outputPipeJson() {
+                    return "[{$match: {_id: 1, 'a.x': 1, $or: [{b: 1}, {b: 2}]}}"
+                           ",{$project: {_id: true, a: true, b: '$b', c: '$d'}}]";
+                }
+            };
+
+            class MatchOnComputedFieldStays : public Base {
+                string inputPipeJson() {
+                    return "[{$project: {_id: false, a: true, c: '$d'}}"
+                           ",{$match: {a: 1, c: 1}}]";
+                }
+                string outputPipeJson() {
+                    return "[{$project: {_id: false, a: true, c: '$d'}}"
+                           ",{$match: {a: 1, c: 1}}]";
+                }
+            };
+
+            class MatchOnExcludedIdStays : public Base {
+                string inputPipeJson() {
+                    return "[{$project: {_id: false, a: true}}, {$match: {_id: 1}}]";
+                }
+                string outputPipeJson() {
+                    return "[{$project: {_id: false, a: true}}, {$match: {_id: 1}}]";
+                }
+            };
+
+            class MatchBeforeUnwindOfOtherField : public Base {
+                string inputPipeJson() {
+                    return "[{$unwind: '$a.b'}, {$sort: {c: 1}}, {$match: {'a.c': 1, d: 1}}]";
+                }
+                string outputPipeJson() {
+                    return "[{$match: {'a.c': 1, d: 1}}, {$unwind: '$a.b'}"
+                           ",{$sort: {c: 1}}]";
+                }
+            };
+
+            class MatchOnUnwoundFieldStays : public Base {
+                string inputPipeJson() {
+                    return "[{$unwind: '$a.b'}, {$match: {a: 1}}, {$match: {'a.b.c': 1}}]";
+                }
+                string outputPipeJson() {
+                    return "[{$unwind: '$a.b'}, {$match: {$and: [{a: 1}, {'a.b.c': 1}]}}]";
+                }
+            };
+
+            class LimitBeforeProjectAndSkip : public Base {
+                string inputPipeJson() {
+                    return "[{$skip: 2}, {$project: {a: true}}, {$limit: 5}]";
+                }
+                string outputPipeJson() {
+                    return "[{$limit: 7}, {$skip: 2}, {$project: {a: true}}]";
+                }
+            };
+        } // namespace Local
+
         namespace Sharded {
             class Base {
             public:
@@ -184,26 +278,76 @@ namespace PipelineTests {
                     // No new project should be added. This test reflects current behavior where the
                     // 'a' field is still sent because it is explicitly asked for, even though it
                     // isn't actually needed. If this changes in the future, this test will need to
-                    // change.
+                    // change. A $limit would be moved in front of the $project, so this splits the
+                    // pipeline at a $skip, which only runs on the merger.
                     string inputPipeJson() {
                         return "[{$project: {_id:true, a:true}}"
-                               ",{$limit:1}"
+                               ",{$skip:1}"
                                ",{$group: {_id: '$_id'}}"
                                "]";
                     }
                     string shardPipeJson() {
                         return "[{$project: {_id:true, a:true}}"
-                               ",{$limit:1}"
                                "]";
                     }
                     string mergePipeJson() {
-                        return "[{$limit:1}"
+                        return "[{$skip:1}"
                                ",{$group: {_id: '$_id'}}"
                                "]";
                     }
                 };
 
             } // namespace limitFieldsSentFromShardsToMerger
+
+            namespace mergeSortedGroupsFromShards {
+
+                class Group : public Base {
+                    string inputPipeJson() {
+                        return "[{$group: {_id: '$a', n: {$sum: 1}}}]";
+                    }
+                    string shardPipeJson() {
+                        return "[{$group: {_id: '$a', n: {$sum: {$const: 1}}}}"
+                               ",{$sort: {_id: 1}}"
+                               "]";
+                    }
+                    string mergePipeJson() {
+                        return "[{$sort: {_id: 1, $mergePresorted: true}}"
+                               ",{$group: {_id: '$$ROOT._id', n: {$sum: '$$ROOT.n'},"
+                               "           $doingMerge: true}}"
+                               "]";
+                    }
+                };
+
+                class GroupSortedById : public Base {
+                    string inputPipeJson() {
+                        return "[{$group: {_id: '$a'}}, {$sort: {_id: 1}}]";
+                    }
+                    string shardPipeJson() {
+                        return "[{$group: {_id: '$a'}}, {$sort: {_id: 1}}]";
+                    }
+                    string mergePipeJson() {
+                        return "[{$sort: {_id: 1, $mergePresorted: true}}"
+                               ",{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+                               ",{$sort: {_id: 1}}"
+                               "]";
+                    }
+                };
+
+                class GroupSortedByIdDescending : public Base {
+                    string inputPipeJson() {
+                        return "[{$group: {_id: '$a'}}, {$sort: {_id: -1}}]";
+                    }
+                    string shardPipeJson() {
+                        return "[{$group: {_id: '$a'}}, {$sort: {_id: 1}}]";
+                    }
+                    string mergePipeJson() {
+                        return "[{$sort: {_id: 1, $mergePresorted: true}}"
+                               ",{$group: {_id: '$$ROOT._id', $doingMerge: true}}"
+                               ",{$sort: {_id: -1}}"
+                               "]";
+                    }
+                };
+            } // namespace mergeSortedGroupsFromShards
         } // namespace Sharded
     } // namespace Optimizations
 
@@ -212,6 +356,13 @@ namespace PipelineTests {
         All() : Suite( "pipeline" ) {
         }
         void setupTests() {
+            add<Optimizations::Local::MatchBeforeSort>();
+            add<Optimizations::Local::MatchBeforeProjectKeepingFields>();
+            add<Optimizations::Local::MatchOnComputedFieldStays>();
+            add<Optimizations::Local::MatchOnExcludedIdStays>();
+            add<Optimizations::Local::MatchBeforeUnwindOfOtherField>();
+            add<Optimizations::Local::MatchOnUnwoundFieldStays>();
+            add<Optimizations::Local::LimitBeforeProjectAndSkip>();
             add<Optimizations::Sharded::Empty>();
             add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::OneUnwind>();
             add<Optimizations::Sharded::moveFinalUnwindFromShardsToMerger::TwoUnwind>();
@@ -223,6 +374,9 @@ namespace PipelineTests {
             add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::NothingNeeded>();
             add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::JustNeedsMetadata>();
             add<Optimizations::Sharded::limitFieldsSentFromShardsToMerger::ShardAlreadyExhaustive>();
+            add<Optimizations::Sharded::mergeSortedGroupsFromShards::Group>();
+            add<Optimizations::Sharded::mergeSortedGroupsFromShards::GroupSortedById>();
+            add<Optimizations::Sharded::mergeSortedGroupsFromShards::GroupSortedByIdDescending>();
         }
     };
 
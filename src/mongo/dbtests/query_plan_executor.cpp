@@ -504,6 +504,52 @@ namespace QueryPlanExecutor {
             }
         };
 
+        /**
+         * Test that many cursors can be registered, found, erased and timed out, wherever their
+         * ids place them in the cursor manager.
+         */
+        class ManyCursors : public PlanExecutorBase {
+        public:
+            void run() {
+                OldClientWriteContext ctx(&_txn, ns());
+                insert(BSON("a" << 1 << "b" << 1));
+
+                Collection* collection = ctx.getCollection();
+                CursorManager* cursorManager = collection->getCursorManager();
+
+                const size_t numToOpen = 100;
+                std::vector<CursorId> ids;
+                for (size_t i = 0; i < numToOpen; i++) {
+                    BSONObj filterObj = fromjson("{_id: {$gt: 0}, b: {$gt: 0}}");
+                    PlanExecutor* exec = makeCollScanExec(collection, filterObj);
+                    ClientCursor* cc = new ClientCursor(cursorManager, exec, ns(), 0, BSONObj());
+                    ids.push_back(cc->cursorid());
+                }
+                ASSERT_EQUALS(numToOpen, numCursors());
+
+                std::set<CursorId> openCursors;
+                cursorManager->getCursorIds(&openCursors);
+                ASSERT_EQUALS(numToOpen, openCursors.size());
+
+                for (size_t i = 0; i < ids.size(); i++) {
+                    ASSERT(cursorManager->ownsCursorId(ids[i]));
+                    ClientCursorPin pin(cursorManager, ids[i]);
+                    ASSERT(pin.c());
+                    ASSERT_EQUALS(ids[i], pin.c()->cursorid());
+                }
+
+                for (size_t i = 0; i < ids.size(); i += 2) {
+                    ASSERT(cursorManager->eraseCursor(&_txn, ids[i], false));
+                    ASSERT(!cursorManager->eraseCursor(&_txn, ids[i], false));
+                    ASSERT(NULL == cursorManager->find(ids[i], false));
+                }
+                ASSERT_EQUALS(numToOpen / 2, numCursors());
+
+                ASSERT_EQUALS(numToOpen / 2, cursorManager->timeoutCursors(600001));
+                ASSERT_EQUALS(0U, numCursors());
+            }
+        };
+
     } // namespace ClientCursor
 
     class All : public Suite {
@@ -519,6 +565,7 @@ namespace QueryPlanExecutor {
             add<ClientCursor::Invalidate>();
             add<ClientCursor::InvalidatePinned>();
             add<ClientCursor::Timeout>();
+            add<ClientCursor::ManyCursors>();
         }
     };
 
@@ -180,7 +180,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -284,7 +284,7 @@ namespace QueryStageAnd {
             addIndex(BSON("baz" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20 (descending)
             IndexScanParams params;
@@ -371,7 +371,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -426,7 +426,7 @@ namespace QueryStageAnd {
             // before hashed AND is done reading the first child (stage has to
             // hold 21 keys in buffer for Foo <= 20).
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll, 20 * big.size()));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll, 20 * big.size()));
 
             // Foo <= 20
             IndexScanParams params;
@@ -451,6 +451,57 @@ namespace QueryStageAnd {
         }
     };
 
+    // Same as QueryStageAndHashTwoLeafFirstChildLargeKeys, but with only the RecordIds of the
+    // first child kept in memory, the stage fits in the buffer limit.
+    class QueryStageAndHashRecordIdsOnlyFirstChildLargeKeys : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            std::string big(512, 'a');
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i << "big" << big));
+            }
+
+            addIndex(BSON("foo" << 1 << "big" << 1));
+            addIndex(BSON("bar" << 1));
+
+            WorkingSet ws;
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll, 20 * big.size()));
+            ah->setRecordIdsOnly();
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1 << "big" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20 << "" << big);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10
+            params.descriptor = getIndex(BSON("bar" << 1), coll);
+            params.bounds.startKey = BSON("" << 10);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // foo == bar, foo<=20, bar>=10, so our values are:
+            // foo == 10, 11, 12, 13, 14, 15. 16, 17, 18, 19, 20
+            ASSERT_EQUALS(11, countResults(ah.get()));
+            ASSERT_LESS_THAN(ah->getMemUsage(), 20 * big.size());
+        }
+    };
+
     // An AND with three children.
     // Add large keys (512 bytes) to index of last child to verify that
     // keys in last child are not buffered
@@ -479,7 +530,7 @@ namespace QueryStageAnd {
             // keys in last child's index are not buffered. There are 6 keys
             // that satisfy the criteria Foo <= 20 and Bar >= 10 and 5 <= baz <= 15.
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll, 5 * big.size()));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll, 5 * big.size()));
 
             // Foo <= 20
             IndexScanParams params;
@@ -527,7 +578,7 @@ namespace QueryStageAnd {
             addIndex(BSON("baz" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -561,6 +612,64 @@ namespace QueryStageAnd {
         }
     };
 
+    // QueryStageAndHashThreeLeaf with only RecordIds kept, which also has the middle child
+    // produce its results in the reverse order of the last one.
+    class QueryStageAndHashRecordIdsOnlyThreeLeaf : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i << "baz" << i));
+            }
+
+            addIndex(BSON("foo" << 1));
+            addIndex(BSON("bar" << 1));
+            addIndex(BSON("baz" << 1));
+
+            WorkingSet ws;
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
+            ah->setRecordIdsOnly();
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10, scanned backwards
+            params.descriptor = getIndex(BSON("bar" << 1), coll);
+            params.bounds.startKey = BSON("" << MAXKEY);
+            params.bounds.endKey = BSON("" << 10);
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // 5 <= baz <= 15
+            params.descriptor = getIndex(BSON("baz" << 1), coll);
+            params.bounds.startKey = BSON("" << 5);
+            params.bounds.endKey = BSON("" << 15);
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // foo == bar == baz, and foo<=20, bar>=10, 5<=baz<=15, so our values are:
+            // foo == 10, 11, 12, 13, 14, 15.
+            ASSERT_EQUALS(6, countResults(ah.get()));
+        }
+    };
+
     // An AND with three children.
     // Add large keys (512 bytes) to index of second child to cause
     // internal buffer within hashed AND to exceed threshold (32MB)
@@ -594,7 +703,7 @@ namespace QueryStageAnd {
             // before hashed AND is done reading the second child (stage has to
             // hold 11 keys in buffer for Foo <= 20 and Bar >= 10).
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll, 10 * big.size()));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll, 10 * big.size()));
 
             // Foo <= 20
             IndexScanParams params;
@@ -648,7 +757,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -709,7 +818,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo >= 100
             IndexScanParams params;
@@ -761,7 +870,7 @@ namespace QueryStageAnd {
             StatusWithMatchExpression swme = MatchExpressionParser::parse(filter);
             verify(swme.isOK());
             auto_ptr<MatchExpression> filterExpr(swme.getValue());
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, filterExpr.get(), coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, filterExpr.get(), coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -810,7 +919,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -869,7 +978,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Foo <= 20
             IndexScanParams params;
@@ -1245,7 +1354,7 @@ namespace QueryStageAnd {
             addIndex(BSON("bar" << 1));
 
             WorkingSet ws;
-            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&_txn, &ws, NULL, coll));
 
             // Scan over foo == 1
             IndexScanParams params;
@@ -1402,7 +1511,9 @@ namespace QueryStageAnd {
             add<QueryStageAndHashTwoLeaf>();
             add<QueryStageAndHashTwoLeafFirstChildLargeKeys>();
             add<QueryStageAndHashTwoLeafLastChildLargeKeys>();
+            add<QueryStageAndHashRecordIdsOnlyFirstChildLargeKeys>();
             add<QueryStageAndHashThreeLeaf>();
+            add<QueryStageAndHashRecordIdsOnlyThreeLeaf>();
             add<QueryStageAndHashThreeLeafMiddleChildLargeKeys>();
             add<QueryStageAndHashWithNothing>();
             add<QueryStageAndHashProducesNothing>();
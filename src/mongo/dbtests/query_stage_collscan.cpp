@@ -379,6 +379,103 @@ namespace QueryStageCollectionScan {
         }
     };
 
+    //
+    // Returning pinned records yields the same objects, in order, across saves and restores.
+    //
+
+    class QueryStageCollscanPinnedRecordsInOrder : public QueryStageCollectionScanBase {
+    public:
+        void run() {
+            AutoGetCollectionForRead ctx(&_txn, ns());
+
+            CollectionScanParams params;
+            params.collection = ctx.getCollection();
+            params.direction = CollectionScanParams::FORWARD;
+            params.tailable = false;
+
+            WorkingSet* ws = new WorkingSet();
+            PlanStage* ps = new CollectionScan(&_txn, params, ws, NULL);
+
+            PlanExecutor* rawExec;
+            Status status = PlanExecutor::make(&_txn, ws, ps, params.collection,
+                                               PlanExecutor::YIELD_MANUAL, &rawExec);
+            ASSERT_OK(status);
+            boost::scoped_ptr<PlanExecutor> exec(rawExec);
+            ASSERT(exec->returnPinnedRecords());
+
+            int count = 0;
+            for (BSONObj obj; PlanExecutor::ADVANCED == exec->getNext(&obj, NULL); ) {
+                ASSERT_EQUALS(count, obj["foo"].numberInt());
+                ++count;
+
+                if (count % 7 == 0) {
+                    exec->saveState();
+                    ASSERT(exec->restoreState(&_txn));
+                }
+            }
+
+            ASSERT_EQUALS(numObj(), count);
+        }
+    };
+
+    //
+    // Delete the pinned object that was just returned while yielded, then expect to get the
+    // object after it.
+    //
+
+    class QueryStageCollscanPinnedRecordDeleted : public QueryStageCollectionScanBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Collection* coll = ctx.getCollection();
+
+            vector<RecordId> locs;
+            getLocs(coll, CollectionScanParams::FORWARD, &locs);
+
+            CollectionScanParams params;
+            params.collection = coll;
+            params.direction = CollectionScanParams::FORWARD;
+            params.tailable = false;
+
+            WorkingSet ws;
+            scoped_ptr<CollectionScan> scan(new CollectionScan(&_txn, params, &ws, NULL));
+            ASSERT(scan->returnPinnedRecords());
+            ASSERT_FALSE(scan->supportsWorkBatch());
+
+            int count = 0;
+            while (count < 10) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = scan->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    WorkingSetMember* member = ws.get(id);
+                    ASSERT_EQUALS(locs[count], member->loc);
+                    ASSERT_EQUALS(count, member->obj.value()["foo"].numberInt());
+                    ++count;
+                }
+            }
+
+            // Remove locs[count - 1], which was returned last.
+            scan->saveState();
+            scan->invalidate(&_txn, locs[count - 1], INVALIDATION_DELETION);
+            remove(coll->docFor(&_txn, locs[count - 1]).value());
+            scan->restoreState(&_txn);
+
+            // Expect the rest, starting right after it.
+            while (!scan->isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = scan->work(&id);
+                if (PlanStage::ADVANCED == state) {
+                    WorkingSetMember* member = ws.get(id);
+                    ASSERT_EQUALS(locs[count], member->loc);
+                    ASSERT_EQUALS(count, member->obj.value()["foo"].numberInt());
+                    ++count;
+                }
+            }
+
+            ASSERT_EQUALS(numObj(), count);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "QueryStageCollectionScan" ) {}
@@ -393,6 +490,8 @@ namespace QueryStageCollectionScan {
             add<QueryStageCollscanObjectsInOrderBackward>();
             add<QueryStageCollscanInvalidateUpcomingObject>();
             add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
+            add<QueryStageCollscanPinnedRecordsInOrder>();
+            add<QueryStageCollscanPinnedRecordDeleted>();
         }
     };
 
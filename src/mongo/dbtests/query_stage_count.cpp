@@ -133,6 +133,7 @@ namespace QueryStageCount {
                                   false,
                                   true,
                                   NULL,
+                                  NULL,
                                   args);
             wunit.commit();
         }
@@ -291,6 +291,73 @@ namespace QueryStageDelete {
         }
     };
 
+    /**
+     * Test that a batched multi delete deletes whole batches at a time, and skips a document
+     * invalidated while it waits in the batch.
+     */
+    class QueryStageDeleteBatched : public QueryStageDeleteBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+
+            Collection* coll = ctx.getCollection();
+
+            // Get the RecordIds that would be returned by an in-order scan.
+            vector<RecordId> locs;
+            getLocs(coll, CollectionScanParams::FORWARD, &locs);
+
+            CollectionScanParams collScanParams;
+            collScanParams.collection = coll;
+            collScanParams.direction = CollectionScanParams::FORWARD;
+            collScanParams.tailable = false;
+
+            DeleteStageParams deleteStageParams;
+            deleteStageParams.isMulti = true;
+            deleteStageParams.shouldCallLogOp = false;
+            deleteStageParams.maxBatchDocs = 20;
+            deleteStageParams.maxBatchBytes = 1024 * 1024;
+
+            WorkingSet ws;
+            DeleteStage deleteStage(&_txn, deleteStageParams, &ws, coll,
+                                    new CollectionScan(&_txn, collScanParams, &ws, NULL));
+
+            const DeleteStats* stats =
+                static_cast<const DeleteStats*>(deleteStage.getSpecificStats());
+
+            // Nothing is deleted until the first batch is full.
+            for (size_t i = 0; i < 5; ++i) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                ASSERT_EQUALS(PlanStage::NEED_TIME, deleteStage.work(&id));
+            }
+            ASSERT_EQUALS(0U, stats->docsDeleted);
+
+            // Remove the first document, which is waiting in the batch.
+            deleteStage.saveState();
+            deleteStage.invalidate(&_txn, locs[0], INVALIDATION_DELETION);
+            BSONObj targetDoc = coll->docFor(&_txn, locs[0]).value();
+            ASSERT(!targetDoc.isEmpty());
+            remove(targetDoc);
+            deleteStage.restoreState(&_txn);
+
+            while (stats->docsDeleted == 0) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                ASSERT_EQUALS(PlanStage::NEED_TIME, deleteStage.work(&id));
+            }
+            ASSERT_EQUALS(19U, stats->docsDeleted);
+
+            // Delete the rest.
+            while (!deleteStage.isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = deleteStage.work(&id);
+                invariant(PlanStage::NEED_TIME == state || PlanStage::IS_EOF == state);
+            }
+
+            ASSERT_EQUALS(numObj() - 1, stats->docsDeleted);
+            ASSERT_EQUALS(1U, stats->nInvalidateSkips);
+            ASSERT_EQUALS(0U, coll->numRecords(&_txn));
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite("query_stage_delete") {}
@@ -300,6 +367,7 @@ namespace QueryStageDelete {
             add<QueryStageDeleteInvalidateUpcomingObject>();
             add<QueryStageDeleteReturnOldDoc>();
             add<QueryStageDeleteSkipOwnedObjects>();
+            add<QueryStageDeleteBatched>();
         }
     };
 
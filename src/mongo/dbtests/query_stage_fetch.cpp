@@ -210,6 +210,63 @@ namespace QueryStageFetch {
         }
     };
 
+    //
+    // Test that a batch is returned in RecordId order when the fetch is allowed to sort it.
+    //
+    class FetchStageSortRecordIds : public QueryStageFetchBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            for (int i = 0; i < 10; ++i) {
+                insert(BSON("foo" << i));
+            }
+            set<RecordId> locs;
+            getLocs(&locs, coll);
+            ASSERT_EQUALS(size_t(10), locs.size());
+
+            for (int sortRecordIds = 0; sortRecordIds < 2; ++sortRecordIds) {
+                WorkingSet ws;
+                auto_ptr<QueuedDataStage> mockStage(new QueuedDataStage(&ws));
+
+                // Hand out the records in reverse order.
+                for (set<RecordId>::const_reverse_iterator it = locs.rbegin();
+                     it != locs.rend(); ++it) {
+                    WorkingSetMember mockMember;
+                    mockMember.state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+                    mockMember.loc = *it;
+                    mockMember.obj = coll->docFor(&_txn, mockMember.loc);
+                    mockStage->pushBack(mockMember);
+                }
+
+                auto_ptr<FetchStage> fetchStage(new FetchStage(&_txn, &ws, mockStage.release(),
+                                                               NULL, coll));
+                if (sortRecordIds) {
+                    fetchStage->setSortRecordIds();
+                }
+
+                std::vector<WorkingSetID> results;
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState state = fetchStage->workBatch(100, &results, &id);
+                ASSERT_EQUALS(PlanStage::ADVANCED, state);
+                ASSERT_EQUALS(locs.size(), results.size());
+
+                for (size_t i = 1; i < results.size(); ++i) {
+                    const RecordId& prev = ws.get(results[i - 1])->loc;
+                    const RecordId& cur = ws.get(results[i])->loc;
+                    ASSERT_EQUALS(sortRecordIds ? prev < cur : cur < prev, true);
+                }
+            }
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_fetch" ) { }
@@ -217,6 +274,7 @@ namespace QueryStageFetch {
         void setupTests() {
             add<FetchStageAlreadyFetched>();
             add<FetchStageFilter>();
+            add<FetchStageSortRecordIds>();
         }
     };
 
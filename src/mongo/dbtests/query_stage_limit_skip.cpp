@@ -80,6 +80,20 @@ namespace {
         return count;
     }
 
+    int countResultsBatched(PlanStage* stage, size_t batchSize) {
+        int count = 0;
+        while (!stage->isEOF()) {
+            std::vector<WorkingSetID> results;
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState status = stage->workBatch(batchSize, &results, &id);
+            ASSERT_LESS_THAN_OR_EQUALS(results.size(), batchSize);
+            if (PlanStage::ADVANCED == status) { ASSERT_FALSE(results.empty()); }
+            if (PlanStage::NEED_TIME == status) { ASSERT_TRUE(results.empty()); }
+            count += results.size();
+        }
+        return count;
+    }
+
     //
     // Insert 50 objects.  Filter/skip 0, 1, 2, ..., 100 objects and expect the right # of results.
     //
@@ -98,12 +112,39 @@ namespace {
         }
     };
 
+    //
+    // Same as above, but using workBatch() with a few different batch sizes.
+    //
+    class QueryStageLimitSkipBatchedTest {
+    public:
+        void run() {
+            const size_t batchSizes[] = {1, 4, 7, 128};
+            for (size_t b = 0; b < sizeof(batchSizes) / sizeof(batchSizes[0]); ++b) {
+                for (int i = 0; i < 2 * N; ++i) {
+                    WorkingSet ws;
+
+                    scoped_ptr<PlanStage> skip(new SkipStage(i, &ws, getMS(&ws)));
+                    ASSERT_EQUALS(max(0, N - i), countResultsBatched(skip.get(), batchSizes[b]));
+
+                    scoped_ptr<PlanStage> limit(new LimitStage(i, &ws, getMS(&ws)));
+                    ASSERT_EQUALS(min(N, i), countResultsBatched(limit.get(), batchSizes[b]));
+
+                    scoped_ptr<PlanStage> limitSkip(
+                        new LimitStage(i, &ws, new SkipStage(i / 2, &ws, getMS(&ws))));
+                    ASSERT_EQUALS(min(max(0, N - i / 2), i),
+                                  countResultsBatched(limitSkip.get(), batchSizes[b]));
+                }
+            }
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite( "query_stage_limit_skip" ) { }
 
         void setupTests() {
             add<QueryStageLimitSkipBasicTest>();
+            add<QueryStageLimitSkipBatchedTest>();
         }
     };
 
@@ -38,6 +38,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 
 /**
@@ -512,6 +513,74 @@ namespace QueryStageMergeSortTests {
         }
     };
 
+    // Many children, not a power of two, each with many results to merge.  The sort keys are
+    // compared both as KeyStrings and as BSON.
+    class QueryStageMergeSortManyInterleaved : public QueryStageMergeSortTestBase {
+    public:
+        void run() {
+            const bool oldUseKeyStrings = internalQueryExecSortUseKeyStrings;
+            internalQueryExecSortUseKeyStrings = true;
+            runMerge();
+            internalQueryExecSortUseKeyStrings = false;
+            runMerge();
+            internalQueryExecSortUseKeyStrings = oldUseKeyStrings;
+        }
+
+        void runMerge() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            const int numChildren = 13;
+            const int numPerChild = 40;
+            const BSONObj indexSpec = BSON("a" << 1 << "foo" << 1);
+            if (!getIndex(indexSpec, coll)) {
+                for (int i = 0; i < numChildren * numPerChild; ++i) {
+                    // Child i scans a == i, which holds every numChildren-th value of foo.
+                    insert(BSON("a" << i % numChildren << "foo" << i));
+                }
+                addIndex(indexSpec);
+            }
+
+            WorkingSet* ws = new WorkingSet();
+            MergeSortStageParams msparams;
+            msparams.pattern = BSON("foo" << 1);
+            msparams.dedup = false;
+            MergeSortStage* ms = new MergeSortStage(msparams, ws, coll);
+
+            for (int i = 0; i < numChildren; ++i) {
+                IndexScanParams params;
+                params.descriptor = getIndex(indexSpec, coll);
+                params.bounds.isSimpleRange = true;
+                params.bounds.startKey = objWithMinKey(i);
+                params.bounds.endKey = objWithMaxKey(i);
+                params.bounds.endKeyInclusive = true;
+                params.direction = 1;
+                ms->addChild(new IndexScan(&_txn, params, ws, NULL));
+            }
+
+            PlanExecutor* rawExec;
+            Status status = PlanExecutor::make(&_txn, ws, new FetchStage(&_txn, ws, ms, NULL, coll),
+                                               coll, PlanExecutor::YIELD_MANUAL, &rawExec);
+            ASSERT_OK(status);
+            boost::scoped_ptr<PlanExecutor> exec(rawExec);
+
+            for (int i = 0; i < numChildren * numPerChild; ++i) {
+                BSONObj obj;
+                ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&obj, NULL));
+                ASSERT_EQUALS(i, obj["foo"].numberInt());
+            }
+
+            BSONObj foo;
+            ASSERT_EQUALS(PlanExecutor::IS_EOF, exec->getNext(&foo, NULL));
+        }
+    };
+
     // Invalidation mid-run
     class QueryStageMergeSortInvalidation : public QueryStageMergeSortTestBase {
     public:
@@ -637,6 +706,7 @@ namespace QueryStageMergeSortTests {
             add<QueryStageMergeSortPrefixIndexReverse>();
             add<QueryStageMergeSortOneStageEOF>();
             add<QueryStageMergeSortManyShort>();
+            add<QueryStageMergeSortManyInterleaved>();
             add<QueryStageMergeSortInvalidation>();
         }
     };
@@ -38,6 +38,7 @@
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_impl.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/dbtests/dbtests.h"
 
 /**
@@ -153,6 +154,7 @@ namespace QueryStageSortTests {
             params.collection = coll;
             params.pattern = BSON("foo" << direction);
             params.limit = limit();
+            params.allowDiskUse = allowDiskUse();
 
             // Must fetch so we can look at the doc as a BSONObj.
             PlanExecutor* rawExec;
@@ -206,6 +208,9 @@ namespace QueryStageSortTests {
         // Leave as 0 to disable limit.
         virtual int limit() const { return 0; };
 
+        // Returns whether the sort may spill to disk.
+        virtual bool allowDiskUse() const { return false; }
+
 
         static const char* ns() { return "unittests.QueryStageSort"; }
 
@@ -284,6 +289,40 @@ namespace QueryStageSortTests {
         }
     };
 
+    // Sort more data than fits in the memory limit, spilling it to disk.
+    template <int LIMIT>
+    class QueryStageSortSpill : public QueryStageSortTestBase {
+    public:
+        QueryStageSortSpill() : _oldMaxBytes(internalQueryExecMaxBlockingSortBytes) {
+            internalQueryExecMaxBlockingSortBytes = 64 * 1024;
+        }
+
+        virtual ~QueryStageSortSpill() {
+            internalQueryExecMaxBlockingSortBytes = _oldMaxBytes;
+        }
+
+        virtual int numObj() { return 10000; }
+        virtual int limit() const { return LIMIT; }
+        virtual bool allowDiskUse() const { return true; }
+
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = db->getCollection(ns());
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            fillData();
+            sortAndCheck(-1, coll);
+        }
+
+    private:
+        const int _oldMaxBytes;
+    };
+
     // Mutation invalidation of docs fed to sort.
     class QueryStageSortMutationInvalidation : public QueryStageSortTestBase {
     public:
@@ -337,7 +376,7 @@ namespace QueryStageSortTests {
             oplogUpdateEntryArgs args;
             {
                 WriteUnitOfWork wuow(&_txn);
-                coll->updateDocument(&_txn, *it, oldDoc, newDoc, false, false, NULL, args);
+                coll->updateDocument(&_txn, *it, oldDoc, newDoc, false, false, NULL, NULL, args);
                 wuow.commit();
             }
             exec->restoreState(&_txn);
@@ -355,7 +394,8 @@ namespace QueryStageSortTests {
                 oldDoc = coll->docFor(&_txn, *it);
                 {
                     WriteUnitOfWork wuow(&_txn);
-                    coll->updateDocument(&_txn, *it++, oldDoc, newDoc, false, false, NULL, args);
+                    coll->updateDocument(&_txn, *it++, oldDoc, newDoc, false, false, NULL, NULL,
+                                         args);
                     wuow.commit();
                 }
             }
@@ -554,6 +594,8 @@ namespace QueryStageSortTests {
             // and a special case for limit == 1
             add<QueryStageSortDecWithLimit<1> >();
             add<QueryStageSortExt>();
+            add<QueryStageSortSpill<0> >();
+            add<QueryStageSortSpill<5000> >();
             add<QueryStageSortMutationInvalidation>();
             add<QueryStageSortDeletionInvalidation>();
             add<QueryStageSortDeletionInvalidationWithLimit<10> >();
@@ -158,6 +158,62 @@ namespace QueryStageSubplan {
         }
     };
 
+    /**
+     * Test that $or branches of the same shape are ranked once, and that the others use the
+     * winning plan of the first.
+     */
+    class QueryStageSubplanSameShapeBranches : public QueryStageSubplanBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+
+            addIndex(BSON("a" << 1));
+            addIndex(BSON("a" << 1 << "b" << 1));
+            addIndex(BSON("c" << 1));
+
+            for (int i = 0; i < 10; i++) {
+                insert(BSON("a" << (i % 3) << "b" << i << "c" << i));
+            }
+
+            // The first two branches have the same shape, the last one doesn't.
+            BSONObj query = fromjson("{$or: [{a: 1, b: 4}, {a: 2, b: 5}, {c: 6}]}");
+
+            Collection* collection = ctx.getCollection();
+
+            CanonicalQuery* rawCq;
+            ASSERT_OK(CanonicalQuery::canonicalize(ns(), query, &rawCq));
+            boost::scoped_ptr<CanonicalQuery> cq(rawCq);
+
+            // Get planner params.
+            QueryPlannerParams plannerParams;
+            fillOutPlannerParams(&_txn, collection, cq.get(), &plannerParams);
+
+            WorkingSet ws;
+            boost::scoped_ptr<SubplanStage> subplan(new SubplanStage(&_txn, collection, &ws,
+                                                                     plannerParams, cq.get()));
+
+            PlanYieldPolicy yieldPolicy(NULL, PlanExecutor::YIELD_MANUAL);
+            ASSERT_OK(subplan->pickBestPlan(&yieldPolicy));
+
+            ASSERT_FALSE(subplan->branchPlannedLikeEarlierBranch(0));
+            ASSERT_TRUE(subplan->branchPlannedLikeEarlierBranch(1));
+            ASSERT_FALSE(subplan->branchPlannedLikeEarlierBranch(2));
+
+            // Each branch matches one document.
+            int count = 0;
+            PlanStage::StageState state = PlanStage::NEED_TIME;
+            while (PlanStage::IS_EOF != state) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                state = subplan->work(&id);
+                ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+                if (PlanStage::ADVANCED == state) {
+                    ++count;
+                }
+            }
+            ASSERT_EQUALS(3, count);
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite("query_stage_subplan") {}
@@ -165,6 +221,7 @@ namespace QueryStageSubplan {
         void setupTests() {
             add<QueryStageSubplanGeo2dOr>();
             add<QueryStageSubplanPlanFromCache>();
+            add<QueryStageSubplanSameShapeBranches>();
         }
     };
 
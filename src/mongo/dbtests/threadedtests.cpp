@@ -336,6 +336,45 @@ namespace ThreadedTests {
         }
     };
 
+    // Tasks scheduled with the same affinity are queued on one worker; while that worker is
+    // blocked, the other workers must steal them.
+    class ThreadPoolStealTest {
+        static const unsigned iterations = 1000;
+        static const unsigned nThreads = 4;
+
+        AtomicUInt32 counter;
+        Notification blocked;
+        Notification release;
+
+        void block() {
+            blocked.notifyOne();
+            release.waitToBeNotified();
+        }
+        void increment() {
+            counter.fetchAndAdd(1);
+        }
+
+    public:
+        void run() {
+            ThreadPool tp(nThreads);
+
+            tp.scheduleWithAffinity(0, stdx::bind(&ThreadPoolStealTest::block, this));
+            blocked.waitToBeNotified();
+            for (unsigned i = 0; i < iterations; i++) {
+                tp.scheduleWithAffinity(0, stdx::bind(&ThreadPoolStealTest::increment, this));
+            }
+
+            while (counter.load() < iterations) {
+                sleepmillis(1);
+            }
+            ASSERT_EQUALS(tp.tasks_remaining(), 1);
+
+            release.notifyOne();
+            tp.join();
+            ASSERT_EQUALS(tp.tasks_remaining(), 0);
+        }
+    };
+
     class RWLockTest1 { 
     public:
         void run() { 
@@ -828,6 +867,7 @@ namespace ThreadedTests {
             add< IsAtomicWordAtomic<AtomicUInt64> >();
             add< MVarTest >();
             add< ThreadPoolTest >();
+            add< ThreadPoolStealTest >();
 
             add< RWLockTest1 >();
             add< RWLockTest2 >();
@@ -0,0 +1,244 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <sstream>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/logger/appender.h"
+#include "mongo/logger/encoder.h"
+#include "mongo/logger/log_severity.h"
+#include "mongo/logger/rotatable_file_writer.h"
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Base of appenders which may hold messages that aren't written yet.
+     */
+    class FlushableAppenderBase {
+    public:
+        virtual ~FlushableAppenderBase() {}
+
+        /**
+         * Writes out all the messages this appender holds.
+         */
+        virtual void flush() = 0;
+    };
+
+    void registerFlushableAppender(FlushableAppenderBase* appender);
+    void unregisterFlushableAppender(FlushableAppenderBase* appender);
+
+    /**
+     * Writes out the messages of every live flushable appender.  Call before exiting the process
+     * without destroying the appenders.
+     */
+    void flushAllAppenders();
+
+    /**
+     * Appender for writing to instances of RotatableFileWriter from a background thread.
+     *
+     * Threads logging through it only encode their event and queue the text, the writer thread
+     * does the (possibly slow) file writes.  Once "maxQueuedMessages" messages are waiting, an
+     * appending thread either waits for the writer to catch up, or drops its message if
+     * "dropWhenFull" is set; the writer then logs how many messages were lost.
+     *
+     * Events of severity Error and above are written before append() returns, after all the
+     * messages queued ahead of them, so that they are on disk when the process goes down.
+     */
+    template <typename Event>
+    class AsyncRotatableFileAppender : public Appender<Event>, public FlushableAppenderBase {
+        MONGO_DISALLOW_COPYING(AsyncRotatableFileAppender);
+
+    public:
+        typedef Encoder<Event> EventEncoder;
+
+        /**
+         * Constructs an appender, that owns "encoder", but not "writer."  Caller must
+         * keep "writer" in scope at least as long as the constructed appender.
+         */
+        AsyncRotatableFileAppender(EventEncoder* encoder,
+                                   RotatableFileWriter* writer,
+                                   size_t maxQueuedMessages,
+                                   bool dropWhenFull) :
+            _encoder(encoder),
+            _writer(writer),
+            _maxQueuedMessages(maxQueuedMessages),
+            _dropWhenFull(dropWhenFull),
+            _shutdown(false),
+            _dropped(0),
+            _totalDropped(0),
+            _thread(boost::bind(&AsyncRotatableFileAppender::_run, this)) {
+            registerFlushableAppender(this);
+        }
+
+        virtual ~AsyncRotatableFileAppender() {
+            unregisterFlushableAppender(this);
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _shutdown = true;
+            }
+            _notEmpty.notify_one();
+            _thread.join();
+        }
+
+        virtual Status append(const Event& event) {
+            std::ostringstream os;
+            _encoder->encode(event, os);
+
+            if (event.getSeverity() >= LogSeverity::Error()) {
+                return _flush(os.str());
+            }
+
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                while (_queue.size() >= _maxQueuedMessages && !_shutdown) {
+                    if (_dropWhenFull) {
+                        _dropped++;
+                        _totalDropped++;
+                        return Status::OK();
+                    }
+                    _notFull.wait(lk);
+                }
+                _queue.push_back(os.str());
+            }
+            _notEmpty.notify_one();
+            return Status::OK();
+        }
+
+        virtual void flush() {
+            _flush(std::string());
+        }
+
+        /**
+         * Returns the number of messages dropped because the queue was full.
+         */
+        unsigned long long getDroppedCount() const {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _totalDropped;
+        }
+
+    private:
+        typedef std::deque<std::string> Queue;
+
+        void _run() {
+            while (true) {
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (_queue.empty() && !_shutdown) {
+                        _notEmpty.wait(lk);
+                    }
+                    if (_queue.empty() && _shutdown) {
+                        return;
+                    }
+                }
+
+                // Writes happen under _writeMutex, taken before the queue is swapped out, so that
+                // messages reach the file in the order they were queued
+                boost::lock_guard<boost::mutex> writeLock(_writeMutex);
+                Queue batch;
+                _takeQueued(&batch);
+                _write(batch);
+            }
+        }
+
+        // Writes the queued messages followed by "last," if not empty, before returning
+        Status _flush(const std::string& last) {
+            boost::lock_guard<boost::mutex> writeLock(_writeMutex);
+            Queue pending;
+            _takeQueued(&pending);
+            if (!last.empty())
+                pending.push_back(last);
+            return _write(pending);
+        }
+
+        void _takeQueued(Queue* out) {
+            unsigned long long dropped;
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                out->swap(_queue);
+                dropped = _dropped;
+                _dropped = 0;
+            }
+            _notFull.notify_all();
+
+            if (dropped) {
+                std::ostringstream os;
+                os << "*** " << dropped << " log messages were dropped because the log writer "
+                   << "fell behind ***" << std::endl;
+                out->push_back(os.str());
+            }
+        }
+
+        Status _write(const Queue& messages) {
+            if (messages.empty())
+                return Status::OK();
+
+            RotatableFileWriter::Use useWriter(_writer);
+            Status status = useWriter.status();
+            if (!status.isOK())
+                return status;
+            for (Queue::const_iterator it = messages.begin(); it != messages.end(); ++it) {
+                useWriter.stream() << *it;
+            }
+            useWriter.stream().flush();
+            return useWriter.status();
+        }
+
+        boost::scoped_ptr<EventEncoder> _encoder;
+        RotatableFileWriter* _writer;
+        const size_t _maxQueuedMessages;
+        const bool _dropWhenFull;
+
+        // Serializes swapping out and writing the queued messages
+        boost::mutex _writeMutex;
+
+        // Protects the members below
+        mutable boost::mutex _mutex;
+        boost::condition_variable _notEmpty;
+        boost::condition_variable _notFull;
+        Queue _queue;
+        bool _shutdown;
+        unsigned long long _dropped; // since the last write
+        unsigned long long _totalDropped;
+
+        // Declared last, so that it starts once everything it uses is constructed
+        boost::thread _thread;
+    };
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,119 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "mongo/logger/async_rotatable_file_appender.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/logger/message_event_utf8_encoder.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+    using namespace mongo::logger;
+
+    const std::string logFileName("LogTest_AsyncRotatableFileAppender.txt");
+
+    typedef AsyncRotatableFileAppender<MessageEventEphemeral> AsyncAppender;
+
+    class AsyncRotatableFileAppenderTest : public mongo::unittest::Test {
+    public:
+        AsyncRotatableFileAppenderTest() {
+            unlink(logFileName.c_str());
+            ASSERT_OK(RotatableFileWriter::Use(&_writer).setFileName(logFileName, false));
+        }
+
+        virtual ~AsyncRotatableFileAppenderTest() {
+            unlink(logFileName.c_str());
+        }
+
+    protected:
+        static MessageEventEphemeral makeEvent(LogSeverity severity, const std::string& message) {
+            return MessageEventEphemeral(Date_t(0), severity, "test", message);
+        }
+
+        static std::vector<std::string> readLines() {
+            std::vector<std::string> lines;
+            std::ifstream ifs(logFileName.c_str());
+            std::string line;
+            while (std::getline(ifs, line)) {
+                lines.push_back(line);
+            }
+            return lines;
+        }
+
+        RotatableFileWriter _writer;
+    };
+
+    TEST_F(AsyncRotatableFileAppenderTest, WritesInOrderOnDestruction) {
+        {
+            AsyncAppender appender(new MessageEventUnadornedEncoder, &_writer, 10, false);
+            for (int i = 0; i < 100; i++) {
+                std::ostringstream os;
+                os << "message " << i;
+                ASSERT_OK(appender.append(makeEvent(LogSeverity::Log(), os.str())));
+            }
+        }
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(100U, lines.size());
+        for (int i = 0; i < 100; i++) {
+            std::ostringstream os;
+            os << "message " << i;
+            ASSERT_EQUALS(os.str(), lines[i]);
+        }
+    }
+
+    TEST_F(AsyncRotatableFileAppenderTest, ErrorsAreWrittenBeforeAppendReturns) {
+        AsyncAppender appender(new MessageEventUnadornedEncoder, &_writer, 10, false);
+        ASSERT_OK(appender.append(makeEvent(LogSeverity::Log(), "queued")));
+        ASSERT_OK(appender.append(makeEvent(LogSeverity::Error(), "error")));
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(2U, lines.size());
+        ASSERT_EQUALS("queued", lines[0]);
+        ASSERT_EQUALS("error", lines[1]);
+    }
+
+    TEST_F(AsyncRotatableFileAppenderTest, FlushAllAppenders) {
+        AsyncAppender appender(new MessageEventUnadornedEncoder, &_writer, 10, true);
+        ASSERT_OK(appender.append(makeEvent(LogSeverity::Log(), "one")));
+        ASSERT_OK(appender.append(makeEvent(LogSeverity::Info(), "two")));
+        flushAllAppenders();
+
+        std::vector<std::string> lines = readLines();
+        ASSERT_EQUALS(2U, lines.size());
+        ASSERT_EQUALS("one", lines[0]);
+        ASSERT_EQUALS("two", lines[1]);
+        ASSERT_EQUALS(0U, appender.getDroppedCount());
+    }
+
+}  // namespace
@@ -69,7 +69,7 @@ namespace rpc {
 
     private:
         // Default values are all empty.
-        BufBuilder _builder{};
+        BufBuilder _builder{BufferPool::suggestedSize()};
         std::unique_ptr<Message> _message;
 
         enum class BuildState {
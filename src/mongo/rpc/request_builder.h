@@ -71,7 +71,7 @@ namespace rpc {
         std::unique_ptr<Message> done();
 
     private:
-        BufBuilder _builder{};
+        BufBuilder _builder{BufferPool::suggestedSize()};
         std::unique_ptr<Message> _message;
 
         enum class BuildState {
@@ -41,6 +41,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/catalog/catalog_cache.h"
@@ -49,6 +50,7 @@
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/catalog/type_collection.h"
 #include "mongo/s/catalog/type_settings.h"
+#include "mongo/s/catalog/type_shard.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
 #include "mongo/s/catalog/dist_lock_manager.h"
@@ -76,6 +78,10 @@ namespace mongo {
 
     MONGO_FP_DECLARE(skipBalanceRound);
 
+    // Whether the balancer asks the shards how hot their chunks are and evens out their load, not
+    // just their chunk counts
+    MONGO_EXPORT_SERVER_PARAMETER(balancerUseChunkHeat, bool, false);
+
     Balancer balancer;
 
     Balancer::Balancer()
@@ -327,6 +333,15 @@ namespace mongo {
         
         OCCASIONALLY warnOnMultiVersion( shardInfo );
 
+        vector<ShardType> heatShards;
+        if (balancerUseChunkHeat) {
+            Status shardsStatus = grid.catalogManager()->getAllShards(&heatShards);
+            if (!shardsStatus.isOK()) {
+                warning() << "failed to load shards to get chunk heat from"
+                          << causedBy(shardsStatus);
+            }
+        }
+
         // For each collection, check if the balancing policy recommends moving anything around.
         for (const auto& coll : collections) {
             // Skip collections for which balancing is disabled
@@ -385,6 +400,12 @@ namespace mongo {
 
             DistributionStatus status(shardInfo, shardToChunksMap.map());
 
+            ChunkHeatMap chunkHeat;
+            if (!heatShards.empty()) {
+                DistributionStatus::populateChunkHeatMap(ns, heatShards, &chunkHeat);
+                status.setChunkHeat(&chunkHeat);
+            }
+
             cursor = conn.query(TagsType::ConfigNS,
                                 QUERY(TagsType::ns(ns)).sort(TagsType::min()));
 
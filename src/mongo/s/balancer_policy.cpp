@@ -34,6 +34,7 @@
 #include "mongo/s/balancer_policy.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "mongo/client/connpool.h"
 #include "mongo/s/catalog/catalog_manager.h"
@@ -61,7 +62,7 @@ namespace mongo {
 
     DistributionStatus::DistributionStatus( const ShardInfoMap& shardInfo,
                                             const ShardToChunksMap& shardToChunksMap )
-        : _shardInfo( shardInfo ), _shardChunks( shardToChunksMap ) {
+        : _shardInfo( shardInfo ), _shardChunks( shardToChunksMap ), _chunkHeat( NULL ) {
 
         for ( ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i ) {
             _shards.insert( i->first );
@@ -160,6 +161,34 @@ namespace mongo {
         return worst;
     }
 
+    double DistributionStatus::chunkHeat( const ChunkType& chunk ) const {
+        if ( _chunkHeat == NULL )
+            return 0;
+
+        ChunkHeatMap::const_iterator i = _chunkHeat->find( chunk.getMin() );
+        if ( i == _chunkHeat->end() )
+            return 0;
+
+        return i->second;
+    }
+
+    double DistributionStatus::shardHeatWithTag( const string& shard, const string& tag ) const {
+        ShardToChunksMap::const_iterator i = _shardChunks.find(shard);
+        if (i == _shardChunks.end()) {
+            return 0;
+        }
+
+        double total = 0;
+        const vector<ChunkType*>& chunkList = i->second->vector();
+        for (unsigned j = 0; j < chunkList.size(); j++) {
+            if (tag == getTagForChunk(*chunkList[j])) {
+                total += chunkHeat(*chunkList[j]);
+            }
+        }
+
+        return total;
+    }
+
     const vector<ChunkType*>& DistributionStatus::getChunks(
             const string& shard) const {
         ShardToChunksMap::const_iterator i = _shardChunks.find(shard);
@@ -308,6 +337,38 @@ namespace mongo {
         }
     }
 
+    void DistributionStatus::populateChunkHeatMap(const string& ns,
+                                                  const vector<ShardType>& shards,
+                                                  ChunkHeatMap* chunkHeat) {
+        for (const ShardType& shard : shards) {
+            BSONObj heatResult;
+            try {
+                ScopedDbConnection conn(shard.getHost(), 30);
+                bool ok = conn->runCommand("admin", BSON("_getChunkHeat" << ns), heatResult);
+                conn.done();
+
+                if (!ok) {
+                    // Shards running older versions don't track chunk heat
+                    LOG(1) << "could not get chunk heat of " << ns << " from " << shard.getName()
+                           << ": " << heatResult;
+                    continue;
+                }
+            }
+            catch (const DBException& ex) {
+                warning() << "could not get chunk heat of " << ns << " from " << shard.getName()
+                          << causedBy(ex);
+                continue;
+            }
+
+            BSONObjIterator it(heatResult.getObjectField("chunks"));
+            while (it.more()) {
+                BSONObj chunkHeatDoc = it.next().Obj();
+                (*chunkHeat)[chunkHeatDoc[ChunkType::min()].Obj().getOwned()] +=
+                    chunkHeatDoc["reads"].numberDouble() + chunkHeatDoc["writes"].numberDouble();
+            }
+        }
+    }
+
     StatusWith<string> DistributionStatus::getTagForSingleChunk(const string& configServer,
                                                                 const string& ns,
                                                                 const ChunkType& chunk) {
@@ -347,7 +408,8 @@ namespace mongo {
         // 1) check for shards that policy require to us to move off of:
         //    draining only
         // 2) check tag policy violations
-        // 3) then we make sure chunks are balanced for each tag
+        // 3) if we know how hot the chunks are, even out the load for each tag
+        // 4) then we make sure chunks are balanced for each tag
 
         // ----
 
@@ -441,14 +503,6 @@ namespace mongo {
             }
         }
 
-        // 3) for each tag balance
-
-        int threshold = 8;
-        if ( balancedLastTime || distribution.totalChunks() < 20 )
-            threshold = 2;
-        else if ( distribution.totalChunks() < 80 )
-            threshold = 4;
-
         // randomize the order in which we balance the tags
         // this is so that one bad tag doesn't prevent others from getting balanced
         vector<string> tags;
@@ -461,6 +515,24 @@ namespace mongo {
             std::random_shuffle( tags.begin(), tags.end() );
         }
 
+        // 3) for each tag balance the load
+
+        if ( distribution.hasChunkHeat() ) {
+            for ( unsigned i = 0; i < tags.size(); i++ ) {
+                MigrateInfo* migrate = balanceChunkHeat( ns, distribution, tags[i] );
+                if ( migrate )
+                    return migrate;
+            }
+        }
+
+        // 4) for each tag balance
+
+        int threshold = 8;
+        if ( balancedLastTime || distribution.totalChunks() < 20 )
+            threshold = 2;
+        else if ( distribution.totalChunks() < 80 )
+            threshold = 4;
+
         for ( unsigned i=0; i<tags.size(); i++ ) {
             string tag = tags[i];
 
@@ -490,7 +562,11 @@ namespace mongo {
             if ( imbalance < threshold )
                 continue;
 
+            // When we know how hot the chunks are, move the coldest one so as not to undo the
+            // load balancing
             const vector<ChunkType *>& chunks = distribution.getChunks(from);
+            const ChunkType* chunkToMove = NULL;
+            double chunkToMoveHeat = 0;
             unsigned numJumboChunks = 0;
             for ( unsigned j = 0; j < chunks.size(); j++ ) {
                 const ChunkType& chunk = *chunks[j];
@@ -502,10 +578,23 @@ namespace mongo {
                     continue;
                 }
 
-                log() << " ns: " << ns << " going to move " << chunk
+                if ( !distribution.hasChunkHeat() ) {
+                    chunkToMove = &chunk;
+                    break;
+                }
+
+                const double heat = distribution.chunkHeat( chunk );
+                if ( chunkToMove == NULL || heat < chunkToMoveHeat ) {
+                    chunkToMove = &chunk;
+                    chunkToMoveHeat = heat;
+                }
+            }
+
+            if ( chunkToMove ) {
+                log() << " ns: " << ns << " going to move " << *chunkToMove
                       << " from: " << from << " to: " << to << " tag [" << tag << "]"
                       << endl;
-                return new MigrateInfo(ns, to, from, chunk.toBSON());
+                return new MigrateInfo(ns, to, from, chunkToMove->toBSON());
             }
 
             if ( numJumboChunks ) {
@@ -523,6 +612,104 @@ namespace mongo {
         return NULL;
     }
 
+    namespace {
+
+        // Below this many estimated recent ops of a tag, the load isn't worth balancing
+        const double kMinHeatToBalance = 1000;
+
+        // How much hotter than average the hottest shard of a tag may be
+        const double kHeatImbalanceThreshold = 0.25;
+
+    } // namespace
+
+    MigrateInfo* BalancerPolicy::balanceChunkHeat( const string& ns,
+                                                   const DistributionStatus& distribution,
+                                                   const string& tag ) {
+
+        string from;
+        double maxHeat = -1;
+        string to;
+        double minHeat = numeric_limits<double>::max();
+        double totalHeat = 0;
+        unsigned numShards = 0;
+
+        const set<string>& shards = distribution.shards();
+        for ( set<string>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
+            const string& shard = *i;
+            const ShardInfo& info = distribution.shardInfo( shard );
+            if ( ! info.hasTag( tag ) )
+                continue;
+
+            const double heat = distribution.shardHeatWithTag( shard, tag );
+            totalHeat += heat;
+            numShards++;
+
+            if ( heat > maxHeat ) {
+                from = shard;
+                maxHeat = heat;
+            }
+
+            if ( info.isSizeMaxed() || info.isDraining() )
+                continue;
+
+            if ( heat < minHeat ) {
+                to = shard;
+                minHeat = heat;
+            }
+        }
+
+        if ( numShards < 2 || from.empty() || to.empty() || from == to )
+            return NULL;
+
+        if ( totalHeat < kMinHeatToBalance )
+            return NULL;
+
+        const double meanHeat = totalHeat / numShards;
+        if ( maxHeat <= meanHeat * ( 1 + kHeatImbalanceThreshold ) )
+            return NULL;
+
+        LOG(1) << "collection : " << ns << endl;
+        LOG(1) << "donor      : " << from << " heat " << maxHeat << endl;
+        LOG(1) << "receiver   : " << to << " heat " << minHeat << endl;
+        LOG(1) << "mean heat  : " << meanHeat << endl;
+
+        // Moving a chunk of heat h leaves the hotter of the two shards at
+        // max(maxHeat - h, minHeat + h), which is lowest for h closest to half the difference. A
+        // chunk hotter than the difference would only move the hot spot, it needs splitting.
+        const double imbalance = maxHeat - minHeat;
+        const vector<ChunkType *>& chunks = distribution.getChunks( from );
+        const ChunkType* chunkToMove = NULL;
+        double bestDistance = 0;
+        for ( unsigned j = 0; j < chunks.size(); j++ ) {
+            const ChunkType& chunk = *chunks[j];
+            if ( chunk.getJumbo() || distribution.getTagForChunk( chunk ) != tag )
+                continue;
+
+            const double heat = distribution.chunkHeat( chunk );
+            if ( heat <= 0 || heat >= imbalance )
+                continue;
+
+            const double distance = std::fabs( heat - imbalance / 2 );
+            if ( chunkToMove == NULL || distance < bestDistance ) {
+                chunkToMove = &chunk;
+                bestDistance = distance;
+            }
+        }
+
+        if ( chunkToMove == NULL ) {
+            LOG(1) << "no chunk of " << from << " would even out its load with " << to
+                   << " tag [" << tag << "]" << endl;
+            return NULL;
+        }
+
+        log() << " ns: " << ns << " going to move " << *chunkToMove
+              << " from: " << from << " (heat " << maxHeat << ")"
+              << " to: " << to << " (heat " << minHeat << ")"
+              << " chunk heat: " << distribution.chunkHeat( *chunkToMove )
+              << " tag [" << tag << "]" << endl;
+        return new MigrateInfo( ns, to, from, chunkToMove->toBSON() );
+    }
+
 
     ShardInfo::ShardInfo(long long maxSizeMB,
                          long long currSizeMB,
@@ -40,6 +40,7 @@
 namespace mongo {
 
     class ChunkManager;
+    class ShardType;
 
     struct ChunkInfo {
         const BSONObj min;
@@ -126,6 +127,9 @@ namespace mongo {
     typedef std::map< std::string,ShardInfo > ShardInfoMap;
     typedef std::map<std::string, OwnedPointerVector<ChunkType>* > ShardToChunksMap;
 
+    // Estimated recent reads and writes of the chunks of a collection, by chunk min
+    typedef std::map<BSONObj, double> ChunkHeatMap;
+
     class DistributionStatus : boost::noncopyable {
     public:
         DistributionStatus( const ShardInfoMap& shardInfo,
@@ -138,6 +142,12 @@ namespace mongo {
          */
         bool addTagRange( const TagRange& range );
 
+        /**
+         * Sets how hot the chunks are, so that the policy balances load and not just chunk counts.
+         * 'chunkHeat' is not owned and must outlive this DistributionStatus.
+         */
+        void setChunkHeat( const ChunkHeatMap* chunkHeat ) { _chunkHeat = chunkHeat; }
+
         // ---- these methods might be better suiting in BalancerPolicy
         
         /**
@@ -164,6 +174,15 @@ namespace mongo {
         /** @return number of chunks in this shard with the given tag */
         unsigned numberOfChunksInShardWithTag( const std::string& shard, const std::string& tag ) const;
 
+        /** @return whether any chunk is known to be hot */
+        bool hasChunkHeat() const { return _chunkHeat != NULL && !_chunkHeat->empty(); }
+
+        /** @return the estimated recent ops of the chunk, 0 if unknown */
+        double chunkHeat( const ChunkType& chunk ) const;
+
+        /** @return the estimated recent ops of the chunks in this shard with the given tag */
+        double shardHeatWithTag( const std::string& shard, const std::string& tag ) const;
+
         /** @return chunks for the shard */
         const std::vector<ChunkType*>& getChunks(const std::string& shard) const;
 
@@ -195,6 +214,14 @@ namespace mongo {
                                              const ChunkManager& chunkMgr,
                                              ShardToChunksMap* shardToChunksMap);
 
+        /**
+         * Asks each of the shards how hot the chunks of 'ns' it owns have recently been.  Shards
+         * which can't tell are skipped.
+         */
+        static void populateChunkHeatMap(const std::string& ns,
+                                         const std::vector<ShardType>& shards,
+                                         ChunkHeatMap* chunkHeat);
+
         /**
          * Returns the tag of the given chunk by querying the config server.
          *
@@ -207,6 +234,7 @@ namespace mongo {
     private:
         const ShardInfoMap& _shardInfo;
         const ShardToChunksMap& _shardChunks;
+        const ChunkHeatMap* _chunkHeat;
         std::map<BSONObj,TagRange> _tagRanges;
         std::set<std::string> _allTags;
         std::set<std::string> _shards;
@@ -229,6 +257,17 @@ namespace mongo {
         static MigrateInfo* balance( const std::string& ns,
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
+
+    private:
+
+        /**
+         * Returns the move which best evens out the chunk heat of the hottest and the coldest
+         * shard for the tag, if the hottest one is much hotter than average.  Otherwise returns
+         * NULL.
+         */
+        static MigrateInfo* balanceChunkHeat( const std::string& ns,
+                                              const DistributionStatus& distribution,
+                                              const std::string& tag );
     };
 
 
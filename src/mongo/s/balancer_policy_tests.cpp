@@ -457,6 +457,116 @@ namespace mongo {
             ASSERT( !m );
         }
 
+        /**
+         * Sets the heat of the chunks of a shard, in order.
+         */
+        void setShardHeat( const OwnedShardToChunksMap& chunks,
+                           const string& shard,
+                           const vector<double>& heats,
+                           ChunkHeatMap* chunkHeat ) {
+            const vector<ChunkType*>& chunkList = chunks.map().find( shard )->second->vector();
+            ASSERT_EQUALS( chunkList.size(), heats.size() );
+            for ( size_t i = 0; i < chunkList.size(); i++ ) {
+                (*chunkHeat)[chunkList[i]->getMin()] = heats[i];
+            }
+        }
+
+        /**
+         * Chunk counts are even, but one shard has most of the load.  The chunk which best evens
+         * out the load of the hottest and the coldest shard moves between them.
+         */
+        TEST( BalancerPolicyTests, ChunkHeatMovesLoad ) {
+
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 3 , false );
+            addShard( chunks, 3 , false );
+            addShard( chunks, 3 , true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 3, false);
+            shards["shard1"] = ShardInfo(0, 3, false);
+            shards["shard2"] = ShardInfo(0, 3, false);
+
+            ChunkHeatMap chunkHeat;
+            setShardHeat( chunks, "shard0", { 5000, 3000, 1000 }, &chunkHeat );
+            setShardHeat( chunks, "shard1", { 100, 100, 100 }, &chunkHeat );
+            setShardHeat( chunks, "shard2", { 200, 200, 200 }, &chunkHeat );
+
+            DistributionStatus d(shards, chunks.map());
+            d.setChunkHeat( &chunkHeat );
+            ASSERT_EQUALS( 9000, d.shardHeatWithTag( "shard0", "" ) );
+
+            scoped_ptr<MigrateInfo> m(BalancerPolicy::balance( "ns", d, 0 ));
+            ASSERT( m );
+            ASSERT_EQUALS( "shard0" , m->from );
+            ASSERT_EQUALS( "shard1" , m->to );
+            ASSERT_EQUALS( 5000, chunkHeat[m->chunk.min] );
+
+            // Without the heat it all looks balanced
+            DistributionStatus countsOnly(shards, chunks.map());
+            scoped_ptr<MigrateInfo> none(BalancerPolicy::balance( "ns", countsOnly, 0 ));
+            ASSERT( !none );
+        }
+
+        /**
+         * Nothing moves when the load is even, or when the only thing that could move is a chunk
+         * hotter than the imbalance itself.
+         */
+        TEST( BalancerPolicyTests, ChunkHeatNoMove ) {
+
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 3 , false );
+            addShard( chunks, 3 , true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 3, false);
+            shards["shard1"] = ShardInfo(0, 3, false);
+
+            ChunkHeatMap evenHeat;
+            setShardHeat( chunks, "shard0", { 1000, 1100, 900 }, &evenHeat );
+            setShardHeat( chunks, "shard1", { 950, 1000, 1050 }, &evenHeat );
+
+            DistributionStatus even(shards, chunks.map());
+            even.setChunkHeat( &evenHeat );
+            scoped_ptr<MigrateInfo> m(BalancerPolicy::balance( "ns", even, 0 ));
+            ASSERT( !m );
+
+            ChunkHeatMap hotSpot;
+            setShardHeat( chunks, "shard0", { 10000, 0, 0 }, &hotSpot );
+            setShardHeat( chunks, "shard1", { 0, 0, 0 }, &hotSpot );
+
+            DistributionStatus single(shards, chunks.map());
+            single.setChunkHeat( &hotSpot );
+            m.reset(BalancerPolicy::balance( "ns", single, 0 ));
+            ASSERT( !m );
+        }
+
+        /**
+         * When balancing chunk counts, the coldest chunk moves.
+         */
+        TEST( BalancerPolicyTests, ChunkHeatCountsMoveColdest ) {
+
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 6 , false );
+            addShard( chunks, 0 , true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 6, false);
+            shards["shard1"] = ShardInfo(0, 0, false);
+
+            // Not enough load to balance it
+            ChunkHeatMap chunkHeat;
+            setShardHeat( chunks, "shard0", { 50, 40, 10, 30, 20, 60 }, &chunkHeat );
+
+            DistributionStatus d(shards, chunks.map());
+            d.setChunkHeat( &chunkHeat );
+            scoped_ptr<MigrateInfo> m(BalancerPolicy::balance( "ns", d, 0 ));
+            ASSERT( m );
+            ASSERT_EQUALS( "shard0" , m->from );
+            ASSERT_EQUALS( "shard1" , m->to );
+            ASSERT_EQUALS( 10, chunkHeat[m->chunk.min] );
+        }
+
         /**
          * Idea behind this test is that we set up several shards, the first two of which are
          * draining and the second two of which have a data size limit.  We also simulate a random
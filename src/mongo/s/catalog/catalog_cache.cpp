@@ -44,17 +44,43 @@ namespace mongo {
 
 
     CatalogCache::CatalogCache(CatalogManager* catalogManager)
-            : _catalogManager(catalogManager) {
+            : _catalogManager(catalogManager),
+              _generation(0) {
 
         invariant(_catalogManager);
     }
 
     StatusWith<shared_ptr<DBConfig>> CatalogCache::getDatabase(const string& dbName) {
-        boost::lock_guard<boost::mutex> guard(_mutex);
+        shared_ptr<boost::mutex> loadMutex;
+        {
+            boost::lock_guard<boost::mutex> guard(_mutex);
+
+            ShardedDatabasesMap::iterator it = _databases.find(dbName);
+            if (it != _databases.end()) {
+                return it->second;
+            }
+
+            shared_ptr<boost::mutex>& mutex = _loadMutexes[dbName];
+            if (!mutex) {
+                mutex = boost::make_shared<boost::mutex>();
+            }
+            loadMutex = mutex;
+        }
 
-        ShardedDatabasesMap::iterator it = _databases.find(dbName);
-        if (it != _databases.end()) {
-            return it->second;
+        // Loading a database loads the routing tables of all its sharded collections, which can
+        // take a while, so it is done without holding _mutex: the other databases stay available
+        // in the meantime. Requests for the same database wait for the one load.
+        boost::lock_guard<boost::mutex> loadGuard(*loadMutex);
+
+        unsigned long long generation;
+        {
+            boost::lock_guard<boost::mutex> guard(_mutex);
+
+            ShardedDatabasesMap::iterator it = _databases.find(dbName);
+            if (it != _databases.end()) {
+                return it->second;
+            }
+            generation = _generation;
         }
 
         // Need to load from the store
@@ -66,7 +92,18 @@ namespace mongo {
         shared_ptr<DBConfig> db = boost::make_shared<DBConfig>(dbName, status.getValue());
         db->load();
 
-        invariant(_databases.insert(std::make_pair(dbName, db)).second);
+        boost::lock_guard<boost::mutex> guard(_mutex);
+
+        LoadMutexMap::iterator it = _loadMutexes.find(dbName);
+        if (it != _loadMutexes.end() && it->second == loadMutex) {
+            _loadMutexes.erase(it);
+        }
+
+        // If the cache was invalidated during the load, what was loaded may already be stale,
+        // so only this caller gets to use it.
+        if (generation == _generation) {
+            invariant(_databases.insert(std::make_pair(dbName, db)).second);
+        }
 
         return db;
     }
@@ -78,12 +115,14 @@ namespace mongo {
         if (it != _databases.end()) {
             _databases.erase(it);
         }
+        _generation++;
     }
 
     void CatalogCache::invalidateAll() {
         boost::lock_guard<boost::mutex> guard(_mutex);
 
         _databases.clear();
+        _generation++;
     }
 
 } // namespace mongo
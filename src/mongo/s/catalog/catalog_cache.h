@@ -76,6 +76,7 @@ namespace mongo {
 
     private:
         typedef std::map<std::string, boost::shared_ptr<DBConfig>> ShardedDatabasesMap;
+        typedef std::map<std::string, boost::shared_ptr<boost::mutex>> LoadMutexMap;
 
 
         // Reference to the catalog manager. Not owned.
@@ -84,6 +85,13 @@ namespace mongo {
         // Databases catalog map and mutex to protect it
         boost::mutex _mutex;
         ShardedDatabasesMap _databases;
+
+        // Serializes the loads of each database which isn't cached yet. Guarded by _mutex.
+        LoadMutexMap _loadMutexes;
+
+        // Bumped on every invalidation, so that a load which raced with one isn't cached.
+        // Guarded by _mutex.
+        unsigned long long _generation;
     };
 
 } // namespace mongo
@@ -234,7 +234,7 @@ namespace mongo {
         bool operator!=(const Chunk& s) const { return ! ( *this == s ); }
 
         std::string getns() const;
-        Shard getShard() const { return _shard; }
+        const Shard& getShard() const { return _shard; }
         const ChunkManager* getManager() const { return _manager; }
         
 
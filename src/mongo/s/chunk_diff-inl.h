@@ -34,6 +34,7 @@
 #include "mongo/logger/logger.h"
 #include "mongo/logger/logstream_builder.h"
 #include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/partitioned_chunk_cursor.h"
 #include "mongo/util/concurrency/thread_name.h"
 
 namespace mongo {
@@ -98,10 +99,51 @@ namespace mongo {
 
         try {
 
+            // Full loads of many chunks read several ranges of versions in parallel
+            if (_currMap->empty()) {
+                const long long numChunks =
+                        PartitionedChunkCursor::countChunks(conn.get(), diffQuery.getFilter());
+                const int numPartitions = PartitionedChunkCursor::numPartitionsFor(numChunks);
+                if (numPartitions > 1) {
+                    conn.done();
+
+                    PartitionedChunkCursor partitionedCursor(config,
+                                                             diffQuery.getFilter(),
+                                                             numChunks,
+                                                             numPartitions);
+                    int diff = calculateConfigDiff(partitionedCursor);
+                    if (diff <= 0) {
+                        return diff;
+                    }
+
+                    // Chunks changed during the load have versions above all of the ones read,
+                    // but their old range may have been read before and the last one after they
+                    // changed, so read everything from the new max version again.
+                    ScopedDbConnection laterConn(config, 30.0);
+                    std::auto_ptr<DBClientCursor> laterCursor =
+                            laterConn->query(ChunkType::ConfigNS, configDiffQuery());
+                    uassert(ErrorCodes::HostUnreachable,
+                            "problem opening chunk metadata cursor",
+                            laterCursor.get());
+
+                    int laterDiff = calculateConfigDiff(*laterCursor.get());
+                    laterConn.done();
+
+                    if (laterDiff < 0) {
+                        return laterDiff;
+                    }
+
+                    _validDiffs = diff;
+                    return diff;
+                }
+            }
+
             // Open a cursor for the diff chunks
             std::auto_ptr<DBClientCursor> cursor = conn->query(
                     ChunkType::ConfigNS, diffQuery, 0, 0, 0, 0, ( kDebugBuild ? 2 : 1000000 ) );
-            verify( cursor.get() );
+            uassert(ErrorCodes::HostUnreachable,
+                    "problem opening chunk metadata cursor",
+                    cursor.get());
 
             int diff = calculateConfigDiff( *cursor.get() );
 
@@ -211,6 +211,9 @@ namespace {
             // Could be v.expensive
             // TODO: If chunks were immutable and didn't reference the manager, we could do more
             // interesting things here
+            //
+            // The old chunks are visited in key order, so each one is inserted with the end hint
+            // in constant time rather than comparing its key against log(n) others.
             for( ChunkMap::const_iterator it = oldChunkMap.begin(); it != oldChunkMap.end(); it++ ){
 
                 ChunkPtr oldC = it->second;
@@ -221,7 +224,7 @@ namespace {
 
                 c->setBytesWritten( oldC->getBytesWritten() );
 
-                chunkMap.insert( make_pair( oldC->getMax(), c ) );
+                chunkMap.insert( chunkMap.end(), make_pair( oldC->getMax(), c ) );
             }
 
             LOG(2) << "loading chunk manager for collection " << _ns
@@ -777,12 +780,13 @@ namespace {
     void ChunkRangeManager::_insertRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end) {
         while (begin != end) {
             ChunkMap::const_iterator first = begin;
-            Shard shard = first->second->getShard();
+            const Shard& shard = first->second->getShard();
             while (begin != end && (begin->second->getShard() == shard))
                 ++begin;
 
+            // Ranges are generated in key order, so hint the insert at the end of the map.
             shared_ptr<ChunkRange> cr (new ChunkRange(first, begin));
-            _ranges[cr->getMax()] = cr;
+            _ranges.insert(_ranges.end(), std::make_pair(cr->getMax(), cr));
         }
     }
 
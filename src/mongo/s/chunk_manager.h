@@ -57,7 +57,7 @@ namespace mongo {
         ChunkRange(const ChunkRange& min, const ChunkRange& max);
 
         const ChunkManager* getManager() const { return _manager; }
-        Shard getShard() const { return _shard; }
+        const Shard& getShard() const { return _shard; }
 
         const BSONObj& getMin() const { return _min; }
         const BSONObj& getMax() const { return _max; }
@@ -32,6 +32,8 @@
 
 #include "mongo/s/chunk_manager_targeter.h"
 
+#include <algorithm>
+
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
@@ -269,6 +271,21 @@ namespace {
         return false;
     }
 
+    /**
+     * Orders the indexes of documents to insert by their shard keys.
+     */
+    class ShardKeyIndexLess {
+    public:
+        explicit ShardKeyIndexLess(const vector<BSONObj>& shardKeys) : _shardKeys(shardKeys) {}
+
+        bool operator()(size_t lhs, size_t rhs) const {
+            return _shardKeys[lhs].woCompare(_shardKeys[rhs]) < 0;
+        }
+
+    private:
+        const vector<BSONObj>& _shardKeys;
+    };
+
 } // namespace
 
     ChunkManagerTargeter::ChunkManagerTargeter(const NamespaceString& nss)
@@ -296,34 +313,13 @@ namespace {
     Status ChunkManagerTargeter::targetInsert( const BSONObj& doc,
                                                ShardEndpoint** endpoint ) const {
 
-        BSONObj shardKey;
-
+        // Target the shard key or database primary
         if ( _manager ) {
-
-            //
-            // Sharded collections have the following requirements for targeting:
-            //
-            // Inserts must contain the exact shard key.
-            //
-
-            shardKey = _manager->getShardKeyPattern().extractShardKeyFromDoc(doc);
-
-            // Check shard key exists
-            if (shardKey.isEmpty()) {
-                return Status(ErrorCodes::ShardKeyNotFound,
-                              stream() << "document " << doc
-                                       << " does not contain shard key for pattern "
-                                       << _manager->getShardKeyPattern().toString());
-            }
-
-            // Check shard key size on insert
-            Status status = ShardKeyPattern::checkShardKeySize(shardKey);
+            BSONObj shardKey;
+            Status status = extractInsertShardKey(doc, &shardKey);
             if (!status.isOK())
                 return status;
-        }
 
-        // Target the shard key or database primary
-        if (!shardKey.isEmpty()) {
             return targetShardKey(shardKey, doc.objsize(), endpoint);
         }
         else {
@@ -339,6 +335,104 @@ namespace {
         }
     }
 
+    void ChunkManagerTargeter::targetInserts( const vector<BSONObj>& docs,
+                                              vector<ShardEndpoint*>* endpoints,
+                                              vector<Status>* statuses ) const {
+
+        endpoints->assign(docs.size(), NULL);
+        statuses->assign(docs.size(), Status::OK());
+
+        if (!_manager) {
+            for (size_t i = 0; i < docs.size(); ++i) {
+                (*statuses)[i] = targetInsert(docs[i], &(*endpoints)[i]);
+            }
+            return;
+        }
+
+        vector<BSONObj> shardKeys(docs.size());
+        vector<size_t> order;
+        order.reserve(docs.size());
+        for (size_t i = 0; i < docs.size(); ++i) {
+            (*statuses)[i] = extractInsertShardKey(docs[i], &shardKeys[i]);
+            if ((*statuses)[i].isOK()) {
+                order.push_back(i);
+            }
+        }
+
+        // In shard key order, the chunk of a document is most often the chunk of the previous
+        // document or the one after it, which saves looking up each key in the chunk map.
+        std::stable_sort(order.begin(), order.end(), ShardKeyIndexLess(shardKeys));
+
+        const ChunkMap& chunkMap = _manager->getChunkMap();
+        ChunkMap::const_iterator chunkIt = chunkMap.end();
+        string shardName;
+        ChunkVersion shardVersion;
+        long long chunkDataSize = 0;
+
+        for (vector<size_t>::const_iterator it = order.begin(); it != order.end(); ++it) {
+            const BSONObj& shardKey = shardKeys[*it];
+
+            if (chunkIt == chunkMap.end() || !chunkIt->second->containsKey(shardKey)) {
+                if (chunkIt != chunkMap.end()) {
+                    _stats.chunkSizeDelta[chunkIt->second->getMin()] += chunkDataSize;
+                    chunkDataSize = 0;
+
+                    ++chunkIt;
+                }
+
+                // The chunk map is keyed by the chunk max keys
+                if (chunkIt == chunkMap.end() || !chunkIt->second->containsKey(shardKey)) {
+                    chunkIt = chunkMap.upper_bound(shardKey);
+                }
+
+                if (chunkIt == chunkMap.end() || !chunkIt->second->containsKey(shardKey)) {
+                    // Leave reporting the inconsistent chunk map to the usual lookup
+                    (*statuses)[*it] = targetShardKey(shardKey,
+                                                      docs[*it].objsize(),
+                                                      &(*endpoints)[*it]);
+                    chunkIt = chunkMap.end();
+                    continue;
+                }
+
+                shardName = chunkIt->second->getShard().getName();
+                shardVersion = _manager->getVersion(shardName);
+            }
+
+            // Track autosplit stats for sharded collections, as targetShardKey does
+            chunkDataSize += docs[*it].objsize();
+
+            (*endpoints)[*it] = new ShardEndpoint(shardName, shardVersion);
+        }
+
+        if (chunkIt != chunkMap.end()) {
+            _stats.chunkSizeDelta[chunkIt->second->getMin()] += chunkDataSize;
+        }
+    }
+
+    Status ChunkManagerTargeter::extractInsertShardKey(const BSONObj& doc,
+                                                       BSONObj* shardKey) const {
+        invariant(NULL != _manager);
+
+        //
+        // Sharded collections have the following requirements for targeting:
+        //
+        // Inserts must contain the exact shard key.
+        //
+
+        *shardKey = _manager->getShardKeyPattern().extractShardKeyFromDoc(doc);
+
+        // Check shard key exists
+        if (shardKey->isEmpty()) {
+            return Status(ErrorCodes::ShardKeyNotFound,
+                          stream() << "document " << doc
+                                   << " does not contain shard key for pattern "
+                                   << _manager->getShardKeyPattern().toString());
+        }
+
+        // Check shard key size on insert
+        return ShardKeyPattern::checkShardKeySize(*shardKey);
+    }
+
     Status ChunkManagerTargeter::targetUpdate( const BatchedUpdateDocument& updateDoc,
                                                vector<ShardEndpoint*>* endpoints ) const {
 
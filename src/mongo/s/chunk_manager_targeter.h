@@ -70,6 +70,12 @@ namespace mongo {
         // Returns ShardKeyNotFound if document does not have a full shard key.
         Status targetInsert( const BSONObj& doc, ShardEndpoint** endpoint ) const;
 
+        // Extracts all the shard keys first, and finds their chunks in shard key order with a
+        // single forward walk over the chunk map.
+        void targetInserts( const std::vector<BSONObj>& docs,
+                            std::vector<ShardEndpoint*>* endpoints,
+                            std::vector<Status>* statuses ) const;
+
         // Returns ShardKeyNotFound if the update can't be targeted without a shard key.
         Status targetUpdate( const BatchedUpdateDocument& updateDoc,
                              std::vector<ShardEndpoint*>* endpoints ) const;
@@ -135,6 +141,13 @@ namespace mongo {
          */
         Status targetQuery( const BSONObj& query, std::vector<ShardEndpoint*>* endpoints ) const;
 
+        /**
+         * Returns the shard key of a document to insert into a sharded collection.
+         *
+         * Returns ShardKeyNotFound if the document does not have a full shard key.
+         */
+        Status extractInsertShardKey(const BSONObj& doc, BSONObj* shardKey) const;
+
         /**
          * Returns a ShardEndpoint for an exact shard key query.
          *
@@ -31,19 +31,25 @@
 #include "mongo/s/client/dbclient_multi_command.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <vector>
 
+#include "mongo/client/dbclientinterface.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/client/shard_connection.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/sock.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
     using boost::scoped_ptr;
     using std::deque;
     using std::string;
+    using std::vector;
 
     DBClientMultiCommand::PendingCommand::PendingCommand( const ConnectionString& endpoint,
                                                           StringData dbName,
@@ -52,6 +58,7 @@ namespace mongo {
         dbName( dbName.toString() ),
         cmdObj( cmdObj ),
         conn( NULL ),
+        sent( false ),
         status( Status::OK() ) {
     }
 
@@ -126,6 +133,11 @@ namespace mongo {
             it != _pendingCommands.end(); ++it ) {
 
             PendingCommand* command = *it;
+
+            // Commands added after an earlier sendAll may be queued behind ones already sent
+            if ( command->sent ) continue;
+            command->sent = true;
+
             dassert( NULL == command->conn );
 
             try {
@@ -154,7 +166,8 @@ namespace mongo {
                     // invalidate other connections which might be bad.  But if the connection
                     // doesn't seem bad, don't send it back, because we don't want to reuse it.
                     if ( !command->conn->isFailed() ) {
-                        delete command->conn;
+                        shardConnectionPool.discard( command->endpoint.toString(),
+                                                     command->conn );
                     }
                     else {
                         shardConnectionPool.release( command->endpoint.toString(), command->conn );
@@ -170,10 +183,55 @@ namespace mongo {
         return static_cast<int>( _pendingCommands.size() );
     }
 
+    DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::nextReadyCommand() {
+
+        dassert( !_pendingCommands.empty() );
+        if ( _pendingCommands.size() == 1u || !isPollSupported() )
+            return _pendingCommands.begin();
+
+        vector<pollfd> pollInfo;
+        vector<PendingQueue::iterator> polledCommands;
+
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+
+            PendingCommand* command = *it;
+            if ( !command->sent ) continue;
+
+            // Send errors are reported without waiting on anything
+            if ( !command->status.isOK() ) return it;
+
+            // Only plain connections expose a socket we can poll
+            DBClientConnection* conn = dynamic_cast<DBClientConnection*>( command->conn );
+            if ( NULL == conn || conn->port().psock->rawFD() < 0 )
+                return _pendingCommands.begin();
+
+            pollfd info;
+            info.fd = conn->port().psock->rawFD();
+            info.events = POLLIN;
+            info.revents = 0;
+            pollInfo.push_back( info );
+            polledCommands.push_back( it );
+        }
+
+        if ( pollInfo.empty() )
+            return _pendingCommands.begin();
+
+        // Errors and hangups count as ready too, the recv reports them
+        if ( socketPoll( &pollInfo[0], pollInfo.size(), -1 ) > 0 ) {
+            for ( size_t i = 0; i < pollInfo.size(); ++i ) {
+                if ( pollInfo[i].revents != 0 ) return polledCommands[i];
+            }
+        }
+
+        return _pendingCommands.begin();
+    }
+
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        scoped_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        PendingQueue::iterator readyIt = nextReadyCommand();
+        scoped_ptr<PendingCommand> command( *readyIt );
+        _pendingCommands.erase( readyIt );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
@@ -202,7 +260,7 @@ namespace mongo {
             // invalidate other connections which might be bad.  But if the connection doesn't seem
             // bad, don't send it back, because we don't want to reuse it.
             if ( !command->conn->isFailed() ) {
-                delete command->conn;
+                shardConnectionPool.discard( command->endpoint.toString(), command->conn );
             }
             else {
                 shardConnectionPool.release( command->endpoint.toString(), command->conn );
@@ -223,7 +281,9 @@ namespace mongo {
 
             PendingCommand* command = *it;
 
-            if ( NULL != command->conn ) delete command->conn;
+            if ( NULL != command->conn ) {
+                shardConnectionPool.discard( command->endpoint.toString(), command->conn );
+            }
             delete command;
             command = NULL;
         }
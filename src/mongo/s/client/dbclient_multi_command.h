@@ -77,11 +77,22 @@ namespace mongo {
             // Where to send it
             DBClientBase* conn;
 
+            // Whether sendAll has already sent (or tried to send) it
+            bool sent;
+
             // If anything goes wrong
             Status status;
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
+
+        /**
+         * Returns the sent command whose response should be received next - one which failed to
+         * send, or whose connection has data ready.  Blocks until there is one, unless readiness
+         * can't be polled, in which case the oldest command is returned.
+         */
+        PendingQueue::iterator nextReadyCommand();
+
         PendingQueue _pendingCommands;
         int _timeoutMillis;
     };
@@ -241,7 +241,7 @@ namespace {
                 }
 
                 if (!isConnGood) {
-                    delete s->avail;
+                    shardConnectionPool.discard(addr, s->avail);
                     s->avail = NULL;
                 }
 
@@ -353,7 +353,7 @@ namespace {
         void clearPool() {
             for(HostMap::iterator iter = _hosts.begin(); iter != _hosts.end(); ++iter) {
                 if (iter->second->avail != NULL) {
-                    delete iter->second->avail;
+                    shardConnectionPool.discard(iter->first, iter->second->avail);
                 }
                 delete iter->second;
             }
@@ -484,7 +484,7 @@ namespace {
                 ClientConnections::threadInstance()->done(_addr, _conn);
             }
             else {
-                delete _conn;
+                shardConnectionPool.discard(_addr, _conn);
             }
 
             _conn = 0;
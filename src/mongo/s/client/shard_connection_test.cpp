@@ -78,6 +78,7 @@ namespace {
                 Client::initThread("ShardConnFixture", getGlobalServiceContext(), NULL);
             }
             _maxPoolSizePerHost = mongo::shardConnectionPool.getMaxPoolSize();
+            _maxInUsePerHost = mongo::shardConnectionPool.getMaxInUse();
 
             mongo::ConnectionString::setConnectionHook(
                     mongo::MockConnRegistry::get()->getConnStrHook());
@@ -92,6 +93,7 @@ namespace {
             delete _dummyServer;
 
             mongo::shardConnectionPool.setMaxPoolSize(_maxPoolSizePerHost);
+            mongo::shardConnectionPool.setMaxInUse(_maxInUsePerHost);
         }
 
         void killServer() {
@@ -156,6 +158,7 @@ namespace {
     private:
         MockRemoteDBServer* _dummyServer;
         uint32_t _maxPoolSizePerHost;
+        int _maxInUsePerHost;
     };
 
     TEST_F(ShardConnFixture, BasicShardConnection) {
@@ -321,5 +324,21 @@ namespace {
         conn1Again.done();
     }
 
+    TEST_F(ShardConnFixture, InUseLimitPerHost) {
+        mongo::shardConnectionPool.setMaxInUse(2);
+        mongo::shardConnectionPool.setInUseWaitTimeoutMillis(10);
+
+        ShardConnection conn1(TARGET_HOST, "test.user");
+        ShardConnection conn2(TARGET_HOST, "test.user");
+
+        ASSERT_THROWS(ShardConnection(TARGET_HOST, "test.user"), mongo::UserException);
+
+        // Discarding a connection frees its slot, just like returning it does
+        conn1.kill();
+        ShardConnection conn3(TARGET_HOST, "test.user");
+        conn3.done();
+        conn2.done();
+    }
+
 } // namespace
 } // namespace mongo
@@ -33,6 +33,7 @@
 #include "mongo/s/collection_metadata.h"
 
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -209,6 +210,8 @@ namespace mongo {
         metadata->_pendingMap.erase( pending.getMin() );
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangeBounds = this->_rangeBounds;
+        metadata->_rangeBoundEnds = this->_rangeBoundEnds;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -244,6 +247,8 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangeBounds = this->_rangeBounds;
+        metadata->_rangeBoundEnds = this->_rangeBoundEnds;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -434,6 +439,8 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_rangeBounds = this->_rangeBounds;
+        metadata->_rangeBoundEnds = this->_rangeBoundEnds;
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
@@ -455,14 +462,29 @@ namespace mongo {
             return true;
         }
 
-        if ( _rangesMap.size() <= 0 ) {
+        const size_t numRanges = _rangeBoundEnds.size() / 2;
+        if ( numRanges == 0 ) {
             return false;
         }
 
-        RangeMap::const_iterator it = _rangesMap.upper_bound( key );
-        if ( it != _rangesMap.begin() ) it--;
+        // Shard keys are compared field by field, in ascending order.
+        const KeyString keyString( key, Ordering::make( BSONObj() ) );
 
-        bool good = rangeContains( it->first, it->second, key );
+        // Count the ranges whose min is not above the key; the key can only be in the last one.
+        size_t first = 0;
+        size_t count = numRanges;
+        while ( count > 0 ) {
+            const size_t half = count / 2;
+            if ( compareRangeBound( 2 * ( first + half ), keyString ) <= 0 ) {
+                first += half + 1;
+                count -= half + 1;
+            }
+            else {
+                count = half;
+            }
+        }
+
+        bool good = first > 0 && compareRangeBound( 2 * first - 1, keyString ) > 0;
 
 #if 0
         // DISABLED because of SERVER-11175 - huge amount of logging
@@ -710,8 +732,10 @@ namespace mongo {
     }
 
     void CollectionMetadata::fillRanges() {
-        if (_chunksMap.empty())
+        if (_chunksMap.empty()) {
+            fillRangeBounds();
             return;
+        }
 
         // Load the chunk information, coallesceing their ranges.  The version for this shard
         // would be the highest version for any of the chunks.
@@ -741,6 +765,33 @@ namespace mongo {
         dassert(!min.isEmpty());
 
         _rangesMap.insert(make_pair(min, max));
+
+        fillRangeBounds();
+    }
+
+    void CollectionMetadata::fillRangeBounds() {
+        const Ordering ordering = Ordering::make(BSONObj());
+
+        _rangeBounds.clear();
+        _rangeBoundEnds.clear();
+        _rangeBoundEnds.reserve(2 * _rangesMap.size());
+        for (RangeMap::const_iterator it = _rangesMap.begin(); it != _rangesMap.end(); ++it) {
+            const KeyString min(it->first, ordering);
+            _rangeBounds.append(min.getBuffer(), min.getSize());
+            _rangeBoundEnds.push_back(_rangeBounds.size());
+
+            const KeyString max(it->second, ordering);
+            _rangeBounds.append(max.getBuffer(), max.getSize());
+            _rangeBoundEnds.push_back(_rangeBounds.size());
+        }
+    }
+
+    int CollectionMetadata::compareRangeBound(size_t i, const KeyString& key) const {
+        const size_t begin = i == 0 ? 0 : _rangeBoundEnds[i - 1];
+        return KeyString::compare(_rangeBounds.data() + begin,
+                                  _rangeBoundEnds[i] - begin,
+                                  key.getBuffer(),
+                                  key.getSize());
     }
 
     void CollectionMetadata::fillKeyPatternFields() {
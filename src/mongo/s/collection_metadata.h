@@ -29,6 +29,8 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/owned_pointer_vector.h"
@@ -40,6 +42,7 @@
 
 namespace mongo {
 
+    class KeyString;
     class MetadataLoader;
     class CollectionMetadata;
 
@@ -300,6 +303,12 @@ namespace mongo {
         // installations.
         RangeMap _rangesMap;
 
+        // A flat copy of _rangesMap for keyBelongsToMe() to binary search: the KeyStrings of the
+        // min and the max of each range, in order, back to back in _rangeBounds. Bound i ends at
+        // offset _rangeBoundEnds[i].
+        std::string _rangeBounds;
+        std::vector<size_t> _rangeBoundEnds;
+
         /**
          * Returns true if this metadata was loaded with all necessary information.
          */
@@ -310,6 +319,16 @@ namespace mongo {
          */
         void fillRanges();
 
+        /**
+         * Rebuilds _rangeBounds and _rangeBoundEnds from _rangesMap.
+         */
+        void fillRangeBounds();
+
+        /**
+         * Compares bound 'i' of _rangeBounds to 'key', like KeyString::compare().
+         */
+        int compareRangeBound( size_t i, const KeyString& key ) const;
+
         /**
          * Creates the _keyField* local data
          */
@@ -1241,6 +1241,17 @@ namespace {
         ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << MAXKEY)) );
     }
 
+    TEST_F(ThreeChunkWithRangeGapFixture, KeysOfOtherTypes) {
+        // Numbers of any type compare by value, and other types by their canonical type order.
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << MINKEY)) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << BSONNULL)) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 19.5)) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << 30LL)) );
+        ASSERT( getCollMetadata().keyBelongsToMe(BSON("a" << "abc")) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 20.0)) );
+        ASSERT_FALSE( getCollMetadata().keyBelongsToMe(BSON("a" << 29.99)) );
+    }
+
     TEST_F(ThreeChunkWithRangeGapFixture, GetNextFromEmpty) {
         ChunkType nextChunk;
         ASSERT( getCollMetadata().getNextChunk( getCollMetadata().getMinKey(), &nextChunk ) );
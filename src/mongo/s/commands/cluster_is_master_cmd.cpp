@@ -28,9 +28,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/operation_context.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/util/net/message_compressor.h"
 
 namespace mongo {
 namespace {
@@ -77,6 +80,8 @@ namespace {
             result.append("maxWireVersion", maxWireVersion);
             result.append("minWireVersion", minWireVersion);
 
+            negotiateMessageCompression(cmdObj, txn->getClient()->port(), &result);
+
             return true;
         }
 
@@ -268,6 +268,18 @@ namespace {
                         return false;
                     }
 
+                    // Shard key hashing always uses the original hash function.
+                    if (isHashedShardKey &&
+                        idx["hashVersion"].numberInt() != BSONElementHasher::HASH_VERSION_MD5) {
+
+                        errmsg = str::stream() << "can't shard collection " << ns
+                                               << " with hashed shard key " << proposedKey
+                                               << " because the hashed index uses hashVersion "
+                                               << idx["hashVersion"].numberInt();
+                        conn.done();
+                        return false;
+                    }
+
                     hasUsefulIndexForKey = true;
                 }
             }
@@ -76,10 +76,10 @@ namespace mongo {
     Shard Shard::EMPTY;
 
 
-    CollectionInfo::CollectionInfo(const CollectionType& coll) {
+    CollectionInfo::CollectionInfo(const CollectionType& coll, const ChunkManager* oldManager) {
         _dropped = coll.getDropped();
 
-        shard(new ChunkManager(coll));
+        shard(new ChunkManager(coll), oldManager);
         _dirty = false;
     }
 
@@ -94,9 +94,9 @@ namespace mongo {
         _cm.reset(cm);
     }
     
-    void CollectionInfo::shard(ChunkManager* manager) {
+    void CollectionInfo::shard(ChunkManager* manager, const ChunkManager* oldManager) {
         // Do this *first* so we're invisible to everyone else
-        manager->loadExistingRanges(configServer.getPrimary().getConnString(), NULL);
+        manager->loadExistingRanges(configServer.getPrimary().getConnString(), oldManager);
 
         //
         // Collections with no chunks are unsharded, no matter what the collections entry says
@@ -470,7 +470,16 @@ namespace mongo {
                 numCollsErased++;
             }
             else {
-                _collections[coll.getNs()] = CollectionInfo(coll);
+                // Keep the old chunk manager alive while the new one is built from it, so that
+                // a reload only reads the chunks which changed since then.
+                ChunkManagerPtr oldManager;
+                CollectionInfoMap::const_iterator it = _collections.find(coll.getNs());
+                if (it != _collections.end() && it->second.isSharded() &&
+                        it->second.getCM()->getVersion().epoch() == coll.getEpoch()) {
+                    oldManager = it->second.getCM();
+                }
+
+                _collections[coll.getNs()] = CollectionInfo(coll, oldManager.get());
                 numCollsSharded++;
             }
         }
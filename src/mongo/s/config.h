@@ -55,7 +55,11 @@ namespace mongo {
             _dropped = false;
         }
 
-        CollectionInfo(const CollectionType& in);
+        /**
+         * Loads the chunks of a sharded collection. If 'oldManager' is given and has the same
+         * epoch, only the chunks which changed since its version are read from the config servers.
+         */
+        CollectionInfo(const CollectionType& in, const ChunkManager* oldManager = NULL);
         ~CollectionInfo();
 
         bool isSharded() const {
@@ -68,7 +72,7 @@ namespace mongo {
 
         void resetCM(ChunkManager * cm);
 
-        void shard(ChunkManager* cm);
+        void shard(ChunkManager* cm, const ChunkManager* oldManager = NULL);
         void unshard();
 
         bool isDirty() const { return _dirty; }
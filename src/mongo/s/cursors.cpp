@@ -49,9 +49,9 @@
 #include "mongo/db/lasterror.h"
 #include "mongo/db/max_time.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/coarse_clock.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/log.h"
-#include "mongo/util/net/listen.h"
 
 namespace mongo {
 
@@ -62,6 +62,12 @@ namespace mongo {
 
     const int ShardedClientCursor::INIT_REPLY_BUFFER_SIZE = 32768;
 
+    // Whether sharded cursors have the shards produce their next batch while the client is still
+    // consuming the current one, and how much memory the unread replies may take up.
+    MONGO_EXPORT_SERVER_PARAMETER(cursorReadAhead, bool, true);
+    MONGO_EXPORT_SERVER_PARAMETER(cursorReadAheadMaxBytesPerCursor, int, 16 * 1024 * 1024);
+    MONGO_EXPORT_SERVER_PARAMETER(cursorReadAheadMaxBytesTotal, long long, 256 * 1024 * 1024);
+
     // Note: There is no counter for shardedEver from cursorInfo since it is deprecated
     static Counter64 cursorStatsMultiTarget;
     static Counter64 cursorStatsSingleTarget;
@@ -101,12 +107,13 @@ namespace mongo {
         _done = false;
 
         _id = 0;
+        _readAheadBytes = 0;
 
         if ( q.queryOptions & QueryOption_NoCursorTimeout ) {
             _lastAccessMillis = 0;
         }
         else
-            _lastAccessMillis = Listener::getElapsedTimeMillis();
+            _lastAccessMillis = CoarseClock::elapsedMillis();
 
         cursorStatsMultiTarget.increment();
     }
@@ -115,6 +122,7 @@ namespace mongo {
         verify( _cursor );
         delete _cursor;
         _cursor = 0;
+        cursorCache.noteReadAheadBytes(-_readAheadBytes);
         cursorStatsMultiTarget.decrement();
     }
 
@@ -132,7 +140,7 @@ namespace mongo {
 
     void ShardedClientCursor::accessed() {
         if ( _lastAccessMillis > 0 )
-            _lastAccessMillis = Listener::getElapsedTimeMillis();
+            _lastAccessMillis = CoarseClock::elapsedMillis();
     }
 
     long long ShardedClientCursor::idleTime( long long now ) {
@@ -150,6 +158,8 @@ namespace mongo {
 
         docCount = 0;
 
+        _cursor->setReadAhead(cursorCache.allowReadAhead(_readAheadBytes));
+
         // If ntoreturn is negative, it means that we should send up to -ntoreturn results
         // back to the client, and that we should only send a *single batch*. An ntoreturn of
         // 1 is also a special case which means "return up to 1 result in a single batch" (so
@@ -215,6 +225,10 @@ namespace mongo {
         _totalSent += docCount;
         _done = ! hasMoreBatches;
 
+        const long long readAheadBytes = _done ? 0 : _cursor->getReadAheadBytes();
+        cursorCache.noteReadAheadBytes(readAheadBytes - _readAheadBytes);
+        _readAheadBytes = readAheadBytes;
+
         return hasMoreBatches;
     }
 
@@ -346,7 +360,7 @@ namespace mongo {
         while ( true ) {
             boost::lock_guard<boost::mutex> lk( _mutex );
 
-            long long x = Listener::getElapsedTimeMillis() << 32;
+            long long x = CoarseClock::elapsedMillis() << 32;
             x |= _random.nextInt32();
 
             if ( x == 0 )
@@ -453,10 +467,22 @@ namespace mongo {
         result.appendNumber( "shardedEver" , _shardedTotal );
         result.append( "refs", static_cast<int>(cursorStatsSingleTarget.get()));
         result.append( "totalOpen", static_cast<int>(cursorStatsTotalOpen.get()));
+        result.appendNumber( "readAheadBytes", _readAheadBytes.load() );
+    }
+
+    bool CursorCache::allowReadAhead(long long cursorBytes) const {
+        return cursorReadAhead &&
+               cursorBytes < cursorReadAheadMaxBytesPerCursor &&
+               _readAheadBytes.load() < cursorReadAheadMaxBytesTotal;
+    }
+
+    void CursorCache::noteReadAheadBytes(long long delta) {
+        if (delta != 0)
+            _readAheadBytes.fetchAndAdd(delta);
     }
 
     void CursorCache::doTimeouts() {
-        long long now = Listener::getElapsedTimeMillis();
+        long long now = CoarseClock::elapsedMillis();
         boost::lock_guard<boost::mutex> lk( _mutex );
         for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
             // Note: cursors with no timeout will always have an idleTime of 0
@@ -35,6 +35,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/client/parallel.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 
 namespace mongo {
@@ -90,6 +91,9 @@ namespace mongo {
         long long _id;
         long long _lastAccessMillis; // 0 means no timeout
 
+        // This cursor's share of CursorCache's read-ahead bytes, as of its last batch.
+        long long _readAheadBytes;
+
     };
 
     typedef boost::shared_ptr<ShardedClientCursor> ShardedClientCursorPtr;
@@ -128,6 +132,19 @@ namespace mongo {
 
         void doTimeouts();
         void startTimeoutThread();
+
+        /**
+         * Returns whether a cursor whose unread read-ahead replies are estimated at 'cursorBytes'
+         * may have the shards produce batches before the client asks for them. This is checked
+         * once per batch and without coordination between cursors, so the limits are soft.
+         */
+        bool allowReadAhead(long long cursorBytes) const;
+
+        /**
+         * Adds 'delta' to the estimated size of the read-ahead replies of all cursors.
+         */
+        void noteReadAheadBytes(long long delta);
+
     private:
         mutable mongo::mutex _mutex;
 
@@ -150,6 +167,8 @@ namespace mongo {
         
         long long _shardedTotal;
 
+        AtomicInt64 _readAheadBytes;
+
         static const int _myLogLevel;
     };
 
@@ -0,0 +1,239 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/d_chunk_heat.h"
+
+#include <cmath>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/collection_metadata.h"
+#include "mongo/s/d_state.h"
+#include "mongo/s/shard_key_pattern.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::stringstream;
+
+    // One in this many ops is sampled for chunk heat, 0 turns sampling off
+    MONGO_EXPORT_SERVER_PARAMETER(chunkHeatSampleRate, int, 100);
+
+    // The time it takes for the chunk heat of past ops to halve
+    MONGO_EXPORT_SERVER_PARAMETER(chunkHeatHalfLifeSecs, int, 600);
+
+    namespace {
+
+        // Decaying more often than this isn't worth going through all the chunks
+        const long long kMinDecayIntervalMillis = 1000;
+
+        // Chunks whose estimated ops decay below this are forgotten
+        const double kMinTrackedOps = 1.0;
+
+    } // namespace
+
+    ChunkHeatTracker chunkHeatTracker;
+
+    bool ChunkHeatTracker::_shouldSample() {
+        const int sampleRate = chunkHeatSampleRate;
+        if ( sampleRate <= 0 )
+            return false;
+        return _numOps.fetchAndAdd( 1 ) % static_cast<unsigned>( sampleRate ) == 0;
+    }
+
+    void ChunkHeatTracker::noteRead( StringData ns, const BSONObj& doc ) {
+        if ( _shouldSample() )
+            _noteSampled( ns.toString(), doc, true, false );
+    }
+
+    void ChunkHeatTracker::noteInsert( StringData ns, const BSONObj& doc ) {
+        if ( _shouldSample() )
+            _noteSampled( ns.toString(), doc, true, true );
+    }
+
+    void ChunkHeatTracker::noteWrite( StringData ns, const BSONObj& query ) {
+        if ( _shouldSample() )
+            _noteSampled( ns.toString(), query, false, true );
+    }
+
+    void ChunkHeatTracker::_noteSampled( const string& ns,
+                                         const BSONObj& shardKey,
+                                         bool fromDoc,
+                                         bool isWrite ) {
+
+        if ( !shardingState.enabled() )
+            return;
+
+        CollectionMetadataPtr metadata = shardingState.getCollectionMetadata( ns );
+        if ( !metadata || metadata->getKeyPattern().isEmpty() )
+            return;
+
+        ShardKeyPattern shardKeyPattern( metadata->getKeyPattern() );
+        BSONObj key;
+        if ( fromDoc ) {
+            key = shardKeyPattern.extractShardKeyFromDoc( shardKey );
+        }
+        else {
+            StatusWith<BSONObj> status = shardKeyPattern.extractShardKeyFromQuery( shardKey );
+            if ( !status.isOK() )
+                return;
+            key = status.getValue();
+        }
+
+        if ( key.isEmpty() )
+            return;
+
+        ChunkType chunk;
+        if ( !metadata->getNextChunk( key, &chunk ) || chunk.getMin().woCompare( key ) > 0 ) {
+            return;
+        }
+
+        const double estimatedOps = chunkHeatSampleRate;
+        const long long now = curTimeMillis64();
+
+        boost::lock_guard<boost::mutex> lk( _mutex );
+
+        CollectionHeat& heat = _collections[ns];
+        _decay( &heat, now );
+
+        ChunkCounts& counts = heat.chunks[chunk.getMin()];
+        counts.max = chunk.getMax();
+        if ( isWrite ) {
+            counts.writes += estimatedOps;
+        }
+        else {
+            counts.reads += estimatedOps;
+        }
+    }
+
+    void ChunkHeatTracker::_decay( CollectionHeat* heat, long long nowMillis ) {
+
+        const long long elapsedMillis = nowMillis - heat->lastDecayMillis;
+        if ( heat->lastDecayMillis != 0 && elapsedMillis < kMinDecayIntervalMillis )
+            return;
+
+        const int halfLifeSecs = chunkHeatHalfLifeSecs;
+        if ( heat->lastDecayMillis != 0 && halfLifeSecs > 0 ) {
+
+            const double factor = std::pow( 0.5, elapsedMillis / ( halfLifeSecs * 1000.0 ) );
+
+            for ( ChunkCountsMap::iterator it = heat->chunks.begin(); it != heat->chunks.end(); ) {
+                ChunkCounts& counts = it->second;
+                counts.reads *= factor;
+                counts.writes *= factor;
+
+                if ( counts.reads + counts.writes < kMinTrackedOps ) {
+                    heat->chunks.erase( it++ );
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        heat->lastDecayMillis = nowMillis;
+    }
+
+    void ChunkHeatTracker::report( const string& ns, BSONObjBuilder* result ) {
+
+        BSONArrayBuilder chunksBuilder( result->subarrayStart( "chunks" ) );
+
+        boost::lock_guard<boost::mutex> lk( _mutex );
+
+        std::map<string, CollectionHeat>::iterator heatIt = _collections.find( ns );
+        if ( heatIt != _collections.end() ) {
+
+            CollectionHeat& heat = heatIt->second;
+            _decay( &heat, curTimeMillis64() );
+
+            for ( ChunkCountsMap::const_iterator it = heat.chunks.begin();
+                it != heat.chunks.end(); ++it ) {
+
+                BSONObjBuilder chunkBuilder( chunksBuilder.subobjStart() );
+                chunkBuilder.append( ChunkType::min(), it->first );
+                chunkBuilder.append( ChunkType::max(), it->second.max );
+                chunkBuilder.append( "reads", it->second.reads );
+                chunkBuilder.append( "writes", it->second.writes );
+                chunkBuilder.doneFast();
+            }
+        }
+
+        chunksBuilder.doneFast();
+    }
+
+    /**
+     * Reports the chunk heat of a collection on this shard to the balancer.
+     */
+    class GetChunkHeatCommand : public Command {
+    public:
+        GetChunkHeatCommand() : Command( "_getChunkHeat" ) {}
+
+        virtual bool slaveOk() const { return false; }
+        virtual bool adminOnly() const { return true; }
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+        virtual void help( stringstream& help ) const {
+            help << "internal\n"
+                    "  { _getChunkHeat : \"db.coll\" }\n"
+                    "returns the estimated recent reads and writes of the collection's chunks";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::internal);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        bool run(OperationContext* txn,
+                 const string& dbname,
+                 BSONObj& cmdObj,
+                 int,
+                 string& errmsg,
+                 BSONObjBuilder& result) {
+
+            const string ns = cmdObj.firstElement().str();
+            if ( !NamespaceString( ns ).isValid() ) {
+                errmsg = "need a valid namespace";
+                return false;
+            }
+
+            chunkHeatTracker.report( ns, &result );
+            result.append( "sampleRate", chunkHeatSampleRate );
+            return true;
+        }
+    } getChunkHeatCmd;
+
+} // namespace mongo
@@ -0,0 +1,124 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * Tracks how often the chunks of the sharded collections on this shard are read and written, so
+     * that the balancer can move load off of busy shards rather than just even out chunk counts.
+     *
+     * One in chunkHeatSampleRate ops is sampled and attributed to the chunk of the current
+     * CollectionMetadata containing its shard key; ops without the full shard key aren't counted.
+     * Counts are scaled by the sample rate to estimate the real number of ops, and decay with a
+     * half-life of chunkHeatHalfLifeSecs so that they describe recent load.
+     */
+    class ChunkHeatTracker {
+        MONGO_DISALLOW_COPYING(ChunkHeatTracker);
+    public:
+
+        ChunkHeatTracker() {}
+
+        /**
+         * Notes that a read of 'ns' returned 'doc'.
+         */
+        void noteRead( StringData ns, const BSONObj& doc );
+
+        /**
+         * Notes an insert of 'doc' into 'ns'.
+         */
+        void noteInsert( StringData ns, const BSONObj& doc );
+
+        /**
+         * Notes an update or a delete of the documents of 'ns' matching 'query'.
+         */
+        void noteWrite( StringData ns, const BSONObj& query );
+
+        /**
+         * Appends "chunks", an array of { min, max, reads, writes } with the estimated recent ops
+         * of each chunk of 'ns' which had any.
+         */
+        void report( const std::string& ns, BSONObjBuilder* result );
+
+    private:
+
+        struct ChunkCounts {
+            ChunkCounts() : reads( 0 ), writes( 0 ) {}
+
+            BSONObj max;
+            double reads;
+            double writes;
+        };
+
+        // Chunk min -> counts
+        typedef std::map<BSONObj, ChunkCounts> ChunkCountsMap;
+
+        struct CollectionHeat {
+            CollectionHeat() : lastDecayMillis( 0 ) {}
+
+            long long lastDecayMillis;
+            ChunkCountsMap chunks;
+        };
+
+        /**
+         * Returns whether the current op should be sampled.
+         */
+        bool _shouldSample();
+
+        /**
+         * Attributes a sampled op with the shard key 'shardKey' to its chunk, if 'ns' is sharded.
+         * 'fromDoc' tells whether 'shardKey' is a document to extract the shard key from, or a
+         * query.
+         */
+        void _noteSampled( const std::string& ns, const BSONObj& shardKey, bool fromDoc,
+                           bool isWrite );
+
+        /**
+         * Decays the counts of 'heat' for the time since it last was.  Must hold _mutex.
+         */
+        static void _decay( CollectionHeat* heat, long long nowMillis );
+
+        AtomicUInt32 _numOps;
+
+        // Protects _collections
+        boost::mutex _mutex;
+        std::map<std::string, CollectionHeat> _collections;
+    };
+
+    extern ChunkHeatTracker chunkHeatTracker;
+
+} // namespace mongo
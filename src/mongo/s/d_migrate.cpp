@@ -45,6 +45,7 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/action_set.h"
@@ -72,9 +73,11 @@
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/logger/ramlog.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/chunk.h"
@@ -84,6 +87,7 @@
 #include "mongo/s/catalog/dist_lock_manager.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/client/shard.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/exit.h"
@@ -136,6 +140,18 @@ namespace mongo {
 
     Tee* migrateLog = RamLog::get("migrate");
 
+    // Number of connections the recipient of a chunk pulls the initial clone over in parallel.
+    MONGO_EXPORT_SERVER_PARAMETER(migrateCloneConcurrency, int, 2);
+
+    // Number of cloned or transferred documents the recipient writes per acquisition of the
+    // collection lock.
+    MONGO_EXPORT_SERVER_PARAMETER(migrateDocsPerWriteLock, int, 100);
+
+    namespace {
+        // How many locs a _migrateClone request takes from the set still to be cloned at once.
+        const size_t kCloneLocsPerSlice = 1000;
+    }
+
     class MoveTimingHelper {
     public:
         MoveTimingHelper(OperationContext* txn,
@@ -624,30 +640,46 @@ namespace mongo {
             while (!isBufferFilled) {
                 AutoGetCollectionForRead ctx(txn, getNS());
 
-                boost::lock_guard<boost::mutex> sl(_mutex);
-                if (!_active) {
-                    errmsg = "not active";
-                    return false;
-                }
+                // Take the next slice of locs out of _cloneLocs and read it without holding
+                // either mutex, so that concurrent _migrateClone requests read disjoint sets of
+                // documents in parallel.
+                vector<RecordId> locs;
+                {
+                    boost::lock_guard<boost::mutex> sl(_mutex);
+                    if (!_active) {
+                        errmsg = "not active";
+                        return false;
+                    }
 
-                // TODO: fix SERVER-16540 race
+                    // TODO: fix SERVER-16540 race
 
-                Collection* collection = ctx.getCollection();
+                    if (!ctx.getCollection()) {
+                        errmsg = str::stream() << "collection " << _ns << " does not exist";
+                        return false;
+                    }
 
-                if (!collection) {
-                    errmsg = str::stream() << "collection " << _ns << " does not exist";
-                    return false;
+                    boost::lock_guard<boost::mutex> lk(_cloneLocsMutex);
+                    set<RecordId>::iterator sliceEnd = _cloneLocs.begin();
+                    for (size_t n = 0; n < kCloneLocsPerSlice && sliceEnd != _cloneLocs.end();
+                            ++n) {
+                        ++sliceEnd;
+                    }
+                    locs.assign(_cloneLocs.begin(), sliceEnd);
+                    _cloneLocs.erase(_cloneLocs.begin(), sliceEnd);
+                }
+
+                if (locs.empty()) {
+                    break;
                 }
 
-                boost::lock_guard<boost::mutex> lk(_cloneLocsMutex);
-                set<RecordId>::iterator cloneLocsIter = _cloneLocs.begin();
-                for ( ; cloneLocsIter != _cloneLocs.end(); ++cloneLocsIter) {
+                Collection* collection = ctx.getCollection();
+                vector<RecordId>::const_iterator locsIter = locs.begin();
+                for ( ; locsIter != locs.end(); ++locsIter) {
                     if (tracker.intervalHasElapsed()) // should I yield?
                         break;
 
-                    RecordId dl = *cloneLocsIter;
                     Snapshotted<BSONObj> doc;
-                    if (!collection->findDoc(txn, dl, &doc)) {
+                    if (!collection->findDoc(txn, *locsIter, &doc)) {
                         // doc was deleted
                         continue;
                     }
@@ -665,11 +697,13 @@ namespace mongo {
                     clonedDocsArrayBuilder.append(doc.value());
                 }
 
-                _cloneLocs.erase(_cloneLocs.begin(), cloneLocsIter);
-
-                // Note: must be holding _cloneLocsMutex, don't move this inside while condition!
-                if (_cloneLocs.empty()) {
-                    break;
+                // Give back the locs we didn't get to while still holding the collection lock,
+                // so that aboutToDelete() can't have missed any of them. The caller will ask
+                // again, so a concurrent request that found _cloneLocs empty in the meantime
+                // doesn't leave them behind.
+                if (locsIter != locs.end()) {
+                    boost::lock_guard<boost::mutex> lk(_cloneLocsMutex);
+                    _cloneLocs.insert(locsIter, locs.cend());
                 }
             }
 
@@ -1809,6 +1843,109 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    /**
+     * Pulls the initial clone of a chunk from the donor over several connections at once, each
+     * issuing _migrateClone requests of its own, while the migrate thread inserts the batches
+     * already received. The donor gives concurrent requests disjoint sets of documents.
+     */
+    class CloneBatchFetcher {
+        MONGO_DISALLOW_COPYING(CloneBatchFetcher);
+    public:
+        CloneBatchFetcher(const std::string& fromShard, int numFetchers)
+            : _fromShard(fromShard),
+              _numFetchers(std::max(1, numFetchers)),
+              _numFinished(0),
+              _batches(_numFetchers + 1) {
+            for (int i = 0; i < _numFetchers; i++) {
+                _threads.push_back(new boost::thread(stdx::bind(&CloneBatchFetcher::_fetch,
+                                                                this)));
+            }
+        }
+
+        ~CloneBatchFetcher() {
+            _stopped.store(1);
+            for (size_t i = 0; i < _threads.size(); i++) {
+                // A fetcher may be blocked on a full queue.
+                do {
+                    _batches.clear();
+                } while (!_threads[i]->timed_join(boost::posix_time::milliseconds(10)));
+            }
+        }
+
+        /**
+         * Waits up to 'maxSecondsToWait' for a batch of documents and returns false if none
+         * came. Otherwise 'objects' is the next batch, or empty once all of the chunk has been
+         * received, or once a fetcher failed, in which case 'errmsg' says why.
+         */
+        bool next(BSONObj* objects, std::string* errmsg, int maxSecondsToWait) {
+            while (true) {
+                BSONObj batch;
+                if (!_batches.blockingPop(batch, maxSecondsToWait)) {
+                    return false;
+                }
+
+                if (!batch.isEmpty()) {
+                    *objects = batch;
+                    return true;
+                }
+
+                // A fetcher is done.
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                if (!_errmsg.empty() || ++_numFinished == _numFetchers) {
+                    *errmsg = _errmsg;
+                    *objects = BSONObj();
+                    return true;
+                }
+            }
+        }
+
+    private:
+        void _fetch() {
+            try {
+                ScopedDbConnection conn(_fromShard);
+                while (!_stopped.load()) {
+                    // gets array of objects to copy, in disk order
+                    BSONObj res;
+                    if (!conn->runCommand("admin", BSON("_migrateClone" << 1), res)) {
+                        _setError("_migrateClone failed: " + res.toString());
+                        break;
+                    }
+
+                    BSONObj objects = res["objects"].Obj().getOwned();
+                    if (objects.isEmpty()) {
+                        break;
+                    }
+                    _batches.push(objects);
+                }
+                conn.done();
+            }
+            catch (const std::exception& e) {
+                _setError(str::stream() << "_migrateClone failed: " << e.what());
+            }
+
+            // Tells next() that this fetcher is done.
+            _batches.push(BSONObj());
+        }
+
+        void _setError(const std::string& errmsg) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_errmsg.empty()) {
+                _errmsg = errmsg;
+            }
+        }
+
+        const std::string _fromShard;
+        const int _numFetchers;
+
+        boost::mutex _mutex; // protects _numFinished and _errmsg
+        int _numFinished;
+        std::string _errmsg;
+
+        AtomicUInt32 _stopped;
+        BlockingQueue<BSONObj> _batches;
+        OwnedPointerVector<boost::thread> _threads;
+    };
+
     class MigrateStatus {
     public:
         enum State {
@@ -2131,34 +2268,51 @@ namespace mongo {
                 // 3. initial bulk clone
                 setState(CLONE);
 
+                CloneBatchFetcher fetcher(fromShard, migrateCloneConcurrency);
                 while ( true ) {
-                    BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    BSONObj arr;
+                    string fetchErrmsg;
+                    if (!fetcher.next(&arr, &fetchErrmsg, 1)) {
+                        txn->checkForInterrupt();
+
+                        if ( getState() == ABORT ) {
+                            errmsg = str::stream() << "Migration abort requested while "
+                                                   << "copying documents";
+                            error() << errmsg << migrateLog;
+                            return;
+                        }
+                        continue;
+                    }
+
+                    if (!fetchErrmsg.empty()) {
                         setState(FAIL);
-                        errmsg = "_migrateClone failed: ";
-                        errmsg += res.toString();
+                        errmsg = fetchErrmsg;
                         error() << errmsg << migrateLog;
                         conn.done();
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    if (arr.isEmpty())
+                        break;
 
                     BSONObjIterator i( arr );
                     while( i.more() ) {
-                        txn->checkForInterrupt();
-
-                        if ( getState() == ABORT ) {
-                            errmsg = str::stream() << "Migration abort requested while "
-                                                   << "copying documents";
-                            error() << errmsg << migrateLog;
-                            return;
-                        }
+                        // Insert a batch of documents per acquisition of the write lock.
+                        OldClientWriteContext cx(txn, ns );
+
+                        long long numCloned = 0;
+                        long long clonedBytes = 0;
+                        for (int n = 0; n < migrateDocsPerWriteLock && i.more(); n++) {
+                            txn->checkForInterrupt();
+
+                            if ( getState() == ABORT ) {
+                                errmsg = str::stream() << "Migration abort requested while "
+                                                       << "copying documents";
+                                error() << errmsg << migrateLog;
+                                return;
+                            }
 
-                        BSONObj docToClone = i.next().Obj();
-                        {
-                            OldClientWriteContext cx(txn, ns );
+                            BSONObj docToClone = i.next().Obj();
 
                             BSONObj localDoc;
                             if (willOverrideLocalId(txn,
@@ -2182,34 +2336,33 @@ namespace mongo {
                             }
 
                             Helpers::upsert( txn, ns, docToClone, true );
+
+                            numCloned++;
+                            clonedBytes += docToClone.objsize();
                         }
-                        thisTime++;
 
                         {
                             boost::lock_guard<boost::mutex> statsLock(_mutex);
-                            _numCloned++;
-                            _clonedBytes += docToClone.objsize();
+                            _numCloned += numCloned;
+                            _clonedBytes += clonedBytes;
                         }
+                    }
 
-                        if (writeConcern.shouldWaitForOtherNodes()) {
-                            repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                                    repl::getGlobalReplicationCoordinator()->awaitReplication(
-                                            txn,
-                                            repl::ReplClientInfo::forClient(
-                                                    txn->getClient()).getLastOp(),
-                                            writeConcern);
-                            if (replStatus.status.code() == ErrorCodes::ExceededTimeLimit) {
-                                warning() << "secondaryThrottle on, but doc insert timed out; "
-                                             "continuing";
-                            }
-                            else {
-                                massertStatusOK(replStatus.status);
-                            }
+                    if (writeConcern.shouldWaitForOtherNodes()) {
+                        repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                                repl::getGlobalReplicationCoordinator()->awaitReplication(
+                                        txn,
+                                        repl::ReplClientInfo::forClient(
+                                                txn->getClient()).getLastOp(),
+                                        writeConcern);
+                        if (replStatus.status.code() == ErrorCodes::ExceededTimeLimit) {
+                            warning() << "secondaryThrottle on, but doc insert timed out; "
+                                         "continuing";
+                        }
+                        else {
+                            massertStatusOK(replStatus.status);
                         }
                     }
-
-                    if ( thisTime == 0 )
-                        break;
                 }
 
                 timing.done(3);
@@ -2404,72 +2557,81 @@ namespace mongo {
 
                 BSONObjIterator i( xfer["deleted"].Obj() );
                 while ( i.more() ) {
+                    // Apply a batch of deletes per acquisition of the collection lock.
                     Lock::CollectionLock clk(txn->lockState(), ns, MODE_X);
                     OldClientContext ctx(txn, ns);
 
-                    BSONObj id = i.next().Obj();
+                    for (int n = 0; n < migrateDocsPerWriteLock && i.more(); n++) {
+                        BSONObj id = i.next().Obj();
 
-                    // do not apply deletes if they do not belong to the chunk being migrated
-                    BSONObj fullObj;
-                    if (Helpers::findById(txn, ctx.db(), ns.c_str(), id, fullObj)) {
-                        if (!isInRange(fullObj , min , max , shardKeyPattern)) {
-                            log() << "not applying out of range deletion: " << fullObj << migrateLog;
+                        // do not apply deletes if they do not belong to the chunk being migrated
+                        BSONObj fullObj;
+                        if (Helpers::findById(txn, ctx.db(), ns.c_str(), id, fullObj)) {
+                            if (!isInRange(fullObj , min , max , shardKeyPattern)) {
+                                log() << "not applying out of range deletion: " << fullObj
+                                      << migrateLog;
 
-                            continue;
+                                continue;
+                            }
                         }
-                    }
 
-                    if (serverGlobalParams.moveParanoia) {
-                        rs.goingToDelete(fullObj);
-                    }
-
-                    deleteObjects(txn,
-                                  ctx.db(),
-                                  ns,
-                                  id,
-                                  PlanExecutor::YIELD_MANUAL,
-                                  true /* justOne */,
-                                  false /* god */,
-                                  true /* fromMigrate */);
+                        if (serverGlobalParams.moveParanoia) {
+                            rs.goingToDelete(fullObj);
+                        }
 
-                    *lastOpApplied = repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
-                    didAnything = true;
+                        deleteObjects(txn,
+                                      ctx.db(),
+                                      ns,
+                                      id,
+                                      PlanExecutor::YIELD_MANUAL,
+                                      true /* justOne */,
+                                      false /* god */,
+                                      true /* fromMigrate */);
+
+                        *lastOpApplied =
+                            repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
+                        didAnything = true;
+                    }
                 }
             }
 
             if ( xfer["reload"].isABSONObj() ) {
                 BSONObjIterator i( xfer["reload"].Obj() );
                 while ( i.more() ) {
+                    // Apply a batch of upserts per acquisition of the write lock.
                     OldClientWriteContext cx(txn, ns);
 
-                    BSONObj updatedDoc = i.next().Obj();
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(txn,
-                                            ns,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            updatedDoc,
-                                            &localDoc)) {
-                        string errMsg =
-                            str::stream() << "cannot migrate chunk, local document "
-                                          << localDoc
-                                          << " has same _id as reloaded remote document "
-                                          << updatedDoc;
-
-                        warning() << errMsg << endl;
-
-                        // Exception will abort migration cleanly
-                        uasserted( 16977, errMsg );
-                    }
+                    for (int n = 0; n < migrateDocsPerWriteLock && i.more(); n++) {
+                        BSONObj updatedDoc = i.next().Obj();
+
+                        BSONObj localDoc;
+                        if (willOverrideLocalId(txn,
+                                                ns,
+                                                min,
+                                                max,
+                                                shardKeyPattern,
+                                                cx.db(),
+                                                updatedDoc,
+                                                &localDoc)) {
+                            string errMsg =
+                                str::stream() << "cannot migrate chunk, local document "
+                                              << localDoc
+                                              << " has same _id as reloaded remote document "
+                                              << updatedDoc;
+
+                            warning() << errMsg << endl;
+
+                            // Exception will abort migration cleanly
+                            uasserted( 16977, errMsg );
+                        }
 
-                    // We are in write lock here, so sure we aren't killing
-                    Helpers::upsert( txn, ns , updatedDoc , true );
+                        // We are in write lock here, so sure we aren't killing
+                        Helpers::upsert( txn, ns , updatedDoc , true );
 
-                    *lastOpApplied = repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
-                    didAnything = true;
+                        *lastOpApplied =
+                            repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
+                        didAnything = true;
+                    }
                 }
             }
 
@@ -2704,9 +2866,12 @@ namespace mongo {
 
             // Pending deletes (for migrations) are serialized by the distributed collection lock,
             // we are sure we registered a delete for a range *before* we can migrate-in a
-            // subrange.
-            const size_t numDeletes = getDeleter()->getTotalDeletes();
+            // subrange. Deletes for other collections can't overlap the incoming chunk.
+            const string deletesNS = cmdObj.firstElement().String();
+            const size_t numDeletes = getDeleter()->getTotalDeletes(deletesNS);
             if (numDeletes > 0) {
+                // The balancer is going to retry, so get these out of the way first.
+                getDeleter()->prioritizeDeletes(deletesNS);
 
                 errmsg = str::stream() << "can't accept new chunks because "
                         << " there are still " << numDeletes
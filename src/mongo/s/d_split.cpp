@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -49,10 +50,13 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/index_legacy.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/chunk.h"
@@ -236,6 +240,127 @@ namespace mongo {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
 
+    // When the storage engine can return random index entries, splitVector picks split points
+    // from this many sampled entries per resulting chunk instead of walking the index. Each
+    // chunk's size is then off by about 1/sqrt(splitVectorSamplesPerChunk). 0 always walks.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorSamplesPerChunk, int, 100);
+
+    namespace {
+        // Collections this small are walked, which is about as cheap as sampling them.
+        const long long kMinRecordsToSample = 100 * 1000;
+
+        // Bounds on the number of random entries drawn; only those in the chunk are kept.
+        const long long kMinSampleDraws = 1000;
+        const long long kMaxSampleDraws = 20 * 1000;
+
+        struct KeyLess {
+            explicit KeyLess(const Ordering& ordering) : ordering(ordering) { }
+
+            bool operator()(const BSONObj& lhs, const BSONObj& rhs) const {
+                return lhs.woCompare(rhs, ordering, false) < 0;
+            }
+
+            Ordering ordering;
+        };
+
+        /**
+         * Finds the split points of the chunk [min, max) from random entries of 'idx', each
+         * standing for recCount / (entries drawn) documents, and appends them to 'splitKeys',
+         * which holds the first key of the chunk. Returns false, having appended nothing, if
+         * the index can't be sampled or too few of the entries drawn fall in the chunk to stay
+         * within the error splitVectorSamplesPerChunk allows; the caller then walks the index.
+         * Forced splits always walk the index, to split exactly at the median.
+         */
+        bool sampleSplitKeys(OperationContext* txn,
+                             Collection* collection,
+                             IndexDescriptor* idx,
+                             const BSONObj& keyPattern,
+                             const BSONObj& min,
+                             const BSONObj& max,
+                             long long recCount,
+                             long long keyCount,
+                             long long maxSplitPoints,
+                             vector<BSONObj>* splitKeys,
+                             set<BSONObj>* tooFrequentKeys) {
+            const long long samplesPerChunk = splitVectorSamplesPerChunk;
+            if (samplesPerChunk <= 0 || keyCount <= 0 || recCount < kMinRecordsToSample) {
+                return false;
+            }
+
+            IndexAccessMethod* iam = collection->getIndexCatalog()->getIndex(idx);
+            std::unique_ptr<SortedDataInterface::RandomCursor> cursor =
+                iam->newRandomCursor(txn);
+            if (!cursor) {
+                return false;
+            }
+
+            const KeyLess less(Ordering::make(idx->keyPattern()));
+            vector<BSONObj> samples;
+            long long draws = 0;
+            bool enough = false;
+            while (!enough && draws < kMaxSampleDraws) {
+                boost::optional<IndexKeyEntry> entry = cursor->next();
+                if (!entry) {
+                    return false;
+                }
+                draws++;
+
+                if (!less(entry->key, min) && less(entry->key, max)) {
+                    samples.push_back(entry->key.getOwned());
+                }
+
+                if (draws >= kMinSampleDraws) {
+                    // How many chunks the sample so far says [min, max) makes.
+                    const double docsInRange =
+                        static_cast<double>(recCount) * samples.size() / draws;
+                    const long long numChunks = 1 + static_cast<long long>(docsInRange / keyCount);
+                    enough = static_cast<long long>(samples.size()) >= samplesPerChunk * numChunks;
+                }
+            }
+
+            if (!enough) {
+                LOG(1) << "not sampling split points for " << collection->ns()
+                       << ": only " << samples.size() << " of " << draws
+                       << " sampled index entries were in the chunk";
+                return false;
+            }
+
+            std::sort(samples.begin(), samples.end(), less);
+
+            // Every 'samplesPerSplit'-th sample approximates every 'keyCount'-th key.
+            const double samplesPerSplit = static_cast<double>(keyCount) * draws / recCount;
+
+            long long numSplits = 0;
+            double pos = samplesPerSplit;
+            while (pos < samples.size()) {
+                const size_t i = static_cast<size_t>(pos);
+                const BSONObj currKey =
+                    prettyKey(idx->keyPattern(), samples[i]).extractFields(keyPattern);
+
+                // As when walking the index, all instances of a key must stay in one chunk.
+                if (currKey.woCompare(splitKeys->back()) == 0) {
+                    tooFrequentKeys->insert(currKey.getOwned());
+                    pos = i + 1;
+                    continue;
+                }
+
+                splitKeys->push_back(currKey.getOwned());
+                numSplits++;
+                LOG(4) << "picked a sampled split key: " << currKey;
+
+                if (maxSplitPoints && numSplits >= maxSplitPoints) {
+                    break;
+                }
+                pos = i + samplesPerSplit;
+            }
+
+            log() << "estimated split points for chunk " << collection->ns() << " " << min
+                  << " -->> " << max << " from " << samples.size() << " of " << draws
+                  << " sampled index entries";
+            return true;
+        }
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -428,8 +553,12 @@ namespace mongo {
                 set<BSONObj> tooFrequentKeys;
                 splitKeys.push_back(prettyKey(idx->keyPattern(), currKey.getOwned()).extractFields( keyPattern ) );
 
+                const bool sampled = !forceMedianSplit &&
+                    sampleSplitKeys(txn, collection, idx, keyPattern, min, max, recCount,
+                                    keyCount, maxSplitPoints, &splitKeys, &tooFrequentKeys);
+
                 exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
-                while ( 1 ) {
+                while ( !sampled ) {
                     while (PlanExecutor::ADVANCED == state) {
                         currCount++;
                         
@@ -503,6 +632,7 @@ namespace mongo {
                 // 4MB work of 'result' size. This should be okay for now.
 
                 result.append( "timeMillis", timer.millis() );
+                result.appendBool( "sampled", sampled );
             }
 
             result.append( "splitKeys" , splitKeys );
@@ -34,6 +34,7 @@
 
 #include "mongo/s/d_state.h"
 
+#include <boost/make_shared.hpp>
 #include <map>
 #include <string>
 #include <vector>
@@ -82,17 +83,17 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _publishedMetadata(boost::make_shared<CollectionMetadataMap>()) {
     }
 
     bool ShardingState::enabled() {
-        boost::lock_guard<boost::mutex> lk(_mutex);
-        return _enabled;
+        return _enabled.load();
     }
 
     string ShardingState::getConfigServer() {
         boost::lock_guard<boost::mutex> lk(_mutex);
-        invariant(_enabled);
+        invariant(_enabled.load());
 
         return configServer.getConnectionString().toString();
     }
@@ -166,34 +167,43 @@ namespace mongo {
     void ShardingState::clearCollectionMetadata() {
         boost::lock_guard<boost::mutex> lk(_mutex);
         _collMetadata.clear();
+        _publishMetadata_inlock();
+    }
+
+    void ShardingState::_publishMetadata_inlock() {
+        boost::shared_ptr<const CollectionMetadataMap> published =
+            boost::make_shared<CollectionMetadataMap>(_collMetadata);
+        boost::atomic_store(&_publishedMetadata, published);
+    }
+
+    CollectionMetadataPtr ShardingState::_getPublishedMetadata(const string& ns) const {
+        boost::shared_ptr<const CollectionMetadataMap> published =
+            boost::atomic_load(&_publishedMetadata);
+
+        CollectionMetadataMap::const_iterator it = published->find(ns);
+        if (it == published->end()) {
+            return CollectionMetadataPtr();
+        }
+        return it->second;
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
     bool ShardingState::hasVersion( const string& ns ) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
-
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        return it != _collMetadata.end();
+        return static_cast<bool>(_getPublishedMetadata(ns));
     }
 
     bool ShardingState::hasVersion( const string& ns , ChunkVersion& version ) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
-
-        CollectionMetadataMap::const_iterator it = _collMetadata.find(ns);
-        if ( it == _collMetadata.end() )
+        CollectionMetadataPtr p = _getPublishedMetadata(ns);
+        if ( !p )
             return false;
 
-        CollectionMetadataPtr p = it->second;
         version = p->getShardVersion();
         return true;
     }
 
     ChunkVersion ShardingState::getVersion(const string& ns) {
-        boost::lock_guard<boost::mutex> lk(_mutex);
-
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it != _collMetadata.end() ) {
-            CollectionMetadataPtr p = it->second;
+        CollectionMetadataPtr p = _getPublishedMetadata(ns);
+        if ( p ) {
             return p->getShardVersion();
         }
         else {
@@ -231,6 +241,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _publishMetadata_inlock();
     }
 
     void ShardingState::undoDonateChunk(OperationContext* txn,
@@ -245,6 +256,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _publishMetadata_inlock();
     }
 
     bool ShardingState::notePending(OperationContext* txn,
@@ -289,6 +301,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishMetadata_inlock();
         return true;
     }
 
@@ -334,6 +347,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _publishMetadata_inlock();
         return true;
     }
 
@@ -360,6 +374,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishMetadata_inlock();
     }
 
     void ShardingState::mergeChunks(OperationContext* txn,
@@ -384,6 +399,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _publishMetadata_inlock();
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -393,6 +409,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _publishMetadata_inlock();
     }
 
     Status ShardingState::refreshMetadataIfNeeded( OperationContext* txn,
@@ -419,12 +436,7 @@ namespace mongo {
         // metadata version or a different epoch before verifying against config server.
         //
 
-        CollectionMetadataPtr storedMetadata;
-        {
-            boost::lock_guard<boost::mutex> lk( _mutex );
-            CollectionMetadataMap::iterator it = _collMetadata.find( ns );
-            if ( it != _collMetadata.end() ) storedMetadata = it->second;
-        }
+        CollectionMetadataPtr storedMetadata = _getPublishedMetadata(ns);
         ChunkVersion storedShardVersion;
         if ( storedMetadata ) storedShardVersion = storedMetadata->getShardVersion();
         *latestShardVersion = storedShardVersion;
@@ -471,7 +483,7 @@ namespace mongo {
         // Ensure only one caller at a time initializes
         boost::lock_guard<boost::mutex> lk(_mutex);
 
-        if (_enabled) {
+        if (_enabled.load()) {
             // TODO: Do we need to throw exception if the config servers have changed from what we
             // already have in place? How do we test for that?
             return;
@@ -491,7 +503,7 @@ namespace mongo {
         uassertStatusOK(catalogManager->init(configServerCS));
         grid.setCatalogManager(std::move(catalogManager));
 
-        _enabled = true;
+        _enabled.store(true);
     }
 
     Status ShardingState::doRefreshMetadata( OperationContext* txn,
@@ -515,7 +527,7 @@ namespace mongo {
             boost::lock_guard<boost::mutex> lk( _mutex );
 
             // We can't reload if sharding is not enabled - i.e. without a config server location
-            if (!_enabled) {
+            if (!_enabled.load()) {
                 string errMsg = str::stream() << "cannot refresh metadata for " << ns
                                               << " before sharding has been enabled";
 
@@ -637,7 +649,7 @@ namespace mongo {
             boost::lock_guard<boost::mutex> lk( _mutex );
 
             // Don't reload if our config server has changed or sharding is no longer enabled
-            if (!_enabled) {
+            if (!_enabled.load()) {
                 string errMsg = str::stream() << "could not refresh metadata for " << ns
                                               << ", sharding is no longer enabled";
 
@@ -718,6 +730,7 @@ namespace mongo {
                     _collMetadata.erase( it );
                 }
 
+                _publishMetadata_inlock();
                 *latestShardVersion = remoteShardVersion;
             }
         }
@@ -791,8 +804,9 @@ namespace mongo {
     void ShardingState::appendInfo(BSONObjBuilder& builder) {
         boost::lock_guard<boost::mutex> lk(_mutex);
 
-        builder.appendBool("enabled", _enabled);
-        if (!_enabled) {
+        const bool enabled = _enabled.load();
+        builder.appendBool("enabled", enabled);
+        if (!enabled) {
             return;
         }
 
@@ -812,7 +826,7 @@ namespace mongo {
     }
 
     bool ShardingState::needCollectionMetadata( const string& ns ) const {
-        if ( ! _enabled )
+        if ( ! _enabled.load() )
             return false;
 
         if ( ! ShardedConnectionInfo::get( false ) )
@@ -822,15 +836,7 @@ namespace mongo {
     }
 
     CollectionMetadataPtr ShardingState::getCollectionMetadata( const string& ns ) {
-        boost::lock_guard<boost::mutex> lk( _mutex );
-
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it == _collMetadata.end() ) {
-            return CollectionMetadataPtr();
-        }
-        else {
-            return it->second;
-        }
+        return _getPublishedMetadata(ns);
     }
 
     ShardingState shardingState;
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/util/concurrency/ticketholder.h"
@@ -129,7 +130,7 @@ namespace mongo {
 
         void appendInfo( BSONObjBuilder& b );
 
-        // querying support
+        // querying support; the lookups don't lock, they read the last published metadata
 
         bool needCollectionMetadata( const std::string& ns ) const;
         CollectionMetadataPtr getCollectionMetadata( const std::string& ns );
@@ -278,11 +279,23 @@ namespace mongo {
                                   bool useRequestedVersion,
                                   ChunkVersion* latestShardVersion );
 
+        /**
+         * Replaces the published copy of _collMetadata with the current contents. Must be called
+         * with _mutex held after every change to _collMetadata.
+         */
+        void _publishMetadata_inlock();
+
+        /**
+         * Returns the published metadata for 'ns', or an empty pointer if it is not sharded.
+         * Doesn't take _mutex.
+         */
+        CollectionMetadataPtr _getPublishedMetadata(const std::string& ns) const;
+
         // protects state below
         mongo::mutex _mutex;
 
-        // Whether ::initialize has been called
-        bool _enabled;
+        // Whether ::initialize has been called. Only set under _mutex, but read without it.
+        AtomicWord<bool> _enabled;
 
         // Sets the shard name for this host (comes through setShardVersion)
         std::string _shardName;
@@ -294,6 +307,10 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef std::map<std::string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        // Immutable copy of _collMetadata, which the version checks on the request path read with
+        // boost::atomic_load instead of taking _mutex. Swapped in by _publishMetadata_inlock.
+        boost::shared_ptr<const CollectionMetadataMap> _publishedMetadata;
     };
 
     extern ShardingState shardingState;
@@ -45,7 +45,6 @@
 
 namespace mongo {
 
-    using std::auto_ptr;
     using std::endl;
     using std::make_pair;
     using std::map;
@@ -189,29 +188,13 @@ namespace mongo {
 
         try {
 
-            ScopedDbConnection conn( _configLoc.toString(), 30 );
-
-            auto_ptr<DBClientCursor> cursor = conn->query( ChunkType::ConfigNS,
-                                                           differ.configDiffQuery() );
-
-            if ( !cursor.get() ) {
-
-                // Make our metadata invalid
-                metadata->_collVersion = ChunkVersion( 0, 0, OID() );
-                metadata->_chunksMap.clear();
-                conn.done();
-
-                return Status( ErrorCodes::HostUnreachable,
-                               "problem opening chunk metadata cursor" );
-            }
-
             //
             // The diff tracker should always find at least one chunk (the highest chunk we saw
             // last time).  If not, something has changed on the config server (potentially between
             // when we read the collection data and when we read the chunks data).
             //
 
-            int diffsApplied = differ.calculateConfigDiff( *cursor );
+            int diffsApplied = differ.calculateConfigDiff( _configLoc.toString() );
             if ( diffsApplied > 0 ) {
 
                 // Chunks found, return ok
@@ -221,7 +204,6 @@ namespace mongo {
 
                 metadata->_shardVersion = versionMap[shard];
                 metadata->fillRanges();
-                conn.done();
 
                 invariant( metadata->isValid() );
                 return Status::OK();
@@ -243,7 +225,6 @@ namespace mongo {
 
                 metadata->_collVersion = ChunkVersion( 0, 0, OID() );
                 metadata->_chunksMap.clear();
-                conn.done();
 
                 return fullReload ? Status( ErrorCodes::NamespaceNotFound, errMsg ) :
                                     Status( ErrorCodes::RemoteChangeDetected, errMsg );
@@ -263,7 +244,6 @@ namespace mongo {
 
                 metadata->_collVersion = ChunkVersion( 0, 0, OID() );
                 metadata->_chunksMap.clear();
-                conn.done();
 
                 return Status( ErrorCodes::RemoteChangeDetected, errMsg );
             }
@@ -271,7 +251,7 @@ namespace mongo {
         catch ( const DBException& e ) {
             string errMsg = str::stream() << "problem querying chunks metadata" << causedBy( e );
 
-            // We deliberately do not return connPtr to the pool, since it was involved
+            // We deliberately do not return the connection to the pool, since it was involved
             // with the error here.
 
             return Status( ErrorCodes::HostUnreachable, errMsg );
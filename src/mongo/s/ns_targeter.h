@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/bson/bsonobj.h"
 #include "mongo/base/status.h"
@@ -85,6 +86,25 @@ namespace mongo {
          */
         virtual Status targetInsert( const BSONObj& doc, ShardEndpoint** endpoint ) const = 0;
 
+        /**
+         * Targets a batch of single document writes, as targetInsert targets each of them.  Sets
+         * (*endpoints)[i] to the endpoint for docs[i], or to NULL if (*statuses)[i] is !OK; the
+         * caller owns the endpoints.
+         *
+         * Implementations may target the batch more cheaply than document by document.
+         */
+        virtual void targetInserts( const std::vector<BSONObj>& docs,
+                                    std::vector<ShardEndpoint*>* endpoints,
+                                    std::vector<Status>* statuses ) const {
+            endpoints->clear();
+            statuses->clear();
+            for ( size_t i = 0; i < docs.size(); ++i ) {
+                ShardEndpoint* endpoint = NULL;
+                statuses->push_back( targetInsert( docs[i], &endpoint ) );
+                endpoints->push_back( endpoint );
+            }
+        }
+
         /**
          * Returns a vector of ShardEndpoints for a potentially multi-shard update.
          *
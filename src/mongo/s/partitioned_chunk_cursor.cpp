@@ -0,0 +1,229 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/partitioned_chunk_cursor.h"
+
+#include "mongo/client/connpool.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    // The number of ranges of versions the chunks of a collection are read in, in parallel, when
+    // loading at least internalChunkReadPartitionThreshold of them. 1 reads them all with a
+    // single cursor.
+    MONGO_EXPORT_SERVER_PARAMETER(internalChunkReadPartitions, int, 4);
+
+    // The number of chunks from which the chunks of a collection are read in parallel.
+    MONGO_EXPORT_SERVER_PARAMETER(internalChunkReadPartitionThreshold, int, 20000);
+
+namespace {
+
+    Query sortedByVersion(const BSONObj& query) {
+        return Query(query).sort(BSON(ChunkType::DEPRECATED_lastmod() << 1));
+    }
+
+}  // namespace
+
+    // static
+    long long PartitionedChunkCursor::countChunks(DBClientBase* conn, const BSONObj& query) {
+        try {
+            return conn->count(ChunkType::ConfigNS, query);
+        }
+        catch (const DBException& ex) {
+            // Only used to decide how to read the chunks, reading them reports the errors
+            LOG(1) << "couldn't count the chunks matching " << query << causedBy(ex);
+            return 0;
+        }
+    }
+
+    // static
+    int PartitionedChunkCursor::numPartitionsFor(long long numChunks) {
+        const int numPartitions = internalChunkReadPartitions;
+        if (numPartitions <= 1 || numChunks < internalChunkReadPartitionThreshold) {
+            return 1;
+        }
+        return numPartitions;
+    }
+
+    PartitionedChunkCursor::PartitionedChunkCursor(const string& config,
+                                                   const BSONObj& query,
+                                                   long long numChunks,
+                                                   int numPartitions)
+        : _config(config),
+          _current(0),
+          _closing(false) {
+
+        invariant(numPartitions > 1);
+
+        // The ranges start at the versions of every numChunks / numPartitions-th chunk. Reading
+        // only the version lets the config servers answer from the {ns, lastmod} index.
+        vector<BSONObj> bounds;
+        {
+            ScopedDbConnection conn(config, 30.0);
+
+            const BSONObj fields = BSON(ChunkType::DEPRECATED_lastmod() << 1 << "_id" << 0);
+            for (int i = 1; i < numPartitions; i++) {
+                std::auto_ptr<DBClientCursor> cursor =
+                    conn->query(ChunkType::ConfigNS,
+                                sortedByVersion(query),
+                                1,
+                                static_cast<int>(i * numChunks / numPartitions),
+                                &fields);
+                uassert(ErrorCodes::HostUnreachable,
+                        "problem opening chunk metadata cursor",
+                        cursor.get());
+
+                if (!cursor->more()) {
+                    // Chunks were removed since they were counted
+                    break;
+                }
+                bounds.push_back(cursor->nextSafe().getOwned());
+            }
+
+            conn.done();
+        }
+
+        const BSONElement nsElem = query[ChunkType::ns()];
+        const BSONElement minVersionElem =
+            query[ChunkType::DEPRECATED_lastmod()].Obj()["$gte"];
+
+        _partitions.resize(bounds.size() + 1);
+        for (size_t i = 0; i < _partitions.size(); i++) {
+            BSONObjBuilder partitionQuery;
+            partitionQuery.append(nsElem);
+
+            BSONObjBuilder versionB(partitionQuery.subobjStart(ChunkType::DEPRECATED_lastmod()));
+            versionB.appendAs(i == 0 ? minVersionElem : bounds[i - 1].firstElement(), "$gte");
+            if (i < bounds.size()) {
+                versionB.appendAs(bounds[i].firstElement(), "$lt");
+            }
+            versionB.done();
+
+            _threads.create_thread(stdx::bind(&PartitionedChunkCursor::_read,
+                                              this,
+                                              i,
+                                              partitionQuery.obj()));
+        }
+
+        LOG(1) << "reading " << numChunks << " chunks matching " << query << " in "
+               << _partitions.size() << " ranges";
+    }
+
+    PartitionedChunkCursor::~PartitionedChunkCursor() {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _closing = true;
+        }
+        _threads.join_all();
+    }
+
+    bool PartitionedChunkCursor::more() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+
+        while (_current < _partitions.size()) {
+            Partition& partition = _partitions[_current];
+            while (partition.docs.empty() && !partition.done) {
+                _readCond.wait(lk);
+            }
+
+            if (!partition.docs.empty()) {
+                return true;
+            }
+
+            uassertStatusOK(partition.status);
+            _current++;
+        }
+
+        return false;
+    }
+
+    BSONObj PartitionedChunkCursor::next() {
+        uassert(ErrorCodes::IllegalOperation, "no more chunks to read", more());
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        std::deque<BSONObj>& docs = _partitions[_current].docs;
+        const BSONObj doc = docs.front();
+        docs.pop_front();
+        return doc;
+    }
+
+    void PartitionedChunkCursor::_read(size_t index, const BSONObj& query) {
+        Status status = Status::OK();
+
+        try {
+            ScopedDbConnection conn(_config, 30.0);
+
+            std::auto_ptr<DBClientCursor> cursor =
+                conn->query(ChunkType::ConfigNS, sortedByVersion(query));
+            uassert(ErrorCodes::HostUnreachable,
+                    "problem opening chunk metadata cursor",
+                    cursor.get());
+
+            while (cursor->more()) {
+                // Hand over a batch at a time, the documents must outlive the cursor
+                vector<BSONObj> batch;
+                do {
+                    batch.push_back(cursor->nextSafe().getOwned());
+                } while (cursor->moreInCurrentBatch());
+
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                if (_closing) {
+                    // Don't return the connection to the pool with the cursor still open
+                    return;
+                }
+
+                Partition& partition = _partitions[index];
+                partition.docs.insert(partition.docs.end(), batch.begin(), batch.end());
+                _readCond.notify_all();
+            }
+
+            conn.done();
+        }
+        catch (const DBException& ex) {
+            status = ex.toStatus();
+        }
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        Partition& partition = _partitions[index];
+        partition.status = status;
+        partition.done = true;
+        _readCond.notify_all();
+    }
+
+}  // namespace mongo
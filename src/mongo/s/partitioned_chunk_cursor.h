@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class DBClientBase;
+
+    /**
+     * Reads the chunk documents matched by a config diff query (see
+     * ConfigDiffTracker::configDiffQuery) as several consecutive ranges of versions, in parallel
+     * and each over its own config server connection. The documents are returned in ascending
+     * version order, as a single cursor would return them, and the documents of a range are
+     * returned while the following ranges are still being read.
+     *
+     * Chunks changed while the ranges are read get higher versions than all of the chunks read,
+     * but the last range may already be read by then. Callers must read the chunks above the
+     * resulting max version again with a single cursor.
+     *
+     * Errors reading a range are thrown by more() once its documents are reached.
+     */
+    class PartitionedChunkCursor : public DBClientCursorInterface {
+    public:
+        /**
+         * Returns the number of chunk documents matched by the diff query 'query', or 0 if they
+         * couldn't be counted.
+         */
+        static long long countChunks(DBClientBase* conn, const BSONObj& query);
+
+        /**
+         * Returns the number of ranges to read 'numChunks' chunk documents in, or 1 if they should
+         * be read with a single cursor.
+         */
+        static int numPartitionsFor(long long numChunks);
+
+        /**
+         * Starts reading the 'numChunks' chunk documents matched by the diff query 'query' from
+         * the config servers 'config' in 'numPartitions' ranges. Throws a DBException if the
+         * boundaries of the ranges can't be read.
+         */
+        PartitionedChunkCursor(const std::string& config,
+                               const BSONObj& query,
+                               long long numChunks,
+                               int numPartitions);
+
+        /**
+         * Stops the reads which are still running, and waits for them.
+         */
+        virtual ~PartitionedChunkCursor();
+
+        virtual bool more();
+        virtual BSONObj next();
+
+    private:
+        struct Partition {
+            Partition() : done(false), status(Status::OK()) {}
+
+            // Documents read but not yet returned
+            std::deque<BSONObj> docs;
+
+            // Whether the read of this range has finished, successfully or not
+            bool done;
+            Status status;
+        };
+
+        void _read(size_t index, const BSONObj& query);
+
+        const std::string _config;
+
+        // Protects the state below, which the reading threads fill
+        boost::mutex _mutex;
+        boost::condition_variable _readCond;
+
+        std::vector<Partition> _partitions;
+
+        // Index of the range which documents are returned from
+        size_t _current;
+
+        // Set on destruction to stop the reads
+        bool _closing;
+
+        boost::thread_group _threads;
+    };
+
+}  // namespace mongo
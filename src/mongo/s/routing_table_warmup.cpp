@@ -0,0 +1,160 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/routing_table_warmup.h"
+
+#include <algorithm>
+#include <boost/thread/thread.hpp>
+#include <set>
+
+#include "mongo/base/status_with.h"
+#include "mongo/db/client.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/s/catalog/catalog_cache.h"
+#include "mongo/s/catalog/catalog_manager.h"
+#include "mongo/s/catalog/type_collection.h"
+#include "mongo/s/grid.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/stringutils.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+    // Comma separated list of the collections and databases whose routing tables are loaded at
+    // startup, or "*" for all sharded collections. See warmUpRoutingTables().
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableWarmupNamespaces, string, "");
+
+    // The number of threads loading routing tables at startup.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(routingTableWarmupThreads, int, 8);
+
+namespace {
+
+    void warmUpDatabases(const vector<string>* dbNames, AtomicUInt32* next) {
+        Client::initThread("routingTableWarmup");
+
+        for (size_t i = next->fetchAndAdd(1); i < dbNames->size(); i = next->fetchAndAdd(1)) {
+            const string& dbName = (*dbNames)[i];
+            try {
+                StatusWith<boost::shared_ptr<DBConfig>> status =
+                    grid.catalogCache()->getDatabase(dbName);
+                if (!status.isOK()) {
+                    warning() << "couldn't load routing tables of database " << dbName
+                              << causedBy(status.getStatus());
+                }
+            }
+            catch (const std::exception& ex) {
+                warning() << "couldn't load routing tables of database " << dbName
+                          << causedBy(ex);
+            }
+        }
+    }
+
+}  // namespace
+
+    vector<string> parseRoutingTableWarmupNamespaces(const string& namespaces, bool* all) {
+        *all = false;
+
+        vector<string> entries;
+        splitStringDelim(namespaces, &entries, ',');
+
+        vector<string> dbNames;
+        std::set<string> seen;
+        for (vector<string>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+            string entry = str::ltrim(*it);
+            entry.erase(entry.find_last_not_of(' ') + 1);
+            if (entry.empty()) {
+                continue;
+            }
+            if (entry == "*") {
+                *all = true;
+                continue;
+            }
+
+            const string dbName = nsToDatabase(entry);
+            if (seen.insert(dbName).second) {
+                dbNames.push_back(dbName);
+            }
+        }
+        return dbNames;
+    }
+
+    void warmUpRoutingTables() {
+        bool all;
+        vector<string> dbNames = parseRoutingTableWarmupNamespaces(routingTableWarmupNamespaces,
+                                                                   &all);
+        if (all) {
+            vector<CollectionType> collections;
+            Status status = grid.catalogManager()->getCollections(NULL, &collections);
+            if (!status.isOK()) {
+                warning() << "couldn't list sharded collections to warm up" << causedBy(status);
+            }
+
+            std::set<string> seen(dbNames.begin(), dbNames.end());
+            for (vector<CollectionType>::const_iterator it = collections.begin();
+                 it != collections.end(); ++it) {
+                const string dbName = nsToDatabase(it->getNs());
+                if (!it->getDropped() && seen.insert(dbName).second) {
+                    dbNames.push_back(dbName);
+                }
+            }
+        }
+
+        if (dbNames.empty()) {
+            return;
+        }
+
+        const size_t numThreads = std::min(dbNames.size(),
+                                           static_cast<size_t>(std::max(1,
+                                                               routingTableWarmupThreads)));
+        log() << "loading routing tables of " << dbNames.size() << " databases using "
+              << numThreads << " threads";
+
+        Timer timer;
+        AtomicUInt32 next;
+        boost::thread_group threads;
+        for (size_t i = 0; i < numThreads; i++) {
+            threads.create_thread(stdx::bind(&warmUpDatabases, &dbNames, &next));
+        }
+        threads.join_all();
+
+        log() << "loaded routing tables of " << dbNames.size() << " databases in "
+              << timer.millis() << "ms";
+    }
+
+}  // namespace mongo
@@ -0,0 +1,56 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace mongo {
+
+    /**
+     * Loads the routing tables of the sharded collections in the namespaces listed by the
+     * routingTableWarmupNamespaces server parameter, so that the first requests for them after
+     * mongos starts don't wait on the config servers. Each entry is a collection, a database,
+     * which stands for all its sharded collections, or "*" for every sharded collection.
+     *
+     * The databases are loaded in parallel, by up to routingTableWarmupThreads threads, and this
+     * returns once they are all loaded. Failures are logged and otherwise ignored: the routing
+     * tables that couldn't be loaded are loaded on demand, as without warm-up.
+     */
+    void warmUpRoutingTables();
+
+    /**
+     * Returns the names of the databases to load for the comma separated list of namespaces
+     * 'namespaces', as accepted by routingTableWarmupNamespaces, without looking up "*".
+     * Sets '*all' to whether the list includes "*". Exposed for testing.
+     */
+    std::vector<std::string> parseRoutingTableWarmupNamespaces(const std::string& namespaces,
+                                                               bool* all);
+
+}  // namespace mongo
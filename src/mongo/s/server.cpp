@@ -48,14 +48,17 @@
 #include "mongo/db/auth/authz_manager_external_state_s.h"
 #include "mongo/db/auth/user_cache_invalidator_job.h"
 #include "mongo/db/client_basic.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/dbwebserver.h"
 #include "mongo/db/initialize_server_global_state.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/log_process_details.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
 #include "mongo/db/startup_warnings_common.h"
+#include "mongo/logger/async_rotatable_file_appender.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/balance.h"
 #include "mongo/s/catalog/legacy/catalog_manager_legacy.h"
@@ -67,11 +70,13 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/mongos_options.h"
 #include "mongo/s/request.h"
+#include "mongo/s/routing_table_warmup.h"
 #include "mongo/s/version_mongos.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/admin_access.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
+#include "mongo/util/coarse_clock.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/exception_filter_win32.h"
@@ -132,7 +137,70 @@ namespace mongo {
         return errB.obj();
     }
 
+    /**
+     * Forwards replies to the client's port, and remembers the last one so an exhaust query can
+     * continue from it.
+     */
+    class ExhaustReplyPort : public AbstractMessagingPort {
+    public:
+        explicit ExhaustReplyPort(AbstractMessagingPort* port)
+            : _port(port), _lastReplyId(0), _lastCursorId(0) {
+            tag = port->tag;
+            setX509SubjectName(port->getX509SubjectName());
+        }
+
+        virtual void reply(Message& received, Message& response, MSGID responseTo) {
+            _port->reply(received, response, responseTo);
+            _noteReply(response);
+        }
+
+        virtual void reply(Message& received, Message& response) {
+            _port->reply(received, response);
+            _noteReply(response);
+        }
+
+        virtual HostAndPort remote() const { return _port->remote(); }
+        virtual unsigned remotePort() const { return _port->remotePort(); }
+        virtual SockAddr remoteAddr() const { return _port->remoteAddr(); }
+        virtual SockAddr localAddr() const { return _port->localAddr(); }
+
+        MSGID lastReplyId() const { return _lastReplyId; }
+
+        /** The cursor of the last reply, or 0 if it failed or there is nothing more to read. */
+        long long lastCursorId() const { return _lastCursorId; }
+
+    private:
+        void _noteReply(Message& response) {
+            MsgData::View header = response.header();
+            QueryResult::View qr = header.view2ptr();
+            _lastReplyId = header.getId();
+            _lastCursorId = 0;
+            if (header.getOperation() == opReply &&
+                !(qr.getResultFlags() & (ResultFlag_ErrSet | ResultFlag_CursorNotFound))) {
+                _lastCursorId = qr.getCursorId();
+            }
+        }
+
+        AbstractMessagingPort* const _port;
+        MSGID _lastReplyId;
+        long long _lastCursorId;
+    };
+
+    static bool isExhaustQuery(Message& m) {
+        if (m.operation() != dbQuery) {
+            return false;
+        }
+        DbMessage d(m);
+        QueryMessage q(d);
+        return (q.queryOptions & QueryOption_Exhaust) && !NamespaceString(q.ns).isCommand();
+    }
+
     class ShardedMessageHandler : public MessageHandler {
+        struct DetachedClient : public ConnectionState {
+            explicit DetachedClient(ServiceContext::UniqueClient c) : client(std::move(c)) {}
+            ServiceContext::UniqueClient client;
+        };
+
     public:
         virtual ~ShardedMessageHandler() {}
 
@@ -140,8 +208,48 @@ namespace mongo {
             Client::initThread("conn", getGlobalServiceContext(), p);
         }
 
+        virtual std::unique_ptr<ConnectionState> detachConnection() {
+            return std::unique_ptr<ConnectionState>(new DetachedClient(Client::releaseCurrent()));
+        }
+
+        virtual void attachConnection(std::unique_ptr<ConnectionState> state) {
+            Client::setCurrent(std::move(static_cast<DetachedClient*>(state.get())->client));
+        }
+
         virtual void process(Message& m, AbstractMessagingPort* p) {
             verify( p );
+            if (!isExhaustQuery(m)) {
+                _processRequest(m, p);
+                return;
+            }
+
+            // The client of an exhaust query reads batches until one has no cursor, without
+            // sending getMores, so issue them on its behalf. Sending each batch blocks until the
+            // client reads it, which keeps us from getting ahead of it.
+            const string ns = DbMessage(m).getns();
+            ExhaustReplyPort exhaustPort(p);
+            _processRequest(m, &exhaustPort);
+
+            while (exhaustPort.lastCursorId() && !inShutdown()) {
+                BufBuilder b(512);
+                b.appendNum((int) 0 /*size set later in appendData()*/);
+                b.appendNum(exhaustPort.lastReplyId());
+                b.appendNum((int) 0);
+                b.appendNum((int) dbGetMore);
+                b.appendNum((int) 0);
+                b.appendStr(ns);
+                b.appendNum((int) 0); // ntoreturn
+                b.appendNum(exhaustPort.lastCursorId());
+
+                Message getMore;
+                getMore.appendData(b.buf(), b.len());
+                b.decouple();
+                _processRequest(getMore, &exhaustPort);
+            }
+        }
+
+    private:
+        void _processRequest(Message& m, AbstractMessagingPort* p) {
             Request r( m , p );
 
             try {
@@ -193,6 +301,7 @@ namespace mongo {
         ShardedMessageHandler handler;
         MessageServer * server = createServer( opts , &handler );
         server->setAsTimeTracker();
+        CoarseClock::start();
         server->setupSockets();
         server->run();
     }
@@ -280,6 +389,7 @@ static ExitCode runMongosServer( bool doUpgrade ) {
     }
 
     configServer.reloadSettings();
+    warmUpRoutingTables();
 
 #if !defined(_WIN32)
     mongo::signalForkSuccess();
@@ -508,5 +618,6 @@ void mongo::dbexit( ExitCode rc, const char *why ) {
     log() << "dbexit: " << why
           << " rc:" << rc
           << endl;
+    logger::flushAllAppenders();
     quickExit(rc);
 }
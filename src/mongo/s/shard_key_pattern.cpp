@@ -114,14 +114,24 @@ namespace mongo {
         return parsedPaths.release();
     }
 
+    static vector<string> patternPathStrings(const vector<FieldRef*>& paths) {
+        vector<string> pathStrings;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            pathStrings.push_back(paths[i]->dottedField().toString());
+        }
+        return pathStrings;
+    }
+
     ShardKeyPattern::ShardKeyPattern(const BSONObj& keyPattern)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern)),
-          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? BSONObj() : keyPattern),
+          _extractor(patternPathStrings(_keyPatternPaths.vector())) {
     }
 
     ShardKeyPattern::ShardKeyPattern(const KeyPattern& keyPattern)
         : _keyPatternPaths(parseShardKeyPattern(keyPattern.toBSON())),
-          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern) {
+          _keyPattern(_keyPatternPaths.empty() ? KeyPattern(BSONObj()) : keyPattern),
+          _extractor(patternPathStrings(_keyPatternPaths.vector())) {
     }
 
     bool ShardKeyPattern::isValid() const {
@@ -255,8 +265,39 @@ namespace mongo {
     }
 
     BSONObj ShardKeyPattern::extractShardKeyFromDoc(const BSONObj& doc) const {
-        BSONMatchableDocument matchable(doc);
-        return extractShardKeyFromMatchable(matchable);
+
+        if (!isValid())
+            return BSONObj();
+
+        // Same result as extractShardKeyFromMatchable() on a BSONMatchableDocument, which
+        // doesn't traverse arrays either (and arrays aren't shard key elements), but without
+        // walking the document once per shard key field.
+        std::vector<BSONElement> matchEls;
+        _extractor.extract(doc, &matchEls);
+
+        BSONObjBuilder keyBuilder;
+
+        BSONObjIterator patternIt(_keyPattern.toBSON());
+        for (size_t i = 0; patternIt.more(); ++i) {
+
+            BSONElement patternEl = patternIt.next();
+            const BSONElement& matchEl = matchEls[i];
+
+            if (!isShardKeyElement(matchEl, true))
+                return BSONObj();
+
+            if (isHashedPatternEl(patternEl)) {
+                keyBuilder.append(patternEl.fieldName(),
+                                  BSONElementHasher::hash64(matchEl,
+                                                            BSONElementHasher::DEFAULT_HASH_SEED));
+            }
+            else {
+                keyBuilder.appendAs(matchEl, patternEl.fieldName());
+            }
+        }
+
+        dassert(isShardKey(keyBuilder.asTempObj()));
+        return keyBuilder.obj();
     }
 
     static BSONElement findEqualityElement(const EqualityMatches& equalities,
@@ -31,6 +31,7 @@
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
+#include "mongo/bson/bson_field_extractor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/matcher/matchable.h"
@@ -224,6 +225,9 @@ namespace mongo {
         const OwnedPointerVector<FieldRef> _keyPatternPaths;
 
         const KeyPattern _keyPattern;
+
+        // Looks up all the shard key paths in a document in one pass, for extractShardKeyFromDoc
+        const BSONFieldExtractor _extractor;
     };
 
 }
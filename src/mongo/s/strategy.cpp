@@ -161,13 +161,11 @@ namespace mongo {
         if ( q.ntoreturn == 1 && strstr(q.ns, ".$cmd") )
             throw UserException( 8010 , "something is wrong, shouldn't see a command here" );
 
-        if (q.queryOptions & QueryOption_Exhaust) {
-            uasserted(18526,
-                      string("the 'exhaust' query option is invalid for mongos queries: ") + q.ns
-                      + " " + q.query.toString());
-        }
+        // mongos streams the batches of an exhaust query itself (see ShardedMessageHandler), and
+        // reads them from the shards with regular getMores.
+        const int queryOptions = q.queryOptions & ~QueryOption_Exhaust;
 
-        QuerySpec qSpec( (string)q.ns, q.query, q.fields, q.ntoskip, q.ntoreturn, q.queryOptions );
+        QuerySpec qSpec( (string)q.ns, q.query, q.fields, q.ntoskip, q.ntoreturn, queryOptions );
 
         // Parse "$maxTimeMS".
         StatusWith<int> maxTimeMS = LiteParsedQuery::parseMaxTimeMSQuery( q.query );
@@ -216,6 +214,7 @@ namespace mongo {
             BufBuilder buffer( ShardedClientCursor::INIT_REPLY_BUFFER_SIZE );
             int docCount = 0;
             const int startFrom = cc->getTotalSent();
+            buffer.skip(sizeof(QueryResult::Value));
             bool hasMore = cc->sendNextBatch(q.ntoreturn, buffer, docCount);
 
             if ( hasMore ) {
@@ -232,7 +231,7 @@ namespace mongo {
                 cursorCache.store( cc, cursorLeftoverMillis );
             }
 
-            replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+            replyToQuery( 0, r.p(), r.m(), buffer, docCount,
                     startFrom, hasMore ? cc->getId() : 0 );
         }
         else{
@@ -618,6 +617,7 @@ namespace mongo {
             BufBuilder buffer( ShardedClientCursor::INIT_REPLY_BUFFER_SIZE );
             int docCount = 0;
             const int startFrom = cursor->getTotalSent();
+            buffer.skip(sizeof(QueryResult::Value));
             bool hasMore = cursor->sendNextBatch(ntoreturn, buffer, docCount);
 
             if ( hasMore ) {
@@ -638,7 +638,7 @@ namespace mongo {
                 cursorCache.remove( id );
             }
 
-            replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+            replyToQuery( 0, r.p(), r.m(), buffer, docCount,
                     startFrom, hasMore ? cursor->getId() : 0 );
             return;
         }
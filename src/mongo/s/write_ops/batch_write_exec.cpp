@@ -46,6 +46,7 @@ namespace mongo {
 
     using std::endl;
     using std::make_pair;
+    using std::string;
     using std::stringstream;
     using std::vector;
 
@@ -91,6 +92,17 @@ namespace mongo {
         return false;
     }
 
+    // Returns whether one of the child batches still to be sent goes to the given shard
+    static bool hasBatchToSend( const vector<TargetedWriteBatch*>& childBatches,
+                                const string& shardName ) {
+        for ( vector<TargetedWriteBatch*>::const_iterator it = childBatches.begin();
+            it != childBatches.end(); ++it ) {
+            if ( *it != NULL && ( *it )->getEndpoint().shardName == shardName )
+                return true;
+        }
+        return false;
+    }
+
     // The number of times we'll try to continue a batch op if no progress is being made
     // This only applies when no writes are occurring and metadata is not changing on reload
     static const int kMaxRoundsWithoutProgress( 5 );
@@ -157,20 +169,34 @@ namespace mongo {
             //
             // Send all child batches
             //
+            // Unordered batches are pipelined per host: as soon as a host returns the results of
+            // one child batch, the next batch for that host is sent, targeting the remaining ready
+            // ops again if none is left for it.  This way fast hosts don't wait for the slowest
+            // host of the round.  Only ready ops are retargeted - completed ops are never sent
+            // again - and once anything goes wrong we stop targeting and leave the failed ops to
+            // the next round, after the targeter has been refreshed.
+            //
+
+            const bool pipelined = !clientRequest.getOrdered();
+            bool keepTargeting = pipelined && targetStatus.isOK();
 
             size_t numSent = 0;
             size_t numToSend = childBatches.size();
             bool remoteMetadataChanging = false;
-            while ( numSent != numToSend ) {
 
-                // Collect batches out on the network, mapped by endpoint
-                OwnedHostBatchMap ownedPendingBatches;
-                OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+            // Collect batches out on the network, mapped by endpoint
+            OwnedHostBatchMap ownedPendingBatches;
+            OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+
+            while ( numSent != numToSend || _dispatcher->numPending() > 0 ) {
 
                 //
                 // Send side
                 //
 
+                const bool othersPending = !pendingBatches.empty();
+                size_t numSentNow = 0;
+
                 // Get as many batches as we can at once
                 for ( vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
                     it != childBatches.end(); ++it ) {
@@ -240,15 +266,21 @@ namespace mongo {
 
                     // Recv-side is responsible for cleaning up the nextBatch when used
                     pendingBatches.insert( make_pair( shardHost, nextBatch ) );
+                    ++numSentNow;
                 }
 
                 // Send them all out
                 _dispatcher->sendAll();
-                numSent += pendingBatches.size();
+                numSent += numSentNow;
+                if ( othersPending ) {
+                    _stats->numPipelinedBatches += numSentNow;
+                }
 
                 //
                 // Recv side
                 //
+                // Wait for all the outstanding batches, or when pipelining just for the next one.
+                //
 
                 while ( _dispatcher->numPending() > 0 ) {
 
@@ -258,8 +290,9 @@ namespace mongo {
                     Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
 
                     // Get the TargetedWriteBatch to find where to put the response
-                    dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
-                    TargetedWriteBatch* batch = pendingBatches.find( shardHost )->second;
+                    OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find( shardHost );
+                    dassert( pendingIt != pendingBatches.end() );
+                    TargetedWriteBatch* batch = pendingIt->second;
 
                     if ( dispatchStatus.isOK() ) {
 
@@ -279,6 +312,7 @@ namespace mongo {
                         if ( staleErrors.size() > 0 ) {
                             noteStaleResponses( staleErrors, _targeter );
                             ++_stats->numStaleBatches;
+                            keepTargeting = false;
                         }
 
                         // Remember if the shard is actively changing metadata right now
@@ -286,6 +320,11 @@ namespace mongo {
                             remoteMetadataChanging = true;
                         }
 
+                        // Don't keep targeting on top of a failed batch
+                        if ( !response.getOk() ) {
+                            keepTargeting = false;
+                        }
+
                         // Remember that we successfully wrote to this shard
                         // NOTE: This will record lastOps for shards where we actually didn't update
                         // or delete any documents, which preserves old behavior but is conservative
@@ -311,7 +350,36 @@ namespace mongo {
                                  << causedBy( dispatchStatus.toString() ) << endl;
 
                         batchOp.noteBatchError( *batch, error );
+                        keepTargeting = false;
+                    }
+
+                    // We're done with this batch, the host is free for the next one
+                    const string shardName = batch->getEndpoint().shardName;
+                    pendingBatches.erase( pendingIt );
+                    delete batch;
+
+                    if ( !pipelined )
+                        continue;
+
+                    // Find more work for this host if none is waiting for it
+                    if ( keepTargeting && !hasBatchToSend( childBatches, shardName ) ) {
+
+                        size_t numTargeted = childBatches.size();
+                        Status retargetStatus = batchOp.targetBatch( *_targeter,
+                                                                     recordTargetErrors,
+                                                                     &childBatches );
+                        if ( !retargetStatus.isOK() ) {
+                            // Leave the remaining ops for the next round
+                            _targeter->noteCouldNotTarget();
+                            refreshedTargeter = true;
+                            ++_stats->numTargetErrors;
+                            keepTargeting = false;
+                        }
+
+                        numToSend += childBatches.size() - numTargeted;
                     }
+
+                    break;
                 }
             }
 
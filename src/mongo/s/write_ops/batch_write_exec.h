@@ -109,7 +109,8 @@ namespace mongo {
     public:
 
         BatchWriteExecStats() :
-           numRounds( 0 ), numTargetErrors( 0 ), numResolveErrors( 0 ), numStaleBatches( 0 ) {
+           numRounds( 0 ), numTargetErrors( 0 ), numResolveErrors( 0 ), numStaleBatches( 0 ),
+           numPipelinedBatches( 0 ) {
         }
 
         void noteWriteAt(const ConnectionString& host, Timestamp opTime, const OID& electionId);
@@ -126,6 +127,8 @@ namespace mongo {
         int numResolveErrors;
         // Number of stale batches
         int numStaleBatches;
+        // Number of child batches sent while others of the same round were still outstanding
+        int numPipelinedBatches;
 
     private:
 
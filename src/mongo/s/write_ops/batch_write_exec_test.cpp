@@ -313,4 +313,73 @@ namespace {
         ASSERT_EQUALS( stats.numStaleBatches, 10 );
     }
 
+    /**
+     * Executes an insert of 3000 docs alternating between two shards, each getting more than fits
+     * in one child batch.
+     */
+    static void executeTwoShardInsert( bool ordered, BatchWriteExecStats* stats ) {
+
+        NamespaceString nss( "foo.bar" );
+
+        ShardEndpoint endpointA( "shardA", ChunkVersion::IGNORED() );
+        ShardEndpoint endpointB( "shardB", ChunkVersion::IGNORED() );
+        vector<MockRange*> mockRanges;
+        mockRanges.push_back( new MockRange( endpointA,
+                                             nss,
+                                             BSON( "x" << MINKEY ),
+                                             BSON( "x" << 0 ) ) );
+        mockRanges.push_back( new MockRange( endpointB,
+                                             nss,
+                                             BSON( "x" << 0 ),
+                                             BSON( "x" << MAXKEY ) ) );
+
+        MockNSTargeter targeter;
+        targeter.init( mockRanges );
+        MockShardResolver resolver;
+        MockMultiWriteCommand dispatcher;
+        BatchWriteExec exec( &targeter, &resolver, &dispatcher );
+
+        BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+        request.setNS( nss.ns() );
+        request.setOrdered( ordered );
+        request.setWriteConcern( BSONObj() );
+        for ( int i = 1; i <= 1500; i++ ) {
+            request.getInsertRequest()->addToDocuments( BSON( "x" << -i ) );
+            request.getInsertRequest()->addToDocuments( BSON( "x" << i ) );
+        }
+
+        BatchedCommandResponse response;
+        exec.executeBatch( request, &response );
+        ASSERT( response.getOk() );
+        ASSERT( !response.isErrDetailsSet() );
+
+        stats->numRounds = exec.getStats().numRounds;
+        stats->numPipelinedBatches = exec.getStats().numPipelinedBatches;
+    }
+
+    TEST(BatchWriteExecTests, UnorderedPipelinedPerShard) {
+
+        //
+        // Each shard gets its next child batch as soon as it returns the previous one, within a
+        // single round
+        //
+
+        BatchWriteExecStats stats;
+        executeTwoShardInsert( false, &stats );
+        ASSERT_EQUALS( stats.numRounds, 1 );
+        ASSERT_EQUALS( stats.numPipelinedBatches, 2 );
+    }
+
+    TEST(BatchWriteExecTests, OrderedNotPipelined) {
+
+        //
+        // Ordered batches are still sent a round at a time
+        //
+
+        BatchWriteExecStats stats;
+        executeTwoShardInsert( true, &stats );
+        ASSERT_GREATER_THAN( stats.numRounds, 1 );
+        ASSERT_EQUALS( stats.numPipelinedBatches, 0 );
+    }
+
 } // unnamed namespace
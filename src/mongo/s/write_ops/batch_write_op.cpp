@@ -289,6 +289,32 @@ namespace mongo {
         int numTargetErrors = 0;
 
         size_t numWriteOps = _clientRequest->sizeWriteOps();
+
+        //
+        // Unordered inserts are all targeted at once, so the targeter can find their chunks in
+        // shard key order.  Ordered batches often only send a prefix of their writes per round, so
+        // they're still targeted one write at a time.
+        //
+
+        const bool targetInsertsAtOnce =
+            !ordered && _clientRequest->getBatchType() == BatchedCommandRequest::BatchType_Insert
+            && !_clientRequest->isInsertIndexRequest();
+
+        OwnedPointerVector<ShardEndpoint> insertEndpointsOwned;
+        vector<ShardEndpoint*>& insertEndpoints = insertEndpointsOwned.mutableVector();
+        vector<Status> insertStatuses;
+        size_t numInsertsTargeted = 0;
+
+        if ( targetInsertsAtOnce ) {
+            vector<BSONObj> docs;
+            for ( size_t i = 0; i < numWriteOps; ++i ) {
+                if ( _writeOps[i].getWriteState() == WriteOpState_Ready ) {
+                    docs.push_back( _writeOps[i].getWriteItem().getDocument() );
+                }
+            }
+            targeter.targetInserts( docs, &insertEndpoints, &insertStatuses );
+        }
+
         for ( size_t i = 0; i < numWriteOps; ++i ) {
 
             WriteOp& writeOp = _writeOps[i];
@@ -304,7 +330,17 @@ namespace mongo {
             OwnedPointerVector<TargetedWrite> writesOwned;
             vector<TargetedWrite*>& writes = writesOwned.mutableVector();
 
-            Status targetStatus = writeOp.targetWrites( targeter, &writes );
+            Status targetStatus = Status::OK();
+            if ( targetInsertsAtOnce ) {
+                const size_t insertIndex = numInsertsTargeted++;
+                targetStatus = insertStatuses[insertIndex];
+                if ( targetStatus.isOK() ) {
+                    writeOp.targetInsertTo( *insertEndpoints[insertIndex], &writes );
+                }
+            }
+            else {
+                targetStatus = writeOp.targetWrites( targeter, &writes );
+            }
 
             if ( !targetStatus.isOK() ) {
 
@@ -115,7 +115,23 @@ namespace mongo {
         // If we had an error, stop here
         if ( !targetStatus.isOK() ) return targetStatus;
 
-        for ( vector<ShardEndpoint*>::iterator it = endpoints.begin(); it != endpoints.end();
+        addTargetedWrites( endpoints, targetedWrites );
+        return Status::OK();
+    }
+
+    void WriteOp::targetInsertTo( const ShardEndpoint& endpoint,
+                                  std::vector<TargetedWrite*>* targetedWrites ) {
+        dassert( _itemRef.getOpType() == BatchedCommandRequest::BatchType_Insert );
+        dassert( !_itemRef.getRequest()->isInsertIndexRequest() );
+
+        ShardEndpoint endpointCopy( endpoint );
+        addTargetedWrites( vector<ShardEndpoint*>( 1, &endpointCopy ), targetedWrites );
+    }
+
+    void WriteOp::addTargetedWrites( const vector<ShardEndpoint*>& endpoints,
+                                     std::vector<TargetedWrite*>* targetedWrites ) {
+
+        for ( vector<ShardEndpoint*>::const_iterator it = endpoints.begin(); it != endpoints.end();
             ++it ) {
 
             ShardEndpoint* endpoint = *it;
@@ -139,7 +155,6 @@ namespace mongo {
         }
 
         _state = WriteOpState_Pending;
-        return Status::OK();
     }
 
     size_t WriteOp::getNumTargeted() {
@@ -129,6 +129,13 @@ namespace mongo {
         Status targetWrites( const NSTargeter& targeter,
                              std::vector<TargetedWrite*>* targetedWrites );
 
+        /**
+         * Creates the TargetedWrite for an insert which was already targeted to 'endpoint', as
+         * part of a batch by NSTargeter::targetInserts.
+         */
+        void targetInsertTo( const ShardEndpoint& endpoint,
+                             std::vector<TargetedWrite*>* targetedWrites );
+
         /**
          * Returns the number of child writes that were last targeted.
          */
@@ -168,6 +175,12 @@ namespace mongo {
 
     private:
 
+        /**
+         * Creates a TargetedWrite for every endpoint and moves to state _Pending.
+         */
+        void addTargetedWrites( const std::vector<ShardEndpoint*>& endpoints,
+                                std::vector<TargetedWrite*>* targetedWrites );
+
         /**
          * Updates the op state after new information is received.
          */
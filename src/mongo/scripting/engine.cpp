@@ -278,7 +278,15 @@ namespace {
         //     returned by JS_CompileFunction.
         ScriptingFunction defaultFunctionNumber = getFunctionCache().size() + 1;
         ScriptingFunction& actualFunctionNumber = _cachedFunctions[code];
-        actualFunctionNumber = _createFunction(code, defaultFunctionNumber);
+        try {
+            actualFunctionNumber = _createFunction(code, defaultFunctionNumber);
+        }
+        catch (...) {
+            // don't leave an entry behind for code which didn't compile, function numbers
+            // have to keep matching the functions the engine compiled
+            _cachedFunctions.erase(code);
+            throw;
+        }
         return actualFunctionNumber;
     }
 
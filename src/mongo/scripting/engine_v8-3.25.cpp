@@ -1069,8 +1069,9 @@ namespace mongo {
 
     void V8Scope::setFunction(const char* field, const char* code) {
         V8_SIMPLE_HEADER
-        getGlobal()->ForceSet(v8StringData(field),
-                          __createFunction(code, getFunctionCache().size() + 1));
+        // install the function this scope compiled for the code before, if any
+        ScriptingFunction func = createFunction(code);
+        getGlobal()->ForceSet(v8StringData(field), _funcs[func - 1].Get(_isolate));
     }
 
     void V8Scope::rename(const char * from, const char * to) {
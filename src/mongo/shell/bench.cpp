@@ -36,13 +36,20 @@
 
 #include <pcrecpp.h>
 
+#include <algorithm>
 #include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
+#include <fstream>
 #include <iostream>
 
+#include "mongo/base/data_view.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/platform/bits.h"
+#include "mongo/platform/random.h"
 #include "mongo/scripting/bson_template_evaluator.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/log.h"
@@ -89,11 +96,54 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        std::fill(_latencyBuckets, _latencyBuckets + kNumBuckets, 0);
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        for (int i = 0; i < kNumBuckets; ++i)
+            _latencyBuckets[i] += other._latencyBuckets[i];
+    }
+
+    int BenchRunEventCounter::bucketFor(long long timeMicros) {
+        if (timeMicros < (1LL << kSubBucketBits))
+            return timeMicros < 0 ? 0 : static_cast<int>(timeMicros);
+
+        // Buckets are indexed by the position of the highest set bit, then by the
+        // kSubBucketBits bits below it.
+        const int shift = 63 - countLeadingZeros64(timeMicros) - kSubBucketBits;
+        const int subBucket = static_cast<int>(timeMicros >> shift) &
+                              ((1 << kSubBucketBits) - 1);
+        return ((shift + 1) << kSubBucketBits) + subBucket;
+    }
+
+    long long BenchRunEventCounter::bucketUpperBoundMicros(int bucket) {
+        if (bucket < (1 << kSubBucketBits))
+            return bucket;
+
+        const int shift = (bucket >> kSubBucketBits) - 1;
+        const long long subBucket = bucket & ((1 << kSubBucketBits) - 1);
+        return (((1LL << kSubBucketBits) + subBucket + 1) << shift) - 1;
+    }
+
+    long long BenchRunEventCounter::getPercentileMicros(double quantile) const {
+        if (_numEvents == 0)
+            return 0;
+
+        // The rank of the event at the requested quantile, counting from 1.
+        unsigned long long rank = static_cast<unsigned long long>(quantile * _numEvents);
+        if (rank < quantile * _numEvents)
+            ++rank;
+        rank = std::max(1ULL, std::min(rank, _numEvents));
+
+        unsigned long long seen = 0;
+        for (int i = 0; i < kNumBuckets; ++i) {
+            seen += _latencyBuckets[i];
+            if (seen >= rank)
+                return bucketUpperBoundMicros(i);
+        }
+        return bucketUpperBoundMicros(kNumBuckets - 1);
     }
 
     BenchRunStats::BenchRunStats() {
@@ -111,6 +161,7 @@ namespace mongo {
         insertCounter.reset();
         deleteCounter.reset();
         queryCounter.reset();
+        commandCounter.reset();
 
         trappedErrors.clear();
     }
@@ -125,6 +176,7 @@ namespace mongo {
         insertCounter.updateFrom(other.insertCounter);
         deleteCounter.updateFrom(other.deleteCounter);
         queryCounter.updateFrom(other.queryCounter);
+        commandCounter.updateFrom(other.commandCounter);
 
         for (size_t i = 0; i < other.trappedErrors.size(); ++i)
             trappedErrors.push_back(other.trappedErrors[i]);
@@ -152,11 +204,106 @@ namespace mongo {
         noWatchPattern.reset();
 
         ops = BSONObj();
+        cumulativeOpWeights.clear();
+        opsPerSecond = 0;
 
         throwGLE = false;
         breakOnTrap = true;
     }
 
+    namespace {
+        /**
+         * Converts the requests in a diagnostic log, as captured by mongod --diagLog, into benchRun
+         * operations, in the order they were received.  Requests benchRun can't reproduce, like
+         * getMores and killCursors on the cursor ids of the original run, are skipped.
+         */
+        BSONObj opsFromDiagLog(const std::string& path) {
+            std::ifstream in(path.c_str(), std::ios::in | std::ios::binary);
+            uassert(28706, str::stream() << "couldn't open diaglog " << path, in.good());
+
+            BSONArrayBuilder ops;
+            long long numRequests = 0;
+            long long numSkipped = 0;
+            char lengthBuf[sizeof(int32_t)];
+            while (in.read(lengthBuf, sizeof(lengthBuf))) {
+                const int32_t length = ConstDataView(lengthBuf).read<LittleEndian<int32_t>>();
+                uassert(28707,
+                        str::stream() << "invalid message length " << length << " in diaglog "
+                                      << path,
+                        length >= static_cast<int32_t>(sizeof(MSGHEADER::Layout)) &&
+                        static_cast<size_t>(length) <= MaxMessageSizeBytes);
+
+                boost::scoped_array<char> buf(new char[length]);
+                memcpy(buf.get(), lengthBuf, sizeof(lengthBuf));
+                uassert(28708, str::stream() << "truncated message in diaglog " << path,
+                        in.read(buf.get() + sizeof(lengthBuf), length - sizeof(lengthBuf)));
+                ++numRequests;
+
+                Message m(buf.get(), false);
+                DbMessage d(m);
+                switch (m.operation()) {
+                case dbQuery: {
+                    QueryMessage q(d);
+                    const NamespaceString nss(q.ns);
+                    if (nss.isCommand()) {
+                        ops.append(BSON("op" << "command"
+                                        << "ns" << nss.db()
+                                        << "command" << q.query
+                                        << "options" << q.queryOptions));
+                    }
+                    else {
+                        ops.append(BSON("op" << "query"
+                                        << "ns" << q.ns
+                                        << "query" << q.query
+                                        << "filter" << q.fields
+                                        << "limit" << q.ntoreturn
+                                        << "skip" << q.ntoskip
+                                        << "options" << q.queryOptions));
+                    }
+                    break;
+                }
+                case dbInsert: {
+                    const std::string ns = d.getns();
+                    while (d.moreJSObjs()) {
+                        ops.append(BSON("op" << "insert" << "ns" << ns << "doc" << d.nextJsObj()));
+                    }
+                    break;
+                }
+                case dbUpdate: {
+                    const std::string ns = d.getns();
+                    const int flags = d.pullInt();
+                    BSONObj query = d.nextJsObj();
+                    BSONObj update = d.nextJsObj();
+                    ops.append(BSON("op" << "update"
+                                    << "ns" << ns
+                                    << "query" << query
+                                    << "update" << update
+                                    << "upsert" << bool(flags & UpdateOption_Upsert)
+                                    << "multi" << bool(flags & UpdateOption_Multi)));
+                    break;
+                }
+                case dbDelete: {
+                    const std::string ns = d.getns();
+                    const int flags = d.pullInt();
+                    BSONObj query = d.nextJsObj();
+                    ops.append(BSON("op" << "delete"
+                                    << "ns" << ns
+                                    << "query" << query
+                                    << "multi" << !(flags & RemoveOption_JustOne)));
+                    break;
+                }
+                default:
+                    ++numSkipped;
+                    break;
+                }
+            }
+
+            log() << "benchRun replaying " << numRequests - numSkipped << " of the "
+                  << numRequests << " requests in diaglog " << path << endl;
+            return ops.obj();
+        }
+    }  // namespace
+
     BenchRunConfig *BenchRunConfig::createFromBson( const BSONObj &args ) {
         BenchRunConfig *config = new BenchRunConfig();
         config->initializeFromBson( args );
@@ -216,7 +363,32 @@ namespace mongo {
             this->noWatchPattern = boost::shared_ptr< pcrecpp::RE >( new pcrecpp::RE( regex, flags2options( flags ) ) );
         }
 
-        this->ops = args["ops"].Obj().getOwned();
+        if ( args["opsPerSecond"].isNumber() )
+            this->opsPerSecond = args["opsPerSecond"].number();
+
+        if ( args["replayDiagLog"].type() == String )
+            this->ops = opsFromDiagLog( args["replayDiagLog"].String() );
+        else
+            this->ops = args["ops"].Obj().getOwned();
+
+        bool weighted = false;
+        double totalWeight = 0;
+        std::vector<double> cumulativeWeights;
+        BSONObjIterator i( this->ops );
+        while ( i.more() ) {
+            BSONElement weight = i.next()["weight"];
+            if ( !weight.eoo() ) {
+                uassert( 28709, "benchRun op weights must be non-negative numbers",
+                         weight.isNumber() && weight.number() >= 0 );
+                weighted = true;
+            }
+            totalWeight += weight.eoo() ? 1 : weight.number();
+            cumulativeWeights.push_back( totalWeight );
+        }
+        if ( weighted ) {
+            uassert( 28710, "benchRun op weights must not all be zero", totalWeight > 0 );
+            this->cumulativeOpWeights.swap( cumulativeWeights );
+        }
     }
 
     DBClientBase *BenchRunConfig::createConnection() const {
@@ -350,13 +522,44 @@ namespace mongo {
             }
         }
 
+        std::vector<BSONElement> ops;
+        _config->ops.elems( ops );
+
+        // Weighted op mixes are drawn from a sequence which is the same on every run.
+        const std::vector<double>& cumulativeWeights = _config->cumulativeOpWeights;
+        PseudoRandom random( static_cast<int64_t>( _id ) );
+
+        // With a target rate, operations are scheduled "scheduleIntervalMicros" apart, starting now.
+        const long long scheduleIntervalMicros = _config->opsPerSecond > 0 ?
+            static_cast<long long>( 1000000.0 * _config->parallel / _config->opsPerSecond ) : 0;
+        long long nextScheduledMicros = timer.micros();
+
         while ( !shouldStop() ) {
-            BSONObjIterator i( _config->ops );
-            while ( i.more() ) {
+            for ( size_t opNum = 0; opNum < ops.size(); ++opNum ) {
 
                 if ( shouldStop() ) break;
 
-                BSONElement e = i.next();
+                long long scheduleLagMicros = 0;
+                if ( scheduleIntervalMicros > 0 ) {
+                    const long long now = timer.micros();
+                    if ( now < nextScheduledMicros )
+                        sleepmicros( nextScheduledMicros - now );
+                    scheduleLagMicros = std::max( 0LL, timer.micros() - nextScheduledMicros );
+                    nextScheduledMicros += scheduleIntervalMicros;
+                }
+
+                size_t opIndex = opNum;
+                if ( !cumulativeWeights.empty() ) {
+                    // A uniformly distributed double in [0, 1), from the top 53 bits.
+                    const double unit = ( static_cast<uint64_t>( random.nextInt64() ) >> 11 ) /
+                                        static_cast<double>( 1ULL << 53 );
+                    opIndex = std::upper_bound( cumulativeWeights.begin(),
+                                                cumulativeWeights.end(),
+                                                unit * cumulativeWeights.back() ) -
+                              cumulativeWeights.begin();
+                }
+
+                BSONElement e = ops[opIndex];
 
                 string ns = e["ns"].String();
                 string op = e["op"].String();
@@ -404,7 +607,7 @@ namespace mongo {
 
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, scheduleLagMicros);
                             result = conn->findOne( ns , fixQuery( e["query"].Obj(),
                                                                    bsonTemplateEvaluator ) );
                         }
@@ -426,8 +629,12 @@ namespace mongo {
                     else if ( op == "command" ) {
 
                         BSONObj result;
-                        conn->runCommand( ns, fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
-                                          result, e["options"].numberInt() );
+                        {
+                            BenchRunEventTrace _bret(&_stats.commandCounter, scheduleLagMicros);
+                            conn->runCommand( ns,
+                                              fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
+                                              result, e["options"].numberInt() );
+                        }
 
                         if( check ){
                             int err = scope->invoke( scopeFunc , 0 , &result,  1000 * 60 , false );
@@ -459,12 +666,12 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, scheduleLagMicros);
                             stdx::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, scheduleLagMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
@@ -500,7 +707,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
+                            BenchRunEventTrace _bret(&_stats.updateCounter, scheduleLagMicros);
                             BSONObj query = fixQuery(queryOrginal, bsonTemplateEvaluator);
                             BSONObj update = fixQuery(updateOriginal, bsonTemplateEvaluator);
 
@@ -552,7 +759,7 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
+                            BenchRunEventTrace _bret(&_stats.insertCounter, scheduleLagMicros);
 
                             BSONObj insertDoc = fixQuery(e["doc"].Obj(), bsonTemplateEvaluator);
 
@@ -601,7 +808,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, scheduleLagMicros);
                             BSONObj predicate = fixQuery(query, bsonTemplateEvaluator);
                             if (useWriteCmd) {
 
@@ -864,6 +1071,15 @@ namespace mongo {
                         static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
      }
 
+     static void appendPercentileMicrosIfAvailable(
+             BSONObjBuilder &buf, const std::string &name, const BenchRunEventCounter &counter) {
+
+         if (counter.getNumEvents() > 0)
+             buf.append(name, BSON("p50" << counter.getPercentileMicros(0.5)
+                                << "p99" << counter.getPercentileMicros(0.99)
+                                << "p999" << counter.getPercentileMicros(0.999)));
+     }
+
      BSONObj BenchRunner::finish( BenchRunner* runner ) {
 
          runner->stop();
@@ -890,6 +1106,19 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "deleteLatencyAverageMicros", stats.deleteCounter);
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
+         appendAverageMicrosIfAvailable(buf, "commandLatencyAverageMicros", stats.commandCounter);
+         appendPercentileMicrosIfAvailable(buf, "findOneLatencyPercentilesMicros",
+                                           stats.findOneCounter);
+         appendPercentileMicrosIfAvailable(buf, "insertLatencyPercentilesMicros",
+                                           stats.insertCounter);
+         appendPercentileMicrosIfAvailable(buf, "deleteLatencyPercentilesMicros",
+                                           stats.deleteCounter);
+         appendPercentileMicrosIfAvailable(buf, "updateLatencyPercentilesMicros",
+                                           stats.updateCounter);
+         appendPercentileMicrosIfAvailable(buf, "queryLatencyPercentilesMicros",
+                                           stats.queryCounter);
+         appendPercentileMicrosIfAvailable(buf, "commandLatencyPercentilesMicros",
+                                           stats.commandCounter);
 
          {
              BSONObjIterator i( after );
@@ -29,6 +29,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
@@ -118,12 +119,34 @@ namespace mongo {
          * Every thread in a benchRun job will perform these operations in sequence, restarting at
          * the beginning when the end is reached, until the job is stopped.
          *
+         * When "replayDiagLog" names a diagnostic log captured with mongod --diagLog (the format
+         * mongosniff --diaglog reads), the operations are the requests captured in it instead.
+         *
          * TODO: Document the operation objects.
          *
          * TODO: Introduce support for performing each operation exactly N times.
          */
         BSONObj ops;
 
+        /**
+         * Cumulative weights of the operations in "ops", in order, if any operation has a
+         * "weight" field.  In that case, every thread picks each operation at random, with a
+         * probability proportional to its weight (1 if it has none), instead of performing the
+         * operations in sequence.  Empty otherwise.
+         */
+        std::vector<double> cumulativeOpWeights;
+
+        /**
+         * Target rate, in operations per second across all threads, at which to start operations.
+         *
+         * When positive, each thread starts operations on a fixed schedule rather than as soon as
+         * the previous one completes, and the latency of an operation which starts late, because
+         * earlier operations took too long, includes the time it spent waiting to start.  This
+         * keeps a slow server from hiding its own latency by slowing down the load.  When zero,
+         * each thread starts operations back to back.
+         */
+        double opsPerSecond;
+
         bool throwGLE;
         bool breakOnTrap;
 
@@ -159,6 +182,7 @@ namespace mongo {
         void countOne(long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            ++_latencyBuckets[bucketFor(timeMicros)];
         }
 
         /**
@@ -171,9 +195,27 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Get the latency, in microseconds, under which the fraction "quantile" of the observed
+         * events completed, e.g. 0.99 for the 99th percentile.  The result is rounded up to the
+         * histogram bucket holding that event, so it overestimates by at most 1/16th.
+         *
+         * Returns 0 if no events were observed.
+         */
+        long long getPercentileMicros(double quantile) const;
+
     private:
+        // Latencies below 2^kSubBucketBits microseconds each have their own bucket, and every
+        // larger power of two range of latencies is split into 2^kSubBucketBits buckets.
+        static const int kSubBucketBits = 4;
+        static const int kNumBuckets = (64 - kSubBucketBits + 1) << kSubBucketBits;
+
+        static int bucketFor(long long timeMicros);
+        static long long bucketUpperBoundMicros(int bucket);
+
         unsigned long long _numEvents;
         long long _totalTimeMicros;
+        unsigned long long _latencyBuckets[kNumBuckets];
     };
 
     /**
@@ -188,21 +230,28 @@ namespace mongo {
      * event, and otherwise, the succes counter will.
      *
      * In all cases, the counter objects must outlive the trace object.
+     *
+     * "scheduleLagMicros" is how late the event started relative to when it was scheduled to, and
+     * is counted as part of its duration.
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter,
+                                    long long scheduleLagMicros=0) {
             initialize(eventCounter, eventCounter, false);
+            _scheduleLagMicros = scheduleLagMicros;
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
                            BenchRunEventCounter *failCounter,
                            bool defaultToFailure=true) {
             initialize(successCounter, failCounter, defaultToFailure);
+            _scheduleLagMicros = 0;
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(_scheduleLagMicros +
+                                                                    _timer.micros());
         }
 
         void succeed() { _succeeded = true; }
@@ -221,6 +270,7 @@ namespace mongo {
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
+        long long _scheduleLagMicros;
     };
 
     /**
@@ -243,6 +293,7 @@ namespace mongo {
         BenchRunEventCounter insertCounter;
         BenchRunEventCounter deleteCounter;
         BenchRunEventCounter queryCounter;
+        BenchRunEventCounter commandCounter;
 
         std::map<std::string, long long> opcounters;
         std::vector<BSONObj> trappedErrors;
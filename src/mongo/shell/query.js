@@ -41,6 +41,7 @@ DBQuery.prototype.help = function () {
     print("\t.max(idxDoc)")
     print("\t.comment(comment)")
     print("\t.snapshot()")
+    print("\t.allowDiskUse() - lets a blocking sort write temporary files instead of failing")
     print("\t.readPref(mode, tagset)")
     
     print("\nCursor methods");
@@ -82,8 +83,8 @@ DBQuery.prototype._canUseFindCommand = function() {
     // Since runCommand() is implemented by running a findOne() against the $cmd collection, we have
     // to make sure that we don't try to run a find command against the $cmd collection.
     //
-    // We also forbid queries with the exhaust option from running as find commands, because the
-    // find command does not support exhaust.
+    // We also run queries with the exhaust option as legacy queries. mongod streams the replies of
+    // an exhaust find command, but mongos only supports exhaust on legacy queries.
     return (this._collection.getName().indexOf("$cmd") !== 0)
         && (this._options & DBQuery.Option.exhaust) === 0;
 }
@@ -195,6 +196,10 @@ DBQuery.prototype._convertToCommand = function() {
         cmd["snapshot"] = this._query.$snapshot;
     }
 
+    if (this._query.$allowDiskUse) {
+        cmd["allowDiskUse"] = this._query.$allowDiskUse;
+    }
+
     if ((this._options & DBQuery.Option.tailable) != 0) {
         cmd["tailable"] = true;
     }
@@ -455,6 +460,10 @@ DBQuery.prototype.snapshot = function(){
     return this._addSpecial( "$snapshot" , true );
 }
 
+DBQuery.prototype.allowDiskUse = function(){
+    return this._addSpecial( "$allowDiskUse" , true );
+}
+
 DBQuery.prototype.pretty = function(){
     this._prettyShell = true;
     return this;
@@ -34,3 +34,18 @@ ReplSetBridge.prototype.setDelay = function (delay) {
     this.delay = delay || 0;
     this.start();
 };
+
+/**
+ * Changes how the running bridge shapes traffic, without restarting it. 'shaping' may hold
+ * 'requests' and 'replies', each of which may hold 'delay' and 'jitter' in milliseconds and
+ * 'bytesPerSec'. Returns the shaping now in effect.
+ */
+ReplSetBridge.prototype.configure = function(shaping) {
+    var cmd = Object.extend({configureBridge: 1}, shaping);
+    var res = new Mongo(this.host).getDB("admin").runCommand(cmd);
+    assert.commandWorked(res, "configureBridge failed: " + tojson(cmd));
+    if (res.requests) {
+        this.delay = res.requests.delay;
+    }
+    return res;
+};
@@ -37,6 +37,8 @@
 #include "mongo/base/initializer.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/namespace_string.h"
+#include "mongo/platform/random.h"
 #include "mongo/tools/mongobridge_options.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
@@ -44,6 +46,7 @@
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/quick_exit.h"
 #include "mongo/util/text.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 using namespace mongo;
@@ -51,6 +54,151 @@ using namespace std;
 
 void cleanup( int sig );
 
+namespace {
+
+    // Guards mongoBridgeGlobalParams.requests and .replies, which the configureBridge command can
+    // change while Forwarders read them.
+    boost::mutex shapingMutex;
+
+    BridgeShaping currentShaping(const BridgeShaping& shaping) {
+        boost::lock_guard<boost::mutex> lk(shapingMutex);
+        return shaping;
+    }
+
+    /**
+     * Sleeps for as long as 'shaping' holds back a message of 'size' bytes.
+     */
+    void holdMessage(const BridgeShaping& shaping, int size, PseudoRandom& rand) {
+        long long micros = shaping.delayMillis * 1000LL;
+        if (shaping.jitterMillis > 0) {
+            const uint32_t jitter = static_cast<uint32_t>(rand.nextInt32());
+            micros += (jitter % (shaping.jitterMillis + 1)) * 1000LL;
+        }
+        if (shaping.bytesPerSec > 0) {
+            micros += size * 1000LL * 1000 / shaping.bytesPerSec;
+        }
+        if (micros > 0) {
+            sleepmicros(micros);
+        }
+    }
+
+    BSONObj shapingToBSON(const BridgeShaping& shaping) {
+        return BSON("delay" << shaping.delayMillis
+                    << "jitter" << shaping.jitterMillis
+                    << "bytesPerSec" << shaping.bytesPerSec);
+    }
+
+    /**
+     * Updates 'shaping' from the fields present in 'spec', leaving the others as they are.
+     */
+    Status updateShaping(const BSONElement& spec, BridgeShaping* shaping) {
+        if (spec.type() != Object) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << "'" << spec.fieldName() << "' must be an object");
+        }
+
+        BridgeShaping updated = *shaping;
+        BSONForEach(elem, spec.Obj()) {
+            const StringData name = elem.fieldNameStringData();
+            if (!elem.isNumber()) {
+                return Status(ErrorCodes::TypeMismatch,
+                              str::stream() << "'" << name << "' must be a number");
+            }
+            if (elem.numberLong() < 0) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "'" << name << "' can't be negative");
+            }
+
+            if (name == "delay") {
+                updated.delayMillis = elem.numberInt();
+            }
+            else if (name == "jitter") {
+                updated.jitterMillis = elem.numberInt();
+            }
+            else if (name == "bytesPerSec") {
+                updated.bytesPerSec = elem.numberLong();
+            }
+            else {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "unknown field '" << name << "' in '"
+                                            << spec.fieldName() << "'");
+            }
+        }
+
+        *shaping = updated;
+        return Status::OK();
+    }
+
+    /**
+     * Runs {configureBridge: 1, requests: {delay: <ms>, jitter: <ms>, bytesPerSec: <n>},
+     * replies: {...}}, which changes the shaping of each direction for all connections through
+     * the bridge. Fields left out keep their current values, and the reply holds the shaping now
+     * in effect.
+     */
+    BSONObj runConfigureBridge(const BSONObj& cmdObj) {
+        BSONObjBuilder result;
+        boost::lock_guard<boost::mutex> lk(shapingMutex);
+
+        BridgeShaping requests = mongoBridgeGlobalParams.requests;
+        BridgeShaping replies = mongoBridgeGlobalParams.replies;
+        Status status = Status::OK();
+        BSONForEach(elem, cmdObj) {
+            const StringData name = elem.fieldNameStringData();
+            if (name == "configureBridge") {
+                continue;
+            }
+            else if (name == "requests") {
+                status = updateShaping(elem, &requests);
+            }
+            else if (name == "replies") {
+                status = updateShaping(elem, &replies);
+            }
+            else {
+                status = Status(ErrorCodes::BadValue,
+                                str::stream() << "unknown field '" << name << "'");
+            }
+
+            if (!status.isOK()) {
+                result.append("ok", 0.0);
+                result.append("errmsg", status.reason());
+                result.append("code", status.code());
+                return result.obj();
+            }
+        }
+
+        mongoBridgeGlobalParams.requests = requests;
+        mongoBridgeGlobalParams.replies = replies;
+        log() << "bridge shaping is now requests: " << shapingToBSON(requests)
+              << ", replies: " << shapingToBSON(replies);
+
+        result.append("ok", 1.0);
+        result.append("requests", shapingToBSON(requests));
+        result.append("replies", shapingToBSON(replies));
+        return result.obj();
+    }
+
+    /**
+     * Returns true and sets 'cmdObj' if 'm' is a configureBridge command, which the bridge
+     * answers itself instead of forwarding.
+     */
+    bool isConfigureBridge(Message& m, BSONObj* cmdObj) {
+        if (m.operation() != dbQuery) {
+            return false;
+        }
+
+        DbMessage d(m);
+        QueryMessage q(d);
+        if (!NamespaceString(q.ns).isCommand() ||
+                q.query.firstElementFieldName() != StringData("configureBridge")) {
+            return false;
+        }
+
+        *cmdObj = q.query.getOwned();
+        return true;
+    }
+
+} // namespace
+
 class Forwarder {
 public:
     Forwarder( MessagingPort &mp ) : mp_( mp ) {
@@ -75,6 +223,7 @@ public:
             sleepmillis(500);
         }
 
+        PseudoRandom rand(static_cast<int64_t>(curTimeMicros64()));
         Message m;
         while( 1 ) {
             try {
@@ -84,7 +233,14 @@ public:
                     mp_.shutdown();
                     break;
                 }
-                sleepmillis(mongoBridgeGlobalParams.delay);
+
+                BSONObj cmdObj;
+                if ( isConfigureBridge( m, &cmdObj ) ) {
+                    replyToQuery( 0, &mp_, m, runConfigureBridge( cmdObj ) );
+                    continue;
+                }
+
+                holdMessage(currentShaping(mongoBridgeGlobalParams.requests), m.size(), rand);
 
                 int oldId = m.header().getId();
                 if ( m.operation() == dbQuery || m.operation() == dbMsg || m.operation() == dbGetMore ) {
@@ -100,6 +256,9 @@ public:
                     // nothing to reply with?
                     if ( response.empty() ) cleanup(0);
 
+                    holdMessage(currentShaping(mongoBridgeGlobalParams.replies),
+                                response.size(),
+                                rand);
                     mp_.reply( m, response, oldId );
                     while ( exhaust ) {
                         MsgData::View header = response.header();
@@ -107,6 +266,9 @@ public:
                         if ( qr.getCursorId() ) {
                             response.reset();
                             dest.port().recv( response );
+                            holdMessage(currentShaping(mongoBridgeGlobalParams.replies),
+                                        response.size(),
+                                        rand);
                             mp_.reply( m, response ); // m argument is ignored anyway
                         }
                         else {
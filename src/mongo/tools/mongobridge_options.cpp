@@ -53,11 +53,39 @@ namespace mongo {
                                   .setDefault(moe::Value(0));
 
 
+        options->addOptionChaining("jitter", "jitter", moe::Int,
+                "random extra transfer delay of up to this many milliseconds (default = 0)")
+                                  .setDefault(moe::Value(0));
+
+
+        options->addOptionChaining("bytesPerSec", "bytesPerSec", moe::Long,
+                "bandwidth limit in bytes per second (default = 0, unlimited)")
+                                  .setDefault(moe::Value(0L));
+
+
+        options->addOptionChaining("replyDelay", "replyDelay", moe::Int,
+                "transfer delay of replies in milliseconds (default = 0)")
+                                  .setDefault(moe::Value(0));
+
+
+        options->addOptionChaining("replyJitter", "replyJitter", moe::Int,
+                "random extra transfer delay of replies of up to this many milliseconds "
+                "(default = 0)")
+                                  .setDefault(moe::Value(0));
+
+
+        options->addOptionChaining("replyBytesPerSec", "replyBytesPerSec", moe::Long,
+                "bandwidth limit for replies in bytes per second (default = 0, unlimited)")
+                                  .setDefault(moe::Value(0L));
+
+
         return Status::OK();
     }
 
     void printMongoBridgeHelp(std::ostream* out) {
-        *out << "Usage: mongobridge --port <port> --dest <dest> [ --delay <ms> ] [ --help ]"
+        *out << "Usage: mongobridge --port <port> --dest <dest> [ --delay <ms> ] [ --jitter <ms> ]"
+             << " [ --bytesPerSec <n> ] [ --replyDelay <ms> ] [ --replyJitter <ms> ]"
+             << " [ --replyBytesPerSec <n> ] [ --help ]"
              << std::endl;
         *out << moe::startupOptions.helpString();
         *out << std::flush;
@@ -86,7 +114,38 @@ namespace mongo {
         mongoBridgeGlobalParams.destUri = params["dest"].as<std::string>();
 
         if (params.count("delay")) {
-            mongoBridgeGlobalParams.delay = params["delay"].as<int>();
+            mongoBridgeGlobalParams.requests.delayMillis = params["delay"].as<int>();
+        }
+
+        if (params.count("jitter")) {
+            mongoBridgeGlobalParams.requests.jitterMillis = params["jitter"].as<int>();
+        }
+
+        if (params.count("bytesPerSec")) {
+            mongoBridgeGlobalParams.requests.bytesPerSec = params["bytesPerSec"].as<long>();
+        }
+
+        if (params.count("replyDelay")) {
+            mongoBridgeGlobalParams.replies.delayMillis = params["replyDelay"].as<int>();
+        }
+
+        if (params.count("replyJitter")) {
+            mongoBridgeGlobalParams.replies.jitterMillis = params["replyJitter"].as<int>();
+        }
+
+        if (params.count("replyBytesPerSec")) {
+            mongoBridgeGlobalParams.replies.bytesPerSec =
+                params["replyBytesPerSec"].as<long>();
+        }
+
+        const BridgeShaping* shapings[] = {&mongoBridgeGlobalParams.requests,
+                                           &mongoBridgeGlobalParams.replies};
+        for (size_t i = 0; i < 2; i++) {
+            if (shapings[i]->delayMillis < 0 || shapings[i]->jitterMillis < 0 ||
+                    shapings[i]->bytesPerSec < 0) {
+                return Status(ErrorCodes::BadValue,
+                              "Delays, jitter and bandwidth limits can't be negative");
+            }
         }
 
         return Status::OK();
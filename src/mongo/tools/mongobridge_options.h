@@ -43,13 +43,30 @@ namespace mongo {
 
     namespace moe = mongo::optionenvironment;
 
+    /**
+     * How the bridge shapes the messages it forwards in one direction. Each message is held back
+     * for delayMillis, plus a random extra of up to jitterMillis, plus the time it would take to
+     * send at bytesPerSec if that is non-zero.
+     */
+    struct BridgeShaping {
+        int delayMillis;
+        int jitterMillis;
+        long long bytesPerSec; // 0 means unlimited
+
+        BridgeShaping() : delayMillis(0), jitterMillis(0), bytesPerSec(0) {}
+    };
+
     struct MongoBridgeGlobalParams {
         int port;
-        int delay;
         int connectTimeoutSec;
         std::string destUri;
 
-        MongoBridgeGlobalParams() : port(0), delay(0), connectTimeoutSec(15) {}
+        // Initial shaping of messages from the client to the server, and of replies back. Both
+        // can be changed while the bridge is running with the configureBridge command.
+        BridgeShaping requests;
+        BridgeShaping replies;
+
+        MongoBridgeGlobalParams() : port(0), connectTimeoutSec(15) {}
     };
 
     extern MongoBridgeGlobalParams mongoBridgeGlobalParams;
@@ -0,0 +1,97 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/coarse_clock.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+    AtomicUInt32 started;
+    AtomicUInt32 running;
+    AtomicInt64 elapsedMillisSample;
+    AtomicUInt64 nowSample;
+
+    const Timer& sinceStartup() {
+        static const Timer timer;
+        return timer;
+    }
+
+    long long readElapsedMillis() {
+        return sinceStartup().micros() / 1000;
+    }
+
+    void updateSamples() {
+        elapsedMillisSample.store(readElapsedMillis());
+        nowSample.store(jsTime());
+    }
+
+    void updaterThread() {
+        setThreadName("coarseClock");
+        while (true) {
+            sleepmillis(1);
+            updateSamples();
+        }
+    }
+
+}  // namespace
+
+    void CoarseClock::start() {
+        if (started.swap(1)) {
+            return;
+        }
+
+        updateSamples();
+        running.store(1);
+        // The thread runs until the process exits.
+        boost::thread(stdx::bind(&updaterThread)).detach();
+    }
+
+    long long CoarseClock::elapsedMillis() {
+        if (!running.loadRelaxed()) {
+            return readElapsedMillis();
+        }
+        return elapsedMillisSample.loadRelaxed();
+    }
+
+    Date_t CoarseClock::now() {
+        if (!running.loadRelaxed()) {
+            return jsTime();
+        }
+        return nowSample.loadRelaxed();
+    }
+
+}  // namespace mongo
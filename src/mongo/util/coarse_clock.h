@@ -0,0 +1,66 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    /**
+     * A clock with millisecond granularity which is read without a system call.
+     *
+     * Once start() has been called, a background thread samples the system clocks every
+     * millisecond and readers get the latest sample.  That suits code which checks the time on
+     * every operation or every document but can tolerate being a tick late, such as yield and
+     * time limit checks.  For timing spans of code, use Timer, or CycleClock for very short
+     * spans.
+     *
+     * Until start() is called, or in processes which never call it, each read falls back to the
+     * system clock.
+     */
+    class CoarseClock {
+    public:
+        /**
+         * Starts the thread which updates the clock.  Safe to call more than once.
+         */
+        static void start();
+
+        /**
+         * Milliseconds elapsed on a monotonic clock since an arbitrary point early in the life
+         * of the process.
+         */
+        static long long elapsedMillis();
+
+        /**
+         * The current wall clock time.
+         */
+        static Date_t now();
+    };
+
+}  // namespace mongo
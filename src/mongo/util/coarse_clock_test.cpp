@@ -0,0 +1,63 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/coarse_clock.h"
+
+#include <cstdlib>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+    TEST(CoarseClock, FollowsSystemClockBeforeStart) {
+        const unsigned long long before = jsTime();
+        const unsigned long long now = CoarseClock::now();
+        ASSERT_LESS_THAN_OR_EQUALS(before, now);
+        ASSERT_LESS_THAN_OR_EQUALS(now, static_cast<unsigned long long>(jsTime()));
+    }
+
+    TEST(CoarseClock, AdvancesOnceStarted) {
+        CoarseClock::start();
+        CoarseClock::start();
+
+        const long long elapsed = CoarseClock::elapsedMillis();
+        sleepmillis(50);
+        ASSERT_GREATER_THAN(CoarseClock::elapsedMillis(), elapsed);
+
+        // Allow for the updater thread being descheduled for a while on a loaded machine.
+        const long long skew = static_cast<long long>(jsTime()) -
+                               static_cast<long long>(CoarseClock::now());
+        ASSERT_LESS_THAN(std::abs(skew), 1000);
+    }
+
+}  // namespace
+}  // namespace mongo
@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/fair_ticket_queue.h"
+
+#include <algorithm>
+#include <boost/thread/locks.hpp>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    namespace {
+        // How long a queued request sleeps before it looks for free tickets itself, in case
+        // some were added without dispatch() being called.
+        const int kRecheckMillis = 100;
+    }
+
+    struct FairTicketQueue::Waiter {
+        explicit Waiter(double start) : start(start), granted(false) { }
+
+        const double start;
+        bool granted;
+        boost::condition_variable cv;
+    };
+
+    FairTicketQueue::FairTicketQueue(TicketHolder* holder)
+        : _holder(holder),
+          _virtualTime(0) { }
+
+    long long FairTicketQueue::waitForTicket(const std::string& group, double weight) {
+        invariant(weight > 0);
+
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        if (_waiters.empty() && _holder->tryAcquire()) {
+            return 0;
+        }
+
+        Timer timer;
+        double& lastFinish = _lastFinish[group];
+        Waiter waiter(std::max(_virtualTime, lastFinish));
+        lastFinish = waiter.start + 1 / weight;
+        _waiters.insert(std::make_pair(lastFinish, &waiter));
+        _queued.fetchAndAdd(1);
+
+        GroupStats& stats = _stats[group];
+        stats.queued++;
+
+        // A ticket released before _queued was raised wasn't passed on, so look for it here.
+        _dispatchInLock();
+        while (!waiter.granted) {
+            const bool timedOut = !waiter.cv.timed_wait(
+                    lk, boost::posix_time::milliseconds(kRecheckMillis));
+            if (timedOut) {
+                _dispatchInLock();
+            }
+        }
+
+        const long long waitMicros = timer.micros();
+        stats.queued--;
+        stats.waits++;
+        stats.totalWaitMicros += waitMicros;
+        stats.maxWaitMicros = std::max(stats.maxWaitMicros, waitMicros);
+        return waitMicros;
+    }
+
+    void FairTicketQueue::release() {
+        _holder->release();
+        dispatch();
+    }
+
+    void FairTicketQueue::dispatch() {
+        if (_queued.load() == 0) {
+            return;
+        }
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _dispatchInLock();
+    }
+
+    int FairTicketQueue::queued() const {
+        return _queued.load();
+    }
+
+    void FairTicketQueue::getStats(GroupStatsMap* out) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        *out = _stats;
+    }
+
+    void FairTicketQueue::_dispatchInLock() {
+        while (!_waiters.empty() && _holder->tryAcquire()) {
+            WaiterMap::iterator first = _waiters.begin();
+            Waiter* waiter = first->second;
+            _waiters.erase(first);
+            _queued.subtractAndFetch(1);
+
+            _virtualTime = std::max(_virtualTime, waiter->start);
+            waiter->granted = true;
+            waiter->cv.notify_one();
+        }
+    }
+
+} // namespace mongo
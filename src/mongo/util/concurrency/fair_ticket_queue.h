@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class TicketHolder;
+
+    /**
+     * Hands out the tickets of a TicketHolder to groups of requests, such as the operations on
+     * one database, by weighted fair queuing.
+     *
+     * A ticket that is free when nobody is queued is taken at once. Otherwise the request
+     * queues behind a virtual finish time, which advances by 1 / weight with each request its
+     * group queues, and the request with the earliest finish time gets the next ticket. A group
+     * of weight 4 therefore gets four times the tickets of a group of weight 1 while both are
+     * queued, but a group with nothing queued builds up no credit.
+     *
+     * Tickets given back to the TicketHolder other than by release() reach queued requests once
+     * dispatch() is called.
+     */
+    class FairTicketQueue {
+        MONGO_DISALLOW_COPYING(FairTicketQueue);
+    public:
+        /**
+         * The queueing of one group since the queue was created.
+         */
+        struct GroupStats {
+            GroupStats() : waits(0), totalWaitMicros(0), maxWaitMicros(0), queued(0) { }
+
+            // Requests that had to queue, and the time they spent queued.
+            long long waits;
+            long long totalWaitMicros;
+            long long maxWaitMicros;
+
+            // Requests queued right now.
+            int queued;
+        };
+
+        typedef std::map<std::string, GroupStats> GroupStatsMap;
+
+        explicit FairTicketQueue(TicketHolder* holder);
+
+        /**
+         * Takes a ticket for a request of 'group', whose share of the tickets is proportional
+         * to 'weight', which must be positive. Returns the microseconds spent queued.
+         */
+        long long waitForTicket(const std::string& group, double weight);
+
+        /**
+         * Gives back a ticket taken with waitForTicket(), passing it on to the next request in
+         * line, if any.
+         */
+        void release();
+
+        /**
+         * Hands out tickets that became free without going through release(), for instance by
+         * resizing the TicketHolder or by releasing it directly. Cheap when nothing is queued.
+         */
+        void dispatch();
+
+        /**
+         * The number of requests queued right now.
+         */
+        int queued() const;
+
+        void getStats(GroupStatsMap* out) const;
+
+    private:
+        struct Waiter;
+
+        typedef std::multimap<double, Waiter*> WaiterMap;
+
+        /**
+         * Hands the free tickets to the requests with the earliest finish times.
+         */
+        void _dispatchInLock();
+
+        TicketHolder* const _holder;
+
+        // Read without the mutex to skip dispatching when nothing is queued.
+        AtomicInt32 _queued;
+
+        mutable boost::mutex _mutex;
+
+        // The start time of the request given a ticket last.
+        double _virtualTime;
+
+        WaiterMap _waiters;
+
+        // The finish time of the last request each group queued, and its stats.
+        std::map<std::string, double> _lastFinish;
+        GroupStatsMap _stats;
+    };
+
+} // namespace mongo
@@ -0,0 +1,209 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/fair_ticket_queue.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using mongo::FairTicketQueue;
+    using mongo::OwnedPointerVector;
+    using mongo::TicketHolder;
+    using std::string;
+    using std::vector;
+
+    /**
+     * Queues requests for the single ticket of a TicketHolder, and records the order in which
+     * their groups are given it.
+     */
+    class QueueFixture {
+    public:
+        QueueFixture() : _holder(1), _queue(&_holder) {
+            // Hold the only ticket until all the requests are queued.
+            ASSERT_EQUALS(0, _queue.waitForTicket("main", 1));
+        }
+
+        void add(const string& group, double weight) {
+            const int queued = _queue.queued();
+            _threads.push_back(new boost::thread(
+                    boost::bind(&QueueFixture::_run, this, group, weight)));
+            // Wait for the request to queue, so that the order of queueing is known.
+            while (_queue.queued() == queued) {
+                mongo::sleepmillis(1);
+            }
+        }
+
+        vector<string> run() {
+            _queue.release();
+            for (size_t i = 0; i < _threads.size(); i++) {
+                _threads[i]->join();
+            }
+            ASSERT_EQUALS(0, _queue.queued());
+            ASSERT_EQUALS(1, _holder.available());
+            return _order;
+        }
+
+        FairTicketQueue& queue() { return _queue; }
+
+    private:
+        void _run(const string& group, double weight) {
+            _queue.waitForTicket(group, weight);
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _order.push_back(group);
+            }
+            _queue.release();
+        }
+
+        TicketHolder _holder;
+        FairTicketQueue _queue;
+        OwnedPointerVector<boost::thread> _threads;
+
+        boost::mutex _mutex;
+        vector<string> _order;
+    };
+
+    TEST(FairTicketQueue, TakesFreeTicketAtOnce) {
+        TicketHolder holder(2);
+        FairTicketQueue queue(&holder);
+        ASSERT_EQUALS(0, queue.waitForTicket("a", 1));
+        ASSERT_EQUALS(0, queue.waitForTicket("b", 1));
+        ASSERT_EQUALS(0, holder.available());
+        queue.release();
+        queue.release();
+        ASSERT_EQUALS(2, holder.available());
+
+        FairTicketQueue::GroupStatsMap stats;
+        queue.getStats(&stats);
+        ASSERT(stats.empty());
+    }
+
+    TEST(FairTicketQueue, BreaksTiesInQueueOrder) {
+        QueueFixture fixture;
+        fixture.add("1", 1);
+        fixture.add("2", 1);
+        fixture.add("3", 1);
+
+        // All three requests have the same finish time.
+        vector<string> order = fixture.run();
+        ASSERT_EQUALS(3U, order.size());
+        ASSERT_EQUALS("1", order[0]);
+        ASSERT_EQUALS("2", order[1]);
+        ASSERT_EQUALS("3", order[2]);
+    }
+
+    TEST(FairTicketQueue, AlternatesBetweenGroupsOfEqualWeight) {
+        QueueFixture fixture;
+        fixture.add("a", 1);
+        fixture.add("a", 1);
+        fixture.add("a", 1);
+        fixture.add("b", 1);
+        fixture.add("b", 1);
+
+        vector<string> order = fixture.run();
+        ASSERT_EQUALS(5U, order.size());
+        ASSERT_EQUALS("a", order[0]);
+        ASSERT_EQUALS("b", order[1]);
+        ASSERT_EQUALS("a", order[2]);
+        ASSERT_EQUALS("b", order[3]);
+        ASSERT_EQUALS("a", order[4]);
+    }
+
+    TEST(FairTicketQueue, HeavierGroupGetsMoreTickets) {
+        QueueFixture fixture;
+        for (int i = 0; i < 4; i++) {
+            fixture.add("light", 1);
+        }
+        for (int i = 0; i < 4; i++) {
+            fixture.add("heavy", 3);
+        }
+
+        // Finish times are 1, 2, 3, 4 for the light group and 1/3, 2/3, 1, 4/3 for the heavy
+        // one, which queued later and so loses the tie at 1.
+        vector<string> order = fixture.run();
+        ASSERT_EQUALS(8U, order.size());
+        const char* expected[] = {"heavy", "heavy", "light", "heavy", "heavy",
+                                  "light", "light", "light"};
+        for (size_t i = 0; i < order.size(); i++) {
+            ASSERT_EQUALS(expected[i], order[i]);
+        }
+    }
+
+    TEST(FairTicketQueue, RecordsWaitsPerGroup) {
+        QueueFixture fixture;
+        fixture.add("a", 1);
+        fixture.add("a", 1);
+        fixture.add("b", 1);
+
+        FairTicketQueue::GroupStatsMap stats;
+        fixture.queue().getStats(&stats);
+        ASSERT_EQUALS(2U, stats.size());
+        ASSERT_EQUALS(2, stats["a"].queued);
+        ASSERT_EQUALS(0, stats["a"].waits);
+        ASSERT_EQUALS(1, stats["b"].queued);
+
+        fixture.run();
+        fixture.queue().getStats(&stats);
+        ASSERT_EQUALS(0, stats["a"].queued);
+        ASSERT_EQUALS(2, stats["a"].waits);
+        ASSERT_EQUALS(1, stats["b"].waits);
+        ASSERT_GREATER_THAN_OR_EQUALS(stats["a"].totalWaitMicros, stats["a"].maxWaitMicros);
+        ASSERT_EQUALS(0U, stats.count("main"));
+    }
+
+    TEST(FairTicketQueue, DispatchHandsOutAddedTickets) {
+        TicketHolder holder(1);
+        FairTicketQueue queue(&holder);
+        ASSERT_EQUALS(0, queue.waitForTicket("a", 1));
+
+        boost::thread waiter(boost::bind(&FairTicketQueue::waitForTicket, &queue, "b", 1.0));
+        while (queue.queued() == 0) {
+            mongo::sleepmillis(1);
+        }
+
+        // A ticket given back to the holder directly is found by dispatch().
+        holder.release();
+        queue.dispatch();
+        waiter.join();
+        ASSERT_EQUALS(0, queue.queued());
+        queue.release();
+        ASSERT_EQUALS(1, holder.available());
+    }
+
+}  // namespace
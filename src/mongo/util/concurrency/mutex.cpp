@@ -34,4 +34,26 @@ namespace mongo {
 
     bool StaticObserver::_destroyingStatics = false;
 
+#if defined(_WIN32)
+    void SimpleMutex::_lockSampled() {
+        const void* const site = MONGO_CALLER_ADDRESS();
+        if ( !TryEnterCriticalSection( &_cs ) ) {
+            MutexContention::SampledWait wait(
+                _name, reinterpret_cast<const void*>(_holderSite.loadRelaxed()));
+            EnterCriticalSection( &_cs );
+        }
+        _holderSite.store(reinterpret_cast<uintptr_t>(site));
+    }
+#else
+    void SimpleMutex::_lockSampled() {
+        const void* const site = MONGO_CALLER_ADDRESS();
+        if ( pthread_mutex_trylock(&_lock) != 0 ) {
+            MutexContention::SampledWait wait(
+                _name, reinterpret_cast<const void*>(_holderSite.loadRelaxed()));
+            verify( pthread_mutex_lock(&_lock) == 0 );
+        }
+        _holderSite.store(reinterpret_cast<uintptr_t>(site));
+    }
+#endif
+
 } // namespace mongo
@@ -38,7 +38,9 @@
 #include <boost/thread/xtime.hpp>
 
 #include "mongo/bson/inline_decls.h"
+#include "mongo/platform/compiler.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/mutex_stats.h"
 #include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/time_support.h"
 
@@ -80,18 +82,26 @@ namespace mongo {
           special functionality (such as try and try timeout).  Thus it can be 
           implemented using OS-specific facilities in all environments (if desired).
         On Windows, the implementation below is faster than boost mutex.
+        While MutexContention sampling is on, its waits are charged to its name, which must
+        outlive it.
     */
 #if defined(_WIN32)
     class SimpleMutex : boost::noncopyable {
     public:
-        SimpleMutex( StringData ) { InitializeCriticalSection( &_cs ); }
+        SimpleMutex( StringData name ) : _name(name) { InitializeCriticalSection( &_cs ); }
         ~SimpleMutex() {
             if ( ! StaticObserver::_destroyingStatics ) {
                 DeleteCriticalSection(&_cs);
             }
         }
         void dassertLocked() const { }
-        void lock() { EnterCriticalSection( &_cs ); }
+        void lock() {
+            if ( MONGO_unlikely( MutexContention::isSampling() ) ) {
+                _lockSampled();
+                return;
+            }
+            EnterCriticalSection( &_cs );
+        }
         void unlock() { LeaveCriticalSection( &_cs ); }
         class scoped_lock {
             SimpleMutex& _m;
@@ -102,20 +112,30 @@ namespace mongo {
         };
 
     private:
+        NOINLINE_DECL void _lockSampled();
+
         CRITICAL_SECTION _cs;
+        const StringData _name;
+        AtomicUInt64 _holderSite; // the last call site to lock, noted while sampling
     };
 #else
     class SimpleMutex : boost::noncopyable {
     public:
         void dassertLocked() const { }
-        SimpleMutex(StringData name) { verify( pthread_mutex_init(&_lock,0) == 0 ); }
+        SimpleMutex(StringData name) : _name(name) { verify( pthread_mutex_init(&_lock,0) == 0 ); }
         ~SimpleMutex(){ 
             if ( ! StaticObserver::_destroyingStatics ) { 
                 verify( pthread_mutex_destroy(&_lock) == 0 ); 
             }
         }
 
-        void lock() { verify( pthread_mutex_lock(&_lock) == 0 ); }
+        void lock() {
+            if ( MONGO_unlikely( MutexContention::isSampling() ) ) {
+                _lockSampled();
+                return;
+            }
+            verify( pthread_mutex_lock(&_lock) == 0 );
+        }
         void unlock() { verify( pthread_mutex_unlock(&_lock) == 0 ); }
     public:
         class scoped_lock : boost::noncopyable {
@@ -127,7 +147,11 @@ namespace mongo {
         };
 
     private:
+        NOINLINE_DECL void _lockSampled();
+
         pthread_mutex_t _lock;
+        const StringData _name;
+        AtomicUInt64 _holderSite; // the last call site to lock, noted while sampling
     };
 #endif
 
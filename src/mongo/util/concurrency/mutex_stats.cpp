@@ -0,0 +1,208 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/mutex_stats.h"
+
+#include <algorithm>
+#include <boost/thread/mutex.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#if !defined(_WIN32)
+#include <cxxabi.h>
+#include <dlfcn.h>
+#endif
+
+#include "mongo/stdx/chrono.h"
+
+namespace mongo {
+
+    using std::string;
+    using std::vector;
+
+namespace {
+
+    // The number of distinct holder call sites kept per mutex name.
+    const size_t kMaxHolderSites = 16;
+
+    struct Entry {
+        Entry() : waits(0), totalWaitMicros(0), maxWaitMicros(0), otherHolderWaits(0) { }
+
+        long long waits;
+        long long totalWaitMicros;
+        long long maxWaitMicros;
+        std::map<const void*, long long> holders;
+        long long otherHolderWaits;
+    };
+
+    typedef std::map<string, Entry> EntryMap;
+
+    // Never destroyed, since mutexes may still be locked by other threads during shutdown. A
+    // boost::mutex, as a SimpleMutex would sample itself.
+    boost::mutex* const entriesMutex = new boost::mutex();
+    EntryMap* const entries = new EntryMap();
+
+    AtomicUInt32 contendedAcquisitions;
+
+    // Not curTimeMicros64, which locks a SimpleMutex on some platforms.
+    long long nowMicros() {
+        return stdx::chrono::duration_cast<stdx::chrono::microseconds>(
+            stdx::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool moreWaits(const std::pair<string, long long>& lhs,
+                   const std::pair<string, long long>& rhs) {
+        return lhs.second > rhs.second;
+    }
+
+    /**
+     * Returns the symbol and offset of "site", or the module and offset when the symbol isn't
+     * exported, or just the address.
+     */
+    string describeSite(const void* site) {
+        std::ostringstream os;
+#if !defined(_WIN32)
+        Dl_info dlinfo;
+        if (dladdr(site, &dlinfo)) {
+            if (dlinfo.dli_sname) {
+                int status;
+                char* niceName = abi::__cxa_demangle(dlinfo.dli_sname, 0, 0, &status);
+                os << (niceName ? niceName : dlinfo.dli_sname) << "+0x" << std::hex
+                   << uintptr_t(site) - uintptr_t(dlinfo.dli_saddr);
+                free(niceName);
+                return os.str();
+            }
+            if (dlinfo.dli_fname && dlinfo.dli_fbase) {
+                const char* baseName = strrchr(dlinfo.dli_fname, '/');
+                os << (baseName ? baseName + 1 : dlinfo.dli_fname) << "+0x" << std::hex
+                   << uintptr_t(site) - uintptr_t(dlinfo.dli_fbase);
+                return os.str();
+            }
+        }
+#endif
+        os << site;
+        return os.str();
+    }
+
+}  // namespace
+
+    AtomicInt32 MutexContention::_sampleRate;
+
+    MutexContention::SampledWait::SampledWait(StringData name, const void* holderSite)
+        : _name(name),
+          _holderSite(holderSite),
+          _startMicros(shouldSample() ? nowMicros() : -1) {
+    }
+
+    MutexContention::SampledWait::~SampledWait() {
+        if (_startMicros >= 0) {
+            recordWait(_name, _holderSite, nowMicros() - _startMicros);
+        }
+    }
+
+    // static
+    void MutexContention::setSampleRate(int rate) {
+        _sampleRate.store(std::max(rate, 0));
+    }
+
+    // static
+    bool MutexContention::shouldSample() {
+        const int rate = _sampleRate.loadRelaxed();
+        if (rate <= 0) {
+            return false;
+        }
+        return contendedAcquisitions.fetchAndAdd(1) % rate == 0;
+    }
+
+    // static
+    void MutexContention::recordWait(StringData name,
+                                     const void* holderSite,
+                                     long long waitMicros) {
+        boost::mutex::scoped_lock lk(*entriesMutex);
+        Entry& entry = (*entries)[name.toString()];
+        entry.waits++;
+        entry.totalWaitMicros += waitMicros;
+        entry.maxWaitMicros = std::max(entry.maxWaitMicros, waitMicros);
+
+        if (!holderSite) {
+            return;
+        }
+        std::map<const void*, long long>::iterator it = entry.holders.find(holderSite);
+        if (it != entry.holders.end()) {
+            it->second++;
+        }
+        else if (entry.holders.size() < kMaxHolderSites) {
+            entry.holders[holderSite] = 1;
+        }
+        else {
+            entry.otherHolderWaits++;
+        }
+    }
+
+    // static
+    vector<MutexContention::Stats> MutexContention::getStats() {
+        EntryMap copy;
+        {
+            boost::mutex::scoped_lock lk(*entriesMutex);
+            copy = *entries;
+        }
+
+        // The symbols are resolved outside of the mutex, as dladdr can be slow.
+        vector<Stats> stats;
+        for (EntryMap::const_iterator it = copy.begin(); it != copy.end(); ++it) {
+            stats.push_back(Stats());
+            Stats& mutexStats = stats.back();
+            mutexStats.name = it->first;
+            mutexStats.waits = it->second.waits;
+            mutexStats.totalWaitMicros = it->second.totalWaitMicros;
+            mutexStats.maxWaitMicros = it->second.maxWaitMicros;
+            mutexStats.otherHolderWaits = it->second.otherHolderWaits;
+
+            for (std::map<const void*, long long>::const_iterator site =
+                     it->second.holders.begin();
+                 site != it->second.holders.end();
+                 ++site) {
+                mutexStats.holders.push_back(std::make_pair(describeSite(site->first),
+                                                            site->second));
+            }
+            std::stable_sort(mutexStats.holders.begin(), mutexStats.holders.end(), moreWaits);
+        }
+        return stats;
+    }
+
+    // static
+    void MutexContention::reset() {
+        boost::mutex::scoped_lock lk(*entriesMutex);
+        entries->clear();
+    }
+
+}  // namespace mongo
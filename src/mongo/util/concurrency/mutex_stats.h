@@ -0,0 +1,123 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define MONGO_CALLER_ADDRESS() _ReturnAddress()
+#else
+#define MONGO_CALLER_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace mongo {
+
+    /**
+     * Sampled contention statistics of the SimpleMutexes, by name, and of the SpinLocks, for
+     * finding internal bottlenecks on a running server.
+     *
+     * Sampling is off by default, and then only costs a relaxed load on each acquisition. With a
+     * sample rate of N, one in every N acquisitions which have to wait is timed and charged to the
+     * name of its mutex, along with the call site which last acquired the mutex, which is usually
+     * the one holding it.
+     */
+    class MutexContention {
+    public:
+        struct Stats {
+            Stats() : waits(0), totalWaitMicros(0), maxWaitMicros(0), otherHolderWaits(0) { }
+
+            std::string name;
+            long long waits;
+            long long totalWaitMicros;
+            long long maxWaitMicros;
+
+            // The call sites of the holders, as symbol and offset where they can be resolved,
+            // with the number of sampled waits on each, most frequent first.
+            std::vector<std::pair<std::string, long long> > holders;
+
+            // The sampled waits on holders which didn't fit in the per mutex limit of sites.
+            long long otherHolderWaits;
+        };
+
+        /**
+         * Times a contended acquisition from construction to destruction, if it is sampled.
+         */
+        class SampledWait {
+        public:
+            SampledWait(StringData name, const void* holderSite);
+            ~SampledWait();
+
+        private:
+            const StringData _name;
+            const void* const _holderSite;
+            const long long _startMicros; // -1 when not sampled
+        };
+
+        static bool isSampling() {
+            return _sampleRate.loadRelaxed() > 0;
+        }
+
+        static int getSampleRate() {
+            return _sampleRate.loadRelaxed();
+        }
+
+        /**
+         * Samples one in every "rate" contended acquisitions, or none for 0.
+         */
+        static void setSampleRate(int rate);
+
+        /**
+         * Returns whether the contended acquisition which is about to wait should be timed.
+         */
+        static bool shouldSample();
+
+        /**
+         * Charges a wait of "waitMicros" to the mutex "name", which was held by "holderSite", if
+         * known.  "name" is copied.
+         */
+        static void recordWait(StringData name, const void* holderSite, long long waitMicros);
+
+        /**
+         * Returns the statistics collected since the last reset, by mutex name.
+         */
+        static std::vector<Stats> getStats();
+
+        static void reset();
+
+    private:
+        static AtomicInt32 _sampleRate;
+    };
+
+}  // namespace mongo
@@ -0,0 +1,139 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/thread/thread.hpp>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/mutex_stats.h"
+#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using namespace mongo;
+
+    template <typename Mutex>
+    void holdFor(Mutex* m, AtomicWord<bool>* held) {
+        m->lock();
+        held->store(true);
+        sleepmillis(50);
+        m->unlock();
+    }
+
+    /**
+     * Holds "m" for a while from another thread, and then locks it here.
+     */
+    template <typename Mutex>
+    void lockWhileHeld(Mutex* m) {
+        AtomicWord<bool> held(false);
+        boost::thread holder(stdx::bind(&holdFor<Mutex>, m, &held));
+        while (!held.load()) {
+            sleepmillis(1);
+        }
+        m->lock();
+        m->unlock();
+        holder.join();
+    }
+
+    const MutexContention::Stats* findStats(const std::vector<MutexContention::Stats>& stats,
+                                            StringData name) {
+        for (size_t i = 0; i < stats.size(); i++) {
+            if (stats[i].name == name) {
+                return &stats[i];
+            }
+        }
+        return NULL;
+    }
+
+    class MutexContentionTest : public unittest::Test {
+    protected:
+        void setUp() {
+            MutexContention::reset();
+        }
+
+        void tearDown() {
+            MutexContention::setSampleRate(0);
+            MutexContention::reset();
+        }
+    };
+
+    TEST_F(MutexContentionTest, NothingIsSampledByDefault) {
+        ASSERT_FALSE(MutexContention::isSampling());
+        SimpleMutex m("mutexContentionTestOff");
+        lockWhileHeld(&m);
+        ASSERT(findStats(MutexContention::getStats(), "mutexContentionTestOff") == NULL);
+    }
+
+    TEST_F(MutexContentionTest, SampledWaitsAreChargedToTheMutexAndItsHolder) {
+        MutexContention::setSampleRate(1);
+        SimpleMutex m("mutexContentionTest");
+        lockWhileHeld(&m);
+        lockWhileHeld(&m);
+
+        const std::vector<MutexContention::Stats> stats = MutexContention::getStats();
+        const MutexContention::Stats* mutexStats = findStats(stats, "mutexContentionTest");
+        ASSERT(mutexStats != NULL);
+        ASSERT_EQUALS(2, mutexStats->waits);
+        ASSERT_GREATER_THAN_OR_EQUALS(mutexStats->totalWaitMicros, mutexStats->maxWaitMicros);
+        ASSERT_GREATER_THAN(mutexStats->maxWaitMicros, 10 * 1000);
+
+        // Both waits were on the lock in holdFor.
+        ASSERT_EQUALS(1U, mutexStats->holders.size());
+        ASSERT_EQUALS(2, mutexStats->holders[0].second);
+        ASSERT_FALSE(mutexStats->holders[0].first.empty());
+        ASSERT_EQUALS(0, mutexStats->otherHolderWaits);
+
+        MutexContention::reset();
+        ASSERT(findStats(MutexContention::getStats(), "mutexContentionTest") == NULL);
+    }
+
+    TEST_F(MutexContentionTest, SamplingCanBeTurnedOff) {
+        MutexContention::setSampleRate(1);
+        MutexContention::setSampleRate(0);
+        ASSERT_FALSE(MutexContention::isSampling());
+        SimpleMutex m("mutexContentionTestTurnedOff");
+        lockWhileHeld(&m);
+        ASSERT(findStats(MutexContention::getStats(), "mutexContentionTestTurnedOff") == NULL);
+    }
+
+    TEST_F(MutexContentionTest, SpinLockWaits) {
+        MutexContention::setSampleRate(1);
+        SpinLock spin;
+        lockWhileHeld(&spin);
+
+        const MutexContention::Stats* spinStats =
+            findStats(MutexContention::getStats(), "SpinLock");
+        ASSERT(spinStats != NULL);
+        ASSERT_GREATER_THAN_OR_EQUALS(spinStats->waits, 1);
+    }
+
+}  // namespace
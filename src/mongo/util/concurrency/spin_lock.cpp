@@ -35,6 +35,7 @@
 #include <time.h>
 
 #include "mongo/bson/inline_decls.h"
+#include "mongo/util/concurrency/mutex_stats.h"
 
 namespace mongo {
 
@@ -66,7 +67,8 @@ namespace mongo {
          * it allows spinlocks to be used in many more places
          * which is good because even with this change they are about 8x faster on linux
          */
-        
+        MutexContention::SampledWait wait("SpinLock", NULL);
+
         for ( int i=0; i<1000; i++ ) {            
             if ( pthread_spin_trylock( &_lock ) == 0 )
                 return;
@@ -97,6 +99,8 @@ namespace mongo {
             return;
         }
 
+        MutexContention::SampledWait sampledWait("SpinLock", NULL);
+
         // wait for lock
         int wait = 1000;
         while ((wait-- > 0) && (_locked)) {
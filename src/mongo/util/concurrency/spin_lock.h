@@ -43,6 +43,9 @@ namespace mongo {
     /**
      * The spinlock currently requires late GCC support routines to be efficient.
      * Other platforms default to a mutex implemenation.
+     *
+     * When MutexContention sampling is on, the sampled waits of all the SpinLocks are charged to
+     * the name "SpinLock", without the holders, which aren't tracked to keep locking cheap.
      */
     class SpinLock : boost::noncopyable {
     public:
@@ -34,10 +34,11 @@
 
 #include "mongo/util/concurrency/thread_pool.h"
 
+#include <deque>
+
 #include <boost/noncopyable.hpp>
 #include <boost/thread/thread.hpp>
 
-#include "mongo/util/concurrency/mvar.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -45,44 +46,51 @@ namespace mongo {
     namespace threadpool {
 
         using std::endl;
-        
+
+        struct WorkQueue : boost::noncopyable {
+            mongo::mutex mutex;
+            std::deque<Task> tasks; // the owning worker pops the front, thieves the back
+
+            bool pop(Task* task, bool fromFront) {
+                boost::lock_guard<boost::mutex> lock(mutex);
+                if (tasks.empty())
+                    return false;
+                if (fromFront) {
+                    task->swap(tasks.front());
+                    tasks.pop_front();
+                }
+                else {
+                    task->swap(tasks.back());
+                    tasks.pop_back();
+                }
+                return true;
+            }
+        };
+
         // Worker thread
         class Worker : boost::noncopyable {
         public:
-            explicit Worker(ThreadPool& owner, const std::string& threadName)
+            Worker(ThreadPool& owner, size_t queue, const std::string& threadName)
                 : _owner(owner)
-                , _is_done(true)
+                , _queue(queue)
                 , _thread(stdx::bind(&Worker::loop, this, threadName))
             {}
 
-            // destructor will block until current operation is completed
+            // destructor will block until the pool has shut down and the thread has exited
             // Acts as a "join" on this thread
             ~Worker() {
-                _task.put(Task());
                 _thread.join();
             }
 
-            void set_task(Task& func) {
-                verify(func);
-                verify(_is_done);
-                _is_done = false;
-
-                _task.put(func);
-            }
-
         private:
             ThreadPool& _owner;
-            MVar<Task> _task;
-            bool _is_done; // only used for error detection
+            const size_t _queue;
             boost::thread _thread;
 
             void loop(const std::string& threadName) {
                 setThreadName(threadName);
-                while (true) {
-                    Task task = _task.take();
-                    if (!task)
-                        break; // ends the thread
-
+                Task task;
+                while (_owner._takeTask(_queue, &task)) {
                     try {
                         task();
                     }
@@ -95,92 +103,132 @@ namespace mongo {
                     catch (...) {
                         log() << "Unhandled non-exception in worker thread" << endl;
                     }
-                    _is_done = true;
-                    _owner.task_done(this);
+                    task = Task();
+                    _owner.task_done();
                 }
             }
         };
 
         ThreadPool::ThreadPool(int nThreads, const std::string& threadNamePrefix)
-            : _tasksRemaining(0)
+            : _inShutdown(false)
             , _nThreads(nThreads)
             , _threadNamePrefix(threadNamePrefix) {
+            _init();
             startThreads();
         }
 
         ThreadPool::ThreadPool(const DoNotStartThreadsTag&,
                                int nThreads,
                                const std::string& threadNamePrefix)
-            : _tasksRemaining(0)
+            : _inShutdown(false)
             , _nThreads(nThreads)
             , _threadNamePrefix(threadNamePrefix) {
+            _init();
+        }
+
+        void ThreadPool::_init() {
+            verify(_nThreads > 0);
+            for (int i = 0; i < _nThreads; ++i) {
+                _queues.push_back(new WorkQueue());
+            }
         }
 
         void ThreadPool::startThreads() {
             boost::lock_guard<boost::mutex> lock(_mutex);
+            verify(_workers.empty());
             for (int i = 0; i < _nThreads; ++i) {
                 const std::string threadName(_threadNamePrefix.empty() ?
                                                         _threadNamePrefix :
                                                         str::stream() << _threadNamePrefix << i);
-                Worker* worker = new Worker(*this, threadName);
-                if (_tasks.empty()) {
-                    _freeWorkers.push_front(worker);
-                }
-                else {
-                    worker->set_task(_tasks.front());
-                    _tasks.pop_front();
-                }
+                _workers.push_back(new Worker(*this, i, threadName));
             }
         }
 
         ThreadPool::~ThreadPool() {
             join();
 
-            verify(_tasksRemaining == 0);
+            verify(_tasksRemaining.load() == 0);
 
-            while(!_freeWorkers.empty()) {
-                delete _freeWorkers.front();
-                _freeWorkers.pop_front();
+            {
+                boost::lock_guard<boost::mutex> lock(_mutex);
+                _inShutdown = true;
+                _workAvailable.notify_all();
+            }
+
+            for (size_t i = 0; i < _workers.size(); ++i) {
+                delete _workers[i];
+            }
+            for (size_t i = 0; i < _queues.size(); ++i) {
+                delete _queues[i];
             }
         }
 
         void ThreadPool::join() {
             boost::unique_lock<boost::mutex> lock(_mutex);
-            while(_tasksRemaining) {
+            while (_tasksRemaining.load()) {
                 _condition.wait(lock);
             }
         }
 
         void ThreadPool::schedule(Task task) {
-            boost::lock_guard<boost::mutex> lock(_mutex);
+            _push(_nextQueue.fetchAndAdd(1) % _queues.size(), task);
+        }
 
-            _tasksRemaining++;
+        void ThreadPool::scheduleWithAffinity(size_t affinity, Task task) {
+            _push(affinity % _queues.size(), task);
+        }
 
-            if (!_freeWorkers.empty()) {
-                _freeWorkers.front()->set_task(task);
-                _freeWorkers.pop_front();
+        void ThreadPool::_push(size_t queue, Task& task) {
+            verify(task);
+            _tasksRemaining.fetchAndAdd(1);
+            {
+                WorkQueue* q = _queues[queue];
+                boost::lock_guard<boost::mutex> lock(q->mutex);
+                q->tasks.push_back(Task());
+                q->tasks.back().swap(task);
+                _tasksQueued.fetchAndAdd(1);
             }
-            else {
-                _tasks.push_back(task);
+
+            // A worker increments _idleWorkers before checking _tasksQueued under _mutex, so
+            // either it sees this task or we see it waiting and wake it.
+            if (_idleWorkers.load() > 0) {
+                boost::lock_guard<boost::mutex> lock(_mutex);
+                _workAvailable.notify_one();
             }
         }
 
-        // should only be called by a worker from the worker thread
-        void ThreadPool::task_done(Worker* worker) {
-            boost::lock_guard<boost::mutex> lock(_mutex);
+        bool ThreadPool::_takeTask(size_t queue, Task* task) {
+            const size_t nQueues = _queues.size();
+            while (true) {
+                if (_queues[queue]->pop(task, true)) {
+                    _tasksQueued.fetchAndSubtract(1);
+                    return true;
+                }
+                for (size_t i = 1; i < nQueues; ++i) {
+                    if (_queues[(queue + i) % nQueues]->pop(task, false)) {
+                        _tasksQueued.fetchAndSubtract(1);
+                        return true;
+                    }
+                }
 
-            if (!_tasks.empty()) {
-                worker->set_task(_tasks.front());
-                _tasks.pop_front();
-            }
-            else {
-                _freeWorkers.push_front(worker);
+                boost::unique_lock<boost::mutex> lock(_mutex);
+                _idleWorkers.fetchAndAdd(1);
+                while (_tasksQueued.load() == 0 && !_inShutdown) {
+                    _workAvailable.wait(lock);
+                }
+                _idleWorkers.fetchAndSubtract(1);
+                if (_tasksQueued.load() == 0 && _inShutdown) {
+                    return false;
+                }
             }
+        }
 
-            _tasksRemaining--;
-
-            if(_tasksRemaining == 0)
+        // should only be called by a worker from the worker thread
+        void ThreadPool::task_done() {
+            if (_tasksRemaining.subtractAndFetch(1) == 0) {
+                boost::lock_guard<boost::mutex> lock(_mutex);
                 _condition.notify_all();
+            }
         }
 
     } //namespace threadpool
@@ -29,11 +29,12 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
 
 #include <boost/noncopyable.hpp>
 #include <boost/thread/condition.hpp>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/mutex.h"
 
@@ -41,9 +42,14 @@ namespace mongo {
 
     namespace threadpool {
         class Worker;
+        struct WorkQueue;
 
         typedef stdx::function<void(void)> Task; //nullary function or functor
 
+        // Each worker thread has its own queue of tasks.  schedule() spreads tasks across the
+        // queues, and a worker whose queue is empty steals tasks from the others, so workers
+        // rarely contend with each other or with the scheduling thread.
+        //
         // exported to the mongo namespace
         class ThreadPool : boost::noncopyable {
         public:
@@ -70,6 +76,11 @@ namespace mongo {
             // task will be copied a few times so make sure it's relatively cheap
             void schedule(Task task);
 
+            // Queues task on the worker selected by affinity (modulo the number of threads), so
+            // that tasks scheduled with the same affinity tend to run on the same thread.  This
+            // is only a hint: an idle worker may still steal the task.
+            void scheduleWithAffinity(size_t affinity, Task task);
+
             // Helpers that wrap schedule and stdx::bind.
             // Functor and args will be copied a few times so make sure it's relatively cheap
             template<typename F, typename A>
@@ -83,21 +94,34 @@ namespace mongo {
             template<typename F, typename A, typename B, typename C, typename D, typename E>
             void schedule(F f, A a, B b, C c, D d, E e) { schedule(stdx::bind(f,a,b,c,d,e)); }
 
-            int tasks_remaining() { return _tasksRemaining; }
+            int tasks_remaining() { return _tasksRemaining.load(); }
 
         private:
-            mongo::mutex _mutex;
-            boost::condition _condition;
+            void _init();
+            void _push(size_t queue, Task& task);
 
-            std::list<Worker*> _freeWorkers; //used as LIFO stack (always front)
-            std::list<Task> _tasks; //used as FIFO queue (push_back, pop_front)
-            int _tasksRemaining; // in queue + currently processing
-            int _nThreads; // only used for sanity checking. could be removed in the future.
-            const std::string _threadNamePrefix; // used for logging/diagnostics
+            // Pops a task from the worker's own queue or steals one from another queue, waiting
+            // for one to be scheduled if all are empty.  Returns false once the pool is shutting
+            // down and no tasks are left.
+            bool _takeTask(size_t queue, Task* task);
 
             // should only be called by a worker from the worker's thread
-            void task_done(Worker* worker);
+            void task_done();
             friend class Worker;
+
+            mongo::mutex _mutex;
+            boost::condition _condition; // notified when _tasksRemaining drops to 0
+            boost::condition _workAvailable; // notified when a task is queued or on shutdown
+            bool _inShutdown; // guarded by _mutex
+
+            std::vector<WorkQueue*> _queues; // one per worker, owned
+            std::vector<Worker*> _workers; // owned
+            AtomicUInt32 _nextQueue; // round robin position for schedule()
+            AtomicInt32 _tasksQueued; // in any queue, not yet taken by a worker
+            AtomicInt32 _idleWorkers; // waiting on _workAvailable
+            AtomicInt32 _tasksRemaining; // in queue + currently processing
+            const int _nThreads;
+            const std::string _threadNamePrefix; // used for logging/diagnostics
         };
 
     } //namespace threadpool
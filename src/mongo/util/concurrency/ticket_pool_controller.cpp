@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/concurrency/ticket_pool_controller.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+namespace {
+
+    // Relative changes of throughput smaller than this are taken as noise.
+    const double kThroughputTolerance = 0.05;
+
+    // Fraction of the tickets kept after throughput fell.
+    const double kDecreaseFactor = 0.75;
+
+    int clamp(int size, int minSize, int maxSize) {
+        return std::max(minSize, std::min(maxSize, size));
+    }
+
+} // namespace
+
+    TicketPoolController::TicketPoolController()
+        : _lastAcquisitions(0),
+          _lastIncrease(0) { }
+
+    int TicketPoolController::nextSize(int currentSize,
+                                       const Sample& sample,
+                                       int minSize,
+                                       int maxSize) {
+        const long long lastAcquisitions = _lastAcquisitions;
+        const int lastIncrease = _lastIncrease;
+        _lastAcquisitions = sample.acquisitions;
+        _lastIncrease = 0;
+
+        if (lastIncrease > 0) {
+            if (sample.acquisitions < lastAcquisitions * (1 - kThroughputTolerance)) {
+                return clamp(static_cast<int>(currentSize * kDecreaseFactor), minSize, maxSize);
+            }
+            if (sample.acquisitions <= lastAcquisitions * (1 + kThroughputTolerance)) {
+                return clamp(currentSize - lastIncrease, minSize, maxSize);
+            }
+        }
+
+        if (sample.waits == 0) {
+            return clamp(currentSize, minSize, maxSize);
+        }
+
+        const int newSize = clamp(currentSize + std::max(1, currentSize / 16), minSize, maxSize);
+        _lastIncrease = newSize - currentSize;
+        return newSize;
+    }
+
+} // namespace mongo
@@ -0,0 +1,72 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Decides how many tickets a TicketHolder should have, from the throughput and queueing
+     * measured over successive intervals of equal length.
+     *
+     * Only while requests queue for tickets is the pool probed with a few more tickets. An
+     * increase is kept if throughput improved, taken back if throughput stayed flat, and
+     * followed by a multiplicative decrease if throughput fell: more concurrent transactions
+     * than the hardware can serve make every transaction slower. Without queueing the size is
+     * left alone, as there is nothing to learn.
+     */
+    class TicketPoolController {
+    public:
+        /**
+         * What happened to a pool during one interval.
+         */
+        struct Sample {
+            Sample() : acquisitions(0), waits(0) { }
+
+            // Tickets handed out.
+            long long acquisitions;
+
+            // How many of those had to wait for a ticket.
+            long long waits;
+        };
+
+        TicketPoolController();
+
+        /**
+         * Returns the size the pool should have for the next interval, given its size during
+         * the interval described by "sample". The result is within [minSize, maxSize].
+         */
+        int nextSize(int currentSize, const Sample& sample, int minSize, int maxSize);
+
+    private:
+        // Throughput of the previous interval and the change of size made after it, if any.
+        long long _lastAcquisitions;
+        int _lastIncrease;
+    };
+
+} // namespace mongo
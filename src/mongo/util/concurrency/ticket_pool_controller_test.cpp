@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticket_pool_controller.h"
+
+namespace {
+
+    using mongo::TicketPoolController;
+
+    TicketPoolController::Sample sample(long long acquisitions, long long waits) {
+        TicketPoolController::Sample s;
+        s.acquisitions = acquisitions;
+        s.waits = waits;
+        return s;
+    }
+
+    TEST(TicketPoolController, KeepsSizeWithoutQueueing) {
+        TicketPoolController controller;
+        ASSERT_EQUALS(128, controller.nextSize(128, sample(1000, 0), 16, 1024));
+        ASSERT_EQUALS(128, controller.nextSize(128, sample(5000, 0), 16, 1024));
+    }
+
+    TEST(TicketPoolController, GrowsWhileThroughputImproves) {
+        TicketPoolController controller;
+        ASSERT_EQUALS(136, controller.nextSize(128, sample(1000, 10), 16, 1024));
+        ASSERT_EQUALS(144, controller.nextSize(136, sample(1100, 10), 16, 1024));
+        ASSERT_EQUALS(153, controller.nextSize(144, sample(1200, 10), 16, 1024));
+    }
+
+    TEST(TicketPoolController, TakesBackIncreaseWithoutGain) {
+        TicketPoolController controller;
+        ASSERT_EQUALS(136, controller.nextSize(128, sample(1000, 10), 16, 1024));
+        ASSERT_EQUALS(128, controller.nextSize(136, sample(1010, 10), 16, 1024));
+
+        // Queueing goes on, so the next interval probes again.
+        ASSERT_EQUALS(136, controller.nextSize(128, sample(1000, 10), 16, 1024));
+    }
+
+    TEST(TicketPoolController, ShrinksWhenThroughputFalls) {
+        TicketPoolController controller;
+        ASSERT_EQUALS(136, controller.nextSize(128, sample(1000, 10), 16, 1024));
+        ASSERT_EQUALS(102, controller.nextSize(136, sample(800, 10), 16, 1024));
+    }
+
+    TEST(TicketPoolController, StaysWithinBounds) {
+        TicketPoolController controller;
+        ASSERT_EQUALS(1024, controller.nextSize(1020, sample(1000, 10), 16, 1024));
+        ASSERT_EQUALS(1024, controller.nextSize(1024, sample(2000, 10), 16, 1024));
+
+        TicketPoolController other;
+        ASSERT_EQUALS(17, other.nextSize(16, sample(1000, 10), 16, 1024));
+        ASSERT_EQUALS(16, other.nextSize(17, sample(10, 10), 16, 1024));
+
+        // Bounds changed to exclude the current size are applied right away.
+        TicketPoolController third;
+        ASSERT_EQUALS(64, third.nextSize(128, sample(1000, 0), 16, 64));
+    }
+
+} // namespace
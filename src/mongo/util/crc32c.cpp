@@ -0,0 +1,190 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/crc32c.h"
+
+#include <cstring>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <nmmintrin.h>
+#define MONGO_CRC32C_X86_64
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <cpuid.h>
+#define MONGO_CRC32C_X86_64
+#endif
+
+namespace mongo {
+
+    namespace {
+
+        // The reflected Castagnoli polynomial.
+        const uint32_t kPolynomial = 0x82f63b78;
+
+        /**
+         * Tables for processing 8 bytes at a time: table[0] is the usual byte-wise table, and
+         * table[k][b] is the crc of byte b followed by k zero bytes.
+         */
+        struct Crc32cTables {
+            Crc32cTables() {
+                for (uint32_t b = 0; b < 256; b++) {
+                    uint32_t crc = b;
+                    for (int bit = 0; bit < 8; bit++) {
+                        crc = (crc & 1) ? (crc >> 1) ^ kPolynomial : crc >> 1;
+                    }
+                    table[0][b] = crc;
+                }
+                for (uint32_t b = 0; b < 256; b++) {
+                    for (int k = 1; k < 8; k++) {
+                        table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+                    }
+                }
+            }
+
+            uint32_t table[8][256];
+        };
+
+        const Crc32cTables& tables() {
+            static const Crc32cTables instance;
+            return instance;
+        }
+
+        // Loads 8 bytes in little endian order, which is what the byte-wise loop consumes first.
+        inline uint64_t loadLittleEndian64(const unsigned char* p) {
+            uint64_t v = 0;
+            for (int i = 7; i >= 0; i--) {
+                v = (v << 8) | p[i];
+            }
+            return v;
+        }
+
+#if defined(MONGO_CRC32C_X86_64)
+        bool cpuHasSse42() {
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 1);
+            return info[2] & (1 << 20);
+#else
+            unsigned int eax, ebx, ecx, edx;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            return ecx & bit_SSE4_2;
+#endif
+        }
+
+        inline uint64_t crc32Step64(uint64_t crc, uint64_t v) {
+#if defined(_MSC_VER)
+            return _mm_crc32_u64(crc, v);
+#else
+            // An assembler mnemonic rather than the intrinsic, which would need the whole file to
+            // be compiled for SSE4.2.
+            __asm__("crc32q %1, %0" : "+r"(crc) : "rm"(v));
+            return crc;
+#endif
+        }
+
+        inline uint32_t crc32Step8(uint32_t crc, unsigned char v) {
+#if defined(_MSC_VER)
+            return _mm_crc32_u8(crc, v);
+#else
+            __asm__("crc32b %1, %0" : "+r"(crc) : "rm"(v));
+            return crc;
+#endif
+        }
+
+        uint32_t crc32cHardware(uint32_t crc, const void* buf, size_t len) {
+            const unsigned char* p = static_cast<const unsigned char*>(buf);
+            uint32_t c = ~crc;
+
+            // Align to 8 bytes, then process 8 bytes per instruction.
+            while (len > 0 && (reinterpret_cast<uintptr_t>(p) & 7)) {
+                c = crc32Step8(c, *p++);
+                len--;
+            }
+            uint64_t c64 = c;
+            for (; len >= 8; p += 8, len -= 8) {
+                uint64_t v;
+                memcpy(&v, p, sizeof(v));
+                c64 = crc32Step64(c64, v);
+            }
+            c = static_cast<uint32_t>(c64);
+            while (len > 0) {
+                c = crc32Step8(c, *p++);
+                len--;
+            }
+            return ~c;
+        }
+#endif
+
+    } // namespace
+
+    uint32_t crc32cSoftware(uint32_t crc, const void* buf, size_t len) {
+        const uint32_t (&t)[8][256] = tables().table;
+        const unsigned char* p = static_cast<const unsigned char*>(buf);
+        uint32_t c = ~crc;
+
+        for (; len >= 8; p += 8, len -= 8) {
+            const uint64_t v = loadLittleEndian64(p) ^ c;
+            c = t[7][v & 0xff] ^
+                t[6][(v >> 8) & 0xff] ^
+                t[5][(v >> 16) & 0xff] ^
+                t[4][(v >> 24) & 0xff] ^
+                t[3][(v >> 32) & 0xff] ^
+                t[2][(v >> 40) & 0xff] ^
+                t[1][(v >> 48) & 0xff] ^
+                t[0][v >> 56];
+        }
+        while (len > 0) {
+            c = (c >> 8) ^ t[0][(c ^ *p++) & 0xff];
+            len--;
+        }
+        return ~c;
+    }
+
+    bool crc32cIsHardwareAccelerated() {
+#if defined(MONGO_CRC32C_X86_64)
+        static const bool hasSse42 = cpuHasSse42();
+        return hasSse42;
+#else
+        return false;
+#endif
+    }
+
+    uint32_t crc32c(uint32_t crc, const void* buf, size_t len) {
+#if defined(MONGO_CRC32C_X86_64)
+        if (crc32cIsHardwareAccelerated()) {
+            return crc32cHardware(crc, buf, len);
+        }
+#endif
+        return crc32cSoftware(crc, buf, len);
+    }
+
+} // namespace mongo
@@ -0,0 +1,52 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * Returns the CRC-32C (Castagnoli) of the len bytes at buf.  crc is the value returned for the
+     * bytes preceding them, or 0 to start a new checksum.
+     *
+     * Uses the SSE4.2 crc32 instruction when the CPU supports it, a table driven implementation
+     * otherwise; both give the same results.
+     */
+    uint32_t crc32c(uint32_t crc, const void* buf, size_t len);
+
+    /** The table driven implementation crc32c() falls back to, exposed for testing. */
+    uint32_t crc32cSoftware(uint32_t crc, const void* buf, size_t len);
+
+    /** Whether crc32c() uses the crc32 instruction on this machine. */
+    bool crc32cIsHardwareAccelerated();
+
+} // namespace mongo
@@ -0,0 +1,85 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/crc32c.h"
+
+#include <cstring>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    TEST(Crc32c, KnownValues) {
+        ASSERT_EQUALS(0U, crc32c(0, "", 0));
+        ASSERT_EQUALS(0xe3069283U, crc32c(0, "123456789", 9));
+        ASSERT_EQUALS(0xe3069283U, crc32cSoftware(0, "123456789", 9));
+
+        // From RFC 3720, appendix B.4.
+        char zeros[32];
+        memset(zeros, 0, sizeof(zeros));
+        ASSERT_EQUALS(0x8a9136aaU, crc32c(0, zeros, sizeof(zeros)));
+        char ones[32];
+        memset(ones, 0xff, sizeof(ones));
+        ASSERT_EQUALS(0x62a8ab43U, crc32c(0, ones, sizeof(ones)));
+    }
+
+    TEST(Crc32c, HardwareMatchesSoftware) {
+        std::vector<unsigned char> buf(1024);
+        for (size_t i = 0; i < buf.size(); i++) {
+            buf[i] = static_cast<unsigned char>(i * 7919 + (i >> 3));
+        }
+
+        // Every alignment, and lengths around the 8 byte steps.
+        for (size_t offset = 0; offset < 8; offset++) {
+            for (size_t len = 0; len < 100; len++) {
+                ASSERT_EQUALS(crc32cSoftware(0, &buf[offset], len),
+                              crc32c(0, &buf[offset], len));
+            }
+        }
+        ASSERT_EQUALS(crc32cSoftware(0, &buf[0], buf.size()), crc32c(0, &buf[0], buf.size()));
+    }
+
+    TEST(Crc32c, Continues) {
+        const char* data = "The quick brown fox jumps over the lazy dog";
+        const size_t len = strlen(data);
+        const uint32_t whole = crc32c(0, data, len);
+        for (size_t split = 0; split <= len; split++) {
+            ASSERT_EQUALS(whole, crc32c(crc32c(0, data, split), data + split, len - split));
+            ASSERT_EQUALS(whole,
+                          crc32cSoftware(crc32cSoftware(0, data, split),
+                                         data + split,
+                                         len - split));
+        }
+    }
+
+} // namespace
+} // namespace mongo
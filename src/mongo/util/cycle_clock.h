@@ -0,0 +1,68 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace mongo {
+
+    /**
+     * A cheap clock for timing short spans of code, such as a single call into a query stage.
+     *
+     * On x86 it reads the CPU's time stamp counter, which takes a few nanoseconds and doesn't
+     * enter the kernel, and elsewhere it falls back to the system clock.  Readings are in
+     * platform-dependent units, and only differences between readings taken in the same process
+     * are meaningful.  Use toNanos() to convert them.
+     */
+    class CycleClock {
+    public:
+        static long long now() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            return static_cast<long long>(__builtin_ia32_rdtsc());
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            return static_cast<long long>(__rdtsc());
+#else
+            return nowGeneric();
+#endif
+        }
+
+        /**
+         * Converts a number of cycles into nanoseconds.  The rate of the clock is measured against
+         * the system clock over the life of the process, so conversions done in the first few
+         * milliseconds after startup are imprecise.
+         */
+        static long long toNanos(long long cycles);
+
+    private:
+        static long long nowGeneric();
+    };
+
+}  // namespace mongo
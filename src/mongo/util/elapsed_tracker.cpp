@@ -32,7 +32,7 @@
 
 #include "mongo/util/elapsed_tracker.h"
 
-#include "mongo/util/net/listen.h"
+#include "mongo/util/coarse_clock.h"
 
 namespace mongo {
 
@@ -40,17 +40,17 @@ namespace mongo {
         _hitsBetweenMarks( hitsBetweenMarks ),
         _msBetweenMarks( msBetweenMarks ),
         _pings( 0 ),
-        _last( Listener::getElapsedTimeMillis() ) {
+        _last( CoarseClock::elapsedMillis() ) {
     }
 
     bool ElapsedTracker::intervalHasElapsed() {
         if ( ++_pings >= _hitsBetweenMarks ) {
             _pings = 0;
-            _last = Listener::getElapsedTimeMillis();
+            _last = CoarseClock::elapsedMillis();
             return true;
         }
 
-        long long now = Listener::getElapsedTimeMillis();
+        long long now = CoarseClock::elapsedMillis();
         if ( now - _last > _msBetweenMarks ) {
             _pings = 0;
             _last = now;
@@ -62,7 +62,7 @@ namespace mongo {
 
     void ElapsedTracker::resetLastTime() {
         _pings = 0;
-        _last = Listener::getElapsedTimeMillis();
+        _last = CoarseClock::elapsedMillis();
     }
 
 } // namespace mongo
@@ -117,11 +117,19 @@ namespace mongo {
         return parent;
     }
 
-    FileAllocator::FileAllocator() : _failed() {}
+    FileAllocator::FileAllocator() : _failed(), _lastAllocationMicros(0) {}
 
 
-    void FileAllocator::start() {
-        boost::thread t( stdx::bind( &FileAllocator::run , this ) );
+    void FileAllocator::start( int numThreads ) {
+        {
+            // initialize unique temporary file name counter
+            // TODO: SERVER-6055 -- Unify temporary file name selection
+            SimpleMutex::scoped_lock lk(_uniqueNumberMutex);
+            _uniqueNumber = curTimeMicros64();
+        }
+        for ( int i = 0; i < std::max( 1, numThreads ); i++ ) {
+            boost::thread t( stdx::bind( &FileAllocator::run , this ) );
+        }
     }
 
     void FileAllocator::requestAllocation( const string &name, long &size ) {
@@ -153,12 +161,12 @@ namespace mongo {
         }
         checkFailure();
         _pendingSize[ name ] = size;
-        if ( _pending.size() == 0 )
-            _pending.push_back( name );
-        else if ( _pending.front() != name ) {
+        if ( !_allocating.count( name ) ) {
+            // Allocate it before all other files which no thread has started on yet.
             _pending.remove( name );
             list< string >::iterator i = _pending.begin();
-            ++i;
+            while ( i != _pending.end() && _allocating.count( *i ) )
+                ++i;
             _pending.insert( i, name );
         }
         _pendingUpdated.notify_all();
@@ -177,6 +185,11 @@ namespace mongo {
             _pendingUpdated.wait(lk);
     }
 
+    long long FileAllocator::lastAllocationMicros() const {
+        boost::lock_guard<boost::mutex> lk( _pendingMutex );
+        return _lastAllocationMicros;
+    }
+
     // TODO: pull this out to per-OS files once they exist
     static bool useSparseFiles(int fd) {
 
@@ -328,6 +341,14 @@ namespace mongo {
         return false;
     }
 
+    // caller must hold _pendingMutex lock.
+    string FileAllocator::nextUnclaimed() const {
+        for( list< string >::const_iterator i = _pending.begin(); i != _pending.end(); ++i )
+            if ( !_allocating.count( *i ) )
+                return *i;
+        return "";
+    }
+
     string FileAllocator::makeTempFileName( boost::filesystem::path root ) {
         while( 1 ) {
             boost::filesystem::path p = root / "_tmp";
@@ -351,16 +372,10 @@ namespace mongo {
 
     void FileAllocator::run( FileAllocator * fa ) {
         setThreadName( "FileAllocator" );
-        {
-            // initialize unique temporary file name counter
-            // TODO: SERVER-6055 -- Unify temporary file name selection
-            SimpleMutex::scoped_lock lk(_uniqueNumberMutex);
-            _uniqueNumber = curTimeMicros64();
-        }
         while( 1 ) {
             {
                 boost::unique_lock<boost::mutex> lk( fa->_pendingMutex );
-                if ( fa->_pending.size() == 0 )
+                while ( fa->nextUnclaimed().empty() )
                     fa->_pendingUpdated.wait(lk);
             }
             while( 1 ) {
@@ -368,14 +383,16 @@ namespace mongo {
                 long size = 0;
                 {
                     boost::lock_guard<boost::mutex> lk( fa->_pendingMutex );
-                    if ( fa->_pending.size() == 0 )
+                    name = fa->nextUnclaimed();
+                    if ( name.empty() )
                         break;
-                    name = fa->_pending.front();
                     size = fa->_pendingSize[ name ];
+                    fa->_allocating.insert( name );
                 }
 
                 string tmp;
                 long fd = 0;
+                long long allocationMicros = 0;
                 try {
                     log() << "allocating new datafile " << name << ", filling with zeroes..." << endl;
                     
@@ -421,6 +438,8 @@ namespace mongo {
                           << " took " << ((double)t.millis())/1000.0 << " secs"
                           << endl;
 
+                    allocationMicros = t.micros();
+
                     // no longer in a failed state. allow new writers.
                     fa->_failed = false;
                 }
@@ -448,13 +467,21 @@ namespace mongo {
                     
                     
                     sleepsecs(10);
+
+                    // Lets other threads retry this file only after the pause.
+                    {
+                        boost::lock_guard<boost::mutex> lk(fa->_pendingMutex);
+                        fa->_allocating.erase( name );
+                    }
                     continue;
                 }
 
                 {
                     boost::lock_guard<boost::mutex> lk( fa->_pendingMutex );
                     fa->_pendingSize.erase( name );
-                    fa->_pending.pop_front();
+                    fa->_pending.remove( name );
+                    fa->_allocating.erase( name );
+                    fa->_lastAllocationMicros = allocationMicros;
                     fa->_pendingUpdated.notify_all();
                 }
             }
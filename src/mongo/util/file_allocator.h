@@ -30,6 +30,7 @@
 #include "mongo/platform/basic.h"
 
 #include <list>
+#include <set>
 #include <boost/filesystem/path.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/thread/condition.hpp>
@@ -50,7 +51,10 @@ namespace mongo {
          * size specified per file will be used.
         */
     public:
-        void start();
+        /**
+         * Starts 'numThreads' threads, which allocate requested files concurrently.
+         */
+        void start( int numThreads = 1 );
 
         /**
          * May be called if file exists. If file exists, or its allocation has
@@ -67,6 +71,12 @@ namespace mongo {
 
         void waitUntilFinished() const;
 
+        /**
+         * How long allocating the most recently allocated file took, or 0 if no file has been
+         * allocated yet.
+         */
+        long long lastAllocationMicros() const;
+
         static void ensureLength(int fd, long size);
 
         /** @return the singleton */
@@ -85,7 +95,11 @@ namespace mongo {
         // caller must hold pendingMutex_ lock.
         bool inProgress( const std::string &name ) const;
 
-        /** called from the worked thread */
+        // caller must hold pendingMutex_ lock.  Returns a pending file no thread is allocating
+        // yet, or an empty string if there is none.
+        std::string nextUnclaimed() const;
+
+        /** called from the worker threads */
         static void run( FileAllocator * fa );
 
         // generate a unique name for temporary files
@@ -97,6 +111,11 @@ namespace mongo {
         std::list< std::string > _pending;
         mutable std::map< std::string, long > _pendingSize;
 
+        // The pending files which a worker thread is allocating right now.
+        std::set< std::string > _allocating;
+
+        long long _lastAllocationMicros;
+
         // unique number for temporary files
         static unsigned long long _uniqueNumber;
 
@@ -0,0 +1,235 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/smart_ptr/scoped_array.hpp>
+
+#include "mongo/util/unordered_fast_key_table.h"
+
+namespace mongo {
+
+    /**
+     * A hash table with the interface of UnorderedFastKeyTable, laid out as an open addressing
+     * table in the style of a Swiss table: alongside the slots, one control byte per slot holds
+     * either the low 7 bits of the hash of the slot's key, or marks it empty or deleted. Slots
+     * come in groups of 16, whose control bytes are compared with the hash of a key at once
+     * (with SSE2 where available), so a lookup usually reads one group of control bytes and
+     * compares a single key.
+     *
+     * The table grows once 7/8 of its slots are used. The hash of each key is stored with it, so
+     * growing doesn't rehash the keys or compare them.
+     */
+    template< typename K_L, // key lookup
+              typename K_S, // key storage
+              typename V, // value
+              typename H , // hash of K_L
+              typename E, // equal of K_L
+              typename C, // convertor from K_S -> K_L
+              typename C_LS=UnorderedFastKeyTable_LS_C<K_L,K_S> // convertor from K_L -> K_S
+              >
+    class GroupedFastKeyTable {
+    public:
+        typedef std::pair<K_S, V> value_type;
+        typedef K_L key_type;
+        typedef V mapped_type;
+
+        static const unsigned kGroupSize = 16;
+
+    private:
+        // Control bytes of the slots which aren't in use. The others hold 7 bits of their hash.
+        static const signed char kEmpty = -128;
+        static const signed char kDeleted = -2;
+
+        struct Slot {
+            Slot() : hash(0) { }
+
+            size_t hash;
+            value_type data;
+        };
+
+        struct Area {
+            explicit Area( unsigned numGroups );
+            Area( const Area& other );
+
+            unsigned capacity() const { return _numGroups * kGroupSize; }
+
+            /**
+             * @return the slot of "key" or -1 if not there
+             */
+            int find( const K_L& key, size_t hash, const GroupedFastKeyTable& sm ) const;
+
+            /**
+             * @return the first slot which is empty or deleted on the probe sequence of "hash"
+             */
+            int findFree( size_t hash ) const;
+
+            void swap( Area* other ) {
+                using std::swap;
+                swap( _numGroups, other->_numGroups );
+                swap( _growthLeft, other->_growthLeft );
+                swap( _control, other->_control );
+                swap( _slots, other->_slots );
+            }
+
+            unsigned _numGroups; // a power of 2
+            unsigned _growthLeft; // the empty slots which can be used before growing
+            boost::scoped_array<signed char> _control;
+            boost::scoped_array<Slot> _slots;
+        };
+
+    public:
+        static const unsigned DEFAULT_STARTING_CAPACITY = kGroupSize;
+
+        /**
+         * @param startingCapacity how many slots should exist on initial creation, rounded up
+         *                         to a power of 2 number of groups
+         */
+        explicit GroupedFastKeyTable( unsigned startingCapacity = DEFAULT_STARTING_CAPACITY );
+
+        GroupedFastKeyTable( const GroupedFastKeyTable& other );
+
+        GroupedFastKeyTable& operator=( const GroupedFastKeyTable& other ) {
+            other.copyTo( this );
+            return *this;
+        }
+
+        void copyTo( GroupedFastKeyTable* out ) const;
+
+        /**
+         * @return number of elements in map
+         */
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        /*
+         * @return storage space
+         */
+        size_t capacity() const { return _area.capacity(); }
+
+        V& operator[]( const K_L& key ) { return get( key ); }
+
+        V& get( const K_L& key );
+
+        /**
+         * @return number of elements removed
+         */
+        size_t erase( const K_L& key );
+
+        class const_iterator {
+            friend class GroupedFastKeyTable;
+
+        public:
+            const_iterator() { _position = -1; }
+            const_iterator( const Area* area ) {
+                _area = area;
+                _position = 0;
+                _max = _area->capacity() - 1;
+                _skip();
+            }
+            const_iterator( const Area* area, int pos ) {
+                _area = area;
+                _position = pos;
+                _max = pos;
+            }
+
+            const value_type* operator->() const { return &_area->_slots[_position].data; }
+
+            const value_type& operator*() const { return _area->_slots[_position].data; }
+
+            const_iterator operator++() {
+                if ( _position < 0 )
+                    return *this;
+                _position++;
+                if ( _position > _max )
+                    _position = -1;
+                else
+                    _skip();
+                return *this;
+            }
+
+            bool operator==( const const_iterator& other ) const {
+                return _position == other._position;
+            }
+            bool operator!=( const const_iterator& other ) const {
+                return _position != other._position;
+            }
+
+        private:
+
+            void _skip() {
+                while ( true ) {
+                    if ( _area->_control[_position] >= 0 )
+                        break;
+                    if ( _position >= _max ) {
+                        _position = -1;
+                        break;
+                    }
+                    ++_position;
+                }
+            }
+
+            const Area* _area;
+            int _position;
+            int _max; // inclusive
+        };
+
+        void erase( const_iterator it );
+
+        /**
+         * @return either a one-shot iterator with the key, or end()
+         */
+        const_iterator find( const K_L& key ) const;
+
+        const_iterator begin() const;
+
+        const_iterator end() const;
+
+    private:
+        void _eraseAt( int pos );
+
+        /**
+         * Moves all the elements to an area of "numGroups" groups, without comparing any keys.
+         */
+        void _rehash( unsigned numGroups );
+
+        // ----
+
+        size_t _size;
+        Area _area;
+
+        H _hash;
+        E _equals;
+        C _convertor;
+        C_LS _convertorOther;
+    };
+
+}
+
+#include "mongo/util/grouped_fast_key_table_internal.h"
@@ -0,0 +1,299 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <cstring>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define MONGO_GROUPED_FAST_KEY_TABLE_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace mongo {
+
+    /**
+     * Matches the control bytes of a group of GroupedFastKeyTable slots, returning a mask with bit
+     * i set for each matching slot i.
+     */
+    struct GroupedFastKeyTableGroup {
+#ifdef MONGO_GROUPED_FAST_KEY_TABLE_USE_SSE2
+        static unsigned match( const signed char* control, signed char h2 ) {
+            const __m128i group = _mm_loadu_si128( reinterpret_cast<const __m128i*>( control ) );
+            return _mm_movemask_epi8( _mm_cmpeq_epi8( group, _mm_set1_epi8( h2 ) ) );
+        }
+
+        static unsigned matchEmpty( const signed char* control ) {
+            return match( control, -128 );
+        }
+
+        /**
+         * The slots which are empty or deleted, the only control bytes with the sign bit set.
+         */
+        static unsigned matchFree( const signed char* control ) {
+            return _mm_movemask_epi8(
+                _mm_loadu_si128( reinterpret_cast<const __m128i*>( control ) ) );
+        }
+#else
+        static unsigned match( const signed char* control, signed char h2 ) {
+            unsigned mask = 0;
+            for ( unsigned i = 0; i < 16; i++ ) {
+                if ( control[i] == h2 )
+                    mask |= 1U << i;
+            }
+            return mask;
+        }
+
+        static unsigned matchEmpty( const signed char* control ) {
+            return match( control, -128 );
+        }
+
+        static unsigned matchFree( const signed char* control ) {
+            unsigned mask = 0;
+            for ( unsigned i = 0; i < 16; i++ ) {
+                if ( control[i] < 0 )
+                    mask |= 1U << i;
+            }
+            return mask;
+        }
+#endif
+    };
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area( unsigned numGroups )
+        : _numGroups( numGroups ),
+          _growthLeft( numGroups * kGroupSize / 8 * 7 ),
+          _control( new signed char[numGroups * kGroupSize] ),
+          _slots( new Slot[numGroups * kGroupSize] ) {
+        memset( _control.get(), kEmpty, capacity() );
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area( const Area& other )
+        : _numGroups( other._numGroups ),
+          _growthLeft( other._growthLeft ),
+          _control( new signed char[other.capacity()] ),
+          _slots( new Slot[other.capacity()] ) {
+        memcpy( _control.get(), other._control.get(), capacity() );
+        for ( unsigned i = 0; i < capacity(); i++ ) {
+            if ( _control[i] >= 0 )
+                _slots[i] = other._slots[i];
+        }
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline int GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::find(
+            const K_L& key,
+            size_t hash,
+            const GroupedFastKeyTable& sm ) const {
+        const signed char h2 = static_cast<signed char>( hash & 0x7f );
+        const unsigned groupMask = _numGroups - 1;
+        unsigned group = static_cast<unsigned>( hash >> 7 ) & groupMask;
+
+        // Triangular steps, which visit every group of a power of 2 number of them.
+        for ( unsigned probe = 1; probe <= _numGroups; probe++ ) {
+            const unsigned first = group * kGroupSize;
+            for ( unsigned matches = GroupedFastKeyTableGroup::match( &_control[first], h2 );
+                  matches;
+                  matches &= matches - 1 ) {
+                const unsigned pos = first + countTrailingZeros64( matches );
+                if ( _slots[pos].hash == hash &&
+                     sm._equals( key, sm._convertor( _slots[pos].data.first ) ) ) {
+                    return pos;
+                }
+            }
+
+            // A key is never placed beyond a group which had an empty slot.
+            if ( GroupedFastKeyTableGroup::matchEmpty( &_control[first] ) )
+                return -1;
+
+            group = ( group + probe ) & groupMask;
+        }
+        return -1;
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline int GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::findFree(
+            size_t hash ) const {
+        const unsigned groupMask = _numGroups - 1;
+        unsigned group = static_cast<unsigned>( hash >> 7 ) & groupMask;
+
+        for ( unsigned probe = 1; probe <= _numGroups; probe++ ) {
+            const unsigned first = group * kGroupSize;
+            const unsigned free = GroupedFastKeyTableGroup::matchFree( &_control[first] );
+            if ( free )
+                return first + countTrailingZeros64( free );
+            group = ( group + probe ) & groupMask;
+        }
+
+        // Can't happen, as the table grows before it is full.
+        verify( false );
+        return -1;
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::GroupedFastKeyTable(
+            unsigned startingCapacity )
+        : _size( 0 ), _area( 1 ) {
+        unsigned numGroups = 1;
+        while ( numGroups * kGroupSize < startingCapacity )
+            numGroups *= 2;
+        if ( numGroups > 1 ) {
+            Area area( numGroups );
+            _area.swap( &area );
+        }
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::GroupedFastKeyTable(
+            const GroupedFastKeyTable& other )
+        : _size( other._size ),
+          _area( other._area ),
+          _hash( other._hash ),
+          _equals( other._equals ),
+          _convertor( other._convertor ),
+          _convertorOther( other._convertorOther ) {
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline void GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::copyTo(
+            GroupedFastKeyTable* out ) const {
+        out->_size = _size;
+        Area x( _area );
+        out->_area.swap( &x );
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline V& GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::get( const K_L& key ) {
+
+        const size_t hash = _hash( key );
+        int pos = _area.find( key, hash, *this );
+        if ( pos >= 0 )
+            return _area._slots[pos].data.second;
+
+        // key not in map
+        // need to add
+        pos = _area.findFree( hash );
+        if ( _area._control[pos] == kEmpty && _area._growthLeft == 0 ) {
+            // Grow, unless enough of the used slots are deleted ones for rehashing in place to
+            // leave plenty of room.
+            const bool mostlyDeleted = _size + 1 <= capacity() / 16 * 7;
+            _rehash( mostlyDeleted ? _area._numGroups : _area._numGroups * 2 );
+            pos = _area.findFree( hash );
+        }
+
+        if ( _area._control[pos] == kEmpty )
+            _area._growthLeft--;
+        _size++;
+        _area._control[pos] = static_cast<signed char>( hash & 0x7f );
+        _area._slots[pos].hash = hash;
+        _area._slots[pos].data.first = _convertorOther( key );
+        return _area._slots[pos].data.second;
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline size_t GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::erase( const K_L& key ) {
+        if ( _size == 0 )
+            return 0;
+
+        int pos = _area.find( key, _hash( key ), *this );
+        if ( pos < 0 )
+            return 0;
+
+        _eraseAt( pos );
+        return 1;
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    void GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::erase( const_iterator it ) {
+        dassert(it._position >= 0);
+        dassert(it._area == &_area);
+
+        _eraseAt( it._position );
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline void GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::_eraseAt( int pos ) {
+        --_size;
+
+        // The slot can be empty again if its group has an empty slot, since then no probe for a
+        // key went on past this group.
+        const unsigned first = pos - pos % kGroupSize;
+        if ( GroupedFastKeyTableGroup::matchEmpty( &_area._control[first] ) ) {
+            _area._control[pos] = kEmpty;
+            _area._growthLeft++;
+        }
+        else {
+            _area._control[pos] = kDeleted;
+        }
+        _area._slots[pos].data.second = V();
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline void GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::_rehash( unsigned numGroups ) {
+        Area newArea( numGroups );
+        for ( unsigned i = 0; i < _area.capacity(); i++ ) {
+            if ( _area._control[i] < 0 )
+                continue;
+
+            Slot& slot = _area._slots[i];
+            const int pos = newArea.findFree( slot.hash );
+            newArea._control[pos] = _area._control[i];
+            newArea._growthLeft--;
+            newArea._slots[pos].hash = slot.hash;
+
+            using std::swap;
+            swap( newArea._slots[pos].data, slot.data );
+        }
+        _area.swap( &newArea );
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline typename GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::find( const K_L& key ) const {
+        if ( _size == 0 )
+            return const_iterator();
+        int pos = _area.find( key, _hash(key), *this );
+        if ( pos < 0 )
+            return const_iterator();
+        return const_iterator( &_area, pos );
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline typename GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::end() const {
+        return const_iterator();
+    }
+
+    template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
+    inline typename GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::const_iterator
+    GroupedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::begin() const {
+        return const_iterator( &_area );
+    }
+}
@@ -0,0 +1,256 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstdio>
+#include <map>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/string_map.h"
+
+namespace {
+    using namespace mongo;
+
+    // Puts every key on the same probe sequence, and into the same group of control bytes.
+    struct CollidingHash {
+        size_t operator()( StringData s ) const {
+            return s.size() % 2;
+        }
+    };
+
+    typedef GroupedFastKeyTable<StringData,
+                                std::string,
+                                int,
+                                CollidingHash,
+                                StringMapDefaultEqual,
+                                StringMapDefaultConvertor,
+                                StringMapDefaultConvertorOther> CollidingMap;
+
+    template <typename Map>
+    void assertMatches( const std::map<std::string, int>& expected, const Map& m ) {
+        ASSERT_EQUALS( expected.size(), m.size() );
+        size_t iterated = 0;
+        for ( typename Map::const_iterator it = m.begin(); it != m.end(); ++it ) {
+            std::map<std::string, int>::const_iterator e = expected.find( it->first );
+            ASSERT( e != expected.end() );
+            ASSERT_EQUALS( e->second, it->second );
+            iterated++;
+        }
+        ASSERT_EQUALS( expected.size(), iterated );
+        for ( std::map<std::string, int>::const_iterator e = expected.begin();
+              e != expected.end();
+              ++e ) {
+            typename Map::const_iterator it = m.find( e->first );
+            ASSERT( it != m.end() );
+            ASSERT_EQUALS( e->second, it->second );
+        }
+    }
+
+    TEST(GroupedFastKeyTableTest, Basic) {
+        GroupedStringMap<int> m;
+        ASSERT_EQUALS( 0U, m.size() );
+        ASSERT_TRUE( m.empty() );
+        ASSERT_TRUE( m.begin() == m.end() );
+        ASSERT_TRUE( m.end() == m.find( "eliot" ) );
+
+        m["eliot"] = 5;
+        ASSERT_EQUALS( 5, m["eliot"] );
+        ASSERT_EQUALS( 1U, m.size() );
+        ASSERT_FALSE( m.empty() );
+
+        GroupedStringMap<int>::const_iterator i = m.find( "eliot" );
+        ASSERT_TRUE( i != m.end() );
+        ASSERT_EQUALS( "eliot", i->first );
+        ASSERT_EQUALS( 5, i->second );
+        ++i;
+        ASSERT_TRUE( i == m.end() );
+    }
+
+    TEST(GroupedFastKeyTableTest, GrowsAtSevenEighths) {
+        GroupedStringMap<int> m;
+        ASSERT_EQUALS( 16U, m.capacity() );
+        char buf[64];
+        for ( int i = 0; i < 14; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        ASSERT_EQUALS( 16U, m.capacity() );
+        m["foo14"] = 14;
+        ASSERT_EQUALS( 32U, m.capacity() );
+
+        for ( int i = 0; i < 15; i++ ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( i, m[buf] );
+        }
+        ASSERT_EQUALS( 15U, m.size() );
+    }
+
+    TEST(GroupedFastKeyTableTest, StartingCapacityIsRoundedUpToGroups) {
+        ASSERT_EQUALS( 16U, GroupedStringMap<int>().capacity() );
+        ASSERT_EQUALS( 16U, CollidingMap( 1 ).capacity() );
+        CollidingMap colliding( 100 );
+        ASSERT_EQUALS( 128U, colliding.capacity() );
+    }
+
+    TEST(GroupedFastKeyTableTest, Big) {
+        GroupedStringMap<int> m;
+        char buf[64];
+
+        for ( int i = 0; i < 100000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        ASSERT_EQUALS( 100000U, m.size() );
+        ASSERT_LESS_THAN_OR_EQUALS( m.capacity(), 256U * 1024 );
+
+        for ( int i = 0; i < 100000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( i, m[buf] );
+        }
+        ASSERT_EQUALS( 100000U, m.size() );
+    }
+
+    TEST(GroupedFastKeyTableTest, EraseReusesSlots) {
+        GroupedStringMap<int> m;
+        char buf[64];
+
+        m["eliot"] = 5;
+        ASSERT_EQUALS( 1U, m.erase( "eliot" ) );
+        ASSERT( m.end() == m.find( "eliot" ) );
+        ASSERT_EQUALS( 0U, m.erase( "eliot" ) );
+        ASSERT_EQUALS( 0, m["eliot"] );
+        ASSERT_EQUALS( 1U, m.size() );
+
+        size_t before = m.capacity();
+        for ( int i = 0; i < 10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+            ASSERT_EQUALS( i, m[buf] );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+            ASSERT( m.end() == m.find( buf ) );
+        }
+        ASSERT_EQUALS( before, m.capacity() );
+
+        GroupedStringMap<int>::const_iterator i = m.find( "eliot" );
+        m.erase( i );
+        ASSERT_TRUE( m.empty() );
+    }
+
+    TEST(GroupedFastKeyTableTest, DeletedSlotsAreRehashedAway) {
+        // Colliding keys fill the groups in order, so erasing from a full group leaves deleted
+        // slots rather than empty ones.
+        CollidingMap m;
+        char buf[64];
+        for ( int i = 0; i < 14; i++ ) {
+            sprintf( buf, "k%02d", i );
+            m[buf] = i;
+        }
+        const size_t before = m.capacity();
+        for ( int round = 0; round < 100; round++ ) {
+            sprintf( buf, "k%02d", round % 14 );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+            sprintf( buf, "r%03d", round );
+            m[buf] = round;
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+            sprintf( buf, "k%02d", round % 14 );
+            m[buf] = round % 14;
+        }
+        ASSERT_EQUALS( 14U, m.size() );
+        ASSERT_EQUALS( before, m.capacity() );
+        for ( int i = 0; i < 14; i++ ) {
+            sprintf( buf, "k%02d", i );
+            ASSERT( m.find( buf ) != m.end() );
+        }
+    }
+
+    TEST(GroupedFastKeyTableTest, CollidingHashes) {
+        CollidingMap m;
+        std::map<std::string, int> expected;
+        char buf[64];
+        for ( int i = 0; i < 500; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+            expected[buf] = i;
+        }
+        assertMatches( expected, m );
+
+        for ( int i = 0; i < 500; i += 3 ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+            expected.erase( buf );
+        }
+        assertMatches( expected, m );
+    }
+
+    TEST(GroupedFastKeyTableTest, RandomOperationsMatchStdMap) {
+        PseudoRandom random( 17 );
+        GroupedStringMap<int> m;
+        std::map<std::string, int> expected;
+        char buf[64];
+
+        for ( int i = 0; i < 50000; i++ ) {
+            sprintf( buf, "key%d", random.nextInt32( 2000 ) );
+            switch ( random.nextInt32( 3 ) ) {
+            case 0:
+                m[buf] = i;
+                expected[buf] = i;
+                break;
+            case 1:
+                ASSERT_EQUALS( expected.erase( buf ), m.erase( buf ) );
+                break;
+            case 2:
+                ASSERT_EQUALS( expected.count( buf ) != 0, m.find( buf ) != m.end() );
+                break;
+            }
+        }
+        assertMatches( expected, m );
+    }
+
+    TEST(GroupedFastKeyTableTest, CopyAndAssign) {
+        GroupedStringMap<int> m;
+        char buf[64];
+        for ( int i = 0; i < 100; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+
+        GroupedStringMap<int> y = m;
+        ASSERT_EQUALS( 100U, y.size() );
+        m["foo1"] = -1;
+        ASSERT_EQUALS( 1, y["foo1"] );
+
+        GroupedStringMap<int> z;
+        z["eliot"] = 6;
+        z = m;
+        ASSERT_EQUALS( 100U, z.size() );
+        ASSERT_EQUALS( -1, z["foo1"] );
+        ASSERT( z.end() == z.find( "eliot" ) );
+    }
+}
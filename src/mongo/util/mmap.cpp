@@ -211,6 +211,48 @@ namespace {
         return thingsToFlush.size();
     }
 
+    /*static*/ unsigned long long MongoFile::writebackNext( WritebackCursor* cursor,
+                                                            unsigned long long maxBytes,
+                                                            bool* passCompleted ) {
+        *passCompleted = false;
+
+        LockMongoFilesShared lk;
+        if ( mmfiles.empty() )
+            return 0;
+
+        if ( cursor->file >= mmfiles.size() ) {
+            // files were closed since the last call
+            *cursor = WritebackCursor();
+        }
+        set<MongoFile*>::iterator i = mmfiles.begin();
+        std::advance( i, cursor->file );
+
+        unsigned long long covered = 0;
+        size_t filesVisited = 0;
+        while ( covered < maxBytes && filesVisited <= mmfiles.size() ) {
+            MongoFile* mmf = *i;
+            const unsigned long long len = mmf->length();
+            if ( cursor->offset < len ) {
+                const unsigned long long n = std::min( maxBytes - covered, len - cursor->offset );
+                mmf->startWriteback( cursor->offset, n );
+                cursor->offset += n;
+                covered += n;
+            }
+
+            if ( cursor->offset >= len ) {
+                filesVisited++;
+                cursor->offset = 0;
+                cursor->file++;
+                if ( ++i == mmfiles.end() ) {
+                    i = mmfiles.begin();
+                    cursor->file = 0;
+                    *passCompleted = true;
+                }
+            }
+        }
+        return covered;
+    }
+
     void MongoFile::created() {
         LockMongoFilesExclusive lk;
         mmfiles.insert(this);
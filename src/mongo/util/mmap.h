@@ -53,6 +53,12 @@ namespace mongo {
         enum Advice { Sequential=1 , Random=2 };
         MAdvise(void *p, unsigned len, Advice a);
         ~MAdvise(); // destructor resets the range to MADV_NORMAL
+
+        /**
+         * Asks the OS to start reading [p, p + len) in from disk (MADV_WILLNEED), without
+         * waiting for it. Does nothing on platforms without such a hint.
+         */
+        static void willNeed(void *p, unsigned len);
     private:
         void *_p;
         unsigned _len;
@@ -122,6 +128,23 @@ namespace mongo {
 
         static int flushAll( bool sync ); // returns n flushed
         static long long totalMappedLength();
+
+        /** position of an incremental writeback of all files, see writebackNext */
+        struct WritebackCursor {
+            WritebackCursor() : file(0), offset(0) { }
+            size_t file;                // index into getAllFiles()
+            unsigned long long offset;  // in that file
+        };
+
+        /** starts writing back the dirty pages of up to maxBytes of the files from cursor on,
+            without waiting for the writes, going round the files in turn, and advances cursor.
+            maxBytes should be a multiple of the page size.
+            @param passCompleted set if this went past the end of the last file
+            @return bytes covered, clean or dirty
+        */
+        static unsigned long long writebackNext( WritebackCursor* cursor,
+                                                 unsigned long long maxBytes,
+                                                 bool* passCompleted );
         static void closeAllFiles( std::stringstream &message );
 
         virtual bool isDurableMappedFile() { return false; }
@@ -143,6 +166,11 @@ namespace mongo {
          */
         virtual Flushable * prepareFlush() = 0;
 
+        /** starts writing back the dirty pages of len bytes at offset, a multiple of the page
+            size, without waiting for them.  called with the files locked in shared mode.
+        */
+        virtual void startWriteback(unsigned long long offset, unsigned long long len) { }
+
         void created(); /* subclass must call after create */
 
         /* subclass must call in destructor (or at close).
@@ -213,6 +241,7 @@ namespace mongo {
 
         void flush(bool sync);
         virtual Flushable * prepareFlush();
+        virtual void startWriteback(unsigned long long offset, unsigned long long len);
 
         long shortLength() const          { return (long) len; }
         unsigned long long length() const { return len; }
@@ -248,6 +277,12 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+#ifndef _WIN32
+        /** replaces rangeLen bytes of the private view at oldPrivateAddr from offset on, which
+            must be a multiple of the page size, with a fresh mapping of that part of the file */
+        void remapPrivateViewRange(void *oldPrivateAddr, size_t offset, size_t rangeLen);
+#endif
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
@@ -127,6 +127,7 @@ namespace mongo {
 #if defined(__sun)
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
+    void MAdvise::willNeed(void *, unsigned) { }
 #else
     MAdvise::MAdvise(void *p, unsigned len, Advice a) {
 
@@ -153,6 +154,16 @@ namespace mongo {
     MAdvise::~MAdvise() {
         madvise(_p,_len,MADV_NORMAL);
     }
+
+    void MAdvise::willNeed(void *p, unsigned len) {
+        void* start = _pageAlign( p );
+        len += static_cast<unsigned>( reinterpret_cast<size_t>(p) -
+                                      reinterpret_cast<size_t>(start) );
+
+        if ( madvise( start, len, MADV_WILLNEED ) ) {
+            LOG(1) << "madvise(MADV_WILLNEED) failed: " << errnoWithDescription();
+        }
+    }
 #endif
 
     void* MemoryMappedFile::map(const char *filename, unsigned long long &length, int options) {
@@ -255,6 +266,27 @@ namespace mongo {
         return x;
     }
 
+    void MemoryMappedFile::remapPrivateViewRange(void *oldPrivateAddr,
+                                                 size_t offset,
+                                                 size_t rangeLen) {
+#if defined(__sun) // SERVER-8795
+        LockMongoFilesExclusive lockMongoFiles;
+#endif
+        verify( offset + rangeLen <= len );
+
+        char* const addr = static_cast<char*>(oldPrivateAddr) + offset;
+        void * x = mmap( addr, rangeLen, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED, fd,
+                         offset );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == addr );
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
@@ -319,6 +351,25 @@ namespace mongo {
         return new PosixFlushable( this, viewForFlushing(), fd, len);
     }
 
+    void MemoryMappedFile::startWriteback(unsigned long long offset, unsigned long long rangeLen) {
+        if ( views.empty() || fd == 0 )
+            return;
+        verify( offset + rangeLen <= len );
+
+#if defined(__linux__)
+        // msync with MS_ASYNC doesn't start any writes on linux, while this does without
+        // waiting for them, unless the device's request queue is full.
+        if ( sync_file_range( fd, offset, rangeLen, SYNC_FILE_RANGE_WRITE ) == 0 )
+            return;
+#else
+        if ( msync( static_cast<char*>(viewForFlushing()) + offset, rangeLen, MS_ASYNC ) == 0 )
+            return;
+#endif
+        // not fatal, the next full flush will report a failing file
+        LOG(1) << "starting writeback of " << filename() << " failed: "
+               << errnoWithDescription();
+    }
+
 
 } // namespace mongo
 
@@ -73,6 +73,7 @@ namespace mongo {
 
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
+    void MAdvise::willNeed(void *, unsigned) { }
 
     const unsigned long long memoryMappedFileLocationFloor = 256LL * 1024LL * 1024LL * 1024LL;
     static unsigned long long _nextMemoryMappedFileLocation = memoryMappedFileLocationFloor;
@@ -536,4 +537,19 @@ namespace mongo {
                                     filename(), _flushMutex);
     }
 
+    void MemoryMappedFile::startWriteback(unsigned long long offset, unsigned long long rangeLen) {
+        void* view = viewForFlushing();
+        if ( !view || !fd )
+            return;
+        verify( offset + rangeLen <= len );
+
+        // Without FlushFileBuffers this only starts the writes.  A lock violation just means
+        // the range is left to the next full flush.
+        if ( !FlushViewOfFile( static_cast<char*>(view) + offset, static_cast<SIZE_T>(rangeLen) ) ) {
+            DWORD dosError = GetLastError();
+            LOG(1) << "starting writeback of " << filename() << " failed: "
+                   << errnoWithDescription( dosError );
+        }
+    }
+
 }
@@ -36,6 +36,7 @@
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/encoded_value_storage.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/hostandport.h"
@@ -67,6 +68,7 @@ namespace mongo {
         dbKillCursors = 2007,
         dbCommand = 2008,
         dbCommandReply = 2009,
+        dbCompressed = 2012, /* another message, compressed. see MessagingPort::setCompressor() */
     };
 
     bool doesOpGetAResponse( int op );
@@ -82,6 +84,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -355,6 +358,9 @@ namespace mongo {
 
         bool empty() const { return !_buf && _data.empty(); }
 
+        // true if the whole message is in one buffer, see singleData()
+        bool isSingleBuffer() const { return _buf; }
+
         int size() const {
             int res = 0;
             if ( _buf ) {
@@ -383,7 +389,7 @@ namespace mongo {
                  i != _data.end(); ++i) {
                 totalSize += i->second;
             }
-            char *buf = (char*)mongoMalloc( totalSize );
+            char *buf = (char*)BufferPool::allocate( totalSize );
             char *p = buf;
             for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
                  i != _data.end(); ++i) {
@@ -411,11 +417,11 @@ namespace mongo {
         void reset() {
             if ( _freeIt ) {
                 if ( _buf ) {
-                    free( _buf );
+                    BufferPool::release(_buf, MsgData::ConstView(_buf).getLen());
                 }
                 for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
                      i != _data.end(); ++i) {
-                    free(i->first);
+                    BufferPool::release(i->first, i->second);
                 }
             }
             _buf = 0;
@@ -455,7 +461,7 @@ namespace mongo {
         void setData(int operation, const char *msgdata, size_t len) {
             verify( empty() );
             size_t dataLen = len + sizeof(MsgData::Value) - 4;
-            MsgData::View d = reinterpret_cast<char *>(mongoMalloc(dataLen));
+            MsgData::View d = reinterpret_cast<char *>(BufferPool::allocate(dataLen));
             memcpy(d.data(), msgdata, len);
             d.setLen(dataLen);
             d.setOperation(operation);
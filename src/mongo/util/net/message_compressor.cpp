@@ -0,0 +1,241 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+
+#include "mongo/base/string_data.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/compress.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/text.h"
+
+namespace mongo {
+
+namespace {
+
+    const char kDisabled[] = "disabled";
+
+    const char kCompressionField[] = "compression";
+
+    class SnappyMessageCompressor : public MessageCompressor {
+    public:
+        SnappyMessageCompressor() : MessageCompressor("snappy", 1) {}
+
+    private:
+        virtual void _compress(const char* input, size_t inputLength, std::string* output) {
+            mongo::compress(input, inputLength, output);
+        }
+
+        virtual bool _decompress(const char* input, size_t inputLength, std::string* output) {
+            return mongo::uncompress(input, inputLength, output);
+        }
+    };
+
+}  // namespace
+
+    MessageCompressor::MessageCompressor(StringData name, uint8_t id)
+        : _name(name.toString()),
+          _id(id) {
+    }
+
+    void MessageCompressor::compress(const char* input, size_t inputLength, std::string* output) {
+        _compress(input, inputLength, output);
+        _compressorBytesIn.fetchAndAdd(inputLength);
+        _compressorBytesOut.fetchAndAdd(output->size());
+    }
+
+    bool MessageCompressor::decompress(const char* input,
+                                       size_t inputLength,
+                                       std::string* output) {
+        if (!_decompress(input, inputLength, output)) {
+            return false;
+        }
+        _decompressorBytesIn.fetchAndAdd(inputLength);
+        _decompressorBytesOut.fetchAndAdd(output->size());
+        return true;
+    }
+
+    // static
+    MessageCompressorRegistry& MessageCompressorRegistry::get() {
+        static MessageCompressorRegistry* registry = new MessageCompressorRegistry();
+        return *registry;
+    }
+
+    MessageCompressorRegistry::MessageCompressorRegistry() {
+        registerCompressor(std::unique_ptr<MessageCompressor>(new SnappyMessageCompressor()));
+    }
+
+    void MessageCompressorRegistry::registerCompressor(
+            std::unique_ptr<MessageCompressor> compressor) {
+        invariant(!findByName(compressor->getName()));
+        invariant(!findById(compressor->getId()));
+        _all.push_back(compressor.release());
+    }
+
+    Status MessageCompressorRegistry::setEnabled(StringData names) {
+        std::vector<MessageCompressor*> enabled;
+        if (!names.empty() && names != kDisabled) {
+            std::vector<std::string> split = StringSplitter::split(names.toString(), ",");
+            for (size_t i = 0; i < split.size(); i++) {
+                MessageCompressor* compressor = findByName(split[i]);
+                if (!compressor) {
+                    return Status(ErrorCodes::BadValue,
+                                  str::stream() << "Unknown message compressor: " << split[i]);
+                }
+                enabled.push_back(compressor);
+            }
+        }
+        _enabled.swap(enabled);
+        return Status::OK();
+    }
+
+    MessageCompressor* MessageCompressorRegistry::chooseEnabled(
+            const std::vector<std::string>& requested) const {
+        for (size_t i = 0; i < requested.size(); i++) {
+            for (size_t j = 0; j < _enabled.size(); j++) {
+                if (_enabled[j]->getName() == requested[i]) {
+                    return _enabled[j];
+                }
+            }
+        }
+        return NULL;
+    }
+
+    MessageCompressor* MessageCompressorRegistry::findByName(StringData name) const {
+        for (size_t i = 0; i < _all.size(); i++) {
+            if (_all[i]->getName() == name) {
+                return _all[i];
+            }
+        }
+        return NULL;
+    }
+
+    MessageCompressor* MessageCompressorRegistry::findById(uint8_t id) const {
+        for (size_t i = 0; i < _all.size(); i++) {
+            if (_all[i]->getId() == id) {
+                return _all[i];
+            }
+        }
+        return NULL;
+    }
+
+    void MessageCompressorRegistry::appendStats(BSONObjBuilder* b) const {
+        for (size_t i = 0; i < _all.size(); i++) {
+            const MessageCompressor* compressor = _all[i];
+            BSONObjBuilder compressorBuilder(b->subobjStart(compressor->getName()));
+            {
+                BSONObjBuilder sub(compressorBuilder.subobjStart("compressor"));
+                sub.appendNumber("bytesIn", compressor->getCompressorBytesIn());
+                sub.appendNumber("bytesOut", compressor->getCompressorBytesOut());
+            }
+            {
+                BSONObjBuilder sub(compressorBuilder.subobjStart("decompressor"));
+                sub.appendNumber("bytesIn", compressor->getDecompressorBytesIn());
+                sub.appendNumber("bytesOut", compressor->getDecompressorBytesOut());
+            }
+        }
+    }
+
+    void appendMessageCompressionRequest(BSONObjBuilder* cmd) {
+        const std::vector<MessageCompressor*>& enabled =
+            MessageCompressorRegistry::get().getEnabled();
+        if (enabled.empty()) {
+            return;
+        }
+
+        BSONArrayBuilder names(cmd->subarrayStart(kCompressionField));
+        for (size_t i = 0; i < enabled.size(); i++) {
+            names.append(enabled[i]->getName());
+        }
+        names.doneFast();
+    }
+
+    void negotiateMessageCompression(const BSONObj& cmd,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* reply) {
+        BSONElement requestedElt = cmd[kCompressionField];
+        if (requestedElt.type() != Array) {
+            return;
+        }
+
+        // Only real network connections can compress.
+        MessagingPort* messagingPort = dynamic_cast<MessagingPort*>(port);
+        if (!messagingPort) {
+            return;
+        }
+
+        std::vector<std::string> requested;
+        BSONForEach(nameElt, requestedElt.Obj()) {
+            if (nameElt.type() == String) {
+                requested.push_back(nameElt.String());
+            }
+        }
+
+        MessageCompressor* compressor =
+            MessageCompressorRegistry::get().chooseEnabled(requested);
+        if (!compressor) {
+            return;
+        }
+
+        messagingPort->setCompressor(compressor);
+
+        BSONArrayBuilder names(reply->subarrayStart(kCompressionField));
+        names.append(compressor->getName());
+        names.doneFast();
+    }
+
+    void applyMessageCompressionReply(const BSONObj& reply, MessagingPort* port) {
+        BSONElement chosenElt = reply[kCompressionField];
+        if (chosenElt.type() != Array) {
+            return;
+        }
+
+        BSONElement nameElt = chosenElt.Obj().firstElement();
+        if (nameElt.type() != String) {
+            return;
+        }
+
+        // Only accept what this side offered.
+        MessageCompressor* compressor =
+            MessageCompressorRegistry::get().findByName(nameElt.valueStringData());
+        const std::vector<MessageCompressor*>& enabled =
+            MessageCompressorRegistry::get().getEnabled();
+        if (std::find(enabled.begin(), enabled.end(), compressor) == enabled.end()) {
+            return;
+        }
+
+        port->setCompressor(compressor);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,183 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class AbstractMessagingPort;
+    class BSONObj;
+    class BSONObjBuilder;
+    class MessagingPort;
+
+    /**
+     * Compresses and decompresses the bodies of wire protocol messages. A MessagingPort uses one
+     * once it has been negotiated for the connection; see MessagingPort::setCompressor().
+     *
+     * Keeps counts of the bytes that went in and came out of it in each direction.
+     */
+    class MessageCompressor {
+        MONGO_DISALLOW_COPYING(MessageCompressor);
+    public:
+        virtual ~MessageCompressor() {}
+
+        /**
+         * The name used to negotiate this compressor in isMaster.
+         */
+        const std::string& getName() const { return _name; }
+
+        /**
+         * The id identifying this compressor in compressed messages.
+         */
+        uint8_t getId() const { return _id; }
+
+        /**
+         * Replaces "*output" with the compressed form of the "inputLength" bytes at "input".
+         */
+        void compress(const char* input, size_t inputLength, std::string* output);
+
+        /**
+         * Replaces "*output" with the decompressed form of the "inputLength" bytes at "input".
+         * Returns false if they are not validly compressed.
+         */
+        bool decompress(const char* input, size_t inputLength, std::string* output);
+
+        long long getCompressorBytesIn() const { return _compressorBytesIn.loadRelaxed(); }
+        long long getCompressorBytesOut() const { return _compressorBytesOut.loadRelaxed(); }
+        long long getDecompressorBytesIn() const { return _decompressorBytesIn.loadRelaxed(); }
+        long long getDecompressorBytesOut() const { return _decompressorBytesOut.loadRelaxed(); }
+
+    protected:
+        MessageCompressor(StringData name, uint8_t id);
+
+    private:
+        virtual void _compress(const char* input, size_t inputLength, std::string* output) = 0;
+        virtual bool _decompress(const char* input, size_t inputLength, std::string* output) = 0;
+
+        const std::string _name;
+        const uint8_t _id;
+
+        AtomicInt64 _compressorBytesIn;
+        AtomicInt64 _compressorBytesOut;
+        AtomicInt64 _decompressorBytesIn;
+        AtomicInt64 _decompressorBytesOut;
+    };
+
+    /**
+     * Holds the available MessageCompressors and which of them this process offers and accepts.
+     *
+     * Compressors are registered and enabled during startup and never removed, so lookups need
+     * no locking. Compressed messages are decompressed with any registered compressor, whether or
+     * not it is enabled.
+     */
+    class MessageCompressorRegistry {
+        MONGO_DISALLOW_COPYING(MessageCompressorRegistry);
+    public:
+        /**
+         * The registry, with the built-in compressors registered and none enabled.
+         */
+        static MessageCompressorRegistry& get();
+
+        /**
+         * Makes "compressor" available. Its name and id must be unique.
+         */
+        void registerCompressor(std::unique_ptr<MessageCompressor> compressor);
+
+        /**
+         * Enables the comma separated list of compressors "names", in order of preference, or
+         * none if "names" is "disabled" or empty. Fails if any of them is not registered.
+         */
+        Status setEnabled(StringData names);
+
+        /**
+         * The enabled compressors, in order of preference.
+         */
+        const std::vector<MessageCompressor*>& getEnabled() const { return _enabled; }
+
+        /**
+         * Returns the first of "requested" that is enabled here, or NULL if none is.
+         */
+        MessageCompressor* chooseEnabled(const std::vector<std::string>& requested) const;
+
+        MessageCompressor* findByName(StringData name) const;
+        MessageCompressor* findById(uint8_t id) const;
+
+        const std::vector<MessageCompressor*>& getAll() const { return _all; }
+
+        /**
+         * Appends the byte counters of every registered compressor, as
+         * { <name>: { compressor: { bytesIn, bytesOut }, decompressor: { bytesIn, bytesOut } } }.
+         */
+        void appendStats(BSONObjBuilder* b) const;
+
+    private:
+        MessageCompressorRegistry();
+
+        // Owned; never deleted.
+        std::vector<MessageCompressor*> _all;
+        std::vector<MessageCompressor*> _enabled;
+    };
+
+    /**
+     * Compression is negotiated in the isMaster a client runs right after connecting. The client
+     * lists the compressors it has enabled, in order of preference, as "compression" in the
+     * command. The server picks the first of them it has enabled too, starts compressing what it
+     * sends on that connection and names it in "compression" in its reply. The client then does
+     * the same. Peers that don't know about compression ignore the field, so nothing changes.
+     */
+
+    /**
+     * Appends the client's list of compressors to the isMaster command being built in "cmd", if
+     * any is enabled.
+     */
+    void appendMessageCompressionRequest(BSONObjBuilder* cmd);
+
+    /**
+     * Handles the compression request in the isMaster command "cmd", if there is one, for the
+     * connection "port", and appends the chosen compressor to "reply".
+     */
+    void negotiateMessageCompression(const BSONObj& cmd,
+                                     AbstractMessagingPort* port,
+                                     BSONObjBuilder* reply);
+
+    /**
+     * Starts compressing on "port" with the compressor named in the isMaster reply "reply", if it
+     * names one.
+     */
+    void applyMessageCompressionReply(const BSONObj& reply, MessagingPort* port);
+
+}  // namespace mongo
@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2014 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+    MessageCompressor* getSnappy() {
+        MessageCompressor* snappy = MessageCompressorRegistry::get().findByName("snappy");
+        ASSERT(snappy);
+        return snappy;
+    }
+
+    TEST(MessageCompressor, SnappyRoundTrip) {
+        MessageCompressor* snappy = getSnappy();
+        ASSERT_EQUALS(snappy, MessageCompressorRegistry::get().findById(snappy->getId()));
+
+        const std::string input(4096, 'x');
+        const long long bytesInBefore = snappy->getCompressorBytesIn();
+
+        std::string compressed;
+        snappy->compress(input.data(), input.size(), &compressed);
+        ASSERT_LESS_THAN(compressed.size(), input.size());
+        ASSERT_EQUALS(bytesInBefore + static_cast<long long>(input.size()),
+                      snappy->getCompressorBytesIn());
+
+        std::string output;
+        ASSERT(snappy->decompress(compressed.data(), compressed.size(), &output));
+        ASSERT_EQUALS(input, output);
+    }
+
+    TEST(MessageCompressor, SnappyRejectsGarbage) {
+        const std::string garbage(64, '\xff');
+        std::string output;
+        ASSERT_FALSE(getSnappy()->decompress(garbage.data(), garbage.size(), &output));
+    }
+
+    TEST(MessageCompressorRegistry, SetEnabled) {
+        MessageCompressorRegistry& registry = MessageCompressorRegistry::get();
+
+        ASSERT_OK(registry.setEnabled("snappy"));
+        ASSERT_EQUALS(1U, registry.getEnabled().size());
+        ASSERT_EQUALS(getSnappy(), registry.getEnabled()[0]);
+
+        ASSERT_NOT_OK(registry.setEnabled("snappy,bogus"));
+
+        ASSERT_OK(registry.setEnabled("disabled"));
+        ASSERT(registry.getEnabled().empty());
+    }
+
+    TEST(MessageCompressorRegistry, ChooseEnabled) {
+        MessageCompressorRegistry& registry = MessageCompressorRegistry::get();
+
+        std::vector<std::string> requested;
+        requested.push_back("bogus");
+        requested.push_back("snappy");
+
+        ASSERT(!registry.chooseEnabled(requested));
+
+        ASSERT_OK(registry.setEnabled("snappy"));
+        ASSERT_EQUALS(getSnappy(), registry.chooseEnabled(requested));
+
+        // The reply names the compressor that was picked.
+        BSONObjBuilder cmd;
+        appendMessageCompressionRequest(&cmd);
+        ASSERT_EQUALS(BSON("compression" << BSON_ARRAY("snappy")), cmd.obj());
+
+        ASSERT_OK(registry.setEnabled("disabled"));
+        ASSERT(!registry.chooseEnabled(requested));
+    }
+
+}  // namespace
+}  // namespace mongo
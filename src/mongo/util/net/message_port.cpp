@@ -37,12 +37,15 @@
 #include <fcntl.h>
 #include <time.h>
 
+#include "mongo/base/data_view.h"
+#include "mongo/bson/util/buffer_pool.h"
 #include "mongo/config.h"
 #include "mongo/util/allocator.h"
 #include "mongo/util/background.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/net/ssl_options.h"
 #include "mongo/util/scopeguard.h"
@@ -144,18 +147,18 @@ namespace mongo {
     }
 
     MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
-        : psock( new Socket( fd , remote ) ) , piggyBackData(0) {
+        : psock( new Socket( fd , remote ) ) , piggyBackData(0), _compressor(NULL) {
         ports.insert(this);
     }
 
     MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll ) 
-        : psock( new Socket( timeout, ll ) ) {
+        : psock( new Socket( timeout, ll ) ), _compressor(NULL) {
         ports.insert(this);
         piggyBackData = 0;
     }
 
     MessagingPort::MessagingPort( boost::shared_ptr<Socket> sock )
-        : psock( sock ), piggyBackData( 0 ) {
+        : psock( sock ), piggyBackData( 0 ), _compressor(NULL) {
         ports.insert(this);
     }
 
@@ -233,7 +236,7 @@ again:
             psock->setHandshakeReceived();
             int z = (len+1023)&0xfffffc00;
             verify(z>=len);
-            MsgData::View md = reinterpret_cast<char *>(mongoMalloc(z));
+            MsgData::View md = reinterpret_cast<char *>(BufferPool::allocate(z));
             ScopeGuard guard = MakeGuard(free, md.view2ptr());
             verify(md.view2ptr());
 
@@ -244,6 +247,11 @@ again:
 
             guard.Dismiss();
             m.setData(md.view2ptr(), true);
+
+            if (md.getOperation() == dbCompressed && !_decompress(m)) {
+                m.reset();
+                return false;
+            }
             return true;
 
         }
@@ -316,9 +324,111 @@ again:
             }
         }
 
+        Message compressed;
+        if ( _compressor && _compress( toSend, &compressed ) ) {
+            compressed.send( *this, "say" );
+            return;
+        }
+
         toSend.send( *this, "say" );
     }
 
+namespace {
+
+    // Smaller messages are sent as they are, since compressing them gains little if anything.
+    const int kMinCompressibleMessageBytes = 256;
+
+    // The original operation and body size, and the compressor id, in front of compressed bodies.
+    const int kCompressedPrefixBytes = 4 + 4 + 1;
+
+}  // namespace
+
+    bool MessagingPort::_compress(Message& toSend, Message* compressed) {
+        if ( toSend.header().getLen() < kMinCompressibleMessageBytes ) {
+            return false;
+        }
+
+        if ( toSend.doIFreeIt() ) {
+            toSend.concat();
+        }
+        if ( !toSend.isSingleBuffer() ) {
+            return false;
+        }
+
+        const MsgData::View original = toSend.singleData();
+        const int originalBodyLen = original.getLen() - sizeof(MSGHEADER::Value);
+
+        std::string body;
+        _compressor->compress( original.data(), originalBodyLen, &body );
+
+        const size_t len = sizeof(MSGHEADER::Value) + kCompressedPrefixBytes + body.size();
+        if ( len >= static_cast<size_t>(original.getLen()) ) {
+            return false;
+        }
+
+        MsgData::View md = reinterpret_cast<char *>(mongoMalloc(len));
+        md.setLen(len);
+        md.setId(original.getId());
+        md.setResponseTo(original.getResponseTo());
+        md.setOperation(dbCompressed);
+
+        DataView prefix(md.data());
+        prefix.write(tagLittleEndian<int32_t>(original.getOperation()), 0);
+        prefix.write(tagLittleEndian<int32_t>(originalBodyLen), 4);
+        prefix.write(_compressor->getId(), 8);
+        memcpy( md.data() + kCompressedPrefixBytes, body.data(), body.size() );
+
+        compressed->setData(md.view2ptr(), true);
+        return true;
+    }
+
+    bool MessagingPort::_decompress(Message& m) {
+        const MsgData::View md = m.singleData();
+        const int bodyLen = md.getLen() - sizeof(MSGHEADER::Value);
+        if ( bodyLen < kCompressedPrefixBytes ) {
+            LOG(0) << "recv(): compressed message len " << md.getLen() << " is invalid";
+            return false;
+        }
+
+        const ConstDataView prefix(md.data());
+        const int32_t operation = prefix.read<LittleEndian<int32_t>>();
+        const int32_t originalBodyLen = prefix.read<LittleEndian<int32_t>>(4);
+        const uint8_t compressorId = prefix.read<uint8_t>(8);
+
+        MessageCompressor* compressor = MessageCompressorRegistry::get().findById(compressorId);
+        if ( !compressor ) {
+            LOG(0) << "recv(): unknown message compressor " << static_cast<int>(compressorId);
+            return false;
+        }
+
+        const size_t len = sizeof(MSGHEADER::Value) + originalBodyLen;
+        if ( originalBodyLen < 0 || len > MaxMessageSizeBytes ) {
+            LOG(0) << "recv(): decompressed message len " << len << " is invalid. "
+                   << "Max: " << MaxMessageSizeBytes;
+            return false;
+        }
+
+        std::string body;
+        if ( !compressor->decompress( md.data() + kCompressedPrefixBytes,
+                                      bodyLen - kCompressedPrefixBytes,
+                                      &body ) ||
+             body.size() != static_cast<size_t>(originalBodyLen) ) {
+            LOG(0) << "recv(): could not decompress message with " << compressor->getName();
+            return false;
+        }
+
+        MsgData::View decompressed = reinterpret_cast<char *>(mongoMalloc(len));
+        decompressed.setLen(len);
+        decompressed.setId(md.getId());
+        decompressed.setResponseTo(md.getResponseTo());
+        decompressed.setOperation(operation);
+        memcpy( decompressed.data(), body.data(), body.size() );
+
+        m.reset();
+        m.setData(decompressed.view2ptr(), true);
+        return true;
+    }
+
     void MessagingPort::piggyBack( Message& toSend , int responseTo ) {
 
         if ( toSend.header().getLen() > 1300 ) {
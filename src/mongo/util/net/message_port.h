@@ -39,6 +39,7 @@
 
 namespace mongo {
 
+    class MessageCompressor;
     class MessagingPort;
     class PiggyBackData;
 
@@ -117,6 +118,19 @@ namespace mongo {
 
         void piggyBack( Message& toSend , int responseTo = 0 );
 
+        /**
+         * Compresses the messages sent from now on with "compressor", which is not owned. NULL
+         * stops compressing. Only for compressors both ends have agreed on, see
+         * MessageCompressorRegistry.
+         *
+         * A compressed message has operation dbCompressed and keeps the id and responseTo of the
+         * original one. Its body is the original operation (int32), the size of the original body
+         * (int32), the compressor id (uint8) and the compressed original body. recv() always
+         * decompresses such messages, whether or not a compressor was set.
+         */
+        void setCompressor(MessageCompressor* compressor) { _compressor = compressor; }
+        MessageCompressor* getCompressor() const { return _compressor; }
+
         unsigned remotePort() const { return psock->remotePort(); }
         virtual HostAndPort remote() const;
         virtual SockAddr remoteAddr() const;
@@ -155,9 +169,23 @@ namespace mongo {
         }
 
     private:
-        
+        /**
+         * Sets "*compressed" to "toSend" compressed with _compressor. Returns false, leaving
+         * "*compressed" empty, if it is not worth compressing.
+         */
+        bool _compress(Message& toSend, Message* compressed);
+
+        /**
+         * Replaces the dbCompressed message "m" with the message it holds. Returns false if "m"
+         * is invalid.
+         */
+        bool _decompress(Message& m);
+
         PiggyBackData * piggyBackData;
 
+        // Not owned. See setCompressor().
+        MessageCompressor* _compressor;
+
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
         mutable HostAndPort _remoteParsed; 
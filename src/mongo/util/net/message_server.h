@@ -36,10 +36,23 @@
 
 #include "mongo/platform/basic.h"
 
+#include <memory>
+
 namespace mongo {
 
+    class AbstractMessagingPort;
+    class Message;
+
     class MessageHandler {
     public:
+        /**
+         * Opaque per-connection state that a handler binds to the servicing thread in connected().
+         */
+        class ConnectionState {
+        public:
+            virtual ~ConnectionState() {}
+        };
+
         virtual ~MessageHandler() {}
         
         /**
@@ -52,6 +65,19 @@ namespace mongo {
          * handler is responsible for responding to client
          */
         virtual void process(Message& m, AbstractMessagingPort* p) = 0;
+
+        /**
+         * Unbinds the per-connection state set up by connected() from the current thread, so
+         * that the connection can later be serviced by another thread. Used by executors which
+         * do not dedicate a thread to each connection. Returns NULL if the handler keeps no
+         * thread-bound state.
+         */
+        virtual std::unique_ptr<ConnectionState> detachConnection() { return nullptr; }
+
+        /**
+         * Binds state previously returned by detachConnection() to the current thread.
+         */
+        virtual void attachConnection(std::unique_ptr<ConnectionState> state) {}
     };
 
     class MessageServer {
@@ -37,8 +37,11 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/config.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/util/concurrency/synchronization.h"
@@ -50,9 +53,13 @@
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/message_server.h"
+#include "mongo/util/net/pooled_connection_executor.h"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/net/ssl_options.h"
+#include "mongo/util/numa_placement.h"
 #include "mongo/util/scopeguard.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
@@ -88,6 +95,88 @@ namespace {
         MessageHandler* const _handler;
     };
 
+    const char kThreadPerConnection[] = "threadPerConnection";
+    const char kPooled[] = "pooled";
+
+    std::string connectionExecutor = kThreadPerConnection;
+
+    /**
+     * Selects how incoming connections are serviced: a dedicated thread per connection, or
+     * the PooledConnectionExecutor.
+     */
+    class ConnectionExecutorParameter : public ExportedServerParameter<std::string> {
+    public:
+        ConnectionExecutorParameter()
+            : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                   "connectionExecutor",
+                                                   &connectionExecutor,
+                                                   true, // Change at startup
+                                                   false) {} // Change at runtime
+
+    protected:
+        virtual Status validate(const std::string& potentialNewValue) {
+            if (potentialNewValue != kThreadPerConnection && potentialNewValue != kPooled) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "connectionExecutor must be either \""
+                                            << kThreadPerConnection << "\" or \"" << kPooled
+                                            << "\"");
+            }
+            return Status::OK();
+        }
+    } connectionExecutorParameter;
+
+    std::string networkMessageCompressors = "disabled";
+
+    /**
+     * Comma separated list of the compressors offered to and accepted from peers, in order of
+     * preference, or "disabled".
+     */
+    class NetworkMessageCompressorsParameter : public ExportedServerParameter<std::string> {
+    public:
+        NetworkMessageCompressorsParameter()
+            : ExportedServerParameter<std::string>(ServerParameterSet::getGlobal(),
+                                                   "networkMessageCompressors",
+                                                   &networkMessageCompressors,
+                                                   true, // Change at startup
+                                                   false) {} // Change at runtime
+
+        using ExportedServerParameter<std::string>::set;
+
+        virtual Status set(const std::string& newValue) {
+            Status status = MessageCompressorRegistry::get().setEnabled(newValue);
+            if (!status.isOK()) {
+                return status;
+            }
+            return ExportedServerParameter<std::string>::set(newValue);
+        }
+    } networkMessageCompressorsParameter;
+
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionExecutorIOThreads, int, 1);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionExecutorMinWorkers, int, 16);
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(connectionExecutorMaxWorkers, int, 1024);
+
+    // Set once at startup if connections are serviced by a pooled executor; never destroyed.
+    PooledConnectionExecutor* pooledExecutor = NULL;
+
+    class ConnectionExecutorServerStatusSection : public ServerStatusSection {
+    public:
+        ConnectionExecutorServerStatusSection() : ServerStatusSection("connectionExecutor") {}
+        virtual bool includeByDefault() const { return true; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder b;
+            if (pooledExecutor) {
+                b.append("mode", kPooled);
+                pooledExecutor->appendStats(&b);
+            }
+            else {
+                b.append("mode", kThreadPerConnection);
+            }
+            return b.obj();
+        }
+    } connectionExecutorServerStatusSection;
+
 }  // namespace
 
     class PortMessageServer : public MessageServer , public Listener {
@@ -113,6 +202,12 @@ namespace {
                 return;
             }
 
+            if (pooledExecutor) {
+                pooledExecutor->add(portWithHandler.release());
+                sleepAfterClosingPort.Dismiss();
+                return;
+            }
+
             try {
 #ifndef __linux__  // TODO: consider making this ifdef _WIN32
                 {
@@ -173,6 +268,9 @@ namespace {
         }
 
         void run() {
+            if (connectionExecutor == kPooled) {
+                startPooledExecutor();
+            }
             initAndListen();
         }
 
@@ -181,6 +279,33 @@ namespace {
     private:
         MessageHandler* _handler;
 
+        void startPooledExecutor() {
+            if (!PooledConnectionExecutor::isSupported()) {
+                warning() << "connectionExecutor \"" << kPooled << "\" is not supported on this "
+                          << "platform, using a thread per connection";
+                return;
+            }
+
+            // The pooled executor relies on the socket becoming readable for every message,
+            // which does not hold when an SSL connection has already buffered decrypted data.
+            if (sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+                warning() << "connectionExecutor \"" << kPooled << "\" is not supported with "
+                          << "SSL, using a thread per connection";
+                return;
+            }
+
+            PooledConnectionExecutor::Options options;
+            options.ioThreads = std::max(1, connectionExecutorIOThreads);
+            options.minWorkers = std::max(1, connectionExecutorMinWorkers);
+            options.maxWorkers = std::max(options.minWorkers, connectionExecutorMaxWorkers);
+
+            log() << "servicing connections with " << options.ioThreads << " I/O thread(s) and "
+                  << options.minWorkers << " to " << options.maxWorkers << " worker threads";
+
+            pooledExecutor = new PooledConnectionExecutor(_handler, options);
+            pooledExecutor->start();
+        }
+
         /**
          * Handles incoming messages from a given socket.
          *
@@ -202,6 +327,7 @@ namespace {
             MessageHandler* const handler = portWithHandler->getHandler();
 
             setThreadName(std::string(str::stream() << "conn" << portWithHandler->connectionId()));
+            NumaPlacement::bindCurrentThread(NumaPlacement::kConnections);
             portWithHandler->psock->setLogLevel(logger::LogSeverity::Debug(1));
 
             Message m;
@@ -0,0 +1,341 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/pooled_connection_executor.h"
+
+#include <boost/thread/thread.hpp>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/concurrency/synchronization.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/exit.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/listen.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/numa_placement.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+namespace {
+
+    const char kWorkerThreadName[] = "connExecutorWorker";
+
+    // How long epoll_wait blocks before the I/O thread re-checks for shutdown and starvation.
+    const int kIOWaitMillis = 100;
+
+    // A connection left in the ready queue for longer than this while no worker is idle causes
+    // another worker to be started.
+    const unsigned long long kStarvationMicros = 50 * 1000;
+
+    // Workers beyond Options::minWorkers exit after being idle for this long.
+    const int kIdleWorkerExitMillis = 30 * 1000;
+
+}  // namespace
+
+    struct PooledConnectionExecutor::Connection {
+        explicit Connection(MessagingPort* p)
+            : port(p),
+              threadName(str::stream() << "conn" << p->connectionId()),
+              epollFd(-1),
+              readyMicros(0),
+              connected(false),
+              registered(false) {
+        }
+
+        std::unique_ptr<MessagingPort> port;
+
+        // Handler state while no thread is servicing this connection.
+        std::unique_ptr<MessageHandler::ConnectionState> state;
+
+        const std::string threadName;
+        int epollFd;
+        unsigned long long readyMicros;
+        bool connected;
+        bool registered;
+    };
+
+    PooledConnectionExecutor::PooledConnectionExecutor(MessageHandler* handler,
+                                                       const Options& options)
+        : _handler(handler),
+          _options(options),
+          _numWorkers(0),
+          _numIdleWorkers(0) {
+        invariant(_options.ioThreads > 0);
+        invariant(_options.minWorkers > 0);
+        invariant(_options.maxWorkers >= _options.minWorkers);
+    }
+
+    bool PooledConnectionExecutor::isSupported() {
+#ifdef __linux__
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void PooledConnectionExecutor::start() {
+#ifdef __linux__
+        invariant(_epollFds.empty());
+        for (int i = 0; i < _options.ioThreads; i++) {
+            int fd = epoll_create1(EPOLL_CLOEXEC);
+            if (fd < 0) {
+                severe() << "epoll_create1 failed: " << errnoWithDescription();
+                fassertFailed(28700);
+            }
+            _epollFds.push_back(fd);
+            boost::thread(stdx::bind(&PooledConnectionExecutor::_ioThread, this, fd));
+        }
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        for (int i = 0; i < _options.minWorkers; i++) {
+            _startWorker_inlock();
+        }
+#else
+        fassertFailed(28701);
+#endif
+    }
+
+    void PooledConnectionExecutor::add(MessagingPort* port) {
+        Connection* conn = new Connection(port);
+        conn->epollFd = _epollFds[port->connectionId() % _epollFds.size()];
+        _enqueue(conn);
+    }
+
+    void PooledConnectionExecutor::appendStats(BSONObjBuilder* b) const {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            b->append("queueDepth", static_cast<int>(_readyQueue.size()));
+            b->append("workers", _numWorkers);
+            b->append("idleWorkers", _numIdleWorkers);
+        }
+        b->append("ioThreads", _options.ioThreads);
+        b->appendNumber("workersCreated", _workersCreated.load());
+        b->appendNumber("totalDispatched", _totalDispatched.load());
+        b->appendNumber("totalDispatchLatencyMicros", _totalDispatchLatencyMicros.load());
+        b->appendNumber("maxDispatchLatencyMicros", _maxDispatchLatencyMicros.load());
+    }
+
+    void PooledConnectionExecutor::_startWorker_inlock() {
+        boost::thread(stdx::bind(&PooledConnectionExecutor::_workerThread, this));
+        _numWorkers++;
+        _workersCreated.fetchAndAdd(1);
+    }
+
+    void PooledConnectionExecutor::_enqueue(Connection* conn) {
+        conn->readyMicros = curTimeMicros64();
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _readyQueue.push_back(conn);
+        _workAvailable.notify_one();
+    }
+
+    void PooledConnectionExecutor::_ioThread(int epollFd) {
+#ifdef __linux__
+        setThreadName("connExecutorIO");
+
+        const int kMaxEvents = 128;
+        epoll_event events[kMaxEvents];
+
+        while (!inShutdown()) {
+            int numEvents = epoll_wait(epollFd, events, kMaxEvents, kIOWaitMillis);
+            if (numEvents < 0) {
+                if (errno == EINTR)
+                    continue;
+                severe() << "epoll_wait failed: " << errnoWithDescription();
+                fassertFailed(28702);
+            }
+
+            for (int i = 0; i < numEvents; i++) {
+                // Errors and hangups are reported by the subsequent recv on a worker.
+                _enqueue(static_cast<Connection*>(events[i].data.ptr));
+            }
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (!_readyQueue.empty() &&
+                _numIdleWorkers == 0 &&
+                _numWorkers < _options.maxWorkers &&
+                curTimeMicros64() - _readyQueue.front()->readyMicros > kStarvationMicros) {
+                _startWorker_inlock();
+            }
+        }
+#endif
+    }
+
+    void PooledConnectionExecutor::_workerThread() {
+        setThreadName(kWorkerThreadName);
+        NumaPlacement::bindCurrentThread(NumaPlacement::kConnections);
+
+        int64_t counter = 0;
+        while (true) {
+            Connection* conn;
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                _numIdleWorkers++;
+                while (_readyQueue.empty()) {
+                    const bool timedOut = !_workAvailable.timed_wait(
+                            lk, boost::posix_time::milliseconds(kIdleWorkerExitMillis));
+                    if (timedOut &&
+                        _readyQueue.empty() &&
+                        _numWorkers > _options.minWorkers) {
+                        _numIdleWorkers--;
+                        _numWorkers--;
+                        return;
+                    }
+                }
+                _numIdleWorkers--;
+                conn = _readyQueue.front();
+                _readyQueue.pop_front();
+            }
+
+            const long long latency = curTimeMicros64() - conn->readyMicros;
+            _totalDispatched.fetchAndAdd(1);
+            _totalDispatchLatencyMicros.fetchAndAdd(latency);
+            long long prevMax = _maxDispatchLatencyMicros.load();
+            while (latency > prevMax) {
+                const long long seen = _maxDispatchLatencyMicros.compareAndSwap(prevMax, latency);
+                if (seen == prevMax)
+                    break;
+                prevMax = seen;
+            }
+
+            _service(conn);
+
+            // Occasionally we want to see if we're using too much memory.
+            if ((counter++ & 0xf) == 0) {
+                markThreadIdle();
+            }
+        }
+    }
+
+    void PooledConnectionExecutor::_service(Connection* conn) {
+        MessagingPort* const port = conn->port.get();
+
+        setThreadName(conn->threadName);
+        if (conn->state) {
+            _handler->attachConnection(std::move(conn->state));
+        }
+
+        bool keepOpen = false;
+        try {
+            if (!conn->connected) {
+                port->psock->setLogLevel(logger::LogSeverity::Debug(1));
+                _handler->connected(port);
+                conn->connected = true;
+                keepOpen = true;
+            }
+            else {
+                Message m;
+                port->psock->clearCounters();
+
+                // The socket is readable, so this normally returns without blocking for long;
+                // a client that sends only part of a message ties up this worker until it either
+                // completes the message or disconnects, just like a dedicated thread would.
+                if (!port->recv(m)) {
+                    if (!serverGlobalParams.quiet) {
+                        int conns = Listener::globalTicketHolder.used() - 1;
+                        const char* word = (conns == 1 ? " connection" : " connections");
+                        log() << "end connection " << port->psock->remoteString()
+                              << " (" << conns << word << " now open)";
+                    }
+                    port->shutdown();
+                }
+                else {
+                    _handler->process(m, port);
+                    networkCounter.hit(port->psock->getBytesIn(), port->psock->getBytesOut());
+                    keepOpen = !inShutdown();
+                }
+            }
+        }
+        catch (AssertionException& e) {
+            log() << "AssertionException handling request, closing client connection: " << e;
+            port->shutdown();
+        }
+        catch (SocketException& e) {
+            log() << "SocketException handling request, closing client connection: " << e;
+            port->shutdown();
+        }
+        catch (const DBException& e) {
+            // must be right above std::exception to avoid catching subclasses
+            log() << "DBException handling request, closing client connection: " << e;
+            port->shutdown();
+        }
+        catch (std::exception& e) {
+            error() << "Uncaught std::exception: " << e.what() << ", terminating";
+            dbexit(EXIT_UNCAUGHT);
+        }
+
+        conn->state = _handler->detachConnection();
+        setThreadName(kWorkerThreadName);
+
+        // The connection must be completely detached before it is re-armed, since another worker
+        // may pick it up as soon as it is.
+        if (!keepOpen || !_arm(conn)) {
+            _close(conn);
+        }
+    }
+
+    bool PooledConnectionExecutor::_arm(Connection* conn) {
+#ifdef __linux__
+        epoll_event event;
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+        event.data.ptr = conn;
+        const int fd = conn->port->psock->rawFD();
+        const int op = conn->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+        if (epoll_ctl(conn->epollFd, op, fd, &event) != 0) {
+            warning() << "failed to register connection with epoll, closing it: "
+                      << errnoWithDescription();
+            return false;
+        }
+        conn->registered = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void PooledConnectionExecutor::_close(Connection* conn) {
+        // Destroying the detached state (e.g. the Client) here rather than on whichever thread
+        // next runs means cleanup never races with another worker.
+        conn->state.reset();
+        delete conn;
+        Listener::globalTicketHolder.release();
+    }
+
+}  // namespace mongo
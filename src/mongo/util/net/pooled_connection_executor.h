@@ -0,0 +1,134 @@
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/net/message_server.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class MessagingPort;
+
+    /**
+     * Services client connections with a small, adaptive set of threads instead of one thread
+     * per connection.
+     *
+     * A few I/O threads wait (via epoll) for connections to become readable and queue them. A
+     * pool of worker threads takes ready connections off that queue, reads one complete Message
+     * and hands it to the MessageHandler. Between messages, the handler's per-connection state is
+     * detached from the worker with MessageHandler::detachConnection(), so any worker may service
+     * the connection's next message.
+     *
+     * Each connection is armed with EPOLLONESHOT, so it is queued or serviced by at most one
+     * thread at a time and the queue never holds more entries than there are connections.
+     *
+     * The pool starts with minWorkers threads. Because operations may block for a long time
+     * (e.g. waiting for write concern or on awaitData cursors), a worker is added whenever the
+     * oldest queued connection has waited longer than a short threshold, up to maxWorkers. Extra
+     * workers exit again after being idle for a while.
+     *
+     * Only supported on Linux; see isSupported().
+     */
+    class PooledConnectionExecutor {
+        MONGO_DISALLOW_COPYING(PooledConnectionExecutor);
+    public:
+        struct Options {
+            Options() : ioThreads(1), minWorkers(16), maxWorkers(1024) {}
+
+            int ioThreads;
+            int minWorkers;
+            int maxWorkers;
+        };
+
+        /**
+         * "handler" is not owned and must outlive this executor.
+         */
+        PooledConnectionExecutor(MessageHandler* handler, const Options& options);
+
+        /**
+         * Returns true if this platform has the readiness notification needed by this executor.
+         */
+        static bool isSupported();
+
+        /**
+         * Starts the I/O and worker threads. Must be called exactly once, before add().
+         */
+        void start();
+
+        /**
+         * Takes ownership of "port" and runs MessageHandler::connected() for it on a worker.
+         *
+         * The caller must already hold a ticket from Listener::globalTicketHolder for the
+         * connection; it is released when the connection is closed.
+         */
+        void add(MessagingPort* port);
+
+        /**
+         * Appends queue depth, thread counts and dispatch latency counters.
+         */
+        void appendStats(BSONObjBuilder* b) const;
+
+    private:
+        struct Connection;
+
+        void _ioThread(int epollFd);
+        void _workerThread();
+        void _startWorker_inlock();
+
+        void _enqueue(Connection* conn);
+        void _service(Connection* conn);
+        void _close(Connection* conn);
+        bool _arm(Connection* conn);
+
+        MessageHandler* const _handler;
+        const Options _options;
+
+        // One epoll set per I/O thread; connections are assigned round robin by connection id.
+        std::vector<int> _epollFds;
+
+        // Protects the members below.
+        mutable boost::mutex _mutex;
+        boost::condition_variable _workAvailable;
+        std::deque<Connection*> _readyQueue;
+        int _numWorkers;
+        int _numIdleWorkers;
+
+        AtomicInt64 _workersCreated;
+        AtomicInt64 _totalDispatched;
+        AtomicInt64 _totalDispatchLatencyMicros;
+        AtomicInt64 _maxDispatchLatencyMicros;
+    };
+
+}  // namespace mongo
@@ -648,7 +648,36 @@ namespace mongo {
         }
     }
 
+namespace {
+    // Multi-part messages up to this size are gathered into one write where the transport has no
+    // scatter/gather call, so that with Nagle disabled a small header doesn't go out in a packet
+    // (or TLS record) of its own.
+    const int kMaxGatheredSendBytes = 16 * 1024;
+}  // namespace
+
     void Socket::_send( const vector< pair< char *, int > > &data, const char *context ) {
+        int total = 0;
+        for (vector< pair<char *, int> >::const_iterator i = data.begin();
+             i != data.end();
+             ++i) {
+            total += i->second;
+        }
+
+        if ( data.size() > 1 && total <= kMaxGatheredSendBytes ) {
+            char gathered[kMaxGatheredSendBytes];
+            char* out = gathered;
+            for (vector< pair<char *, int> >::const_iterator i = data.begin();
+                 i != data.end();
+                 ++i) {
+                if ( i->second > 0 ) {
+                    memcpy( out, i->first, i->second );
+                    out += i->second;
+                }
+            }
+            send( gathered, total, context );
+            return;
+        }
+
         for (vector< pair<char *, int> >::const_iterator i = data.begin(); 
              i != data.end(); 
              ++i) {
@@ -689,7 +718,7 @@ namespace mongo {
         struct msghdr meta;
         memset( &meta, 0, sizeof( meta ) );
         meta.msg_iov = &d[ 0 ];
-        meta.msg_iovlen = d.size();
+        meta.msg_iovlen = i;
 
         while( meta.msg_iovlen > 0 ) {
             int ret = -1;
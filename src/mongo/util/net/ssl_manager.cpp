@@ -35,6 +35,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/thread/tss.hpp>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -154,9 +155,18 @@ namespace mongo {
 
         SimpleMutex sslManagerMtx("SSL Manager");
         SSLManagerInterface* theSSLManager = NULL;
-        static const int BUFFER_SIZE = 8*1024;
+        // Large enough for a whole TLS record, of up to 2^14 bytes of data, 2048 bytes of expansion
+        // and a 5 byte header, so that a record is received with one recv().
+        static const int BUFFER_SIZE = 16*1024 + 2048 + 5;
         static const int DATE_LEN = 128;
 
+        // How many sessions the server keeps for clients to resume, and for how long.
+        static const long kSessionCacheSize = 20*1024;
+        static const long kSessionTimeoutSecs = 60*60;
+
+        // How many remote hosts we keep a session to resume with.
+        static const size_t kMaxClientSessions = 1024;
+
         class SSLManager : public SSLManagerInterface {
         public:
             explicit SSLManager(const SSLParams& params, bool isServer);
@@ -176,6 +186,8 @@ namespace mongo {
                 return _sslConfiguration;
             }
 
+            virtual void appendSessionStats(BSONObjBuilder* builder) const;
+
             virtual std::string getSSLErrorMessage(int code);
 
             virtual int SSL_read(SSLConnection* conn, void* buf, int num);
@@ -201,6 +213,27 @@ namespace mongo {
             bool _allowInvalidHostnames;
             SSLConfiguration _sslConfiguration;
 
+            // Session of the last outgoing connection to each remote address, which the next
+            // connection to the address tries to resume instead of doing a full handshake.
+            typedef std::map<std::string, SSL_SESSION*> SessionMap;
+            SimpleMutex _clientSessionsMtx;
+            SessionMap _clientSessions;
+
+            AtomicUInt64 _numClientFullHandshakes;
+            AtomicUInt64 _numClientResumedSessions;
+            AtomicUInt64 _numServerFullHandshakes;
+            AtomicUInt64 _numServerResumedSessions;
+
+            /**
+             * Sets up "conn" to resume the session of the last connection to "remote", if any.
+             */
+            void _setClientSession(SSLConnection* conn, const std::string& remote);
+
+            /**
+             * Keeps the session of "conn", connected to "remote", for the next connection.
+             */
+            void _saveClientSession(SSLConnection* conn, const std::string& remote);
+
             /**
              * creates an SSL object to be used for this file descriptor.
              * caller must SSL_free it.
@@ -379,7 +412,8 @@ namespace mongo {
         _clientContext(NULL),
         _weakValidation(params.sslWeakCertificateValidation),
         _allowInvalidCertificates(params.sslAllowInvalidCertificates),
-        _allowInvalidHostnames(params.sslAllowInvalidHostnames) {
+        _allowInvalidHostnames(params.sslAllowInvalidHostnames),
+        _clientSessionsMtx("SSL client sessions") {
 
         SSL_library_init();
         SSL_load_error_strings();
@@ -403,6 +437,8 @@ namespace mongo {
         if (!_initSSLContext(&_clientContext, params)) {
             uasserted(16768, "ssl initialization problem"); 
         }
+        // Outgoing sessions are kept in _clientSessions, by remote address.
+        SSL_CTX_set_session_cache_mode(_clientContext, SSL_SESS_CACHE_OFF);
 
         // pick the certificate for use in outgoing connections,
         std::string clientPEM;
@@ -427,6 +463,11 @@ namespace mongo {
             if (!_initSSLContext(&_serverContext, params)) {
                 uasserted(16562, "ssl initialization problem");
             }
+            // Let reconnecting clients resume their session, from its id or from a session
+            // ticket, which skips the key exchange and certificate validation of a full handshake.
+            SSL_CTX_set_session_cache_mode(_serverContext, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(_serverContext, kSessionCacheSize);
+            SSL_CTX_set_timeout(_serverContext, kSessionTimeoutSecs);
 
             if (!_parseAndValidateCertificate(params.sslPEMKeyFile,
                                               &_sslConfiguration.serverSubjectName,
@@ -450,6 +491,50 @@ namespace mongo {
         if (NULL != _clientContext) {
             SSL_CTX_free(_clientContext);
         }
+        for (SessionMap::iterator it = _clientSessions.begin(); it != _clientSessions.end(); ++it) {
+            SSL_SESSION_free(it->second);
+        }
+    }
+
+    void SSLManager::appendSessionStats(BSONObjBuilder* builder) const {
+        builder->append("clientFullHandshakes",
+                        static_cast<long long>(_numClientFullHandshakes.load()));
+        builder->append("clientResumedSessions",
+                        static_cast<long long>(_numClientResumedSessions.load()));
+        builder->append("serverFullHandshakes",
+                        static_cast<long long>(_numServerFullHandshakes.load()));
+        builder->append("serverResumedSessions",
+                        static_cast<long long>(_numServerResumedSessions.load()));
+    }
+
+    void SSLManager::_setClientSession(SSLConnection* conn, const std::string& remote) {
+        SimpleMutex::scoped_lock lck(_clientSessionsMtx);
+        SessionMap::const_iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            // If the server no longer has the session, it does a full handshake instead.
+            SSL_set_session(conn->ssl, it->second);
+        }
+    }
+
+    void SSLManager::_saveClientSession(SSLConnection* conn, const std::string& remote) {
+        SSL_SESSION* session = SSL_get1_session(conn->ssl);
+        if (!session) {
+            return;
+        }
+        SimpleMutex::scoped_lock lck(_clientSessionsMtx);
+        SessionMap::iterator it = _clientSessions.find(remote);
+        if (it != _clientSessions.end()) {
+            SSL_SESSION_free(it->second);
+            it->second = session;
+            return;
+        }
+        if (_clientSessions.size() >= kMaxClientSessions) {
+            for (it = _clientSessions.begin(); it != _clientSessions.end(); ++it) {
+                SSL_SESSION_free(it->second);
+            }
+            _clientSessions.clear();
+        }
+        _clientSessions[remote] = session;
     }
 
     int SSLManager::password_cb(char *buf,int num, int rwflag,void *userdata) {
@@ -814,6 +899,13 @@ namespace mongo {
         int wantRead;
         while ((wantRead = BIO_ctrl_get_read_request(conn->networkBIO)) > 0)
         {
+            // Receive as much as the BIO can hold rather than only what the TLS layer asked for,
+            // usually a record header, so that the following records don't each cost a recv().
+            // recv() returns what is available, so this doesn't wait for more than was asked.
+            const int canRead = BIO_ctrl_get_write_guarantee(conn->networkBIO);
+            if (wantRead < canRead) {
+                wantRead = canRead;
+            }
             if (wantRead > BUFFER_SIZE) {
                 wantRead = BUFFER_SIZE;
             }
@@ -849,6 +941,8 @@ namespace mongo {
 
     SSLConnection* SSLManager::connect(Socket* socket) {
         std::unique_ptr<SSLConnection> sslConn = stdx::make_unique<SSLConnection>(_clientContext, socket, (const char*)NULL, 0);
+        const std::string remote = socket->remoteString();
+        _setClientSession(sslConn.get(), remote);
  
         int ret;
         do {
@@ -857,6 +951,14 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
+
+        if (SSL_session_reused(sslConn->ssl)) {
+            _numClientResumedSessions.fetchAndAdd(1);
+        }
+        else {
+            _numClientFullHandshakes.fetchAndAdd(1);
+        }
+        _saveClientSession(sslConn.get(), remote);
  
         return sslConn.release();
     }
@@ -871,6 +973,13 @@ namespace mongo {
  
         if (ret != 1)
             _handleSSLError(SSL_get_error(sslConn.get(), ret), ret);
+
+        if (SSL_session_reused(sslConn->ssl)) {
+            _numServerResumedSessions.fetchAndAdd(1);
+        }
+        else {
+            _numServerFullHandshakes.fetchAndAdd(1);
+        }
  
         return sslConn.release();
     }
@@ -53,6 +53,8 @@ namespace mongo {
 #ifdef MONGO_CONFIG_SSL
 namespace mongo {
 
+    class BSONObjBuilder;
+
     class SSLConnection {
     public:
         SSL* ssl;
@@ -123,6 +125,12 @@ namespace mongo {
          */
          virtual const SSLConfiguration& getSSLConfiguration() const = 0;
 
+        /**
+         * Appends the number of full and resumed handshakes of incoming and outgoing connections
+         * to "builder".
+         */
+        virtual void appendSessionStats(BSONObjBuilder* builder) const = 0;
+
         /**
         * Fetches the error text for an error code, in a thread-safe manner.
         */
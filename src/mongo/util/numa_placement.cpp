@@ -0,0 +1,122 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kControl
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/numa_placement.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+
+namespace mongo {
+
+    // Bind connection and replication writer threads to NUMA nodes.  Best combined with
+    // launching mongod without "numactl --interleave=all", so that threads allocate locally.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(numaThreadPlacement, bool, false);
+
+namespace {
+
+    const unsigned kMaxNodes = 64;
+
+    const char* const kPoolNames[NumaPlacement::kNumPools] = {
+        "connections",
+        "replWriters",
+    };
+
+    AtomicUInt32 nextNode[NumaPlacement::kNumPools];
+
+    // Number of threads of each pool that were bound to each node.
+    AtomicInt64 threadsBound[NumaPlacement::kNumPools][kMaxNodes];
+    AtomicInt64 bindFailures;
+
+    unsigned numNodes() {
+        return std::min<size_t>(ProcessInfo::getNumaNodeCpus().size(), kMaxNodes);
+    }
+
+    class NumaServerStatusSection : public ServerStatusSection {
+    public:
+        NumaServerStatusSection() : ServerStatusSection("numa") {}
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection(OperationContext* txn,
+                                        const BSONElement& configElement) const {
+            BSONObjBuilder b;
+            b.append("threadPlacement", NumaPlacement::enabled());
+            b.appendNumber("bindFailures", bindFailures.load());
+
+            const std::vector<std::vector<unsigned> >& cpus = ProcessInfo::getNumaNodeCpus();
+            BSONArrayBuilder nodes(b.subarrayStart("nodes"));
+            for (unsigned node = 0; node < numNodes(); ++node) {
+                BSONObjBuilder nodeBuilder(nodes.subobjStart());
+                nodeBuilder.append("node", static_cast<int>(node));
+                nodeBuilder.append("cpus", static_cast<int>(cpus[node].size()));
+                BSONObjBuilder threads(nodeBuilder.subobjStart("threadsBound"));
+                for (int pool = 0; pool < NumaPlacement::kNumPools; ++pool) {
+                    threads.appendNumber(kPoolNames[pool], threadsBound[pool][node].load());
+                }
+                threads.doneFast();
+                nodeBuilder.doneFast();
+            }
+            nodes.doneFast();
+            return b.obj();
+        }
+    } numaServerStatusSection;
+
+}  // namespace
+
+    bool NumaPlacement::enabled() {
+        return numaThreadPlacement && numNodes() > 1;
+    }
+
+    int NumaPlacement::bindCurrentThread(Pool pool) {
+        if (!enabled())
+            return -1;
+
+        const unsigned node = nextNode[pool].fetchAndAdd(1) % numNodes();
+        if (!ProcessInfo::bindCurrentThreadToNumaNode(node)) {
+            // Only the first failure is logged, since every thread would fail the same way.
+            if (bindFailures.fetchAndAdd(1) == 0) {
+                warning() << "failed to bind a thread to NUMA node " << node;
+            }
+            return -1;
+        }
+
+        threadsBound[pool][node].fetchAndAdd(1);
+        return node;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,60 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Optional placement of worker threads on NUMA nodes, enabled by the numaThreadPlacement
+     * startup parameter.  Each pool spreads its threads over the nodes round robin, so that a
+     * thread, the memory it allocates and the memory of the data it caches stay on one node.
+     *
+     * Placement is a no-op unless the parameter is set and the machine has several nodes.
+     */
+    class NumaPlacement {
+    public:
+        enum Pool {
+            kConnections,
+            kReplWriters,
+            kNumPools
+        };
+
+        /**
+         * Whether threads are being placed.
+         */
+        static bool enabled();
+
+        /**
+         * Binds the calling thread to the next node for 'pool'.  Call once, when a thread of the
+         * pool starts.  Returns the node, or -1 if the thread was not bound.
+         */
+        static int bindCurrentThread(Pool pool);
+    };
+
+}  // namespace mongo
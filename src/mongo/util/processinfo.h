@@ -30,6 +30,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/cstdint.h"
@@ -98,6 +99,21 @@ namespace mongo {
          */
         bool hasNumaEnabled() const { return sysInfo().hasNuma; }
 
+        /**
+         * Get the CPUs of each NUMA node, indexed by node number.  Empty if the platform does not
+         * report its NUMA topology.
+         */
+        static const std::vector<std::vector<unsigned> >& getNumaNodeCpus() {
+            return systemInfo->numaNodeCpus;
+        }
+
+        /**
+         * Restricts the calling thread to the CPUs of NUMA node 'node', and makes it prefer
+         * allocating memory from that node.
+         * @return true on success, false if it failed or is not supported on this platform
+         */
+        static bool bindCurrentThreadToNumaNode(unsigned node);
+
         /**
          * Determine if file zeroing is necessary for newly allocated data files.
          */
@@ -168,6 +184,7 @@ namespace mongo {
             unsigned long long pageSize;
             std::string cpuArch;
             bool hasNuma;
+            std::vector<std::vector<unsigned> > numaNodeCpus;
             BSONObj _extraStats;
 
             // This is an OS specific value, which determines whether files should be zero-filled
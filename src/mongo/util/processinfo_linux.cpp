@@ -31,9 +31,11 @@
 
 #include <malloc.h>
 #include <iostream>
+#include <sched.h>
 #include <stdio.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/utsname.h>
 #ifdef __UCLIBC__
 #include <features.h>
@@ -377,6 +379,39 @@ namespace mongo {
             return 0;
         }
 
+        /**
+        * Get the CPUs of each NUMA node from /sys/devices/system/node/node<N>/cpulist, which
+        * holds ranges like "0-7,16-23"
+        */
+        static vector<vector<unsigned> > getNumaNodeCpus() {
+            vector<vector<unsigned> > nodes;
+            for (unsigned node = 0; ; ++node) {
+                char fname[128];
+                snprintf(fname, sizeof(fname), "/sys/devices/system/node/node%u/cpulist", node);
+                if (access(fname, R_OK) != 0)
+                    break;
+
+                vector<unsigned> cpus;
+                string cpulist = readLineFromFile(fname);
+                for (const char* p = cpulist.c_str(); *p; ) {
+                    char* end;
+                    unsigned first = strtoul(p, &end, 10);
+                    unsigned last = first;
+                    if (end == p)
+                        break;
+                    if (*end == '-') {
+                        p = end + 1;
+                        last = strtoul(p, &end, 10);
+                    }
+                    for (unsigned cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+                        cpus.push_back(cpu);
+                    p = *end == ',' ? end + 1 : end + strlen(end);
+                }
+                nodes.push_back(cpus);
+            }
+            return nodes;
+        }
+
     };
 
 
@@ -440,6 +475,7 @@ namespace mongo {
         pageSize = static_cast<unsigned long long>(sysconf( _SC_PAGESIZE ));
         cpuArch = unameData.machine;
         hasNuma = checkNumaEnabled();
+        numaNodeCpus = LinuxSysHelper::getNumaNodeCpus();
         
         BSONObjBuilder bExtra;
         bExtra.append( "versionString", LinuxSysHelper::readLineFromFile( "/proc/version" ) );
@@ -495,6 +531,37 @@ namespace mongo {
         return false;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        const vector<vector<unsigned> >& nodes = getNumaNodeCpus();
+        if (node >= nodes.size() || nodes[node].empty())
+            return false;
+
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (size_t i = 0; i < nodes[node].size(); ++i)
+            CPU_SET(nodes[node][i], &cpus);
+        if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+            log() << "sched_setaffinity failed: " << errnoWithDescription() << endl;
+            return false;
+        }
+
+#ifdef SYS_set_mempolicy
+        // Prefer, rather than require, memory from this node so that allocations still succeed
+        // once it is full.  glibc has no wrapper for set_mempolicy, and the constants come from
+        // <linux/mempolicy.h>.
+        const int kMpolPreferred = 1;
+        unsigned long nodeMask = 0;
+        if (node < sizeof(nodeMask) * 8) {
+            nodeMask = 1UL << node;
+            // The kernel reads one bit fewer than maxnode.
+            if (syscall(SYS_set_mempolicy, kMpolPreferred, &nodeMask, sizeof(nodeMask) * 8 + 1)) {
+                log() << "set_mempolicy failed: " << errnoWithDescription() << endl;
+            }
+        }
+#endif
+        return true;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return true;
     }
@@ -185,6 +185,10 @@ namespace mongo {
         return true;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        return false;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return true;
     }
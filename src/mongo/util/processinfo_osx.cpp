@@ -199,6 +199,10 @@ namespace mongo {
         return false;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        return false;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return true;
     }
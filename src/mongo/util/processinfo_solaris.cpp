@@ -213,6 +213,10 @@ namespace mongo {
         return groups > 1;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        return false;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return true;
     }
@@ -69,4 +69,16 @@ namespace mongo_test {
             ASSERT_TRUE(result[8]);
         }
     }
+
+    TEST(ProcessInfo, NumaNodesHaveCpus) {
+        const std::vector<std::vector<unsigned> >& nodes = ProcessInfo::getNumaNodeCpus();
+        for (size_t i = 0; i < nodes.size(); ++i) {
+            ASSERT_FALSE(nodes[i].empty());
+        }
+    }
+
+    TEST(ProcessInfo, BindToUnknownNumaNodeFails) {
+        const unsigned numNodes = ProcessInfo::getNumaNodeCpus().size();
+        ASSERT_FALSE(ProcessInfo::bindCurrentThreadToNumaNode(numNodes));
+    }
 }
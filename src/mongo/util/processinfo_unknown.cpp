@@ -63,6 +63,10 @@ namespace mongo {
         return false;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        return false;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return false;
     }
@@ -424,6 +424,10 @@ namespace mongo {
         return numaNodeCount > 1;
     }
 
+    bool ProcessInfo::bindCurrentThreadToNumaNode(unsigned node) {
+        return false;
+    }
+
     bool ProcessInfo::blockCheckSupported() {
         return psapiGlobal->supported;
     }
@@ -96,9 +96,20 @@ namespace mongo {
          * The max size for this queue
          */
         size_t maxSize() const {
+            boost::lock_guard<boost::mutex> l( _lock );
             return _maxSize;
         }
 
+        /**
+         * Changes the max size.  If the queue is already larger, push() blocks until enough items
+         * have been popped.
+         */
+        void setMaxSize(size_t size) {
+            boost::lock_guard<boost::mutex> l( _lock );
+            _maxSize = size;
+            _cvNoLongerFull.notify_one();
+        }
+
         /**
          * The number/count of items in the queue ( _queue.size() )
          */
@@ -203,7 +214,7 @@ namespace mongo {
     private:
         mutable mongo::mutex _lock;
         std::queue<T> _queue;
-        const size_t _maxSize;
+        size_t _maxSize;
         size_t _currentSize;
         getSizeFunc _getSize;
 
@@ -57,6 +57,22 @@ namespace mongo {
         }
     }
 
+    bool SafeNum::toBSON(StringData fieldName, BSONObjBuilder* bob) const {
+        switch (_type) {
+        case NumberInt:
+            bob->append(fieldName, _value.int32Val);
+            return true;
+        case NumberLong:
+            bob->append(fieldName, _value.int64Val);
+            return true;
+        case NumberDouble:
+            bob->append(fieldName, _value.doubleVal);
+            return true;
+        default:
+            return false;
+        }
+    }
+
     std::string SafeNum::debugString() const {
         ostringstream os;
         switch (_type) {
@@ -151,7 +151,11 @@ namespace mutablebson {
         friend class mutablebson::Element;
         friend class mutablebson::Document;
 
-        // TODO: output to builder
+        /**
+         * Appends this number, with its type, as field 'fieldName' of 'bob'. Returns false,
+         * appending nothing, if this is an EOO-typed instance.
+         */
+        bool toBSON(StringData fieldName, BSONObjBuilder* bob) const;
 
         //
         // accessors
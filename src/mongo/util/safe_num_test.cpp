@@ -457,4 +457,18 @@ namespace {
         ASSERT_EQUALS(mongo::EOO, (minusOneInt64 * minInt64).type());
     }
 
+    TEST(Output, ToBSON) {
+        mongo::BSONObjBuilder bob;
+        ASSERT_TRUE(SafeNum(1).toBSON("a", &bob));
+        ASSERT_TRUE(SafeNum(2LL).toBSON("b", &bob));
+        ASSERT_TRUE(SafeNum(3.5).toBSON("c", &bob));
+        ASSERT_FALSE(SafeNum().toBSON("d", &bob));
+        const mongo::BSONObj obj = bob.obj();
+        ASSERT_EQUALS(3, obj.nFields());
+        ASSERT_EQUALS(mongo::NumberInt, obj["a"].type());
+        ASSERT_EQUALS(mongo::NumberLong, obj["b"].type());
+        ASSERT_EQUALS(mongo::NumberDouble, obj["c"].type());
+        ASSERT_EQUALS(3.5, obj["c"].Double());
+    }
+
 } // unnamed namespace
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/base/string_data.h"
+#include "mongo/util/grouped_fast_key_table.h"
 #include "mongo/util/unordered_fast_key_table.h"
 
 namespace mongo {
@@ -63,5 +64,17 @@ namespace mongo {
                                                     StringMapDefaultConvertor,
                                                     StringMapDefaultConvertorOther > {
     };
-}
 
+    /**
+     * A StringMap on a GroupedFastKeyTable, for lookup heavy maps.
+     */
+    template< typename V >
+    class GroupedStringMap : public GroupedFastKeyTable< StringData, // K_L
+                                                         std::string, // K_S
+                                                         V,           // V
+                                                         StringMapDefaultHash,
+                                                         StringMapDefaultEqual,
+                                                         StringMapDefaultConvertor,
+                                                         StringMapDefaultConvertorOther > {
+    };
+}
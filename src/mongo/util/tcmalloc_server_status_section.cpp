@@ -90,6 +90,7 @@ namespace {
 
         TCMallocServerStatusSection() : ServerStatusSection("tcmalloc") {}
         virtual bool includeByDefault() const { return false; }
+        virtual bool isExpensive() const { return true; }
 
         virtual BSONObj generateSection(OperationContext* txn,
                                         const BSONElement& configElement) const {